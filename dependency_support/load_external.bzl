@@ -117,6 +117,15 @@ def load_external_repositories():
         ],
     )
 
+    # Released on 2022-01-10, used by the microbenchmarks in //xls/benchmarks.
+    # https://github.com/google/benchmark/releases/tag/v1.6.1
+    http_archive(
+        name = "com_github_google_benchmark",
+        sha256 = "6132883bc8c9b0df5375b16ab520fac1a85dc9e4cf5be59480448ece74b278d4",
+        strip_prefix = "benchmark-1.6.1",
+        urls = ["https://github.com/google/benchmark/archive/refs/tags/v1.6.1.tar.gz"],
+    )
+
     # Released on 2022-04-22, current as of 2022-05-27
     # https://github.com/bazelbuild/rules_python/releases/tag/0.8.1
     http_archive(
@@ -0,0 +1,90 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of BinaryDecisionDiagram operations. Each benchmark builds
+// the expressions for `range(0)`-bit operands in a fresh BDD.
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "xls/data_structures/binary_decision_diagram.h"
+
+namespace xls {
+namespace {
+
+BddNodeIndex Xor(BinaryDecisionDiagram& bdd, BddNodeIndex a, BddNodeIndex b) {
+  return bdd.Or(bdd.And(a, bdd.Not(b)), bdd.And(bdd.Not(a), b));
+}
+
+// Creates variables for two operands. If `interleave` is true the variables
+// of the operands alternate in the variable order, otherwise all variables of
+// `a` precede those of `b`.
+void CreateOperands(BinaryDecisionDiagram& bdd, int64_t bit_count,
+                    bool interleave, std::vector<BddNodeIndex>* a,
+                    std::vector<BddNodeIndex>* b) {
+  a->resize(bit_count);
+  b->resize(bit_count);
+  for (int64_t i = 0; i < bit_count; ++i) {
+    (*a)[i] = bdd.NewVariable();
+    if (interleave) {
+      (*b)[i] = bdd.NewVariable();
+    }
+  }
+  if (!interleave) {
+    for (int64_t i = 0; i < bit_count; ++i) {
+      (*b)[i] = bdd.NewVariable();
+    }
+  }
+}
+
+// Builds the sum bits of a ripple-carry adder.
+void BM_BddAdder(benchmark::State& state) {
+  int64_t bit_count = state.range(0);
+  for (auto _ : state) {
+    BinaryDecisionDiagram bdd;
+    std::vector<BddNodeIndex> a, b;
+    CreateOperands(bdd, bit_count, /*interleave=*/true, &a, &b);
+    BddNodeIndex carry = bdd.zero();
+    for (int64_t i = 0; i < bit_count; ++i) {
+      BddNodeIndex half = Xor(bdd, a[i], b[i]);
+      benchmark::DoNotOptimize(Xor(bdd, half, carry));
+      carry = bdd.Or(bdd.And(a[i], b[i]), bdd.And(half, carry));
+    }
+    state.counters["nodes"] = bdd.size();
+  }
+}
+BENCHMARK(BM_BddAdder)->RangeMultiplier(4)->Range(4, 256);
+
+// Builds an equality comparison. With `range(1)` false the variables are
+// ordered badly and the BDD grows exponentially in the bit count.
+void BM_BddEquality(benchmark::State& state) {
+  int64_t bit_count = state.range(0);
+  for (auto _ : state) {
+    BinaryDecisionDiagram bdd;
+    std::vector<BddNodeIndex> a, b;
+    CreateOperands(bdd, bit_count, /*interleave=*/state.range(1) != 0, &a,
+                   &b);
+    BddNodeIndex eq = bdd.one();
+    for (int64_t i = 0; i < bit_count; ++i) {
+      eq = bdd.And(eq, bdd.Not(Xor(bdd, a[i], b[i])));
+    }
+    benchmark::DoNotOptimize(eq);
+    state.counters["nodes"] = bdd.size();
+  }
+}
+BENCHMARK(BM_BddEquality)->ArgsProduct({{4, 8, 12, 16}, {0, 1}});
+
+}  // namespace
+}  // namespace xls
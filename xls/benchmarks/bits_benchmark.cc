@@ -0,0 +1,148 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of Bits, bits_ops and Value construction. Each benchmark is
+// parameterized by the bit width (or element count) of the operands.
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Returns a bits value of the given width with a mix of set and cleared bits.
+Bits MakeBits(int64_t bit_count, uint8_t seed) {
+  std::vector<uint8_t> bytes((bit_count + 7) / 8);
+  for (int64_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<uint8_t>(seed * (i + 1) + 0x5a);
+  }
+  return Bits::FromBytes(bytes, bit_count);
+}
+
+void BM_BitsFromBytes(benchmark::State& state) {
+  int64_t bit_count = state.range(0);
+  std::vector<uint8_t> bytes((bit_count + 7) / 8, 0xa5);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Bits::FromBytes(bytes, bit_count));
+  }
+}
+BENCHMARK(BM_BitsFromBytes)->RangeMultiplier(4)->Range(8, 4096);
+
+void BM_BitsAdd(benchmark::State& state) {
+  Bits a = MakeBits(state.range(0), 1);
+  Bits b = MakeBits(state.range(0), 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bits_ops::Add(a, b));
+  }
+}
+BENCHMARK(BM_BitsAdd)->RangeMultiplier(4)->Range(8, 4096);
+
+void BM_BitsUMul(benchmark::State& state) {
+  Bits a = MakeBits(state.range(0), 1);
+  Bits b = MakeBits(state.range(0), 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bits_ops::UMul(a, b));
+  }
+}
+BENCHMARK(BM_BitsUMul)->RangeMultiplier(4)->Range(8, 1024);
+
+void BM_BitsAnd(benchmark::State& state) {
+  Bits a = MakeBits(state.range(0), 1);
+  Bits b = MakeBits(state.range(0), 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bits_ops::And(a, b));
+  }
+}
+BENCHMARK(BM_BitsAnd)->RangeMultiplier(4)->Range(8, 4096);
+
+void BM_BitsULessThan(benchmark::State& state) {
+  Bits a = MakeBits(state.range(0), 1);
+  Bits b = MakeBits(state.range(0), 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bits_ops::ULessThan(a, b));
+  }
+}
+BENCHMARK(BM_BitsULessThan)->RangeMultiplier(4)->Range(8, 4096);
+
+void BM_BitsShiftLeftLogical(benchmark::State& state) {
+  Bits a = MakeBits(state.range(0), 1);
+  int64_t amount = state.range(0) / 3;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bits_ops::ShiftLeftLogical(a, amount));
+  }
+}
+BENCHMARK(BM_BitsShiftLeftLogical)->RangeMultiplier(4)->Range(8, 4096);
+
+void BM_BitsConcat(benchmark::State& state) {
+  // Concatenates `range(0)` 8-bit values.
+  std::vector<Bits> operands;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    operands.push_back(MakeBits(8, i));
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bits_ops::Concat(operands));
+  }
+}
+BENCHMARK(BM_BitsConcat)->RangeMultiplier(4)->Range(2, 512);
+
+void BM_BitsSlice(benchmark::State& state) {
+  Bits a = MakeBits(state.range(0), 1);
+  int64_t width = state.range(0) / 2;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a.Slice(/*start=*/1, width));
+  }
+}
+BENCHMARK(BM_BitsSlice)->RangeMultiplier(4)->Range(8, 4096);
+
+void BM_ValueFromBits(benchmark::State& state) {
+  Bits a = MakeBits(state.range(0), 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Value(a));
+  }
+}
+BENCHMARK(BM_ValueFromBits)->RangeMultiplier(4)->Range(8, 4096);
+
+void BM_ValueTuple(benchmark::State& state) {
+  std::vector<Value> elements(state.range(0), Value(UBits(42, 32)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Value::Tuple(elements));
+  }
+}
+BENCHMARK(BM_ValueTuple)->RangeMultiplier(4)->Range(1, 1024);
+
+void BM_ValueArray(benchmark::State& state) {
+  std::vector<Value> elements(state.range(0), Value(UBits(42, 32)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Value::Array(elements));
+  }
+}
+BENCHMARK(BM_ValueArray)->RangeMultiplier(4)->Range(1, 1024);
+
+void BM_ValueEquality(benchmark::State& state) {
+  std::vector<Value> elements(state.range(0), Value(UBits(42, 32)));
+  Value a = Value::Tuple(elements);
+  Value b = Value::Tuple(elements);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a == b);
+  }
+}
+BENCHMARK(BM_ValueEquality)->RangeMultiplier(4)->Range(1, 1024);
+
+}  // namespace
+}  // namespace xls
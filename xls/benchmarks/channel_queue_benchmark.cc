@@ -0,0 +1,145 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of the throughput of ByteQueue and the JIT channel queues.
+// Each benchmark is parameterized by the byte size of the queue elements and
+// reports the number of bytes moved through the queue.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/byte_queue.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/package.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+// Number of elements written to the queue before they are read back.
+constexpr int64_t kBurstSize = 64;
+
+JitRuntime* GetJitRuntime() {
+  static auto jit_runtime =
+      std::make_unique<JitRuntime>(OrcJit::CreateDataLayout().value());
+  return jit_runtime.get();
+}
+
+void BM_ByteQueueWriteRead(benchmark::State& state) {
+  int64_t element_size = state.range(0);
+  ByteQueue queue(element_size, /*is_single_value=*/false);
+  std::vector<uint8_t> buffer(element_size, 0x5a);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kBurstSize; ++i) {
+      queue.Write(buffer.data());
+    }
+    for (int64_t i = 0; i < kBurstSize; ++i) {
+      benchmark::DoNotOptimize(queue.Read(buffer.data()));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * kBurstSize * element_size);
+}
+BENCHMARK(BM_ByteQueueWriteRead)->RangeMultiplier(4)->Range(1, 4096);
+
+void BM_ByteQueueBatchWriteRead(benchmark::State& state) {
+  int64_t element_size = state.range(0);
+  ByteQueue queue(element_size, /*is_single_value=*/false);
+  std::vector<uint8_t> buffer(element_size * kBurstSize, 0x5a);
+  for (auto _ : state) {
+    queue.WriteBatch(buffer.data(), kBurstSize);
+    benchmark::DoNotOptimize(queue.ReadBatch(buffer.data(), kBurstSize));
+  }
+  state.SetBytesProcessed(state.iterations() * kBurstSize * element_size);
+}
+BENCHMARK(BM_ByteQueueBatchWriteRead)->RangeMultiplier(4)->Range(1, 4096);
+
+// Returns a streaming channel whose elements are `byte_count` bytes.
+Channel* CreateChannel(Package* package, int64_t byte_count) {
+  return package
+      ->CreateStreamingChannel("c", ChannelOps::kSendReceive,
+                               package->GetBitsType(byte_count * 8))
+      .value();
+}
+
+template <typename QueueT>
+void BM_JitChannelQueueWriteRead(benchmark::State& state) {
+  Package package("benchmark");
+  Channel* channel = CreateChannel(&package, state.range(0));
+  QueueT queue(channel, GetJitRuntime());
+  int64_t element_size = GetJitRuntime()->GetTypeByteSize(channel->type());
+  std::vector<uint8_t> buffer(element_size, 0x5a);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kBurstSize; ++i) {
+      queue.WriteRaw(buffer.data());
+    }
+    for (int64_t i = 0; i < kBurstSize; ++i) {
+      benchmark::DoNotOptimize(queue.ReadRaw(buffer.data()));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * kBurstSize * element_size);
+}
+BENCHMARK_TEMPLATE(BM_JitChannelQueueWriteRead, ThreadSafeJitChannelQueue)
+    ->RangeMultiplier(4)
+    ->Range(1, 4096);
+BENCHMARK_TEMPLATE(BM_JitChannelQueueWriteRead, ThreadUnsafeJitChannelQueue)
+    ->RangeMultiplier(4)
+    ->Range(1, 4096);
+BENCHMARK_TEMPLATE(BM_JitChannelQueueWriteRead, LockFreeSpscJitChannelQueue)
+    ->RangeMultiplier(4)
+    ->Range(1, 4096);
+
+// Measures throughput with a producer thread writing to the queue while the
+// benchmark thread reads from it.
+template <typename QueueT>
+void BM_JitChannelQueueProducerConsumer(benchmark::State& state) {
+  Package package("benchmark");
+  Channel* channel = CreateChannel(&package, state.range(0));
+  QueueT queue(channel, GetJitRuntime());
+  int64_t element_size = GetJitRuntime()->GetTypeByteSize(channel->type());
+  int64_t total = 0;
+  for (auto _ : state) {
+    Thread producer([&]() {
+      std::vector<uint8_t> buffer(element_size, 0x5a);
+      for (int64_t i = 0; i < kBurstSize; ++i) {
+        queue.WriteRaw(buffer.data());
+      }
+    });
+    std::vector<uint8_t> buffer(element_size);
+    int64_t received = 0;
+    while (received < kBurstSize) {
+      if (queue.ReadRaw(buffer.data())) {
+        ++received;
+      }
+    }
+    producer.Join();
+    total += received;
+  }
+  state.SetBytesProcessed(total * element_size);
+}
+BENCHMARK_TEMPLATE(BM_JitChannelQueueProducerConsumer,
+                   ThreadSafeJitChannelQueue)
+    ->RangeMultiplier(16)
+    ->Range(1, 4096);
+BENCHMARK_TEMPLATE(BM_JitChannelQueueProducerConsumer,
+                   LockFreeSpscJitChannelQueue)
+    ->RangeMultiplier(16)
+    ->Range(1, 4096);
+
+}  // namespace
+}  // namespace xls
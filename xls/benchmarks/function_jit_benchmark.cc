@@ -0,0 +1,107 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of the call overhead of the different FunctionJit entry
+// points. The jitted function is a single add so the time is dominated by
+// argument packing, result unpacking and dispatch. Each benchmark is
+// parameterized by the bit width of the operands.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+// Holds a package with a function adding two parameters of the given width
+// and a JIT of the function.
+struct AddJit {
+  explicit AddJit(int64_t bit_count) : package("benchmark") {
+    FunctionBuilder b("add", &package);
+    b.Add(b.Param("x", package.GetBitsType(bit_count)),
+          b.Param("y", package.GetBitsType(bit_count)));
+    Function* f = b.Build().value();
+    jit = FunctionJit::Create(f).value();
+    args = {Value(Bits::AllOnes(bit_count)), Value(UBits(1, bit_count))};
+  }
+
+  Package package;
+  std::unique_ptr<FunctionJit> jit;
+  std::vector<Value> args;
+};
+
+void BM_FunctionJitRun(benchmark::State& state) {
+  AddJit add(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(add.jit->Run(add.args));
+  }
+}
+BENCHMARK(BM_FunctionJitRun)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_FunctionJitRunWithResultView(benchmark::State& state) {
+  AddJit add(state.range(0));
+  std::vector<uint8_t> result(add.jit->GetReturnTypeSize());
+  InterpreterEvents events;
+  for (auto _ : state) {
+    XLS_CHECK_OK(add.jit->RunWithResultView(add.args, absl::MakeSpan(result),
+                                            &events));
+    benchmark::DoNotOptimize(result.data());
+  }
+}
+BENCHMARK(BM_FunctionJitRunWithResultView)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_FunctionJitRunWithViews(benchmark::State& state) {
+  AddJit add(state.range(0));
+  std::vector<std::vector<uint8_t>> arg_buffers;
+  std::vector<uint8_t*> arg_ptrs;
+  for (int64_t i = 0; i < add.args.size(); ++i) {
+    arg_buffers.push_back(std::vector<uint8_t>(add.jit->GetArgTypeSize(i)));
+    add.jit->runtime()->BlitValueToBuffer(
+        add.args[i], add.jit->function()->param(i)->GetType(),
+        absl::MakeSpan(arg_buffers.back()));
+    arg_ptrs.push_back(arg_buffers.back().data());
+  }
+  std::vector<uint8_t> result(add.jit->GetReturnTypeSize());
+  InterpreterEvents events;
+  for (auto _ : state) {
+    XLS_CHECK_OK(
+        add.jit->RunWithViews(arg_ptrs, absl::MakeSpan(result), &events));
+    benchmark::DoNotOptimize(result.data());
+  }
+}
+BENCHMARK(BM_FunctionJitRunWithViews)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_FunctionJitCreate(benchmark::State& state) {
+  Package package("benchmark");
+  FunctionBuilder b("add", &package);
+  b.Add(b.Param("x", package.GetBitsType(state.range(0))),
+        b.Param("y", package.GetBitsType(state.range(0))));
+  Function* f = b.Build().value();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FunctionJit::Create(f));
+  }
+}
+BENCHMARK(BM_FunctionJitCreate)->Arg(32)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,89 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of parsing large IR packages.
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "benchmark/benchmark.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/ir_parser.h"
+
+namespace xls {
+namespace {
+
+// Returns the text of a package with `function_count` functions each
+// containing a chain of `node_count` arithmetic nodes. The last function is
+// the top and invokes all of the others.
+std::string GeneratePackage(int64_t function_count, int64_t node_count) {
+  std::string text = "package benchmark\n\n";
+  for (int64_t f = 0; f < function_count; ++f) {
+    bool is_top = f == function_count - 1;
+    absl::StrAppendFormat(&text, "%sfn f%d(x: bits[32], y: bits[32]) -> "
+                          "bits[32] {\n",
+                          is_top ? "top " : "", f);
+    std::string prev = "x";
+    int64_t id = 1;
+    if (is_top) {
+      for (int64_t callee = 0; callee < f; ++callee) {
+        absl::StrAppendFormat(
+            &text, "  invoke.%d: bits[32] = invoke(%s, y, to_apply=f%d)\n",
+            id, prev, callee);
+        prev = absl::StrCat("invoke.", id++);
+      }
+    }
+    for (int64_t i = 0; i < node_count; ++i) {
+      std::string op = i % 3 == 0 ? "add" : (i % 3 == 1 ? "xor" : "umul");
+      absl::StrAppendFormat(&text, "  %s.%d: bits[32] = %s(%s, y)\n", op, id,
+                            op, prev);
+      prev = absl::StrCat(op, ".", id++);
+    }
+    absl::StrAppendFormat(&text,
+                          "  ret identity.%d: bits[32] = identity(%s)\n}\n\n",
+                          id, prev);
+  }
+  return text;
+}
+
+// Parses a package with a single function of `range(0)` nodes.
+void BM_ParseLargeFunction(benchmark::State& state) {
+  std::string text = GeneratePackage(/*function_count=*/1, state.range(0));
+  for (auto _ : state) {
+    XLS_CHECK_OK(Parser::ParsePackage(text).status());
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParseLargeFunction)->RangeMultiplier(8)->Range(64, 32768);
+
+// Parses a package with `range(0)` functions of 256 nodes each using
+// `range(1)` threads.
+void BM_ParseManyFunctions(benchmark::State& state) {
+  std::string text = GeneratePackage(state.range(0), /*node_count=*/256);
+  for (auto _ : state) {
+    XLS_CHECK_OK(Parser::ParsePackage(text, /*filename=*/std::nullopt,
+                                      /*thread_count=*/state.range(1))
+                     .status());
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParseManyFunctions)
+    ->ArgsProduct({{16, 128}, {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls
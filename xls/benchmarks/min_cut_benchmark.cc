@@ -0,0 +1,91 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of the max flow algorithms used by MinCutBetweenNodes. The
+// graph has `range(0)` layers of `range(0)` nodes with random forward edges
+// between the layers.
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "xls/data_structures/min_cut.h"
+
+namespace xls {
+namespace min_cut {
+namespace {
+
+// Returns a layered acyclic graph with a source feeding the first layer and a
+// sink fed by the last layer.
+Graph MakeLayeredGraph(int64_t layer_count, int64_t nodes_in_layer,
+                       NodeId* source, NodeId* sink) {
+  constexpr int64_t kMaxFanOut = 10;
+  Graph graph;
+  *source = graph.AddNode("source");
+  *sink = graph.AddNode("sink");
+  std::vector<std::vector<NodeId>> layers(layer_count);
+  for (int64_t i = 0; i < layer_count; ++i) {
+    for (int64_t j = 0; j < nodes_in_layer; ++j) {
+      layers[i].push_back(graph.AddNode());
+    }
+  }
+  for (NodeId node : layers.front()) {
+    graph.AddEdge(*source, node, std::numeric_limits<int64_t>::max());
+  }
+  std::mt19937 gen;
+  std::uniform_int_distribution<int64_t> to_node_id_dis(0, nodes_in_layer - 1);
+  std::uniform_int_distribution<int64_t> to_weight_dis(0, 10);
+  std::uniform_int_distribution<int64_t> fanout_dis(0, kMaxFanOut);
+  for (int64_t i = 0; i < layer_count - 1; ++i) {
+    std::uniform_int_distribution<int64_t> to_layer_dis(i + 1,
+                                                        layer_count - 1);
+    for (int64_t from = 0; from < nodes_in_layer; ++from) {
+      int64_t fanout = fanout_dis(gen);
+      for (int64_t j = 0; j < fanout; ++j) {
+        graph.AddEdge(layers[i][from],
+                      layers[to_layer_dis(gen)][to_node_id_dis(gen)],
+                      to_weight_dis(gen));
+      }
+    }
+  }
+  for (NodeId node : layers.back()) {
+    graph.AddEdge(node, *sink, std::numeric_limits<int64_t>::max());
+  }
+  return graph;
+}
+
+void BM_MinCut(benchmark::State& state, MaxFlowAlgorithm algorithm) {
+  NodeId source;
+  NodeId sink;
+  Graph graph =
+      MakeLayeredGraph(state.range(0), state.range(0), &source, &sink);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        MinCutBetweenNodes(graph, source, sink, algorithm));
+  }
+  state.counters["edges"] = graph.edge_count();
+}
+BENCHMARK_CAPTURE(BM_MinCut, augmenting_path,
+                  MaxFlowAlgorithm::kAugmentingPath)
+    ->RangeMultiplier(2)
+    ->Range(8, 64);
+BENCHMARK_CAPTURE(BM_MinCut, push_relabel, MaxFlowAlgorithm::kPushRelabel)
+    ->RangeMultiplier(2)
+    ->Range(8, 64);
+
+}  // namespace
+}  // namespace min_cut
+}  // namespace xls
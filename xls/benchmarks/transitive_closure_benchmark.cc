@@ -0,0 +1,74 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks comparing the HashRelation and BitmapRelation versions of
+// TransitiveClosure on a random DAG of `range(0)` nodes.
+
+#include <cstdint>
+#include <random>
+
+#include "benchmark/benchmark.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/data_structures/transitive_closure.h"
+
+namespace xls {
+namespace {
+
+// Each forward pair of nodes is connected with this probability.
+constexpr double kEdgeProbability = 0.03;
+
+HashRelation<int64_t> RandomHashDag(int64_t node_count) {
+  std::mt19937_64 rng(42);
+  std::bernoulli_distribution edge(kEdgeProbability);
+  HashRelation<int64_t> relation;
+  for (int64_t i = 0; i < node_count; ++i) {
+    for (int64_t j = i + 1; j < node_count; ++j) {
+      if (edge(rng)) {
+        relation[i].insert(j);
+      }
+    }
+  }
+  return relation;
+}
+
+BitmapRelation ToBitmapRelation(const HashRelation<int64_t>& relation,
+                                int64_t node_count) {
+  BitmapRelation result(node_count, InlineBitmap(node_count));
+  for (const auto& [from, tos] : relation) {
+    for (int64_t to : tos) {
+      result[from].Set(to, true);
+    }
+  }
+  return result;
+}
+
+void BM_HashTransitiveClosure(benchmark::State& state) {
+  HashRelation<int64_t> relation = RandomHashDag(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(TransitiveClosure<int64_t>(relation));
+  }
+}
+BENCHMARK(BM_HashTransitiveClosure)->RangeMultiplier(4)->Range(32, 512);
+
+void BM_BitmapTransitiveClosure(benchmark::State& state) {
+  BitmapRelation relation =
+      ToBitmapRelation(RandomHashDag(state.range(0)), state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(TransitiveClosure(relation));
+  }
+}
+BENCHMARK(BM_BitmapTransitiveClosure)->RangeMultiplier(4)->Range(32, 512);
+
+}  // namespace
+}  // namespace xls
@@ -191,10 +191,16 @@ def xls_ir_verilog_impl(ctx, src):
     CODEGEN_FLAGS = (
         "clock_period_ps",
         "additional_input_delay_ps",
+        "initiation_interval",
         "pipeline_stages",
         "delay_model",
         "io_constraints",
+        "multicycle_ops",
+        "memory_lookup_min_bits",
+        "memory_read_latency",
         "receives_first_sends_last",
+        "schedule_cache_dir",
+        "scheduling_thread_count",
         "top",
         "generator",
         "input_valid_signal",
@@ -224,6 +230,11 @@ def xls_ir_verilog_impl(ctx, src):
         "gate_format",
         "smulp_format",
         "umulp_format",
+        "codegen_thread_count",
+        "sat_io_analysis",
+        "retime_registers",
+        "share_resources",
+        "clock_gate_format",
     )
 
     is_args_valid(codegen_args, CODEGEN_FLAGS)
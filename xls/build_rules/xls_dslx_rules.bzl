@@ -103,7 +103,11 @@ def _get_dslx_test_cmdline(ctx, src, append_cmd_line_args = True):
     DSLX_TEST_FLAGS = (
         "compare",
         "dslx_path",
+        "execute_on_jit",
         "warnings_as_errors",
+        "type_info_cache_dir",
+        "test_threads",
+        "bytecode_cache_dir",
     )
 
     dslx_test_args = dict(_dslx_test_args)
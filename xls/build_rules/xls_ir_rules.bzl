@@ -131,6 +131,9 @@ def _convert_to_ir(ctx, src):
         "emit_fail_as_assert",
         "top_proc_initial_state",
         "warnings_as_errors",
+        "output_ir_format",
+        "typecheck_threads",
+        "type_info_cache_dir",
     )
 
     ir_conv_args = dict(ctx.attr.ir_conv_args)
@@ -196,6 +199,18 @@ def _optimize_ir(ctx, src):
         "opt_level",
         "convert_array_index_to_select",
         "inline_procs",
+        "defer_proc_inlining",
+        "function_pass_threads",
+        "inlining_node_budget",
+        "bottom_up_optimization",
+        "memoize_bottom_up_optimization",
+        "loop_unroll_factor",
+        "narrowing_worklist",
+        "mutual_exclusion_threads",
+        "mutual_exclusion_time_budget_ms",
+        "parse_threads",
+        "pass_metrics_proto",
+        "output_ir_format",
     )
 
     is_args_valid(opt_ir_args, IR_OPT_FLAGS)
@@ -260,6 +275,8 @@ def get_ir_equivalence_test_cmd(
         get_xls_toolchain_info(ctx).ir_equivalence_tool,
     )
     IR_EQUIVALENCE_FLAGS = (
+        "portfolio",
+        "simulation_samples",
         "timeout",
     )
 
@@ -312,13 +329,17 @@ def get_eval_ir_test_cmd(ctx, src, append_cmd_line_args = True):
         "input",
         "input_file",
         "random_inputs",
+        "threads",
         "expected",
         "expected_file",
         "optimize_ir",
         "eval_after_each_pass",
         "use_llvm_jit",
+        "interpreter_cache_size",
         "test_llvm_jit",
         "llvm_opt_level",
+        "jit_object_cache_dir",
+        "jit_compilation_mode",
         "test_only_inject_jit_result",
     )
 
@@ -395,6 +416,11 @@ def get_benchmark_ir_cmd(ctx, src, append_cmd_line_args = True):
         "show_known_bits",
         "delay_model",
         "convert_array_index_to_select",
+        "scheduling_metrics_path",
+        "repetitions",
+        "warmup_repetitions",
+        "results_path",
+        "results_format",
     )
 
     benchmark_ir_args = append_default_to_args(
@@ -312,6 +312,7 @@ def cc_xls_ir_jit_wrapper(
         hdrs = [":" + header_filename],
         deps = [
             "@com_google_absl//absl/status",
+            "//xls/common/status:ret_check",
             "//xls/common/status:status_macros",
             "@com_google_absl//absl/status:statusor",
             "//xls/ir",
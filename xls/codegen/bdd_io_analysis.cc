@@ -15,19 +15,34 @@
 #include "xls/codegen/bdd_io_analysis.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <random>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/interpreter/random_value.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
 #include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/query_engine.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_utils.h"
+#include "../z3/src/api/z3_api.h"
 
 namespace xls {
 
@@ -49,9 +64,124 @@ bool UseNodeInBddEngine(const Node* node) {
          node->Is<CompareOp>();
 }
 
+// The number of 64-sample words simulated by the kSimulationAndSat engine
+// before it resorts to SAT.
+constexpr int64_t kSimulationWordCount = 4;
+
+// The time allowed for each SAT query of the kSimulationAndSat engine. A query
+// which times out is conservatively treated as satisfiable.
+constexpr absl::Duration kSatQueryTimeout = absl::Seconds(10);
+
+// Returns the nodes which 'roots' transitively depend on, including 'roots'
+// themselves, in topological order.
+std::vector<Node*> FaninCone(FunctionBase* f, absl::Span<Node* const> roots) {
+  absl::flat_hash_set<Node*> cone(roots.begin(), roots.end());
+  std::vector<Node*> worklist(roots.begin(), roots.end());
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* operand : node->operands()) {
+      if (cone.insert(operand).second) {
+        worklist.push_back(operand);
+      }
+    }
+  }
+  std::vector<Node*> result;
+  for (Node* node : TopoSort(f)) {
+    if (cone.contains(node)) {
+      result.push_back(node);
+    }
+  }
+  return result;
+}
+
+// Evaluates the predicates with random values for the params and for the
+// results of side-effecting nodes (e.g., receives). Returns true if in some
+// sample at least two of the predicates are true.
+absl::StatusOr<bool> SimulationFindsOverlappingPredicates(
+    FunctionBase* f, absl::Span<Node* const> predicates) {
+  std::vector<Node*> cone = FaninCone(f, predicates);
+  std::minstd_rand engine;
+  absl::flat_hash_map<Node*, Value> values;
+  std::vector<Value> operand_values;
+  for (int64_t word = 0; word < kSimulationWordCount; ++word) {
+    // Bit i of masks[j] is set if predicates[j] is true in the i-th sample.
+    std::vector<uint64_t> masks(predicates.size(), 0);
+    for (int64_t sample = 0; sample < 64; ++sample) {
+      for (Node* node : cone) {
+        Value result;
+        if (OpIsSideEffecting(node->op()) && node->op() != Op::kGate) {
+          result = RandomValue(node->GetType(), &engine);
+        } else {
+          operand_values.clear();
+          for (Node* operand : node->operands()) {
+            operand_values.push_back(values.at(operand));
+          }
+          XLS_ASSIGN_OR_RETURN(result, InterpretNode(node, operand_values));
+        }
+        values.insert_or_assign(node, std::move(result));
+      }
+      for (int64_t i = 0; i < predicates.size(); ++i) {
+        if (values.at(predicates[i]).bits().IsOne()) {
+          masks[i] |= uint64_t{1} << sample;
+        }
+      }
+    }
+    // A sample in which two predicates are true sets the same bit in both
+    // masks.
+    uint64_t seen = 0;
+    for (int64_t i = 0; i < predicates.size(); ++i) {
+      if ((seen & masks[i]) != 0) {
+        XLS_VLOG(3) << "Simulation found " << predicates[i]->GetName()
+                    << " true together with another send predicate";
+        return true;
+      }
+      seen |= masks[i];
+    }
+  }
+  return false;
+}
+
+// Proves with Z3 that no two of the predicates can be true at once. The
+// function is translated once and each pair is checked within a push/pop scope
+// of a single solver. Unsupported ops (e.g., receives) are translated into
+// fresh variables.
+absl::StatusOr<bool> SatProvesPredicatesExclusive(
+    FunctionBase* f, absl::Span<Node* const> predicates) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<solvers::z3::IrTranslator> translator,
+      solvers::z3::IrTranslator::CreateAndTranslate(
+          f, /*allow_unsupported=*/true));
+  translator->SetTimeout(kSatQueryTimeout);
+  Z3_context ctx = translator->ctx();
+  Z3_solver solver = solvers::z3::CreateSolver(ctx, 1);
+  Z3_ast one = Z3_mk_int(ctx, 1, Z3_mk_bv_sort(ctx, 1));
+
+  bool exclusive = true;
+  for (int64_t i = 0; i < predicates.size() && exclusive; ++i) {
+    for (int64_t j = i + 1; j < predicates.size() && exclusive; ++j) {
+      Z3_ast both =
+          Z3_mk_bvand(ctx, translator->GetTranslation(predicates[i]),
+                      translator->GetTranslation(predicates[j]));
+      Z3_solver_push(ctx, solver);
+      Z3_solver_assert(ctx, solver, Z3_mk_eq(ctx, both, one));
+      Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
+      XLS_VLOG(3) << absl::StreamFormat(
+          "SAT query for %s and %s: %s", predicates[i]->GetName(),
+          predicates[j]->GetName(),
+          solvers::z3::SolverResultToString(ctx, solver, satisfiable));
+      Z3_solver_pop(ctx, solver, 1);
+      exclusive = satisfiable == Z3_L_FALSE;
+    }
+  }
+  Z3_solver_dec_ref(ctx, solver);
+  return exclusive;
+}
+
 }  // namespace
 
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(FunctionBase* f) {
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    FunctionBase* f, IOAnalysisEngine engine) {
   // Find all send nodes associated with streaming channels.
   int64_t streaming_send_count = 0;
   std::vector<Node*> send_predicates;
@@ -88,6 +218,15 @@ absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(FunctionBase* f) {
     return false;
   }
 
+  if (engine == IOAnalysisEngine::kSimulationAndSat) {
+    XLS_ASSIGN_OR_RETURN(bool overlap, SimulationFindsOverlappingPredicates(
+                                           f, send_predicates));
+    if (overlap) {
+      return false;
+    }
+    return SatProvesPredicatesExclusive(f, send_predicates);
+  }
+
   // Use BDD query engine to determine predicates are such that
   // if one is true, the rest are false.
   BddQueryEngine query_engine(BddFunction::kDefaultPathLimit,
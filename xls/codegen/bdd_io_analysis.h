@@ -22,11 +22,26 @@
 
 namespace xls {
 
+// Engines which may be used to prove that the predicates of streaming sends
+// are mutually exclusive.
+enum class IOAnalysisEngine {
+  // Builds a BDD of the predicate logic. Exact for cheap logic, but the BDD
+  // may blow up (and the analysis give up) on procs with wide predicates.
+  kBdd,
+
+  // Simulates the proc on random inputs, 64 samples per machine word, to
+  // quickly find two predicates which are true together. If none are found,
+  // each pair of predicates is then proven disjoint with incremental SAT
+  // queries against a single Z3 translation of the proc.
+  kSimulationAndSat,
+};
+
 // Determines if streaming outputs are mutually exclusive.
 //
 // TODO(tedhong): 2022-02-09 Add analysis of I/O dependencies
 // TODO(tedhong): 2022-02-09 Add additional exclusivity analysis
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(FunctionBase* f);
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    FunctionBase* f, IOAnalysisEngine engine = IOAnalysisEngine::kBdd);
 
 }  // namespace xls
 
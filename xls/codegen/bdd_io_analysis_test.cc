@@ -31,6 +31,8 @@
 namespace xls {
 namespace {
 
+using status_testing::IsOkAndHolds;
+
 class BddIOAnalysisPassTest : public IrTestBase {};
 
 TEST_F(BddIOAnalysisPassTest, RunOnFunction) {
@@ -228,5 +230,89 @@ TEST_F(BddIOAnalysisPassTest, NonMutuallyExclusiveSendIf) {
   EXPECT_EQ(mutually_exclusive, false);
 }
 
+TEST_F(BddIOAnalysisPassTest, SimulationAndSatMutuallyExclusive) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * sel,
+      package.CreateStreamingChannel("sel", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out2,
+      package.CreateStreamingChannel("out2", ChannelOps::kSendOnly, u32));
+
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+
+  BValue in_val = pb.Receive(in);
+  BValue sel_val = pb.Receive(sel);
+  BValue bound = pb.Add(in_val, sel_val);
+
+  pb.SendIf(out0, pb.ULt(sel_val, bound), in_val);
+  pb.SendIf(out1, pb.UGt(sel_val, bound), in_val);
+  pb.SendIf(out2, pb.Eq(sel_val, bound), in_val);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool mutually_exclusive,
+      AreStreamingOutputsMutuallyExclusive(
+          proc, IOAnalysisEngine::kSimulationAndSat));
+  EXPECT_EQ(mutually_exclusive, true);
+}
+
+TEST_F(BddIOAnalysisPassTest, SimulationAndSatNonMutuallyExclusive) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out2,
+      package.CreateStreamingChannel("out2", ChannelOps::kSendOnly, u32));
+
+  {
+    // Overlapping predicates which random simulation readily finds.
+    TokenlessProcBuilder pb("easy", /*token_name=*/"tkn", &package);
+    BValue in_val = pb.Receive(in);
+    pb.SendIf(out0, pb.BitSlice(in_val, /*start=*/0, /*width=*/1), in_val);
+    pb.SendIf(out1, pb.BitSlice(in_val, /*start=*/1, /*width=*/1), in_val);
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+    EXPECT_THAT(AreStreamingOutputsMutuallyExclusive(
+                    proc, IOAnalysisEngine::kSimulationAndSat),
+                IsOkAndHolds(false));
+  }
+  {
+    // Predicates which overlap for a single input value so only the SAT
+    // query finds the overlap.
+    TokenlessProcBuilder pb("hard", /*token_name=*/"tkn", &package);
+    BValue in_val = pb.Receive(in);
+    pb.SendIf(out0, pb.Eq(in_val, pb.Literal(UBits(0x12345, 32))), in_val);
+    pb.SendIf(out1, pb.ULt(in_val, pb.Literal(UBits(0x10000, 32))), in_val);
+    pb.SendIf(out2, pb.UGt(in_val, pb.Literal(UBits(0x12344, 32))), in_val);
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+    EXPECT_THAT(AreStreamingOutputsMutuallyExclusive(
+                    proc, IOAnalysisEngine::kSimulationAndSat),
+                IsOkAndHolds(false));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -124,6 +124,13 @@ struct PipelineRegister {
 };
 
 // A data structure representing a state register for a single XLS IR value.
+//
+// The state register is read in stage `stage` and written in stage
+// `next_stage`. If these differ (i.e., the proc is scheduled with an
+// initiation interval greater than one) then the register has an associated
+// one-bit `full` register which is set when the next state value is written
+// and cleared when the state is read. The reading stage may only proceed while
+// the state register is full.
 class StateRegister {
  public:
   StateRegister(std::string_view name, Value reset_value, Stage stage,
@@ -131,6 +138,7 @@ class StateRegister {
       : name_(name),
         reset_value_(reset_value),
         stage_(stage),
+        next_stage_(stage),
         reg_(reg),
         reg_write_(reg_write),
         reg_read_(reg_read) {}
@@ -138,24 +146,33 @@ class StateRegister {
   std::string& name() { return name_; }
   Value& reset_value() { return reset_value_; }
   Stage& stage() { return stage_; }
+  Stage& next_stage() { return next_stage_; }
   Register*& reg() { return reg_; }
   RegisterWrite*& reg_write() { return reg_write_; }
   RegisterRead*& reg_read() { return reg_read_; }
+  Register*& full_reg() { return full_reg_; }
+  RegisterRead*& full_reg_read() { return full_reg_read_; }
 
   std::string_view name() const { return name_; }
   const Value& reset_value() const { return reset_value_; }
   Stage stage() const { return stage_; }
+  Stage next_stage() const { return next_stage_; }
   Register* reg() const { return reg_; }
   RegisterWrite* reg_write() const { return reg_write_; }
   RegisterRead* reg_read() const { return reg_read_; }
+  Register* full_reg() const { return full_reg_; }
+  RegisterRead* full_reg_read() const { return full_reg_read_; }
 
  private:
   std::string name_;
   Value reset_value_;
   Stage stage_;
+  Stage next_stage_;
   Register* reg_;
   RegisterWrite* reg_write_;
   RegisterRead* reg_read_;
+  Register* full_reg_ = nullptr;
+  RegisterRead* full_reg_read_ = nullptr;
 };
 
 // The collection of pipeline registers for a single stage.
@@ -304,6 +321,52 @@ static absl::Status UpdateStateRegisterWithReset(const ResetInfo& reset_info,
                                                        reset_behavior);
 }
 
+// Adds a full flag register for each state register which is written in a
+// later stage than it is read (see StateRegister). The flag is reset to one as
+// the state register holds its initial value after reset. The stage reading
+// the state register is treated as having an additional input which is valid
+// only while the flag is set, so `all_active_inputs_valid` of that stage is
+// ANDed with the flag. The flag register is written in
+// UpdatePipelineWithBubbleFlowControl once the stage enables are known.
+static absl::Status AddStateFullFlags(
+    const ResetInfo& reset_info,
+    absl::Span<std::optional<StateRegister>> state_registers,
+    std::vector<Node*>& all_active_inputs_valid, Block* block) {
+  for (std::optional<StateRegister>& state_register : state_registers) {
+    if (!state_register.has_value() ||
+        state_register->next_stage() == state_register->stage()) {
+      continue;
+    }
+    if (!reset_info.input_port.has_value() ||
+        !reset_info.behavior.has_value()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Unable to add full flag for state register %s as block was not "
+          "created with a reset.",
+          state_register->name()));
+    }
+    xls::Reset reset_behavior = reset_info.behavior.value();
+    reset_behavior.reset_value = Value(UBits(1, 1));
+    XLS_ASSIGN_OR_RETURN(
+        state_register->full_reg(),
+        block->AddRegister(absl::StrCat(state_register->name(), "_full"),
+                           block->package()->GetBitsType(1), reset_behavior));
+    XLS_ASSIGN_OR_RETURN(state_register->full_reg_read(),
+                         block->MakeNode<RegisterRead>(
+                             /*loc=*/SourceInfo(), state_register->full_reg()));
+
+    Node*& stage_inputs_valid =
+        all_active_inputs_valid.at(state_register->stage());
+    XLS_ASSIGN_OR_RETURN(
+        stage_inputs_valid,
+        block->MakeNode<NaryOp>(
+            SourceInfo(),
+            std::vector<Node*>{stage_inputs_valid,
+                               state_register->full_reg_read()},
+            Op::kAnd));
+  }
+  return absl::OkStatus();
+}
+
 // Updates datapath pipeline registers with a reset signal.
 //  1. The pipeline registers are reset active_high or active_low
 //     following the block behavior.
@@ -517,18 +580,51 @@ static absl::StatusOr<BubbleFlowControl> UpdatePipelineWithBubbleFlowControl(
 
   // Generate writes for state registers. This is done in a separate loop
   // because the last stage isn't included in the pipeline register loop.
+  //
+  // The state register is written when the stage computing the next state
+  // value completes. If this is a later stage than the one reading the state,
+  // the full flag is set on the write and cleared on the read:
+  //
+  //   full_next = write_enable || (full && !read_enable)
   for (std::optional<StateRegister>& state_register : state_registers) {
     if (state_register.has_value()) {
+      Node* write_enable = state_enables.at(state_register->next_stage());
       XLS_ASSIGN_OR_RETURN(
           RegisterWrite * new_reg_write,
           block->MakeNode<RegisterWrite>(
               /*loc=*/state_register->reg_write()->loc(),
               /*data=*/state_register->reg_write()->data(),
-              /*load_enable=*/state_enables.at(state_register->stage()),
+              /*load_enable=*/write_enable,
               /*reset=*/state_register->reg_write()->reset(),
               /*reg=*/state_register->reg_write()->GetRegister()));
       XLS_RETURN_IF_ERROR(block->RemoveNode(state_register->reg_write()));
       state_register->reg_write() = new_reg_write;
+
+      if (state_register->full_reg() != nullptr) {
+        Node* read_enable = state_enables.at(state_register->stage());
+        XLS_ASSIGN_OR_RETURN(
+            Node * not_read_enable,
+            block->MakeNode<UnOp>(SourceInfo(), read_enable, Op::kNot));
+        XLS_ASSIGN_OR_RETURN(
+            Node * still_full,
+            block->MakeNode<NaryOp>(
+                SourceInfo(),
+                std::vector<Node*>{state_register->full_reg_read(),
+                                   not_read_enable},
+                Op::kAnd));
+        XLS_ASSIGN_OR_RETURN(
+            Node * full_next,
+            block->MakeNode<NaryOp>(
+                SourceInfo(), std::vector<Node*>{write_enable, still_full},
+                Op::kOr));
+        XLS_RETURN_IF_ERROR(block
+                                ->MakeNode<RegisterWrite>(
+                                    /*loc=*/SourceInfo(), full_next,
+                                    /*load_enable=*/absl::nullopt,
+                                    /*reset=*/reset_info.input_port,
+                                    state_register->full_reg())
+                                .status());
+      }
     }
   }
 
@@ -1771,6 +1867,9 @@ static absl::StatusOr<std::vector<Node*>> AddBubbleFlowControl(
       std::vector<Node*> all_active_inputs_valid,
       MakeInputValidPortsForInputChannels(streaming_io.inputs, stage_count,
                                           valid_suffix, block));
+  XLS_RETURN_IF_ERROR(
+      AddStateFullFlags(reset_info, absl::MakeSpan(streaming_io.state_registers),
+                        all_active_inputs_valid, block));
   streaming_io.all_active_inputs_valid = all_active_inputs_valid;
   XLS_VLOG(3) << "After Inputs Valid";
   XLS_VLOG_LINES(3, block->DumpIr());
@@ -2039,8 +2138,8 @@ class CloneNodesIntoBlockHandler {
     if (is_proc_) {
       for (Node* node : sorted_nodes) {
         if (next_state_nodes_.contains(node)) {
-          XLS_RETURN_IF_ERROR(
-              SetNextStateNode(node_map_.at(node), next_state_nodes_.at(node)));
+          XLS_RETURN_IF_ERROR(SetNextStateNode(
+              node_map_.at(node), stage, next_state_nodes_.at(node)));
         }
       }
     }
@@ -2048,42 +2147,20 @@ class CloneNodesIntoBlockHandler {
     return absl::OkStatus();
   }
 
-  // Add pipeline registers. A register is needed for each node which is
-  // scheduled at or before this cycle and has a use after this cycle.
-  absl::Status AddNextPipelineStage(const PipelineSchedule& schedule,
+  // Add pipeline registers for the given nodes which are live out of the
+  // stage. See GetNodesLiveOutOfStages.
+  absl::Status AddNextPipelineStage(absl::Span<Node* const> live_out_nodes,
                                     int64_t stage) {
-    Function* as_func = dynamic_cast<Function*>(function_base_);
-
-    for (Node* function_base_node : function_base_->nodes()) {
-      if (schedule.cycle(function_base_node) > stage) {
-        continue;
-      }
-      auto is_live_out_of_stage = [&](Node* n) {
-        if (stage == schedule.length() - 1) {
-          return false;
-        }
-        if (as_func && (n == as_func->return_value())) {
-          return true;
-        }
-        for (Node* user : n->users()) {
-          if (schedule.cycle(user) > stage) {
-            return true;
-          }
-        }
-        return false;
-      };
+    for (Node* function_base_node : live_out_nodes) {
+      Node* node = node_map_.at(function_base_node);
 
-      if (is_live_out_of_stage(function_base_node)) {
-        Node* node = node_map_.at(function_base_node);
-
-        XLS_ASSIGN_OR_RETURN(
-            Node * node_after_stage,
-            CreatePipelineRegistersForNode(
-                PipelineSignalName(node->GetName(), stage), node,
-                result_.pipeline_registers.at(stage), block_));
+      XLS_ASSIGN_OR_RETURN(
+          Node * node_after_stage,
+          CreatePipelineRegistersForNode(
+              PipelineSignalName(node->GetName(), stage), node,
+              result_.pipeline_registers.at(stage), block_));
 
-        node_map_[function_base_node] = node_after_stage;
-      }
+      node_map_[function_base_node] = node_after_stage;
     }
 
     return absl::OkStatus();
@@ -2304,8 +2381,8 @@ class CloneNodesIntoBlockHandler {
   }
 
   // Sets the next state value for the state elements with the given indices to
-  // `next_state`.
-  absl::Status SetNextStateNode(Node* next_state,
+  // `next_state` which is computed in stage `stage`.
+  absl::Status SetNextStateNode(Node* next_state, Stage stage,
                                 absl::Span<const int64_t> indices) {
     if (next_state->GetType()->GetFlatBitCount() == 0) {
       Proc* proc = function_base_->AsProcOrDie();
@@ -2331,6 +2408,18 @@ class CloneNodesIntoBlockHandler {
       // There should only be one next state node.
       XLS_CHECK_EQ(state_register.reg_write(), nullptr);
 
+      // The next state value may be computed in a later stage than the state
+      // is read when scheduled with an initiation interval greater than one,
+      // but never in an earlier one.
+      if (stage < state_register.stage()) {
+        return absl::UnimplementedError(absl::StrFormat(
+            "Next state value %s of state element %s is scheduled in stage %d "
+            "before the state is read in stage %d",
+            next_state->GetName(), state_register.name(), stage,
+            state_register.stage()));
+      }
+      state_register.next_stage() = stage;
+
       XLS_ASSIGN_OR_RETURN(state_register.reg_write(),
                            block_->MakeNode<RegisterWrite>(
                                next_state->loc(), next_state,
@@ -2455,6 +2544,37 @@ class CloneNodesIntoBlockHandler {
   absl::flat_hash_map<Node*, Node*> node_map_;
 };
 
+// Returns the nodes which need a pipeline register after each stage, indexed by
+// stage. A register is needed for each node which is scheduled at or before
+// the stage and has a use after the stage (the return value of a function is
+// used by the output port in the final stage). The nodes of each stage are in
+// the order of FunctionBase::nodes.
+//
+// Each node is visited once so the cost is proportional to the number of nodes
+// plus the number of pipeline registers rather than to the number of nodes
+// times the number of stages.
+static std::vector<std::vector<Node*>> GetNodesLiveOutOfStages(
+    const PipelineSchedule& schedule) {
+  FunctionBase* function_base = schedule.function_base();
+  Function* as_func = dynamic_cast<Function*>(function_base);
+  int64_t last_stage = schedule.length() - 1;
+  std::vector<std::vector<Node*>> live_out_nodes(schedule.length());
+  for (Node* node : function_base->nodes()) {
+    int64_t last_use = schedule.cycle(node);
+    if (as_func != nullptr && node == as_func->return_value()) {
+      last_use = last_stage;
+    }
+    for (Node* user : node->users()) {
+      last_use = std::max(last_use, schedule.cycle(user));
+    }
+    for (int64_t stage = schedule.cycle(node);
+         stage < std::min(last_use, last_stage); ++stage) {
+      live_out_nodes[stage].push_back(node);
+    }
+  }
+  return live_out_nodes;
+}
+
 // Adds the nodes in the given schedule to the block. Pipeline registers are
 // inserted between stages and returned as a vector indexed by cycle. The block
 // should be empty prior to calling this function.
@@ -2466,9 +2586,12 @@ static absl::StatusOr<StreamingIOPipeline> CloneNodesIntoPipelinedBlock(
 
   CloneNodesIntoBlockHandler cloner(function_base, schedule.length(), options,
                                     block);
+  std::vector<std::vector<Node*>> live_out_nodes =
+      GetNodesLiveOutOfStages(schedule);
   for (int64_t stage = 0; stage < schedule.length(); ++stage) {
     XLS_RET_CHECK_OK(cloner.CloneNodes(schedule.nodes_in_cycle(stage), stage));
-    XLS_RET_CHECK_OK(cloner.AddNextPipelineStage(schedule, stage));
+    XLS_RET_CHECK_OK(
+        cloner.AddNextPipelineStage(live_out_nodes.at(stage), stage));
   }
 
   XLS_RET_CHECK_OK(cloner.AddOutputPortsIfFunction());
@@ -2612,7 +2735,10 @@ absl::StatusOr<Block*> ProcToPipelinedBlock(const PipelineSchedule& schedule,
   if (number_of_outputs > 1) {
     // TODO: do this analysis on a per-stage basis
     XLS_ASSIGN_OR_RETURN(streaming_outputs_mutually_exclusive,
-                         AreStreamingOutputsMutuallyExclusive(proc));
+                         AreStreamingOutputsMutuallyExclusive(
+                             proc, options.sat_io_analysis()
+                                       ? IOAnalysisEngine::kSimulationAndSat
+                                       : IOAnalysisEngine::kBdd));
 
     if (streaming_outputs_mutually_exclusive) {
       XLS_VLOG(3) << absl::StrFormat(
@@ -2766,7 +2892,10 @@ absl::StatusOr<Block*> ProcToCombinationalBlock(Proc* proc,
   if (number_of_outputs > 1) {
     // TODO: do this analysis on a per-stage basis
     XLS_ASSIGN_OR_RETURN(bool streaming_outputs_mutually_exclusive,
-                         AreStreamingOutputsMutuallyExclusive(proc));
+                         AreStreamingOutputsMutuallyExclusive(
+                             proc, options.sat_io_analysis()
+                                       ? IOAnalysisEngine::kSimulationAndSat
+                                       : IOAnalysisEngine::kBdd));
 
     if (streaming_outputs_mutually_exclusive) {
       XLS_VLOG(3) << absl::StrFormat(
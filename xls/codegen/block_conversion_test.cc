@@ -1807,6 +1807,109 @@ INSTANTIATE_TEST_SUITE_P(
                         CodegenOptions::IOKind::kZeroLatencyBuffer)),
     SimpleRunningCounterProcTestSweepFixture::PrintToStringParamName);
 
+// Fixture used to test pipelined BlockConversion of a running sum proc whose
+// state recurrence spans several stages, i.e., which is scheduled with an
+// initiation interval greater than one.
+class InitiationIntervalProcTest : public ProcConversionTestFixture {
+ protected:
+  absl::StatusOr<std::unique_ptr<Package>> BuildBlockInPackage(
+      int64_t stage_count, const CodegenOptions& options) override {
+    auto package_ptr = std::make_unique<Package>(TestName());
+    Package& package = *package_ptr;
+
+    Type* u32 = package.GetBitsType(32);
+    XLS_ASSIGN_OR_RETURN(
+        Channel * ch_in,
+        package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+    XLS_ASSIGN_OR_RETURN(
+        Channel * ch_out,
+        package.CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+
+    TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+    BValue state = pb.StateElement("st", Value(UBits(0, 32)));
+    BValue in_val = pb.Receive(ch_in);
+    BValue next_state = pb.Not(pb.Not(pb.Add(in_val, state)));
+    pb.Send(ch_out, next_state);
+    XLS_ASSIGN_OR_RETURN(Proc * proc, pb.Build({next_state}));
+
+    // With unit delays each op is in its own stage so the path from the state
+    // through the add and the two nots spans three stages.
+    XLS_ASSIGN_OR_RETURN(
+        PipelineSchedule schedule,
+        PipelineSchedule::Run(proc, TestDelayEstimator(),
+                              SchedulingOptions()
+                                  .pipeline_stages(stage_count)
+                                  .clock_period_ps(1)
+                                  .initiation_interval(3)));
+    XLS_RET_CHECK_EQ(schedule.cycle(next_state.node()) -
+                         schedule.cycle(state.node()),
+                     2);
+
+    CodegenOptions codegen_options = options;
+    codegen_options.module_name(kBlockName);
+    XLS_RET_CHECK_OK(ProcToPipelinedBlock(schedule, codegen_options, proc));
+
+    return package_ptr;
+  }
+};
+
+TEST_F(InitiationIntervalProcTest, RandomStalling) {
+  CodegenOptions options;
+  options.clock_name("clk");
+  options.valid_control("input_valid", "output_valid");
+  options.reset("rst", false, /*active_low=*/false, false);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           BuildBlockInPackage(/*stage_count=*/5, options));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, package->GetBlock(kBlockName));
+  XLS_VLOG_LINES(2, block->DumpIr());
+
+  int64_t simulation_cycle_count = 2000;
+  int64_t max_random_cycle = simulation_cycle_count - 20 - 1;
+
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> inputs;
+  XLS_ASSERT_OK(SetSignalsOverCycles(0, 9, {{"rst", 1}}, inputs));
+  XLS_ASSERT_OK(SetSignalsOverCycles(10, simulation_cycle_count - 1,
+                                     {{"rst", 0}}, inputs));
+  XLS_ASSERT_OK(SetIncrementingSignalOverCycles(0, simulation_cycle_count - 1,
+                                                "in", 1, inputs));
+  std::minstd_rand rng_engine;
+  XLS_ASSERT_OK(SetRandomSignalOverCycles(0, max_random_cycle, "in_vld", 0, 1,
+                                          rng_engine, inputs));
+  XLS_ASSERT_OK(SetRandomSignalOverCycles(0, max_random_cycle, "out_rdy", 0, 1,
+                                          rng_engine, inputs));
+  XLS_ASSERT_OK(SetSignalsOverCycles(max_random_cycle + 1,
+                                     simulation_cycle_count - 1,
+                                     {{"in_vld", 0}, {"out_rdy", 1}}, inputs));
+
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> outputs;
+  XLS_ASSERT_OK_AND_ASSIGN(outputs, InterpretSequentialBlock(block, inputs));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<CycleAndValue> input_sequence,
+      GetChannelSequenceFromIO({"in", SignalType::kInput},
+                               {"in_vld", SignalType::kInput},
+                               {"in_rdy", SignalType::kOutput},
+                               {"rst", SignalType::kInput}, inputs, outputs));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<CycleAndValue> output_sequence,
+      GetChannelSequenceFromIO({"out", SignalType::kOutput},
+                               {"out_vld", SignalType::kOutput},
+                               {"out_rdy", SignalType::kInput},
+                               {"rst", SignalType::kInput}, inputs, outputs));
+
+  // Each output is the running sum of the inputs so far, so no state update
+  // was lost or applied twice despite the state being written two stages
+  // after it is read.
+  ASSERT_GT(input_sequence.size(), 10);
+  ASSERT_EQ(output_sequence.size(), input_sequence.size());
+  uint64_t sum = 0;
+  for (int64_t i = 0; i < input_sequence.size(); ++i) {
+    sum = (sum + input_sequence[i].value) & 0xffffffff;
+    EXPECT_EQ(output_sequence[i].value, sum) << "output " << i;
+  }
+}
+
 // Fixture used to test pipelined BlockConversion on a multi input  block.
 class MultiInputPipelinedProcTest : public ProcConversionTestFixture {
  protected:
@@ -686,6 +686,20 @@ class BlockGenerator {
       if (xls::BlockInstantiation* block_instantiation =
               dynamic_cast<BlockInstantiation*>(instantiation)) {
         std::vector<Connection> connections;
+        // The clock of an instantiated block is driven by the clock of this
+        // block.
+        std::optional<Block::ClockPort> clock_port =
+            block_instantiation->instantiated_block()->GetClockPort();
+        if (clock_port.has_value()) {
+          if (mb_.clock() == nullptr) {
+            return absl::InvalidArgumentError(absl::StrFormat(
+                "Block %s has no clock port but instantiates block %s which "
+                "has one",
+                block_->name(),
+                block_instantiation->instantiated_block()->name()));
+          }
+          connections.push_back(Connection{clock_port->name, mb_.clock()});
+        }
         for (InstantiationInput* input :
              block_->GetInstantiationInputs(instantiation)) {
           XLS_RET_CHECK(std::holds_alternative<Expression*>(
@@ -773,6 +787,7 @@ absl::StatusOr<std::string> GenerateVerilog(Block* top,
                        GatherInstantiatedBlocks(top));
   VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
                                                 : FileType::kVerilog);
+  file.set_emit_thread_count(options.emit_thread_count());
   for (Block* block : blocks) {
     XLS_RETURN_IF_ERROR(BlockGenerator::Generate(block, &file, options));
     if (block != blocks.back()) {
@@ -211,6 +211,46 @@ TEST_P(BlockGeneratorTest, PipelinedAandBNoReset) {
   XLS_ASSERT_OK(tb.Run());
 }
 
+TEST_P(BlockGeneratorTest, ClockGatedLoadEnabledRegisters) {
+  Package package(TestBaseName());
+
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb(TestBaseName(), &package);
+  BValue a = bb.InputPort("a", u32);
+  BValue b = bb.InputPort("b", u32);
+  BValue en = bb.InputPort("en", package.GetBitsType(1));
+
+  BValue p0_a = bb.InsertRegister("p0_a", a, /*load_enable=*/en);
+  BValue p0_b = bb.InsertRegister("p0_b", b, /*load_enable=*/en);
+  BValue p1_sum = bb.InsertRegister("p1_sum", bb.And(p0_a, p0_b));
+
+  bb.OutputPort("sum", p1_sum);
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string verilog,
+      GenerateVerilog(block, codegen_options().clock_gate_format(
+                                 "my_clock_gate {name} (.clk({clock}), "
+                                 ".en({enable}), .gclk({gated_clock}))")));
+  // The two registers with the load enable share a single gating cell and are
+  // assigned unconditionally on the gated clock.
+  EXPECT_THAT(verilog,
+              HasSubstr("my_clock_gate en_gated_clk_gate (.clk(clk), "
+                        ".en(en), .gclk(en_gated_clk));"));
+  EXPECT_THAT(verilog, HasSubstr("posedge en_gated_clk"));
+  EXPECT_THAT(verilog, HasSubstr("p0_a <= a;"));
+  EXPECT_THAT(verilog, HasSubstr("p0_b <= b;"));
+  EXPECT_THAT(verilog, HasSubstr("p1_sum <= and_"));
+  EXPECT_THAT(verilog, Not(HasSubstr(" ? ")));
+
+  EXPECT_THAT(GenerateVerilog(block, codegen_options().clock_gate_format(
+                                         "my_clock_gate {foo}")),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid placeholder {foo} in clock gate "
+                                 "format string")));
+}
+
 TEST_P(BlockGeneratorTest, Accumulator) {
   Package package(TestBaseName());
 
@@ -14,15 +14,24 @@
 
 #include "xls/codegen/block_metrics.h"
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/codegen/xls_metrics.pb.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
 #include "xls/ir/node_iterator.h"
+#include "re2/re2.h"
 
 namespace xls::verilog {
 namespace {
 
+// The number of buckets in the histogram of register-to-register path delays.
+constexpr int64_t kDelayHistogramBucketCount = 8;
+
 int64_t GenerateFlopCount(Block* block) {
   int64_t count = 0;
 
@@ -34,6 +43,22 @@ int64_t GenerateFlopCount(Block* block) {
   return count;
 }
 
+// Returns the number of register bits which are only loaded when their load
+// enable is asserted. These are the candidates for clock gating.
+absl::StatusOr<int64_t> GenerateEnabledFlopCount(Block* block) {
+  int64_t count = 0;
+
+  for (Register* reg : block->GetRegisters()) {
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                         block->GetRegisterWrite(reg));
+    if (reg_write->load_enable().has_value()) {
+      count += reg->type()->GetFlatBitCount();
+    }
+  }
+
+  return count;
+}
+
 // Returns true if there is a combinational feedthrough path from an input port
 // to an output port.
 bool HasFeedthroughPass(Block* block) {
@@ -58,6 +83,38 @@ bool HasFeedthroughPass(Block* block) {
   return false;
 }
 
+// Returns the stage of the given pipeline register as encoded in its name by
+// PipelineSignalName, or std::nullopt if the register is not a pipeline
+// register.
+std::optional<int64_t> GetPipelineRegisterStage(Register* reg) {
+  int64_t stage;
+  if (RE2::PartialMatch(reg->name(), R"(^p(\d+)_)", &stage)) {
+    return stage;
+  }
+  return std::nullopt;
+}
+
+// Adds a histogram of the given register-to-register path delays to `proto`.
+void SetRegToRegDelayHistogram(absl::Span<const int64_t> delays,
+                               BlockMetricsProto* proto) {
+  if (delays.empty()) {
+    return;
+  }
+  int64_t max_delay = *std::max_element(delays.begin(), delays.end());
+  int64_t bucket_width = max_delay / kDelayHistogramBucketCount + 1;
+  std::vector<int64_t> counts(kDelayHistogramBucketCount, 0);
+  for (int64_t delay : delays) {
+    ++counts[delay / bucket_width];
+  }
+  for (int64_t i = 0; i < kDelayHistogramBucketCount; ++i) {
+    DelayHistogramBucketProto* bucket =
+        proto->add_reg_to_reg_delay_histogram();
+    bucket->set_lower_bound_ps(i * bucket_width);
+    bucket->set_upper_bound_ps((i + 1) * bucket_width);
+    bucket->set_count(counts[i]);
+  }
+}
+
 // Sets the delay fields of `proto` based on analysis of `block`.
 absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
                             BlockMetricsProto* proto) {
@@ -72,6 +129,11 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
   std::optional<int64_t> max_reg_to_output_delay;
   std::optional<int64_t> max_feedthrough_path_delay;
 
+  // Maximum delay of the paths to the pipeline registers of each stage.
+  std::map<int64_t, int64_t> stage_delays;
+  // Maximum delay of the register-to-register paths to each register.
+  std::vector<int64_t> reg_to_reg_delays;
+
   for (Node* node : TopoSort(block)) {
     if (node->Is<InputPort>()) {
       input_delay_map[node] = 0;
@@ -134,16 +196,32 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
       if (node->As<RegisterWrite>()->load_enable().has_value()) {
         operands.push_back(node->As<RegisterWrite>()->load_enable().value());
       }
+      std::optional<int64_t> to_reg_delay;
+      std::optional<int64_t> reg_to_reg_delay;
       for (Node* operand : operands) {
         if (input_delay_map.contains(operand)) {
           max_input_to_reg_delay =
               optional_max(input_delay_map.at(operand), max_input_to_reg_delay);
+          to_reg_delay =
+              optional_max(input_delay_map.at(operand), to_reg_delay);
         }
         if (reg_delay_map.contains(operand)) {
           max_reg_to_reg_delay =
               optional_max(reg_delay_map.at(operand), max_reg_to_reg_delay);
+          to_reg_delay = optional_max(reg_delay_map.at(operand), to_reg_delay);
+          reg_to_reg_delay =
+              optional_max(reg_delay_map.at(operand), reg_to_reg_delay);
         }
       }
+      if (reg_to_reg_delay.has_value()) {
+        reg_to_reg_delays.push_back(reg_to_reg_delay.value());
+      }
+      std::optional<int64_t> stage =
+          GetPipelineRegisterStage(node->As<RegisterWrite>()->GetRegister());
+      if (stage.has_value() && to_reg_delay.has_value()) {
+        stage_delays[stage.value()] =
+            std::max(stage_delays[stage.value()], to_reg_delay.value());
+      }
       continue;
     }
   }
@@ -161,6 +239,13 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
     proto->set_max_feedthrough_path_delay_ps(
         max_feedthrough_path_delay.value());
   }
+  for (PipelineStageMetricsProto& stage : *proto->mutable_pipeline_stages()) {
+    auto it = stage_delays.find(stage.stage());
+    if (it != stage_delays.end()) {
+      stage.set_max_delay_ps(it->second);
+    }
+  }
+  SetRegToRegDelayHistogram(reg_to_reg_delays, proto);
 
   return absl::OkStatus();
 }
@@ -318,6 +403,36 @@ absl::Status GenerateBomEntry(Node* node, BomEntryProto* proto) {
   return absl::OkStatus();
 }
 
+// Adds the per-stage flop counts of the pipeline registers of `block` to
+// `proto`. The delays of the stages are set by SetDelayFields.
+void GeneratePipelineStages(Block* block, BlockMetricsProto* proto) {
+  std::map<int64_t, int64_t> stage_flop_counts;
+  for (Register* reg : block->GetRegisters()) {
+    if (std::optional<int64_t> stage = GetPipelineRegisterStage(reg)) {
+      stage_flop_counts[stage.value()] += reg->type()->GetFlatBitCount();
+    }
+  }
+  for (const auto& [stage, flop_count] : stage_flop_counts) {
+    PipelineStageMetricsProto* stage_proto = proto->add_pipeline_stages();
+    stage_proto->set_stage(stage);
+    stage_proto->set_flop_count(flop_count);
+  }
+}
+
+// Returns the sum of the estimated areas of the operations in `block`.
+// Operations which the area model does not characterize are not counted.
+int64_t GenerateEstimatedArea(Block* block,
+                              const AreaEstimator& area_estimator) {
+  int64_t area = 0;
+  for (Node* node : block->nodes()) {
+    absl::StatusOr<int64_t> node_area = area_estimator.GetOperationArea(node);
+    if (node_area.ok()) {
+      area += node_area.value();
+    }
+  }
+  return area;
+}
+
 // Generate a bill of materials.
 absl::Status GenerateBom(Block* block, BlockMetricsProto* proto) {
   for (Node* node : block->nodes()) {
@@ -331,16 +446,25 @@ absl::Status GenerateBom(Block* block, BlockMetricsProto* proto) {
 }  // namespace
 
 absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
-    Block* block, std::optional<const DelayEstimator*> delay_estimator) {
+    Block* block, std::optional<const DelayEstimator*> delay_estimator,
+    std::optional<const AreaEstimator*> area_estimator) {
   BlockMetricsProto proto;
   proto.set_flop_count(GenerateFlopCount(block));
+  XLS_ASSIGN_OR_RETURN(int64_t enabled_flop_count,
+                       GenerateEnabledFlopCount(block));
+  proto.set_enabled_flop_count(enabled_flop_count);
   proto.set_feedthrough_path_exists(HasFeedthroughPass(block));
+  GeneratePipelineStages(block, &proto);
 
   if (delay_estimator.has_value()) {
     proto.set_delay_model(delay_estimator.value()->name());
     XLS_RETURN_IF_ERROR(
         SetDelayFields(block, *delay_estimator.value(), &proto));
   }
+  if (area_estimator.has_value()) {
+    proto.set_estimated_area(
+        GenerateEstimatedArea(block, *area_estimator.value()));
+  }
 
   XLS_RETURN_IF_ERROR(GenerateBom(block, &proto));
 
@@ -17,18 +17,22 @@
 
 #include "absl/status/statusor.h"
 #include "xls/codegen/xls_metrics.pb.h"
+#include "xls/contrib/integrator/area_model/area_estimator.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
 
 namespace xls::verilog {
 
 // Collects and generate metrics related to the contents of the block.
-// (ex. flop count, number of operations, etc...).
+// (ex. flop count, number of operations, etc...). Path delays, including the
+// critical path of each pipeline stage, are only generated if a delay estimator
+// is given and the estimated area only if an area estimator is given.
 //
 // TODO(tedhong): 2022-01-28 Add a class around the proto.
 absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
     Block* block,
-    std::optional<const DelayEstimator*> delay_estimator = std::nullopt);
+    std::optional<const DelayEstimator*> delay_estimator = std::nullopt,
+    std::optional<const AreaEstimator*> area_estimator = std::nullopt);
 
 }  // namespace xls::verilog
 
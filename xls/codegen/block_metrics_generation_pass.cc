@@ -30,8 +30,12 @@ absl::StatusOr<bool> BlockMetricsGenerationPass::RunInternal(
         "signature generation.");
   }
 
+  std::optional<const DelayEstimator*> delay_estimator;
+  if (options.delay_estimator != nullptr) {
+    delay_estimator = options.delay_estimator;
+  }
   XLS_ASSIGN_OR_RETURN(BlockMetricsProto block_metrics,
-                       GenerateBlockMetrics(unit->block));
+                       GenerateBlockMetrics(unit->block, delay_estimator));
   XLS_RETURN_IF_ERROR(unit->signature->ReplaceBlockMetrics(block_metrics));
 
   return true;
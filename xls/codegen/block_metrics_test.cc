@@ -19,6 +19,7 @@
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/xls_metrics.pb.h"
 #include "xls/common/status/matchers.h"
+#include "xls/contrib/integrator/area_model/area_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
 #include "xls/ir/block.h"
 #include "xls/ir/function_builder.h"
@@ -81,6 +82,24 @@ TEST(BlockMetricsGeneratorTest, PipelineRegisters) {
   EXPECT_EQ(proto.flop_count(), 64);
 }
 
+TEST(BlockMetricsGeneratorTest, LoadEnabledRegisters) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb("test_block", &package);
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue en = bb.InputPort("en", package.GetBitsType(1));
+  BValue a = bb.InputPort("a", u32);
+  BValue p0_a = bb.InsertRegister("p0_a", a, /*load_enable=*/en);
+  BValue p1_a = bb.InsertRegister("p1_a", p0_a);
+  bb.OutputPort("z", bb.InsertRegister("p2_a", p1_a, /*load_enable=*/en));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto proto,
+                           GenerateBlockMetrics(block));
+  EXPECT_EQ(proto.flop_count(), 96);
+  EXPECT_EQ(proto.enabled_flop_count(), 64);
+}
+
 TEST(BlockMetricsGeneratorTest, PipelineRegistersCount) {
   Package package("test");
 
@@ -424,6 +443,80 @@ TEST(BlockMetricsGeneratorTest, DelayMetrics) {
   }
 }
 
+TEST(BlockMetricsGeneratorTest, PipelineStageMetrics) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+
+  BlockBuilder bb("pipeline", &package);
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue x = bb.InputPort("x", u32);
+  BValue y = bb.InputPort("y", u32);
+  BValue p0_x = bb.InsertRegister("p0_x", bb.Not(x));
+  BValue p0_y = bb.InsertRegister("p0_y", y);
+  BValue p1_sum =
+      bb.InsertRegister("p1_sum", bb.Add(bb.Not(p0_x), bb.Not(p0_y)));
+  BValue state = bb.InsertRegister("state", p1_sum);
+  bb.OutputPort("out", bb.Add(p1_sum, state));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto proto,
+                           GenerateBlockMetrics(block));
+  ASSERT_EQ(proto.pipeline_stages_size(), 2);
+  EXPECT_EQ(proto.pipeline_stages(0).stage(), 0);
+  EXPECT_EQ(proto.pipeline_stages(0).flop_count(), 64);
+  EXPECT_FALSE(proto.pipeline_stages(0).has_max_delay_ps());
+  EXPECT_EQ(proto.pipeline_stages(1).stage(), 1);
+  EXPECT_EQ(proto.pipeline_stages(1).flop_count(), 32);
+  EXPECT_EQ(proto.reg_to_reg_delay_histogram_size(), 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(proto,
+                           GenerateBlockMetrics(block, delay_estimator));
+  ASSERT_EQ(proto.pipeline_stages_size(), 2);
+  EXPECT_EQ(proto.pipeline_stages(0).max_delay_ps(), 1);
+  EXPECT_EQ(proto.pipeline_stages(1).max_delay_ps(), 2);
+
+  // The register-to-register paths end at p1_sum with a delay of 2 and at
+  // state with a delay of 0.
+  EXPECT_EQ(proto.max_reg_to_reg_delay_ps(), 2);
+  ASSERT_GT(proto.reg_to_reg_delay_histogram_size(), 0);
+  int64_t total_count = 0;
+  for (const DelayHistogramBucketProto& bucket :
+       proto.reg_to_reg_delay_histogram()) {
+    EXPECT_LT(bucket.lower_bound_ps(), bucket.upper_bound_ps());
+    total_count += bucket.count();
+  }
+  EXPECT_EQ(total_count, 2);
+  EXPECT_EQ(proto.reg_to_reg_delay_histogram(0).lower_bound_ps(), 0);
+  EXPECT_EQ(proto.reg_to_reg_delay_histogram(0).count(), 1);
+  EXPECT_GT(proto.reg_to_reg_delay_histogram().rbegin()->upper_bound_ps(), 2);
+}
+
+TEST(BlockMetricsGeneratorTest, EstimatedArea) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+  // The unit model assigns an area of one to each characterized operation.
+  AreaEstimator area_estimator(delay_estimator);
+
+  BlockBuilder bb("area", &package);
+  BValue a = bb.InputPort("a", u32);
+  BValue b = bb.InputPort("b", u32);
+  bb.OutputPort("out", bb.Add(a, bb.Not(b)));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto proto,
+                           GenerateBlockMetrics(block));
+  EXPECT_FALSE(proto.has_estimated_area());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      proto, GenerateBlockMetrics(block, /*delay_estimator=*/std::nullopt,
+                                  &area_estimator));
+  EXPECT_EQ(proto.estimated_area(), 2);
+}
+
 }  // namespace
 }  // namespace verilog
 }  // namespace xls
@@ -0,0 +1,66 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/block_timing.h"
+
+#include <algorithm>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/node_iterator.h"
+
+namespace xls::verilog {
+
+absl::flat_hash_map<Node*, int64_t> GetNodeDelays(
+    Block* block, const DelayEstimator& delay_estimator) {
+  absl::flat_hash_map<Node*, int64_t> delays;
+  for (Node* node : block->nodes()) {
+    absl::StatusOr<int64_t> delay = delay_estimator.GetOperationDelayInPs(node);
+    delays[node] = delay.ok() ? delay.value() : 0;
+  }
+  return delays;
+}
+
+absl::flat_hash_map<Node*, int64_t> GetArrivalTimes(
+    Block* block, const absl::flat_hash_map<Node*, int64_t>& delays,
+    const absl::flat_hash_map<Node*, int64_t>& overrides) {
+  absl::flat_hash_map<Node*, int64_t> arrivals;
+  for (Node* node : TopoSort(block)) {
+    auto it = overrides.find(node);
+    if (it != overrides.end()) {
+      arrivals[node] = it->second;
+      continue;
+    }
+    int64_t operand_arrival = 0;
+    for (Node* operand : node->operands()) {
+      operand_arrival = std::max(operand_arrival, arrivals.at(operand));
+    }
+    arrivals[node] = delays.at(node) + operand_arrival;
+  }
+  return arrivals;
+}
+
+absl::flat_hash_map<Node*, int64_t> GetTailTimes(
+    Block* block, const absl::flat_hash_map<Node*, int64_t>& delays) {
+  absl::flat_hash_map<Node*, int64_t> tails;
+  for (Node* node : ReverseTopoSort(block)) {
+    int64_t tail = 0;
+    for (Node* user : node->users()) {
+      tail = std::max(tail, delays.at(user) + tails.at(user));
+    }
+    tails[node] = tail;
+  }
+  return tails;
+}
+
+}  // namespace xls::verilog
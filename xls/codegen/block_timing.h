@@ -0,0 +1,46 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_BLOCK_TIMING_H_
+#define XLS_CODEGEN_BLOCK_TIMING_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/block.h"
+
+namespace xls::verilog {
+
+// Returns the delay of each node in the block. Nodes which the estimator does
+// not model (e.g., ports and registers) are given a delay of zero.
+absl::flat_hash_map<Node*, int64_t> GetNodeDelays(
+    Block* block, const DelayEstimator& delay_estimator);
+
+// Returns the arrival time of each node in the block: the delay of the longest
+// combinational path ending at (and including) the node. Register reads and
+// input ports start paths. Nodes in `overrides` are given the overriding
+// arrival time instead.
+absl::flat_hash_map<Node*, int64_t> GetArrivalTimes(
+    Block* block, const absl::flat_hash_map<Node*, int64_t>& delays,
+    const absl::flat_hash_map<Node*, int64_t>& overrides = {});
+
+// Returns the delay of the longest combinational path which starts after each
+// node in the block.
+absl::flat_hash_map<Node*, int64_t> GetTailTimes(
+    Block* block, const absl::flat_hash_map<Node*, int64_t>& delays);
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_BLOCK_TIMING_H_
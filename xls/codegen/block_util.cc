@@ -0,0 +1,30 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/block_util.h"
+
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/nodes.h"
+
+namespace xls::verilog {
+
+absl::Status RemoveRegisterAndAccesses(Block* block, Register* reg) {
+  XLS_ASSIGN_OR_RETURN(RegisterRead * read, block->GetRegisterRead(reg));
+  XLS_ASSIGN_OR_RETURN(RegisterWrite * write, block->GetRegisterWrite(reg));
+  XLS_RETURN_IF_ERROR(block->RemoveNode(read));
+  XLS_RETURN_IF_ERROR(block->RemoveNode(write));
+  return block->RemoveRegister(reg);
+}
+
+}  // namespace xls::verilog
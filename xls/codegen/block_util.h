@@ -0,0 +1,30 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_BLOCK_UTIL_H_
+#define XLS_CODEGEN_BLOCK_UTIL_H_
+
+#include "absl/status/status.h"
+#include "xls/ir/block.h"
+#include "xls/ir/register.h"
+
+namespace xls::verilog {
+
+// Removes the given register from the block along with its RegisterRead and
+// RegisterWrite. The read must have no users.
+absl::Status RemoveRegisterAndAccesses(Block* block, Register* reg);
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_BLOCK_UTIL_H_
@@ -0,0 +1,53 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/block_util.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+
+class BlockUtilTest : public IrTestBase {};
+
+TEST_F(BlockUtilTest, RemoveRegisterAndAccesses) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  bb.InsertRegister("a_reg", a);
+  bb.OutputPort("out", bb.InsertRegister("b_reg", a));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Register * a_reg, block->GetRegister("a_reg"));
+  XLS_ASSERT_OK_AND_ASSIGN(Register * b_reg, block->GetRegister("b_reg"));
+  int64_t node_count = block->node_count();
+
+  XLS_ASSERT_OK(RemoveRegisterAndAccesses(block, a_reg));
+  EXPECT_THAT(block->GetRegisters(), ElementsAre(b_reg));
+  EXPECT_EQ(block->node_count(), node_count - 2);
+
+  // The read of b_reg is used by the output port.
+  EXPECT_THAT(RemoveRegisterAndAccesses(block, b_reg),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+}  // namespace
+}  // namespace xls::verilog
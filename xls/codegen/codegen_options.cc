@@ -49,7 +49,13 @@ CodegenOptions::CodegenOptions(const CodegenOptions& options)
       streaming_channel_data_suffix_(options.streaming_channel_data_suffix_),
       streaming_channel_ready_suffix_(options.streaming_channel_ready_suffix_),
       streaming_channel_valid_suffix_(options.streaming_channel_valid_suffix_),
-      array_index_bounds_checking_(options.array_index_bounds_checking_) {
+      array_index_bounds_checking_(options.array_index_bounds_checking_),
+      emit_thread_count_(options.emit_thread_count_),
+      sat_io_analysis_(options.sat_io_analysis_),
+      retime_registers_(options.retime_registers_),
+      share_resources_(options.share_resources_),
+      clock_gate_format_(options.clock_gate_format_),
+      memory_lookups_(options.memory_lookups_) {
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
   }
@@ -75,6 +81,12 @@ CodegenOptions& CodegenOptions::operator=(const CodegenOptions& options) {
   streaming_channel_ready_suffix_ = options.streaming_channel_ready_suffix_;
   streaming_channel_valid_suffix_ = options.streaming_channel_valid_suffix_;
   array_index_bounds_checking_ = options.array_index_bounds_checking_;
+  emit_thread_count_ = options.emit_thread_count_;
+  sat_io_analysis_ = options.sat_io_analysis_;
+  retime_registers_ = options.retime_registers_;
+  share_resources_ = options.share_resources_;
+  clock_gate_format_ = options.clock_gate_format_;
+  memory_lookups_ = options.memory_lookups_;
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
   }
@@ -222,4 +234,35 @@ CodegenOptions& CodegenOptions::array_index_bounds_checking(bool value) {
   return *this;
 }
 
+CodegenOptions& CodegenOptions::emit_thread_count(int64_t value) {
+  emit_thread_count_ = value;
+  return *this;
+}
+
+CodegenOptions& CodegenOptions::sat_io_analysis(bool value) {
+  sat_io_analysis_ = value;
+  return *this;
+}
+
+CodegenOptions& CodegenOptions::retime_registers(bool value) {
+  retime_registers_ = value;
+  return *this;
+}
+
+CodegenOptions& CodegenOptions::share_resources(bool value) {
+  share_resources_ = value;
+  return *this;
+}
+
+CodegenOptions& CodegenOptions::clock_gate_format(std::string_view format) {
+  clock_gate_format_ = format;
+  return *this;
+}
+
+CodegenOptions& CodegenOptions::memory_lookups(
+    const MemoryLookupConfig& config) {
+  memory_lookups_ = config;
+  return *this;
+}
+
 }  // namespace xls::verilog
@@ -21,6 +21,7 @@
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/codegen/op_override.h"
 #include "xls/ir/op.h"
+#include "xls/scheduling/scheduling_options.h"
 
 namespace xls::verilog {
 
@@ -204,6 +205,52 @@ class CodegenOptions {
     return array_index_bounds_checking_;
   }
 
+  // The number of threads used to emit the text of the generated Verilog. The
+  // sections of each module (e.g., the pipeline stages) are emitted
+  // concurrently. The generated Verilog does not depend on this value.
+  CodegenOptions& emit_thread_count(int64_t value);
+  int64_t emit_thread_count() const { return emit_thread_count_; }
+
+  // Whether to prove the mutual exclusivity of streaming outputs by random
+  // simulation and SAT rather than with BDDs. The BDD analysis can blow up on
+  // procs with wide predicate logic.
+  CodegenOptions& sat_io_analysis(bool value);
+  bool sat_io_analysis() const { return sat_io_analysis_; }
+
+  // Whether to retime the pipeline registers of the block across
+  // combinational logic to shorten the critical path. Requires a delay
+  // estimator to be given to the codegen pass pipeline.
+  CodegenOptions& retime_registers(bool value);
+  bool retime_registers() const { return retime_registers_; }
+
+  // Whether to share the hardware of expensive operations whose values are
+  // never needed in the same cycle.
+  CodegenOptions& share_resources(bool value);
+  bool share_resources() const { return share_resources_; }
+
+  // Format string for instantiating a clock gating cell. If set, registers
+  // without a reset which have a load enable are clocked by a gated clock,
+  // one gating cell per distinct load enable, instead of reloading their
+  // value when the enable is not asserted. Supported placeholders are {name}
+  // (instance name), {clock}, {enable} and {gated_clock}. Example:
+  //
+  //   my_clock_gate {name} (.clk({clock}), .en({enable}), .gclk({gated_clock}))
+  CodegenOptions& clock_gate_format(std::string_view format);
+  std::optional<std::string_view> clock_gate_format() const {
+    return clock_gate_format_;
+  }
+
+  // Implement the lookups into literal tables described by `config` with
+  // read-only memories. Each lookup whose result passes through
+  // `config.read_latency` pipeline registers is replaced by an instance of a
+  // separately generated memory module with a registered output, which may be
+  // swapped for a memory macro. The schedule should be generated with the same
+  // configuration (see SchedulingOptions::memory_lookups).
+  CodegenOptions& memory_lookups(const MemoryLookupConfig& config);
+  std::optional<MemoryLookupConfig> memory_lookups() const {
+    return memory_lookups_;
+  }
+
  private:
   std::optional<std::string> entry_;
   std::optional<std::string> module_name_;
@@ -225,6 +272,12 @@ class CodegenOptions {
   std::string streaming_channel_ready_suffix_ = "_rdy";
   std::string streaming_channel_valid_suffix_ = "_vld";
   bool array_index_bounds_checking_ = true;
+  int64_t emit_thread_count_ = 1;
+  bool sat_io_analysis_ = false;
+  bool retime_registers_ = false;
+  bool share_resources_ = false;
+  std::optional<std::string> clock_gate_format_;
+  std::optional<MemoryLookupConfig> memory_lookups_;
 };
 
 }  // namespace xls::verilog
@@ -18,6 +18,7 @@
 #include "absl/types/optional.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/module_signature.h"
+#include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
 #include "xls/ir/package.h"
 #include "xls/passes/pass_base.h"
@@ -36,6 +37,9 @@ struct CodegenPassOptions : public PassOptions {
   // Optional schedule. If given, a feedforward pipeline is generated based on
   // the schedule.
   std::optional<PipelineSchedule> schedule;
+
+  // Optional delay estimator used by passes which are guided by timing.
+  const DelayEstimator* delay_estimator = nullptr;
 };
 
 // Data structure operated on by codegen passes. Contains the IR and associated
@@ -60,6 +64,7 @@ struct CodegenPassUnit {
   // These methods are required by CompoundPassBase.
   std::string DumpIr() const;
   const std::string& name() const { return block->name(); }
+  int64_t GetNodeCount() const { return package->GetNodeCount(); }
 };
 
 using CodegenPass = PassBase<CodegenPassUnit, CodegenPassOptions, PassResults>;
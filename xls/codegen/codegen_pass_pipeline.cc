@@ -20,9 +20,12 @@
 #include "xls/codegen/block_metrics_generation_pass.h"
 #include "xls/codegen/codegen_checker.h"
 #include "xls/codegen/codegen_wrapper_pass.h"
+#include "xls/codegen/memory_lowering_pass.h"
 #include "xls/codegen/mulp_combining_pass.h"
 #include "xls/codegen/port_legalization_pass.h"
 #include "xls/codegen/register_legalization_pass.h"
+#include "xls/codegen/register_retiming_pass.h"
+#include "xls/codegen/resource_sharing_pass.h"
 #include "xls/codegen/signature_generation_pass.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/identity_removal_pass.h"
@@ -51,10 +54,20 @@ std::unique_ptr<CodegenCompoundPass> CreateCodegenPassPipeline() {
   // Remove zero-width registers.
   top->Add<RegisterLegalizationPass>();
 
+  // Optionally replace lookups into large literal tables with memories.
+  top->Add<MemoryLoweringPass>();
+
   // Eliminate no-longer-needed partial product operations by turning them into
   // normal multiplies.
   top->Add<MulpCombiningPass>();
 
+  // Optionally share expensive operations on mutually exclusive paths.
+  top->Add<ResourceSharingPass>();
+
+  // Optionally move pipeline registers across combinational logic to shorten
+  // the critical path.
+  top->Add<RegisterRetimingPass>();
+
   // Remove any identity ops which might have been added earlier in the
   // pipeline.
   top->Add<CodegenWrapperPass>(std::make_unique<IdentityRemovalPass>());
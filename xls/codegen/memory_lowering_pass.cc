@@ -0,0 +1,159 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/memory_lowering_pass.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/codegen/block_util.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/node_util.h"
+#include "xls/ir/nodes.h"
+
+namespace xls::verilog {
+namespace {
+
+// Returns the writes of the chain of `read_latency` registers through which
+// the result of `lookup` passes before it is used, or std::nullopt if there is
+// no such chain.
+absl::StatusOr<std::optional<std::vector<RegisterWrite*>>> GetRegisterChain(
+    Block* block, Node* lookup, int64_t read_latency) {
+  std::vector<RegisterWrite*> chain;
+  Node* value = lookup;
+  for (int64_t i = 0; i < read_latency; ++i) {
+    if (value->users().size() != 1 ||
+        !value->users().front()->Is<RegisterWrite>()) {
+      return std::nullopt;
+    }
+    RegisterWrite* write = value->users().front()->As<RegisterWrite>();
+    if (write->data() != value || write->load_enable() == value ||
+        write->GetRegister()->reset().has_value()) {
+      return std::nullopt;
+    }
+    chain.push_back(write);
+    XLS_ASSIGN_OR_RETURN(value, block->GetRegisterRead(write->GetRegister()));
+  }
+  return chain;
+}
+
+// Builds the block modeling the memory which implements `lookup` followed by
+// the registers written by `chain`.
+absl::StatusOr<Block*> BuildMemoryBlock(
+    Block* block, ArrayIndex* lookup, absl::Span<RegisterWrite* const> chain) {
+  Package* package = block->package();
+  BlockBuilder bb(
+      absl::StrCat(block->name(), "_", lookup->GetName(), "_memory"), package);
+  XLS_RETURN_IF_ERROR(bb.block()->AddClockPort("clk"));
+  BValue addr = bb.InputPort("addr", lookup->indices().front()->GetType());
+  BValue data = bb.ArrayIndex(
+      bb.Literal(lookup->array()->As<xls::Literal>()->value()), {addr});
+  for (int64_t i = 0; i < chain.size(); ++i) {
+    std::optional<BValue> load_enable;
+    if (chain[i]->load_enable().has_value()) {
+      load_enable =
+          bb.InputPort(absl::StrCat("en_", i), package->GetBitsType(1));
+    }
+    data = bb.InsertRegister(absl::StrCat("data_", i), data, load_enable);
+  }
+  bb.OutputPort("data", data);
+  return bb.Build();
+}
+
+absl::Status LowerToMemory(Block* block, ArrayIndex* lookup,
+                           absl::Span<RegisterWrite* const> chain) {
+  XLS_ASSIGN_OR_RETURN(Block * memory, BuildMemoryBlock(block, lookup, chain));
+  XLS_ASSIGN_OR_RETURN(
+      BlockInstantiation * instantiation,
+      block->AddBlockInstantiation(absl::StrCat(lookup->GetName(), "_memory"),
+                                   memory));
+  XLS_RETURN_IF_ERROR(block
+                          ->MakeNode<InstantiationInput>(
+                              lookup->loc(), lookup->indices().front(),
+                              instantiation, "addr")
+                          .status());
+  for (int64_t i = 0; i < chain.size(); ++i) {
+    if (chain[i]->load_enable().has_value()) {
+      XLS_RETURN_IF_ERROR(
+          block
+              ->MakeNode<InstantiationInput>(
+                  lookup->loc(), chain[i]->load_enable().value(),
+                  instantiation, absl::StrCat("en_", i))
+              .status());
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(InstantiationOutput * data,
+                       block->MakeNode<InstantiationOutput>(
+                           lookup->loc(), instantiation, "data"));
+  XLS_ASSIGN_OR_RETURN(RegisterRead * last_read,
+                       block->GetRegisterRead(chain.back()->GetRegister()));
+  XLS_RETURN_IF_ERROR(last_read->ReplaceUsesWith(data));
+
+  // Remove the registers from the last to the first so each is unused when it
+  // is removed.
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    XLS_RETURN_IF_ERROR(RemoveRegisterAndAccesses(block, (*it)->GetRegister()));
+  }
+  return block->RemoveNode(lookup);
+}
+
+}  // namespace
+
+absl::StatusOr<bool> MemoryLoweringPass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    PassResults* results) const {
+  std::optional<MemoryLookupConfig> config =
+      options.codegen_options.memory_lookups();
+  if (!config.has_value() || config->read_latency < 1) {
+    return false;
+  }
+  Block* block = unit->block;
+  if (!block->GetClockPort().has_value()) {
+    return false;
+  }
+
+  std::vector<ArrayIndex*> lookups;
+  for (Node* node : block->nodes()) {
+    if (IsLiteralTableLookup(node, config->min_table_bits)) {
+      lookups.push_back(node->As<ArrayIndex>());
+    }
+  }
+
+  bool changed = false;
+  for (ArrayIndex* lookup : lookups) {
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<std::vector<RegisterWrite*>> chain,
+        GetRegisterChain(block, lookup, config->read_latency));
+    if (!chain.has_value()) {
+      XLS_VLOG(2) << absl::StreamFormat(
+          "Not lowering %s to a memory: its result does not pass through %d "
+          "registers without a reset",
+          lookup->GetName(), config->read_latency);
+      continue;
+    }
+    XLS_VLOG(2) << absl::StreamFormat("Lowering %s to a memory",
+                                      lookup->GetName());
+    XLS_RETURN_IF_ERROR(LowerToMemory(block, lookup, *chain));
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace xls::verilog
@@ -0,0 +1,51 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_MEMORY_LOWERING_PASS_H_
+#define XLS_CODEGEN_MEMORY_LOWERING_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+
+namespace xls::verilog {
+
+// Replaces lookups into large literal tables with instances of read-only
+// memories, as configured by the memory_lookups codegen option. A lookup is
+// replaced if its result passes through a chain of `read_latency` registers
+// without a reset before it is used, which is the case in a pipeline scheduled
+// with the same option. The lookup and the chain of registers are moved into a
+// new block which is instantiated in place of them:
+//
+//   module <block>_<lookup>_memory(
+//     input wire clk,
+//     input wire [A-1:0] addr,
+//     input wire en_0, ..., // Only if the pipeline registers have enables.
+//     output wire [D-1:0] data
+//   );
+//
+// The memory block models the memory behaviorally and may be replaced with a
+// memory macro of the same interface in the generated Verilog.
+class MemoryLoweringPass : public CodegenPass {
+ public:
+  MemoryLoweringPass() : CodegenPass("memory_lowering", "Memory lowering") {}
+  ~MemoryLoweringPass() override {}
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_MEMORY_LOWERING_PASS_H_
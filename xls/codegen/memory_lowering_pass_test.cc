@@ -0,0 +1,116 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/memory_lowering_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/codegen/block_generator.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::HasSubstr;
+
+class MemoryLoweringPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Block* block, int64_t read_latency) {
+    PassResults results;
+    CodegenPassOptions options;
+    options.codegen_options.memory_lookups(MemoryLookupConfig{
+        .min_table_bits = 32, .read_latency = read_latency});
+    CodegenPassUnit unit(block->package(), block);
+    return MemoryLoweringPass().Run(&unit, options, &results);
+  }
+
+  // Builds a block which looks up `addr` in a table of 4 bytes and passes the
+  // result through `stages` registers, enabled by `en` if `load_enable` is
+  // true.
+  absl::StatusOr<Block*> MakeBlock(Package* p, int64_t stages,
+                                   bool load_enable) {
+    BlockBuilder bb(TestName(), p);
+    XLS_RETURN_IF_ERROR(bb.block()->AddClockPort("clk"));
+    BValue addr = bb.InputPort("addr", p->GetBitsType(2));
+    std::optional<BValue> en;
+    if (load_enable) {
+      en = bb.InputPort("en", p->GetBitsType(1));
+    }
+    XLS_ASSIGN_OR_RETURN(Value table,
+                         Value::UBitsArray({1, 2, 3, 4}, /*bit_count=*/8));
+    BValue data =
+        bb.ArrayIndex(bb.Literal(table), {addr}, SourceInfo(), "lookup");
+    for (int64_t i = 0; i < stages; ++i) {
+      data = bb.InsertRegister(absl::StrCat("p", i), data, en);
+    }
+    bb.OutputPort("out", data);
+    return bb.Build();
+  }
+};
+
+TEST_F(MemoryLoweringPassTest, LookupIntoMemory) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                           MakeBlock(p.get(), /*stages=*/3,
+                                     /*load_enable=*/false));
+
+  EXPECT_THAT(Run(block, /*read_latency=*/2), IsOkAndHolds(true));
+  ASSERT_EQ(block->GetInstantiations().size(), 1);
+  Block* memory = down_cast<BlockInstantiation*>(block->GetInstantiations()[0])
+                      ->instantiated_block();
+  EXPECT_EQ(memory->GetRegisters().size(), 2);
+  EXPECT_EQ(block->GetRegisters().size(), 1);
+  for (Node* node : block->nodes()) {
+    EXPECT_FALSE(node->Is<ArrayIndex>());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateVerilog(block, CodegenOptions()));
+  EXPECT_THAT(verilog, HasSubstr(absl::StrCat("module ", memory->name())));
+  EXPECT_THAT(verilog, HasSubstr(".clk(clk)"));
+  EXPECT_THAT(verilog, HasSubstr(".addr(addr)"));
+
+  EXPECT_THAT(Run(block, /*read_latency=*/2), IsOkAndHolds(false));
+}
+
+TEST_F(MemoryLoweringPassTest, LoadEnabledRegisters) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                           MakeBlock(p.get(), /*stages=*/1,
+                                     /*load_enable=*/true));
+
+  EXPECT_THAT(Run(block, /*read_latency=*/1), IsOkAndHolds(true));
+  ASSERT_EQ(block->GetInstantiations().size(), 1);
+  Block* memory = down_cast<BlockInstantiation*>(block->GetInstantiations()[0])
+                      ->instantiated_block();
+  XLS_EXPECT_OK(memory->GetInputPort("en_0").status());
+  EXPECT_TRUE(block->GetRegisters().empty());
+}
+
+TEST_F(MemoryLoweringPassTest, TooFewRegisters) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                           MakeBlock(p.get(), /*stages=*/1,
+                                     /*load_enable=*/false));
+
+  EXPECT_THAT(Run(block, /*read_latency=*/2), IsOkAndHolds(false));
+  EXPECT_TRUE(block->GetInstantiations().empty());
+}
+
+}  // namespace
+}  // namespace xls::verilog
@@ -17,9 +17,11 @@
 #include <algorithm>
 #include <memory>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
@@ -1062,9 +1064,85 @@ absl::Status ModuleBuilder::AssignRegisters(
     }
   }
 
+  if (!options_.clock_gate_format().has_value() ||
+      registers.front().reset_value != nullptr) {
+    return AssignRegistersOnClock(registers, clk_);
+  }
+
+  // Registers sharing a load enable are clocked by a common gated clock and
+  // are assigned unconditionally. Registers are grouped in order of first
+  // appearance of their load enable to keep the emitted Verilog stable.
+  std::vector<Register> ungated_registers;
+  std::vector<Expression*> load_enables;
+  absl::flat_hash_map<Expression*, std::vector<Register>> gated_registers;
+  for (const Register& reg : registers) {
+    if (reg.load_enable == nullptr) {
+      ungated_registers.push_back(reg);
+      continue;
+    }
+    auto [it, inserted] = gated_registers.try_emplace(reg.load_enable);
+    if (inserted) {
+      load_enables.push_back(reg.load_enable);
+    }
+    Register gated_reg = reg;
+    gated_reg.load_enable = nullptr;
+    it->second.push_back(gated_reg);
+  }
+  XLS_RETURN_IF_ERROR(AssignRegistersOnClock(ungated_registers, clk_));
+  for (Expression* load_enable : load_enables) {
+    XLS_ASSIGN_OR_RETURN(LogicRef * gated_clock,
+                         DeclareGatedClock(load_enable));
+    XLS_RETURN_IF_ERROR(AssignRegistersOnClock(
+        gated_registers.at(load_enable), gated_clock));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<LogicRef*> ModuleBuilder::DeclareGatedClock(
+    Expression* enable) {
+  std::string name;
+  if (auto* enable_ref = dynamic_cast<LogicRef*>(enable)) {
+    name = absl::StrCat(enable_ref->GetName(), "_gated_clk");
+  } else {
+    name = absl::StrCat("gated_clk_", gated_clock_count_++);
+  }
+  LogicRef* gated_clock = DeclareVariable(name, /*bit_count=*/1);
+
+  absl::flat_hash_map<std::string, std::string> placeholders = {
+      {"name", absl::StrCat(name, "_gate")},
+      {"clock", clk_->GetName()},
+      {"enable", enable->Emit(nullptr)},
+      {"gated_clock", name}};
+  std::string_view format = options_.clock_gate_format().value();
+  RE2 re(R"({(\w+)})");
+  std::string placeholder;
+  std::string_view piece(format);
+  while (RE2::FindAndConsume(&piece, re, &placeholder)) {
+    if (!placeholders.contains(placeholder)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid placeholder {%s} in clock gate format string. Valid "
+          "placeholders: {clock}, {enable}, {gated_clock}, {name}",
+          placeholder));
+    }
+  }
+  std::string statement(format);
+  for (const auto& [key, value] : placeholders) {
+    absl::StrReplaceAll({{absl::StrCat("{", key, "}"), value}}, &statement);
+  }
+  assignment_section()->Add<InlineVerilogStatement>(SourceInfo(),
+                                                    statement + ";");
+  return gated_clock;
+}
+
+absl::Status ModuleBuilder::AssignRegistersOnClock(
+    absl::Span<const Register> registers, LogicRef* clock) {
+  if (registers.empty()) {
+    return absl::OkStatus();
+  }
+
   // Construct an always_ff block.
   std::vector<SensitivityListElement> sensitivity_list;
-  sensitivity_list.push_back(file_->Make<PosEdge>(SourceInfo(), clk_));
+  sensitivity_list.push_back(file_->Make<PosEdge>(SourceInfo(), clock));
   if (rst_.has_value()) {
     if (rst_->asynchronous) {
       if (rst_->active_low) {
@@ -172,7 +172,10 @@ class ModuleBuilder {
                                            int64_t bit_count, Expression* next,
                                            Expression* reset_value = nullptr);
 
-  // Construct an always block to assign values to the registers.
+  // Construct an always block to assign values to the registers. If the
+  // clock_gate_format codegen option is set, registers without a reset which
+  // have a load enable are instead assigned in always blocks clocked by gated
+  // clocks, one per distinct load enable.
   absl::Status AssignRegisters(absl::Span<const Register> registers);
 
   // For organization (not functionality) the module is divided into several
@@ -295,6 +298,16 @@ class ModuleBuilder {
       Expression* lhs, Expression* rhs, Type* xls_type, int64_t slice_start,
       std::function<void(Expression*, Expression*)> add_assignment);
 
+  // Constructs an always block clocked by `clock` which assigns values to the
+  // registers.
+  absl::Status AssignRegistersOnClock(absl::Span<const Register> registers,
+                                      LogicRef* clock);
+
+  // Declares a gated clock driven by a clock gating cell instantiated with the
+  // clock_gate_format codegen option. The gated clock pulses only on cycles in
+  // which `enable` is asserted.
+  absl::StatusOr<LogicRef*> DeclareGatedClock(Expression* enable);
+
   // Returns true if the node must be emitted as a function.
   bool MustEmitAsFunction(Node* node);
 
@@ -322,6 +335,7 @@ class ModuleBuilder {
   CodegenOptions options_;
 
   LogicRef* clk_ = nullptr;
+  int64_t gated_clock_count_ = 0;
   std::optional<Reset> rst_;
 
   Module* module_;
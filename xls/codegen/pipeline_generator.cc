@@ -40,7 +40,7 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
-    const CodegenOptions& options) {
+    const CodegenOptions& options, const DelayEstimator* delay_estimator) {
   XLS_VLOG(2) << "Generating pipelined module for module:";
   XLS_VLOG_LINES(2, module->DumpIr());
   XLS_VLOG_LINES(2, schedule.ToString());
@@ -50,6 +50,7 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
   CodegenPassOptions pass_options;
   pass_options.codegen_options = options;
   pass_options.schedule = schedule;
+  pass_options.delay_estimator = delay_estimator;
 
   XLS_RET_CHECK(module->IsProc() || module->IsFunction());
   // Convert to block and add in pipe stages according to schedule.
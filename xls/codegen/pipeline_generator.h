@@ -24,6 +24,7 @@
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/codegen/name_to_bit_count.h"
 #include "xls/codegen/vast.h"
+#include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
@@ -48,10 +49,12 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
 
 // Emits the given function or proc as a verilog module which follows the given
 // schedule. The module is pipelined with a latency and initiation interval
-// given in the signature.
+// given in the signature. `delay_estimator`, if given, is used by codegen passes
+// which are guided by timing such as register retiming.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
-    const CodegenOptions& options = BuildPipelineOptions());
+    const CodegenOptions& options = BuildPipelineOptions(),
+    const DelayEstimator* delay_estimator = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
@@ -0,0 +1,390 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/register_retiming_pass.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/codegen/block_timing.h"
+#include "xls/codegen/block_util.h"
+#include "xls/codegen/vast.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+#include "re2/re2.h"
+
+namespace xls::verilog {
+namespace {
+
+// The critical path of a block and the number of nodes whose arrival time is
+// the critical path. Timings are compared lexicographically so a move which
+// leaves the critical path unchanged but removes one of several critical paths
+// is still an improvement.
+using Timing = std::pair<int64_t, int64_t>;
+
+// Returns the timing of the block given the arrival times of its nodes,
+// ignoring the nodes in `excluded` and including the additional arrival times
+// in `extra`.
+Timing GetTiming(const absl::flat_hash_map<Node*, int64_t>& arrivals,
+                 const absl::flat_hash_set<Node*>& excluded,
+                 absl::Span<const int64_t> extra) {
+  Timing timing = {0, 0};
+  auto add = [&](int64_t arrival) {
+    if (arrival > timing.first) {
+      timing = {arrival, 1};
+    } else if (arrival == timing.first) {
+      ++timing.second;
+    }
+  };
+  for (const auto& [node, arrival] : arrivals) {
+    if (!excluded.contains(node)) {
+      add(arrival);
+    }
+  }
+  for (int64_t arrival : extra) {
+    add(arrival);
+  }
+  return timing;
+}
+
+// Returns whether the given register may be moved. Registers with a reset
+// carry control state (valid bits, proc state, reset data path) and registers
+// at the ports of the block are input/output flops; both keep their place.
+bool IsRetimable(Block* block, Register* reg) {
+  if (reg->reset().has_value()) {
+    return false;
+  }
+  absl::StatusOr<RegisterRead*> read = block->GetRegisterRead(reg);
+  absl::StatusOr<RegisterWrite*> write = block->GetRegisterWrite(reg);
+  if (!read.ok() || !write.ok()) {
+    return false;
+  }
+  if (write.value()->data()->Is<InputPort>()) {
+    return false;
+  }
+  for (Node* user : read.value()->users()) {
+    if (user->Is<OutputPort>()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns whether the given node may be moved across registers.
+bool IsMovable(Node* node, const absl::flat_hash_map<Node*, int64_t>& delays) {
+  return !OpIsSideEffecting(node->op()) && !node->Is<xls::Literal>() &&
+         delays.at(node) > 0;
+}
+
+// A register move across a single node.
+struct Move {
+  Node* node;
+  // Whether the registers feeding `node` are moved after it (`node` moves into
+  // the earlier stage) or the registers `node` feeds are moved before it
+  // (`node` moves into the later stage).
+  bool forward;
+  // The registers moved and their shared load enable.
+  std::vector<Register*> registers;
+  std::optional<Node*> load_enable;
+};
+
+// Returns the move of the registers feeding `node` to after it, if possible.
+// All non-literal operands of `node` must be reads of retimable registers with
+// the same load enable.
+std::optional<Move> GetForwardMove(Block* block, Node* node) {
+  Move move{node, /*forward=*/true, {}, std::nullopt};
+  for (Node* operand : node->operands()) {
+    if (operand->Is<xls::Literal>()) {
+      continue;
+    }
+    if (!operand->Is<RegisterRead>()) {
+      return std::nullopt;
+    }
+    Register* reg = operand->As<RegisterRead>()->GetRegister();
+    if (!IsRetimable(block, reg)) {
+      return std::nullopt;
+    }
+    RegisterWrite* write = block->GetRegisterWrite(reg).value();
+    if (write->data() == node) {
+      // Don't move registers in a loop through the node.
+      return std::nullopt;
+    }
+    std::optional<Node*> load_enable = write->load_enable();
+    if (!move.registers.empty() && load_enable != move.load_enable) {
+      return std::nullopt;
+    }
+    move.load_enable = load_enable;
+    if (std::find(move.registers.begin(), move.registers.end(), reg) ==
+        move.registers.end()) {
+      move.registers.push_back(reg);
+    }
+  }
+  if (move.registers.empty()) {
+    return std::nullopt;
+  }
+  return move;
+}
+
+// Returns the move of the registers fed by `node` to before it, if possible.
+// All users of `node` must be writes of retimable registers with the same load
+// enable which use `node` as data only.
+std::optional<Move> GetBackwardMove(Block* block, Node* node) {
+  Move move{node, /*forward=*/false, {}, std::nullopt};
+  if (node->users().empty()) {
+    return std::nullopt;
+  }
+  for (Node* user : node->users()) {
+    if (!user->Is<RegisterWrite>()) {
+      return std::nullopt;
+    }
+    RegisterWrite* write = user->As<RegisterWrite>();
+    if (write->data() != node || write->load_enable() == node) {
+      return std::nullopt;
+    }
+    if (!IsRetimable(block, write->GetRegister())) {
+      return std::nullopt;
+    }
+    if (!move.registers.empty() && write->load_enable() != move.load_enable) {
+      return std::nullopt;
+    }
+    move.load_enable = write->load_enable();
+    move.registers.push_back(write->GetRegister());
+  }
+  bool has_non_literal_operand = false;
+  for (Node* operand : node->operands()) {
+    if (operand->Is<RegisterRead>() &&
+        std::find(move.registers.begin(), move.registers.end(),
+                  operand->As<RegisterRead>()->GetRegister()) !=
+            move.registers.end()) {
+      // Don't move registers in a loop through the node.
+      return std::nullopt;
+    }
+    has_non_literal_operand |= !operand->Is<xls::Literal>();
+  }
+  if (!has_non_literal_operand) {
+    return std::nullopt;
+  }
+  return move;
+}
+
+// Returns the timing of the block after the given move. `arrivals` are the
+// arrival times of the nodes before the move.
+Timing TimingAfterMove(Block* block, const Move& move,
+                       const absl::flat_hash_map<Node*, int64_t>& delays,
+                       const absl::flat_hash_map<Node*, int64_t>& arrivals) {
+  // The new registers are assumed to have the same read and write delays as
+  // the registers they replace.
+  Node* node = move.node;
+  RegisterRead* old_read =
+      block->GetRegisterRead(move.registers.front()).value();
+  RegisterWrite* old_write =
+      block->GetRegisterWrite(move.registers.front()).value();
+  int64_t read_delay = delays.at(old_read);
+  int64_t write_delay = delays.at(old_write);
+
+  absl::flat_hash_map<Node*, int64_t> overrides;
+  absl::flat_hash_set<Node*> excluded;
+  std::vector<int64_t> extra;
+  if (move.forward) {
+    // The node is recomputed from the data of the registers feeding it, and
+    // its uses are replaced by the read of a new register holding that value.
+    int64_t operand_arrival = 0;
+    for (Node* operand : node->operands()) {
+      if (operand->Is<RegisterRead>()) {
+        Node* data = block
+                         ->GetRegisterWrite(
+                             operand->As<RegisterRead>()->GetRegister())
+                         .value()
+                         ->data();
+        operand_arrival = std::max(operand_arrival, arrivals.at(data));
+      }
+    }
+    int64_t early_arrival = delays.at(node) + operand_arrival;
+    extra.push_back(early_arrival);
+    extra.push_back(early_arrival + write_delay);
+    overrides[node] = read_delay;
+  } else {
+    // The operands of the node are written to new registers and the node is
+    // recomputed from their reads, replacing the reads of the registers it
+    // fed.
+    excluded.insert(node);
+    for (Node* operand : node->operands()) {
+      extra.push_back(arrivals.at(operand) + write_delay);
+    }
+    for (Register* reg : move.registers) {
+      overrides[block->GetRegisterRead(reg).value()] =
+          read_delay + delays.at(node);
+      excluded.insert(block->GetRegisterWrite(reg).value());
+    }
+  }
+  return GetTiming(GetArrivalTimes(block, delays, overrides), excluded, extra);
+}
+
+// Returns a name for a register holding the value of `node` which is unique
+// in the block. The name carries the pipeline stage prefix of `neighbor`, a
+// register at the same stage boundary, if it has one.
+std::string RetimedRegisterName(Block* block, Node* node, Register* neighbor) {
+  std::string prefix;
+  RE2::PartialMatch(neighbor->name(), R"(^(p\d+_))", &prefix);
+  std::string base =
+      absl::StrCat(prefix, SanitizeIdentifier(node->GetName()), "_retimed");
+  std::string name = base;
+  for (int64_t i = 1; block->GetRegister(name).ok(); ++i) {
+    name = absl::StrCat(base, "_", i);
+  }
+  return name;
+}
+
+// Adds a register holding `data` and returns its read.
+absl::StatusOr<Node*> AddRetimedRegister(Block* block, Node* data,
+                                         std::optional<Node*> load_enable,
+                                         Node* node, Register* neighbor) {
+  XLS_ASSIGN_OR_RETURN(
+      Register * reg,
+      block->AddRegister(RetimedRegisterName(block, node, neighbor),
+                         data->GetType()));
+  XLS_RETURN_IF_ERROR(block
+                          ->MakeNode<RegisterWrite>(
+                              /*loc=*/data->loc(), data, load_enable,
+                              /*reset=*/absl::nullopt, reg)
+                          .status());
+  return block->MakeNode<RegisterRead>(/*loc=*/data->loc(), reg);
+}
+
+absl::Status ApplyMove(Block* block, const Move& move) {
+  Node* node = move.node;
+  XLS_VLOG(3) << absl::StreamFormat(
+      "Moving %d register(s) %s across %s", move.registers.size(),
+      move.forward ? "forward" : "backward", node->GetName());
+  if (move.forward) {
+    std::vector<Node*> operands;
+    for (Node* operand : node->operands()) {
+      if (operand->Is<RegisterRead>()) {
+        XLS_ASSIGN_OR_RETURN(RegisterWrite * write,
+                             block->GetRegisterWrite(
+                                 operand->As<RegisterRead>()->GetRegister()));
+        operands.push_back(write->data());
+      } else {
+        operands.push_back(operand);
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(Node * early, node->Clone(operands));
+    XLS_ASSIGN_OR_RETURN(Node * read,
+                         AddRetimedRegister(block, early, move.load_enable,
+                                            node, move.registers.front()));
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(read));
+    XLS_RETURN_IF_ERROR(block->RemoveNode(node));
+    for (Register* reg : move.registers) {
+      XLS_ASSIGN_OR_RETURN(RegisterRead * old_read,
+                           block->GetRegisterRead(reg));
+      if (old_read->users().empty()) {
+        XLS_RETURN_IF_ERROR(RemoveRegisterAndAccesses(block, reg));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::flat_hash_map<Node*, Node*> operand_reads;
+  std::vector<Node*> operands;
+  for (Node* operand : node->operands()) {
+    if (operand->Is<xls::Literal>()) {
+      operands.push_back(operand);
+      continue;
+    }
+    if (!operand_reads.contains(operand)) {
+      XLS_ASSIGN_OR_RETURN(
+          operand_reads[operand],
+          AddRetimedRegister(block, operand, move.load_enable, operand,
+                             move.registers.front()));
+    }
+    operands.push_back(operand_reads.at(operand));
+  }
+  XLS_ASSIGN_OR_RETURN(Node * late, node->Clone(operands));
+  for (Register* reg : move.registers) {
+    XLS_ASSIGN_OR_RETURN(RegisterRead * old_read, block->GetRegisterRead(reg));
+    XLS_RETURN_IF_ERROR(old_read->ReplaceUsesWith(late));
+    XLS_RETURN_IF_ERROR(RemoveRegisterAndAccesses(block, reg));
+  }
+  return block->RemoveNode(node);
+}
+
+}  // namespace
+
+absl::StatusOr<bool> RegisterRetimingPass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    PassResults* results) const {
+  if (!options.codegen_options.retime_registers() ||
+      options.delay_estimator == nullptr) {
+    return false;
+  }
+  Block* block = unit->block;
+
+  bool changed = false;
+  // Each move strictly improves the timing so the loop terminates; the bound
+  // only limits the run time on very large blocks.
+  int64_t max_moves = block->node_count();
+  for (int64_t i = 0; i < max_moves; ++i) {
+    absl::flat_hash_map<Node*, int64_t> delays =
+        GetNodeDelays(block, *options.delay_estimator);
+    absl::flat_hash_map<Node*, int64_t> arrivals =
+        GetArrivalTimes(block, delays);
+    absl::flat_hash_map<Node*, int64_t> tails = GetTailTimes(block, delays);
+    Timing timing = GetTiming(arrivals, /*excluded=*/{}, /*extra=*/{});
+
+    // Only moves across nodes on a critical path can improve the timing.
+    std::optional<Move> best_move;
+    Timing best_timing = timing;
+    for (Node* node : block->nodes()) {
+      if (arrivals.at(node) + tails.at(node) != timing.first ||
+          !IsMovable(node, delays)) {
+        continue;
+      }
+      for (std::optional<Move> move :
+           {GetForwardMove(block, node), GetBackwardMove(block, node)}) {
+        if (!move.has_value()) {
+          continue;
+        }
+        Timing move_timing = TimingAfterMove(block, *move, delays, arrivals);
+        if (move_timing < best_timing) {
+          best_move = std::move(move);
+          best_timing = move_timing;
+        }
+      }
+    }
+    if (!best_move.has_value()) {
+      break;
+    }
+    XLS_VLOG(2) << absl::StreamFormat(
+        "Retiming improves critical path from %dps (%d nodes) to %dps (%d "
+        "nodes)",
+        timing.first, timing.second, best_timing.first, best_timing.second);
+    XLS_RETURN_IF_ERROR(ApplyMove(block, *best_move));
+    changed = true;
+  }
+
+  return changed;
+}
+
+}  // namespace xls::verilog
@@ -0,0 +1,49 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
+#define XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+
+namespace xls::verilog {
+
+// Retimes the pipeline registers of the block to shorten its critical path as
+// measured by the delay estimator in the pass options. Registers are moved
+// across single combinational nodes, either forward (the node is computed
+// before the registers which feed it) or backward (the node is computed after
+// the registers it feeds), as long as each move shortens the critical path or
+// reduces the number of nodes on it. Each move preserves the number of
+// registers on every path so the latency of the pipeline is unchanged.
+//
+// Only registers without a reset whose values neither come from input ports
+// nor drive output ports are moved. This leaves valid registers, state
+// registers and input/output flops in place. The pass only runs if
+// retime_registers is set in the codegen options and a delay estimator is
+// given.
+class RegisterRetimingPass : public CodegenPass {
+ public:
+  RegisterRetimingPass()
+      : CodegenPass("register_retiming", "Register retiming") {}
+  ~RegisterRetimingPass() override {}
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
@@ -0,0 +1,124 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/register_retiming_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class RegisterRetimingPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Block* block, bool retime_registers = true) {
+    PassResults results;
+    CodegenPassOptions options;
+    options.codegen_options.retime_registers(retime_registers);
+    options.delay_estimator = &delay_estimator_;
+    CodegenPassUnit unit(block->package(), block);
+    return RegisterRetimingPass().Run(&unit, options, &results);
+  }
+
+  // Returns the node written to the only register of the block.
+  static Node* RegisterData(Block* block) {
+    XLS_CHECK_EQ(block->GetRegisters().size(), 1);
+    return block->GetRegisterWrite(block->GetRegisters().front())
+        .value()
+        ->data();
+  }
+
+  TestDelayEstimator delay_estimator_;
+};
+
+TEST_F(RegisterRetimingPassTest, MoveRegisterForward) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue b = bb.InputPort("b", p->GetBitsType(32));
+  BValue x = bb.InsertRegister("x_reg", bb.Add(a, b));
+  bb.OutputPort("out", bb.Negate(bb.Not(bb.Negate(x))));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  // The first negate moves before the register, which balances the two stages.
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+  EXPECT_THAT(RegisterData(block),
+              m::Neg(m::Add(m::InputPort("a"), m::InputPort("b"))));
+  EXPECT_THAT(block->GetOutputPort("out").value(),
+              m::OutputPort(m::Neg(m::Not(m::RegisterRead()))));
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+}
+
+TEST_F(RegisterRetimingPassTest, MoveRegisterBackward) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue b = bb.InputPort("b", p->GetBitsType(32));
+  BValue x = bb.InsertRegister("x_reg", bb.Not(bb.Negate(bb.Add(a, b))));
+  bb.OutputPort("out", bb.Negate(x));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  // The not moves after the register.
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+  EXPECT_THAT(RegisterData(block), m::Neg(m::Add()));
+  EXPECT_THAT(block->GetOutputPort("out").value(),
+              m::OutputPort(m::Neg(m::Not(m::RegisterRead()))));
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+}
+
+TEST_F(RegisterRetimingPassTest, RegisterWithResetIsNotMoved) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue b = bb.InputPort("b", p->GetBitsType(32));
+  BValue rst = bb.InputPort("rst", p->GetBitsType(1));
+  BValue x = bb.InsertRegister("x_reg", bb.Add(a, b), rst,
+                               xls::Reset{.reset_value = Value(UBits(0, 32)),
+                                          .asynchronous = false,
+                                          .active_low = false});
+  bb.OutputPort("out", bb.Negate(bb.Not(bb.Negate(x))));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+}
+
+TEST_F(RegisterRetimingPassTest, NotRunWithoutOption) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue b = bb.InputPort("b", p->GetBitsType(32));
+  BValue x = bb.InsertRegister("x_reg", bb.Add(a, b));
+  bb.OutputPort("out", bb.Negate(bb.Not(bb.Negate(x))));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block, /*retime_registers=*/false), IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xls::verilog
@@ -0,0 +1,360 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/resource_sharing_pass.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/codegen/block_timing.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/value.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
+
+namespace xls::verilog {
+namespace {
+
+// Minimum width of adds and subtracts worth sharing. Narrower ones are not
+// much bigger than the multiplexers needed to share them.
+constexpr int64_t kMinSharedAdderWidth = 32;
+
+bool IsShareable(Node* node) {
+  switch (node->op()) {
+    case Op::kUMul:
+    case Op::kSMul:
+    case Op::kUDiv:
+    case Op::kSDiv:
+    case Op::kUMod:
+    case Op::kSMod:
+      return true;
+    case Op::kAdd:
+    case Op::kSub:
+      return node->BitCountOrDie() >= kMinSharedAdderWidth;
+    default:
+      return false;
+  }
+}
+
+// An operation whose value is only needed when `predicate` is true.
+struct Candidate {
+  Node* node;
+  Node* predicate;
+};
+
+// Returns the operand number of `node` in the select which is its only user,
+// if its value is used only as a single case of that select.
+std::optional<int64_t> SelectCaseOperandNumber(Node* node) {
+  if (node->users().size() != 1) {
+    return std::nullopt;
+  }
+  Node* select = node->users().front();
+  if (!select->Is<Select>() && !select->Is<OneHotSelect>() &&
+      !select->Is<PrioritySelect>()) {
+    return std::nullopt;
+  }
+  std::optional<int64_t> operand_no;
+  for (int64_t i = 0; i < select->operand_count(); ++i) {
+    if (select->operand(i) != node) {
+      continue;
+    }
+    if (i == 0 || operand_no.has_value()) {
+      // The node is the selector or more than one case.
+      return std::nullopt;
+    }
+    operand_no = i;
+  }
+  return operand_no;
+}
+
+// Returns a new 1-bit node which is true when `select` picks its operand
+// `operand_no`. Nodes created along the way are appended to `created`.
+absl::StatusOr<Node*> MakeCasePredicate(Block* block, Node* select,
+                                        int64_t operand_no,
+                                        std::vector<Node*>* created) {
+  auto add = [&](absl::StatusOr<Node*> node) -> absl::StatusOr<Node*> {
+    if (node.ok()) {
+      created->push_back(node.value());
+    }
+    return node;
+  };
+  const SourceInfo& loc = select->loc();
+  Node* selector = select->operand(0);
+  int64_t selector_width = selector->BitCountOrDie();
+  int64_t case_no = operand_no - 1;
+  if (select->Is<Select>()) {
+    int64_t case_count = select->As<Select>()->cases().size();
+    XLS_ASSIGN_OR_RETURN(
+        Node * index,
+        add(block->MakeNode<xls::Literal>(
+            loc, Value(UBits(std::min(case_no, case_count), selector_width)))));
+    // The default value is picked by any selector value past the cases.
+    return add(block->MakeNode<CompareOp>(
+        loc, selector, index, case_no < case_count ? Op::kEq : Op::kUGe));
+  }
+  if (select->Is<OneHotSelect>() || case_no == 0) {
+    return add(block->MakeNode<BitSlice>(loc, selector, /*start=*/case_no,
+                                         /*width=*/1));
+  }
+  // A priority select picks the case of its lowest set selector bit.
+  XLS_ASSIGN_OR_RETURN(Node * low_bits,
+                       add(block->MakeNode<BitSlice>(loc, selector, /*start=*/0,
+                                                     /*width=*/case_no + 1)));
+  XLS_ASSIGN_OR_RETURN(
+      Node * one_hot,
+      add(block->MakeNode<xls::Literal>(
+          loc, Value(Bits::PowerOfTwo(case_no, case_no + 1)))));
+  return add(block->MakeNode<CompareOp>(loc, low_bits, one_hot, Op::kEq));
+}
+
+// Returns whether any of `roots` transitively depends on `target`.
+bool DependsOn(absl::Span<Node* const> roots, Node* target) {
+  std::vector<Node*> worklist(roots.begin(), roots.end());
+  absl::flat_hash_set<Node*> visited(roots.begin(), roots.end());
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (node == target) {
+      return true;
+    }
+    for (Node* operand : node->operands()) {
+      if (visited.insert(operand).second) {
+        worklist.push_back(operand);
+      }
+    }
+  }
+  return false;
+}
+
+// Returns the operands and the predicate of the candidate; the shared
+// operation depends on these for every candidate it replaces.
+std::vector<Node*> CandidateInputs(const Candidate& candidate) {
+  std::vector<Node*> inputs(candidate.node->operands().begin(),
+                            candidate.node->operands().end());
+  inputs.push_back(candidate.predicate);
+  return inputs;
+}
+
+// An operation shared by several candidates along with the nodes created to
+// multiplex its operands. The operation has no users yet.
+struct SharedOperation {
+  Node* node;
+  std::vector<Node*> created;
+};
+
+absl::StatusOr<SharedOperation> MakeSharedOperation(
+    Block* block, absl::Span<const Candidate> candidates) {
+  SharedOperation shared;
+  const SourceInfo& loc = candidates.front().node->loc();
+
+  // One-hot selector with bit i set when candidate i is needed.
+  Node* selector = nullptr;
+  std::vector<Node*> operands;
+  for (int64_t i = 0; i < candidates.front().node->operand_count(); ++i) {
+    std::vector<Node*> cases;
+    for (const Candidate& candidate : candidates) {
+      cases.push_back(candidate.node->operand(i));
+    }
+    if (std::all_of(cases.begin(), cases.end(),
+                    [&](Node* n) { return n == cases.front(); })) {
+      operands.push_back(cases.front());
+      continue;
+    }
+    if (selector == nullptr) {
+      std::vector<Node*> predicates;
+      for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+        predicates.push_back(it->predicate);
+      }
+      XLS_ASSIGN_OR_RETURN(selector,
+                           block->MakeNode<xls::Concat>(loc, predicates));
+      shared.created.push_back(selector);
+    }
+    XLS_ASSIGN_OR_RETURN(Node * mux,
+                         block->MakeNode<OneHotSelect>(loc, selector, cases));
+    shared.created.push_back(mux);
+    operands.push_back(mux);
+  }
+  XLS_ASSIGN_OR_RETURN(shared.node,
+                       candidates.front().node->Clone(operands));
+  shared.created.push_back(shared.node);
+  return shared;
+}
+
+// Removes the given nodes, which must have no users other than later nodes in
+// the list.
+absl::Status RemoveNodes(Block* block, absl::Span<Node* const> nodes) {
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+    XLS_RETURN_IF_ERROR(block->RemoveNode(*it));
+  }
+  return absl::OkStatus();
+}
+
+// Returns whether replacing the candidates with the shared operation keeps the
+// critical path of the block.
+bool MeetsTiming(Block* block, const SharedOperation& shared,
+                 absl::Span<const Candidate> candidates,
+                 const DelayEstimator& delay_estimator) {
+  absl::flat_hash_map<Node*, int64_t> delays =
+      GetNodeDelays(block, delay_estimator);
+  absl::flat_hash_map<Node*, int64_t> arrivals =
+      GetArrivalTimes(block, delays);
+  absl::flat_hash_map<Node*, int64_t> tails = GetTailTimes(block, delays);
+  absl::flat_hash_set<Node*> created(shared.created.begin(),
+                                     shared.created.end());
+  int64_t critical_path = 0;
+  for (const auto& [node, arrival] : arrivals) {
+    if (!created.contains(node)) {
+      critical_path = std::max(critical_path, arrival);
+    }
+  }
+  int64_t tail = 0;
+  for (const Candidate& candidate : candidates) {
+    tail = std::max(tail, tails.at(candidate.node));
+  }
+  return arrivals.at(shared.node) + tail <= critical_path;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ResourceSharingPass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    PassResults* results) const {
+  if (!options.codegen_options.share_resources()) {
+    return false;
+  }
+  Block* block = unit->block;
+
+  // Gather the candidates in groups of operations of the same kind which could
+  // share hardware.
+  std::vector<std::vector<Node*>> groups;
+  absl::flat_hash_map<std::pair<Op, std::vector<Type*>>, int64_t> group_index;
+  for (Node* node : block->nodes()) {
+    if (!IsShareable(node) || !SelectCaseOperandNumber(node).has_value()) {
+      continue;
+    }
+    std::vector<Type*> types = {node->GetType()};
+    for (Node* operand : node->operands()) {
+      types.push_back(operand->GetType());
+    }
+    auto [it, inserted] = group_index.insert(
+        {{node->op(), types}, static_cast<int64_t>(groups.size())});
+    if (inserted) {
+      groups.emplace_back();
+    }
+    groups[it->second].push_back(node);
+  }
+
+  // Add the predicates of the candidates before analyzing the block so the
+  // query engine can reason about them.
+  std::vector<std::vector<Candidate>> candidate_groups;
+  std::vector<Node*> predicate_nodes;
+  for (const std::vector<Node*>& group : groups) {
+    if (group.size() < 2) {
+      continue;
+    }
+    std::vector<Candidate>& candidates = candidate_groups.emplace_back();
+    for (Node* node : group) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * predicate,
+          MakeCasePredicate(block, node->users().front(),
+                            SelectCaseOperandNumber(node).value(),
+                            &predicate_nodes));
+      candidates.push_back(Candidate{node, predicate});
+    }
+  }
+  if (candidate_groups.empty()) {
+    return false;
+  }
+  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
+  XLS_RETURN_IF_ERROR(query_engine.Populate(block).status());
+
+  // Replacing candidates by a shared operation leaves the values of all other
+  // nodes unchanged, so the analysis remains valid as candidates are merged.
+  bool changed = false;
+  for (const std::vector<Candidate>& candidates : candidate_groups) {
+    std::vector<bool> merged(candidates.size(), false);
+    for (int64_t i = 0; i < candidates.size(); ++i) {
+      if (merged[i]) {
+        continue;
+      }
+      // Greedily grow a set of mutually exclusive candidates around this one.
+      std::vector<Candidate> members = {candidates[i]};
+      std::optional<SharedOperation> shared;
+      for (int64_t j = i + 1; j < candidates.size(); ++j) {
+        if (merged[j]) {
+          continue;
+        }
+        const Candidate& candidate = candidates[j];
+        std::vector<Node*> predicates = {candidate.predicate};
+        bool acyclic = true;
+        for (const Candidate& member : members) {
+          predicates.push_back(member.predicate);
+          acyclic = acyclic &&
+                    !DependsOn(CandidateInputs(candidate), member.node) &&
+                    !DependsOn(CandidateInputs(member), candidate.node);
+        }
+        if (!acyclic || !query_engine.AtMostOneNodeTrue(predicates)) {
+          continue;
+        }
+        members.push_back(candidate);
+        XLS_ASSIGN_OR_RETURN(SharedOperation new_shared,
+                             MakeSharedOperation(block, members));
+        if (options.delay_estimator != nullptr &&
+            !MeetsTiming(block, new_shared, members,
+                         *options.delay_estimator)) {
+          XLS_RETURN_IF_ERROR(RemoveNodes(block, new_shared.created));
+          members.pop_back();
+          continue;
+        }
+        if (shared.has_value()) {
+          XLS_RETURN_IF_ERROR(RemoveNodes(block, shared->created));
+        }
+        shared = std::move(new_shared);
+        merged[j] = true;
+      }
+      if (!shared.has_value()) {
+        continue;
+      }
+      XLS_VLOG(2) << absl::StreamFormat("Sharing %s among %d operations",
+                                        shared->node->GetName(),
+                                        members.size());
+      for (const Candidate& member : members) {
+        XLS_RETURN_IF_ERROR(member.node->ReplaceUsesWith(shared->node));
+        XLS_RETURN_IF_ERROR(block->RemoveNode(member.node));
+      }
+      changed = true;
+    }
+  }
+
+  // Remove the predicates of candidates which were not shared.
+  for (auto it = predicate_nodes.rbegin(); it != predicate_nodes.rend(); ++it) {
+    if ((*it)->users().empty()) {
+      XLS_RETURN_IF_ERROR(block->RemoveNode(*it));
+    }
+  }
+  return changed;
+}
+
+}  // namespace xls::verilog
@@ -0,0 +1,47 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_RESOURCE_SHARING_PASS_H_
+#define XLS_CODEGEN_RESOURCE_SHARING_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+
+namespace xls::verilog {
+
+// Shares the hardware of expensive operations (multiplies, divides, modulos
+// and wide adds and subtracts) whose values are never needed in the same
+// cycle. Such an operation feeds a single case of a select, so its value is
+// only needed when the select picks that case. Operations of the same kind
+// whose cases are proven by BDD analysis to never be picked together are
+// replaced by one operation whose operands are multiplexed between theirs.
+//
+// If a delay estimator is given, operations are only shared when the added
+// multiplexers do not lengthen the critical path of the block. The pass only
+// runs if share_resources is set in the codegen options.
+class ResourceSharingPass : public CodegenPass {
+ public:
+  ResourceSharingPass()
+      : CodegenPass("resource_sharing", "Share mutually exclusive operations") {
+  }
+  ~ResourceSharingPass() override {}
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_RESOURCE_SHARING_PASS_H_
@@ -0,0 +1,156 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/resource_sharing_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+class ResourceSharingPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Block* block,
+                           const DelayEstimator* delay_estimator = nullptr) {
+    PassResults results;
+    CodegenPassOptions options;
+    options.codegen_options.share_resources(true);
+    options.delay_estimator = delay_estimator;
+    CodegenPassUnit unit(block->package(), block);
+    return ResourceSharingPass().Run(&unit, options, &results);
+  }
+
+  static int64_t MultiplyCount(Block* block) {
+    int64_t count = 0;
+    for (Node* node : block->nodes()) {
+      if (node->op() == Op::kUMul) {
+        ++count;
+      }
+    }
+    return count;
+  }
+};
+
+TEST_F(ResourceSharingPassTest, MultipliesOfSelectCases) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  BValue s = bb.InputPort("s", p->GetBitsType(1));
+  BValue a = bb.InputPort("a", p->GetBitsType(8));
+  BValue b = bb.InputPort("b", p->GetBitsType(8));
+  BValue c = bb.InputPort("c", p->GetBitsType(8));
+  bb.OutputPort("out", bb.Select(s, {bb.UMul(a, b), bb.UMul(a, c)}));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+  EXPECT_EQ(MultiplyCount(block), 1);
+  EXPECT_THAT(
+      InterpretCombinationalBlock(
+          block, absl::flat_hash_map<std::string, uint64_t>{
+                     {"s", 0}, {"a", 3}, {"b", 5}, {"c", 7}}),
+      IsOkAndHolds(UnorderedElementsAre(Pair("out", 15))));
+  EXPECT_THAT(
+      InterpretCombinationalBlock(
+          block, absl::flat_hash_map<std::string, uint64_t>{
+                     {"s", 1}, {"a", 3}, {"b", 5}, {"c", 7}}),
+      IsOkAndHolds(UnorderedElementsAre(Pair("out", 21))));
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+}
+
+TEST_F(ResourceSharingPassTest, MultipliesOfExclusiveSelects) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  BValue s = bb.InputPort("s", p->GetBitsType(2));
+  BValue a = bb.InputPort("a", p->GetBitsType(8));
+  BValue b = bb.InputPort("b", p->GetBitsType(8));
+  BValue zero = bb.Literal(UBits(0, 8));
+  bb.OutputPort("x", bb.Select(bb.Eq(s, bb.Literal(UBits(0, 2))),
+                               {zero, bb.UMul(a, b)}));
+  bb.OutputPort("y", bb.Select(bb.Eq(s, bb.Literal(UBits(1, 2))),
+                               {zero, bb.UMul(b, b)}));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+  EXPECT_EQ(MultiplyCount(block), 1);
+  for (uint64_t s_value = 0; s_value < 4; ++s_value) {
+    EXPECT_THAT(InterpretCombinationalBlock(
+                    block, absl::flat_hash_map<std::string, uint64_t>{
+                               {"s", s_value}, {"a", 3}, {"b", 5}}),
+                IsOkAndHolds(UnorderedElementsAre(
+                    Pair("x", s_value == 0 ? 15 : 0),
+                    Pair("y", s_value == 1 ? 25 : 0))));
+  }
+}
+
+TEST_F(ResourceSharingPassTest, MultipliesOfIndependentSelects) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  BValue s = bb.InputPort("s", p->GetBitsType(1));
+  BValue t = bb.InputPort("t", p->GetBitsType(1));
+  BValue a = bb.InputPort("a", p->GetBitsType(8));
+  BValue b = bb.InputPort("b", p->GetBitsType(8));
+  BValue zero = bb.Literal(UBits(0, 8));
+  bb.OutputPort("x", bb.Select(s, {zero, bb.UMul(a, b)}));
+  bb.OutputPort("y", bb.Select(t, {zero, bb.UMul(b, b)}));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+  EXPECT_EQ(MultiplyCount(block), 2);
+}
+
+TEST_F(ResourceSharingPassTest, SharingMustNotLengthenCriticalPath) {
+  // Builds a block with two multiplies on the cases of a select and optionally
+  // an unrelated path of `long_path_length` nots.
+  auto make_block = [&](Package* p, int64_t long_path_length) {
+    BlockBuilder bb(TestName(), p);
+    BValue s = bb.InputPort("s", p->GetBitsType(1));
+    BValue a = bb.InputPort("a", p->GetBitsType(8));
+    BValue b = bb.InputPort("b", p->GetBitsType(8));
+    BValue c = bb.InputPort("c", p->GetBitsType(8));
+    bb.OutputPort("out", bb.Select(s, {bb.UMul(a, b), bb.UMul(a, c)}));
+    BValue long_path = a;
+    for (int64_t i = 0; i < long_path_length; ++i) {
+      long_path = bb.Not(long_path);
+    }
+    bb.OutputPort("long", long_path);
+    return bb.Build();
+  };
+  TestDelayEstimator delay_estimator;
+
+  // The multiplexers in front of a shared multiply would be on the critical
+  // path.
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, make_block(p.get(), 0));
+  EXPECT_THAT(Run(block, &delay_estimator), IsOkAndHolds(false));
+  EXPECT_EQ(MultiplyCount(block), 2);
+
+  // With a longer path elsewhere in the block there is room for them.
+  auto p_slack = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block_slack, make_block(p_slack.get(), 8));
+  EXPECT_THAT(Run(block_slack, &delay_estimator), IsOkAndHolds(true));
+  EXPECT_EQ(MultiplyCount(block_slack), 1);
+}
+
+}  // namespace
+}  // namespace xls::verilog
@@ -16,14 +16,17 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "xls/codegen/finite_state_machine.h"
@@ -37,8 +40,14 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/passes/passes.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
@@ -170,7 +179,9 @@ absl::Status SequentialModuleBuilder::AddSequentialLogic() {
   LogicRef* ready_in = port_references_.ready_in.value();
   XLS_ASSIGN_OR_RETURN(
       StridedCounterReferences index_references,
-      AddStaticStridedCounter("index_counter", loop_->stride(),
+      AddStaticStridedCounter("index_counter",
+                              loop_->stride() *
+                                  sequential_options_.unroll_factor(),
                               loop_->stride() * loop_->trip_count(),
                               port_references_.clk, ready_in,
                               last_pipeline_cycle));
@@ -299,6 +310,17 @@ SequentialModuleBuilder::AddStaticStridedCounter(
 }
 
 absl::StatusOr<ModuleGeneratorResult> SequentialModuleBuilder::Build() {
+  int64_t unroll_factor = sequential_options_.unroll_factor();
+  if (unroll_factor < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Loop unroll factor must be positive, got %d.", unroll_factor));
+  }
+  if (loop_->trip_count() % unroll_factor != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Loop unroll factor %d does not evenly divide trip count %d of %s.",
+        unroll_factor, loop_->trip_count(), loop_->GetName()));
+  }
+
   // Generate the loop body module.
   absl::StatusOr<std::unique_ptr<ModuleGeneratorResult>> loop_body_status =
       GenerateLoopBodyPipeline();
@@ -399,6 +421,9 @@ SequentialModuleBuilder::GenerateLoopBodyPipeline() {
 
   // Get schedule.
   Function* loop_body_function = loop_->body();
+  if (sequential_options_.unroll_factor() > 1) {
+    XLS_ASSIGN_OR_RETURN(loop_body_function, UnrollLoopBody());
+  }
   XLS_ASSIGN_OR_RETURN(
       PipelineSchedule schedule,
       PipelineSchedule::Run(loop_body_function,
@@ -482,6 +507,64 @@ absl::Status SequentialModuleBuilder::InitializeModuleBuilder(
   return absl::OkStatus();
 }
 
+absl::StatusOr<Function*> SequentialModuleBuilder::UnrollLoopBody() {
+  Function* body = loop_->body();
+  int64_t unroll_factor = sequential_options_.unroll_factor();
+  unrolled_body_package_ = std::make_unique<Package>(body->package()->name());
+  Function* unrolled = unrolled_body_package_->AddFunction(
+      std::make_unique<Function>(
+          absl::StrFormat("%s_unrolled_%d", body->name(), unroll_factor),
+          unrolled_body_package_.get()));
+
+  // The unrolled function has the same signature as the body: the index of
+  // the first iteration, the accumulator and the invariants.
+  std::vector<Node*> params;
+  for (Param* param : body->params()) {
+    XLS_ASSIGN_OR_RETURN(Node * cloned, param->CloneInNewFunction(
+                                            /*new_operands=*/{}, unrolled));
+    params.push_back(cloned);
+  }
+  XLS_RET_CHECK_GE(params.size(), 2);
+  Node* index = params.at(0);
+  int64_t index_width = index->BitCountOrDie();
+
+  Node* accumulator = params.at(1);
+  for (int64_t iteration = 0; iteration < unroll_factor; ++iteration) {
+    absl::flat_hash_map<Node*, Node*> body_to_unrolled;
+    for (int64_t i = 0; i < params.size(); ++i) {
+      body_to_unrolled[body->param(i)] = params.at(i);
+    }
+    body_to_unrolled[body->param(1)] = accumulator;
+    if (iteration > 0) {
+      // Like the index counter, the offset index wraps at the index width.
+      Bits offset = bits_ops::ZeroExtend(
+                        UBits(iteration * loop_->stride(), 64),
+                        std::max<int64_t>(index_width, 64))
+                        .Slice(0, index_width);
+      XLS_ASSIGN_OR_RETURN(
+          Node * offset_literal,
+          unrolled->MakeNode<xls::Literal>(SourceInfo(), Value(offset)));
+      XLS_ASSIGN_OR_RETURN(body_to_unrolled[body->param(0)],
+                           unrolled->MakeNode<BinOp>(
+                               SourceInfo(), index, offset_literal, Op::kAdd));
+    }
+    for (Node* node : TopoSort(body)) {
+      if (node->Is<Param>()) {
+        continue;
+      }
+      std::vector<Node*> new_operands;
+      for (Node* operand : node->operands()) {
+        new_operands.push_back(body_to_unrolled.at(operand));
+      }
+      XLS_ASSIGN_OR_RETURN(body_to_unrolled[node],
+                           node->CloneInNewFunction(new_operands, unrolled));
+    }
+    accumulator = body_to_unrolled.at(body->return_value());
+  }
+  XLS_RETURN_IF_ERROR(unrolled->set_return_value(accumulator));
+  return unrolled;
+}
+
 absl::Status SequentialModuleBuilder::InstantiateLoopBody(
     LogicRef* index_value, const ModuleBuilder::Register& accumulator_reg,
     absl::Span<const ModuleBuilder::Register> invariant_registers,
@@ -32,6 +32,7 @@
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
 #include "xls/ir/function.h"
+#include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
 namespace xls {
@@ -83,12 +84,24 @@ class SequentialOptions {
   }
   bool use_system_verilog() const { return use_system_verilog_; }
 
+  // Number of consecutive loop iterations evaluated by each pass through the
+  // loop body pipeline. The body is replicated this many times, chaining the
+  // accumulator from one copy to the next, and the whole chain is scheduled
+  // as a single pipeline, so bodies much shallower than the clock period
+  // retire several iterations per pass. Must evenly divide the trip count.
+  SequentialOptions& unroll_factor(int64_t value) {
+    unroll_factor_ = value;
+    return *this;
+  }
+  int64_t unroll_factor() const { return unroll_factor_; }
+
  private:
   const DelayEstimator* delay_estimator_ = &GetStandardDelayEstimator();
   std::optional<std::string> module_name_;
   std::optional<ResetProto> reset_proto_;
   SchedulingOptions pipeline_scheduling_options_;
   bool use_system_verilog_ = true;
+  int64_t unroll_factor_ = 1;
   // TODO(jbaileyhandle): Interface options.
 };
 
@@ -184,6 +197,11 @@ class SequentialModuleBuilder {
     return wire;
   }
 
+  // Builds a function which evaluates sequential_options_.unroll_factor()
+  // consecutive iterations of the loop body. The function is owned by
+  // unrolled_body_package_.
+  absl::StatusOr<Function*> UnrollLoopBody();
+
   // Instantiates the loop body.
   absl::Status InstantiateLoopBody(
       LogicRef* index_value, const ModuleBuilder::Register& accumulator_reg,
@@ -192,6 +210,7 @@ class SequentialModuleBuilder {
 
   VerilogFile file_;
   const CountedFor* loop_;
+  std::unique_ptr<Package> unrolled_body_package_;
   std::unique_ptr<ModuleGeneratorResult> loop_body_pipeline_result_;
   std::unique_ptr<ModuleBuilder> module_builder_;
   std::unique_ptr<ModuleSignature> module_signature_;
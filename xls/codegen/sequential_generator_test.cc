@@ -52,6 +52,8 @@ namespace verilog {
 namespace {
 
 using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
 
 constexpr char kTestName[] = "sequential_generator_test";
 constexpr char kTestdataPath[] = "xls/codegen/testdata";
@@ -1905,6 +1907,89 @@ top fn __SequentialModuleSimple__main(init_acc: bits[32]) -> bits[32] {
   }
 }
 
+TEST_P(SequentialGeneratorTest, SequentialModuleUnrolled) {
+  std::string text = R"(
+package SequentialModuleUnrolled
+
+fn ____SequentialModuleUnrolled__main_counted_for_0_body(index: bits[8], acc: bits[32]) -> bits[32] {
+  add.3: bits[32] = add(acc, acc, pos=[(0,2,8)])
+  zero_ext.4: bits[32] = zero_ext(index, new_bit_count=32, pos=[(0,2,8)])
+  ret xor.5: bits[32] = xor(add.3, zero_ext.4, pos=[(0,2,8)])
+}
+
+top fn __SequentialModuleUnrolled__main(init_acc: bits[32]) -> bits[32] {
+  ret counted_for.6: bits[32] = counted_for(init_acc, trip_count=6, stride=3, body=____SequentialModuleUnrolled__main_counted_for_0_body, pos=[(0,1,5)])
+}
+)";
+  // The body is order-sensitive, so this checks that each copy in the
+  // unrolled body sees the right index.
+  uint64_t expected = 100;
+  for (uint64_t index = 0; index < 18; index += 3) {
+    expected = ((expected + expected) ^ index) & 0xffffffff;
+  }
+  for (int64_t unroll_factor : {1, 2, 3, 6}) {
+    for (int64_t latency = 0; latency < 3; ++latency) {
+      XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                               Parser::ParsePackage(text));
+      std::optional<FunctionBase*> main = package->GetTop();
+      ASSERT_TRUE(main.has_value());
+      XLS_ASSERT_OK_AND_ASSIGN(Node * node_loop,
+                               main.value()->GetNode("counted_for.6"));
+      CountedFor* loop = node_loop->As<CountedFor>();
+
+      ResetProto reset;
+      reset.set_name("reset");
+      reset.set_asynchronous(false);
+      reset.set_active_low(false);
+      SequentialOptions sequential_options;
+      sequential_options.use_system_verilog(UseSystemVerilog());
+      sequential_options.reset(reset);
+      sequential_options.unroll_factor(unroll_factor);
+      sequential_options.pipeline_scheduling_options().pipeline_stages(
+          latency + 1);
+      XLS_ASSERT_OK_AND_ASSIGN(
+          ModuleGeneratorResult result,
+          ToSequentialModuleText(sequential_options, loop));
+
+      ModuleSimulator simulator =
+          NewModuleSimulator(result.verilog_text, result.signature);
+      EXPECT_THAT(simulator.Run({{"init_acc_in", Value(UBits(100, 32))}}),
+                  IsOkAndHolds(Value(UBits(expected, 32))))
+          << "unroll_factor: " << unroll_factor << " latency: " << latency;
+    }
+  }
+}
+
+TEST_P(SequentialGeneratorTest, SequentialModuleUnrollFactorMustDivideTrips) {
+  std::string text = R"(
+package SequentialModuleUnrolled
+
+fn ____SequentialModuleUnrolled__main_counted_for_0_body(index: bits[32], acc: bits[32]) -> bits[32] {
+  ret add.5: bits[32] = add(acc, index, pos=[(0,2,8)])
+}
+
+top fn __SequentialModuleUnrolled__main(init_acc: bits[32]) -> bits[32] {
+  ret counted_for.6: bits[32] = counted_for(init_acc, trip_count=4, stride=1, body=____SequentialModuleUnrolled__main_counted_for_0_body, pos=[(0,1,5)])
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(text));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * node_loop,
+                           package->GetTop().value()->GetNode("counted_for.6"));
+  ResetProto reset;
+  reset.set_name("reset");
+  reset.set_asynchronous(false);
+  reset.set_active_low(false);
+  SequentialOptions sequential_options;
+  sequential_options.use_system_verilog(UseSystemVerilog());
+  sequential_options.reset(reset);
+  sequential_options.unroll_factor(3);
+  EXPECT_THAT(
+      ToSequentialModuleText(sequential_options, node_loop->As<CountedFor>()),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("does not evenly divide trip count 4")));
+}
+
 // TODO(jbaileyhandle): Test module reset (active high and active low).
 
 INSTANTIATE_TEST_SUITE_P(SequentialGeneratorTestInstantiation,
@@ -0,0 +1,159 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/timing_constraints.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+
+namespace xls::verilog {
+namespace {
+
+// The names of the ports of a module other than its clock, in the order they
+// are described by the signature.
+struct Ports {
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+};
+
+Ports GetNonClockPorts(const ModuleSignatureProto& proto) {
+  Ports ports;
+  absl::flat_hash_set<std::string> seen;
+  auto add = [&](std::vector<std::string>& names, const std::string& name) {
+    if (!name.empty() && seen.insert(name).second) {
+      names.push_back(name);
+    }
+  };
+  if (proto.has_reset()) {
+    add(ports.inputs, proto.reset().name());
+  }
+  for (const PortProto& port : proto.data_ports()) {
+    // Zero-width ports do not exist in the Verilog module.
+    if (port.width() == 0) {
+      continue;
+    }
+    add(port.direction() == DIRECTION_INPUT ? ports.inputs : ports.outputs,
+        port.name());
+  }
+  for (const ChannelProto& channel : proto.data_channels()) {
+    if (channel.supported_ops() == CHANNEL_OPS_RECEIVE_ONLY) {
+      add(ports.inputs, channel.valid_port_name());
+      add(ports.outputs, channel.ready_port_name());
+    } else if (channel.supported_ops() == CHANNEL_OPS_SEND_ONLY) {
+      add(ports.outputs, channel.valid_port_name());
+      add(ports.inputs, channel.ready_port_name());
+    }
+  }
+  if (proto.has_pipeline() && proto.pipeline().has_pipeline_control()) {
+    const PipelineControl& control = proto.pipeline().pipeline_control();
+    if (control.has_valid()) {
+      add(ports.inputs, control.valid().input_name());
+      add(ports.outputs, control.valid().output_name());
+    } else if (control.has_manual()) {
+      add(ports.inputs, control.manual().input_name());
+    }
+  }
+  return ports;
+}
+
+// Returns the given delay in picoseconds as nanoseconds, the default time unit
+// of SDC.
+std::string ToNs(int64_t delay_ps) {
+  return absl::StrFormat("%.3f", static_cast<double>(delay_ps) / 1000.0);
+}
+
+std::string GetPorts(const std::vector<std::string>& names) {
+  return absl::StrFormat("[get_ports {%s}]", absl::StrJoin(names, " "));
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> GenerateSdcConstraints(
+    const ModuleSignature& signature, std::optional<int64_t> clock_period_ps) {
+  const ModuleSignatureProto& proto = signature.proto();
+  const BlockMetricsProto& metrics = proto.metrics().block_metrics();
+  if (!metrics.has_max_reg_to_reg_delay_ps()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "The signature of module %s has no path delays; timing constraints "
+        "require the module to be generated with a delay estimator",
+        signature.module_name()));
+  }
+  int64_t period_ps = clock_period_ps.value_or(std::max(
+      {metrics.max_reg_to_reg_delay_ps(), metrics.max_input_to_reg_delay_ps(),
+       metrics.max_reg_to_output_delay_ps(),
+       metrics.max_feedthrough_path_delay_ps()}));
+  if (period_ps <= 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Clock period must be positive, got %dps", period_ps));
+  }
+
+  Ports ports = GetNonClockPorts(proto);
+  std::string sdc = absl::StrFormat(
+      "# Timing constraints for module %s generated by XLS.\n",
+      signature.module_name());
+  if (metrics.has_delay_model()) {
+    absl::StrAppendFormat(&sdc, "# Path delays estimated by delay model %s.\n",
+                          metrics.delay_model());
+  }
+
+  if (!proto.has_clock_name()) {
+    // Without a clock every path of the module is from an input to an output.
+    if (ports.inputs.empty() || ports.outputs.empty()) {
+      return sdc;
+    }
+    absl::StrAppendFormat(&sdc, "\nset_max_delay %s -from %s -to %s\n",
+                          ToNs(period_ps), GetPorts(ports.inputs),
+                          GetPorts(ports.outputs));
+    return sdc;
+  }
+
+  const std::string& clock = proto.clock_name();
+  absl::StrAppendFormat(&sdc, "\ncreate_clock -name %s -period %s %s\n", clock,
+                        ToNs(period_ps), GetPorts({clock}));
+  if (!ports.inputs.empty()) {
+    absl::StrAppendFormat(
+        &sdc, "set_input_delay -clock %s %s %s\n", clock,
+        ToNs(std::max(int64_t{0},
+                      period_ps - metrics.max_input_to_reg_delay_ps())),
+        GetPorts(ports.inputs));
+  }
+  if (!ports.outputs.empty()) {
+    absl::StrAppendFormat(
+        &sdc, "set_output_delay -clock %s %s %s\n", clock,
+        ToNs(std::max(int64_t{0},
+                      period_ps - metrics.max_reg_to_output_delay_ps())),
+        GetPorts(ports.outputs));
+  }
+  if (metrics.feedthrough_path_exists() && !ports.inputs.empty() &&
+      !ports.outputs.empty()) {
+    // A combinational path through the module would otherwise be checked
+    // against both the input and the output delay, so such paths are limited
+    // to their estimated delay instead.
+    absl::StrAppendFormat(
+        &sdc,
+        "# The module has combinational paths from inputs to outputs.\n"
+        "set_max_delay %s -from %s -to %s\n",
+        ToNs(metrics.max_feedthrough_path_delay_ps()), GetPorts(ports.inputs),
+        GetPorts(ports.outputs));
+  }
+  return sdc;
+}
+
+}  // namespace xls::verilog
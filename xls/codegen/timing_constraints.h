@@ -0,0 +1,43 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_TIMING_CONSTRAINTS_H_
+#define XLS_CODEGEN_TIMING_CONSTRAINTS_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/module_signature.h"
+
+namespace xls::verilog {
+
+// Returns timing constraints in Synopsys Design Constraints (SDC) format for
+// the module with the given signature, for consumption by synthesis and static
+// timing analysis tools. The constraints define the clock of the module and
+// set the input (output) delay of every port to the part of the clock period
+// not used by the module's own paths from inputs (to outputs), so the logic
+// outside the module gets the rest of the cycle.
+//
+// The path delays are taken from the block metrics of the signature, which are
+// only populated when the module is generated with a delay estimator. If
+// `clock_period_ps` is not given the period is the longest path delay of the
+// module.
+absl::StatusOr<std::string> GenerateSdcConstraints(
+    const ModuleSignature& signature, std::optional<int64_t> clock_period_ps);
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_TIMING_CONSTRAINTS_H_
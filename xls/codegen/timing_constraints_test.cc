@@ -0,0 +1,101 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/timing_constraints.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+// Returns the signature of a two-stage pipeline with the given block metrics.
+absl::StatusOr<ModuleSignature> PipelineSignature(
+    const BlockMetricsProto& metrics) {
+  ModuleSignatureBuilder b("foo");
+  b.WithClock("clk");
+  b.WithReset("rst", /*asynchronous=*/false, /*active_low=*/false);
+  PipelineControl control;
+  control.mutable_valid()->set_input_name("in_valid");
+  control.mutable_valid()->set_output_name("out_valid");
+  b.WithPipelineInterface(/*latency=*/2, /*initiation_interval=*/1, control);
+  b.AddDataInput("x", 32);
+  b.AddDataInput("y", 32);
+  b.AddDataInput("empty", 0);
+  b.AddDataOutput("out", 32);
+  XLS_ASSIGN_OR_RETURN(ModuleSignature signature, b.Build());
+  XLS_RETURN_IF_ERROR(signature.ReplaceBlockMetrics(metrics));
+  return signature;
+}
+
+TEST(TimingConstraintsTest, PipelinedModule) {
+  BlockMetricsProto metrics;
+  metrics.set_delay_model("unit");
+  metrics.set_max_reg_to_reg_delay_ps(900);
+  metrics.set_max_input_to_reg_delay_ps(300);
+  metrics.set_max_reg_to_output_delay_ps(1000);
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature,
+                           PipelineSignature(metrics));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string sdc,
+                           GenerateSdcConstraints(signature, 1250));
+  EXPECT_THAT(sdc, HasSubstr("create_clock -name clk -period 1.250 "
+                             "[get_ports {clk}]\n"));
+  EXPECT_THAT(sdc, HasSubstr("set_input_delay -clock clk 0.950 "
+                             "[get_ports {rst x y in_valid}]\n"));
+  EXPECT_THAT(sdc, HasSubstr("set_output_delay -clock clk 0.250 "
+                             "[get_ports {out out_valid}]\n"));
+  EXPECT_THAT(sdc, Not(HasSubstr("set_max_delay")));
+
+  // Without a clock period the module's longest path sets the period.
+  XLS_ASSERT_OK_AND_ASSIGN(sdc, GenerateSdcConstraints(signature,
+                                                       std::nullopt));
+  EXPECT_THAT(sdc, HasSubstr("-period 1.000 "));
+  EXPECT_THAT(sdc, HasSubstr("set_output_delay -clock clk 0.000 "));
+}
+
+TEST(TimingConstraintsTest, FeedthroughPath) {
+  BlockMetricsProto metrics;
+  metrics.set_max_reg_to_reg_delay_ps(500);
+  metrics.set_max_input_to_reg_delay_ps(500);
+  metrics.set_max_reg_to_output_delay_ps(500);
+  metrics.set_feedthrough_path_exists(true);
+  metrics.set_max_feedthrough_path_delay_ps(200);
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature,
+                           PipelineSignature(metrics));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string sdc,
+                           GenerateSdcConstraints(signature, 1000));
+  EXPECT_THAT(sdc, HasSubstr("set_max_delay 0.200 "
+                             "-from [get_ports {rst x y in_valid}] "
+                             "-to [get_ports {out out_valid}]\n"));
+}
+
+TEST(TimingConstraintsTest, SignatureWithoutDelays) {
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature,
+                           PipelineSignature(BlockMetricsProto()));
+  EXPECT_THAT(GenerateSdcConstraints(signature, 1000),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("delay estimator")));
+}
+
+}  // namespace
+}  // namespace xls::verilog
@@ -14,6 +14,9 @@
 
 #include "xls/codegen/vast.h"
 
+#include <atomic>
+
+#include "absl/algorithm/container.h"
 #include "absl/flags/flag.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
@@ -25,6 +28,7 @@
 #include "xls/common/indent.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/common/visitor.h"
 #include "re2/re2.h"
 
@@ -98,6 +102,20 @@ void LineInfo::End(const VastNode* node) {
 
 void LineInfo::Increase(int64_t delta) { current_line_number_ += delta; }
 
+void LineInfo::Append(const LineInfo& other) {
+  for (const auto& [node, other_spans] : other.spans_) {
+    XLS_CHECK(!other_spans.hanging_start_line.has_value())
+        << "Cannot append line info with a hanging span!";
+    std::vector<LineSpan>& completed_spans = spans_[node].completed_spans;
+    for (const LineSpan& span : other_spans.completed_spans) {
+      completed_spans.push_back(
+          LineSpan(span.StartLine() + current_line_number_,
+                   span.EndLine() + current_line_number_));
+    }
+  }
+  current_line_number_ += other.current_line_number_;
+}
+
 std::optional<std::vector<LineSpan>> LineInfo::LookupNode(
     const VastNode* node) const {
   if (!spans_.contains(node)) {
@@ -208,21 +226,22 @@ DataType* VerilogFile::UnpackedArrayType(int64_t element_bit_count,
 }
 
 std::string VerilogFile::Emit(LineInfo* line_info) const {
-  auto file_member_str = [=](const FileMember& member) -> std::string {
-    return absl::visit(
-        Visitor{[=](Include* m) -> std::string { return m->Emit(line_info); },
-                [=](Module* m) -> std::string { return m->Emit(line_info); },
-                [=](BlankLine* m) -> std::string { return m->Emit(line_info); },
-                [=](Comment* m) -> std::string { return m->Emit(line_info); }},
-        member);
-  };
+  absl::Cord out;
+  EmitTo(&out, line_info);
+  return std::string(out);
+}
 
-  std::string out;
+void VerilogFile::EmitTo(absl::Cord* out, LineInfo* line_info) const {
   for (const FileMember& member : members_) {
-    absl::StrAppend(&out, file_member_str(member), "\n");
+    absl::visit(
+        Visitor{[=](Include* m) { out->Append(m->Emit(line_info)); },
+                [=](Module* m) { m->EmitTo(out, line_info); },
+                [=](BlankLine* m) { out->Append(m->Emit(line_info)); },
+                [=](Comment* m) { out->Append(m->Emit(line_info)); }},
+        member);
+    out->Append("\n");
     LineInfoIncrease(line_info, 1);
   }
-  return out;
 }
 
 LocalParamItemRef* LocalParam::AddItem(std::string_view name,
@@ -566,23 +585,110 @@ std::string EmitModuleMember(LineInfo* line_info, const ModuleMember& member) {
 
 }  // namespace
 
+void ModuleSection::CollectLeafSections(
+    std::vector<const ModuleSection*>* sections) const {
+  for (const ModuleMember& member : members_) {
+    if (!std::holds_alternative<ModuleSection*>(member)) {
+      continue;
+    }
+    const ModuleSection* section = std::get<ModuleSection*>(member);
+    if (section->members_.empty()) {
+      continue;
+    }
+    bool contains_nonempty_section = absl::c_any_of(
+        section->members_, [](const ModuleMember& m) {
+          return std::holds_alternative<ModuleSection*>(m) &&
+                 !std::get<ModuleSection*>(m)->members_.empty();
+        });
+    if (contains_nonempty_section) {
+      section->CollectLeafSections(sections);
+    } else {
+      sections->push_back(section);
+    }
+  }
+}
+
 std::string ModuleSection::Emit(LineInfo* line_info) const {
+  absl::Cord out;
+  EmitTo(&out, line_info);
+  return std::string(out);
+}
+
+void ModuleSection::EmitTo(absl::Cord* out, LineInfo* line_info,
+                           int64_t indent) const {
+  // The leaf sections (e.g., the per-stage sections of a pipeline) hold the
+  // bulk of the text. These are emitted concurrently, each into its own string
+  // and line info, and then stitched into the output in member order so the
+  // result does not depend on the thread count.
+  int64_t thread_count = file()->emit_thread_count();
+  std::vector<const ModuleSection*> leaves;
+  if (thread_count > 1) {
+    CollectLeafSections(&leaves);
+  }
+  if (leaves.size() < 2) {
+    EmitWithEmittedSections(out, line_info, indent, {});
+    return;
+  }
+  std::vector<EmittedSection> emitted(leaves.size());
+  std::atomic<int64_t> next_leaf = 0;
+  auto emit_leaves = [&]() {
+    for (int64_t i = next_leaf++; i < leaves.size(); i = next_leaf++) {
+      emitted[i].text = leaves[i]->Emit(
+          line_info == nullptr ? nullptr : &emitted[i].line_info);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < thread_count && i < leaves.size(); ++i) {
+    threads.push_back(std::make_unique<Thread>(emit_leaves));
+  }
+  emit_leaves();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  absl::flat_hash_map<const ModuleSection*, EmittedSection> emitted_sections;
+  for (int64_t i = 0; i < leaves.size(); ++i) {
+    emitted_sections[leaves[i]] = std::move(emitted[i]);
+  }
+  EmitWithEmittedSections(out, line_info, indent, emitted_sections);
+}
+
+void ModuleSection::EmitWithEmittedSections(
+    absl::Cord* out, LineInfo* line_info, int64_t indent,
+    const absl::flat_hash_map<const ModuleSection*, EmittedSection>& emitted)
+    const {
+  auto append = [&](std::string text) {
+    out->Append(indent == 0 ? std::move(text) : Indent(text, indent));
+  };
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
+  bool first_element = true;
   for (const ModuleMember& member : members_) {
+    if (std::holds_alternative<ModuleSection*>(member) &&
+        std::get<ModuleSection*>(member)->members_.empty()) {
+      continue;
+    }
+    if (!first_element) {
+      out->Append("\n");
+    }
+    first_element = false;
     if (std::holds_alternative<ModuleSection*>(member)) {
-      if (std::get<ModuleSection*>(member)->members_.empty()) {
-        continue;
+      const ModuleSection* section = std::get<ModuleSection*>(member);
+      if (auto it = emitted.find(section); it != emitted.end()) {
+        append(it->second.text);
+        if (line_info != nullptr) {
+          line_info->Append(it->second.line_info);
+        }
+      } else {
+        section->EmitWithEmittedSections(out, line_info, indent, emitted);
       }
+    } else {
+      append(EmitModuleMember(line_info, member));
     }
-    elements.push_back(EmitModuleMember(line_info, member));
     LineInfoIncrease(line_info, 1);
   }
-  if (!elements.empty()) {
+  if (!first_element) {
     LineInfoIncrease(line_info, -1);
   }
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string ContinuousAssignment::Emit(LineInfo* line_info) const {
@@ -677,6 +783,12 @@ std::string SystemFunctionCall::Emit(LineInfo* line_info) const {
 }
 
 std::string Module::Emit(LineInfo* line_info) const {
+  absl::Cord out;
+  EmitTo(&out, line_info);
+  return std::string(out);
+}
+
+void Module::EmitTo(absl::Cord* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
   std::string result = absl::StrCat("module ", name_);
   if (ports_.empty()) {
@@ -695,11 +807,12 @@ std::string Module::Emit(LineInfo* line_info) const {
     absl::StrAppend(&result, "\n);\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  out->Append(std::move(result));
+  top_.EmitTo(out, line_info, /*indent=*/kDefaultIndentSpaces);
+  out->Append("\n");
   LineInfoIncrease(line_info, 1);
-  absl::StrAppend(&result, "endmodule");
+  out->Append("endmodule");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Literal::Emit(LineInfo* line_info) const {
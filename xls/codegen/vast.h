@@ -28,6 +28,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
 #include "absl/types/optional.h"
@@ -128,6 +129,12 @@ class LineInfo {
   // sequence of calls that does not include negative numbers.
   void Increase(int64_t delta);
 
+  // Appends the spans recorded in `other`, which must have no hanging spans,
+  // as if they had been recorded by this object starting at its current line
+  // number, and advances the current line number past them. This allows
+  // separately emitted pieces of text to be stitched together.
+  void Append(const LineInfo& other);
+
   // Returns the underlying relation between nodes and spans.
   const absl::flat_hash_map<const VastNode*, PartialLineSpans>& Spans() const {
     return spans_;
@@ -1474,7 +1481,30 @@ class ModuleSection : public VastNode {
 
   std::string Emit(LineInfo* line_info) const override;
 
+  // Appends the emitted text of the section to `out` with every nonempty line
+  // indented by `indent` spaces. The section is appended member by member so
+  // the text of the entire section is never held in one string.
+  void EmitTo(absl::Cord* out, LineInfo* line_info, int64_t indent = 0) const;
+
  private:
+  // The text and line info of a separately emitted section.
+  struct EmittedSection {
+    std::string text;
+    LineInfo line_info;
+  };
+
+  // Appends the nonempty sections nested (at any depth) within this section
+  // which do not themselves contain any nonempty sections.
+  void CollectLeafSections(std::vector<const ModuleSection*>* sections) const;
+
+  // Appends the section to `out` as EmitTo does. Nested sections present in
+  // `emitted` are not emitted again; their previously emitted text is used
+  // instead.
+  void EmitWithEmittedSections(
+      absl::Cord* out, LineInfo* line_info, int64_t indent,
+      const absl::flat_hash_map<const ModuleSection*, EmittedSection>& emitted)
+      const;
+
   std::vector<ModuleMember> members_;
 };
 
@@ -1537,6 +1567,9 @@ class Module : public VastNode {
 
   std::string Emit(LineInfo* line_info) const override;
 
+  // Appends the emitted text of the module to `out`.
+  void EmitTo(absl::Cord* out, LineInfo* line_info) const;
+
  private:
   // Add the given Def as a port on the module.
   LogicRef* AddPortDef(Direction direction, Def* def, const SourceInfo& loc);
@@ -1592,6 +1625,21 @@ class VerilogFile {
 
   std::string Emit(LineInfo* line_info = nullptr) const;
 
+  // Appends the emitted text of the file to `out`. Unlike Emit, the text is
+  // built as a sequence of chunks (roughly one per module member) rather than
+  // by repeatedly concatenating and copying the text of nested constructs.
+  // This bounds the memory needed beyond the output itself, and the chunks
+  // can be written out without flattening (see absl::Cord::Chunks).
+  void EmitTo(absl::Cord* out, LineInfo* line_info = nullptr) const;
+
+  // The number of threads used to emit the text of module sections (e.g., the
+  // per-stage sections of a pipeline) concurrently. The emitted text does not
+  // depend on the thread count.
+  void set_emit_thread_count(int64_t thread_count) {
+    emit_thread_count_ = thread_count;
+  }
+  int64_t emit_thread_count() const { return emit_thread_count_; }
+
   verilog::Slice* Slice(IndexableExpression* subject, Expression* hi,
                         Expression* lo, const SourceInfo& loc) {
     return Make<verilog::Slice>(loc, subject, hi, lo);
@@ -1836,6 +1884,7 @@ class VerilogFile {
   }
 
   FileType file_type_;
+  int64_t emit_thread_count_ = 1;
   std::vector<FileMember> members_;
   std::vector<std::unique_ptr<VastNode>> nodes_;
 };
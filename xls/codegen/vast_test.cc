@@ -1184,6 +1184,124 @@ endmodule)");
             std::vector<LineSpan>{LineSpan(7, 7)});
 }
 
+TEST_P(VastTest, EmitToCord) {
+  VerilogFile f(GetFileType());
+  f.Add(f.Make<Comment>(SourceInfo(), "header\ncomment"));
+  for (std::string_view name : {"first", "second"}) {
+    Module* module = f.AddModule(name, SourceInfo());
+    LogicRef* in = module->AddInput("in", f.BitVectorType(8, SourceInfo()),
+                                    SourceInfo());
+    LogicRef* out = module->AddOutput("out", f.BitVectorType(8, SourceInfo()),
+                                      SourceInfo());
+    ModuleSection* section = module->Add<ModuleSection>(SourceInfo());
+    section->Add<Comment>(SourceInfo(), "section");
+    LogicRef* tmp = module->AddWire("tmp", f.BitVectorType(8, SourceInfo()),
+                                    SourceInfo(), section);
+    section->Add<ContinuousAssignment>(SourceInfo(), tmp,
+                                       f.Negate(in, SourceInfo()));
+    module->Add<BlankLine>(SourceInfo());
+    module->Add<ContinuousAssignment>(SourceInfo(), out, tmp);
+    f.Add(f.Make<BlankLine>(SourceInfo()));
+  }
+
+  LineInfo string_line_info;
+  std::string text = f.Emit(&string_line_info);
+  EXPECT_EQ(text, R"(// header
+// comment
+module first(
+  input wire [7:0] in,
+  output wire [7:0] out
+);
+  // section
+  wire [7:0] tmp;
+  assign tmp = -in;
+
+  assign out = tmp;
+endmodule
+
+module second(
+  input wire [7:0] in,
+  output wire [7:0] out
+);
+  // section
+  wire [7:0] tmp;
+  assign tmp = -in;
+
+  assign out = tmp;
+endmodule
+
+)");
+
+  // EmitTo appends to the existing contents of the cord.
+  absl::Cord cord("prefix\n");
+  LineInfo cord_line_info;
+  f.EmitTo(&cord, &cord_line_info);
+  EXPECT_EQ(std::string(cord), absl::StrCat("prefix\n", text));
+  EXPECT_EQ(cord_line_info.Spans().size(), string_line_info.Spans().size());
+  for (const auto& [node, spans] : string_line_info.Spans()) {
+    EXPECT_EQ(cord_line_info.LookupNode(node),
+              string_line_info.LookupNode(node));
+  }
+}
+
+TEST_P(VastTest, ModuleSectionsEmittedConcurrently) {
+  VerilogFile f(GetFileType());
+  Module* module = f.Make<Module>(SourceInfo(), "my_module");
+  LogicRef* in = module->AddInput("in", f.BitVectorType(8, SourceInfo()),
+                                  SourceInfo());
+  ModuleSection* stages = module->Add<ModuleSection>(SourceInfo());
+  module->Add<ModuleSection>(SourceInfo());
+  std::vector<ModuleSection*> sections = {stages};
+  Expression* prev = in;
+  for (int64_t stage = 0; stage < 7; ++stage) {
+    ModuleSection* section = stages->Add<ModuleSection>(SourceInfo());
+    sections.push_back(section);
+    section->Add<Comment>(SourceInfo(),
+                          absl::StrCat("stage ", stage, "\nsecond line"));
+    // Leave one stage without any contents.
+    if (stage == 3) {
+      section->Add<ModuleSection>(SourceInfo());
+      continue;
+    }
+    // Nest some of the stages' logic one level deeper.
+    ModuleSection* logic_section =
+        stage % 2 == 0 ? section : section->Add<ModuleSection>(SourceInfo());
+    sections.push_back(logic_section);
+    LogicRef* wire =
+        module->AddWire(absl::StrCat("stage_", stage),
+                        f.BitVectorType(8, SourceInfo()), SourceInfo(),
+                        logic_section);
+    logic_section->Add<ContinuousAssignment>(
+        SourceInfo(), wire, f.Add(prev, f.PlainLiteral(stage, SourceInfo()),
+                                  SourceInfo()));
+    prev = wire;
+  }
+  module->Add<BlankLine>(SourceInfo());
+  LogicRef* out = module->AddOutput("out", f.BitVectorType(8, SourceInfo()),
+                                    SourceInfo());
+  module->Add<ContinuousAssignment>(SourceInfo(), out, prev);
+
+  LineInfo serial_line_info;
+  std::string serial_text = module->Emit(&serial_line_info);
+  EXPECT_THAT(serial_text, HasSubstr("  // stage 6\n"
+                                     "  // second line\n"
+                                     "  wire [7:0] stage_6;\n"
+                                     "  assign stage_6 = stage_5 + 6;\n"));
+  for (int64_t thread_count : {2, 3, 16}) {
+    f.set_emit_thread_count(thread_count);
+    LineInfo line_info;
+    EXPECT_EQ(module->Emit(&line_info), serial_text);
+    EXPECT_EQ(module->Emit(nullptr), serial_text);
+    EXPECT_EQ(line_info.Spans().size(), serial_line_info.Spans().size());
+    for (const auto& [node, spans] : serial_line_info.Spans()) {
+      EXPECT_EQ(line_info.LookupNode(node), serial_line_info.LookupNode(node));
+    }
+    for (ModuleSection* section : sections) {
+      EXPECT_TRUE(line_info.LookupNode(section).has_value());
+    }
+  }
+}
+
 TEST_P(VastTest, VerilogFunction) {
   VerilogFile f(GetFileType());
   Module* m = f.AddModule("top", SourceInfo());
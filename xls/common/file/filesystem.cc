@@ -20,6 +20,10 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
 #include "google/protobuf/io/tokenizer.h"
 #include "google/protobuf/text_format.h"
 #include "absl/status/status.h"
@@ -66,6 +70,26 @@ class ParseTextProtoFileErrorCollector : public google::protobuf::io::ErrorColle
   const google::protobuf::Message& proto_;
 };
 
+// Serializes `proto` in binary format for writing to `file_name`.
+absl::StatusOr<std::string> SerializeProtobin(
+    const std::filesystem::path& file_name, const google::protobuf::Message& proto) {
+  std::string bin_proto;
+  if (!proto.IsInitialized()) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Cannot serialize proto, missing required field ",
+                     proto.InitializationErrorString()));
+  }
+
+  if (!proto.SerializeToString(&bin_proto)) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Failed to convert proto to protobin for saving to ",
+        file_name.string(),
+        " (this generally stems from massive protobufs that either exhaust "
+        "memory or overflow a 32-bit buffer somewhere)."));
+  }
+  return bin_proto;
+}
+
 enum class SetOrAppend { kSet, kAppend };
 
 absl::Status SetFileContentsOrAppend(const std::filesystem::path& file_name,
@@ -190,6 +214,24 @@ absl::Status AppendStringToFile(const std::filesystem::path& file_name,
   return SetFileContentsOrAppend(file_name, content, SetOrAppend::kAppend);
 }
 
+absl::Status SetFileContentsAtomically(const std::filesystem::path& file_name,
+                                       std::string_view content) {
+  // The temporary file is in the same directory so the rename does not cross
+  // file systems. The pid and a per-process counter make its name unique.
+  static std::atomic<int64_t> next_temp_file_id(0);
+  std::filesystem::path temp_path =
+      absl::StrCat(file_name.string(), ".tmp.", getpid(), ".",
+                   next_temp_file_id.fetch_add(1));
+  absl::Status status = SetFileContents(temp_path, content);
+  if (status.ok() && rename(temp_path.c_str(), file_name.c_str()) != 0) {
+    status = ErrNoToStatusWithFilename(errno, file_name);
+  }
+  if (!status.ok()) {
+    unlink(temp_path.c_str());
+  }
+  return status;
+}
+
 absl::Status ParseTextProto(std::string_view contents,
                             const std::filesystem::path& file_name,
                             google::protobuf::Message* proto) {
@@ -236,23 +278,18 @@ absl::Status ParseProtobinFile(const std::filesystem::path& file_name,
 
 absl::Status SetProtobinFile(const std::filesystem::path& file_name,
                              const google::protobuf::Message& proto) {
-  std::string bin_proto;
-  if (!proto.IsInitialized()) {
-    return absl::FailedPreconditionError(
-        absl::StrCat("Cannot serialize proto, missing required field ",
-                     proto.InitializationErrorString()));
-  }
-
-  if (!proto.SerializeToString(&bin_proto)) {
-    return absl::FailedPreconditionError(absl::StrCat(
-        "Failed to convert proto to protobin for saving to ",
-        file_name.string(),
-        " (this generally stems from massive protobufs that either exhaust "
-        "memory or overflow a 32-bit buffer somewhere)."));
-  }
+  XLS_ASSIGN_OR_RETURN(std::string bin_proto,
+                       SerializeProtobin(file_name, proto));
   return SetFileContents(file_name, bin_proto);
 }
 
+absl::Status SetProtobinFileAtomically(const std::filesystem::path& file_name,
+                                       const google::protobuf::Message& proto) {
+  XLS_ASSIGN_OR_RETURN(std::string bin_proto,
+                       SerializeProtobin(file_name, proto));
+  return SetFileContentsAtomically(file_name, bin_proto);
+}
+
 absl::Status SetTextProtoFile(const std::filesystem::path& file_name,
                               const google::protobuf::Message& proto) {
   std::string text_proto;
@@ -225,6 +225,25 @@ absl::Status SetProtobinFile(const std::filesystem::path& file_name,
 absl::Status SetTextProtoFile(const std::filesystem::path& file_name,
                               const google::protobuf::Message& proto);
 
+// Like SetFileContents, except that the update is atomic: the data is written
+// to a temporary file next to `file_name`, which is then renamed over it.
+// Concurrent readers observe either the previous file or the complete new one,
+// never a partially written file. Each call uses a distinct temporary file, so
+// concurrent writers of the same file from any thread or process do not
+// interfere; the last rename wins. The temporary file is removed on failure.
+//
+// Typical return codes (not guaranteed exhaustive):
+//  * StatusCode::kOk
+//  * StatusCode::kPermissionDenied (directory not writable)
+//  * StatusCode::kUnknown (a Write or Open error occurred)
+absl::Status SetFileContentsAtomically(const std::filesystem::path& file_name,
+                                       std::string_view content);
+
+// Like SetProtobinFile, except that the file is written with
+// SetFileContentsAtomically.
+absl::Status SetProtobinFileAtomically(const std::filesystem::path& file_name,
+                                       const google::protobuf::Message& proto);
+
 // Returns the process's current working directory.
 absl::StatusOr<std::filesystem::path> GetCurrentDirectory();
 
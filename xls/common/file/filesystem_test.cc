@@ -33,6 +33,7 @@ using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using ::testing::AnyOf;
 using ::testing::Contains;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::HasSubstr;
 
@@ -442,5 +443,37 @@ TEST(FilesystemTest, ParseProtobinFile) {
   EXPECT_EQ(content.field(), "hi");
 }
 
+TEST(FilesystemTest, SetFileContentsAtomicallyReplacesFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "file";
+  XLS_ASSERT_OK(SetFileContentsAtomically(path, "first contents"));
+  XLS_ASSERT_OK(SetFileContentsAtomically(path, "second"));
+  EXPECT_THAT(GetFileContents(path), IsOkAndHolds("second"));
+
+  // No temporary files are left behind.
+  EXPECT_THAT(GetDirectoryEntries(temp_dir.path()),
+              IsOkAndHolds(ElementsAre(path)));
+}
+
+TEST(FilesystemTest, SetFileContentsAtomicallyRemovesTemporaryOnFailure) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  // A file cannot be renamed over a directory.
+  std::filesystem::path path = temp_dir.path() / "dir";
+  XLS_ASSERT_OK(RecursivelyCreateDir(path));
+  EXPECT_FALSE(SetFileContentsAtomically(path, "contents").ok());
+  EXPECT_THAT(GetDirectoryEntries(temp_dir.path()),
+              IsOkAndHolds(ElementsAre(path)));
+}
+
+TEST(FilesystemTest, SetProtobinFileAtomically) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  FilesystemTest proto;
+  proto.set_field("hi");
+  XLS_ASSERT_OK(SetProtobinFileAtomically(temp_dir.path() / "a.pb", proto));
+  FilesystemTest content;
+  XLS_ASSERT_OK(ParseProtobinFile(temp_dir.path() / "a.pb", &content));
+  EXPECT_EQ(content.field(), "hi");
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,14 +14,19 @@
 
 #include "xls/common/logging/vlog_is_on.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "absl/base/internal/spinlock.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/strip.h"
 #include "xls/common/logging/errno_saver.h"
 #include "xls/common/logging/vlog_is_on.inc"
 
-// Construct a logging site from a logging level and epoch.
+// Construct a logging site from a logging level and epoch. Levels outside
+// the int16_t range are clamped.
 inline int32_t Site(int level, int epoch) {
+  level = std::clamp(level, int{INT16_MIN} + 1, int{INT16_MAX});
   return ((level & 0x0000FFFF) << 16) | (epoch & 0x0000FFFF);
 }
 
@@ -119,8 +124,7 @@ int SetVLOGLevel(std::string_view module_pattern, int log_level) {
     info->next = vmodule_list.load(std::memory_order_relaxed);
     vmodule_list.store(info, std::memory_order_release);
   }
-  // Increment the epoch, marking all cached logging sites as stale.
-  ::xls::logging_internal::vlog_epoch.fetch_add(1, std::memory_order_release);
+  logging_internal::AdvanceVLogEpoch();
 
   if (XLS_VLOG_IS_ON(1)) {
     ABSL_RAW_LOG(INFO, "Set VLOG level for \"%.*s\" to %d",
@@ -132,6 +136,15 @@ int SetVLOGLevel(std::string_view module_pattern, int log_level) {
 
 namespace logging_internal {
 
+void AdvanceVLogEpoch() {
+  // Skip epoch 0 when the epoch wraps, as it is the epoch of
+  // never-initialized sites.
+  int32_t epoch = vlog_epoch.fetch_add(1, std::memory_order_release) + 1;
+  if ((epoch & 0x0000FFFF) == 0) {
+    vlog_epoch.fetch_add(1, std::memory_order_release);
+  }
+}
+
 // NOTE: Individual XLS_VLOG statements cache the integer log level pointers.
 // NOTE: This function must not allocate memory or require any locks.
 int InitVLOG(std::atomic<int32_t>* site, std::string_view full_path) {
@@ -172,7 +185,7 @@ int InitVLOG(std::atomic<int32_t>* site, std::string_view full_path) {
   // newer than the list we traverse or the log site we fetch.
   int32_t global_epoch = GlobalEpoch();
   int32_t old_site = site->load(std::memory_order_acquire);
-  int32_t new_site = Site(SiteLevel(kDefaultSite), global_epoch);
+  int32_t new_site = Site(absl::GetFlag(FLAGS_v), global_epoch);
 
   // Find target in list of modules, and set new_site with a
   // module-specific verbosity level, if found.
@@ -180,7 +193,7 @@ int InitVLOG(std::atomic<int32_t>* site, std::string_view full_path) {
 
   // If we find a matching module in the list, we use its
   // vlog_level to control the VLOG at the call site.  Otherwise,
-  // the site remains set to its default value.
+  // the site uses FLAGS_v.
   while (info != nullptr) {
     if (info->module_is_path) {
       // If there are any slashes in the pattern, try to match the full fname.
@@ -214,11 +227,6 @@ bool VLogEnabledSlow(std::atomic<int32_t>* site, int32_t level,
   int32_t site_level = ABSL_PREDICT_TRUE(SiteEpoch(site_copy) == GlobalEpoch())
                            ? SiteLevel(site_copy)
                            : InitVLOG(site, file);
-
-  if (site_level == kUseFlag) {
-    // Use global setting instead of per-site setting.
-    site_level = absl::GetFlag(FLAGS_v);
-  }
   return ABSL_PREDICT_FALSE(site_level >= level);
 }
 
@@ -58,13 +58,14 @@ ABSL_DECLARE_FLAG(std::string, vmodule);
 // We pack an int16_t verbosity level and an int16_t epoch into an
 // int32_t at every XLS_VLOG_IS_ON() call site.  The level determines
 // whether the site should log, and the epoch determines whether the
-// site is stale and should be reinitialized.  A verbosity level of
-// kUseFlag (kint16min) indicates that the value of FLAGS_v should be used as
-// the verbosity level.  When the site is (re)initialized, a verbosity
-// level for the current source file is retrieved from an internal
-// list.  This list is mutated through calls to SetVLOGLevel() and
-// mutations to the --vmodule flag.  New log sites are initialized
-// with a stale epoch and a verbosity level of kUseFlag.
+// site is stale and should be reinitialized.  When the site is
+// (re)initialized, the verbosity level for the current source file is
+// retrieved from an internal list, or from FLAGS_v if no pattern in the
+// list matches, and cached in the site.  The list is mutated through calls
+// to SetVLOGLevel() and mutations to the --vmodule flag; these and
+// mutations to the --v flag advance the global epoch.  New log sites are
+// initialized with a stale epoch, so a disabled site costs one load and
+// compare of the site and of the global epoch.
 #define XLS_VLOG_IS_ON(verbose_level)               \
   (::xls::logging_internal::VLogEnabled(            \
       []() -> std::atomic<int32_t>* {               \
@@ -95,12 +96,17 @@ namespace logging_internal {
 // global epoch is advanced, invalidating all site epochs.
 extern std::atomic<int32_t> vlog_epoch;
 
-// A log level of kUseFlag means "read the logging level from FLAGS_v."
+// The log level of a site which has never been initialized. The level is
+// resolved (from --vmodule or FLAGS_v) when the site is first initialized.
 const int kUseFlag = (int16_t)~0x7FFF;
 
-// Log sites use FLAGS_v by default, and have an initial epoch of 0.
+// Log sites have an initial epoch of 0, which the global epoch never takes,
+// so they are initially stale.
 const int32_t kDefaultSite = static_cast<unsigned int>(kUseFlag) << 16;
 
+// Advances the global epoch, marking all cached logging sites as stale.
+void AdvanceVLogEpoch();
+
 // The global epoch is the least significant half of an int32_t, and
 // may only be accessed through atomic operations.
 inline int32_t GlobalEpoch() {
@@ -136,15 +142,9 @@ ABSL_ATTRIBUTE_ALWAYS_INLINE
 inline bool VLogEnabled(std::atomic<int32_t>* site, int32_t level,
                         std::string_view file) {
   const int32_t site_copy = site->load(std::memory_order_acquire);
-  if (ABSL_PREDICT_TRUE(SiteEpoch(site_copy) == GlobalEpoch())) {
-    int32_t site_level = SiteLevel(site_copy);
-    if (site_level == kUseFlag) {
-      // Use global setting instead of per-site setting.
-      site_level = absl::GetFlag(FLAGS_v);
-    }
-    if (ABSL_PREDICT_TRUE(level > site_level)) {
-      return false;
-    }
+  if (ABSL_PREDICT_TRUE(level > SiteLevel(site_copy) &&
+                        SiteEpoch(site_copy) == GlobalEpoch())) {
+    return false;
   }
   return VLogEnabledSlow(site, level, file);
 }
@@ -33,6 +33,15 @@ TEST_F(VlogIsOnTest, GlobalFlagIsUsedByDefault) {
   ExpectVlogLevel(4);
 }
 
+TEST_F(VlogIsOnTest, GlobalFlagChangesApplyToInitializedSites) {
+  absl::SetFlag(&FLAGS_v, 1);
+  ExpectVlogLevel(1);
+  absl::SetFlag(&FLAGS_v, 3);
+  ExpectVlogLevel(3);
+  absl::SetFlag(&FLAGS_v, 0);
+  ExpectVlogLevel(0);
+}
+
 TEST_F(VlogIsOnTest, MismatchingModuleNamePatternDoesNotApply) {
   absl::SetFlag(&FLAGS_v, 5);
   SetVLOGLevel("something_else", 10);
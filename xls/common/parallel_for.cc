@@ -0,0 +1,51 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "xls/common/thread.h"
+
+namespace xls {
+
+void ParallelFor(int64_t count, int64_t thread_count,
+                 const std::function<void(int64_t)>& fn) {
+  if (thread_count == 0) {
+    thread_count = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+  }
+  thread_count = std::min(thread_count, count);
+
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < count;
+         i = next_index.fetch_add(1)) {
+      fn(i);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,34 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_PARALLEL_FOR_H_
+#define XLS_COMMON_PARALLEL_FOR_H_
+
+#include <cstdint>
+#include <functional>
+
+namespace xls {
+
+// Calls `fn(i)` for each i in [0, count) using up to `thread_count` threads,
+// one of which is the calling thread. Indices are handed out in increasing
+// order as threads become free, so a few expensive items do not hold up the
+// rest. A `thread_count` of zero uses one thread per hardware thread. Returns
+// once all calls have completed. `fn` must be safe to call concurrently for
+// distinct indices.
+void ParallelFor(int64_t count, int64_t thread_count,
+                 const std::function<void(int64_t)>& fn);
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_PARALLEL_FOR_H_
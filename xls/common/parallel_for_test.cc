@@ -0,0 +1,44 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/parallel_for.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+TEST(ParallelForTest, CallsEachIndexOnce) {
+  for (int64_t thread_count : {0, 1, 4, 100}) {
+    std::vector<std::atomic<int64_t>> calls(50);
+    ParallelFor(calls.size(), thread_count,
+                [&](int64_t i) { calls[i].fetch_add(1); });
+    for (const std::atomic<int64_t>& c : calls) {
+      EXPECT_EQ(c.load(), 1) << "thread_count: " << thread_count;
+    }
+  }
+}
+
+TEST(ParallelForTest, NoItems) {
+  bool called = false;
+  ParallelFor(0, 4, [&](int64_t i) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,37 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_STABLE_HASH_H_
+#define XLS_COMMON_STABLE_HASH_H_
+
+#include <cstdint>
+#include <string_view>
+
+namespace xls {
+
+// Returns the 64-bit FNV-1a hash of `s`. Unlike absl::Hash the value is the
+// same in every process and build, so it may be used to name files shared
+// between runs, e.g. the entries of an on-disk cache.
+inline uint64_t Fnv1aHash(std::string_view s) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : s) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_STABLE_HASH_H_
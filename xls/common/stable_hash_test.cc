@@ -0,0 +1,36 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/stable_hash.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+TEST(StableHashTest, Fnv1aKnownValues) {
+  EXPECT_EQ(Fnv1aHash(""), 0xcbf29ce484222325ULL);
+  EXPECT_EQ(Fnv1aHash("a"), 0xaf63dc4c8601ec8cULL);
+  EXPECT_EQ(Fnv1aHash("foobar"), 0x85944171f73967e8ULL);
+}
+
+TEST(StableHashTest, Fnv1aDistinguishesBytes) {
+  EXPECT_NE(Fnv1aHash("ab"), Fnv1aHash("ba"));
+  EXPECT_NE(Fnv1aHash(std::string_view("\0", 1)), Fnv1aHash(""));
+  EXPECT_NE(Fnv1aHash("\xff"), Fnv1aHash("\x7f"));
+}
+
+}  // namespace
+}  // namespace xls
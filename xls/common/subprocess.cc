@@ -17,6 +17,8 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <signal.h>
+#include <spawn.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/wait.h>
@@ -36,6 +38,16 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/common/strerror.h"
 
+extern char** environ;
+
+// posix_spawn_file_actions_addchdir_np is available from glibc 2.29 and
+// macOS 10.15.
+#if (defined(__GLIBC__) && \
+     (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))) || \
+    defined(__APPLE__)
+#define XLS_HAVE_SPAWN_ADDCHDIR 1
+#endif
+
 namespace xls {
 namespace {
 
@@ -60,6 +72,7 @@ struct Pipe {
   FileDescriptor entrance;
 };
 
+#ifndef XLS_HAVE_SPAWN_ADDCHDIR
 void PrepareAndExecInChildProcess(const std::vector<const char*>& argv_pointers,
                                   const std::filesystem::path& cwd,
                                   const Pipe& stdout_pipe,
@@ -82,11 +95,71 @@ void PrepareAndExecInChildProcess(const std::vector<const char*>& argv_pointers,
   XLS_LOG(ERROR) << "Execv syscall failed: " << Strerror(errno);
   _exit(127);
 }
+#endif
+
+// Starts the subprocess with its stdout and stderr redirected to the given
+// pipes and returns its pid. Uses posix_spawn, which (unlike fork) does not
+// copy the address space of the parent, so starting a subprocess costs the
+// same from a multi-GB tool as from a small one. Falls back to fork where
+// posix_spawn cannot change the working directory.
+absl::StatusOr<pid_t> SpawnChild(const std::vector<const char*>& argv_pointers,
+                                 const std::filesystem::path& cwd,
+                                 const Pipe& stdout_pipe,
+                                 const Pipe& stderr_pipe) {
+#ifndef XLS_HAVE_SPAWN_ADDCHDIR
+  if (!cwd.empty()) {
+    pid_t pid = fork();
+    if (pid == -1) {
+      return absl::InternalError(
+          absl::StrCat("Failed to fork: ", Strerror(errno)));
+    } else if (pid == 0) {
+      PrepareAndExecInChildProcess(argv_pointers, cwd, stdout_pipe,
+                                   stderr_pipe);
+    }
+    return pid;
+  }
+#endif
+
+  posix_spawn_file_actions_t actions;
+  int error = posix_spawn_file_actions_init(&actions);
+  if (error != 0) {
+    return absl::InternalError(absl::StrCat(
+        "posix_spawn_file_actions_init failed: ", Strerror(error)));
+  }
+  // The pipes are close-on-exec, so only the duplicates survive in the child.
+  error = posix_spawn_file_actions_adddup2(
+      &actions, stdout_pipe.entrance.get(), STDOUT_FILENO);
+  if (error == 0) {
+    error = posix_spawn_file_actions_adddup2(
+        &actions, stderr_pipe.entrance.get(), STDERR_FILENO);
+  }
+#ifdef XLS_HAVE_SPAWN_ADDCHDIR
+  if (error == 0 && !cwd.empty()) {
+    error = posix_spawn_file_actions_addchdir_np(&actions, cwd.c_str());
+  }
+#endif
+  pid_t pid;
+  if (error == 0) {
+    error = posix_spawn(&pid, argv_pointers[0], &actions, /*attrp=*/nullptr,
+                        const_cast<char* const*>(argv_pointers.data()),
+                        environ);
+  }
+  posix_spawn_file_actions_destroy(&actions);
+  if (error != 0) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to spawn %s: %s", argv_pointers[0], Strerror(error)));
+  }
+  return pid;
+}
+
+// How often ReadFileDescriptors checks for cancellation.
+constexpr int kCancelPollMilliseconds = 50;
 
 // Takes a list of file descriptor data streams and reads them into a list of
-// strings, one for each provided file descriptor. Uses poll.
+// strings, one for each provided file descriptor. Uses poll. Returns a
+// CancelledError if 'cancel' is non-null and gets notified first.
 absl::StatusOr<std::vector<std::string>> ReadFileDescriptors(
-    absl::Span<FileDescriptor*> fds) {
+    absl::Span<FileDescriptor*> fds, const absl::Notification* cancel) {
   absl::FixedArray<char> buffer(4096);
   std::vector<std::string> result;
   result.resize(fds.size());
@@ -105,8 +178,15 @@ absl::StatusOr<std::vector<std::string>> ReadFileDescriptors(
   };
 
   while (descriptors_left > 0) {
-    int data_count = poll(poll_list.data(), poll_list.size(), -1);
-    if (data_count <= 0) {
+    if (cancel != nullptr && cancel->HasBeenNotified()) {
+      return absl::CancelledError("Subprocess cancelled.");
+    }
+    int data_count = poll(poll_list.data(), poll_list.size(),
+                          cancel == nullptr ? -1 : kCancelPollMilliseconds);
+    if (data_count == 0) {
+      continue;
+    }
+    if (data_count < 0) {
       if (errno == EINTR) {
         continue;
       }
@@ -159,7 +239,8 @@ absl::StatusOr<int> WaitForPid(pid_t pid) {
 }  // namespace
 
 absl::StatusOr<std::pair<std::string, std::string>> InvokeSubprocess(
-    absl::Span<const std::string> argv, const std::filesystem::path& cwd) {
+    absl::Span<const std::string> argv, const std::filesystem::path& cwd,
+    const absl::Notification* cancel) {
   if (argv.empty()) {
     return absl::InvalidArgumentError("Cannot invoke empty argv list.");
   }
@@ -180,22 +261,23 @@ absl::StatusOr<std::pair<std::string, std::string>> InvokeSubprocess(
   XLS_ASSIGN_OR_RETURN(auto stdout_pipe, Pipe::Open());
   XLS_ASSIGN_OR_RETURN(auto stderr_pipe, Pipe::Open());
 
-  pid_t pid = fork();
-  if (pid == -1) {
-    return absl::InternalError(
-        absl::StrCat("Failed to fork: ", Strerror(errno)));
-  } else if (pid == 0) {
-    PrepareAndExecInChildProcess(argv_pointers, cwd, stdout_pipe, stderr_pipe);
-  }
-  // This is the parent process.
+  XLS_ASSIGN_OR_RETURN(
+      pid_t pid, SpawnChild(argv_pointers, cwd, stdout_pipe, stderr_pipe));
   stdout_pipe.entrance.Close();
   stderr_pipe.entrance.Close();
 
   // Read from the output streams of the subprocess.
   FileDescriptor* fds[] = {&stdout_pipe.exit, &stderr_pipe.exit};
-  XLS_ASSIGN_OR_RETURN(auto output_strings, ReadFileDescriptors(fds));
-  const auto& stdout_output = output_strings[0];
-  const auto& stderr_output = output_strings[1];
+  absl::StatusOr<std::vector<std::string>> output_strings =
+      ReadFileDescriptors(fds, cancel);
+  if (!output_strings.ok()) {
+    // Don't leave the subprocess running (or a zombie) behind.
+    kill(pid, SIGKILL);
+    WaitForPid(pid).IgnoreError();
+    return output_strings.status();
+  }
+  const auto& stdout_output = (*output_strings)[0];
+  const auto& stderr_output = (*output_strings)[1];
 
   XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stdout:\n ", stdout_output));
   XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stderr:\n ", stderr_output));
@@ -19,15 +19,18 @@
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
 #include "absl/types/span.h"
 
 namespace xls {
 
 // Invokes a subprocess with the given argv. If 'cwd' is not empty the
 // subprocess will be invoked in the given directory. Returns the
-// stdout/stderr as a string pair.
+// stdout/stderr as a string pair. If 'cancel' is given and is notified before
+// the subprocess exits, the subprocess is killed and a CancelledError returned.
 absl::StatusOr<std::pair<std::string, std::string>> InvokeSubprocess(
-    absl::Span<const std::string> argv, const std::filesystem::path& cwd = "");
+    absl::Span<const std::string> argv, const std::filesystem::path& cwd = "",
+    const absl::Notification* cancel = nullptr);
 }
 
 #endif  // XLS_COMMON_SUBPROCESS_H_
@@ -16,7 +16,11 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 
 namespace xls {
 namespace {
@@ -66,5 +70,41 @@ TEST(SubprocessTest, LargeOutputToStderrFirstWorks) {
   EXPECT_THAT(result->second, HasSubstr("\n10000\n"));
 }
 
+TEST(SubprocessTest, RunsInWorkingDirectory) {
+  auto result = InvokeSubprocess({"/bin/sh", "-c", "/bin/pwd"}, "/");
+
+  XLS_ASSERT_OK(result);
+  EXPECT_EQ(result->first, "/\n");
+}
+
+TEST(SubprocessTest, MissingBinaryFails) {
+  auto result = InvokeSubprocess({"/nonexistent/binary"});
+
+  EXPECT_THAT(result, StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST(SubprocessTest, CancelKillsSubprocess) {
+  absl::Notification cancel;
+  Thread canceller([&cancel]() {
+    absl::SleepFor(absl::Milliseconds(100));
+    cancel.Notify();
+  });
+  absl::Time start = absl::Now();
+  auto result = InvokeSubprocess({"/bin/sleep", "60"}, "", &cancel);
+  canceller.Join();
+
+  EXPECT_THAT(result, StatusIs(absl::StatusCode::kCancelled));
+  EXPECT_LT(absl::Now() - start, absl::Seconds(30));
+}
+
+TEST(SubprocessTest, UncancelledCommandWorks) {
+  absl::Notification cancel;
+  auto result = InvokeSubprocess({"/bin/sh", "-c", "/bin/echo hey"}, "",
+                                 &cancel);
+
+  XLS_ASSERT_OK(result);
+  EXPECT_EQ(result->first, "hey\n");
+}
+
 }  // namespace
 }  // namespace xls
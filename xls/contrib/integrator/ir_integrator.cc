@@ -574,30 +574,29 @@ absl::StatusOr<float> IntegrationFunction::GetInsertNodeCost(
   return insert_cost.value();
 }
 
+absl::Status IntegrationFunction::ValidateNodeForMerge(const Node* node) const {
+  if (IntegrationFunctionOwnsNode(node)) {
+    if (!IsMappingTarget(node)) {
+      // TODO(jbaileyhandle): Relax this requirement so that
+      // it only applies to integration-generated muxes and params.
+      return absl::FailedPreconditionError(absl::StrCat(
+          "Trying to merge non-mapping-target integration node: ",
+          node->ToString()));
+    }
+  } else {
+    if (HasMapping(node)) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "Trying to merge non-integration node that already has mapping: ",
+          node->ToString()));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<IntegrationFunction::MergeNodesBackendResult>
 IntegrationFunction::MergeNodesBackend(const Node* node_a, const Node* node_b) {
-  // TODO(jbaileyhandle): If we add any more precondition checks, move
-  // precondition checks into a separate function.
-  auto validate_node = [this](const Node* node) {
-    if (IntegrationFunctionOwnsNode(node)) {
-      if (!IsMappingTarget(node)) {
-        // TODO(jbaileyhandle): Relax this requirement so that
-        // it only applies to integration-generated muxes and params.
-        return absl::FailedPreconditionError(absl::StrCat(
-            "Trying to merge non-mapping-target integration node: ",
-            node->ToString()));
-      }
-    } else {
-      if (HasMapping(node)) {
-        return absl::FailedPreconditionError(absl::StrCat(
-            "Trying to merge non-integration node that already has mapping: ",
-            node->ToString()));
-      }
-    }
-    return absl::OkStatus();
-  };
-  XLS_RETURN_IF_ERROR(validate_node(node_a));
-  XLS_RETURN_IF_ERROR(validate_node(node_b));
+  XLS_RETURN_IF_ERROR(ValidateNodeForMerge(node_a));
+  XLS_RETURN_IF_ERROR(ValidateNodeForMerge(node_b));
 
   // Special cases that cannot be merged.
   if (node_a != node_b) {
@@ -636,8 +635,75 @@ IntegrationFunction::MergeNodesBackend(const Node* node_a, const Node* node_b) {
   return MergeNodesBackendResult{.can_merge = false};
 }
 
+absl::StatusOr<std::optional<std::vector<int64_t>>>
+IntegrationFunction::GetMergeCostCacheKey(const Node* node_a,
+                                          const Node* node_b) const {
+  if (node_a->operand_count() != node_b->operand_count() ||
+      !AllOperandsHaveMapping(node_a) || !AllOperandsHaveMapping(node_b)) {
+    return std::nullopt;
+  }
+  std::vector<int64_t> key = {node_a->id(), node_b->id()};
+  for (const Node* node : {node_a, node_b}) {
+    if (IntegrationFunctionOwnsNode(node)) {
+      XLS_ASSIGN_OR_RETURN(std::set<int64_t> source_indexes,
+                           GetSourceFunctionIndexesOfNodesMappedToNode(node));
+      key.push_back(source_indexes.size());
+      key.insert(key.end(), source_indexes.begin(), source_indexes.end());
+    }
+  }
+
+  // How unifying a pair of operands changes the muxes of the function.
+  enum OperandUnification : int64_t {
+    kSameNode,
+    kNewMux,
+    kExistingMux,
+    kBothMuxes,
+  };
+  XLS_ASSIGN_OR_RETURN(std::vector<Node*> a_ops, GetIntegratedOperands(node_a));
+  XLS_ASSIGN_OR_RETURN(std::vector<Node*> b_ops, GetIntegratedOperands(node_b));
+  for (int64_t i = 0; i < a_ops.size(); ++i) {
+    if (a_ops[i] == b_ops[i]) {
+      key.push_back(kSameNode);
+    } else if (integration_options_.unique_select_signal_per_mux()) {
+      key.push_back(node_pair_to_mux_.contains(
+                        std::pair<const Node*, const Node*>(a_ops[i], b_ops[i]))
+                        ? kExistingMux
+                        : kNewMux);
+    } else {
+      int64_t mux_count = global_mux_to_metadata_.contains(a_ops[i]) +
+                          global_mux_to_metadata_.contains(b_ops[i]);
+      key.push_back(mux_count == 0   ? kNewMux
+                    : mux_count == 1 ? kExistingMux
+                                     : kBothMuxes);
+    }
+  }
+  return key;
+}
+
 absl::StatusOr<std::optional<int64_t>> IntegrationFunction::GetMergeNodesCost(
     const Node* node_a, const Node* node_b) {
+  // The validity of the nodes depends on the mappings and is not captured by
+  // the cache key.
+  XLS_RETURN_IF_ERROR(ValidateNodeForMerge(node_a));
+  XLS_RETURN_IF_ERROR(ValidateNodeForMerge(node_b));
+  XLS_ASSIGN_OR_RETURN(std::optional<std::vector<int64_t>> key,
+                       GetMergeCostCacheKey(node_a, node_b));
+  if (!key.has_value()) {
+    return ComputeMergeNodesCost(node_a, node_b);
+  }
+  auto it = merge_cost_cache_.find(*key);
+  if (it != merge_cost_cache_.end()) {
+    return it->second;
+  }
+  XLS_ASSIGN_OR_RETURN(std::optional<int64_t> cost,
+                       ComputeMergeNodesCost(node_a, node_b));
+  merge_cost_cache_[*std::move(key)] = cost;
+  return cost;
+}
+
+absl::StatusOr<std::optional<int64_t>>
+IntegrationFunction::ComputeMergeNodesCost(const Node* node_a,
+                                           const Node* node_b) {
   XLS_ASSIGN_OR_RETURN(MergeNodesBackendResult merge_result,
                        MergeNodesBackend(node_a, node_b));
   // Can't merge nodes.
@@ -62,7 +62,11 @@ class IntegrationFunction {
   absl::StatusOr<Node*> InsertNode(Node* to_insert);
 
   // Estimate the cost of merging node_a and node_b. If nodes cannot be
-  // merged, not value is returned.
+  // merged, not value is returned. Costs are memoized by the merged nodes and
+  // the state of the muxes which merging them would add or modify (see
+  // GetMergeCostCacheKey), so repeatedly estimating the cost of merging the
+  // same candidates, as integration algorithms do after each move, does not
+  // repeat the trial merge.
   absl::StatusOr<std::optional<int64_t>> GetMergeNodesCost(const Node* node_a,
                                                            const Node* node_b);
 
@@ -204,6 +208,25 @@ class IntegrationFunction {
   absl::StatusOr<MergeNodesBackendResult> MergeNodesBackend(const Node* node_a,
                                                             const Node* node_b);
 
+  // Returns an error if 'node' may not be merged: it is either an integration
+  // function node which is not a mapping target or an external node which
+  // already has a mapping.
+  absl::Status ValidateNodeForMerge(const Node* node) const;
+
+  // Estimates the cost of merging node_a and node_b by performing the merge
+  // and then reverting it. Not memoized.
+  absl::StatusOr<std::optional<int64_t>> ComputeMergeNodesCost(
+      const Node* node_a, const Node* node_b);
+
+  // Returns the key under which the cost of merging node_a and node_b is
+  // memoized, or std::nullopt if the cost should not be memoized. The cost is
+  // determined by the nodes themselves, the source functions mapped to them
+  // and, for each operand position, whether unifying the operands is a no-op,
+  // adds a mux, or modifies an existing mux. Node ids are used rather than
+  // pointers because ids are never reused within a package.
+  absl::StatusOr<std::optional<std::vector<int64_t>>> GetMergeCostCacheKey(
+      const Node* node_a, const Node* node_b) const;
+
   // For the integration function nodes node_a and node_b,
   // returns a single integration function node that combines the two
   // nodes. If a node combining node_a and node_b does not already
@@ -286,6 +309,10 @@ class IntegrationFunction {
   // select signal.
   absl::flat_hash_map<Node*, GlobalMuxMetadata> global_mux_to_metadata_;
 
+  // Memoized results of GetMergeNodesCost indexed by GetMergeCostCacheKey.
+  absl::flat_hash_map<std::vector<int64_t>, std::optional<int64_t>>
+      merge_cost_cache_;
+
   // Source function in the integration package.
   std::vector<const Function*> source_functions_;
 
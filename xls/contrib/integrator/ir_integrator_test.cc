@@ -33,6 +33,7 @@ using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::Optional;
 using ::testing::UnorderedElementsAre;
 
 class IntegratorTest : public IrTestBase {};
@@ -2126,6 +2127,55 @@ TEST_F(IntegratorTest, MergeCostExternalExternalTwoMux) {
             IntegrationFunction::UnificationChange::kNewMuxAdded);
 }
 
+TEST_F(IntegratorTest, MergeCostMemoizedByMuxState) {
+  auto p = CreatePackage();
+  FunctionBuilder fb_a("func_a", p.get());
+  auto a_in1 = fb_a.Param("in1", p->GetBitsType(2));
+  auto a_in2 = fb_a.Param("in2", p->GetBitsType(2));
+  fb_a.Add(a_in1, a_in2, SourceInfo(), "add");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_a, fb_a.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_b, func_a->Clone("func_b"));
+  Node* a_in1_node = FindNode("in1", func_a);
+  Node* a_add_node = FindNode("add", func_a);
+  Node* b_in1_node = FindNode("in1", func_b);
+  Node* b_add_node = FindNode("add", func_b);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IntegrationFunction> integration,
+      IntegrationFunction::MakeIntegrationFunctionWithParamTuples(
+          p.get(), {func_a, func_b},
+          IntegrationOptions().unique_select_signal_per_mux(true)));
+  int64_t add_cost = integration->GetNodeCost(a_add_node);
+  int64_t mux_cost = 1;
+
+  // Repeated estimates return the same cost and leave the function unchanged.
+  int64_t init_node_count = integration->function()->node_count();
+  for (int64_t i = 0; i < 2; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::optional<int64_t> cost,
+        integration->GetMergeNodesCost(a_add_node, b_add_node));
+    EXPECT_THAT(cost, Optional(add_cost + 2 * mux_cost));
+    EXPECT_EQ(integration->function()->node_count(), init_node_count);
+  }
+
+  // Once a mux exists for the first operands only one new mux is needed.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * a_in1_target,
+                           integration->GetNodeMapping(a_in1_node));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * b_in1_target,
+                           integration->GetNodeMapping(b_in1_node));
+  XLS_ASSERT_OK(
+      integration->UnifyIntegrationNodes(a_in1_target, b_in1_target).status());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::optional<int64_t> cost,
+      integration->GetMergeNodesCost(a_add_node, b_add_node));
+  EXPECT_THAT(cost, Optional(add_cost + mux_cost));
+
+  // Validity is checked even if the cost is memoized.
+  XLS_ASSERT_OK(integration->InsertNode(a_add_node).status());
+  EXPECT_THAT(integration->GetMergeNodesCost(a_add_node, b_add_node),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
 TEST_F(IntegratorTest, MergeCostInternalExternalOneMux) {
   auto p = CreatePackage();
   FunctionBuilder fb_a("func_a", p.get());
@@ -23,6 +23,7 @@
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/AST/RecursiveASTVisitor.h"
 #include "clang/include/clang/Frontend/CompilerInstance.h"
+#include "clang/include/clang/Frontend/FrontendActions.h"
 #include "clang/include/clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/include/clang/Tooling/Tooling.h"
 #include "xls/common/logging/logging.h"
@@ -149,6 +150,28 @@ absl::Status CCParser::ScanFile(
   return libtool_visit_status_;
 }
 
+absl::Status CCParser::GeneratePrecompiledHeader(
+    std::string_view header_filename, std::string_view pch_filename,
+    absl::Span<std::string_view> command_line_args) {
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  argv.emplace_back(header_filename);
+  AddCommonClangArgs(command_line_args, argv);
+  argv.emplace_back("-x");
+  argv.emplace_back("c++-header");
+  // Parsing includes the builtin header first, so it is part of the
+  // precompiled header too.
+  argv.emplace_back("-include");
+  argv.emplace_back("/xls_builtin.h");
+  argv.emplace_back("-o");
+  argv.emplace_back(pch_filename);
+
+  libtool_visit_status_ = absl::OkStatus();
+  RunClangTool(argv, std::make_unique<clang::GeneratePCHAction>(),
+               /*top_src=*/"", *this);
+  return libtool_visit_status_;
+}
+
 void CCParser::AddSourceInfoToMetadata(xlscc_metadata::MetadataOutput& output) {
   for (const auto& [path, number] : file_numbers_) {
     xlscc_metadata::SourceName* source = output.add_sources();
@@ -394,46 +417,9 @@ absl::StatusOr<const clang::VarDecl*> CCParser::GetXlsccOnReset() const {
   return xlscc_on_reset_;
 }
 
-LibToolThread::LibToolThread(std::string_view source_filename,
-                             absl::Span<std::string_view> command_line_args,
-                             CCParser& parser)
-    : source_filename_(source_filename),
-      command_line_args_(command_line_args),
-      parser_(parser) {}
-
-void LibToolThread::Start() {
-  thread_.emplace([this] { Run(); });
-}
-
-void LibToolThread::Join() { thread_->Join(); }
+namespace {
 
-void LibToolThread::Run() {
-  std::vector<std::string> argv;
-  argv.emplace_back("binary");
-  argv.emplace_back("/xls_top.cc");
-  for (const auto& view : command_line_args_) {
-    argv.emplace_back(view);
-  }
-  // For xls_top.cc to include the source file
-  argv.emplace_back("-I.");
-  argv.emplace_back("-fsyntax-only");
-  argv.emplace_back("-std=c++17");
-  argv.emplace_back("-nostdinc");
-  argv.emplace_back("-Wno-unused-label");
-  argv.emplace_back("-Wno-constant-logical-operand");
-  argv.emplace_back("-Wno-unused-but-set-variable");
-  argv.emplace_back("-Wno-c++11-narrowing");
-
-  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
-
-  std::unique_ptr<LibToolFrontendAction> libtool_action(
-      new LibToolFrontendAction(parser_));
-
-  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
-      new llvm::vfs::InMemoryFileSystem);
-  mem_fs->addFile("/xls_builtin.h", 0,
-                  llvm::MemoryBuffer::getMemBuffer(
-                      R"(
+const char kXlsBuiltinHeader[] = R"(
 #ifndef __XLS_BUILTIN_H
 #define __XLS_BUILTIN_H
 template<int N>
@@ -459,16 +445,45 @@ int __xlscc_unimplemented() { return 0; }
 bool __xlscc_on_reset = false;
 
 #endif//__XLS_BUILTIN_H
-          )"));
+          )";
 
-  const std::string top_src = absl::StrFormat(R"(
-#include "/xls_builtin.h"
-#include "%s"
-          )",
-                                              source_filename_);
+// Flags passed to clang for both parsing and precompiling headers. These
+// must match between the two for clang to accept a precompiled header.
+void AddCommonClangArgs(absl::Span<std::string_view> command_line_args,
+                        std::vector<std::string>& argv) {
+  for (const auto& view : command_line_args) {
+    argv.emplace_back(view);
+  }
+  // For xls_top.cc to include the source file
+  argv.emplace_back("-I.");
+  argv.emplace_back("-std=c++17");
+  argv.emplace_back("-nostdinc");
+  argv.emplace_back("-Wno-unused-label");
+  argv.emplace_back("-Wno-constant-logical-operand");
+  argv.emplace_back("-Wno-unused-but-set-variable");
+  argv.emplace_back("-Wno-c++11-narrowing");
+}
 
-  mem_fs->addFile("/xls_top.cc", 0,
-                  llvm::MemoryBuffer::getMemBuffer(top_src.c_str()));
+// Runs `action` with clang over a file system in which /xls_builtin.h is
+// available, as is /xls_top.cc with the contents `top_src`, if non-empty.
+// Errors are recorded in the parser via DiagnosticInterceptor.
+void RunClangTool(const std::vector<std::string>& argv,
+                  std::unique_ptr<clang::FrontendAction> action,
+                  std::string_view top_src, CCParser& parser) {
+  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
+
+  // The modification time of the builtin header must be stable, as clang
+  // checks it when loading a precompiled header which includes it.
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
+      new llvm::vfs::InMemoryFileSystem);
+  mem_fs->addFile("/xls_builtin.h", 0,
+                  llvm::MemoryBuffer::getMemBuffer(kXlsBuiltinHeader));
+
+  if (!top_src.empty()) {
+    mem_fs->addFile("/xls_top.cc", 0,
+                    llvm::MemoryBuffer::getMemBufferCopy(
+                        llvm::StringRef(top_src.data(), top_src.size())));
+  }
 
   llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
       new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
@@ -479,19 +494,51 @@ bool __xlscc_on_reset = false;
       new clang::FileManager(clang::FileSystemOptions(), overlay_fs);
 
   std::unique_ptr<clang::tooling::ToolInvocation> libtool_inv(
-      new clang::tooling::ToolInvocation(argv, std::move(libtool_action),
+      new clang::tooling::ToolInvocation(argv, std::move(action),
                                          libtool_files.get()));
 
   llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diag_opts =
       new clang::DiagnosticOptions();
-  DiagnosticInterceptor diag_print(parser_, llvm::errs(), &*diag_opts);
+  DiagnosticInterceptor diag_print(parser, llvm::errs(), &*diag_opts);
   libtool_inv->setDiagnosticConsumer(&diag_print);
 
   // Errors are extracted via DiagnosticInterceptor,
-  //  since we block in run() until ~CCParser()
+  //  since for parsing we block in run() until ~CCParser()
   (void)libtool_inv->run();
 }
 
+}  // namespace
+
+LibToolThread::LibToolThread(std::string_view source_filename,
+                             absl::Span<std::string_view> command_line_args,
+                             CCParser& parser)
+    : source_filename_(source_filename),
+      command_line_args_(command_line_args),
+      parser_(parser) {}
+
+void LibToolThread::Start() {
+  thread_.emplace([this] { Run(); });
+}
+
+void LibToolThread::Join() { thread_->Join(); }
+
+void LibToolThread::Run() {
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  argv.emplace_back("/xls_top.cc");
+  AddCommonClangArgs(command_line_args_, argv);
+  argv.emplace_back("-fsyntax-only");
+
+  const std::string top_src = absl::StrFormat(R"(
+#include "/xls_builtin.h"
+#include "%s"
+          )",
+                                              source_filename_);
+
+  RunClangTool(argv, std::make_unique<LibToolFrontendAction>(parser_),
+               top_src, parser_);
+}
+
 void LibToolFrontendAction::EndSourceFileAction() {
   // ToolInvocation::run() from returning until ~CCParser()
   parser_.libtool_wait_for_parse_->DecrementCount();
@@ -109,6 +109,18 @@ class CCParser {
   absl::Status ScanFile(std::string_view source_filename,
                         absl::Span<std::string_view> command_line_args);
 
+  // Uses Clang to precompile the header header_filename, along with the
+  //  xlscc builtins, into pch_filename.
+  //
+  // Passing "-include-pch <pch_filename>" to ScanFile() then avoids
+  //  re-parsing the header, which is worthwhile for large headers such as
+  //  ac_datatypes shared by many translation units. command_line_args must
+  //  be the same as those passed to ScanFile(), except for -include-pch,
+  //  or Clang will reject the precompiled header.
+  absl::Status GeneratePrecompiledHeader(
+      std::string_view header_filename, std::string_view pch_filename,
+      absl::Span<std::string_view> command_line_args);
+
   // Call after ScanFile, as the top function may be specified by #pragma
   // If none was found, an error is returned
   absl::StatusOr<std::string> GetEntryFunctionName() const;
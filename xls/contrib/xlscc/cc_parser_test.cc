@@ -361,4 +361,55 @@ TEST_F(CCParserTest, PragmaZeroExtend) {
   ASSERT_EQ(pragma.type(), xlscc::Pragma_ArrayAllowDefaultPad);
 }
 
+TEST_F(CCParserTest, PrecompiledHeader) {
+  const std::string header_src = R"(
+    template<typename T>
+    T add(T a, T b) {
+      return a + b;
+    }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempFile header,
+                           xls::TempFile::CreateWithContent(header_src, ".h"));
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempFile pch, xls::TempFile::Create(".pch"));
+  const std::string header_path = header.path().string();
+  const std::string pch_path = pch.path().string();
+
+  // Same as the arguments added by ScanTempFileWithContent()
+  std::vector<std::string_view> pch_argv = {"-Werror", "-Wall",
+                                            "-Wno-unknown-pragmas"};
+  {
+    xlscc::CCParser pch_parser;
+    XLS_ASSERT_OK(pch_parser.GeneratePrecompiledHeader(
+        header_path, pch_path, absl::MakeSpan(pch_argv)));
+  }
+
+  xlscc::CCParser parser;
+
+  const std::string cpp_src = R"(
+    #pragma hls_top
+    int foo(int a, int b) {
+      return add(a, b);
+    }
+  )";
+
+  XLS_ASSERT_OK(
+      ScanTempFileWithContent(cpp_src, {"-include-pch", pch_path}, &parser));
+  XLS_ASSERT_OK_AND_ASSIGN(const auto* top_ptr, parser.GetTopFunction());
+  EXPECT_NE(top_ptr, nullptr);
+  XLS_EXPECT_OK(parser.GetXlsccOnReset().status());
+}
+
+TEST_F(CCParserTest, PrecompiledHeaderError) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      xls::TempFile header,
+      xls::TempFile::CreateWithContent("int x = undeclared;", ".h"));
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempFile pch, xls::TempFile::Create(".pch"));
+
+  xlscc::CCParser parser;
+  EXPECT_THAT(parser.GeneratePrecompiledHeader(header.path().string(),
+                                               pch.path().string(), {}),
+              xls::status_testing::StatusIs(
+                  absl::StatusCode::kFailedPrecondition));
+}
+
 }  // namespace
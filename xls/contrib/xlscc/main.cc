@@ -43,6 +43,10 @@ xlscc foo.cc
 Emit combinational Verilog module:
 xlscc foo.cc --block_pb block_info.pb
 
+Precompile a header shared by several sources, then use it:
+xlscc ac_int.h --generate_pch_out ac_int.pch
+xlscc foo.cc --pch ac_int.pch
+
 )";
 
 ABSL_FLAG(std::string, out, "",
@@ -66,6 +70,14 @@ ABSL_FLAG(std::vector<std::string>, defines, std::vector<std::string>(),
 ABSL_FLAG(std::vector<std::string>, include_dirs, std::vector<std::string>(),
           "Comma separated list of include directories to pass to clang");
 
+ABSL_FLAG(std::string, generate_pch_out, "",
+          "If specified, precompile the input file, a header, into a "
+          "precompiled header at this path instead of generating IR");
+
+ABSL_FLAG(std::string, pch, "",
+          "Precompiled header, generated by --generate_pch_out with the same "
+          "clang arguments, to include before the input file");
+
 ABSL_FLAG(std::string, meta_out, "",
           "Path at which to output metadata protobuf");
 
@@ -87,6 +99,12 @@ ABSL_FLAG(int, max_unroll_iters, 1000,
 ABSL_FLAG(int, warn_unroll_iters, 100,
           "Maximum number of iterations to allow loops to be unrolled");
 
+ABSL_FLAG(bool, unroll_as_counted_for, false,
+          "Translate the bodies of loops to be unrolled only once, as "
+          "counted_for loops, where the bodies don't need to be specialized "
+          "for each iteration. This reduces translation time and IR size "
+          "before optimization");
+
 namespace xlscc {
 
 absl::Status Run(std::string_view cpp_path) {
@@ -97,6 +115,10 @@ absl::Status Run(std::string_view cpp_path) {
                                absl::GetFlag(FLAGS_max_unroll_iters),
                                absl::GetFlag(FLAGS_warn_unroll_iters));
 
+  if (absl::GetFlag(FLAGS_unroll_as_counted_for)) {
+    translator.SetUnrollAsCountedFor();
+  }
+
   const std::string block_pb_name = absl::GetFlag(FLAGS_block_pb);
 
   HLSBlock block;
@@ -138,11 +160,30 @@ absl::Status Run(std::string_view cpp_path) {
     clang_argvs.push_back(absl::StrCat("-I", dir));
   }
 
+  const std::string generate_pch_out = absl::GetFlag(FLAGS_generate_pch_out);
+  const std::string pch = absl::GetFlag(FLAGS_pch);
+
+  // Only the input file is parsed when precompiling it
+  if (!pch.empty() && generate_pch_out.empty()) {
+    clang_argvs.push_back("-include-pch");
+    clang_argvs.push_back(pch);
+  }
+
   std::vector<std::string_view> clang_argv;
   for (size_t i = 0; i < clang_argvs.size(); ++i) {
     clang_argv.push_back(clang_argvs[i]);
   }
 
+  if (!generate_pch_out.empty()) {
+    std::cerr << "Precompiling header '" << cpp_path << "' with clang..."
+              << std::endl;
+    return translator.GeneratePrecompiledHeader(
+        cpp_path, generate_pch_out,
+        clang_argv.empty()
+            ? absl::Span<std::string_view>()
+            : absl::MakeSpan(&clang_argv[0], clang_argv.size()));
+  }
+
   std::cerr << "Parsing file '" << cpp_path << "' with clang..." << std::endl;
   XLS_RETURN_IF_ERROR(translator.ScanFile(
       cpp_path, clang_argv.empty()
@@ -28,6 +28,42 @@ double doubletime() {
   return tv.tv_sec + static_cast<double>(tv.tv_usec) / 1000000.0;
 }
 
+// Returns true if the loop body stmt contains constructs which can't be
+// translated once for all iterations: jumps out of the body, static
+// declarations, or IO via the channel parameters of the enclosing function.
+bool BodyNeedsUnrolling(const clang::Stmt* stmt,
+                        const xlscc::GeneratedFunction& enclosing_func) {
+  if (stmt == nullptr) {
+    return false;
+  }
+  if (clang::isa<clang::BreakStmt>(stmt) ||
+      clang::isa<clang::ReturnStmt>(stmt) ||
+      clang::isa<clang::GotoStmt>(stmt)) {
+    return true;
+  }
+  if (auto decl_stmt = clang::dyn_cast<clang::DeclStmt>(stmt)) {
+    for (const clang::Decl* decl : decl_stmt->decls()) {
+      auto var_decl = clang::dyn_cast<clang::VarDecl>(decl);
+      if (var_decl != nullptr && var_decl->isStaticLocal()) {
+        return true;
+      }
+    }
+  }
+  if (auto ref = clang::dyn_cast<clang::DeclRefExpr>(stmt)) {
+    auto param = clang::dyn_cast<clang::ParmVarDecl>(ref->getDecl());
+    if (param != nullptr &&
+        enclosing_func.io_channels_by_param.contains(param)) {
+      return true;
+    }
+  }
+  for (const clang::Stmt* child : stmt->children()) {
+    if (BodyNeedsUnrolling(child, enclosing_func)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 namespace xlscc {
@@ -46,6 +82,14 @@ absl::Status Translator::GenerateIR_Loop(
   }
   XLS_ASSIGN_OR_RETURN(Pragma pragma, FindPragmaForLoc(presumed_loc));
   if (pragma.type() == Pragma_Unroll || context().for_loops_default_unroll) {
+    if (unroll_as_counted_for_ && !always_first_iter) {
+      XLS_ASSIGN_OR_RETURN(
+          bool generated,
+          GenerateIR_CountedForLoop(init, cond_expr, inc, body, ctx, loc));
+      if (generated) {
+        return absl::OkStatus();
+      }
+    }
     return GenerateIR_UnrolledLoop(always_first_iter, init, cond_expr, inc,
                                    body, ctx, loc);
   }
@@ -202,6 +246,316 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
   return absl::OkStatus();
 }
 
+absl::StatusOr<bool> Translator::GenerateIR_CountedForLoop(
+    const clang::Stmt* init, const clang::Expr* cond_expr,
+    const clang::Stmt* inc, const clang::Stmt* body, clang::ASTContext& ctx,
+    const xls::SourceInfo& loc) {
+  // Match for (T i = start; i <op> bound; i += step), with constant start,
+  // bound, and step
+  auto init_stmt = clang::dyn_cast_or_null<clang::DeclStmt>(init);
+  if (init_stmt == nullptr || !init_stmt->isSingleDecl()) {
+    return false;
+  }
+  auto counter = clang::dyn_cast<clang::VarDecl>(init_stmt->getSingleDecl());
+  if (counter == nullptr || !counter->getType()->isIntegerType() ||
+      counter->getType()->isBooleanType() || counter->getInit() == nullptr ||
+      !counter->getInit()->isIntegerConstantExpr(ctx)) {
+    return false;
+  }
+  auto refers_to_counter = [counter](const clang::Expr* expr) {
+    auto ref = clang::dyn_cast<clang::DeclRefExpr>(expr->IgnoreParenImpCasts());
+    return ref != nullptr && ref->getDecl() == counter;
+  };
+
+  auto cond_op = clang::dyn_cast_or_null<clang::BinaryOperator>(
+      cond_expr == nullptr ? nullptr : cond_expr->IgnoreParens());
+  if (cond_op == nullptr || !refers_to_counter(cond_op->getLHS()) ||
+      !cond_op->getRHS()->isIntegerConstantExpr(ctx)) {
+    return false;
+  }
+
+  const clang::Expr* inc_expr = clang::dyn_cast_or_null<clang::Expr>(inc);
+  if (inc_expr == nullptr) {
+    return false;
+  }
+  inc_expr = inc_expr->IgnoreParens();
+  int64_t step = 0;
+  if (auto unary = clang::dyn_cast<clang::UnaryOperator>(inc_expr)) {
+    if (!unary->isIncrementDecrementOp() ||
+        !refers_to_counter(unary->getSubExpr())) {
+      return false;
+    }
+    step = unary->isIncrementOp() ? 1 : -1;
+  } else if (auto compound =
+                 clang::dyn_cast<clang::CompoundAssignOperator>(inc_expr)) {
+    if ((compound->getOpcode() != clang::BO_AddAssign &&
+         compound->getOpcode() != clang::BO_SubAssign) ||
+        !refers_to_counter(compound->getLHS()) ||
+        !compound->getRHS()->isIntegerConstantExpr(ctx)) {
+      return false;
+    }
+    XLS_ASSIGN_OR_RETURN(step, EvaluateInt64(*compound->getRHS(), ctx, loc));
+    if (compound->getOpcode() == clang::BO_SubAssign) {
+      step = -step;
+    }
+  } else {
+    return false;
+  }
+
+  // Limit the counter width so that the arithmetic below can't overflow
+  const int64_t counter_width = ctx.getIntWidth(counter->getType());
+  const bool counter_signed = counter->getType()->isSignedIntegerType();
+  if (counter_width > 32 || step == 0 || step > INT32_MAX ||
+      step < INT32_MIN) {
+    return false;
+  }
+
+  XLS_ASSIGN_OR_RETURN(int64_t start,
+                       EvaluateInt64(*counter->getInit(), ctx, loc));
+  XLS_ASSIGN_OR_RETURN(int64_t bound,
+                       EvaluateInt64(*cond_op->getRHS(), ctx, loc));
+  const int64_t limit = INT64_C(1) << 33;
+  if (start > limit || start < -limit || bound > limit || bound < -limit) {
+    return false;
+  }
+
+  int64_t trip_count = -1;
+  switch (cond_op->getOpcode()) {
+    case clang::BO_LT:
+      if (step > 0) {
+        trip_count = (bound > start) ? (bound - start + step - 1) / step : 0;
+      }
+      break;
+    case clang::BO_LE:
+      if (step > 0) {
+        trip_count = (bound >= start) ? (bound - start) / step + 1 : 0;
+      }
+      break;
+    case clang::BO_GT:
+      if (step < 0) {
+        trip_count = (start > bound) ? (start - bound - step - 1) / -step : 0;
+      }
+      break;
+    case clang::BO_GE:
+      if (step < 0) {
+        trip_count = (start >= bound) ? (start - bound) / -step + 1 : 0;
+      }
+      break;
+    case clang::BO_NE:
+      if ((bound - start) % step == 0 && (bound - start) / step >= 0) {
+        trip_count = (bound - start) / step;
+      }
+      break;
+    default:
+      break;
+  }
+  if (trip_count < 0) {
+    return false;
+  }
+
+  // The counter must not wrap, including on the final increment, and an
+  // unsigned comparison must not see negative values.
+  const int64_t end = start + trip_count * step;
+  const int64_t counter_min =
+      counter_signed ? -(INT64_C(1) << (counter_width - 1)) : 0;
+  const int64_t counter_max = counter_signed
+                                  ? (INT64_C(1) << (counter_width - 1)) - 1
+                                  : (INT64_C(1) << counter_width) - 1;
+  if (start < counter_min || start > counter_max || end < counter_min ||
+      end > counter_max) {
+    return false;
+  }
+  if (cond_op->getLHS()->getType()->isUnsignedIntegerType() &&
+      (start < 0 || end < 0 || bound < 0)) {
+    return false;
+  }
+
+  if (BodyNeedsUnrolling(body, *context().sf)) {
+    return false;
+  }
+
+  if (trip_count == 0) {
+    return true;
+  }
+
+  // Restored if the loop must be unrolled after all, as the unrolled
+  // translation declares the counter again
+  auto saved_check_ids = unique_decl_ids_;
+
+  // Generate the counter declaration within a private context
+  PushContextGuard for_init_guard(*this, loc);
+
+  XLS_RETURN_IF_ERROR(GenerateIR_Stmt(init, ctx));
+
+  const CValue& counter_cval = context().variables.at(counter);
+  if (!counter_cval.type()->Is<CIntType>() ||
+      counter_cval.type()->As<CIntType>()->width() != counter_width) {
+    unique_decl_ids_ = saved_check_ids;
+    return false;
+  }
+  std::shared_ptr<CType> counter_type = counter_cval.type();
+
+  // Pack context tuple, which is the loop carried value
+  std::shared_ptr<CStructType> context_struct_type;
+  xls::BValue context_tuple_out;
+  absl::flat_hash_map<const clang::NamedDecl*, uint64_t> variable_field_indices;
+  std::vector<const clang::NamedDecl*> variable_fields_order;
+  {
+    std::vector<std::shared_ptr<CField>> fields;
+    std::vector<xls::BValue> tuple_values;
+
+    // Create a deterministic field order
+    for (const auto& [decl, _] : context().variables) {
+      if (decl == counter) {
+        continue;
+      }
+      XLS_CHECK(context().sf->declaration_order_by_name_.contains(decl));
+      variable_fields_order.push_back(decl);
+    }
+
+    context().sf->SortNamesDeterministically(variable_fields_order);
+
+    for (const clang::NamedDecl* decl : variable_fields_order) {
+      const CValue& cvalue = context().variables.at(decl);
+      // Pointers can't be passed through the loop body function
+      if (!cvalue.rvalue().valid()) {
+        unique_decl_ids_ = saved_check_ids;
+        return false;
+      }
+      const uint64_t field_idx = tuple_values.size();
+      variable_field_indices[decl] = field_idx;
+      tuple_values.push_back(cvalue.rvalue());
+      fields.push_back(
+          std::make_shared<CField>(decl, field_idx, cvalue.type()));
+    }
+
+    context_struct_type = std::make_shared<CStructType>(
+        fields, /*no_tuple=*/false, /*synthetic_int=*/false);
+    context_tuple_out = MakeStructXLS(tuple_values, *context_struct_type, loc);
+  }
+
+  const std::string name_prefix =
+      absl::StrFormat("__for_%i", next_for_number_++);
+
+  // Generate body function, translating the body only once
+  xls::Function* body_func = nullptr;
+  std::vector<const clang::NamedDecl*> vars_changed_in_body;
+  {
+    GeneratedFunction generated_func;
+    XLS_CHECK_NE(context().sf, nullptr);
+    generated_func.clang_decl = context().sf->clang_decl;
+
+    xls::FunctionBuilder body_builder(absl::StrFormat("%s_func", name_prefix),
+                                      package_);
+
+    // counted_for passes the iteration number times the stride
+    xls::BValue index_param =
+        body_builder.Param(absl::StrFormat("%s_i", name_prefix),
+                           package_->GetBitsType(counter_width), loc);
+    xls::BValue context_param =
+        body_builder.Param(absl::StrFormat("%s_context", name_prefix),
+                           context_tuple_out.GetType(), loc);
+
+    TranslationContext& prev_context = context();
+    PushContextGuard context_guard(*this, loc);
+
+    context() = TranslationContext();
+    context().propagate_up = false;
+
+    context().fb = absl::implicit_cast<xls::BuilderBase*>(&body_builder);
+    context().sf = &generated_func;
+    context().for_loops_default_unroll = prev_context.for_loops_default_unroll;
+    context().in_pipelined_for_body = prev_context.in_pipelined_for_body;
+    context().outer_pipelined_loop_init_interval =
+        prev_context.outer_pipelined_loop_init_interval;
+
+    // Context in
+    absl::flat_hash_map<const clang::NamedDecl*, xls::BValue> prev_vars;
+
+    for (const clang::NamedDecl* decl : variable_fields_order) {
+      const uint64_t field_idx = variable_field_indices.at(decl);
+      const CValue& outer_value = prev_context.variables.at(decl);
+      xls::BValue param_bval = GetStructFieldXLS(context_param, field_idx,
+                                                 *context_struct_type, loc);
+
+      XLS_RETURN_IF_ERROR(
+          DeclareVariable(decl, CValue(param_bval, outer_value.type()), loc,
+                          /*check_unique_ids=*/false));
+
+      prev_vars[decl] = param_bval;
+    }
+
+    xls::BValue start_bval = body_builder.Literal(
+        counter_signed ? xls::SBits(start, counter_width)
+                       : xls::UBits(start, counter_width),
+        loc);
+    xls::BValue counter_bval =
+        (step > 0) ? body_builder.Add(start_bval, index_param, loc)
+                   : body_builder.Subtract(start_bval, index_param, loc);
+    XLS_RETURN_IF_ERROR(DeclareVariable(counter,
+                                        CValue(counter_bval, counter_type),
+                                        loc, /*check_unique_ids=*/false));
+
+    // Generate body
+    {
+      PushContextGuard body_guard(*this, loc);
+      context().propagate_break_up = false;
+      context().propagate_continue_up = false;
+      context().in_for_body = true;
+      context().in_switch_body = false;
+
+      XLS_CHECK_NE(body, nullptr);
+      XLS_RETURN_IF_ERROR(GenerateIR_Compound(body, ctx));
+    }
+
+    // The body must be the same function of the context on every iteration
+    if (!generated_func.io_ops.empty() ||
+        !generated_func.static_values.empty() ||
+        context().variables.at(counter).rvalue().node() !=
+            counter_bval.node()) {
+      unique_decl_ids_ = saved_check_ids;
+      return false;
+    }
+
+    // Context out
+    std::vector<xls::BValue> tuple_values;
+    tuple_values.resize(variable_fields_order.size());
+    for (const clang::NamedDecl* decl : variable_fields_order) {
+      const uint64_t field_idx = variable_field_indices.at(decl);
+      const CValue& cvalue = context().variables.at(decl);
+      if (!cvalue.rvalue().valid()) {
+        unique_decl_ids_ = saved_check_ids;
+        return false;
+      }
+      tuple_values[field_idx] = cvalue.rvalue();
+      if (cvalue.rvalue().node() != prev_vars.at(decl).node()) {
+        vars_changed_in_body.push_back(decl);
+      }
+    }
+
+    xls::BValue ret_ctx =
+        MakeStructXLS(tuple_values, *context_struct_type, loc);
+    XLS_ASSIGN_OR_RETURN(body_func,
+                         body_builder.BuildWithReturnValue(ret_ctx));
+  }
+
+  xls::BValue loop_result = context().fb->CountedFor(
+      context_tuple_out, trip_count, (step > 0) ? step : -step, body_func,
+      /*invariant_args=*/{}, loc);
+
+  // Unpack context tuple
+  // Don't assign to variables that aren't changed in the loop body
+  for (const clang::NamedDecl* decl : vars_changed_in_body) {
+    const uint64_t field_idx = variable_field_indices.at(decl);
+    const CValue cval(GetStructFieldXLS(loop_result, field_idx,
+                                        *context_struct_type, loc),
+                      context().variables.at(decl).type());
+    XLS_RETURN_IF_ERROR(Assign(decl, cval, loc));
+  }
+
+  return true;
+}
+
 absl::Status Translator::GenerateIR_PipelinedLoop(
     bool always_first_iter, const clang::Stmt* init,
     const clang::Expr* cond_expr, const clang::Stmt* inc,
@@ -3354,15 +3354,6 @@ absl::Status Translator::GenerateIR_Stmt(const clang::Stmt* stmt,
       }
     }
 
-    // Unique function name
-    RE2::GlobalReplace(&sasm, "\\(fid\\)",
-                       absl::StrFormat("fid%i", next_asm_number_++));
-    // Unique IR instruction name
-    RE2::GlobalReplace(&sasm, "\\(aid\\)",
-                       absl::StrFormat("aid%i", next_asm_number_++));
-    // File location
-    RE2::GlobalReplace(&sasm, "\\(loc\\)", loc.ToString());
-
     if (pasm->getNumOutputs() != 1) {
       return absl::UnimplementedError(
           absl::StrFormat("asm must have exactly 1 output"));
@@ -3371,12 +3362,31 @@ absl::Status Translator::GenerateIR_Stmt(const clang::Stmt* stmt,
     XLS_ASSIGN_OR_RETURN(CValue out_val,
                          GenerateIR_Expr(pasm->getOutputExpr(0), loc));
 
-    // verify_function_only because external channels are defined up-front,
-    //  which generates "No receive/send node" errors
-    XLS_ASSIGN_OR_RETURN(
-        xls::Function * af,
-        xls::Parser::ParseFunction(sasm, package_,
-                                   /*verify_function_only=*/true));
+    // The same statement is reached once per unrolled iteration, and
+    //  identical statements appear in many template instantiations, so
+    //  reuse the function parsed from the first one.
+    xls::Function* af = nullptr;
+    auto found = inline_ir_functions_.find(sasm);
+    if (found != inline_ir_functions_.end()) {
+      af = found->second;
+    } else {
+      const std::string asm_key = sasm;
+      // Unique function name
+      RE2::GlobalReplace(&sasm, "\\(fid\\)",
+                         absl::StrFormat("fid%i", next_asm_number_++));
+      // Unique IR instruction name
+      RE2::GlobalReplace(&sasm, "\\(aid\\)",
+                         absl::StrFormat("aid%i", next_asm_number_++));
+      // File location
+      RE2::GlobalReplace(&sasm, "\\(loc\\)", loc.ToString());
+
+      // verify_function_only because external channels are defined up-front,
+      //  which generates "No receive/send node" errors
+      XLS_ASSIGN_OR_RETURN(
+          af, xls::Parser::ParseFunction(sasm, package_,
+                                         /*verify_function_only=*/true));
+      inline_ir_functions_[asm_key] = af;
+    }
 
     // No type conversion in or out: inline IR can do whatever it wants.
     // If you use inline IR, you should know exactly what you're doing.
@@ -3933,6 +3943,14 @@ absl::Status Translator::ScanFile(
   return parser_->ScanFile(source_filename, command_line_args);
 }
 
+absl::Status Translator::GeneratePrecompiledHeader(
+    std::string_view header_filename, std::string_view pch_filename,
+    absl::Span<std::string_view> command_line_args) {
+  XLS_CHECK_NE(parser_.get(), nullptr);
+  return parser_->GeneratePrecompiledHeader(header_filename, pch_filename,
+                                            command_line_args);
+}
+
 absl::StatusOr<std::string> Translator::GetEntryFunctionName() const {
   XLS_CHECK_NE(parser_.get(), nullptr);
   return parser_->GetEntryFunctionName();
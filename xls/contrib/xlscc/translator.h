@@ -733,6 +733,12 @@ class Translator {
   absl::Status ScanFile(std::string_view source_filename,
                         absl::Span<std::string_view> command_line_args);
 
+  // Precompiles a header for use by later ScanFile() calls, possibly in
+  //  other xlscc invocations. See CCParser::GeneratePrecompiledHeader().
+  absl::Status GeneratePrecompiledHeader(
+      std::string_view header_filename, std::string_view pch_filename,
+      absl::Span<std::string_view> command_line_args);
+
   // Call after ScanFile, as the top function may be specified by #pragma
   // If none was found, an error is returned
   absl::StatusOr<std::string> GetEntryFunctionName() const;
@@ -769,6 +775,10 @@ class Translator {
 
   inline void SetIOTestMode() { io_test_mode_ = true; }
 
+  // Emits loops which would otherwise be unrolled as counted_for where
+  //  possible, see GenerateIR_CountedForLoop().
+  inline void SetUnrollAsCountedFor() { unroll_as_counted_for_ = true; }
+
  private:
   friend class CInstantiableTypeAlias;
   friend class CStructType;
@@ -875,6 +885,9 @@ class Translator {
   // so that IO operations can be generated without calling GenerateIR_Block()
   bool io_test_mode_ = false;
 
+  // Translate unrolled loops' bodies only once, as counted_for bodies
+  bool unroll_as_counted_for_ = false;
+
   struct InstTypeHash {
     size_t operator()(
         const std::shared_ptr<CInstantiableTypeAlias>& value) const {
@@ -918,6 +931,10 @@ class Translator {
   absl::flat_hash_map<const clang::FunctionDecl*, std::string>
       xls_names_for_functions_generated_;
 
+  // Functions parsed from inline IR asm statements, keyed by the IR text after
+  // constant substitution. Identical statements share one function.
+  absl::flat_hash_map<std::string, xls::Function*> inline_ir_functions_;
+
   int next_asm_number_ = 1;
   int next_for_number_ = 1;
 
@@ -1083,6 +1100,19 @@ class Translator {
                                        const clang::Stmt* body,
                                        clang::ASTContext& ctx,
                                        const xls::SourceInfo& loc);
+  // Translates the body of an unrolled loop of the form
+  //  for (int i = start; i < bound; i += step) only once, as the body of an
+  //  XLS counted_for, rather than once per iteration.
+  // Returns false without generating anything if the loop doesn't have this
+  //  form, or if the body needs to be specialized for each iteration, in
+  //  which case the loop should be unrolled as usual.
+  // init, cond, and inc can be nullptr
+  absl::StatusOr<bool> GenerateIR_CountedForLoop(const clang::Stmt* init,
+                                                 const clang::Expr* cond_expr,
+                                                 const clang::Stmt* inc,
+                                                 const clang::Stmt* body,
+                                                 clang::ASTContext& ctx,
+                                                 const xls::SourceInfo& loc);
   // init, cond, and inc can be nullptr
   absl::Status GenerateIR_PipelinedLoop(
       bool always_first_iter, const clang::Stmt* init,
@@ -1186,6 +1216,9 @@ class Translator {
       std::shared_ptr<CType> t);
   absl::StatusOr<std::shared_ptr<CType>> ResolveTypeInstanceDeeply(
       std::shared_ptr<CType> t);
+  // Returns the translation of 'decl', translating it on first use. Each
+  // template instantiation is a distinct decl, and calls are emitted as
+  // invokes of the shared translation.
   absl::StatusOr<GeneratedFunction*> TranslateFunctionToXLS(
       const clang::FunctionDecl* decl);
   absl::StatusOr<bool> FunctionIsInSyntheticInt(
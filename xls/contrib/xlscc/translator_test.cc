@@ -213,6 +213,37 @@ TEST_F(TranslatorTest, IrAsm) {
   Run({{"a", 1000}}, 500, content);
 }
 
+TEST_F(TranslatorTest, IrAsmInUnrolledLoopParsedOnce) {
+  const std::string content = R"(
+      long long my_package(long long a) {
+       long long ret = 0;
+       #pragma hls_unroll yes
+       for(int i=0;i<4;++i) {
+         int asm_out;
+         asm (
+             "fn (fid)(x: bits[i]) -> bits[r] { "
+             "   ret op_(aid): bits[r] = bit_slice(x, start=s, width=r) }"
+           : "=r" (asm_out)
+           : "i" (64), "s" (1), "r" (32), "param0" (a));
+         ret += asm_out;
+       }
+       return ret;
+      })";
+
+  Run({{"a", 1000}}, 2000, content);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir_src, SourceToIr(content));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::Package> package,
+                           ParsePackage(ir_src));
+  int64_t asm_functions = 0;
+  for (const std::unique_ptr<xls::Function>& f : package->functions()) {
+    if (absl::StartsWith(f->name(), "fid")) {
+      ++asm_functions;
+    }
+  }
+  EXPECT_EQ(asm_functions, 1);
+}
+
 TEST_F(TranslatorTest, ArrayParam) {
   const std::string content = R"(
        long long my_package(const long long arr[2]) {
@@ -1690,6 +1721,57 @@ TEST_F(TranslatorTest, ForUnrollContinue6) {
   Run({{"a", 11}, {"b", 20}}, 11, content);
 }
 
+TEST_F(TranslatorTest, ForUnrollAsCountedFor) {
+  const std::string content = R"(
+       long long my_package(long long a, long long b) {
+         #pragma hls_unroll yes
+         for(int i=1;i<=10;++i) {
+           a += b * i;
+         }
+         return a;
+       })";
+  unroll_as_counted_for_ = true;
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, SourceToIr(content));
+  EXPECT_THAT(ir, testing::HasSubstr("counted_for("));
+  Run({{"a", 11}, {"b", 20}}, 1111, content);
+}
+
+TEST_F(TranslatorTest, ForUnrollAsCountedForDownContinue) {
+  const std::string content = R"(
+       long long my_package(long long a) {
+         #pragma hls_unroll yes
+         for(int i=10;i>0;i-=3) {
+           if(i == 4) {
+             continue;
+           }
+           a += i;
+         }
+         return a;
+       })";
+  unroll_as_counted_for_ = true;
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, SourceToIr(content));
+  EXPECT_THAT(ir, testing::HasSubstr("counted_for("));
+  Run({{"a", 11}}, 29, content);
+}
+
+TEST_F(TranslatorTest, ForUnrollAsCountedForBreakIsUnrolled) {
+  const std::string content = R"(
+       long long my_package(long long a, long long b) {
+         #pragma hls_unroll yes
+         for(int i=0;i<10;++i) {
+           if(a > 50) {
+             break;
+           }
+           a += b;
+         }
+         return a;
+       })";
+  unroll_as_counted_for_ = true;
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, SourceToIr(content));
+  EXPECT_THAT(ir, testing::Not(testing::HasSubstr("counted_for(")));
+  Run({{"a", 11}, {"b", 20}}, 51, content);
+}
+
 TEST_F(TranslatorTest, ReturnFromFor) {
   const std::string content = R"(
        long long my_package(long long a, long long b) {
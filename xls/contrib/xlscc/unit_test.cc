@@ -143,6 +143,9 @@ absl::Status XlsccTestBase::ScanFile(xls::TempFile& temp,
   if (io_test_mode) {
     translator_->SetIOTestMode();
   }
+  if (unroll_as_counted_for_) {
+    translator_->SetUnrollAsCountedFor();
+  }
   return absl::OkStatus();
 }
 
@@ -104,6 +104,9 @@ class XlsccTestBase : public xls::IrTestBase {
 
   std::unique_ptr<xls::Package> package_;
   std::unique_ptr<xlscc::Translator> translator_;
+
+  // Passed to each translator_ created by ScanFile()
+  bool unroll_as_counted_for_ = false;
 };
 
 #endif  // XLS_CONTRIB_XLSCC_UNIT_TEST_H_
@@ -14,8 +14,11 @@
 
 #include "xls/data_structures/binary_decision_diagram.h"
 
+#include <algorithm>
 #include <limits>
+#include <tuple>
 
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -24,10 +27,19 @@
 #include "absl/strings/string_view.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
+#include "xls/common/math_util.h"
 
 namespace xls {
 
-BinaryDecisionDiagram::BinaryDecisionDiagram() {
+// The initial number of entries in the computed table.
+static constexpr int64_t kInitialComputedTableSize = 1024;
+
+BinaryDecisionDiagram::BinaryDecisionDiagram(int64_t max_computed_table_size)
+    : max_computed_table_size_(
+          int64_t{1} << CeilOfLog2(std::max(max_computed_table_size,
+                                            int64_t{1}))) {
+  computed_table_.resize(
+      std::min(kInitialComputedTableSize, max_computed_table_size_));
   // Leaf node 0.
   nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
                            /*p=*/1));
@@ -58,6 +70,37 @@ BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
   return node_index;
 }
 
+int64_t BinaryDecisionDiagram::ComputedTableSlot(BddNodeIndex cond,
+                                                 BddNodeIndex if_true,
+                                                 BddNodeIndex if_false) const {
+  size_t hash = absl::Hash<std::tuple<int32_t, int32_t, int32_t>>()(
+      {cond.value(), if_true.value(), if_false.value()});
+  return hash & (computed_table_.size() - 1);
+}
+
+void BinaryDecisionDiagram::InsertComputedTable(BddNodeIndex cond,
+                                                BddNodeIndex if_true,
+                                                BddNodeIndex if_false,
+                                                BddNodeIndex result) {
+  if (nodes_.size() > computed_table_.size() &&
+      computed_table_.size() < max_computed_table_size_) {
+    GrowComputedTable();
+  }
+  computed_table_[ComputedTableSlot(cond, if_true, if_false)] =
+      ComputedTableEntry{cond, if_true, if_false, result};
+}
+
+void BinaryDecisionDiagram::GrowComputedTable() {
+  std::vector<ComputedTableEntry> old_table(computed_table_.size() * 2);
+  std::swap(old_table, computed_table_);
+  for (const ComputedTableEntry& entry : old_table) {
+    if (entry.cond != BddNodeIndex(-1)) {
+      computed_table_[ComputedTableSlot(entry.cond, entry.if_true,
+                                        entry.if_false)] = entry;
+    }
+  }
+}
+
 BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
                                              bool value) {
   if (expr == zero() || expr == one()) {
@@ -65,7 +108,7 @@ BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
   }
 
   const BddNode& node = GetNode(expr);
-  XLS_CHECK_LE(var, node.variable);
+  XLS_CHECK_LE(GetVariableLevel(var), GetVariableLevel(node.variable));
   if (node.variable == var) {
     return value ? node.high : node.low;
   }
@@ -87,26 +130,31 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
   if (if_true == if_false) {
     return if_true;
   }
-  auto key = std::make_tuple(cond, if_true, if_false);
-  auto it = ite_map_.find(key);
-  if (it != ite_map_.end()) {
-    return it->second;
+  ++computed_table_lookups_;
+  const ComputedTableEntry& entry =
+      computed_table_[ComputedTableSlot(cond, if_true, if_false)];
+  if (entry.cond == cond && entry.if_true == if_true &&
+      entry.if_false == if_false) {
+    ++computed_table_hits_;
+    return entry.result;
   }
 
   // The expression is non-trivial and has not been computed before. Recursively
   // decompose the expression by peeling away the first variable and performing
   // a Shannon decomposition.
 
-  // First, find the lowest-index variable amongst all expressions. In all paths
-  // through the BDD the variable indices are strictly increasing.
+  // First, find the variable with the lowest level amongst all expressions. In
+  // all paths through the BDD the variable levels are strictly increasing.
   BddVariable min_var = GetNode(cond).variable;
-  // Only non-leaf nodes (not zero or one) have associated variables.
-  if (if_true != zero() && if_true != one()) {
-    min_var = std::min(min_var, GetNode(if_true).variable);
-  }
-  if (if_false != zero() && if_false != one()) {
-    min_var = std::min(min_var, GetNode(if_false).variable);
-  }
+  auto update_min_var = [&](BddNodeIndex expr) {
+    // Only non-leaf nodes (not zero or one) have associated variables.
+    if (expr != zero() && expr != one() &&
+        GetVariableLevel(GetNode(expr).variable) < GetVariableLevel(min_var)) {
+      min_var = GetNode(expr).variable;
+    }
+  };
+  update_min_var(if_true);
+  update_min_var(if_false);
 
   // Perform a Shannon expansion about the variable where Shannon expansion is
   // the identity:
@@ -121,17 +169,20 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                            Restrict(if_false, min_var, false));
 
   if (true_cofactor == false_cofactor) {
-    ite_map_[key] = true_cofactor;
+    InsertComputedTable(cond, if_true, if_false, true_cofactor);
     return true_cofactor;
   }
   BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
-  ite_map_[key] = expr;
+  InsertComputedTable(cond, if_true, if_false, expr);
   return expr;
 }
 
 BddNodeIndex BinaryDecisionDiagram::NewVariable() {
   BddVariable var = next_var_;
   ++next_var_;
+  // New variables are placed at the bottom of the variable order.
+  var_to_level_.push_back(level_to_var_.size());
+  level_to_var_.push_back(var);
   return GetOrCreateNode(var, one(), zero());
 }
 
@@ -179,6 +230,241 @@ absl::StatusOr<bool> BinaryDecisionDiagram::Evaluate(
   return result == one();
 }
 
+std::vector<bool> BinaryDecisionDiagram::MarkLive(
+    absl::Span<const BddNodeIndex> roots) const {
+  std::vector<bool> live(nodes_.size(), false);
+  live[zero().value()] = true;
+  live[one().value()] = true;
+  std::vector<BddNodeIndex> worklist(roots.begin(), roots.end());
+  for (BddVariable var(0); var < next_var_; ++var) {
+    worklist.push_back(GetVariableBaseNode(var));
+  }
+  while (!worklist.empty()) {
+    BddNodeIndex node_index = worklist.back();
+    worklist.pop_back();
+    if (live[node_index.value()]) {
+      continue;
+    }
+    live[node_index.value()] = true;
+    worklist.push_back(GetNode(node_index).high);
+    worklist.push_back(GetNode(node_index).low);
+  }
+  return live;
+}
+
+int64_t BinaryDecisionDiagram::LiveNodeCount(
+    absl::Span<const BddNodeIndex> roots) const {
+  std::vector<bool> live = MarkLive(roots);
+  return std::count(live.begin(), live.end(), true);
+}
+
+std::vector<BddNodeIndex> BinaryDecisionDiagram::GarbageCollect(
+    absl::Span<const BddNodeIndex> roots) {
+  std::vector<bool> live = MarkLive(roots);
+
+  // Compact, preserving the relative order of the retained nodes. Reordering
+  // can give nodes children with larger indices than their own so the new
+  // indices are assigned before any children are rewritten.
+  std::vector<BddNodeIndex> remap(nodes_.size(), BddNodeIndex(-1));
+  int64_t next_index = 0;
+  for (int64_t i = 0; i < nodes_.size(); ++i) {
+    if (live[i]) {
+      remap[i] = BddNodeIndex(next_index);
+      ++next_index;
+    }
+  }
+  for (int64_t i = 0; i < nodes_.size(); ++i) {
+    if (!live[i]) {
+      continue;
+    }
+    BddNode node = nodes_[i];
+    if (i != zero().value() && i != one().value()) {
+      node.high = remap[node.high.value()];
+      node.low = remap[node.low.value()];
+    }
+    nodes_[remap[i].value()] = node;
+  }
+  XLS_VLOG(2) << absl::StreamFormat("BDD garbage collection: %d -> %d nodes",
+                                    nodes_.size(), next_index);
+  nodes_.resize(next_index);
+  nodes_.shrink_to_fit();
+
+  // Rebuild the maps, dropping the entries which refer to freed nodes. Swap in
+  // new maps rather than erasing from the old ones so their memory is
+  // released.
+  absl::flat_hash_map<NodeKey, BddNodeIndex> node_map;
+  node_map.reserve(nodes_.size());
+  for (int64_t i = 2; i < nodes_.size(); ++i) {
+    const BddNode& node = nodes_[i];
+    node_map[{node.variable, node.high, node.low}] = BddNodeIndex(i);
+  }
+  node_map_ = std::move(node_map);
+
+  auto is_live = [&](BddNodeIndex index) {
+    return remap[index.value()] != BddNodeIndex(-1);
+  };
+  std::vector<ComputedTableEntry> computed_table(computed_table_.size());
+  std::swap(computed_table, computed_table_);
+  for (const ComputedTableEntry& entry : computed_table) {
+    if (entry.cond != BddNodeIndex(-1) && is_live(entry.cond) &&
+        is_live(entry.if_true) && is_live(entry.if_false) &&
+        is_live(entry.result)) {
+      InsertComputedTable(remap[entry.cond.value()],
+                          remap[entry.if_true.value()],
+                          remap[entry.if_false.value()],
+                          remap[entry.result.value()]);
+    }
+  }
+
+  return remap;
+}
+
+void BinaryDecisionDiagram::SwapAdjacentLevels(int64_t level) {
+  BddVariable upper = level_to_var_[level];
+  BddVariable lower = level_to_var_[level + 1];
+  auto is_lower = [&](BddNodeIndex expr) {
+    return expr != zero() && expr != one() && GetNode(expr).variable == lower;
+  };
+
+  // Only nodes labeled `upper` with a child labeled `lower` depend on the
+  // relative order of the two variables. All other nodes remain valid as is.
+  // Dead nodes are rewritten too as the unique table can revive them.
+  std::vector<BddNodeIndex> to_rewrite;
+  for (int64_t i = 2; i < nodes_.size(); ++i) {
+    if (nodes_[i].variable == upper &&
+        (is_lower(nodes_[i].high) || is_lower(nodes_[i].low))) {
+      to_rewrite.push_back(BddNodeIndex(i));
+    }
+  }
+
+  std::swap(level_to_var_[level], level_to_var_[level + 1]);
+  var_to_level_[upper.value()] = level + 1;
+  var_to_level_[lower.value()] = level;
+
+  // Rewrite each such node F = upper ? F1 : F0 as
+  // F = lower ? (upper ? F11 : F01) : (upper ? F10 : F00) where Fxy is the
+  // cofactor with upper = x and lower = y.
+  auto cofactor = [&](BddNodeIndex expr, bool value) {
+    if (!is_lower(expr)) {
+      return expr;
+    }
+    return value ? GetNode(expr).high : GetNode(expr).low;
+  };
+  for (BddNodeIndex node_index : to_rewrite) {
+    BddNodeIndex f1 = GetNode(node_index).high;
+    BddNodeIndex f0 = GetNode(node_index).low;
+    BddNodeIndex high =
+        GetOrCreateNode(upper, cofactor(f1, true), cofactor(f0, true));
+    BddNodeIndex low =
+        GetOrCreateNode(upper, cofactor(f1, false), cofactor(f0, false));
+    node_map_.erase(std::make_tuple(upper, f1, f0));
+    BddNode& node = nodes_[node_index.value()];
+    node.variable = lower;
+    node.high = high;
+    node.low = low;
+    node_map_[std::make_tuple(lower, high, low)] = node_index;
+  }
+}
+
+void BinaryDecisionDiagram::RecomputePathCounts() {
+  // Children may have larger indices than their parents after reordering so
+  // visit the nodes in depth-first post order.
+  std::vector<bool> done(nodes_.size(), false);
+  done[zero().value()] = true;
+  done[one().value()] = true;
+  std::vector<BddNodeIndex> stack;
+  for (int64_t i = 2; i < nodes_.size(); ++i) {
+    stack.push_back(BddNodeIndex(i));
+    while (!stack.empty()) {
+      BddNodeIndex node_index = stack.back();
+      BddNode& node = nodes_[node_index.value()];
+      if (done[node_index.value()]) {
+        stack.pop_back();
+        continue;
+      }
+      if (!done[node.high.value()] || !done[node.low.value()]) {
+        stack.push_back(node.high);
+        stack.push_back(node.low);
+        continue;
+      }
+      node.path_count = std::min(
+          static_cast<int64_t>(GetNode(node.high).path_count) +
+              GetNode(node.low).path_count,
+          static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
+      done[node_index.value()] = true;
+      stack.pop_back();
+    }
+  }
+}
+
+int64_t BinaryDecisionDiagram::SiftVariables(
+    absl::Span<const BddNodeIndex> roots, int64_t max_variables,
+    int64_t max_distance) {
+  int64_t size = LiveNodeCount(roots);
+  int64_t initial_size = size;
+
+  // Sift the variables labeling the most live nodes first.
+  std::vector<int64_t> node_counts(level_to_var_.size(), 0);
+  std::vector<bool> live = MarkLive(roots);
+  for (int64_t i = 2; i < nodes_.size(); ++i) {
+    if (live[i]) {
+      ++node_counts[nodes_[i].variable.value()];
+    }
+  }
+  std::vector<BddVariable> variables(level_to_var_.begin(),
+                                     level_to_var_.end());
+  std::stable_sort(variables.begin(), variables.end(),
+                   [&](BddVariable a, BddVariable b) {
+                     return node_counts[a.value()] > node_counts[b.value()];
+                   });
+  if (variables.size() > max_variables) {
+    variables.resize(max_variables);
+  }
+
+  const int64_t level_count = level_to_var_.size();
+  for (BddVariable var : variables) {
+    const int64_t start = GetVariableLevel(var);
+    const int64_t top = std::max(int64_t{0}, start - max_distance);
+    const int64_t bottom = std::min(level_count - 1, start + max_distance);
+    int64_t level = start;
+    int64_t best_level = start;
+    int64_t best_size = size;
+    auto too_big = [&]() { return size > kMaxSiftGrowth * best_size; };
+    auto swap_and_measure = [&](int64_t swap_level, int64_t new_level) {
+      SwapAdjacentLevels(swap_level);
+      level = new_level;
+      size = LiveNodeCount(roots);
+      if (size < best_size) {
+        best_size = size;
+        best_level = level;
+      }
+    };
+
+    // Move the variable down, then up past its starting position, then to
+    // the best position found.
+    while (level < bottom && !too_big()) {
+      swap_and_measure(level, level + 1);
+    }
+    while (level > top && (level > start || !too_big())) {
+      swap_and_measure(level - 1, level - 1);
+    }
+    while (level < best_level) {
+      SwapAdjacentLevels(level);
+      ++level;
+    }
+    while (level > best_level) {
+      SwapAdjacentLevels(level - 1);
+      --level;
+    }
+    size = best_size;
+  }
+
+  RecomputePathCounts();
+  XLS_VLOG(2) << absl::StreamFormat("BDD sifting: %d -> %d live nodes",
+                                    initial_size, size);
+  return size;
+}
+
 void BinaryDecisionDiagram::ToStringDnfHelper(BddNodeIndex expr,
                                               int64_t* minterms_to_emit,
                                               std::vector<std::string>* terms,
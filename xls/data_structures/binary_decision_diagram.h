@@ -16,9 +16,11 @@
 #define XLS_DATA_STRUCTURES_BINARY_DECISION_DIAGRAM_H_
 
 #include <cstdint>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -57,9 +59,16 @@ struct BddNode {
 
 class BinaryDecisionDiagram {
  public:
+  // The default maximum number of entries in the computed table which caches
+  // the results of if-then-else operations.
+  static constexpr int64_t kDefaultMaxComputedTableSize = 1 << 20;
+
   // Creates an empty BDD. Initialize the BDD contains only the nodes
-  // corresponding to zero and one.
-  BinaryDecisionDiagram();
+  // corresponding to zero and one. `max_computed_table_size` is the number of
+  // entries the computed table may grow to; it is rounded up to a power of
+  // two.
+  explicit BinaryDecisionDiagram(
+      int64_t max_computed_table_size = kDefaultMaxComputedTableSize);
 
   // Adds a new variable to the BDD and returns the node corresponding the
   // variable's value.
@@ -95,6 +104,12 @@ class BinaryDecisionDiagram {
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return next_var_.value(); }
 
+  // Statistics about the computed table. A lookup is performed for each
+  // non-trivial if-then-else operation.
+  int64_t computed_table_size() const { return computed_table_.size(); }
+  int64_t computed_table_lookups() const { return computed_table_lookups_; }
+  int64_t computed_table_hits() const { return computed_table_hits_; }
+
   // Returns the number of paths in the given expression.
   int64_t path_count(BddNodeIndex expr) const {
     return GetNode(expr).path_count;
@@ -112,6 +127,41 @@ class BinaryDecisionDiagram {
     return GetNode(expr).high == one() && GetNode(expr).low == zero();
   }
 
+  // Frees all nodes which are not reachable from the given roots and compacts
+  // the remaining nodes. The terminal nodes and the base node of every
+  // variable are always retained. Node indices change as a result so all node
+  // indices held outside the BDD are invalidated. Returns a vector indexed by
+  // old node index which holds the new index of each retained node, and an
+  // index with value -1 for each freed node.
+  std::vector<BddNodeIndex> GarbageCollect(
+      absl::Span<const BddNodeIndex> roots);
+
+  // Returns the position of the given variable in the variable order. On every
+  // path from a root to a terminal the levels of the variables strictly
+  // increase. Variables are initially ordered by creation.
+  int64_t GetVariableLevel(BddVariable var) const {
+    return var_to_level_[var.value()];
+  }
+
+  // SiftVariables stops moving a variable in a direction once the diagram
+  // exceeds this multiple of the smallest size seen.
+  static constexpr double kMaxSiftGrowth = 1.2;
+
+  // Reorders the variables with Rudell's sifting algorithm to reduce the
+  // number of nodes reachable from `roots`. Each variable in turn is moved
+  // through the order by swapping adjacent levels and left at the position
+  // where the diagram was smallest. Only the `max_variables` variables labeling
+  // the most nodes are sifted, and each moves at most `max_distance` levels in
+  // either direction; movement in a direction also stops once the diagram grows
+  // beyond kMaxSiftGrowth times the best size seen.
+  //
+  // Swaps are done in place: every node index keeps representing the same
+  // expression, so indices held outside the BDD stay valid. Nodes which become
+  // unreachable are not freed; call GarbageCollect afterwards. Returns the
+  // number of nodes reachable from the roots after reordering.
+  int64_t SiftVariables(absl::Span<const BddNodeIndex> roots,
+                        int64_t max_variables = 64, int64_t max_distance = 32);
+
  private:
   // Helper for constructing a DNF string respresentation.
   void ToStringDnfHelper(BddNodeIndex expr, int64_t* minterms_to_emit,
@@ -131,6 +181,24 @@ class BinaryDecisionDiagram {
   BddNodeIndex IfThenElse(BddNodeIndex cond, BddNodeIndex if_true,
                           BddNodeIndex if_false);
 
+  // Returns a vector indexed by node index indicating which nodes are
+  // reachable from the given roots, the terminals, or the base node of any
+  // variable.
+  std::vector<bool> MarkLive(absl::Span<const BddNodeIndex> roots) const;
+
+  // Returns the number of nodes reachable from the given roots as defined by
+  // MarkLive.
+  int64_t LiveNodeCount(absl::Span<const BddNodeIndex> roots) const;
+
+  // Exchanges the variables at levels `level` and `level + 1` in the variable
+  // order. Nodes labeled with the upper variable which have a child labeled
+  // with the lower variable are rewritten in place to keep the diagram
+  // ordered and reduced. Path counts are not updated.
+  void SwapAdjacentLevels(int64_t level);
+
+  // Recomputes the path count of every node from scratch.
+  void RecomputePathCounts();
+
   // Returns the node corresponding to the value of the given variable.
   BddNodeIndex GetVariableBaseNode(BddVariable variable) const {
     return node_map_.at({variable, one(), zero()});
@@ -140,6 +208,11 @@ class BinaryDecisionDiagram {
   // call to NewVariable which
   BddVariable next_var_ = BddVariable(0);
 
+  // The variable order. `var_to_level_` is indexed by variable and
+  // `level_to_var_` is its inverse.
+  std::vector<int64_t> var_to_level_;
+  std::vector<BddVariable> level_to_var_;
+
   // The vector of all the nodes in the BDD.
   std::vector<BddNode> nodes_;
 
@@ -149,11 +222,38 @@ class BinaryDecisionDiagram {
   using NodeKey = std::tuple<BddVariable, BddNodeIndex, BddNodeIndex>;
   absl::flat_hash_map<NodeKey, BddNodeIndex> node_map_;
 
-  // A map from if-then-else expression to the node corresponding to that
-  // expression. The key elements are (condition, if-true, if-false). This map
-  // enables fast lookup for expressions.
-  using IteKey = std::tuple<BddNodeIndex, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map_;
+  // An entry in the computed table holding the result of the if-then-else
+  // expression (cond, if_true, if_false). Empty entries have a `cond` of -1.
+  struct ComputedTableEntry {
+    BddNodeIndex cond = BddNodeIndex(-1);
+    BddNodeIndex if_true;
+    BddNodeIndex if_false;
+    BddNodeIndex result;
+  };
+
+  // Returns the slot of the computed table for the given expression.
+  int64_t ComputedTableSlot(BddNodeIndex cond, BddNodeIndex if_true,
+                            BddNodeIndex if_false) const;
+
+  // Records the result of the given if-then-else expression in the computed
+  // table, overwriting whatever entry occupied its slot.
+  void InsertComputedTable(BddNodeIndex cond, BddNodeIndex if_true,
+                           BddNodeIndex if_false, BddNodeIndex result);
+
+  // Doubles the size of the computed table (up to max_computed_table_size_)
+  // and reinserts the existing entries.
+  void GrowComputedTable();
+
+  // The computed table: a fixed-size, direct-mapped and lossy cache of
+  // if-then-else results indexed by a hash of the operands, as used in
+  // standard BDD packages. Unlike an exhaustive memo table its memory is
+  // bounded. The table starts small and doubles whenever the number of nodes
+  // exceeds its size until it reaches `max_computed_table_size_`. The size is
+  // always a power of two.
+  std::vector<ComputedTableEntry> computed_table_;
+  int64_t max_computed_table_size_;
+  int64_t computed_table_lookups_ = 0;
+  int64_t computed_table_hits_ = 0;
 };
 
 }  // namespace xls
@@ -306,5 +306,152 @@ TEST(BinaryDecisionDiagramTest, ThreeVariableExhaustive) {
   }
 }
 
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  BddNodeIndex a = bdd.NewVariable();
+  BddNodeIndex b = bdd.NewVariable();
+  BddNodeIndex c = bdd.NewVariable();
+  BddNodeIndex a_and_c = bdd.And(a, c);
+  // Create some garbage.
+  bdd.Or(bdd.And(a, b), bdd.Not(c));
+  bdd.Or(b, c);
+  int64_t size_before = bdd.size();
+
+  std::vector<BddNodeIndex> remap = bdd.GarbageCollect({a_and_c});
+  EXPECT_LT(bdd.size(), size_before);
+  // The terminal nodes keep their indices.
+  EXPECT_EQ(remap[bdd.zero().value()], bdd.zero());
+  EXPECT_EQ(remap[bdd.one().value()], bdd.one());
+
+  // Variable base nodes are always retained.
+  a = remap[a.value()];
+  b = remap[b.value()];
+  c = remap[c.value()];
+  a_and_c = remap[a_and_c.value()];
+  ASSERT_NE(a, BddNodeIndex(-1));
+  ASSERT_NE(b, BddNodeIndex(-1));
+  ASSERT_NE(c, BddNodeIndex(-1));
+  ASSERT_NE(a_and_c, BddNodeIndex(-1));
+  EXPECT_TRUE(bdd.IsVariableBaseNode(b));
+
+  // The retained expression is still canonical and evaluates correctly.
+  EXPECT_EQ(bdd.And(a, c), a_and_c);
+  EXPECT_EQ(bdd.And(c, a), a_and_c);
+  EXPECT_THAT(bdd.Evaluate(a_and_c, {{a, true}, {c, true}}),
+              IsOkAndHolds(true));
+  EXPECT_THAT(bdd.Evaluate(a_and_c, {{a, true}, {c, false}}),
+              IsOkAndHolds(false));
+
+  // Nodes created after collection behave as before.
+  BddNodeIndex b_or_c = bdd.Or(b, c);
+  EXPECT_EQ(bdd.path_count(b_or_c), 3);
+  EXPECT_THAT(bdd.Evaluate(b_or_c, {{b, false}, {c, true}}),
+              IsOkAndHolds(true));
+}
+
+TEST(BinaryDecisionDiagramTest, ComputedTable) {
+  BinaryDecisionDiagram bdd;
+  BddNodeIndex a = bdd.NewVariable();
+  BddNodeIndex b = bdd.NewVariable();
+  EXPECT_EQ(bdd.computed_table_lookups(), 0);
+
+  BddNodeIndex a_and_b = bdd.And(a, b);
+  int64_t lookups = bdd.computed_table_lookups();
+  int64_t hits = bdd.computed_table_hits();
+  EXPECT_GT(lookups, 0);
+
+  // Repeating the operation is answered by the computed table.
+  EXPECT_EQ(bdd.And(a, b), a_and_b);
+  EXPECT_EQ(bdd.computed_table_lookups(), lookups + 1);
+  EXPECT_EQ(bdd.computed_table_hits(), hits + 1);
+}
+
+TEST(BinaryDecisionDiagramTest, TinyComputedTable) {
+  // Results are correct even when the computed table constantly evicts
+  // entries.
+  BinaryDecisionDiagram bdd(/*max_computed_table_size=*/1);
+  EXPECT_EQ(bdd.computed_table_size(), 1);
+  std::vector<BddNodeIndex> vars;
+  for (int64_t i = 0; i < 8; ++i) {
+    vars.push_back(bdd.NewVariable());
+  }
+  BddNodeIndex parity = bdd.zero();
+  for (BddNodeIndex var : vars) {
+    parity =
+        bdd.Or(bdd.And(parity, bdd.Not(var)), bdd.And(bdd.Not(parity), var));
+  }
+  EXPECT_EQ(bdd.computed_table_size(), 1);
+  for (int64_t value = 0; value < 256; ++value) {
+    absl::flat_hash_map<BddNodeIndex, bool> values;
+    bool expected = false;
+    for (int64_t i = 0; i < 8; ++i) {
+      values[vars[i]] = (value >> i) & 1;
+      expected ^= values[vars[i]];
+    }
+    EXPECT_THAT(bdd.Evaluate(parity, values), IsOkAndHolds(expected));
+  }
+}
+
+TEST(BinaryDecisionDiagramTest, SiftVariables) {
+  // The expression (a0 & b0) | (a1 & b1) | ... has a BDD whose size is
+  // exponential in the number of pairs when all the a's precede all the b's,
+  // and linear when each a is adjacent to its b.
+  constexpr int64_t kPairs = 6;
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars;
+  for (int64_t i = 0; i < 2 * kPairs; ++i) {
+    vars.push_back(bdd.NewVariable());
+  }
+  BddNodeIndex expr = bdd.zero();
+  for (int64_t i = 0; i < kPairs; ++i) {
+    expr = bdd.Or(expr, bdd.And(vars[i], vars[kPairs + i]));
+  }
+  std::vector<BddNodeIndex> remap = bdd.GarbageCollect({expr});
+  expr = remap[expr.value()];
+  for (BddNodeIndex& var : vars) {
+    var = remap[var.value()];
+  }
+  int64_t size_before = bdd.size();
+  int64_t path_count_before = bdd.path_count(expr);
+
+  int64_t live_size = bdd.SiftVariables({expr});
+  remap = bdd.GarbageCollect({expr});
+  expr = remap[expr.value()];
+  for (BddNodeIndex& var : vars) {
+    var = remap[var.value()];
+  }
+  EXPECT_EQ(bdd.size(), live_size);
+  EXPECT_LT(bdd.size(), size_before);
+  EXPECT_LT(bdd.path_count(expr), path_count_before);
+
+  // Every path visits the variables in order of increasing level.
+  for (int64_t i = 2; i < bdd.size(); ++i) {
+    const BddNode& node = bdd.GetNode(BddNodeIndex(i));
+    for (BddNodeIndex child : {node.high, node.low}) {
+      if (child != bdd.zero() && child != bdd.one()) {
+        EXPECT_LT(bdd.GetVariableLevel(node.variable),
+                  bdd.GetVariableLevel(bdd.GetNode(child).variable));
+      }
+    }
+  }
+
+  // The expression is unchanged.
+  for (int64_t value = 0; value < (1 << (2 * kPairs)); ++value) {
+    absl::flat_hash_map<BddNodeIndex, bool> values;
+    bool expected = false;
+    for (int64_t i = 0; i < 2 * kPairs; ++i) {
+      values[vars[i]] = (value >> i) & 1;
+    }
+    for (int64_t i = 0; i < kPairs; ++i) {
+      expected |= values[vars[i]] && values[vars[kPairs + i]];
+    }
+    EXPECT_THAT(bdd.Evaluate(expr, values), IsOkAndHolds(expected));
+  }
+
+  // New operations respect the new order.
+  EXPECT_EQ(bdd.And(vars[0], vars[kPairs]),
+            bdd.And(vars[kPairs], vars[0]));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,10 +14,15 @@
 
 #include "xls/data_structures/binary_search.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 
 namespace xls {
 
@@ -103,4 +108,59 @@ absl::StatusOr<int64_t> BinarySearchMinTrueWithStatus(
   return lowest_true;
 }
 
+absl::StatusOr<int64_t> ParallelSearchMinTrueWithStatus(
+    int64_t start, int64_t end, int64_t thread_count,
+    absl::FunctionRef<absl::StatusOr<bool>(int64_t i)> f) {
+  XLS_RET_CHECK_GE(thread_count, 1);
+  if (thread_count == 1) {
+    return BinarySearchMinTrueWithStatus(start, end, f);
+  }
+  XLS_RET_CHECK_LE(start, end);
+  XLS_ASSIGN_OR_RETURN(bool f_end, f(end));
+  if (!f_end) {
+    return absl::InvalidArgumentError(
+        "Highest value in range fails condition of binary search.");
+  }
+  XLS_ASSIGN_OR_RETURN(bool f_start, f(start));
+  if (f_start) {
+    return start;
+  }
+  int64_t highest_false = start;
+  int64_t lowest_true = end;
+  while (highest_false < lowest_true - 1) {
+    // Probe values evenly spaced in the open interval
+    // (highest_false, lowest_true).
+    int64_t interval = lowest_true - highest_false;
+    int64_t probe_count = std::min(thread_count, interval - 1);
+    int64_t step = interval / (probe_count + 1);
+    std::vector<int64_t> probes(probe_count);
+    for (int64_t i = 0; i < probe_count; ++i) {
+      probes[i] = highest_false + (i + 1) * step;
+    }
+
+    // The first probe is evaluated on the calling thread.
+    std::vector<absl::StatusOr<bool>> results(probe_count);
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(probe_count - 1);
+    for (int64_t i = 1; i < probe_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(
+          [&results, &probes, &f, i]() { results[i] = f(probes[i]); }));
+    }
+    results[0] = f(probes[0]);
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+
+    for (int64_t i = 0; i < probe_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(bool f_probe, results[i]);
+      if (f_probe) {
+        lowest_true = probes[i];
+        break;
+      }
+      highest_false = probes[i];
+    }
+  }
+  return lowest_true;
+}
+
 }  // namespace xls
@@ -44,6 +44,20 @@ absl::StatusOr<int64_t> BinarySearchMinTrueWithStatus(
     int64_t start, int64_t end,
     absl::FunctionRef<absl::StatusOr<bool>(int64_t i)> f);
 
+// Variant of BinarySearchMinTrueWithStatus which evaluates up to
+// `thread_count` values concurrently. Each round of the search evaluates
+// values evenly spaced in the remaining interval in parallel and narrows the
+// interval to the gap between the largest false value and the smallest true
+// value, so the number of rounds is logarithmic in base `thread_count + 1`.
+// This is worthwhile when `f` is expensive. `f` must be safe to call
+// concurrently. The results of a round are examined in increasing order up to
+// the first true value, and the first error found is returned. Errors of
+// values above the first true value are ignored as the search does not need
+// those values.
+absl::StatusOr<int64_t> ParallelSearchMinTrueWithStatus(
+    int64_t start, int64_t end, int64_t thread_count,
+    absl::FunctionRef<absl::StatusOr<bool>(int64_t i)> f);
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_BINARY_SEARCH_H_
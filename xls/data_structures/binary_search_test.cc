@@ -14,6 +14,8 @@
 
 #include "xls/data_structures/binary_search.h"
 
+#include <atomic>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
@@ -80,6 +82,35 @@ TEST(BinarySearchTest, MinTrueWithStatus) {
   }
 }
 
+TEST(BinarySearchTest, ParallelMinTrueWithStatus) {
+  const int64_t kMaxSize = 10;
+  for (int thread_count = 1; thread_count <= 4; ++thread_count) {
+    for (int start = 0; start < kMaxSize; ++start) {
+      for (int end = start; end < kMaxSize; ++end) {
+        for (int target = start; target <= end; ++target) {
+          auto got = ParallelSearchMinTrueWithStatus(
+              start, end, thread_count,
+              [&](int64_t i) -> absl::StatusOr<bool> { return i >= target; });
+          EXPECT_THAT(got, IsOkAndHolds(target));
+        }
+      }
+    }
+  }
+}
+
+TEST(BinarySearchTest, ParallelSearchNumRounds) {
+  // With seven threads each round narrows the interval by a factor of eight.
+  std::atomic<int64_t> f_called = 0;
+  auto f = [&](int64_t i) -> absl::StatusOr<bool> {
+    f_called++;
+    return i >= 123456;
+  };
+  EXPECT_THAT(ParallelSearchMinTrueWithStatus(0, 1024 * 1024, 7, f),
+              IsOkAndHolds(123456));
+  // Two initial evaluations followed by at most seven rounds of seven probes.
+  EXPECT_LE(f_called, 2 + 7 * 7);
+}
+
 TEST(BinarySearchTest, NumTimesFunctionCalled) {
   int64_t f_called = 0;
   // Note: some compilers dislike the lambda living inside the macro, so we
@@ -134,6 +165,20 @@ TEST(BinarySearchTest, ErrorConditions) {
         return absl::UnimplementedError("qux");
       });
   EXPECT_THAT(e, StatusIs(absl::StatusCode::kUnimplemented, HasSubstr("qux")));
+
+  EXPECT_THAT(
+      ParallelSearchMinTrueWithStatus(
+          1, 42, 4, [&](int64_t i) -> absl::StatusOr<bool> { return false; }),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("Highest value in range fails condition")));
+  auto f = ParallelSearchMinTrueWithStatus(
+      1, 42, 4, [&](int64_t i) -> absl::StatusOr<bool> {
+        if (i == 1 || i == 42) {
+          return i == 42;
+        }
+        return absl::UnimplementedError("qux");
+      });
+  EXPECT_THAT(f, StatusIs(absl::StatusCode::kUnimplemented, HasSubstr("qux")));
 }
 
 }  // namespace
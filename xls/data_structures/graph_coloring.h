@@ -15,14 +15,21 @@
 #ifndef XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
 #define XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "../z3/src/api/c++/z3++.h"
 
 namespace xls {
@@ -150,6 +157,123 @@ std::vector<absl::flat_hash_set<V>> RecursiveLargestFirstColoring(
   return result;
 }
 
+// A graph over the vertices [0, n) as an adjacency matrix: bit j of row i is
+// set iff vertices i and j are adjacent. The matrix must be symmetric and its
+// diagonal must be clear.
+using BitmapGraph = std::vector<InlineBitmap>;
+
+// Color the given graph using the Recursive Largest First algorithm, as the
+// version above does, with every neighborhood operation done a word at a time
+// on the rows of the adjacency matrix. The coloring is the same as the one the
+// version above computes for the same graph with integer vertices.
+//
+// Each color class costs O(n^2 / 64) time per vertex added to it, which is a
+// lot for graphs with tens of thousands of vertices. Once `time_budget` is
+// exceeded, the class being built is closed and the remaining vertices are
+// colored greedily in order of decreasing degree, each taking the first color
+// whose class contains none of its neighbors.
+inline std::vector<absl::flat_hash_set<int64_t>> RecursiveLargestFirstColoring(
+    const BitmapGraph& graph,
+    absl::Duration time_budget = absl::InfiniteDuration()) {
+  const int64_t n = graph.size();
+  const absl::Time deadline = absl::Now() + time_budget;
+
+  std::vector<InlineBitmap> classes;
+  InlineBitmap uncolored(n, /*fill=*/true);
+  bool out_of_time = false;
+  while (!out_of_time && !uncolored.IsAllZeroes()) {
+    // Find a maximal independent set in the subgraph induced by `uncolored`.
+    // The names follow FindMaximalIndependentSet above.
+    InlineBitmap result(n);              // S
+    InlineBitmap available = uncolored;  // X
+    InlineBitmap neighboring_result(n);  // Y
+    auto add_to_result = [&](int64_t vertex) {
+      result.Set(vertex, true);
+      neighboring_result.Union(graph[vertex]);
+      neighboring_result.Intersect(uncolored);
+      available.Set(vertex, false);
+    };
+
+    {
+      int64_t largest_neighborhood = 0;
+      int64_t vertex_with_most_neighbors = -1;
+      for (int64_t vertex = 0; vertex < n; ++vertex) {
+        if (!available.Get(vertex)) {
+          continue;
+        }
+        int64_t neighborhood_size =
+            graph[vertex].IntersectionPopCount(uncolored);
+        if (neighborhood_size >= largest_neighborhood) {
+          largest_neighborhood = neighborhood_size;
+          vertex_with_most_neighbors = vertex;
+        }
+      }
+      add_to_result(vertex_with_most_neighbors);
+    }
+
+    while (!available.IsAllZeroes()) {
+      if (absl::Now() > deadline) {
+        out_of_time = true;
+        break;
+      }
+      std::pair<int64_t, int64_t> measure = {-1, -1};
+      int64_t best = -1;
+      for (int64_t vertex = 0; vertex < n; ++vertex) {
+        if (!available.Get(vertex) || neighboring_result.Get(vertex)) {
+          continue;
+        }
+        std::pair<int64_t, int64_t> vertex_measure{
+            graph[vertex].IntersectionPopCount(neighboring_result),
+            -graph[vertex].IntersectionPopCount(available)};
+        if (vertex_measure > measure) {
+          best = vertex;
+          measure = vertex_measure;
+        }
+      }
+      if (best == -1) {
+        break;
+      }
+      add_to_result(best);
+    }
+
+    uncolored.Subtract(result);
+    classes.push_back(std::move(result));
+  }
+
+  if (!uncolored.IsAllZeroes()) {
+    std::vector<std::pair<int64_t, int64_t>> by_degree;
+    for (int64_t vertex = 0; vertex < n; ++vertex) {
+      if (uncolored.Get(vertex)) {
+        by_degree.push_back({-graph[vertex].IntersectionPopCount(uncolored),
+                             vertex});
+      }
+    }
+    std::sort(by_degree.begin(), by_degree.end());
+    for (const auto& [_, vertex] : by_degree) {
+      auto it = std::find_if(
+          classes.begin(), classes.end(), [&](const InlineBitmap& members) {
+            return graph[vertex].IntersectionPopCount(members) == 0;
+          });
+      if (it == classes.end()) {
+        it = classes.insert(classes.end(), InlineBitmap(n));
+      }
+      it->Set(vertex, true);
+    }
+  }
+
+  std::vector<absl::flat_hash_set<int64_t>> coloring;
+  coloring.reserve(classes.size());
+  for (const InlineBitmap& members : classes) {
+    absl::flat_hash_set<int64_t>& color_class = coloring.emplace_back();
+    for (int64_t vertex = 0; vertex < n; ++vertex) {
+      if (members.Get(vertex)) {
+        color_class.insert(vertex);
+      }
+    }
+  }
+  return coloring;
+}
+
 inline std::optional<int64_t> LookupIntegerInZ3Model(z3::model model,
                                                      std::string_view name) {
   for (int32_t i = 0; i < model.size(); i++) {
@@ -14,10 +14,17 @@
 
 #include "xls/data_structures/graph_coloring.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -141,5 +148,88 @@ TEST(GraphColoringTest, Wheel) {
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
 }
 
+// Returns a random graph over [0, n) in which each edge is present with the
+// given probability.
+BitmapGraph RandomBitmapGraph(int64_t n, double edge_probability) {
+  std::mt19937 gen;
+  std::bernoulli_distribution coin(edge_probability);
+  BitmapGraph graph(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j = i + 1; j < n; ++j) {
+      if (coin(gen)) {
+        graph[i].Set(j, true);
+        graph[j].Set(i, true);
+      }
+    }
+  }
+  return graph;
+}
+
+bool IsValidBitmapColoring(
+    const BitmapGraph& graph,
+    const std::vector<absl::flat_hash_set<int64_t>>& coloring) {
+  std::vector<int64_t> colors(graph.size(), -1);
+  for (int64_t color = 0; color < coloring.size(); ++color) {
+    for (int64_t vertex : coloring[color]) {
+      if (colors[vertex] != -1) {
+        return false;
+      }
+      colors[vertex] = color;
+    }
+  }
+  for (int64_t i = 0; i < graph.size(); ++i) {
+    if (colors[i] == -1) {
+      return false;
+    }
+    for (int64_t j = 0; j < graph.size(); ++j) {
+      if (graph[i].Get(j) && colors[i] == colors[j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(GraphColoringTest, BitmapMatchesHashSet) {
+  BitmapGraph graph = RandomBitmapGraph(150, 0.2);
+  absl::flat_hash_set<int64_t> vertices;
+  for (int64_t i = 0; i < graph.size(); ++i) {
+    vertices.insert(i);
+  }
+  std::vector<absl::flat_hash_set<int64_t>> expected =
+      RecursiveLargestFirstColoring<int64_t>(
+          vertices, [&](int64_t v) -> absl::flat_hash_set<int64_t> {
+            absl::flat_hash_set<int64_t> result;
+            for (int64_t u = 0; u < graph.size(); ++u) {
+              if (graph[v].Get(u)) {
+                result.insert(u);
+              }
+            }
+            return result;
+          });
+  std::vector<absl::flat_hash_set<int64_t>> coloring =
+      RecursiveLargestFirstColoring(graph);
+  EXPECT_EQ(coloring, expected);
+  EXPECT_TRUE(IsValidBitmapColoring(graph, coloring));
+}
+
+TEST(GraphColoringTest, BitmapOutOfTime) {
+  BitmapGraph graph = RandomBitmapGraph(300, 0.1);
+  std::vector<absl::flat_hash_set<int64_t>> coloring =
+      RecursiveLargestFirstColoring(graph, absl::ZeroDuration());
+  EXPECT_TRUE(IsValidBitmapColoring(graph, coloring));
+  // The greedy coloring never needs more colors than the maximum degree plus
+  // one.
+  int64_t max_degree = 0;
+  for (const InlineBitmap& row : graph) {
+    max_degree = std::max(max_degree, row.PopCount());
+  }
+  EXPECT_LE(coloring.size(), max_degree + 1);
+}
+
+TEST(GraphColoringTest, BitmapEmpty) {
+  EXPECT_TRUE(RecursiveLargestFirstColoring(BitmapGraph()).empty());
+}
+
 }  // namespace
 }  // namespace xls
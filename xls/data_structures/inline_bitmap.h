@@ -15,10 +15,12 @@
 #ifndef XLS_DATA_STRUCTURES_INLINE_BITMAP_H_
 #define XLS_DATA_STRUCTURES_INLINE_BITMAP_H_
 
+#include <algorithm>
 #include <cstdint>
 
 #include "absl/base/casts.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/numeric/bits.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
@@ -26,6 +28,10 @@
 namespace xls {
 
 // A bitmap that has 64-bits of inline storage by default.
+//
+// Bits beyond bit_count() in the last storage word are always zero. Bulk
+// operations (slicing/copying, counting, bitwise logic) operate on whole
+// 64-bit words rather than on individual bits.
 class InlineBitmap {
  public:
   static InlineBitmap FromWord(uint64_t word, int64_t bit_count,
@@ -41,6 +47,9 @@ class InlineBitmap {
       : bit_count_(bit_count),
         data_(CeilOfRatio(bit_count, kWordBits), fill ? -1ULL : 0ULL) {
     XLS_DCHECK_GE(bit_count, 0);
+    if (fill && bit_count != 0) {
+      MaskLastWord();
+    }
   }
 
   bool operator==(const InlineBitmap& other) const {
@@ -107,6 +116,84 @@ class InlineBitmap {
     return data_[wordno];
   }
 
+  // Sets the 64-bit word `wordno`. Bits of `value` beyond bit_count() are
+  // dropped.
+  void SetWord(int64_t wordno, uint64_t value) {
+    XLS_DCHECK_LT(wordno, word_count());
+    data_[wordno] = value & MaskForWord(wordno);
+  }
+
+  // Returns the number of 64-bit words backing the bitmap.
+  int64_t word_count() const { return data_.size(); }
+
+  // Returns the `width` bits starting at bit `start` as the low bits of a
+  // word. `width` must be at most 64.
+  uint64_t GetBits(int64_t start, int64_t width) const {
+    XLS_DCHECK_GE(start, 0);
+    XLS_DCHECK_LE(width, kWordBits);
+    XLS_DCHECK_LE(start + width, bit_count());
+    if (width == 0) {
+      return 0;
+    }
+    int64_t wordno = start / kWordBits;
+    int64_t offset = start % kWordBits;
+    uint64_t result = data_[wordno] >> offset;
+    if (offset != 0 && wordno + 1 < word_count()) {
+      result |= data_[wordno + 1] << (kWordBits - offset);
+    }
+    return result & Mask(width);
+  }
+
+  // Copies `width` bits of `src` starting at bit `src_start` into this bitmap
+  // starting at bit `dst_start`. The copy proceeds a destination word at a
+  // time. `src` must not be this bitmap.
+  void Overwrite(const InlineBitmap& src, int64_t src_start, int64_t dst_start,
+                 int64_t width) {
+    XLS_DCHECK_NE(&src, this);
+    XLS_DCHECK_LE(src_start + width, src.bit_count());
+    XLS_DCHECK_LE(dst_start + width, bit_count());
+    int64_t copied = 0;
+    while (copied < width) {
+      int64_t dst_bit = dst_start + copied;
+      int64_t offset = dst_bit % kWordBits;
+      int64_t chunk = std::min(kWordBits - offset, width - copied);
+      uint64_t mask = Mask(chunk) << offset;
+      uint64_t& word = data_[dst_bit / kWordBits];
+      word =
+          (word & ~mask) | (src.GetBits(src_start + copied, chunk) << offset);
+      copied += chunk;
+    }
+  }
+
+  // Returns the number of set bits.
+  int64_t PopCount() const {
+    int64_t count = 0;
+    for (uint64_t word : data_) {
+      count += absl::popcount(word);
+    }
+    return count;
+  }
+
+  // Returns the number of bits set in both this bitmap and `other`, without
+  // materializing the intersection.
+  int64_t IntersectionPopCount(const InlineBitmap& other) const {
+    XLS_DCHECK_EQ(bit_count(), other.bit_count());
+    int64_t count = 0;
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      count += absl::popcount(data_[i] & other.data_[i]);
+    }
+    return count;
+  }
+
+  // Returns the number of contiguous zero (one) bits starting from the most
+  // significant bit.
+  int64_t CountLeadingZeros() const { return CountLeading(/*ones=*/false); }
+  int64_t CountLeadingOnes() const { return CountLeading(/*ones=*/true); }
+
+  // Returns the number of contiguous zero (one) bits starting from bit 0.
+  int64_t CountTrailingZeros() const { return CountTrailing(/*ones=*/false); }
+  int64_t CountTrailingOnes() const { return CountTrailing(/*ones=*/true); }
+
   // Sets a byte in the data underlying the bitmap.
   //
   // Setting byte i as {b_7, b_6, b_5, ..., b_0} sets the bit at i*8 to b_0, the
@@ -136,40 +223,16 @@ class InlineBitmap {
   // two's complement integers. If equal, returns 0. If this is greater than
   // other, returns 1. If this is less than other, returns -1.
   int64_t UCmp(const InlineBitmap& other) const {
-    int64_t bit_diff = bit_count_ - other.bit_count_;
-    int64_t bit_min = std::min(bit_count_, other.bit_count_);
-
-    int64_t my_idx = bit_count_ - 1;
-    int64_t other_idx = other.bit_count_ - 1;
-
-    while (bit_diff > 0) {
-      if (Get(my_idx)) {
-        return 1;
-      }
-      my_idx--;
-      bit_diff--;
-    }
-    while (bit_diff < 0) {
-      if (other.Get(other_idx)) {
-        return -1;
-      }
-      other_idx--;
-      bit_diff++;
-    }
-
-    for (int64_t i = 0; i < bit_min; i++) {
-      bool my_word = Get(my_idx);
-      bool other_word = other.Get(other_idx);
-      if (my_word && !other_word) {
-        return 1;
-      }
-      if (!my_word && other_word) {
-        return -1;
+    // The narrower bitmap is implicitly zero-extended.
+    for (int64_t wordno = std::max(word_count(), other.word_count()) - 1;
+         wordno >= 0; --wordno) {
+      uint64_t my_word = wordno < word_count() ? data_[wordno] : 0;
+      uint64_t other_word =
+          wordno < other.word_count() ? other.data_[wordno] : 0;
+      if (my_word != other_word) {
+        return my_word > other_word ? 1 : -1;
       }
-      my_idx--;
-      other_idx--;
     }
-
     return 0;
   }
 
@@ -181,6 +244,40 @@ class InlineBitmap {
     }
   }
 
+  // Sets this bitmap to the intersection of this bitmap and `other`.
+  void Intersect(const InlineBitmap& other) {
+    XLS_CHECK_EQ(bit_count(), other.bit_count());
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      data_[i] &= other.data_[i];
+    }
+  }
+
+  // Clears the bits of this bitmap which are set in `other`.
+  void Subtract(const InlineBitmap& other) {
+    XLS_CHECK_EQ(bit_count(), other.bit_count());
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      data_[i] &= ~other.data_[i];
+    }
+  }
+
+  // Sets this bitmap to the bitwise exclusive-or of this bitmap and `other`.
+  void Xor(const InlineBitmap& other) {
+    XLS_CHECK_EQ(bit_count(), other.bit_count());
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      data_[i] ^= other.data_[i];
+    }
+  }
+
+  // Inverts every bit of this bitmap.
+  void Invert() {
+    for (uint64_t& word : data_) {
+      word = ~word;
+    }
+    if (bit_count_ != 0) {
+      MaskLastWord();
+    }
+  }
+
   int64_t byte_count() const { return CeilOfRatio(bit_count_, int64_t{8}); }
 
   template <typename H>
@@ -191,7 +288,35 @@ class InlineBitmap {
  private:
   static constexpr int64_t kWordBits = 64;
   static constexpr int64_t kWordBytes = 8;
-  int64_t word_count() const { return data_.size(); }
+
+  // Returns word `wordno` with its bits inverted if `ones` is true, so that
+  // runs of ones can be counted as runs of zeros. Bits beyond bit_count() are
+  // zero in the result.
+  uint64_t WordForCount(int64_t wordno, bool ones) const {
+    return (ones ? ~data_[wordno] : data_[wordno]) & MaskForWord(wordno);
+  }
+
+  int64_t CountLeading(bool ones) const {
+    for (int64_t wordno = word_count() - 1; wordno >= 0; --wordno) {
+      uint64_t word = WordForCount(wordno, ones);
+      if (word != 0) {
+        int64_t top_index =
+            wordno * kWordBits + kWordBits - 1 - absl::countl_zero(word);
+        return bit_count_ - 1 - top_index;
+      }
+    }
+    return bit_count_;
+  }
+
+  int64_t CountTrailing(bool ones) const {
+    for (int64_t wordno = 0; wordno < word_count(); ++wordno) {
+      uint64_t word = WordForCount(wordno, ones);
+      if (word != 0) {
+        return wordno * kWordBits + absl::countr_zero(word);
+      }
+    }
+    return bit_count_;
+  }
 
   void MaskLastWord() {
     int64_t last_wordno = word_count() - 1;
@@ -294,5 +294,129 @@ TEST(InlineBitmapTest, Union) {
   }
 }
 
+TEST(InlineBitmapTest, FillMasksLastWord) {
+  InlineBitmap b(/*bit_count=*/70, /*fill=*/true);
+  EXPECT_EQ(b.GetWord(0), -1ULL);
+  EXPECT_EQ(b.GetWord(1), 0x3f);
+  EXPECT_TRUE(b.IsAllOnes());
+  b.Invert();
+  EXPECT_TRUE(b.IsAllZeroes());
+  EXPECT_EQ(b.GetWord(1), 0);
+}
+
+TEST(InlineBitmapTest, GetBitsAndOverwrite) {
+  // Set every third bit of a bitmap spanning several words.
+  InlineBitmap src(/*bit_count=*/200);
+  for (int64_t i = 0; i < src.bit_count(); i += 3) {
+    src.Set(i, true);
+  }
+  for (int64_t start : {0, 1, 63, 64, 65, 130}) {
+    for (int64_t width : {0, 1, 7, 63, 64}) {
+      if (start + width > src.bit_count()) {
+        continue;
+      }
+      uint64_t expected = 0;
+      for (int64_t i = 0; i < width; ++i) {
+        expected |= static_cast<uint64_t>(src.Get(start + i)) << i;
+      }
+      EXPECT_EQ(src.GetBits(start, width), expected)
+          << "start: " << start << " width: " << width;
+    }
+  }
+
+  for (int64_t src_start : {0, 5, 64, 71}) {
+    for (int64_t dst_start : {0, 3, 64, 100}) {
+      int64_t width = 97;
+      InlineBitmap dst(/*bit_count=*/250, /*fill=*/true);
+      dst.Overwrite(src, src_start, dst_start, width);
+      for (int64_t i = 0; i < dst.bit_count(); ++i) {
+        bool expected = (i >= dst_start && i < dst_start + width)
+                            ? src.Get(src_start + i - dst_start)
+                            : true;
+        ASSERT_EQ(dst.Get(i), expected)
+            << "src_start: " << src_start << " dst_start: " << dst_start
+            << " i: " << i;
+      }
+    }
+  }
+}
+
+TEST(InlineBitmapTest, Counts) {
+  InlineBitmap b(/*bit_count=*/150);
+  EXPECT_EQ(b.PopCount(), 0);
+  EXPECT_EQ(b.CountLeadingZeros(), 150);
+  EXPECT_EQ(b.CountTrailingZeros(), 150);
+  EXPECT_EQ(b.CountLeadingOnes(), 0);
+  EXPECT_EQ(b.CountTrailingOnes(), 0);
+
+  b.Set(3, true);
+  b.Set(70, true);
+  b.Set(140, true);
+  EXPECT_EQ(b.PopCount(), 3);
+  EXPECT_EQ(b.CountLeadingZeros(), 9);
+  EXPECT_EQ(b.CountTrailingZeros(), 3);
+
+  b.Invert();
+  EXPECT_EQ(b.PopCount(), 147);
+  EXPECT_EQ(b.CountLeadingOnes(), 9);
+  EXPECT_EQ(b.CountTrailingOnes(), 3);
+  EXPECT_EQ(b.CountLeadingZeros(), 0);
+  EXPECT_EQ(b.CountTrailingZeros(), 0);
+
+  InlineBitmap empty(/*bit_count=*/0);
+  EXPECT_EQ(empty.PopCount(), 0);
+  EXPECT_EQ(empty.CountLeadingZeros(), 0);
+  EXPECT_EQ(empty.CountTrailingOnes(), 0);
+}
+
+TEST(InlineBitmapTest, IntersectAndXor) {
+  InlineBitmap a(/*bit_count=*/80);
+  a.SetByte(0, 0xab);
+  a.SetByte(9, 0x84);
+  InlineBitmap b(/*bit_count=*/80);
+  b.SetByte(0, 0xf0);
+  b.SetByte(9, 0x8f);
+
+  InlineBitmap intersection = a;
+  intersection.Intersect(b);
+  EXPECT_EQ(intersection.GetByte(0), 0xa0);
+  EXPECT_EQ(intersection.GetByte(9), 0x84);
+
+  InlineBitmap difference = a;
+  difference.Xor(b);
+  EXPECT_EQ(difference.GetByte(0), 0x5b);
+  EXPECT_EQ(difference.GetByte(9), 0x0b);
+}
+
+TEST(InlineBitmapTest, SubtractAndIntersectionPopCount) {
+  InlineBitmap a(/*bit_count=*/80);
+  a.SetByte(0, 0xab);
+  a.SetByte(9, 0x84);
+  InlineBitmap b(/*bit_count=*/80);
+  b.SetByte(0, 0xf0);
+  b.SetByte(9, 0x8f);
+
+  EXPECT_EQ(a.IntersectionPopCount(b), 4);
+  EXPECT_EQ(b.IntersectionPopCount(a), 4);
+
+  InlineBitmap difference = a;
+  difference.Subtract(b);
+  EXPECT_EQ(difference.GetByte(0), 0x0b);
+  EXPECT_EQ(difference.GetByte(9), 0x00);
+  EXPECT_EQ(difference.IntersectionPopCount(b), 0);
+}
+
+TEST(InlineBitmapTest, WideUnsignedComparisons) {
+  InlineBitmap a(/*bit_count=*/130);
+  InlineBitmap b(/*bit_count=*/200);
+  a.Set(129, true);
+  b.Set(128, true);
+  EXPECT_EQ(a.UCmp(b), 1);
+  EXPECT_EQ(b.UCmp(a), -1);
+  b.Set(150, true);
+  EXPECT_EQ(a.UCmp(b), -1);
+  EXPECT_EQ(b.UCmp(a), 1);
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,10 @@
 #ifndef XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
 #define XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
 
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "absl/container/inlined_vector.h"
@@ -27,6 +31,101 @@
 
 namespace xls {
 
+template <typename T>
+class LeafTypeTree;
+
+namespace leaf_type_tree_internal {
+
+inline bool IsLeafType(Type* t) { return t->IsBits() || t->IsToken(); }
+
+// Returns a pair containing the Type and element offset for the given type
+// index.
+inline std::pair<Type*, int64_t> GetSubtypeAndOffset(
+    Type* t, absl::Span<int64_t const> index, int64_t offset = 0) {
+  if (index.empty()) {
+    return {t, offset};
+  }
+  if (t->IsArray()) {
+    XLS_CHECK(!index.empty());
+    XLS_CHECK_LT(index[0], t->AsArrayOrDie()->size());
+    Type* element_type = t->AsArrayOrDie()->element_type();
+    return GetSubtypeAndOffset(element_type, index.subspan(1),
+                               offset + index[0] * element_type->leaf_count());
+  }
+  XLS_CHECK(t->IsTuple());
+  TupleType* tuple_type = t->AsTupleOrDie();
+  XLS_CHECK_LT(index[0], tuple_type->size());
+  int64_t element_offset = 0;
+  for (int64_t i = 0; i < index[0]; ++i) {
+    element_offset += tuple_type->element_type(i)->leaf_count();
+  }
+  return GetSubtypeAndOffset(tuple_type->element_type(index[0]),
+                             index.subspan(1), offset + element_offset);
+}
+
+}  // namespace leaf_type_tree_internal
+
+// A non-owning view of a LeafTypeTree or of one of its subtrees. The view
+// refers to the elements and leaf types of the tree it was created from, so
+// it is cheap to create and copy, and it is only valid as long as that tree
+// is alive and unresized. T may be const-qualified for a read-only view.
+//
+// Example usage:
+//
+//   LeafTypeTree<int64_t> tree(t); /* (bits[42], (bits[123], bits[64])) */
+//   LeafTypeTreeView<int64_t> subtree = tree.AsView({1});
+//   subtree.Get({1}) = 333;  /* Same as tree.Set({1, 1}, 333) */
+template <typename T>
+class LeafTypeTreeView {
+ public:
+  LeafTypeTreeView(Type* type, absl::Span<T> elements,
+                   absl::Span<Type* const> leaf_types)
+      : type_(type), elements_(elements), leaf_types_(leaf_types) {
+    XLS_CHECK_EQ(elements_.size(), leaf_types_.size());
+  }
+
+  // A mutable view converts implicitly to a read-only one.
+  template <typename U,
+            typename = std::enable_if_t<std::is_same_v<const U, T> &&
+                                        !std::is_same_v<U, T>>>
+  LeafTypeTreeView(const LeafTypeTreeView<U>& other)  // NOLINT
+      : type_(other.type()),
+        elements_(other.elements()),
+        leaf_types_(other.leaf_types()) {}
+
+  Type* type() const { return type_; }
+  int64_t size() const { return elements_.size(); }
+  absl::Span<T> elements() const { return elements_; }
+  absl::Span<Type* const> leaf_types() const { return leaf_types_; }
+
+  // Returns the element at the given Type index, which must refer to a leaf
+  // of the view's type.
+  T& Get(absl::Span<int64_t const> index) const {
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
+    XLS_CHECK(leaf_type_tree_internal::IsLeafType(type_offset.first));
+    return elements_[type_offset.second];
+  }
+
+  // Returns a view of the subtree rooted at the given index.
+  LeafTypeTreeView<T> AsView(absl::Span<const int64_t> index) const {
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
+    int64_t leaf_count = type_offset.first->leaf_count();
+    return LeafTypeTreeView<T>(
+        type_offset.first, elements_.subspan(type_offset.second, leaf_count),
+        leaf_types_.subspan(type_offset.second, leaf_count));
+  }
+
+  // Copies the elements of the view into a new LeafTypeTree.
+  LeafTypeTree<std::remove_const_t<T>> ToTree() const;
+
+ private:
+  Type* type_;
+  absl::Span<T> elements_;
+  absl::Span<Type* const> leaf_types_;
+};
+
 // A container which stores values of an arbitrary type T, one value for each
 // leaf element (Bits value) of a potentially-recursive XLS type. Values are
 // stored in a flat vector which provides fast iteration, but indexing through
@@ -170,15 +269,48 @@ class LeafTypeTree {
   // Copies and returns the subtree rooted at the given type index as a
   // LeafTypeTree.
   LeafTypeTree<T> CopySubtree(absl::Span<const int64_t> index) const {
-    std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
-    // To avoid indexing into an empty vector, handle the empty elements()
-    // case specially.
-    return LeafTypeTree<T>(
-        type_offset.first,
-        type_offset.first->leaf_count() == 0
-            ? absl::Span<const T>()
-            : absl::Span<const T>(&elements_[type_offset.second],
-                                  type_offset.first->leaf_count()));
+    return AsView(index).ToTree();
+  }
+
+  // Returns a view of the subtree rooted at the given type index, or of the
+  // whole tree if `index` is empty. Unlike CopySubtree this does not copy any
+  // elements.
+  LeafTypeTreeView<T> AsView(absl::Span<const int64_t> index = {}) {
+    return LeafTypeTreeView<T>(type_, absl::MakeSpan(elements_),
+                               leaf_types_)
+        .AsView(index);
+  }
+  LeafTypeTreeView<const T> AsView(
+      absl::Span<const int64_t> index = {}) const {
+    return LeafTypeTreeView<const T>(type_, absl::MakeConstSpan(elements_),
+                                     leaf_types_)
+        .AsView(index);
+  }
+
+  // Replaces each element with the result of applying `function` to it.
+  // Unlike Map this modifies the tree in place, so no new tree is built.
+  void MapInPlace(const std::function<void(T&)>& function) {
+    for (T& element : elements_) {
+      function(element);
+    }
+  }
+
+  // Uses the given function to update each element with the corresponding
+  // element of `other` in place. CHECK fails if `other` does not have the
+  // same type as this tree.
+  template <typename U>
+  void ZipInPlace(const std::function<void(T&, const U&)>& function,
+                  LeafTypeTreeView<const U> other) {
+    XLS_CHECK(type_->IsEqualTo(other.type()));
+    XLS_CHECK_EQ(size(), other.size());
+    for (int64_t i = 0; i < size(); ++i) {
+      function(elements_[i], other.elements()[i]);
+    }
+  }
+  template <typename U>
+  void ZipInPlace(const std::function<void(T&, const U&)>& function,
+                  const LeafTypeTree<U>& other) {
+    ZipInPlace<U>(function, other.AsView());
   }
 
   // Produce a new `LeafTypeTree` from this one `LeafTypeTree` with a different
@@ -288,7 +420,19 @@ class LeafTypeTree {
   }
 
  private:
-  static bool IsLeafType(Type* t) { return t->IsBits() || t->IsToken(); }
+  template <typename U>
+  friend class LeafTypeTreeView;
+
+  // Constructor for views, which already know their leaf types.
+  LeafTypeTree(Type* type, absl::Span<const T> elements,
+               absl::Span<Type* const> leaf_types)
+      : type_(type),
+        elements_(elements.begin(), elements.end()),
+        leaf_types_(leaf_types.begin(), leaf_types.end()) {}
+
+  static bool IsLeafType(Type* t) {
+    return leaf_type_tree_internal::IsLeafType(t);
+  }
 
   std::string ToStringHelper(const std::function<std::string(const T&)>& f,
                              Type* subtype, bool multiline, int64_t indent,
@@ -353,29 +497,9 @@ class LeafTypeTree {
 
   // Returns a pair containing the Type and element offset for the given type
   // index.
-  std::pair<Type*, int64_t> GetSubtypeAndOffset(Type* t,
-                                                absl::Span<int64_t const> index,
-                                                int64_t offset = 0) const {
-    if (index.empty()) {
-      return {t, offset};
-    }
-    if (t->IsArray()) {
-      XLS_CHECK(!index.empty());
-      XLS_CHECK_LT(index[0], t->AsArrayOrDie()->size());
-      Type* element_type = t->AsArrayOrDie()->element_type();
-      return GetSubtypeAndOffset(
-          element_type, index.subspan(1),
-          offset + index[0] * element_type->leaf_count());
-    }
-    XLS_CHECK(t->IsTuple());
-    TupleType* tuple_type = t->AsTupleOrDie();
-    XLS_CHECK_LT(index[0], tuple_type->size());
-    int64_t element_offset = 0;
-    for (int64_t i = 0; i < index[0]; ++i) {
-      element_offset += tuple_type->element_type(i)->leaf_count();
-    }
-    return GetSubtypeAndOffset(tuple_type->element_type(index[0]),
-                               index.subspan(1), offset + element_offset);
+  std::pair<Type*, int64_t> GetSubtypeAndOffset(
+      Type* t, absl::Span<int64_t const> index) const {
+    return leaf_type_tree_internal::GetSubtypeAndOffset(t, index);
   }
 
   absl::Status ForEachHelper(
@@ -411,6 +535,11 @@ class LeafTypeTree {
   absl::InlinedVector<Type*, 1> leaf_types_;
 };
 
+template <typename T>
+LeafTypeTree<std::remove_const_t<T>> LeafTypeTreeView<T>::ToTree() const {
+  return LeafTypeTree<std::remove_const_t<T>>(type_, elements_, leaf_types_);
+}
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
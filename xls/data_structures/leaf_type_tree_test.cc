@@ -341,5 +341,52 @@ TEST_F(LeafTypeTreeTest, OutOfBoundsTest) {
   EXPECT_EQ(tree.CopySubtree({2, 0}).ToString(), "()");
 }
 
+TEST_F(LeafTypeTreeTest, Views) {
+  LeafTypeTree<int64_t> tree(AsType("(bits[32], (bits[8], bits[16])[2], ())"));
+  tree.Set({0}, 1);
+  tree.Set({1, 0, 0}, 2);
+  tree.Set({1, 0, 1}, 3);
+  tree.Set({1, 1, 0}, 4);
+  tree.Set({1, 1, 1}, 5);
+
+  LeafTypeTreeView<int64_t> whole = tree.AsView();
+  EXPECT_EQ(whole.type(), tree.type());
+  EXPECT_THAT(whole.elements(), ElementsAre(1, 2, 3, 4, 5));
+
+  LeafTypeTreeView<int64_t> array = tree.AsView({1});
+  EXPECT_EQ(array.type()->ToString(), "(bits[8], bits[16])[2]");
+  EXPECT_THAT(array.elements(), ElementsAre(2, 3, 4, 5));
+  EXPECT_THAT(AsStrings(array.leaf_types()),
+              ElementsAre("bits[8]", "bits[16]", "bits[8]", "bits[16]"));
+
+  // Views of views, and writes through views, refer to the original tree.
+  LeafTypeTreeView<int64_t> element = array.AsView({1});
+  EXPECT_THAT(element.elements(), ElementsAre(4, 5));
+  element.Get({1}) = 42;
+  EXPECT_EQ(tree.Get({1, 1, 1}), 42);
+
+  LeafTypeTreeView<const int64_t> read_only = element;
+  EXPECT_EQ(read_only.Get({0}), 4);
+  EXPECT_EQ(read_only.ToTree().ToString(), "(4, 42)");
+  EXPECT_EQ(read_only.ToTree(), tree.CopySubtree({1, 1}));
+
+  const LeafTypeTree<int64_t>& const_tree = tree;
+  EXPECT_EQ(const_tree.AsView({2}).size(), 0);
+  EXPECT_EQ(const_tree.AsView({2}).ToTree().ToString(), "()");
+}
+
+TEST_F(LeafTypeTreeTest, MapAndZipInPlace) {
+  Type* type = AsType("(bits[32], bits[32][3])");
+  LeafTypeTree<int64_t> tree(type, 10);
+  tree.Set({1, 2}, 20);
+  tree.MapInPlace([](int64_t& x) { x += 1; });
+  EXPECT_THAT(tree.elements(), ElementsAre(11, 11, 11, 21));
+
+  LeafTypeTree<int64_t> other(type, absl::Span<const int64_t>({1, 2, 3, 4}));
+  tree.ZipInPlace<int64_t>([](int64_t& x, const int64_t& y) { x *= y; },
+                           other);
+  EXPECT_THAT(tree.elements(), ElementsAre(11, 22, 33, 84));
+}
+
 }  // namespace
 }  // namespace xls
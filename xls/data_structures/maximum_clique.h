@@ -15,14 +15,22 @@
 #ifndef XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 #define XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "ortools/linear_solver/linear_solver.h"
 
 namespace xls {
@@ -93,6 +101,94 @@ absl::StatusOr<absl::btree_set<V>> MaximumClique(
   return result;
 }
 
+// Compute a maximum clique of the graph over the vertices [0, n) whose
+// adjacency matrix is `graph`: bit j of row i is set iff i and j are adjacent.
+// The matrix must be symmetric and its diagonal must be clear. Returns the
+// vertices of the clique in increasing order.
+//
+// This is a branch and bound search which bounds the size of the cliques
+// extending the current one by a greedy coloring of the candidate vertices
+// (Tomita and Seki's MCQ), with all set operations done a word at a time. It
+// handles much larger graphs than the ILP above. The search starts from a
+// greedily found maximal clique; if `time_budget` is exceeded, it stops and
+// returns the largest clique found so far, which is maximal but may not be
+// maximum.
+inline std::vector<int64_t> MaximumClique(
+    const std::vector<InlineBitmap>& graph,
+    absl::Duration time_budget = absl::InfiniteDuration()) {
+  const int64_t n = graph.size();
+  const absl::Time deadline = absl::Now() + time_budget;
+
+  // Greedily grow a clique from the empty one, each time adding the candidate
+  // with the most neighbors among the candidates.
+  std::vector<int64_t> best;
+  {
+    InlineBitmap candidates(n, /*fill=*/true);
+    while (!candidates.IsAllZeroes()) {
+      int64_t chosen = -1;
+      int64_t chosen_degree = -1;
+      for (int64_t vertex = 0; vertex < n; ++vertex) {
+        if (!candidates.Get(vertex)) {
+          continue;
+        }
+        int64_t degree = graph[vertex].IntersectionPopCount(candidates);
+        if (degree > chosen_degree) {
+          chosen = vertex;
+          chosen_degree = degree;
+        }
+      }
+      best.push_back(chosen);
+      candidates.Intersect(graph[chosen]);
+    }
+  }
+
+  std::vector<int64_t> clique;
+  std::function<void(InlineBitmap)> expand = [&](InlineBitmap candidates) {
+    if (absl::Now() > deadline) {
+      return;
+    }
+    // Color the candidates greedily. Vertices are listed in order of their
+    // color so that `colors[i]` bounds the size of any clique drawn from
+    // `order[0..i]`.
+    std::vector<int64_t> order;
+    std::vector<int64_t> colors;
+    InlineBitmap uncolored = candidates;
+    for (int64_t color = 1; !uncolored.IsAllZeroes(); ++color) {
+      InlineBitmap color_candidates = uncolored;
+      while (!color_candidates.IsAllZeroes()) {
+        int64_t vertex = color_candidates.CountTrailingZeros();
+        color_candidates.Set(vertex, false);
+        color_candidates.Subtract(graph[vertex]);
+        uncolored.Set(vertex, false);
+        order.push_back(vertex);
+        colors.push_back(color);
+      }
+    }
+    for (int64_t i = order.size() - 1; i >= 0; --i) {
+      if (clique.size() + colors[i] <= best.size()) {
+        return;
+      }
+      int64_t vertex = order[i];
+      clique.push_back(vertex);
+      InlineBitmap next_candidates = candidates;
+      next_candidates.Intersect(graph[vertex]);
+      if (next_candidates.IsAllZeroes()) {
+        if (clique.size() > best.size()) {
+          best = clique;
+        }
+      } else {
+        expand(std::move(next_candidates));
+      }
+      clique.pop_back();
+      candidates.Set(vertex, false);
+    }
+  };
+  expand(InlineBitmap(n, /*fill=*/true));
+
+  std::sort(best.begin(), best.end());
+  return best;
+}
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
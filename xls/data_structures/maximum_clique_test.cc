@@ -14,12 +14,17 @@
 
 #include "xls/data_structures/maximum_clique.h"
 
+#include <cstdint>
 #include <random>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "absl/time/time.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -152,5 +157,57 @@ TEST(MaximumCliqueTest, Big) {
   EXPECT_TRUE(IsValidClique(graph, clique));
 }
 
+// Returns the graph of the Big test above as an adjacency matrix.
+std::vector<InlineBitmap> BigBitmapGraph() {
+  constexpr int64_t kNodeCount = 100;
+  std::vector<InlineBitmap> graph(kNodeCount, InlineBitmap(kNodeCount));
+  std::mt19937 gen;
+  std::bernoulli_distribution coin(0.5);
+  for (int64_t x = 0; x < kNodeCount; ++x) {
+    for (int64_t y = 0; y < kNodeCount; ++y) {
+      if (coin(gen) && x != y) {
+        graph[x].Set(y, true);
+        graph[y].Set(x, true);
+      }
+    }
+  }
+  return graph;
+}
+
+bool IsValidBitmapClique(const std::vector<InlineBitmap>& graph,
+                         const std::vector<int64_t>& clique) {
+  for (int64_t x : clique) {
+    for (int64_t y : clique) {
+      if (x != y && !graph[x].Get(y)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(MaximumCliqueTest, BitmapBig) {
+  std::vector<InlineBitmap> graph = BigBitmapGraph();
+  std::vector<int64_t> clique = MaximumClique(graph);
+  EXPECT_EQ(clique.size(), 17);
+  EXPECT_TRUE(IsValidBitmapClique(graph, clique));
+}
+
+TEST(MaximumCliqueTest, BitmapOutOfTime) {
+  std::vector<InlineBitmap> graph = BigBitmapGraph();
+  std::vector<int64_t> clique = MaximumClique(graph, absl::ZeroDuration());
+  EXPECT_TRUE(IsValidBitmapClique(graph, clique));
+  EXPECT_LE(clique.size(), 17);
+  // The greedily found clique is maximal.
+  for (int64_t vertex = 0; vertex < graph.size(); ++vertex) {
+    if (absl::c_linear_search(clique, vertex)) {
+      continue;
+    }
+    std::vector<int64_t> extended = clique;
+    extended.push_back(vertex);
+    EXPECT_FALSE(IsValidBitmapClique(graph, extended)) << vertex;
+  }
+}
+
 }  // namespace
 }  // namespace xls
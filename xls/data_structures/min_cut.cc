@@ -15,9 +15,11 @@
 #include "xls/data_structures/min_cut.h"
 
 #include <deque>
+#include <numeric>
 #include <set>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -267,48 +269,267 @@ int64_t AugmentFlow(const Graph& graph, NodeId source, NodeId sink,
   return 0;
 }
 
-}  // namespace
-
-GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink) {
+// Computes a maximum flow with the Ford-Fulkerson method and returns the set of
+// nodes reachable from the source in the resulting residual graph. The vector
+// is indexed by NodeId.
+std::vector<bool> AugmentingPathMinCut(const Graph& graph, NodeId source,
+                                       NodeId sink) {
   // This loop is the core of the Ford-Fulkerson method. Starting with zero flow
   // on all edges, flow is increased along a path from source to sink with
   // residual capacity (called an augmenting path). When no further augmenting
-  // paths exist, flow has been maximized. 'flow' is the flow of each edge in
-  // the graph indexed by EdgeId.
+  // paths exist, flow has been maximized.
   ResidualGraph residual_graph(graph);
   while (AugmentFlow(graph, source, sink, &residual_graph) > 0) {
   }
 
   // Once a maximum flow is found, walk the residual graph from the source. All
   // reachable nodes form one partition.
-  absl::flat_hash_set<NodeId> reachable_from_source;
+  std::vector<bool> reachable_from_source(graph.node_count(), false);
   std::deque<NodeId> frontier = {source};
-  reachable_from_source.insert(source);
+  reachable_from_source[int64_t{source}] = true;
   while (!frontier.empty()) {
     NodeId node = frontier.front();
     frontier.pop_front();
     for (EdgeId successor_edge_id : residual_graph.successors(node)) {
       const ResidualEdge& edge = residual_graph.edge(successor_edge_id);
-      if (edge.capacity > 0 && !reachable_from_source.contains(edge.to)) {
-        reachable_from_source.insert(edge.to);
+      if (edge.capacity > 0 && !reachable_from_source[int64_t{edge.to}]) {
+        reachable_from_source[int64_t{edge.to}] = true;
         frontier.push_back(edge.to);
       }
     }
   }
-  XLS_CHECK(!reachable_from_source.contains(sink));
+  return reachable_from_source;
+}
+
+// The residual graph used by the push-relabel algorithm. Nodes are identified
+// by the integer value of their NodeId. Arcs are stored in compressed sparse
+// row form: the arcs leaving node `n` are numbered contiguously in
+// [arc_begin(n), arc_end(n)) so scanning the arcs of a node touches contiguous
+// memory. Each edge in the original graph yields a forward arc with the edge's
+// weight as capacity and a backward arc with zero capacity.
+class CsrResidualGraph {
+ public:
+  explicit CsrResidualGraph(const Graph& graph) {
+    int64_t node_count = graph.node_count();
+    arc_begin_.assign(node_count + 1, 0);
+    for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id();
+         edge_id += EdgeId{1}) {
+      const Edge& edge = graph.edge(edge_id);
+      ++arc_begin_[int64_t{edge.from} + 1];
+      ++arc_begin_[int64_t{edge.to} + 1];
+    }
+    std::partial_sum(arc_begin_.begin(), arc_begin_.end(), arc_begin_.begin());
+
+    std::vector<int64_t> next_arc(arc_begin_.begin(), arc_begin_.end() - 1);
+    targets_.resize(2 * graph.edge_count());
+    capacities_.resize(2 * graph.edge_count());
+    reverse_arcs_.resize(2 * graph.edge_count());
+    for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id();
+         edge_id += EdgeId{1}) {
+      const Edge& edge = graph.edge(edge_id);
+      XLS_CHECK_GE(edge.weight, 0);
+      int64_t forward_arc = next_arc[int64_t{edge.from}]++;
+      int64_t backward_arc = next_arc[int64_t{edge.to}]++;
+      targets_[forward_arc] = int64_t{edge.to};
+      capacities_[forward_arc] = edge.weight;
+      reverse_arcs_[forward_arc] = backward_arc;
+      targets_[backward_arc] = int64_t{edge.from};
+      capacities_[backward_arc] = 0;
+      reverse_arcs_[backward_arc] = forward_arc;
+    }
+  }
+
+  int64_t node_count() const { return arc_begin_.size() - 1; }
+  int64_t arc_begin(int64_t node) const { return arc_begin_[node]; }
+  int64_t arc_end(int64_t node) const { return arc_begin_[node + 1]; }
+  int64_t target(int64_t arc) const { return targets_[arc]; }
+  int64_t capacity(int64_t arc) const { return capacities_[arc]; }
+  int64_t reverse_arc(int64_t arc) const { return reverse_arcs_[arc]; }
+
+  // Push flow along the given arc. The capacity of the arc is reduced and the
+  // capacity of its reverse arc is increased.
+  void PushFlow(int64_t amount, int64_t arc) {
+    capacities_[arc] -= amount;
+    capacities_[reverse_arcs_[arc]] += amount;
+  }
+
+ private:
+  // Index of the first arc of each node. Has node_count() + 1 entries.
+  std::vector<int64_t> arc_begin_;
+
+  // The target node, residual capacity, and reverse arc of each arc.
+  std::vector<int32_t> targets_;
+  std::vector<int64_t> capacities_;
+  std::vector<int64_t> reverse_arcs_;
+};
+
+// Computes a maximum flow with the FIFO push-relabel algorithm and returns the
+// set of nodes reachable from the source in the resulting residual graph. The
+// vector is indexed by NodeId.
+//
+// Nodes may hold more incoming flow than outgoing flow (excess). Active nodes
+// (those with excess) push it along admissible arcs, residual arcs to a node
+// whose height is exactly one less, and are relabeled (raised) when no
+// admissible arc remains. Heights start at the BFS distance to the sink. When
+// no node remains at some height below the node count the nodes above that
+// height cannot reach the sink and are raised above the source at once (the
+// gap heuristic). The algorithm runs until no node has excess, at which point
+// all excess which could not reach the sink has been returned to the source
+// and the preflow is a maximum flow.
+std::vector<bool> PushRelabelMinCut(const Graph& graph, NodeId source_id,
+                                    NodeId sink_id) {
+  CsrResidualGraph residual_graph(graph);
+  int64_t node_count = residual_graph.node_count();
+  int64_t source = int64_t{source_id};
+  int64_t sink = int64_t{sink_id};
+
+  // Initialize heights to the distance to the sink in the residual graph.
+  // Nodes which cannot reach the sink start at the height of the source.
+  std::vector<int64_t> height(node_count, node_count);
+  height[sink] = 0;
+  std::vector<int64_t> bfs_queue = {sink};
+  for (int64_t i = 0; i < bfs_queue.size(); ++i) {
+    int64_t node = bfs_queue[i];
+    for (int64_t arc = residual_graph.arc_begin(node);
+         arc < residual_graph.arc_end(node); ++arc) {
+      int64_t predecessor = residual_graph.target(arc);
+      if (predecessor != source && height[predecessor] == node_count &&
+          residual_graph.capacity(residual_graph.reverse_arc(arc)) > 0) {
+        height[predecessor] = height[node] + 1;
+        bfs_queue.push_back(predecessor);
+      }
+    }
+  }
+  height[source] = node_count;
+
+  // The number of nodes at each height below `node_count`. Used to detect
+  // gaps.
+  std::vector<int64_t> height_count(node_count, 0);
+  std::vector<int64_t> current_arc(node_count);
+  for (int64_t node = 0; node < node_count; ++node) {
+    if (height[node] < node_count) {
+      ++height_count[height[node]];
+    }
+    current_arc[node] = residual_graph.arc_begin(node);
+  }
+
+  // Excess can be the sum of many maximum weight edges so it is kept in 128
+  // bits. The amount pushed along any one arc always fits in 64 bits.
+  std::vector<absl::int128> excess(node_count, 0);
+  std::deque<int64_t> active;
+  auto push = [&](int64_t node, int64_t arc, int64_t amount) {
+    int64_t target = residual_graph.target(arc);
+    residual_graph.PushFlow(amount, arc);
+    excess[node] -= amount;
+    if (excess[target] == 0 && target != source && target != sink) {
+      active.push_back(target);
+    }
+    excess[target] += amount;
+  };
+  auto relabel = [&](int64_t node) {
+    int64_t old_height = height[node];
+    current_arc[node] = residual_graph.arc_begin(node);
+    if (old_height < node_count && --height_count[old_height] == 0) {
+      // Gap heuristic.
+      for (int64_t other = 0; other < node_count; ++other) {
+        if (height[other] > old_height && height[other] < node_count) {
+          --height_count[height[other]];
+          height[other] = node_count + 1;
+          current_arc[other] = residual_graph.arc_begin(other);
+        }
+      }
+      height[node] = node_count + 1;
+      return;
+    }
+    int64_t min_height = std::numeric_limits<int64_t>::max();
+    for (int64_t arc = residual_graph.arc_begin(node);
+         arc < residual_graph.arc_end(node); ++arc) {
+      if (residual_graph.capacity(arc) > 0) {
+        min_height = std::min(min_height, height[residual_graph.target(arc)]);
+      }
+    }
+    // A node with excess always has a residual path back to the source.
+    XLS_CHECK_NE(min_height, std::numeric_limits<int64_t>::max());
+    height[node] = min_height + 1;
+    if (height[node] < node_count) {
+      ++height_count[height[node]];
+    }
+  };
+
+  if (source != sink) {
+    for (int64_t arc = residual_graph.arc_begin(source);
+         arc < residual_graph.arc_end(source); ++arc) {
+      if (residual_graph.capacity(arc) > 0) {
+        push(source, arc, residual_graph.capacity(arc));
+      }
+    }
+  }
+  while (!active.empty()) {
+    int64_t node = active.front();
+    active.pop_front();
+    // Discharge the node.
+    while (excess[node] > 0) {
+      int64_t arc = current_arc[node];
+      if (arc == residual_graph.arc_end(node)) {
+        relabel(node);
+        continue;
+      }
+      int64_t capacity = residual_graph.capacity(arc);
+      if (capacity > 0 &&
+          height[node] == height[residual_graph.target(arc)] + 1) {
+        push(node, arc,
+             excess[node] < capacity ? static_cast<int64_t>(excess[node])
+                                     : capacity);
+      } else {
+        ++current_arc[node];
+      }
+    }
+  }
+
+  std::vector<bool> reachable_from_source(node_count, false);
+  reachable_from_source[source] = true;
+  bfs_queue = {source};
+  for (int64_t i = 0; i < bfs_queue.size(); ++i) {
+    int64_t node = bfs_queue[i];
+    for (int64_t arc = residual_graph.arc_begin(node);
+         arc < residual_graph.arc_end(node); ++arc) {
+      int64_t target = residual_graph.target(arc);
+      if (residual_graph.capacity(arc) > 0 && !reachable_from_source[target]) {
+        reachable_from_source[target] = true;
+        bfs_queue.push_back(target);
+      }
+    }
+  }
+  return reachable_from_source;
+}
+
+}  // namespace
+
+GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink,
+                            MaxFlowAlgorithm algorithm) {
+  std::vector<bool> reachable_from_source;
+  switch (algorithm) {
+    case MaxFlowAlgorithm::kAugmentingPath:
+      reachable_from_source = AugmentingPathMinCut(graph, source, sink);
+      break;
+    case MaxFlowAlgorithm::kPushRelabel:
+      reachable_from_source = PushRelabelMinCut(graph, source, sink);
+      break;
+  }
+  XLS_CHECK(!reachable_from_source[int64_t{sink}]);
 
   GraphCut min_cut;
   min_cut.weight = 0;
   for (NodeId node_id = NodeId(0); node_id <= graph.max_node_id(); ++node_id) {
-    if (reachable_from_source.contains(node_id)) {
+    if (reachable_from_source[int64_t{node_id}]) {
       min_cut.source_partition.push_back(node_id);
     } else {
       min_cut.sink_partition.push_back(node_id);
     }
     for (EdgeId edge_id : graph.successors(node_id)) {
       const Edge& edge = graph.edge(edge_id);
-      if (reachable_from_source.contains(edge.from) &&
-          !reachable_from_source.contains(edge.to)) {
+      if (reachable_from_source[int64_t{edge.from}] &&
+          !reachable_from_source[int64_t{edge.to}]) {
         min_cut.weight += edge.weight;
       }
     }
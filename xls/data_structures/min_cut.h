@@ -94,12 +94,27 @@ struct GraphCut {
   std::string ToString(const Graph& graph) const;
 };
 
+// The algorithm used to compute the maximum flow from which a min cut is
+// derived.
+enum class MaxFlowAlgorithm {
+  // The Ford-Fulkerson method augmenting along shortest paths found by BFS.
+  // Simple but slow on graphs with many edges.
+  kAugmentingPath,
+  // FIFO push-relabel with the gap heuristic over a residual graph stored in
+  // compressed sparse row form. Worst case run time is O(V^3) and it is much
+  // faster than kAugmentingPath on large graphs.
+  kPushRelabel,
+};
+
 // Computes a minimum cut of the given graph where source and sink are in
 // different partitions. The cut is returned as a partitioning of the nodes of
-// the graph into two sets of nodes on either side of the cut. The min cut is
-// found via the Ford-Fulkerson method using Dinic's algorithm. This results in
-// a worst case run time of O(V^2 * E).
-GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink);
+// the graph into two sets of nodes on either side of the cut. The source
+// partition is the set of nodes reachable from the source in the residual
+// graph of a maximum flow. This set is the same for every maximum flow so the
+// cut does not depend on `algorithm`.
+GraphCut MinCutBetweenNodes(
+    const Graph& graph, NodeId source, NodeId sink,
+    MaxFlowAlgorithm algorithm = MaxFlowAlgorithm::kPushRelabel);
 
 }  // namespace min_cut
 }  // namespace xls
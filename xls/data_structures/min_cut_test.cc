@@ -355,6 +355,66 @@ TEST(MinCutTest, ResidualGraphTraversalTest) {
   EXPECT_EQ(min_cut.weight, 2);
 }
 
+TEST(MinCutTest, AlgorithmsProduceSameCut) {
+  // The source partition is the set of nodes reachable from the source in the
+  // residual graph of any maximum flow so both algorithms must produce exactly
+  // the same cut.
+  for (bool acyclic : {false, true}) {
+    for (int64_t layer_count = 5; layer_count < 30; layer_count += 6) {
+      for (int64_t nodes_in_layer = 5; nodes_in_layer < 30;
+           nodes_in_layer += 6) {
+        NodeId source;
+        NodeId sink;
+        Graph graph = MakeLargeGraph(acyclic, &source, &sink, layer_count,
+                                     nodes_in_layer);
+        GraphCut augmenting_path_cut = MinCutBetweenNodes(
+            graph, source, sink, MaxFlowAlgorithm::kAugmentingPath);
+        GraphCut push_relabel_cut = MinCutBetweenNodes(
+            graph, source, sink, MaxFlowAlgorithm::kPushRelabel);
+        EXPECT_EQ(augmenting_path_cut.weight, push_relabel_cut.weight);
+        EXPECT_EQ(augmenting_path_cut.source_partition,
+                  push_relabel_cut.source_partition);
+        EXPECT_EQ(augmenting_path_cut.sink_partition,
+                  push_relabel_cut.sink_partition);
+      }
+    }
+  }
+}
+
+TEST(MinCutTest, PushRelabelSelfLoopsAndParallelEdges) {
+  Graph graph;
+  auto source = graph.AddNode("source");
+  auto a = graph.AddNode("a");
+  auto sink = graph.AddNode("sink");
+  graph.AddEdge(source, source, 5);
+  graph.AddEdge(source, a, 2);
+  graph.AddEdge(source, a, 3);
+  graph.AddEdge(a, a, 7);
+  graph.AddEdge(a, sink, 4);
+  graph.AddEdge(a, sink, std::numeric_limits<int64_t>::max());
+
+  GraphCut min_cut = MinCutBetweenNodes(graph, source, sink,
+                                        MaxFlowAlgorithm::kPushRelabel);
+  EXPECT_EQ(min_cut.weight, 5);
+  EXPECT_THAT(min_cut.source_partition, UnorderedElementsAre(source));
+  EXPECT_THAT(min_cut.sink_partition, UnorderedElementsAre(a, sink));
+}
+
+TEST(MinCutTest, MaxFlowAlgorithmsAgreeOnLargeGraph) {
+  // Both max flow algorithms must produce the same cut. Their run times are
+  // compared by //xls/benchmarks:min_cut_benchmark.
+  NodeId source;
+  NodeId sink;
+  Graph graph = MakeLargeGraph(/*acyclic=*/true, &source, &sink,
+                               /*layer_count=*/60, /*nodes_in_layer=*/60);
+  GraphCut augmenting_path_cut = MinCutBetweenNodes(
+      graph, source, sink, MaxFlowAlgorithm::kAugmentingPath);
+  GraphCut push_relabel_cut =
+      MinCutBetweenNodes(graph, source, sink, MaxFlowAlgorithm::kPushRelabel);
+  EXPECT_EQ(augmenting_path_cut.source_partition,
+            push_relabel_cut.source_partition);
+}
+
 }  // namespace
 }  // namespace min_cut
 }  // namespace xls
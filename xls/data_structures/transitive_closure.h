@@ -15,17 +15,26 @@
 #ifndef XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 #define XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 
 template <typename V>
 using HashRelation = absl::flat_hash_map<V, absl::flat_hash_set<V>>;
 
+// A relation over the integers [0, n) stored as n rows of n bits each; bit j
+// of row i is set iff i is related to j.
+using BitmapRelation = std::vector<InlineBitmap>;
+
 // Compute the transitive closure of a relation.
 template <typename V>
 HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
@@ -95,6 +104,31 @@ HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
   return result;
 }
 
+// Compute the transitive closure of a dense relation.
+//
+// This is Warshall's algorithm with the innermost loop done a word at a time:
+// for each k, every row which contains k absorbs row k. It takes O(n^3 / 64)
+// time regardless of the number of pairs in the relation, which makes it much
+// faster than the HashRelation version above unless the relation is sparse.
+inline BitmapRelation TransitiveClosure(BitmapRelation relation) {
+  const int64_t n = relation.size();
+  for (const InlineBitmap& row : relation) {
+    XLS_CHECK_EQ(row.bit_count(), n);
+  }
+  for (int64_t k = 0; k < n; ++k) {
+    const InlineBitmap& row_k = relation[k];
+    if (row_k.IsAllZeroes()) {
+      continue;
+    }
+    for (int64_t i = 0; i < n; ++i) {
+      if (i != k && relation[i].Get(k)) {
+        relation[i].Union(row_k);
+      }
+    }
+  }
+  return relation;
+}
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
@@ -14,14 +14,22 @@
 
 #include "xls/data_structures/transitive_closure.h"
 
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::UnorderedElementsAre;
 
 using V = std::string;
@@ -41,5 +49,75 @@ TEST(TransitiveClosureTest, Simple) {
   EXPECT_FALSE(tc.contains("qux"));
 }
 
+BitmapRelation EmptyBitmapRelation(int64_t n) {
+  return BitmapRelation(n, InlineBitmap(n));
+}
+
+TEST(TransitiveClosureTest, BitmapSimple) {
+  // 0 -> 1 -> {2, 3}, 2 -> 3, 4 -> 2.
+  BitmapRelation rel = EmptyBitmapRelation(5);
+  rel[0].Set(1, true);
+  rel[1].Set(2, true);
+  rel[1].Set(3, true);
+  rel[2].Set(3, true);
+  rel[4].Set(2, true);
+  BitmapRelation tc = TransitiveClosure(rel);
+  auto row = [&](int64_t i) {
+    std::vector<int64_t> result;
+    for (int64_t j = 0; j < 5; ++j) {
+      if (tc[i].Get(j)) {
+        result.push_back(j);
+      }
+    }
+    return result;
+  };
+  EXPECT_THAT(row(0), ElementsAre(1, 2, 3));
+  EXPECT_THAT(row(1), ElementsAre(2, 3));
+  EXPECT_THAT(row(2), ElementsAre(3));
+  EXPECT_THAT(row(3), IsEmpty());
+  EXPECT_THAT(row(4), ElementsAre(2, 3));
+}
+
+TEST(TransitiveClosureTest, BitmapCycle) {
+  BitmapRelation rel = EmptyBitmapRelation(3);
+  rel[0].Set(1, true);
+  rel[1].Set(2, true);
+  rel[2].Set(0, true);
+  BitmapRelation tc = TransitiveClosure(rel);
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(tc[i].IsAllOnes()) << i;
+  }
+}
+
+// Compares the bitmap version against the hash version on a random DAG wide
+// enough to span several words per row. Their run times are compared by
+// //xls/benchmarks:transitive_closure_benchmark.
+TEST(TransitiveClosureTest, BitmapMatchesHashOnRandomDag) {
+  constexpr int64_t kNodeCount = 130;
+  std::mt19937_64 rng(42);
+  std::bernoulli_distribution edge(0.03);
+  HashRelation<int64_t> hash_rel;
+  BitmapRelation bitmap_rel = EmptyBitmapRelation(kNodeCount);
+  for (int64_t i = 0; i < kNodeCount; ++i) {
+    for (int64_t j = i + 1; j < kNodeCount; ++j) {
+      if (edge(rng)) {
+        hash_rel[i].insert(j);
+        bitmap_rel[i].Set(j, true);
+      }
+    }
+  }
+
+  HashRelation<int64_t> hash_tc = TransitiveClosure<int64_t>(hash_rel);
+  BitmapRelation bitmap_tc = TransitiveClosure(bitmap_rel);
+
+  for (int64_t i = 0; i < kNodeCount; ++i) {
+    for (int64_t j = 0; j < kNodeCount; ++j) {
+      EXPECT_EQ(bitmap_tc[i].Get(j),
+                hash_tc.contains(i) && hash_tc.at(i).contains(j))
+          << i << " -> " << j;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -73,6 +73,76 @@ class UnionFind {
   UnionFindMap<T, absl::monostate> union_find_map_;
 };
 
+// A union-find data structure over the integers [0, size()) backed by arrays
+// rather than hash maps, for elements which are already dense indices. Find
+// uses path halving and Union merges by rank, so a sequence of operations
+// takes nearly linear time.
+class DenseUnionFind {
+ public:
+  // Creates the data structure with the elements [0, size), each in its own
+  // equivalence class.
+  explicit DenseUnionFind(int64_t size = 0) {
+    parent_.reserve(size);
+    rank_.reserve(size);
+    for (int64_t i = 0; i < size; ++i) {
+      Add();
+    }
+  }
+
+  // Adds a new element in its own equivalence class and returns it. The new
+  // element is the previous value of size().
+  int64_t Add() {
+    int64_t element = parent_.size();
+    parent_.push_back(element);
+    rank_.push_back(0);
+    ++class_count_;
+    return element;
+  }
+
+  // Union together the equivalence classes of two elements. Returns the
+  // representative of the merged class.
+  int64_t Union(int64_t x, int64_t y) {
+    x = Find(x);
+    y = Find(y);
+    if (x == y) {
+      return x;
+    }
+    if (rank_[x] < rank_[y]) {
+      std::swap(x, y);
+    }
+    parent_[y] = x;
+    if (rank_[x] == rank_[y]) {
+      ++rank_[x];
+    }
+    --class_count_;
+    return x;
+  }
+
+  // Returns the representative element in the given element's equivalence
+  // class.
+  int64_t Find(int64_t element) {
+    XLS_DCHECK_GE(element, 0);
+    XLS_DCHECK_LT(element, size());
+    while (parent_[element] != element) {
+      parent_[element] = parent_[parent_[element]];
+      element = parent_[element];
+    }
+    return element;
+  }
+
+  // Returns the number of elements in the data structure.
+  int64_t size() const { return parent_.size(); }
+
+  // Returns the number of equivalence classes.
+  int64_t class_count() const { return class_count_; }
+
+ private:
+  std::vector<int64_t> parent_;
+  // Upper bound on the height of the tree rooted at each representative.
+  std::vector<uint8_t> rank_;
+  int64_t class_count_ = 0;
+};
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_UNION_FIND_H_
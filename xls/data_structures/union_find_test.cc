@@ -14,6 +14,8 @@
 
 #include "xls/data_structures/union_find.h"
 
+#include <cstdint>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -67,5 +69,49 @@ TEST(UnionFindTest, UnionFind) {
   EXPECT_THAT(uf.Find('a'), AnyOf('a', 'b', 'c', 'd'));
 }
 
+TEST(UnionFindTest, DenseUnionFind) {
+  DenseUnionFind uf(4);
+  EXPECT_EQ(uf.size(), 4);
+  EXPECT_EQ(uf.class_count(), 4);
+  for (int64_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(uf.Find(i), i);
+  }
+
+  // Unioning an element with itself should have no effect.
+  EXPECT_EQ(uf.Union(0, 0), 0);
+  EXPECT_EQ(uf.class_count(), 4);
+
+  int64_t rep = uf.Union(0, 1);
+  EXPECT_THAT(rep, AnyOf(0, 1));
+  EXPECT_EQ(uf.Find(0), rep);
+  EXPECT_EQ(uf.Find(1), rep);
+  EXPECT_EQ(uf.Find(2), 2);
+  EXPECT_EQ(uf.class_count(), 3);
+
+  EXPECT_EQ(uf.Add(), 4);
+  EXPECT_EQ(uf.Find(4), 4);
+
+  uf.Union(2, 4);
+  rep = uf.Union(4, 1);
+  for (int64_t i : {0, 1, 2, 4}) {
+    EXPECT_EQ(uf.Find(i), rep);
+  }
+  EXPECT_EQ(uf.Find(3), 3);
+  EXPECT_EQ(uf.class_count(), 2);
+}
+
+TEST(UnionFindTest, DenseUnionFindLongChain) {
+  constexpr int64_t kSize = 100000;
+  DenseUnionFind uf(kSize);
+  for (int64_t i = 1; i < kSize; ++i) {
+    uf.Union(i - 1, i);
+  }
+  EXPECT_EQ(uf.class_count(), 1);
+  int64_t rep = uf.Find(0);
+  for (int64_t i = 0; i < kSize; ++i) {
+    EXPECT_EQ(uf.Find(i), rep);
+  }
+}
+
 }  // namespace
 }  // namespace xls
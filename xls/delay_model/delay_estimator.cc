@@ -14,7 +14,12 @@
 
 #include "xls/delay_model/delay_estimator.h"
 
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/common/status/status_builder.h"
@@ -24,6 +29,17 @@
 
 namespace xls {
 
+absl::StatusOr<std::vector<int64_t>> DelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<int64_t> delays;
+  delays.reserve(nodes.size());
+  for (Node* node : nodes) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay, GetOperationDelayInPs(node));
+    delays.push_back(delay);
+  }
+  return delays;
+}
+
 DelayEstimatorManager& GetDelayEstimatorManagerSingleton() {
   static DelayEstimatorManager* manager = new DelayEstimatorManager;
   return *manager;
@@ -169,6 +185,75 @@ absl::StatusOr<int64_t> DecoratingDelayEstimator::GetOperationDelayInPs(
   return modifier_(node, original);
 }
 
+namespace {
+
+// Returns the cache key of the given node for CachingDelayEstimator, or
+// std::nullopt if the delay of the node cannot be determined from the key.
+std::optional<std::string> DelayCacheKey(Node* node) {
+  switch (node->op()) {
+    case Op::kCountedFor:
+    case Op::kDynamicCountedFor:
+    case Op::kInvoke:
+    case Op::kMap:
+      return std::nullopt;
+    default:
+      break;
+  }
+  std::string key =
+      absl::StrCat(OpToString(node->op()), ":", node->GetType()->ToString());
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    Node* operand = node->operand(i);
+    int64_t first_index = i;
+    for (int64_t j = 0; j < i; ++j) {
+      if (node->operand(j) == operand) {
+        first_index = j;
+        break;
+      }
+    }
+    absl::StrAppend(&key, ",", operand->GetType()->ToString(),
+                    operand->Is<Literal>() ? "L" : "", "#", first_index);
+  }
+  return key;
+}
+
+}  // namespace
+
+CachingDelayEstimator::CachingDelayEstimator(const DelayEstimator& cached)
+    : DelayEstimator(cached.name()), cached_(cached) {}
+
+absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
+    Node* node) const {
+  std::optional<std::string> key = DelayCacheKey(node);
+  if (!key.has_value()) {
+    return cached_.GetOperationDelayInPs(node);
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = delays_.find(*key);
+    if (it != delays_.end()) {
+      ++hit_count_;
+      return it->second;
+    }
+    ++miss_count_;
+  }
+  // The lock is not held while computing the delay so that concurrent misses
+  // do not serialize. Errors are not cached.
+  XLS_ASSIGN_OR_RETURN(int64_t delay, cached_.GetOperationDelayInPs(node));
+  absl::MutexLock lock(&mutex_);
+  delays_.emplace(*std::move(key), delay);
+  return delay;
+}
+
+int64_t CachingDelayEstimator::hit_count() const {
+  absl::MutexLock lock(&mutex_);
+  return hit_count_;
+}
+
+int64_t CachingDelayEstimator::miss_count() const {
+  absl::MutexLock lock(&mutex_);
+  return miss_count_;
+}
+
 /* static */ absl::StatusOr<int64_t> DelayEstimator::GetLogicalEffortDelayInPs(
     Node* node, int64_t tau_in_ps) {
   XLS_ASSIGN_OR_RETURN(int64_t delay_in_tau, GetLogicalEffortDelayInTau(node));
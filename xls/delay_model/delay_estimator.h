@@ -16,9 +16,13 @@
 #define XLS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node.h"
@@ -36,6 +40,12 @@ class DelayEstimator {
   // Returns the estimated delay of the given node in picoseconds.
   virtual absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const = 0;
 
+  // Returns the estimated delays of the given nodes in picoseconds, in the
+  // order of the nodes. Clients which need the delay of every node of a
+  // function should prefer this to querying each node separately.
+  virtual absl::StatusOr<std::vector<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const;
+
   // Compute the delay of the given node using logical effort estimation. Only
   // relatively simple operations (kAnd, kOr, etc) are supported using this
   // method.
@@ -62,6 +72,36 @@ class DecoratingDelayEstimator : public DelayEstimator {
   std::function<int64_t(Node*, int64_t)> modifier_;
 };
 
+// Memoizes the delays computed by an underlying delay estimator. Delays are
+// keyed on the properties of a node which delay models are defined in terms
+// of: the op, the result type, and the type of each operand along with whether
+// it is a literal or is identical to another operand. The underlying estimator
+// must compute the delay from only these properties. Nodes which call other
+// functions (e.g., invoke or map) are passed through uncached.
+//
+// Keys do not refer to the node or its package, so one instance can be shared
+// across functions, packages and scheduling runs. Thread-safe.
+class CachingDelayEstimator : public DelayEstimator {
+ public:
+  explicit CachingDelayEstimator(const DelayEstimator& cached);
+
+  ~CachingDelayEstimator() override = default;
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
+
+  // Returns the number of queries answered from (not answered from) the cache.
+  int64_t hit_count() const;
+  int64_t miss_count() const;
+
+ private:
+  const DelayEstimator& cached_;
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<std::string, int64_t> delays_
+      ABSL_GUARDED_BY(mutex_);
+  mutable int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  mutable int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
 enum class DelayEstimatorPrecedence {
   kLow = 1,
   kMedium = 2,
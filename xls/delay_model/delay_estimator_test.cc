@@ -14,6 +14,8 @@
 
 #include "xls/delay_model/delay_estimator.h"
 
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/memory/memory.h"
@@ -126,5 +128,82 @@ TEST_F(DelayEstimatorTest, DecoratingDelayEstimator) {
               IsOkAndHolds(42));
 }
 
+TEST_F(DelayEstimatorTest, BatchedQueriesMatchSingleQueries) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  BValue sum = fb.Add(x, y);
+  BValue wide = fb.ZeroExtend(sum, 1000);
+  BValue wide_sum = fb.Add(wide, wide);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f,
+      fb.BuildWithReturnValue(fb.Concat({fb.Not(wide_sum), fb.UMul(x, y)})));
+  const DelayEstimator& estimator = GetStandardDelayEstimator();
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> delays,
+                           estimator.GetOperationDelaysInPs(nodes));
+  ASSERT_EQ(delays.size(), nodes.size());
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    EXPECT_THAT(estimator.GetOperationDelayInPs(nodes[i]),
+                IsOkAndHolds(delays[i]))
+        << nodes[i]->GetName();
+  }
+}
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimator) {
+  // An estimator whose delay is the flat bit count of the node, counting the
+  // number of times it is called.
+  class CountingDelayEstimator : public DelayEstimator {
+   public:
+    CountingDelayEstimator() : DelayEstimator("counting") {}
+    absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+      ++call_count;
+      return node->GetType()->GetFlatBitCount();
+    }
+    mutable int64_t call_count = 0;
+  };
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching(counting);
+  EXPECT_EQ(caching.name(), "counting");
+
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue z = fb.Param("z", p->GetBitsType(16));
+  BValue add0 = fb.Add(x, y);
+  BValue add1 = fb.Add(y, x);
+  BValue add_same = fb.Add(x, x);
+  BValue add_literal = fb.Add(x, fb.Literal(UBits(1, 8)));
+  BValue wide_add = fb.Add(z, z);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  EXPECT_THAT(caching.GetOperationDelayInPs(add0.node()), IsOkAndHolds(8));
+  EXPECT_THAT(caching.GetOperationDelayInPs(add1.node()), IsOkAndHolds(8));
+  EXPECT_EQ(counting.call_count, 1);
+  EXPECT_EQ(caching.hit_count(), 1);
+
+  // Identical and literal operands, and different widths are cached
+  // separately.
+  EXPECT_THAT(caching.GetOperationDelayInPs(add_same.node()), IsOkAndHolds(8));
+  EXPECT_THAT(caching.GetOperationDelayInPs(add_literal.node()),
+              IsOkAndHolds(8));
+  EXPECT_THAT(caching.GetOperationDelayInPs(wide_add.node()),
+              IsOkAndHolds(16));
+  EXPECT_EQ(counting.call_count, 4);
+  EXPECT_EQ(caching.miss_count(), 4);
+
+  // The cache is shared across packages.
+  auto p2 = CreatePackage();
+  FunctionBuilder fb2(TestName(), p2.get());
+  BValue a = fb2.Add(fb2.Param("a", p2->GetBitsType(8)),
+                     fb2.Param("b", p2->GetBitsType(8)));
+  XLS_ASSERT_OK(fb2.Build().status());
+  EXPECT_THAT(caching.GetOperationDelayInPs(a.node()), IsOkAndHolds(8));
+  EXPECT_EQ(counting.call_count, 4);
+  EXPECT_EQ(caching.hit_count(), 2);
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,8 +14,14 @@
 
 #include "xls/delay_model/delay_estimators.h"
 
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
 
 namespace xls {
 
@@ -23,6 +29,22 @@ absl::StatusOr<DelayEstimator*> GetDelayEstimator(std::string_view name) {
   return GetDelayEstimatorManagerSingleton().GetDelayEstimator(name);
 }
 
+absl::StatusOr<DelayEstimator*> GetCachingDelayEstimator(
+    std::string_view name) {
+  static absl::Mutex* mutex = new absl::Mutex;
+  static auto* caching_estimators =
+      new absl::flat_hash_map<std::string,
+                              std::unique_ptr<CachingDelayEstimator>>;
+  XLS_ASSIGN_OR_RETURN(DelayEstimator * estimator, GetDelayEstimator(name));
+  absl::MutexLock lock(mutex);
+  std::unique_ptr<CachingDelayEstimator>& caching =
+      (*caching_estimators)[name];
+  if (caching == nullptr) {
+    caching = std::make_unique<CachingDelayEstimator>(*estimator);
+  }
+  return caching.get();
+}
+
 const DelayEstimator& GetStandardDelayEstimator() {
   return *GetDelayEstimatorManagerSingleton()
               .GetDefaultDelayEstimator()
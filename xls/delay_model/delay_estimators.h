@@ -28,6 +28,13 @@ namespace xls {
 // Returns the registered delay estimator with the given name.
 absl::StatusOr<DelayEstimator*> GetDelayEstimator(std::string_view name);
 
+// Returns a CachingDelayEstimator wrapping the registered delay estimator with
+// the given name. The caching estimator is created on first use and lives for
+// the lifetime of the process so its cache is shared by every caller, e.g.,
+// across the scheduling runs of a batch codegen invocation.
+absl::StatusOr<DelayEstimator*> GetCachingDelayEstimator(
+    std::string_view name);
+
 // Returns a reference to a singleton object which uses the "standard" delay
 // estimation model.
 // TODO(meheff): Remove this function and require users to specify the estimator
@@ -23,7 +23,7 @@ well as provide delay estimates in Python.
 import abc
 import random
 
-from typing import Sequence, Text, Tuple, Callable
+from typing import List, Optional, Sequence, Text, Tuple, Callable
 import warnings
 
 import numpy as np
@@ -201,6 +201,18 @@ def _operation_delay_expression(expression: delay_model_pb2.DelayExpression,
   return expression.constant
 
 
+def _delay_expression_factors(
+    expression: delay_model_pb2.DelayExpression
+) -> List[delay_model_pb2.DelayFactor]:
+  """Returns the delay factors occurring in a delay expression."""
+  if expression.HasField('bin_op'):
+    return (_delay_expression_factors(expression.lhs_expression) +
+            _delay_expression_factors(expression.rhs_expression))
+  if expression.HasField('factor'):
+    return [expression.factor]
+  return []
+
+
 def _delay_factor_cpp_expression(factor: delay_model_pb2.DelayFactor,
                                  node_identifier: Text) -> Text:
   """Returns a C++ expression which computes a delay factor of an XLS Node*.
@@ -235,13 +247,18 @@ def _delay_factor_cpp_expression(factor: delay_model_pb2.DelayFactor,
 
 
 def _delay_expression_cpp_expression(
-    expression: delay_model_pb2.DelayExpression, node_identifier: Text) -> Text:
+    expression: delay_model_pb2.DelayExpression,
+    node_identifier: Text,
+    factor_identifier: Optional[Text] = None) -> Text:
   """Returns a C++ expression which computes a delay expression of an XLS Node*.
 
   Args:
     expression: The delay expression to extract.
     node_identifier: The identifier of the xls::Node* to extract the factor
       from.
+    factor_identifier: If given, the identifier of the value of the (single)
+      factor of the expression, which is used instead of extracting the factor
+      from the node.
 
   Returns:
     C++ expression computing the delay expression of a node.
@@ -250,9 +267,11 @@ def _delay_expression_cpp_expression(
     assert expression.HasField('lhs_expression')
     assert expression.HasField('rhs_expression')
     lhs_value = _delay_expression_cpp_expression(expression.lhs_expression,
-                                                 node_identifier)
+                                                 node_identifier,
+                                                 factor_identifier)
     rhs_value = _delay_expression_cpp_expression(expression.rhs_expression,
-                                                 node_identifier)
+                                                 node_identifier,
+                                                 factor_identifier)
     e = delay_model_pb2.DelayExpression.BinaryOperation
     return {
         e.ADD: lambda: '({} + {})'.format(lhs_value, rhs_value),
@@ -265,6 +284,8 @@ def _delay_expression_cpp_expression(
     }[expression.bin_op]()
 
   if expression.HasField('factor'):
+    if factor_identifier is not None:
+      return 'static_cast<float>({})'.format(factor_identifier)
     return 'static_cast<float>({})'.format(
         _delay_factor_cpp_expression(expression.factor, node_identifier))
 
@@ -467,13 +488,46 @@ class RegressionEstimator(Estimator):
     """Returns the delay with delay expressions passed in as floats."""
     return self.delay_function(xargs)
 
-  def cpp_delay_code(self, node_identifier: Text) -> Text:
+  def table_factor(self) -> Optional[delay_model_pb2.DelayFactor]:
+    """Returns the bit count factor which is the only input of the delay.
+
+    The delay of such an estimator is a function of a single bit count and can
+    be precomputed in a table indexed by bit count.
+
+    Returns:
+      The factor, or None if the delay depends on other factors (or on none).
+    """
+    factors = []
+    for expression in self.delay_expressions:
+      factors.extend(_delay_expression_factors(expression))
+    if not factors or any(f != factors[0] for f in factors):
+      return None
+    e = delay_model_pb2.DelayFactor.Source
+    if factors[0].source not in (e.RESULT_BIT_COUNT, e.OPERAND_BIT_COUNT):
+      return None
+    return factors[0]
+
+  def cpp_delay_expression(self,
+                           node_identifier: Text,
+                           factor_identifier: Optional[Text] = None) -> Text:
+    """Returns a C++ expression which computes the delay.
+
+    Args:
+      node_identifier: The string identifier of the Node* value whose delay is
+        being estimated.
+      factor_identifier: If given, the identifier of the value of the
+        table_factor() to use instead of extracting it from the node.
+    """
     terms = [str(self.params[0])]
     for i, expression in enumerate(self.delay_expressions):
-      e_str = _delay_expression_cpp_expression(expression, node_identifier)
+      e_str = _delay_expression_cpp_expression(expression, node_identifier,
+                                               factor_identifier)
       terms.append('{} * {}'.format(self.params[2 * i + 1], e_str))
       terms.append('{} * std::log2({})'.format(self.params[2 * i + 2], e_str))
-    return 'return std::round({});'.format(' + '.join(terms))
+    return 'std::round({})'.format(' + '.join(terms))
+
+  def cpp_delay_code(self, node_identifier: Text) -> Text:
+    return 'return {};'.format(self.cpp_delay_expression(node_identifier))
 
 
 class BoundingBoxEstimator(Estimator):
@@ -622,10 +676,56 @@ class OpModel:
       lines.append('if (%s) {' % cond)
       lines.append(estimator.cpp_delay_code('node'))
       lines.append('}')
+    table_factor = self._table_factor()
+    if table_factor is not None:
+      lines.append('int64_t table_bit_count = %s;' %
+                   _delay_factor_cpp_expression(table_factor, 'node'))
+      lines.append(
+          'if (table_bit_count > 0 && table_bit_count < kDelayTableSize) {')
+      lines.append('return %s()[table_bit_count];' %
+                   self.cpp_delay_table_function_name())
+      lines.append('}')
     lines.append(self.estimator.cpp_delay_code('node'))
     lines.append('}')
     return '\n'.join(lines)
 
+  def _table_factor(self) -> Optional[delay_model_pb2.DelayFactor]:
+    if isinstance(self.estimator, RegressionEstimator):
+      return self.estimator.table_factor()
+    return None
+
+  def has_delay_table(self) -> bool:
+    """Returns whether the op's delay is looked up in a precomputed table.
+
+    The (non-specialized) delay of such an op is a function of a single bit
+    count. Evaluating the regression for each query is comparatively slow, so
+    the delays are computed once for the bit counts below kDelayTableSize.
+    """
+    return self._table_factor() is not None
+
+  def cpp_delay_table_function(self) -> Text:
+    """Returns a C++ function which returns the delay table of the op."""
+    assert self.has_delay_table()
+    lines = []
+    lines.append('const std::array<int64_t, kDelayTableSize>& %s() {' %
+                 self.cpp_delay_table_function_name())
+    lines.append('static const std::array<int64_t, kDelayTableSize> table = '
+                 '[] {')
+    lines.append('std::array<int64_t, kDelayTableSize> table = {};')
+    lines.append('for (int64_t bit_count = 1; bit_count < kDelayTableSize; '
+                 '++bit_count) {')
+    lines.append('table[bit_count] = %s;' %
+                 self.estimator.cpp_delay_expression('node', 'bit_count'))
+    lines.append('}')
+    lines.append('return table;')
+    lines.append('}();')
+    lines.append('return table;')
+    lines.append('}')
+    return '\n'.join(lines)
+
+  def cpp_delay_table_function_name(self) -> Text:
+    return self.op.lstrip('k') + 'DelayTable'
+
   def cpp_delay_function_name(self) -> Text:
     return self.op.lstrip('k') + 'Delay'
 
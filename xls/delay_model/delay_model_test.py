@@ -173,6 +173,7 @@ class DelayModelTest(absltest.TestCase):
               0.0 + 0.0 * static_cast<float>(node->GetType()->GetFlatBitCount()) +
               0.0 * std::log2(static_cast<float>(node->GetType()->GetFlatBitCount())));
         """)
+    self.assertEqual(foo.table_factor(), result_bit_count.factor)
 
   def test_one_regression_estimator_operand_count(self):
 
@@ -204,6 +205,7 @@ class DelayModelTest(absltest.TestCase):
               0.0 + 0.0 * static_cast<float>(node->operand_count()) +
               0.0 * std::log2(static_cast<float>(node->operand_count())));
         """)
+    self.assertIsNone(foo.table_factor())
 
   def test_two_factor_regression_estimator(self):
 
@@ -247,6 +249,7 @@ class DelayModelTest(absltest.TestCase):
               0.0 * static_cast<float>(node->operand(1)->GetType()->GetFlatBitCount()) +
               0.0 * std::log2(static_cast<float>(node->operand(1)->GetType()->GetFlatBitCount())));
         """)
+    self.assertIsNone(foo.table_factor())
 
   def test_fixed_op_model(self):
     op_model = delay_model.OpModel(
@@ -261,6 +264,7 @@ class DelayModelTest(absltest.TestCase):
         """absl::StatusOr<int64_t> FooDelay(Node* node) {
              return 42;
            }""")
+    self.assertFalse(op_model.has_delay_table())
 
   def test_fixed_op_model_with_specialization(self):
     op_model = delay_model.OpModel(
@@ -792,11 +796,32 @@ class DelayModelTest(absltest.TestCase):
                 "Unhandled node for delay estimation: " +
                 node->ToStringWithOperandTypes());
             }
+            int64_t table_bit_count = node->GetType()->GetFlatBitCount();
+            if (table_bit_count > 0 && table_bit_count < kDelayTableSize) {
+              return FooDelayTable()[table_bit_count];
+            }
             return std::round(
                 0.0 + 0.0 * static_cast<float>(node->GetType()->GetFlatBitCount()) +
                 0.0 * std::log2(static_cast<float>(node->GetType()->GetFlatBitCount())));
           }
         """)
+    self.assertTrue(op_model.has_delay_table())
+    self.assertEqualIgnoringWhitespaceAndFloats(
+        op_model.cpp_delay_table_function(), """
+          const std::array<int64_t, kDelayTableSize>& FooDelayTable() {
+            static const std::array<int64_t, kDelayTableSize> table = [] {
+              std::array<int64_t, kDelayTableSize> table = {};
+              for (int64_t bit_count = 1; bit_count < kDelayTableSize;
+                   ++bit_count) {
+                table[bit_count] = std::round(
+                    0.0 + 0.0 * static_cast<float>(bit_count) +
+                    0.0 * std::log2(static_cast<float>(bit_count)));
+              }
+              return table;
+            }();
+            return table;
+          }
+        """)
 
   def test_regression_estimator_generate_validation_sets(self):
     raw_data_points = [(0, 0), (1, 1), (2, 2), (3, 3), (4, 4), (5, 5)]
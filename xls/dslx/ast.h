@@ -23,6 +23,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/casts.h"
@@ -2855,6 +2856,7 @@ class Module : public AstNode {
   }
 
   BuiltinNameDef* GetOrCreateBuiltinNameDef(std::string_view name) {
+    absl::MutexLock lock(&builtin_name_defs_mutex_);
     auto it = builtin_name_defs_.find(name);
     if (it == builtin_name_defs_.end()) {
       BuiltinNameDef* bnd = MakeInternal<BuiltinNameDef>(std::string(name));
@@ -2960,7 +2962,22 @@ class Module : public AstNode {
 
   const std::string& name() const { return name_; }
 
+  // Returns the nodes owned by this module in the order they were created.
+  // Parsing is deterministic, so the nodes created by parsing the same text
+  // always appear at the same positions (nodes synthesized later, e.g. during
+  // type inference, are appended).
+  std::vector<AstNode*> GetNodes() const {
+    absl::MutexLock lock(&nodes_mutex_);
+    std::vector<AstNode*> result;
+    result.reserve(nodes_.size());
+    for (const auto& node : nodes_) {
+      result.push_back(node.get());
+    }
+    return result;
+  }
+
   const AstNode* FindNode(AstNodeKind kind, const Span& span) const {
+    absl::MutexLock lock(&nodes_mutex_);
     for (const auto& node : nodes_) {
       if (node->kind() == kind && node->GetSpan().has_value() &&
           node->GetSpan().value() == span) {
@@ -2976,6 +2993,7 @@ class Module : public AstNode {
     std::unique_ptr<T> node =
         std::make_unique<T>(this, std::forward<Args>(args)...);
     T* ptr = node.get();
+    absl::MutexLock lock(&nodes_mutex_);
     ptr->SetParentage();
     nodes_.push_back(std::move(node));
     return ptr;
@@ -3011,6 +3029,11 @@ class Module : public AstNode {
   std::vector<ModuleMember> top_;  // Top-level members of this module.
   std::vector<std::unique_ptr<AstNode>> nodes_;  // Lifetime-owned AST nodes.
 
+  // Type inference may synthesize nodes in an imported module (e.g. for
+  // `map`), and importers may be typechecked concurrently. The mutex also
+  // covers the parent links set on the operands of new nodes.
+  mutable absl::Mutex nodes_mutex_;
+
   // Map of top-level module member name to the member itself.
   absl::flat_hash_map<std::string, ModuleMember> top_by_name_;
 
@@ -3018,6 +3041,7 @@ class Module : public AstNode {
   // for any particular purpose at this time aside from cleanliness of not
   // having many definition nodes of the same builtin thing floating around.
   absl::flat_hash_map<std::string, BuiltinNameDef*> builtin_name_defs_;
+  absl::Mutex builtin_name_defs_mutex_;
 };
 
 // Helper for determining whether an AST node is constant (e.g. can be
@@ -64,6 +64,9 @@ absl::StatusOr<Bytecode::Op> OpFromString(std::string_view s) {
   if (s == "fail") {
     return Bytecode::Op::kFail;
   }
+  if (s == "fused_binop") {
+    return Bytecode::Op::kFusedBinop;
+  }
   if (s == "ge") {
     return Bytecode::Op::kGe;
   }
@@ -195,6 +198,8 @@ std::string OpToString(Bytecode::Op op) {
       return "eq";
     case Bytecode::Op::kFail:
       return "fail";
+    case Bytecode::Op::kFusedBinop:
+      return "fused_binop";
     case Bytecode::Op::kGe:
       return "ge";
     case Bytecode::Op::kGt:
@@ -370,6 +375,29 @@ std::string Bytecode::MatchArmItem::ToString() const {
   return "<invalid MatchArmItem>";
 }
 
+std::string Bytecode::FusedBinopData::ToString() const {
+  struct OperandVisitor {
+    std::string operator()(const std::monostate&) { return "stack"; }
+    std::string operator()(const SlotIndex& v) {
+      return absl::StrCat("load:", v.value());
+    }
+    std::string operator()(const InterpValue& v) {
+      return absl::StrCat("value:", v.ToString());
+    }
+  };
+
+  std::string result =
+      absl::StrFormat("%s(%s, %s)", OpToString(op),
+                      std::visit(OperandVisitor(), lhs),
+                      std::visit(OperandVisitor(), rhs));
+  if (store_slot.has_value()) {
+    absl::StrAppend(&result, " store:", store_slot->value());
+  } else if (jump_target.has_value()) {
+    absl::StrAppendFormat(&result, " jump_rel_if %+d", jump_target->value());
+  }
+  return result;
+}
+
 #define DEF_UNARY_BUILDER(OP_NAME)                           \
   /* static */ Bytecode Bytecode::Make##OP_NAME(Span span) { \
     return Bytecode(span, Op::k##OP_NAME);                   \
@@ -483,6 +511,17 @@ absl::StatusOr<Bytecode::SlotIndex> Bytecode::slot_index() const {
   return std::get<SlotIndex>(data_.value());
 }
 
+absl::StatusOr<const Bytecode::FusedBinopData*> Bytecode::fused_binop_data()
+    const {
+  if (!data_.has_value()) {
+    return absl::InvalidArgumentError("Bytecode does not hold data.");
+  }
+  if (!std::holds_alternative<FusedBinopData>(data_.value())) {
+    return absl::InvalidArgumentError("Bytecode data is not FusedBinopData.");
+  }
+  return &std::get<FusedBinopData>(data_.value());
+}
+
 absl::StatusOr<Bytecode::InvocationData> Bytecode::invocation_data() const {
   if (!data_.has_value()) {
     return absl::InvalidArgumentError("Bytecode does not hold data.");
@@ -599,6 +638,8 @@ std::string Bytecode::ToString(bool source_locs) const {
 
       std::string operator()(const MatchArmItem& v) { return v.ToString(); }
 
+      std::string operator()(const FusedBinopData& v) { return v.ToString(); }
+
       std::string operator()(const SpawnData& spawn_data) {
         return spawn_data.spawn->ToString();
       }
@@ -702,6 +743,18 @@ absl::Status BytecodeFunction::Init() {
     if (bc.op() == Bytecode::Op::kLoad || bc.op() == Bytecode::Op::kStore) {
       XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, bc.slot_index());
       num_slots_ = std::max(num_slots_, slot.value() + 1);
+    } else if (bc.op() == Bytecode::Op::kFusedBinop) {
+      XLS_ASSIGN_OR_RETURN(const Bytecode::FusedBinopData* data,
+                           bc.fused_binop_data());
+      for (const auto* operand : {&data->lhs, &data->rhs}) {
+        if (std::holds_alternative<Bytecode::SlotIndex>(*operand)) {
+          num_slots_ = std::max(
+              num_slots_, std::get<Bytecode::SlotIndex>(*operand).value() + 1);
+        }
+      }
+      if (data->store_slot.has_value()) {
+        num_slots_ = std::max(num_slots_, data->store_slot->value() + 1);
+      }
     }
   }
   return absl::OkStatus();
@@ -720,6 +773,11 @@ std::vector<Bytecode> BytecodeFunction::CloneBytecodes() const {
         bytecodes.emplace_back(
             Bytecode(bc.source_span(), bc.op(),
                      std::get<InterpValue>(bc.data().value())));
+      } else if (std::holds_alternative<Bytecode::FusedBinopData>(
+                     bc.data().value())) {
+        bytecodes.emplace_back(
+            Bytecode(bc.source_span(), bc.op(),
+                     std::get<Bytecode::FusedBinopData>(bc.data().value())));
       } else {
         const std::unique_ptr<ConcreteType>& type =
             std::get<std::unique_ptr<ConcreteType>>(bc.data().value());
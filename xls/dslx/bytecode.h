@@ -15,7 +15,9 @@
 #define XLS_DSLX_BYTECODE_H_
 
 #include <memory>
+#include <optional>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -73,6 +75,12 @@ class Bytecode {
     // Terminates the current program with a failure status. Consumes as many
     // values from the stack as are specified in the `TraceData` data member.
     kFail,
+    // Superinstruction emitted in place of a run of operand loads, a binary op,
+    // and an optional store or conditional jump. Applies the op given in the
+    // `FusedBinopData` data member to its operands, then stores the result to
+    // a slot, jumps (relative) if the result is true, or pushes the result
+    // onto the stack.
+    kFusedBinop,
     // Compares TOS1 to TOS0, storing true if TOS1 >= TOS0.
     kGe,
     // Compares TOS1 to TOS0, storing true if TOS1 > TOS0.
@@ -249,10 +257,30 @@ class Bytecode {
     std::optional<SymbolicBindings> caller_bindings;
   };
 
+  // Data for a kFusedBinop: the binary op to apply, where its operands come
+  // from, and where its result goes.
+  struct FusedBinopData {
+    // An operand is either popped from the stack (monostate), loaded from a
+    // slot, or a literal.
+    using Operand = std::variant<std::monostate, SlotIndex, InterpValue>;
+
+    Op op;
+    Operand lhs;
+    Operand rhs;
+
+    // At most one of these is set. If neither is, the result is pushed onto
+    // the stack.
+    std::optional<SlotIndex> store_slot;
+    std::optional<JumpTarget> jump_target;
+
+    std::string ToString() const;
+  };
+
   using TraceData = std::vector<FormatStep>;
   using Data = std::variant<InterpValue, JumpTarget, NumElements, SlotIndex,
                             std::unique_ptr<ConcreteType>, InvocationData,
-                            MatchArmItem, SpawnData, TraceData>;
+                            MatchArmItem, SpawnData, TraceData,
+                            FusedBinopData>;
 
   static Bytecode MakeCreateTuple(Span span, NumElements elements);
   static Bytecode MakeDup(Span span);
@@ -293,6 +321,7 @@ class Bytecode {
 
   bool has_data() const { return data_.has_value(); }
 
+  absl::StatusOr<const FusedBinopData*> fused_binop_data() const;
   absl::StatusOr<InvocationData> invocation_data() const;
   absl::StatusOr<JumpTarget> jump_target() const;
   absl::StatusOr<const MatchArmItem*> match_arm_item() const;
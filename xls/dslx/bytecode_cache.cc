@@ -13,25 +13,202 @@
 // limitations under the License.
 #include "xls/dslx/bytecode_cache.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode_cache.pb.h"
 #include "xls/dslx/bytecode_emitter.h"
+#include "xls/dslx/bytecode_to_proto.h"
+#include "xls/dslx/type_info_cache.h"
 
 namespace xls::dslx {
+namespace {
+
+// Bumped whenever the meaning of cache entries changes.
+constexpr int64_t kFormatVersion = 1;
+
+std::string Sha256Hex(std::string_view data) {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest), SHA256_DIGEST_LENGTH));
+}
+
+}  // namespace
 
 BytecodeCache::BytecodeCache(ImportData* import_data)
     : import_data_(import_data) {}
 
+/* static */ absl::StatusOr<std::unique_ptr<BytecodeCache>>
+BytecodeCache::Create(ImportData* import_data,
+                      const std::filesystem::path& directory,
+                      std::optional<std::string> compiler_version) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  if (!compiler_version.has_value()) {
+    XLS_ASSIGN_OR_RETURN(compiler_version,
+                         TypeInfoCache::GetDefaultCompilerVersion());
+  }
+  auto cache = std::make_unique<BytecodeCache>(import_data);
+  cache->directory_ = directory;
+  cache->compiler_version_ = std::move(compiler_version).value();
+  return cache;
+}
+
 absl::StatusOr<BytecodeFunction*> BytecodeCache::GetOrCreateBytecodeFunction(
     const Function* f, const TypeInfo* type_info,
     const std::optional<SymbolicBindings>& caller_bindings) {
   Key key = std::make_tuple(f, type_info, caller_bindings);
-  if (!cache_.contains(key)) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<BytecodeFunction> bf,
-        BytecodeEmitter::Emit(import_data_, type_info, f, caller_bindings));
-    cache_.emplace(key, std::move(bf));
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      return it->second.get();
+    }
   }
 
-  return cache_.at(key).get();
+  // Emit without holding the lock; if another thread emitted the same function
+  // in the meantime its result is kept.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
+                       RestoreOrEmit(f, type_info, caller_bindings));
+  absl::MutexLock lock(&mutex_);
+  return cache_.emplace(key, std::move(bf)).first->second.get();
+}
+
+absl::StatusOr<std::string> BytecodeCache::GetModuleDigest(
+    const Module* module) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = module_digests_.find(module);
+    if (it != module_digests_.end()) {
+      return it->second;
+    }
+  }
+  auto compute = [&]() -> absl::StatusOr<std::string> {
+    for (const AstNode* node : module->GetNodes()) {
+      if (std::optional<Span> span = node->GetSpan()) {
+        XLS_ASSIGN_OR_RETURN(std::string contents,
+                             GetFileContents(span->filename()));
+        return Sha256Hex(contents);
+      }
+    }
+    return absl::NotFoundError(
+        absl::StrFormat("Module %s has no source location", module->name()));
+  };
+  absl::StatusOr<std::string> digest = compute();
+  absl::MutexLock lock(&mutex_);
+  return module_digests_.emplace(module, std::move(digest)).first->second;
+}
+
+absl::StatusOr<std::filesystem::path> BytecodeCache::GetEntryPath(
+    const Function* f,
+    const std::optional<SymbolicBindings>& caller_bindings) {
+  // Collect the function's module and everything it imports, since e.g.
+  // imported constants are folded into the bytecode.
+  std::vector<const Module*> modules = {f->owner()};
+  absl::flat_hash_set<const Module*> seen = {f->owner()};
+  for (int64_t i = 0; i < modules.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(TypeInfo * root,
+                         import_data_->GetRootTypeInfo(modules[i]));
+    for (const auto& [import, info] : root->imports()) {
+      if (seen.insert(info.module).second) {
+        modules.push_back(info.module);
+      }
+    }
+  }
+
+  std::vector<std::string> digests;
+  for (const Module* module : modules) {
+    XLS_ASSIGN_OR_RETURN(std::string digest, GetModuleDigest(module));
+    digests.push_back(absl::StrCat(module->name(), ":", digest));
+  }
+  // The function's module stays first; the order of the imports depends on
+  // hash map iteration.
+  std::sort(digests.begin() + 1, digests.end());
+
+  std::string key = absl::StrFormat(
+      "format: %d\ncompiler: %s\nfunction: %s @ %s\nbindings: %s\n",
+      kFormatVersion, compiler_version_, f->identifier(),
+      f->span().ToString(),
+      caller_bindings.has_value() ? caller_bindings->ToString() : "none");
+  for (const std::string& digest : digests) {
+    absl::StrAppend(&key, "module: ", digest, "\n");
+  }
+  return directory_.value() / absl::StrCat(Sha256Hex(key), ".pb");
+}
+
+absl::StatusOr<std::unique_ptr<BytecodeFunction>> BytecodeCache::RestoreOrEmit(
+    const Function* f, const TypeInfo* type_info,
+    const std::optional<SymbolicBindings>& caller_bindings) {
+  auto emit = [&]() {
+    return BytecodeEmitter::Emit(
+        import_data_, type_info, f, caller_bindings,
+        BytecodeEmitterOptions{.fuse_superinstructions = true});
+  };
+  if (!directory_.has_value()) {
+    return emit();
+  }
+
+  absl::StatusOr<std::filesystem::path> entry_path =
+      GetEntryPath(f, caller_bindings);
+  if (!entry_path.ok()) {
+    XLS_VLOG(2) << absl::StreamFormat("Not caching bytecode for %s: %s",
+                                      f->identifier(),
+                                      entry_path.status().ToString());
+    return emit();
+  }
+
+  if (FileExists(entry_path.value()).ok()) {
+    BytecodeFunctionProto proto;
+    absl::Status status = ParseProtobinFile(entry_path.value(), &proto);
+    absl::StatusOr<std::vector<Bytecode>> bytecodes =
+        status.ok() ? BytecodesFromProto(proto, *import_data_)
+                    : absl::StatusOr<std::vector<Bytecode>>(status);
+    absl::StatusOr<std::unique_ptr<BytecodeFunction>> bf =
+        bytecodes.ok() ? BytecodeFunction::Create(f->owner(), f, type_info,
+                                                  std::move(bytecodes).value())
+                       : bytecodes.status();
+    if (bf.ok()) {
+      XLS_VLOG(2) << "Restored bytecode from cache: " << entry_path.value();
+      absl::MutexLock lock(&mutex_);
+      ++disk_hit_count_;
+      return bf;
+    }
+    XLS_LOG(WARNING) << absl::StreamFormat(
+        "Ignoring invalid bytecode cache file %s: %s",
+        entry_path.value().string(), bf.status().ToString());
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    ++disk_miss_count_;
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf, emit());
+  absl::StatusOr<BytecodeFunctionProto> proto =
+      BytecodeFunctionToProto(*bf, *import_data_);
+  if (!proto.ok()) {
+    XLS_VLOG(1) << absl::StreamFormat("Not caching bytecode for %s: %s",
+                                      f->identifier(),
+                                      proto.status().ToString());
+    return bf;
+  }
+
+  absl::Status status =
+      SetProtobinFileAtomically(entry_path.value(), proto.value());
+  if (!status.ok()) {
+    XLS_LOG(WARNING) << absl::StreamFormat(
+        "Unable to write bytecode cache file %s: %s",
+        entry_path.value().string(), status.ToString());
+  }
+  return bf;
 }
 
 }  // namespace xls::dslx
@@ -14,9 +14,13 @@
 #ifndef XLS_DSLX_BYTECODE_CACHE_H_
 #define XLS_DSLX_BYTECODE_CACHE_H_
 
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/ast.h"
 #include "xls/dslx/bytecode.h"
 #include "xls/dslx/bytecode_cache_interface.h"
@@ -25,19 +29,75 @@
 
 namespace xls::dslx {
 
+// Thread-safe: modules may be typechecked (and constexprs evaluated)
+// concurrently against the same ImportData.
+//
+// A cache created with a directory (see Create()) also persists emitted
+// bytecode there, so that later processes need not re-emit e.g. the standard
+// library. Entries are keyed by the function, its parametric bindings, a
+// compiler version and digests of the text of the function's module and of the
+// modules it imports (transitively). Functions whose bytecode has no serialized
+// form (see bytecode_to_proto.h), or whose modules cannot be read from the
+// paths they were parsed from, are only cached in memory. As with the type
+// information cache, failures to read or write entries are treated as misses.
 class BytecodeCache : public BytecodeCacheInterface {
  public:
   BytecodeCache(ImportData* import_data);
+
+  // Creates a cache which persists entries in `directory`, created if it does
+  // not exist. Entries are only shared by caches created with the same
+  // `compiler_version`, which defaults to one identifying the running binary
+  // (see TypeInfoCache::GetDefaultCompilerVersion()).
+  static absl::StatusOr<std::unique_ptr<BytecodeCache>> Create(
+      ImportData* import_data, const std::filesystem::path& directory,
+      std::optional<std::string> compiler_version = absl::nullopt);
+
   absl::StatusOr<BytecodeFunction*> GetOrCreateBytecodeFunction(
       const Function* f, const TypeInfo* type_info,
       const std::optional<SymbolicBindings>& caller_bindings) override;
 
+  // Number of functions which were restored from and missed the on-disk cache
+  // respectively; both are zero for a cache without a directory.
+  int64_t disk_hit_count() const {
+    absl::MutexLock lock(&mutex_);
+    return disk_hit_count_;
+  }
+  int64_t disk_miss_count() const {
+    absl::MutexLock lock(&mutex_);
+    return disk_miss_count_;
+  }
+
  private:
   using Key = std::tuple<const Function*, const TypeInfo*,
                          std::optional<SymbolicBindings>>;
 
+  // Returns the path of the on-disk entry for the given function, or an error
+  // if it cannot be persisted.
+  absl::StatusOr<std::filesystem::path> GetEntryPath(
+      const Function* f,
+      const std::optional<SymbolicBindings>& caller_bindings);
+
+  // Returns the SHA-256 digest of the text of the given module, read from the
+  // path it was parsed from.
+  absl::StatusOr<std::string> GetModuleDigest(const Module* module);
+
+  // Restores or emits the bytecode for the given function, writing it to the
+  // on-disk cache if it was emitted.
+  absl::StatusOr<std::unique_ptr<BytecodeFunction>> RestoreOrEmit(
+      const Function* f, const TypeInfo* type_info,
+      const std::optional<SymbolicBindings>& caller_bindings);
+
   ImportData* import_data_;
-  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_;
+  std::optional<std::filesystem::path> directory_;
+  std::string compiler_version_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<const Module*, absl::StatusOr<std::string>>
+      module_digests_ ABSL_GUARDED_BY(mutex_);
+  int64_t disk_hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t disk_miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
 };
 
 }  // namespace xls::dslx
@@ -0,0 +1,144 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "xls/dslx/bytecode_cache.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/bytecode_interpreter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+
+namespace xls::dslx {
+namespace {
+
+constexpr std::string_view kProgram = R"(
+import std
+
+enum Choice : u2 {
+  ZERO = 0,
+  ONE = 1,
+}
+
+fn add_n<N: u32>(x: u32) -> u32 { x + N }
+
+fn pick(c: Choice) -> u32 {
+  match c {
+    Choice::ZERO => u32:0,
+    _ => u32:1,
+  }
+}
+
+fn main(x: u32) -> u32 {
+  let y = add_n<u32:3>(x) + add_n<u32:4>(x);
+  std::umax(y, pick(Choice::ONE))
+}
+)";
+
+class BytecodeCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+    temp_dir_ = std::move(temp_dir);
+    // The module is read back from its path to key the cache entries.
+    module_path_ = temp_dir_->path() / "test_module.x";
+    XLS_ASSERT_OK(SetFileContents(module_path_, kProgram));
+  }
+
+  struct Result {
+    InterpValue value;
+    std::string bytecode;
+    int64_t hit_count;
+    int64_t miss_count;
+  };
+
+  // Runs `main` from the program against a fresh import data which uses a
+  // cache in the temporary directory.
+  absl::StatusOr<Result> Run() {
+    ImportData import_data = CreateImportDataForTest();
+    XLS_ASSIGN_OR_RETURN(
+        TypecheckedModule tm,
+        ParseAndTypecheck(kProgram, module_path_.string(), "test_module",
+                          &import_data));
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<BytecodeCache> cache,
+        BytecodeCache::Create(&import_data, temp_dir_->path() / "cache",
+                              "test"));
+    BytecodeCache* cache_ptr = cache.get();
+    import_data.SetBytecodeCache(std::move(cache));
+    XLS_ASSIGN_OR_RETURN(Function * f,
+                         tm.module->GetMemberOrError<Function>("main"));
+    XLS_ASSIGN_OR_RETURN(BytecodeFunction * bf,
+                         cache_ptr->GetOrCreateBytecodeFunction(
+                             f, tm.type_info, absl::nullopt));
+    XLS_ASSIGN_OR_RETURN(
+        InterpValue value,
+        BytecodeInterpreter::Interpret(&import_data, bf,
+                                       {InterpValue::MakeU32(1)}));
+    return Result{value, bf->ToString(), cache_ptr->disk_hit_count(),
+                  cache_ptr->disk_miss_count()};
+  }
+
+  std::optional<TempDirectory> temp_dir_;
+  std::filesystem::path module_path_;
+};
+
+TEST_F(BytecodeCacheTest, SecondRunRestoresBytecode) {
+  XLS_ASSERT_OK_AND_ASSIGN(Result first, Run());
+  EXPECT_EQ(first.value, InterpValue::MakeU32(9));
+  EXPECT_EQ(first.hit_count, 0);
+  EXPECT_GT(first.miss_count, 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Result second, Run());
+  EXPECT_EQ(second.value, first.value);
+  EXPECT_EQ(second.bytecode, first.bytecode);
+  EXPECT_EQ(second.hit_count, first.miss_count);
+  EXPECT_EQ(second.miss_count, 0);
+}
+
+TEST_F(BytecodeCacheTest, ChangedModuleMisses) {
+  XLS_ASSERT_OK_AND_ASSIGN(Result first, Run());
+
+  XLS_ASSERT_OK(
+      SetFileContents(module_path_, absl::StrCat(kProgram, "\n// edit\n")));
+  XLS_ASSERT_OK_AND_ASSIGN(Result second, Run());
+  EXPECT_EQ(second.value, first.value);
+  // Functions of the (unchanged) standard library are still restored.
+  EXPECT_LT(second.hit_count, first.miss_count);
+  EXPECT_GT(second.miss_count, 0);
+}
+
+TEST_F(BytecodeCacheTest, CorruptEntriesAreIgnored) {
+  XLS_ASSERT_OK_AND_ASSIGN(Result first, Run());
+  for (const auto& entry :
+       std::filesystem::directory_iterator(temp_dir_->path() / "cache")) {
+    XLS_ASSERT_OK(SetFileContents(entry.path(), "not a proto"));
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(Result second, Run());
+  EXPECT_EQ(second.value, first.value);
+  EXPECT_EQ(second.hit_count, 0);
+  EXPECT_EQ(second.bytecode, first.bytecode);
+}
+
+}  // namespace
+}  // namespace xls::dslx
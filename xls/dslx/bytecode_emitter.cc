@@ -17,6 +17,7 @@
 #include "absl/cleanup/cleanup.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -32,6 +33,147 @@
 // on the stack (I believe that should be the case for any valid program).
 
 namespace xls::dslx {
+namespace {
+
+bool IsFusibleBinop(Bytecode::Op op) {
+  switch (op) {
+    case Bytecode::Op::kAdd:
+    case Bytecode::Op::kAnd:
+    case Bytecode::Op::kConcat:
+    case Bytecode::Op::kDiv:
+    case Bytecode::Op::kEq:
+    case Bytecode::Op::kGe:
+    case Bytecode::Op::kGt:
+    case Bytecode::Op::kLe:
+    case Bytecode::Op::kLt:
+    case Bytecode::Op::kMul:
+    case Bytecode::Op::kNe:
+    case Bytecode::Op::kOr:
+    case Bytecode::Op::kShl:
+    case Bytecode::Op::kShr:
+    case Bytecode::Op::kSub:
+    case Bytecode::Op::kXor:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsFusibleOperand(const Bytecode& bytecode) {
+  return bytecode.op() == Bytecode::Op::kLoad ||
+         bytecode.op() == Bytecode::Op::kLiteral;
+}
+
+// Returns the number of bytecodes starting at `start` which can be collapsed
+// into a single kFusedBinop, or 1 if there is no such run: up to two operand
+// loads/literals, a binary op, and optionally a store or conditional jump
+// consuming its result. Jump destinations are never part of a run, so every
+// jump still lands on an instruction which exists after fusion.
+int64_t GetFusibleRunLength(absl::Span<const Bytecode> bytecodes,
+                            int64_t start) {
+  int64_t binop = start;
+  while (binop < bytecodes.size() && binop - start < 2 &&
+         IsFusibleOperand(bytecodes[binop])) {
+    ++binop;
+  }
+  if (binop >= bytecodes.size() || !IsFusibleBinop(bytecodes[binop].op())) {
+    return 1;
+  }
+  int64_t end = binop + 1;
+  if (end < bytecodes.size() &&
+      (bytecodes[end].op() == Bytecode::Op::kStore ||
+       bytecodes[end].op() == Bytecode::Op::kJumpRelIf)) {
+    ++end;
+  }
+  return end - start;
+}
+
+absl::StatusOr<Bytecode::FusedBinopData::Operand> GetFusedOperand(
+    const Bytecode& bytecode) {
+  if (bytecode.op() == Bytecode::Op::kLoad) {
+    XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, bytecode.slot_index());
+    return Bytecode::FusedBinopData::Operand(slot);
+  }
+  XLS_ASSIGN_OR_RETURN(InterpValue value, bytecode.value_data());
+  return Bytecode::FusedBinopData::Operand(std::move(value));
+}
+
+// Peephole pass which replaces runs found by GetFusibleRunLength() with
+// kFusedBinop superinstructions and retargets all relative jumps to account
+// for the removed bytecodes.
+absl::StatusOr<std::vector<Bytecode>> FuseSuperinstructions(
+    std::vector<Bytecode> bytecodes) {
+  // First find the runs and the post-fusion index of every bytecode; a run's
+  // bytecodes all map to the index of their superinstruction.
+  std::vector<int64_t> run_lengths(bytecodes.size(), 1);
+  std::vector<int64_t> new_indices(bytecodes.size() + 1);
+  int64_t new_size = 0;
+  for (int64_t i = 0; i < bytecodes.size(); i += run_lengths[i]) {
+    run_lengths[i] = GetFusibleRunLength(bytecodes, i);
+    for (int64_t j = i; j < i + run_lengths[i]; ++j) {
+      new_indices[j] = new_size;
+    }
+    ++new_size;
+  }
+  new_indices[bytecodes.size()] = new_size;
+
+  // Converts the jump amount of the jump at `old_pc` into one relative to the
+  // post-fusion PC `new_pc`.
+  auto retarget = [&](int64_t old_pc, int64_t new_pc,
+                      Bytecode::JumpTarget target)
+      -> absl::StatusOr<Bytecode::JumpTarget> {
+    int64_t old_dest = old_pc + target.value();
+    XLS_RET_CHECK(old_dest >= 0 && old_dest <= bytecodes.size());
+    return Bytecode::JumpTarget(new_indices[old_dest] - new_pc);
+  };
+
+  std::vector<Bytecode> result;
+  result.reserve(new_size);
+  for (int64_t i = 0; i < bytecodes.size(); i += run_lengths[i]) {
+    int64_t new_pc = result.size();
+    Bytecode& bytecode = bytecodes[i];
+    if (run_lengths[i] == 1) {
+      if (bytecode.op() == Bytecode::Op::kJumpRel ||
+          bytecode.op() == Bytecode::Op::kJumpRelIf) {
+        XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                             bytecode.jump_target());
+        XLS_ASSIGN_OR_RETURN(target, retarget(i, new_pc, target));
+        result.push_back(
+            Bytecode(bytecode.source_span(), bytecode.op(), target));
+      } else {
+        result.push_back(std::move(bytecode));
+      }
+      continue;
+    }
+
+    int64_t binop = i;
+    while (!IsFusibleBinop(bytecodes[binop].op())) {
+      ++binop;
+    }
+    Bytecode::FusedBinopData data{.op = bytecodes[binop].op()};
+    if (binop - i == 2) {
+      XLS_ASSIGN_OR_RETURN(data.lhs, GetFusedOperand(bytecodes[i]));
+      XLS_ASSIGN_OR_RETURN(data.rhs, GetFusedOperand(bytecodes[i + 1]));
+    } else if (binop - i == 1) {
+      XLS_ASSIGN_OR_RETURN(data.rhs, GetFusedOperand(bytecodes[i]));
+    }
+    int64_t tail = i + run_lengths[i] - 1;
+    if (tail > binop) {
+      if (bytecodes[tail].op() == Bytecode::Op::kStore) {
+        XLS_ASSIGN_OR_RETURN(data.store_slot, bytecodes[tail].slot_index());
+      } else {
+        XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                             bytecodes[tail].jump_target());
+        XLS_ASSIGN_OR_RETURN(data.jump_target, retarget(tail, new_pc, target));
+      }
+    }
+    result.push_back(Bytecode(bytecodes[binop].source_span(),
+                              Bytecode::Op::kFusedBinop, std::move(data)));
+  }
+  return result;
+}
+
+}  // namespace
 
 BytecodeEmitter::BytecodeEmitter(
     ImportData* import_data, const TypeInfo* type_info,
@@ -53,16 +195,18 @@ absl::Status BytecodeEmitter::Init(const Function* f) {
 /* static */ absl::StatusOr<std::unique_ptr<BytecodeFunction>>
 BytecodeEmitter::Emit(ImportData* import_data, const TypeInfo* type_info,
                       const Function* f,
-                      const std::optional<SymbolicBindings>& caller_bindings) {
+                      const std::optional<SymbolicBindings>& caller_bindings,
+                      const BytecodeEmitterOptions& options) {
   return EmitProcNext(import_data, type_info, f, caller_bindings,
-                      /*proc_members=*/{});
+                      /*proc_members=*/{}, options);
 }
 
 /* static */ absl::StatusOr<std::unique_ptr<BytecodeFunction>>
 BytecodeEmitter::EmitProcNext(
     ImportData* import_data, const TypeInfo* type_info, const Function* f,
     const std::optional<SymbolicBindings>& caller_bindings,
-    const std::vector<NameDef*>& proc_members) {
+    const std::vector<NameDef*>& proc_members,
+    const BytecodeEmitterOptions& options) {
   BytecodeEmitter emitter(import_data, type_info, caller_bindings);
   for (const NameDef* name_def : proc_members) {
     emitter.namedef_to_slot_[name_def] = emitter.namedef_to_slot_.size();
@@ -70,8 +214,13 @@ BytecodeEmitter::EmitProcNext(
   XLS_RETURN_IF_ERROR(emitter.Init(f));
   XLS_RETURN_IF_ERROR(f->body()->AcceptExpr(&emitter));
 
+  std::vector<Bytecode> bytecodes = std::move(emitter.bytecode_);
+  if (options.fuse_superinstructions) {
+    XLS_ASSIGN_OR_RETURN(bytecodes,
+                         FuseSuperinstructions(std::move(bytecodes)));
+  }
   return BytecodeFunction::Create(f->owner(), f, type_info,
-                                  std::move(emitter.bytecode_));
+                                  std::move(bytecodes));
 }
 
 // Extracts all NameDefs "downstream" of a given AstNode. This
@@ -27,6 +27,14 @@
 
 namespace xls::dslx {
 
+struct BytecodeEmitterOptions {
+  // Whether to collapse common bytecode sequences (operand loads, a binary op,
+  // and a trailing store or conditional jump) into kFusedBinop
+  // superinstructions, which reduces the number of instructions the
+  // interpreter dispatches and the values it pushes and pops.
+  bool fuse_superinstructions = false;
+};
+
 // Translates a DSLX expression tree into a linear sequence of bytecode
 // (bytecodes?).
 // TODO(rspringer): Handle the rest of the Expr node types.
@@ -37,7 +45,8 @@ class BytecodeEmitter : public ExprVisitor {
   // `f` itself. It will be nullopt for non-parametric functions.
   static absl::StatusOr<std::unique_ptr<BytecodeFunction>> Emit(
       ImportData* import_data, const TypeInfo* type_info, const Function* f,
-      const std::optional<SymbolicBindings>& caller_bindings);
+      const std::optional<SymbolicBindings>& caller_bindings,
+      const BytecodeEmitterOptions& options = BytecodeEmitterOptions());
 
   // TODO(rspringer): 2022-03-16: I think we can delete `caller_bindings`.
   static absl::StatusOr<std::unique_ptr<BytecodeFunction>> EmitExpression(
@@ -50,7 +59,8 @@ class BytecodeEmitter : public ExprVisitor {
   static absl::StatusOr<std::unique_ptr<BytecodeFunction>> EmitProcNext(
       ImportData* import_data, const TypeInfo* type_info, const Function* f,
       const std::optional<SymbolicBindings>& caller_bindings,
-      const std::vector<NameDef*>& proc_members);
+      const std::vector<NameDef*>& proc_members,
+      const BytecodeEmitterOptions& options = BytecodeEmitterOptions());
 
  private:
   BytecodeEmitter(ImportData* import_data, const TypeInfo* type_info,
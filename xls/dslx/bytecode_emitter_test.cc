@@ -31,7 +31,8 @@ using status_testing::IsOkAndHolds;
 
 absl::StatusOr<std::unique_ptr<BytecodeFunction>> EmitBytecodes(
     ImportData* import_data, std::string_view program,
-    std::string_view fn_name) {
+    std::string_view fn_name,
+    const BytecodeEmitterOptions& options = BytecodeEmitterOptions()) {
   XLS_ASSIGN_OR_RETURN(
       TypecheckedModule tm,
       ParseAndTypecheck(program, "test.x", "test", import_data));
@@ -39,7 +40,7 @@ absl::StatusOr<std::unique_ptr<BytecodeFunction>> EmitBytecodes(
   XLS_ASSIGN_OR_RETURN(TestFunction * tf, tm.module->GetTest(fn_name));
 
   return BytecodeEmitter::Emit(import_data, tm.type_info, tf->fn(),
-                               absl::nullopt);
+                               absl::nullopt, options);
 }
 
 // Verifies that a baseline translation - of a nearly-minimal test case -
@@ -1119,6 +1120,57 @@ fn main() -> u32 {
   }
 }
 
+TEST(BytecodeEmitterTest, SimpleForFused) {
+  constexpr std::string_view kProgram = R"(#[test]
+fn main() -> u32 {
+  for (i, accum) : (u32, u32) in range(u32:0, u32:8) {
+    accum + i
+  }(u32:1)
+})";
+
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> bf,
+      EmitBytecodes(&import_data, kProgram, "main",
+                    BytecodeEmitterOptions{.fuse_superinstructions = true}));
+
+  // The loop condition becomes a compare-and-jump, the body's add reads both
+  // operands from slots, and the induction variable update becomes a single
+  // load/op/store. Both jumps are retargeted to the same jump_dests as in the
+  // unfused SimpleFor above.
+  const std::vector<std::string> kExpected = {
+      "literal u32:0 @ test.x:3:44-3:45",
+      "literal u32:8 @ test.x:3:51-3:52",
+      "literal builtin:range @ test.x:3:34-3:39",
+      "call range(u32:0, u32:8) : {} @ test.x:3:39-3:53",
+      "store 0 @ test.x:3:6-5:11",
+      "literal u32:0 @ test.x:3:6-5:11",
+      "store 1 @ test.x:3:6-5:11",
+      "literal u32:1 @ test.x:5:9-5:10",
+      "jump_dest @ test.x:3:6-5:11",
+      "fused_binop eq(load:1, value:u32:8) jump_rel_if +12 @ test.x:3:6-5:11",
+      "load 0 @ test.x:3:6-5:11",
+      "load 1 @ test.x:3:6-5:11",
+      "index @ test.x:3:6-5:11",
+      "swap @ test.x:3:6-5:11",
+      "create_tuple 2 @ test.x:3:6-5:11",
+      "expand_tuple @ test.x:3:7-3:17",
+      "store 2 @ test.x:3:8-3:9",
+      "store 3 @ test.x:3:11-3:16",
+      "fused_binop add(load:3, load:2) @ test.x:4:11-4:12",
+      "fused_binop add(load:1, value:u32:1) store:1 @ test.x:3:6-5:11",
+      "jump_rel -12 @ test.x:3:6-5:11",
+      "jump_dest @ test.x:3:6-5:11",
+  };
+
+  const std::vector<Bytecode>& bytecodes = bf->bytecodes();
+  ASSERT_EQ(bytecodes.size(), kExpected.size());
+  for (int i = 0; i < bytecodes.size(); i++) {
+    ASSERT_EQ(bytecodes[i].ToString(), kExpected[i]);
+  }
+  EXPECT_EQ(bf->num_slots(), 4);
+}
+
 TEST(BytecodeEmitterTest, Range) {
   constexpr std::string_view kProgram = R"(#[test]
 fn main() -> u32[8] {
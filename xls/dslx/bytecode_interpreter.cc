@@ -27,6 +27,55 @@
 #include "xls/ir/bits_ops.h"
 
 namespace xls::dslx {
+namespace {
+
+// Applies the binary op `op` (one which pops two operands and pushes one
+// result) to the given operands.
+absl::StatusOr<InterpValue> ApplyBinop(Bytecode::Op op, const InterpValue& lhs,
+                                       const InterpValue& rhs) {
+  switch (op) {
+    case Bytecode::Op::kAdd:
+      return lhs.Add(rhs);
+    case Bytecode::Op::kAnd:
+      return lhs.BitwiseAnd(rhs);
+    case Bytecode::Op::kConcat:
+      return lhs.Concat(rhs);
+    case Bytecode::Op::kDiv:
+      return lhs.FloorDiv(rhs);
+    case Bytecode::Op::kEq:
+      return InterpValue::MakeBool(lhs.Eq(rhs));
+    case Bytecode::Op::kGe:
+      return lhs.Ge(rhs);
+    case Bytecode::Op::kGt:
+      return lhs.Gt(rhs);
+    case Bytecode::Op::kLe:
+      return lhs.Le(rhs);
+    case Bytecode::Op::kLt:
+      return lhs.Lt(rhs);
+    case Bytecode::Op::kMul:
+      return lhs.Mul(rhs);
+    case Bytecode::Op::kNe:
+      return InterpValue::MakeBool(lhs.Ne(rhs));
+    case Bytecode::Op::kOr:
+      return lhs.BitwiseOr(rhs);
+    case Bytecode::Op::kShl:
+      return lhs.Shl(rhs);
+    case Bytecode::Op::kShr:
+      if (lhs.IsSigned()) {
+        return lhs.Shra(rhs);
+      }
+      return lhs.Shrl(rhs);
+    case Bytecode::Op::kSub:
+      return lhs.Sub(rhs);
+    case Bytecode::Op::kXor:
+      return lhs.BitwiseXor(rhs);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Not a binary op: ", OpToString(op)));
+  }
+}
+
+}  // namespace
 
 Frame::Frame(BytecodeFunction* bf, std::vector<InterpValue> args,
              const TypeInfo* type_info,
@@ -49,7 +98,7 @@ void Frame::StoreSlot(Bytecode::SlotIndex slot, InterpValue value) {
     slots_.push_back(InterpValue::MakeToken());
   }
 
-  slots_.at(slot.value()) = value;
+  slots_.at(slot.value()) = std::move(value);
 }
 
 /* static */ absl::StatusOr<InterpValue> BytecodeInterpreter::Interpret(
@@ -201,6 +250,15 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       XLS_RETURN_IF_ERROR(EvalFail(bytecode));
       break;
     }
+    case Bytecode::Op::kFusedBinop: {
+      XLS_ASSIGN_OR_RETURN(std::optional<int64_t> new_pc,
+                           EvalFusedBinop(frame->pc(), bytecode));
+      if (new_pc.has_value()) {
+        frame->set_pc(new_pc.value());
+        return absl::OkStatus();
+      }
+      break;
+    }
     case Bytecode::Op::kGe: {
       XLS_RETURN_IF_ERROR(EvalGe(bytecode));
       break;
@@ -362,27 +420,21 @@ absl::Status BytecodeInterpreter::EvalUnop(
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalBinop(
-    const std::function<absl::StatusOr<InterpValue>(
-        const InterpValue& lhs, const InterpValue& rhs)>& op) {
+absl::Status BytecodeInterpreter::EvalBinop(Bytecode::Op op) {
   XLS_RET_CHECK_GE(stack_.size(), 2);
   XLS_ASSIGN_OR_RETURN(InterpValue rhs, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
-  XLS_ASSIGN_OR_RETURN(InterpValue result, op(lhs, rhs));
+  XLS_ASSIGN_OR_RETURN(InterpValue result, ApplyBinop(op, lhs, rhs));
   stack_.push_back(std::move(result));
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalAdd(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Add(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kAdd);
 }
 
 absl::Status BytecodeInterpreter::EvalAnd(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseAnd(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kAnd);
 }
 
 absl::StatusOr<BytecodeFunction*> BytecodeInterpreter::GetBytecodeFn(
@@ -549,9 +601,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalConcat(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Concat(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kConcat);
 }
 
 absl::Status BytecodeInterpreter::EvalCreateArray(const Bytecode& bytecode) {
@@ -591,9 +641,7 @@ absl::Status BytecodeInterpreter::EvalCreateTuple(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalDiv(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.FloorDiv(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kDiv);
 }
 
 absl::Status BytecodeInterpreter::EvalDup(const Bytecode& bytecode) {
@@ -603,9 +651,7 @@ absl::Status BytecodeInterpreter::EvalDup(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalEq(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Eq(rhs));
-  });
+  return EvalBinop(Bytecode::Op::kEq);
 }
 
 absl::Status BytecodeInterpreter::EvalExpandTuple(const Bytecode& bytecode) {
@@ -639,15 +685,11 @@ absl::Status BytecodeInterpreter::EvalFail(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalGe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Ge(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kGe);
 }
 
 absl::Status BytecodeInterpreter::EvalGt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Gt(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kGt);
 }
 
 absl::Status BytecodeInterpreter::EvalIndex(const Bytecode& bytecode) {
@@ -673,9 +715,7 @@ absl::Status BytecodeInterpreter::EvalInvert(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalLe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Le(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kLe);
 }
 
 absl::Status BytecodeInterpreter::EvalLiteral(const Bytecode& bytecode) {
@@ -738,9 +778,7 @@ absl::Status BytecodeInterpreter::EvalLogicalOr(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalLt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Lt(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kLt);
 }
 
 absl::StatusOr<bool> BytecodeInterpreter::MatchArmEqualsInterpValue(
@@ -807,15 +845,11 @@ absl::Status BytecodeInterpreter::EvalMatchArm(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalMul(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Mul(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kMul);
 }
 
 absl::Status BytecodeInterpreter::EvalNe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Ne(rhs));
-  });
+  return EvalBinop(Bytecode::Op::kNe);
 }
 
 absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
@@ -826,9 +860,7 @@ absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalOr(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseOr(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kOr);
 }
 
 absl::Status BytecodeInterpreter::EvalPop(const Bytecode& bytecode) {
@@ -918,18 +950,11 @@ absl::Status BytecodeInterpreter::EvalSend(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalShl(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Shl(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kShl);
 }
 
 absl::Status BytecodeInterpreter::EvalShr(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    if (lhs.IsSigned()) {
-      return lhs.Shra(rhs);
-    }
-    return lhs.Shrl(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kShr);
 }
 
 absl::Status BytecodeInterpreter::EvalSlice(const Bytecode& bytecode) {
@@ -994,7 +1019,7 @@ absl::Status BytecodeInterpreter::EvalStore(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-  frames_.back().StoreSlot(slot, value);
+  frames_.back().StoreSlot(slot, std::move(value));
   return absl::OkStatus();
 }
 
@@ -1009,10 +1034,54 @@ absl::StatusOr<std::optional<int64_t>> BytecodeInterpreter::EvalJumpRelIf(
   return std::nullopt;
 }
 
+absl::StatusOr<const InterpValue*> BytecodeInterpreter::ResolveFusedOperand(
+    const Bytecode::FusedBinopData::Operand& operand,
+    std::optional<InterpValue>* storage) {
+  if (std::holds_alternative<InterpValue>(operand)) {
+    return &std::get<InterpValue>(operand);
+  }
+  if (std::holds_alternative<Bytecode::SlotIndex>(operand)) {
+    Bytecode::SlotIndex slot = std::get<Bytecode::SlotIndex>(operand);
+    if (frames_.back().slots().size() <= slot.value()) {
+      return absl::InternalError(absl::StrFormat(
+          "Attempted to access local data in slot %d, which is out of range.",
+          slot.value()));
+    }
+    return &frames_.back().slots().at(slot.value());
+  }
+  XLS_ASSIGN_OR_RETURN(*storage, Pop());
+  return &storage->value();
+}
+
+absl::StatusOr<std::optional<int64_t>> BytecodeInterpreter::EvalFusedBinop(
+    int64_t pc, const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::FusedBinopData* data,
+                       bytecode.fused_binop_data());
+  // As in EvalBinop(), the rhs is popped first when both come from the stack.
+  std::optional<InterpValue> rhs_storage;
+  std::optional<InterpValue> lhs_storage;
+  XLS_ASSIGN_OR_RETURN(const InterpValue* rhs,
+                       ResolveFusedOperand(data->rhs, &rhs_storage));
+  XLS_ASSIGN_OR_RETURN(const InterpValue* lhs,
+                       ResolveFusedOperand(data->lhs, &lhs_storage));
+  XLS_ASSIGN_OR_RETURN(InterpValue result, ApplyBinop(data->op, *lhs, *rhs));
+  if (data->store_slot.has_value()) {
+    frames_.back().StoreSlot(data->store_slot.value(), std::move(result));
+    return std::nullopt;
+  }
+  if (data->jump_target.has_value()) {
+    XLS_VLOG(2) << "fused jump_rel_if value: " << result.ToString();
+    if (result.IsTrue()) {
+      return pc + data->jump_target->value();
+    }
+    return std::nullopt;
+  }
+  stack_.push_back(std::move(result));
+  return std::nullopt;
+}
+
 absl::Status BytecodeInterpreter::EvalSub(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Sub(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kSub);
 }
 
 absl::Status BytecodeInterpreter::EvalSwap(const Bytecode& bytecode) {
@@ -1093,9 +1162,7 @@ absl::Status BytecodeInterpreter::EvalWidthSlice(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalXor(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseXor(rhs);
-  });
+  return EvalBinop(Bytecode::Op::kXor);
 }
 
 absl::Status BytecodeInterpreter::RunBuiltinFn(const Bytecode& bytecode,
@@ -1726,8 +1793,9 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
 
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> next_bf,
-      BytecodeEmitter::EmitProcNext(import_data, type_info, proc->next(),
-                                    caller_bindings, member_defs));
+      BytecodeEmitter::EmitProcNext(
+          import_data, type_info, proc->next(), caller_bindings, member_defs,
+          BytecodeEmitterOptions{.fuse_superinstructions = true}));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeInterpreter> next_interpreter,
       CreateUnique(import_data, next_bf.get(), full_next_args));
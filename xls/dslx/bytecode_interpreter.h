@@ -164,14 +164,22 @@ class BytecodeInterpreter {
   absl::Status EvalUnop(
       const std::function<absl::StatusOr<InterpValue>(const InterpValue& arg)>&
           op);
-  absl::Status EvalBinop(
-      const std::function<absl::StatusOr<InterpValue>(
-          const InterpValue& lhs, const InterpValue& rhs)>& op);
+  // Pops the rhs and then the lhs of the binary `op` off the stack and pushes
+  // the result.
+  absl::Status EvalBinop(Bytecode::Op op);
   absl::StatusOr<BytecodeFunction*> GetBytecodeFn(
       Function* function, const Invocation* invocation,
       const std::optional<SymbolicBindings>& caller_bindings);
   absl::StatusOr<std::optional<int64_t>> EvalJumpRelIf(
       int64_t pc, const Bytecode& bytecode);
+  // Returns the new PC if the superinstruction ends in a jump that is taken.
+  absl::StatusOr<std::optional<int64_t>> EvalFusedBinop(
+      int64_t pc, const Bytecode& bytecode);
+  // Returns the value of a fused operand, popping it into `storage` if it
+  // comes from the stack.
+  absl::StatusOr<const InterpValue*> ResolveFusedOperand(
+      const Bytecode::FusedBinopData::Operand& operand,
+      std::optional<InterpValue>* storage);
 
   // TODO(rspringer): 2022-02-14: Builtins should probably go in their own file,
   // likely after removing the old interpreter.
@@ -47,7 +47,9 @@ TEST(BytecodeInterpreterTest, TraceDataToString) {
 absl::StatusOr<InterpValue> Interpret(ImportData* import_data,
                                       std::string_view program,
                                       std::string_view entry,
-                                      std::vector<InterpValue> args = {}) {
+                                      std::vector<InterpValue> args = {},
+                                      const BytecodeEmitterOptions& options =
+                                          BytecodeEmitterOptions()) {
   XLS_ASSIGN_OR_RETURN(
       TypecheckedModule tm,
       ParseAndTypecheck(program, "test.x", "test", import_data));
@@ -56,7 +58,8 @@ absl::StatusOr<InterpValue> Interpret(ImportData* import_data,
                        tm.module->GetMemberOrError<Function>(entry));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
-      BytecodeEmitter::Emit(import_data, tm.type_info, f, SymbolicBindings()));
+      BytecodeEmitter::Emit(import_data, tm.type_info, f, SymbolicBindings(),
+                            options));
 
   return BytecodeInterpreter::Interpret(import_data, bf.get(), args);
 }
@@ -967,6 +970,47 @@ fn has_params(x: u32, y: u64) -> u48 {
   EXPECT_EQ(int_val, 212);
 }
 
+TEST(BytecodeInterpreterTest, FusedSuperinstructionsMatchUnfused) {
+  constexpr std::string_view kProgram = R"(
+fn main(x: u32, y: s8) -> (u32, s8, u32) {
+  let sum = for (i, accum) : (u32, u32) in range(u32:0, u32:5) {
+    accum + i * x - (i >> u32:1)
+  }(u32:0);
+  let z = if x > u32:3 { y >> u32:2 } else { y << u32:1 };
+  let w = match x {
+    u32:7 => sum ^ u32:0xff,
+    _ => sum | u32:1,
+  };
+  (sum, z, w)
+})";
+
+  struct TestCase {
+    uint32_t x;
+    InterpValue expected;
+  };
+  const std::vector<TestCase> kTestCases = {
+      {7, InterpValue::MakeTuple({InterpValue::MakeU32(66),
+                                  InterpValue::MakeSBits(8, -16),
+                                  InterpValue::MakeU32(189)})},
+      {2, InterpValue::MakeTuple({InterpValue::MakeU32(16),
+                                  InterpValue::MakeSBits(8, -128),
+                                  InterpValue::MakeU32(17)})},
+  };
+  for (const TestCase& test_case : kTestCases) {
+    std::vector<InterpValue> args = {InterpValue::MakeU32(test_case.x),
+                                     InterpValue::MakeSBits(8, -64)};
+    for (bool fuse : {false, true}) {
+      auto import_data = CreateImportDataForTest();
+      XLS_ASSERT_OK_AND_ASSIGN(
+          InterpValue value,
+          Interpret(&import_data, kProgram, "main", args,
+                    BytecodeEmitterOptions{.fuse_superinstructions = fuse}));
+      EXPECT_TRUE(value.Eq(test_case.expected))
+          << "fuse: " << fuse << " value: " << value.ToString();
+    }
+  }
+}
+
 TEST(BytecodeInterpreterTest, SimpleFnCall) {
   constexpr std::string_view kProgram = R"(
 fn callee(x: u32, y: u32) -> u32 {
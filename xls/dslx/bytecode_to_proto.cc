@@ -0,0 +1,421 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode_to_proto.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/type_info_to_proto.h"
+
+namespace xls::dslx {
+namespace {
+
+using SlotIndex = Bytecode::SlotIndex;
+
+absl::StatusOr<BytecodeNodeRefProto> NodeRefToProto(
+    const AstNode* node, const ImportData& import_data) {
+  std::optional<Span> span = node->GetSpan();
+  if (!span.has_value()) {
+    return absl::UnimplementedError(
+        absl::StrFormat("Cannot refer to %s node without a span",
+                        AstNodeKindToString(node->kind())));
+  }
+  // Nodes are found again by kind and span, so only nodes which are the first
+  // of their kind at their span can be referred to.
+  absl::StatusOr<const AstNode*> found =
+      import_data.FindNode(node->kind(), span.value());
+  if (!found.ok() || found.value() != node) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "%s node @ %s is not uniquely identified by its span",
+        AstNodeKindToString(node->kind()), span->ToString()));
+  }
+  BytecodeNodeRefProto proto;
+  proto.set_kind(static_cast<int32_t>(node->kind()));
+  *proto.mutable_span() = SpanToProto(span.value());
+  return proto;
+}
+
+absl::StatusOr<const AstNode*> NodeRefFromProto(
+    const BytecodeNodeRefProto& proto, const ImportData& import_data) {
+  return import_data.FindNode(static_cast<AstNodeKind>(proto.kind()),
+                              SpanFromProto(proto.span()));
+}
+
+FindNodeFn MakeFindNodeFn(const ImportData& import_data) {
+  return [&import_data](AstNodeKind kind,
+                        const Span& span) -> absl::StatusOr<const AstNode*> {
+    switch (kind) {
+      case AstNodeKind::kEnumDef:
+        return import_data.FindEnumDef(span);
+      case AstNodeKind::kStructDef:
+        return import_data.FindStructDef(span);
+      default:
+        return import_data.FindNode(kind, span);
+    }
+  };
+}
+
+absl::StatusOr<BytecodeValueProto> ValueToProto(
+    const InterpValue& value, const ImportData& import_data) {
+  BytecodeValueProto proto;
+  if (!value.IsFunction()) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_value(), InterpValueToProto(value));
+    return proto;
+  }
+  const InterpValue::FnData& fn_data = value.GetFunctionOrDie();
+  if (std::holds_alternative<Builtin>(fn_data)) {
+    proto.set_builtin(static_cast<int32_t>(std::get<Builtin>(fn_data)));
+    return proto;
+  }
+  const auto& user_fn = std::get<InterpValue::UserFnData>(fn_data);
+  XLS_ASSIGN_OR_RETURN(*proto.mutable_user_function(),
+                       NodeRefToProto(user_fn.function, import_data));
+  return proto;
+}
+
+absl::StatusOr<InterpValue> ValueFromProto(const BytecodeValueProto& proto,
+                                           const ImportData& import_data) {
+  switch (proto.value_oneof_case()) {
+    case BytecodeValueProto::kValue:
+      return InterpValueFromProto(proto.value(), MakeFindNodeFn(import_data));
+    case BytecodeValueProto::kBuiltin:
+      return InterpValue::MakeFunction(static_cast<Builtin>(proto.builtin()));
+    case BytecodeValueProto::kUserFunction: {
+      XLS_ASSIGN_OR_RETURN(
+          const AstNode* node,
+          NodeRefFromProto(proto.user_function(), import_data));
+      // ImportData only hands out const nodes; the function value refers to
+      // the (mutable) function it owns.
+      auto* f = const_cast<Function*>(dynamic_cast<const Function*>(node));
+      XLS_RET_CHECK(f != nullptr);
+      return InterpValue::MakeFunction(InterpValue::UserFnData{f->owner(), f});
+    }
+    case BytecodeValueProto::VALUE_ONEOF_NOT_SET:
+      break;
+  }
+  return absl::InvalidArgumentError("Bytecode value proto holds no value");
+}
+
+absl::StatusOr<SymbolicBindingsProto> BindingsToProto(
+    const SymbolicBindings& bindings) {
+  SymbolicBindingsProto proto;
+  for (const SymbolicBinding& binding : bindings.bindings()) {
+    SymbolicBindingProto* binding_proto = proto.add_bindings();
+    binding_proto->set_identifier(binding.identifier);
+    XLS_ASSIGN_OR_RETURN(*binding_proto->mutable_value(),
+                         InterpValueToProto(binding.value));
+  }
+  return proto;
+}
+
+absl::StatusOr<SymbolicBindings> BindingsFromProto(
+    const SymbolicBindingsProto& proto, const ImportData& import_data) {
+  std::vector<std::pair<std::string, InterpValue>> items;
+  for (const SymbolicBindingProto& binding : proto.bindings()) {
+    XLS_ASSIGN_OR_RETURN(
+        InterpValue value,
+        InterpValueFromProto(binding.value(), MakeFindNodeFn(import_data)));
+    items.push_back({binding.identifier(), std::move(value)});
+  }
+  return SymbolicBindings(items);
+}
+
+absl::StatusOr<BytecodeMatchArmItemProto> MatchArmItemToProto(
+    const Bytecode::MatchArmItem& item, const ImportData& import_data) {
+  BytecodeMatchArmItemProto proto;
+  switch (item.kind()) {
+    case Bytecode::MatchArmItem::Kind::kInterpValue: {
+      XLS_ASSIGN_OR_RETURN(InterpValue value, item.interp_value());
+      XLS_ASSIGN_OR_RETURN(*proto.mutable_value(),
+                           ValueToProto(value, import_data));
+      break;
+    }
+    case Bytecode::MatchArmItem::Kind::kLoad: {
+      XLS_ASSIGN_OR_RETURN(SlotIndex slot, item.slot_index());
+      proto.set_load(slot.value());
+      break;
+    }
+    case Bytecode::MatchArmItem::Kind::kStore: {
+      XLS_ASSIGN_OR_RETURN(SlotIndex slot, item.slot_index());
+      proto.set_store(slot.value());
+      break;
+    }
+    case Bytecode::MatchArmItem::Kind::kTuple: {
+      XLS_ASSIGN_OR_RETURN(std::vector<Bytecode::MatchArmItem> elements,
+                           item.tuple_elements());
+      BytecodeMatchArmItemProto::TupleProto* tuple = proto.mutable_tuple();
+      for (const Bytecode::MatchArmItem& element : elements) {
+        XLS_ASSIGN_OR_RETURN(*tuple->add_elements(),
+                             MatchArmItemToProto(element, import_data));
+      }
+      break;
+    }
+    case Bytecode::MatchArmItem::Kind::kWildcard:
+      proto.set_wildcard(true);
+      break;
+  }
+  return proto;
+}
+
+absl::StatusOr<Bytecode::MatchArmItem> MatchArmItemFromProto(
+    const BytecodeMatchArmItemProto& proto, const ImportData& import_data) {
+  switch (proto.item_oneof_case()) {
+    case BytecodeMatchArmItemProto::kValue: {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           ValueFromProto(proto.value(), import_data));
+      return Bytecode::MatchArmItem::MakeInterpValue(value);
+    }
+    case BytecodeMatchArmItemProto::kLoad:
+      return Bytecode::MatchArmItem::MakeLoad(SlotIndex(proto.load()));
+    case BytecodeMatchArmItemProto::kStore:
+      return Bytecode::MatchArmItem::MakeStore(SlotIndex(proto.store()));
+    case BytecodeMatchArmItemProto::kTuple: {
+      std::vector<Bytecode::MatchArmItem> elements;
+      for (const BytecodeMatchArmItemProto& element :
+           proto.tuple().elements()) {
+        XLS_ASSIGN_OR_RETURN(Bytecode::MatchArmItem item,
+                             MatchArmItemFromProto(element, import_data));
+        elements.push_back(std::move(item));
+      }
+      return Bytecode::MatchArmItem::MakeTuple(std::move(elements));
+    }
+    case BytecodeMatchArmItemProto::kWildcard:
+      return Bytecode::MatchArmItem::MakeWildcard();
+    case BytecodeMatchArmItemProto::ITEM_ONEOF_NOT_SET:
+      break;
+  }
+  return absl::InvalidArgumentError("Match arm item proto holds no item");
+}
+
+absl::StatusOr<BytecodeFusedOperandProto> FusedOperandToProto(
+    const Bytecode::FusedBinopData::Operand& operand,
+    const ImportData& import_data) {
+  BytecodeFusedOperandProto proto;
+  if (std::holds_alternative<std::monostate>(operand)) {
+    proto.set_stack(true);
+  } else if (std::holds_alternative<SlotIndex>(operand)) {
+    proto.set_slot(std::get<SlotIndex>(operand).value());
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        *proto.mutable_value(),
+        ValueToProto(std::get<InterpValue>(operand), import_data));
+  }
+  return proto;
+}
+
+absl::StatusOr<Bytecode::FusedBinopData::Operand> FusedOperandFromProto(
+    const BytecodeFusedOperandProto& proto, const ImportData& import_data) {
+  switch (proto.operand_oneof_case()) {
+    case BytecodeFusedOperandProto::kStack:
+      return std::monostate();
+    case BytecodeFusedOperandProto::kSlot:
+      return SlotIndex(proto.slot());
+    case BytecodeFusedOperandProto::kValue: {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           ValueFromProto(proto.value(), import_data));
+      return value;
+    }
+    case BytecodeFusedOperandProto::OPERAND_ONEOF_NOT_SET:
+      break;
+  }
+  return absl::InvalidArgumentError("Fused operand proto holds no operand");
+}
+
+absl::StatusOr<BytecodeProto> BytecodeToProto(const Bytecode& bytecode,
+                                              const ImportData& import_data) {
+  BytecodeProto proto;
+  *proto.mutable_span() = SpanToProto(bytecode.source_span());
+  proto.set_op(static_cast<int32_t>(bytecode.op()));
+  if (!bytecode.has_data()) {
+    return proto;
+  }
+  const Bytecode::Data& data = bytecode.data().value();
+  if (const auto* value = std::get_if<InterpValue>(&data)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_value(),
+                         ValueToProto(*value, import_data));
+  } else if (const auto* target = std::get_if<Bytecode::JumpTarget>(&data)) {
+    proto.set_jump_target(target->value());
+  } else if (const auto* count = std::get_if<Bytecode::NumElements>(&data)) {
+    proto.set_num_elements(count->value());
+  } else if (const auto* slot = std::get_if<SlotIndex>(&data)) {
+    proto.set_slot_index(slot->value());
+  } else if (const auto* type =
+                 std::get_if<std::unique_ptr<ConcreteType>>(&data)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_type(), ConcreteTypeToProto(**type));
+  } else if (const auto* invocation =
+                 std::get_if<Bytecode::InvocationData>(&data)) {
+    BytecodeInvocationProto* invocation_proto = proto.mutable_invocation();
+    XLS_ASSIGN_OR_RETURN(
+        *invocation_proto->mutable_invocation(),
+        NodeRefToProto(invocation->invocation, import_data));
+    if (invocation->bindings.has_value()) {
+      XLS_ASSIGN_OR_RETURN(*invocation_proto->mutable_bindings(),
+                           BindingsToProto(invocation->bindings.value()));
+    }
+  } else if (const auto* item = std::get_if<Bytecode::MatchArmItem>(&data)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_match_arm_item(),
+                         MatchArmItemToProto(*item, import_data));
+  } else if (const auto* trace_data = std::get_if<Bytecode::TraceData>(&data)) {
+    BytecodeTraceDataProto* trace_proto = proto.mutable_trace_data();
+    for (const FormatStep& step : *trace_data) {
+      BytecodeFormatStepProto* step_proto = trace_proto->add_steps();
+      if (const auto* text = std::get_if<std::string>(&step)) {
+        step_proto->set_text(*text);
+      } else {
+        step_proto->set_preference(
+            static_cast<int32_t>(std::get<FormatPreference>(step)));
+      }
+    }
+  } else if (const auto* fused =
+                 std::get_if<Bytecode::FusedBinopData>(&data)) {
+    BytecodeFusedBinopProto* fused_proto = proto.mutable_fused_binop();
+    fused_proto->set_op(static_cast<int32_t>(fused->op));
+    XLS_ASSIGN_OR_RETURN(*fused_proto->mutable_lhs(),
+                         FusedOperandToProto(fused->lhs, import_data));
+    XLS_ASSIGN_OR_RETURN(*fused_proto->mutable_rhs(),
+                         FusedOperandToProto(fused->rhs, import_data));
+    if (fused->store_slot.has_value()) {
+      fused_proto->set_store_slot(fused->store_slot->value());
+    }
+    if (fused->jump_target.has_value()) {
+      fused_proto->set_jump_target(fused->jump_target->value());
+    }
+  } else {
+    return absl::UnimplementedError(
+        absl::StrFormat("Cannot serialize the data of bytecode: %s",
+                        bytecode.ToString()));
+  }
+  return proto;
+}
+
+absl::StatusOr<Bytecode> BytecodeFromProto(const BytecodeProto& proto,
+                                           const ImportData& import_data) {
+  Span span = SpanFromProto(proto.span());
+  auto op = static_cast<Bytecode::Op>(proto.op());
+  std::optional<Bytecode::Data> data;
+  switch (proto.data_oneof_case()) {
+    case BytecodeProto::kValue: {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           ValueFromProto(proto.value(), import_data));
+      data = std::move(value);
+      break;
+    }
+    case BytecodeProto::kJumpTarget:
+      data = Bytecode::JumpTarget(proto.jump_target());
+      break;
+    case BytecodeProto::kNumElements:
+      data = Bytecode::NumElements(proto.num_elements());
+      break;
+    case BytecodeProto::kSlotIndex:
+      data = SlotIndex(proto.slot_index());
+      break;
+    case BytecodeProto::kType: {
+      XLS_ASSIGN_OR_RETURN(
+          std::unique_ptr<ConcreteType> type,
+          ConcreteTypeFromProto(proto.type(), MakeFindNodeFn(import_data)));
+      data = std::move(type);
+      break;
+    }
+    case BytecodeProto::kInvocation: {
+      XLS_ASSIGN_OR_RETURN(
+          const AstNode* node,
+          NodeRefFromProto(proto.invocation().invocation(), import_data));
+      const auto* invocation = dynamic_cast<const Invocation*>(node);
+      XLS_RET_CHECK(invocation != nullptr);
+      std::optional<SymbolicBindings> bindings;
+      if (proto.invocation().has_bindings()) {
+        XLS_ASSIGN_OR_RETURN(
+            bindings,
+            BindingsFromProto(proto.invocation().bindings(), import_data));
+      }
+      data = Bytecode::InvocationData{invocation, std::move(bindings)};
+      break;
+    }
+    case BytecodeProto::kMatchArmItem: {
+      XLS_ASSIGN_OR_RETURN(
+          Bytecode::MatchArmItem item,
+          MatchArmItemFromProto(proto.match_arm_item(), import_data));
+      data = std::move(item);
+      break;
+    }
+    case BytecodeProto::kTraceData: {
+      Bytecode::TraceData trace_data;
+      for (const BytecodeFormatStepProto& step : proto.trace_data().steps()) {
+        if (step.has_text()) {
+          trace_data.push_back(step.text());
+        } else {
+          trace_data.push_back(
+              static_cast<FormatPreference>(step.preference()));
+        }
+      }
+      data = std::move(trace_data);
+      break;
+    }
+    case BytecodeProto::kFusedBinop: {
+      const BytecodeFusedBinopProto& fused_proto = proto.fused_binop();
+      Bytecode::FusedBinopData fused;
+      fused.op = static_cast<Bytecode::Op>(fused_proto.op());
+      XLS_ASSIGN_OR_RETURN(fused.lhs,
+                           FusedOperandFromProto(fused_proto.lhs(),
+                                                 import_data));
+      XLS_ASSIGN_OR_RETURN(fused.rhs,
+                           FusedOperandFromProto(fused_proto.rhs(),
+                                                 import_data));
+      if (fused_proto.has_store_slot()) {
+        fused.store_slot = SlotIndex(fused_proto.store_slot());
+      }
+      if (fused_proto.has_jump_target()) {
+        fused.jump_target = Bytecode::JumpTarget(fused_proto.jump_target());
+      }
+      data = std::move(fused);
+      break;
+    }
+    case BytecodeProto::DATA_ONEOF_NOT_SET:
+      break;
+  }
+  return Bytecode(span, op, std::move(data));
+}
+
+}  // namespace
+
+absl::StatusOr<BytecodeFunctionProto> BytecodeFunctionToProto(
+    const BytecodeFunction& bf, const ImportData& import_data) {
+  BytecodeFunctionProto proto;
+  for (const Bytecode& bytecode : bf.bytecodes()) {
+    XLS_ASSIGN_OR_RETURN(*proto.add_bytecodes(),
+                         BytecodeToProto(bytecode, import_data));
+  }
+  return proto;
+}
+
+absl::StatusOr<std::vector<Bytecode>> BytecodesFromProto(
+    const BytecodeFunctionProto& proto, const ImportData& import_data) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.reserve(proto.bytecodes_size());
+  for (const BytecodeProto& bytecode_proto : proto.bytecodes()) {
+    XLS_ASSIGN_OR_RETURN(Bytecode bytecode,
+                         BytecodeFromProto(bytecode_proto, import_data));
+    bytecodes.push_back(std::move(bytecode));
+  }
+  return bytecodes;
+}
+
+}  // namespace xls::dslx
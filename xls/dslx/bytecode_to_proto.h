@@ -0,0 +1,42 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_BYTECODE_TO_PROTO_H_
+#define XLS_DSLX_BYTECODE_TO_PROTO_H_
+
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/dslx/bytecode.h"
+#include "xls/dslx/bytecode_cache.pb.h"
+#include "xls/dslx/import_data.h"
+
+namespace xls::dslx {
+
+// Converts the bytecode of the given function to protobuf form for
+// serialization. Returns an unimplemented error if the bytecode holds data with
+// no serialized form (e.g. spawns, or values with no InterpValueProto form), or
+// refers to an AST node which is not uniquely identified by its kind and span
+// among the modules in `import_data`.
+absl::StatusOr<BytecodeFunctionProto> BytecodeFunctionToProto(
+    const BytecodeFunction& bf, const ImportData& import_data);
+
+// Converts the given protobuf form back into bytecodes, resolving the AST
+// nodes they refer to against the modules in `import_data`.
+absl::StatusOr<std::vector<Bytecode>> BytecodesFromProto(
+    const BytecodeFunctionProto& proto, const ImportData& import_data);
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_BYTECODE_TO_PROTO_H_
@@ -293,9 +293,10 @@ absl::Status ConstexprEvaluator::HandleAttr(const Attr* expr) {
 absl::Status ConstexprEvaluator::HandleArray(const Array* expr) {
   XLS_VLOG(3) << "ConstexprEvaluator::HandleArray : " << expr->ToString();
   std::vector<InterpValue> values;
+  values.reserve(expr->members().size());
   for (const Expr* member : expr->members()) {
     GET_CONSTEXPR_OR_RETURN(InterpValue value, member);
-    values.push_back(value);
+    values.push_back(std::move(value));
   }
 
   if (concrete_type_ != nullptr) {
@@ -315,14 +316,16 @@ absl::Status ConstexprEvaluator::HandleArray(const Array* expr) {
 
     int64_t int_size = int_size_or.value();
     int64_t remaining = int_size - values.size();
+    values.reserve(int_size);
     while (remaining-- > 0) {
       values.push_back(values.back());
     }
   }
 
   // No need to fire up the interpreter. We can handle this one.
-  XLS_ASSIGN_OR_RETURN(InterpValue array, InterpValue::MakeArray(values));
-  type_info_->NoteConstExpr(expr, array);
+  XLS_ASSIGN_OR_RETURN(InterpValue array,
+                       InterpValue::MakeArray(std::move(values)));
+  type_info_->NoteConstExpr(expr, std::move(array));
   return absl::OkStatus();
 }
 
@@ -728,9 +731,10 @@ absl::Status ConstexprEvaluator::HandleUnrollFor(const UnrollFor* expr) {
 
 absl::Status ConstexprEvaluator::HandleXlsTuple(const XlsTuple* expr) {
   std::vector<InterpValue> values;
+  values.reserve(expr->members().size());
   for (const Expr* member : expr->members()) {
     GET_CONSTEXPR_OR_RETURN(InterpValue value, member);
-    values.push_back(value);
+    values.push_back(std::move(value));
   }
 
   // No need to fire up the interpreter. We can handle this one.
@@ -744,6 +748,17 @@ absl::Status ConstexprEvaluator::InterpretExpr(
   XLS_ASSIGN_OR_RETURN(env, MakeConstexprEnv(import_data_, type_info_, expr,
                                              bindings_, bypass_env));
 
+  // The environment holds everything the value depends on, so an evaluation of
+  // the expression in another instantiation with the same environment can be
+  // reused without emitting and running bytecode.
+  SymbolicBindings env_key(env);
+  if (std::optional<InterpValue> cached =
+          type_info_->GetConstExprEvaluation(expr, env_key);
+      cached.has_value()) {
+    type_info_->NoteConstExpr(expr, std::move(cached).value());
+    return absl::OkStatus();
+  }
+
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
                        BytecodeEmitter::EmitExpression(import_data_, type_info_,
                                                        expr, env, bindings_));
@@ -751,6 +766,7 @@ absl::Status ConstexprEvaluator::InterpretExpr(
   XLS_ASSIGN_OR_RETURN(InterpValue constexpr_value,
                        BytecodeInterpreter::Interpret(import_data_, bf.get(),
                                                       /*args=*/{}));
+  type_info_->NoteConstExprEvaluation(expr, env_key, constexpr_value);
   type_info_->NoteConstExpr(expr, constexpr_value);
 
   return absl::OkStatus();
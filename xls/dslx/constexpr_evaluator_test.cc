@@ -609,5 +609,42 @@ fn main() -> u32 {
   EXPECT_EQ(value.GetBitValueInt64().value(), 32);
 }
 
+TEST(ConstexprEvaluatorTest, EvaluationsAreSharedAcrossTypeInfos) {
+  constexpr std::string_view kProgram = R"(
+fn main() -> u32 {
+  u32:3 * u32:2
+}
+)";
+
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  Expr* body = f->body()->body();
+  // Stand-ins for the type information of two parametric instantiations.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypeInfo * first,
+      import_data.type_info_owner().New(tm.module, tm.type_info));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypeInfo * second,
+      import_data.type_info_owner().New(tm.module, tm.type_info));
+
+  XLS_ASSERT_OK(ConstexprEvaluator::Evaluate(&import_data, first,
+                                             SymbolicBindings(), body));
+  std::optional<InterpValue> evaluation =
+      tm.type_info->GetConstExprEvaluation(body, SymbolicBindings());
+  ASSERT_TRUE(evaluation.has_value());
+  EXPECT_EQ(evaluation->GetBitValueInt64().value(), 6);
+  EXPECT_FALSE(tm.type_info->IsKnownConstExpr(body));
+
+  XLS_ASSERT_OK(ConstexprEvaluator::Evaluate(&import_data, second,
+                                             SymbolicBindings(), body));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue value, second->GetConstExpr(body));
+  EXPECT_EQ(value.GetBitValueInt64().value(), 6);
+}
+
 }  // namespace
 }  // namespace xls::dslx
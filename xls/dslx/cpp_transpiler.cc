@@ -14,6 +14,9 @@
 
 #include "xls/dslx/cpp_transpiler.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/string_view.h"
@@ -39,6 +42,7 @@ struct TranspileData {
   Module* module;
   TypeInfo* type_info;
   ImportData* import_data;
+  bool emit_jit_conversions;
 };
 
 absl::StatusOr<InterpValue> InterpretExpr(
@@ -533,6 +537,419 @@ absl::StatusOr<std::optional<int64_t>> GetFieldWidth(
   return absl::nullopt;
 }
 
+// The layout of a type in the native form the XLS JIT uses for its argument
+// and result buffers, see xls::LlvmTypeConverter.
+struct JitLayout {
+  int64_t byte_size;
+  int64_t alignment;
+};
+
+// Returns the number of bytes the JIT uses to hold a bits value of the given
+// width. This mirrors LlvmTypeConverter::GetLlvmBitCount(), which pads widths
+// out to a power of two of at least eight bits. Integers are aligned to their
+// size, as they are in the (x86-64) data layout of the JIT.
+int64_t GetJitBitsByteSize(int64_t bit_count) {
+  if (bit_count <= 8) {
+    return 1;
+  }
+  return (int64_t{1} << CeilOfLog2(bit_count)) / 8;
+}
+
+absl::StatusOr<JitLayout> GetJitLayout(const TranspileData& xpile_data,
+                                       const TypeAnnotation* type);
+
+// Returns the JIT layout of the given struct, i.e., that of the LLVM struct of
+// its members, optionally also recording the offset of each member.
+absl::StatusOr<JitLayout> GetStructJitLayout(
+    const TranspileData& xpile_data, const StructDef* struct_def,
+    std::vector<int64_t>* member_offsets = nullptr) {
+  int64_t offset = 0;
+  int64_t alignment = 1;
+  for (const auto& [name_def, type] : struct_def->members()) {
+    XLS_ASSIGN_OR_RETURN(JitLayout member_layout,
+                         GetJitLayout(xpile_data, type));
+    offset = RoundUpToNearest(offset, member_layout.alignment);
+    if (member_offsets != nullptr) {
+      member_offsets->push_back(offset);
+    }
+    offset += member_layout.byte_size;
+    alignment = std::max(alignment, member_layout.alignment);
+  }
+  return JitLayout{RoundUpToNearest(offset, alignment), alignment};
+}
+
+absl::StatusOr<JitLayout> GetJitLayout(const TranspileData& xpile_data,
+                                       const TypeAnnotation* type) {
+  XLS_ASSIGN_OR_RETURN(std::optional<int64_t> width,
+                       GetFieldWidth(xpile_data, type));
+  if (width.has_value()) {
+    int64_t byte_size = GetJitBitsByteSize(width.value());
+    return JitLayout{byte_size, byte_size};
+  }
+  if (auto* array_type = dynamic_cast<const ArrayTypeAnnotation*>(type)) {
+    XLS_ASSIGN_OR_RETURN(
+        InterpValue array_dim_value,
+        InterpretExpr(xpile_data.import_data, xpile_data.type_info,
+                      array_type->dim(), /*env=*/{}));
+    XLS_ASSIGN_OR_RETURN(int64_t dim, array_dim_value.GetBitValueInt64());
+    XLS_ASSIGN_OR_RETURN(JitLayout element_layout,
+                         GetJitLayout(xpile_data, array_type->element_type()));
+    return JitLayout{dim * element_layout.byte_size, element_layout.alignment};
+  }
+  if (auto* typeref_type = dynamic_cast<const TypeRefTypeAnnotation*>(type)) {
+    TypeDefinition type_definition =
+        typeref_type->type_ref()->type_definition();
+    if (std::holds_alternative<TypeDef*>(type_definition)) {
+      return GetJitLayout(
+          xpile_data, std::get<TypeDef*>(type_definition)->type_annotation());
+    }
+    if (std::holds_alternative<StructDef*>(type_definition)) {
+      return GetStructJitLayout(xpile_data,
+                                std::get<StructDef*>(type_definition));
+    }
+  }
+
+  return absl::UnimplementedError(absl::StrFormat(
+      "Unsupported type for JIT layout: %s.", type->ToString()));
+}
+
+// Generates code for FromJitBuffer() logic for a bits value (of an integral or
+// enum member) stored at the address `src_address`. Signed values are sign
+// extended from their width, as the JIT zeroes the padding bits.
+std::string GenerateBitsFromJitBuffer(std::string_view src_address,
+                                      std::string_view dst_element,
+                                      int64_t bit_count, bool is_signed,
+                                      std::string_view enum_name,
+                                      int indent_level) {
+  // $0: Indentation.
+  // $1: Source address.
+  // $2: Destination element.
+  // $3: Value of the destination element.
+  // $4: Number of bits in the buffer.
+  constexpr std::string_view kTemplate = R"($0{
+$0  uint$4_t bits;
+$0  memcpy(&bits, $1, sizeof(bits));
+$0  $2 = $3;
+$0})";
+
+  int64_t buffer_bit_count = GetJitBitsByteSize(bit_count) * 8;
+  std::string value = "bits";
+  if (is_signed) {
+    int64_t padding = buffer_bit_count - bit_count;
+    value = padding == 0
+                ? absl::StrFormat("static_cast<int%d_t>(bits)",
+                                  buffer_bit_count)
+                : absl::StrFormat(
+                      "static_cast<int%d_t>(static_cast<uint%d_t>(bits << "
+                      "%d)) >> %d",
+                      buffer_bit_count, buffer_bit_count, padding, padding);
+  }
+  if (!enum_name.empty()) {
+    value = absl::StrFormat("static_cast<%s>(%s)", CheckedCamelize(enum_name),
+                            value);
+  }
+  return absl::Substitute(kTemplate, std::string(indent_level * 2, ' '),
+                          src_address, dst_element, value, buffer_bit_count);
+}
+
+// Generates code for ToJitBuffer() logic for a bits value (of an integral or
+// enum member) to be stored at the address `dst_address`, zeroing its padding
+// bits.
+std::string GenerateBitsToJitBuffer(std::string_view src_element,
+                                    std::string_view dst_address,
+                                    int64_t bit_count, int indent_level) {
+  // $0: Indentation.
+  // $1: Source element.
+  // $2: Destination address.
+  // $3: Number of bits in the buffer.
+  // $4: Padding mask, if any.
+  constexpr std::string_view kTemplate = R"($0{
+$0  uint$3_t bits = static_cast<uint$3_t>($1)$4;
+$0  memcpy($2, &bits, sizeof(bits));
+$0})";
+
+  int64_t buffer_bit_count = GetJitBitsByteSize(bit_count) * 8;
+  std::string mask;
+  if (bit_count < buffer_bit_count) {
+    mask = absl::StrFormat(" & 0x%x", (uint64_t{1} << bit_count) - 1);
+  }
+  return absl::Substitute(kTemplate, std::string(indent_level * 2, ' '),
+                          src_element, dst_address, buffer_bit_count, mask);
+}
+
+// Generates code for either FromJitBuffer() (if `to_buffer` is false) or
+// ToJitBuffer() logic for the struct member `element` stored at the address
+// `address`.
+absl::StatusOr<std::string> GenerateMemberJitConversion(
+    const TranspileData& xpile_data, std::string_view element,
+    std::string_view address, TypeAnnotation* type, bool to_buffer,
+    int indent_level) {
+  XLS_ASSIGN_OR_RETURN(std::optional<BuiltinType> as_builtin_type,
+                       GetAsBuiltinType(xpile_data.module, xpile_data.type_info,
+                                        xpile_data.import_data, type));
+  if (as_builtin_type.has_value()) {
+    XLS_ASSIGN_OR_RETURN(bool is_signed,
+                         GetBuiltinTypeSignedness(as_builtin_type.value()));
+    XLS_ASSIGN_OR_RETURN(int64_t bit_count,
+                         GetBuiltinTypeBitCount(as_builtin_type.value()));
+    if (to_buffer) {
+      return GenerateBitsToJitBuffer(element, address, bit_count,
+                                     indent_level);
+    }
+    return GenerateBitsFromJitBuffer(address, element, bit_count, is_signed,
+                                     /*enum_name=*/"", indent_level);
+  }
+  if (auto* array_type = dynamic_cast<ArrayTypeAnnotation*>(type)) {
+    constexpr std::string_view kTemplate =
+        R"(%sfor (int i = 0; i < %d; i++) {
+%s
+%s})";
+    XLS_ASSIGN_OR_RETURN(
+        InterpValue array_dim_value,
+        InterpretExpr(xpile_data.import_data, xpile_data.type_info,
+                      array_type->dim(), /*env=*/{}));
+    if (array_dim_value.IsArray()) {
+      return absl::UnimplementedError(
+          "Only single-dimensional arrays are currently supported.");
+    }
+    XLS_ASSIGN_OR_RETURN(std::optional<int64_t> element_width,
+                         GetFieldWidth(xpile_data, array_type->element_type()));
+    if (!element_width.has_value()) {
+      return absl::UnimplementedError(
+          "Only scalars are currently supported as array elements.");
+    }
+    XLS_ASSIGN_OR_RETURN(
+        std::string copy,
+        GenerateMemberJitConversion(
+            xpile_data, absl::StrCat(element, "[i]"),
+            absl::StrFormat("%s + i * %d", address,
+                            GetJitBitsByteSize(element_width.value())),
+            array_type->element_type(), to_buffer, indent_level + 1));
+    std::string indent(indent_level * 2, ' ');
+    return absl::StrFormat(kTemplate, indent,
+                           array_dim_value.GetBitValueUint64().value(), copy,
+                           indent);
+  }
+  if (auto* typeref_type = dynamic_cast<TypeRefTypeAnnotation*>(type)) {
+    TypeDefinition type_definition =
+        typeref_type->type_ref()->type_definition();
+    if (std::holds_alternative<TypeDef*>(type_definition)) {
+      return GenerateMemberJitConversion(
+          xpile_data, element, address,
+          std::get<TypeDef*>(type_definition)->type_annotation(), to_buffer,
+          indent_level);
+    }
+    if (std::holds_alternative<EnumDef*>(type_definition)) {
+      EnumDef* enum_def = std::get<EnumDef*>(type_definition);
+      XLS_ASSIGN_OR_RETURN(
+          std::optional<BuiltinType> enum_as_builtin_type,
+          GetAsBuiltinType(xpile_data.module, xpile_data.type_info,
+                           xpile_data.import_data,
+                           enum_def->type_annotation()));
+      XLS_CHECK(enum_as_builtin_type.has_value());
+      XLS_ASSIGN_OR_RETURN(
+          bool is_signed,
+          GetBuiltinTypeSignedness(enum_as_builtin_type.value()));
+      XLS_ASSIGN_OR_RETURN(
+          int64_t bit_count,
+          GetBuiltinTypeBitCount(enum_as_builtin_type.value()));
+      if (to_buffer) {
+        return GenerateBitsToJitBuffer(element, address, bit_count,
+                                       indent_level);
+      }
+      return GenerateBitsFromJitBuffer(address, element, bit_count, is_signed,
+                                       enum_def->identifier(), indent_level);
+    }
+    if (std::holds_alternative<StructDef*>(type_definition)) {
+      std::string indent(indent_level * 2, ' ');
+      if (to_buffer) {
+        return absl::StrFormat("%s%s.ToJitBuffer(%s);", indent, element,
+                               address);
+      }
+      return absl::StrFormat("%s%s = %s::FromJitBuffer(%s);", indent, element,
+                             CheckedCamelize(type->ToString()), address);
+    }
+  }
+
+  return absl::UnimplementedError(absl::StrFormat(
+      "Unsupported type for transpilation: %s.", type->ToString()));
+}
+
+// Returns whether all the members of the struct are integral or enums, in
+// which case the struct is given helpers to convert spans of it to and from
+// struct-of-arrays form.
+absl::StatusOr<bool> HasOnlyScalarMembers(const TranspileData& xpile_data,
+                                          const StructDef* struct_def) {
+  for (const auto& [name_def, type] : struct_def->members()) {
+    XLS_ASSIGN_OR_RETURN(std::optional<int64_t> width,
+                         GetFieldWidth(xpile_data, type));
+    if (!width.has_value()) {
+      return false;
+    }
+  }
+  return !struct_def->members().empty();
+}
+
+// Generates the declarations of the JIT buffer (and struct-of-arrays)
+// conversions of a struct, see TranspileStructDefJitBody().
+absl::StatusOr<std::string> TranspileStructDefJitHeader(
+    const TranspileData& xpile_data, const StructDef* struct_def) {
+  // $0: name.
+  // $1: JIT byte size.
+  // $2: JIT alignment.
+  // $3: Struct-of-arrays declarations, if any.
+  constexpr std::string_view kTemplate = R"(
+
+  // Conversions to and from the native layout the XLS JIT uses for this type
+  // (see xls::LlvmTypeConverter), e.g. for the argument and result buffers of
+  // JIT-compiled functions. The padding bits of values are zeroed on writing;
+  // padding bytes between members are left as they are.
+  static constexpr int64_t kJitByteSize = $1;
+  static constexpr int64_t kJitAlignment = $2;
+  static $0 FromJitBuffer(const uint8_t* buffer);
+  void ToJitBuffer(uint8_t* buffer) const;
+
+  // As above, for arrays of this type, i.e., for elements kJitByteSize apart.
+  static void FromJitBuffer(const uint8_t* buffer, absl::Span<$0> values);
+  static void ToJitBuffer(absl::Span<const $0> values, uint8_t* buffer);$3)";
+
+  // $0: name.
+  // $1: Member columns.
+  constexpr std::string_view kColumnsTemplate = R"(
+
+  // The struct-of-arrays form of a span of this type.
+  struct Columns {
+$1
+  };
+  static Columns ToColumns(absl::Span<const $0> values);
+  static std::vector<$0> FromColumns(const Columns& columns);)";
+
+  std::string name = CheckedCamelize(struct_def->identifier());
+  XLS_ASSIGN_OR_RETURN(JitLayout layout,
+                       GetStructJitLayout(xpile_data, struct_def));
+  std::string columns;
+  XLS_ASSIGN_OR_RETURN(bool has_only_scalar_members,
+                       HasOnlyScalarMembers(xpile_data, struct_def));
+  if (has_only_scalar_members) {
+    std::vector<std::string> column_decls;
+    for (const auto& [name_def, type] : struct_def->members()) {
+      XLS_ASSIGN_OR_RETURN(std::string type_str,
+                           TypeAnnotationToString(xpile_data, type));
+      column_decls.push_back(
+          absl::StrFormat("    std::vector<%s> %s;", CheckedCamelize(type_str),
+                          name_def->identifier()));
+    }
+    columns = absl::Substitute(kColumnsTemplate, name,
+                               absl::StrJoin(column_decls, "\n"));
+  }
+  return absl::Substitute(kTemplate, name, layout.byte_size, layout.alignment,
+                          columns);
+}
+
+// Generates the definitions of the JIT buffer (and struct-of-arrays)
+// conversions of a struct.
+absl::StatusOr<std::string> TranspileStructDefJitBody(
+    const TranspileData& xpile_data, const StructDef* struct_def) {
+  // $0: name.
+  // $1: FromJitBuffer element setters.
+  // $2: ToJitBuffer element copies.
+  // $3: Struct-of-arrays definitions, if any.
+  constexpr std::string_view kTemplate =
+      R"($0 $0::FromJitBuffer(const uint8_t* buffer) {
+  $0 result;
+$1
+  return result;
+}
+
+void $0::ToJitBuffer(uint8_t* buffer) const {
+$2
+}
+
+void $0::FromJitBuffer(const uint8_t* buffer, absl::Span<$0> values) {
+  for (int64_t i = 0; i < values.size(); ++i) {
+    values[i] = FromJitBuffer(buffer + i * kJitByteSize);
+  }
+}
+
+void $0::ToJitBuffer(absl::Span<const $0> values, uint8_t* buffer) {
+  for (int64_t i = 0; i < values.size(); ++i) {
+    values[i].ToJitBuffer(buffer + i * kJitByteSize);
+  }
+}$3)";
+
+  // $0: name.
+  // $1: Column reservations.
+  // $2: Column appends.
+  // $3: Element setters.
+  // $4: First column.
+  constexpr std::string_view kColumnsTemplate = R"(
+
+$0::Columns $0::ToColumns(absl::Span<const $0> values) {
+  Columns columns;
+$1
+  for (const $0& value : values) {
+$2
+  }
+  return columns;
+}
+
+std::vector<$0> $0::FromColumns(const Columns& columns) {
+  std::vector<$0> values(columns.$4.size());
+  for (int64_t i = 0; i < values.size(); ++i) {
+$3
+  }
+  return values;
+})";
+
+  std::string name = CheckedCamelize(struct_def->identifier());
+  std::vector<int64_t> member_offsets;
+  XLS_RETURN_IF_ERROR(
+      GetStructJitLayout(xpile_data, struct_def, &member_offsets).status());
+  std::vector<std::string> from_buffer;
+  std::vector<std::string> to_buffer;
+  for (int i = 0; i < struct_def->members().size(); i++) {
+    std::string member_name = struct_def->members()[i].first->identifier();
+    TypeAnnotation* type = struct_def->members()[i].second;
+    std::string address = absl::StrCat("buffer + ", member_offsets[i]);
+    XLS_ASSIGN_OR_RETURN(
+        std::string from,
+        GenerateMemberJitConversion(xpile_data,
+                                    absl::StrCat("result.", member_name),
+                                    address, type, /*to_buffer=*/false,
+                                    /*indent_level=*/1));
+    from_buffer.push_back(from);
+    XLS_ASSIGN_OR_RETURN(
+        std::string to,
+        GenerateMemberJitConversion(xpile_data, member_name, address, type,
+                                    /*to_buffer=*/true, /*indent_level=*/1));
+    to_buffer.push_back(to);
+  }
+
+  std::string columns;
+  XLS_ASSIGN_OR_RETURN(bool has_only_scalar_members,
+                       HasOnlyScalarMembers(xpile_data, struct_def));
+  if (has_only_scalar_members) {
+    std::vector<std::string> reservations;
+    std::vector<std::string> appends;
+    std::vector<std::string> setters;
+    for (const auto& [name_def, type] : struct_def->members()) {
+      const std::string& member_name = name_def->identifier();
+      reservations.push_back(absl::Substitute(
+          "  columns.$0.reserve(values.size());", member_name));
+      appends.push_back(absl::Substitute(
+          "    columns.$0.push_back(value.$0);", member_name));
+      setters.push_back(absl::Substitute(
+          "    values[i].$0 = columns.$0[i];", member_name));
+    }
+    columns = absl::Substitute(
+        kColumnsTemplate, name, absl::StrJoin(reservations, "\n"),
+        absl::StrJoin(appends, "\n"), absl::StrJoin(setters, "\n"),
+        struct_def->members().front().first->identifier());
+  }
+  return absl::Substitute(kTemplate, name, absl::StrJoin(from_buffer, "\n"),
+                          absl::StrJoin(to_buffer, "\n"), columns);
+}
+
 // Should performance become an issue, optimizing struct layouts by reordering
 // (packing?) struct members could be considered.
 absl::StatusOr<std::string> TranspileStructDefHeader(
@@ -544,7 +961,7 @@ absl::StatusOr<std::string> TranspileStructDefHeader(
 
   friend std::ostream& operator<<(std::ostream& os, const $0& data);
 
-$1$2
+$1$2$3
 };)";
 
   std::string struct_body;
@@ -579,9 +996,15 @@ $1$2
   if (!width_block.empty()) {
     width_block = "\n\n" + width_block;
   }
+  std::string jit_block;
+  if (xpile_data.emit_jit_conversions) {
+    XLS_ASSIGN_OR_RETURN(jit_block,
+                         TranspileStructDefJitHeader(xpile_data, struct_def));
+  }
   return absl::Substitute(kStructTemplate,
                           CheckedCamelize(struct_def->identifier()),
-                          absl::StrJoin(member_decls, "\n"), width_block);
+                          absl::StrJoin(member_decls, "\n"), width_block,
+                          jit_block);
 }
 
 absl::StatusOr<std::string> TranspileStructDefBody(
@@ -610,7 +1033,7 @@ $3
   return xls::Value::Tuple(elements);
 }
 
-$4)";
+$4$5)";
 
   std::string struct_body;
   std::vector<std::string> setters;
@@ -634,11 +1057,18 @@ $4)";
                          TypeAnnotationToString(xpile_data, type));
   }
 
+  std::string jit_block;
+  if (xpile_data.emit_jit_conversions) {
+    XLS_ASSIGN_OR_RETURN(jit_block,
+                         TranspileStructDefJitBody(xpile_data, struct_def));
+    jit_block = "\n\n" + jit_block;
+  }
+
   std::string body = absl::Substitute(
       kStructTemplate, CheckedCamelize(struct_def->identifier()),
       struct_def->members().size(), absl::StrJoin(setters, "\n"),
       absl::StrJoin(to_values, "\n"),
-      GenerateOutputOperator(xpile_data, struct_def));
+      GenerateOutputOperator(xpile_data, struct_def), jit_block);
   return body;
 }
 
@@ -672,15 +1102,16 @@ absl::StatusOr<Sources> TranspileSingleToCpp(
 // Need paths
 absl::StatusOr<Sources> TranspileToCpp(Module* module, ImportData* import_data,
                                        std::string_view output_header_path,
-                                       std::string namespaces) {
+                                       std::string namespaces,
+                                       bool emit_jit_conversions) {
   constexpr std::string_view kHeaderTemplate =
       R"(// AUTOMATICALLY GENERATED FILE. DO NOT EDIT!
 #ifndef $0
 #define $0
 #include <cstdint>
-#include <ostream>
+#include <ostream>$4
 
-#include "absl/status/statusor.h"
+#include "absl/status/statusor.h"$5
 #include "xls/public/value.h"
 
 $2$1$3
@@ -690,7 +1121,7 @@ $2$1$3
 
   constexpr std::string_view kSourceTemplate =
       R"(// AUTOMATICALLY GENERATED FILE. DO NOT EDIT!
-#include <vector>
+%s#include <vector>
 
 #include "%s"
 #include "absl/base/macros.h"
@@ -702,7 +1133,7 @@ $2$1$3
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        import_data->GetRootTypeInfo(module));
   struct TranspileData xpile_data {
-    module, type_info, import_data
+    module, type_info, import_data, emit_jit_conversions
   };
 
   std::vector<std::string> header;
@@ -730,11 +1161,24 @@ $2$1$3
     namespace_end = absl::StrCat("\n\n}  // namespace ", namespaces);
   }
 
-  return Sources{absl::Substitute(kHeaderTemplate, header_guard,
-                                  absl::StrJoin(header, "\n\n"),
-                                  namespace_begin, namespace_end),
-                 absl::StrFormat(kSourceTemplate, output_header_path,
-                                 absl::StrJoin(body, "\n\n"))};
+  // The JIT conversions take spans, make struct-of-arrays vectors and copy with
+  // memcpy.
+  std::string header_std_includes;
+  std::string header_absl_includes;
+  std::string source_std_includes;
+  if (emit_jit_conversions) {
+    header_std_includes = "\n#include <vector>";
+    header_absl_includes = "\n#include \"absl/types/span.h\"";
+    source_std_includes = "#include <cstring>\n";
+  }
+
+  return Sources{
+      absl::Substitute(kHeaderTemplate, header_guard,
+                       absl::StrJoin(header, "\n\n"), namespace_begin,
+                       namespace_end, header_std_includes,
+                       header_absl_includes),
+      absl::StrFormat(kSourceTemplate, source_std_includes, output_header_path,
+                      absl::StrJoin(body, "\n\n"))};
 }
 
 }  // namespace xls::dslx
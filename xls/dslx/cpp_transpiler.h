@@ -49,9 +49,15 @@ struct Sources {
   std::string body;
 };
 
+// If `emit_jit_conversions` is set, structs are also given conversions to and
+// from the native layout of the XLS JIT (see xls::LlvmTypeConverter), for
+// single values and arrays of them, which bypass xls::Value. Structs with only
+// integral and enum members also get conversions of spans of them to and from
+// struct-of-arrays form.
 absl::StatusOr<Sources> TranspileToCpp(Module* module, ImportData* import_data,
                                        std::string_view output_header_path,
-                                       std::string namespaces = "");
+                                       std::string namespaces = "",
+                                       bool emit_jit_conversions = false);
 
 }  // namespace xls::dslx
 
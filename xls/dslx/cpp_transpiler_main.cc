@@ -36,6 +36,9 @@ ABSL_FLAG(std::string, namespaces, "",
           "\"::my::explicitly::top::level::namespace\".");
 ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
           "Path to DSLX standard library");
+ABSL_FLAG(bool, emit_jit_conversions, false,
+          "Whether to give structs conversions to and from the native layout "
+          "of the XLS JIT, which bypass xls::Value.");
 
 namespace xls {
 namespace dslx {
@@ -53,7 +56,8 @@ absl::Status RealMain(const std::filesystem::path& module_path,
                       const std::filesystem::path& dslx_stdlib_path,
                       std::string_view output_header_path,
                       std::string_view output_source_path,
-                      std::string_view namespaces) {
+                      std::string_view namespaces,
+                      bool emit_jit_conversions) {
   XLS_ASSIGN_OR_RETURN(std::string module_text, GetFileContents(module_path));
 
   ImportData import_data(
@@ -64,7 +68,7 @@ absl::Status RealMain(const std::filesystem::path& module_path,
   XLS_ASSIGN_OR_RETURN(
       Sources sources,
       TranspileToCpp(module.module, &import_data, output_header_path,
-                     std::string(namespaces)));
+                     std::string(namespaces), emit_jit_conversions));
 
   XLS_RETURN_IF_ERROR(SetFileContents(output_header_path, sources.header));
   XLS_RETURN_IF_ERROR(SetFileContents(output_source_path, sources.body));
@@ -88,7 +92,8 @@ int main(int argc, char* argv[]) {
       << "--output_source_path must be specified.";
   XLS_QCHECK_OK(xls::dslx::RealMain(
       args[0], absl::GetFlag(FLAGS_dslx_stdlib_path), output_header_path,
-      output_source_path, absl::GetFlag(FLAGS_namespaces)));
+      output_source_path, absl::GetFlag(FLAGS_namespaces),
+      absl::GetFlag(FLAGS_emit_jit_conversions)));
 
   return 0;
 }
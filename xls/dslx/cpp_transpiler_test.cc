@@ -23,6 +23,9 @@
 namespace xls::dslx {
 namespace {
 
+using ::testing::HasSubstr;
+using ::testing::Not;
+
 // Verifies that the transpiler can convert a basic enum into C++.
 TEST(CppTranspilerTest, BasicEnums) {
   const std::string kModule = R"(
@@ -836,5 +839,104 @@ constexpr int64_t kMyEnumNumElements = 4;
   ASSERT_EQ(result.header, kExpected);
 }
 
+// Verifies the conversions to and from the JIT's native layout, in which e.g.
+// the members of Outer are at offsets 0, 4, 6, 10 and 16.
+TEST(CppTranspilerTest, JitConversions) {
+  const std::string kModule = R"(
+pub enum MyEnum : u2 {
+  A = 0,
+  B = 1,
+}
+
+struct Inner {
+  a: u15,
+  b: s5,
+}
+
+struct Outer {
+  x: u32,
+  e: MyEnum,
+  inner: Inner,
+  arr: u8[3],
+  w: s63,
+}
+)";
+
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule module,
+      ParseAndTypecheck(kModule, "fake_path", "MyModule", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto result, TranspileToCpp(module.module, &import_data, "fake_path.h",
+                                  /*namespaces=*/"",
+                                  /*emit_jit_conversions=*/true));
+
+  EXPECT_THAT(result.header, HasSubstr(R"(#include <ostream>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+)"));
+  EXPECT_THAT(result.header, HasSubstr(R"(
+  static constexpr int64_t kJitByteSize = 4;
+  static constexpr int64_t kJitAlignment = 2;
+  static Inner FromJitBuffer(const uint8_t* buffer);
+  void ToJitBuffer(uint8_t* buffer) const;
+)"));
+  EXPECT_THAT(result.header, HasSubstr(R"(
+  struct Columns {
+    std::vector<uint16_t> a;
+    std::vector<int8_t> b;
+  };
+  static Columns ToColumns(absl::Span<const Inner> values);
+  static std::vector<Inner> FromColumns(const Columns& columns);
+)"));
+  EXPECT_THAT(result.header, HasSubstr(R"(
+  static constexpr int64_t kJitByteSize = 24;
+  static constexpr int64_t kJitAlignment = 8;
+)"));
+  // Outer has non-scalar members, so has no struct-of-arrays form.
+  EXPECT_THAT(result.header,
+              Not(HasSubstr("ToColumns(absl::Span<const Outer> values)")));
+
+  EXPECT_THAT(result.body, HasSubstr(R"(#include <cstring>
+#include <vector>
+)"));
+  // Signed values are sign extended from, and masked to, their width.
+  EXPECT_THAT(result.body, HasSubstr(R"(  {
+    uint8_t bits;
+    memcpy(&bits, buffer + 2, sizeof(bits));
+    result.b = static_cast<int8_t>(static_cast<uint8_t>(bits << 3)) >> 3;
+  })"));
+  EXPECT_THAT(result.body, HasSubstr(R"(  {
+    uint8_t bits = static_cast<uint8_t>(b) & 0x1f;
+    memcpy(buffer + 2, &bits, sizeof(bits));
+  })"));
+  EXPECT_THAT(result.body, HasSubstr(R"(  {
+    uint8_t bits;
+    memcpy(&bits, buffer + 4, sizeof(bits));
+    result.e = static_cast<MyEnum>(bits);
+  }
+  result.inner = Inner::FromJitBuffer(buffer + 6);
+  for (int i = 0; i < 3; i++) {
+    {
+      uint8_t bits;
+      memcpy(&bits, buffer + 10 + i * 1, sizeof(bits));
+      result.arr[i] = bits;
+    }
+  })"));
+  EXPECT_THAT(result.body, HasSubstr(R"(  inner.ToJitBuffer(buffer + 6);)"));
+  EXPECT_THAT(result.body, HasSubstr(R"(  {
+    uint64_t bits = static_cast<uint64_t>(w) & 0x7fffffffffffffff;
+    memcpy(buffer + 16, &bits, sizeof(bits));
+  })"));
+  EXPECT_THAT(result.body, HasSubstr(R"(
+void Outer::ToJitBuffer(absl::Span<const Outer> values, uint8_t* buffer) {
+  for (int64_t i = 0; i < values.size(); ++i) {
+    values[i].ToJitBuffer(buffer + i * kJitByteSize);
+  }
+})"));
+}
+
 }  // namespace
 }  // namespace xls::dslx
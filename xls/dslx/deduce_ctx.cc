@@ -42,6 +42,22 @@ DeduceCtx::DeduceCtx(TypeInfo* type_info, Module* module,
       import_data_(import_data),
       warnings_(warnings) {}
 
+std::optional<TypeInfo*> DeduceCtx::GetInstantiationTypeInfo(
+    const Function* f, const SymbolicBindings& bindings) const {
+  auto it = instantiations_->find(std::make_pair(f, bindings));
+  if (it == instantiations_->end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+void DeduceCtx::NoteInstantiationTypeInfo(const Function* f,
+                                          SymbolicBindings bindings,
+                                          TypeInfo* type_info) {
+  instantiations_->insert_or_assign(std::make_pair(f, std::move(bindings)),
+                                    type_info);
+}
+
 // Helper that converts the symbolic bindings to a parametric expression
 // environment (for parametric evaluation).
 ParametricExpression::Env ToParametricEnv(
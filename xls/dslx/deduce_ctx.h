@@ -16,12 +16,17 @@
 #define XLS_DSLX_DEDUCE_CTX_H_
 
 #include <filesystem>
+#include <memory>
+#include <optional>
+#include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/dslx/concrete_type.h"
 #include "xls/dslx/import_routines.h"
 #include "xls/dslx/interp_bindings.h"
+#include "xls/dslx/symbolic_bindings.h"
 #include "xls/dslx/type_and_bindings.h"
 #include "xls/dslx/warning_collector.h"
 
@@ -111,9 +116,11 @@ class DeduceCtx {
   // Note that the resulting DeduceCtx has an empty fn_stack.
   std::unique_ptr<DeduceCtx> MakeCtx(TypeInfo* new_type_info,
                                      Module* new_module) const {
-    return std::make_unique<DeduceCtx>(
+    auto ctx = std::make_unique<DeduceCtx>(
         new_type_info, new_module, deduce_function_, typecheck_function_,
         typecheck_module_, typecheck_invocation_, import_data_, warnings_);
+    ctx->instantiations_ = instantiations_;
+    return ctx;
   }
 
   // Helper that calls back to the top-level deduce procedure for the given
@@ -186,6 +193,20 @@ class DeduceCtx {
     return import_data_->type_info_owner();
   }
 
+  // Returns the derived type information an earlier invocation of `f` with
+  // the given bindings was typechecked into, if any.
+  //
+  // Instantiations are shared by this context and the contexts made from it
+  // (see MakeCtx()), i.e. across a single module typecheck, so the type
+  // information handed out is always created by that typecheck.
+  std::optional<TypeInfo*> GetInstantiationTypeInfo(
+      const Function* f, const SymbolicBindings& bindings) const;
+
+  // Notes that the body of `f` has been typechecked into `type_info` for the
+  // given bindings, see GetInstantiationTypeInfo().
+  void NoteInstantiationTypeInfo(const Function* f, SymbolicBindings bindings,
+                                 TypeInfo* type_info);
+
   bool in_typeless_number_ctx() const { return in_typeless_number_ctx_; }
   void set_in_typeless_number_ctx(bool in_typeless_number_ctx) {
     in_typeless_number_ctx_ = in_typeless_number_ctx;
@@ -213,6 +234,14 @@ class DeduceCtx {
   // Object used for collecting warnings flagged in the type checking process.
   WarningCollector* warnings_;
 
+  // Parametric instantiations typechecked so far, see
+  // GetInstantiationTypeInfo().
+  using InstantiationMap =
+      absl::flat_hash_map<std::pair<const Function*, SymbolicBindings>,
+                          TypeInfo*>;
+  std::shared_ptr<InstantiationMap> instantiations_ =
+      std::make_shared<InstantiationMap>();
+
   // Set to true if this context is deducing inside a For AST node. It is
   // necessary to disable constexpr evaluation during that time, as a given
   // NameDef will have multiple values associated with it, and so constexpr
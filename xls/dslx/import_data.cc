@@ -25,6 +25,7 @@ namespace xls::dslx {
 }
 
 absl::StatusOr<ModuleInfo*> ImportData::Get(const ImportTokens& subject) {
+  absl::MutexLock lock(mutex_.get());
   auto it = modules_.find(subject);
   if (it == modules_.end()) {
     return absl::NotFoundError("Module information was not found for import " +
@@ -35,6 +36,7 @@ absl::StatusOr<ModuleInfo*> ImportData::Get(const ImportTokens& subject) {
 
 absl::StatusOr<ModuleInfo*> ImportData::Put(
     const ImportTokens& subject, std::unique_ptr<ModuleInfo> module_info) {
+  absl::MutexLock lock(mutex_.get());
   auto* pmodule_info = module_info.get();
   auto [it, inserted] = modules_.emplace(subject, std::move(module_info));
   if (!inserted) {
@@ -45,6 +47,11 @@ absl::StatusOr<ModuleInfo*> ImportData::Put(
   return pmodule_info;
 }
 
+void ImportData::RetainAbandonedModule(std::unique_ptr<Module> module) {
+  absl::MutexLock lock(mutex_.get());
+  abandoned_modules_.push_back(std::move(module));
+}
+
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfoForNode(
     const AstNode* node) {
   XLS_RET_CHECK(node != nullptr);
@@ -56,6 +63,7 @@ absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfo(const Module* module) {
 }
 
 InterpBindings& ImportData::GetOrCreateTopLevelBindings(Module* module) {
+  absl::MutexLock lock(mutex_.get());
   auto it = top_level_bindings_.find(module);
   if (it == top_level_bindings_.end()) {
     it = top_level_bindings_
@@ -68,6 +76,7 @@ InterpBindings& ImportData::GetOrCreateTopLevelBindings(Module* module) {
 
 void ImportData::SetTopLevelBindings(Module* module,
                                      std::unique_ptr<InterpBindings> tlb) {
+  absl::MutexLock lock(mutex_.get());
   auto it = top_level_bindings_.emplace(module, std::move(tlb));
   XLS_CHECK(it.second) << "Module already had top level bindings: "
                        << module->name();
@@ -82,6 +91,15 @@ BytecodeCacheInterface* ImportData::bytecode_cache() {
   return bytecode_cache_.get();
 }
 
+void ImportData::SetTypeInfoCache(
+    std::unique_ptr<TypeInfoCacheInterface> type_info_cache) {
+  type_info_cache_ = std::move(type_info_cache);
+}
+
+TypeInfoCacheInterface* ImportData::type_info_cache() {
+  return type_info_cache_.get();
+}
+
 absl::StatusOr<const EnumDef*> ImportData::FindEnumDef(const Span& span) const {
   XLS_ASSIGN_OR_RETURN(const Module* module, FindModule(span));
   const EnumDef* enum_def = module->FindEnumDef(span);
@@ -106,6 +124,7 @@ absl::StatusOr<const StructDef*> ImportData::FindStructDef(
 }
 
 absl::StatusOr<const Module*> ImportData::FindModule(const Span& span) const {
+  absl::MutexLock lock(mutex_.get());
   auto it = path_to_module_info_.find(span.filename());
   if (it == path_to_module_info_.end()) {
     std::vector<std::string> paths;
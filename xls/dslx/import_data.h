@@ -18,11 +18,13 @@
 #include <filesystem>
 #include <memory>
 
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/ast.h"
 #include "xls/dslx/bytecode_cache_interface.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/interp_bindings.h"
 #include "xls/dslx/type_info.h"
+#include "xls/dslx/type_info_cache_interface.h"
 
 namespace xls::dslx {
 
@@ -93,12 +95,16 @@ class ImportTokens {
 // Wrapper around a {subject: module_info} mapping that modules can be imported
 // into.
 // Use the routines in create_import_data.h to instantiate an object.
+//
+// Thread-safe: independent imports may be typechecked concurrently against the
+// same ImportData (see CheckModule).
 class ImportData {
  public:
   // All instantiations of ImportData should pass a stdlib_path as below.
   ImportData() = delete;
 
   bool Contains(const ImportTokens& target) const {
+    absl::MutexLock lock(mutex_.get());
     return modules_.find(target) != modules_.end();
   }
 
@@ -107,6 +113,11 @@ class ImportData {
   absl::StatusOr<ModuleInfo*> Put(const ImportTokens& subject,
                                   std::unique_ptr<ModuleInfo> module_info);
 
+  // Takes ownership of a module whose typechecking was started but abandoned
+  // (e.g. a concurrently typechecked import which failed), so that the type
+  // information created for it stays valid for the lifetime of this object.
+  void RetainAbandonedModule(std::unique_ptr<Module> module);
+
   TypeInfoOwner& type_info_owner() { return type_info_owner_; }
 
   // Helper that gets the "root" type information for the module of the given
@@ -130,12 +141,14 @@ class ImportData {
   // work-in-progress. "node" may be set as nullptr when done with the entire
   // module.
   void SetTypecheckWorkInProgress(Module* module, AstNode* node) {
+    absl::MutexLock lock(mutex_.get());
     typecheck_wip_[module] = node;
   }
 
   // Retrieves which node was noted as currently work-in-progress, getter for
   // SetTypecheckWorkInProgress() above.
   AstNode* GetTypecheckWorkInProgress(Module* module) {
+    absl::MutexLock lock(mutex_.get());
     return typecheck_wip_[module];
   }
 
@@ -145,9 +158,11 @@ class ImportData {
   // hitting a work-in-progress indicator) those completed bindings can be
   // re-used after that without any need for re-evaluation.
   bool IsTopLevelBindingsDone(Module* module) const {
+    absl::MutexLock lock(mutex_.get());
     return top_level_bindings_done_.contains(module);
   }
   void MarkTopLevelBindingsDone(Module* module) {
+    absl::MutexLock lock(mutex_.get());
     top_level_bindings_done_.insert(module);
   }
 
@@ -159,6 +174,12 @@ class ImportData {
   void SetBytecodeCache(std::unique_ptr<BytecodeCacheInterface> bytecode_cache);
   BytecodeCacheInterface* bytecode_cache();
 
+  // The persistent type information cache consulted when importing modules
+  // (see DoImport()); nullptr unless one has been set.
+  void SetTypeInfoCache(
+      std::unique_ptr<TypeInfoCacheInterface> type_info_cache);
+  TypeInfoCacheInterface* type_info_cache();
+
   // Helpers for finding nodes in the cluster of modules managed by this object.
   //
   // These return a NotFound error if _either_ the module (implicitly
@@ -190,6 +211,7 @@ class ImportData {
 
   absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>> modules_;
   absl::flat_hash_map<std::string, ModuleInfo*> path_to_module_info_;
+  std::vector<std::unique_ptr<Module>> abandoned_modules_;
   absl::flat_hash_map<Module*, std::unique_ptr<InterpBindings>>
       top_level_bindings_;
   absl::flat_hash_set<Module*> top_level_bindings_done_;
@@ -198,6 +220,12 @@ class ImportData {
   std::string stdlib_path_;
   absl::Span<const std::filesystem::path> additional_search_paths_;
   std::unique_ptr<BytecodeCacheInterface> bytecode_cache_;
+  std::unique_ptr<TypeInfoCacheInterface> type_info_cache_;
+
+  // Guards the module and binding maps above (the type info owner and bytecode
+  // cache synchronize themselves; the type info cache is only consulted by
+  // serial imports). Held by pointer so ImportData stays movable.
+  std::unique_ptr<absl::Mutex> mutex_ = std::make_unique<absl::Mutex>();
 };
 
 }  // namespace xls::dslx
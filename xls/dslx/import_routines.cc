@@ -14,8 +14,17 @@
 
 #include "xls/dslx/import_routines.h"
 
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/types/span.h"
 #include "xls/common/config/xls_config.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
@@ -120,17 +129,18 @@ static absl::StatusOr<std::filesystem::path> FindExistingPath(
                       GetCurrentDirectory().value(), stdlib_path));
 }
 
-absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
-                                     const ImportTokens& subject,
-                                     ImportData* import_data,
-                                     const Span& import_span) {
-  XLS_RET_CHECK(import_data != nullptr);
-  if (import_data->Contains(subject)) {
-    return import_data->Get(subject);
-  }
-
-  XLS_VLOG(3) << "DoImport (uncached) subject: " << subject.ToString();
+// A module which has been located and parsed, along with the path it was found
+// at and its text.
+struct ParsedModule {
+  std::filesystem::path path;
+  std::string contents;
+  std::unique_ptr<Module> module;
+};
 
+// Locates and parses the module identified by "subject".
+static absl::StatusOr<ParsedModule> ParseImport(const ImportTokens& subject,
+                                                ImportData* import_data,
+                                                const Span& import_span) {
   XLS_ASSIGN_OR_RETURN(
       std::filesystem::path found_path,
       FindExistingPath(subject, import_data->stdlib_path(),
@@ -139,16 +149,127 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
 
   absl::Span<std::string const> pieces = subject.pieces();
   std::string fully_qualified_name = absl::StrJoin(pieces, ".");
-  XLS_VLOG(3) << "Parsing and typechecking " << fully_qualified_name
-              << ": start";
+  XLS_VLOG(3) << "Parsing " << fully_qualified_name;
 
   Scanner scanner(found_path, contents);
   Parser parser(/*module_name=*/fully_qualified_name, &scanner);
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
-  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
+  return ParsedModule{std::move(found_path), std::move(contents),
+                      std::move(module)};
+}
+
+// Imports the modules which "module" imports, as the type information cache
+// validates (and restores) its entries against them. Returns false if any of
+// them fails to import, in which case typechecking "module" reports the error.
+static bool ImportDependencies(const TypecheckModuleFn& ftypecheck,
+                               const Module& module, ImportData* import_data,
+                               WarningCollector* warnings) {
+  for (const ModuleMember& member : module.top()) {
+    if (!std::holds_alternative<Import*>(member)) {
+      continue;
+    }
+    Import* import = std::get<Import*>(member);
+    if (!DoImport(ftypecheck, ImportTokens(import->subject()), import_data,
+                  import->span(), warnings)
+             .ok()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
+                                     const ImportTokens& subject,
+                                     ImportData* import_data,
+                                     const Span& import_span,
+                                     WarningCollector* warnings) {
+  XLS_RET_CHECK(import_data != nullptr);
+  if (import_data->Contains(subject)) {
+    return import_data->Get(subject);
+  }
+
+  XLS_VLOG(3) << "DoImport (uncached) subject: " << subject.ToString();
+
+  XLS_ASSIGN_OR_RETURN(ParsedModule parsed,
+                       ParseImport(subject, import_data, import_span));
+  TypeInfoCacheInterface* cache =
+      warnings == nullptr ? nullptr : import_data->type_info_cache();
+  if (cache != nullptr &&
+      ImportDependencies(ftypecheck, *parsed.module, import_data, warnings)) {
+    std::optional<TypeInfo*> type_info =
+        cache->Lookup(subject.pieces(), parsed.path, parsed.contents,
+                      parsed.module.get(), import_data, warnings);
+    if (type_info.has_value()) {
+      return import_data->Put(
+          subject,
+          std::make_unique<ModuleInfo>(std::move(parsed.module),
+                                       type_info.value(),
+                                       std::move(parsed.path)));
+    }
+  }
+  int64_t warning_count = warnings == nullptr ? 0 : warnings->warnings().size();
+  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(parsed.module.get()));
+  if (cache != nullptr) {
+    cache->Insert(parsed.module.get(), type_info,
+                  absl::MakeConstSpan(warnings->warnings())
+                      .subspan(warning_count),
+                  import_data);
+  }
   return import_data->Put(
-      subject, std::make_unique<ModuleInfo>(std::move(module), type_info,
-                                            std::move(found_path)));
+      subject, std::make_unique<ModuleInfo>(std::move(parsed.module),
+                                            type_info, std::move(parsed.path)));
+}
+
+absl::StatusOr<std::vector<ParsedImport>> ParseImportGraph(
+    const Module& module, ImportData* import_data) {
+  XLS_RET_CHECK(import_data != nullptr);
+  std::vector<ParsedImport> result;
+  // Index into "result" of each module which has been completely visited, and
+  // the subjects on the current import path (for cycle detection).
+  absl::flat_hash_map<ImportTokens, int64_t> visited;
+  absl::flat_hash_set<ImportTokens> on_path;
+
+  // Visits the imports of "importer" in member order, returning the indices of
+  // those which need typechecking.
+  std::function<absl::StatusOr<std::vector<int64_t>>(const Module&)>
+      visit_imports;
+  visit_imports =
+      [&](const Module& importer) -> absl::StatusOr<std::vector<int64_t>> {
+    std::vector<int64_t> imports;
+    for (const ModuleMember& member : importer.top()) {
+      if (!std::holds_alternative<Import*>(member)) {
+        continue;
+      }
+      Import* import = std::get<Import*>(member);
+      ImportTokens subject(import->subject());
+      if (import_data->Contains(subject)) {
+        continue;
+      }
+      if (auto it = visited.find(subject); it != visited.end()) {
+        imports.push_back(it->second);
+        continue;
+      }
+      if (on_path.contains(subject)) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("ImportError: %s Import cycle detected via %s",
+                            import->span().ToString(), subject.ToString()));
+      }
+      XLS_ASSIGN_OR_RETURN(ParsedModule parsed,
+                           ParseImport(subject, import_data, import->span()));
+      on_path.insert(subject);
+      XLS_ASSIGN_OR_RETURN(std::vector<int64_t> imported_imports,
+                           visit_imports(*parsed.module));
+      on_path.erase(subject);
+      visited[subject] = result.size();
+      imports.push_back(result.size());
+      result.push_back(ParsedImport{subject, std::move(parsed.path),
+                                    std::move(parsed.module),
+                                    std::move(imported_imports)});
+    }
+    return imports;
+  };
+  XLS_RETURN_IF_ERROR(visit_imports(module).status());
+  return result;
 }
 
 }  // namespace xls::dslx
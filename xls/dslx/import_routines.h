@@ -16,11 +16,14 @@
 #define XLS_DSLX_IMPORT_ROUTINES_H_
 
 #include <filesystem>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "xls/dslx/ast.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/type_info.h"
+#include "xls/dslx/warning_collector.h"
 
 namespace xls::dslx {
 
@@ -41,13 +44,39 @@ using TypecheckModuleFn = std::function<absl::StatusOr<TypeInfo*>(Module*)>;
 //      fully qualified like ('xls', 'lib', 'math').
 //  cache: Cache that we resolve against so we don't waste resources
 //      re-importing things in the import DAG.
+//  warnings: Where the warnings flagged by "ftypecheck" are collected. When
+//      given, the persistent type information cache of "import_data" (if any)
+//      is consulted before typechecking the module, and replays the warnings
+//      of modules it restores.
 //
 // Returns:
 //  The imported module information.
 absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const ImportTokens& subject,
                                      ImportData* import_data,
-                                     const Span& import_span);
+                                     const Span& import_span,
+                                     WarningCollector* warnings = nullptr);
+
+// A module found by ParseImportGraph which has been parsed but not yet
+// typechecked.
+struct ParsedImport {
+  ImportTokens subject;
+  std::filesystem::path path;
+  std::unique_ptr<Module> module;
+  // Indices into the ParseImportGraph result of the modules this module
+  // imports directly (those not already present in the import data).
+  std::vector<int64_t> imports;
+};
+
+// Locates and parses the transitive imports of "module" which are not yet
+// present in "import_data", without typechecking them.
+//
+// The result is in the order DoImport would typecheck the modules when
+// importing serially (a post-order of the import DAG), so every module follows
+// the modules it imports. Returns an error if an import cannot be found or
+// parsed, or if the imports form a cycle.
+absl::StatusOr<std::vector<ParsedImport>> ParseImportGraph(
+    const Module& module, ImportData* import_data);
 
 }  // namespace xls::dslx
 
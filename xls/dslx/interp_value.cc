@@ -197,6 +197,10 @@ std::string InterpValue::ToString(bool humanize,
 
 bool InterpValue::Eq(const InterpValue& other) const {
   auto values_equal = [&] {
+    if (std::get<Elements>(payload_).SharesStorageWith(
+            std::get<Elements>(other.payload_))) {
+      return true;
+    }
     const std::vector<InterpValue>& lhs = GetValuesOrDie();
     const std::vector<InterpValue>& rhs = other.GetValuesOrDie();
     if (lhs.size() != rhs.size()) {
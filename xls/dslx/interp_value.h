@@ -16,6 +16,8 @@
 #define XLS_DSLX_INTERP_VALUE_H_
 
 #include <deque>
+#include <memory>
+#include <vector>
 
 #include "xls/dslx/ast.h"
 #include "xls/ir/bits.h"
@@ -289,13 +291,13 @@ class InterpValue {
   InterpValueTag tag() const { return tag_; }
 
   absl::StatusOr<const std::vector<InterpValue>*> GetValues() const {
-    if (!std::holds_alternative<std::vector<InterpValue>>(payload_)) {
+    if (!std::holds_alternative<Elements>(payload_)) {
       return absl::InvalidArgumentError("Value does not hold element values");
     }
-    return &std::get<std::vector<InterpValue>>(payload_);
+    return &std::get<Elements>(payload_).values();
   }
   const std::vector<InterpValue>& GetValuesOrDie() const {
-    return std::get<std::vector<InterpValue>>(payload_);
+    return std::get<Elements>(payload_).values();
   }
   absl::StatusOr<const FnData*> GetFunction() const {
     if (!std::holds_alternative<FnData>(payload_)) {
@@ -337,7 +339,7 @@ class InterpValue {
   }
 
   bool HasValues() const {
-    return std::holds_alternative<std::vector<InterpValue>>(payload_);
+    return std::holds_alternative<Elements>(payload_);
   }
 
   bool IsToken() const { return tag_ == InterpValueTag::kToken; }
@@ -372,9 +374,30 @@ class InterpValue {
   //
   // TODO(leary): 2020-02-10 When all Python bindings are eliminated we can more
   // easily make an interpreter scoped lifetime that InterpValues can live in.
-  using Payload =
-      std::variant<Bits, EnumData, std::vector<InterpValue>, FnData,
-                   std::shared_ptr<TokenData>, std::shared_ptr<Channel>>;
+  // Element values of a tuple or array. InterpValues are immutable, so copies
+  // of an aggregate share its elements rather than deep copying them; this
+  // keeps moving aggregates between interpreter slots and the stack cheap.
+  class Elements {
+   public:
+    // Implicit so that element vectors convert directly to a Payload.
+    Elements(std::vector<InterpValue> values)  // NOLINT
+        : values_(std::make_shared<const std::vector<InterpValue>>(
+              std::move(values))) {}
+
+    const std::vector<InterpValue>& values() const { return *values_; }
+
+    // Returns true if this and `other` refer to the same element storage.
+    bool SharesStorageWith(const Elements& other) const {
+      return values_ == other.values_;
+    }
+
+   private:
+    std::shared_ptr<const std::vector<InterpValue>> values_;
+  };
+
+  using Payload = std::variant<Bits, EnumData, Elements, FnData,
+                               std::shared_ptr<TokenData>,
+                               std::shared_ptr<Channel>>;
 
   InterpValue(InterpValueTag tag, Payload payload)
       : tag_(tag), payload_(std::move(payload)) {}
@@ -150,6 +150,28 @@ TEST(InterpValueTest, ArrayOfU32HumanStr) {
   EXPECT_EQ(array->ToHumanString(), "[2, 3, 4]");
 }
 
+TEST(InterpValueTest, CopiesShareElements) {
+  InterpValue tuple = InterpValue::MakeTuple(
+      {InterpValue::MakeU32(2),
+       InterpValue::MakeTuple({InterpValue::MakeU32(3)})});
+  InterpValue copy = tuple;
+  EXPECT_EQ(&tuple.GetValuesOrDie(), &copy.GetValuesOrDie());
+  EXPECT_EQ(tuple, copy);
+
+  // Updating a copy leaves the original's elements alone.
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue array,
+                           InterpValue::MakeArray({InterpValue::MakeU32(2),
+                                                   InterpValue::MakeU32(3)}));
+  InterpValue array_copy = array;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue updated,
+      array_copy.Update(InterpValue::MakeU32(0), InterpValue::MakeU32(7)));
+  EXPECT_NE(&updated.GetValuesOrDie(), &array.GetValuesOrDie());
+  EXPECT_EQ(array.GetValuesOrDie()[0], InterpValue::MakeU32(2));
+  EXPECT_EQ(updated.GetValuesOrDie()[0], InterpValue::MakeU32(7));
+  EXPECT_EQ(array, array_copy);
+}
+
 TEST(InterpValueTest, TestPredicates) {
   auto false_value = InterpValue::MakeBool(false);
   EXPECT_TRUE(false_value.IsFalse());
@@ -42,6 +42,18 @@ ABSL_FLAG(std::string, test_filter, "",
           "Target (currently *single*) test name to run.");
 ABSL_FLAG(bool, warnings_as_errors, true,
           "Whether to fail early, as an error, if warnings are detected");
+ABSL_FLAG(bool, execute_on_jit, false,
+          "Run test functions on the JIT by converting them to IR; tests which "
+          "cannot be converted run on the bytecode interpreter.");
+ABSL_FLAG(std::string, type_info_cache_dir, "",
+          "Directory in which to cache the type information of imported "
+          "modules across invocations; empty to not cache.");
+ABSL_FLAG(int64_t, test_threads, 1,
+          "Number of threads on which to run unit tests and quickcheck "
+          "samples.");
+ABSL_FLAG(std::string, bytecode_cache_dir, "",
+          "Directory in which to cache the bytecode emitted for tests across "
+          "invocations; empty to not cache.");
 // LINT.ThenChange(//xls/build_rules/xls_dslx_rules.bzl)
 
 namespace xls::dslx {
@@ -62,7 +74,11 @@ absl::Status RealMain(std::string_view entry_module_path,
                       std::optional<std::string> test_filter,
                       FormatPreference trace_format_preference,
                       CompareFlag compare_flag, bool execute,
-                      bool warnings_as_errors, std::optional<int64_t> seed,
+                      bool warnings_as_errors, bool execute_on_jit,
+                      std::optional<int64_t> seed,
+                      std::optional<std::string> type_info_cache_dir,
+                      int64_t test_threads,
+                      std::optional<std::string> bytecode_cache_dir,
                       bool* printed_error) {
   XLS_ASSIGN_OR_RETURN(std::string program, GetFileContents(entry_module_path));
   XLS_ASSIGN_OR_RETURN(std::string module_name, PathToName(entry_module_path));
@@ -85,6 +101,10 @@ absl::Status RealMain(std::string_view entry_module_path,
       .execute = execute,
       .seed = seed,
       .warnings_as_errors = warnings_as_errors,
+      .execute_on_jit = execute_on_jit,
+      .type_info_cache_dir = std::move(type_info_cache_dir),
+      .thread_count = test_threads,
+      .bytecode_cache_dir = std::move(bytecode_cache_dir),
   };
   XLS_ASSIGN_OR_RETURN(
       TestResult test_result,
@@ -115,6 +135,7 @@ int main(int argc, char* argv[]) {
   std::string compare_flag_str = absl::GetFlag(FLAGS_compare);
   bool execute = absl::GetFlag(FLAGS_execute);
   bool warnings_as_errors = absl::GetFlag(FLAGS_warnings_as_errors);
+  bool execute_on_jit = absl::GetFlag(FLAGS_execute_on_jit);
 
   xls::dslx::CompareFlag compare_flag;
   if (compare_flag_str == "none") {
@@ -141,16 +162,33 @@ int main(int argc, char* argv[]) {
     test_filter = std::move(flag);
   }
 
+  std::optional<std::string> type_info_cache_dir;
+  if (std::string flag = absl::GetFlag(FLAGS_type_info_cache_dir);
+      !flag.empty()) {
+    type_info_cache_dir = std::move(flag);
+  }
+
   absl::StatusOr<xls::FormatPreference> preference =
       xls::FormatPreferenceFromString(
           absl::GetFlag(FLAGS_trace_format_preference));
   XLS_QCHECK_OK(preference.status())
       << "-trace_format_preference accepts default|binary|hex|decimal";
 
+  std::optional<std::string> bytecode_cache_dir;
+  if (std::string flag = absl::GetFlag(FLAGS_bytecode_cache_dir);
+      !flag.empty()) {
+    bytecode_cache_dir = std::move(flag);
+  }
+
+  int64_t test_threads = absl::GetFlag(FLAGS_test_threads);
+  XLS_QCHECK_GE(test_threads, 1) << "-test_threads must be at least 1";
+
   bool printed_error = false;
   absl::Status status = xls::dslx::RealMain(
       args[0], dslx_paths, test_filter, preference.value(), compare_flag,
-      execute, warnings_as_errors, seed, &printed_error);
+      execute, warnings_as_errors, execute_on_jit, seed,
+      std::move(type_info_cache_dir), test_threads,
+      std::move(bytecode_cache_dir), &printed_error);
   if (printed_error) {
     return EXIT_FAILURE;
   }
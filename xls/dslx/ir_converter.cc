@@ -24,9 +24,17 @@
 
 #include "xls/dslx/ir_converter.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
+#include "xls/common/thread.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/ast.h"
 #include "xls/dslx/ast_utils.h"
@@ -43,6 +51,7 @@
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/value_helpers.h"
 
 namespace xls::dslx {
 namespace {
@@ -53,6 +62,18 @@ struct PackageData {
   Package* package;
   absl::flat_hash_map<xls::FunctionBase*, dslx::Function*> ir_to_dslx;
   absl::flat_hash_set<xls::Function*> wrappers;
+  // IR values of the module-level constants converted so far. Constants (e.g.
+  // large lookup tables) are referenced from many functions, so they are
+  // converted from their constexpr values once per package.
+  absl::flat_hash_map<const ConstantDef*, Value> constant_values;
+
+  // When functions are converted concurrently each is converted into a
+  // package of its own, which is later merged into the package of `base`.
+  // Functions already converted into the latter are used via stubs: functions
+  // with the same signature which calls are redirected from on merging (see
+  // MergeIntoPackage()).
+  const PackageData* base = nullptr;
+  absl::flat_hash_map<xls::Function*, xls::Function*> stub_to_base;
 };
 
 // Returns a status that indicates an error in the IR conversion process.
@@ -463,6 +484,14 @@ class FunctionConverter {
 
   Package* package() const { return package_data_.package; }
 
+  // Returns whether a function with the given name has been converted into the
+  // package (or its base, see PackageData).
+  bool HasFunction(std::string_view name) const;
+
+  // Returns the function with the given name from the package, first creating
+  // a stub for it if it was converted into the base package.
+  absl::StatusOr<xls::Function*> GetFunction(std::string_view name);
+
   // Package that IR is being generated into.
   PackageData& package_data_;
 
@@ -835,6 +864,54 @@ absl::StatusOr<BValue> FunctionConverter::DefWithStatus(
   return result;
 }
 
+bool FunctionConverter::HasFunction(std::string_view name) const {
+  return package()->HasFunctionWithName(name) ||
+         (package_data_.base != nullptr &&
+          package_data_.base->package->HasFunctionWithName(name));
+}
+
+// Returns a value of the given type, for the body of a stub function.
+static BValue StubValueOfType(FunctionBuilder& fb, xls::Type* type) {
+  if (type->IsToken()) {
+    return fb.AfterAll({});
+  }
+  if (type->IsTuple()) {
+    std::vector<BValue> elements;
+    for (xls::Type* element_type : type->AsTupleOrDie()->element_types()) {
+      elements.push_back(StubValueOfType(fb, element_type));
+    }
+    return fb.Tuple(elements);
+  }
+  return fb.Literal(ZeroOfType(type));
+}
+
+absl::StatusOr<xls::Function*> FunctionConverter::GetFunction(
+    std::string_view name) {
+  if (package()->HasFunctionWithName(name) || package_data_.base == nullptr) {
+    return package()->GetFunction(name);
+  }
+  XLS_ASSIGN_OR_RETURN(xls::Function * base_f,
+                       package_data_.base->package->GetFunction(name));
+  FunctionBuilder fb(name, package());
+  for (xls::Param* param : base_f->params()) {
+    XLS_ASSIGN_OR_RETURN(xls::Type * type,
+                         package()->MapTypeFromOtherPackage(param->GetType()));
+    fb.Param(param->GetName(), type);
+  }
+  XLS_ASSIGN_OR_RETURN(xls::Type * return_type,
+                       package()->MapTypeFromOtherPackage(
+                           base_f->return_value()->GetType()));
+  BValue return_value = StubValueOfType(fb, return_type);
+  XLS_ASSIGN_OR_RETURN(xls::Function * stub,
+                       fb.BuildWithReturnValue(return_value));
+  package_data_.stub_to_base[stub] = base_f;
+  if (auto it = package_data_.base->ir_to_dslx.find(base_f);
+      it != package_data_.base->ir_to_dslx.end()) {
+    package_data_.ir_to_dslx[stub] = it->second;
+  }
+  return stub;
+}
+
 BValue FunctionConverter::Def(
     const AstNode* node,
     const std::function<BValue(const SourceInfo&)>& ir_func) {
@@ -1036,9 +1113,15 @@ absl::Status FunctionConverter::HandleConstantDef(const ConstantDef* node) {
   // We've already evaluated constants to their values; we don't need to dive
   // into them for [useless] IR conversion.
   XLS_VLOG(5) << "Visiting ConstantDef expr: " << node->value()->ToString();
-  XLS_ASSIGN_OR_RETURN(InterpValue iv,
-                       current_type_info_->GetConstExpr(node->value()));
-  XLS_ASSIGN_OR_RETURN(Value value, InterpValueToValue(iv));
+  auto it = package_data_.constant_values.find(node);
+  if (it == package_data_.constant_values.end()) {
+    XLS_ASSIGN_OR_RETURN(InterpValue iv,
+                         current_type_info_->GetConstExpr(node->value()));
+    XLS_ASSIGN_OR_RETURN(Value converted, InterpValueToValue(iv));
+    it = package_data_.constant_values.emplace(node, std::move(converted))
+             .first;
+  }
+  const Value& value = it->second;
   Def(node->value(), [this, &value](const SourceInfo& loc) {
     return function_builder_->Literal(value, loc);
   });
@@ -1645,7 +1728,7 @@ absl::StatusOr<BValue> FunctionConverter::DefMapWithBuiltin(
   XLS_VLOG(5) << "Mapping with builtin; arg: "
               << arg_value.GetType()->ToString();
   auto* array_type = arg_value.GetType()->AsArrayOrDie();
-  if (!package()->HasFunctionWithName(mangled_name)) {
+  if (!HasFunction(mangled_name)) {
     FunctionBuilder fb(mangled_name, package());
     BValue param = fb.Param("arg", array_type->element_type());
     const std::string& builtin_name = node->identifier();
@@ -1661,7 +1744,7 @@ absl::StatusOr<BValue> FunctionConverter::DefMapWithBuiltin(
     XLS_RETURN_IF_ERROR(fb.Build().status());
   }
 
-  XLS_ASSIGN_OR_RETURN(xls::Function * f, package()->GetFunction(mangled_name));
+  XLS_ASSIGN_OR_RETURN(xls::Function * f, GetFunction(mangled_name));
   return Def(parent_node, [&](const SourceInfo& loc) {
     return function_builder_->Map(arg_value, f);
   });
@@ -1709,7 +1792,7 @@ absl::StatusOr<BValue> FunctionConverter::HandleMap(const Invocation* node) {
                      free_set, node_sym_bindings.value()));
   XLS_VLOG(5) << "Getting function with mangled name: " << mangled_name
               << " from package: " << package()->name();
-  XLS_ASSIGN_OR_RETURN(xls::Function * f, package()->GetFunction(mangled_name));
+  XLS_ASSIGN_OR_RETURN(xls::Function * f, GetFunction(mangled_name));
   return Def(node, [&](const SourceInfo& loc) -> BValue {
     return function_builder_->Map(arg, f, loc);
   });
@@ -1927,9 +2010,8 @@ absl::Status FunctionConverter::HandleInvocation(const Invocation* node) {
     return values;
   };
 
-  if (package()->HasFunctionWithName(called_name)) {
-    XLS_ASSIGN_OR_RETURN(xls::Function * f,
-                         package()->GetFunction(called_name));
+  if (HasFunction(called_name)) {
+    XLS_ASSIGN_OR_RETURN(xls::Function * f, GetFunction(called_name));
     XLS_ASSIGN_OR_RETURN(std::vector<BValue> args, accept_args());
     return HandleUdfInvocation(node, f, std::move(args));
   }
@@ -3313,6 +3395,113 @@ absl::Status CreateBoundaryChannels(absl::Span<Param* const> params,
   return absl::OkStatus();
 }
 
+// Moves the functions converted into `from` into the package of `into`,
+// redirecting the calls to stubs to the functions they stand in for (see
+// PackageData).
+absl::Status MergeIntoPackage(PackageData& from, PackageData& into) {
+  absl::flat_hash_map<const xls::Function*, xls::Function*> call_remapping;
+  for (const std::unique_ptr<xls::Function>& f : from.package->functions()) {
+    if (auto it = from.stub_to_base.find(f.get());
+        it != from.stub_to_base.end()) {
+      call_remapping[f.get()] = it->second;
+      continue;
+    }
+    if (into.package->HasFunctionWithName(f->name())) {
+      // E.g. the function made for a map of a builtin, which other functions
+      // converted alongside this one may have made as well.
+      XLS_ASSIGN_OR_RETURN(call_remapping[f.get()],
+                           into.package->GetFunction(f->name()));
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(xls::Function * clone,
+                         f->Clone(f->name(), into.package, call_remapping));
+    call_remapping[f.get()] = clone;
+    if (auto it = from.ir_to_dslx.find(f.get()); it != from.ir_to_dslx.end()) {
+      into.ir_to_dslx[clone] = it->second;
+    }
+    if (from.wrappers.contains(f.get())) {
+      into.wrappers.insert(clone);
+    }
+  }
+  for (auto& [constant_def, value] : from.constant_values) {
+    into.constant_values.try_emplace(constant_def, std::move(value));
+  }
+  return absl::OkStatus();
+}
+
+// Converts the (non-proc) functions in `order` on up to
+// `options.thread_count` threads. Functions are converted in waves: each is
+// assigned to the wave after the latest wave of its callees, the functions of
+// a wave are converted concurrently into packages of their own, and those are
+// merged into the package (in conversion order) before the next wave starts.
+absl::Status ConvertFunctionsConcurrently(
+    absl::Span<const ConversionRecord> order, ImportData* import_data,
+    const ConvertOptions& options, PackageData& package_data) {
+  absl::flat_hash_map<std::pair<const Function*, SymbolicBindings>, int64_t>
+      record_waves;
+  std::vector<std::vector<const ConversionRecord*>> waves;
+  for (const ConversionRecord& record : order) {
+    int64_t wave = 0;
+    for (const Callee& callee : record.callees()) {
+      auto it = record_waves.find(
+          std::make_pair(callee.f(), callee.sym_bindings()));
+      if (it != record_waves.end()) {
+        wave = std::max(wave, it->second + 1);
+      }
+    }
+    record_waves[std::make_pair(record.f(), record.symbolic_bindings())] =
+        wave;
+    if (waves.size() <= wave) {
+      waves.resize(wave + 1);
+    }
+    waves[wave].push_back(&record);
+  }
+
+  for (const std::vector<const ConversionRecord*>& wave : waves) {
+    std::vector<std::unique_ptr<Package>> packages(wave.size());
+    std::vector<std::unique_ptr<PackageData>> wave_data(wave.size());
+    std::vector<absl::Status> statuses(wave.size());
+    for (int64_t i = 0; i < wave.size(); ++i) {
+      packages[i] = std::make_unique<Package>(package_data.package->name());
+      // Keep the file numbers of the source locations in step.
+      for (const auto& [fileno, filename] :
+           package_data.package->fileno_to_name()) {
+        packages[i]->SetFileno(fileno, filename);
+      }
+      wave_data[i] = std::make_unique<PackageData>();
+      wave_data[i]->package = packages[i].get();
+      wave_data[i]->base = &package_data;
+    }
+    std::atomic<int64_t> next_index = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_index.fetch_add(1); i < wave.size();
+           i = next_index.fetch_add(1)) {
+        XLS_VLOG(3) << "Converting to IR: " << wave[i]->ToString();
+        ProcConversionData proc_data;
+        statuses[i] = ConvertOneFunctionInternal(
+            *wave_data[i], *wave[i], import_data, &proc_data, options);
+      }
+    };
+    int64_t wave_thread_count =
+        std::min<int64_t>(options.thread_count, wave.size());
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < wave_thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    worker();
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+
+    // Report the error of the function converted first in conversion order.
+    for (int64_t i = 0; i < wave.size(); ++i) {
+      XLS_RETURN_IF_ERROR(statuses[i]);
+      XLS_RETURN_IF_ERROR(MergeIntoPackage(*wave_data[i], package_data));
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 // Converts the functions in the call graph in a specified order.
@@ -3433,10 +3622,21 @@ static absl::Status ConvertCallGraph(
         first_proc_config->type_info(), package_data, &proc_data));
   }
 
-  for (const ConversionRecord& record : order) {
-    XLS_VLOG(3) << "Converting to IR: " << record.ToString();
-    XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(
-        package_data, record, import_data, &proc_data, options));
+  // Procs share channels (and other state) across their conversion, so they
+  // are converted serially.
+  const bool has_procs =
+      absl::c_any_of(order, [](const ConversionRecord& record) {
+        return record.f()->tag() != Function::Tag::kNormal;
+      });
+  if (options.thread_count > 1 && !has_procs) {
+    XLS_RETURN_IF_ERROR(ConvertFunctionsConcurrently(order, import_data,
+                                                     options, package_data));
+  } else {
+    for (const ConversionRecord& record : order) {
+      XLS_VLOG(3) << "Converting to IR: " << record.ToString();
+      XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(
+          package_data, record, import_data, &proc_data, options));
+    }
   }
 
   XLS_VLOG(3) << "Verifying converted package";
@@ -3525,6 +3725,16 @@ absl::Status ConvertOneFunctionIntoPackage(
                       entry_function_name, module->name()));
 }
 
+absl::Status ConvertTestFunctionIntoPackage(TestFunction* tf,
+                                            ImportData* import_data,
+                                            const ConvertOptions& options,
+                                            Package* package) {
+  Function* f = tf->fn();
+  return ConvertOneFunctionIntoPackageInternal(
+      f->owner(), f, import_data, /*symbolic_bindings=*/nullptr, options,
+      package, /*top_proc_initial_state=*/absl::nullopt);
+}
+
 absl::StatusOr<std::string> ConvertOneFunction(
     Module* module, std::string_view entry_function_name,
     ImportData* import_data, const SymbolicBindings* symbolic_bindings,
@@ -3545,15 +3755,18 @@ absl::StatusOr<Value> InterpValueToValue(const InterpValue& iv) {
       return Value(iv.GetBitsOrDie());
     case InterpValueTag::kTuple:
     case InterpValueTag::kArray: {
+      const std::vector<InterpValue>& elements = iv.GetValuesOrDie();
       std::vector<Value> ir_values;
-      for (const InterpValue& e : iv.GetValuesOrDie()) {
+      ir_values.reserve(elements.size());
+      for (const InterpValue& e : elements) {
         XLS_ASSIGN_OR_RETURN(Value ir_value, InterpValueToValue(e));
         ir_values.push_back(std::move(ir_value));
       }
+      // The element values are moved rather than copied into the result.
       if (iv.tag() == InterpValueTag::kTuple) {
-        return Value::Tuple(std::move(ir_values));
+        return Value::TupleOwned(std::move(ir_values));
       }
-      return Value::Array(std::move(ir_values));
+      return Value::ArrayOwned(std::move(ir_values));
     }
     default:
       return absl::InvalidArgumentError(
@@ -41,6 +41,12 @@ struct ConvertOptions {
 
   // Should the generated IR be verified?
   bool verify_ir = true;
+
+  // Number of threads used to convert functions that do not call one another.
+  // Modules with procs are always converted on a single thread. The converted
+  // package holds the same functions regardless, but their order (and node
+  // ids) may differ when more than one thread is used.
+  int64_t thread_count = 1;
 };
 
 // Converts the contents of a module to IR form.
@@ -107,6 +113,17 @@ absl::Status ConvertOneFunctionIntoPackage(
     ImportData* import_data, const SymbolicBindings* symbolic_bindings,
     const ConvertOptions& options, Package* package);
 
+// Converts the body of the given test function, along with everything it
+// calls, into "package" as an ordinary function (e.g. so that the test can be
+// executed on the JIT). The resulting IR function is named by mangling the
+// test's function as for any other DSLX function.
+//
+// Package must outlive this function call, it may not be nullptr.
+absl::Status ConvertTestFunctionIntoPackage(TestFunction* tf,
+                                            ImportData* import_data,
+                                            const ConvertOptions& options,
+                                            Package* package);
+
 // Converts an interpreter value to an IR value.
 absl::StatusOr<Value> InterpValueToValue(const InterpValue& v);
 
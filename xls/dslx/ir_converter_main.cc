@@ -27,7 +27,10 @@
 #include "xls/dslx/ir_converter.h"
 #include "xls/dslx/parser.h"
 #include "xls/dslx/scanner.h"
+#include "xls/dslx/type_info_cache.h"
 #include "xls/dslx/typecheck.h"
+#include "xls/ir/binary_ir.h"
+#include "xls/tools/tool_server.h"
 
 // LINT.IfChange
 ABSL_FLAG(std::string, top, "",
@@ -53,6 +56,16 @@ ABSL_FLAG(bool, verify, true,
           "If true, verifies the generated IR for correctness.");
 ABSL_FLAG(bool, warnings_as_errors, true,
           "Whether to fail early, as an error, if warnings are detected");
+ABSL_FLAG(std::string, output_ir_format, "text",
+          "Format of the emitted IR: `text` or `binary`. The binary format is "
+          "faster to load but is not stable across XLS versions.");
+ABSL_FLAG(int64_t, typecheck_threads, 1,
+          "Number of threads to typecheck independent imported modules on. "
+          "Values of one or less typecheck imports serially.");
+ABSL_FLAG(std::string, type_info_cache_dir, "",
+          "Directory in which to cache the type information of imported "
+          "modules across invocations; empty to not cache. Only used when "
+          "imports are typechecked serially.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls::dslx {
@@ -71,6 +84,9 @@ Example invocation for a particular function:
 If no entry point is given all functions within the module are converted:
 
   ir_converter_main path/to/frobulator.x
+
+With --serve_on_socket, runs as a server for invocations sent with
+tool_client_main instead.
 )";
 
 absl::StatusOr<std::unique_ptr<Module>> ParseText(std::string_view text,
@@ -92,7 +108,8 @@ static absl::Status AddPathToPackage(
     std::optional<std::string_view> top_proc_initial_state,
     const ConvertOptions& convert_options, std::string stdlib_path,
     absl::Span<const std::filesystem::path> dslx_paths, Package* package,
-    bool warnings_as_errors, bool* printed_error) {
+    bool warnings_as_errors, int64_t typecheck_threads,
+    const std::string& type_info_cache_dir, bool* printed_error) {
   // Read the `.x` contents.
   XLS_ASSIGN_OR_RETURN(std::string text, GetFileContents(path));
   // Figure out what we name this module.
@@ -108,9 +125,14 @@ static absl::Status AddPathToPackage(
   // make the modules outlive any given AddPathToPackage() if we want to
   // appropriately reuse things in ImportData).
   ImportData import_data(CreateImportData(std::move(stdlib_path), dslx_paths));
+  if (!type_info_cache_dir.empty()) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<TypeInfoCache> type_info_cache,
+                         TypeInfoCache::Create(type_info_cache_dir));
+    import_data.SetTypeInfoCache(std::move(type_info_cache));
+  }
   WarningCollector warnings;
   absl::StatusOr<TypeInfo*> type_info_or =
-      CheckModule(module.get(), &import_data, &warnings);
+      CheckModule(module.get(), &import_data, &warnings, typecheck_threads);
   if (!type_info_or.ok()) {
     *printed_error = TryPrintError(type_info_or.status());
     return type_info_or.status();
@@ -143,7 +165,10 @@ absl::Status RealMain(absl::Span<const std::string_view> paths,
                       const std::string& stdlib_path,
                       absl::Span<const std::filesystem::path> dslx_paths,
                       bool emit_fail_as_assert, bool verify_ir,
-                      bool warnings_as_errors, bool* printed_error) {
+                      bool warnings_as_errors, IrFormat output_ir_format,
+                      int64_t typecheck_threads,
+                      const std::string& type_info_cache_dir,
+                      bool* printed_error) {
   std::optional<xls::Package> package;
   if (package_name.has_value()) {
     package.emplace(package_name.value());
@@ -174,23 +199,24 @@ absl::Status RealMain(absl::Span<const std::string_view> paths,
     }
     XLS_RETURN_IF_ERROR(AddPathToPackage(
         path, top, top_proc_initial_state, convert_options, stdlib_path,
-        dslx_paths, &package.value(), warnings_as_errors, printed_error));
+        dslx_paths, &package.value(), warnings_as_errors, typecheck_threads,
+        type_info_cache_dir, printed_error));
   }
-  std::cout << package->DumpIr();
+  XLS_ASSIGN_OR_RETURN(std::string ir,
+                       DumpPackage(&package.value(), output_ir_format));
+  std::cout << ir;
 
   return absl::OkStatus();
 }
 
-}  // namespace
-}  // namespace xls::dslx
-
-int main(int argc, char* argv[]) {
-  std::vector<std::string_view> args =
-      xls::InitXls(xls::dslx::kUsage, argc, argv);
+// Converts the DSLX files given by `args` using the options given by the
+// flags.
+absl::Status RealMainFromFlags(absl::Span<const std::string_view> args,
+                               bool* printed_error) {
   if (args.empty()) {
-    XLS_LOG(QFATAL) << "Wrong number of command-line arguments; got "
-                    << args.size() << ": `" << absl::StrJoin(args, " ")
-                    << "`; want " << argv[0] << " <input-file>";
+    return absl::InvalidArgumentError(
+        "Wrong number of command-line arguments; got 0; want "
+        "ir_converter_main <input-file>");
   }
   std::string stdlib_path = absl::GetFlag(FLAGS_stdlib_path);
   std::string dslx_path = absl::GetFlag(FLAGS_dslx_path);
@@ -217,17 +243,41 @@ int main(int argc, char* argv[]) {
     top_proc_initial_state = absl::GetFlag(FLAGS_top_proc_initial_state);
   }
   if (top_proc_initial_state.has_value() && !top.has_value()) {
-    XLS_LOG(QFATAL)
-        << "--top_proc_initial_state requires that --top is also set.";
+    return absl::InvalidArgumentError(
+        "--top_proc_initial_state requires that --top is also set.");
   }
 
   bool emit_fail_as_assert = absl::GetFlag(FLAGS_emit_fail_as_assert);
   bool verify_ir = absl::GetFlag(FLAGS_verify);
   bool warnings_as_errors = absl::GetFlag(FLAGS_warnings_as_errors);
+  XLS_ASSIGN_OR_RETURN(
+      IrFormat output_ir_format,
+      IrFormatFromString(absl::GetFlag(FLAGS_output_ir_format)));
+  return RealMain(args, top, top_proc_initial_state, package_name, stdlib_path,
+                  dslx_paths, emit_fail_as_assert, verify_ir,
+                  warnings_as_errors, output_ir_format,
+                  absl::GetFlag(FLAGS_typecheck_threads),
+                  absl::GetFlag(FLAGS_type_info_cache_dir), printed_error);
+}
+
+}  // namespace
+}  // namespace xls::dslx
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string_view> args =
+      xls::InitXls(xls::dslx::kUsage, argc, argv);
+  std::string serve_on_socket = absl::GetFlag(FLAGS_serve_on_socket);
+  if (!serve_on_socket.empty()) {
+    XLS_QCHECK_OK(xls::tools::ServeToolInvocations(
+        serve_on_socket,
+        [](absl::Span<const std::string_view> args) -> absl::Status {
+          bool printed_error = false;
+          return xls::dslx::RealMainFromFlags(args, &printed_error);
+        }));
+    return EXIT_SUCCESS;
+  }
   bool printed_error = false;
-  absl::Status status = xls::dslx::RealMain(
-      args, top, top_proc_initial_state, package_name, stdlib_path, dslx_paths,
-      emit_fail_as_assert, verify_ir, warnings_as_errors, &printed_error);
+  absl::Status status = xls::dslx::RealMainFromFlags(args, &printed_error);
   if (printed_error) {
     return EXIT_FAILURE;
   }
@@ -1746,6 +1746,53 @@ TEST(IrConverterTest, ChannelDecl) {
                        HasSubstr("AST node unsupported for IR conversion:")));
 }
 
+TEST(IrConverterTest, ConvertsFunctionsConcurrently) {
+  constexpr std::string_view kProgram = R"(
+const TABLE = u8[4]:[1, 2, 3, 4];
+
+fn double<N: u32>(x: bits[N]) -> bits[N] { x + x }
+
+fn lookup(i: u2) -> u8 { TABLE[i] }
+
+fn add_one(x: u8) -> u8 { x + u8:1 }
+
+fn combine(x: u8, y: u16) -> u16 {
+  let a = double(add_one(x));
+  let b = double(y);
+  let c = map(TABLE, add_one);
+  let d = map(TABLE, clz);
+  b + (a as u16) + (lookup(x as u2) as u16) + (c[0] as u16) + (d[1] as u16)
+}
+
+fn main(x: u8, y: u16) -> u16 {
+  combine(x, y) + double(y) + (lookup(u2:1) as u16)
+}
+)";
+  auto convert = [&](int64_t thread_count)
+      -> absl::StatusOr<std::unique_ptr<Package>> {
+    auto import_data = CreateImportDataForTest();
+    XLS_ASSIGN_OR_RETURN(
+        TypecheckedModule tm,
+        ParseAndTypecheck(kProgram, "test_module.x", "test_module",
+                          &import_data));
+    ConvertOptions options;
+    options.emit_positions = false;
+    options.thread_count = thread_count;
+    return ConvertModuleToPackage(tm.module, &import_data, options);
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> serial, convert(1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> concurrent, convert(4));
+
+  // The same functions are converted, calling one another in the same way.
+  ASSERT_EQ(concurrent->functions().size(), serial->functions().size());
+  for (const std::unique_ptr<xls::Function>& f : serial->functions()) {
+    XLS_ASSERT_OK_AND_ASSIGN(xls::Function * concurrent_f,
+                             concurrent->GetFunction(f->name()));
+    EXPECT_EQ(concurrent_f->node_count(), f->node_count()) << f->name();
+    EXPECT_EQ(concurrent_f->GetType()->ToString(), f->GetType()->ToString());
+  }
+}
+
 }  // namespace
 }  // namespace xls::dslx
 
@@ -26,12 +26,13 @@ namespace xls::dslx {
 
 absl::StatusOr<TypecheckedModule> ParseAndTypecheck(
     std::string_view text, std::string_view path,
-    std::string_view module_name, ImportData* import_data) {
+    std::string_view module_name, ImportData* import_data,
+    int64_t thread_count) {
   XLS_RET_CHECK(import_data != nullptr);
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module,
                        ParseModule(text, path, module_name));
-  return TypecheckModule(std::move(module), path, import_data);
+  return TypecheckModule(std::move(module), path, import_data, thread_count);
 }
 
 absl::StatusOr<std::unique_ptr<Module>> ParseModule(
@@ -52,7 +53,7 @@ absl::StatusOr<std::unique_ptr<Module>> ParseModuleFromFileAtPath(
 
 absl::StatusOr<TypecheckedModule> TypecheckModule(
     std::unique_ptr<Module> module, std::string_view path,
-    ImportData* import_data) {
+    ImportData* import_data, int64_t thread_count) {
   XLS_RET_CHECK(module.get() != nullptr);
   XLS_RET_CHECK(import_data != nullptr);
 
@@ -60,7 +61,8 @@ absl::StatusOr<TypecheckedModule> TypecheckModule(
 
   WarningCollector warnings;
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
-                       CheckModule(module.get(), import_data, &warnings));
+                       CheckModule(module.get(), import_data, &warnings,
+                                   thread_count));
   TypecheckedModule result{module.get(), type_info, std::move(warnings)};
   XLS_ASSIGN_OR_RETURN(ImportTokens subject,
                        ImportTokens::FromString(module_name));
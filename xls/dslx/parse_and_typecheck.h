@@ -36,10 +36,12 @@ struct TypecheckedModule {
 //
 // "path" is used for error reporting (`Span`s) and module_name is the name
 // given to the returned `TypecheckedModule::module`. "import_data" is used to
-// get-or-insert any imported modules.
+// get-or-insert any imported modules. If "thread_count" is greater than one,
+// independent imports are typechecked concurrently (see CheckModule).
 absl::StatusOr<TypecheckedModule> ParseAndTypecheck(
     std::string_view text, std::string_view path,
-    std::string_view module_name, ImportData* import_data);
+    std::string_view module_name, ImportData* import_data,
+    int64_t thread_count = 1);
 
 // Helper that parses and creates a new module from the given "text".
 //
@@ -60,9 +62,10 @@ absl::StatusOr<std::unique_ptr<Module>> ParseModuleFromFileAtPath(
 //
 // "path" is used for error reporting (`Span`s)
 // "import_data" is used to get-or-insert any imported modules.
+// "thread_count" is as for ParseAndTypecheck.
 absl::StatusOr<TypecheckedModule> TypecheckModule(
     std::unique_ptr<Module> module, std::string_view path,
-    ImportData* import_data);
+    ImportData* import_data, int64_t thread_count = 1);
 
 }  // namespace xls::dslx
 
@@ -16,6 +16,7 @@
 #define XLS_DSLX_POS_H_
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include "absl/status/statusor.h"
@@ -25,27 +26,41 @@
 namespace xls::dslx {
 
 // Represents a position in the text (file, line, column).
+//
+// The filename is shared between copies of a position, so positions (and spans)
+// made from a single filename string, e.g. all those created by one scanner,
+// refer to a single copy of it.
 class Pos {
  public:
   static absl::StatusOr<Pos> FromString(std::string_view s);
 
-  Pos() : filename_(""), lineno_(0), colno_(0) {}
+  Pos() : filename_(GetEmptyFilename()), lineno_(0), colno_(0) {}
   Pos(std::string filename, int64_t lineno, int64_t colno)
+      : filename_(std::make_shared<const std::string>(std::move(filename))),
+        lineno_(lineno),
+        colno_(colno) {}
+  Pos(std::shared_ptr<const std::string> filename, int64_t lineno,
+      int64_t colno)
       : filename_(std::move(filename)), lineno_(lineno), colno_(colno) {}
 
+  // Copies only: a moved-from position would have no filename.
+  Pos(const Pos& other) = default;
+  Pos& operator=(const Pos& other) = default;
+
   std::string ToString() const {
-    return absl::StrFormat("%s:%d:%d", filename_, lineno_ + 1, colno_ + 1);
+    return absl::StrFormat("%s:%d:%d", filename(), lineno_ + 1, colno_ + 1);
   }
   std::string ToStringNoFile() const {
     return absl::StrFormat("%d:%d", lineno_ + 1, colno_ + 1);
   }
 
   std::string ToRepr() const {
-    return absl::StrFormat("Pos(\"%s\", %d, %d)", filename_, lineno_, colno_);
+    return absl::StrFormat("Pos(\"%s\", %d, %d)", filename(), lineno_,
+                           colno_);
   }
 
   bool operator<(const Pos& other) const {
-    XLS_CHECK_EQ(filename_, other.filename_);
+    XLS_CHECK(SameFilename(other)) << filename() << " vs " << other.filename();
     if (lineno_ < other.lineno_) {
       return true;
     }
@@ -58,7 +73,7 @@ class Pos {
     return false;
   }
   bool operator==(const Pos& other) const {
-    XLS_CHECK_EQ(filename_, other.filename_);
+    XLS_CHECK(SameFilename(other)) << filename() << " vs " << other.filename();
     return lineno_ == other.lineno_ && colno_ == other.colno_;
   }
   bool operator!=(const Pos& other) const { return !(*this == other); }
@@ -67,14 +82,24 @@ class Pos {
   }
   bool operator>=(const Pos& other) const { return !((*this) < other); }
 
-  const std::string& filename() const { return filename_; }
+  const std::string& filename() const { return *filename_; }
   int64_t lineno() const { return lineno_; }
   int64_t colno() const { return colno_; }
 
   Pos BumpCol() const { return Pos(filename_, lineno_, colno_ + 1); }
 
  private:
-  std::string filename_;
+  static const std::shared_ptr<const std::string>& GetEmptyFilename() {
+    static const auto* empty =
+        new std::shared_ptr<const std::string>(new std::string);
+    return *empty;
+  }
+
+  bool SameFilename(const Pos& other) const {
+    return filename_ == other.filename_ || *filename_ == *other.filename_;
+  }
+
+  std::shared_ptr<const std::string> filename_;
   int64_t lineno_;
   int64_t colno_;
 };
@@ -37,5 +37,16 @@ TEST(PosTest, PosLt) {
   EXPECT_GE(Pos(kFakeFile, 0, 0), Pos(kFakeFile, 0, 0));
 }
 
+TEST(PosTest, CopiesShareFilename) {
+  Pos p("/my/foo.x", 1, 2);
+  Pos copy = p;
+  Pos bumped = p.BumpCol();
+  EXPECT_EQ(&copy.filename(), &p.filename());
+  EXPECT_EQ(&bumped.filename(), &p.filename());
+  // Positions with equal but separately created filenames still compare.
+  EXPECT_EQ(p, Pos("/my/foo.x", 1, 2));
+  EXPECT_LT(p, bumped);
+}
+
 }  // namespace
 }  // namespace xls::dslx
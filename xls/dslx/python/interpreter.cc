@@ -51,8 +51,11 @@ absl::StatusOr<std::vector<InterpValue>> RunFunctionBatched(
     const std::vector<std::vector<InterpValue>>& args_batch) {
   std::vector<std::unique_ptr<ConcreteType>> params;
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
-                       BytecodeEmitter::Emit(&import_data, tm.type_info, f,
-                                             /*caller_bindings=*/{}));
+                       BytecodeEmitter::Emit(
+                           &import_data, tm.type_info, f,
+                           /*caller_bindings=*/{},
+                           BytecodeEmitterOptions{
+                               .fuse_superinstructions = true}));
   XLS_ASSIGN_OR_RETURN(FunctionType * fn_type,
                        tm.type_info->GetItemAs<FunctionType>(f));
   std::vector<InterpValue> results;
@@ -14,8 +14,13 @@
 
 #include "xls/dslx/run_routines.h"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <random>
 
+#include "xls/common/math_util.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bindings.h"
 #include "xls/dslx/bytecode_cache.h"
 #include "xls/dslx/bytecode_emitter.h"
@@ -28,9 +33,11 @@
 #include "xls/dslx/ir_converter.h"
 #include "xls/dslx/mangle.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_info_cache.h"
 #include "xls/dslx/typecheck.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/ir/events.h"
 
 namespace xls::dslx {
 namespace {
@@ -39,24 +46,94 @@ namespace {
 constexpr int kUnitSpaces = 7;
 constexpr int kQuickcheckSpaces = 15;
 
+// Number of quickcheck samples drawn from each independently seeded random
+// engine; see DoQuickCheck().
+constexpr int64_t kQuickCheckShardSize = 128;
+
+// Calls fn(worker, index) for every index in [0, count) on up to thread_count
+// threads, the calling thread included. `worker` is in [0, thread_count) and
+// identifies the thread making the call, so callers can keep per-thread state.
+void ParallelFor(int64_t count, int64_t thread_count,
+                 const std::function<void(int64_t worker, int64_t index)>& fn) {
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&](int64_t worker_index) {
+    for (int64_t i = next_index.fetch_add(1); i < count;
+         i = next_index.fetch_add(1)) {
+      fn(worker_index, i);
+    }
+  };
+  thread_count = std::min(thread_count, count);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>([&worker, i] { worker(i); }));
+  }
+  worker(0);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+}
+
 absl::Status RunTestFunction(
     ImportData* import_data, TypeInfo* type_info, Module* module,
     TestFunction* tf, BytecodeInterpreter::PostFnEvalHook post_fn_eval_hook) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
-      BytecodeEmitter::Emit(import_data, type_info, tf->fn(), absl::nullopt));
+      BytecodeEmitter::Emit(
+          import_data, type_info, tf->fn(), absl::nullopt,
+          BytecodeEmitterOptions{.fuse_superinstructions = true}));
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*params=*/{},
                                         post_fn_eval_hook)
       .status();
 }
 
+// Converts the test function to IR and runs it on the JIT. Returns false
+// (rather than an error) if the test could not be converted, in which case it
+// should be run on the bytecode interpreter instead.
+absl::StatusOr<bool> RunTestFunctionOnJit(
+    ImportData* import_data, TestFunction* tf,
+    const ConvertOptions& convert_options) {
+  Function* f = tf->fn();
+  Package package(f->owner()->name());
+  absl::Status convert_status = ConvertTestFunctionIntoPackage(
+      tf, import_data, convert_options, &package);
+  if (!convert_status.ok()) {
+    XLS_VLOG(1) << "Could not convert test " << tf->identifier()
+                << " to IR, running it on the bytecode interpreter: "
+                << convert_status;
+    return false;
+  }
+
+  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
+                       import_data->GetRootTypeInfoForNode(f));
+  std::optional<bool> requires_implicit_token =
+      type_info->GetRequiresImplicitToken(f);
+  XLS_RET_CHECK(requires_implicit_token.has_value());
+  XLS_ASSIGN_OR_RETURN(
+      std::string ir_name,
+      MangleDslxName(f->owner()->name(), f->identifier(),
+                     *requires_implicit_token
+                         ? CallingConvention::kImplicitToken
+                         : CallingConvention::kTypical,
+                     f->GetFreeParametricKeySet()));
+  XLS_ASSIGN_OR_RETURN(xls::Function * ir_function,
+                       package.GetFunction(ir_name));
+
+  std::vector<Value> args;
+  if (*requires_implicit_token) {
+    args = {Value::Token(), Value::Bool(true)};
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                       FunctionJit::Create(ir_function));
+  XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result, jit->Run(args));
+  XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(result.events));
+  for (const std::string& msg : result.events.trace_msgs) {
+    XLS_LOG(INFO) << msg;
+  }
+  return true;
+}
+
 absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
                          Module* module, TestProc* tp) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
-
   XLS_ASSIGN_OR_RETURN(TypeInfo * ti,
                        type_info->GetTopLevelProcTypeInfo(tp->proc()));
 
@@ -88,6 +165,12 @@ absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
 
 absl::StatusOr<FunctionJit*> RunComparator::GetOrCompileJitFunction(
     std::string ir_name, xls::Function* ir_function) {
+  absl::MutexLock lock(&mutex_);
+  return GetOrCompileJitFunctionLocked(std::move(ir_name), ir_function);
+}
+
+absl::StatusOr<FunctionJit*> RunComparator::GetOrCompileJitFunctionLocked(
+    std::string ir_name, xls::Function* ir_function) {
   auto it = jit_cache_.find(ir_name);
   if (it != jit_cache_.end()) {
     return it->second.get();
@@ -143,8 +226,12 @@ absl::Status RunComparator::RunComparison(
     case CompareMode::kJit: {  // Compare to IR JIT.
       // TODO(https://github.com/google/xls/issues/506): Also compare events
       // once the DSLX interpreter supports them (and the JIT supports traces).
+      //
+      // The cached JIT function reuses its buffers between runs, so runs are
+      // serialized.
+      absl::MutexLock lock(&mutex_);
       XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
-                           GetOrCompileJitFunction(ir_name, ir_function));
+                           GetOrCompileJitFunctionLocked(ir_name, ir_function));
       XLS_ASSIGN_OR_RETURN(ir_result, DropInterpreterEvents(jit->Run(ir_args)));
       mode_str = "JIT";
       break;
@@ -194,39 +281,89 @@ static bool TestMatchesFilter(std::string_view test_name,
 absl::StatusOr<QuickCheckResults> DoQuickCheck(xls::Function* xls_function,
                                                std::string ir_name,
                                                RunComparator* run_comparator,
-                                               int64_t seed,
-                                               int64_t num_tests) {
-  XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
+                                               int64_t seed, int64_t num_tests,
+                                               int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 1);
+  int64_t shard_count = CeilOfRatio(num_tests, kQuickCheckShardSize);
+  thread_count = std::max<int64_t>(1, std::min(thread_count, shard_count));
+
+  // A FunctionJit may only run one sample at a time, so every worker other
+  // than the first gets its own compilation of the predicate.
+  std::vector<FunctionJit*> jits;
+  std::vector<std::unique_ptr<FunctionJit>> owned_jits;
+  XLS_ASSIGN_OR_RETURN(FunctionJit * cached_jit,
                        run_comparator->GetOrCompileJitFunction(
                            std::move(ir_name), xls_function));
+  jits.push_back(cached_jit);
+  for (int64_t i = 1; i < thread_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create(xls_function));
+    jits.push_back(jit.get());
+    owned_jits.push_back(std::move(jit));
+  }
+
+  // Each shard draws its arguments from an engine seeded by (seed, shard), so
+  // the samples do not depend on how shards are distributed across threads.
+  // Shards after the first falsified one are not needed and are skipped.
+  std::vector<absl::StatusOr<QuickCheckResults>> shard_results(shard_count);
+  std::atomic<int64_t> first_falsified = shard_count;
+  ParallelFor(shard_count, thread_count, [&](int64_t worker, int64_t shard) {
+    if (shard > first_falsified.load()) {
+      return;
+    }
+    auto run_shard = [&]() -> absl::StatusOr<QuickCheckResults> {
+      std::seed_seq seed_seq{static_cast<uint32_t>(seed),
+                             static_cast<uint32_t>(seed >> 32),
+                             static_cast<uint32_t>(shard)};
+      std::minstd_rand rng_engine(seed_seq);
+      QuickCheckResults results;
+      int64_t sample_count = std::min(kQuickCheckShardSize,
+                                      num_tests - shard * kQuickCheckShardSize);
+      for (int64_t i = 0; i < sample_count; ++i) {
+        results.arg_sets.push_back(
+            RandomFunctionArguments(xls_function, &rng_engine));
+        // TODO(https://github.com/google/xls/issues/506): 2021-10-15
+        // Assertion failures should work out, but we should consciously decide
+        // if/how we want to dump traces when running QuickChecks (always, for
+        // failures, flag-controlled, ...).
+        XLS_ASSIGN_OR_RETURN(
+            xls::Value result,
+            DropInterpreterEvents(jits[worker]->Run(results.arg_sets.back())));
+        results.results.push_back(result);
+        if (result.IsAllZeros()) {
+          // We were able to falsify the xls_function (predicate), bail out
+          // early and present this evidence.
+          int64_t current = first_falsified.load();
+          while (shard < current &&
+                 !first_falsified.compare_exchange_weak(current, shard)) {
+          }
+          break;
+        }
+      }
+      return results;
+    };
+    shard_results[shard] = run_shard();
+  });
 
+  // Results are reported as if the shards had run in order, up to and
+  // including the first falsifying example.
   QuickCheckResults results;
-  std::minstd_rand rng_engine(seed);
-
-  for (int i = 0; i < num_tests; i++) {
-    results.arg_sets.push_back(
-        RandomFunctionArguments(xls_function, &rng_engine));
-    // TODO(https://github.com/google/xls/issues/506): 2021-10-15
-    // Assertion failures should work out, but we should consciously decide
-    // if/how we want to dump traces when running QuickChecks (always, for
-    // failures, flag-controlled, ...).
-    XLS_ASSIGN_OR_RETURN(
-        xls::Value result,
-        DropInterpreterEvents(jit->Run(results.arg_sets.back())));
-    results.results.push_back(result);
-    if (result.IsAllZeros()) {
-      // We were able to falsify the xls_function (predicate), bail out early
-      // and present this evidence.
-      break;
+  int64_t last_shard = std::min<int64_t>(first_falsified, shard_count - 1);
+  for (int64_t shard = 0; shard <= last_shard; ++shard) {
+    XLS_ASSIGN_OR_RETURN(QuickCheckResults shard_result,
+                         std::move(shard_results[shard]));
+    for (int64_t i = 0; i < shard_result.results.size(); ++i) {
+      results.arg_sets.push_back(std::move(shard_result.arg_sets[i]));
+      results.results.push_back(std::move(shard_result.results[i]));
     }
   }
-
   return results;
 }
 
 static absl::Status RunQuickCheck(RunComparator* run_comparator,
                                   Package* ir_package, QuickCheck* quickcheck,
-                                  TypeInfo* type_info, int64_t seed) {
+                                  TypeInfo* type_info, int64_t seed,
+                                  int64_t thread_count) {
   Function* fn = quickcheck->f();
   XLS_ASSIGN_OR_RETURN(std::string ir_name,
                        MangleDslxName(fn->owner()->name(), fn->identifier(),
@@ -238,7 +375,7 @@ static absl::Status RunQuickCheck(RunComparator* run_comparator,
   XLS_ASSIGN_OR_RETURN(
       QuickCheckResults qc_results,
       DoQuickCheck(ir_function, std::move(ir_name), run_comparator, seed,
-                   quickcheck->test_count()));
+                   quickcheck->test_count(), thread_count));
   const auto& [arg_sets, results] = qc_results;
   XLS_ASSIGN_OR_RETURN(Bits last_result, results.back().GetBitsWithStatus());
   if (!last_result.IsZero()) {
@@ -274,7 +411,7 @@ using HandleError = const std::function<void(
 
 static absl::Status RunQuickChecksIfJitEnabled(
     Module* entry_module, TypeInfo* type_info, RunComparator* run_comparator,
-    Package* ir_package, std::optional<int64_t> seed,
+    Package* ir_package, std::optional<int64_t> seed, int64_t thread_count,
     const HandleError& handle_error) {
   if (run_comparator == nullptr) {
     std::cerr << "[ SKIPPING QUICKCHECKS  ] (JIT is disabled)" << std::endl;
@@ -292,8 +429,8 @@ static absl::Status RunQuickChecksIfJitEnabled(
     const std::string& test_name = quickcheck->identifier();
     std::cerr << "[ RUN QUICKCHECK        ] " << test_name
               << " count: " << quickcheck->test_count() << std::endl;
-    absl::Status status =
-        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed);
+    absl::Status status = RunQuickCheck(run_comparator, ir_package, quickcheck,
+                                        type_info, *seed, thread_count);
     if (!status.ok()) {
       handle_error(status, test_name, /*is_quickcheck=*/true);
     } else {
@@ -342,6 +479,12 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
 
   ImportData import_data(
       CreateImportData(options.stdlib_path, options.dslx_paths));
+  if (options.type_info_cache_dir.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<TypeInfoCache> type_info_cache,
+        TypeInfoCache::Create(options.type_info_cache_dir.value()));
+    import_data.SetTypeInfoCache(std::move(type_info_cache));
+  }
   absl::StatusOr<TypecheckedModule> tm_or =
       ParseAndTypecheck(program, filename, module_name, &import_data);
   if (!tm_or.ok()) {
@@ -403,31 +546,80 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
   }
 
   // Run unit tests.
+  if (options.bytecode_cache_dir.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<BytecodeCache> bytecode_cache,
+        BytecodeCache::Create(&import_data,
+                              options.bytecode_cache_dir.value()));
+    import_data.SetBytecodeCache(std::move(bytecode_cache));
+  } else {
+    import_data.SetBytecodeCache(
+        std::make_unique<BytecodeCache>(&import_data));
+  }
+  std::vector<std::string> test_names;
   for (const std::string& test_name : entry_module->GetTestNames()) {
     if (!TestMatchesFilter(test_name, options.test_filter)) {
       skipped += 1;
       continue;
     }
+    test_names.push_back(test_name);
+  }
 
-    ran += 1;
-    std::cerr << "[ RUN UNITTEST  ] " << test_name << std::endl;
-    absl::Status status;
+  auto run_test = [&](const std::string& test_name) -> absl::Status {
     ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
-    if (std::holds_alternative<TestFunction*>(*member)) {
-      XLS_ASSIGN_OR_RETURN(TestFunction * tf, entry_module->GetTest(test_name));
-      status = RunTestFunction(&import_data, tm_or.value().type_info,
-                               entry_module, tf, post_fn_eval_hook);
-    } else {
+    if (std::holds_alternative<TestProc*>(*member)) {
       XLS_ASSIGN_OR_RETURN(TestProc * tp, entry_module->GetTestProc(test_name));
-      status =
-          RunTestProc(&import_data, tm_or.value().type_info, entry_module, tp);
+      return RunTestProc(&import_data, tm_or.value().type_info, entry_module,
+                         tp);
+    }
+    XLS_ASSIGN_OR_RETURN(TestFunction * tf, entry_module->GetTest(test_name));
+    absl::StatusOr<bool> jit_ran = false;
+    if (options.execute_on_jit) {
+      jit_ran = RunTestFunctionOnJit(&import_data, tf, options.convert_options);
+    }
+    if (jit_ran.ok() && *jit_ran) {
+      return absl::OkStatus();
+    }
+    // Either the test couldn't be run on the JIT or it failed there; in the
+    // latter case the bytecode interpreter is rerun to report the failure with
+    // its source position.
+    absl::Status status = RunTestFunction(&import_data, tm_or.value().type_info,
+                                          entry_module, tf, post_fn_eval_hook);
+    if (status.ok() && !jit_ran.ok()) {
+      return absl::InternalError(absl::StrFormat(
+          "Test failed on the JIT but passed on the bytecode interpreter; JIT "
+          "status: %s",
+          jit_ran.status().ToString()));
     }
+    return status;
+  };
 
+  auto report = [&](const std::string& test_name, const absl::Status& status) {
     if (status.ok()) {
       std::cerr << "[            OK ]" << std::endl;
     } else {
       handle_error(status, test_name, /*is_quickcheck=*/false);
     }
+  };
+
+  ran = test_names.size();
+  if (options.thread_count > 1) {
+    // Tests are independent, so run them all up front and report the results
+    // in module order.
+    std::vector<absl::Status> statuses(test_names.size());
+    ParallelFor(test_names.size(), options.thread_count,
+                [&](int64_t worker, int64_t i) {
+                  statuses[i] = run_test(test_names[i]);
+                });
+    for (int64_t i = 0; i < test_names.size(); ++i) {
+      std::cerr << "[ RUN UNITTEST  ] " << test_names[i] << std::endl;
+      report(test_names[i], statuses[i]);
+    }
+  } else {
+    for (const std::string& test_name : test_names) {
+      std::cerr << "[ RUN UNITTEST  ] " << test_name << std::endl;
+      report(test_name, run_test(test_name));
+    }
   }
 
   std::cerr << absl::StreamFormat(
@@ -439,7 +631,7 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
   if (!entry_module->GetQuickChecks().empty()) {
     XLS_RETURN_IF_ERROR(RunQuickChecksIfJitEnabled(
         entry_module, tm_or.value().type_info, options.run_comparator,
-        ir_package.get(), options.seed, handle_error));
+        ir_package.get(), options.seed, options.thread_count, handle_error));
   }
 
   return failed == 0 ? TestResult::kAllPassed : TestResult::kSomeFailed;
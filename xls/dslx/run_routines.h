@@ -18,6 +18,7 @@
 #ifndef XLS_DSLX_RUN_ROUTINES_H_
 #define XLS_DSLX_RUN_ROUTINES_H_
 
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/ir_converter.h"
@@ -41,6 +42,9 @@ enum class CompareMode {
 //
 // Implementation note: slightly simpler to keep in object form so we can
 // inspect cache state more easily than closing over it, e.g. for testing.
+//
+// RunComparison() may be called concurrently (e.g. from tests run in
+// parallel); comparisons are serialized internally.
 class RunComparator {
  public:
   explicit RunComparator(CompareMode mode) : mode_(mode) {}
@@ -57,17 +61,25 @@ class RunComparator {
   // already been mangled (see MangleDslxName) so it should be unique in the
   // program and is used as the cache key.
   //
-  // Note: There is no locking in jit compilation or on the jit function cache
-  // so this function is *not* thread-safe.
+  // Note: the returned FunctionJit is not thread-safe, so it must not be run
+  // concurrently with RunComparison() or with other users of the same
+  // function.
   absl::StatusOr<FunctionJit*> GetOrCompileJitFunction(
-      std::string ir_name, xls::Function* ir_function);
+      std::string ir_name, xls::Function* ir_function)
+      ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
   friend class RunRoutinesTest_TestInvokedFunctionDoesJit_Test;
   friend class RunRoutinesTest_QuickcheckInvokedFunctionDoesJit_Test;
   friend class RunRoutinesTest_NoSeedStillQuickChecks_Test;
 
-  absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> jit_cache_;
+  absl::StatusOr<FunctionJit*> GetOrCompileJitFunctionLocked(
+      std::string ir_name, xls::Function* ir_function)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> jit_cache_
+      ABSL_GUARDED_BY(mutex_);
   CompareMode mode_;
 };
 
@@ -81,6 +93,13 @@ class RunComparator {
 //   seed: Seed for QuickCheck random input stimulus.
 //   convert_options: Options used in IR conversion, see `ConvertOptions` for
 //    details.
+//   execute_on_jit: Whether to run test functions by converting them to IR and
+//    executing them on the JIT, rather than on the bytecode interpreter. Tests
+//    which cannot be converted still run on the bytecode interpreter, as does
+//    any test which fails on the JIT (to report the failure with its source
+//    position). `run_comparator` only checks bytecode-interpreted tests.
+//   thread_count: Number of threads on which to run unit tests and quickcheck
+//    samples. Test results are still reported in module order.
 struct ParseAndTestOptions {
   std::string stdlib_path = xls::kDefaultDslxStdlibPath;
   absl::Span<const std::filesystem::path> dslx_paths = {};
@@ -91,6 +110,14 @@ struct ParseAndTestOptions {
   std::optional<int64_t> seed = absl::nullopt;
   ConvertOptions convert_options;
   bool warnings_as_errors = true;
+  bool execute_on_jit = false;
+  // Directory of a persistent cache of the type information of imported
+  // modules (see TypeInfoCache), if any.
+  std::optional<std::string> type_info_cache_dir = absl::nullopt;
+  int64_t thread_count = 1;
+  // Directory of a persistent cache of the bytecode emitted for tests and the
+  // functions they call (see BytecodeCache), if any.
+  std::optional<std::string> bytecode_cache_dir = absl::nullopt;
 };
 
 enum class TestResult {
@@ -127,10 +154,16 @@ struct QuickCheckResults {
 // xls_function is a predicate we're trying to find evidence to falsify, so if
 // this finds an example that falsifies the predicate, we early-return (i.e. the
 // length of the returned vectors may be < 1000).
+//
+// Arguments are drawn in fixed-size shards, each with a random engine seeded
+// from `seed` and the shard index, and the shards are run on up to
+// `thread_count` threads. The results for a given seed are the same however
+// many threads are used.
 absl::StatusOr<QuickCheckResults> DoQuickCheck(xls::Function* xls_function,
                                                std::string ir_name,
                                                RunComparator* run_comparator,
-                                               int64_t seed, int64_t num_tests);
+                                               int64_t seed, int64_t num_tests,
+                                               int64_t thread_count = 1);
 
 }  // namespace xls::dslx
 
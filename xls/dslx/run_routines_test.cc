@@ -105,6 +105,84 @@ fn trivial(x: u5) -> bool { false }
   EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed));
 }
 
+TEST(RunRoutinesTest, TestsExecuteOnJit) {
+  constexpr std::string_view kProgram = R"(
+fn sum_to(n: u32) -> u32 {
+  for (i, accum) : (u32, u32) in range(u32:0, n) {
+    accum + i
+  }(u32:0)
+}
+
+#[test]
+fn test_sum() {
+  let _ = assert_eq(sum_to(u32:10), u32:45);
+  ()
+}
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  ParseAndTestOptions options;
+  options.execute_on_jit = true;
+  absl::StatusOr<TestResult> result =
+      ParseAndTest(kProgram, kModuleName, kFilename, options);
+  EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kAllPassed));
+}
+
+TEST(RunRoutinesTest, FailingTestOnJit) {
+  constexpr std::string_view kProgram = R"(
+#[test]
+fn test_wrong() {
+  let _ = assert_eq(u32:1 + u32:1, u32:3);
+  ()
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto temp_file,
+                           TempFile::CreateWithContent(kProgram, "_test.x"));
+  constexpr const char* kModuleName = "test";
+  ParseAndTestOptions options;
+  options.execute_on_jit = true;
+  absl::StatusOr<TestResult> result = ParseAndTest(
+      kProgram, kModuleName, std::string(temp_file.path()), options);
+  EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed));
+}
+
+TEST(RunRoutinesTest, TestsRunConcurrently) {
+  constexpr std::string_view kProgram = R"(
+#[test]
+fn test_add() {
+  let _ = assert_eq(u32:1 + u32:1, u32:2);
+  ()
+}
+
+#[test]
+fn test_wrong() {
+  let _ = assert_eq(u32:1 + u32:1, u32:3);
+  ()
+}
+
+#[test]
+fn test_sub() {
+  let _ = assert_eq(u32:3 - u32:1, u32:2);
+  ()
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto temp_file,
+                           TempFile::CreateWithContent(kProgram, "_test.x"));
+  constexpr const char* kModuleName = "test";
+  RunComparator jit_comparator(CompareMode::kJit);
+  ParseAndTestOptions options;
+  options.run_comparator = &jit_comparator;
+  options.thread_count = 4;
+  absl::StatusOr<TestResult> result = ParseAndTest(
+      kProgram, kModuleName, std::string(temp_file.path()), options);
+  EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed));
+
+  options.test_filter = "test_sub";
+  result = ParseAndTest(kProgram, kModuleName, std::string(temp_file.path()),
+                        options);
+  EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kAllPassed));
+}
+
 TEST(RunRoutinesTest, FailingProc) {
   constexpr std::string_view kProgram = R"(
 #[test_proc()]
@@ -251,4 +329,57 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// The samples drawn for a given seed do not depend on the number of threads
+// they are run on.
+TEST(QuickcheckTest, ThreadCountDoesNotChangeResults) {
+  Package package("always_true");
+  std::string ir_text = R"(
+  fn ret_true(x: bits[32]) -> bits[1] {
+    ret eq_value: bits[1] = eq(x, x)
+  }
+  )";
+  int64_t seed = 12345;
+  int64_t num_tests = 1000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto serial,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto parallel, DoQuickCheck(function, kFakeIrName, &jit_comparator, seed,
+                                  num_tests, /*thread_count=*/4));
+
+  EXPECT_EQ(parallel.arg_sets.size(), 1000);
+  EXPECT_EQ(parallel.arg_sets, serial.arg_sets);
+  EXPECT_EQ(parallel.results, serial.results);
+}
+
+// Only the samples up to the first falsifying example are reported, however
+// many threads run.
+TEST(QuickcheckTest, FalsifiedWithThreads) {
+  Package package("sometimes_false");
+  std::string ir_text = R"(
+  fn gt_one(x: bits[8]) -> bits[1] {
+    literal.2: bits[8] = literal(value=1)
+    ret ugt.3: bits[1] = ugt(x, literal.2)
+  }
+  )";
+  int64_t seed = 12345;
+  int64_t num_tests = 1000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto serial,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto parallel, DoQuickCheck(function, kFakeIrName, &jit_comparator, seed,
+                                  num_tests, /*thread_count=*/4));
+
+  EXPECT_EQ(parallel.results.back(), Value(UBits(0, 1)));
+  EXPECT_EQ(parallel.arg_sets, serial.arg_sets);
+  EXPECT_EQ(parallel.results, serial.results);
+}
+
 }  // namespace xls::dslx
@@ -100,24 +100,24 @@ bool Scanner::TryDropChar(char target) {
 }
 
 absl::StatusOr<Token> Scanner::PopComment(const Pos& start_pos) {
-  std::string chars;
+  const int64_t start_index = index_;
   while (!AtCharEof()) {
-    char c = PopChar();
-    chars.append(1, c);
-    if (c == '\n') {
+    if (PopChar() == '\n') {
       break;
     }
   }
-  return Token(TokenKind::kComment, Span(start_pos, GetPos()), chars);
+  return Token(TokenKind::kComment, Span(start_pos, GetPos()),
+               std::string(GetTextSince(start_index)));
 }
 
 absl::StatusOr<Token> Scanner::PopWhitespace(const Pos& start_pos) {
   XLS_CHECK(AtWhitespace());
-  std::string chars;
+  const int64_t start_index = index_;
   while (!AtCharEof() && AtWhitespace()) {
-    chars.append(1, PopChar());
+    DropChar();
   }
-  return Token(TokenKind::kWhitespace, Span(start_pos, GetPos()), chars);
+  return Token(TokenKind::kWhitespace, Span(start_pos, GetPos()),
+               std::string(GetTextSince(start_index)));
 }
 
 // This is too simple to need to return absl::Status. Just never call it
@@ -272,12 +272,14 @@ absl::StatusOr<Token> Scanner::ScanIdentifierOrKeyword(char startc,
     return std::isalpha(c) || std::isdigit(c) || c == '_' || c == '!' ||
            c == '\'';
   };
-  std::string s = ScanWhile(startc, is_trailing_identifier_char);
+  // Keywords are matched against the text in place, only identifiers are
+  // copied out of it.
+  std::string_view s = ScanWhile(index_ - 1, is_trailing_identifier_char);
   Span span(start_pos, GetPos());
   if (std::optional<Keyword> keyword = GetKeyword(s)) {
     return Token(span, *keyword);
   }
-  return Token(TokenKind::kIdentifier, span, std::move(s));
+  return Token(TokenKind::kIdentifier, span, std::string(s));
 }
 
 absl::StatusOr<std::optional<Token>> Scanner::TryPopWhitespaceOrComment() {
@@ -298,25 +300,29 @@ absl::StatusOr<std::optional<Token>> Scanner::TryPopWhitespaceOrComment() {
 }
 
 absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
+  // Index of `startc`, which includes the minus sign of negative numbers.
+  const int64_t start_index = index_ - 1;
   bool negative = startc == '-';
   if (negative) {
     startc = PopChar();
   }
+  const int64_t digits_index = index_ - 1;
 
-  std::string s;
+  std::string_view digits;
   if (startc == '0' && TryDropChar('x')) {  // Hex radix.
-    s = ScanWhile("0x", [](char c) {
+    digits = ScanWhile(digits_index, [](char c) {
       return ('0' <= c && c <= '9') || ('a' <= c && c <= 'f') ||
              ('A' <= c && c <= 'F') || c == '_';
     });
-    if (s == "0x") {
+    if (digits == "0x") {
       return ScanError(Span(GetPos(), GetPos()),
                        "Expected hex characters following 0x prefix.");
     }
   } else if (startc == '0' && TryDropChar('b')) {  // Bin prefix.
-    s = ScanWhile("0b",
-                  [](char c) { return ('0' <= c && c <= '1') || c == '_'; });
-    if (s == "0b") {
+    digits = ScanWhile(digits_index, [](char c) {
+      return ('0' <= c && c <= '1') || c == '_';
+    });
+    if (digits == "0b") {
       return ScanError(Span(GetPos(), GetPos()),
                        "Expected binary characters following 0b prefix");
     }
@@ -326,19 +332,18 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
           absl::StrFormat("Invalid digit for binary number: '%c'", PeekChar()));
     }
   } else {
-    s = ScanWhile(startc, [](char c) { return std::isdigit(c); });
-    if (absl::StartsWith(s, "0") && s.size() != 1) {
+    digits =
+        ScanWhile(digits_index, [](char c) { return std::isdigit(c) != 0; });
+    if (absl::StartsWith(digits, "0") && digits.size() != 1) {
       return ScanError(
           Span(GetPos(), GetPos()),
           "Invalid radix for number, expect 0b or 0x because of leading 0.");
     }
-    XLS_CHECK(!s.empty())
+    XLS_CHECK(!digits.empty())
         << "Must have seen numerical digits to attempt to scan a number.";
   }
-  if (negative) {
-    s = "-" + s;
-  }
-  return Token(TokenKind::kNumber, Span(start_pos, GetPos()), s);
+  return Token(TokenKind::kNumber, Span(start_pos, GetPos()),
+               std::string(GetTextSince(start_index)));
 }
 
 std::string KeywordToString(Keyword keyword) {
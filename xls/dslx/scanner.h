@@ -15,7 +15,9 @@
 #ifndef XLS_DSLX_CPP_SCANNER_H_
 #define XLS_DSLX_CPP_SCANNER_H_
 
+#include <memory>
 #include <string>
+#include <string_view>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -189,7 +191,7 @@ class Scanner {
  public:
   Scanner(std::string filename, std::string text,
           bool include_whitespace_and_comments = false)
-      : filename_(std::move(filename)),
+      : filename_(std::make_shared<const std::string>(std::move(filename))),
         text_(std::move(text)),
         include_whitespace_and_comments_(include_whitespace_and_comments) {}
 
@@ -266,19 +268,19 @@ class Scanner {
   absl::StatusOr<Token> ScanChar(const Pos& start_pos);
 
   // Scans from the current position until ftake returns false or EOF is
-  // reached.
-  std::string ScanWhile(std::string s, const std::function<bool(char)>& ftake) {
-    while (!AtCharEof()) {
-      char peek = PeekChar();
-      if (!ftake(peek)) {
-        break;
-      }
-      s.append(1, PopChar());
+  // reached, and returns the text from `start_index` up to the new position.
+  // The result is a view into the text, so no characters are copied.
+  template <typename TakeFn>
+  std::string_view ScanWhile(int64_t start_index, TakeFn ftake) {
+    while (!AtCharEof() && ftake(PeekChar())) {
+      DropChar();
     }
-    return s;
+    return GetTextSince(start_index);
   }
-  std::string ScanWhile(char c, const std::function<bool(char)>& ftake) {
-    return ScanWhile(std::string(1, c), ftake);
+
+  // Returns the text from `start_index` up to the current position.
+  std::string_view GetTextSince(int64_t start_index) const {
+    return std::string_view(text_).substr(start_index, index_ - start_index);
   }
 
   // Scans the identifier-looping entity beginning with startc.
@@ -371,7 +373,8 @@ class Scanner {
   // are valid constituents of a string.
   absl::StatusOr<std::string> ProcessNextStringChar();
 
-  std::string filename_;
+  // Shared by the positions of all scanned tokens.
+  std::shared_ptr<const std::string> filename_;
   std::string text_;
   bool include_whitespace_and_comments_;
   int64_t index_ = 0;
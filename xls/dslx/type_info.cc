@@ -33,6 +33,7 @@ std::string InvocationData::ToString() const {
 // -- class TypeInfoOwner
 
 absl::StatusOr<TypeInfo*> TypeInfoOwner::New(Module* module, TypeInfo* parent) {
+  absl::MutexLock lock(mutex_.get());
   // Note: private constructor so not using make_unique.
   type_infos_.push_back(absl::WrapUnique(new TypeInfo(module, parent)));
   TypeInfo* result = type_infos_.back().get();
@@ -53,6 +54,7 @@ absl::StatusOr<TypeInfo*> TypeInfoOwner::New(Module* module, TypeInfo* parent) {
 }
 
 absl::StatusOr<TypeInfo*> TypeInfoOwner::GetRootTypeInfo(const Module* module) {
+  absl::MutexLock lock(mutex_.get());
   auto it = module_to_root_.find(module);
   if (it == module_to_root_.end()) {
     return absl::NotFoundError(absl::StrCat(
@@ -61,16 +63,34 @@ absl::StatusOr<TypeInfo*> TypeInfoOwner::GetRootTypeInfo(const Module* module) {
   return it->second;
 }
 
+int64_t TypeInfoOwner::type_info_count() const {
+  absl::MutexLock lock(mutex_.get());
+  return type_infos_.size();
+}
+
+std::vector<TypeInfo*> TypeInfoOwner::GetTypeInfosSince(int64_t start) const {
+  absl::MutexLock lock(mutex_.get());
+  std::vector<TypeInfo*> result;
+  for (int64_t i = start; i < type_infos_.size(); ++i) {
+    result.push_back(type_infos_[i].get());
+  }
+  return result;
+}
+
 // -- class TypeInfo
 
 void TypeInfo::NoteConstExpr(const AstNode* const_expr, InterpValue value) {
-  const_exprs_.insert({const_expr, value});
+  absl::MutexLock lock(&mutex_);
+  const_exprs_.insert({const_expr, std::move(value)});
 }
 
 absl::StatusOr<InterpValue> TypeInfo::GetConstExpr(
     const AstNode* const_expr) const {
-  if (auto it = const_exprs_.find(const_expr); it != const_exprs_.end()) {
-    return it->second.value();
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = const_exprs_.find(const_expr); it != const_exprs_.end()) {
+      return it->second.value();
+    }
   }
 
   if (parent_ != nullptr) {
@@ -85,8 +105,11 @@ absl::StatusOr<InterpValue> TypeInfo::GetConstExpr(
 }
 
 bool TypeInfo::IsKnownConstExpr(const AstNode* node) {
-  if (const_exprs_.contains(node)) {
-    return const_exprs_.at(node).has_value();
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = const_exprs_.find(node); it != const_exprs_.end()) {
+      return it->second.has_value();
+    }
   }
 
   if (parent_ != nullptr) {
@@ -97,8 +120,11 @@ bool TypeInfo::IsKnownConstExpr(const AstNode* node) {
 }
 
 bool TypeInfo::IsKnownNonConstExpr(const AstNode* node) {
-  if (const_exprs_.contains(node)) {
-    return !const_exprs_.at(node).has_value();
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = const_exprs_.find(node); it != const_exprs_.end()) {
+      return !it->second.has_value();
+    }
   }
 
   if (parent_ != nullptr) {
@@ -145,9 +171,10 @@ void TypeInfo::AddInvocationCallBindings(const Invocation* call,
               << call->ToString() << " @ " << call->span()
               << " caller: " << caller.ToString()
               << " callee: " << callee.ToString();
+  absl::MutexLock lock(&top->mutex_);
   auto it = top->invocations_.find(call);
   if (it == top->invocations_.end()) {
-    absl::flat_hash_map<SymbolicBindings, SymbolicBindings> symbind_map;
+    absl::node_hash_map<SymbolicBindings, SymbolicBindings> symbind_map;
     symbind_map.emplace(std::move(caller), std::move(callee));
     top->invocations_[call] =
         InvocationData{call, std::move(symbind_map)};
@@ -163,6 +190,7 @@ std::optional<bool> TypeInfo::GetRequiresImplicitToken(
   XLS_CHECK_EQ(f->owner(), module_) << "function owner: " << f->owner()->name()
                                     << " module: " << module_->name();
   const TypeInfo* root = GetRoot();
+  absl::MutexLock lock(&root->mutex_);
   const absl::flat_hash_map<const Function*, bool>& map =
       root->requires_implicit_token_;
   auto it = map.find(f);
@@ -181,6 +209,7 @@ void TypeInfo::NoteRequiresImplicitToken(const Function* f, bool is_required) {
   XLS_VLOG(6) << absl::StreamFormat(
       "NoteRequiresImplicitToken %p: %s::%s => %s", root, f->owner()->name(),
       f->identifier(), is_required ? "true" : "false");
+  absl::MutexLock lock(&root->mutex_);
   root->requires_implicit_token_.emplace(f, is_required);
 }
 
@@ -189,6 +218,7 @@ std::optional<TypeInfo*> TypeInfo::GetInvocationTypeInfo(
   XLS_CHECK_EQ(invocation->owner(), module_)
       << invocation->owner()->name() << " vs " << module_->name();
   const TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->mutex_);
   auto it = top->invocations_.find(invocation);
   if (it == top->invocations_.end()) {
     XLS_VLOG(5) << "Could not find instantiation for invocation: "
@@ -211,6 +241,7 @@ void TypeInfo::SetInvocationTypeInfo(const Invocation* invocation,
                                      TypeInfo* type_info) {
   XLS_CHECK_EQ(invocation->owner(), module_);
   TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->mutex_);
   InvocationData& data = top->invocations_[invocation];
   data.instantiations[caller] = type_info;
 }
@@ -244,8 +275,9 @@ TypeInfo::GetInvocationCalleeBindings(const Invocation* invocation,
       "TypeInfo %p getting instantiation symbolic bindings: %p %s @ %s %s", top,
       invocation, invocation->ToString(),
       invocation->span().ToString(), caller.ToString());
-  auto it = top->invocations().find(invocation);
-  if (it == top->invocations().end()) {
+  absl::MutexLock lock(&top->mutex_);
+  auto it = top->invocations_.find(invocation);
+  if (it == top->invocations_.end()) {
     XLS_VLOG(3) << "Could not find instantiation " << invocation
                 << " in top-level type info: " << top;
     return absl::nullopt;
@@ -270,6 +302,7 @@ void TypeInfo::AddSliceStartAndWidth(Slice* node,
                                      StartAndWidth start_width) {
   XLS_CHECK_EQ(node->owner(), module_);
   TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->mutex_);
   auto it = top->slices_.find(node);
   if (it == top->slices_.end()) {
     top->slices_[node] =
@@ -284,6 +317,7 @@ std::optional<StartAndWidth> TypeInfo::GetSliceStartAndWidth(
     Slice* node, const SymbolicBindings& symbolic_bindings) const {
   XLS_CHECK_EQ(node->owner(), module_);
   const TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->mutex_);
   auto it = top->slices_.find(node);
   if (it == top->slices_.end()) {
     return absl::nullopt;
@@ -296,6 +330,28 @@ std::optional<StartAndWidth> TypeInfo::GetSliceStartAndWidth(
   return it2->second;
 }
 
+void TypeInfo::NoteConstExprEvaluation(const Expr* expr,
+                                       const SymbolicBindings& env,
+                                       InterpValue value) {
+  XLS_CHECK_EQ(expr->owner(), module_);
+  TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->mutex_);
+  top->const_expr_evaluations_.insert_or_assign(std::make_pair(expr, env),
+                                                std::move(value));
+}
+
+std::optional<InterpValue> TypeInfo::GetConstExprEvaluation(
+    const Expr* expr, const SymbolicBindings& env) const {
+  XLS_CHECK_EQ(expr->owner(), module_);
+  const TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->mutex_);
+  auto it = top->const_expr_evaluations_.find(std::make_pair(expr, env));
+  if (it == top->const_expr_evaluations_.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
 void TypeInfo::AddImport(Import* import, Module* module, TypeInfo* type_info) {
   XLS_CHECK_EQ(import->owner(), module_);
   GetRoot()->imports_[import] = ImportedInfo{module, type_info};
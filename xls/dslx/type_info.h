@@ -17,6 +17,11 @@
 #ifndef XLS_DSLX_TYPE_INFO_H_
 #define XLS_DSLX_TYPE_INFO_H_
 
+#include <optional>
+#include <utility>
+
+#include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/ast.h"
 #include "xls/dslx/concrete_type.h"
 #include "xls/dslx/symbolic_bindings.h"
@@ -50,8 +55,10 @@ struct InvocationData {
   // Invocation/Spawn AST node.
   const Invocation* node;
   // Map from symbolic bindings in the caller to the corresponding symbolic
-  // bindings in the callee for this invocation.
-  absl::flat_hash_map<SymbolicBindings, SymbolicBindings> symbolic_bindings_map;
+  // bindings in the callee for this invocation. Node-based so that pointers to
+  // callee bindings stay valid as instantiations are added (possibly by
+  // another thread, see TypeInfo).
+  absl::node_hash_map<SymbolicBindings, SymbolicBindings> symbolic_bindings_map;
   // Type information that is specialized for a particular parametric
   // instantiation of an invocation.
   absl::flat_hash_map<SymbolicBindings, TypeInfo*> instantiations;
@@ -69,6 +76,8 @@ struct InvocationData {
 // the program at type checking time, we place all type info objects into this
 // owned pool (arena style ownership to avoid circular references or leaks or
 // any other sort of lifetime issues).
+//
+// Thread-safe: modules may be typechecked concurrently against the same owner.
 class TypeInfoOwner {
  public:
   // Returns an error status iff parent is nullptr and "module" already has a
@@ -79,6 +88,11 @@ class TypeInfoOwner {
   // status error if it is not present.
   absl::StatusOr<TypeInfo*> GetRootTypeInfo(const Module* module);
 
+  // Returns the number of type information objects created so far, and those
+  // created after the first "start" of them (in creation order), respectively.
+  int64_t type_info_count() const;
+  std::vector<TypeInfo*> GetTypeInfosSince(int64_t start) const;
+
  private:
   // Mapping from module to the "root" (or "parentmost") type info -- these have
   // nullptr as their parent. There should only be one of these for any given
@@ -88,8 +102,21 @@ class TypeInfoOwner {
   // Owned type information objects -- TypeInfoOwner is the lifetime owner for
   // these.
   std::vector<std::unique_ptr<TypeInfo>> type_infos_;
+
+  // Guards the members above. Held by pointer so the owner (and the
+  // ImportData holding it) stays movable.
+  std::unique_ptr<absl::Mutex> mutex_ = std::make_unique<absl::Mutex>();
 };
 
+// Note on thread safety: once a module has been typechecked its root TypeInfo
+// is shared by every module that imports it, and importers which are
+// typechecked concurrently may add parametric instantiation information
+// (invocations, slices, implicit token requirements) to it at the same time.
+// That information is guarded by the mutex of the root TypeInfo. Constexpr
+// values, which IR conversion may also note (possibly for several functions
+// at a time), are guarded by the mutex of the TypeInfo holding them. All other
+// information is only written by the typecheck which created the TypeInfo.
+
 class TypeInfo {
  public:
   // Type information can be "differential"; e.g. when we obtain type
@@ -226,12 +253,23 @@ class TypeInfo {
   bool IsKnownNonConstExpr(const AstNode* node);
   absl::StatusOr<InterpValue> GetConstExpr(const AstNode* const_expr) const;
 
+  // Notes the result of interpreting `expr` in the constexpr environment `env`
+  // (the parametric bindings and the values of its constexpr free variables),
+  // so that evaluations of the same expression in the same environment, e.g.
+  // array sizes in other instantiations of a parametric function, can reuse
+  // it. Unlike the above this is kept in the root of the tree.
+  void NoteConstExprEvaluation(const Expr* expr, const SymbolicBindings& env,
+                               InterpValue value);
+  std::optional<InterpValue> GetConstExprEvaluation(
+      const Expr* expr, const SymbolicBindings& env) const;
+
   // Retrieves a string that shows the module associated with this type info and
   // which imported modules are present, suitable for debugging.
   std::string GetImportsDebugString() const;
 
-  const absl::flat_hash_map<const Invocation*, InvocationData>&
-      invocations() const {
+  // Note: not synchronized, for use once typechecking is complete.
+  const absl::node_hash_map<const Invocation*, InvocationData>& invocations()
+      const {
     return invocations_;
   }
 
@@ -242,6 +280,24 @@ class TypeInfo {
     return dict_;
   }
 
+  // Note: as with invocations(), the accessors below are not synchronized and
+  // are for use once typechecking is complete (e.g. for serialization).
+  const absl::flat_hash_map<Slice*, SliceData>& slices() const {
+    return slices_;
+  }
+  const absl::flat_hash_map<const AstNode*, std::optional<InterpValue>>&
+  const_exprs() const {
+    return const_exprs_;
+  }
+  const absl::flat_hash_map<const Function*, bool>& requires_implicit_token()
+      const {
+    return requires_implicit_token_;
+  }
+  const absl::flat_hash_map<const Proc*, TypeInfo*>& top_level_proc_type_infos()
+      const {
+    return top_level_proc_type_info_;
+  }
+
  private:
   friend class TypeInfoOwner;
 
@@ -271,14 +327,21 @@ class TypeInfo {
   Module* module_;
   absl::flat_hash_map<const AstNode*, std::unique_ptr<ConcreteType>> dict_;
   absl::flat_hash_map<Import*, ImportedInfo> imports_;
-  absl::flat_hash_map<const Invocation*, InvocationData> invocations_;
+  absl::node_hash_map<const Invocation*, InvocationData> invocations_;
   absl::flat_hash_map<Slice*, SliceData> slices_;
   absl::flat_hash_map<const AstNode*, std::optional<InterpValue>> const_exprs_;
+  absl::flat_hash_map<std::pair<const Expr*, SymbolicBindings>, InterpValue>
+      const_expr_evaluations_;
   absl::flat_hash_map<const Function*, bool> requires_implicit_token_;
 
   // Maps a Proc to the TypeInfo used for its top-level typechecking.
   absl::flat_hash_map<const Proc*, TypeInfo*> top_level_proc_type_info_;
   TypeInfo* parent_;  // Note: may be nullptr.
+
+  // Guards invocations_, slices_, const_expr_evaluations_ and
+  // requires_implicit_token_, for which only the mutex of the root TypeInfo is
+  // used, and const_exprs_.
+  mutable absl::Mutex mutex_;
 };
 
 // -- Inlines
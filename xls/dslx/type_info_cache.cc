@@ -0,0 +1,903 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_info_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <system_error>  // NOLINT
+#include <tuple>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/type_info_to_proto.h"
+
+namespace xls::dslx {
+namespace {
+
+// Bumped whenever the meaning of cache entries changes.
+constexpr int64_t kFormatVersion = 1;
+
+std::string Sha256Hex(std::string_view data) {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest), SHA256_DIGEST_LENGTH));
+}
+
+bool SameModule(const CachedModuleProto& a, const CachedModuleProto& b) {
+  return std::equal(a.subject().begin(), a.subject().end(),
+                    b.subject().begin(), b.subject().end()) &&
+         a.path() == b.path() && a.digest() == b.digest() &&
+         a.node_count() == b.node_count();
+}
+
+ImportTokens GetSubject(const CachedModuleProto& record) {
+  return ImportTokens(std::vector<std::string>(record.subject().begin(),
+                                               record.subject().end()));
+}
+
+// Builds up a cache entry; modules are added to the entry as the AST nodes
+// they own are referenced.
+class EntryEncoder {
+ public:
+  using GetRecordFn =
+      std::function<absl::StatusOr<CachedModuleProto>(const Module*)>;
+
+  EntryEncoder(TypeInfoCacheEntryProto* entry, GetRecordFn get_record)
+      : entry_(entry), get_record_(std::move(get_record)) {}
+
+  absl::StatusOr<int64_t> GetModuleIndex(const Module* module) {
+    auto it = module_indices_.find(module);
+    if (it != module_indices_.end()) {
+      return it->second;
+    }
+    XLS_ASSIGN_OR_RETURN(CachedModuleProto record, get_record_(module));
+    std::vector<AstNode*> nodes = module->GetNodes();
+    XLS_RET_CHECK_LE(record.node_count(), static_cast<int64_t>(nodes.size()));
+    absl::flat_hash_map<const AstNode*, int64_t>& node_indices =
+        node_indices_[module];
+    for (int64_t i = 0; i < record.node_count(); ++i) {
+      node_indices[nodes[i]] = i;
+    }
+    int64_t index = entry_->modules_size();
+    *entry_->add_modules() = std::move(record);
+    module_indices_[module] = index;
+    return index;
+  }
+
+  absl::StatusOr<AstNodeRefProto> GetNodeRef(const AstNode* node) {
+    XLS_ASSIGN_OR_RETURN(int64_t module_index, GetModuleIndex(node->owner()));
+    const absl::flat_hash_map<const AstNode*, int64_t>& node_indices =
+        node_indices_.at(node->owner());
+    auto it = node_indices.find(node);
+    if (it == node_indices.end()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "AST node `%s` of module %s was not created by parsing",
+          node->ToString(), node->owner()->name()));
+    }
+    AstNodeRefProto ref;
+    ref.set_module(module_index);
+    ref.set_node(it->second);
+    ref.set_kind(static_cast<int32_t>(node->kind()));
+    return ref;
+  }
+
+  absl::StatusOr<ConcreteTypeProto> EncodeType(const ConcreteType& type) {
+    XLS_RETURN_IF_ERROR(NoteDefinitions(type));
+    return ConcreteTypeToProto(type);
+  }
+
+  absl::StatusOr<InterpValueProto> EncodeValue(const InterpValue& value) {
+    XLS_RETURN_IF_ERROR(NoteDefinitions(value));
+    return InterpValueToProto(value);
+  }
+
+  absl::StatusOr<SymbolicBindingsProto> EncodeBindings(
+      const SymbolicBindings& bindings) {
+    SymbolicBindingsProto proto;
+    for (const SymbolicBinding& binding : bindings.bindings()) {
+      SymbolicBindingProto* binding_proto = proto.add_bindings();
+      binding_proto->set_identifier(binding.identifier);
+      XLS_ASSIGN_OR_RETURN(*binding_proto->mutable_value(),
+                           EncodeValue(binding.value));
+    }
+    return proto;
+  }
+
+ private:
+  // Adds the modules holding the struct and enum definitions referred to by
+  // serialized types and values, which are resolved by span upon restoring.
+  absl::Status NoteDefinitions(const ConcreteType& type) {
+    if (auto* s = dynamic_cast<const StructType*>(&type)) {
+      XLS_RETURN_IF_ERROR(GetModuleIndex(s->nominal_type().owner()).status());
+      for (const std::unique_ptr<ConcreteType>& member : s->members()) {
+        XLS_RETURN_IF_ERROR(NoteDefinitions(*member));
+      }
+    } else if (auto* e = dynamic_cast<const EnumType*>(&type)) {
+      XLS_RETURN_IF_ERROR(GetModuleIndex(e->nominal_type().owner()).status());
+    } else if (auto* t = dynamic_cast<const TupleType*>(&type)) {
+      for (const std::unique_ptr<ConcreteType>& member : t->members()) {
+        XLS_RETURN_IF_ERROR(NoteDefinitions(*member));
+      }
+    } else if (auto* a = dynamic_cast<const ArrayType*>(&type)) {
+      XLS_RETURN_IF_ERROR(NoteDefinitions(a->element_type()));
+    } else if (auto* f = dynamic_cast<const FunctionType*>(&type)) {
+      for (const std::unique_ptr<ConcreteType>& param : f->params()) {
+        XLS_RETURN_IF_ERROR(NoteDefinitions(*param));
+      }
+      XLS_RETURN_IF_ERROR(NoteDefinitions(f->return_type()));
+    } else if (auto* c = dynamic_cast<const ChannelType*>(&type)) {
+      XLS_RETURN_IF_ERROR(NoteDefinitions(c->payload_type()));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status NoteDefinitions(const InterpValue& value) {
+    if (std::optional<InterpValue::EnumData> enum_data =
+            value.GetEnumData()) {
+      return GetModuleIndex(enum_data->def->owner()).status();
+    }
+    if (value.HasValues()) {
+      for (const InterpValue& element : value.GetValuesOrDie()) {
+        XLS_RETURN_IF_ERROR(NoteDefinitions(element));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  TypeInfoCacheEntryProto* entry_;
+  GetRecordFn get_record_;
+  absl::flat_hash_map<const Module*, int64_t> module_indices_;
+  absl::flat_hash_map<const Module*,
+                      absl::flat_hash_map<const AstNode*, int64_t>>
+      node_indices_;
+};
+
+// Resolves the references of a cache entry against the modules it refers to.
+//
+// Note: not movable, as the node-finding callback refers to this object.
+class EntryDecoder {
+ public:
+  EntryDecoder(const TypeInfoCacheEntryProto& entry,
+               std::vector<Module*> modules)
+      : modules_(std::move(modules)) {
+    for (int64_t i = 0; i < modules_.size(); ++i) {
+      std::vector<AstNode*> nodes = modules_[i]->GetNodes();
+      nodes.resize(entry.modules(i).node_count());
+      nodes_.push_back(std::move(nodes));
+      paths_.push_back(entry.modules(i).path());
+    }
+    find_node_ = [this](AstNodeKind kind, const Span& span) {
+      return FindDefinition(kind, span);
+    };
+  }
+
+  EntryDecoder(const EntryDecoder&) = delete;
+  EntryDecoder& operator=(const EntryDecoder&) = delete;
+
+  absl::StatusOr<Module*> GetModule(int64_t index) const {
+    XLS_RET_CHECK(index >= 0 && index < modules_.size());
+    return modules_[index];
+  }
+
+  template <typename T = AstNode>
+  absl::StatusOr<T*> GetNode(const AstNodeRefProto& ref) const {
+    XLS_RET_CHECK(ref.module() >= 0 && ref.module() < nodes_.size());
+    const std::vector<AstNode*>& nodes = nodes_[ref.module()];
+    XLS_RET_CHECK(ref.node() >= 0 && ref.node() < nodes.size());
+    AstNode* node = nodes[ref.node()];
+    XLS_RET_CHECK_EQ(static_cast<int32_t>(node->kind()), ref.kind());
+    T* result = dynamic_cast<T*>(node);
+    XLS_RET_CHECK(result != nullptr);
+    return result;
+  }
+
+  absl::StatusOr<std::unique_ptr<ConcreteType>> DecodeType(
+      const ConcreteTypeProto& proto) {
+    return ConcreteTypeFromProto(proto, find_node_);
+  }
+
+  absl::StatusOr<InterpValue> DecodeValue(const InterpValueProto& proto) {
+    return InterpValueFromProto(proto, find_node_);
+  }
+
+  absl::StatusOr<SymbolicBindings> DecodeBindings(
+      const SymbolicBindingsProto& proto) {
+    std::vector<std::pair<std::string, InterpValue>> items;
+    for (const SymbolicBindingProto& binding : proto.bindings()) {
+      XLS_ASSIGN_OR_RETURN(InterpValue value, DecodeValue(binding.value()));
+      items.push_back({binding.identifier(), std::move(value)});
+    }
+    return SymbolicBindings(items);
+  }
+
+ private:
+  absl::StatusOr<const AstNode*> FindDefinition(AstNodeKind kind,
+                                                const Span& span) {
+    std::pair<AstNodeKind, std::string> key(kind, span.ToString());
+    auto it = definitions_.find(key);
+    if (it != definitions_.end()) {
+      return it->second;
+    }
+    for (int64_t i = 0; i < modules_.size(); ++i) {
+      if (paths_[i] != span.filename()) {
+        continue;
+      }
+      if (const AstNode* node = modules_[i]->FindNode(kind, span)) {
+        definitions_[key] = node;
+        return node;
+      }
+    }
+    return absl::NotFoundError(
+        absl::StrFormat("Could not find node with kind %s @ %s",
+                        AstNodeKindToString(kind), span.ToString()));
+  }
+
+  std::vector<Module*> modules_;
+  std::vector<std::vector<AstNode*>> nodes_;
+  std::vector<std::string> paths_;
+  FindNodeFn find_node_;
+  absl::flat_hash_map<std::pair<AstNodeKind, std::string>, const AstNode*>
+      definitions_;
+};
+
+// The contents of a cache entry, resolved (and validated) in full before any
+// of it is applied.
+struct DecodedTypeInfo {
+  Module* module;
+  // Index of the parent among the restored type information objects.
+  std::optional<int64_t> parent;
+  // Existing root type information of another module, if that is the parent.
+  TypeInfo* root_parent = nullptr;
+  std::vector<std::pair<const AstNode*, std::unique_ptr<ConcreteType>>> types;
+  std::vector<std::pair<const AstNode*, InterpValue>> const_exprs;
+  std::vector<std::pair<Import*, Module*>> imports;
+  std::vector<std::pair<const Proc*, int64_t>> proc_type_infos;
+};
+
+struct DecodedRootData {
+  // Null for the root type information of the module being restored.
+  TypeInfo* root;
+  std::vector<std::tuple<const Invocation*, SymbolicBindings, SymbolicBindings>>
+      call_bindings;
+  std::vector<
+      std::tuple<const Invocation*, SymbolicBindings, std::optional<int64_t>>>
+      instantiations;
+  std::vector<std::tuple<Slice*, SymbolicBindings, StartAndWidth>> slices;
+  std::vector<std::pair<const Function*, bool>> implicit_tokens;
+};
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<TypeInfoCache>>
+TypeInfoCache::Create(const std::filesystem::path& directory,
+                      std::optional<std::string> compiler_version) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  if (!compiler_version.has_value()) {
+    XLS_ASSIGN_OR_RETURN(compiler_version, GetDefaultCompilerVersion());
+  }
+  return absl::WrapUnique(
+      new TypeInfoCache(directory, std::move(compiler_version).value()));
+}
+
+/* static */ absl::StatusOr<std::string>
+TypeInfoCache::GetDefaultCompilerVersion() {
+  std::error_code ec;
+  std::filesystem::path binary =
+      std::filesystem::read_symlink("/proc/self/exe", ec);
+  if (ec) {
+    return absl::UnavailableError(absl::StrFormat(
+        "Unable to determine the running binary: %s", ec.message()));
+  }
+  uintmax_t size = std::filesystem::file_size(binary, ec);
+  if (ec) {
+    return absl::UnavailableError(absl::StrFormat(
+        "Unable to stat %s: %s", binary.string(), ec.message()));
+  }
+  std::filesystem::file_time_type mtime =
+      std::filesystem::last_write_time(binary, ec);
+  if (ec) {
+    return absl::UnavailableError(absl::StrFormat(
+        "Unable to stat %s: %s", binary.string(), ec.message()));
+  }
+  return absl::StrFormat("%s:%d:%d", binary.string(), size,
+                         mtime.time_since_epoch().count());
+}
+
+/* static */ TypeInfoCache::RootSnapshot TypeInfoCache::Snapshot(
+    const TypeInfo& root) {
+  RootSnapshot snapshot;
+  snapshot.node_count = root.module()->GetNodes().size();
+  snapshot.type_count = root.dict().size();
+  snapshot.const_expr_count = root.const_exprs().size();
+  for (const auto& [invocation, data] : root.invocations()) {
+    for (const auto& [caller, callee] : data.symbolic_bindings_map) {
+      snapshot.call_bindings.insert({invocation, caller});
+    }
+    for (const auto& [caller, type_info] : data.instantiations) {
+      snapshot.instantiations[{invocation, caller}] = type_info;
+    }
+  }
+  for (const auto& [slice, data] : root.slices()) {
+    for (const auto& [bindings, start_width] : data.bindings_to_start_width) {
+      snapshot.slices.insert({slice, bindings});
+    }
+  }
+  for (const auto& [function, is_required] : root.requires_implicit_token()) {
+    snapshot.implicit_tokens.insert(function);
+  }
+  return snapshot;
+}
+
+std::filesystem::path TypeInfoCache::GetEntryPath(
+    absl::Span<const std::string> subject, const std::filesystem::path& path,
+    std::string_view contents) const {
+  std::string key = absl::StrFormat(
+      "format: %d\ncompiler: %s\nsubject: %s\npath: %s\n", kFormatVersion,
+      compiler_version_, absl::StrJoin(subject, "."), path.string());
+  absl::StrAppend(&key, contents);
+  return directory_ / absl::StrCat(Sha256Hex(key), ".pb");
+}
+
+absl::StatusOr<CachedModuleProto> TypeInfoCache::GetModuleRecord(
+    const Module* module) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = records_.find(module);
+  if (it == records_.end()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Module %s was not imported via the type information cache",
+        module->name()));
+  }
+  return it->second;
+}
+
+std::optional<TypeInfo*> TypeInfoCache::Lookup(
+    absl::Span<const std::string> subject, const std::filesystem::path& path,
+    std::string_view contents, Module* module, ImportData* import_data,
+    WarningCollector* warnings) {
+  CachedModuleProto record;
+  for (const std::string& piece : subject) {
+    record.add_subject(piece);
+  }
+  record.set_path(path.string());
+  record.set_digest(Sha256Hex(contents));
+  record.set_node_count(module->GetNodes().size());
+  {
+    absl::MutexLock lock(&mutex_);
+    records_[module] = std::move(record);
+  }
+
+  std::filesystem::path entry_path = GetEntryPath(subject, path, contents);
+  absl::StatusOr<TypeInfo*> restored =
+      Restore(entry_path, module, import_data, warnings);
+  if (restored.ok()) {
+    XLS_VLOG(2) << "Restored type information from cache: " << entry_path;
+    absl::MutexLock lock(&mutex_);
+    ++hit_count_;
+    return restored.value();
+  }
+  if (absl::IsNotFound(restored.status())) {
+    XLS_VLOG(2) << absl::StreamFormat("Type information cache miss for %s: %s",
+                                      module->name(),
+                                      restored.status().message());
+  } else {
+    XLS_LOG(WARNING) << absl::StreamFormat(
+        "Ignoring invalid type info cache file %s: %s", entry_path.string(),
+        restored.status().ToString());
+  }
+
+  // Note what the imported modules hold now, so Insert() can tell what
+  // typechecking this module adds to them.
+  PendingInsert pending{entry_path,
+                        import_data->type_info_owner().type_info_count(),
+                        {}};
+  std::vector<TypeInfo*> worklist;
+  for (const ModuleMember& member : module->top()) {
+    if (!std::holds_alternative<Import*>(member)) {
+      continue;
+    }
+    absl::StatusOr<ModuleInfo*> imported = import_data->Get(
+        ImportTokens(std::get<Import*>(member)->subject()));
+    if (imported.ok()) {
+      worklist.push_back(imported.value()->type_info());
+    }
+  }
+  while (!worklist.empty()) {
+    TypeInfo* root = worklist.back();
+    worklist.pop_back();
+    if (pending.roots.contains(root)) {
+      continue;
+    }
+    pending.roots[root] = Snapshot(*root);
+    for (const auto& [import, info] : root->imports()) {
+      worklist.push_back(info.type_info);
+    }
+  }
+
+  absl::MutexLock lock(&mutex_);
+  pending_[module] = std::move(pending);
+  ++miss_count_;
+  return absl::nullopt;
+}
+
+absl::StatusOr<TypeInfo*> TypeInfoCache::Restore(
+    const std::filesystem::path& entry_path, Module* module,
+    ImportData* import_data, WarningCollector* warnings) {
+  if (!FileExists(entry_path).ok()) {
+    return absl::NotFoundError("no cache entry");
+  }
+  TypeInfoCacheEntryProto entry;
+  XLS_RETURN_IF_ERROR(ParseProtobinFile(entry_path, &entry));
+
+  // Check the entry was made against the modules as they are now.
+  XLS_RET_CHECK_GT(entry.modules_size(), 0);
+  std::vector<Module*> modules;
+  absl::flat_hash_set<Module*> seen;
+  for (int64_t i = 0; i < entry.modules_size(); ++i) {
+    const CachedModuleProto& cached = entry.modules(i);
+    Module* m = module;
+    if (i != 0) {
+      absl::StatusOr<ModuleInfo*> info =
+          import_data->Get(GetSubject(cached));
+      if (!info.ok()) {
+        return absl::NotFoundError(absl::StrFormat(
+            "module %s is not imported", GetSubject(cached).ToString()));
+      }
+      m = &info.value()->module();
+    }
+    XLS_RET_CHECK(seen.insert(m).second);
+    XLS_ASSIGN_OR_RETURN(CachedModuleProto record, GetModuleRecord(m));
+    if (!SameModule(cached, record)) {
+      return absl::NotFoundError(
+          absl::StrFormat("module %s has changed", m->name()));
+    }
+    modules.push_back(m);
+  }
+  EntryDecoder decoder(entry, std::move(modules));
+  auto get_root = [&](int64_t index) -> absl::StatusOr<TypeInfo*> {
+    XLS_RET_CHECK_GT(index, 0);
+    XLS_ASSIGN_OR_RETURN(Module * m, decoder.GetModule(index));
+    return import_data->GetRootTypeInfo(m);
+  };
+
+  std::vector<DecodedTypeInfo> type_infos;
+  XLS_RET_CHECK_GT(entry.type_infos_size(), 0);
+  for (int64_t i = 0; i < entry.type_infos_size(); ++i) {
+    const CachedTypeInfoProto& cached = entry.type_infos(i);
+    DecodedTypeInfo decoded;
+    XLS_ASSIGN_OR_RETURN(decoded.module, decoder.GetModule(cached.module()));
+    switch (cached.parent_oneof_case()) {
+      case CachedTypeInfoProto::ParentOneofCase::kParent:
+        XLS_RET_CHECK(cached.parent() >= 0 && cached.parent() < i);
+        XLS_RET_CHECK_EQ(type_infos[cached.parent()].module, decoded.module);
+        decoded.parent = cached.parent();
+        break;
+      case CachedTypeInfoProto::ParentOneofCase::kParentRootOf: {
+        XLS_ASSIGN_OR_RETURN(decoded.root_parent,
+                             get_root(cached.parent_root_of()));
+        XLS_RET_CHECK_EQ(decoded.root_parent->module(), decoded.module);
+        break;
+      }
+      case CachedTypeInfoProto::ParentOneofCase::PARENT_ONEOF_NOT_SET:
+        XLS_RET_CHECK_EQ(i, 0);
+        XLS_RET_CHECK_EQ(decoded.module, module);
+        break;
+    }
+    if (i == 0) {
+      XLS_RET_CHECK(!decoded.parent.has_value() &&
+                    decoded.root_parent == nullptr);
+    }
+    for (const CachedTypeEntryProto& type : cached.types()) {
+      XLS_ASSIGN_OR_RETURN(AstNode * node, decoder.GetNode(type.node()));
+      XLS_RET_CHECK_EQ(node->owner(), decoded.module);
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> concrete_type,
+                           decoder.DecodeType(type.type()));
+      decoded.types.push_back({node, std::move(concrete_type)});
+    }
+    for (const CachedConstExprProto& const_expr : cached.const_exprs()) {
+      XLS_ASSIGN_OR_RETURN(AstNode * node, decoder.GetNode(const_expr.node()));
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           decoder.DecodeValue(const_expr.value()));
+      decoded.const_exprs.push_back({node, std::move(value)});
+    }
+    XLS_RET_CHECK(i == 0 || cached.imports().empty());
+    for (const CachedImportProto& import_proto : cached.imports()) {
+      XLS_ASSIGN_OR_RETURN(Import * import,
+                           decoder.GetNode<Import>(import_proto.import()));
+      XLS_RET_CHECK_EQ(import->owner(), module);
+      XLS_RET_CHECK_GT(import_proto.module(), 0);
+      XLS_ASSIGN_OR_RETURN(Module * imported,
+                           decoder.GetModule(import_proto.module()));
+      decoded.imports.push_back({import, imported});
+    }
+    XLS_RET_CHECK(i == 0 || cached.proc_type_infos().empty());
+    for (const CachedProcTypeInfoProto& proc_ti : cached.proc_type_infos()) {
+      XLS_ASSIGN_OR_RETURN(Proc * proc, decoder.GetNode<Proc>(proc_ti.proc()));
+      XLS_RET_CHECK_EQ(proc->owner(), module);
+      XLS_RET_CHECK(proc_ti.type_info() >= 0 &&
+                    proc_ti.type_info() < entry.type_infos_size());
+      decoded.proc_type_infos.push_back({proc, proc_ti.type_info()});
+    }
+    type_infos.push_back(std::move(decoded));
+  }
+
+  std::vector<DecodedRootData> root_data;
+  for (const CachedRootDataProto& cached : entry.root_data()) {
+    DecodedRootData decoded;
+    Module* owner = module;
+    if (cached.module() == 0) {
+      decoded.root = nullptr;
+    } else {
+      XLS_ASSIGN_OR_RETURN(decoded.root, get_root(cached.module()));
+      owner = decoded.root->module();
+    }
+    for (const CachedInvocationProto& invocation_proto :
+         cached.invocations()) {
+      XLS_ASSIGN_OR_RETURN(
+          Invocation * invocation,
+          decoder.GetNode<Invocation>(invocation_proto.invocation()));
+      XLS_RET_CHECK_EQ(invocation->owner(), owner);
+      for (const CachedCallBindingsProto& call_bindings :
+           invocation_proto.call_bindings()) {
+        XLS_ASSIGN_OR_RETURN(SymbolicBindings caller,
+                             decoder.DecodeBindings(call_bindings.caller()));
+        XLS_ASSIGN_OR_RETURN(SymbolicBindings callee,
+                             decoder.DecodeBindings(call_bindings.callee()));
+        decoded.call_bindings.push_back(
+            {invocation, std::move(caller), std::move(callee)});
+      }
+      for (const CachedInstantiationProto& instantiation :
+           invocation_proto.instantiations()) {
+        XLS_ASSIGN_OR_RETURN(SymbolicBindings caller,
+                             decoder.DecodeBindings(instantiation.caller()));
+        std::optional<int64_t> type_info;
+        if (instantiation.has_type_info()) {
+          XLS_RET_CHECK(instantiation.type_info() >= 0 &&
+                        instantiation.type_info() < entry.type_infos_size());
+          type_info = instantiation.type_info();
+        }
+        decoded.instantiations.push_back(
+            {invocation, std::move(caller), type_info});
+      }
+    }
+    for (const CachedSliceProto& slice_proto : cached.slices()) {
+      XLS_ASSIGN_OR_RETURN(Slice * slice,
+                           decoder.GetNode<Slice>(slice_proto.slice()));
+      XLS_RET_CHECK_EQ(slice->owner(), owner);
+      XLS_ASSIGN_OR_RETURN(SymbolicBindings bindings,
+                           decoder.DecodeBindings(slice_proto.bindings()));
+      decoded.slices.push_back(
+          {slice, std::move(bindings),
+           StartAndWidth{slice_proto.start(), slice_proto.width()}});
+    }
+    for (const CachedImplicitTokenProto& implicit_token :
+         cached.implicit_tokens()) {
+      XLS_ASSIGN_OR_RETURN(
+          Function * function,
+          decoder.GetNode<Function>(implicit_token.function()));
+      XLS_RET_CHECK_EQ(function->owner(), owner);
+      decoded.implicit_tokens.push_back(
+          {function, implicit_token.is_required()});
+    }
+    root_data.push_back(std::move(decoded));
+  }
+
+  // Everything checks out; apply the entry.
+  TypeInfoOwner& type_info_owner = import_data->type_info_owner();
+  std::vector<TypeInfo*> created;
+  for (DecodedTypeInfo& decoded : type_infos) {
+    TypeInfo* parent = decoded.parent.has_value()
+                           ? created[decoded.parent.value()]
+                           : decoded.root_parent;
+    XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
+                         type_info_owner.New(decoded.module, parent));
+    created.push_back(type_info);
+  }
+  for (int64_t i = 0; i < type_infos.size(); ++i) {
+    DecodedTypeInfo& decoded = type_infos[i];
+    TypeInfo* type_info = created[i];
+    for (const auto& [node, concrete_type] : decoded.types) {
+      type_info->SetItem(node, *concrete_type);
+    }
+    for (auto& [node, value] : decoded.const_exprs) {
+      type_info->NoteConstExpr(node, std::move(value));
+    }
+    for (const auto& [import, imported] : decoded.imports) {
+      XLS_ASSIGN_OR_RETURN(TypeInfo * imported_root,
+                           import_data->GetRootTypeInfo(imported));
+      type_info->AddImport(import, imported, imported_root);
+    }
+    for (const auto& [proc, index] : decoded.proc_type_infos) {
+      XLS_RETURN_IF_ERROR(
+          type_info->SetTopLevelProcTypeInfo(proc, created[index]));
+    }
+  }
+  for (DecodedRootData& decoded : root_data) {
+    TypeInfo* root = decoded.root == nullptr ? created[0] : decoded.root;
+    for (auto& [invocation, caller, callee] : decoded.call_bindings) {
+      root->AddInvocationCallBindings(invocation, std::move(caller),
+                                      std::move(callee));
+    }
+    for (auto& [invocation, caller, index] : decoded.instantiations) {
+      root->SetInvocationTypeInfo(
+          invocation, std::move(caller),
+          index.has_value() ? created[index.value()] : nullptr);
+    }
+    for (auto& [slice, bindings, start_width] : decoded.slices) {
+      root->AddSliceStartAndWidth(slice, bindings, start_width);
+    }
+    for (const auto& [function, is_required] : decoded.implicit_tokens) {
+      root->NoteRequiresImplicitToken(function, is_required);
+    }
+  }
+  for (const CachedWarningProto& warning : entry.warnings()) {
+    warnings->Add(SpanFromProto(warning.span()), warning.message());
+  }
+  return created[0];
+}
+
+absl::StatusOr<TypeInfoCacheEntryProto> TypeInfoCache::MakeEntry(
+    Module* module, TypeInfo* type_info,
+    absl::Span<const WarningCollector::Entry> warnings,
+    const PendingInsert& pending, ImportData* import_data) const {
+  TypeInfoCacheEntryProto entry;
+  EntryEncoder encoder(
+      &entry,
+      [&](const Module* m) -> absl::StatusOr<CachedModuleProto> {
+        XLS_ASSIGN_OR_RETURN(CachedModuleProto record, GetModuleRecord(m));
+        if (m != module) {
+          // The entry is validated against the modules imported under the
+          // recorded subjects.
+          absl::StatusOr<ModuleInfo*> info =
+              import_data->Get(GetSubject(record));
+          if (!info.ok() || &info.value()->module() != m) {
+            return absl::UnimplementedError(absl::StrFormat(
+                "module %s is not imported as %s", m->name(),
+                GetSubject(record).ToString()));
+          }
+        }
+        return record;
+      });
+
+  XLS_ASSIGN_OR_RETURN(int64_t self_index, encoder.GetModuleIndex(module));
+  XLS_RET_CHECK_EQ(self_index, 0);
+  if (entry.modules(0).node_count() != module->GetNodes().size()) {
+    return absl::UnimplementedError(
+        "type inference synthesized AST nodes for the module");
+  }
+  RootSnapshot empty;
+  for (const auto& [root, snapshot] : pending.roots) {
+    if (root->module()->GetNodes().size() != snapshot.node_count ||
+        root->dict().size() != snapshot.type_count ||
+        root->const_exprs().size() != snapshot.const_expr_count) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "typechecking modified the type information of module %s",
+          root->module()->name()));
+    }
+  }
+
+  std::vector<TypeInfo*> type_infos =
+      import_data->type_info_owner().GetTypeInfosSince(
+          pending.type_info_count);
+  XLS_RET_CHECK(!type_infos.empty() && type_infos[0] == type_info);
+  absl::flat_hash_map<const TypeInfo*, int64_t> type_info_indices;
+  for (int64_t i = 0; i < type_infos.size(); ++i) {
+    type_info_indices[type_infos[i]] = i;
+  }
+  auto get_type_info_index =
+      [&](const TypeInfo* ti) -> absl::StatusOr<int64_t> {
+    auto it = type_info_indices.find(ti);
+    if (it == type_info_indices.end()) {
+      return absl::UnimplementedError(
+          "type information refers to type information created elsewhere");
+    }
+    return it->second;
+  };
+
+  for (int64_t i = 0; i < type_infos.size(); ++i) {
+    const TypeInfo* ti = type_infos[i];
+    CachedTypeInfoProto* cached = entry.add_type_infos();
+    XLS_ASSIGN_OR_RETURN(int64_t module_index,
+                         encoder.GetModuleIndex(ti->module()));
+    cached->set_module(module_index);
+    if (i == 0) {
+      XLS_RET_CHECK(ti->parent() == nullptr);
+    } else if (type_info_indices.contains(ti->parent())) {
+      cached->set_parent(type_info_indices.at(ti->parent()));
+    } else if (pending.roots.contains(ti->parent())) {
+      XLS_ASSIGN_OR_RETURN(int64_t parent_module,
+                           encoder.GetModuleIndex(ti->parent()->module()));
+      cached->set_parent_root_of(parent_module);
+    } else {
+      return absl::UnimplementedError(absl::StrFormat(
+          "type information for module %s has an unknown parent",
+          ti->module()->name()));
+    }
+    for (const auto& [node, concrete_type] : ti->dict()) {
+      CachedTypeEntryProto* type = cached->add_types();
+      XLS_ASSIGN_OR_RETURN(*type->mutable_node(), encoder.GetNodeRef(node));
+      XLS_ASSIGN_OR_RETURN(*type->mutable_type(),
+                           encoder.EncodeType(*concrete_type));
+    }
+    for (const auto& [node, value] : ti->const_exprs()) {
+      XLS_RET_CHECK(value.has_value());
+      CachedConstExprProto* const_expr = cached->add_const_exprs();
+      XLS_ASSIGN_OR_RETURN(*const_expr->mutable_node(),
+                           encoder.GetNodeRef(node));
+      XLS_ASSIGN_OR_RETURN(*const_expr->mutable_value(),
+                           encoder.EncodeValue(value.value()));
+    }
+    if (i != 0) {
+      XLS_RET_CHECK(ti->imports().empty());
+      XLS_RET_CHECK(ti->top_level_proc_type_infos().empty());
+      continue;
+    }
+    for (const auto& [import, info] : ti->imports()) {
+      if (info.type_info == nullptr || info.type_info->parent() != nullptr) {
+        return absl::UnimplementedError(
+            "import does not refer to root type information");
+      }
+      CachedImportProto* cached_import = cached->add_imports();
+      XLS_ASSIGN_OR_RETURN(*cached_import->mutable_import(),
+                           encoder.GetNodeRef(import));
+      XLS_ASSIGN_OR_RETURN(int64_t imported_index,
+                           encoder.GetModuleIndex(info.module));
+      cached_import->set_module(imported_index);
+    }
+    for (const auto& [proc, proc_ti] : ti->top_level_proc_type_infos()) {
+      CachedProcTypeInfoProto* cached_proc = cached->add_proc_type_infos();
+      XLS_ASSIGN_OR_RETURN(*cached_proc->mutable_proc(),
+                           encoder.GetNodeRef(proc));
+      XLS_ASSIGN_OR_RETURN(int64_t index, get_type_info_index(proc_ti));
+      cached_proc->set_type_info(index);
+    }
+  }
+
+  // Records what the root type information holds beyond "snapshot".
+  auto add_root_data = [&](const TypeInfo* root,
+                           const RootSnapshot& snapshot) -> absl::Status {
+    CachedRootDataProto cached;
+    XLS_ASSIGN_OR_RETURN(int64_t module_index,
+                         encoder.GetModuleIndex(root->module()));
+    cached.set_module(module_index);
+    for (const auto& [invocation, data] : root->invocations()) {
+      CachedInvocationProto cached_invocation;
+      for (const auto& [caller, callee] : data.symbolic_bindings_map) {
+        if (snapshot.call_bindings.contains({invocation, caller})) {
+          continue;
+        }
+        CachedCallBindingsProto* call_bindings =
+            cached_invocation.add_call_bindings();
+        XLS_ASSIGN_OR_RETURN(*call_bindings->mutable_caller(),
+                             encoder.EncodeBindings(caller));
+        XLS_ASSIGN_OR_RETURN(*call_bindings->mutable_callee(),
+                             encoder.EncodeBindings(callee));
+      }
+      for (const auto& [caller, instantiation_ti] : data.instantiations) {
+        auto it = snapshot.instantiations.find({invocation, caller});
+        if (it != snapshot.instantiations.end() &&
+            it->second == instantiation_ti) {
+          continue;
+        }
+        CachedInstantiationProto* instantiation =
+            cached_invocation.add_instantiations();
+        XLS_ASSIGN_OR_RETURN(*instantiation->mutable_caller(),
+                             encoder.EncodeBindings(caller));
+        if (instantiation_ti != nullptr) {
+          XLS_ASSIGN_OR_RETURN(int64_t index,
+                               get_type_info_index(instantiation_ti));
+          instantiation->set_type_info(index);
+        }
+      }
+      if (cached_invocation.call_bindings().empty() &&
+          cached_invocation.instantiations().empty()) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(*cached_invocation.mutable_invocation(),
+                           encoder.GetNodeRef(invocation));
+      *cached.add_invocations() = std::move(cached_invocation);
+    }
+    for (const auto& [slice, data] : root->slices()) {
+      for (const auto& [bindings, start_width] :
+           data.bindings_to_start_width) {
+        if (snapshot.slices.contains({slice, bindings})) {
+          continue;
+        }
+        CachedSliceProto* cached_slice = cached.add_slices();
+        XLS_ASSIGN_OR_RETURN(*cached_slice->mutable_slice(),
+                             encoder.GetNodeRef(slice));
+        XLS_ASSIGN_OR_RETURN(*cached_slice->mutable_bindings(),
+                             encoder.EncodeBindings(bindings));
+        cached_slice->set_start(start_width.start);
+        cached_slice->set_width(start_width.width);
+      }
+    }
+    for (const auto& [function, is_required] :
+         root->requires_implicit_token()) {
+      if (snapshot.implicit_tokens.contains(function)) {
+        continue;
+      }
+      CachedImplicitTokenProto* implicit_token = cached.add_implicit_tokens();
+      XLS_ASSIGN_OR_RETURN(*implicit_token->mutable_function(),
+                           encoder.GetNodeRef(function));
+      implicit_token->set_is_required(is_required);
+    }
+    if (module_index == 0 || !cached.invocations().empty() ||
+        !cached.slices().empty() || !cached.implicit_tokens().empty()) {
+      *entry.add_root_data() = std::move(cached);
+    }
+    return absl::OkStatus();
+  };
+  XLS_RETURN_IF_ERROR(add_root_data(type_info, empty));
+  for (const auto& [root, snapshot] : pending.roots) {
+    XLS_RETURN_IF_ERROR(add_root_data(root, snapshot));
+  }
+
+  for (const WarningCollector::Entry& warning : warnings) {
+    CachedWarningProto* cached_warning = entry.add_warnings();
+    *cached_warning->mutable_span() = SpanToProto(warning.span);
+    cached_warning->set_message(warning.message);
+  }
+  return entry;
+}
+
+void TypeInfoCache::Insert(Module* module, TypeInfo* type_info,
+                           absl::Span<const WarningCollector::Entry> warnings,
+                           ImportData* import_data) {
+  PendingInsert pending;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = pending_.find(module);
+    if (it == pending_.end()) {
+      return;
+    }
+    pending = std::move(it->second);
+    pending_.erase(it);
+  }
+  absl::StatusOr<TypeInfoCacheEntryProto> entry =
+      MakeEntry(module, type_info, warnings, pending, import_data);
+  if (!entry.ok()) {
+    XLS_VLOG(1) << absl::StreamFormat(
+        "Not caching type information for module %s: %s", module->name(),
+        entry.status().ToString());
+    return;
+  }
+
+  absl::Status status =
+      SetProtobinFileAtomically(pending.entry_path, entry.value());
+  if (!status.ok()) {
+    XLS_LOG(WARNING) << absl::StreamFormat(
+        "Unable to write type info cache file %s: %s",
+        pending.entry_path.string(), status.ToString());
+    return;
+  }
+  XLS_VLOG(2) << "Wrote type information to cache: " << pending.entry_path;
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,157 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef XLS_DSLX_TYPE_INFO_CACHE_H_
+#define XLS_DSLX_TYPE_INFO_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/dslx/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/symbolic_bindings.h"
+#include "xls/dslx/type_info.h"
+#include "xls/dslx/type_info_cache.pb.h"
+#include "xls/dslx/type_info_cache_interface.h"
+#include "xls/dslx/warning_collector.h"
+
+namespace xls::dslx {
+
+// A type information cache which persists the type information of imported
+// modules in a directory on disk, so that later processes need not re-typecheck
+// e.g. the standard library. Entries are keyed by a hash of the module text,
+// path and import subject along with a compiler version, and record digests of
+// the modules they refer to (an entry is ignored if any of those changed).
+//
+// Modules whose type information cannot be recorded are not cached; e.g. when
+// type inference synthesized AST nodes the type information refers to, or when
+// it holds values with no serialized form (see type_info_to_proto.h).
+//
+// An entry which cannot be restored is logged (unless it is merely absent) and
+// the module is typechecked as usual; the resulting type information is then
+// written to the entry. Write failures are logged and do not fail the import.
+class TypeInfoCache : public TypeInfoCacheInterface {
+ public:
+  // Creates a cache which stores entries in `directory`. The directory is
+  // created if it does not exist. Entries are only shared by caches created
+  // with the same `compiler_version`, which defaults to one identifying the
+  // running binary (see GetDefaultCompilerVersion()).
+  static absl::StatusOr<std::unique_ptr<TypeInfoCache>> Create(
+      const std::filesystem::path& directory,
+      std::optional<std::string> compiler_version = absl::nullopt);
+
+  // Returns a version string identifying the running binary (by its path, size
+  // and modification time).
+  static absl::StatusOr<std::string> GetDefaultCompilerVersion();
+
+  std::optional<TypeInfo*> Lookup(absl::Span<const std::string> subject,
+                                  const std::filesystem::path& path,
+                                  std::string_view contents, Module* module,
+                                  ImportData* import_data,
+                                  WarningCollector* warnings) override;
+  void Insert(Module* module, TypeInfo* type_info,
+              absl::Span<const WarningCollector::Entry> warnings,
+              ImportData* import_data) override;
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  // Number of lookups which were satisfied from and missed the cache
+  // respectively.
+  int64_t hit_count() const {
+    absl::MutexLock lock(&mutex_);
+    return hit_count_;
+  }
+  int64_t miss_count() const {
+    absl::MutexLock lock(&mutex_);
+    return miss_count_;
+  }
+
+ private:
+  // The instantiation information held by the root type information of a
+  // module, used to determine what typechecking an importer adds to it. The
+  // counts are used to check that nothing else was added.
+  struct RootSnapshot {
+    int64_t node_count = 0;
+    int64_t type_count = 0;
+    int64_t const_expr_count = 0;
+    absl::flat_hash_set<std::pair<const Invocation*, SymbolicBindings>>
+        call_bindings;
+    absl::flat_hash_map<std::pair<const Invocation*, SymbolicBindings>,
+                        TypeInfo*>
+        instantiations;
+    absl::flat_hash_set<std::pair<const Slice*, SymbolicBindings>> slices;
+    absl::flat_hash_set<const Function*> implicit_tokens;
+  };
+
+  // State noted by a Lookup() miss for the following Insert().
+  struct PendingInsert {
+    std::filesystem::path entry_path;
+    // Number of type information objects which existed before typechecking.
+    int64_t type_info_count = 0;
+    // Snapshots of the root type information of the modules imported
+    // (transitively) by the module.
+    absl::flat_hash_map<TypeInfo*, RootSnapshot> roots;
+  };
+
+  TypeInfoCache(std::filesystem::path directory, std::string compiler_version)
+      : directory_(std::move(directory)),
+        compiler_version_(std::move(compiler_version)) {}
+
+  static RootSnapshot Snapshot(const TypeInfo& root);
+
+  // Returns the path of the cache entry for the given module.
+  std::filesystem::path GetEntryPath(absl::Span<const std::string> subject,
+                                     const std::filesystem::path& path,
+                                     std::string_view contents) const;
+
+  // Returns the record of a module noted by Lookup(), or a not-found error.
+  absl::StatusOr<CachedModuleProto> GetModuleRecord(const Module* module) const;
+
+  // Restores the entry at "entry_path" for "module"; returns a not-found error
+  // if there is no entry or it is stale.
+  absl::StatusOr<TypeInfo*> Restore(const std::filesystem::path& entry_path,
+                                    Module* module, ImportData* import_data,
+                                    WarningCollector* warnings);
+
+  // Builds the entry for "module" after it has been typechecked.
+  absl::StatusOr<TypeInfoCacheEntryProto> MakeEntry(
+      Module* module, TypeInfo* type_info,
+      absl::Span<const WarningCollector::Entry> warnings,
+      const PendingInsert& pending, ImportData* import_data) const;
+
+  std::filesystem::path directory_;
+  std::string compiler_version_;
+
+  mutable absl::Mutex mutex_;
+  // Records of the modules seen by Lookup(), for validating dependencies.
+  absl::flat_hash_map<const Module*, CachedModuleProto> records_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<const Module*, PendingInsert> pending_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_TYPE_INFO_CACHE_H_
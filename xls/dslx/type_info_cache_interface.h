@@ -0,0 +1,64 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef XLS_DSLX_TYPE_INFO_CACHE_INTERFACE_H_
+#define XLS_DSLX_TYPE_INFO_CACHE_INTERFACE_H_
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/types/span.h"
+#include "xls/dslx/ast.h"
+#include "xls/dslx/type_info.h"
+#include "xls/dslx/warning_collector.h"
+
+namespace xls::dslx {
+
+class ImportData;
+
+// Defines the interface a type must provide in order to serve as a persistent
+// cache of the type information of imported modules. As with
+// BytecodeCacheInterface, this type exists to avoid attaching too many concrete
+// dependencies onto ImportData, which is the cache owner.
+class TypeInfoCacheInterface {
+ public:
+  virtual ~TypeInfoCacheInterface() = default;
+
+  // Attempts to restore the type information of "module", which was just
+  // parsed from "contents" (the text of the file at "path", imported as
+  // "subject"), into "import_data"; the warnings typechecking the module
+  // flagged are added to "warnings". The modules that "module" imports must
+  // already be present in "import_data".
+  //
+  // Returns nullopt if no usable entry exists, in which case the caller
+  // typechecks the module as usual and then calls Insert().
+  virtual std::optional<TypeInfo*> Lookup(absl::Span<const std::string> subject,
+                                          const std::filesystem::path& path,
+                                          std::string_view contents,
+                                          Module* module,
+                                          ImportData* import_data,
+                                          WarningCollector* warnings) = 0;
+
+  // Records the type information (and warnings) produced by typechecking
+  // "module" after a Lookup() miss. Modules whose type information cannot be
+  // recorded are simply not cached.
+  virtual void Insert(Module* module, TypeInfo* type_info,
+                      absl::Span<const WarningCollector::Entry> warnings,
+                      ImportData* import_data) = 0;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_TYPE_INFO_CACHE_INTERFACE_H_
@@ -0,0 +1,123 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_info_cache.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/ir_converter.h"
+#include "xls/dslx/parse_and_typecheck.h"
+
+namespace xls::dslx {
+namespace {
+
+constexpr std::string_view kProgram = R"(
+import float32
+import std
+
+fn main(x: u32, y: u32) -> (float32::F32, u32) {
+  (float32::unflatten(x), std::umax(x, y))
+}
+)";
+
+class TypeInfoCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+    temp_dir_ = std::move(temp_dir);
+  }
+
+  struct Result {
+    std::string ir;
+    int64_t hit_count;
+    int64_t miss_count;
+  };
+
+  // Typechecks and converts the program against a fresh import data which uses
+  // a cache in the temporary directory.
+  absl::StatusOr<Result> Run() {
+    ImportData import_data = CreateImportDataForTest();
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<TypeInfoCache> cache,
+                         TypeInfoCache::Create(temp_dir_->path(), "test"));
+    TypeInfoCache* cache_ptr = cache.get();
+    import_data.SetTypeInfoCache(std::move(cache));
+    XLS_ASSIGN_OR_RETURN(
+        TypecheckedModule tm,
+        ParseAndTypecheck(kProgram, "fake.x", "fake", &import_data));
+    XLS_ASSIGN_OR_RETURN(
+        std::string ir,
+        ConvertModule(tm.module, &import_data,
+                      ConvertOptions{.emit_positions = false}));
+    return Result{ir, cache_ptr->hit_count(), cache_ptr->miss_count()};
+  }
+
+  std::optional<TempDirectory> temp_dir_;
+};
+
+TEST_F(TypeInfoCacheTest, SecondRunHitsCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(Result first, Run());
+  EXPECT_EQ(first.hit_count, 0);
+  EXPECT_GT(first.miss_count, 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Result second, Run());
+  EXPECT_GT(second.hit_count, 0);
+  EXPECT_EQ(second.hit_count + second.miss_count, first.miss_count);
+  EXPECT_EQ(second.ir, first.ir);
+}
+
+TEST_F(TypeInfoCacheTest, DifferentCompilerVersionMisses) {
+  XLS_ASSERT_OK_AND_ASSIGN(Result first, Run());
+
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TypeInfoCache> cache,
+                           TypeInfoCache::Create(temp_dir_->path(), "other"));
+  TypeInfoCache* cache_ptr = cache.get();
+  import_data.SetTypeInfoCache(std::move(cache));
+  XLS_ASSERT_OK(
+      ParseAndTypecheck(kProgram, "fake.x", "fake", &import_data).status());
+  EXPECT_EQ(cache_ptr->hit_count(), 0);
+  EXPECT_EQ(cache_ptr->miss_count(), first.miss_count);
+}
+
+TEST_F(TypeInfoCacheTest, CorruptEntriesAreIgnored) {
+  XLS_ASSERT_OK_AND_ASSIGN(Result first, Run());
+  int64_t entry_count = 0;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(temp_dir_->path())) {
+    XLS_ASSERT_OK(SetFileContents(entry.path(), "not a proto"));
+    ++entry_count;
+  }
+  ASSERT_GT(entry_count, 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Result second, Run());
+  EXPECT_EQ(second.hit_count, 0);
+  EXPECT_EQ(second.ir, first.ir);
+
+  // The entries were rewritten by the run which ignored them.
+  XLS_ASSERT_OK_AND_ASSIGN(Result third, Run());
+  EXPECT_GT(third.hit_count, 0);
+  EXPECT_EQ(third.ir, first.ir);
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -15,6 +15,7 @@
 #include "xls/dslx/type_info_to_proto.h"
 
 #include "xls/common/proto_adaptor_utils.h"
+#include "xls/common/status/ret_check.h"
 
 namespace xls::dslx {
 namespace {
@@ -158,13 +159,29 @@ std::string U8sToString(absl::Span<const uint8_t> bs) {
   return std::string(reinterpret_cast<const char*>(bs.data()), bs.size());
 }
 
+BitsValueProto ToProto(const Bits& bits, bool is_signed) {
+  BitsValueProto proto;
+  proto.set_is_signed(is_signed);
+  proto.set_bit_count(bits.bit_count());
+  *proto.mutable_data() = U8sToString(bits.ToBytes());
+  return proto;
+}
+
 absl::StatusOr<InterpValueProto> ToProto(const InterpValue& v) {
   InterpValueProto proto;
   if (v.IsBits()) {
-    BitsValueProto* bvp = proto.mutable_bits();
-    bvp->set_is_signed(v.IsSBits());
-    bvp->set_bit_count(v.GetBitCount().value());
-    *bvp->mutable_data() = U8sToString(v.GetBitsOrDie().ToBytes());
+    *proto.mutable_bits() = ToProto(v.GetBitsOrDie(), v.IsSBits());
+  } else if (v.IsTuple() || v.IsArray()) {
+    InterpValueElementsProto* elements =
+        v.IsTuple() ? proto.mutable_tuple() : proto.mutable_array();
+    for (const InterpValue& element : v.GetValuesOrDie()) {
+      XLS_ASSIGN_OR_RETURN(*elements->add_elements(), ToProto(element));
+    }
+  } else if (v.IsEnum()) {
+    InterpValue::EnumData enum_data = v.GetEnumData().value();
+    EnumValueProto* evp = proto.mutable_enum_value();
+    *evp->mutable_bits() = ToProto(enum_data.value, enum_data.is_signed);
+    *evp->mutable_enum_def_span() = ToProto(enum_data.def->span());
   } else {
     return absl::UnimplementedError(
         "TypeInfoProto: convert InterpValue to proto: " + v.ToString());
@@ -179,6 +196,10 @@ absl::StatusOr<ParametricExpressionProto> ToProto(
     ParametricSymbolProto* psproto = proto.mutable_symbol();
     psproto->set_identifier(s->identifier());
     *psproto->mutable_span() = ToProto(s->span());
+    if (std::optional<InterpValue> const_value = s->const_value()) {
+      XLS_ASSIGN_OR_RETURN(*psproto->mutable_const_value(),
+                           ToProto(const_value.value()));
+    }
     return proto;
   }
   return absl::UnimplementedError(
@@ -274,10 +295,20 @@ absl::StatusOr<EnumTypeProto> ToProto(const EnumType& enum_type) {
                        ToProto(enum_type.nominal_type()));
   XLS_ASSIGN_OR_RETURN(*proto.mutable_size(), ToProto(enum_type.size()));
   proto.set_is_signed(enum_type.signedness());
+  for (const InterpValue& member : enum_type.members()) {
+    XLS_ASSIGN_OR_RETURN(*proto.add_members(), ToProto(member));
+  }
   XLS_VLOG(5) << "- proto: " << proto.ShortDebugString();
   return proto;
 }
 
+absl::StatusOr<ChannelTypeProto> ToProto(const ChannelType& channel_type) {
+  ChannelTypeProto proto;
+  XLS_ASSIGN_OR_RETURN(*proto.mutable_payload(),
+                       ToProto(channel_type.payload_type()));
+  return proto;
+}
+
 absl::StatusOr<ConcreteTypeProto> ToProto(const ConcreteType& concrete_type) {
   ConcreteTypeProto proto;
   if (const auto* bits = dynamic_cast<const BitsType*>(&concrete_type)) {
@@ -299,6 +330,10 @@ absl::StatusOr<ConcreteTypeProto> ToProto(const ConcreteType& concrete_type) {
     XLS_ASSIGN_OR_RETURN(*proto.mutable_enum_type(), ToProto(*enum_type));
   } else if (dynamic_cast<const TokenType*>(&concrete_type) != nullptr) {
     proto.mutable_token_type();
+  } else if (const auto* channel_type =
+                 dynamic_cast<const ChannelType*>(&concrete_type)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_channel_type(),
+                         ToProto(*channel_type));
   } else {
     return absl::UnimplementedError(
         "TypeInfoToProto: convert ConcreteType to proto: " +
@@ -341,12 +376,49 @@ absl::Span<const uint8_t> ToU8Span(const std::string& s) {
                                    s.size());
 }
 
-absl::StatusOr<InterpValue> FromProto(const InterpValueProto& ivp) {
+Bits FromProto(const BitsValueProto& bvp) {
+  return Bits::FromBytes(ToU8Span(bvp.data()), bvp.bit_count());
+}
+
+// Retrieves the definition of kind T identified by "span" via "find_node".
+template <typename T>
+absl::StatusOr<const T*> FindDef(const FindNodeFn& find_node, AstNodeKind kind,
+                                 const SpanProto& span) {
+  XLS_ASSIGN_OR_RETURN(const AstNode* node, find_node(kind, FromProto(span)));
+  const T* def = dynamic_cast<const T*>(node);
+  XLS_RET_CHECK(def != nullptr) << "Unexpected node for definition @ "
+                                << FromProto(span).ToString();
+  return def;
+}
+
+absl::StatusOr<InterpValue> FromProto(const InterpValueProto& ivp,
+                                      const FindNodeFn& find_node) {
   switch (ivp.value_oneof_case()) {
     case InterpValueProto::ValueOneofCase::kBits: {
-      return InterpValue::MakeBits(
-          ivp.bits().is_signed(),
-          Bits::FromBytes(ToU8Span(ivp.bits().data()), ivp.bits().bit_count()));
+      return InterpValue::MakeBits(ivp.bits().is_signed(),
+                                   FromProto(ivp.bits()));
+    }
+    case InterpValueProto::ValueOneofCase::kTuple:
+    case InterpValueProto::ValueOneofCase::kArray: {
+      const InterpValueElementsProto& elements_proto =
+          ivp.has_tuple() ? ivp.tuple() : ivp.array();
+      std::vector<InterpValue> elements;
+      for (const InterpValueProto& element : elements_proto.elements()) {
+        XLS_ASSIGN_OR_RETURN(InterpValue value, FromProto(element, find_node));
+        elements.push_back(std::move(value));
+      }
+      if (ivp.has_tuple()) {
+        return InterpValue::MakeTuple(std::move(elements));
+      }
+      return InterpValue::MakeArray(std::move(elements));
+    }
+    case InterpValueProto::ValueOneofCase::kEnumValue: {
+      const EnumValueProto& evp = ivp.enum_value();
+      XLS_ASSIGN_OR_RETURN(const EnumDef* enum_def,
+                           FindDef<EnumDef>(find_node, AstNodeKind::kEnumDef,
+                                            evp.enum_def_span()));
+      return InterpValue::MakeEnum(FromProto(evp.bits()),
+                                   evp.bits().is_signed(), enum_def);
     }
     default:
       break;
@@ -358,17 +430,22 @@ absl::StatusOr<InterpValue> FromProto(const InterpValueProto& ivp) {
       ivp.ShortDebugString());
 }
 
-std::unique_ptr<ParametricSymbol> FromProto(
-    const ParametricSymbolProto& proto) {
-  return std::make_unique<ParametricSymbol>(proto.identifier(),
-                                            FromProto(proto.span()));
+absl::StatusOr<std::unique_ptr<ParametricSymbol>> FromProto(
+    const ParametricSymbolProto& proto, const FindNodeFn& find_node) {
+  std::optional<InterpValue> const_value;
+  if (proto.has_const_value()) {
+    XLS_ASSIGN_OR_RETURN(const_value,
+                         FromProto(proto.const_value(), find_node));
+  }
+  return std::make_unique<ParametricSymbol>(
+      proto.identifier(), FromProto(proto.span()), std::move(const_value));
 }
 
 absl::StatusOr<std::unique_ptr<ParametricExpression>> FromProto(
-    const ParametricExpressionProto& proto) {
+    const ParametricExpressionProto& proto, const FindNodeFn& find_node) {
   switch (proto.expr_oneof_case()) {
     case ParametricExpressionProto::ExprOneofCase::kSymbol: {
-      return FromProto(proto.symbol());
+      return FromProto(proto.symbol(), find_node);
     }
     default:
       break;
@@ -380,15 +457,17 @@ absl::StatusOr<std::unique_ptr<ParametricExpression>> FromProto(
       proto.ShortDebugString());
 }
 
-absl::StatusOr<ConcreteTypeDim> FromProto(const ConcreteTypeDimProto& ctdp) {
+absl::StatusOr<ConcreteTypeDim> FromProto(const ConcreteTypeDimProto& ctdp,
+                                          const FindNodeFn& find_node) {
   switch (ctdp.dim_oneof_case()) {
     case ConcreteTypeDimProto::DimOneofCase::kInterpValue: {
-      XLS_ASSIGN_OR_RETURN(InterpValue iv, FromProto(ctdp.interp_value()));
+      XLS_ASSIGN_OR_RETURN(InterpValue iv,
+                           FromProto(ctdp.interp_value(), find_node));
       return ConcreteTypeDim(std::move(iv));
     }
     case ConcreteTypeDimProto::DimOneofCase::kParametric: {
       XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParametricExpression> p,
-                           FromProto(ctdp.parametric()));
+                           FromProto(ctdp.parametric(), find_node));
       return ConcreteTypeDim(std::move(p));
     }
     default:
@@ -401,13 +480,13 @@ absl::StatusOr<ConcreteTypeDim> FromProto(const ConcreteTypeDimProto& ctdp) {
 }
 
 absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
-    const ConcreteTypeProto& ctp, const ImportData& import_data) {
+    const ConcreteTypeProto& ctp, const FindNodeFn& find_node) {
   XLS_VLOG(5) << "Converting ConcreteTypeProto to C++: "
               << ctp.ShortDebugString();
   switch (ctp.concrete_type_oneof_case()) {
     case ConcreteTypeProto::ConcreteTypeOneofCase::kBitsType: {
       XLS_ASSIGN_OR_RETURN(ConcreteTypeDim dim,
-                           FromProto(ctp.bits_type().dim()));
+                           FromProto(ctp.bits_type().dim(), find_node));
       return std::make_unique<BitsType>(ctp.bits_type().is_signed(),
                                         std::move(dim));
     }
@@ -415,7 +494,7 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
       std::vector<std::unique_ptr<ConcreteType>> members;
       for (const ConcreteTypeProto& member : ctp.tuple_type().members()) {
         XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> ct,
-                             FromProto(member, import_data));
+                             FromProto(member, find_node));
         members.push_back(std::move(ct));
       }
       return std::make_unique<TupleType>(std::move(members));
@@ -423,9 +502,9 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
     case ConcreteTypeProto::ConcreteTypeOneofCase::kArrayType: {
       XLS_ASSIGN_OR_RETURN(
           std::unique_ptr<ConcreteType> element_type,
-          FromProto(ctp.array_type().element_type(), import_data));
+          FromProto(ctp.array_type().element_type(), find_node));
       XLS_ASSIGN_OR_RETURN(ConcreteTypeDim size,
-                           FromProto(ctp.array_type().size()));
+                           FromProto(ctp.array_type().size(), find_node));
       return std::make_unique<ArrayType>(std::move(element_type),
                                          std::move(size));
     }
@@ -433,13 +512,13 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
       const EnumTypeProto& etp = ctp.enum_type();
       const EnumDefProto& enum_def_proto = etp.enum_def();
       XLS_ASSIGN_OR_RETURN(ConcreteTypeDim size,
-                           FromProto(ctp.enum_type().size()));
-      XLS_ASSIGN_OR_RETURN(
-          const EnumDef* enum_def,
-          import_data.FindEnumDef(FromProto(enum_def_proto.span())));
+                           FromProto(ctp.enum_type().size(), find_node));
+      XLS_ASSIGN_OR_RETURN(const EnumDef* enum_def,
+                           FindDef<EnumDef>(find_node, AstNodeKind::kEnumDef,
+                                            enum_def_proto.span()));
       std::vector<InterpValue> members;
       for (const InterpValueProto& value : etp.members()) {
-        XLS_ASSIGN_OR_RETURN(InterpValue member, FromProto(value));
+        XLS_ASSIGN_OR_RETURN(InterpValue member, FromProto(value, find_node));
         members.push_back(member);
       }
 
@@ -451,26 +530,33 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
       std::vector<std::unique_ptr<ConcreteType>> params;
       for (const ConcreteTypeProto& param : ftp.params()) {
         XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> ct,
-                             FromProto(param, import_data));
+                             FromProto(param, find_node));
         params.push_back(std::move(ct));
       }
       XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> rt,
-                           FromProto(ftp.return_type(), import_data));
+                           FromProto(ftp.return_type(), find_node));
       return std::make_unique<FunctionType>(std::move(params), std::move(rt));
     }
     case ConcreteTypeProto::ConcreteTypeOneofCase::kTokenType: {
       return std::make_unique<TokenType>();
     }
+    case ConcreteTypeProto::ConcreteTypeOneofCase::kChannelType: {
+      XLS_ASSIGN_OR_RETURN(
+          std::unique_ptr<ConcreteType> payload,
+          FromProto(ctp.channel_type().payload(), find_node));
+      return std::make_unique<ChannelType>(std::move(payload));
+    }
     case ConcreteTypeProto::ConcreteTypeOneofCase::kStructType: {
       const StructTypeProto& stp = ctp.struct_type();
       const StructDefProto& struct_def_proto = stp.struct_def();
       XLS_ASSIGN_OR_RETURN(
           const StructDef* struct_def,
-          import_data.FindStructDef(FromProto(struct_def_proto.span())));
+          FindDef<StructDef>(find_node, AstNodeKind::kStructDef,
+                             struct_def_proto.span()));
       std::vector<std::unique_ptr<ConcreteType>> members;
       for (const ConcreteTypeProto& member_proto : stp.members()) {
         XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> member,
-                             FromProto(member_proto, import_data));
+                             FromProto(member_proto, find_node));
         members.push_back(std::move(member));
       }
       return std::make_unique<StructType>(std::move(members), *struct_def);
@@ -484,10 +570,26 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
   }
 }
 
+// Resolves the definitions referenced by serialized types against the modules
+// in "import_data".
+FindNodeFn MakeFindNodeFn(const ImportData& import_data) {
+  return [&import_data](AstNodeKind kind,
+                        const Span& span) -> absl::StatusOr<const AstNode*> {
+    switch (kind) {
+      case AstNodeKind::kEnumDef:
+        return import_data.FindEnumDef(span);
+      case AstNodeKind::kStructDef:
+        return import_data.FindStructDef(span);
+      default:
+        return import_data.FindNode(kind, span);
+    }
+  };
+}
+
 absl::StatusOr<std::string> ToHumanString(const ConcreteTypeProto& ctp,
                                           const ImportData& import_data) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> ct,
-                       FromProto(ctp, import_data));
+                       FromProto(ctp, MakeFindNodeFn(import_data)));
   return ct->ToString();
 }
 
@@ -652,6 +754,29 @@ absl::StatusOr<TypeInfoProto> TypeInfoToProto(const TypeInfo& type_info) {
   return tip;
 }
 
+absl::StatusOr<ConcreteTypeProto> ConcreteTypeToProto(
+    const ConcreteType& concrete_type) {
+  return ToProto(concrete_type);
+}
+
+absl::StatusOr<std::unique_ptr<ConcreteType>> ConcreteTypeFromProto(
+    const ConcreteTypeProto& proto, const FindNodeFn& find_node) {
+  return FromProto(proto, find_node);
+}
+
+absl::StatusOr<InterpValueProto> InterpValueToProto(const InterpValue& value) {
+  return ToProto(value);
+}
+
+absl::StatusOr<InterpValue> InterpValueFromProto(const InterpValueProto& proto,
+                                                 const FindNodeFn& find_node) {
+  return FromProto(proto, find_node);
+}
+
+SpanProto SpanToProto(const Span& span) { return ToProto(span); }
+
+Span SpanFromProto(const SpanProto& proto) { return FromProto(proto); }
+
 absl::StatusOr<std::string> ToHumanString(const TypeInfoProto& tip,
                                           const ImportData& import_data) {
   std::vector<std::string> lines;
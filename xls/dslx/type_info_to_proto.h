@@ -15,12 +15,20 @@
 #ifndef XLS_DSLX_TYPE_INFO_TO_PROTO_H_
 #define XLS_DSLX_TYPE_INFO_TO_PROTO_H_
 
+#include <functional>
+#include <memory>
+
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/type_info.h"
 #include "xls/dslx/type_info.pb.h"
 
 namespace xls::dslx {
 
+// Resolves the AST node of the given kind at the given span; used to find the
+// struct and enum definitions referred to by serialized types and values.
+using FindNodeFn = std::function<absl::StatusOr<const AstNode*>(
+    AstNodeKind kind, const Span& span)>;
+
 // Converts the given type information object to protobuf form for
 // serialization.
 absl::StatusOr<TypeInfoProto> TypeInfoToProto(const TypeInfo& type_info);
@@ -34,6 +42,23 @@ absl::StatusOr<std::string> ToHumanString(const AstNodeTypeInfoProto& antip,
 absl::StatusOr<std::string> ToHumanString(const TypeInfoProto& tip,
                                           const ImportData& import_data);
 
+// Converts the given concrete type to and from protobuf form. Returns an
+// unimplemented error for types which have no protobuf form (e.g. those with
+// parametric expressions more complex than a symbol).
+absl::StatusOr<ConcreteTypeProto> ConcreteTypeToProto(
+    const ConcreteType& concrete_type);
+absl::StatusOr<std::unique_ptr<ConcreteType>> ConcreteTypeFromProto(
+    const ConcreteTypeProto& proto, const FindNodeFn& find_node);
+
+// As above, for interpreter values (bits, tuples, arrays and enums only).
+absl::StatusOr<InterpValueProto> InterpValueToProto(const InterpValue& value);
+absl::StatusOr<InterpValue> InterpValueFromProto(const InterpValueProto& proto,
+                                                 const FindNodeFn& find_node);
+
+// As above, for source spans.
+SpanProto SpanToProto(const Span& span);
+Span SpanFromProto(const SpanProto& proto);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_TYPE_INFO_TO_PROTO_H_
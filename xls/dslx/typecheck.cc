@@ -14,6 +14,10 @@
 
 #include "xls/dslx/typecheck.h"
 
+#include <atomic>
+
+#include "absl/algorithm/container.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/ast_utils.h"
 #include "xls/dslx/builtins_metadata.h"
 #include "xls/dslx/bytecode_emitter.h"
@@ -383,7 +387,7 @@ absl::Status CheckModuleMember(const ModuleMember& member, Module* module,
     XLS_ASSIGN_OR_RETURN(
         ModuleInfo * imported,
         DoImport(ctx->typecheck_module(), ImportTokens(import->subject()),
-                 import_data, import->span()));
+                 import_data, import->span(), ctx->warnings()));
     ctx->type_info()->AddImport(import, &imported->module(),
                                 imported->type_info());
   } else if (std::holds_alternative<ConstantDef*>(member) ||
@@ -727,9 +731,25 @@ absl::StatusOr<TypeAndBindings> CheckInvocation(
   parent_ctx->type_info()->SetItem(invocation->callee(), instantiated_ft);
   ctx->type_info()->SetItem(callee_fn->name_def(), instantiated_ft);
 
+  // Function instantiations only depend on their bindings, so the body of one
+  // which was already typechecked (e.g. at another call site) is not deduced
+  // again; procs need separate type information per instantiation (see
+  // above).
+  TypeInfo* original_ti = parent_ctx->type_info();
+  const bool memoizable =
+      !callee_fn->proc().has_value() && constexpr_env.empty();
+  if (memoizable) {
+    if (std::optional<TypeInfo*> instantiation_ti =
+            ctx->GetInstantiationTypeInfo(callee_fn, tab.symbolic_bindings);
+        instantiation_ti.has_value()) {
+      original_ti->SetInvocationTypeInfo(invocation, tab.symbolic_bindings,
+                                         instantiation_ti.value());
+      return tab;
+    }
+  }
+
   // We need to deduce fn body, so we're going to call Deduce, which means we'll
   // need a new stack entry w/the new symbolic bindings.
-  TypeInfo* original_ti = parent_ctx->type_info();
   ctx->AddFnStackEntry(
       FnStackEntry::Make(callee_fn, tab.symbolic_bindings, invocation));
   ctx->AddDerivedTypeInfo();
@@ -784,6 +804,10 @@ absl::StatusOr<TypeAndBindings> CheckInvocation(
 
   original_ti->SetInvocationTypeInfo(invocation, tab.symbolic_bindings,
                                         ctx->type_info());
+  if (memoizable) {
+    ctx->NoteInstantiationTypeInfo(callee_fn, tab.symbolic_bindings,
+                                   ctx->type_info());
+  }
 
   XLS_RETURN_IF_ERROR(ctx->PopDerivedTypeInfo());
   ctx->PopFnStackEntry();
@@ -801,8 +825,109 @@ absl::StatusOr<TypeAndBindings> CheckInvocation(
   return tab;
 }
 
+// Typechecks the transitive imports of "module" which are not yet in
+// "import_data" ahead of the serial traversal in CheckModule. Each module is
+// assigned to the wave after the latest wave of its imports and the modules of
+// a wave are typechecked concurrently. Typechecked modules are put in
+// "import_data" where the serial traversal finds them.
+//
+// Failures to locate, parse or typecheck an import are not reported here: the
+// failing module (and anything importing it) is left for the serial traversal
+// so errors are reported exactly as without this step.
+static absl::Status TypecheckImportsConcurrently(Module* module,
+                                                 ImportData* import_data,
+                                                 WarningCollector* warnings,
+                                                 int64_t thread_count) {
+  absl::StatusOr<std::vector<ParsedImport>> graph =
+      ParseImportGraph(*module, import_data);
+  if (!graph.ok()) {
+    XLS_VLOG(3) << "Not typechecking imports of " << module->name()
+                << " concurrently: " << graph.status();
+    return absl::OkStatus();
+  }
+  std::vector<ParsedImport>& imports = graph.value();
+
+  std::vector<std::vector<int64_t>> waves;
+  std::vector<int64_t> module_waves(imports.size());
+  for (int64_t i = 0; i < imports.size(); ++i) {
+    int64_t wave = 0;
+    for (int64_t imported : imports[i].imports) {
+      wave = std::max(wave, module_waves[imported] + 1);
+    }
+    module_waves[i] = wave;
+    if (wave >= waves.size()) {
+      waves.resize(wave + 1);
+    }
+    waves[wave].push_back(i);
+  }
+
+  std::vector<bool> typechecked(imports.size(), false);
+  std::vector<WarningCollector> module_warnings(imports.size());
+  for (const std::vector<int64_t>& wave : waves) {
+    // Skip modules which import a module that failed to typecheck.
+    std::vector<int64_t> ready;
+    for (int64_t i : wave) {
+      if (absl::c_all_of(imports[i].imports, [&](int64_t imported) {
+            return typechecked[imported];
+          })) {
+        ready.push_back(i);
+      }
+    }
+    std::vector<absl::StatusOr<TypeInfo*>> results(ready.size());
+    std::atomic<int64_t> next_index = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_index.fetch_add(1); i < ready.size();
+           i = next_index.fetch_add(1)) {
+        results[i] = CheckModule(imports[ready[i]].module.get(), import_data,
+                                 &module_warnings[ready[i]]);
+      }
+    };
+    int64_t wave_thread_count = std::min<int64_t>(thread_count, ready.size());
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < wave_thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    worker();
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+
+    for (int64_t i = 0; i < ready.size(); ++i) {
+      ParsedImport& parsed = imports[ready[i]];
+      if (!results[i].ok()) {
+        XLS_VLOG(3) << "Concurrent typecheck of " << parsed.subject.ToString()
+                    << " failed: " << results[i].status();
+        // Type information was created for the module so keep it alive.
+        import_data->RetainAbandonedModule(std::move(parsed.module));
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(
+          import_data
+              ->Put(parsed.subject, std::make_unique<ModuleInfo>(
+                                        std::move(parsed.module),
+                                        results[i].value(), parsed.path))
+              .status());
+      typechecked[ready[i]] = true;
+    }
+  }
+
+  // Add the warnings in the order a serial typecheck would have flagged them.
+  for (int64_t i = 0; i < imports.size(); ++i) {
+    for (const WarningCollector::Entry& entry : module_warnings[i].warnings()) {
+      warnings->Add(entry.span, entry.message);
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<TypeInfo*> CheckModule(Module* module, ImportData* import_data,
-                                      WarningCollector* warnings) {
+                                      WarningCollector* warnings,
+                                      int64_t thread_count) {
+  if (thread_count > 1) {
+    XLS_RETURN_IF_ERROR(TypecheckImportsConcurrently(module, import_data,
+                                                     warnings, thread_count));
+  }
+
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        import_data->type_info_owner().New(module));
 
@@ -46,11 +46,17 @@ absl::StatusOr<TypeAndBindings> CheckInvocation(
 //      module, and that owns the type information determined for this module.
 //   warnings: Object that collects warnings flagged during the typechecking
 //      process.
+//   thread_count: If greater than one, the transitive imports of the module
+//      which are not yet in the import cache are parsed up front and those
+//      which do not depend on each other are typechecked concurrently on up to
+//      this many threads. The result (and any error) is the same as a serial
+//      typecheck.
 //
 // Returns type information mapping from AST nodes in the module to their
 // deduced/checked type. The owner for the type info is within the import_cache.
 absl::StatusOr<TypeInfo*> CheckModule(Module* module, ImportData* import_data,
-                                      WarningCollector* warnings);
+                                      WarningCollector* warnings,
+                                      int64_t thread_count = 1);
 
 // Determines if the given type is best represented as a DSLX BuiltinType with
 // fixed width, e.g., u7 or s64 vs bits, uN, or sN. If so, then this function
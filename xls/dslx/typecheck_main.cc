@@ -29,6 +29,9 @@ ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
 ABSL_FLAG(std::string, output_path, "",
           "Path to dump the type information to as a protobin -- if not "
           "provided textual proto is given on stdout.");
+ABSL_FLAG(int64_t, typecheck_threads, 1,
+          "Number of threads to typecheck independent imported modules on. "
+          "Values of one or less typecheck imports serially.");
 
 namespace xls::dslx {
 namespace {
@@ -41,14 +44,16 @@ was deduced.
 absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
                       const std::filesystem::path& dslx_stdlib_path,
                       const std::filesystem::path& input_path,
-                      std::optional<std::filesystem::path> output_path) {
+                      std::optional<std::filesystem::path> output_path,
+                      int64_t typecheck_threads) {
   ImportData import_data(
       CreateImportData(dslx_stdlib_path,
                        /*additional_search_paths=*/dslx_paths));
   XLS_ASSIGN_OR_RETURN(std::string input_contents, GetFileContents(input_path));
   XLS_ASSIGN_OR_RETURN(std::string module_name, PathToName(input_path.c_str()));
   absl::StatusOr<TypecheckedModule> tm_or = ParseAndTypecheck(
-      input_contents, input_path.c_str(), module_name, &import_data);
+      input_contents, input_path.c_str(), module_name, &import_data,
+      typecheck_threads);
   if (!tm_or.ok()) {
     if (TryPrintError(tm_or.status())) {
       return absl::InvalidArgumentError(
@@ -96,6 +101,7 @@ int main(int argc, char* argv[]) {
   std::filesystem::path dslx_stdlib_path(absl::GetFlag(FLAGS_dslx_stdlib_path));
 
   XLS_QCHECK_OK(xls::dslx::RealMain(dslx_paths, dslx_stdlib_path, input_path,
-                                    output_path));
+                                    output_path,
+                                    absl::GetFlag(FLAGS_typecheck_threads)));
   return EXIT_SUCCESS;
 }
@@ -14,14 +14,20 @@
 
 #include "xls/dslx/typecheck.h"
 
+#include <optional>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/ast.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/error_printer.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/symbolic_bindings.h"
+#include "xls/dslx/type_info.h"
 #include "xls/dslx/type_info_to_proto.h"
 
 namespace xls::dslx {
@@ -1486,5 +1492,98 @@ fn f(s: S) -> S { S{x: u32:4, y: u32:8, ..s} }
       PositionalErrorColor::kWarningColor));
 }
 
+// Typechecks "text" with the given number of threads and returns the
+// humanized type information of the module and of each of its imports.
+absl::StatusOr<std::string> TypecheckToHumanString(std::string_view text,
+                                                   int64_t thread_count) {
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSIGN_OR_RETURN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(text, "fake.x", "fake", &import_data, thread_count));
+  std::vector<const Module*> modules = {tm.module};
+  for (std::string_view name : {"std", "apfloat", "float32", "bfloat16"}) {
+    XLS_ASSIGN_OR_RETURN(ModuleInfo * info,
+                         import_data.Get(ImportTokens({std::string(name)})));
+    modules.push_back(&info->module());
+  }
+  std::string result;
+  for (const Module* module : modules) {
+    XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
+                         import_data.GetRootTypeInfo(module));
+    XLS_ASSIGN_OR_RETURN(TypeInfoProto tip, TypeInfoToProto(*type_info));
+    XLS_ASSIGN_OR_RETURN(std::string humanized,
+                         ToHumanString(tip, import_data));
+    absl::StrAppend(&result, humanized, "\n");
+  }
+  return result;
+}
+
+TEST(TypecheckTest, ConcurrentImportsMatchSerial) {
+  // float32 and bfloat16 both import apfloat which imports std, so the two are
+  // typechecked concurrently and both instantiate parametrics of apfloat.
+  std::string_view program = R"(
+import std
+import float32
+import bfloat16
+
+fn f() -> (float32::F32, bfloat16::BF16, u32) {
+  (float32::one(u1:0), bfloat16::one(u1:0), std::clog2(u32:5))
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::string serial,
+                           TypecheckToHumanString(program, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string concurrent,
+                           TypecheckToHumanString(program, 4));
+  EXPECT_EQ(serial, concurrent);
+}
+
+TEST(TypecheckTest, ParametricInstantiationsAreShared) {
+  std::string_view program = R"(
+fn p<N: u32>(x: bits[N]) -> bits[N] { x + bits[N]:1 }
+fn f() -> (u8, u8, u16) { (p(u8:1), p(u8:2), p(u16:3)) }
+)";
+  TypecheckedModule tm;
+  XLS_ASSERT_OK(Typecheck(program, &tm));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("f"));
+  auto* tuple = dynamic_cast<XlsTuple*>(f->body()->body());
+  ASSERT_NE(tuple, nullptr);
+  std::vector<std::optional<TypeInfo*>> invocation_tis;
+  for (Expr* member : tuple->members()) {
+    auto* invocation = dynamic_cast<Invocation*>(member);
+    ASSERT_NE(invocation, nullptr);
+    std::optional<const SymbolicBindings*> bindings =
+        tm.type_info->GetInvocationCalleeBindings(invocation,
+                                                  SymbolicBindings());
+    ASSERT_TRUE(bindings.has_value());
+    invocation_tis.push_back(
+        tm.type_info->GetInvocationTypeInfo(invocation, *bindings.value()));
+    ASSERT_TRUE(invocation_tis.back().has_value());
+  }
+  // The two invocations with N=8 share type information, N=16 has its own.
+  EXPECT_EQ(invocation_tis[0], invocation_tis[1]);
+  EXPECT_NE(invocation_tis[0], invocation_tis[2]);
+}
+
+TEST(TypecheckTest, ConcurrentImportErrorMatchesSerial) {
+  std::string_view program = R"(
+import std
+import this_module_does_not_exist
+
+fn f() -> u32 { std::clog2(u32:5) }
+)";
+  auto import_data = CreateImportDataForTest();
+  absl::Status serial =
+      ParseAndTypecheck(program, "fake.x", "fake", &import_data).status();
+  auto concurrent_import_data = CreateImportDataForTest();
+  absl::Status concurrent =
+      ParseAndTypecheck(program, "fake.x", "fake", &concurrent_import_data,
+                        /*thread_count=*/4)
+          .status();
+  EXPECT_THAT(serial, StatusIs(absl::StatusCode::kNotFound,
+                               HasSubstr("Could not find DSLX file")));
+  EXPECT_EQ(serial, concurrent);
+}
+
 }  // namespace
 }  // namespace xls::dslx
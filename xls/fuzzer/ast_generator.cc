@@ -15,8 +15,10 @@
 #include "xls/fuzzer/ast_generator.h"
 
 #include <algorithm>
+#include <numeric>
 #include <optional>
 #include <set>
+#include <string>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -1478,23 +1480,94 @@ int OpProbability(OpChoice op) {
   XLS_LOG(FATAL) << "Invalid op choice: " << static_cast<int64_t>(op);
 }
 
-std::discrete_distribution<int>& GetOpDistribution(bool generate_proc) {
-  static std::discrete_distribution<int> dist = [generate_proc]() {
-    static const std::set<int> proc_ops = {int{kChannelOp}, int{kJoinOp}};
-    std::vector<int> tmp;
-    tmp.reserve(int{kEndSentinel});
-    for (int i = 0; i < int{kEndSentinel}; ++i) {
-      // When not generating a proc, do not generate proc operations by setting
-      // its probability to zero.
-      if (!generate_proc && proc_ops.find(i) != proc_ops.end()) {
-        tmp.push_back(0);
-        continue;
-      }
-      tmp.push_back(OpProbability(static_cast<OpChoice>(i)));
+// Returns the name of the given op as used in
+// AstGeneratorOptions::expression_weights.
+std::string_view OpChoiceName(OpChoice op) {
+  switch (op) {
+    case kArray:
+      return "array";
+    case kArrayIndex:
+      return "array_index";
+    case kArrayUpdate:
+      return "array_update";
+    case kArraySlice:
+      return "array_slice";
+    case kBinop:
+      return "binop";
+    case kBitSlice:
+      return "bit_slice";
+    case kBitSliceUpdate:
+      return "bit_slice_update";
+    case kBitwiseReduction:
+      return "bitwise_reduction";
+    case kCastToBitsArray:
+      return "cast_to_bits_array";
+    case kChannelOp:
+      return "channel_op";
+    case kCompareOp:
+      return "compare_op";
+    case kCompareArrayOp:
+      return "compare_array_op";
+    case kCompareTupleOp:
+      return "compare_tuple_op";
+    case kConcat:
+      return "concat";
+    case kCountedFor:
+      return "counted_for";
+    case kGate:
+      return "gate";
+    case kJoinOp:
+      return "join_op";
+    case kLogical:
+      return "logical";
+    case kMap:
+      return "map";
+    case kNumber:
+      return "number";
+    case kOneHotSelectBuiltin:
+      return "one_hot_select_builtin";
+    case kPartialProduct:
+      return "partial_product";
+    case kPrioritySelectBuiltin:
+      return "priority_select_builtin";
+    case kShiftOp:
+      return "shift_op";
+    case kTupleOrIndex:
+      return "tuple_or_index";
+    case kUnop:
+      return "unop";
+    case kUnopBuiltin:
+      return "unop_builtin";
+    case kEndSentinel:
+      break;
+  }
+  XLS_LOG(FATAL) << "Invalid op choice: " << static_cast<int64_t>(op);
+}
+
+std::discrete_distribution<int> MakeOpDistribution(
+    const AstGeneratorOptions& options) {
+  static const std::set<int> proc_ops = {int{kChannelOp}, int{kJoinOp}};
+  std::vector<double> tmp;
+  tmp.reserve(int{kEndSentinel});
+  for (int i = 0; i < int{kEndSentinel}; ++i) {
+    // When not generating a proc, do not generate proc operations by setting
+    // its probability to zero.
+    if (!options.generate_proc && proc_ops.find(i) != proc_ops.end()) {
+      tmp.push_back(0);
+      continue;
     }
-    return std::discrete_distribution<int>(tmp.begin(), tmp.end());
-  }();
-  return dist;
+    OpChoice op = static_cast<OpChoice>(i);
+    double weight = 1.0;
+    auto it = options.expression_weights.find(OpChoiceName(op));
+    if (it != options.expression_weights.end()) {
+      XLS_CHECK_GE(it->second, 0.0) << OpChoiceName(op);
+      weight = it->second;
+    }
+    tmp.push_back(OpProbability(op) * weight);
+  }
+  XLS_CHECK_GT(std::accumulate(tmp.begin(), tmp.end(), 0.0), 0.0)
+      << "All expression kinds have zero weight";
+  return std::discrete_distribution<int>(tmp.begin(), tmp.end());
 }
 
 }  // namespace
@@ -1514,8 +1587,9 @@ absl::StatusOr<TypedExpr> AstGenerator::GenerateExpr(int64_t expr_size,
   while (true) {
     absl::StatusOr<TypedExpr> generated;
 
-    int choice = GetOpDistribution(options_.generate_proc)(rng_);
-    switch (static_cast<OpChoice>(choice)) {
+    OpChoice choice =
+        static_cast<OpChoice>(expression_kind_distribution_(rng_));
+    switch (choice) {
       case kArray:
         generated = GenerateArray(env);
         break;
@@ -1611,6 +1685,7 @@ absl::StatusOr<TypedExpr> AstGenerator::GenerateExpr(int64_t expr_size,
 
     if (generated.ok()) {
       rhs = generated.value();
+      ++expression_kind_counts_[OpChoiceName(choice)];
       if (IsBits(rhs.type)) {
         XLS_RET_CHECK_LE(GetTypeBitCount(rhs.type),
                          options_.max_width_bits_types)
@@ -1944,6 +2019,15 @@ AstGenerator::AstGenerator(AstGeneratorOptions options, std::mt19937* rng)
     : rng_(*XLS_DIE_IF_NULL(rng)),
       options_(options),
       fake_pos_("<fake>", 0, 0),
-      fake_span_(fake_pos_, fake_pos_) {}
+      fake_span_(fake_pos_, fake_pos_),
+      expression_kind_distribution_(MakeOpDistribution(options_)) {}
+
+/* static */ std::vector<std::string> AstGenerator::ExpressionKinds() {
+  std::vector<std::string> kinds;
+  for (int i = 0; i < int{kEndSentinel}; ++i) {
+    kinds.push_back(std::string(OpChoiceName(static_cast<OpChoice>(i))));
+  }
+  return kinds;
+}
 
 }  // namespace xls::dslx
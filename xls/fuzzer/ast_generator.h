@@ -16,6 +16,8 @@
 #define XLS_FUZZER_CPP_AST_GENERATOR_H_
 
 #include <random>
+#include <string>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
@@ -66,6 +68,12 @@ struct AstGeneratorOptions {
 
   // Whether to generate a proc.
   bool generate_proc = false;
+
+  // Multipliers of the relative probability with which each kind of expression
+  // is generated, keyed by the names of AstGenerator::ExpressionKinds(); kinds
+  // which are not present keep their default probability. Used to steer
+  // generation by coverage feedback (see CoverageFeedback).
+  absl::flat_hash_map<std::string, double> expression_weights;
 };
 
 // Type that generates a random module for use in fuzz testing; i.e.
@@ -91,6 +99,17 @@ class AstGenerator {
   absl::StatusOr<std::unique_ptr<Module>> Generate(std::string top_entity_name,
                                                    std::string module_name);
 
+  // Returns the names of the kinds of expressions the generator chooses
+  // between, as used by AstGeneratorOptions::expression_weights.
+  static std::vector<std::string> ExpressionKinds();
+
+  // Returns the number of expressions of each kind generated so far (only
+  // kinds which were generated at least once are present).
+  const absl::flat_hash_map<std::string, int64_t>& expression_kind_counts()
+      const {
+    return expression_kind_counts_;
+  }
+
   // Chooses a random "interesting" bit pattern with the given bit count.
   Bits ChooseBitPattern(int64_t bit_count);
 
@@ -570,6 +589,12 @@ class AstGenerator {
 
   // Contains properties of the generated proc.
   ProcProperties proc_properties_;
+
+  // Distribution over the kinds of expressions to generate, weighted per the
+  // options.
+  std::discrete_distribution<int> expression_kind_distribution_;
+
+  absl::flat_hash_map<std::string, int64_t> expression_kind_counts_;
 };
 
 }  // namespace xls::dslx
@@ -93,6 +93,26 @@ TEST(AstGeneratorTest, GeneratesValidFunctions) {
   }
 }
 
+TEST(AstGeneratorTest, ExpressionWeights) {
+  std::mt19937 rng(0);
+  AstGeneratorOptions options;
+  for (const std::string& kind : AstGenerator::ExpressionKinds()) {
+    options.expression_weights[kind] = 0.0;
+  }
+  options.expression_weights["binop"] = 1.0;
+  options.expression_weights["number"] = 1.0;
+  for (int64_t i = 0; i < 8; ++i) {
+    AstGenerator g(options, &rng);
+    std::string module_name = absl::StrFormat("sample_%d", i);
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Module> module,
+                             g.Generate("main", module_name));
+    XLS_ASSERT_OK(ParseAndTypecheck<Function>(module->ToString(), module_name));
+    for (const auto& [kind, count] : g.expression_kind_counts()) {
+      EXPECT_THAT(kind, testing::AnyOf("binop", "number"));
+    }
+  }
+}
+
 // Simply tests that we generate a bunch of valid procs using seed 0 (that
 // parse and typecheck).
 TEST(AstGeneratorTest, GeneratesValidProcs) {
@@ -0,0 +1,89 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/coverage_feedback.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+
+namespace xls {
+
+void CoverageFeedback::AddSample(
+    const absl::flat_hash_map<std::string, int64_t>& expression_kind_counts,
+    const SampleCoverage& coverage) {
+  std::vector<std::string> features;
+  for (const auto& [op, count] : coverage.op_counts) {
+    features.push_back(absl::StrCat("op:", op));
+  }
+  for (const auto& [pass, count] : coverage.pass_change_counts) {
+    features.push_back(absl::StrCat("pass:", pass));
+  }
+
+  absl::MutexLock lock(&mutex_);
+  double score = 0.0;
+  for (const std::string& feature : features) {
+    int64_t& count = feature_counts_[feature];
+    score += 1.0 / (1.0 + count);
+    ++count;
+  }
+  for (const auto& [kind, count] : expression_kind_counts) {
+    if (count == 0) {
+      continue;
+    }
+    KindStats& stats = kind_stats_[kind];
+    ++stats.sample_count;
+    stats.total_score += score;
+  }
+  ++sample_count_;
+}
+
+absl::flat_hash_map<std::string, double>
+CoverageFeedback::GetExpressionWeights() const {
+  absl::MutexLock lock(&mutex_);
+  double total_mean = 0.0;
+  int64_t kind_count = 0;
+  for (const auto& [kind, stats] : kind_stats_) {
+    if (stats.sample_count >= kMinSamplesPerKind) {
+      total_mean += stats.total_score / stats.sample_count;
+      ++kind_count;
+    }
+  }
+  absl::flat_hash_map<std::string, double> weights;
+  if (kind_count == 0 || total_mean <= 0.0) {
+    return weights;
+  }
+  total_mean /= kind_count;
+  for (const auto& [kind, stats] : kind_stats_) {
+    if (stats.sample_count >= kMinSamplesPerKind) {
+      double mean = stats.total_score / stats.sample_count;
+      weights[kind] = std::clamp(mean / total_mean, kMinWeight, kMaxWeight);
+    }
+  }
+  return weights;
+}
+
+int64_t CoverageFeedback::sample_count() const {
+  absl::MutexLock lock(&mutex_);
+  return sample_count_;
+}
+
+absl::flat_hash_map<std::string, int64_t> CoverageFeedback::GetFeatureCounts()
+    const {
+  absl::MutexLock lock(&mutex_);
+  return feature_counts_;
+}
+
+}  // namespace xls
@@ -0,0 +1,80 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_COVERAGE_FEEDBACK_H_
+#define XLS_FUZZER_COVERAGE_FEEDBACK_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/in_process_sample_runner.h"
+
+namespace xls {
+
+// Accumulates what fuzzer samples exercised in the optimization pipeline and
+// turns it into expression weights for the AST generator which favor the kinds
+// of expressions whose samples reached rarely exercised IR ops and passes.
+//
+// Each sample is scored by the rarity of what it covered: every IR op it
+// contains and every pass which changed it contributes 1 / (1 + the number of
+// earlier samples which also covered it). The score of a sample is credited to
+// each kind of expression it was generated with, and a kind's weight is its
+// mean score relative to the mean over all kinds, clamped to
+// [kMinWeight, kMaxWeight] so that no kind is starved or dominates.
+//
+// All methods take an internal lock, so the workers of a multi-threaded fuzzer
+// can feed one instance and draw their weights from the combined coverage.
+class CoverageFeedback {
+ public:
+  static constexpr double kMinWeight = 0.25;
+  static constexpr double kMaxWeight = 4.0;
+
+  // Kinds of expressions with fewer samples than this keep weight 1.
+  static constexpr int64_t kMinSamplesPerKind = 8;
+
+  // Records a sample which was generated with expressions of the given kinds
+  // (see AstGenerator::expression_kind_counts()) and exercised `coverage`.
+  void AddSample(
+      const absl::flat_hash_map<std::string, int64_t>& expression_kind_counts,
+      const SampleCoverage& coverage);
+
+  // Returns weights for AstGeneratorOptions::expression_weights.
+  absl::flat_hash_map<std::string, double> GetExpressionWeights() const;
+
+  int64_t sample_count() const;
+
+  // Returns the number of samples in which each op occurred and each pass
+  // changed the IR, keyed by "op:<name>" and "pass:<name>".
+  absl::flat_hash_map<std::string, int64_t> GetFeatureCounts() const;
+
+ private:
+  struct KindStats {
+    int64_t sample_count = 0;
+    double total_score = 0.0;
+  };
+
+  mutable absl::Mutex mutex_;
+  int64_t sample_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<std::string, int64_t> feature_counts_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, KindStats> kind_stats_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_COVERAGE_FEEDBACK_H_
@@ -0,0 +1,87 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/coverage_feedback.h"
+
+#include <cstdint>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "xls/fuzzer/in_process_sample_runner.h"
+
+namespace xls {
+namespace {
+
+using ::testing::DoubleEq;
+using ::testing::Gt;
+using ::testing::IsEmpty;
+
+TEST(CoverageFeedbackTest, NoFeedbackYieldsNoWeights) {
+  CoverageFeedback feedback;
+  EXPECT_THAT(feedback.GetExpressionWeights(), IsEmpty());
+
+  // Too few samples of the kind to judge it.
+  SampleCoverage coverage;
+  coverage.op_counts["add"] = 1;
+  feedback.AddSample({{"binop", 1}}, coverage);
+  EXPECT_THAT(feedback.GetExpressionWeights(), IsEmpty());
+  EXPECT_EQ(feedback.sample_count(), 1);
+}
+
+TEST(CoverageFeedbackTest, FavorsKindsReachingRareFeatures) {
+  CoverageFeedback feedback;
+  for (int64_t i = 0; i < 2 * CoverageFeedback::kMinSamplesPerKind; ++i) {
+    // Binops always produce the same op...
+    SampleCoverage common;
+    common.op_counts["add"] = 3;
+    feedback.AddSample({{"binop", 3}}, common);
+
+    // ...whereas every map sample triggers a pass nothing else did.
+    SampleCoverage rare;
+    rare.op_counts["add"] = 1;
+    rare.pass_change_counts[absl::StrCat("pass_", i)] = 1;
+    feedback.AddSample({{"binop", 1}, {"map", 1}}, rare);
+  }
+  absl::flat_hash_map<std::string, double> weights =
+      feedback.GetExpressionWeights();
+  ASSERT_TRUE(weights.contains("binop"));
+  ASSERT_TRUE(weights.contains("map"));
+  EXPECT_THAT(weights.at("map"), Gt(weights.at("binop")));
+  EXPECT_LE(weights.at("map"), CoverageFeedback::kMaxWeight);
+  EXPECT_GE(weights.at("binop"), CoverageFeedback::kMinWeight);
+
+  absl::flat_hash_map<std::string, int64_t> features =
+      feedback.GetFeatureCounts();
+  EXPECT_EQ(features.at("op:add"), 4 * CoverageFeedback::kMinSamplesPerKind);
+  EXPECT_EQ(features.at("pass:pass_0"), 1);
+}
+
+TEST(CoverageFeedbackTest, EqualCoverageYieldsEqualWeights) {
+  CoverageFeedback feedback;
+  SampleCoverage coverage;
+  coverage.op_counts["add"] = 1;
+  for (int64_t i = 0; i < CoverageFeedback::kMinSamplesPerKind; ++i) {
+    feedback.AddSample({{"binop", 1}, {"concat", 2}}, coverage);
+  }
+  absl::flat_hash_map<std::string, double> weights =
+      feedback.GetExpressionWeights();
+  EXPECT_THAT(weights.at("binop"), DoubleEq(1.0));
+  EXPECT_THAT(weights.at("concat"), DoubleEq(1.0));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,130 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/crasher_signature.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+const char kUsage[] = R"(
+Recognizes fuzzer crashers which likely share a root cause with a previously
+seen crasher. Each crasher directory (as written by run_fuzz) is given a
+failure signature made of a hash of its failure message or stack trace in
+exception.txt, the optimization pass which failed (if any) and, if the crasher
+has been minimized, the op histogram of minimized.ir. Signatures of new
+crashers are recorded in the index file. Usage:
+
+  crasher_dedup_main --index_file=INDEX_FILE [CRASHER_DIR...]
+
+For each crasher directory one line is printed to stdout:
+
+  <dir>: new <signature>
+  <dir>: duplicate of <crasher>
+
+With --fail_on_duplicate the exit code is non-zero if any crasher is a
+duplicate, so a script can skip the minimization and simulation of a single
+crasher with:
+
+  crasher_dedup_main --index_file=INDEX_FILE --fail_on_duplicate CRASHER_DIR
+)";
+
+ABSL_FLAG(std::string, index_file, "", "The crasher index to consult.");
+ABSL_FLAG(bool, dry_run, false,
+          "If true, then new crashers are not recorded in the index.");
+ABSL_FLAG(bool, fail_on_duplicate, false,
+          "If true, then exit with a non-zero code if any crasher is a "
+          "duplicate.");
+
+namespace xls {
+namespace {
+
+absl::StatusOr<CrasherSignature> ComputeSignatureOfCrasherDir(
+    const std::filesystem::path& crasher_dir) {
+  XLS_ASSIGN_OR_RETURN(std::string exception,
+                       GetFileContents(crasher_dir / "exception.txt"));
+  std::filesystem::path minimized_path = crasher_dir / "minimized.ir";
+  if (!FileExists(minimized_path).ok()) {
+    return ComputeCrasherSignature(exception);
+  }
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(minimized_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, minimized_path.string()));
+  return ComputeCrasherSignature(exception, package.get());
+}
+
+// Returns whether any of the crashers is a duplicate.
+absl::StatusOr<bool> RealMain(absl::Span<const std::string_view> crasher_dirs) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CrasherIndex> index,
+                       CrasherIndex::Load(absl::GetFlag(FLAGS_index_file)));
+  bool any_duplicate = false;
+  for (std::string_view dir : crasher_dirs) {
+    std::filesystem::path crasher_dir(dir);
+    XLS_ASSIGN_OR_RETURN(CrasherSignature signature,
+                         ComputeSignatureOfCrasherDir(crasher_dir));
+    std::string crasher_name =
+        crasher_dir.lexically_normal().filename().string();
+    if (crasher_name.empty()) {
+      crasher_name =
+          crasher_dir.lexically_normal().parent_path().filename().string();
+    }
+    std::optional<std::string> duplicate;
+    if (absl::GetFlag(FLAGS_dry_run)) {
+      duplicate = index->FindDuplicate(signature);
+    } else {
+      XLS_ASSIGN_OR_RETURN(duplicate,
+                           index->FindOrAdd(signature, crasher_name));
+    }
+    if (duplicate.has_value()) {
+      any_duplicate = true;
+      std::cout << absl::StreamFormat("%s: duplicate of %s\n", dir,
+                                      *duplicate);
+    } else {
+      std::cout << absl::StreamFormat("%s: new %s %s\n", dir, signature.Key(),
+                                      signature.OpHistogramString());
+    }
+  }
+  return any_duplicate;
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+  XLS_QCHECK(!absl::GetFlag(FLAGS_index_file).empty())
+      << "--index_file must be specified.";
+
+  absl::StatusOr<bool> any_duplicate = xls::RealMain(positional_arguments);
+  XLS_QCHECK_OK(any_duplicate.status());
+  if (*any_duplicate && absl::GetFlag(FLAGS_fail_on_duplicate)) {
+    return 1;
+  }
+  return 0;
+}
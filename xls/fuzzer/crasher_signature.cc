@@ -0,0 +1,200 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/crasher_signature.h"
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "re2/re2.h"
+
+namespace xls {
+namespace {
+
+// Number of hex digits of the SHA256 digest kept in signatures.
+constexpr int64_t kDigestLength = 16;
+
+// Number of innermost stack frames which make up the signature of a failure
+// with a stack trace.
+constexpr int64_t kMaxStackFrames = 8;
+
+std::string Sha256Hex(std::string_view data) {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest), SHA256_DIGEST_LENGTH));
+}
+
+// Returns the symbols of the frames of the (first) stack trace in `message`,
+// as printed by absl's failure signal handler, e.g.:
+//
+//     @     0x55d4e7f1a0a1        128  xls::Foo()
+std::vector<std::string> GetStackFrames(std::string_view message) {
+  std::vector<std::string> frames;
+  for (std::string_view line : absl::StrSplit(message, '\n')) {
+    std::string symbol;
+    if (RE2::FullMatch(line, R"(\s*@\s+0x[0-9a-fA-F]+\s+(?:\d+\s+)?(.*\S)\s*)",
+                       &symbol)) {
+      frames.push_back(symbol);
+      if (frames.size() == kMaxStackFrames) {
+        break;
+      }
+    }
+  }
+  return frames;
+}
+
+// Returns the name of the pass named in `message` as having failed, using the
+// phrasing of the errors of CompoundPassBase.
+std::string GetFailingPass(std::string_view message) {
+  std::string pass;
+  if (RE2::PartialMatch(message, R"(after '([^']+)' pass)", &pass) ||
+      RE2::PartialMatch(message, R"(Pass (\S+) indicated IR)", &pass)) {
+    return absl::StrReplaceAll(pass, {{" ", "_"}});
+  }
+  return "";
+}
+
+}  // namespace
+
+std::string CrasherSignature::Key() const {
+  return absl::StrCat(message_digest, "/",
+                      failing_pass.empty() ? "-" : failing_pass);
+}
+
+std::string CrasherSignature::OpHistogramString() const {
+  if (op_histogram.empty()) {
+    return "-";
+  }
+  return absl::StrJoin(op_histogram, ",", absl::PairFormatter(":"));
+}
+
+std::string NormalizeFailureMessage(std::string_view message) {
+  std::string result(message);
+  // Keep only the basename of paths, which are often in temporary directories.
+  RE2::GlobalReplace(&result, R"((?:/[\w.+-]+)+/([\w.+-]+))", R"(\1)");
+  RE2::GlobalReplace(&result, R"(0x[0-9a-fA-F]+)", "N");
+  RE2::GlobalReplace(&result, R"(\d+)", "N");
+  RE2::GlobalReplace(&result, R"(\s+)", " ");
+  return std::string(absl::StripAsciiWhitespace(result));
+}
+
+CrasherSignature ComputeCrasherSignature(std::string_view failure_message,
+                                         const Package* package) {
+  CrasherSignature signature;
+  std::vector<std::string> frames = GetStackFrames(failure_message);
+  std::string digested =
+      frames.empty() ? NormalizeFailureMessage(failure_message)
+                     : NormalizeFailureMessage(absl::StrJoin(frames, "\n"));
+  signature.message_digest = Sha256Hex(digested).substr(0, kDigestLength);
+  signature.failing_pass = GetFailingPass(failure_message);
+  if (package != nullptr) {
+    for (FunctionBase* f : package->GetFunctionBases()) {
+      for (Node* node : f->nodes()) {
+        signature.op_histogram[OpToString(node->op())]++;
+      }
+    }
+  }
+  return signature;
+}
+
+absl::StatusOr<std::unique_ptr<CrasherIndex>> CrasherIndex::Load(
+    const std::filesystem::path& path) {
+  auto index = absl::WrapUnique(new CrasherIndex(path));
+  absl::Status exists = FileExists(path);
+  if (absl::IsNotFound(exists)) {
+    return index;
+  }
+  XLS_RETURN_IF_ERROR(exists);
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  absl::MutexLock lock(&index->mutex_);
+  int64_t line_number = 0;
+  for (std::string_view line : absl::StrSplit(contents, '\n')) {
+    ++line_number;
+    if (absl::StripAsciiWhitespace(line).empty()) {
+      continue;
+    }
+    std::vector<std::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (fields.size() != 3) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Malformed crasher index entry at %s:%d: \"%s\"",
+                          path.string(), line_number, line));
+    }
+    index->entries_[std::string(fields[0])].push_back(
+        Entry{std::string(fields[1]), std::string(fields[2])});
+    ++index->size_;
+  }
+  return index;
+}
+
+std::optional<std::string> CrasherIndex::FindDuplicateLocked(
+    const CrasherSignature& signature) const {
+  auto it = entries_.find(signature.Key());
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  std::string op_histogram = signature.OpHistogramString();
+  for (const Entry& entry : it->second) {
+    if (op_histogram == "-" || entry.op_histogram == "-" ||
+        entry.op_histogram == op_histogram) {
+      return entry.crasher_name;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string> CrasherIndex::FindDuplicate(
+    const CrasherSignature& signature) const {
+  absl::MutexLock lock(&mutex_);
+  return FindDuplicateLocked(signature);
+}
+
+absl::StatusOr<std::optional<std::string>> CrasherIndex::FindOrAdd(
+    const CrasherSignature& signature, std::string_view crasher_name) {
+  absl::MutexLock lock(&mutex_);
+  std::optional<std::string> duplicate = FindDuplicateLocked(signature);
+  if (duplicate.has_value()) {
+    return duplicate;
+  }
+  std::string op_histogram = signature.OpHistogramString();
+  XLS_RETURN_IF_ERROR(AppendStringToFile(
+      path_, absl::StrFormat("%s %s %s\n", signature.Key(), crasher_name,
+                             op_histogram)));
+  entries_[signature.Key()].push_back(
+      Entry{std::string(crasher_name), op_histogram});
+  ++size_;
+  return std::nullopt;
+}
+
+int64_t CrasherIndex::size() const {
+  absl::MutexLock lock(&mutex_);
+  return size_;
+}
+
+}  // namespace xls
@@ -0,0 +1,125 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_CRASHER_SIGNATURE_H_
+#define XLS_FUZZER_CRASHER_SIGNATURE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Summary of how a fuzzer sample failed, used to recognize crashers which
+// likely share a root cause.
+struct CrasherSignature {
+  // Hex digest of the symbolized stack frames if the failure message contains
+  // a stack trace, otherwise of the normalized failure message (see
+  // NormalizeFailureMessage).
+  std::string message_digest;
+
+  // Name of the optimization pass which failed, or empty if the failure
+  // message does not name one.
+  std::string failing_pass;
+
+  // Number of nodes of each op in the (ideally minimized) IR of the crasher.
+  // Empty if no IR was available.
+  std::map<std::string, int64_t> op_histogram;
+
+  // Returns the part of the signature which is known before minimization,
+  // i.e., everything but the op histogram. Contains no whitespace.
+  std::string Key() const;
+
+  // Returns the op histogram as "op:count" pairs separated by commas, or "-"
+  // if it is empty.
+  std::string OpHistogramString() const;
+};
+
+// Returns `message` with the details which vary between crashers of the same
+// cause (numbers, hex values, directories of paths and runs of whitespace)
+// replaced by placeholders.
+std::string NormalizeFailureMessage(std::string_view message);
+
+// Computes the signature of a crasher from its failure message (e.g., the
+// contents of exception.txt). `package`, if given, is the IR of the crasher
+// and provides the op histogram.
+CrasherSignature ComputeCrasherSignature(std::string_view failure_message,
+                                         const Package* package = nullptr);
+
+// Append-only on-disk index of the signatures of known crashers. Each line of
+// the index file holds one crasher:
+//
+//   <signature key> <crasher name> <op histogram string>
+//
+// Two signatures match if their keys are equal and, when both of them have an
+// op histogram, their op histograms are equal too. So a crasher which has not
+// been minimized yet matches any minimized crasher with the same failure.
+//
+// FindOrAdd checks for a duplicate and records the crasher under one lock, so
+// when several fuzzer workers hit the same failure at once only the first one
+// records it.
+class CrasherIndex {
+ public:
+  // Loads the index at `path`. A missing file gives an empty index which is
+  // created on the first addition.
+  static absl::StatusOr<std::unique_ptr<CrasherIndex>> Load(
+      const std::filesystem::path& path);
+
+  // Returns the name of a recorded crasher whose signature matches
+  // `signature`, if any.
+  std::optional<std::string> FindDuplicate(
+      const CrasherSignature& signature) const;
+
+  // As FindDuplicate, but if there is no duplicate, records the crasher under
+  // `crasher_name` (in memory and on disk) and returns std::nullopt.
+  absl::StatusOr<std::optional<std::string>> FindOrAdd(
+      const CrasherSignature& signature, std::string_view crasher_name);
+
+  int64_t size() const;
+
+ private:
+  struct Entry {
+    std::string crasher_name;
+    // Op histogram string of the signature; "-" if unknown.
+    std::string op_histogram;
+  };
+
+  explicit CrasherIndex(const std::filesystem::path& path) : path_(path) {}
+
+  std::optional<std::string> FindDuplicateLocked(
+      const CrasherSignature& signature) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::filesystem::path path_;
+  mutable absl::Mutex mutex_;
+  int64_t size_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<std::string, std::vector<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_CRASHER_SIGNATURE_H_
@@ -0,0 +1,151 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/crasher_signature.h"
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+using ::testing::Pair;
+
+TEST(CrasherSignatureTest, NormalizeFailureMessage) {
+  EXPECT_EQ(NormalizeFailureMessage(
+                "Result miscompare for sample 3:\n  args: bits[8]:0x2a;  "
+                "bits[8]:17\n  file /tmp/temp_dir_xyz/sample.ir"),
+            "Result miscompare for sample N: args: bits[N]:N; bits[N]:N file "
+            "sample.ir");
+}
+
+TEST(CrasherSignatureTest, SameCauseSameKey) {
+  CrasherSignature a = ComputeCrasherSignature(
+      "INTERNAL: Node add.12 has width 8, expected 16");
+  CrasherSignature b = ComputeCrasherSignature(
+      "INTERNAL: Node add.345 has width 3, expected 7");
+  CrasherSignature c = ComputeCrasherSignature(
+      "INTERNAL: Node add.12 has no users");
+  EXPECT_EQ(a.Key(), b.Key());
+  EXPECT_NE(a.Key(), c.Key());
+  EXPECT_EQ(a.failing_pass, "");
+  EXPECT_EQ(a.OpHistogramString(), "-");
+}
+
+TEST(CrasherSignatureTest, StackTraceDeterminesDigest) {
+  CrasherSignature a = ComputeCrasherSignature(
+      "*** SIGSEGV received at time=1 on cpu 0 ***\n"
+      "    @     0x55d4e7f1a0a1        128  xls::Foo()\n"
+      "    @     0x55d4e7f1b000         64  xls::Bar()\n");
+  CrasherSignature b = ComputeCrasherSignature(
+      "*** SIGSEGV received at time=99 on cpu 7 ***\n"
+      "    @     0x7f0000000001         32  xls::Foo()\n"
+      "    @     0x7f0000000002         16  xls::Bar()\n");
+  CrasherSignature c = ComputeCrasherSignature(
+      "*** SIGSEGV received at time=1 on cpu 0 ***\n"
+      "    @     0x55d4e7f1a0a1        128  xls::Baz()\n");
+  EXPECT_EQ(a.message_digest, b.message_digest);
+  EXPECT_NE(a.message_digest, c.message_digest);
+}
+
+TEST(CrasherSignatureTest, FailingPass) {
+  EXPECT_EQ(ComputeCrasherSignature(
+                "INTERNAL: Verification failed after 'Constant folding' "
+                "pass, dynamic pass #12")
+                .failing_pass,
+            "Constant_folding");
+  EXPECT_EQ(ComputeCrasherSignature(
+                "INTERNAL: Pass cse indicated IR unchanged, but IR is changed")
+                .failing_pass,
+            "cse");
+}
+
+TEST(CrasherSignatureTest, OpHistogram) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package p
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  add.1: bits[8] = add(x, y)
+  ret add.2: bits[8] = add(add.1, y)
+}
+)"));
+  CrasherSignature signature =
+      ComputeCrasherSignature("INTERNAL: failure", package.get());
+  EXPECT_THAT(signature.op_histogram,
+              ElementsAre(Pair("add", 2), Pair("param", 2)));
+  EXPECT_EQ(signature.OpHistogramString(), "add:2,param:2");
+}
+
+TEST(CrasherIndexTest, FindsDuplicatesAcrossLoads) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "index.txt";
+
+  CrasherSignature minimized = ComputeCrasherSignature("INTERNAL: failure");
+  minimized.op_histogram = {{"add", 1}, {"param", 2}};
+  CrasherSignature unminimized = ComputeCrasherSignature("INTERNAL: failure");
+  CrasherSignature other_ops = minimized;
+  other_ops.op_histogram = {{"sub", 1}};
+  CrasherSignature other_failure = ComputeCrasherSignature("INTERNAL: other");
+
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CrasherIndex> index,
+                             CrasherIndex::Load(path));
+    EXPECT_EQ(index->size(), 0);
+    XLS_ASSERT_OK_AND_ASSIGN(std::optional<std::string> duplicate,
+                             index->FindOrAdd(minimized, "crasher_a"));
+    EXPECT_FALSE(duplicate.has_value());
+    XLS_ASSERT_OK_AND_ASSIGN(duplicate,
+                             index->FindOrAdd(minimized, "crasher_b"));
+    EXPECT_THAT(duplicate, Optional(Eq("crasher_a")));
+    EXPECT_EQ(index->size(), 1);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CrasherIndex> index,
+                           CrasherIndex::Load(path));
+  EXPECT_EQ(index->size(), 1);
+  EXPECT_THAT(index->FindDuplicate(minimized), Optional(Eq("crasher_a")));
+  // Before minimization the op histogram is unknown, so only the failure has
+  // to match.
+  EXPECT_THAT(index->FindDuplicate(unminimized), Optional(Eq("crasher_a")));
+  EXPECT_FALSE(index->FindDuplicate(other_ops).has_value());
+  EXPECT_FALSE(index->FindDuplicate(other_failure).has_value());
+}
+
+TEST(CrasherIndexTest, MalformedIndex) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "index.txt";
+  XLS_ASSERT_OK(SetFileContents(path, "abc/- crasher_a\n"));
+  EXPECT_THAT(CrasherIndex::Load(path),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Malformed crasher index entry")));
+}
+
+}  // namespace
+}  // namespace xls
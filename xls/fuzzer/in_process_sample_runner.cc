@@ -0,0 +1,268 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/in_process_sample_runner.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode_emitter.h"
+#include "xls/dslx/bytecode_interpreter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value_helpers.h"
+#include "xls/dslx/ir_converter.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/passes/pass_base.h"
+#include "xls/tools/opt.h"
+
+namespace xls {
+namespace {
+
+constexpr std::string_view kTopName = "main";
+
+using ArgsBatch = std::vector<std::vector<Value>>;
+
+// Records the time elapsed since `start` with the given setter of `timing` (if
+// non-null).
+void RecordTiming(absl::Time start, SampleTimingProto* timing,
+                  void (SampleTimingProto::*setter)(int64_t)) {
+  if (timing != nullptr) {
+    (timing->*setter)(absl::ToInt64Nanoseconds(absl::Now() - start));
+  }
+}
+
+absl::StatusOr<std::vector<Value>> InterpretDslx(
+    dslx::ImportData* import_data, const dslx::TypecheckedModule& tm,
+    const std::vector<std::vector<dslx::InterpValue>>& args_batch) {
+  XLS_ASSIGN_OR_RETURN(dslx::Function * f,
+                       tm.module->GetMemberOrError<dslx::Function>(kTopName));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<dslx::BytecodeFunction> bf,
+      dslx::BytecodeEmitter::Emit(import_data, tm.type_info, f,
+                                  /*caller_bindings=*/{}));
+  XLS_ASSIGN_OR_RETURN(dslx::FunctionType * fn_type,
+                       tm.type_info->GetItemAs<dslx::FunctionType>(f));
+  std::vector<Value> results;
+  results.reserve(args_batch.size());
+  for (const std::vector<dslx::InterpValue>& unsigned_args : args_batch) {
+    XLS_ASSIGN_OR_RETURN(std::vector<dslx::InterpValue> args,
+                         dslx::SignConvertArgs(*fn_type, unsigned_args));
+    XLS_ASSIGN_OR_RETURN(
+        dslx::InterpValue result,
+        dslx::BytecodeInterpreter::Interpret(import_data, bf.get(), args));
+    // The IR has no notion of signedness so the results are compared as IR
+    // values.
+    XLS_ASSIGN_OR_RETURN(Value value, dslx::InterpValueToValue(result));
+    results.push_back(std::move(value));
+  }
+  return results;
+}
+
+absl::StatusOr<std::vector<Value>> EvaluateIr(Function* f,
+                                              const ArgsBatch& args_batch,
+                                              bool use_jit) {
+  std::unique_ptr<FunctionJit> jit;
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(f));
+  }
+  std::vector<Value> results;
+  results.reserve(args_batch.size());
+  for (const std::vector<Value>& args : args_batch) {
+    absl::StatusOr<InterpreterResult<Value>> result =
+        use_jit ? jit->Run(args) : InterpretFunction(f, args);
+    XLS_ASSIGN_OR_RETURN(Value value, DropInterpreterEvents(std::move(result)));
+    results.push_back(std::move(value));
+  }
+  return results;
+}
+
+absl::StatusOr<Function*> ParseTopFunction(std::string_view ir_text,
+                                           std::unique_ptr<Package>* package) {
+  XLS_ASSIGN_OR_RETURN(*package, Parser::ParsePackage(ir_text));
+  return (*package)->GetTopAsFunction();
+}
+
+// Compares the results of each step against those of the (alphabetically)
+// first step, as sample_runner.py does.
+absl::Status CompareResults(
+    const std::map<std::string, std::vector<Value>>& results,
+    const ArgsBatch& args_batch) {
+  if (results.empty()) {
+    return absl::OkStatus();
+  }
+  const auto& [reference, reference_values] = *results.begin();
+  for (const auto& [name, values] : results) {
+    if (values.size() != reference_values.size()) {
+      return absl::InternalError(absl::StrFormat(
+          "Results for %s has %d values, %s has %d", reference,
+          reference_values.size(), name, values.size()));
+    }
+    for (int64_t i = 0; i < values.size(); ++i) {
+      if (values[i] == reference_values[i]) {
+        continue;
+      }
+      // Bin all of the sources by whether they match the reference or
+      // `values`. This helps identify which of the two is likely correct.
+      std::vector<std::string> reference_matches;
+      std::vector<std::string> values_matches;
+      for (const auto& [other_name, other_values] : results) {
+        if (other_values[i] == reference_values[i]) {
+          reference_matches.push_back(other_name);
+        }
+        if (other_values[i] == values[i]) {
+          values_matches.push_back(other_name);
+        }
+      }
+      return absl::InternalError(absl::StrFormat(
+          "Result miscompare for sample %d:\nargs: %s\n%s =\n   %s\n%s =\n"
+          "   %s",
+          i,
+          absl::StrJoin(args_batch[i], "; ",
+                        [](std::string* out, const Value& v) {
+                          absl::StrAppend(out, v.ToString());
+                        }),
+          absl::StrJoin(reference_matches, ", "),
+          reference_values[i].ToString(), absl::StrJoin(values_matches, ", "),
+          values[i].ToString()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status RunSampleInProcess(const Sample& sample,
+                                SampleTimingProto* timing,
+                                SampleCoverage* coverage) {
+  const SampleOptions& options = sample.options();
+  if (!options.input_is_dslx() || options.top_type() != TopType::kFunction ||
+      options.codegen()) {
+    return absl::UnimplementedError(
+        "Only DSLX function samples without codegen can be run in-process");
+  }
+
+  ArgsBatch args_batch;
+  for (const std::vector<dslx::InterpValue>& args : sample.args_batch()) {
+    std::vector<Value>& ir_args = args_batch.emplace_back();
+    for (const dslx::InterpValue& arg : args) {
+      XLS_ASSIGN_OR_RETURN(Value value, dslx::InterpValueToValue(arg));
+      ir_args.push_back(std::move(value));
+    }
+  }
+  std::map<std::string, std::vector<Value>> results;
+
+  dslx::ImportData import_data(dslx::CreateImportData(
+      kDefaultDslxStdlibPath, /*additional_search_paths=*/{}));
+  XLS_ASSIGN_OR_RETURN(dslx::TypecheckedModule tm,
+                       dslx::ParseAndTypecheck(sample.input_text(), "sample.x",
+                                               "sample", &import_data));
+  if (!args_batch.empty()) {
+    absl::Time start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(
+        results["interpreted DSLX"],
+        InterpretDslx(&import_data, tm, sample.args_batch()));
+    RecordTiming(start, timing, &SampleTimingProto::set_interpret_dslx_ns);
+  }
+  if (!options.convert_to_ir()) {
+    return CompareResults(results, args_batch);
+  }
+
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(
+      std::string ir_text,
+      dslx::ConvertOneFunction(tm.module, kTopName, &import_data,
+                               /*symbolic_bindings=*/nullptr,
+                               dslx::ConvertOptions(),
+                               /*top_proc_initial_state=*/std::nullopt));
+  std::unique_ptr<Package> package;
+  XLS_ASSIGN_OR_RETURN(Function * f, ParseTopFunction(ir_text, &package));
+  RecordTiming(start, timing, &SampleTimingProto::set_convert_ir_ns);
+
+  if (!args_batch.empty()) {
+    start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(results["evaluated unopt IR (interpreter)"],
+                         EvaluateIr(f, args_batch, /*use_jit=*/false));
+    RecordTiming(start, timing,
+                 &SampleTimingProto::set_unoptimized_interpret_ir_ns);
+    if (options.use_jit()) {
+      start = absl::Now();
+      XLS_ASSIGN_OR_RETURN(results["evaluated unopt IR (JIT)"],
+                           EvaluateIr(f, args_batch, /*use_jit=*/true));
+      RecordTiming(start, timing, &SampleTimingProto::set_unoptimized_jit_ns);
+    }
+  }
+
+  if (options.optimize_ir()) {
+    start = absl::Now();
+    tools::OptOptions opt_options;
+    opt_options.inline_procs = false;
+    PassResults pass_results;
+    XLS_ASSIGN_OR_RETURN(
+        std::string opt_ir_text,
+        tools::OptimizeIrForTop(ir_text, opt_options, &pass_results));
+    std::unique_ptr<Package> opt_package;
+    XLS_ASSIGN_OR_RETURN(Function * opt_f,
+                         ParseTopFunction(opt_ir_text, &opt_package));
+    RecordTiming(start, timing, &SampleTimingProto::set_optimize_ns);
+    if (coverage != nullptr) {
+      *coverage = SampleCoverage();
+      for (Node* node : f->nodes()) {
+        ++coverage->op_counts[OpToString(node->op())];
+      }
+      for (const PassInvocation& invocation : pass_results.invocations) {
+        if (invocation.ir_changed) {
+          ++coverage->pass_change_counts[invocation.pass_name];
+        }
+      }
+    }
+
+    if (!args_batch.empty()) {
+      if (options.use_jit()) {
+        start = absl::Now();
+        XLS_ASSIGN_OR_RETURN(results["evaluated opt IR (JIT)"],
+                             EvaluateIr(opt_f, args_batch, /*use_jit=*/true));
+        RecordTiming(start, timing, &SampleTimingProto::set_optimized_jit_ns);
+      }
+      start = absl::Now();
+      XLS_ASSIGN_OR_RETURN(results["evaluated opt IR (interpreter)"],
+                           EvaluateIr(opt_f, args_batch, /*use_jit=*/false));
+      RecordTiming(start, timing,
+                   &SampleTimingProto::set_optimized_interpret_ir_ns);
+    }
+  }
+
+  return CompareResults(results, args_batch);
+}
+
+}  // namespace xls
@@ -0,0 +1,57 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_IN_PROCESS_SAMPLE_RUNNER_H_
+#define XLS_FUZZER_IN_PROCESS_SAMPLE_RUNNER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+
+// What a sample exercised in the IR optimization pipeline, as feedback for
+// coverage-guided generation.
+struct SampleCoverage {
+  // The number of nodes of each op (by OpToString()) in the unoptimized IR.
+  absl::flat_hash_map<std::string, int64_t> op_counts;
+  // The number of invocations of each pass which changed the IR.
+  absl::flat_hash_map<std::string, int64_t> pass_change_counts;
+};
+
+// Runs a fuzzer sample without leaving the process: the DSLX is interpreted,
+// converted to IR and optimized, and the unoptimized and optimized IR are
+// evaluated with the interpreter and (if the sample options say to) the JIT,
+// all on in-memory representations. This is the function-sample pipeline of
+// sample_runner.py minus the per-step process launches and file round trips.
+//
+// Returns an error describing the first step which failed or, if all steps
+// succeeded, the first miscompare between the results of the steps (in
+// the same format as sample_runner.py). If `timing` is non-null the time spent
+// in each step is recorded in it, and likewise for `coverage` (which is only
+// filled in when the IR is optimized).
+//
+// Only DSLX function samples without codegen are supported; other samples
+// result in an Unimplemented error.
+absl::Status RunSampleInProcess(const Sample& sample,
+                                SampleTimingProto* timing = nullptr,
+                                SampleCoverage* coverage = nullptr);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_IN_PROCESS_SAMPLE_RUNNER_H_
@@ -0,0 +1,94 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/in_process_sample_runner.h"
+
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_generator.h"
+
+namespace xls {
+namespace {
+
+using dslx::InterpValue;
+using status_testing::StatusIs;
+
+constexpr std::string_view kSignedSample = R"(
+fn main(x: s8, y: u8) -> (s8, u16) {
+  let z = x >> (y as u3);
+  (z, (y as u16) * u16:3)
+}
+)";
+
+TEST(InProcessSampleRunnerTest, RunsFunctionSample) {
+  SampleOptions options;
+  options.set_ir_converter_args({"--top=main"});
+  Sample sample(
+      std::string(kSignedSample), options,
+      {{InterpValue::MakeUBits(8, 0x80), InterpValue::MakeUBits(8, 3)},
+       {InterpValue::MakeUBits(8, 0x7f), InterpValue::MakeUBits(8, 255)}});
+  SampleTimingProto timing;
+  XLS_EXPECT_OK(RunSampleInProcess(sample, &timing));
+  EXPECT_TRUE(timing.has_interpret_dslx_ns());
+  EXPECT_TRUE(timing.has_optimized_jit_ns());
+}
+
+TEST(InProcessSampleRunnerTest, WithoutJit) {
+  SampleOptions options;
+  options.set_use_jit(false);
+  Sample sample(
+      std::string(kSignedSample), options,
+      {{InterpValue::MakeUBits(8, 0xf0), InterpValue::MakeUBits(8, 1)}});
+  SampleTimingProto timing;
+  XLS_EXPECT_OK(RunSampleInProcess(sample, &timing));
+  EXPECT_FALSE(timing.has_unoptimized_jit_ns());
+  EXPECT_TRUE(timing.has_optimized_interpret_ir_ns());
+}
+
+TEST(InProcessSampleRunnerTest, TypeErrorIsReported) {
+  Sample sample("fn main(x: u8) -> u16 { x }", SampleOptions(),
+                {{InterpValue::MakeUBits(8, 1)}});
+  EXPECT_FALSE(RunSampleInProcess(sample).ok());
+}
+
+TEST(InProcessSampleRunnerTest, CodegenIsUnimplemented) {
+  SampleOptions options;
+  options.set_codegen(true);
+  Sample sample(std::string(kSignedSample), options, {});
+  EXPECT_THAT(RunSampleInProcess(sample),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+TEST(InProcessSampleRunnerTest, GeneratedSamples) {
+  RngState rng(std::mt19937{});
+  dslx::AstGeneratorOptions generator_options;
+  SampleOptions sample_options;
+  sample_options.set_calls_per_sample(8);
+  for (int64_t i = 0; i < 8; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Sample sample,
+        GenerateSample(generator_options, sample_options, &rng));
+    XLS_EXPECT_OK(RunSampleInProcess(sample)) << sample.input_text();
+  }
+}
+
+}  // namespace
+}  // namespace xls
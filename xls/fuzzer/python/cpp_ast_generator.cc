@@ -114,8 +114,13 @@ PYBIND11_MODULE(cpp_ast_generator, m) {
           }
           return result;
         });
-  m.def("generate_sample", GenerateSample, py::arg("options"),
-        py::arg("default_options"), py::arg("rng"));
+  m.def(
+      "generate_sample",
+      [](const AstGeneratorOptions& options,
+         const SampleOptions& default_options, RngState* rng) {
+        return GenerateSample(options, default_options, rng);
+      },
+      py::arg("options"), py::arg("default_options"), py::arg("rng"));
 }
 
 }  // namespace xls::dslx
@@ -0,0 +1,293 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/coverage_feedback.h"
+#include "xls/fuzzer/crasher_signature.h"
+#include "xls/fuzzer/in_process_sample_runner.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_generator.h"
+
+const char kUsage[] = R"(
+Generates and runs fuzzer samples on a pool of threads within a single process.
+Each sample is interpreted, converted to IR, optimized and evaluated in memory
+(see in_process_sample_runner.h) rather than by launching the XLS tools, so this
+runs many more samples per second than run_fuzz_multiprocess. It does not
+support codegen, use run_fuzz_multiprocess for that.
+
+Failing samples are written as crashers into --crash_path. Example invocation:
+
+  run_fuzz_multithreaded_main --crash_path=/tmp/crashers --duration=1h
+)";
+
+ABSL_FLAG(int64_t, seed, 0,
+          "Seed value for generation. Zero chooses a nondeterministic seed.");
+ABSL_FLAG(int64_t, sample_count, 0,
+          "Number of samples to generate; zero for no limit.");
+ABSL_FLAG(absl::Duration, duration, absl::InfiniteDuration(),
+          "Duration to run the fuzzer for.");
+ABSL_FLAG(int64_t, calls_per_sample, 128,
+          "Arguments to generate per sample.");
+ABSL_FLAG(std::string, crash_path, "", "Path at which to place crash data.");
+ABSL_FLAG(int64_t, worker_count, 0,
+          "Number of threads to run samples on; zero for one per hardware "
+          "thread.");
+ABSL_FLAG(bool, emit_loops, true, "Emit loops in generator.");
+ABSL_FLAG(bool, use_llvm_jit, true,
+          "Use LLVM JIT to evaluate IR. The interpreter is still invoked at "
+          "least once on the IR even with this option enabled, but this option "
+          "can be used to disable the JIT entirely.");
+ABSL_FLAG(int64_t, max_width_bits_types, 64,
+          "The maximum width of bits types in the generated samples.");
+ABSL_FLAG(int64_t, max_width_aggregate_types, 1024,
+          "The maximum width of aggregate types (tuples and arrays) in the "
+          "generated samples.");
+ABSL_FLAG(bool, coverage_feedback, false,
+          "Bias the generation of samples towards the kinds of expressions "
+          "whose samples exercised rarely seen IR ops and optimization "
+          "passes (see coverage_feedback.h).");
+ABSL_FLAG(std::string, crasher_index, "",
+          "If given, a crasher index file (see crasher_dedup_main). Failing "
+          "samples whose failure signature matches a crasher of the index are "
+          "counted but not saved, new crashers are added to the index.");
+ABSL_FLAG(bool, force_failure, false,
+          "Forces each run to assert failure. Used for testing failure paths.");
+
+namespace xls {
+namespace {
+
+struct WorkerConfig {
+  int64_t worker_number;
+  dslx::AstGeneratorOptions generator_options;
+  SampleOptions sample_options;
+  std::filesystem::path crasher_dir;
+  int64_t seed;
+  // Zero for no limit.
+  int64_t sample_count;
+  absl::Time deadline;
+  bool force_failure;
+  // Shared by all workers; null if coverage feedback is disabled.
+  CoverageFeedback* coverage_feedback;
+  // Shared by all workers; null if crashers are not deduplicated.
+  CrasherIndex* crasher_index;
+};
+
+std::string Sha256Hex(std::string_view data) {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest), SHA256_DIGEST_LENGTH));
+}
+
+// Writes the sample as a crasher into a directory of `crasher_dir` named after
+// the sample, as run_fuzz.py does.
+absl::Status SaveCrasher(const Sample& sample, const absl::Status& error,
+                         const std::filesystem::path& crasher_dir) {
+  std::string digest = Sha256Hex(sample.input_text()).substr(0, 8);
+  std::filesystem::path sample_crasher_dir = crasher_dir / digest;
+  XLS_LOG(INFO) << "Saving crasher to " << sample_crasher_dir;
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(sample_crasher_dir));
+  XLS_RETURN_IF_ERROR(SetFileContents(sample_crasher_dir / "exception.txt",
+                                      error.ToString()));
+  std::string crasher_name = absl::StrFormat(
+      "crasher_%s_%s.x", absl::FormatTime("%Y-%m-%d", absl::Now(),
+                                          absl::LocalTimeZone()),
+      digest.substr(0, 4));
+  return SetFileContents(sample_crasher_dir / crasher_name,
+                         sample.ToCrasher(error.message()));
+}
+
+absl::Status DoWorkerTask(const WorkerConfig& config) {
+  std::cout << absl::StreamFormat("--- Started worker %d\n",
+                                  config.worker_number);
+  absl::Time start = absl::Now();
+  RngState rng(std::mt19937(config.seed + config.worker_number));
+
+  dslx::AstGeneratorOptions generator_options = config.generator_options;
+  int64_t crashers = 0;
+  int64_t i = 0;
+  for (; config.sample_count == 0 || i < config.sample_count; ++i) {
+    if (absl::Now() >= config.deadline) {
+      break;
+    }
+    // Weights are only refreshed occasionally as they change slowly.
+    if (config.coverage_feedback != nullptr && i % 16 == 0) {
+      generator_options.expression_weights =
+          config.coverage_feedback->GetExpressionWeights();
+    }
+    absl::flat_hash_map<std::string, int64_t> expression_kind_counts;
+    XLS_ASSIGN_OR_RETURN(
+        Sample sample,
+        GenerateSample(generator_options, config.sample_options, &rng,
+                       &expression_kind_counts));
+    SampleCoverage coverage;
+    absl::Status status =
+        RunSampleInProcess(sample, /*timing=*/nullptr, &coverage);
+    if (status.ok() && config.coverage_feedback != nullptr) {
+      config.coverage_feedback->AddSample(expression_kind_counts, coverage);
+    }
+    if (status.ok() && config.force_failure) {
+      status = absl::InternalError("Forced sample failure.");
+    }
+    if (!status.ok()) {
+      XLS_LOG(ERROR) << "Sample failed: " << status;
+      std::optional<std::string> duplicate;
+      if (config.crasher_index != nullptr) {
+        XLS_ASSIGN_OR_RETURN(
+            duplicate, config.crasher_index->FindOrAdd(
+                           ComputeCrasherSignature(status.ToString()),
+                           Sha256Hex(sample.input_text()).substr(0, 8)));
+      }
+      if (duplicate.has_value()) {
+        XLS_LOG(INFO) << "Not saving crasher, duplicate of " << *duplicate;
+      } else {
+        XLS_RETURN_IF_ERROR(SaveCrasher(sample, status, config.crasher_dir));
+      }
+      std::cout << absl::StreamFormat(
+          "--- Worker %d noted crasher #%d for sample number %d\n",
+          config.worker_number, crashers, i);
+      ++crashers;
+    }
+    if (i != 0 && i % 16 == 0) {
+      absl::Duration elapsed = absl::Now() - start;
+      std::cout << absl::StreamFormat(
+          "--- Worker %3d: %d samples, %.2f samples/s, running for %s\n",
+          config.worker_number, i, i / absl::ToDoubleSeconds(elapsed),
+          absl::FormatDuration(elapsed));
+    }
+  }
+
+  absl::Duration elapsed = absl::Now() - start;
+  std::cout << absl::StreamFormat(
+      "--- Worker %3d finished! %d samples; %d crashers; %.2f samples/s; ran "
+      "for %s\n",
+      config.worker_number, i, crashers, i / absl::ToDoubleSeconds(elapsed),
+      absl::FormatDuration(elapsed));
+  return absl::OkStatus();
+}
+
+absl::Status RealMain() {
+  std::filesystem::path crasher_dir = absl::GetFlag(FLAGS_crash_path);
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(crasher_dir));
+
+  int64_t worker_count = absl::GetFlag(FLAGS_worker_count);
+  if (worker_count <= 0) {
+    worker_count = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+  }
+  int64_t seed = absl::GetFlag(FLAGS_seed);
+  if (seed == 0) {
+    seed = std::random_device()();
+  }
+
+  dslx::AstGeneratorOptions generator_options;
+  generator_options.emit_loops = absl::GetFlag(FLAGS_emit_loops);
+  generator_options.max_width_bits_types =
+      absl::GetFlag(FLAGS_max_width_bits_types);
+  generator_options.max_width_aggregate_types =
+      absl::GetFlag(FLAGS_max_width_aggregate_types);
+
+  SampleOptions sample_options;
+  sample_options.set_input_is_dslx(true);
+  sample_options.set_ir_converter_args({"--top=main"});
+  sample_options.set_calls_per_sample(absl::GetFlag(FLAGS_calls_per_sample));
+  sample_options.set_use_jit(absl::GetFlag(FLAGS_use_llvm_jit));
+
+  // As in run_fuzz_multiprocess, the sample count is split between the
+  // workers.
+  int64_t sample_count = absl::GetFlag(FLAGS_sample_count);
+  absl::Time deadline = absl::Now() + absl::GetFlag(FLAGS_duration);
+  CoverageFeedback coverage_feedback;
+  std::unique_ptr<CrasherIndex> crasher_index;
+  if (!absl::GetFlag(FLAGS_crasher_index).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        crasher_index, CrasherIndex::Load(absl::GetFlag(FLAGS_crasher_index)));
+  }
+  std::vector<WorkerConfig> configs;
+  for (int64_t i = 0; i < worker_count; ++i) {
+    WorkerConfig config;
+    config.worker_number = i;
+    config.generator_options = generator_options;
+    config.sample_options = sample_options;
+    config.crasher_dir = crasher_dir;
+    config.seed = seed;
+    config.sample_count =
+        sample_count == 0 ? 0 : (sample_count + i) / worker_count;
+    config.deadline = deadline;
+    config.force_failure = absl::GetFlag(FLAGS_force_failure);
+    config.coverage_feedback = absl::GetFlag(FLAGS_coverage_feedback)
+                                   ? &coverage_feedback
+                                   : nullptr;
+    config.crasher_index = crasher_index.get();
+    if (sample_count != 0 && config.sample_count == 0) {
+      continue;
+    }
+    configs.push_back(config);
+  }
+
+  std::vector<absl::Status> statuses(configs.size());
+  std::vector<std::unique_ptr<xls::Thread>> threads;
+  for (int64_t i = 1; i < configs.size(); ++i) {
+    threads.push_back(std::make_unique<xls::Thread>(
+        [&, i]() { statuses[i] = DoWorkerTask(configs[i]); }));
+  }
+  if (!configs.empty()) {
+    statuses[0] = DoWorkerTask(configs[0]);
+  }
+  for (std::unique_ptr<xls::Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+  XLS_QCHECK(positional_arguments.empty())
+      << "Unexpected positional arguments.";
+  XLS_QCHECK(!absl::GetFlag(FLAGS_crash_path).empty())
+      << "--crash_path must be specified.";
+  XLS_QCHECK_OK(xls::RealMain());
+  return 0;
+}
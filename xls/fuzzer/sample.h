@@ -84,6 +84,7 @@ class SampleOptions {
   void set_ir_converter_args(const std::vector<std::string>& value) {
     ir_converter_args_ = value;
   }
+  void set_use_jit(bool value) { use_jit_ = value; }
   void set_codegen(bool value) { codegen_ = value; }
   void set_simulate(bool value) { simulate_ = value; }
   void set_codegen_args(const std::vector<std::string>& value) {
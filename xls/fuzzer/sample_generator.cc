@@ -201,10 +201,14 @@ static std::vector<std::string> GenerateCodegenArgs(bool use_system_verilog,
 }
 
 static absl::StatusOr<std::string> Generate(
-    const AstGeneratorOptions& ast_options, RngState* rng) {
+    const AstGeneratorOptions& ast_options, RngState* rng,
+    absl::flat_hash_map<std::string, int64_t>* expression_kind_counts) {
   AstGenerator g(ast_options, &rng->rng());
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module,
                        g.Generate("main", "test"));
+  if (expression_kind_counts != nullptr) {
+    *expression_kind_counts = g.expression_kind_counts();
+  }
   return module->ToString();
 }
 
@@ -317,7 +321,8 @@ absl::StatusOr<Sample> GenerateProcSample(dslx::Proc* proc,
 
 absl::StatusOr<Sample> GenerateSample(
     const AstGeneratorOptions& generator_options,
-    const SampleOptions& sample_options, RngState* rng) {
+    const SampleOptions& sample_options, RngState* rng,
+    absl::flat_hash_map<std::string, int64_t>* expression_kind_counts) {
   constexpr std::string_view top_name = "main";
   if (generator_options.generate_proc) {
     XLS_CHECK_EQ(sample_options.calls_per_sample(), 0)
@@ -344,7 +349,9 @@ absl::StatusOr<Sample> GenerateSample(
     sample_options_copy.set_codegen_args(
         GenerateCodegenArgs(sample_options_copy.use_system_verilog(), rng));
   }
-  XLS_ASSIGN_OR_RETURN(std::string dslx_text, Generate(generator_options, rng));
+  XLS_ASSIGN_OR_RETURN(
+      std::string dslx_text,
+      Generate(generator_options, rng, expression_kind_counts));
 
   // Parse and type check the DSLX input to retrieve the top entity. The top
   // member must be a proc or a function.
@@ -16,7 +16,9 @@
 #define XLS_FUZZER_SAMPLE_GENERATOR_H_
 
 #include <random>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/span.h"
 #include "xls/dslx/concrete_type.h"
 #include "xls/fuzzer/ast_generator.h"
@@ -50,10 +52,14 @@ class RngState {
 absl::StatusOr<std::vector<dslx::InterpValue>> GenerateArguments(
     absl::Span<const dslx::ConcreteType* const> arg_types, RngState* rng);
 
-// Generates and returns a random Sample with the given options.
+// Generates and returns a random Sample with the given options. If
+// `expression_kind_counts` is non-null, it is set to the number of expressions
+// of each kind in the sample (see AstGenerator::expression_kind_counts()).
 absl::StatusOr<Sample> GenerateSample(
     const dslx::AstGeneratorOptions& generator_options,
-    const SampleOptions& sample_options, RngState* rng);
+    const SampleOptions& sample_options, RngState* rng,
+    absl::flat_hash_map<std::string, int64_t>* expression_kind_counts =
+        nullptr);
 
 }  // namespace xls
 
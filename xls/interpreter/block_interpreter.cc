@@ -14,28 +14,76 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <algorithm>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/op.h"
 #include "xls/ir/value_helpers.h"
 
 namespace xls {
 namespace {
 
-// An interpreter for XLS blocks.
+// Returns the slots of the nodes of the block which read or write port and
+// register values. Input ports are mapped to their index in
+// Block::GetInputPorts and register reads and writes to the index of their
+// register in Block::GetRegisters.
+absl::flat_hash_map<Node*, int64_t> GetNodeSlots(Block* block) {
+  absl::flat_hash_map<Node*, int64_t> slots;
+  for (int64_t i = 0; i < block->GetInputPorts().size(); ++i) {
+    slots[block->GetInputPorts()[i]] = i;
+  }
+  for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+    Register* reg = block->GetRegisters()[i];
+    absl::StatusOr<RegisterRead*> reg_read = block->GetRegisterRead(reg);
+    if (reg_read.ok()) {
+      slots[reg_read.value()] = i;
+    }
+    absl::StatusOr<RegisterWrite*> reg_write = block->GetRegisterWrite(reg);
+    if (reg_write.ok()) {
+      slots[reg_write.value()] = i;
+    }
+  }
+  return slots;
+}
+
+// Returns the index of the port named `name` in `ports` or std::nullopt if
+// there is no such port.
+template <typename PortT>
+std::optional<int64_t> FindPortIndex(absl::Span<PortT* const> ports,
+                                     std::string_view name) {
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    if (ports[i]->GetName() == name) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+// An interpreter for XLS blocks. Port and register values are indexed by the
+// slots computed by GetNodeSlots.
 class BlockInterpreter : public IrInterpreter {
  public:
-  BlockInterpreter(const absl::flat_hash_map<std::string, Value>& inputs,
-                   const absl::flat_hash_map<std::string, Value>& reg_state)
-      : IrInterpreter(/*args=*/{}), inputs_(inputs), reg_state_(reg_state) {}
+  // If `node_values` is non-null, node values are stored in (and read from)
+  // the given map rather than a map owned by the interpreter.
+  BlockInterpreter(const absl::flat_hash_map<Node*, int64_t>& slots,
+                   absl::Span<const Value> inputs,
+                   absl::Span<const Value> reg_state,
+                   absl::Span<Value> next_reg_state,
+                   absl::flat_hash_map<Node*, Value>* node_values = nullptr)
+      : IrInterpreter(node_values, /*events=*/nullptr),
+        slots_(slots),
+        inputs_(inputs),
+        reg_state_(reg_state),
+        next_reg_state_(next_reg_state) {}
 
   absl::Status HandleInputPort(InputPort* input_port) override {
-    auto port_iter = inputs_.find(input_port->GetName());
-    if (port_iter == inputs_.end()) {
-      return absl::InvalidArgumentError(absl::StrFormat(
-          "Missing input for port '%s'", input_port->GetName()));
-    }
-
-    return SetValueResult(input_port, port_iter->second);
+    return SetValueResult(input_port, inputs_[slots_.at(input_port)]);
   }
 
   absl::Status HandleOutputPort(OutputPort* output_port) override {
@@ -44,15 +92,11 @@ class BlockInterpreter : public IrInterpreter {
   }
 
   absl::Status HandleRegisterRead(RegisterRead* reg_read) override {
-    auto reg_value_iter = reg_state_.find(reg_read->GetRegister()->name());
-    if (reg_value_iter == reg_state_.end()) {
-      return absl::InvalidArgumentError(absl::StrFormat(
-          "Missing value for register '%s'", reg_read->GetRegister()->name()));
-    }
-    return SetValueResult(reg_read, reg_value_iter->second);
+    return SetValueResult(reg_read, reg_state_[slots_.at(reg_read)]);
   }
 
   absl::Status HandleRegisterWrite(RegisterWrite* reg_write) override {
+    int64_t slot = slots_.at(reg_write);
     auto get_next_reg_state = [&]() -> Value {
       if (reg_write->reset().has_value()) {
         bool reset_signal = ResolveAsBool(reg_write->reset().value());
@@ -67,36 +111,33 @@ class BlockInterpreter : public IrInterpreter {
           !ResolveAsBool(reg_write->load_enable().value())) {
         // Load enable is not activated. Next register state is the previous
         // register value.
-        return reg_state_.at(reg_write->GetRegister()->name());
+        return reg_state_[slot];
       }
 
       // Next register state is the input data value.
       return ResolveAsValue(reg_write->data());
     };
 
-    next_reg_state_[reg_write->GetRegister()->name()] = get_next_reg_state();
-    XLS_VLOG(3) << absl::StreamFormat(
-        "Next register value for register %s: %s",
-        reg_write->GetRegister()->name(),
-        next_reg_state_.at(reg_write->GetRegister()->name()).ToString());
+    next_reg_state_[slot] = get_next_reg_state();
+    XLS_VLOG(3) << absl::StreamFormat("Next register value for register %s: %s",
+                                      reg_write->GetRegister()->name(),
+                                      next_reg_state_[slot].ToString());
 
     // Register writes have empty tuple types.
     return SetValueResult(reg_write, Value::Tuple({}));
   }
 
-  absl::flat_hash_map<std::string, Value>&& MoveRegState() {
-    return std::move(next_reg_state_);
-  }
-
  private:
+  const absl::flat_hash_map<Node*, int64_t>& slots_;
+
   // Values fed to the input ports.
-  const absl::flat_hash_map<std::string, Value> inputs_;
+  absl::Span<const Value> inputs_;
 
   // The state of the registers in this iteration.
-  const absl::flat_hash_map<std::string, Value> reg_state_;
+  absl::Span<const Value> reg_state_;
 
   // The next state for the registers.
-  absl::flat_hash_map<std::string, Value> next_reg_state_;
+  absl::Span<Value> next_reg_state_;
 };
 
 }  // namespace
@@ -104,9 +145,7 @@ class BlockInterpreter : public IrInterpreter {
 absl::StatusOr<BlockRunResult> BlockRun(
     const absl::flat_hash_map<std::string, Value>& inputs,
     const absl::flat_hash_map<std::string, Value>& reg_state, Block* block) {
-  // Verify each input corresponds to an input port. The reverse check (each
-  // input port has a corresponding value in `inputs`) is checked in
-  // HandleInputPort.
+  // Verify each input corresponds to an input port.
   absl::flat_hash_set<std::string> input_port_names;
   for (InputPort* port : block->GetInputPorts()) {
     input_port_names.insert(port->GetName());
@@ -118,9 +157,7 @@ absl::StatusOr<BlockRunResult> BlockRun(
     }
   }
 
-  // Verify each register value corresponds to a register. The reverse check
-  // (each register has a corresponding value in `reg_state`) is checked in
-  // HandleRegisterRead.
+  // Verify each register value corresponds to a register.
   absl::flat_hash_set<std::string> reg_names;
   for (Register* reg : block->GetRegisters()) {
     reg_names.insert(reg->name());
@@ -132,7 +169,34 @@ absl::StatusOr<BlockRunResult> BlockRun(
     }
   }
 
-  BlockInterpreter interpreter(inputs, reg_state);
+  // Gather the values into slots. Each input port must have a value, as must
+  // each register which is read.
+  std::vector<Value> input_values;
+  for (InputPort* port : block->GetInputPorts()) {
+    auto port_iter = inputs.find(port->GetName());
+    if (port_iter == inputs.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing input for port '%s'", port->GetName()));
+    }
+    input_values.push_back(port_iter->second);
+  }
+  std::vector<Value> reg_values;
+  for (Register* reg : block->GetRegisters()) {
+    auto reg_value_iter = reg_state.find(reg->name());
+    if (reg_value_iter != reg_state.end()) {
+      reg_values.push_back(reg_value_iter->second);
+    } else if (block->GetRegisterRead(reg).ok()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing value for register '%s'", reg->name()));
+    } else {
+      reg_values.push_back(ZeroOfType(reg->type()));
+    }
+  }
+  std::vector<Value> next_reg_values = reg_values;
+
+  absl::flat_hash_map<Node*, int64_t> slots = GetNodeSlots(block);
+  BlockInterpreter interpreter(slots, input_values, reg_values,
+                               absl::MakeSpan(next_reg_values));
   XLS_RETURN_IF_ERROR(block->Accept(&interpreter));
 
   BlockRunResult result;
@@ -140,11 +204,133 @@ absl::StatusOr<BlockRunResult> BlockRun(
     result.outputs[port->GetName()] =
         interpreter.ResolveAsValue(port->operand(0));
   }
-  result.reg_state = std::move(interpreter.MoveRegState());
+  for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+    Register* reg = block->GetRegisters()[i];
+    if (block->GetRegisterWrite(reg).ok()) {
+      result.reg_state[reg->name()] = std::move(next_reg_values[i]);
+    }
+  }
 
   return result;
 }
 
+BlockCycleInterpreter::BlockCycleInterpreter(Block* block,
+                                             bool track_activity)
+    : block_(block),
+      track_activity_(track_activity),
+      slots_(GetNodeSlots(block)) {
+  if (track_activity_) {
+    execution_order_ = TopoSort(block).AsVector();
+  }
+  for (InputPort* port : block->GetInputPorts()) {
+    inputs_.push_back(ZeroOfType(port->GetType()));
+  }
+  for (OutputPort* port : block->GetOutputPorts()) {
+    outputs_.push_back(ZeroOfType(port->operand(0)->GetType()));
+  }
+  for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+    Register* reg = block->GetRegisters()[i];
+    registers_.push_back(ZeroOfType(reg->type()));
+    if (!block->GetRegisterWrite(reg).ok()) {
+      held_registers_.push_back(i);
+    }
+  }
+  next_registers_ = registers_;
+}
+
+absl::StatusOr<int64_t> BlockCycleInterpreter::GetInputPortIndex(
+    std::string_view name) const {
+  std::optional<int64_t> index = FindPortIndex(block_->GetInputPorts(), name);
+  if (!index.has_value()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Block has no input port '%s'", name));
+  }
+  return index.value();
+}
+
+absl::StatusOr<int64_t> BlockCycleInterpreter::GetOutputPortIndex(
+    std::string_view name) const {
+  std::optional<int64_t> index = FindPortIndex(block_->GetOutputPorts(), name);
+  if (!index.has_value()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Block has no output port '%s'", name));
+  }
+  return index.value();
+}
+
+absl::StatusOr<int64_t> BlockCycleInterpreter::GetRegisterIndex(
+    std::string_view name) const {
+  for (int64_t i = 0; i < block_->GetRegisters().size(); ++i) {
+    if (block_->GetRegisters()[i]->name() == name) {
+      return i;
+    }
+  }
+  return absl::NotFoundError(
+      absl::StrFormat("Block has no register '%s'", name));
+}
+
+absl::Status BlockCycleInterpreter::RunOneCycle() {
+  // Registers without a write keep their value.
+  for (int64_t i : held_registers_) {
+    next_registers_[i] = registers_[i];
+  }
+  if (track_activity_) {
+    XLS_RETURN_IF_ERROR(EvaluateChangedNodes());
+  } else {
+    BlockInterpreter interpreter(slots_, inputs_, registers_,
+                                 absl::MakeSpan(next_registers_));
+    XLS_RETURN_IF_ERROR(block_->Accept(&interpreter));
+    for (int64_t i = 0; i < block_->GetOutputPorts().size(); ++i) {
+      outputs_[i] =
+          interpreter.ResolveAsValue(block_->GetOutputPorts()[i]->operand(0));
+    }
+    evaluated_node_count_ = block_->node_count();
+  }
+  std::swap(registers_, next_registers_);
+  return absl::OkStatus();
+}
+
+absl::Status BlockCycleInterpreter::EvaluateChangedNodes() {
+  BlockInterpreter interpreter(slots_, inputs_, registers_,
+                               absl::MakeSpan(next_registers_), &node_values_);
+  bool first_cycle = node_values_.empty();
+  changed_nodes_.clear();
+  evaluated_node_count_ = 0;
+  for (Node* node : execution_order_) {
+    // Side-effecting nodes are always evaluated. These include the input ports
+    // and register reads whose values are compared against the previous cycle
+    // below, and the register writes which must produce the next register
+    // value in every cycle.
+    bool evaluate = first_cycle || OpIsSideEffecting(node->op()) ||
+                    std::any_of(node->operands().begin(),
+                                node->operands().end(), [&](Node* operand) {
+                                  return changed_nodes_.contains(operand);
+                                });
+    if (!evaluate) {
+      continue;
+    }
+    std::optional<Value> previous_value;
+    auto value_iter = node_values_.find(node);
+    if (value_iter != node_values_.end()) {
+      previous_value = std::move(value_iter->second);
+      node_values_.erase(value_iter);
+    }
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(&interpreter));
+    ++evaluated_node_count_;
+    if (!previous_value.has_value() ||
+        node_values_.at(node) != previous_value.value()) {
+      changed_nodes_.insert(node);
+    }
+  }
+  for (int64_t i = 0; i < block_->GetOutputPorts().size(); ++i) {
+    Node* operand = block_->GetOutputPorts()[i]->operand(0);
+    if (first_cycle || changed_nodes_.contains(operand)) {
+      outputs_[i] = node_values_.at(operand);
+    }
+  }
+  return absl::OkStatus();
+}
+
 // Convert a uint64_t to a Value suitable for node's type.
 static absl::StatusOr<Value> ConvertInputUint64ToValue(uint64_t input,
                                                        const InputPort* port,
@@ -304,6 +490,19 @@ InterpretSequentialBlock(
   return outputs;
 }
 
+ChannelSource::ChannelSource(std::string_view data_name,
+                             std::string_view valid_name,
+                             std::string_view ready_name, double lambda,
+                             Block* block)
+    : data_name_(data_name),
+      valid_name_(valid_name),
+      ready_name_(ready_name),
+      lambda_(lambda),
+      block_(block),
+      data_index_(FindPortIndex(block->GetInputPorts(), data_name)),
+      valid_index_(FindPortIndex(block->GetInputPorts(), valid_name)),
+      ready_index_(FindPortIndex(block->GetOutputPorts(), ready_name)) {}
+
 absl::Status ChannelSource::SetDataSequence(std::vector<Value> data) {
   // TODO(tedhong): 2022-03-15 - Add additional checks to ensure type of Value
   // elements in data are consistent and compatible with this channel's
@@ -325,31 +524,17 @@ absl::Status ChannelSource::SetDataSequence(absl::Span<const uint64_t> data) {
   return absl::OkStatus();
 }
 
-absl::Status ChannelSource::SetBlockInputs(
-    int64_t this_cycle, absl::flat_hash_map<std::string, Value>& inputs,
-    std::minstd_rand& random_engine, std::optional<verilog::ResetProto> reset) {
-  bool is_in_reset = false;
-
-  // Don't send inputs when reset is asserted, because we don't typically care
-  // about the behavior of the block when inputs are sent during reset.
-  if (reset.has_value()) {
-    if (inputs.contains(reset.value().name())) {
-      Value value_when_reset_asserted =
-          Value(UBits(reset.value().active_low() ? 0 : 1, 1));
-      if (inputs.at(reset.value().name()) == value_when_reset_asserted) {
-        is_in_reset = true;
-      }
-    }
-  }
-
+absl::Status ChannelSource::DriveDataAndValid(bool is_in_reset,
+                                              std::minstd_rand& random_engine,
+                                              Value& data, Value& valid) {
   if (!is_in_reset) {
     if (is_valid_) {
       // Continue to output valid and data, while waiting for the ready signal.
       XLS_CHECK_GE(current_index_, 0);
       XLS_CHECK_LT(current_index_, data_sequence_.size());
 
-      inputs[data_name_] = data_sequence_.at(current_index_);
-      inputs[valid_name_] = Value(UBits(1, 1));
+      data = data_sequence_.at(current_index_);
+      valid = Value(UBits(1, 1));
 
       return absl::OkStatus();
     }
@@ -362,8 +547,8 @@ absl::Status ChannelSource::SetBlockInputs(
         XLS_CHECK_GE(current_index_, 0);
         XLS_CHECK_LT(current_index_, data_sequence_.size());
 
-        inputs[data_name_] = data_sequence_.at(current_index_);
-        inputs[valid_name_] = Value(UBits(1, 1));
+        data = data_sequence_.at(current_index_);
+        valid = Value(UBits(1, 1));
         is_valid_ = true;
 
         return absl::OkStatus();
@@ -372,13 +557,66 @@ absl::Status ChannelSource::SetBlockInputs(
   }
 
   // If stalling, send a zero value with valid bit set to zero.
-  XLS_ASSIGN_OR_RETURN(const InputPort* port, block_->GetInputPort(data_name_));
-  inputs[data_name_] = ZeroOfType(port->GetType());
-  inputs[valid_name_] = Value(UBits(0, 1));
+  if (!data_index_.has_value()) {
+    return block_->GetInputPort(data_name_).status();
+  }
+  data = ZeroOfType(block_->GetInputPorts()[data_index_.value()]->GetType());
+  valid = Value(UBits(0, 1));
+
+  return absl::OkStatus();
+}
+
+absl::Status ChannelSource::SetBlockInputs(
+    int64_t this_cycle, absl::flat_hash_map<std::string, Value>& inputs,
+    std::minstd_rand& random_engine, std::optional<verilog::ResetProto> reset) {
+  bool is_in_reset = false;
+
+  // Don't send inputs when reset is asserted, because we don't typically care
+  // about the behavior of the block when inputs are sent during reset.
+  if (reset.has_value()) {
+    if (inputs.contains(reset.value().name())) {
+      Value value_when_reset_asserted =
+          Value(UBits(reset.value().active_low() ? 0 : 1, 1));
+      if (inputs.at(reset.value().name()) == value_when_reset_asserted) {
+        is_in_reset = true;
+      }
+    }
+  }
+
+  Value data;
+  Value valid;
+  XLS_RETURN_IF_ERROR(
+      DriveDataAndValid(is_in_reset, random_engine, data, valid));
+  inputs[data_name_] = std::move(data);
+  inputs[valid_name_] = std::move(valid);
 
   return absl::OkStatus();
 }
 
+absl::Status ChannelSource::SetBlockInputs(
+    int64_t this_cycle, absl::Span<Value> inputs,
+    std::minstd_rand& random_engine, std::optional<verilog::ResetProto> reset) {
+  if (!data_index_.has_value() || !valid_index_.has_value()) {
+    return absl::InternalError(absl::StrFormat(
+        "Block %s has no input ports %s and %s for channel", block_->name(),
+        data_name_, valid_name_));
+  }
+
+  bool is_in_reset = false;
+  if (reset.has_value()) {
+    std::optional<int64_t> reset_index =
+        FindPortIndex(block_->GetInputPorts(), reset.value().name());
+    if (reset_index.has_value()) {
+      is_in_reset = inputs[reset_index.value()] ==
+                    Value(UBits(reset.value().active_low() ? 0 : 1, 1));
+    }
+  }
+
+  return DriveDataAndValid(is_in_reset, random_engine,
+                           inputs[data_index_.value()],
+                           inputs[valid_index_.value()]);
+}
+
 absl::Status ChannelSource::GetBlockOutputs(
     int64_t this_cycle,
     const absl::flat_hash_map<std::string, Value>& outputs) {
@@ -397,6 +635,35 @@ absl::Status ChannelSource::GetBlockOutputs(
   return absl::OkStatus();
 }
 
+absl::Status ChannelSource::GetBlockOutputs(int64_t this_cycle,
+                                            absl::Span<const Value> outputs) {
+  if (!ready_index_.has_value()) {
+    return absl::InternalError(absl::StrFormat(
+        "Block %s Channel %s Port %s value not found in interpreter output",
+        block_->name(), data_name_, ready_name_));
+  }
+
+  const bool ready = outputs[ready_index_.value()].bits().IsAllOnes();
+  if (is_valid_ && ready) {
+    is_valid_ = false;
+  }
+
+  return absl::OkStatus();
+}
+
+ChannelSink::ChannelSink(std::string_view data_name,
+                         std::string_view valid_name,
+                         std::string_view ready_name, double lambda,
+                         Block* block)
+    : data_name_(data_name),
+      valid_name_(valid_name),
+      ready_name_(ready_name),
+      lambda_(lambda),
+      block_(block),
+      ready_index_(FindPortIndex(block->GetInputPorts(), ready_name)),
+      data_index_(FindPortIndex(block->GetOutputPorts(), data_name)),
+      valid_index_(FindPortIndex(block->GetOutputPorts(), valid_name)) {}
+
 absl::Status ChannelSink::SetBlockInputs(
     int64_t this_cycle, absl::flat_hash_map<std::string, Value>& inputs,
     std::minstd_rand& random_engine) {
@@ -407,6 +674,22 @@ absl::Status ChannelSink::SetBlockInputs(
   return absl::OkStatus();
 }
 
+absl::Status ChannelSink::SetBlockInputs(int64_t this_cycle,
+                                         absl::Span<Value> inputs,
+                                         std::minstd_rand& random_engine) {
+  if (!ready_index_.has_value()) {
+    return absl::InternalError(
+        absl::StrFormat("Block %s has no input port %s for channel",
+                        block_->name(), ready_name_));
+  }
+
+  // Ready is independently random each cycle
+  is_ready_ = std::bernoulli_distribution(lambda_)(random_engine);
+  inputs[ready_index_.value()] = Value(UBits(is_ready_ ? 1 : 0, 1));
+
+  return absl::OkStatus();
+}
+
 absl::Status ChannelSink::GetBlockOutputs(
     int64_t this_cycle,
     const absl::flat_hash_map<std::string, Value>& outputs) {
@@ -427,6 +710,23 @@ absl::Status ChannelSink::GetBlockOutputs(
   return absl::OkStatus();
 }
 
+absl::Status ChannelSink::GetBlockOutputs(int64_t this_cycle,
+                                          absl::Span<const Value> outputs) {
+  if (!valid_index_.has_value() || !data_index_.has_value()) {
+    return absl::InternalError(absl::StrFormat(
+        "Block %s Channel %s Port %s value not found in interpreter output",
+        block_->name(), data_name_, valid_name_));
+  }
+
+  // If ready and valid, grab data.
+  const bool valid = outputs[valid_index_.value()].bits().IsAllOnes();
+  if (is_ready_ && valid) {
+    data_sequence_.push_back(outputs[data_index_.value()]);
+  }
+
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::vector<uint64_t>> ChannelSink::GetOutputSequenceAsUint64()
     const {
   std::vector<uint64_t> ret;
@@ -15,9 +15,14 @@
 #ifndef XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 #define XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 
+#include <optional>
 #include <random>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -40,6 +45,77 @@ absl::StatusOr<BlockRunResult> BlockRun(
     const absl::flat_hash_map<std::string, Value>& inputs,
     const absl::flat_hash_map<std::string, Value>& reg_state, Block* block);
 
+// Runs a block cycle by cycle with the port and register values held in flat
+// vectors rather than string-keyed maps. Ports and registers are resolved once
+// to integer slots: their index in Block::GetInputPorts, Block::GetOutputPorts,
+// and Block::GetRegisters respectively. The vectors are allocated once and
+// reused across cycles. Input port and register values are initially zero.
+//
+// If `track_activity` is true, the node values of the previous cycle are kept
+// and only nodes with an operand whose value changed since the previous cycle
+// are re-evaluated (side-effecting nodes such as input ports, register reads
+// and register writes are evaluated every cycle). This is much faster for
+// designs in which few signals toggle in each cycle.
+class BlockCycleInterpreter {
+ public:
+  explicit BlockCycleInterpreter(Block* block, bool track_activity = false);
+
+  // Returns the slot of the port or register with the given name.
+  absl::StatusOr<int64_t> GetInputPortIndex(std::string_view name) const;
+  absl::StatusOr<int64_t> GetOutputPortIndex(std::string_view name) const;
+  absl::StatusOr<int64_t> GetRegisterIndex(std::string_view name) const;
+
+  // The values driven on the input ports. Values written here must match the
+  // type of the respective port and persist until overwritten.
+  absl::Span<Value> inputs() { return absl::MakeSpan(inputs_); }
+
+  // The values of the output ports computed in the last call to RunOneCycle.
+  absl::Span<const Value> outputs() const { return outputs_; }
+
+  // The current register values. Values written here must match the type of
+  // the respective register.
+  absl::Span<Value> registers() { return absl::MakeSpan(registers_); }
+
+  // Evaluates the block for one cycle. The output port values are computed
+  // from the current input port and register values after which the registers
+  // are clocked.
+  absl::Status RunOneCycle();
+
+  // Returns the number of nodes evaluated in the last call to RunOneCycle.
+  int64_t evaluated_node_count() const { return evaluated_node_count_; }
+
+  Block* block() const { return block_; }
+
+ private:
+  // Evaluates the nodes of the block affected by changes since the previous
+  // cycle. Used if activity tracking is enabled.
+  absl::Status EvaluateChangedNodes();
+
+  Block* block_;
+  bool track_activity_;
+
+  // Map from input port, register read and register write nodes to their
+  // slot.
+  absl::flat_hash_map<Node*, int64_t> slots_;
+
+  std::vector<Value> inputs_;
+  std::vector<Value> outputs_;
+  std::vector<Value> registers_;
+  std::vector<Value> next_registers_;
+
+  // The slots of the registers which have no register write.
+  std::vector<int64_t> held_registers_;
+
+  int64_t evaluated_node_count_ = 0;
+
+  // State for activity tracking: the nodes of the block in topological order,
+  // the node values of the previous cycle, and the nodes whose values changed
+  // in the current cycle.
+  std::vector<Node*> execution_order_;
+  absl::flat_hash_map<Node*, Value> node_values_;
+  absl::flat_hash_set<Node*> changed_nodes_;
+};
+
 // Runs the interpreter on a combinational block. `inputs` must contain a
 // value for each input port in the block. The returned map contains a value
 // for each output port of the block.
@@ -81,12 +157,7 @@ class ChannelSource {
   // transaction).  Once valid is asserted, it will remain asserted until
   // the transaction completes via ready being asserted.
   ChannelSource(std::string_view data_name, std::string_view valid_name,
-                std::string_view ready_name, double lambda, Block* block)
-      : data_name_(data_name),
-        valid_name_(valid_name),
-        ready_name_(ready_name),
-        lambda_(lambda),
-        block_(block) {}
+                std::string_view ready_name, double lambda, Block* block);
 
   // Sets sequence of data that this source will send to its block.
   absl::Status SetDataSequence(std::vector<Value> data);
@@ -111,6 +182,16 @@ class ChannelSource {
       int64_t this_cycle,
       const absl::flat_hash_map<std::string, Value>& outputs);
 
+  // As above but the port values are held in slots as in
+  // BlockCycleInterpreter: `inputs` is indexed by the position of the port in
+  // Block::GetInputPorts and `outputs` by the position in
+  // Block::GetOutputPorts.
+  absl::Status SetBlockInputs(int64_t this_cycle, absl::Span<Value> inputs,
+                              std::minstd_rand& random_engine,
+                              std::optional<verilog::ResetProto> reset);
+  absl::Status GetBlockOutputs(int64_t this_cycle,
+                               absl::Span<const Value> outputs);
+
   // Source has transferred all data to the block.
   bool AllDataSent() const { return !HasMoreData() && !is_valid_; }
 
@@ -120,6 +201,12 @@ class ChannelSource {
     return current_index_ + 1 < data_sequence_.size();
   }
 
+  // Sets `data` and `valid` to the values to drive on the data and valid
+  // ports this cycle.
+  absl::Status DriveDataAndValid(bool is_in_reset,
+                                 std::minstd_rand& random_engine, Value& data,
+                                 Value& valid);
+
   std::string data_name_;
   std::string valid_name_;
   std::string ready_name_;
@@ -127,6 +214,13 @@ class ChannelSource {
   double lambda_ = 1.0;  // For geometric inter-arrival times.
 
   Block* block_ = nullptr;
+
+  // Slots of the data and valid input ports and of the ready output port.
+  // std::nullopt if the block has no such port.
+  std::optional<int64_t> data_index_;
+  std::optional<int64_t> valid_index_;
+  std::optional<int64_t> ready_index_;
+
   // Data sequence to be sent.
   // Only one of data_sequence_ and data_sequence_as_uint64_ is used,
   // depending on which constructor was called.
@@ -147,12 +241,7 @@ class ChannelSink {
   // lambda is the probability that for a given cycle, the sink will assert
   // ready.
   ChannelSink(std::string_view data_name, std::string_view valid_name,
-              std::string_view ready_name, double lambda, Block* block)
-      : data_name_(data_name),
-        valid_name_(valid_name),
-        ready_name_(ready_name),
-        lambda_(lambda),
-        block_(block) {}
+              std::string_view ready_name, double lambda, Block* block);
 
   // For each cycle, SetBlockInputs() is called to provide the block
   // this channel's inputs for the cycle.
@@ -172,6 +261,13 @@ class ChannelSink {
       int64_t this_cycle,
       const absl::flat_hash_map<std::string, Value>& outputs);
 
+  // As above but the port values are held in slots as in
+  // BlockCycleInterpreter (see ChannelSource).
+  absl::Status SetBlockInputs(int64_t this_cycle, absl::Span<Value> inputs,
+                              std::minstd_rand& random_engine);
+  absl::Status GetBlockOutputs(int64_t this_cycle,
+                               absl::Span<const Value> outputs);
+
   // Returns the sequence of values read from the block.
   absl::StatusOr<std::vector<uint64_t>> GetOutputSequenceAsUint64() const;
   absl::Span<const Value> GetOutputSequence() const { return data_sequence_; }
@@ -184,6 +280,12 @@ class ChannelSink {
   double lambda_ = 1.0;  // Receive with probability lambda.
   Block* block_ = nullptr;
 
+  // Slot of the ready input port and of the data and valid output ports.
+  // std::nullopt if the block has no such port.
+  std::optional<int64_t> ready_index_;
+  std::optional<int64_t> data_index_;
+  std::optional<int64_t> valid_index_;
+
   bool is_ready_ = false;             // Ready is asserted.
   std::vector<Value> data_sequence_;  // Data sequence received.
 };
@@ -14,6 +14,10 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <random>
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
@@ -359,5 +363,170 @@ TEST_F(BlockInterpreterTest, ChannelizedAccumulatorRegister) {
   }
 }
 
+TEST_F(BlockInterpreterTest, CycleInterpreterPipelinedAdder) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  BValue x_d = b.InsertRegister("x_d", x);
+  BValue y_d = b.InsertRegister("y_d", y);
+  BValue x_plus_y_d = b.InsertRegister("x_plus_y_d", b.Add(x_d, y_d));
+  b.OutputPort("out", x_plus_y_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  BlockCycleInterpreter interpreter(block);
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t x_index, interpreter.GetInputPortIndex("x"));
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t y_index, interpreter.GetInputPortIndex("y"));
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t out_index,
+                           interpreter.GetOutputPortIndex("out"));
+  EXPECT_THAT(interpreter.GetInputPortIndex("out"),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("Block has no input port 'out'")));
+
+  std::vector<std::pair<uint64_t, uint64_t>> inputs = {
+      {1, 2}, {42, 100}, {0, 0}, {0, 0}, {0, 0}};
+  std::vector<Value> outputs;
+  for (const auto& [x_value, y_value] : inputs) {
+    interpreter.inputs()[x_index] = Value(UBits(x_value, 32));
+    interpreter.inputs()[y_index] = Value(UBits(y_value, 32));
+    XLS_ASSERT_OK(interpreter.RunOneCycle());
+    outputs.push_back(interpreter.outputs()[out_index]);
+  }
+  EXPECT_EQ(outputs,
+            (std::vector<Value>{Value(UBits(0, 32)), Value(UBits(0, 32)),
+                                Value(UBits(3, 32)), Value(UBits(142, 32)),
+                                Value(UBits(0, 32))}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t reg_index,
+                           interpreter.GetRegisterIndex("x_plus_y_d"));
+  EXPECT_EQ(interpreter.registers()[reg_index], Value(UBits(0, 32)));
+}
+
+TEST_F(BlockInterpreterTest, CycleInterpreterRegisterWithResetAndLoadEnable) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue rst_n = b.InputPort("rst_n", package->GetBitsType(1));
+  BValue le = b.InputPort("le", package->GetBitsType(1));
+  BValue x_d =
+      b.InsertRegister("x_d", x, rst_n,
+                       Reset{Value(UBits(42, 32)), /*asynchronous=*/false,
+                             /*active_low=*/true},
+                       le);
+  b.OutputPort("out", x_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  // Input ports are in order x, rst_n, le.
+  BlockCycleInterpreter interpreter(block);
+  std::vector<std::vector<uint64_t>> inputs = {
+      {1, 1, 0}, {2, 0, 0}, {3, 0, 1}, {4, 1, 1}, {5, 1, 0}};
+  std::vector<uint64_t> outputs;
+  for (const std::vector<uint64_t>& input : inputs) {
+    interpreter.inputs()[0] = Value(UBits(input[0], 32));
+    interpreter.inputs()[1] = Value(UBits(input[1], 1));
+    interpreter.inputs()[2] = Value(UBits(input[2], 1));
+    XLS_ASSERT_OK(interpreter.RunOneCycle());
+    XLS_ASSERT_OK_AND_ASSIGN(uint64_t out,
+                             interpreter.outputs()[0].bits().ToUint64());
+    outputs.push_back(out);
+  }
+  EXPECT_EQ(outputs, (std::vector<uint64_t>{0, 0, 42, 42, 4}));
+}
+
+TEST_F(BlockInterpreterTest, CycleInterpreterChannelizedAccumulator) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue x_vld = b.InputPort("x_vld", package->GetBitsType(1));
+  BValue out_rdy = b.InputPort("out_rdy", package->GetBitsType(1));
+  BValue accum = b.RegisterRead(reg);
+  BValue next_accum =
+      b.Select(b.And(x_vld, out_rdy), {accum, b.Add(x, accum)});
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("x_rdy", out_rdy);
+  b.OutputPort("out", next_accum);
+  b.OutputPort("out_vld", x_vld);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  ChannelSource source("x", "x_vld", "x_rdy", 0.5, block);
+  XLS_ASSERT_OK(source.SetDataSequence(std::vector<uint64_t>{1, 2, 3, 4, 5}));
+  ChannelSink sink("out", "out_vld", "out_rdy", 0.1, block);
+
+  BlockCycleInterpreter interpreter(block);
+  std::minstd_rand random_engine;
+  for (int64_t cycle = 0; cycle < 100; ++cycle) {
+    XLS_ASSERT_OK(source.SetBlockInputs(cycle, interpreter.inputs(),
+                                        random_engine,
+                                        /*reset=*/std::nullopt));
+    XLS_ASSERT_OK(sink.SetBlockInputs(cycle, interpreter.inputs(),
+                                      random_engine));
+    XLS_ASSERT_OK(interpreter.RunOneCycle());
+    XLS_ASSERT_OK(source.GetBlockOutputs(cycle, interpreter.outputs()));
+    XLS_ASSERT_OK(sink.GetBlockOutputs(cycle, interpreter.outputs()));
+  }
+  EXPECT_TRUE(source.AllDataSent());
+  EXPECT_THAT(sink.GetOutputSequenceAsUint64(),
+              IsOkAndHolds(std::vector<uint64_t>{1, 3, 6, 10, 15}));
+}
+
+TEST_F(BlockInterpreterTest, CycleInterpreterActivityTracking) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+
+  // A cone of logic depending only on `config` and an accumulator which is
+  // updated when `en` is asserted.
+  BValue config = b.InputPort("config", package->GetBitsType(32));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue en = b.InputPort("en", package->GetBitsType(1));
+  BValue cone = config;
+  for (int64_t i = 0; i < 10; ++i) {
+    cone = b.Add(b.Shrl(cone, b.Literal(UBits(1, 32))), config);
+  }
+  BValue accum = b.RegisterRead(reg);
+  b.RegisterWrite(reg, b.Add(accum, x), /*load_enable=*/en);
+  b.OutputPort("cone", cone);
+  b.OutputPort("accum", accum);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  BlockCycleInterpreter reference(block);
+  BlockCycleInterpreter tracking(block, /*track_activity=*/true);
+  std::vector<std::vector<uint64_t>> inputs = {
+      {7, 1, 1}, {7, 1, 1}, {7, 1, 0}, {7, 2, 0}, {9, 2, 0}, {9, 2, 1}};
+  for (int64_t cycle = 0; cycle < inputs.size(); ++cycle) {
+    for (BlockCycleInterpreter* interpreter : {&reference, &tracking}) {
+      interpreter->inputs()[0] = Value(UBits(inputs[cycle][0], 32));
+      interpreter->inputs()[1] = Value(UBits(inputs[cycle][1], 32));
+      interpreter->inputs()[2] = Value(UBits(inputs[cycle][2], 1));
+      XLS_ASSERT_OK(interpreter->RunOneCycle());
+    }
+    EXPECT_EQ(tracking.outputs(), reference.outputs()) << "cycle " << cycle;
+    EXPECT_EQ(tracking.registers(), reference.registers()) << "cycle " << cycle;
+    EXPECT_EQ(reference.evaluated_node_count(), block->node_count());
+    if (cycle == 0) {
+      EXPECT_EQ(tracking.evaluated_node_count(), block->node_count());
+    }
+  }
+
+  // Once the config input is stable its cone is no longer evaluated.
+  for (BlockCycleInterpreter* interpreter : {&reference, &tracking}) {
+    XLS_ASSERT_OK(interpreter->RunOneCycle());
+  }
+  EXPECT_EQ(tracking.outputs(), reference.outputs());
+  EXPECT_LT(tracking.evaluated_node_count(), block->node_count() / 2);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,119 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/byte_queue.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "xls/common/math_util.h"
+
+namespace xls {
+
+ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
+    : channel_element_size_(channel_element_size),
+      allocated_element_size_(std::max(channel_element_size, int64_t{1})),
+      is_single_value_(is_single_value) {
+  // Align the vector allocation to a power of 2 for efficient utilization
+  // of the memory.
+  int64_t element_size_2 = 1 << CeilOfLog2(allocated_element_size_);
+  if (element_size_2 > kInitBufferSize) {
+    circular_buffer_.resize(element_size_2);
+  } else {
+    circular_buffer_.resize(kInitBufferSize);
+  }
+  max_byte_count_ = FloorOfRatio(static_cast<int64_t>(circular_buffer_.size()),
+                                 allocated_element_size_) *
+                    allocated_element_size_;
+}
+
+void ByteQueue::Resize() {
+  circular_buffer_.resize(circular_buffer_.size() * 2);
+  max_byte_count_ = FloorOfRatio(static_cast<int64_t>(circular_buffer_.size()),
+                                 allocated_element_size_) *
+                    allocated_element_size_;
+  // The content of the circular buffer must be rearranged when the read
+  // index is not at the beginning of the circular buffer to ensure correct
+  // ordering.
+  if (read_index_ != 0) {
+    std::move(circular_buffer_.begin(), circular_buffer_.begin() + read_index_,
+              circular_buffer_.begin() + bytes_used_);
+  }
+  // Realign the write index to the next available slot.
+  write_index_ = bytes_used_ + read_index_;
+  if (write_index_ == max_byte_count_) {
+    write_index_ = 0;
+  }
+}
+
+void ByteQueue::WriteBatch(const uint8_t* data, int64_t count) {
+  if (count <= 0) {
+    return;
+  }
+  if (is_single_value_) {
+    Write(data + (count - 1) * channel_element_size_);
+    return;
+  }
+  if (channel_element_size_ == 0) {
+    for (int64_t i = 0; i < count; ++i) {
+      Write(data);
+    }
+    return;
+  }
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+  __msan_unpoison(data, count * channel_element_size_);
+#endif
+  int64_t bytes_remaining = count * allocated_element_size_;
+  while (bytes_remaining > 0) {
+    if (bytes_used_ == max_byte_count_) {
+      Resize();
+    }
+    // Copy as much as fits in the free space, splitting the copy in two where
+    // the free space wraps around the end of the circular buffer.
+    int64_t chunk = std::min(bytes_remaining, max_byte_count_ - bytes_used_);
+    int64_t first = std::min(chunk, max_byte_count_ - write_index_);
+    memcpy(circular_buffer_.data() + write_index_, data, first);
+    memcpy(circular_buffer_.data(), data + first, chunk - first);
+    write_index_ = (write_index_ + chunk) % max_byte_count_;
+    bytes_used_ += chunk;
+    data += chunk;
+    bytes_remaining -= chunk;
+  }
+}
+
+int64_t ByteQueue::ReadBatch(uint8_t* buffer, int64_t max_count) {
+  if (max_count <= 0) {
+    return 0;
+  }
+  if (is_single_value_) {
+    return Read(buffer) ? 1 : 0;
+  }
+  if (channel_element_size_ == 0) {
+    int64_t read_count = 0;
+    while (read_count < max_count && Read(buffer)) {
+      ++read_count;
+    }
+    return read_count;
+  }
+  int64_t chunk = std::min(max_count * allocated_element_size_, bytes_used_);
+  int64_t first = std::min(chunk, max_byte_count_ - read_index_);
+  memcpy(buffer, circular_buffer_.data() + read_index_, first);
+  memcpy(buffer + first, circular_buffer_.data(), chunk - first);
+  read_index_ = (read_index_ + chunk) % max_byte_count_;
+  bytes_used_ -= chunk;
+  return chunk / allocated_element_size_;
+}
+
+}  // namespace xls
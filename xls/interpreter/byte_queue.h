@@ -0,0 +1,123 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_BYTE_QUEUE_H_
+#define XLS_INTERPRETER_BYTE_QUEUE_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include "absl/base/config.h"
+#include "absl/container/inlined_vector.h"
+
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+#include <sanitizer/msan_interface.h>
+#endif  // ABSL_HAVE_MEMORY_SANITIZER
+
+namespace xls {
+
+// A queue from which raw bytes may be written or read.
+class ByteQueue {
+ public:
+  // `channel_element_size` is the granuality of the queue access. Each read or
+  // write to the queue handles this many bytes at a time. `is_single_value`
+  // indicates whether this queue follows single-value channel semantics where
+  // the queue only holds a single value; writes overwrite the value in the
+  // queue and reads are non-destructive. If `is_single_value` is false then the
+  // queue has FIFO semantics.
+  ByteQueue(int64_t channel_element_size, bool is_single_value);
+
+  int64_t element_size() const { return channel_element_size_; }
+
+  // Doubles the size of the queue.
+  void Resize();
+
+  void Write(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(data, channel_element_size_);
+#endif
+    if (bytes_used_ == max_byte_count_ && !is_single_value_) {
+      Resize();
+    }
+    memcpy(circular_buffer_.data() + write_index_, data, channel_element_size_);
+    if (is_single_value_) {
+      bytes_used_ = allocated_element_size_;
+    } else {
+      bytes_used_ += allocated_element_size_;
+      write_index_ = write_index_ + allocated_element_size_;
+      if (write_index_ == max_byte_count_) {
+        write_index_ = 0;
+      }
+    }
+  }
+
+  bool Read(uint8_t* buffer) {
+    if (bytes_used_ == 0) {
+      return false;
+    }
+    memcpy(buffer, circular_buffer_.data() + read_index_,
+           channel_element_size_);
+    if (!is_single_value_) {
+      // Reads are destructive for non single-value channels.
+      bytes_used_ -= allocated_element_size_;
+      read_index_ = read_index_ + allocated_element_size_;
+      if (read_index_ == max_byte_count_) {
+        read_index_ = 0;
+      }
+    }
+    return true;
+  }
+
+  // Writes `count` elements stored contiguously in `data` with a stride of
+  // `element_size()` bytes. For single-value queues only the last element is
+  // retained.
+  void WriteBatch(const uint8_t* data, int64_t count);
+
+  // Reads up to `max_count` elements into `buffer` with a stride of
+  // `element_size()` bytes. Returns the number of elements read. For
+  // single-value queues at most one element is read.
+  int64_t ReadBatch(uint8_t* buffer, int64_t max_count);
+
+  int64_t size() const { return bytes_used_ / allocated_element_size_; }
+
+  static constexpr int64_t kInitBufferSize = 128;
+
+ private:
+  // Size of an element in the channel in units of bytes.
+  int64_t channel_element_size_ = 0;
+  // Allocated size of an element in the circular buffer in units of bytes. The
+  // byte size of a JIT type is a multiple of its alignment so elements are
+  // packed contiguously and remain naturally aligned. This enables batched
+  // accesses to move many elements with a single copy. Zero-sized elements
+  // occupy a single byte.
+  int64_t allocated_element_size_ = 0;
+  // TODO(vmirian): 8-09-2022 Place the following guarded members on a single
+  // cache line for optimal performance.
+  // The maximum number of bytes that can hold elements in the circular buffer.
+  int64_t max_byte_count_ = 0;
+  // The number of bytes used in the circular buffer.
+  int64_t bytes_used_ = 0;
+  // Index in the circular buffer to write values to.
+  int64_t read_index_ = 0;
+  // Index in the circular buffer to read values from.
+  int64_t write_index_ = 0;
+  // A circular buffer to store the elements. It is preallocated with storage.
+  absl::InlinedVector<uint8_t, kInitBufferSize> circular_buffer_;
+  // Whether this queue follows single-value channel semantics.
+  bool is_single_value_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_BYTE_QUEUE_H_
@@ -16,11 +16,89 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value_helpers.h"
 
 namespace xls {
+namespace {
+
+// Returns the number of bytes in the flat encoding used by ByteChannelQueue of
+// values of the given type.
+int64_t GetFlatByteSize(Type* type) {
+  switch (type->kind()) {
+    case TypeKind::kBits:
+      return CeilOfRatio(type->AsBitsOrDie()->bit_count(), int64_t{8});
+    case TypeKind::kArray:
+      return type->AsArrayOrDie()->size() *
+             GetFlatByteSize(type->AsArrayOrDie()->element_type());
+    case TypeKind::kTuple: {
+      int64_t size = 0;
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        size += GetFlatByteSize(element_type);
+      }
+      return size;
+    }
+    case TypeKind::kToken:
+      return 0;
+  }
+  XLS_LOG(FATAL) << "Invalid type kind: " << type->kind();
+}
+
+// Writes the flat encoding of `value` to `buffer`. Returns the number of bytes
+// written.
+int64_t EncodeValue(const Value& value, uint8_t* buffer) {
+  if (value.IsBits()) {
+    int64_t byte_count = CeilOfRatio(value.bits().bit_count(), int64_t{8});
+    value.bits().ToBytes(absl::MakeSpan(buffer, byte_count));
+    return byte_count;
+  }
+  if (value.IsToken()) {
+    return 0;
+  }
+  int64_t byte_count = 0;
+  for (const Value& element : value.elements()) {
+    byte_count += EncodeValue(element, buffer + byte_count);
+  }
+  return byte_count;
+}
+
+// Returns the value of type `type` whose flat encoding begins at `*buffer`.
+// Advances `*buffer` past the encoding.
+Value DecodeValue(Type* type, const uint8_t** buffer) {
+  switch (type->kind()) {
+    case TypeKind::kBits: {
+      int64_t bit_count = type->AsBitsOrDie()->bit_count();
+      int64_t byte_count = CeilOfRatio(bit_count, int64_t{8});
+      Bits bits = Bits::FromBytes(absl::MakeConstSpan(*buffer, byte_count),
+                                  bit_count);
+      *buffer += byte_count;
+      return Value(std::move(bits));
+    }
+    case TypeKind::kArray: {
+      ArrayType* array_type = type->AsArrayOrDie();
+      std::vector<Value> elements;
+      elements.reserve(array_type->size());
+      for (int64_t i = 0; i < array_type->size(); ++i) {
+        elements.push_back(DecodeValue(array_type->element_type(), buffer));
+      }
+      return Value::ArrayOwned(std::move(elements)).value();
+    }
+    case TypeKind::kTuple: {
+      std::vector<Value> elements;
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        elements.push_back(DecodeValue(element_type, buffer));
+      }
+      return Value::TupleOwned(std::move(elements));
+    }
+    case TypeKind::kToken:
+      return Value::Token();
+  }
+  XLS_LOG(FATAL) << "Invalid type kind: " << type->kind();
+}
+
+}  // namespace
 
 absl::Status ChannelQueue::AttachGenerator(GeneratorFn generator) {
   absl::MutexLock lock(&mutex_);
@@ -53,7 +131,7 @@ absl::Status ChannelQueue::Write(const Value& value) {
 
   WriteInternal(value);
   XLS_VLOG(4) << absl::StreamFormat("Channel now has %d elements",
-                                    queue_.size());
+                                    GetSizeInternal());
   return absl::OkStatus();
 }
 
@@ -86,7 +164,7 @@ std::optional<Value> ChannelQueue::Read() {
       "Reading data from channel %s: %s", channel_->name(),
       value.has_value() ? value->ToString() : "(none)");
   XLS_VLOG(4) << absl::StreamFormat("Channel now has %d elements",
-                                    queue_.size());
+                                    GetSizeInternal());
   return value;
 }
 
@@ -103,6 +181,27 @@ std::optional<Value> ChannelQueue::ReadInternal() {
   return std::move(value);
 }
 
+ByteChannelQueue::ByteChannelQueue(Channel* channel)
+    : ChannelQueue(channel),
+      byte_queue_(GetFlatByteSize(channel->type()),
+                  channel->kind() == ChannelKind::kSingleValue),
+      buffer_(GetFlatByteSize(channel->type())) {}
+
+int64_t ByteChannelQueue::GetSizeInternal() const { return byte_queue_.size(); }
+
+void ByteChannelQueue::WriteInternal(const Value& value) {
+  EncodeValue(value, buffer_.data());
+  byte_queue_.Write(buffer_.data());
+}
+
+std::optional<Value> ByteChannelQueue::ReadInternal() {
+  if (!byte_queue_.Read(buffer_.data())) {
+    return std::nullopt;
+  }
+  const uint8_t* encoding = buffer_.data();
+  return DecodeValue(channel()->type(), &encoding);
+}
+
 /* static */
 absl::StatusOr<std::unique_ptr<ChannelQueueManager>>
 ChannelQueueManager::Create(std::vector<std::unique_ptr<ChannelQueue>>&& queues,
@@ -146,7 +245,7 @@ ChannelQueueManager::Create(Package* package) {
       return absl::UnimplementedError(
           "Only streaming and single-value channels are supported.");
     }
-    queues.push_back(std::make_unique<ChannelQueue>(channel));
+    queues.push_back(std::make_unique<ByteChannelQueue>(channel));
   }
 
   return absl::WrapUnique(new ChannelQueueManager(package, std::move(queues)));
@@ -21,6 +21,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/interpreter/byte_queue.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
@@ -85,6 +86,28 @@ class ChannelQueue {
   std::optional<GeneratorFn> generator_ ABSL_GUARDED_BY_FIXME(mutex_);
 };
 
+// A channel queue which stores values in a ByteQueue using a flat byte
+// encoding rather than as xls::Values, so writing a value does not allocate
+// (aside from occasionally growing the queue). Each leaf Bits value of the
+// channel type is stored as ceil(bit_count / 8) big-endian bytes in the order
+// the leaves appear in the type.
+class ByteChannelQueue : public ChannelQueue {
+ public:
+  explicit ByteChannelQueue(Channel* channel);
+  virtual ~ByteChannelQueue() = default;
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value)
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  std::optional<Value> ReadInternal()
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+
+  ByteQueue byte_queue_ ABSL_GUARDED_BY(mutex_);
+  // Scratch space holding the encoding of a single value.
+  std::vector<uint8_t> buffer_ ABSL_GUARDED_BY(mutex_);
+};
+
 // A functor which returns a sequence of Values when called. Maybe be attached
 // to a ChannelQueue as a generator.
 class FixedValueGenerator {
@@ -110,7 +133,8 @@ class FixedValueGenerator {
 // convenience methods.
 class ChannelQueueManager {
  public:
-  // Creates and returns a queue manager for the given package.
+  // Creates and returns a queue manager for the given package. The queues are
+  // ByteChannelQueues.
   static absl::StatusOr<std::unique_ptr<ChannelQueueManager>> Create(
       Package* package);
 
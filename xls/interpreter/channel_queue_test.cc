@@ -18,6 +18,7 @@
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
 #include "xls/interpreter/channel_queue_test_base.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
 
@@ -26,6 +27,7 @@ namespace {
 
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Optional;
 
 // Instantiate and run all the tests in channel_queue_test_base.cc.
 INSTANTIATE_TEST_SUITE_P(
@@ -34,6 +36,42 @@ INSTANTIATE_TEST_SUITE_P(
       return std::make_unique<ChannelQueue>(channel);
     })));
 
+INSTANTIATE_TEST_SUITE_P(
+    ByteChannelQueueTest, ChannelQueueTestBase,
+    testing::Values(ChannelQueueTestParam([](Channel* channel) {
+      return std::make_unique<ByteChannelQueue>(channel);
+    })));
+
+class ByteChannelQueueTest : public IrTestBase {};
+
+TEST_F(ByteChannelQueueTest, AggregateValues) {
+  Package package(TestName());
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(3), package.GetArrayType(2, package.GetBitsType(65)),
+       package.GetTokenType(), package.GetTupleType({})});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("c", ChannelOps::kSendReceive, type));
+  ByteChannelQueue queue(channel);
+
+  std::vector<Value> values;
+  for (int64_t i = 0; i < 100; ++i) {
+    Bits wide = bits_ops::Concat({UBits(i % 2, 1), UBits(i * 12345, 64)});
+    values.push_back(Value::Tuple(
+        {Value(UBits(i % 8, 3)),
+         Value::ArrayOrDie({Value(wide), Value(bits_ops::Not(wide))}),
+         Value::Token(), Value::Tuple({})}));
+  }
+  for (const Value& value : values) {
+    XLS_ASSERT_OK(queue.Write(value));
+  }
+  EXPECT_EQ(queue.GetSize(), values.size());
+  for (const Value& value : values) {
+    EXPECT_THAT(queue.Read(), Optional(value));
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
 // Separate tests for queue managers.
 class ChannelQueueManagerTest : public IrTestBase {};
 
@@ -55,6 +93,8 @@ TEST_F(ChannelQueueManagerTest, SimpleChannelQueueManager) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelQueueManager> manager,
                            ChannelQueueManager::Create(&package));
   EXPECT_EQ(manager->queues().size(), 3);
+  EXPECT_NE(dynamic_cast<ByteChannelQueue*>(&manager->GetQueue(channel_a)),
+            nullptr);
   EXPECT_EQ(manager->GetQueue(channel_a).channel(), channel_a);
   EXPECT_EQ(manager->GetQueue(channel_b).channel(), channel_b);
   EXPECT_EQ(manager->GetQueue(channel_c).channel(), channel_c);
@@ -0,0 +1,370 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/keyword_args.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+namespace {
+
+using Instruction = CompiledFunctionInterpreter::Instruction;
+using Handler = CompiledFunctionInterpreter::Handler;
+
+const Bits& OperandBits(const Instruction& instruction,
+                        absl::Span<const Value> slots, int64_t operand_no) {
+  return slots[instruction.operands[operand_no]].bits();
+}
+
+// Returns the given bits value as a uint64_t value. If the value exceeds
+// upper_limit, then upper_limit is returned.
+uint64_t BitsToBoundedUint64(const Bits& bits, uint64_t upper_limit) {
+  if (Bits::MinBitCountUnsigned(upper_limit) <= bits.bit_count() &&
+      bits_ops::UGreaterThan(bits, UBits(upper_limit, bits.bit_count()))) {
+    return upper_limit;
+  }
+  return bits.ToUint64().value();
+}
+
+// Evaluates the node with a single-node IrInterpreter. Used for all ops
+// without a dedicated handler.
+absl::Status EvaluateWithIrInterpreter(const Instruction& instruction,
+                                       absl::Span<Value> slots,
+                                       InterpreterEvents* events) {
+  Node* node = instruction.node;
+  absl::flat_hash_map<Node*, Value> node_values;
+  for (int64_t i = 0; i < instruction.operands.size(); ++i) {
+    // Operands may be duplicated in which case the value is already present.
+    node_values.emplace(node->operand(i), slots[instruction.operands[i]]);
+  }
+  IrInterpreter visitor(&node_values, events);
+  XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
+  slots[instruction.result] = visitor.ResolveAsValue(node);
+  return absl::OkStatus();
+}
+
+template <Bits (*kOp)(const Bits&, const Bits&)>
+absl::Status EvaluateBinaryBitsOp(const Instruction& instruction,
+                                  absl::Span<Value> slots,
+                                  InterpreterEvents* events) {
+  slots[instruction.result] = Value(kOp(OperandBits(instruction, slots, 0),
+                                        OperandBits(instruction, slots, 1)));
+  return absl::OkStatus();
+}
+
+template <Bits (*kOp)(const Bits&, const Bits&)>
+absl::Status EvaluateNaryBitsOp(const Instruction& instruction,
+                                absl::Span<Value> slots,
+                                InterpreterEvents* events) {
+  Bits accum = OperandBits(instruction, slots, 0);
+  for (int64_t i = 1; i < instruction.operands.size(); ++i) {
+    accum = kOp(accum, OperandBits(instruction, slots, i));
+  }
+  slots[instruction.result] = Value(std::move(accum));
+  return absl::OkStatus();
+}
+
+template <Bits (*kOp)(const Bits&)>
+absl::Status EvaluateUnaryBitsOp(const Instruction& instruction,
+                                 absl::Span<Value> slots,
+                                 InterpreterEvents* events) {
+  slots[instruction.result] = Value(kOp(OperandBits(instruction, slots, 0)));
+  return absl::OkStatus();
+}
+
+template <bool (*kOp)(const Bits&, const Bits&)>
+absl::Status EvaluateCompareOp(const Instruction& instruction,
+                               absl::Span<Value> slots,
+                               InterpreterEvents* events) {
+  slots[instruction.result] = Value::Bool(kOp(
+      OperandBits(instruction, slots, 0), OperandBits(instruction, slots, 1)));
+  return absl::OkStatus();
+}
+
+template <Bits (*kOp)(const Bits&, int64_t)>
+absl::Status EvaluateShiftOp(const Instruction& instruction,
+                             absl::Span<Value> slots,
+                             InterpreterEvents* events) {
+  const Bits& input = OperandBits(instruction, slots, 0);
+  int64_t amount =
+      BitsToBoundedUint64(OperandBits(instruction, slots, 1), input.bit_count());
+  slots[instruction.result] = Value(kOp(input, amount));
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateEq(const Instruction& instruction, absl::Span<Value> slots,
+                        InterpreterEvents* events) {
+  slots[instruction.result] = Value::Bool(slots[instruction.operands[0]] ==
+                                          slots[instruction.operands[1]]);
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateNe(const Instruction& instruction, absl::Span<Value> slots,
+                        InterpreterEvents* events) {
+  slots[instruction.result] = Value::Bool(slots[instruction.operands[0]] !=
+                                          slots[instruction.operands[1]]);
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateIdentity(const Instruction& instruction,
+                              absl::Span<Value> slots,
+                              InterpreterEvents* events) {
+  slots[instruction.result] = slots[instruction.operands[0]];
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateBitSlice(const Instruction& instruction,
+                              absl::Span<Value> slots,
+                              InterpreterEvents* events) {
+  BitSlice* bit_slice = instruction.node->As<BitSlice>();
+  slots[instruction.result] = Value(OperandBits(instruction, slots, 0)
+                                        .Slice(bit_slice->start(),
+                                               bit_slice->width()));
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateZeroExtend(const Instruction& instruction,
+                                absl::Span<Value> slots,
+                                InterpreterEvents* events) {
+  slots[instruction.result] = Value(
+      bits_ops::ZeroExtend(OperandBits(instruction, slots, 0),
+                           instruction.node->As<ExtendOp>()->new_bit_count()));
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateSignExtend(const Instruction& instruction,
+                                absl::Span<Value> slots,
+                                InterpreterEvents* events) {
+  slots[instruction.result] = Value(
+      bits_ops::SignExtend(OperandBits(instruction, slots, 0),
+                           instruction.node->As<ExtendOp>()->new_bit_count()));
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateConcat(const Instruction& instruction,
+                            absl::Span<Value> slots,
+                            InterpreterEvents* events) {
+  std::vector<Bits> operands;
+  operands.reserve(instruction.operands.size());
+  for (int64_t slot : instruction.operands) {
+    operands.push_back(slots[slot].bits());
+  }
+  slots[instruction.result] = Value(bits_ops::Concat(operands));
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateSelect(const Instruction& instruction,
+                            absl::Span<Value> slots,
+                            InterpreterEvents* events) {
+  // Operand 0 is the selector, followed by the cases and the optional default
+  // value.
+  Select* select = instruction.node->As<Select>();
+  int64_t case_count = select->cases().size();
+  int64_t index = BitsToBoundedUint64(OperandBits(instruction, slots, 0),
+                                      /*upper_limit=*/case_count);
+  // An out-of-range selector yields the default value which immediately
+  // follows the cases.
+  slots[instruction.result] = slots[instruction.operands[1 + index]];
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateTuple(const Instruction& instruction,
+                           absl::Span<Value> slots,
+                           InterpreterEvents* events) {
+  std::vector<Value> elements;
+  elements.reserve(instruction.operands.size());
+  for (int64_t slot : instruction.operands) {
+    elements.push_back(slots[slot]);
+  }
+  slots[instruction.result] = Value::TupleOwned(std::move(elements));
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateTupleIndex(const Instruction& instruction,
+                                absl::Span<Value> slots,
+                                InterpreterEvents* events) {
+  slots[instruction.result] =
+      slots[instruction.operands[0]].element(
+          instruction.node->As<TupleIndex>()->index());
+  return absl::OkStatus();
+}
+
+// Returns the handler which evaluates the given node.
+Handler GetHandler(Node* node) {
+  switch (node->op()) {
+    case Op::kAdd:
+      return EvaluateBinaryBitsOp<bits_ops::Add>;
+    case Op::kSub:
+      return EvaluateBinaryBitsOp<bits_ops::Sub>;
+    case Op::kAnd:
+      return EvaluateNaryBitsOp<bits_ops::And>;
+    case Op::kOr:
+      return EvaluateNaryBitsOp<bits_ops::Or>;
+    case Op::kXor:
+      return EvaluateNaryBitsOp<bits_ops::Xor>;
+    case Op::kNot:
+      return EvaluateUnaryBitsOp<bits_ops::Not>;
+    case Op::kNeg:
+      return EvaluateUnaryBitsOp<bits_ops::Negate>;
+    case Op::kEq:
+      return EvaluateEq;
+    case Op::kNe:
+      return EvaluateNe;
+    case Op::kUGe:
+      return EvaluateCompareOp<bits_ops::UGreaterThanOrEqual>;
+    case Op::kUGt:
+      return EvaluateCompareOp<bits_ops::UGreaterThan>;
+    case Op::kULe:
+      return EvaluateCompareOp<bits_ops::ULessThanOrEqual>;
+    case Op::kULt:
+      return EvaluateCompareOp<bits_ops::ULessThan>;
+    case Op::kSGe:
+      return EvaluateCompareOp<bits_ops::SGreaterThanOrEqual>;
+    case Op::kSGt:
+      return EvaluateCompareOp<bits_ops::SGreaterThan>;
+    case Op::kSLe:
+      return EvaluateCompareOp<bits_ops::SLessThanOrEqual>;
+    case Op::kSLt:
+      return EvaluateCompareOp<bits_ops::SLessThan>;
+    case Op::kShll:
+      return EvaluateShiftOp<bits_ops::ShiftLeftLogical>;
+    case Op::kShrl:
+      return EvaluateShiftOp<bits_ops::ShiftRightLogical>;
+    case Op::kShra:
+      return EvaluateShiftOp<bits_ops::ShiftRightArith>;
+    case Op::kIdentity:
+      return EvaluateIdentity;
+    case Op::kBitSlice:
+      return EvaluateBitSlice;
+    case Op::kZeroExt:
+      return EvaluateZeroExtend;
+    case Op::kSignExt:
+      return EvaluateSignExtend;
+    case Op::kConcat:
+      return EvaluateConcat;
+    case Op::kSel:
+      return EvaluateSelect;
+    case Op::kTuple:
+      return EvaluateTuple;
+    case Op::kTupleIndex:
+      return EvaluateTupleIndex;
+    default:
+      return EvaluateWithIrInterpreter;
+  }
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>>
+CompiledFunctionInterpreter::Create(Function* function) {
+  auto interpreter = absl::WrapUnique(new CompiledFunctionInterpreter(function));
+
+  // Parameters occupy the first slots in parameter order. The remaining nodes
+  // are assigned slots in topological order.
+  absl::flat_hash_map<Node*, int64_t> slot_map;
+  for (Param* param : function->params()) {
+    slot_map[param] = slot_map.size();
+  }
+  std::vector<Node*> nodes = TopoSort(function).AsVector();
+  for (Node* node : nodes) {
+    if (!node->Is<Param>()) {
+      slot_map[node] = slot_map.size();
+    }
+  }
+  interpreter->slots_.resize(slot_map.size());
+
+  // Operand slot indices are gathered first so the spans referring to them
+  // remain valid.
+  std::vector<Node*> instruction_nodes;
+  std::vector<int64_t> operand_offsets;
+  for (Node* node : nodes) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    if (node->Is<Literal>()) {
+      interpreter->slots_[slot_map.at(node)] = node->As<Literal>()->value();
+      continue;
+    }
+    instruction_nodes.push_back(node);
+    operand_offsets.push_back(interpreter->operand_slots_.size());
+    for (Node* operand : node->operands()) {
+      interpreter->operand_slots_.push_back(slot_map.at(operand));
+    }
+  }
+  interpreter->instructions_.reserve(instruction_nodes.size());
+  absl::Span<const int64_t> operand_slots = interpreter->operand_slots_;
+  for (int64_t i = 0; i < instruction_nodes.size(); ++i) {
+    Node* node = instruction_nodes[i];
+    interpreter->instructions_.push_back(Instruction{
+        .handler = GetHandler(node),
+        .node = node,
+        .operands =
+            operand_slots.subspan(operand_offsets[i], node->operand_count()),
+        .result = slot_map.at(node)});
+  }
+  interpreter->result_slot_ = slot_map.at(function->return_value());
+  XLS_VLOG(3) << absl::StreamFormat(
+      "Compiled function %s into %d instructions and %d slots",
+      function->name(), interpreter->instructions_.size(),
+      interpreter->slots_.size());
+  return interpreter;
+}
+
+absl::StatusOr<InterpreterResult<Value>> CompiledFunctionInterpreter::Run(
+    absl::Span<const Value> args) {
+  if (args.size() != function_->params().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Function %s wants %d arguments, got %d.", function_->name(),
+        function_->params().size(), args.size()));
+  }
+  for (int64_t argno = 0; argno < args.size(); ++argno) {
+    Type* param_type = function_->param(argno)->GetType();
+    if (!ValueConformsToType(args[argno], param_type)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Got argument %s for parameter %d which is not of type %s",
+          args[argno].ToString(), argno, param_type->ToString()));
+    }
+    slots_[argno] = args[argno];
+  }
+  InterpreterEvents events;
+  absl::Span<Value> slots = absl::MakeSpan(slots_);
+  for (const Instruction& instruction : instructions_) {
+    XLS_RETURN_IF_ERROR(instruction.handler(instruction, slots, &events));
+  }
+  return InterpreterResult<Value>{slots_[result_slot_], std::move(events)};
+}
+
+absl::StatusOr<InterpreterResult<Value>>
+CompiledFunctionInterpreter::RunWithKwargs(
+    const absl::flat_hash_map<std::string, Value>& kwargs) {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> positional_args,
+                       KeywordArgsToPositional(*function_, kwargs));
+  return Run(positional_args);
+}
+
+}  // namespace xls
@@ -0,0 +1,102 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+#define XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// An interpreter which translates a function once into a flat array of
+// instructions and then evaluates the array on each call. Each node is assigned
+// an integer slot holding its value, and each instruction holds a pointer to
+// the routine which evaluates its op along with the slot indices of its
+// operands. Evaluation is then a single loop over the instructions without the
+// per-node visitor dispatch and hash map lookups of IrInterpreter, at the cost
+// of a one-time compilation step. This is useful when the same function is
+// interpreted many times (e.g., fuzzing or sampling random inputs) and JIT
+// compilation is unavailable or too expensive.
+//
+// Common bits, tuple and select ops are evaluated directly. All other ops
+// (including side-effecting and invoking ops) are evaluated by IrInterpreter
+// one node at a time, so results and events match InterpretFunction.
+//
+// Run reuses the slot array across calls so an instance must not be run
+// concurrently from multiple threads.
+class CompiledFunctionInterpreter {
+ public:
+  struct Instruction;
+
+  // Evaluates a single instruction, reading operands from and writing the
+  // result to 'slots'.
+  using Handler = absl::Status (*)(const Instruction& instruction,
+                                   absl::Span<Value> slots,
+                                   InterpreterEvents* events);
+
+  // A single step of the compiled function which evaluates 'node'.
+  struct Instruction {
+    Handler handler;
+    Node* node;
+    // Slot indices of the operands of the node, in operand order.
+    absl::Span<const int64_t> operands;
+    int64_t result;
+  };
+
+  static absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>> Create(
+      Function* function);
+
+  // Evaluates the function with the given positional arguments. Returns the
+  // value and any events which happened while running.
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+
+  // Evaluates the function with the arguments given by name.
+  absl::StatusOr<InterpreterResult<Value>> RunWithKwargs(
+      const absl::flat_hash_map<std::string, Value>& kwargs);
+
+  Function* function() const { return function_; }
+
+  // Returns the instructions of the compiled function in evaluation order.
+  // Literals and parameters occupy slots but require no instruction.
+  absl::Span<const Instruction> instructions() const { return instructions_; }
+
+ private:
+  explicit CompiledFunctionInterpreter(Function* function)
+      : function_(function) {}
+
+  Function* function_;
+  std::vector<Instruction> instructions_;
+  // Storage for the operand slot indices of all instructions.
+  std::vector<int64_t> operand_slots_;
+  // Value of each node indexed by slot. Literal slots are populated once at
+  // creation time and parameter slots are populated on each call.
+  std::vector<Value> slots_;
+  int64_t result_slot_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
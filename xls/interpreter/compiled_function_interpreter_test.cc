@@ -0,0 +1,126 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using testing::ElementsAre;
+using testing::HasSubstr;
+
+INSTANTIATE_TEST_SUITE_P(
+    CompiledFunctionInterpreterTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        [](Function* function, absl::Span<const Value> args)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(
+              std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+              CompiledFunctionInterpreter::Create(function));
+          return interpreter->Run(args);
+        },
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(
+              std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+              CompiledFunctionInterpreter::Create(function));
+          return interpreter->RunWithKwargs(kwargs);
+        })));
+
+class CompiledFunctionInterpreterOnlyTest : public IrTestBase {};
+
+TEST_F(CompiledFunctionInterpreterOnlyTest, RunRepeatedly) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8], y: bits[8]) -> (bits[8], bits[1]) {
+  literal.1: bits[8] = literal(value=1)
+  add.2: bits[8] = add(x, literal.1)
+  ult.3: bits[1] = ult(add.2, y)
+  sel.4: bits[8] = sel(ult.3, cases=[x, add.2])
+  ret tuple.5: (bits[8], bits[1]) = tuple(sel.4, ult.3)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunctionInterpreter> interp,
+                           CompiledFunctionInterpreter::Create(f));
+  // Literals and parameters do not require instructions.
+  EXPECT_EQ(interp->instructions().size(), 4);
+
+  for (int64_t x = 0; x < 256; x += 17) {
+    for (int64_t y = 0; y < 256; y += 13) {
+      std::vector<Value> args = {Value(UBits(x, 8)), Value(UBits(y, 8))};
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                               InterpretFunction(f, args));
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                               interp->Run(args));
+      EXPECT_EQ(actual.value, expected.value);
+    }
+  }
+}
+
+TEST_F(CompiledFunctionInterpreterOnlyTest, FallbackOpsRecordEvents) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(tkn: token, x: bits[8]) -> bits[8] {
+  literal.1: bits[1] = literal(value=1)
+  trace.2: token = trace(tkn, literal.1, format="x is {}", data_operands=[x])
+  ret umul.3: bits[8] = umul(x, x)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunctionInterpreter> interp,
+                           CompiledFunctionInterpreter::Create(f));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<Value> result,
+      interp->Run({Value::Token(), Value(UBits(5, 8))}));
+  EXPECT_EQ(result.value, Value(UBits(25, 8)));
+  EXPECT_THAT(result.events.trace_msgs, ElementsAre("x is 5"));
+
+  // Events do not accumulate across runs.
+  XLS_ASSERT_OK_AND_ASSIGN(result,
+                           interp->Run({Value::Token(), Value(UBits(3, 8))}));
+  EXPECT_EQ(result.value, Value(UBits(9, 8)));
+  EXPECT_THAT(result.events.trace_msgs, ElementsAre("x is 3"));
+}
+
+TEST_F(CompiledFunctionInterpreterOnlyTest, WrongArgumentType) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8]) -> bits[8] {
+  ret neg.1: bits[8] = neg(x)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunctionInterpreter> interp,
+                           CompiledFunctionInterpreter::Create(f));
+  EXPECT_THAT(interp->Run({Value(UBits(1, 4))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("which is not of type bits[8]")));
+}
+
+}  // namespace
+}  // namespace xls
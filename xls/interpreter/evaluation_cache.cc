@@ -0,0 +1,63 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/interpreter/evaluation_cache.h"
+
+#include "xls/common/logging/logging.h"
+
+namespace xls {
+
+EvaluationCache::EvaluationCache(int64_t max_entries)
+    : max_entries_(max_entries) {
+  XLS_CHECK_GT(max_entries, 0);
+}
+
+std::optional<InterpreterResult<Value>> EvaluationCache::Lookup(
+    Function* function, absl::Span<const Value> args) {
+  auto it = index_.find(
+      Key(function, std::vector<Value>(args.begin(), args.end())));
+  if (it == index_.end()) {
+    ++misses_;
+    return std::nullopt;
+  }
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->result;
+}
+
+void EvaluationCache::Insert(Function* function, absl::Span<const Value> args,
+                             const InterpreterResult<Value>& result) {
+  Key key(function, std::vector<Value>(args.begin(), args.end()));
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    it->second->result = result;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+  if (entries_.size() >= max_entries_) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+    ++evictions_;
+  }
+  entries_.push_front(Entry{key, result});
+  index_[std::move(key)] = entries_.begin();
+}
+
+void EvaluationCache::Clear() {
+  index_.clear();
+  entries_.clear();
+}
+
+}  // namespace xls
@@ -0,0 +1,91 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_EVALUATION_CACHE_H_
+#define XLS_INTERPRETER_EVALUATION_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// A bounded cache of the results of interpreting functions, keyed on the
+// function and its argument values. XLS functions are pure so the result of
+// interpreting a function (including any trace and assert events) is fully
+// determined by its arguments. The IR interpreter consults the cache when
+// evaluating the callees of invoke and map operations. This avoids
+// re-interpreting a callee when it is repeatedly applied to the same values
+// which is common when evaluating many (random) inputs or when mapping over
+// arrays with repeated elements.
+//
+// When the cache is full the least-recently used entry is evicted. The cache
+// is not thread-safe.
+class EvaluationCache {
+ public:
+  // Creates a cache holding at most `max_entries` results. `max_entries` must
+  // be positive.
+  explicit EvaluationCache(int64_t max_entries);
+
+  // Returns the cached result of interpreting `function` with the given
+  // arguments, or std::nullopt if there is no such result. A successful lookup
+  // marks the entry as most-recently used.
+  std::optional<InterpreterResult<Value>> Lookup(Function* function,
+                                                 absl::Span<const Value> args);
+
+  // Adds the result of interpreting `function` with the given arguments to
+  // the cache, evicting the least-recently used entry if the cache is full.
+  void Insert(Function* function, absl::Span<const Value> args,
+              const InterpreterResult<Value>& result);
+
+  // Removes all entries from the cache. Statistics are not cleared.
+  void Clear();
+
+  int64_t max_entries() const { return max_entries_; }
+  int64_t size() const { return entries_.size(); }
+
+  // Statistics about the use of the cache.
+  int64_t hits() const { return hits_; }
+  int64_t misses() const { return misses_; }
+  int64_t evictions() const { return evictions_; }
+
+ private:
+  using Key = std::pair<Function*, std::vector<Value>>;
+  struct Entry {
+    Key key;
+    InterpreterResult<Value> result;
+  };
+
+  int64_t max_entries_;
+
+  // Entries ordered from most-recently to least-recently used.
+  std::list<Entry> entries_;
+  absl::flat_hash_map<Key, std::list<Entry>::iterator> index_;
+
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+  int64_t evictions_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_EVALUATION_CACHE_H_
@@ -46,7 +46,7 @@ class FunctionInterpreter : public IrInterpreter {
 }  // namespace
 
 absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
-    Function* function, absl::Span<const Value> args) {
+    Function* function, absl::Span<const Value> args, EvaluationCache* cache) {
   XLS_VLOG(3) << "Interpreting function " << function->name();
   if (args.size() != function->params().size()) {
     return absl::InvalidArgumentError(absl::StrFormat(
@@ -65,6 +65,7 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
     }
   }
   FunctionInterpreter visitor(args);
+  visitor.set_evaluation_cache(cache);
   XLS_RETURN_IF_ERROR(function->Accept(&visitor));
   Value result = visitor.ResolveAsValue(function->return_value());
   XLS_VLOG(2) << "Result = " << result;
@@ -19,6 +19,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/interpreter/evaluation_cache.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/function.h"
 #include "xls/ir/value.h"
@@ -27,9 +28,11 @@ namespace xls {
 
 // Runs the interpreter on the given function. 'args' are the argument values
 // indexed by parameter name. Returns both the value and any events that
-// happened while running.
+// happened while running. If `cache` is non-null it is used to memoize the
+// results of functions called via invoke and map operations.
 absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
-    Function* function, absl::Span<const Value> args);
+    Function* function, absl::Span<const Value> args,
+    EvaluationCache* cache = nullptr);
 
 // Runs the interpreter on the function where the arguments are given by name.
 // Returns both the result alue and any events that happened while running.
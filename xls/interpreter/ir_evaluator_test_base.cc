@@ -21,6 +21,7 @@
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/keyword_args.h"
 #include "xls/ir/value_helpers.h"
 
@@ -3550,6 +3551,91 @@ TEST_P(IrEvaluatorTestBase, BitSliceUpdateWideUpdateValue) {
               IsOkAndHolds(0x1234));
 }
 
+// Operations on integers wider than 128 bits which the JIT lowers to
+// word-sliced runtime helpers.
+TEST_P(IrEvaluatorTestBase, WideMultiply) {
+  auto package = CreatePackage();
+  Bits x = bits_ops::Concat({UBits(0x8123456789abcdefULL, 64),
+                             UBits(0xfedcba9876543210ULL, 64),
+                             UBits(0x0f1e2d3c4b5a6978ULL, 64),
+                             UBits(0xdeadbeefcafef00dULL, 64)})
+               .Slice(0, 250);
+  Bits y = bits_ops::Concat({UBits(0xffffffffffffffffULL, 64),
+                             UBits(0x5555666677778888ULL, 64),
+                             UBits(0x9999aaaabbbbccccULL, 64),
+                             UBits(0x1111222233334444ULL, 64)})
+               .Slice(0, 250);
+  for (std::string_view op : {"umul", "smul"}) {
+    for (int64_t result_width : {250, 300}) {
+      std::string input = absl::Substitute(R"(
+  fn main(x: bits[250], y: bits[250]) -> bits[$1] {
+    ret result: bits[$1] = $0(x, y)
+  }
+  )",
+                                           op, result_width);
+      XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                               ParseFunction(input, package.get()));
+      // The full 500-bit product is truncated to the result width.
+      Bits product = op == "umul" ? bits_ops::UMul(x, y) : bits_ops::SMul(x, y);
+      EXPECT_THAT(RunWithBitsNoEvents(function, {x, y}),
+                  IsOkAndHolds(product.Slice(0, result_width)))
+          << op << " " << result_width;
+    }
+  }
+}
+
+TEST_P(IrEvaluatorTestBase, WideShifts) {
+  auto package = CreatePackage();
+  Bits x = bits_ops::Concat({UBits(0x8123456789abcdefULL, 64),
+                             UBits(0xfedcba9876543210ULL, 64),
+                             UBits(0x0f1e2d3c4b5a6978ULL, 64),
+                             UBits(0xdeadbeefcafef00dULL, 64)})
+               .Slice(0, 200);
+  for (std::string_view op : {"shll", "shrl", "shra"}) {
+    std::string input = absl::Substitute(R"(
+  fn main(x: bits[200], amount: bits[16]) -> bits[200] {
+    ret result: bits[200] = $0(x, amount)
+  }
+  )",
+                                         op);
+    XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                             ParseFunction(input, package.get()));
+    for (int64_t amount : {0, 1, 63, 64, 65, 127, 130, 199, 200, 1000}) {
+      Bits expected = op == "shll"   ? bits_ops::ShiftLeftLogical(x, amount)
+                      : op == "shrl" ? bits_ops::ShiftRightLogical(x, amount)
+                                     : bits_ops::ShiftRightArith(x, amount);
+      EXPECT_THAT(RunWithBitsNoEvents(function, {x, UBits(amount, 16)}),
+                  IsOkAndHolds(expected))
+          << op << " " << amount;
+    }
+  }
+}
+
+TEST_P(IrEvaluatorTestBase, WideBitSliceUpdate) {
+  auto package = CreatePackage();
+  std::string input = R"(
+  fn main(a: bits[300], start: bits[32], value: bits[100]) -> bits[300] {
+    ret result: bits[300] = bit_slice_update(a, start, value)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           ParseFunction(input, package.get()));
+  Bits a = bits_ops::Concat({UBits(0x8123456789abcdefULL, 64),
+                             UBits(0xfedcba9876543210ULL, 64),
+                             UBits(0x0f1e2d3c4b5a6978ULL, 64),
+                             UBits(0xdeadbeefcafef00dULL, 64),
+                             UBits(0x0123456789abcdefULL, 64)})
+               .Slice(0, 300);
+  Bits value = bits_ops::Concat({UBits(0x5555666677778888ULL, 64),
+                                 UBits(0x9999aaaabbbbccccULL, 64)})
+                   .Slice(0, 100);
+  for (int64_t start : {0, 1, 63, 64, 100, 250, 299, 300, 5000}) {
+    EXPECT_THAT(RunWithBitsNoEvents(function, {a, UBits(start, 32), value}),
+                IsOkAndHolds(bits_ops::BitSliceUpdate(a, start, value)))
+        << start;
+  }
+}
+
 TEST_P(IrEvaluatorTestBase, NestedEmptyTuple) {
   auto package = CreatePackage();
   std::string input = R"(
@@ -14,6 +14,8 @@
 
 #include "xls/interpreter/ir_interpreter.h"
 
+#include <optional>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -81,6 +83,7 @@ absl::Status IrInterpreter::AddInterpreterEvents(
   for (const std::string& assert_msg : events.assert_msgs) {
     GetInterpreterEvents().assert_msgs.push_back(assert_msg);
   }
+  GetInterpreterEvents().raw_traces.Append(events.raw_traces);
 
   return absl::OkStatus();
 }
@@ -488,7 +491,10 @@ absl::Status IrInterpreter::HandleAssert(Assert* assert_op) {
 }
 
 absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
-  if (ResolveAsBool(trace_op->condition())) {
+  // The interpreter does not record raw traces so TraceCollection::kRaw is
+  // treated as kFormatted.
+  if (GetInterpreterEvents().trace_collection != TraceCollection::kDisabled &&
+      ResolveAsBool(trace_op->condition())) {
     absl::Span<Node* const> arg_nodes = trace_op->args();
     auto arg_node = arg_nodes.begin();
 
@@ -542,7 +548,7 @@ absl::Status IrInterpreter::HandleInvoke(Invoke* invoke) {
     args.push_back(ResolveAsValue(invoke->operand(i)));
   }
   XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
-                       InterpretFunction(to_apply, args));
+                       InterpretCallee(to_apply, args));
   XLS_RETURN_IF_ERROR(AddInterpreterEvents(result.events));
   return SetValueResult(invoke, result.value);
 }
@@ -593,7 +599,7 @@ absl::Status IrInterpreter::HandleMap(Map* map) {
   for (const Value& operand_element :
        ResolveAsValue(map->operand(0)).elements()) {
     XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
-                         InterpretFunction(to_apply, {operand_element}));
+                         InterpretCallee(to_apply, {operand_element}));
     XLS_RETURN_IF_ERROR(AddInterpreterEvents(result.events));
     results.push_back(result.value);
   }
@@ -906,4 +912,20 @@ absl::StatusOr<Value> IrInterpreter::DeepOr(
   return Value::Tuple(elements);
 }
 
+absl::StatusOr<InterpreterResult<Value>> IrInterpreter::InterpretCallee(
+    Function* callee, absl::Span<const Value> args) {
+  if (evaluation_cache_ == nullptr) {
+    return InterpretFunction(callee, args);
+  }
+  std::optional<InterpreterResult<Value>> cached =
+      evaluation_cache_->Lookup(callee, args);
+  if (cached.has_value()) {
+    return std::move(cached.value());
+  }
+  XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
+                       InterpretFunction(callee, args, evaluation_cache_));
+  evaluation_cache_->Insert(callee, args, result);
+  return result;
+}
+
 }  // namespace xls
@@ -18,6 +18,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/interpreter/evaluation_cache.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
@@ -62,6 +63,14 @@ class IrInterpreter : public DfsVisitor {
 
   absl::Status AddInterpreterEvents(const InterpreterEvents& events);
 
+  // Sets the cache used to memoize the results of the functions called by
+  // invoke and map operations. The cache is also used when interpreting the
+  // callees themselves. If null (the default) no caching is performed.
+  void set_evaluation_cache(EvaluationCache* cache) {
+    evaluation_cache_ = cache;
+  }
+  EvaluationCache* evaluation_cache() const { return evaluation_cache_; }
+
   // Returns true if a value has been set for the result of the given node.
   bool HasResult(Node* node) const { return NodeValuesMap().contains(node); }
 
@@ -178,6 +187,11 @@ class IrInterpreter : public DfsVisitor {
   absl::StatusOr<Value> DeepOr(Type* input_type,
                                absl::Span<const Value* const> inputs);
 
+  // Interprets the function called by an invoke or map operation with the
+  // given arguments, using the evaluation cache if one is set.
+  absl::StatusOr<InterpreterResult<Value>> InterpretCallee(
+      Function* callee, absl::Span<const Value> args);
+
   // Returns the map which maps Node* to the Value computed for that node.
   absl::flat_hash_map<Node*, Value>& NodeValuesMap() {
     return node_values_ptr_ != nullptr ? *node_values_ptr_ : node_values_;
@@ -199,6 +213,9 @@ class IrInterpreter : public DfsVisitor {
   // used (`events_ptr` is null).
   InterpreterEvents* events_ptr_;
   InterpreterEvents events_;
+
+  // Optional cache of callee results. Not owned.
+  EvaluationCache* evaluation_cache_ = nullptr;
 };
 
 }  // namespace xls
@@ -15,6 +15,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
+#include "xls/interpreter/evaluation_cache.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/ir/bits.h"
@@ -210,5 +211,112 @@ fn map_trace() -> bits[32][5]{
               UnorderedElementsAre("f is odd", "d is odd", "b is odd"));
 }
 
+TEST_F(IrInterpreterOnlyTest, EvaluationCacheMap) {
+  const std::string pkg_text = R"(
+package cache_test
+
+fn double_it(x: bits[8]) -> bits[8] {
+  after_all.0: token = after_all()
+  literal.1: bits[1] = literal(value=1)
+  trace.2: token = trace(after_all.0, literal.1, format="x is {}", data_operands=[x])
+  ret add.3: bits[8] = add(x, x)
+}
+
+top fn main(input: bits[8][4]) -> bits[8][4] {
+  ret map.4: bits[8][4] = map(input, to_apply=double_it)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(pkg_text));
+  Function* main = FindFunction("main", package.get());
+  XLS_ASSERT_OK_AND_ASSIGN(Value input, Value::UBitsArray({1, 2, 1, 1}, 8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                           Value::UBitsArray({2, 4, 2, 2}, 8));
+
+  EvaluationCache cache(/*max_entries=*/16);
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           InterpretFunction(main, {input}, &cache));
+  EXPECT_EQ(result.value, expected);
+  // Cached results must replay the events of the callee.
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre("x is 1", "x is 2", "x is 1", "x is 1"));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.misses(), 2);
+  EXPECT_EQ(cache.hits(), 2);
+
+  // A second evaluation is served entirely from the cache.
+  XLS_ASSERT_OK_AND_ASSIGN(result, InterpretFunction(main, {input}, &cache));
+  EXPECT_EQ(result.value, expected);
+  EXPECT_EQ(cache.misses(), 2);
+  EXPECT_EQ(cache.hits(), 6);
+}
+
+TEST_F(IrInterpreterOnlyTest, EvaluationCacheNestedInvoke) {
+  const std::string pkg_text = R"(
+package cache_test
+
+fn square(x: bits[32]) -> bits[32] {
+  ret umul.1: bits[32] = umul(x, x)
+}
+
+fn square_plus_one(x: bits[32]) -> bits[32] {
+  invoke.2: bits[32] = invoke(x, to_apply=square)
+  literal.3: bits[32] = literal(value=1)
+  ret add.4: bits[32] = add(invoke.2, literal.3)
+}
+
+top fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  invoke.5: bits[32] = invoke(x, to_apply=square_plus_one)
+  invoke.6: bits[32] = invoke(y, to_apply=square)
+  ret add.7: bits[32] = add(invoke.5, invoke.6)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(pkg_text));
+  Function* main = FindFunction("main", package.get());
+
+  EvaluationCache cache(/*max_entries=*/16);
+  // square(3) is computed inside square_plus_one and then reused for y.
+  EXPECT_THAT(DropInterpreterEvents(InterpretFunction(
+                  main, {Value(UBits(3, 32)), Value(UBits(3, 32))}, &cache)),
+              IsOkAndHolds(Value(UBits(19, 32))));
+  EXPECT_EQ(cache.misses(), 2);
+  EXPECT_EQ(cache.hits(), 1);
+
+  EXPECT_THAT(DropInterpreterEvents(InterpretFunction(
+                  main, {Value(UBits(3, 32)), Value(UBits(4, 32))}, &cache)),
+              IsOkAndHolds(Value(UBits(26, 32))));
+  EXPECT_EQ(cache.misses(), 3);
+  EXPECT_EQ(cache.hits(), 2);
+}
+
+TEST_F(IrInterpreterOnlyTest, EvaluationCacheEviction) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  auto result = [](int64_t v) {
+    return InterpreterResult<Value>{Value(UBits(v, 8)), InterpreterEvents()};
+  };
+  EvaluationCache cache(/*max_entries=*/2);
+  cache.Insert(f, {Value(UBits(1, 8))}, result(1));
+  cache.Insert(f, {Value(UBits(2, 8))}, result(2));
+  // Touch 1 so that 2 becomes the least-recently used entry.
+  ASSERT_TRUE(cache.Lookup(f, {Value(UBits(1, 8))}).has_value());
+  cache.Insert(f, {Value(UBits(3, 8))}, result(3));
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.evictions(), 1);
+  EXPECT_FALSE(cache.Lookup(f, {Value(UBits(2, 8))}).has_value());
+  std::optional<InterpreterResult<Value>> one =
+      cache.Lookup(f, {Value(UBits(1, 8))});
+  ASSERT_TRUE(one.has_value());
+  EXPECT_EQ(one->value, Value(UBits(1, 8)));
+  EXPECT_TRUE(cache.Lookup(f, {Value(UBits(3, 8))}).has_value());
+
+  cache.Clear();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_FALSE(cache.Lookup(f, {Value(UBits(1, 8))}).has_value());
+}
+
 }  // namespace
 }  // namespace xls
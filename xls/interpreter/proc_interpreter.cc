@@ -14,6 +14,9 @@
 
 #include "xls/interpreter/proc_interpreter.h"
 
+#include <iostream>
+#include <string>
+
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
 #include "xls/interpreter/ir_interpreter.h"
@@ -157,6 +160,15 @@ std::ostream& operator<<(std::ostream& os, const TickResult& result) {
   return os;
 }
 
+void PrintTraces(Proc* proc, ProcContinuation& continuation) {
+  InterpreterEvents& events = continuation.GetEvents();
+  for (const std::string& msg : events.GetTraceMessages()) {
+    std::cerr << "Proc " << proc->name() << " trace: " << msg << "\n";
+  }
+  events.trace_msgs.clear();
+  events.raw_traces.Clear();
+}
+
 ProcInterpreter::ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager)
     : proc_(proc),
       queue_manager_(queue_manager),
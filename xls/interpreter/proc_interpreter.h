@@ -52,6 +52,10 @@ class ProcContinuation {
   virtual bool AtStartOfTick() const = 0;
 };
 
+// Prints the trace messages recorded in the continuation of `proc` to stderr
+// and clears them, so each message is printed once.
+void PrintTraces(Proc* proc, ProcContinuation& continuation);
+
 // Data structure holding the result of a single call to Tick.
 struct TickResult {
   // Whether the proc completed executing for this tick. Execution is not
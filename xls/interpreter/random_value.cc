@@ -14,39 +14,118 @@
 
 #include "xls/interpreter/random_value.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "absl/status/status.h"
+#include "xls/common/math_util.h"
 #include "xls/interpreter/function_interpreter.h"
 
 namespace xls {
 
-Value RandomValue(Type* type, std::minstd_rand* engine) {
+namespace {
+
+// Returns the number of random bytes used to construct a value of the given
+// type: one byte per (started) eight bits of each bits-typed leaf.
+int64_t RandomByteCount(Type* type) {
+  if (type->IsTuple()) {
+    int64_t byte_count = 0;
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      byte_count += RandomByteCount(element_type);
+    }
+    return byte_count;
+  }
+  if (type->IsArray()) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    return array_type->size() * RandomByteCount(array_type->element_type());
+  }
+  if (type->IsToken()) {
+    return 0;
+  }
+  return CeilOfRatio(type->AsBitsOrDie()->bit_count(), int64_t{8});
+}
+
+// Constructs a value of the given type from the random bytes at the front of
+// `bytes` and advances `bytes` past the bytes used (see RandomByteCount).
+Value ValueFromRandomBytes(Type* type, absl::Span<const uint8_t>* bytes) {
   if (type->IsTuple()) {
     TupleType* tuple_type = type->AsTupleOrDie();
     std::vector<Value> elements;
+    elements.reserve(tuple_type->size());
     for (int64_t i = 0; i < tuple_type->size(); ++i) {
-      elements.push_back(RandomValue(tuple_type->element_type(i), engine));
+      elements.push_back(
+          ValueFromRandomBytes(tuple_type->element_type(i), bytes));
     }
-    return Value::Tuple(elements);
+    return Value::TupleOwned(std::move(elements));
   }
   if (type->IsArray()) {
     ArrayType* array_type = type->AsArrayOrDie();
     std::vector<Value> elements;
+    elements.reserve(array_type->size());
     for (int64_t i = 0; i < array_type->size(); ++i) {
-      elements.push_back(RandomValue(array_type->element_type(), engine));
+      elements.push_back(
+          ValueFromRandomBytes(array_type->element_type(), bytes));
     }
-    return Value::Array(elements).value();
+    return Value::ArrayOwned(std::move(elements)).value();
   }
   if (type->IsToken()) {
     return Value::Token();
   }
   int64_t bit_count = type->AsBitsOrDie()->bit_count();
-  std::vector<uint8_t> bytes;
-  bytes.reserve(bit_count);
+  int64_t byte_count = CeilOfRatio(bit_count, int64_t{8});
+  Value result(Bits::FromBytes(bytes->subspan(0, byte_count), bit_count));
+  bytes->remove_prefix(byte_count);
+  return result;
+}
+
+// Returns the sum of RandomByteCount over the parameters of `f`.
+int64_t RandomArgumentByteCount(Function* f) {
+  int64_t byte_count = 0;
+  for (Param* param : f->params()) {
+    byte_count += RandomByteCount(param->GetType());
+  }
+  return byte_count;
+}
+
+}  // namespace
+
+Xoshiro256StarStar::Xoshiro256StarStar(uint64_t seed) {
+  // splitmix64
+  for (uint64_t& word : state_) {
+    seed += 0x9e3779b97f4a7c15;
+    uint64_t z = seed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    word = z ^ (z >> 31);
+  }
+}
+
+void Xoshiro256StarStar::Fill(absl::Span<uint8_t> bytes) {
+  for (int64_t i = 0; i < bytes.size(); i += 8) {
+    uint64_t word = (*this)();
+    int64_t end = std::min<int64_t>(i + 8, bytes.size());
+    for (int64_t j = i; j < end; ++j) {
+      bytes[j] = static_cast<uint8_t>(word);
+      word >>= 8;
+    }
+  }
+}
+
+Value RandomValue(Type* type, std::minstd_rand* engine) {
+  std::vector<uint8_t> bytes(RandomByteCount(type));
   std::uniform_int_distribution<int32_t> generator(0, 255);
-  for (int64_t i = 0; i < bit_count; i += 8) {
-    bytes.push_back(static_cast<uint8_t>(generator(*engine)));
+  for (uint8_t& byte : bytes) {
+    byte = static_cast<uint8_t>(generator(*engine));
   }
-  return Value(Bits::FromBytes(bytes, bit_count));
+  absl::Span<const uint8_t> remaining = bytes;
+  return ValueFromRandomBytes(type, &remaining);
+}
+
+Value RandomValue(Type* type, Xoshiro256StarStar* engine) {
+  std::vector<uint8_t> bytes(RandomByteCount(type));
+  engine->Fill(absl::MakeSpan(bytes));
+  absl::Span<const uint8_t> remaining = bytes;
+  return ValueFromRandomBytes(type, &remaining);
 }
 
 std::vector<Value> RandomFunctionArguments(Function* f,
@@ -95,4 +174,19 @@ absl::StatusOr<std::vector<Value>> RandomFunctionArguments(
       "or the limit should be increased."));
 }
 
+std::vector<std::vector<Value>> RandomFunctionArgumentSets(
+    Function* f, int64_t count, Xoshiro256StarStar* engine) {
+  std::vector<uint8_t> bytes(RandomArgumentByteCount(f));
+  std::vector<std::vector<Value>> arg_sets(count);
+  for (std::vector<Value>& args : arg_sets) {
+    engine->Fill(absl::MakeSpan(bytes));
+    absl::Span<const uint8_t> remaining = bytes;
+    args.reserve(f->params().size());
+    for (Param* param : f->params()) {
+      args.push_back(ValueFromRandomBytes(param->GetType(), &remaining));
+    }
+  }
+  return arg_sets;
+}
+
 }  // namespace xls
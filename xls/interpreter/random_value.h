@@ -15,18 +15,64 @@
 #ifndef XLS_INTERPRETER_RANDOM_VALUE_H_
 #define XLS_INTERPRETER_RANDOM_VALUE_H_
 
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <random>
 #include <vector>
 
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/function.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 
 namespace xls {
 
+// A fast pseudo-random bit generator (xoshiro256**) for generating large
+// numbers of random values. Unlike std::minstd_rand each call produces 64
+// random bits. Satisfies the requirements of UniformRandomBitGenerator so it
+// may also be used with the standard distributions.
+class Xoshiro256StarStar {
+ public:
+  using result_type = uint64_t;
+
+  // The state is expanded from `seed` with splitmix64 so any seed (including
+  // zero) is valid.
+  explicit Xoshiro256StarStar(uint64_t seed = 0);
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    const uint64_t result = RotateLeft(state_[1] * 5, 7) * 9;
+    const uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = RotateLeft(state_[3], 45);
+    return result;
+  }
+
+  // Fills `bytes` with random data, eight bytes per call of the generator.
+  void Fill(absl::Span<uint8_t> bytes);
+
+ private:
+  static uint64_t RotateLeft(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  std::array<uint64_t, 4> state_;
+};
+
 // Returns a Value with random uniformly distributed bits using the given
 // engine.
 Value RandomValue(Type* type, std::minstd_rand* engine);
+Value RandomValue(Type* type, Xoshiro256StarStar* engine);
 
 // Returns a set of argument values for the given function with random uniformly
 // distributed bits using the given engine.
@@ -37,6 +83,12 @@ absl::StatusOr<std::vector<Value>> RandomFunctionArguments(
     Function* f, std::minstd_rand* engine, Function* validator,
     int64_t max_attempts);
 
+// Returns `count` sets of argument values for the given function with random
+// uniformly distributed bits using the given engine. The random data of each
+// argument set is drawn in bulk rather than one value at a time.
+std::vector<std::vector<Value>> RandomFunctionArgumentSets(
+    Function* f, int64_t count, Xoshiro256StarStar* engine);
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_RANDOM_VALUE_H_
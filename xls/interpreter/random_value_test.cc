@@ -18,8 +18,10 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
 
@@ -111,5 +113,60 @@ TEST(RandomValueTest, RandomOtherTypes) {
   }
 }
 
+TEST(RandomValueTest, Xoshiro256StarStar) {
+  Package p("test_package");
+  Xoshiro256StarStar engine0(1);
+  Xoshiro256StarStar engine1(1);
+  Xoshiro256StarStar engine2(2);
+  Type* type = p.GetTupleType(
+      {p.GetBitsType(1234), p.GetArrayType(3, p.GetBitsType(13))});
+  Value value = RandomValue(type, &engine0);
+  EXPECT_EQ(value, RandomValue(type, &engine1));
+  EXPECT_NE(value, RandomValue(type, &engine2));
+  EXPECT_TRUE(value.IsTuple());
+  EXPECT_EQ(value.element(0).bits().bit_count(), 1234);
+  EXPECT_EQ(value.element(1).size(), 3);
+
+  // Every bit should be set to 0 and 1 at least once with overwhelming
+  // probability.
+  const int64_t kSampleCount = 1024;
+  std::vector<uint8_t> bytes(11);
+  std::vector<int64_t> bit_set_count(bytes.size() * 8);
+  for (int64_t i = 0; i < kSampleCount; ++i) {
+    engine0.Fill(absl::MakeSpan(bytes));
+    for (int64_t j = 0; j < bit_set_count.size(); ++j) {
+      bit_set_count[j] += (bytes[j / 8] >> (j % 8)) & 1;
+    }
+  }
+  for (int64_t count : bit_set_count) {
+    EXPECT_GT(count, 0);
+    EXPECT_LT(count, kSampleCount);
+  }
+}
+
+TEST(RandomValueTest, RandomFunctionArgumentSets) {
+  Package p("test_package");
+  FunctionBuilder fb("f", &p);
+  fb.Add(fb.Param("x", p.GetBitsType(32)), fb.Param("y", p.GetBitsType(32)));
+  fb.Param("z", p.GetTupleType({p.GetBitsType(7), p.GetTokenType()}));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  Xoshiro256StarStar engine;
+  std::vector<std::vector<Value>> arg_sets =
+      RandomFunctionArgumentSets(f, 100, &engine);
+  ASSERT_EQ(arg_sets.size(), 100);
+  absl::flat_hash_set<Value> x_values;
+  for (const std::vector<Value>& args : arg_sets) {
+    ASSERT_EQ(args.size(), 3);
+    EXPECT_EQ(args[0].bits().bit_count(), 32);
+    EXPECT_EQ(args[1].bits().bit_count(), 32);
+    EXPECT_EQ(args[2].element(0).bits().bit_count(), 7);
+    EXPECT_TRUE(args[2].element(1).IsToken());
+    x_values.insert(args[0]);
+  }
+  // Overwhelmingly likely that the 32-bit values are distinct.
+  EXPECT_EQ(x_values.size(), 100);
+}
+
 }  // namespace
 }  // namespace xls
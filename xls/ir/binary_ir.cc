@@ -0,0 +1,1369 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/ir/binary_ir.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/block.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/function.h"
+#include "xls/ir/instantiation.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/register.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
+
+namespace xls {
+namespace {
+
+// Layout of a serialized package. Integers are unsigned LEB128 varints unless
+// noted otherwise; signed integers are zigzag encoded. Strings are a length
+// followed by the bytes.
+//
+//   magic
+//   package name
+//   file numbers: count, then (file number, file name) for each
+//   type table: count, then a TypeTag and its contents for each. Element types
+//     precede the types which contain them.
+//   channels: count, then each channel
+//   function bases: count, then each function base. Called functions and
+//     instantiated blocks precede their users.
+//   top: index of the top function base plus one, or zero if none.
+//
+// A function base is its FunctionBaseTag, its name, a kind-specific header,
+// its node table, and a kind-specific trailer which refers to nodes by index.
+// Parameters come first in the node table and every node follows its
+// operands. A node is its op, id, assigned name (empty if none), source
+// locations, operand indices, and op-specific attributes.
+
+enum class TypeTag : uint8_t { kBits, kTuple, kArray, kToken };
+enum class ValueTag : uint8_t { kBits, kTuple, kArray, kToken };
+enum class FunctionBaseTag : uint8_t { kFunction, kProc, kBlock };
+enum class PortTag : uint8_t { kInput, kOutput, kClock };
+enum class FormatStepTag : uint8_t { kText, kPreference };
+
+class BinaryWriter {
+ public:
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      out_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    out_.push_back(static_cast<char>(value));
+  }
+  void WriteSigned(int64_t value) {
+    WriteVarint((static_cast<uint64_t>(value) << 1) ^
+                static_cast<uint64_t>(value >> 63));
+  }
+  void WriteBool(bool value) { out_.push_back(value ? 1 : 0); }
+  void WriteString(std::string_view s) {
+    WriteVarint(s.size());
+    out_.append(s.data(), s.size());
+  }
+  void WriteBytes(absl::Span<const uint8_t> bytes) {
+    out_.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  }
+
+  std::string& out() { return out_; }
+
+ private:
+  std::string out_;
+};
+
+class BinaryReader {
+ public:
+  explicit BinaryReader(std::string_view data) : data_(data) {}
+
+  absl::StatusOr<uint64_t> ReadVarint() {
+    uint64_t result = 0;
+    for (int64_t shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) {
+        return TruncatedError();
+      }
+      uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+      result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return result;
+      }
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Malformed varint in binary IR at offset %d", pos_));
+  }
+  absl::StatusOr<int64_t> ReadSigned() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, ReadVarint());
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+  absl::StatusOr<bool> ReadBool() {
+    XLS_ASSIGN_OR_RETURN(std::string_view byte, ReadBytes(1));
+    return byte[0] != 0;
+  }
+  absl::StatusOr<std::string_view> ReadString() {
+    XLS_ASSIGN_OR_RETURN(uint64_t size, ReadVarint());
+    return ReadBytes(size);
+  }
+  absl::StatusOr<std::string_view> ReadBytes(uint64_t size) {
+    if (size > data_.size() - pos_) {
+      return TruncatedError();
+    }
+    std::string_view result = data_.substr(pos_, size);
+    pos_ += size;
+    return result;
+  }
+  // Reads an index which must be less than `limit`.
+  absl::StatusOr<int64_t> ReadIndex(int64_t limit, std::string_view what) {
+    XLS_ASSIGN_OR_RETURN(uint64_t index, ReadVarint());
+    if (index >= limit) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid %s index %d in binary IR (limit %d)", what,
+                          index, limit));
+    }
+    return static_cast<int64_t>(index);
+  }
+
+  bool AtEnd() const { return pos_ == data_.size(); }
+
+ private:
+  absl::Status TruncatedError() const {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Binary IR is truncated at offset %d", pos_));
+  }
+
+  std::string_view data_;
+  uint64_t pos_ = 0;
+};
+
+// Returns the function bases of the package in an order in which each one
+// follows the functions it calls and the blocks it instantiates. The order of
+// the package is otherwise preserved.
+std::vector<FunctionBase*> FunctionBasesInDependencyOrder(Package* package) {
+  std::vector<FunctionBase*> order;
+  absl::flat_hash_set<FunctionBase*> visited;
+  std::function<void(FunctionBase*)> visit = [&](FunctionBase* f) {
+    if (!visited.insert(f).second) {
+      return;
+    }
+    for (Function* callee : CalledFunctions(f)) {
+      visit(callee);
+    }
+    if (f->IsBlock()) {
+      for (Instantiation* instantiation :
+           f->AsBlockOrDie()->GetInstantiations()) {
+        if (auto* block_instantiation =
+                dynamic_cast<BlockInstantiation*>(instantiation)) {
+          visit(block_instantiation->instantiated_block());
+        }
+      }
+    }
+    order.push_back(f);
+  };
+  for (FunctionBase* f : package->GetFunctionBases()) {
+    visit(f);
+  }
+  return order;
+}
+
+// Returns the nodes of `f` with the parameters first (in parameter order) and
+// every other node following its operands. The order of f->nodes() is
+// otherwise preserved.
+std::vector<Node*> NodesInOperandOrder(FunctionBase* f) {
+  std::vector<Node*> order;
+  order.reserve(f->node_count());
+  absl::flat_hash_set<Node*> visited;
+  visited.reserve(f->node_count());
+  for (Param* param : f->params()) {
+    visited.insert(param);
+    order.push_back(param);
+  }
+  // Stack of nodes and the index of the next operand to visit.
+  std::vector<std::pair<Node*, int64_t>> stack;
+  for (Node* root : f->nodes()) {
+    if (!visited.insert(root).second) {
+      continue;
+    }
+    stack.push_back({root, 0});
+    while (!stack.empty()) {
+      Node* node = stack.back().first;
+      int64_t operand_index = stack.back().second;
+      if (operand_index < node->operand_count()) {
+        ++stack.back().second;
+        Node* operand = node->operand(operand_index);
+        if (visited.insert(operand).second) {
+          stack.push_back({operand, 0});
+        }
+        continue;
+      }
+      order.push_back(node);
+      stack.pop_back();
+    }
+  }
+  return order;
+}
+
+class Serializer {
+ public:
+  explicit Serializer(Package* package) : package_(package) {}
+
+  absl::StatusOr<std::string> Serialize();
+
+ private:
+  // Returns the index of the type in the type table, adding it (and its
+  // element types) if necessary.
+  int64_t InternType(Type* type);
+  void WriteType(Type* type) { body_.WriteVarint(InternType(type)); }
+  void WriteValue(const Value& value);
+  void WriteSourceInfo(const SourceInfo& loc);
+  void WriteChannel(Channel* channel);
+  void WriteFunctionRef(FunctionBase* f) {
+    body_.WriteVarint(function_base_indices_.at(f));
+  }
+  absl::Status WriteFunctionBase(FunctionBase* f);
+  absl::Status WriteNode(Node* node);
+
+  Package* package_;
+  BinaryWriter types_;
+  int64_t type_count_ = 0;
+  absl::flat_hash_map<Type*, int64_t> type_indices_;
+  BinaryWriter body_;
+  absl::flat_hash_map<FunctionBase*, int64_t> function_base_indices_;
+  // Indices of the nodes in the table of the function base being written.
+  absl::flat_hash_map<Node*, int64_t> node_indices_;
+  absl::flat_hash_map<Register*, int64_t> register_indices_;
+  absl::flat_hash_map<Instantiation*, int64_t> instantiation_indices_;
+};
+
+int64_t Serializer::InternType(Type* type) {
+  auto it = type_indices_.find(type);
+  if (it != type_indices_.end()) {
+    return it->second;
+  }
+  // Intern the element types first so they precede this type in the table.
+  std::vector<int64_t> element_indices;
+  if (type->IsTuple()) {
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      element_indices.push_back(InternType(element_type));
+    }
+  } else if (type->IsArray()) {
+    element_indices.push_back(
+        InternType(type->AsArrayOrDie()->element_type()));
+  }
+  switch (type->kind()) {
+    case TypeKind::kBits:
+      types_.WriteVarint(static_cast<uint64_t>(TypeTag::kBits));
+      types_.WriteVarint(type->AsBitsOrDie()->bit_count());
+      break;
+    case TypeKind::kTuple:
+      types_.WriteVarint(static_cast<uint64_t>(TypeTag::kTuple));
+      types_.WriteVarint(element_indices.size());
+      for (int64_t index : element_indices) {
+        types_.WriteVarint(index);
+      }
+      break;
+    case TypeKind::kArray:
+      types_.WriteVarint(static_cast<uint64_t>(TypeTag::kArray));
+      types_.WriteVarint(type->AsArrayOrDie()->size());
+      types_.WriteVarint(element_indices.front());
+      break;
+    case TypeKind::kToken:
+      types_.WriteVarint(static_cast<uint64_t>(TypeTag::kToken));
+      break;
+  }
+  int64_t index = type_count_++;
+  type_indices_[type] = index;
+  return index;
+}
+
+void Serializer::WriteValue(const Value& value) {
+  switch (value.kind()) {
+    case ValueKind::kBits: {
+      body_.WriteVarint(static_cast<uint64_t>(ValueTag::kBits));
+      body_.WriteVarint(value.bits().bit_count());
+      body_.WriteBytes(value.bits().ToBytes());
+      return;
+    }
+    case ValueKind::kTuple:
+    case ValueKind::kArray:
+      body_.WriteVarint(static_cast<uint64_t>(
+          value.IsTuple() ? ValueTag::kTuple : ValueTag::kArray));
+      body_.WriteVarint(value.size());
+      for (const Value& element : value.elements()) {
+        WriteValue(element);
+      }
+      return;
+    case ValueKind::kToken:
+      body_.WriteVarint(static_cast<uint64_t>(ValueTag::kToken));
+      return;
+    default:
+      XLS_LOG(FATAL) << "Invalid value: " << value.kind();
+  }
+}
+
+void Serializer::WriteSourceInfo(const SourceInfo& loc) {
+  body_.WriteVarint(loc.locations.size());
+  for (const SourceLocation& location : loc.locations) {
+    body_.WriteSigned(location.fileno().value());
+    body_.WriteSigned(location.lineno().value());
+    body_.WriteSigned(location.colno().value());
+  }
+}
+
+void Serializer::WriteChannel(Channel* channel) {
+  body_.WriteVarint(static_cast<uint64_t>(channel->kind()));
+  body_.WriteString(channel->name());
+  body_.WriteVarint(channel->id());
+  body_.WriteVarint(static_cast<uint64_t>(channel->supported_ops()));
+  WriteType(channel->type());
+  body_.WriteString(channel->metadata().SerializeAsString());
+  if (channel->kind() == ChannelKind::kStreaming) {
+    auto* streaming = down_cast<StreamingChannel*>(channel);
+    body_.WriteVarint(streaming->initial_values().size());
+    for (const Value& value : streaming->initial_values()) {
+      WriteValue(value);
+    }
+    body_.WriteBool(streaming->GetFifoDepth().has_value());
+    if (streaming->GetFifoDepth().has_value()) {
+      body_.WriteVarint(*streaming->GetFifoDepth());
+    }
+    body_.WriteVarint(static_cast<uint64_t>(streaming->GetFlowControl()));
+  }
+}
+
+absl::Status Serializer::WriteFunctionBase(FunctionBase* f) {
+  if (f->IsFunction()) {
+    body_.WriteVarint(static_cast<uint64_t>(FunctionBaseTag::kFunction));
+    body_.WriteString(f->name());
+  } else if (f->IsProc()) {
+    Proc* proc = f->AsProcOrDie();
+    body_.WriteVarint(static_cast<uint64_t>(FunctionBaseTag::kProc));
+    body_.WriteString(f->name());
+    body_.WriteString(proc->TokenParam()->GetName());
+    body_.WriteVarint(proc->GetStateElementCount());
+    for (const Value& value : proc->InitValues()) {
+      WriteValue(value);
+    }
+  } else {
+    Block* block = f->AsBlockOrDie();
+    body_.WriteVarint(static_cast<uint64_t>(FunctionBaseTag::kBlock));
+    body_.WriteString(f->name());
+    register_indices_.clear();
+    body_.WriteVarint(block->GetRegisters().size());
+    for (Register* reg : block->GetRegisters()) {
+      register_indices_[reg] = register_indices_.size();
+      body_.WriteString(reg->name());
+      WriteType(reg->type());
+      body_.WriteBool(reg->reset().has_value());
+      if (reg->reset().has_value()) {
+        WriteValue(reg->reset()->reset_value);
+        body_.WriteBool(reg->reset()->asynchronous);
+        body_.WriteBool(reg->reset()->active_low);
+      }
+    }
+    instantiation_indices_.clear();
+    body_.WriteVarint(block->GetInstantiations().size());
+    for (Instantiation* instantiation : block->GetInstantiations()) {
+      auto* block_instantiation =
+          dynamic_cast<BlockInstantiation*>(instantiation);
+      if (block_instantiation == nullptr) {
+        return absl::UnimplementedError(absl::StrFormat(
+            "Binary IR does not support %s instantiation `%s`",
+            InstantiationKindToString(instantiation->kind()),
+            instantiation->name()));
+      }
+      instantiation_indices_[instantiation] = instantiation_indices_.size();
+      body_.WriteString(instantiation->name());
+      WriteFunctionRef(block_instantiation->instantiated_block());
+    }
+  }
+
+  std::vector<Node*> nodes = NodesInOperandOrder(f);
+  node_indices_.clear();
+  node_indices_.reserve(nodes.size());
+  body_.WriteVarint(nodes.size());
+  for (Node* node : nodes) {
+    XLS_RETURN_IF_ERROR(WriteNode(node));
+    node_indices_[node] = node_indices_.size();
+  }
+
+  if (f->IsFunction()) {
+    Node* return_value = f->AsFunctionOrDie()->return_value();
+    body_.WriteVarint(return_value == nullptr
+                          ? 0
+                          : node_indices_.at(return_value) + 1);
+  } else if (f->IsProc()) {
+    Proc* proc = f->AsProcOrDie();
+    body_.WriteVarint(node_indices_.at(proc->NextToken()));
+    for (Node* next_state : proc->NextState()) {
+      body_.WriteVarint(node_indices_.at(next_state));
+    }
+  } else {
+    Block* block = f->AsBlockOrDie();
+    body_.WriteVarint(block->GetPorts().size());
+    for (const Block::Port& port : block->GetPorts()) {
+      if (std::holds_alternative<InputPort*>(port)) {
+        body_.WriteVarint(static_cast<uint64_t>(PortTag::kInput));
+        body_.WriteString(std::get<InputPort*>(port)->GetName());
+      } else if (std::holds_alternative<OutputPort*>(port)) {
+        body_.WriteVarint(static_cast<uint64_t>(PortTag::kOutput));
+        body_.WriteString(std::get<OutputPort*>(port)->GetName());
+      } else {
+        body_.WriteVarint(static_cast<uint64_t>(PortTag::kClock));
+        body_.WriteString(std::get<Block::ClockPort*>(port)->name);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Serializer::WriteNode(Node* node) {
+  body_.WriteVarint(static_cast<uint64_t>(node->op()));
+  body_.WriteVarint(node->id());
+  body_.WriteString(node->HasAssignedName() ? node->GetName() : "");
+  WriteSourceInfo(node->loc());
+  body_.WriteVarint(node->operand_count());
+  for (Node* operand : node->operands()) {
+    body_.WriteVarint(node_indices_.at(operand));
+  }
+  switch (node->op()) {
+    case Op::kArray:
+      WriteType(node->As<Array>()->element_type());
+      break;
+    case Op::kArraySlice:
+      body_.WriteVarint(node->As<ArraySlice>()->width());
+      break;
+    case Op::kSMul:
+    case Op::kUMul:
+      body_.WriteVarint(node->As<ArithOp>()->width());
+      break;
+    case Op::kSMulp:
+    case Op::kUMulp:
+      body_.WriteVarint(node->As<PartialProductOp>()->width());
+      break;
+    case Op::kAssert: {
+      Assert* assert = node->As<Assert>();
+      body_.WriteString(assert->message());
+      body_.WriteBool(assert->label().has_value());
+      if (assert->label().has_value()) {
+        body_.WriteString(*assert->label());
+      }
+      break;
+    }
+    case Op::kCover:
+      body_.WriteString(node->As<Cover>()->label());
+      break;
+    case Op::kTrace: {
+      absl::Span<const FormatStep> format = node->As<Trace>()->format();
+      body_.WriteVarint(format.size());
+      for (const FormatStep& step : format) {
+        if (std::holds_alternative<std::string>(step)) {
+          body_.WriteVarint(static_cast<uint64_t>(FormatStepTag::kText));
+          body_.WriteString(std::get<std::string>(step));
+        } else {
+          body_.WriteVarint(static_cast<uint64_t>(FormatStepTag::kPreference));
+          body_.WriteVarint(
+              static_cast<uint64_t>(std::get<FormatPreference>(step)));
+        }
+      }
+      break;
+    }
+    case Op::kReceive:
+      body_.WriteVarint(node->As<Receive>()->channel_id());
+      body_.WriteBool(node->As<Receive>()->is_blocking());
+      break;
+    case Op::kSend:
+      body_.WriteVarint(node->As<Send>()->channel_id());
+      break;
+    case Op::kBitSlice:
+      body_.WriteVarint(node->As<BitSlice>()->start());
+      body_.WriteVarint(node->As<BitSlice>()->width());
+      break;
+    case Op::kDynamicBitSlice:
+      body_.WriteVarint(node->As<DynamicBitSlice>()->width());
+      break;
+    case Op::kCountedFor:
+      body_.WriteSigned(node->As<CountedFor>()->trip_count());
+      body_.WriteSigned(node->As<CountedFor>()->stride());
+      WriteFunctionRef(node->As<CountedFor>()->body());
+      break;
+    case Op::kDynamicCountedFor:
+      WriteFunctionRef(node->As<DynamicCountedFor>()->body());
+      break;
+    case Op::kSignExt:
+    case Op::kZeroExt:
+      body_.WriteVarint(node->As<ExtendOp>()->new_bit_count());
+      break;
+    case Op::kInvoke:
+      WriteFunctionRef(node->As<Invoke>()->to_apply());
+      break;
+    case Op::kMap:
+      WriteFunctionRef(node->As<Map>()->to_apply());
+      break;
+    case Op::kLiteral:
+      WriteValue(node->As<Literal>()->value());
+      break;
+    case Op::kOneHot:
+      body_.WriteVarint(static_cast<uint64_t>(node->As<OneHot>()->priority()));
+      break;
+    case Op::kParam:
+      WriteType(node->GetType());
+      break;
+    case Op::kSel:
+      body_.WriteBool(node->As<Select>()->default_value().has_value());
+      break;
+    case Op::kTupleIndex:
+      body_.WriteVarint(node->As<TupleIndex>()->index());
+      break;
+    case Op::kDecode:
+      body_.WriteVarint(node->As<Decode>()->width());
+      break;
+    case Op::kInputPort:
+      WriteType(node->GetType());
+      break;
+    case Op::kRegisterRead:
+      body_.WriteVarint(
+          register_indices_.at(node->As<RegisterRead>()->GetRegister()));
+      break;
+    case Op::kRegisterWrite: {
+      RegisterWrite* reg_write = node->As<RegisterWrite>();
+      body_.WriteVarint(register_indices_.at(reg_write->GetRegister()));
+      body_.WriteBool(reg_write->load_enable().has_value());
+      body_.WriteBool(reg_write->reset().has_value());
+      break;
+    }
+    case Op::kInstantiationInput:
+      body_.WriteVarint(instantiation_indices_.at(
+          node->As<InstantiationInput>()->instantiation()));
+      body_.WriteString(node->As<InstantiationInput>()->port_name());
+      break;
+    case Op::kInstantiationOutput:
+      body_.WriteVarint(instantiation_indices_.at(
+          node->As<InstantiationOutput>()->instantiation()));
+      body_.WriteString(node->As<InstantiationOutput>()->port_name());
+      break;
+    default:
+      // The op and operands fully describe the node.
+      break;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> Serializer::Serialize() {
+  // The channels and function bases are written to `body_` first as writing
+  // them fills in the type table which precedes them in the output.
+  body_.WriteVarint(package_->channels().size());
+  for (Channel* channel : package_->channels()) {
+    WriteChannel(channel);
+  }
+  std::vector<FunctionBase*> function_bases =
+      FunctionBasesInDependencyOrder(package_);
+  body_.WriteVarint(function_bases.size());
+  for (FunctionBase* f : function_bases) {
+    XLS_RETURN_IF_ERROR(WriteFunctionBase(f));
+    function_base_indices_[f] = function_base_indices_.size();
+  }
+  std::optional<FunctionBase*> top = package_->GetTop();
+  body_.WriteVarint(top.has_value() ? function_base_indices_.at(*top) + 1 : 0);
+
+  BinaryWriter header;
+  header.out().append(kBinaryIrMagic.data(), kBinaryIrMagic.size());
+  header.WriteString(package_->name());
+  std::vector<std::pair<Fileno, std::string>> filenos(
+      package_->fileno_to_name().begin(), package_->fileno_to_name().end());
+  std::sort(filenos.begin(), filenos.end());
+  header.WriteVarint(filenos.size());
+  for (const auto& [fileno, filename] : filenos) {
+    header.WriteSigned(fileno.value());
+    header.WriteString(filename);
+  }
+  header.WriteVarint(type_count_);
+
+  std::string result = std::move(header.out());
+  result.reserve(result.size() + types_.out().size() + body_.out().size());
+  result.append(types_.out());
+  result.append(body_.out());
+  return result;
+}
+
+class Deserializer {
+ public:
+  explicit Deserializer(std::string_view data) : reader_(data) {}
+
+  absl::StatusOr<std::unique_ptr<Package>> Deserialize();
+
+ private:
+  absl::StatusOr<Type*> ReadType() {
+    XLS_ASSIGN_OR_RETURN(int64_t index,
+                         reader_.ReadIndex(types_.size(), "type"));
+    return types_[index];
+  }
+  absl::Status ReadTypeTable();
+  absl::StatusOr<Value> ReadValue();
+  absl::StatusOr<SourceInfo> ReadSourceInfo();
+  absl::Status ReadChannel();
+  absl::StatusOr<Function*> ReadFunctionRef();
+  absl::Status ReadFunctionBase();
+  absl::StatusOr<Node*> ReadNode(FunctionBase* f,
+                                 absl::Span<const Value> init_values);
+
+  BinaryReader reader_;
+  std::unique_ptr<Package> package_;
+  std::vector<Type*> types_;
+  std::vector<FunctionBase*> function_bases_;
+  // The node table of the function base being read.
+  std::vector<Node*> nodes_;
+  int64_t max_node_id_ = -1;
+};
+
+absl::Status Deserializer::ReadTypeTable() {
+  XLS_ASSIGN_OR_RETURN(uint64_t type_count, reader_.ReadVarint());
+  for (uint64_t i = 0; i < type_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(uint64_t tag, reader_.ReadVarint());
+    switch (static_cast<TypeTag>(tag)) {
+      case TypeTag::kBits: {
+        XLS_ASSIGN_OR_RETURN(uint64_t bit_count, reader_.ReadVarint());
+        types_.push_back(package_->GetBitsType(bit_count));
+        break;
+      }
+      case TypeTag::kTuple: {
+        XLS_ASSIGN_OR_RETURN(uint64_t size, reader_.ReadVarint());
+        std::vector<Type*> element_types;
+        for (uint64_t j = 0; j < size; ++j) {
+          XLS_ASSIGN_OR_RETURN(Type * element_type, ReadType());
+          element_types.push_back(element_type);
+        }
+        types_.push_back(package_->GetTupleType(element_types));
+        break;
+      }
+      case TypeTag::kArray: {
+        XLS_ASSIGN_OR_RETURN(uint64_t size, reader_.ReadVarint());
+        XLS_ASSIGN_OR_RETURN(Type * element_type, ReadType());
+        types_.push_back(package_->GetArrayType(size, element_type));
+        break;
+      }
+      case TypeTag::kToken:
+        types_.push_back(package_->GetTokenType());
+        break;
+      default:
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Invalid type tag %d in binary IR", tag));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Value> Deserializer::ReadValue() {
+  XLS_ASSIGN_OR_RETURN(uint64_t tag, reader_.ReadVarint());
+  switch (static_cast<ValueTag>(tag)) {
+    case ValueTag::kBits: {
+      XLS_ASSIGN_OR_RETURN(uint64_t bit_count, reader_.ReadVarint());
+      XLS_ASSIGN_OR_RETURN(std::string_view bytes,
+                           reader_.ReadBytes((bit_count + 7) / 8));
+      return Value(Bits::FromBytes(
+          absl::MakeSpan(reinterpret_cast<const uint8_t*>(bytes.data()),
+                         bytes.size()),
+          bit_count));
+    }
+    case ValueTag::kTuple:
+    case ValueTag::kArray: {
+      XLS_ASSIGN_OR_RETURN(uint64_t size, reader_.ReadVarint());
+      std::vector<Value> elements;
+      for (uint64_t i = 0; i < size; ++i) {
+        XLS_ASSIGN_OR_RETURN(Value element, ReadValue());
+        elements.push_back(std::move(element));
+      }
+      if (static_cast<ValueTag>(tag) == ValueTag::kTuple) {
+        return Value::TupleOwned(std::move(elements));
+      }
+      return Value::Array(elements);
+    }
+    case ValueTag::kToken:
+      return Value::Token();
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Invalid value tag %d in binary IR", tag));
+}
+
+absl::StatusOr<SourceInfo> Deserializer::ReadSourceInfo() {
+  XLS_ASSIGN_OR_RETURN(uint64_t count, reader_.ReadVarint());
+  SourceInfo loc;
+  for (uint64_t i = 0; i < count; ++i) {
+    XLS_ASSIGN_OR_RETURN(int64_t fileno, reader_.ReadSigned());
+    XLS_ASSIGN_OR_RETURN(int64_t lineno, reader_.ReadSigned());
+    XLS_ASSIGN_OR_RETURN(int64_t colno, reader_.ReadSigned());
+    loc.locations.push_back(SourceLocation(Fileno(fileno), Lineno(lineno),
+                                           Colno(colno)));
+  }
+  return loc;
+}
+
+absl::Status Deserializer::ReadChannel() {
+  XLS_ASSIGN_OR_RETURN(uint64_t kind, reader_.ReadVarint());
+  XLS_ASSIGN_OR_RETURN(std::string_view name, reader_.ReadString());
+  XLS_ASSIGN_OR_RETURN(uint64_t id, reader_.ReadVarint());
+  XLS_ASSIGN_OR_RETURN(uint64_t supported_ops, reader_.ReadVarint());
+  XLS_ASSIGN_OR_RETURN(Type * type, ReadType());
+  XLS_ASSIGN_OR_RETURN(std::string_view metadata_bytes, reader_.ReadString());
+  ChannelMetadataProto metadata;
+  if (!metadata.ParseFromArray(metadata_bytes.data(), metadata_bytes.size())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid metadata for channel `%s` in binary IR", name));
+  }
+  XLS_RET_CHECK_LE(supported_ops,
+                   static_cast<uint64_t>(ChannelOps::kSendReceive));
+  if (static_cast<ChannelKind>(kind) == ChannelKind::kSingleValue) {
+    return package_
+        ->CreateSingleValueChannel(name,
+                                   static_cast<ChannelOps>(supported_ops),
+                                   type, metadata, id)
+        .status();
+  }
+  if (static_cast<ChannelKind>(kind) != ChannelKind::kStreaming) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid channel kind %d in binary IR", kind));
+  }
+  XLS_ASSIGN_OR_RETURN(uint64_t initial_value_count, reader_.ReadVarint());
+  std::vector<Value> initial_values;
+  for (uint64_t i = 0; i < initial_value_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(Value value, ReadValue());
+    initial_values.push_back(std::move(value));
+  }
+  std::optional<int64_t> fifo_depth;
+  XLS_ASSIGN_OR_RETURN(bool has_fifo_depth, reader_.ReadBool());
+  if (has_fifo_depth) {
+    XLS_ASSIGN_OR_RETURN(fifo_depth, reader_.ReadVarint());
+  }
+  XLS_ASSIGN_OR_RETURN(uint64_t flow_control, reader_.ReadVarint());
+  XLS_RET_CHECK_LE(flow_control,
+                   static_cast<uint64_t>(FlowControl::kReadyValid));
+  return package_
+      ->CreateStreamingChannel(name, static_cast<ChannelOps>(supported_ops),
+                               type, initial_values, fifo_depth,
+                               static_cast<FlowControl>(flow_control),
+                               metadata, id)
+      .status();
+}
+
+absl::StatusOr<Function*> Deserializer::ReadFunctionRef() {
+  XLS_ASSIGN_OR_RETURN(
+      int64_t index, reader_.ReadIndex(function_bases_.size(), "function"));
+  if (!function_bases_[index]->IsFunction()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "`%s` is not a function", function_bases_[index]->name()));
+  }
+  return function_bases_[index]->AsFunctionOrDie();
+}
+
+absl::Status Deserializer::ReadFunctionBase() {
+  XLS_ASSIGN_OR_RETURN(uint64_t tag, reader_.ReadVarint());
+  XLS_ASSIGN_OR_RETURN(std::string_view name, reader_.ReadString());
+  FunctionBase* f;
+  std::vector<Value> init_values;
+  switch (static_cast<FunctionBaseTag>(tag)) {
+    case FunctionBaseTag::kFunction:
+      f = package_->AddFunction(
+          std::make_unique<Function>(name, package_.get()));
+      break;
+    case FunctionBaseTag::kProc: {
+      XLS_ASSIGN_OR_RETURN(std::string_view token_param_name,
+                           reader_.ReadString());
+      XLS_ASSIGN_OR_RETURN(uint64_t state_count, reader_.ReadVarint());
+      for (uint64_t i = 0; i < state_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(Value value, ReadValue());
+        init_values.push_back(std::move(value));
+      }
+      f = package_->AddProc(
+          std::make_unique<Proc>(name, token_param_name, package_.get()));
+      break;
+    }
+    case FunctionBaseTag::kBlock: {
+      Block* block =
+          package_->AddBlock(std::make_unique<Block>(name, package_.get()));
+      XLS_ASSIGN_OR_RETURN(uint64_t register_count, reader_.ReadVarint());
+      for (uint64_t i = 0; i < register_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(std::string_view register_name,
+                             reader_.ReadString());
+        XLS_ASSIGN_OR_RETURN(Type * type, ReadType());
+        XLS_ASSIGN_OR_RETURN(bool has_reset, reader_.ReadBool());
+        std::optional<Reset> reset;
+        if (has_reset) {
+          XLS_ASSIGN_OR_RETURN(Value reset_value, ReadValue());
+          XLS_ASSIGN_OR_RETURN(bool asynchronous, reader_.ReadBool());
+          XLS_ASSIGN_OR_RETURN(bool active_low, reader_.ReadBool());
+          reset = Reset{.reset_value = std::move(reset_value),
+                        .asynchronous = asynchronous,
+                        .active_low = active_low};
+        }
+        XLS_RETURN_IF_ERROR(
+            block->AddRegister(register_name, type, reset).status());
+      }
+      XLS_ASSIGN_OR_RETURN(uint64_t instantiation_count, reader_.ReadVarint());
+      for (uint64_t i = 0; i < instantiation_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(std::string_view instantiation_name,
+                             reader_.ReadString());
+        XLS_ASSIGN_OR_RETURN(
+            int64_t index,
+            reader_.ReadIndex(function_bases_.size(), "instantiated block"));
+        if (!function_bases_[index]->IsBlock()) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "`%s` is not a block", function_bases_[index]->name()));
+        }
+        XLS_RETURN_IF_ERROR(
+            block
+                ->AddBlockInstantiation(instantiation_name,
+                                        function_bases_[index]->AsBlockOrDie())
+                .status());
+      }
+      f = block;
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid function base tag %d in binary IR", tag));
+  }
+
+  XLS_ASSIGN_OR_RETURN(uint64_t node_count, reader_.ReadVarint());
+  nodes_.clear();
+  nodes_.reserve(node_count);
+  for (uint64_t i = 0; i < node_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(Node * node, ReadNode(f, init_values));
+    nodes_.push_back(node);
+  }
+
+  if (f->IsFunction()) {
+    XLS_ASSIGN_OR_RETURN(int64_t return_index,
+                         reader_.ReadIndex(nodes_.size() + 1, "return value"));
+    if (return_index > 0) {
+      XLS_RETURN_IF_ERROR(
+          f->AsFunctionOrDie()->set_return_value(nodes_[return_index - 1]));
+    }
+  } else if (f->IsProc()) {
+    Proc* proc = f->AsProcOrDie();
+    XLS_RET_CHECK_EQ(proc->GetStateElementCount(), init_values.size());
+    XLS_ASSIGN_OR_RETURN(int64_t next_token_index,
+                         reader_.ReadIndex(nodes_.size(), "next token"));
+    XLS_RETURN_IF_ERROR(proc->SetNextToken(nodes_[next_token_index]));
+    for (int64_t i = 0; i < init_values.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(int64_t next_state_index,
+                           reader_.ReadIndex(nodes_.size(), "next state"));
+      XLS_RETURN_IF_ERROR(
+          proc->SetNextStateElement(i, nodes_[next_state_index]));
+    }
+  } else {
+    Block* block = f->AsBlockOrDie();
+    XLS_ASSIGN_OR_RETURN(uint64_t port_count, reader_.ReadVarint());
+    std::vector<std::string> port_names;
+    for (uint64_t i = 0; i < port_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(uint64_t port_tag, reader_.ReadVarint());
+      XLS_ASSIGN_OR_RETURN(std::string_view port_name, reader_.ReadString());
+      if (static_cast<PortTag>(port_tag) == PortTag::kClock) {
+        XLS_RETURN_IF_ERROR(block->AddClockPort(port_name));
+      }
+      port_names.push_back(std::string(port_name));
+    }
+    XLS_RETURN_IF_ERROR(block->ReorderPorts(port_names));
+  }
+  function_bases_.push_back(f);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Node*> Deserializer::ReadNode(
+    FunctionBase* f, absl::Span<const Value> init_values) {
+  XLS_ASSIGN_OR_RETURN(uint64_t op_value, reader_.ReadVarint());
+  if (op_value >= kOpLimit) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid op %d in binary IR", op_value));
+  }
+  Op op = static_cast<Op>(op_value);
+  XLS_ASSIGN_OR_RETURN(uint64_t id, reader_.ReadVarint());
+  XLS_ASSIGN_OR_RETURN(std::string_view name, reader_.ReadString());
+  XLS_ASSIGN_OR_RETURN(SourceInfo loc, ReadSourceInfo());
+  XLS_ASSIGN_OR_RETURN(uint64_t operand_count, reader_.ReadVarint());
+  std::vector<Node*> operands;
+  operands.reserve(operand_count);
+  for (uint64_t i = 0; i < operand_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(int64_t index,
+                         reader_.ReadIndex(nodes_.size(), "operand"));
+    operands.push_back(nodes_[index]);
+  }
+  auto check_operand_count = [&](int64_t expected) -> absl::Status {
+    if (operands.size() != expected) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "%s node has %d operands in binary IR, expected %d", OpToString(op),
+          operands.size(), expected));
+    }
+    return absl::OkStatus();
+  };
+  auto check_min_operand_count = [&](int64_t expected) -> absl::Status {
+    if (operands.size() < expected) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "%s node has %d operands in binary IR, expected at least %d",
+          OpToString(op), operands.size(), expected));
+    }
+    return absl::OkStatus();
+  };
+  absl::Span<Node* const> operand_span = operands;
+
+  // Construct the node with the serialized id by setting the next id of the
+  // package. This avoids renumbering the node (and re-sorting the user lists
+  // of its operands) after construction. The next id is restored after
+  // deserialization.
+  package_->set_next_node_id(id);
+  max_node_id_ = std::max(max_node_id_, static_cast<int64_t>(id));
+
+  switch (op) {
+    case Op::kAdd:
+    case Op::kSDiv:
+    case Op::kSMod:
+    case Op::kShll:
+    case Op::kShrl:
+    case Op::kShra:
+    case Op::kSub:
+    case Op::kUDiv:
+    case Op::kUMod:
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      return f->MakeNodeWithName<BinOp>(loc, operands[0], operands[1], op,
+                                        name);
+    case Op::kAnd:
+    case Op::kNand:
+    case Op::kNor:
+    case Op::kOr:
+    case Op::kXor:
+      return f->MakeNodeWithName<NaryOp>(loc, operand_span, op, name);
+    case Op::kEq:
+    case Op::kNe:
+    case Op::kSGe:
+    case Op::kSGt:
+    case Op::kSLe:
+    case Op::kSLt:
+    case Op::kUGe:
+    case Op::kUGt:
+    case Op::kULe:
+    case Op::kULt:
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      return f->MakeNodeWithName<CompareOp>(loc, operands[0], operands[1], op,
+                                            name);
+    case Op::kIdentity:
+    case Op::kNeg:
+    case Op::kNot:
+    case Op::kReverse:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      return f->MakeNodeWithName<UnOp>(loc, operands[0], op, name);
+    case Op::kAndReduce:
+    case Op::kOrReduce:
+    case Op::kXorReduce:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      return f->MakeNodeWithName<BitwiseReductionOp>(loc, operands[0], op,
+                                                     name);
+    case Op::kSMul:
+    case Op::kUMul: {
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      XLS_ASSIGN_OR_RETURN(uint64_t width, reader_.ReadVarint());
+      return f->MakeNodeWithName<ArithOp>(loc, operands[0], operands[1], width,
+                                          op, name);
+    }
+    case Op::kSMulp:
+    case Op::kUMulp: {
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      XLS_ASSIGN_OR_RETURN(uint64_t width, reader_.ReadVarint());
+      return f->MakeNodeWithName<PartialProductOp>(loc, operands[0],
+                                                   operands[1], width, op,
+                                                   name);
+    }
+    case Op::kSignExt:
+    case Op::kZeroExt: {
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(uint64_t new_bit_count, reader_.ReadVarint());
+      return f->MakeNodeWithName<ExtendOp>(loc, operands[0], new_bit_count, op,
+                                           name);
+    }
+    case Op::kAfterAll:
+      return f->MakeNodeWithName<AfterAll>(loc, operand_span, name);
+    case Op::kArray: {
+      XLS_ASSIGN_OR_RETURN(Type * element_type, ReadType());
+      return f->MakeNodeWithName<Array>(loc, operand_span, element_type, name);
+    }
+    case Op::kArrayIndex:
+      XLS_RETURN_IF_ERROR(check_min_operand_count(1));
+      return f->MakeNodeWithName<ArrayIndex>(loc, operands[0],
+                                             operand_span.subspan(1), name);
+    case Op::kArraySlice: {
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      XLS_ASSIGN_OR_RETURN(uint64_t width, reader_.ReadVarint());
+      return f->MakeNodeWithName<ArraySlice>(loc, operands[0], operands[1],
+                                             width, name);
+    }
+    case Op::kArrayUpdate:
+      XLS_RETURN_IF_ERROR(check_min_operand_count(2));
+      return f->MakeNodeWithName<ArrayUpdate>(
+          loc, operands[0], operands[1], operand_span.subspan(2), name);
+    case Op::kArrayConcat:
+      return f->MakeNodeWithName<ArrayConcat>(loc, operand_span, name);
+    case Op::kAssert: {
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      XLS_ASSIGN_OR_RETURN(std::string_view message, reader_.ReadString());
+      XLS_ASSIGN_OR_RETURN(bool has_label, reader_.ReadBool());
+      std::optional<std::string> label;
+      if (has_label) {
+        XLS_ASSIGN_OR_RETURN(std::string_view label_view,
+                             reader_.ReadString());
+        label = std::string(label_view);
+      }
+      return f->MakeNodeWithName<Assert>(loc, operands[0], operands[1],
+                                         message, label, name);
+    }
+    case Op::kCover: {
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      XLS_ASSIGN_OR_RETURN(std::string_view label, reader_.ReadString());
+      return f->MakeNodeWithName<Cover>(loc, operands[0], operands[1], label,
+                                        name);
+    }
+    case Op::kTrace: {
+      XLS_RETURN_IF_ERROR(check_min_operand_count(2));
+      XLS_ASSIGN_OR_RETURN(uint64_t step_count, reader_.ReadVarint());
+      std::vector<FormatStep> format;
+      for (uint64_t i = 0; i < step_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(uint64_t step_tag, reader_.ReadVarint());
+        if (static_cast<FormatStepTag>(step_tag) == FormatStepTag::kText) {
+          XLS_ASSIGN_OR_RETURN(std::string_view text, reader_.ReadString());
+          format.push_back(std::string(text));
+        } else {
+          XLS_ASSIGN_OR_RETURN(uint64_t preference, reader_.ReadVarint());
+          XLS_RET_CHECK_LE(preference,
+                           static_cast<uint64_t>(FormatPreference::kPlainHex));
+          format.push_back(static_cast<FormatPreference>(preference));
+        }
+      }
+      return f->MakeNodeWithName<Trace>(loc, operands[0], operands[1],
+                                        operand_span.subspan(2), format, name);
+    }
+    case Op::kReceive: {
+      XLS_RETURN_IF_ERROR(check_min_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(uint64_t channel_id, reader_.ReadVarint());
+      XLS_ASSIGN_OR_RETURN(bool is_blocking, reader_.ReadBool());
+      if (!package_->HasChannelWithId(channel_id)) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("No such channel with channel ID %d", channel_id));
+      }
+      std::optional<Node*> predicate;
+      if (operands.size() > 1) {
+        predicate = operands[1];
+      }
+      return f->MakeNodeWithName<Receive>(loc, operands[0], predicate,
+                                          channel_id, is_blocking, name);
+    }
+    case Op::kSend: {
+      XLS_RETURN_IF_ERROR(check_min_operand_count(2));
+      XLS_ASSIGN_OR_RETURN(uint64_t channel_id, reader_.ReadVarint());
+      if (!package_->HasChannelWithId(channel_id)) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("No such channel with channel ID %d", channel_id));
+      }
+      std::optional<Node*> predicate;
+      if (operands.size() > 2) {
+        predicate = operands[2];
+      }
+      return f->MakeNodeWithName<Send>(loc, operands[0], operands[1],
+                                       predicate, channel_id, name);
+    }
+    case Op::kBitSlice: {
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(uint64_t start, reader_.ReadVarint());
+      XLS_ASSIGN_OR_RETURN(uint64_t width, reader_.ReadVarint());
+      return f->MakeNodeWithName<BitSlice>(loc, operands[0], start, width,
+                                           name);
+    }
+    case Op::kDynamicBitSlice: {
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      XLS_ASSIGN_OR_RETURN(uint64_t width, reader_.ReadVarint());
+      return f->MakeNodeWithName<DynamicBitSlice>(loc, operands[0],
+                                                  operands[1], width, name);
+    }
+    case Op::kBitSliceUpdate:
+      XLS_RETURN_IF_ERROR(check_operand_count(3));
+      return f->MakeNodeWithName<BitSliceUpdate>(loc, operands[0], operands[1],
+                                                 operands[2], name);
+    case Op::kConcat:
+      return f->MakeNodeWithName<Concat>(loc, operand_span, name);
+    case Op::kCountedFor: {
+      XLS_RETURN_IF_ERROR(check_min_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(int64_t trip_count, reader_.ReadSigned());
+      XLS_ASSIGN_OR_RETURN(int64_t stride, reader_.ReadSigned());
+      XLS_ASSIGN_OR_RETURN(Function * body, ReadFunctionRef());
+      return f->MakeNodeWithName<CountedFor>(loc, operands[0],
+                                             operand_span.subspan(1),
+                                             trip_count, stride, body, name);
+    }
+    case Op::kDynamicCountedFor: {
+      XLS_RETURN_IF_ERROR(check_min_operand_count(3));
+      XLS_ASSIGN_OR_RETURN(Function * body, ReadFunctionRef());
+      return f->MakeNodeWithName<DynamicCountedFor>(
+          loc, operands[0], operands[1], operands[2], operand_span.subspan(3),
+          body, name);
+    }
+    case Op::kInvoke: {
+      XLS_ASSIGN_OR_RETURN(Function * to_apply, ReadFunctionRef());
+      return f->MakeNodeWithName<Invoke>(loc, operand_span, to_apply, name);
+    }
+    case Op::kMap: {
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(Function * to_apply, ReadFunctionRef());
+      return f->MakeNodeWithName<Map>(loc, operands[0], to_apply, name);
+    }
+    case Op::kLiteral: {
+      XLS_RETURN_IF_ERROR(check_operand_count(0));
+      XLS_ASSIGN_OR_RETURN(Value value, ReadValue());
+      return f->MakeNodeWithName<Literal>(loc, std::move(value), name);
+    }
+    case Op::kOneHot: {
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(uint64_t priority, reader_.ReadVarint());
+      XLS_RET_CHECK_LE(priority, static_cast<uint64_t>(LsbOrMsb::kMsb));
+      return f->MakeNodeWithName<OneHot>(
+          loc, operands[0], static_cast<LsbOrMsb>(priority), name);
+    }
+    case Op::kOneHotSel:
+      XLS_RETURN_IF_ERROR(check_min_operand_count(1));
+      return f->MakeNodeWithName<OneHotSelect>(loc, operands[0],
+                                               operand_span.subspan(1), name);
+    case Op::kPrioritySel:
+      XLS_RETURN_IF_ERROR(check_min_operand_count(1));
+      return f->MakeNodeWithName<PrioritySelect>(
+          loc, operands[0], operand_span.subspan(1), name);
+    case Op::kSel: {
+      XLS_ASSIGN_OR_RETURN(bool has_default, reader_.ReadBool());
+      XLS_RETURN_IF_ERROR(check_min_operand_count(has_default ? 2 : 1));
+      std::optional<Node*> default_value;
+      absl::Span<Node* const> cases = operand_span.subspan(1);
+      if (has_default) {
+        default_value = operands.back();
+        cases.remove_suffix(1);
+      }
+      return f->MakeNodeWithName<Select>(loc, operands[0], cases,
+                                         default_value, name);
+    }
+    case Op::kTuple:
+      return f->MakeNodeWithName<Tuple>(loc, operand_span, name);
+    case Op::kTupleIndex: {
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(uint64_t index, reader_.ReadVarint());
+      return f->MakeNodeWithName<TupleIndex>(loc, operands[0], index, name);
+    }
+    case Op::kDecode: {
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(uint64_t width, reader_.ReadVarint());
+      return f->MakeNodeWithName<Decode>(loc, operands[0], width, name);
+    }
+    case Op::kEncode:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      return f->MakeNodeWithName<Encode>(loc, operands[0], name);
+    case Op::kGate:
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      return f->MakeNodeWithName<Gate>(loc, operands[0], operands[1], name);
+    case Op::kParam: {
+      XLS_RETURN_IF_ERROR(check_operand_count(0));
+      XLS_ASSIGN_OR_RETURN(Type * type, ReadType());
+      if (f->IsFunction()) {
+        return f->MakeNodeWithName<Param>(loc, name, type);
+      }
+      if (!f->IsProc()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Param `%s` in block `%s`", name, f->name()));
+      }
+      // The token parameter is created with the proc; state parameters are
+      // added along with their initial values.
+      Proc* proc = f->AsProcOrDie();
+      int64_t param_index = proc->params().size();
+      Node* param;
+      if (nodes_.empty()) {
+        param = proc->TokenParam();
+        param->SetId(id);
+      } else {
+        if (param_index > init_values.size()) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Proc `%s` has more state parameters than initial values",
+              f->name()));
+        }
+        XLS_ASSIGN_OR_RETURN(
+            param,
+            proc->AppendStateElement(name, init_values[param_index - 1]));
+      }
+      param->SetLoc(loc);
+      XLS_RET_CHECK_EQ(param->GetType(), type);
+      return param;
+    }
+    case Op::kInputPort: {
+      XLS_RETURN_IF_ERROR(check_operand_count(0));
+      XLS_ASSIGN_OR_RETURN(Type * type, ReadType());
+      if (!f->IsBlock()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "input_port `%s` outside of a block", name));
+      }
+      return f->AsBlockOrDie()->AddInputPort(name, type, loc);
+    }
+    case Op::kOutputPort:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      if (!f->IsBlock()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "output_port `%s` outside of a block", name));
+      }
+      return f->AsBlockOrDie()->AddOutputPort(name, operands[0], loc);
+    case Op::kRegisterRead:
+    case Op::kRegisterWrite: {
+      if (!f->IsBlock()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "%s `%s` outside of a block", OpToString(op), name));
+      }
+      absl::Span<Register* const> registers =
+          f->AsBlockOrDie()->GetRegisters();
+      XLS_ASSIGN_OR_RETURN(int64_t reg_index,
+                           reader_.ReadIndex(registers.size(), "register"));
+      if (op == Op::kRegisterRead) {
+        XLS_RETURN_IF_ERROR(check_operand_count(0));
+        return f->MakeNodeWithName<RegisterRead>(loc, registers[reg_index],
+                                                 name);
+      }
+      XLS_ASSIGN_OR_RETURN(bool has_load_enable, reader_.ReadBool());
+      XLS_ASSIGN_OR_RETURN(bool has_reset, reader_.ReadBool());
+      XLS_RETURN_IF_ERROR(
+          check_operand_count(1 + int64_t{has_load_enable} + has_reset));
+      std::optional<Node*> load_enable;
+      std::optional<Node*> reset;
+      if (has_load_enable) {
+        load_enable = operands[1];
+      }
+      if (has_reset) {
+        reset = operands.back();
+      }
+      return f->MakeNodeWithName<RegisterWrite>(
+          loc, operands[0], load_enable, reset, registers[reg_index], name);
+    }
+    case Op::kInstantiationInput:
+    case Op::kInstantiationOutput: {
+      if (!f->IsBlock()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "%s `%s` outside of a block", OpToString(op), name));
+      }
+      absl::Span<Instantiation* const> instantiations =
+          f->AsBlockOrDie()->GetInstantiations();
+      XLS_ASSIGN_OR_RETURN(
+          int64_t instantiation_index,
+          reader_.ReadIndex(instantiations.size(), "instantiation"));
+      XLS_ASSIGN_OR_RETURN(std::string_view port_name, reader_.ReadString());
+      if (op == Op::kInstantiationInput) {
+        XLS_RETURN_IF_ERROR(check_operand_count(1));
+        return f->MakeNodeWithName<InstantiationInput>(
+            loc, operands[0], instantiations[instantiation_index], port_name,
+            name);
+      }
+      XLS_RETURN_IF_ERROR(check_operand_count(0));
+      return f->MakeNodeWithName<InstantiationOutput>(
+          loc, instantiations[instantiation_index], port_name, name);
+    }
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Unsupported op %s in binary IR", OpToString(op)));
+}
+
+absl::StatusOr<std::unique_ptr<Package>> Deserializer::Deserialize() {
+  XLS_ASSIGN_OR_RETURN(std::string_view magic,
+                       reader_.ReadBytes(kBinaryIrMagic.size()));
+  if (magic != kBinaryIrMagic) {
+    return absl::InvalidArgumentError("Data is not binary IR");
+  }
+  XLS_ASSIGN_OR_RETURN(std::string_view package_name, reader_.ReadString());
+  package_ = std::make_unique<Package>(package_name);
+
+  XLS_ASSIGN_OR_RETURN(uint64_t fileno_count, reader_.ReadVarint());
+  for (uint64_t i = 0; i < fileno_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(int64_t fileno, reader_.ReadSigned());
+    XLS_ASSIGN_OR_RETURN(std::string_view filename, reader_.ReadString());
+    package_->SetFileno(Fileno(fileno), filename);
+  }
+  XLS_RETURN_IF_ERROR(ReadTypeTable());
+
+  XLS_ASSIGN_OR_RETURN(uint64_t channel_count, reader_.ReadVarint());
+  for (uint64_t i = 0; i < channel_count; ++i) {
+    XLS_RETURN_IF_ERROR(ReadChannel());
+  }
+  XLS_ASSIGN_OR_RETURN(uint64_t function_base_count, reader_.ReadVarint());
+  for (uint64_t i = 0; i < function_base_count; ++i) {
+    XLS_RETURN_IF_ERROR(ReadFunctionBase());
+  }
+  package_->set_next_node_id(max_node_id_ + 1);
+
+  XLS_ASSIGN_OR_RETURN(int64_t top_index,
+                       reader_.ReadIndex(function_bases_.size() + 1, "top"));
+  if (top_index > 0) {
+    XLS_RETURN_IF_ERROR(package_->SetTop(function_bases_[top_index - 1]));
+  }
+  if (!reader_.AtEnd()) {
+    return absl::InvalidArgumentError("Trailing data after binary IR");
+  }
+  return std::move(package_);
+}
+
+}  // namespace
+
+bool IsBinaryIr(std::string_view data) {
+  return absl::StartsWith(data, kBinaryIrMagic);
+}
+
+absl::StatusOr<std::string> SerializePackageToBinaryIr(Package* package) {
+  return Serializer(package).Serialize();
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryIrPackage(
+    std::string_view data) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Deserializer(data).Deserialize());
+  XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
+  return package;
+}
+
+absl::StatusOr<IrFormat> IrFormatFromString(std::string_view s) {
+  if (s == "text") {
+    return IrFormat::kText;
+  }
+  if (s == "binary") {
+    return IrFormat::kBinary;
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Invalid IR format `%s`, expected `text` or `binary`", s));
+}
+
+absl::StatusOr<std::string> DumpPackage(Package* package, IrFormat format) {
+  if (format == IrFormat::kBinary) {
+    return SerializePackageToBinaryIr(package);
+  }
+  return package->DumpIr();
+}
+
+}  // namespace xls
@@ -0,0 +1,66 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_IR_BINARY_IR_H_
+#define XLS_IR_BINARY_IR_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// A compact binary serialization of an IR package. Compared to the textual IR
+// (Package::DumpIr) the binary format avoids tokenizing and name resolution on
+// load: types are interned in a table, nodes of each function base are stored
+// in a table in operand-before-user order, operands are referred to by their
+// index in the table, and all integers are varint encoded.
+//
+// The format is not stable across XLS versions and is intended for passing
+// packages between tools in a single flow (e.g., ir_converter_main ->
+// opt_main -> codegen_main).
+
+// Prefix of every binary IR serialization. Textual IR cannot begin with a NUL
+// character so the prefix distinguishes the two formats.
+inline constexpr std::string_view kBinaryIrMagic("\0XLSIR\x01\n", 8);
+
+// Returns true if `data` starts with the binary IR prefix.
+bool IsBinaryIr(std::string_view data);
+
+// Serializes the given package to the binary IR format.
+absl::StatusOr<std::string> SerializePackageToBinaryIr(Package* package);
+
+// Deserializes a package from the binary IR format and verifies it.
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryIrPackage(
+    std::string_view data);
+
+// The formats in which tools can write packages.
+enum class IrFormat {
+  kText,
+  kBinary,
+};
+
+// Returns the format for the given flag value: "text" or "binary".
+absl::StatusOr<IrFormat> IrFormatFromString(std::string_view s);
+
+// Serializes the given package in the given format.
+absl::StatusOr<std::string> DumpPackage(Package* package, IrFormat format);
+
+}  // namespace xls
+
+#endif  // XLS_IR_BINARY_IR_H_
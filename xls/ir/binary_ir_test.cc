@@ -0,0 +1,150 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/ir/binary_ir.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using testing::HasSubstr;
+
+class BinaryIrTest : public IrTestBase {
+ protected:
+  // Parses the given text IR, round trips it through the binary format and
+  // checks that the result dumps identically to the original.
+  void RoundTripAndCheckDump(std::string_view text) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             Parser::ParsePackage(text));
+    XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                             SerializePackageToBinaryIr(package.get()));
+    EXPECT_TRUE(IsBinaryIr(binary));
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> round_tripped,
+                             ParseBinaryIrPackage(binary));
+    EXPECT_EQ(round_tripped->DumpIr(), package->DumpIr());
+    EXPECT_EQ(round_tripped->next_node_id(), package->next_node_id());
+
+    // The parser accepts the binary format as well.
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> parsed,
+                             Parser::ParsePackage(binary));
+    EXPECT_EQ(parsed->DumpIr(), package->DumpIr());
+  }
+};
+
+TEST_F(BinaryIrTest, RoundTripFunctions) {
+  RoundTripAndCheckDump(R"(package test
+
+file_number 0 "foo.x"
+file_number 2 "bar.x"
+
+fn body(i: bits[4], acc: (bits[32], bits[8][2])) -> (bits[32], bits[8][2]) {
+  tuple_index.3: bits[32] = tuple_index(acc, index=0, id=3, pos=[(0,1,2), (2,3,4)])
+  zero_ext.4: bits[32] = zero_ext(i, new_bit_count=32, id=4)
+  add.5: bits[32] = add(tuple_index.3, zero_ext.4, id=5)
+  tuple_index.6: bits[8][2] = tuple_index(acc, index=1, id=6)
+  ret tuple.7: (bits[32], bits[8][2]) = tuple(add.5, tuple_index.6, id=7)
+}
+
+top fn main(x: bits[32], y: bits[8], s: bits[2], p: bits[1]) -> bits[32] {
+  lit: (bits[32], bits[8][2]) = literal(value=(0, [1, 2]), id=10)
+  counted_for.11: (bits[32], bits[8][2]) = counted_for(lit, trip_count=4, stride=2, body=body, id=11)
+  result: bits[32] = tuple_index(counted_for.11, index=0, id=12)
+  bit_slice.13: bits[4] = bit_slice(x, start=3, width=4, id=13)
+  sel.14: bits[32] = sel(s, cases=[x, result], default=x, id=14)
+  umul.15: bits[16] = umul(y, y, id=15)
+  after_all.16: token = after_all(id=16)
+  trace.17: token = trace(after_all.16, p, format="x is {:x}", data_operands=[x], id=17)
+  ret xor.18: bits[32] = xor(sel.14, result, x, id=18)
+}
+)");
+}
+
+TEST_F(BinaryIrTest, RoundTripProc) {
+  RoundTripAndCheckDump(R"(package test
+
+chan ch(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=ready_valid, fifo_depth=3, metadata="""""")
+
+proc my_proc(my_token: token, my_state: bits[32], other: (), init={42, ()}) {
+  send.1: token = send(my_token, my_state, channel_id=0, id=1)
+  literal.2: bits[1] = literal(value=1, id=2)
+  receive.3: (token, bits[32]) = receive(send.1, predicate=literal.2, channel_id=0, id=3)
+  tuple_index.4: token = tuple_index(receive.3, index=0, id=4)
+  next (tuple_index.4, my_state, other)
+}
+)");
+}
+
+TEST_F(BinaryIrTest, RoundTripBlocks) {
+  RoundTripAndCheckDump(R"(package test
+
+block sub_block(in: bits[32], out: bits[32]) {
+  in: bits[32] = input_port(name=in, id=1)
+  out: () = output_port(in, name=out, id=2)
+}
+
+block my_block(clk: clock, rst: bits[1], x: bits[32], y: bits[32]) {
+  reg foo(bits[32], reset_value=42, asynchronous=true, active_low=false)
+  instantiation inst(block=sub_block, kind=block)
+  rst: bits[1] = input_port(name=rst, id=3)
+  x: bits[32] = input_port(name=x, id=4)
+  foo_d: () = register_write(x, register=foo, reset=rst, id=5)
+  foo_q: bits[32] = register_read(register=foo, id=6)
+  inst_in: () = instantiation_input(foo_q, instantiation=inst, port_name=in, id=7)
+  inst_out: bits[32] = instantiation_output(instantiation=inst, port_name=out, id=8)
+  y: () = output_port(inst_out, name=y, id=9)
+}
+)");
+}
+
+TEST_F(BinaryIrTest, IrFormatFromString) {
+  EXPECT_THAT(IrFormatFromString("text"), IsOkAndHolds(IrFormat::kText));
+  EXPECT_THAT(IrFormatFromString("binary"), IsOkAndHolds(IrFormat::kBinary));
+  EXPECT_THAT(IrFormatFromString("proto"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid IR format")));
+}
+
+TEST_F(BinaryIrTest, TruncatedData) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(package test
+
+fn f(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x, id=2)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinaryIr(package.get()));
+  EXPECT_THAT(ParseBinaryIrPackage(binary.substr(0, binary.size() - 4)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("truncated")));
+  EXPECT_THAT(ParseBinaryIrPackage("package test"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not binary IR")));
+}
+
+}  // namespace
+}  // namespace xls
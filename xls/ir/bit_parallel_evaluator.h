@@ -0,0 +1,132 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_BIT_PARALLEL_EVALUATOR_H_
+#define XLS_IR_BIT_PARALLEL_EVALUATOR_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/abstract_evaluator.h"
+#include "xls/ir/bits.h"
+
+namespace xls {
+
+// A bit-sliced boolean value holding 64 independent lanes. Lane i holds the
+// value of the bit in the i-th of up to 64 independent evaluations so each
+// logical operation evaluates all lanes at once with a single word operation.
+//
+// The value defines the operators &, |, ^ and ! (lane-wise negation) so it can
+// be used as the value type of netlist::AbstractInterpreter to simulate 64
+// input vectors at once.
+class BitParallelValue {
+ public:
+  static constexpr int64_t kLaneCount = 64;
+
+  BitParallelValue() : lanes_(0) {}
+
+  // Returns a value with the given lanes.
+  static BitParallelValue FromLanes(uint64_t lanes) {
+    return BitParallelValue(lanes);
+  }
+
+  // Returns a value with every lane set to `value`.
+  static BitParallelValue Broadcast(bool value) {
+    return BitParallelValue(value ? ~uint64_t{0} : 0);
+  }
+
+  uint64_t lanes() const { return lanes_; }
+  bool lane(int64_t i) const {
+    XLS_DCHECK_LT(i, kLaneCount);
+    return (lanes_ >> i) & 1;
+  }
+  void set_lane(int64_t i, bool value) {
+    XLS_DCHECK_LT(i, kLaneCount);
+    lanes_ = (lanes_ & ~(uint64_t{1} << i)) | (uint64_t{value} << i);
+  }
+
+  BitParallelValue operator&(const BitParallelValue& other) const {
+    return BitParallelValue(lanes_ & other.lanes_);
+  }
+  BitParallelValue operator|(const BitParallelValue& other) const {
+    return BitParallelValue(lanes_ | other.lanes_);
+  }
+  BitParallelValue operator^(const BitParallelValue& other) const {
+    return BitParallelValue(lanes_ ^ other.lanes_);
+  }
+  BitParallelValue operator!() const { return BitParallelValue(~lanes_); }
+
+  bool operator==(const BitParallelValue& other) const {
+    return lanes_ == other.lanes_;
+  }
+  bool operator!=(const BitParallelValue& other) const {
+    return lanes_ != other.lanes_;
+  }
+
+ private:
+  explicit BitParallelValue(uint64_t lanes) : lanes_(lanes) {}
+
+  uint64_t lanes_;
+};
+
+// An evaluator which evaluates all XLS operations supported by
+// AbstractEvaluator over 64 sets of Bits values at once.
+class BitParallelEvaluator
+    : public AbstractEvaluator<BitParallelValue, BitParallelEvaluator> {
+ public:
+  BitParallelValue One() const { return BitParallelValue::Broadcast(true); }
+
+  BitParallelValue Zero() const { return BitParallelValue::Broadcast(false); }
+
+  BitParallelValue Not(const BitParallelValue& input) const { return !input; }
+
+  BitParallelValue And(const BitParallelValue& a,
+                       const BitParallelValue& b) const {
+    return a & b;
+  }
+
+  BitParallelValue Or(const BitParallelValue& a,
+                      const BitParallelValue& b) const {
+    return a | b;
+  }
+
+  // Returns a vector with value `values[i]` in lane i. At most kLaneCount
+  // values of identical width may be given. Unused lanes are zero.
+  Vector Pack(absl::Span<const Bits> values) const {
+    XLS_CHECK(!values.empty());
+    XLS_CHECK_LE(values.size(), BitParallelValue::kLaneCount);
+    Vector result(values.front().bit_count());
+    for (int64_t lane = 0; lane < values.size(); ++lane) {
+      XLS_CHECK_EQ(values[lane].bit_count(), result.size());
+      for (int64_t i = 0; i < result.size(); ++i) {
+        result[i].set_lane(lane, values[lane].Get(i));
+      }
+    }
+    return result;
+  }
+
+  // Returns the value held in the given lane of `vector`.
+  Bits Unpack(const Vector& vector, int64_t lane) const {
+    BitsRope rope(vector.size());
+    for (const BitParallelValue& bit : vector) {
+      rope.push_back(bit.lane(lane));
+    }
+    return rope.Build();
+  }
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_BIT_PARALLEL_EVALUATOR_H_
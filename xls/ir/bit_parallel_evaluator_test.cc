@@ -0,0 +1,109 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/bit_parallel_evaluator.h"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+
+namespace xls {
+namespace {
+
+class BitParallelEvaluatorTest : public ::testing::Test {
+ protected:
+  // Returns `kLaneCount` random values of the given width.
+  std::vector<Bits> RandomValues(int64_t width) {
+    std::vector<Bits> values;
+    for (int64_t i = 0; i < BitParallelValue::kLaneCount; ++i) {
+      values.push_back(
+          UBits(engine_() & ((uint64_t{1} << width) - 1), width));
+    }
+    return values;
+  }
+
+  std::mt19937_64 engine_;
+  BitParallelEvaluator evaluator_;
+};
+
+TEST_F(BitParallelEvaluatorTest, PackAndUnpack) {
+  std::vector<Bits> values = RandomValues(13);
+  BitParallelEvaluator::Vector packed = evaluator_.Pack(values);
+  ASSERT_EQ(packed.size(), 13);
+  for (int64_t lane = 0; lane < values.size(); ++lane) {
+    EXPECT_EQ(evaluator_.Unpack(packed, lane), values[lane]);
+  }
+
+  // Unused lanes are zero.
+  BitParallelEvaluator::Vector partial =
+      evaluator_.Pack({UBits(0b101, 3), UBits(0b011, 3)});
+  EXPECT_EQ(evaluator_.Unpack(partial, 0), UBits(0b101, 3));
+  EXPECT_EQ(evaluator_.Unpack(partial, 1), UBits(0b011, 3));
+  EXPECT_EQ(evaluator_.Unpack(partial, 2), UBits(0, 3));
+}
+
+TEST_F(BitParallelEvaluatorTest, LaneOperations) {
+  BitParallelValue a = BitParallelValue::FromLanes(0b1100);
+  BitParallelValue b = BitParallelValue::FromLanes(0b1010);
+  EXPECT_EQ((a & b).lanes(), 0b1000);
+  EXPECT_EQ((a | b).lanes(), 0b1110);
+  EXPECT_EQ((a ^ b).lanes(), 0b0110);
+  EXPECT_EQ((!a).lanes(), ~uint64_t{0b1100});
+  EXPECT_EQ(BitParallelValue::Broadcast(true).lanes(), ~uint64_t{0});
+  EXPECT_EQ(BitParallelValue::Broadcast(false).lanes(), 0);
+  a.set_lane(63, true);
+  EXPECT_TRUE(a.lane(63));
+  a.set_lane(2, false);
+  EXPECT_FALSE(a.lane(2));
+  EXPECT_EQ(a.lanes(), (uint64_t{1} << 63) | 0b1000);
+}
+
+TEST_F(BitParallelEvaluatorTest, MatchesScalarEvaluation) {
+  for (int64_t width : {1, 5, 16}) {
+    std::vector<Bits> a_values = RandomValues(width);
+    std::vector<Bits> b_values = RandomValues(width);
+    std::vector<Bits> s_values = RandomValues(1);
+    BitParallelEvaluator::Vector a = evaluator_.Pack(a_values);
+    BitParallelEvaluator::Vector b = evaluator_.Pack(b_values);
+    BitParallelEvaluator::Vector s = evaluator_.Pack(s_values);
+
+    BitParallelEvaluator::Vector sum = evaluator_.Add(a, b);
+    BitParallelEvaluator::Vector product = evaluator_.UMul(a, b);
+    BitParallelEvaluator::Vector bitwise_xor = evaluator_.BitwiseXor(a, b);
+    BitParallelEvaluator::Vector less_than = {evaluator_.ULessThan(a, b)};
+    BitParallelEvaluator::Vector equals = {evaluator_.Equals(a, a)};
+    BitParallelEvaluator::Vector select =
+        evaluator_.Select(s, {a, b}, /*default_value=*/std::nullopt);
+    for (int64_t lane = 0; lane < BitParallelValue::kLaneCount; ++lane) {
+      const Bits& a_value = a_values[lane];
+      const Bits& b_value = b_values[lane];
+      EXPECT_EQ(evaluator_.Unpack(sum, lane), bits_ops::Add(a_value, b_value));
+      EXPECT_EQ(evaluator_.Unpack(product, lane),
+                bits_ops::UMul(a_value, b_value));
+      EXPECT_EQ(evaluator_.Unpack(bitwise_xor, lane),
+                bits_ops::Xor(a_value, b_value));
+      EXPECT_EQ(evaluator_.Unpack(less_than, lane),
+                UBits(bits_ops::ULessThan(a_value, b_value), 1));
+      EXPECT_EQ(evaluator_.Unpack(equals, lane), UBits(1, 1));
+      EXPECT_EQ(evaluator_.Unpack(select, lane),
+                s_values[lane].IsZero() ? a_value : b_value);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls
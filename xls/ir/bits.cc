@@ -106,51 +106,17 @@ Bits Bits::PowerOfTwo(int64_t set_bit_index, int64_t bit_count) {
 
 bool Bits::IsOne() const { return PopCount() == 1 && Get(0); }
 
-int64_t Bits::PopCount() const {
-  int64_t count = 0;
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(i)) {
-      ++count;
-    }
-  }
-  return count;
-}
+int64_t Bits::PopCount() const { return bitmap_.PopCount(); }
 
-int64_t Bits::CountLeadingZeros() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(bit_count() - 1 - i)) {
-      return i;
-    }
-  }
-  return bit_count();
-}
+int64_t Bits::CountLeadingZeros() const { return bitmap_.CountLeadingZeros(); }
 
-int64_t Bits::CountLeadingOnes() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (!Get(bit_count() - 1 - i)) {
-      return i;
-    }
-  }
-  return bit_count();
-}
+int64_t Bits::CountLeadingOnes() const { return bitmap_.CountLeadingOnes(); }
 
 int64_t Bits::CountTrailingZeros() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(i)) {
-      return i;
-    }
-  }
-  return bit_count();
+  return bitmap_.CountTrailingZeros();
 }
 
-int64_t Bits::CountTrailingOnes() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (!Get(i)) {
-      return i;
-    }
-  }
-  return bit_count();
-}
+int64_t Bits::CountTrailingOnes() const { return bitmap_.CountTrailingOnes(); }
 
 bool Bits::HasSingleRunOfSetBits(int64_t* leading_zero_count,
                                  int64_t* set_bit_count,
@@ -163,10 +129,10 @@ bool Bits::HasSingleRunOfSetBits(int64_t* leading_zero_count,
     XLS_CHECK_EQ(leading_zeros, bit_count());
     return false;
   }
-  for (int64_t i = trailing_zeros; i < bit_count() - leading_zeros; ++i) {
-    if (Get(i) != 1) {
-      return false;
-    }
+  // The run is contiguous iff every bit between the leading and trailing zeros
+  // is set.
+  if (PopCount() != bit_count() - leading_zeros - trailing_zeros) {
+    return false;
   }
   *leading_zero_count = leading_zeros;
   *trailing_zero_count = trailing_zeros;
@@ -181,12 +147,7 @@ bool Bits::FitsInInt64() const { return FitsInNBitsSigned(64); }
 
 bool Bits::FitsInNBitsUnsigned(int64_t n) const {
   // All bits at and above bit 'n' must be zero.
-  for (int64_t i = n; i < bit_count(); ++i) {
-    if (Get(i)) {
-      return false;
-    }
-  }
-  return true;
+  return n >= bit_count() || CountLeadingZeros() >= bit_count() - n;
 }
 
 bool Bits::FitsInNBitsSigned(int64_t n) const {
@@ -195,12 +156,11 @@ bool Bits::FitsInNBitsSigned(int64_t n) const {
   }
 
   // All bits at and above bit N-1 must be the same.
-  for (int64_t i = n - 1; i < bit_count(); ++i) {
-    if (Get(i) != msb()) {
-      return false;
-    }
+  if (n >= bit_count()) {
+    return true;
   }
-  return true;
+  int64_t sign_run = msb() ? CountLeadingOnes() : CountLeadingZeros();
+  return sign_run >= bit_count() - n + 1;
 }
 
 absl::StatusOr<uint64_t> Bits::ToUint64() const {
@@ -245,11 +205,8 @@ Bits Bits::Slice(int64_t start, int64_t width) const {
   XLS_CHECK_LE(start + width, bit_count())
       << "start: " << start << " width: " << width;
   Bits result(width);
-  for (int64_t i = 0; i < width; ++i) {
-    if (Get(start + i)) {
-      result.bitmap_.Set(i, true);
-    }
-  }
+  result.bitmap_.Overwrite(bitmap_, /*src_start=*/start, /*dst_start=*/0,
+                           width);
   return result;
 }
 
@@ -335,8 +292,7 @@ std::string Bits::ToRawDigits(FormatPreference preference,
     // Slice out a Bits which contains 1 digit.
     int64_t start = digit_no * digit_width;
     int64_t width = std::min(digit_width, bit_count() - start);
-    // As single digit necessarily fits in a uint64_t, so the value() is safe.
-    uint64_t digit_value = Slice(start, width).ToUint64().value();
+    uint64_t digit_value = bitmap_.GetBits(start, width);
     if (digit_value == 0 && eliding_leading_zeros && digit_no != 0) {
       continue;
     }
@@ -261,7 +261,7 @@ class Bits {
   friend absl::StatusOr<Bits> UBitsWithStatus(uint64_t, int64_t);
   friend absl::StatusOr<Bits> SBitsWithStatus(int64_t, int64_t);
 
-  explicit Bits(InlineBitmap&& bitmap) : bitmap_(bitmap) {}
+  explicit Bits(InlineBitmap&& bitmap) : bitmap_(std::move(bitmap)) {}
 
   InlineBitmap bitmap_;
 };
@@ -286,9 +286,8 @@ class BitsRope {
   //
   // So b.Get(0) is now at result.Get(2).
   void push_back(const Bits& bits) {
-    for (int64_t i = 0; i < bits.bit_count(); ++i) {
-      bitmap_.Set(index_ + i, bits.Get(i));
-    }
+    bitmap_.Overwrite(bits.bitmap_, /*src_start=*/0, /*dst_start=*/index_,
+                      bits.bit_count());
     index_ += bits.bit_count();
   }
 
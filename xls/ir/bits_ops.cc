@@ -35,6 +35,30 @@ Bits TruncateOrSignExtend(const Bits& bits, int64_t bit_count) {
   }
 }
 
+// Returns lhs + rhs (or lhs - rhs if `invert_rhs` is true, computed as
+// lhs + ~rhs + 1) truncated to the common bit count. Operates on 64-bit words,
+// propagating the carry between words.
+Bits AddWithCarry(const Bits& lhs, const Bits& rhs, bool invert_rhs) {
+  const InlineBitmap& lhs_bitmap = lhs.bitmap();
+  const InlineBitmap& rhs_bitmap = rhs.bitmap();
+  InlineBitmap result(lhs.bit_count());
+  uint64_t carry = invert_rhs ? 1 : 0;
+  for (int64_t wordno = 0; wordno < result.word_count(); ++wordno) {
+    uint64_t a = lhs_bitmap.GetWord(wordno);
+    uint64_t b = rhs_bitmap.GetWord(wordno);
+    if (invert_rhs) {
+      b = ~b;
+    }
+    uint64_t sum = a + b;
+    uint64_t carry_out = sum < a ? 1 : 0;
+    sum += carry;
+    carry_out |= (sum < carry) ? 1 : 0;
+    result.SetWord(wordno, sum);
+    carry = carry_out;
+  }
+  return Bits::FromBitmap(std::move(result));
+}
+
 }  // namespace
 
 Bits And(const Bits& lhs, const Bits& rhs) {
@@ -43,12 +67,9 @@ Bits And(const Bits& lhs, const Bits& rhs) {
     return UBits(lhs.ToUint64().value() & rhs.ToUint64().value(),
                  lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] & rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  InlineBitmap result = lhs.bitmap();
+  result.Intersect(rhs.bitmap());
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits NaryAnd(absl::Span<const Bits> operands) {
@@ -67,12 +88,9 @@ Bits Or(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int | rhs_int);
     return UBits(result, lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] | rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  InlineBitmap result = lhs.bitmap();
+  result.Union(rhs.bitmap());
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits NaryOr(absl::Span<const Bits> operands) {
@@ -91,12 +109,9 @@ Bits Xor(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int ^ rhs_int);
     return UBits(result, lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] ^ rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  InlineBitmap result = lhs.bitmap();
+  result.Xor(rhs.bitmap());
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits NaryXor(absl::Span<const Bits> operands) {
@@ -114,12 +129,10 @@ Bits Nand(const Bits& lhs, const Bits& rhs) {
                      Mask(lhs.bit_count()),
                  lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] & rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  InlineBitmap result = lhs.bitmap();
+  result.Intersect(rhs.bitmap());
+  result.Invert();
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits NaryNand(absl::Span<const Bits> operands) {
@@ -137,12 +150,10 @@ Bits Nor(const Bits& lhs, const Bits& rhs) {
                      Mask(lhs.bit_count()),
                  lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] | rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  InlineBitmap result = lhs.bitmap();
+  result.Union(rhs.bitmap());
+  result.Invert();
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits NaryNor(absl::Span<const Bits> operands) {
@@ -158,11 +169,9 @@ Bits Not(const Bits& bits) {
     return UBits((~bits.ToUint64().value()) & Mask(bits.bit_count()),
                  bits.bit_count());
   }
-  std::vector<uint8_t> bytes = bits.ToBytes();
-  for (uint8_t& byte : bytes) {
-    byte = ~byte;
-  }
-  return Bits::FromBytes(bytes, bits.bit_count());
+  InlineBitmap result = bits.bitmap();
+  result.Invert();
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits AndReduce(const Bits& operand) {
@@ -189,9 +198,7 @@ Bits Add(const Bits& lhs, const Bits& rhs) {
     return UBits(result, lhs.bit_count());
   }
 
-  Bits sum = BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                 .ToSignedBits();
-  return TruncateOrSignExtend(sum, lhs.bit_count());
+  return AddWithCarry(lhs, rhs, /*invert_rhs=*/false);
 }
 
 Bits Sub(const Bits& lhs, const Bits& rhs) {
@@ -202,9 +209,7 @@ Bits Sub(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int - rhs_int) & Mask(lhs.bit_count());
     return UBits(result, lhs.bit_count());
   }
-  Bits diff = BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                  .ToSignedBits();
-  return TruncateOrSignExtend(diff, lhs.bit_count());
+  return AddWithCarry(lhs, rhs, /*invert_rhs=*/true);
 }
 
 Bits Mul(const Bits& lhs, const Bits& rhs) {
@@ -434,23 +439,28 @@ Bits Abs(const Bits& bits) {
 Bits ShiftLeftLogical(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.Slice(0, bits.bit_count() - shift_amount), UBits(0, shift_amount)});
+  InlineBitmap result(bits.bit_count());
+  result.Overwrite(bits.bitmap(), /*src_start=*/0, /*dst_start=*/shift_amount,
+                   bits.bit_count() - shift_amount);
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits ShiftRightLogical(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat({UBits(0, shift_amount),
-                 bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  InlineBitmap result(bits.bit_count());
+  result.Overwrite(bits.bitmap(), /*src_start=*/shift_amount, /*dst_start=*/0,
+                   bits.bit_count() - shift_amount);
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits ShiftRightArith(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.msb() ? Bits::AllOnes(shift_amount) : UBits(0, shift_amount),
-       bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  InlineBitmap result(bits.bit_count(), /*fill=*/bits.msb());
+  result.Overwrite(bits.bitmap(), /*src_start=*/shift_amount, /*dst_start=*/0,
+                   bits.bit_count() - shift_amount);
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits OneHotLsbToMsb(const Bits& bits) {
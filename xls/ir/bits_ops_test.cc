@@ -162,6 +162,65 @@ TEST(BitsOpsTest, Sub) {
   }
 }
 
+TEST(BitsOpsTest, WideCarryPropagation) {
+  Bits all_ones = Bits::AllOnes(256);
+  EXPECT_EQ(bits_ops::Add(all_ones, UBits(1, 256)), Bits(256));
+  EXPECT_EQ(bits_ops::Sub(Bits(256), UBits(1, 256)), all_ones);
+  EXPECT_EQ(bits_ops::Add(Bits::AllOnes(192).Slice(0, 130), UBits(1, 130)),
+            Bits(130));
+  EXPECT_EQ(bits_ops::Add(bits_ops::ZeroExtend(Bits::AllOnes(128), 200),
+                          UBits(1, 200)),
+            Bits::PowerOfTwo(128, 200));
+  EXPECT_EQ(bits_ops::Sub(Bits::PowerOfTwo(128, 200), UBits(1, 200)),
+            bits_ops::ZeroExtend(Bits::AllOnes(128), 200));
+
+  Bits primes = PrimeBits(333);
+  EXPECT_EQ(bits_ops::Sub(bits_ops::Add(primes, all_ones.Slice(0, 333)),
+                          all_ones.Slice(0, 333)),
+            primes);
+}
+
+TEST(BitsOpsTest, WideShifts) {
+  // Reference implementations built from slices and concatenation.
+  auto shift_left = [](const Bits& bits, int64_t amount) {
+    return bits_ops::Concat(
+        {bits.Slice(0, bits.bit_count() - amount), Bits(amount)});
+  };
+  auto shift_right = [](const Bits& bits, int64_t amount, bool arith) {
+    Bits fill = arith && bits.msb() ? Bits::AllOnes(amount) : Bits(amount);
+    return bits_ops::Concat(
+        {fill, bits.Slice(amount, bits.bit_count() - amount)});
+  };
+
+  for (const Bits& bits : {PrimeBits(200), bits_ops::Not(PrimeBits(200))}) {
+    for (int64_t shift : {0, 1, 63, 64, 65, 130, 199, 200, 250}) {
+      int64_t amount = std::min(shift, bits.bit_count());
+      EXPECT_EQ(bits_ops::ShiftLeftLogical(bits, shift),
+                shift_left(bits, amount));
+      EXPECT_EQ(bits_ops::ShiftRightLogical(bits, shift),
+                shift_right(bits, amount, /*arith=*/false));
+      EXPECT_EQ(bits_ops::ShiftRightArith(bits, shift),
+                shift_right(bits, amount, /*arith=*/true));
+    }
+  }
+}
+
+TEST(BitsOpsTest, WideCounts) {
+  Bits primes = PrimeBits(300);
+  int64_t expected_pop_count = 0;
+  for (int64_t i = 0; i < primes.bit_count(); ++i) {
+    expected_pop_count += primes.Get(i) ? 1 : 0;
+  }
+  EXPECT_EQ(primes.PopCount(), expected_pop_count);
+  EXPECT_EQ(bits_ops::XorReduce(primes), UBits(expected_pop_count % 2, 1));
+  EXPECT_EQ(primes.CountTrailingZeros(), 2);
+  EXPECT_EQ(bits_ops::Not(primes).CountTrailingOnes(), 2);
+  EXPECT_TRUE(bits_ops::ZeroExtend(UBits(5, 8), 300).FitsInNBitsUnsigned(3));
+  EXPECT_FALSE(bits_ops::ZeroExtend(UBits(5, 8), 300).FitsInNBitsUnsigned(2));
+  EXPECT_TRUE(bits_ops::SignExtend(SBits(-5, 8), 300).FitsInNBitsSigned(4));
+  EXPECT_FALSE(bits_ops::SignExtend(SBits(-5, 8), 300).FitsInNBitsSigned(3));
+}
+
 TEST(BitsOpsTest, UMul) {
   EXPECT_EQ(bits_ops::UMul(Bits(), Bits()), Bits());
   EXPECT_EQ(bits_ops::UMul(UBits(100, 24), UBits(55, 22)), UBits(5500, 46));
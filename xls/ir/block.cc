@@ -426,8 +426,8 @@ static absl::Status AddToMapOfNodeVectors(
   return absl::OkStatus();
 }
 
-Node* Block::AddNodeInternal(std::unique_ptr<Node> node) {
-  Node* ptr = FunctionBase::AddNodeInternal(std::move(node));
+Node* Block::AddNodeInternal(Node* node) {
+  Node* ptr = FunctionBase::AddNodeInternal(node);
   if (RegisterRead* reg_read = dynamic_cast<RegisterRead*>(ptr)) {
     XLS_CHECK_OK(AddToMapOfNodeVectors(reg_read->GetRegister(), reg_read,
                                        &register_reads_));
@@ -175,7 +175,7 @@ class Block : public FunctionBase {
   // by a node in the hard-constraint-naming category.
   absl::Status SetPortNameExactly(std::string_view name, Node* port_node);
 
-  Node* AddNodeInternal(std::unique_ptr<Node> node) override;
+  Node* AddNodeInternal(Node* node) override;
 
   // Returns the order of emission of block nodes in the text IR
   // (Block::DumpIR() output). The order is a topological sort with additional
@@ -0,0 +1,63 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_CHANGE_LISTENER_H_
+#define XLS_IR_CHANGE_LISTENER_H_
+
+namespace xls {
+
+class FunctionBase;
+class Node;
+
+// Interface for objects which observe structural changes to the nodes of a
+// FunctionBase, for example to incrementally maintain an analysis. Listeners
+// are registered with FunctionBase::RegisterChangeListener. The listener must
+// outlive its registration; it is unregistered automatically when the
+// function base is destroyed.
+//
+// Notifications are only delivered for nodes which have been added to the
+// function base: the operands a node is constructed with are not reported as
+// operand changes, the node is reported by NodeAdded once it is added. A
+// listener must not register or unregister listeners of the same function
+// base from within a notification other than FunctionBaseDeleted. When no
+// listener is registered the cost of a modification is unchanged but for a
+// check of an empty list.
+class ChangeListener {
+ public:
+  virtual ~ChangeListener() = default;
+
+  // Called after `node` is added to the function base.
+  virtual void NodeAdded(Node* node) {}
+
+  // Called immediately before `node` is removed from the function base and
+  // destroyed.
+  virtual void NodeDeleted(Node* node) {}
+
+  // Called after one or more operands of `node` are replaced.
+  virtual void OperandChanged(Node* node) {}
+
+  // Called after `node` loses a use: a user is removed or stops using it, or
+  // it stops being an implicit use of the function base (for example, the
+  // return value of a function or the next state of a proc). May be called
+  // spuriously.
+  virtual void UseRemoved(Node* node) {}
+
+  // Called when `function_base` is being destroyed. No further notifications
+  // are delivered to the listener after this one.
+  virtual void FunctionBaseDeleted(FunctionBase* function_base) {}
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_CHANGE_LISTENER_H_
@@ -0,0 +1,148 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/change_listener.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Records the notifications it receives as strings.
+class RecordingListener : public ChangeListener {
+ public:
+  explicit RecordingListener(FunctionBase* f) : f_(f) {
+    f_->RegisterChangeListener(this);
+  }
+  ~RecordingListener() override {
+    if (f_ != nullptr) {
+      f_->UnregisterChangeListener(this);
+    }
+  }
+
+  std::vector<std::string> TakeEvents() {
+    std::vector<std::string> events;
+    std::swap(events, events_);
+    return events;
+  }
+
+  void NodeAdded(Node* node) override {
+    events_.push_back(absl::StrCat("added ", node->GetName()));
+  }
+  void NodeDeleted(Node* node) override {
+    events_.push_back(absl::StrCat("deleted ", node->GetName()));
+  }
+  void OperandChanged(Node* node) override {
+    events_.push_back(absl::StrCat("operand_changed ", node->GetName()));
+  }
+  void UseRemoved(Node* node) override {
+    events_.push_back(absl::StrCat("use_removed ", node->GetName()));
+  }
+  void FunctionBaseDeleted(FunctionBase* function_base) override {
+    events_.push_back("function_base_deleted");
+    f_ = nullptr;
+  }
+
+ private:
+  FunctionBase* f_;
+  std::vector<std::string> events_;
+};
+
+class ChangeListenerTest : public IrTestBase {};
+
+TEST_F(ChangeListenerTest, AddAndRemoveNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+
+  RecordingListener listener(f);
+  // The operand of a new node is not reported as an operand change.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg, f->MakeNodeWithName<UnOp>(SourceInfo(), x.node(), Op::kNeg,
+                                            "neg"));
+  EXPECT_THAT(listener.TakeEvents(), ElementsAre("added neg"));
+
+  XLS_ASSERT_OK(f->RemoveNode(neg));
+  EXPECT_THAT(listener.TakeEvents(),
+              ElementsAre("deleted neg", "use_removed x"));
+}
+
+TEST_F(ChangeListenerTest, ReplaceOperands) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue add = fb.Add(x, x, SourceInfo(), "add");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  RecordingListener listener(f);
+  EXPECT_TRUE(add.node()->ReplaceOperand(x.node(), y.node()));
+  EXPECT_THAT(listener.TakeEvents(),
+              ElementsAre("use_removed x", "operand_changed add"));
+
+  XLS_ASSERT_OK(add.node()->ReplaceOperandNumber(0, x.node()));
+  EXPECT_THAT(listener.TakeEvents(), ElementsAre("operand_changed add"));
+
+  XLS_ASSERT_OK(add.node()->ReplaceOperandNumber(1, x.node()));
+  EXPECT_THAT(listener.TakeEvents(),
+              ElementsAre("operand_changed add", "use_removed y"));
+}
+
+TEST_F(ChangeListenerTest, ReplaceUsesWith) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue neg = fb.Negate(x, SourceInfo(), "neg");
+  BValue inv = fb.Not(x, SourceInfo(), "inv");
+  BValue add = fb.Add(neg, neg, SourceInfo(), "add");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  RecordingListener listener(f);
+  XLS_ASSERT_OK(neg.node()->ReplaceUsesWith(inv.node()));
+  EXPECT_THAT(listener.TakeEvents(),
+              ElementsAre("operand_changed add", "use_removed neg"));
+
+  // Replacing the return value reports the loss of its implicit use.
+  XLS_ASSERT_OK(add.node()->ReplaceUsesWith(inv.node()));
+  EXPECT_THAT(listener.TakeEvents(), ElementsAre("use_removed add"));
+  EXPECT_EQ(f->return_value(), inv.node());
+}
+
+TEST_F(ChangeListenerTest, FunctionBaseDeleted) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+  XLS_ASSERT_OK(p->SetTop(std::nullopt));
+
+  RecordingListener listener(f);
+  XLS_ASSERT_OK(p->RemoveFunction(f));
+  EXPECT_THAT(listener.TakeEvents(), ElementsAre("function_base_deleted"));
+  EXPECT_THAT(listener.TakeEvents(), IsEmpty());
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,63 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/dead_node_worklist.h"
+
+#include <vector>
+
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+DeadNodeWorklist::DeadNodeWorklist(FunctionBase* f) : function_base_(f) {
+  candidates_.reserve(f->node_count());
+  for (Node* node : f->nodes()) {
+    Add(node);
+  }
+  f->RegisterChangeListener(this);
+}
+
+DeadNodeWorklist::~DeadNodeWorklist() {
+  if (function_base_ != nullptr) {
+    function_base_->UnregisterChangeListener(this);
+  }
+}
+
+void DeadNodeWorklist::FunctionBaseDeleted(FunctionBase* function_base) {
+  function_base_ = nullptr;
+  Clear();
+}
+
+std::vector<Node*> DeadNodeWorklist::TakeCandidates() {
+  std::vector<Node*> result;
+  result.reserve(candidate_set_.size());
+  // A removed node's address may be reused by a later node, so a node may
+  // appear more than once in `candidates_`; erasing from the set as nodes are
+  // taken returns each only once.
+  for (Node* node : candidates_) {
+    if (candidate_set_.erase(node) > 0) {
+      result.push_back(node);
+    }
+  }
+  candidates_.clear();
+  return result;
+}
+
+void DeadNodeWorklist::Clear() {
+  candidates_.clear();
+  candidate_set_.clear();
+}
+
+}  // namespace xls
@@ -0,0 +1,80 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_DEAD_NODE_WORKLIST_H_
+#define XLS_IR_DEAD_NODE_WORKLIST_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "xls/ir/change_listener.h"
+
+namespace xls {
+
+class FunctionBase;
+class Node;
+
+// Tracks the nodes of a FunctionBase which may have become dead, i.e., lost
+// their last use, since the worklist was last drained. A node can only become
+// dead by being added without users or by losing a use, so these are the
+// only events recorded. Dead code elimination drains the worklist instead of
+// scanning the whole function base, making its cost proportional to the
+// changes made since it last ran.
+//
+// The worklist is a ChangeListener of the function base. Initially every node
+// of the function base is a candidate.
+//
+// DCE reads the worklist owned by the function base
+// (FunctionBase::GetDeadNodeWorklist), which collects the candidates created
+// by every pass that runs between two invocations of DCE.
+class DeadNodeWorklist : public ChangeListener {
+ public:
+  explicit DeadNodeWorklist(FunctionBase* f);
+  ~DeadNodeWorklist() override;
+
+  DeadNodeWorklist(const DeadNodeWorklist&) = delete;
+  DeadNodeWorklist& operator=(const DeadNodeWorklist&) = delete;
+
+  // Returns the candidates recorded since the last call of TakeCandidates or
+  // Clear, in the order they were first recorded, and clears them. Nodes
+  // which have since been removed are not returned.
+  std::vector<Node*> TakeCandidates();
+
+  // Drops all candidates.
+  void Clear();
+
+  // ChangeListener overrides.
+  void NodeAdded(Node* node) override { Add(node); }
+  void NodeDeleted(Node* node) override { candidate_set_.erase(node); }
+  void UseRemoved(Node* node) override { Add(node); }
+  void FunctionBaseDeleted(FunctionBase* function_base) override;
+
+ private:
+  void Add(Node* node) {
+    if (candidate_set_.insert(node).second) {
+      candidates_.push_back(node);
+    }
+  }
+
+  FunctionBase* function_base_;
+
+  // The candidates in the order they were recorded. May contain nodes which
+  // have since been removed; `candidate_set_` holds the live candidates.
+  std::vector<Node*> candidates_;
+  absl::flat_hash_set<Node*> candidate_set_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_DEAD_NODE_WORKLIST_H_
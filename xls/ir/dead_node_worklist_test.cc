@@ -0,0 +1,89 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/dead_node_worklist.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class DeadNodeWorklistTest : public IrTestBase {};
+
+TEST_F(DeadNodeWorklistTest, InitiallyContainsAllNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  DeadNodeWorklist* worklist = f->GetDeadNodeWorklist();
+  EXPECT_EQ(f->GetDeadNodeWorklist(), worklist);
+  EXPECT_THAT(worklist->TakeCandidates(), ElementsAre(x.node(), neg.node()));
+  EXPECT_THAT(worklist->TakeCandidates(), IsEmpty());
+}
+
+TEST_F(DeadNodeWorklistTest, RecordsNodesWhichLoseUses) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  BValue add = fb.Add(neg, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  DeadNodeWorklist* worklist = f->GetDeadNodeWorklist();
+  worklist->Clear();
+
+  // Replacing an operand records the old operand; adding a node records it.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * inv,
+                           f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNot));
+  XLS_ASSERT_OK(add.node()->ReplaceOperandNumber(0, inv));
+  EXPECT_THAT(worklist->TakeCandidates(), ElementsAre(inv, neg.node()));
+
+  // Changing the return value records the old return value.
+  XLS_ASSERT_OK(f->set_return_value(inv));
+  EXPECT_THAT(worklist->TakeCandidates(), ElementsAre(add.node()));
+
+  // Removing a node records its operands and drops the node itself.
+  XLS_ASSERT_OK(add.node()->ReplaceOperandNumber(1, neg.node()));
+  XLS_ASSERT_OK(f->RemoveNode(add.node()));
+  EXPECT_THAT(worklist->TakeCandidates(),
+              ElementsAre(y.node(), inv, neg.node()));
+}
+
+TEST_F(DeadNodeWorklistTest, ReplaceUsesWith) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  BValue inv = fb.Not(x);
+  BValue add = fb.Add(neg, neg);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  DeadNodeWorklist* worklist = f->GetDeadNodeWorklist();
+  worklist->Clear();
+  XLS_ASSERT_OK(neg.node()->ReplaceUsesWith(inv.node()));
+  EXPECT_THAT(worklist->TakeCandidates(), ElementsAre(neg.node()));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,8 +14,62 @@
 
 #include "xls/ir/events.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace xls {
 
+void RawTraceBuffer::Record(const Trace* trace, Formatter formatter,
+                            const void* context,
+                            absl::Span<const uint8_t> data) {
+  records_.push_back(Entry{.trace = trace,
+                           .formatter = formatter,
+                           .context = context,
+                           .offset = static_cast<int64_t>(data_.size()),
+                           .size = static_cast<int64_t>(data.size())});
+  data_.insert(data_.end(), data.begin(), data.end());
+}
+
+void RawTraceBuffer::Append(const RawTraceBuffer& other) {
+  for (const Entry& entry : other.records_) {
+    Record(entry.trace, entry.formatter, entry.context,
+           absl::MakeConstSpan(other.data_).subspan(entry.offset, entry.size));
+  }
+}
+
+void RawTraceBuffer::Clear() {
+  records_.clear();
+  data_.clear();
+}
+
+std::string RawTraceBuffer::Format(int64_t i) const {
+  const Entry& entry = records_.at(i);
+  return entry.formatter(
+      entry.context, entry.trace,
+      absl::MakeConstSpan(data_).subspan(entry.offset, entry.size));
+}
+
+std::vector<std::string> RawTraceBuffer::FormatAll() const {
+  std::vector<std::string> messages;
+  messages.reserve(records_.size());
+  for (int64_t i = 0; i < records_.size(); ++i) {
+    messages.push_back(Format(i));
+  }
+  return messages;
+}
+
+std::vector<std::string> InterpreterEvents::GetTraceMessages() const {
+  if (raw_traces.empty()) {
+    return trace_msgs;
+  }
+  std::vector<std::string> messages = trace_msgs;
+  for (std::string& message : raw_traces.FormatAll()) {
+    messages.push_back(std::move(message));
+  }
+  return messages;
+}
+
 absl::Status InterpreterEventsToStatus(const InterpreterEvents& events) {
   if (events.assert_msgs.empty()) {
     return absl::OkStatus();
@@ -15,19 +15,94 @@
 #ifndef XLS_IR_EVENTS_H_
 #define XLS_IR_EVENTS_H_
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 
 namespace xls {
 
+class Trace;
+
+// How an evaluator collects the messages of traces executed during evaluation.
+enum class TraceCollection {
+  // Messages are formatted as the traces execute and appended to
+  // InterpreterEvents::trace_msgs.
+  kFormatted,
+  // Traces are recorded in binary form in InterpreterEvents::raw_traces and
+  // only formatted on demand. Evaluators which do not support raw traces
+  // format them as with kFormatted.
+  kRaw,
+  // Traces are not collected.
+  kDisabled,
+};
+
+// A buffer of traces recorded in binary form: for each executed trace, the
+// trace node and the raw bytes of its data operands. Formatting the messages is
+// deferred until they are requested, so evaluations whose traces are never read
+// do not pay for formatting.
+class RawTraceBuffer {
+ public:
+  // Returns the message of `trace` given the raw bytes of its data operands.
+  // `context` is the value passed to Record (e.g., the runtime which defines
+  // the layout of the bytes).
+  using Formatter = std::string (*)(const void* context, const Trace* trace,
+                                    absl::Span<const uint8_t> data);
+
+  // Records an execution of `trace` with data operand bytes `data`. `trace`
+  // and `context` must outlive any formatting of the record.
+  void Record(const Trace* trace, Formatter formatter, const void* context,
+              absl::Span<const uint8_t> data);
+
+  // Appends the records of `other` to this buffer.
+  void Append(const RawTraceBuffer& other);
+
+  int64_t size() const { return records_.size(); }
+  bool empty() const { return records_.empty(); }
+  void Clear();
+
+  // Returns the trace node of the i-th record.
+  const Trace* trace(int64_t i) const { return records_.at(i).trace; }
+
+  // Returns the formatted message of the i-th record.
+  std::string Format(int64_t i) const;
+
+  // Returns the formatted messages of all records in the order recorded.
+  std::vector<std::string> FormatAll() const;
+
+ private:
+  struct Entry {
+    const Trace* trace;
+    Formatter formatter;
+    const void* context;
+    int64_t offset;
+    int64_t size;
+  };
+  std::vector<Entry> records_;
+  std::vector<uint8_t> data_;
+};
+
 // Common structure capturing events that can be produced by any XLS interpreter
 // (DSLX, IR, JIT, etc.)
 struct InterpreterEvents {
   std::vector<std::string> trace_msgs;
   std::vector<std::string> assert_msgs;
 
+  // Set by the user of an evaluator to choose how traces are collected.
+  TraceCollection trace_collection = TraceCollection::kFormatted;
+  // Traces recorded when `trace_collection` is kRaw.
+  RawTraceBuffer raw_traces;
+
+  // Returns the messages of all collected traces: `trace_msgs` followed by the
+  // formatted `raw_traces`.
+  std::vector<std::string> GetTraceMessages() const;
+
   bool operator==(const InterpreterEvents& other) const {
-    return trace_msgs == other.trace_msgs && assert_msgs == other.assert_msgs;
+    return GetTraceMessages() == other.GetTraceMessages() &&
+           assert_msgs == other.assert_msgs;
   }
   bool operator!=(const InterpreterEvents& other) const {
     return !(*this == other);
@@ -0,0 +1,323 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/fingerprint.h"
+
+#include <algorithm>
+#include <variant>
+
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/instantiation.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/register.h"
+
+namespace xls {
+
+namespace {
+
+// Arbitrary seeds distinguishing the kinds of hashed objects.
+constexpr uint64_t kNodeSeed = 0x6e6f6465;
+constexpr uint64_t kFunctionSeed = 0x66756e63;
+constexpr uint64_t kProcSeed = 0x70726f63;
+constexpr uint64_t kBlockSeed = 0x626c6f63;
+
+// Returns whether the attributes of the node refer to objects outside of the
+// function base which may change without notification.
+bool HasExternalAttributes(const Node* node) {
+  switch (node->op()) {
+    case Op::kCountedFor:
+    case Op::kDynamicCountedFor:
+    case Op::kInvoke:
+    case Op::kMap:
+    case Op::kRegisterRead:
+    case Op::kRegisterWrite:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+uint64_t FingerprintCombine(uint64_t hash, uint64_t value) {
+  // Boost-style combination followed by the MurmurHash3 64-bit finalizer so
+  // that small differences in the inputs spread over all bits.
+  uint64_t x =
+      hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+uint64_t FingerprintString(uint64_t hash, std::string_view s) {
+  // 64-bit FNV-1a.
+  uint64_t fnv = 0xcbf29ce484222325ULL;
+  for (char c : s) {
+    fnv ^= static_cast<uint8_t>(c);
+    fnv *= 0x100000001b3ULL;
+  }
+  return FingerprintCombine(FingerprintCombine(hash, s.size()), fnv);
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, int64_t value) {
+  return FingerprintCombine(hash, value);
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, bool value) {
+  return FingerprintCombine(hash, value ? 1 : 0);
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, LsbOrMsb value) {
+  return FingerprintCombine(hash, static_cast<uint64_t>(value));
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, const std::string& value) {
+  return FingerprintString(hash, value);
+}
+
+uint64_t FingerprintAttribute(uint64_t hash,
+                              const std::optional<std::string>& value) {
+  hash = FingerprintCombine(hash, value.has_value() ? 1 : 0);
+  return value.has_value() ? FingerprintString(hash, *value) : hash;
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, const Value& value) {
+  hash = FingerprintCombine(hash, static_cast<uint64_t>(value.kind()));
+  if (value.IsBits()) {
+    const InlineBitmap& bitmap = value.bits().bitmap();
+    hash = FingerprintCombine(hash, bitmap.bit_count());
+    for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+      hash = FingerprintCombine(hash, bitmap.GetWord(i));
+    }
+  } else if (value.IsTuple() || value.IsArray()) {
+    hash = FingerprintCombine(hash, value.size());
+    for (const Value& element : value.elements()) {
+      hash = FingerprintAttribute(hash, element);
+    }
+  }
+  return hash;
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, Type* type) {
+  return FingerprintString(hash, type->ToString());
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, const std::vector<Type*>& types) {
+  hash = FingerprintCombine(hash, types.size());
+  for (Type* type : types) {
+    hash = FingerprintAttribute(hash, type);
+  }
+  return hash;
+}
+
+uint64_t FingerprintAttribute(uint64_t hash,
+                              const std::vector<FormatStep>& steps) {
+  hash = FingerprintCombine(hash, steps.size());
+  for (const FormatStep& step : steps) {
+    if (std::holds_alternative<std::string>(step)) {
+      hash = FingerprintString(hash, std::get<std::string>(step));
+    } else {
+      hash = FingerprintCombine(
+          hash, static_cast<uint64_t>(std::get<FormatPreference>(step)) + 1);
+    }
+  }
+  return hash;
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, Function* function) {
+  return FingerprintCombine(hash, function->StructuralHash());
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, Register* reg) {
+  // Registers are part of the interface of a block so their names are
+  // included.
+  return FingerprintString(hash, reg->ToString());
+}
+
+uint64_t FingerprintAttribute(uint64_t hash, Instantiation* instantiation) {
+  hash = FingerprintString(hash, instantiation->name());
+  return FingerprintCombine(hash,
+                            static_cast<uint64_t>(instantiation->kind()));
+}
+
+StructuralHasher::StructuralHasher(FunctionBase* f) : function_base_(f) {
+  node_hashes_.reserve(f->node_count());
+  for (Node* node : *f->GetTopoSort()) {
+    NodeAdded(node);
+  }
+  hashed_params_.assign(f->params().begin(), f->params().end());
+  f->RegisterChangeListener(this);
+}
+
+StructuralHasher::~StructuralHasher() {
+  if (function_base_ != nullptr) {
+    function_base_->UnregisterChangeListener(this);
+  }
+}
+
+uint64_t StructuralHasher::TypeHash(Type* type) {
+  auto [it, inserted] = type_hashes_.try_emplace(type, 0);
+  if (inserted) {
+    it->second = FingerprintString(0, type->ToString());
+  }
+  return it->second;
+}
+
+uint64_t StructuralHasher::ComputeNodeHash(Node* node) {
+  uint64_t hash =
+      FingerprintCombine(kNodeSeed, static_cast<uint64_t>(node->op()));
+  hash = FingerprintCombine(hash, TypeHash(node->GetType()));
+  hash = node->HashAttributes(hash);
+  switch (node->op()) {
+    case Op::kParam: {
+      absl::Span<Param* const> params = function_base_->params();
+      hash = FingerprintCombine(
+          hash, std::find(params.begin(), params.end(), node) - params.begin());
+      break;
+    }
+    case Op::kInputPort:
+      hash = FingerprintString(hash, node->As<InputPort>()->name());
+      break;
+    case Op::kOutputPort:
+      hash = FingerprintString(hash, node->As<OutputPort>()->name());
+      break;
+    default:
+      break;
+  }
+  hash = FingerprintCombine(hash, node->operand_count());
+  for (Node* operand : node->operands()) {
+    hash = FingerprintCombine(hash, GetNodeHash(operand));
+  }
+  return hash;
+}
+
+uint64_t StructuralHasher::GetNodeHash(Node* node) {
+  auto it = node_hashes_.find(node);
+  if (it != node_hashes_.end()) {
+    return it->second;
+  }
+  uint64_t hash = ComputeNodeHash(node);
+  SetNodeHash(node, hash);
+  return hash;
+}
+
+void StructuralHasher::SetNodeHash(Node* node, uint64_t hash) {
+  auto [it, inserted] = node_hashes_.try_emplace(node, hash);
+  if (!inserted) {
+    node_hash_sum_ -= FingerprintCombine(0, it->second);
+    it->second = hash;
+  }
+  node_hash_sum_ += FingerprintCombine(0, hash);
+}
+
+void StructuralHasher::Rehash(Node* node) {
+  std::vector<Node*> worklist = {node};
+  while (!worklist.empty()) {
+    Node* n = worklist.back();
+    worklist.pop_back();
+    auto it = node_hashes_.find(n);
+    if (it == node_hashes_.end()) {
+      continue;
+    }
+    uint64_t hash = ComputeNodeHash(n);
+    if (hash == it->second) {
+      continue;
+    }
+    SetNodeHash(n, hash);
+    for (Node* user : n->users()) {
+      worklist.push_back(user);
+    }
+  }
+}
+
+uint64_t StructuralHasher::GetHash() {
+  XLS_CHECK(function_base_ != nullptr);
+  absl::Span<Param* const> params = function_base_->params();
+  if (!std::equal(params.begin(), params.end(), hashed_params_.begin(),
+                  hashed_params_.end())) {
+    hashed_params_.assign(params.begin(), params.end());
+    for (Param* param : params) {
+      Rehash(param);
+    }
+  }
+  for (Node* node : external_nodes_) {
+    Rehash(node);
+  }
+
+  uint64_t hash;
+  if (function_base_->IsFunction()) {
+    Function* f = function_base_->AsFunctionOrDie();
+    hash = FingerprintCombine(kFunctionSeed, node_hash_sum_);
+    if (f->return_value() != nullptr) {
+      hash = FingerprintCombine(hash, GetNodeHash(f->return_value()));
+    }
+  } else if (function_base_->IsProc()) {
+    Proc* proc = function_base_->AsProcOrDie();
+    hash = FingerprintCombine(kProcSeed, node_hash_sum_);
+    if (proc->NextToken() != nullptr) {
+      hash = FingerprintCombine(hash, GetNodeHash(proc->NextToken()));
+    }
+    for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+      hash = FingerprintAttribute(hash, proc->GetInitValueElement(i));
+      hash = FingerprintCombine(hash,
+                                GetNodeHash(proc->GetNextStateElement(i)));
+    }
+  } else {
+    hash = FingerprintCombine(kBlockSeed, node_hash_sum_);
+  }
+  return FingerprintCombine(hash, node_hashes_.size());
+}
+
+void StructuralHasher::NodeAdded(Node* node) {
+  if (HasExternalAttributes(node)) {
+    external_nodes_.insert(node);
+  }
+  GetNodeHash(node);
+}
+
+void StructuralHasher::NodeDeleted(Node* node) {
+  external_nodes_.erase(node);
+  auto it = node_hashes_.find(node);
+  if (it == node_hashes_.end()) {
+    return;
+  }
+  node_hash_sum_ -= FingerprintCombine(0, it->second);
+  node_hashes_.erase(it);
+}
+
+void StructuralHasher::OperandChanged(Node* node) {
+  // Operands are added during construction before the node is added to the
+  // function base. Such nodes are hashed when NodeAdded is called.
+  Rehash(node);
+}
+
+void StructuralHasher::FunctionBaseDeleted(FunctionBase* function_base) {
+  XLS_CHECK_EQ(function_base, function_base_);
+  function_base_ = nullptr;
+  node_hashes_.clear();
+  type_hashes_.clear();
+  external_nodes_.clear();
+  hashed_params_.clear();
+  node_hash_sum_ = 0;
+}
+
+}  // namespace xls
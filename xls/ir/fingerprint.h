@@ -0,0 +1,132 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_FINGERPRINT_H_
+#define XLS_IR_FINGERPRINT_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+class Function;
+class FunctionBase;
+class Instantiation;
+class Node;
+class Param;
+class Register;
+
+// Stable 64-bit hashing for structural fingerprints of IR. Unlike absl::Hash,
+// the results do not depend on the process, so fingerprints may be used as
+// keys of persistent caches.
+
+// Mixes `value` into `hash`.
+uint64_t FingerprintCombine(uint64_t hash, uint64_t value);
+
+// Mixes the bytes of `s` into `hash`.
+uint64_t FingerprintString(uint64_t hash, std::string_view s);
+
+// Overloads mixing a node attribute into `hash`, used by the generated
+// Node::HashAttributes methods. Attributes referring to functions mix in the
+// structural hash of the function rather than its name.
+uint64_t FingerprintAttribute(uint64_t hash, int64_t value);
+uint64_t FingerprintAttribute(uint64_t hash, bool value);
+uint64_t FingerprintAttribute(uint64_t hash, LsbOrMsb value);
+uint64_t FingerprintAttribute(uint64_t hash, const std::string& value);
+uint64_t FingerprintAttribute(uint64_t hash,
+                              const std::optional<std::string>& value);
+uint64_t FingerprintAttribute(uint64_t hash, const Value& value);
+uint64_t FingerprintAttribute(uint64_t hash, Type* type);
+uint64_t FingerprintAttribute(uint64_t hash, const std::vector<Type*>& types);
+uint64_t FingerprintAttribute(uint64_t hash,
+                              const std::vector<FormatStep>& steps);
+uint64_t FingerprintAttribute(uint64_t hash, Function* function);
+uint64_t FingerprintAttribute(uint64_t hash, Register* reg);
+uint64_t FingerprintAttribute(uint64_t hash, Instantiation* instantiation);
+
+// Maintains a structural hash of a FunctionBase which ignores node names, node
+// ids and source locations. Each node is hashed from its op, type,
+// attributes and the hashes of its operands (params from their position,
+// ports from their port name), and the function base hash combines the node
+// hashes as a multiset with its return value or next state. Structurally
+// identical function bases therefore hash the same regardless of naming or
+// node order.
+//
+// The hasher is a ChangeListener of the function base, so after a change only
+// the changed nodes and their transitive users are rehashed. Nodes whose
+// attributes refer to objects outside the function base (callees and
+// registers) are rehashed on every call of GetHash as those objects may
+// change without notification.
+//
+// Typically obtained through FunctionBase::StructuralHash.
+class StructuralHasher : public ChangeListener {
+ public:
+  explicit StructuralHasher(FunctionBase* f);
+  ~StructuralHasher() override;
+
+  StructuralHasher(const StructuralHasher&) = delete;
+  StructuralHasher& operator=(const StructuralHasher&) = delete;
+
+  // Returns the structural hash of the function base.
+  uint64_t GetHash();
+
+  // ChangeListener overrides.
+  void NodeAdded(Node* node) override;
+  void NodeDeleted(Node* node) override;
+  void OperandChanged(Node* node) override;
+  void FunctionBaseDeleted(FunctionBase* function_base) override;
+
+ private:
+  // Returns the hash of the node computed from the current hashes of its
+  // operands.
+  uint64_t ComputeNodeHash(Node* node);
+
+  // Returns the current hash of the node, computing it if needed.
+  uint64_t GetNodeHash(Node* node);
+
+  // Rehashes the node and, if its hash changed, its transitive users.
+  void Rehash(Node* node);
+
+  void SetNodeHash(Node* node, uint64_t hash);
+
+  uint64_t TypeHash(Type* type);
+
+  FunctionBase* function_base_;
+  absl::flat_hash_map<Node*, uint64_t> node_hashes_;
+  absl::flat_hash_map<Type*, uint64_t> type_hashes_;
+
+  // Nodes whose attributes refer to callees or registers.
+  absl::flat_hash_set<Node*> external_nodes_;
+
+  // The params in the order they were last hashed.
+  std::vector<Param*> hashed_params_;
+
+  // Sum of the mixed hashes of all nodes.
+  uint64_t node_hash_sum_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_FINGERPRINT_H_
@@ -0,0 +1,138 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/fingerprint.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+class FingerprintTest : public IrTestBase {};
+
+TEST_F(FingerprintTest, IgnoresNames) {
+  auto p = CreatePackage();
+  Function* f1;
+  {
+    FunctionBuilder fb("f1", p.get());
+    BValue x = fb.Param("x", p->GetBitsType(8));
+    BValue y = fb.Param("y", p->GetBitsType(8));
+    XLS_ASSERT_OK_AND_ASSIGN(f1, fb.BuildWithReturnValue(fb.Add(x, y)));
+  }
+  Function* f2;
+  {
+    FunctionBuilder fb("f2", p.get());
+    BValue a = fb.Param("a", p->GetBitsType(8));
+    BValue b = fb.Param("b", p->GetBitsType(8));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        f2, fb.BuildWithReturnValue(fb.Add(a, b, SourceInfo(), "sum")));
+  }
+  EXPECT_EQ(f1->StructuralHash(), f2->StructuralHash());
+}
+
+TEST_F(FingerprintTest, DistinguishesAttributesAndParamOrder) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue literal = fb.Literal(UBits(1, 8));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f,
+      fb.BuildWithReturnValue(fb.Add(fb.Subtract(x, y), literal)));
+  uint64_t original = f->StructuralHash();
+
+  XLS_ASSERT_OK(literal.node()
+                    ->ReplaceUsesWithNew<Literal>(Value(UBits(2, 8)))
+                    .status());
+  uint64_t other_literal = f->StructuralHash();
+  EXPECT_NE(original, other_literal);
+
+  XLS_ASSERT_OK(f->MoveParamToIndex(y.node()->As<Param>(), 0));
+  EXPECT_NE(f->StructuralHash(), other_literal);
+}
+
+TEST_F(FingerprintTest, IncrementalUpdateMatchesRecomputation) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  BValue add = fb.Add(neg, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(fb.Not(add)));
+  uint64_t original = f->StructuralHash();
+
+  EXPECT_TRUE(add.node()->ReplaceOperand(neg.node(), x.node()));
+  XLS_ASSERT_OK(f->RemoveNode(neg.node()));
+  uint64_t updated = f->StructuralHash();
+  EXPECT_NE(updated, original);
+  EXPECT_EQ(updated, StructuralHasher(f).GetHash());
+
+  // Restoring the original graph restores the original hash.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_neg, f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNeg));
+  EXPECT_TRUE(add.node()->ReplaceOperand(x.node(), new_neg));
+  EXPECT_EQ(f->StructuralHash(), original);
+}
+
+TEST_F(FingerprintTest, CalleeChangesAffectCaller) {
+  auto p = CreatePackage();
+  BValue literal;
+  Function* callee;
+  {
+    FunctionBuilder fb("callee", p.get());
+    BValue x = fb.Param("x", p->GetBitsType(8));
+    literal = fb.Literal(UBits(1, 8));
+    XLS_ASSERT_OK_AND_ASSIGN(callee,
+                             fb.BuildWithReturnValue(fb.Add(x, literal)));
+  }
+  Function* caller;
+  {
+    FunctionBuilder fb("caller", p.get());
+    BValue x = fb.Param("x", p->GetBitsType(8));
+    XLS_ASSERT_OK_AND_ASSIGN(caller,
+                             fb.BuildWithReturnValue(fb.Invoke({x}, callee)));
+  }
+  uint64_t original = caller->StructuralHash();
+  XLS_ASSERT_OK(literal.node()
+                    ->ReplaceUsesWithNew<Literal>(Value(UBits(2, 8)))
+                    .status());
+  EXPECT_NE(caller->StructuralHash(), original);
+}
+
+TEST_F(FingerprintTest, PackageFingerprint) {
+  auto build = [](Package* p, std::string_view name, int64_t value) {
+    FunctionBuilder fb(name, p);
+    BValue x = fb.Param("x", p->GetBitsType(8));
+    return fb.BuildWithReturnValue(fb.Add(x, fb.Literal(UBits(value, 8))));
+  };
+  auto p1 = CreatePackage();
+  XLS_ASSERT_OK(build(p1.get(), "f", 1).status());
+  auto p2 = CreatePackage();
+  XLS_ASSERT_OK(build(p2.get(), "g", 1).status());
+  auto p3 = CreatePackage();
+  XLS_ASSERT_OK(build(p3.get(), "f", 3).status());
+
+  EXPECT_EQ(p1->Fingerprint(), p1->Fingerprint());
+  EXPECT_EQ(p1->Fingerprint(), p2->Fingerprint());
+  EXPECT_NE(p1->Fingerprint(), p3->Fingerprint());
+}
+
+}  // namespace
+}  // namespace xls
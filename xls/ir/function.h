@@ -37,9 +37,6 @@
 namespace xls {
 
 class Function : public FunctionBase {
- private:
-  using NodeList = std::list<std::unique_ptr<Node>>;
-
  public:
   Function(std::string_view name, Package* package)
       : FunctionBase(name, package) {}
@@ -53,7 +50,13 @@ class Function : public FunctionBase {
     XLS_RET_CHECK_EQ(n->function_base(), this) << absl::StreamFormat(
         "Return value node %s is not in this function %s (is in function %s)",
         n->GetName(), name(), n->function_base()->name());
+    Node* old_return_value = return_value_;
     return_value_ = n;
+    // The return value is ordered specially by TopoSort.
+    InvalidateTopoSort();
+    if (old_return_value != nullptr && old_return_value != n) {
+      NotifyImplicitUseRemoved(old_return_value);
+    }
     return absl::OkStatus();
   }
 
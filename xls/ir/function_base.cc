@@ -14,6 +14,7 @@
 
 #include "xls/ir/function_base.h"
 
+#include "absl/algorithm/container.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -79,9 +80,94 @@ absl::StatusOr<Node*> FunctionBase::GetNode(
       absl::StrFormat("GetNode(%s) failed.", standard_node_name));
 }
 
+FunctionBase::~FunctionBase() {
+  std::vector<ChangeListener*> listeners = std::move(change_listeners_);
+  change_listeners_.clear();
+  for (ChangeListener* listener : listeners) {
+    listener->FunctionBaseDeleted(this);
+  }
+}
+
+void FunctionBase::RegisterChangeListener(ChangeListener* listener) {
+  XLS_CHECK(!absl::c_linear_search(change_listeners_, listener));
+  change_listeners_.push_back(listener);
+}
+
+void FunctionBase::UnregisterChangeListener(ChangeListener* listener) {
+  auto it = absl::c_find(change_listeners_, listener);
+  XLS_CHECK(it != change_listeners_.end());
+  change_listeners_.erase(it);
+}
+
+StructuralHashIndex* FunctionBase::GetStructuralHashIndex() {
+  if (structural_hash_index_ == nullptr) {
+    structural_hash_index_ = std::make_unique<StructuralHashIndex>(this);
+  }
+  return structural_hash_index_.get();
+}
+
+uint64_t FunctionBase::StructuralHash() {
+  if (structural_hasher_ == nullptr) {
+    structural_hasher_ = std::make_unique<StructuralHasher>(this);
+  }
+  return structural_hasher_->GetHash();
+}
+
+ReachabilityIndex* FunctionBase::GetReachabilityIndex() {
+  if (reachability_index_ == nullptr) {
+    reachability_index_ = std::make_unique<ReachabilityIndex>(this);
+  }
+  return reachability_index_.get();
+}
+
+std::shared_ptr<const std::vector<Node*>> FunctionBase::GetTopoSort() {
+  absl::MutexLock lock(&topo_sort_mutex_);
+  if (topo_sort_ == nullptr) {
+    if (reverse_topo_sort_ == nullptr) {
+      reverse_topo_sort_ = std::make_shared<const std::vector<Node*>>(
+          NodeIterator::ComputeReverseTopoSort(this));
+    }
+    topo_sort_ = std::make_shared<const std::vector<Node*>>(
+        reverse_topo_sort_->rbegin(), reverse_topo_sort_->rend());
+  }
+  return topo_sort_;
+}
+
+std::shared_ptr<const std::vector<Node*>> FunctionBase::GetReverseTopoSort() {
+  absl::MutexLock lock(&topo_sort_mutex_);
+  if (reverse_topo_sort_ == nullptr) {
+    reverse_topo_sort_ = std::make_shared<const std::vector<Node*>>(
+        NodeIterator::ComputeReverseTopoSort(this));
+  }
+  return reverse_topo_sort_;
+}
+
+void FunctionBase::InvalidateTopoSort() {
+  absl::MutexLock lock(&topo_sort_mutex_);
+  topo_sort_ = nullptr;
+  reverse_topo_sort_ = nullptr;
+}
+
+DeadNodeWorklist* FunctionBase::GetDeadNodeWorklist() {
+  if (dead_node_worklist_ == nullptr) {
+    dead_node_worklist_ = std::make_unique<DeadNodeWorklist>(this);
+  }
+  return dead_node_worklist_.get();
+}
+
+void FunctionBase::NotifyImplicitUseRemoved(Node* node) {
+  for (ChangeListener* listener : change_listeners_) {
+    listener->UseRemoved(node);
+  }
+}
+
 absl::Status FunctionBase::RemoveNode(Node* node) {
   XLS_RET_CHECK(node->users().empty()) << node->GetName();
   XLS_RET_CHECK(!HasImplicitUse(node)) << node->GetName();
+  XLS_RET_CHECK(nodes_.contains(node));
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeDeleted(node);
+  }
   std::vector<Node*> unique_operands;
   for (Node* operand : node->operands()) {
     if (!absl::c_linear_search(unique_operands, operand)) {
@@ -95,10 +181,8 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
     params_.erase(std::remove(params_.begin(), params_.end(), node),
                   params_.end());
   }
-  auto node_it = node_iterators_.find(node);
-  XLS_RET_CHECK(node_it != node_iterators_.end());
-  nodes_.erase(node_it->second);
-  node_iterators_.erase(node_it);
+  nodes_.erase(node);
+  InvalidateTopoSort();
   return absl::OkStatus();
 }
 
@@ -157,15 +241,18 @@ Block* FunctionBase::AsBlockOrDie() {
   return down_cast<Block*>(this);
 }
 
-Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
+Node* FunctionBase::AddNodeInternal(Node* node) {
   XLS_VLOG(4) << absl::StrFormat("Adding node %s to FunctionBase %s",
                                  node->GetName(), name());
   if (node->Is<Param>()) {
     params_.push_back(node->As<Param>());
   }
-  Node* ptr = node.get();
-  node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
-  return ptr;
+  nodes_.push_back(node);
+  InvalidateTopoSort();
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeAdded(node);
+  }
+  return node;
 }
 
 /*static*/ std::vector<std::string> FunctionBase::GetIrReservedWords() {
@@ -22,13 +22,20 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/iterator_range.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/dead_node_worklist.h"
 #include "xls/ir/dfs_visitor.h"
+#include "xls/ir/fingerprint.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_list.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/reachability_index.h"
+#include "xls/ir/structural_hash_index.h"
 #include "xls/ir/type.h"
 #include "xls/ir/unwrapping_iterator.h"
 #include "xls/ir/verifier.h"
@@ -40,14 +47,11 @@ class Proc;
 
 // Base class for Functions and Procs. A holder of a set of nodes.
 class FunctionBase {
- protected:
-  using NodeList = std::list<std::unique_ptr<Node>>;
-
  public:
   FunctionBase(std::string_view name, Package* package)
       : name_(name),
         package_(package) {}
-  virtual ~FunctionBase() = default;
+  virtual ~FunctionBase();
 
   Package* package() const { return package_; }
   const std::string& name() const { return name_; }
@@ -75,23 +79,25 @@ class FunctionBase {
 
   int64_t node_count() const { return nodes_.size(); }
 
+  // Returns the number of bytes the function's node arena has reserved from
+  // the system allocator.
+  int64_t node_arena_bytes() const { return nodes_.arena().bytes_reserved(); }
+
+  // Returns whether `node` has been added to this function base and not
+  // removed since.
+  bool HasNode(const Node* node) const { return nodes_.contains(node); }
+
   // Expose Nodes, so that transformation passes can operate
   // on this function.
-  xabsl::iterator_range<UnwrappingIterator<NodeList::iterator>> nodes() {
-    return xabsl::make_range(MakeUnwrappingIterator(nodes_.begin()),
-                             MakeUnwrappingIterator(nodes_.end()));
-  }
-  xabsl::iterator_range<UnwrappingIterator<NodeList::const_iterator>> nodes()
-      const {
-    return xabsl::make_range(MakeUnwrappingIterator(nodes_.begin()),
-                             MakeUnwrappingIterator(nodes_.end()));
+  xabsl::iterator_range<NodeList::iterator> nodes() const {
+    return xabsl::make_range(nodes_.begin(), nodes_.end());
   }
 
   // Adds a node to the set owned by this function.
   template <typename T>
   T* AddNode(std::unique_ptr<T> n) {
-    T* ptr = n.get();
-    AddNodeInternal(std::move(n));
+    T* ptr = n.release();
+    AddNodeInternal(ptr);
     return ptr;
   }
 
@@ -100,10 +106,14 @@ class FunctionBase {
   // the exception of the final FunctionBase* argument. This method verifies the
   // newly constructed node after it is added to the function. Returns a pointer
   // to the newly constructed node.
+  //
+  // Nodes created with MakeNode or MakeNodeWithName are allocated in the
+  // function's node arena.
   template <typename NodeT, typename... Args>
   absl::StatusOr<NodeT*> MakeNode(Args&&... args) {
-    NodeT* new_node = AddNode(std::make_unique<NodeT>(
-        std::forward<Args>(args)..., /*name=*/"", this));
+    NodeT* new_node = nodes_.Create<NodeT>(std::forward<Args>(args)...,
+                                           /*name=*/"", this);
+    AddNodeInternal(new_node);
     XLS_RETURN_IF_ERROR(VerifyNode(new_node));
     return new_node;
   }
@@ -111,11 +121,22 @@ class FunctionBase {
   template <typename NodeT, typename... Args>
   absl::StatusOr<NodeT*> MakeNodeWithName(Args&&... args) {
     NodeT* new_node =
-        AddNode(std::make_unique<NodeT>(std::forward<Args>(args)..., this));
+        nodes_.Create<NodeT>(std::forward<Args>(args)..., this);
+    AddNodeInternal(new_node);
     XLS_RETURN_IF_ERROR(VerifyNode(new_node));
     return new_node;
   }
 
+  // Like MakeNodeWithName but the node is not verified. For builders which
+  // check the constructed IR as a whole.
+  template <typename NodeT, typename... Args>
+  NodeT* MakeUnverifiedNodeWithName(Args&&... args) {
+    NodeT* new_node =
+        nodes_.Create<NodeT>(std::forward<Args>(args)..., this);
+    AddNodeInternal(new_node);
+    return new_node;
+  }
+
   // Find a node by it's name, as generated by DumpIr.
   absl::StatusOr<Node*> GetNode(std::string_view standard_node_name);
 
@@ -149,13 +170,63 @@ class FunctionBase {
   // procs.
   virtual bool HasImplicitUse(Node* node) const = 0;
 
+  // Registers a listener which is notified of node additions, removals, and
+  // operand changes in this function base. The listener is not owned.
+  void RegisterChangeListener(ChangeListener* listener);
+  void UnregisterChangeListener(ChangeListener* listener);
+  absl::Span<ChangeListener* const> change_listeners() const {
+    return change_listeners_;
+  }
+
+  // Returns the structural hash index of the nodes in this function base,
+  // creating it on first use. Once created, the index is kept up to date as
+  // the function base is modified until the function base is destroyed.
+  StructuralHashIndex* GetStructuralHashIndex();
+
+  // Returns a structural hash of this function base which ignores node names,
+  // node ids and source locations, so function bases which differ only in
+  // naming or node order hash the same. Stable across processes. The hash is
+  // maintained incrementally (see StructuralHasher in fingerprint.h) after
+  // the first call, so repeated calls cost time proportional to the changes
+  // in between.
+  uint64_t StructuralHash();
+
+  // Returns the reachability index of the nodes in this function base,
+  // creating it on first use. The index is rebuilt lazily after the function
+  // base is modified.
+  ReachabilityIndex* GetReachabilityIndex();
+
+  // Returns the worklist of nodes which may have become dead, creating it on
+  // first use (with every node as a candidate). Once created, it records
+  // candidates as the function base is modified until the function base is
+  // destroyed.
+  DeadNodeWorklist* GetDeadNodeWorklist();
+
+  // Returns the nodes of this function base in a stable topological order
+  // (see TopoSort in node_iterator.h), or the reverse of that order. The order
+  // is computed on first use and cached until the next node addition, node
+  // removal, operand change or (for functions) return value change. The
+  // returned vector is immutable and remains valid after the cache is
+  // invalidated, so it may be iterated while the function base is modified.
+  // Thread-safe with respect to other calls of these methods.
+  std::shared_ptr<const std::vector<Node*>> GetTopoSort();
+  std::shared_ptr<const std::vector<Node*>> GetReverseTopoSort();
+
+  // Drops the cached topological orders. Called on every structural change.
+  void InvalidateTopoSort();
+
  protected:
   FunctionBase(const FunctionBase& other) = delete;
   void operator=(const FunctionBase& other) = delete;
 
-  // Internal virtual helper for adding a node. Returns a pointer to the newly
-  // added node.
-  virtual Node* AddNodeInternal(std::unique_ptr<Node> node);
+  // Internal virtual helper for adding a node. The function takes ownership of
+  // the node, which must either be heap-allocated or have been created in
+  // nodes_. Returns a pointer to the newly added node.
+  virtual Node* AddNodeInternal(Node* node);
+
+  // Notifies the change listeners that `node` is no longer an implicit use of
+  // the function base.
+  void NotifyImplicitUseRemoved(Node* node);
 
   // Returns a vector containing the reserved words in the IR.
   static std::vector<std::string> GetIrReservedWords();
@@ -163,14 +234,34 @@ class FunctionBase {
   std::string name_;
   Package* package_;
 
-  // Store Nodes in std::list as they can be added and removed arbitrarily and
-  // we want a stable iteration order. Keep a map from instruction pointer to
-  // location in the list for fast lookup.
+  // Store Nodes in an intrusive list as they can be added and removed
+  // arbitrarily and we want a stable iteration order. The list owns the nodes
+  // and the arena most of them are allocated in.
   NodeList nodes_;
-  absl::flat_hash_map<const Node*, NodeList::iterator> node_iterators_;
 
   std::vector<Param*> params_;
 
+  std::vector<ChangeListener*> change_listeners_;
+
+  // Lazily constructed by GetStructuralHashIndex.
+  std::unique_ptr<StructuralHashIndex> structural_hash_index_;
+
+  // Lazily constructed by StructuralHash.
+  std::unique_ptr<StructuralHasher> structural_hasher_;
+
+  // Lazily constructed by GetReachabilityIndex.
+  std::unique_ptr<ReachabilityIndex> reachability_index_;
+
+  // Lazily constructed by GetDeadNodeWorklist.
+  std::unique_ptr<DeadNodeWorklist> dead_node_worklist_;
+
+  // Lazily computed by GetTopoSort and GetReverseTopoSort.
+  absl::Mutex topo_sort_mutex_;
+  std::shared_ptr<const std::vector<Node*>> topo_sort_
+      ABSL_GUARDED_BY(topo_sort_mutex_);
+  std::shared_ptr<const std::vector<Node*>> reverse_topo_sort_
+      ABSL_GUARDED_BY(topo_sort_mutex_);
+
   NameUniquer node_name_uniquer_ =
       NameUniquer(/*separator=*/"__", GetIrReservedWords());
 };
@@ -25,6 +25,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/structural_hash_index.h"
 #include "xls/ir/verifier.h"
 
 namespace xls {
@@ -82,8 +83,18 @@ BValue BuilderBase::CreateBValue(Node* node, const SourceInfo& loc) {
 
 template <typename NodeT, typename... Args>
 BValue BuilderBase::AddNode(const SourceInfo& loc, Args&&... args) {
-  last_node_ = function_->AddNode<NodeT>(std::make_unique<NodeT>(
-      loc, std::forward<Args>(args)..., function_.get()));
+  last_node_ = function_->MakeUnverifiedNodeWithName<NodeT>(
+      loc, std::forward<Args>(args)...);
+  if (hash_cons_nodes_ && !last_node_->HasAssignedName() &&
+      StructuralHashIndex::IsIndexable(last_node_)) {
+    Node* existing =
+        function_->GetStructuralHashIndex()->FindEquivalent(last_node_);
+    if (existing != nullptr) {
+      // The new node has no users so it can always be removed.
+      XLS_CHECK_OK(function_->RemoveNode(last_node_));
+      last_node_ = existing;
+    }
+  }
   return CreateBValue(last_node_, loc);
 }
 
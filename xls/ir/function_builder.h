@@ -125,6 +125,13 @@ class BuilderBase {
   // Get access to currently built up function (or proc).
   FunctionBase* function() const { return function_.get(); }
 
+  // If enabled, the builder does not create a node which is structurally equal
+  // to an existing node (see StructuralHashIndex) and instead returns a
+  // BValue of the existing node. Nodes which are given a name and
+  // side-effecting nodes are always created.
+  void set_hash_cons_nodes(bool value) { hash_cons_nodes_ = value; }
+  bool hash_cons_nodes() const { return hash_cons_nodes_; }
+
   // Declares a parameter to the function being built of type "type".
   virtual BValue Param(std::string_view name, Type* type,
                        const SourceInfo& loc = SourceInfo()) = 0;
@@ -606,6 +613,10 @@ class BuilderBase {
   // tests.
   bool should_verify_;
 
+  // Whether to reuse existing structurally equal nodes rather than creating
+  // duplicates.
+  bool hash_cons_nodes_ = false;
+
   std::string error_msg_;
   std::string error_stacktrace_;
   SourceInfo error_loc_;
@@ -1009,4 +1009,31 @@ TEST(FunctionBuilderTest, Registers) {
   EXPECT_THAT(get_reg_write(x_3)->load_enable().value(), m::InputPort("le"));
 }
 
+TEST(FunctionBuilderTest, HashConsNodes) {
+  Package p("p");
+  FunctionBuilder b("f", &p);
+  b.set_hash_cons_nodes(true);
+  Type* u32 = p.GetBitsType(32);
+  BValue x = b.Param("x", u32);
+  BValue y = b.Param("y", u32);
+  BValue add_xy = b.Add(x, y);
+  BValue add_yx = b.Add(y, x);
+  BValue named_add = b.Add(x, y, SourceInfo(), "named_add");
+  BValue lit = b.Literal(UBits(3, 32));
+  BValue lit_again = b.Literal(UBits(3, 32));
+  BValue sub_xy = b.Subtract(x, y);
+  BValue sub_yx = b.Subtract(y, x);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f,
+      b.BuildWithReturnValue(b.Concat(
+          {add_xy, add_yx, named_add, lit, lit_again, sub_xy, sub_yx})));
+
+  EXPECT_EQ(add_xy.node(), add_yx.node());
+  EXPECT_NE(add_xy.node(), named_add.node());
+  EXPECT_EQ(lit.node(), lit_again.node());
+  EXPECT_NE(sub_xy.node(), sub_yx.node());
+  // x, y, add, named_add, literal, two subtracts, and the concat.
+  EXPECT_EQ(f->node_count(), 8);
+}
+
 }  // namespace xls
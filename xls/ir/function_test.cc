@@ -425,5 +425,88 @@ fn graph(p: bits[42], q: bits[42]) -> bits[42] {
   }
 }
 
+TEST_F(FunctionTest, NodeListOrderAfterRemoval) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+
+  std::vector<Node*> literals;
+  for (int64_t i = 0; i < 1000; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Node * literal,
+        f->MakeNode<Literal>(SourceInfo(), Value(UBits(i, 32))));
+    literals.push_back(literal);
+  }
+  EXPECT_EQ(f->node_count(), 1001);
+
+  // Remove every other literal including the last one.
+  std::vector<Node*> expected = {x.node()};
+  for (int64_t i = 0; i < literals.size(); ++i) {
+    if (i % 2 == 0) {
+      expected.push_back(literals[i]);
+    } else {
+      XLS_ASSERT_OK(f->RemoveNode(literals[i]));
+    }
+  }
+  EXPECT_EQ(f->node_count(), 501);
+  EXPECT_EQ(std::vector<Node*>(f->nodes().begin(), f->nodes().end()),
+            expected);
+
+  // New nodes are appended at the end.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * added, f->MakeNode<Literal>(SourceInfo(), Value(UBits(42, 32))));
+  expected.push_back(added);
+  EXPECT_EQ(std::vector<Node*>(f->nodes().begin(), f->nodes().end()),
+            expected);
+
+  // The node list can be traversed backwards.
+  std::vector<Node*> reversed;
+  for (auto it = f->nodes().end(); it != f->nodes().begin();) {
+    --it;
+    reversed.push_back(*it);
+  }
+  std::reverse(expected.begin(), expected.end());
+  EXPECT_EQ(reversed, expected);
+}
+
+TEST_F(FunctionTest, RemoveNodeOfOtherFunction) {
+  auto p = CreatePackage();
+  FunctionBuilder fb("f", p.get());
+  fb.Param("x", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  FunctionBuilder gb("g", p.get());
+  BValue y = gb.Param("y", p->GetBitsType(32));
+  BValue neg = gb.Negate(y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g, gb.BuildWithReturnValue(y));
+
+  // `neg` is linked into g's node list after its head.
+  EXPECT_THAT(f->RemoveNode(neg.node()),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_EQ(f->node_count(), 1);
+  EXPECT_EQ(g->node_count(), 2);
+  EXPECT_EQ(std::vector<Node*>(g->nodes().begin(), g->nodes().end()),
+            std::vector<Node*>({y.node(), neg.node()}));
+}
+
+TEST_F(FunctionTest, HasNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb("f", p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue not_x = fb.Not(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(not_x));
+  FunctionBuilder gb("g", p.get());
+  BValue y = gb.Param("y", p->GetBitsType(32));
+  BValue neg = gb.Negate(y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g, gb.BuildWithReturnValue(neg));
+
+  EXPECT_TRUE(f->HasNode(x.node()));
+  EXPECT_TRUE(f->HasNode(not_x.node()));
+  EXPECT_FALSE(f->HasNode(y.node()));
+  EXPECT_FALSE(f->HasNode(neg.node()));
+  EXPECT_TRUE(g->HasNode(y.node()));
+  EXPECT_TRUE(g->HasNode(neg.node()));
+}
+
 }  // namespace
 }  // namespace xls
@@ -17,11 +17,11 @@
 #include <algorithm>
 #include <cstdint>
 #include <functional>
-#include <list>
 #include <random>
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/optional.h"
@@ -33,6 +33,24 @@
 #include "xls/ir/interval.h"
 
 namespace xls {
+namespace {
+
+// Appends the given proper interval to the normalized `intervals`, merging it
+// into the last interval if they overlap or abut. The lower bound of
+// `interval` must be no less than that of any interval in `intervals`.
+void AppendNormalized(const Interval& interval,
+                      absl::InlinedVector<Interval, 2>* intervals) {
+  if (!intervals->empty()) {
+    Interval& last = intervals->back();
+    if (Interval::Overlaps(last, interval) || Interval::Abuts(last, interval)) {
+      last = Interval::ConvexHull(last, interval);
+      return;
+    }
+  }
+  intervals->push_back(interval);
+}
+
+}  // namespace
 
 IntervalSet IntervalSet::Maximal(int64_t bit_count) {
   IntervalSet result(bit_count);
@@ -62,10 +80,25 @@ void IntervalSet::SetIntervals(absl::Span<const Interval> intervals) {
   }
 }
 
+bool IntervalSet::ExtendsNormalized(const Interval& interval) const {
+  if (interval.IsImproper()) {
+    return false;
+  }
+  if (intervals_.empty()) {
+    return true;
+  }
+  const Interval& last = intervals_.back();
+  return bits_ops::ULessThan(last.UpperBound(), interval.LowerBound()) &&
+         !Interval::Abuts(last, interval);
+}
+
 void IntervalSet::Normalize() {
+  if (is_normalized_) {
+    return;
+  }
   Bits zero(BitCount());
   Bits max = Bits::AllOnes(BitCount());
-  std::vector<Interval> expand_improper;
+  absl::InlinedVector<Interval, 2> expand_improper;
   for (const Interval& interval : intervals_) {
     if (interval.IsImproper()) {
       expand_improper.push_back(Interval(zero, interval.UpperBound()));
@@ -78,15 +111,8 @@ void IntervalSet::Normalize() {
   std::sort(expand_improper.begin(), expand_improper.end());
 
   intervals_.clear();
-  for (int32_t i = 0; i < expand_improper.size();) {
-    Interval interval = expand_improper[i];
-    while ((i < expand_improper.size()) &&
-           (Interval::Overlaps(interval, expand_improper[i]) ||
-            Interval::Abuts(interval, expand_improper[i]))) {
-      interval = Interval::ConvexHull(interval, expand_improper[i]);
-      ++i;
-    }
-    intervals_.push_back(interval);
+  for (const Interval& interval : expand_improper) {
+    AppendNormalized(interval, &intervals_);
   }
 
   is_normalized_ = true;
@@ -103,8 +129,13 @@ std::optional<Interval> IntervalSet::ConvexHull() const {
 }
 
 std::optional<Bits> IntervalSet::LowerBound() const {
-  // TODO(taktoa): optimize case where is_normalized_ is true
   XLS_CHECK_GE(bit_count_, 0);
+  if (is_normalized_) {
+    if (intervals_.empty()) {
+      return absl::nullopt;
+    }
+    return intervals_.front().LowerBound();
+  }
   std::optional<Bits> lower;
   for (const Interval& interval : intervals_) {
     if (lower.has_value()) {
@@ -119,8 +150,13 @@ std::optional<Bits> IntervalSet::LowerBound() const {
 }
 
 std::optional<Bits> IntervalSet::UpperBound() const {
-  // TODO(taktoa): optimize case where is_normalized_ is true
   XLS_CHECK_GE(bit_count_, 0);
+  if (is_normalized_) {
+    if (intervals_.empty()) {
+      return absl::nullopt;
+    }
+    return intervals_.back().UpperBound();
+  }
   std::optional<Bits> upper;
   for (const Interval& interval : intervals_) {
     if (upper.has_value()) {
@@ -159,13 +195,30 @@ IntervalSet IntervalSet::Combine(const IntervalSet& lhs,
                                  const IntervalSet& rhs) {
   XLS_CHECK_EQ(lhs.BitCount(), rhs.BitCount());
   IntervalSet combined(lhs.BitCount());
-  for (const Interval& interval : lhs.intervals_) {
-    combined.AddInterval(interval);
+  if (!lhs.is_normalized_ || !rhs.is_normalized_) {
+    for (const Interval& interval : lhs.intervals_) {
+      combined.AddInterval(interval);
+    }
+    for (const Interval& interval : rhs.intervals_) {
+      combined.AddInterval(interval);
+    }
+    combined.Normalize();
+    return combined;
   }
-  for (const Interval& interval : rhs.intervals_) {
-    combined.AddInterval(interval);
+
+  // Both operands are sorted and free of improper intervals, so merging them
+  // in order of lower bound yields the normalized union directly.
+  auto left = lhs.intervals_.begin();
+  auto right = rhs.intervals_.begin();
+  while (left != lhs.intervals_.end() || right != rhs.intervals_.end()) {
+    if (right == rhs.intervals_.end() ||
+        (left != lhs.intervals_.end() && *left < *right)) {
+      AppendNormalized(*left++, &combined.intervals_);
+    } else {
+      AppendNormalized(*right++, &combined.intervals_);
+    }
   }
-  combined.Normalize();
+  combined.is_normalized_ = true;
   return combined;
 }
 
@@ -175,70 +228,62 @@ IntervalSet IntervalSet::Intersect(const IntervalSet& lhs,
   XLS_CHECK(lhs.is_normalized_);
   XLS_CHECK(rhs.is_normalized_);
   IntervalSet result(lhs.BitCount());
-  std::list<Interval> lhs_intervals(lhs.Intervals().begin(),
-                                    lhs.Intervals().end());
-  std::list<Interval> rhs_intervals(rhs.Intervals().begin(),
-                                    rhs.Intervals().end());
-  auto left = lhs_intervals.begin();
-  auto right = rhs_intervals.begin();
-  // lhs/rhs_intervals should be sorted in increasing lexicographic order
-  // (i.e.: compare on lower bound, then upper bound if lower bounds are equal)
-  // at this point, since we CHECK that they are normalized.
-  while ((left != lhs_intervals.end()) && (right != rhs_intervals.end())) {
-    if (bits_ops::ULessThan(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*right, *left);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          right = rhs_intervals.insert(right, remainder);
-        }
-      }
-      ++left;
-      continue;
-    }
-    if (bits_ops::ULessThan(right->UpperBound(), left->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*left, *right);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          left = lhs_intervals.insert(left, remainder);
-        }
-      }
-      ++right;
-      continue;
+  // Sweep both sorted lists, intersecting the current pair of intervals and
+  // then advancing past whichever one ends first. The pieces come out sorted
+  // and, as the intervals of each operand are separated by gaps, never overlap
+  // or abut, so the result is normalized by construction.
+  auto left = lhs.intervals_.begin();
+  auto right = rhs.intervals_.begin();
+  while (left != lhs.intervals_.end() && right != rhs.intervals_.end()) {
+    const Bits& lower =
+        bits_ops::ULessThan(left->LowerBound(), right->LowerBound())
+            ? right->LowerBound()
+            : left->LowerBound();
+    bool left_ends_first =
+        bits_ops::ULessThan(left->UpperBound(), right->UpperBound());
+    const Bits& upper =
+        left_ends_first ? left->UpperBound() : right->UpperBound();
+    if (bits_ops::ULessThanOrEqual(lower, upper)) {
+      result.intervals_.push_back(Interval(lower, upper));
     }
-    if (bits_ops::UEqual(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-      }
+    if (left_ends_first) {
       ++left;
+    } else {
       ++right;
-      continue;
     }
   }
-  result.Normalize();
+  result.is_normalized_ = true;
   return result;
 }
 
 IntervalSet IntervalSet::Complement(const IntervalSet& set) {
-  // The complement of an interval set is the intersection of the complements of
-  // the component intervals.
-  IntervalSet result = Maximal(set.BitCount());
-  for (const Interval& interval : set.Intervals()) {
-    IntervalSet complement_set(set.BitCount());
-    for (const Interval& complement : Interval::Complement(interval)) {
-      complement_set.AddInterval(complement);
+  if (!set.is_normalized_) {
+    IntervalSet normalized = set;
+    normalized.Normalize();
+    return Complement(normalized);
+  }
+  // The complement of a normalized interval set is the set of gaps around its
+  // (sorted, disjoint) intervals.
+  int64_t bit_count = set.BitCount();
+  IntervalSet result(bit_count);
+  std::optional<Bits> gap_start = Bits(bit_count);
+  for (const Interval& interval : set.intervals_) {
+    if (bits_ops::ULessThan(gap_start.value(), interval.LowerBound())) {
+      result.intervals_.push_back(
+          Interval(gap_start.value(),
+                   bits_ops::Sub(interval.LowerBound(), UBits(1, bit_count))));
+    }
+    if (interval.UpperBound().IsAllOnes()) {
+      gap_start = absl::nullopt;
+      break;
     }
-    complement_set.Normalize();
-    result = Intersect(result, complement_set);
+    gap_start = bits_ops::Add(interval.UpperBound(), UBits(1, bit_count));
+  }
+  if (gap_start.has_value()) {
+    result.intervals_.push_back(
+        Interval(gap_start.value(), Bits::AllOnes(bit_count)));
   }
+  result.is_normalized_ = true;
   return result;
 }
 
@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -36,6 +37,11 @@
 namespace xls {
 
 // This type represents a set of intervals.
+//
+// Most interval sets hold one or two intervals, so the intervals are stored
+// inline up to that size. The set algebra (`Combine`, `Intersect` and
+// `Complement`) works on normalized operands in a single sorted sweep and
+// returns normalized sets, so chains of set operations never re-sort.
 class IntervalSet {
  public:
   // Create an empty `IntervalSet` with a `BitCount()` of -1. Every method in
@@ -73,10 +79,14 @@ class IntervalSet {
     return bit_count_;
   }
 
-  // Add an interval to this interval set.
+  // Add an interval to this interval set. Appending a proper interval which
+  // lies above every interval of a normalized set (without abutting the last
+  // one) keeps the set normalized.
   void AddInterval(const Interval& interval) {
-    is_normalized_ = false;
     XLS_CHECK_EQ(BitCount(), interval.BitCount());
+    if (is_normalized_ && !ExtendsNormalized(interval)) {
+      is_normalized_ = false;
+    }
     intervals_.push_back(interval);
   }
 
@@ -129,7 +139,7 @@ class IntervalSet {
   static IntervalSet Intersect(const IntervalSet& lhs, const IntervalSet& rhs);
 
   // Returns the normalized set of intervals comprising the complemet of the
-  // given interval set.
+  // given interval set. An unnormalized set is normalized in a copy first.
   static IntervalSet Complement(const IntervalSet& set);
 
   // Returns the number of points covered by the intervals in this interval set,
@@ -180,7 +190,8 @@ class IntervalSet {
   // Returns true iff this set of intervals is empty.
   bool IsEmpty() const;
 
-  // Returns the inclusive lower/upper bound of the interval set.
+  // Returns the inclusive lower/upper bound of the interval set. Constant time
+  // if the set is normalized.
   std::optional<Bits> LowerBound() const;
   std::optional<Bits> UpperBound() const;
 
@@ -211,9 +222,13 @@ class IntervalSet {
   }
 
  private:
+  // Returns true iff appending the given interval to the (normalized)
+  // `intervals_` leaves them normalized.
+  bool ExtendsNormalized(const Interval& interval) const;
+
   bool is_normalized_;
   int64_t bit_count_;
-  std::vector<Interval> intervals_;
+  absl::InlinedVector<Interval, 2> intervals_;
 };
 
 inline std::ostream& operator<<(std::ostream& os,
@@ -114,6 +114,61 @@ TEST(IntervalTest, Combine) {
                                    MakeInterval(25, 35, 32)}));
 }
 
+TEST(IntervalTest, CombineMatchesElementwiseUnion) {
+  int32_t seed = 42;
+  for (int32_t i = 0; i < 30; ++i) {
+    IntervalSet lhs = IntervalSet::Random(seed, 10, 5);
+    IntervalSet rhs = IntervalSet::Random(seed + 1, 10, 5);
+    seed = seed + 2;
+    absl::flat_hash_set<Bits> union_set;
+    for (const IntervalSet& set : {lhs, rhs}) {
+      set.ForEachElement([&](const Bits& bits) -> bool {
+        union_set.insert(bits);
+        return false;
+      });
+    }
+
+    IntervalSet combined = IntervalSet::Combine(lhs, rhs);
+    EXPECT_TRUE(combined.IsNormalized());
+    EXPECT_EQ(union_set.size(), combined.Size().value());
+    combined.ForEachElement([&](const Bits& bits) -> bool {
+      EXPECT_TRUE(union_set.contains(bits));
+      return false;
+    });
+
+    // Combining unnormalized sets gives the same result.
+    IntervalSet unnormalized(10);
+    for (const Interval& interval : lhs.Intervals()) {
+      unnormalized.AddInterval(interval);
+    }
+    unnormalized.AddInterval(MakeInterval(3, 2, 10));
+    EXPECT_EQ(IntervalSet::Combine(unnormalized, rhs),
+              IntervalSet::Maximal(10));
+  }
+}
+
+TEST(IntervalTest, AddIntervalInOrderStaysNormalized) {
+  IntervalSet set(32);
+  set.AddInterval(MakeInterval(5, 10, 32));
+  EXPECT_TRUE(set.IsNormalized());
+  set.AddInterval(MakeInterval(20, 30, 32));
+  EXPECT_TRUE(set.IsNormalized());
+  EXPECT_EQ(set.Intervals(), (std::vector<Interval>{MakeInterval(5, 10, 32),
+                                                    MakeInterval(20, 30, 32)}));
+
+  IntervalSet abutting = set;
+  abutting.AddInterval(MakeInterval(31, 40, 32));
+  EXPECT_FALSE(abutting.IsNormalized());
+
+  IntervalSet out_of_order = set;
+  out_of_order.AddInterval(MakeInterval(0, 1, 32));
+  EXPECT_FALSE(out_of_order.IsNormalized());
+
+  IntervalSet improper = set;
+  improper.AddInterval(MakeInterval(50, 40, 32));
+  EXPECT_FALSE(improper.IsNormalized());
+}
+
 TEST(IntervalTest, Intersect) {
   // Manually tested with 1,000 random seeds;
   int32_t seed = 815303902;
@@ -289,6 +344,28 @@ TEST(IntervalTest, Complement) {
       MakeInterval(151, std::numeric_limits<uint32_t>::max(), 32));
   complement_set1.Normalize();
   EXPECT_EQ(IntervalSet::Complement(set1), complement_set1);
+
+  // Overlapping, unsorted intervals.
+  IntervalSet unnormalized(32);
+  unnormalized.AddInterval(MakeInterval(100, 150, 32));
+  unnormalized.AddInterval(MakeInterval(5, 20, 32));
+  unnormalized.AddInterval(MakeInterval(10, 15, 32));
+  unnormalized.AddInterval(MakeInterval(140, 150, 32));
+  EXPECT_FALSE(unnormalized.IsNormalized());
+  EXPECT_EQ(IntervalSet::Complement(unnormalized), complement_set1);
+}
+
+TEST(IntervalTest, ComplementMatchesElementwiseComplement) {
+  int32_t seed = 1234;
+  for (int32_t i = 0; i < 30; ++i) {
+    IntervalSet set = IntervalSet::Random(seed++, 8, 5);
+    IntervalSet complement = IntervalSet::Complement(set);
+    EXPECT_TRUE(complement.IsNormalized());
+    for (int64_t value = 0; value < 256; ++value) {
+      EXPECT_NE(set.Covers(UBits(value, 8)),
+                complement.Covers(UBits(value, 8)));
+    }
+  }
 }
 
 TEST(IntervalTest, IsEmpty) {
@@ -14,14 +14,22 @@
 
 #include "xls/ir/ir_parser.h"
 
+#include <atomic>
+
 #include "google/protobuf/text_format.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "xls/common/file/memory_mapped_file.h"
+#include "xls/common/thread.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/visitor.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/node.h"
@@ -29,6 +37,7 @@
 #include "xls/ir/number_parser.h"
 #include "xls/ir/op.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value_parser.h"
 #include "xls/ir/verifier.h"
 
 namespace xls {
@@ -62,9 +71,10 @@ absl::Status Parser::ParseKeywordArguments(
   // Verify all mandatory keywords are present.
   for (const std::string& keyword : mandatory_keywords) {
     if (!seen_keywords.contains(keyword)) {
-      return absl::InvalidArgumentError(absl::StrFormat(
-          "Mandatory keyword argument `%s` not found @ %s", keyword,
-          scanner_.PeekTokenOrDie().pos().ToHumanString()));
+      XLS_ASSIGN_OR_RETURN(Token next, scanner_.PeekToken());
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Mandatory keyword argument `%s` not found @ %s",
+                          keyword, next.pos().ToHumanString()));
     }
   }
 
@@ -1453,9 +1463,9 @@ absl::StatusOr<Type*> Parser::ParseTupleType(Package* package) {
     } while (scanner_.TryDropToken(LexicalTokenType::kComma));
   }
   if (!scanner_.PeekTokenIs(LexicalTokenType::kParenClose)) {
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Expected ')' to terminate tuple type; found %s",
-                        scanner_.PopToken().value()));
+    XLS_ASSIGN_OR_RETURN(Token found, scanner_.PopTokenOrError("tuple type"));
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected ')' to terminate tuple type; found %s", found.value()));
   }
   scanner_.PopToken();
   return package->GetTupleType(types);
@@ -1653,6 +1663,28 @@ absl::Status Parser::ParseFileNumber(Package* package) {
 }
 
 absl::StatusOr<Function*> Parser::ParseFunction(Package* package) {
+  XLS_ASSIGN_OR_RETURN(ParsedFunctionBase parsed, ParseFunctionBody(package));
+  XLS_ASSIGN_OR_RETURN(FunctionBase * function,
+                       BuildFunctionBase(std::move(parsed)));
+  return function->AsFunctionOrDie();
+}
+
+absl::StatusOr<Proc*> Parser::ParseProc(Package* package) {
+  XLS_ASSIGN_OR_RETURN(ParsedFunctionBase parsed, ParseProcBody(package));
+  XLS_ASSIGN_OR_RETURN(FunctionBase * proc,
+                       BuildFunctionBase(std::move(parsed)));
+  return proc->AsProcOrDie();
+}
+
+absl::StatusOr<Block*> Parser::ParseBlock(Package* package) {
+  XLS_ASSIGN_OR_RETURN(ParsedFunctionBase parsed, ParseBlockBody(package));
+  XLS_ASSIGN_OR_RETURN(FunctionBase * block,
+                       BuildFunctionBase(std::move(parsed)));
+  return block->AsBlockOrDie();
+}
+
+absl::StatusOr<Parser::ParsedFunctionBase> Parser::ParseFunctionBody(
+    Package* package) {
   if (AtEof()) {
     return absl::InvalidArgumentError("Could not parse function; at EOF.");
   }
@@ -1661,10 +1693,10 @@ absl::StatusOr<Function*> Parser::ParseFunction(Package* package) {
   absl::flat_hash_map<std::string, BValue> name_to_value;
   XLS_ASSIGN_OR_RETURN(auto function_data,
                        ParseFunctionSignature(&name_to_value, package));
-  FunctionBuilder* fb = function_data.first.get();
+  std::unique_ptr<FunctionBuilder> fb = std::move(function_data.first);
 
   XLS_ASSIGN_OR_RETURN(BodyResult body_result,
-                       ParseBody(fb, &name_to_value, package));
+                       ParseBody(fb.get(), &name_to_value, package));
 
   XLS_RET_CHECK(std::holds_alternative<BValue>(body_result));
   BValue return_value = std::get<BValue>(body_result);
@@ -1678,13 +1710,12 @@ absl::StatusOr<Function*> Parser::ParseFunction(Package* package) {
         function_data.second->ToString()));
   }
 
-  // TODO(leary): 2019-02-19 Could be an empty function body, need to decide
-  // what to do for those. Accept that the return value can be null and handle
-  // everywhere?
-  return fb->BuildWithReturnValue(return_value);
+  return ParsedFunctionBase{.builder = std::move(fb),
+                            .body_result = std::move(body_result)};
 }
 
-absl::StatusOr<Proc*> Parser::ParseProc(Package* package) {
+absl::StatusOr<Parser::ParsedFunctionBase> Parser::ParseProcBody(
+    Package* package) {
   if (AtEof()) {
     return absl::InvalidArgumentError("Could not parse proc; at EOF.");
   }
@@ -1698,12 +1729,12 @@ absl::StatusOr<Proc*> Parser::ParseProc(Package* package) {
                        ParseBody(pb.get(), &name_to_value, package));
 
   XLS_RET_CHECK(std::holds_alternative<ProcNext>(body_result));
-  ProcNext proc_next = std::get<ProcNext>(body_result);
-
-  return pb->Build(proc_next.next_token, proc_next.next_state);
+  return ParsedFunctionBase{.builder = std::move(pb),
+                            .body_result = std::move(body_result)};
 }
 
-absl::StatusOr<Block*> Parser::ParseBlock(Package* package) {
+absl::StatusOr<Parser::ParsedFunctionBase> Parser::ParseBlockBody(
+    Package* package) {
   if (AtEof()) {
     return absl::InvalidArgumentError("Could not parse block; at EOF.");
   }
@@ -1719,8 +1750,29 @@ absl::StatusOr<Block*> Parser::ParseBlock(Package* package) {
   XLS_ASSIGN_OR_RETURN(BodyResult body_result,
                        ParseBody(bb.get(), &name_to_value, package));
   XLS_RET_CHECK(std::holds_alternative<BValue>(body_result));
+  return ParsedFunctionBase{.builder = std::move(bb),
+                            .body_result = std::move(body_result),
+                            .block_signature = std::move(signature)};
+}
 
-  XLS_ASSIGN_OR_RETURN(Block * block, bb->Build());
+/* static */
+absl::StatusOr<FunctionBase*> Parser::BuildFunctionBase(
+    ParsedFunctionBase parsed) {
+  if (auto* fb = dynamic_cast<FunctionBuilder*>(parsed.builder.get())) {
+    // TODO(leary): 2019-02-19 Could be an empty function body, need to decide
+    // what to do for those. Accept that the return value can be null and
+    // handle everywhere?
+    return fb->BuildWithReturnValue(std::get<BValue>(parsed.body_result));
+  }
+  if (auto* pb = dynamic_cast<ProcBuilder*>(parsed.builder.get())) {
+    const ProcNext& proc_next = std::get<ProcNext>(parsed.body_result);
+    return pb->Build(proc_next.next_token, proc_next.next_state);
+  }
+  XLS_RET_CHECK(parsed.block_signature.has_value());
+  const BlockSignature& signature = *parsed.block_signature;
+  XLS_ASSIGN_OR_RETURN(
+      Block * block,
+      down_cast<BlockBuilder*>(parsed.builder.get())->Build());
 
   // Verify the ports in the signature match one-to-one to input_ports and
   // output_ports.
@@ -2042,8 +2094,23 @@ absl::StatusOr<Channel*> Parser::ParseChannel(std::string_view input_string,
 
 /* static */
 absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackage(
-    std::string_view input_string,
-    std::optional<std::string_view> filename) {
+    std::string_view input_string, std::optional<std::string_view> filename,
+    int64_t thread_count) {
+  if (IsBinaryIr(input_string)) {
+    return ParseBinaryIrPackage(input_string);
+  }
+  if (thread_count > 1) {
+    absl::StatusOr<std::unique_ptr<Package>> package =
+        ParsePackageConcurrentlyNoVerify(input_string, filename, thread_count);
+    if (package.ok()) {
+      XLS_RETURN_IF_ERROR(VerifyAndSwapError(package->get()));
+      return package;
+    }
+    // Malformed input is reparsed serially so the error matches the one
+    // reported by a serial parse.
+    XLS_VLOG(1) << "Concurrent parse failed, reparsing serially: "
+                << package.status();
+  }
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        ParsePackageNoVerify(input_string, filename));
   XLS_RETURN_IF_ERROR(VerifyAndSwapError(package.get()));
@@ -2054,6 +2121,12 @@ absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackage(
 absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackageWithEntry(
     std::string_view input_string, std::string_view entry,
     std::optional<std::string_view> filename) {
+  if (IsBinaryIr(input_string)) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         ParseBinaryIrPackage(input_string));
+    XLS_RETURN_IF_ERROR(package->SetTopByName(entry));
+    return package;
+  }
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        ParsePackageNoVerify(input_string, filename, entry));
   XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
@@ -2067,9 +2140,445 @@ absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackageNoVerify(
   return ParseDerivedPackageNoVerify<Package>(input_string, filename, entry);
 }
 
+namespace {
+
+// A top-level declaration in the text of a package.
+struct Declaration {
+  // The keyword introducing the declaration: "fn", "proc", "block", "chan" or
+  // "file_number".
+  std::string kind;
+  // Name of the declared entity. Empty for file numbers.
+  std::string name;
+  bool is_top = false;
+  // Extent of the declaration in the text (excluding any `top` keyword) and
+  // the position of its first token.
+  int64_t start;
+  int64_t end;
+  TokenPos pos;
+  // Names of the functions, procs and blocks referred to by the declaration.
+  std::vector<std::string> references;
+  // IDs of the channels used by the declaration or, for a channel, its ID.
+  std::vector<int64_t> channel_ids;
+};
+
+// Pops the tokens of a fn, proc or block declaration from the scanner up to
+// and including the brace closing its body. Names referred to by `to_apply=`,
+// `body=` or `block=` arguments are added to `references` and the IDs given by
+// `channel_id=` arguments are added to `channel_ids`.
+absl::Status SkipFunctionBase(Scanner* scanner,
+                              std::vector<std::string>* references,
+                              std::vector<int64_t>* channel_ids) {
+  static const auto* kReferenceKeywords =
+      new absl::flat_hash_set<std::string>{"to_apply", "body", "block"};
+  int64_t paren_depth = 0;
+  int64_t curl_depth = 0;
+  bool in_body = false;
+  std::optional<Token> prev;
+  std::optional<Token> prev_prev;
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(Token token, scanner->PeekToken());
+    scanner->PopToken();
+    switch (token.type()) {
+      case LexicalTokenType::kParenOpen:
+        ++paren_depth;
+        break;
+      case LexicalTokenType::kParenClose:
+        --paren_depth;
+        break;
+      case LexicalTokenType::kCurlOpen:
+        if (paren_depth == 0) {
+          in_body = true;
+        }
+        ++curl_depth;
+        break;
+      case LexicalTokenType::kCurlClose:
+        if (--curl_depth == 0 && in_body) {
+          return absl::OkStatus();
+        }
+        break;
+      case LexicalTokenType::kIdent:
+        if (prev.has_value() && prev->type() == LexicalTokenType::kEquals &&
+            prev_prev.has_value() &&
+            kReferenceKeywords->contains(prev_prev->value())) {
+          references->push_back(token.value());
+        }
+        break;
+      case LexicalTokenType::kLiteral:
+        if (prev.has_value() && prev->type() == LexicalTokenType::kEquals &&
+            prev_prev.has_value() && prev_prev->value() == "channel_id") {
+          XLS_ASSIGN_OR_RETURN(int64_t channel_id, token.GetValueInt64());
+          channel_ids->push_back(channel_id);
+        }
+        break;
+      default:
+        break;
+    }
+    prev_prev = std::move(prev);
+    prev = std::move(token);
+  }
+}
+
+// Pops the tokens of a channel declaration from the scanner up to and
+// including the parenthesis closing its argument list. Returns the ID of the
+// channel.
+absl::StatusOr<int64_t> SkipChannel(Scanner* scanner) {
+  XLS_RETURN_IF_ERROR(scanner->DropKeywordOrError("chan"));
+  XLS_ASSIGN_OR_RETURN(
+      Token name,
+      scanner->PopTokenOrError(LexicalTokenType::kIdent, "channel name"));
+  XLS_RETURN_IF_ERROR(scanner->DropTokenOrError(LexicalTokenType::kParenOpen,
+                                                "'(' in channel definition"));
+  std::optional<int64_t> id;
+  int64_t paren_depth = 1;
+  while (paren_depth > 0) {
+    XLS_ASSIGN_OR_RETURN(Token token, scanner->PeekToken());
+    scanner->PopToken();
+    if (token.type() == LexicalTokenType::kParenOpen) {
+      ++paren_depth;
+    } else if (token.type() == LexicalTokenType::kParenClose) {
+      --paren_depth;
+    } else if (paren_depth == 1 && token.type() == LexicalTokenType::kIdent &&
+               token.value() == "id" &&
+               scanner->PeekNthTokenIs(0, LexicalTokenType::kEquals) &&
+               scanner->PeekNthTokenIs(1, LexicalTokenType::kLiteral)) {
+      scanner->PopToken();
+      XLS_ASSIGN_OR_RETURN(id, scanner->PopToken().GetValueInt64());
+    }
+  }
+  if (!id.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Channel `%s` has no id @ %s", name.value(),
+                        name.pos().ToHumanString()));
+  }
+  return id.value();
+}
+
+// The top-level declarations of a package in text order.
+struct DeclarationIndex {
+  std::vector<Declaration> declarations;
+  // The index of the declaration of each fn, proc and block by name.
+  absl::flat_hash_map<std::string, int64_t> entity_indices;
+  // The declarations of the entities using each channel.
+  absl::flat_hash_map<int64_t, std::vector<int64_t>> channel_users;
+  std::optional<std::string> top_name;
+};
+
+// Indexes the top-level declarations following the package name without
+// constructing any IR.
+absl::StatusOr<DeclarationIndex> IndexDeclarations(
+    Scanner* scanner, std::string_view filename_str) {
+  Scanner& s = *scanner;
+  DeclarationIndex index;
+  while (!s.AtEof()) {
+    Declaration decl;
+    if (s.TryDropKeyword("top")) {
+      decl.is_top = true;
+    }
+    XLS_ASSIGN_OR_RETURN(Token peek, s.PeekToken());
+    decl.kind = peek.value();
+    decl.start = s.PeekTokenOffset();
+    decl.pos = peek.pos();
+    if (peek.type() == LexicalTokenType::kKeyword &&
+        (decl.kind == "fn" || decl.kind == "proc" || decl.kind == "block")) {
+      s.PopToken();
+      XLS_ASSIGN_OR_RETURN(
+          Token name, s.PopTokenOrError(LexicalTokenType::kIdent,
+                                        absl::StrCat(decl.kind, " name")));
+      decl.name = name.value();
+      XLS_RETURN_IF_ERROR(
+          SkipFunctionBase(&s, &decl.references, &decl.channel_ids))
+          << "@ " << filename_str;
+      if (decl.is_top) {
+        if (index.top_name.has_value()) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Top declared more than once @ %s", decl.pos.ToHumanString()));
+        }
+        index.top_name = decl.name;
+      }
+      index.entity_indices[decl.name] = index.declarations.size();
+      for (int64_t channel_id : decl.channel_ids) {
+        index.channel_users[channel_id].push_back(index.declarations.size());
+      }
+    } else if (decl.is_top) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
+                          peek.value(), peek.pos().ToHumanString()));
+    } else if (peek.type() == LexicalTokenType::kKeyword &&
+               decl.kind == "chan") {
+      XLS_ASSIGN_OR_RETURN(int64_t channel_id, SkipChannel(&s),
+                           _ << "@ " << filename_str);
+      decl.channel_ids.push_back(channel_id);
+    } else if (peek.type() == LexicalTokenType::kKeyword &&
+               decl.kind == "file_number") {
+      // file_number <integer> <quoted-string>
+      for (int64_t i = 0; i < 3; ++i) {
+        XLS_RETURN_IF_ERROR(s.PeekToken().status());
+        s.PopToken();
+      }
+    } else {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected declaration "
+                          "(`fn`, `proc`, `block`, `chan`, `file_number`), "
+                          "got %s @ %s",
+                          peek.value(), peek.pos().ToHumanString()));
+    }
+    decl.end = s.PeekTokenOffset();
+    index.declarations.push_back(std::move(decl));
+  }
+  return index;
+}
+
+}  // namespace
+
+/* static */
+absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackageSubset(
+    std::string_view input_string, absl::Span<const std::string> entity_names,
+    std::optional<std::string_view> filename) {
+  std::string filename_str =
+      (filename.has_value() ? std::string(filename.value()) : "<unknown file>");
+  XLS_ASSIGN_OR_RETURN(auto scanner, Scanner::Create(input_string));
+  Parser parser(std::move(scanner));
+  XLS_ASSIGN_OR_RETURN(std::string package_name, parser.ParsePackageName());
+  XLS_ASSIGN_OR_RETURN(DeclarationIndex index,
+                       IndexDeclarations(&parser.scanner_, filename_str));
+  const std::vector<Declaration>& declarations = index.declarations;
+
+  // Compute the set of entities to parse. In addition to the entities referred
+  // to by name, every proc using a channel of a needed proc is needed so that
+  // each parsed channel has both of its endpoints.
+  std::vector<int64_t> worklist;
+  auto add_entity = [&](std::string_view name) -> absl::Status {
+    auto it = index.entity_indices.find(name);
+    if (it == index.entity_indices.end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "No function, proc or block named `%s` in package `%s`", name,
+          package_name));
+    }
+    worklist.push_back(it->second);
+    return absl::OkStatus();
+  };
+  if (entity_names.empty()) {
+    if (!index.top_name.has_value()) {
+      return absl::InvalidArgumentError(
+          "No entities specified and package has no top");
+    }
+    XLS_RETURN_IF_ERROR(add_entity(*index.top_name));
+  }
+  for (const std::string& name : entity_names) {
+    XLS_RETURN_IF_ERROR(add_entity(name));
+  }
+  absl::flat_hash_set<int64_t> needed;
+  absl::flat_hash_set<int64_t> needed_channel_ids;
+  while (!worklist.empty()) {
+    int64_t decl_index = worklist.back();
+    worklist.pop_back();
+    if (!needed.insert(decl_index).second) {
+      continue;
+    }
+    for (const std::string& reference : declarations[decl_index].references) {
+      XLS_RETURN_IF_ERROR(add_entity(reference));
+    }
+    for (int64_t channel_id : declarations[decl_index].channel_ids) {
+      if (needed_channel_ids.insert(channel_id).second) {
+        const std::vector<int64_t>& users = index.channel_users[channel_id];
+        worklist.insert(worklist.end(), users.begin(), users.end());
+      }
+    }
+  }
+
+  // Parse the needed declarations in text order so every entity is defined
+  // before it is referred to.
+  auto package = std::make_unique<Package>(package_name);
+  for (int64_t i = 0; i < declarations.size(); ++i) {
+    const Declaration& decl = declarations[i];
+    if (decl.kind == "file_number") {
+      // File numbers are cheap and needed by source locations of any entity.
+    } else if (decl.kind == "chan") {
+      if (!needed_channel_ids.contains(decl.channel_ids.front())) {
+        continue;
+      }
+    } else if (!needed.contains(i)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Scanner decl_scanner,
+        Scanner::Create(
+            input_string.substr(decl.start, decl.end - decl.start), decl.pos));
+    Parser decl_parser(std::move(decl_scanner));
+    if (decl.kind == "fn") {
+      XLS_ASSIGN_OR_RETURN(Function * fn,
+                           decl_parser.ParseFunction(package.get()),
+                           _ << "@ " << filename_str);
+      if (decl.is_top) {
+        XLS_RETURN_IF_ERROR(package->SetTop(fn));
+      }
+    } else if (decl.kind == "proc") {
+      XLS_ASSIGN_OR_RETURN(Proc * proc, decl_parser.ParseProc(package.get()),
+                           _ << "@ " << filename_str);
+      if (decl.is_top) {
+        XLS_RETURN_IF_ERROR(package->SetTop(proc));
+      }
+    } else if (decl.kind == "block") {
+      XLS_ASSIGN_OR_RETURN(Block * block,
+                           decl_parser.ParseBlock(package.get()),
+                           _ << "@ " << filename_str);
+      if (decl.is_top) {
+        XLS_RETURN_IF_ERROR(package->SetTop(block));
+      }
+    } else if (decl.kind == "chan") {
+      XLS_RETURN_IF_ERROR(decl_parser.ParseChannel(package.get()).status())
+          << "@ " << filename_str;
+    } else {
+      XLS_RETURN_IF_ERROR(decl_parser.ParseFileNumber(package.get()))
+          << "@ " << filename_str;
+    }
+  }
+  XLS_RETURN_IF_ERROR(VerifyAndSwapError(package.get()));
+  return package;
+}
+
+/* static */
+absl::StatusOr<std::unique_ptr<Package>>
+Parser::ParsePackageConcurrentlyNoVerify(
+    std::string_view input_string, std::optional<std::string_view> filename,
+    int64_t thread_count) {
+  std::string filename_str =
+      (filename.has_value() ? std::string(filename.value()) : "<unknown file>");
+  XLS_ASSIGN_OR_RETURN(auto scanner, Scanner::Create(input_string));
+  Parser parser(std::move(scanner));
+  XLS_ASSIGN_OR_RETURN(std::string package_name, parser.ParsePackageName());
+  XLS_ASSIGN_OR_RETURN(DeclarationIndex index,
+                       IndexDeclarations(&parser.scanner_, filename_str));
+  const std::vector<Declaration>& declarations = index.declarations;
+
+  auto make_parser =
+      [&](const Declaration& decl) -> absl::StatusOr<std::unique_ptr<Parser>> {
+    XLS_ASSIGN_OR_RETURN(
+        Scanner decl_scanner,
+        Scanner::Create(
+            input_string.substr(decl.start, decl.end - decl.start), decl.pos));
+    return absl::WrapUnique(new Parser(std::move(decl_scanner)));
+  };
+
+  // File numbers and channels are cheap to parse and are needed by the
+  // entities so they are parsed up front. Each function, proc and block is
+  // assigned to the wave after the latest wave of the entities it refers to.
+  // References to entities which are not defined earlier in the text and uses
+  // of channels which are not declared earlier are errors in a serial parse.
+  auto package = std::make_unique<Package>(package_name);
+  std::vector<std::vector<int64_t>> waves;
+  absl::flat_hash_map<std::string, int64_t> entity_waves;
+  absl::flat_hash_set<int64_t> declared_channel_ids;
+  for (int64_t i = 0; i < declarations.size(); ++i) {
+    const Declaration& decl = declarations[i];
+    if (decl.kind == "chan" || decl.kind == "file_number") {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Parser> decl_parser,
+                           make_parser(decl));
+      if (decl.kind == "chan") {
+        XLS_RETURN_IF_ERROR(decl_parser->ParseChannel(package.get()).status());
+        declared_channel_ids.insert(decl.channel_ids.front());
+      } else {
+        XLS_RETURN_IF_ERROR(decl_parser->ParseFileNumber(package.get()));
+      }
+      continue;
+    }
+    int64_t wave = 0;
+    for (const std::string& reference : decl.references) {
+      auto it = entity_waves.find(reference);
+      if (it == entity_waves.end()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "`%s` refers to `%s` which is not defined before it", decl.name,
+            reference));
+      }
+      wave = std::max(wave, it->second + 1);
+    }
+    for (int64_t channel_id : decl.channel_ids) {
+      if (!declared_channel_ids.contains(channel_id)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "`%s` uses channel %d which is not declared before it", decl.name,
+            channel_id));
+      }
+    }
+    entity_waves[decl.name] = wave;
+    if (wave >= waves.size()) {
+      waves.resize(wave + 1);
+    }
+    waves[wave].push_back(i);
+  }
+
+  // Parse the bodies of each wave concurrently. The package is only modified
+  // between waves when the parsed entities are built (i.e., added to the
+  // package) so that the entities of a wave may look up the entities of
+  // earlier waves.
+  std::vector<FunctionBase*> function_bases(declarations.size(), nullptr);
+  for (const std::vector<int64_t>& wave : waves) {
+    std::vector<absl::StatusOr<ParsedFunctionBase>> wave_results(wave.size());
+    std::atomic<int64_t> next_index = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_index.fetch_add(1); i < wave.size();
+           i = next_index.fetch_add(1)) {
+        const Declaration& decl = declarations[wave[i]];
+        absl::StatusOr<std::unique_ptr<Parser>> decl_parser = make_parser(decl);
+        if (!decl_parser.ok()) {
+          wave_results[i] = decl_parser.status();
+        } else if (decl.kind == "fn") {
+          wave_results[i] = (*decl_parser)->ParseFunctionBody(package.get());
+        } else if (decl.kind == "proc") {
+          wave_results[i] = (*decl_parser)->ParseProcBody(package.get());
+        } else {
+          wave_results[i] = (*decl_parser)->ParseBlockBody(package.get());
+        }
+      }
+    };
+    int64_t wave_thread_count = std::min<int64_t>(thread_count, wave.size());
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < wave_thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    worker();
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+    for (int64_t i = 0; i < wave.size(); ++i) {
+      XLS_RETURN_IF_ERROR(wave_results[i].status());
+      XLS_ASSIGN_OR_RETURN(
+          function_bases[wave[i]],
+          BuildFunctionBase(std::move(wave_results[i]).value()));
+      if (declarations[wave[i]].is_top) {
+        XLS_RETURN_IF_ERROR(package->SetTop(function_bases[wave[i]]));
+      }
+    }
+  }
+
+  // Entities are built wave by wave; restore the order of the text.
+  std::vector<FunctionBase*> text_order;
+  for (FunctionBase* f : function_bases) {
+    if (f != nullptr) {
+      text_order.push_back(f);
+    }
+  }
+  XLS_RETURN_IF_ERROR(package->ReorderFunctionBases(text_order));
+  return package;
+}
+
+/* static */
+absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackageFromFile(
+    const std::filesystem::path& path,
+    absl::Span<const std::string> entity_names) {
+  XLS_ASSIGN_OR_RETURN(MemoryMappedFile file, MemoryMappedFile::Open(path));
+  if (entity_names.empty() || IsBinaryIr(file.contents())) {
+    return ParsePackage(file.contents(), path.string());
+  }
+  return ParsePackageSubset(file.contents(), entity_names, path.string());
+}
+
 /* static */
 absl::StatusOr<Value> Parser::ParseValue(std::string_view input_string,
                                          Type* expected_type) {
+  std::optional<Value> value = TryParseValueFast(input_string, expected_type);
+  if (value.has_value()) {
+    return *std::move(value);
+  }
   XLS_ASSIGN_OR_RETURN(auto scanner, Scanner::Create(input_string));
   Parser p(std::move(scanner));
   return p.ParseValueInternal(expected_type);
@@ -2077,6 +2586,10 @@ absl::StatusOr<Value> Parser::ParseValue(std::string_view input_string,
 
 /* static */
 absl::StatusOr<Value> Parser::ParseTypedValue(std::string_view input_string) {
+  std::optional<Value> value = TryParseValueFast(input_string);
+  if (value.has_value()) {
+    return *std::move(value);
+  }
   XLS_ASSIGN_OR_RETURN(auto scanner, Scanner::Create(input_string));
   Parser p(std::move(scanner));
   return p.ParseValueInternal(/*expected_type=*/absl::nullopt);
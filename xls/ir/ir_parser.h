@@ -22,12 +22,14 @@
 #ifndef XLS_IR_IR_PARSER_H_
 #define XLS_IR_IR_PARSER_H_
 
+#include <filesystem>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
 #include "xls/ir/channel.h"
@@ -48,10 +50,22 @@ class ArgParser;
 
 class Parser {
  public:
-  // Parses the given input string as a package.
+  // Parses the given input string as a package. The input may be either the
+  // text IR format or the binary IR format (see binary_ir.h).
+  //
+  // If `thread_count` is greater than one the bodies of the functions, procs
+  // and blocks of a text package are parsed concurrently on up to that many
+  // threads. Entities are parsed in waves such that every entity referred to
+  // (e.g., via `to_apply=`) is added to the package before the entities
+  // referring to it are parsed, and the package is only modified between
+  // waves. The resulting package is identical to the one produced by a serial
+  // parse except that the ids of nodes without an `id=` attribute or a
+  // numbered name may differ between runs. Errors are reported exactly as by
+  // a serial parse.
   static absl::StatusOr<std::unique_ptr<Package>> ParsePackage(
       std::string_view input_string,
-      std::optional<std::string_view> filename = absl::nullopt);
+      std::optional<std::string_view> filename = absl::nullopt,
+      int64_t thread_count = 1);
 
   // As above, but sets the entry function to be the given name in the returned
   // package.
@@ -59,6 +73,26 @@ class Parser {
       std::string_view input_string, std::string_view entry,
       std::optional<std::string_view> filename = absl::nullopt);
 
+  // Parses only the named functions, procs and blocks of the package in the
+  // given input string along with the functions, procs and blocks they
+  // transitively refer to (e.g., via `to_apply=`). The procs communicating with
+  // a parsed proc over a channel and the channels they use are parsed as well
+  // as all file numbers. The remaining declarations are skipped at the token
+  // level without constructing any IR which makes extracting a small part of a
+  // large package much cheaper than a full parse. If `entity_names` is empty
+  // the top entity is parsed.
+  static absl::StatusOr<std::unique_ptr<Package>> ParsePackageSubset(
+      std::string_view input_string, absl::Span<const std::string> entity_names,
+      std::optional<std::string_view> filename = absl::nullopt);
+
+  // Parses the package in the given file. The file is memory mapped rather
+  // than read into a string. If `entity_names` is non-empty only those
+  // entities (and their dependencies) are parsed as in ParsePackageSubset.
+  // Binary IR files are always parsed in full.
+  static absl::StatusOr<std::unique_ptr<Package>> ParsePackageFromFile(
+      const std::filesystem::path& path,
+      absl::Span<const std::string> entity_names = {});
+
   // Parse the input_string as a function into the given package.
   // If verify_function_only is true, then only this new function is verified,
   // otherwise the whole package is verified by default.
@@ -103,7 +137,8 @@ class Parser {
       std::optional<std::string_view> entry = absl::nullopt);
 
   // Parses a literal value that should be of type "expected_type" and returns
-  // it.
+  // it. Values in the form emitted by Value::ToString are parsed without
+  // going through the scanner (see value_parser.h).
   static absl::StatusOr<Value> ParseValue(std::string_view input_string,
                                           Type* expected_type);
 
@@ -118,7 +153,7 @@ class Parser {
  private:
   friend class ArgParser;
 
-  explicit Parser(Scanner scanner) : scanner_(scanner) {}
+  explicit Parser(Scanner scanner) : scanner_(std::move(scanner)) {}
 
   // Parse a function starting at the current scanner position.
   absl::StatusOr<Function*> ParseFunction(Package* package);
@@ -274,6 +309,33 @@ class Parser {
   };
   absl::StatusOr<BlockSignature> ParseBlockSignature(Package* package);
 
+  // A function, proc or block whose body has been parsed but which has not
+  // been added to the package. The builders add the entity to the package when
+  // built so deferring the build allows bodies to be parsed concurrently.
+  struct ParsedFunctionBase {
+    std::unique_ptr<BuilderBase> builder;
+    BodyResult body_result;
+    // The signature of a block. Unset for functions and procs.
+    std::optional<BlockSignature> block_signature;
+  };
+
+  // Parse a function, proc or block starting at the current scanner position
+  // without adding it to the package.
+  absl::StatusOr<ParsedFunctionBase> ParseFunctionBody(Package* package);
+  absl::StatusOr<ParsedFunctionBase> ParseProcBody(Package* package);
+  absl::StatusOr<ParsedFunctionBase> ParseBlockBody(Package* package);
+
+  // Builds the parsed function, proc or block, adding it to its package.
+  static absl::StatusOr<FunctionBase*> BuildFunctionBase(
+      ParsedFunctionBase parsed);
+
+  // Parses the text package in the given input string, parsing the bodies of
+  // its functions, procs and blocks concurrently. See ParsePackage.
+  static absl::StatusOr<std::unique_ptr<Package>>
+  ParsePackageConcurrentlyNoVerify(std::string_view input_string,
+                                   std::optional<std::string_view> filename,
+                                   int64_t thread_count);
+
   // Pops the package name out of the scanner, of the form:
   //
   //  "package" <name>
@@ -18,6 +18,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/strings/substitute.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/source_location.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits_ops.h"
@@ -2981,4 +2982,165 @@ top reg
                HasSubstr("Expected fn, proc or block definition, got")));
 }
 
+constexpr std::string_view kSubsetPackage = R"(
+package subset
+
+file_number 0 "fake/file.x"
+
+chan ch(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=ready_valid, metadata="""""")
+
+fn body(x: bits[11], y: bits[11]) -> bits[11] {
+  ret add.1: bits[11] = add(x, y, id=1)
+}
+
+fn unused(x: bits[11]) -> bits[11] {
+  ret neg.2: bits[11] = neg(x, id=2)
+}
+
+fn looper(x: bits[11]) -> bits[11] {
+  ret counted_for.3: bits[11] = counted_for(x, trip_count=7, stride=1, body=body, id=3)
+}
+
+top fn main(x: bits[11]) -> bits[11] {
+  ret invoke.4: bits[11] = invoke(x, to_apply=looper, id=4)
+}
+
+proc producer(tkn: token, st: bits[32], init={42}) {
+  send.5: token = send(tkn, st, channel_id=0, id=5)
+  next (send.5, st)
+}
+
+proc consumer(tkn: token, st: bits[32], init={0}) {
+  receive.6: (token, bits[32]) = receive(tkn, channel_id=0, id=6)
+  tuple_index.7: token = tuple_index(receive.6, index=0, id=7)
+  next (tuple_index.7, st)
+}
+)";
+
+TEST(IrParserTest, ParsePackageSubset) {
+  std::vector<std::string> names = {"main"};
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> pkg,
+                           Parser::ParsePackageSubset(kSubsetPackage, names));
+  EXPECT_EQ(pkg->name(), "subset");
+  ASSERT_EQ(pkg->functions().size(), 3);
+  EXPECT_EQ(pkg->functions()[0]->name(), "body");
+  EXPECT_EQ(pkg->functions()[1]->name(), "looper");
+  EXPECT_EQ(pkg->functions()[2]->name(), "main");
+  EXPECT_TRUE(pkg->procs().empty());
+  EXPECT_TRUE(pkg->channels().empty());
+  EXPECT_THAT(pkg->GetFilename(Fileno(0)),
+              Optional(std::string("fake/file.x")));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, pkg->GetFunction("main"));
+  EXPECT_EQ(pkg->GetTop().value(), main);
+}
+
+TEST(IrParserTest, ParsePackageSubsetDefaultsToTop) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> pkg,
+                           Parser::ParsePackageSubset(kSubsetPackage, {}));
+  EXPECT_EQ(pkg->functions().size(), 3);
+  EXPECT_THAT(pkg->GetFunction("unused").status(),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(IrParserTest, ParsePackageSubsetProc) {
+  // The producer is parsed because it sends on the channel the consumer
+  // receives on.
+  std::vector<std::string> names = {"consumer", "unused"};
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> pkg,
+                           Parser::ParsePackageSubset(kSubsetPackage, names));
+  ASSERT_EQ(pkg->functions().size(), 1);
+  EXPECT_EQ(pkg->functions()[0]->name(), "unused");
+  ASSERT_EQ(pkg->procs().size(), 2);
+  EXPECT_EQ(pkg->procs()[0]->name(), "producer");
+  EXPECT_EQ(pkg->procs()[1]->name(), "consumer");
+  EXPECT_EQ(pkg->channels().size(), 1);
+  EXPECT_FALSE(pkg->GetTop().has_value());
+}
+
+TEST(IrParserTest, ParsePackageSubsetUnknownEntity) {
+  std::vector<std::string> names = {"not_there"};
+  EXPECT_THAT(Parser::ParsePackageSubset(kSubsetPackage, names),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("No function, proc or block named "
+                                 "`not_there`")));
+}
+
+TEST(IrParserTest, ParsePackageFromFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file,
+                           TempFile::CreateWithContent(kSubsetPackage, ".ir"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> full,
+                           Parser::ParsePackageFromFile(file.path()));
+  EXPECT_EQ(full->functions().size(), 4);
+  EXPECT_EQ(full->procs().size(), 2);
+
+  std::vector<std::string> names = {"looper"};
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> subset,
+                           Parser::ParsePackageFromFile(file.path(), names));
+  EXPECT_EQ(subset->functions().size(), 2);
+}
+
+TEST(IrParserTest, ParsePackageConcurrently) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> serial,
+                           Parser::ParsePackage(kSubsetPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Package> concurrent,
+      Parser::ParsePackage(kSubsetPackage, /*filename=*/absl::nullopt,
+                           /*thread_count=*/4));
+  EXPECT_EQ(concurrent->DumpIr(), serial->DumpIr());
+  EXPECT_EQ(concurrent->next_node_id(), serial->next_node_id());
+  ASSERT_TRUE(concurrent->GetTop().has_value());
+  EXPECT_EQ(concurrent->GetTop().value()->name(), "main");
+}
+
+TEST(IrParserTest, ParsePackageWithBlocksConcurrently) {
+  const std::string input = R"(package test
+
+block sub_block(in: bits[38], out: bits[32]) {
+  in: bits[38] = input_port(name=in, id=1)
+  zero: bits[32] = literal(value=0, id=2)
+  out: () = output_port(zero, name=out, id=3)
+}
+
+block other_block(clk: clock, in: bits[32], out: bits[32]) {
+  reg foo(bits[32])
+  in: bits[32] = input_port(name=in, id=8)
+  foo_d: () = register_write(in, register=foo, id=10)
+  foo_q: bits[32] = register_read(register=foo, id=9)
+  out: () = output_port(foo_q, name=out, id=11)
+}
+
+block my_block(x: bits[8], y: bits[32]) {
+  instantiation foo(block=sub_block, kind=block)
+  x: bits[8] = input_port(name=x, id=4)
+  foo_in: () = instantiation_input(x, instantiation=foo, port_name=in, id=5)
+  foo_out: bits[32] = instantiation_output(instantiation=foo, port_name=out, id=6)
+  y: () = output_port(foo_out, name=y, id=7)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Package> package,
+      Parser::ParsePackage(input, /*filename=*/absl::nullopt,
+                           /*thread_count=*/2));
+  ExpectStringsSimilar(package->DumpIr(), input);
+}
+
+TEST(IrParserTest, ParsePackageConcurrentlyReportsSerialError) {
+  const std::string input = R"(package test
+
+fn f(x: bits[32]) -> bits[32] {
+  ret invoke.1: bits[32] = invoke(x, to_apply=g, id=1)
+}
+
+fn g(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x, id=2)
+}
+)";
+  absl::Status serial = Parser::ParsePackage(input).status();
+  ASSERT_FALSE(serial.ok());
+  EXPECT_EQ(Parser::ParsePackage(input, /*filename=*/absl::nullopt,
+                                 /*thread_count=*/2)
+                .status(),
+            serial);
+}
+
 }  // namespace xls
@@ -114,18 +114,50 @@ std::string Token::ToString() const {
 
 namespace {
 
-// Helper class for tokenizing a string.
-// TODO(meheff): This could be combined into Scanner class and made lazy at the
-// same time.
+// Helper class for tokenizing a string one token at a time.
 class Tokenizer {
  public:
+  // Creates a tokenizer which starts at the given index of the string. The
+  // lineno and colno are those of the character at the index.
+  Tokenizer(std::string_view str, int64_t index, int64_t lineno, int64_t colno)
+      : str_(str), index_(index), lineno_(lineno), colno_(colno) {}
+
   // Tokenizes the given string and returns the vector of Tokens.
   static absl::StatusOr<std::vector<Token>> TokenizeString(
       std::string_view str) {
-    Tokenizer tokenizer(str);
-    return tokenizer.Tokenize();
+    Tokenizer tokenizer(str, /*index=*/0, /*lineno=*/0, /*colno=*/0);
+    std::vector<Token> tokens;
+    while (true) {
+      XLS_ASSIGN_OR_RETURN(std::optional<Token> token, tokenizer.Next());
+      if (!token.has_value()) {
+        return tokens;
+      }
+      tokens.push_back(*std::move(token));
+    }
+  }
+
+  // Returns the next token in the string or std::nullopt if the end of the
+  // string has been reached. If `start_index` is non-null it is set to the
+  // index of the first character of the returned token.
+  absl::StatusOr<std::optional<Token>> Next(int64_t* start_index = nullptr) {
+    while (DropWhiteSpace() || DropEndOfLineComment()) {
+    }
+    if (EndOfString()) {
+      return std::nullopt;
+    }
+    if (start_index != nullptr) {
+      *start_index = index();
+    }
+    return NextToken();
   }
 
+  // Returns the current index in the string.
+  int64_t index() const { return index_; }
+
+  // Returns the current line/column number.
+  int64_t lineno() const { return lineno_; }
+  int64_t colno() const { return colno_; }
+
  private:
   // Drops all whitespace starting at current index. Returns true if any
   // whitespace was dropped.
@@ -222,127 +254,115 @@ class Tokenizer {
     return std::string_view(str_.data() + start, index_ - start);
   }
 
-  // Tokenizes the internal string.
-  absl::StatusOr<std::vector<Token>> Tokenize() {
-    std::vector<Token> tokens;
-    while (!EndOfString()) {
-      if (DropWhiteSpace() || DropEndOfLineComment()) {
-        continue;
-      }
+  // Tokenizes the token starting at the current index, which must not be at
+  // whitespace, a comment or the end of the string.
+  absl::StatusOr<Token> NextToken() {
+    const int64_t start_lineno = lineno();
+    const int64_t start_colno = colno();
+
+    // Literal numbers can decimal, binary (eg, 0b0101) or hexadecimal (eg,
+    // 0xbeef) so capture all alphanumeric characters after the initial
+    // digit. Literal numbers can also contain '_'s after the first
+    // character which are used to improve readability (example:
+    // '0xabcd_ef00').
+    if (isdigit(current()) ||
+        (current() == '-' && next().has_value() && isdigit(*next()))) {
+      std::string_view value = CaptureWhile(
+          [](char c) { return absl::ascii_isalnum(c) || c == '_'; },
+          /*min_chars=*/1);
+      return Token(LexicalTokenType::kLiteral, value, start_lineno,
+                   start_colno);
+    }
 
-      const int64_t start_lineno = lineno();
-      const int64_t start_colno = colno();
-
-      // Literal numbers can decimal, binary (eg, 0b0101) or hexadecimal (eg,
-      // 0xbeef) so capture all alphanumeric characters after the initial
-      // digit. Literal numbers can also contain '_'s after the first
-      // character which are used to improve readability (example:
-      // '0xabcd_ef00').
-      if (isdigit(current()) ||
-          (current() == '-' && next().has_value() && isdigit(*next()))) {
-        std::string_view value = CaptureWhile(
-            [](char c) { return absl::ascii_isalnum(c) || c == '_'; },
-            /*min_chars=*/1);
-        tokens.push_back(Token(LexicalTokenType::kLiteral, value, start_lineno,
-                               start_colno));
-        continue;
-      }
+    if (isalpha(current()) || current() == '_') {
+      std::string_view value = CaptureWhile([](char c) {
+        return isalpha(c) || c == '_' || c == '.' || isdigit(c);
+      });
+      return Token::MakeIdentOrKeyword(value, start_lineno, start_colno);
+    }
 
-      if (isalpha(current()) || current() == '_') {
-        std::string_view value = CaptureWhile([](char c) {
-          return isalpha(c) || c == '_' || c == '.' || isdigit(c);
-        });
-        tokens.push_back(
-            Token::MakeIdentOrKeyword(value, start_lineno, start_colno));
-        continue;
-      }
+    // Look for multi-character tokens.
+    if (MatchSubstring("->")) {
+      Advance(2);
+      return Token(LexicalTokenType::kRightArrow, "->", start_lineno,
+                   start_colno);
+    }
 
-      // Look for multi-character tokens.
-      if (MatchSubstring("->")) {
-        tokens.push_back(Token(LexicalTokenType::kRightArrow, "->",
-                               start_lineno, start_colno));
-        Advance(2);
-        continue;
-      }
+    // Match quoted strings. Double-quoted strings (e.g., "foo") and
+    // triple-double-quoted strings (e.g., """foo""") are allowed. Only
+    // triple-double-quoted strings can contain new lines.
+    std::optional<std::string_view> content;
+    XLS_ASSIGN_OR_RETURN(
+        content, MatchQuotedString("\"\"\"", /*allow_multiline=*/true));
+    if (content.has_value()) {
+      return Token(LexicalTokenType::kQuotedString, content.value(),
+                   start_lineno, start_colno);
+    }
+    XLS_ASSIGN_OR_RETURN(content,
+                         MatchQuotedString("\"", /*allow_multiline=*/false));
+    if (content.has_value()) {
+      return Token(LexicalTokenType::kQuotedString, content.value(),
+                   start_lineno, start_colno);
+    }
 
-      // Match quoted strings. Double-quoted strings (e.g., "foo") and
-      // triple-double-quoted strings (e.g., """foo""") are allowed. Only
-      // triple-double-quoted strings can contain new lines.
-      std::optional<std::string_view> content;
-      XLS_ASSIGN_OR_RETURN(
-          content, MatchQuotedString("\"\"\"", /*allow_multiline=*/true));
-      if (content.has_value()) {
-        tokens.push_back(Token(LexicalTokenType::kQuotedString, content.value(),
-                               start_lineno, start_colno));
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(content,
-                           MatchQuotedString("\"", /*allow_multiline=*/false));
-      if (content.has_value()) {
-        tokens.push_back(Token(LexicalTokenType::kQuotedString, content.value(),
-                               start_lineno, start_colno));
-        continue;
-      }
+    // Handle single-character tokens.
+    LexicalTokenType token_type;
 
-      // Handle single-character tokens.
-      LexicalTokenType token_type;
-
-      switch (current()) {
-        case '-':
-          token_type = LexicalTokenType::kMinus;
-          break;
-        case '+':
-          token_type = LexicalTokenType::kAdd;
-          break;
-        case '.':
-          token_type = LexicalTokenType::kDot;
-          break;
-        case ':':
-          token_type = LexicalTokenType::kColon;
-          break;
-        case ',':
-          token_type = LexicalTokenType::kComma;
-          break;
-        case '=':
-          token_type = LexicalTokenType::kEquals;
-          break;
-        case '[':
-          token_type = LexicalTokenType::kBracketOpen;
-          break;
-        case ']':
-          token_type = LexicalTokenType::kBracketClose;
-          break;
-        case '{':
-          token_type = LexicalTokenType::kCurlOpen;
-          break;
-        case '}':
-          token_type = LexicalTokenType::kCurlClose;
-          break;
-        case '(':
-          token_type = LexicalTokenType::kParenOpen;
-          break;
-        case ')':
-          token_type = LexicalTokenType::kParenClose;
-          break;
-        case '>':
-          token_type = LexicalTokenType::kGt;
-          break;
-        case '<':
-          token_type = LexicalTokenType::kLt;
-          break;
-        default:
-          std::string char_str = absl::ascii_iscntrl(current())
-                                     ? absl::StrFormat("\\x%02x", current())
-                                     : std::string(1, current());
-          XLS_LOG(ERROR) << "IR text with error: " << str_;
-          return absl::InvalidArgumentError(absl::StrFormat(
-              "Invalid character in IR text \"%s\" @ %s", char_str,
-              TokenPos{lineno(), colno()}.ToHumanString()));
-      }
-      tokens.push_back(Token(token_type, lineno(), colno()));
-      Advance();
+    switch (current()) {
+      case '-':
+        token_type = LexicalTokenType::kMinus;
+        break;
+      case '+':
+        token_type = LexicalTokenType::kAdd;
+        break;
+      case '.':
+        token_type = LexicalTokenType::kDot;
+        break;
+      case ':':
+        token_type = LexicalTokenType::kColon;
+        break;
+      case ',':
+        token_type = LexicalTokenType::kComma;
+        break;
+      case '=':
+        token_type = LexicalTokenType::kEquals;
+        break;
+      case '[':
+        token_type = LexicalTokenType::kBracketOpen;
+        break;
+      case ']':
+        token_type = LexicalTokenType::kBracketClose;
+        break;
+      case '{':
+        token_type = LexicalTokenType::kCurlOpen;
+        break;
+      case '}':
+        token_type = LexicalTokenType::kCurlClose;
+        break;
+      case '(':
+        token_type = LexicalTokenType::kParenOpen;
+        break;
+      case ')':
+        token_type = LexicalTokenType::kParenClose;
+        break;
+      case '>':
+        token_type = LexicalTokenType::kGt;
+        break;
+      case '<':
+        token_type = LexicalTokenType::kLt;
+        break;
+      default:
+        std::string char_str = absl::ascii_iscntrl(current())
+                                   ? absl::StrFormat("\\x%02x", current())
+                                   : std::string(1, current());
+        XLS_LOG(ERROR) << "IR text with error: " << str_;
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Invalid character in IR text \"%s\" @ %s", char_str,
+            TokenPos{lineno(), colno()}.ToHumanString()));
     }
-    return tokens;
+    Token token(token_type, lineno(), colno());
+    Advance();
+    return token;
   }
 
   // Returns the character at the current index.
@@ -357,16 +377,6 @@ class Tokenizer {
     return absl::nullopt;
   }
 
-  // Returns the current index in the string.
-  int64_t index() const { return index_; }
-
-  // Returns the current line/column number.
-  int64_t lineno() const { return lineno_; }
-  int64_t colno() const { return colno_; }
-
- private:
-  explicit Tokenizer(std::string_view str) : str_(str) {}
-
   // The string being tokenized.
   std::string_view str_;
 
@@ -384,20 +394,49 @@ absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str) {
   return Tokenizer::TokenizeString(str);
 }
 
-absl::StatusOr<Scanner> Scanner::Create(std::string_view text) {
-  XLS_ASSIGN_OR_RETURN(auto tokens, TokenizeString(text));
-  return Scanner(std::move(tokens));
+absl::StatusOr<Scanner> Scanner::Create(std::string_view text,
+                                        TokenPos start) {
+  return Scanner(text, start);
+}
+
+absl::Status Scanner::FillLookahead(int64_t count) const {
+  while (lookahead_.size() < count && !at_end_of_text_) {
+    XLS_RETURN_IF_ERROR(lexical_error_);
+    Tokenizer tokenizer(text_, next_index_, next_pos_.lineno,
+                        next_pos_.colno);
+    int64_t offset;
+    absl::StatusOr<std::optional<Token>> token = tokenizer.Next(&offset);
+    if (!token.ok()) {
+      lexical_error_ = token.status();
+      return lexical_error_;
+    }
+    next_index_ = tokenizer.index();
+    next_pos_ = TokenPos{tokenizer.lineno(), tokenizer.colno()};
+    if (!token->has_value()) {
+      at_end_of_text_ = true;
+      break;
+    }
+    lookahead_.push_back(BufferedToken{**std::move(token), offset});
+  }
+  return absl::OkStatus();
+}
+
+int64_t Scanner::PeekTokenOffset() const {
+  FillLookahead(1).IgnoreError();
+  return lookahead_.empty() ? text_.size() : lookahead_.front().offset;
 }
 
 absl::StatusOr<Token> Scanner::PeekToken() const {
-  if (AtEof()) {
+  XLS_RETURN_IF_ERROR(FillLookahead(1));
+  if (lookahead_.empty()) {
     return absl::InvalidArgumentError("Expected token, but found EOF.");
   }
-  return tokens_[token_idx_];
+  return lookahead_.front().token;
 }
 
 absl::StatusOr<Token> Scanner::PopTokenOrError(std::string_view context) {
-  if (AtEof()) {
+  XLS_RETURN_IF_ERROR(FillLookahead(1));
+  if (lookahead_.empty()) {
     std::string context_str =
         context.empty() ? std::string("") : absl::StrCat(" in ", context);
     return absl::InvalidArgumentError("Expected token" + context_str +
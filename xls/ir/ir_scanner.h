@@ -16,7 +16,10 @@
 #define XLS_IR_IR_SCANNER_H_
 
 #include <cstdint>
+#include <deque>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
@@ -124,14 +127,22 @@ inline std::ostream& operator<<(std::ostream& os, const Token& token) {
 }
 
 // Tokenizes the given string and returns the tokens. It maintains precise
-// source location information.  Right now this is a eager implementation - it
-// tokenizes the whole input. This can be easily changed later to a more demand
-// driven tokenization.
+// source location information. This tokenizes the whole input; Scanner
+// provides demand-driven tokenization.
 absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str);
 
+// Produces the tokens of a text on demand. Only a small window of lookahead
+// tokens is held in memory at any time so the memory used does not grow with
+// the size of the text. The text must outlive the scanner.
 class Scanner {
  public:
-  static absl::StatusOr<Scanner> Create(std::string_view text);
+  // Creates a scanner for the given text. The text is tokenized on demand, so a
+  // lexical error is only reported once the scanner reaches it, by the methods
+  // peeking at or popping tokens which return a status. The positions of the
+  // tokens are relative to `start` which allows scanning a fragment of a
+  // larger text.
+  static absl::StatusOr<Scanner> Create(std::string_view text,
+                                        TokenPos start = TokenPos{0, 0});
 
   // Peeks at the next token in the token stream, or returns an error if we're
   // at EOF and no more tokens are available.
@@ -139,26 +150,36 @@ class Scanner {
 
   // Return the current token.
   const Token& PeekTokenOrDie() const {
-    XLS_CHECK(!AtEof());
-    return tokens_[token_idx_];
+    XLS_CHECK_OK(FillLookahead(1));
+    XLS_CHECK(!lookahead_.empty());
+    return lookahead_.front().token;
   }
 
+  // Returns the offset in the text of the first character of the next token,
+  // or the size of the text if at EOF.
+  int64_t PeekTokenOffset() const;
+
   // Returns true if the next token is the given type.
   bool PeekTokenIs(LexicalTokenType target) const {
-    return !AtEof() && PeekTokenOrDie().type() == target;
+    return FillLookahead(1).ok() && !lookahead_.empty() &&
+           lookahead_.front().token.type() == target;
   }
 
   // Returns true if the nth next token is the given type. If `n` is zero this
   // peeks at the immediate next token.
   bool PeekNthTokenIs(int64_t n, LexicalTokenType target) const {
-    return (token_idx_ + n < tokens_.size()) &&
-           tokens_[token_idx_ + n].type() == target;
+    FillLookahead(n + 1).IgnoreError();
+    return n < lookahead_.size() && lookahead_[n].token.type() == target;
   }
 
   // Pop the current token, advance token pointer to next token.
   Token PopToken() {
-    XLS_VLOG(6) << "Popping token: " << tokens_[token_idx_];
-    return tokens_.at(token_idx_++);
+    XLS_CHECK_OK(FillLookahead(1));
+    XLS_CHECK(!lookahead_.empty());
+    Token token = std::move(lookahead_.front().token);
+    lookahead_.pop_front();
+    XLS_VLOG(6) << "Popping token: " << token;
+    return token;
   }
 
   // Same as PopToken() but returns a status error if we are at EOF (in which
@@ -204,14 +225,36 @@ class Scanner {
   // Returns an absl::Status error if we cannot.
   absl::Status DropKeywordOrError(std::string_view keyword);
 
-  // Check if more tokens are available.
-  bool AtEof() const { return token_idx_ >= tokens_.size(); }
+  // Check if more tokens are available. A lexical error is not EOF: it is
+  // returned by the next attempt to peek at or pop a token.
+  bool AtEof() const { return FillLookahead(1).ok() && lookahead_.empty(); }
 
  private:
-  explicit Scanner(std::vector<Token> tokens) : tokens_(tokens) {}
-
-  int64_t token_idx_ = 0;
-  std::vector<Token> tokens_;
+  // A token along with the offset of its first character in the text.
+  struct BufferedToken {
+    Token token;
+    int64_t offset;
+  };
+
+  Scanner(std::string_view text, TokenPos start)
+      : text_(text), next_pos_(start) {}
+
+  // Tokenizes the text until at least `count` tokens are buffered or the end of
+  // the text is reached. Returns the lexical error, if any, preventing `count`
+  // tokens from being buffered.
+  absl::Status FillLookahead(int64_t count) const;
+
+  std::string_view text_;
+
+  // The tokenized but not yet popped tokens. These are produced lazily (hence
+  // `mutable`) as the scanner is queried.
+  mutable std::deque<BufferedToken> lookahead_;
+  // The index and position in the text at which tokenization resumes.
+  mutable int64_t next_index_ = 0;
+  mutable TokenPos next_pos_;
+  mutable bool at_end_of_text_ = false;
+  // The lexical error at the position where tokenization resumes, if any.
+  mutable absl::Status lexical_error_;
 };
 
 }  // namespace xls
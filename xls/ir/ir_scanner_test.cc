@@ -162,6 +162,51 @@ foo
 bar)"));
 }
 
+TEST(IrScannerTest, ScannerProducesTokensOnDemand) {
+  std::string text = "fn foo x // comment\n  bar {";
+  XLS_ASSERT_OK_AND_ASSIGN(Scanner scanner, Scanner::Create(text));
+  EXPECT_TRUE(scanner.PeekNthTokenIs(3, LexicalTokenType::kIdent));
+  EXPECT_TRUE(scanner.PeekNthTokenIs(4, LexicalTokenType::kCurlOpen));
+  EXPECT_FALSE(scanner.PeekNthTokenIs(5, LexicalTokenType::kCurlOpen));
+  std::vector<std::string> values;
+  std::vector<int64_t> offsets;
+  while (!scanner.AtEof()) {
+    offsets.push_back(scanner.PeekTokenOffset());
+    values.push_back(scanner.PopToken().value());
+  }
+  EXPECT_THAT(values, ElementsAre("fn", "foo", "x", "bar", ""));
+  EXPECT_THAT(offsets, ElementsAre(0, 3, 7, 22, 26));
+  EXPECT_EQ(scanner.PeekTokenOffset(), text.size());
+  EXPECT_FALSE(scanner.PeekToken().ok());
+}
+
+TEST(IrScannerTest, ScannerReportsLexicalErrorsWhenReached) {
+  XLS_ASSERT_OK_AND_ASSIGN(Scanner scanner, Scanner::Create("fn foo $ bar"));
+  EXPECT_TRUE(scanner.PeekNthTokenIs(1, LexicalTokenType::kIdent));
+  EXPECT_FALSE(scanner.PeekNthTokenIs(2, LexicalTokenType::kIdent));
+  XLS_ASSERT_OK(scanner.DropKeywordOrError("fn"));
+  XLS_ASSERT_OK(scanner.PopTokenOrError(LexicalTokenType::kIdent).status());
+  EXPECT_FALSE(scanner.AtEof());
+  EXPECT_FALSE(scanner.PeekTokenIs(LexicalTokenType::kIdent));
+  EXPECT_THAT(scanner.PeekToken().status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid character in IR text")));
+  EXPECT_THAT(scanner.PopTokenOrError().status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid character in IR text")));
+}
+
+TEST(IrScannerTest, ScannerWithStartPosition) {
+  XLS_ASSERT_OK_AND_ASSIGN(Scanner scanner,
+                           Scanner::Create("a\n b", TokenPos{10, 4}));
+  Token a = scanner.PopToken();
+  Token b = scanner.PopToken();
+  EXPECT_EQ(a.pos().lineno, 10);
+  EXPECT_EQ(a.pos().colno, 4);
+  EXPECT_EQ(b.pos().lineno, 11);
+  EXPECT_EQ(b.pos().colno, 1);
+}
+
 TEST(IrScannerTest, UnterminatedQuotedStrings) {
   EXPECT_THAT(
       TokenizeString(R"("unterminated)").status(),
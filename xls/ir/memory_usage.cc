@@ -0,0 +1,109 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/memory_usage.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_format.h"
+#include "xls/ir/node.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+// Returns the number of heap bytes used by a list of `count` elements of
+// `element_size` bytes of which the first `inline_count` are stored inline.
+int64_t OutOfLineBytes(int64_t count, int64_t inline_count,
+                       int64_t element_size) {
+  return count > inline_count ? count * element_size : 0;
+}
+
+}  // namespace
+
+int64_t MemoryUsage::total_bytes() const {
+  return std::max(node_bytes, node_arena_bytes) + operand_bytes + user_bytes +
+         source_info_bytes + name_bytes;
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+  node_count += other.node_count;
+  node_bytes += other.node_bytes;
+  node_arena_bytes += other.node_arena_bytes;
+  operand_bytes += other.operand_bytes;
+  user_bytes += other.user_bytes;
+  source_info_bytes += other.source_info_bytes;
+  name_bytes += other.name_bytes;
+  type_count += other.type_count;
+  return *this;
+}
+
+std::string MemoryUsage::ToString() const {
+  std::string result;
+  absl::StrAppendFormat(&result, "Nodes: %d\n", node_count);
+  absl::StrAppendFormat(&result, "  Node objects:       %d bytes\n",
+                        node_bytes);
+  absl::StrAppendFormat(&result, "  Node arenas:        %d bytes\n",
+                        node_arena_bytes);
+  absl::StrAppendFormat(&result, "  Operand lists:      %d bytes\n",
+                        operand_bytes);
+  absl::StrAppendFormat(&result, "  User lists:         %d bytes\n",
+                        user_bytes);
+  absl::StrAppendFormat(&result, "  Source locations:   %d bytes\n",
+                        source_info_bytes);
+  absl::StrAppendFormat(&result, "  Names:              %d bytes\n",
+                        name_bytes);
+  absl::StrAppendFormat(&result, "  Total:              %d bytes\n",
+                        total_bytes());
+  absl::StrAppendFormat(&result, "Types: %d\n", type_count);
+  return result;
+}
+
+MemoryUsage GetMemoryUsage(FunctionBase* function_base) {
+  // Capacity of the short string buffer, below which names need no heap.
+  static const int64_t kInlineNameSize = std::string().capacity();
+
+  MemoryUsage usage;
+  usage.node_arena_bytes = function_base->node_arena_bytes();
+  for (Node* node : function_base->nodes()) {
+    ++usage.node_count;
+    usage.node_bytes += node->object_size();
+    usage.operand_bytes +=
+        OutOfLineBytes(node->operand_count(), Node::kInlineOperandCount,
+                       sizeof(Node*));
+    usage.user_bytes += OutOfLineBytes(
+        node->users().size(), Node::kInlineUserCount, sizeof(Node*));
+    usage.source_info_bytes +=
+        OutOfLineBytes(node->loc().locations.size(), /*inline_count=*/1,
+                       sizeof(SourceLocation));
+    if (node->HasAssignedName()) {
+      int64_t name_size = node->GetName().size();
+      if (name_size > kInlineNameSize) {
+        usage.name_bytes += name_size + 1;
+      }
+    }
+  }
+  return usage;
+}
+
+MemoryUsage GetMemoryUsage(Package* package) {
+  MemoryUsage usage;
+  for (FunctionBase* function_base : package->GetFunctionBases()) {
+    usage += GetMemoryUsage(function_base);
+  }
+  usage.type_count = package->GetOwnedTypeCount();
+  return usage;
+}
+
+}  // namespace xls
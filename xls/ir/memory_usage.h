@@ -0,0 +1,67 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_MEMORY_USAGE_H_
+#define XLS_IR_MEMORY_USAGE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Estimate of the memory held by the IR, broken down by structure. Heap
+// storage is estimated from element counts rather than allocator capacities
+// so the numbers are lower bounds, but they are deterministic and show which
+// structures dominate for large packages.
+struct MemoryUsage {
+  int64_t node_count = 0;
+  // Bytes of the node objects themselves (see Node::object_size).
+  int64_t node_bytes = 0;
+  // Bytes reserved by the node arenas. The difference from node_bytes is
+  // slack in partially used slabs and freed nodes awaiting reuse.
+  int64_t node_arena_bytes = 0;
+  // Heap bytes of operand and user lists which do not fit inline in the node.
+  int64_t operand_bytes = 0;
+  int64_t user_bytes = 0;
+  // Heap bytes of source locations which do not fit inline in the SourceInfo.
+  int64_t source_info_bytes = 0;
+  // Heap bytes of assigned node names too long for the short string buffer.
+  int64_t name_bytes = 0;
+  // Number of distinct types owned by the package.
+  int64_t type_count = 0;
+
+  // Total of the byte counts above, counting node objects by the larger of
+  // node_bytes and node_arena_bytes.
+  int64_t total_bytes() const;
+
+  MemoryUsage& operator+=(const MemoryUsage& other);
+
+  // Returns a multi-line human-readable report.
+  std::string ToString() const;
+};
+
+// Returns the memory usage of the nodes of the given function base. The
+// type count is not set.
+MemoryUsage GetMemoryUsage(FunctionBase* function_base);
+
+// Returns the memory usage of all function bases in the package and of its
+// types.
+MemoryUsage GetMemoryUsage(Package* package);
+
+}  // namespace xls
+
+#endif  // XLS_IR_MEMORY_USAGE_H_
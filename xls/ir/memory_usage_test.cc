@@ -0,0 +1,84 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/memory_usage.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+
+class MemoryUsageTest : public IrTestBase {};
+
+TEST_F(MemoryUsageTest, SmallListsAreInline) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  MemoryUsage usage = GetMemoryUsage(f);
+  EXPECT_EQ(usage.node_count, 3);
+  EXPECT_GE(usage.node_bytes, 3 * static_cast<int64_t>(sizeof(Node)));
+  EXPECT_GE(usage.node_arena_bytes, usage.node_bytes);
+  EXPECT_EQ(usage.operand_bytes, 0);
+  EXPECT_EQ(usage.user_bytes, 0);
+  EXPECT_EQ(usage.source_info_bytes, 0);
+  EXPECT_EQ(usage.name_bytes, 0);
+  EXPECT_EQ(usage.total_bytes(), usage.node_arena_bytes);
+}
+
+TEST_F(MemoryUsageTest, LongListsAndNames) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Negate(x);
+  fb.Not(x);
+  fb.Concat({x, x, x}, SourceInfo(),
+            "a_name_much_too_long_for_the_short_string_buffer");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  MemoryUsage usage = GetMemoryUsage(f);
+  EXPECT_EQ(usage.node_count, 4);
+  // The three operands of the concat and the three users of x do not fit
+  // inline.
+  EXPECT_EQ(usage.operand_bytes, 3 * static_cast<int64_t>(sizeof(Node*)));
+  EXPECT_EQ(usage.user_bytes, 3 * static_cast<int64_t>(sizeof(Node*)));
+  EXPECT_GT(usage.name_bytes, 0);
+  EXPECT_GT(usage.total_bytes(), usage.node_arena_bytes);
+}
+
+TEST_F(MemoryUsageTest, Package) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Tuple({x, x});
+  XLS_ASSERT_OK(fb.Build().status());
+
+  MemoryUsage usage = GetMemoryUsage(p.get());
+  EXPECT_EQ(usage.node_count, 2);
+  // At least the token type, bits[8] and the tuple type.
+  EXPECT_GE(usage.type_count, 3);
+  EXPECT_THAT(usage.ToString(), HasSubstr("Nodes: 2"));
+}
+
+}  // namespace
+}  // namespace xls
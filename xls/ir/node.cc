@@ -14,6 +14,9 @@
 
 #include "xls/ir/node.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -24,6 +27,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
 #include "xls/ir/instantiation.h"
@@ -49,6 +53,7 @@ void Node::AddOperand(Node* operand) {
               << operands_.size() << " operand of " << GetName();
   operands_.push_back(operand);
   operand->AddUser(this);
+  NotifyOperandChanged();
   XLS_VLOG(3) << " " << operand->GetName()
               << " user now: " << operand->GetUsersString();
 }
@@ -72,10 +77,35 @@ absl::Status Node::AddNodeToFunctionAndReplace(
   return ReplaceUsesWith(replacement_ptr);
 }
 
-void Node::AddUser(Node* user) { users_.insert(user); }
+void Node::AddUser(Node* user) {
+  auto it = std::lower_bound(users_.begin(), users_.end(), user,
+                             NodeIdLessThan());
+  if (it == users_.end() || *it != user) {
+    users_.insert(it, user);
+  }
+}
 
 void Node::RemoveUser(Node* user) {
-  XLS_CHECK_EQ(users_.erase(user), 1) << GetName();
+  auto it = std::lower_bound(users_.begin(), users_.end(), user,
+                             NodeIdLessThan());
+  XLS_CHECK(it != users_.end() && *it == user) << GetName();
+  users_.erase(it);
+  NotifyUseRemoved();
+}
+
+void Node::AddSortedUsers(absl::Span<Node* const> users) {
+  if (users.empty()) {
+    return;
+  }
+  if (users_.empty() || NodeIdLessThan()(users_.back(), users.front())) {
+    users_.insert(users_.end(), users.begin(), users.end());
+    return;
+  }
+  absl::InlinedVector<Node*, 2> merged;
+  merged.reserve(users_.size() + users.size());
+  std::set_union(users_.begin(), users_.end(), users.begin(), users.end(),
+                 std::back_inserter(merged), NodeIdLessThan());
+  users_ = std::move(merged);
 }
 
 absl::Status Node::VisitSingleNode(DfsVisitor* visitor) {
@@ -631,7 +661,8 @@ std::string Node::GetUsersString() const {
 }
 
 bool Node::HasUser(const Node* target) const {
-  return users_.contains(const_cast<Node*>(target));
+  return std::binary_search(users_.begin(), users_.end(),
+                            const_cast<Node*>(target), NodeIdLessThan());
 }
 
 bool Node::IsDead() const {
@@ -659,17 +690,37 @@ int64_t Node::OperandInstanceCount(const Node* target) const {
 }
 
 void Node::SetId(int64_t id) {
-  // The data structure (btree) containing the users of each node is sorted by
-  // node id. To avoid violating invariants of the data structure, remove this
-  // node from all users lists, change id, then read to users list.
+  // The users of each node are sorted by node id. To avoid violating this
+  // invariant, remove this node from all users lists, change id, then re-add
+  // it to the users lists. An operand may appear more than once.
   for (Node* operand : operands()) {
-    operand->users_.erase(this);
+    if (operand->HasUser(this)) {
+      operand->RemoveUser(this);
+    }
   }
   id_ = id;
   for (Node* operand : operands()) {
-    operand->users_.insert(this);
+    operand->AddUser(this);
+  }
+  package()->EnsureNextNodeIdAtLeast(id + 1);
+}
+
+void Node::NotifyOperandChanged() {
+  // The operands of a node under construction are part of the node when it
+  // is added.
+  if (!function_base_->HasNode(this)) {
+    return;
+  }
+  function_base_->InvalidateTopoSort();
+  for (ChangeListener* listener : function_base_->change_listeners()) {
+    listener->OperandChanged(this);
+  }
+}
+
+void Node::NotifyUseRemoved() {
+  for (ChangeListener* listener : function_base_->change_listeners()) {
+    listener->UseRemoved(this);
   }
-  package()->set_next_node_id(std::max(id + 1, package()->next_node_id()));
 }
 
 bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
@@ -697,6 +748,9 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
     }
   }
   old_operand->RemoveUser(this);
+  if (did_replace) {
+    NotifyOperandChanged();
+  }
   return did_replace;
 }
 
@@ -713,6 +767,7 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
   // node in another operand slot, it is safe to call.
   new_operand->AddUser(this);
   operands_[operand_no] = new_operand;
+  NotifyOperandChanged();
 
   for (Node* operand : operands()) {
     if (operand == old_operand) {
@@ -729,9 +784,36 @@ absl::Status Node::ReplaceUsesWith(Node* replacement) {
   XLS_RET_CHECK(GetType() == replacement->GetType())
       << "type was: " << GetType()->ToString()
       << " replacement: " << replacement->GetType()->ToString();
-  std::vector<Node*> orig_users(users().begin(), users().end());
-  for (Node* user : orig_users) {
-    XLS_RET_CHECK(user->ReplaceOperand(this, replacement));
+  if (replacement != this) {
+    // Rewire all users at once rather than through ReplaceOperand so the
+    // users lists are updated with a single merge instead of one sorted
+    // insertion and removal per user. As in ReplaceOperand, the replacement
+    // itself is left as a user to avoid creating a self-cycle.
+    std::vector<Node*> moved_users;
+    moved_users.reserve(users_.size());
+    for (Node* user : users_) {
+      if (user == replacement) {
+        continue;
+      }
+      for (Node*& operand : user->operands_) {
+        if (operand == this) {
+          operand = replacement;
+        }
+      }
+      moved_users.push_back(user);
+    }
+    bool replacement_is_user = moved_users.size() != users_.size();
+    users_.clear();
+    if (replacement_is_user) {
+      users_.push_back(replacement);
+    }
+    replacement->AddSortedUsers(moved_users);
+    for (Node* user : moved_users) {
+      user->NotifyOperandChanged();
+    }
+    if (!moved_users.empty()) {
+      NotifyUseRemoved();
+    }
   }
 
   // Handle replacement of nodes which have special positions within the
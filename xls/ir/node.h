@@ -20,8 +20,8 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -40,6 +40,7 @@ namespace xls {
 class Package;
 class Node;
 class FunctionBase;
+class NodeList;
 
 // Forward decaration to avoid circular dependency.
 class DfsVisitor;
@@ -123,6 +124,7 @@ class Node {
   void SwapOperands(int64_t a, int64_t b) {
     // Operand/user chains already set up properly.
     std::swap(operands_[a], operands_[b]);
+    NotifyOperandChanged();
   }
 
   // Returns true if analysis indicates that this node always produces the
@@ -130,6 +132,12 @@ class Node {
   // conservative and false may be returned for some "equivalent" nodes.
   virtual bool IsDefinitelyEqualTo(const Node* other) const;
 
+  // Mixes the op-specific attributes of the node (e.g., literal values, slice
+  // bounds, callees) into `hash` and returns the result. The node's op, type,
+  // operands, name and source location are not included. The result is stable
+  // across processes (see fingerprint.h).
+  virtual uint64_t HashAttributes(uint64_t hash) const { return hash; }
+
   // Returns whether this Op is of the template argument subclass. For example:
   // Is<Param>().
   template <typename OpT>
@@ -171,6 +179,19 @@ class Node {
   // Set source location.
   void SetLoc(const SourceInfo& loc);
 
+  // Returns the size in bytes of the node object itself: the size of the
+  // concrete node class for nodes allocated in the function's node arena, and
+  // sizeof(Node) as a lower bound for nodes allocated on the heap. Storage
+  // owned by the node (e.g. operands which do not fit inline) is not included.
+  int64_t object_size() const {
+    return arena_size_ != 0 ? arena_size_ : sizeof(Node);
+  }
+
+  // Number of operands and users stored inline in the node. Longer lists are
+  // stored in a separate heap allocation.
+  static constexpr int64_t kInlineOperandCount = 2;
+  static constexpr int64_t kInlineUserCount = 2;
+
   // Returns the name of the node and any concise supplementary information.
   std::string ToString() const { return ToStringInternal(false); }
 
@@ -200,7 +221,7 @@ class Node {
   };
 
   // Returns the unique set of users of this node sorted by id.
-  const absl::btree_set<Node*, NodeIdLessThan>& users() const { return users_; }
+  absl::Span<Node* const> users() const { return users_; }
 
   // Helper for querying whether "target" is a user of this node.
   bool HasUser(const Node* target) const;
@@ -278,6 +299,16 @@ class Node {
  protected:
   void AddUser(Node* user);
   void RemoveUser(Node* user);
+  // Adds the given users which must be sorted by NodeIdLessThan.
+  void AddSortedUsers(absl::Span<Node* const> users);
+
+  // Notifies the change listeners of the function base that the operands of
+  // this node have changed.
+  void NotifyOperandChanged();
+
+  // Notifies the change listeners of the function base that this node has
+  // lost a use.
+  void NotifyUseRemoved();
 
   FunctionBase* function_base_;
   int64_t id_;
@@ -286,10 +317,25 @@ class Node {
   SourceInfo loc_;
   std::string name_;
 
-  std::vector<Node*> operands_;
-
-  // Set of users sorted by node_id for stability.
-  absl::btree_set<Node*, NodeIdLessThan> users_;
+  // Nearly all nodes have at most two operands, which are stored inline so
+  // the node needs no separate allocation for them.
+  absl::InlinedVector<Node*, kInlineOperandCount> operands_;
+
+  // Set of users sorted by node_id for stability. Most nodes have only a few
+  // users so a sorted vector is cheaper to maintain than a tree.
+  absl::InlinedVector<Node*, kInlineUserCount> users_;
+
+ private:
+  friend class NodeList;
+
+  // Links in the intrusive list of nodes owned by the function. `list_` is the
+  // list the node is linked into, or null if it is not linked into any.
+  const NodeList* list_ = nullptr;
+  Node* prev_in_list_ = nullptr;
+  Node* next_in_list_ = nullptr;
+  // Size of the allocation if the node lives in the function's node arena,
+  // zero if it was allocated on the heap.
+  int64_t arena_size_ = 0;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Node& node) {
@@ -23,7 +23,7 @@
 
 namespace xls {
 
-void NodeIterator::Initialize() {
+std::vector<Node*> NodeIterator::ComputeReverseTopoSort(FunctionBase* f) {
   // For topological traversal we only add nodes to the order when all of its
   // users have been scheduled.
   //
@@ -37,14 +37,12 @@ void NodeIterator::Initialize() {
   // keeps track of how many more users must be seen (before that node is ready
   // to place into the ordering).
   //
-  // NOTE: Initialize sorts reverse-topologically.  To sort topologically,
-  // reverse the this->ordered_
   absl::flat_hash_map<Node*, int64_t> pending_to_remaining_users;
-  pending_to_remaining_users.reserve(f_->node_count());
+  pending_to_remaining_users.reserve(f->node_count());
   std::deque<Node*> ready;
 
-  ordered_ = std::make_unique<std::vector<Node*>>();
-  ordered_->reserve(f_->node_count());
+  std::vector<Node*> ordered;
+  ordered.reserve(f->node_count());
 
   auto is_scheduled = [&](Node* n) {
     auto it = pending_to_remaining_users.find(n);
@@ -74,7 +72,7 @@ void NodeIterator::Initialize() {
     XLS_VLOG(5) << "Adding node to order: " << r;
     XLS_DCHECK(all_users_scheduled(r))
         << r << " users size: " << r->users().size();
-    ordered_->push_back(r);
+    ordered.push_back(r);
 
     // We want to be careful to only bump down our operands once, since we're a
     // single user, even though we may refer to them multiple times in our
@@ -102,7 +100,7 @@ void NodeIterator::Initialize() {
   };
 
   Node* return_value = nullptr;
-  for (Node* node : f_->nodes()) {
+  for (Node* node : f->nodes()) {
     if (node->users().empty()) {
       if (is_return_value(node)) {
         // Note: we special case the return value so it always comes at the
@@ -127,7 +125,7 @@ void NodeIterator::Initialize() {
     add_to_order(r);
   }
 
-  if (ordered_->size() < f_->node_count()) {
+  if (ordered.size() < f->node_count()) {
     // Not all nodes have been placed indicating a cycle in the graph. Run a
     // trivial DFS visitor which will emit an error message displaying the
     // cycle.
@@ -137,9 +135,10 @@ void NodeIterator::Initialize() {
       }
     };
     CycleChecker cycle_checker;
-    XLS_CHECK_OK(f_->Accept(&cycle_checker));
+    XLS_CHECK_OK(f->Accept(&cycle_checker));
     XLS_LOG(FATAL) << "Expected to find cycle in function base.";
   }
+  return ordered;
 }
 
 }  // namespace xls
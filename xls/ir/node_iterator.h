@@ -15,6 +15,9 @@
 #ifndef XLS_IR_NODE_ITERATOR_H_
 #define XLS_IR_NODE_ITERATOR_H_
 
+#include <memory>
+#include <vector>
+
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 
@@ -23,38 +26,39 @@ namespace xls {
 // A type that orders the reachable nodes in a function into a usable traversal
 // order. Currently just does a stable topological ordering.
 //
+// The ordering is cached on the FunctionBase (see FunctionBase::GetTopoSort),
+// so creating a NodeIterator for an unmodified function base does not
+// recompute or copy it. The iterator shares ownership of the ordering: it
+// stays valid, and unchanged, if the function base is modified afterwards.
+//
 // Note that this container value must outlive any iterators derived from it
 // (via begin()/end()).
 class NodeIterator {
  public:
   static NodeIterator Create(FunctionBase* f) {
-    NodeIterator it(f);
-    it.Initialize();
-    std::reverse(it.ordered_->begin(), it.ordered_->end());
-    return it;
+    return NodeIterator(f->GetTopoSort());
   }
 
   static NodeIterator CreateReverse(FunctionBase* f) {
-    NodeIterator it(f);
-    it.Initialize();
-    return it;
+    return NodeIterator(f->GetReverseTopoSort());
   }
 
-  std::vector<Node*>::iterator begin() { return ordered_->begin(); }
-  std::vector<Node*>::iterator end() { return ordered_->end(); }
+  // Computes the reverse topological order of the nodes of `f` without
+  // consulting the cache.
+  static std::vector<Node*> ComputeReverseTopoSort(FunctionBase* f);
+
+  std::vector<Node*>::const_iterator begin() const {
+    return ordered_->begin();
+  }
+  std::vector<Node*>::const_iterator end() const { return ordered_->end(); }
 
   const std::vector<Node*>& AsVector() const { return *ordered_; }
 
  private:
-  explicit NodeIterator(FunctionBase* f) : f_(f) {}
-
-  void Initialize();
+  explicit NodeIterator(std::shared_ptr<const std::vector<Node*>> ordered)
+      : ordered_(std::move(ordered)) {}
 
-  // The vector of nodes is wrapped in a unique_ptr so that the
-  // NodeIterator may be movable but the iterators returned to the
-  // caller of begin()/end() are not invalidated by those moves.
-  std::unique_ptr<std::vector<Node*>> ordered_;
-  FunctionBase* f_;
+  std::shared_ptr<const std::vector<Node*>> ordered_;
 };
 
 // Convenience function for concise use in foreach constructs; e.g.:
@@ -66,8 +70,8 @@ class NodeIterator {
 // Yields nodes in a stable topological traversal order (dependency ordering is
 // satisfied).
 //
-// Note that the ordering for all nodes is computed up front, *not*
-// incrementally as iteration proceeds.
+// Note that the ordering for all nodes is computed up front (or taken from the
+// cache), *not* incrementally as iteration proceeds.
 inline NodeIterator TopoSort(FunctionBase* f) {
   return NodeIterator::Create(f);
 }
@@ -14,6 +14,10 @@
 
 #include "xls/ir/node_iterator.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
@@ -267,5 +271,50 @@ TEST(NodeIteratorTest, RpoVsTopo) {
   EXPECT_EQ(rni.end(), it);
 }
 
+TEST(NodeIteratorTest, OrderIsCachedUntilModified) {
+  std::string program = R"(
+  fn f(a: bits[32]) -> bits[32] {
+    b: bits[32] = neg(a)
+    ret c: bits[32] = not(b)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+
+  // Repeated sorts of an unmodified function share the cached order.
+  NodeIterator first = TopoSort(f);
+  NodeIterator second = TopoSort(f);
+  EXPECT_EQ(&first.AsVector(), &second.AsVector());
+  EXPECT_EQ(&ReverseTopoSort(f).AsVector(), &ReverseTopoSort(f).AsVector());
+
+  // Adding a node invalidates the cache. The order held by an existing
+  // iterator is unchanged.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * b, f->GetNode("b"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * c, f->GetNode("c"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * d,
+                           f->MakeNode<UnOp>(SourceInfo(), b, Op::kNeg));
+  EXPECT_EQ(first.AsVector().size(), 3);
+  EXPECT_NE(&TopoSort(f).AsVector(), &first.AsVector());
+  EXPECT_EQ(TopoSort(f).AsVector().size(), 4);
+
+  // Changing the return value changes the order, as the return value is
+  // always last.
+  XLS_ASSERT_OK(f->set_return_value(d));
+  EXPECT_EQ(TopoSort(f).AsVector().back(), d);
+
+  // Changing an operand reorders the users.
+  XLS_ASSERT_OK(c->ReplaceOperandNumber(0, d));
+  std::vector<Node*> order = TopoSort(f).AsVector();
+  EXPECT_LT(std::find(order.begin(), order.end(), d) - order.begin(),
+            std::find(order.begin(), order.end(), c) - order.begin());
+
+  // Removing a node removes it from the order.
+  XLS_ASSERT_OK(f->set_return_value(c));
+  XLS_ASSERT_OK(c->ReplaceOperandNumber(0, b));
+  XLS_ASSERT_OK(f->RemoveNode(d));
+  EXPECT_THAT(TopoSort(f).AsVector(), ::testing::ElementsAre(
+                                          f->param(0), b, c));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,113 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_list.h"
+
+#include <new>
+
+#include "xls/common/logging/logging.h"
+
+namespace xls {
+
+void* NodeArena::Allocate(int64_t size) {
+  int64_t rounded = RoundUp(size);
+  if (rounded > kMaxArenaObjectSize) {
+    return ::operator new(rounded);
+  }
+  int64_t index = rounded / kAlignment;
+  if (index < static_cast<int64_t>(free_lists_.size()) &&
+      free_lists_[index] != nullptr) {
+    FreeBlock* block = free_lists_[index];
+    free_lists_[index] = block->next;
+    return block;
+  }
+  if (limit_ - cursor_ < rounded) {
+    // operator new[] returns storage aligned for any fundamental type, which
+    // includes kAlignment.
+    slabs_.push_back(std::make_unique<char[]>(kSlabSize));
+    bytes_reserved_ += kSlabSize;
+    cursor_ = slabs_.back().get();
+    limit_ = cursor_ + kSlabSize;
+  }
+  void* result = cursor_;
+  cursor_ += rounded;
+  return result;
+}
+
+void NodeArena::Deallocate(void* ptr, int64_t size) {
+  int64_t rounded = RoundUp(size);
+  if (rounded > kMaxArenaObjectSize) {
+    ::operator delete(ptr);
+    return;
+  }
+  int64_t index = rounded / kAlignment;
+  if (index >= static_cast<int64_t>(free_lists_.size())) {
+    free_lists_.resize(index + 1, nullptr);
+  }
+  FreeBlock* block = new (ptr) FreeBlock{free_lists_[index]};
+  free_lists_[index] = block;
+}
+
+void NodeList::push_back(Node* node) {
+  XLS_CHECK(node->list_ == nullptr);
+  node->list_ = this;
+  node->prev_in_list_ = tail_;
+  if (tail_ == nullptr) {
+    head_ = node;
+  } else {
+    tail_->next_in_list_ = node;
+  }
+  tail_ = node;
+  ++size_;
+}
+
+void NodeList::erase(Node* node) {
+  XLS_CHECK(contains(node));
+  if (node->prev_in_list_ == nullptr) {
+    head_ = node->next_in_list_;
+  } else {
+    node->prev_in_list_->next_in_list_ = node->next_in_list_;
+  }
+  if (node->next_in_list_ == nullptr) {
+    tail_ = node->prev_in_list_;
+  } else {
+    node->next_in_list_->prev_in_list_ = node->prev_in_list_;
+  }
+  --size_;
+  Destroy(node);
+}
+
+void NodeList::clear() {
+  Node* node = head_;
+  while (node != nullptr) {
+    Node* next = node->next_in_list_;
+    Destroy(node);
+    node = next;
+  }
+  head_ = nullptr;
+  tail_ = nullptr;
+  size_ = 0;
+}
+
+void NodeList::Destroy(Node* node) {
+  int64_t arena_size = node->arena_size_;
+  if (arena_size == 0) {
+    delete node;
+    return;
+  }
+  node->~Node();
+  arena_.Deallocate(node, arena_size);
+}
+
+}  // namespace xls
@@ -0,0 +1,177 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_LIST_H_
+#define XLS_IR_NODE_LIST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Slab allocator for the nodes owned by a single FunctionBase. Memory is carved
+// out of large slabs and freed blocks are kept on per-size free lists for
+// reuse, so building and rewriting large functions does not go to the global
+// allocator for every node. Not thread-safe; like the rest of the IR, a
+// function must not be mutated concurrently.
+class NodeArena {
+ public:
+  NodeArena() = default;
+
+  NodeArena(const NodeArena&) = delete;
+  NodeArena& operator=(const NodeArena&) = delete;
+
+  // Returns storage for an object of `size` bytes aligned to
+  // alignof(std::max_align_t).
+  void* Allocate(int64_t size);
+
+  // Returns storage previously returned by Allocate(`size`) to the arena.
+  void Deallocate(void* ptr, int64_t size);
+
+  // Total number of bytes reserved from the system allocator.
+  int64_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  static constexpr int64_t kAlignment = alignof(std::max_align_t);
+  static constexpr int64_t kSlabSize = 64 * 1024;
+  // Objects larger than this are allocated individually.
+  static constexpr int64_t kMaxArenaObjectSize = kSlabSize / 8;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  static int64_t RoundUp(int64_t size) {
+    return (size + kAlignment - 1) / kAlignment * kAlignment;
+  }
+
+  std::vector<std::unique_ptr<char[]>> slabs_;
+  char* cursor_ = nullptr;
+  char* limit_ = nullptr;
+  // Free lists indexed by rounded size divided by kAlignment.
+  std::vector<FreeBlock*> free_lists_;
+  int64_t bytes_reserved_ = 0;
+};
+
+// An owning, intrusive, doubly-linked list of nodes. The links are stored in
+// the nodes themselves so appending or removing a node needs no allocation
+// other than the node itself and removal of an arbitrary node is O(1) without
+// an auxiliary map. Nodes may either be constructed in the list's arena with
+// Create or be heap-allocated and handed over with push_back.
+class NodeList {
+ public:
+  // Bidirectional iterator yielding Node*.
+  class iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Node*;
+    using difference_type = ptrdiff_t;
+    using pointer = Node**;
+    using reference = Node*;
+
+    iterator() = default;
+
+    Node* operator*() const { return node_; }
+    Node* operator->() const { return node_; }
+    iterator& operator++() {
+      node_ = node_->next_in_list_;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator temp = *this;
+      operator++();
+      return temp;
+    }
+    iterator& operator--() {
+      node_ = node_ == nullptr ? list_->tail_ : node_->prev_in_list_;
+      return *this;
+    }
+    iterator operator--(int) {
+      iterator temp = *this;
+      operator--();
+      return temp;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.node_ == b.node_;
+    }
+    friend bool operator!=(const iterator& a, const iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    friend class NodeList;
+    iterator(const NodeList* list, Node* node) : list_(list), node_(node) {}
+
+    const NodeList* list_ = nullptr;
+    Node* node_ = nullptr;
+  };
+  using const_iterator = iterator;
+
+  NodeList() = default;
+  ~NodeList() { clear(); }
+
+  NodeList(const NodeList&) = delete;
+  NodeList& operator=(const NodeList&) = delete;
+
+  iterator begin() const { return iterator(this, head_); }
+  iterator end() const { return iterator(this, nullptr); }
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Constructs a NodeT in the arena. The node is not linked into the list;
+  // ownership is passed by a subsequent call to push_back.
+  template <typename NodeT, typename... Args>
+  NodeT* Create(Args&&... args) {
+    void* storage = arena_.Allocate(sizeof(NodeT));
+    NodeT* node = new (storage) NodeT(std::forward<Args>(args)...);
+    static_cast<Node*>(node)->arena_size_ = sizeof(NodeT);
+    return node;
+  }
+
+  // Appends the node to the end of the list, which takes ownership of it. The
+  // node must either be heap-allocated or have been created with Create.
+  void push_back(Node* node);
+
+  // Returns true if the node is linked into this list.
+  bool contains(const Node* node) const { return node->list_ == this; }
+
+  // Unlinks the node from the list and destroys it.
+  void erase(Node* node);
+
+  // Destroys all nodes in the list.
+  void clear();
+
+  const NodeArena& arena() const { return arena_; }
+
+ private:
+  void Destroy(Node* node);
+
+  // Declared first so it outlives the nodes it holds.
+  NodeArena arena_;
+  Node* head_ = nullptr;
+  Node* tail_ = nullptr;
+  int64_t size_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_LIST_H_
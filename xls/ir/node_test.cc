@@ -503,5 +503,50 @@ TEST_F(NodeTest, IncorrectOpClass) {
       HasSubstr("Op `assert` is not a valid op for Node class `UnOp`"));
 }
 
+TEST_F(NodeTest, ReplaceUsesWithMergesSortedUsers) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  std::vector<BValue> x_users;
+  std::vector<BValue> y_users;
+  for (int64_t i = 0; i < 100; ++i) {
+    // Interleave the users of x and y so the merged list is sorted only if
+    // the users are merged rather than appended.
+    x_users.push_back(fb.Add(x, x));
+    y_users.push_back(fb.Not(y));
+  }
+  BValue both = fb.Add(x, y);
+  std::vector<BValue> elements = x_users;
+  elements.insert(elements.end(), y_users.begin(), y_users.end());
+  elements.push_back(both);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple(elements)));
+
+  EXPECT_EQ(x.node()->users().size(), 101);
+  XLS_ASSERT_OK(x.node()->ReplaceUsesWith(y.node()));
+  EXPECT_TRUE(x.node()->users().empty());
+  ASSERT_EQ(y.node()->users().size(), 201);
+  EXPECT_TRUE(std::is_sorted(y.node()->users().begin(),
+                             y.node()->users().end(), Node::NodeIdLessThan()));
+  for (BValue user : x_users) {
+    EXPECT_TRUE(y.node()->HasUser(user.node()));
+    EXPECT_EQ(user.node()->operand(0), y.node());
+    EXPECT_EQ(user.node()->operand(1), y.node());
+  }
+  EXPECT_EQ(both.node()->operand(0), y.node());
+  XLS_EXPECT_OK(VerifyFunction(f));
+
+  // Removing a user keeps the remaining users sorted.
+  Node* tuple = f->return_value();
+  XLS_ASSERT_OK(f->set_return_value(y.node()));
+  XLS_ASSERT_OK(f->RemoveNode(tuple));
+  XLS_ASSERT_OK(f->RemoveNode(both.node()));
+  EXPECT_EQ(y.node()->users().size(), 200);
+  EXPECT_FALSE(y.node()->HasUser(both.node()));
+  EXPECT_TRUE(std::is_sorted(y.node()->users().begin(),
+                             y.node()->users().end(), Node::NodeIdLessThan()));
+}
+
 }  // namespace
 }  // namespace xls
@@ -145,6 +145,16 @@ bool IsSignedCompare(Node* node) {
   }
 }
 
+bool IsLiteralTableLookup(Node* node, int64_t min_table_bits) {
+  if (!node->Is<ArrayIndex>() || !node->GetType()->IsBits()) {
+    return false;
+  }
+  ArrayIndex* array_index = node->As<ArrayIndex>();
+  return array_index->indices().size() == 1 &&
+         array_index->array()->Is<Literal>() &&
+         array_index->array()->GetType()->GetFlatBitCount() >= min_table_bits;
+}
+
 absl::StatusOr<Op> OpToNonReductionOp(Op reduce_op) {
   switch (reduce_op) {
     case Op::kAndReduce:
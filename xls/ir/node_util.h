@@ -134,6 +134,11 @@ absl::StatusOr<Node*> OrReduceLeading(Node* node, int64_t bit_count);
 bool IsUnsignedCompare(Node* node);
 bool IsSignedCompare(Node* node);
 
+// Returns true if the given node is a lookup into a literal table of at least
+// `min_table_bits` bits, i.e., a single-index array_index of a literal array
+// of bits.
+bool IsLiteralTableLookup(Node* node, int64_t min_table_bits);
+
 // For <AndReduce, OrReduce, XorReduce>, returns <And, Or, Xor>.
 absl::StatusOr<Op> OpToNonReductionOp(Op reduce_op);
 
@@ -178,6 +178,22 @@ TEST_F(NodeUtilTest, IsLiteralMask) {
   EXPECT_FALSE(IsLiteralMask(zero_0b.node(), &leading_zeros, &trailing_ones));
 }
 
+TEST_F(NodeUtilTest, IsLiteralTableLookup) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(2));
+  XLS_ASSERT_OK_AND_ASSIGN(Value table,
+                           Value::UBitsArray({1, 2, 3, 4}, /*bit_count=*/8));
+  BValue lookup = fb.ArrayIndex(fb.Literal(table), {x});
+  BValue array = fb.Array({x, x}, p->GetBitsType(2));
+  BValue non_literal_lookup = fb.ArrayIndex(array, {x});
+
+  EXPECT_TRUE(IsLiteralTableLookup(lookup.node(), 32));
+  EXPECT_FALSE(IsLiteralTableLookup(lookup.node(), 33));
+  EXPECT_FALSE(IsLiteralTableLookup(non_literal_lookup.node(), 0));
+  EXPECT_FALSE(IsLiteralTableLookup(x.node(), 0));
+}
+
 TEST_F(NodeUtilTest, NonReductiveEquivalents) {
   XLS_ASSERT_OK_AND_ASSIGN(
       Op and_op, OpToNonReductionOp(Op::kAndReduce));
@@ -14,17 +14,21 @@
 
 #include "xls/ir/package.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/strong_int.h"
 #include "xls/ir/block.h"
 #include "xls/ir/channel.h"
+#include "xls/ir/fingerprint.h"
 #include "xls/ir/function.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/type.h"
@@ -138,6 +142,30 @@ Block* Package::AddBlock(std::unique_ptr<Block> block) {
   return blocks_.back().get();
 }
 
+absl::Status Package::ReorderFunctionBases(
+    absl::Span<FunctionBase* const> order) {
+  absl::flat_hash_map<FunctionBase*, int64_t> positions;
+  for (FunctionBase* f : order) {
+    XLS_RET_CHECK(positions.emplace(f, positions.size()).second)
+        << "Duplicate function base " << f->name();
+  }
+  XLS_RET_CHECK_EQ(positions.size(),
+                   functions_.size() + procs_.size() + blocks_.size());
+  auto sort = [&](auto& function_bases) -> absl::Status {
+    for (const auto& f : function_bases) {
+      XLS_RET_CHECK(positions.contains(f.get())) << f->name();
+    }
+    std::sort(function_bases.begin(), function_bases.end(),
+              [&](const auto& a, const auto& b) {
+                return positions.at(a.get()) < positions.at(b.get());
+              });
+    return absl::OkStatus();
+  };
+  XLS_RETURN_IF_ERROR(sort(functions_));
+  XLS_RETURN_IF_ERROR(sort(procs_));
+  return sort(blocks_);
+}
+
 absl::StatusOr<Function*> Package::GetFunction(
     std::string_view func_name) const {
   for (auto& f : functions_) {
@@ -310,6 +338,7 @@ absl::StatusOr<Type*> Package::MapTypeFromOtherPackage(
 }
 
 BitsType* Package::GetBitsType(int64_t bit_count) {
+  absl::MutexLock lock(&type_mutex_);
   if (bit_count_to_type_.find(bit_count) != bit_count_to_type_.end()) {
     return &bit_count_to_type_.at(bit_count);
   }
@@ -320,11 +349,12 @@ BitsType* Package::GetBitsType(int64_t bit_count) {
 }
 
 ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
+  absl::MutexLock lock(&type_mutex_);
   ArrayKey key{size, element_type};
   if (array_types_.find(key) != array_types_.end()) {
     return &array_types_.at(key);
   }
-  XLS_CHECK(IsOwnedType(element_type))
+  XLS_CHECK(IsOwnedTypeLocked(element_type))
       << "Type is not owned by package: " << *element_type;
   auto it = array_types_.emplace(key, ArrayType(size, element_type));
   ArrayType* new_type = &(it.first->second);
@@ -333,12 +363,13 @@ ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
 }
 
 TupleType* Package::GetTupleType(absl::Span<Type* const> element_types) {
+  absl::MutexLock lock(&type_mutex_);
   TypeVec key(element_types.begin(), element_types.end());
   if (tuple_types_.find(key) != tuple_types_.end()) {
     return &tuple_types_.at(key);
   }
   for (const Type* element_type : element_types) {
-    XLS_CHECK(IsOwnedType(element_type))
+    XLS_CHECK(IsOwnedTypeLocked(element_type))
         << "Type is not owned by package: " << *element_type;
   }
   auto it = tuple_types_.emplace(key, TupleType(element_types));
@@ -352,11 +383,12 @@ TokenType* Package::GetTokenType() { return &token_type_; }
 FunctionType* Package::GetFunctionType(absl::Span<Type* const> args_types,
                                        Type* return_type) {
   std::string key = FunctionType(args_types, return_type).ToString();
+  absl::MutexLock lock(&type_mutex_);
   if (function_types_.find(key) != function_types_.end()) {
     return &function_types_.at(key);
   }
   for (Type* t : args_types) {
-    XLS_CHECK(IsOwnedType(t))
+    XLS_CHECK(IsOwnedTypeLocked(t))
         << "Parameter type is not owned by package: " << t->ToString();
   }
   auto it = function_types_.emplace(key, FunctionType(args_types, return_type));
@@ -488,6 +520,48 @@ int64_t Package::GetNodeCount() const {
   return count;
 }
 
+uint64_t Package::Fingerprint() {
+  uint64_t hash = FingerprintCombine(0, functions().size());
+  for (const std::unique_ptr<Function>& f : functions()) {
+    hash = FingerprintCombine(hash, f->StructuralHash());
+  }
+  hash = FingerprintCombine(hash, procs().size());
+  for (const std::unique_ptr<Proc>& proc : procs()) {
+    hash = FingerprintCombine(hash, proc->StructuralHash());
+  }
+  hash = FingerprintCombine(hash, blocks().size());
+  for (const std::unique_ptr<Block>& block : blocks()) {
+    hash = FingerprintCombine(hash, block->StructuralHash());
+  }
+  hash = FingerprintCombine(hash, channels().size());
+  for (Channel* channel : channels()) {
+    hash = FingerprintCombine(hash, channel->id());
+    hash = FingerprintCombine(hash, static_cast<uint64_t>(channel->kind()));
+    hash = FingerprintCombine(hash,
+                              static_cast<uint64_t>(channel->supported_ops()));
+    hash = FingerprintAttribute(hash, channel->type());
+    for (const Value& value : channel->initial_values()) {
+      hash = FingerprintAttribute(hash, value);
+    }
+    if (channel->kind() == ChannelKind::kStreaming) {
+      StreamingChannel* streaming = down_cast<StreamingChannel*>(channel);
+      hash = FingerprintCombine(
+          hash, static_cast<uint64_t>(streaming->GetFlowControl()));
+      hash = FingerprintCombine(hash, streaming->GetFifoDepth().value_or(-1));
+    }
+  }
+  // Identify the top by its position rather than its name.
+  std::optional<FunctionBase*> top = GetTop();
+  int64_t top_index = -1;
+  if (top.has_value()) {
+    std::vector<FunctionBase*> function_bases = GetFunctionBases();
+    top_index = std::find(function_bases.begin(), function_bases.end(),
+                          top.value()) -
+                function_bases.begin();
+  }
+  return FingerprintCombine(hash, top_index);
+}
+
 bool Package::IsDefinitelyEqualTo(const Package* other) const {
   auto entry_function_status = GetTopAsFunction();
   if (!entry_function_status.ok()) {
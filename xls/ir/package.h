@@ -15,17 +15,20 @@
 #ifndef XLS_IR_PACKAGE_H_
 #define XLS_IR_PACKAGE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/channel_ops.h"
@@ -75,13 +78,25 @@ class Package {
 
   // Returns whether the given type is one of the types owned by this package.
   bool IsOwnedType(const Type* type) {
-    return owned_types_.find(type) != owned_types_.end();
+    absl::MutexLock lock(&type_mutex_);
+    return IsOwnedTypeLocked(type);
   }
   bool IsOwnedFunctionType(const FunctionType* function_type) {
+    absl::MutexLock lock(&type_mutex_);
     return owned_function_types_.find(function_type) !=
            owned_function_types_.end();
   }
 
+  // Returns the number of distinct types, including function types, owned by
+  // this package.
+  int64_t GetOwnedTypeCount() {
+    absl::MutexLock lock(&type_mutex_);
+    return owned_types_.size() + owned_function_types_.size();
+  }
+
+  // The type accessors below and node id allocation are thread-safe so that
+  // passes may transform different functions of the package concurrently.
+
   BitsType* GetBitsType(int64_t bit_count);
   ArrayType* GetArrayType(int64_t size, Type* element_type);
   TupleType* GetTupleType(absl::Span<Type* const> element_types);
@@ -106,6 +121,11 @@ class Package {
   Proc* AddProc(std::unique_ptr<Proc> proc);
   Block* AddBlock(std::unique_ptr<Block> block);
 
+  // Reorders the functions, procs and blocks of the package to follow their
+  // relative order in `order` which must contain every function base of the
+  // package exactly once.
+  absl::Status ReorderFunctionBases(absl::Span<FunctionBase* const> order);
+
   // Get a function, proc, or block by name. Returns an error if no such
   // construct of the indicated kind exists with that name.
   absl::StatusOr<Function*> GetFunction(std::string_view func_name) const;
@@ -149,7 +169,7 @@ class Package {
 
   // Retrieves the next node ID to assign to a node in the package and
   // increments the next node counter. For use in node construction.
-  int64_t GetNextNodeId() { return next_node_id_++; }
+  int64_t GetNextNodeId() { return next_node_id_.fetch_add(1); }
 
   // Adds a file to the file-number table and returns its corresponding number.
   // If it already exists, returns the existing file-number entry.
@@ -162,10 +182,21 @@ class Package {
   // Get the filename corresponding to the given `Fileno`.
   std::optional<std::string> GetFilename(Fileno file_number) const;
 
+  // Returns the file-number table of the package.
+  const absl::flat_hash_map<Fileno, std::string>& fileno_to_name() const {
+    return fileno_to_filename_;
+  }
+
   // Returns the total number of nodes in the graph. Traverses the functions and
   // sums the node counts.
   int64_t GetNodeCount() const;
 
+  // Returns a fingerprint of the structure of the package: the structural
+  // hashes (see FunctionBase::StructuralHash) of its functions, procs and
+  // blocks in order, its channels and its top. Names of nodes, functions and
+  // channels and source locations are ignored. Stable across processes.
+  uint64_t Fingerprint();
+
   // Returns the functions in this package.
   absl::Span<std::unique_ptr<Function>> functions() {
     return absl::MakeSpan(functions_);
@@ -204,10 +235,18 @@ class Package {
   // Returns whether this package contains a function with the "target" name.
   bool HasFunctionWithName(std::string_view target) const;
 
-  int64_t next_node_id() const { return next_node_id_; }
+  int64_t next_node_id() const { return next_node_id_.load(); }
 
   // Intended for use by the parser when node ids are suggested by the IR text.
-  void set_next_node_id(int64_t value) { next_node_id_ = value; }
+  void set_next_node_id(int64_t value) { next_node_id_.store(value); }
+
+  // Sets the next node id to `value` if it is currently smaller. Thread-safe.
+  void EnsureNextNodeIdAtLeast(int64_t value) {
+    int64_t current = next_node_id_.load();
+    while (current < value &&
+           !next_node_id_.compare_exchange_weak(current, value)) {
+    }
+  }
 
   // Create a channel. Channels are used with send/receive nodes in communicate
   // between procs or between procs and external (to XLS) components. If no
@@ -259,40 +298,54 @@ class Package {
   // Name of this package.
   std::string name_;
 
+  bool IsOwnedTypeLocked(const Type* type)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(type_mutex_) {
+    return owned_types_.find(type) != owned_types_.end();
+  }
+
   // Ordinal to assign to the next node created in this package.
-  int64_t next_node_id_ = 1;
+  std::atomic<int64_t> next_node_id_ = 1;
 
   std::vector<std::unique_ptr<Function>> functions_;
   std::vector<std::unique_ptr<Proc>> procs_;
   std::vector<std::unique_ptr<Block>> blocks_;
 
+  // Guards the owned type tables below.
+  absl::Mutex type_mutex_;
+
   // Set of owned types in this package.
-  absl::flat_hash_set<const Type*> owned_types_;
+  absl::flat_hash_set<const Type*> owned_types_
+      ABSL_GUARDED_BY(type_mutex_);
 
   // Set of owned function types in this package.
-  absl::flat_hash_set<const FunctionType*> owned_function_types_;
+  absl::flat_hash_set<const FunctionType*> owned_function_types_
+      ABSL_GUARDED_BY(type_mutex_);
 
   // Mapping from bit count to the owned "bits" type with that many bits. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_;
+  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_
+      ABSL_GUARDED_BY(type_mutex_);
 
   // Mapping from the size and element type of an array type to the owned
   // ArrayType. Use node_hash_map for pointer stability.
   using ArrayKey = std::pair<int64_t, const Type*>;
-  absl::node_hash_map<ArrayKey, ArrayType> array_types_;
+  absl::node_hash_map<ArrayKey, ArrayType> array_types_
+      ABSL_GUARDED_BY(type_mutex_);
 
   // Mapping from elements to the owned tuple type.
   //
   // Uses node_hash_map for pointer stability.
   using TypeVec = absl::InlinedVector<const Type*, 4>;
-  absl::node_hash_map<TypeVec, TupleType> tuple_types_;
+  absl::node_hash_map<TypeVec, TupleType> tuple_types_
+      ABSL_GUARDED_BY(type_mutex_);
 
   // Owned token type.
   TokenType token_type_;
 
   // Mapping from Type:ToString to the owned function type. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<std::string, FunctionType> function_types_;
+  absl::node_hash_map<std::string, FunctionType> function_types_
+      ABSL_GUARDED_BY(type_mutex_);
 
   // The largest `Fileno` used in this `Package`.
   std::optional<Fileno> maximum_fileno_;
@@ -81,7 +81,11 @@ absl::Status Proc::SetNextToken(Node* next) {
         "Cannot set next token to \"%s\", expected token type but has type %s",
         next->GetName(), next->GetType()->ToString()));
   }
+  Node* old_next = next_token_;
   next_token_ = next;
+  if (old_next != nullptr && old_next != next) {
+    NotifyImplicitUseRemoved(old_next);
+  }
   return absl::OkStatus();
 }
 
@@ -115,7 +119,11 @@ absl::Status Proc::SetNextStateElement(int64_t index, Node* next) {
         index, next->GetName(), next->GetType()->ToString(),
         GetStateElementType(index)->ToString()));
   }
+  Node* old_next = next_state_[index];
   next_state_[index] = next;
+  if (old_next != next) {
+    NotifyImplicitUseRemoved(old_next);
+  }
   return absl::OkStatus();
 }
 
@@ -173,7 +181,9 @@ absl::StatusOr<Param*> Proc::ReplaceStateElement(
 
 absl::Status Proc::RemoveStateElement(int64_t index) {
   XLS_RET_CHECK_LT(index, GetStateElementCount());
+  Node* old_next = next_state_[index];
   next_state_.erase(next_state_.begin() + index);
+  NotifyImplicitUseRemoved(old_next);
   if (!StateParams()[index]->users().empty()) {
     return absl::InvalidArgumentError(
         absl::StrFormat("Cannot remove state element %d of proc %s, existing "
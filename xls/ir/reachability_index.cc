@@ -0,0 +1,128 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/reachability_index.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
+
+namespace xls {
+
+ReachabilityIndex::ReachabilityIndex(FunctionBase* f) : function_base_(f) {
+  f->RegisterChangeListener(this);
+}
+
+ReachabilityIndex::~ReachabilityIndex() {
+  if (function_base_ != nullptr) {
+    function_base_->UnregisterChangeListener(this);
+  }
+}
+
+void ReachabilityIndex::FunctionBaseDeleted(FunctionBase* function_base) {
+  function_base_ = nullptr;
+  labels_.clear();
+}
+
+void ReachabilityIndex::Rebuild() {
+  labels_.clear();
+  labels_.reserve(function_base_->node_count());
+  std::vector<Node*> topo_order;
+  topo_order.reserve(function_base_->node_count());
+  for (Node* node : TopoSort(function_base_)) {
+    // A pre-order number of -1 marks a node which the DFS has not visited.
+    labels_[node] = Label{static_cast<int64_t>(topo_order.size()), /*pre=*/-1,
+                          /*post=*/-1, /*low=*/-1};
+    topo_order.push_back(node);
+  }
+
+  // Iterative DFS along user edges. Each stack entry holds a node and the
+  // index of the next user to visit.
+  int64_t pre_count = 0;
+  int64_t post_count = 0;
+  std::vector<std::pair<Node*, int64_t>> stack;
+  for (Node* root : topo_order) {
+    if (labels_.at(root).pre != -1) {
+      continue;
+    }
+    labels_.at(root).pre = pre_count++;
+    stack.push_back({root, 0});
+    while (!stack.empty()) {
+      auto& [node, next_user] = stack.back();
+      if (next_user < node->users().size()) {
+        Node* user = node->users()[next_user++];
+        Label& user_label = labels_.at(user);
+        if (user_label.pre == -1) {
+          user_label.pre = pre_count++;
+          stack.push_back({user, 0});
+        }
+        continue;
+      }
+      Label& label = labels_.at(node);
+      label.post = post_count++;
+      label.low = label.post;
+      for (Node* user : node->users()) {
+        label.low = std::min(label.low, labels_.at(user).low);
+      }
+      stack.pop_back();
+    }
+  }
+  stale_ = false;
+}
+
+bool ReachabilityIndex::DependsOn(Node* node, Node* other) {
+  XLS_CHECK(function_base_ != nullptr);
+  if (node == other) {
+    return false;
+  }
+  if (stale_) {
+    Rebuild();
+  }
+  const Label& target = labels_.at(node);
+  const Label& source = labels_.at(other);
+  if (!MayDependOn(target, source)) {
+    return false;
+  }
+  if (IsTreeDescendant(target, source)) {
+    return true;
+  }
+  std::vector<Node*> worklist = {other};
+  absl::flat_hash_set<Node*> visited = {other};
+  while (!worklist.empty()) {
+    Node* current = worklist.back();
+    worklist.pop_back();
+    for (Node* user : current->users()) {
+      if (user == node) {
+        return true;
+      }
+      const Label& user_label = labels_.at(user);
+      if (!MayDependOn(target, user_label) || !visited.insert(user).second) {
+        continue;
+      }
+      if (IsTreeDescendant(target, user_label)) {
+        return true;
+      }
+      worklist.push_back(user);
+    }
+  }
+  return false;
+}
+
+}  // namespace xls
@@ -0,0 +1,109 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_REACHABILITY_INDEX_H_
+#define XLS_IR_REACHABILITY_INDEX_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/ir/change_listener.h"
+
+namespace xls {
+
+class FunctionBase;
+class Node;
+
+// An index answering whether one node of a FunctionBase transitively depends
+// on another, i.e., whether there is a path of operand edges between them.
+//
+// The index labels each node with its position in a topological sort and with
+// two intervals computed by a depth-first traversal along user edges:
+//
+//  * The interval [pre, post] of the node in the DFS spanning forest. If the
+//    interval of `a` contains the interval of `b` then `b` is a descendant of
+//    `a` in the forest and so depends on `a`.
+//  * The interval [low, post] where `low` is the smallest post-order number
+//    of any node which transitively depends on the node. If `b` depends on
+//    `a` then the interval of `a` contains the interval of `b`.
+//
+// Most queries are answered by these labels alone. The remaining ones fall
+// back to a DFS from `a` which is pruned to the nodes whose labels permit a
+// path to `b`. Building the index takes time and space linear in the size of
+// the function base.
+//
+// The index is a ChangeListener of the function base. Any change marks the
+// index stale and it is rebuilt lazily by the next query, so a pass which
+// interleaves queries with mutations pays for a rebuild per mutation.
+//
+// Passes such as TokenDependencyPass and MutualExclusionPass query the
+// instance owned by the function base (FunctionBase::GetReachabilityIndex),
+// so labels built by one pass are reused by the next if nothing changed in
+// between.
+class ReachabilityIndex : public ChangeListener {
+ public:
+  explicit ReachabilityIndex(FunctionBase* f);
+  ~ReachabilityIndex() override;
+
+  ReachabilityIndex(const ReachabilityIndex&) = delete;
+  ReachabilityIndex& operator=(const ReachabilityIndex&) = delete;
+
+  // Returns whether `node` transitively depends on `other`, that is, whether
+  // `other` is a transitive operand of `node`. A node does not depend on
+  // itself.
+  bool DependsOn(Node* node, Node* other);
+
+  // Returns whether the labels are out of date with the function base and
+  // will be rebuilt by the next query.
+  bool stale() const { return stale_; }
+
+  // ChangeListener overrides.
+  void NodeAdded(Node* node) override { stale_ = true; }
+  void NodeDeleted(Node* node) override { stale_ = true; }
+  void OperandChanged(Node* node) override { stale_ = true; }
+  void FunctionBaseDeleted(FunctionBase* function_base) override;
+
+ private:
+  struct Label {
+    // Position in a topological sort of the function base.
+    int64_t topo_index;
+    // Pre- and post-order numbers in the DFS spanning forest.
+    int64_t pre;
+    int64_t post;
+    // Smallest post-order number of the node or any transitive user.
+    int64_t low;
+  };
+
+  // Returns whether `b` may depend on `a` according to their labels. A false
+  // result is definitive.
+  static bool MayDependOn(const Label& b, const Label& a) {
+    return a.topo_index < b.topo_index && a.low <= b.low && b.post <= a.post;
+  }
+
+  // Returns whether `b` is a descendant of `a` in the DFS spanning forest. A
+  // true result is definitive.
+  static bool IsTreeDescendant(const Label& b, const Label& a) {
+    return a.pre < b.pre && b.post < a.post;
+  }
+
+  void Rebuild();
+
+  FunctionBase* function_base_;
+  bool stale_ = true;
+  absl::flat_hash_map<Node*, Label> labels_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_REACHABILITY_INDEX_H_
@@ -0,0 +1,127 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/reachability_index.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+class ReachabilityIndexTest : public IrTestBase {};
+
+TEST_F(ReachabilityIndexTest, Diamond) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  BValue inv = fb.Not(x);
+  BValue add = fb.Add(neg, inv);
+  BValue sub = fb.Subtract(y, neg);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ReachabilityIndex* index = f->GetReachabilityIndex();
+  EXPECT_EQ(f->GetReachabilityIndex(), index);
+  EXPECT_TRUE(index->DependsOn(add.node(), x.node()));
+  EXPECT_TRUE(index->DependsOn(add.node(), neg.node()));
+  EXPECT_TRUE(index->DependsOn(add.node(), inv.node()));
+  EXPECT_TRUE(index->DependsOn(sub.node(), x.node()));
+  EXPECT_TRUE(index->DependsOn(sub.node(), y.node()));
+  EXPECT_FALSE(index->DependsOn(add.node(), y.node()));
+  EXPECT_FALSE(index->DependsOn(sub.node(), inv.node()));
+  EXPECT_FALSE(index->DependsOn(x.node(), add.node()));
+  EXPECT_FALSE(index->DependsOn(add.node(), sub.node()));
+  EXPECT_FALSE(index->DependsOn(add.node(), add.node()));
+}
+
+// Checks every pair of nodes of a layered graph with many cross edges, which
+// exercises the fallback search, against a direct search over operands.
+TEST_F(ReachabilityIndexTest, MatchesOperandSearch) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> layer;
+  for (int64_t i = 0; i < 4; ++i) {
+    layer.push_back(fb.Param(absl::StrCat("p", i), p->GetBitsType(8)));
+  }
+  for (int64_t depth = 0; depth < 5; ++depth) {
+    std::vector<BValue> next;
+    for (int64_t i = 0; i < layer.size(); ++i) {
+      next.push_back(fb.Add(layer[i], layer[(i * 3 + depth) % layer.size()]));
+    }
+    layer = next;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  auto depends_on = [](Node* node, Node* other) {
+    std::vector<Node*> worklist(node->operands().begin(),
+                                node->operands().end());
+    absl::flat_hash_set<Node*> visited;
+    while (!worklist.empty()) {
+      Node* current = worklist.back();
+      worklist.pop_back();
+      if (current == other) {
+        return true;
+      }
+      if (visited.insert(current).second) {
+        worklist.insert(worklist.end(), current->operands().begin(),
+                        current->operands().end());
+      }
+    }
+    return false;
+  };
+  ReachabilityIndex* index = f->GetReachabilityIndex();
+  for (Node* a : f->nodes()) {
+    for (Node* b : f->nodes()) {
+      EXPECT_EQ(index->DependsOn(a, b), depends_on(a, b))
+          << a->GetName() << " depends on " << b->GetName();
+    }
+  }
+}
+
+TEST_F(ReachabilityIndexTest, RebuiltAfterChange) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ReachabilityIndex* index = f->GetReachabilityIndex();
+  EXPECT_TRUE(index->DependsOn(neg.node(), x.node()));
+  EXPECT_FALSE(index->stale());
+
+  ASSERT_TRUE(neg.node()->ReplaceOperand(x.node(), y.node()));
+  EXPECT_TRUE(index->stale());
+  EXPECT_FALSE(index->DependsOn(neg.node(), x.node()));
+  EXPECT_TRUE(index->DependsOn(neg.node(), y.node()));
+  EXPECT_FALSE(index->stale());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * inv, f->MakeNode<UnOp>(SourceInfo(), neg.node(), Op::kNot));
+  EXPECT_TRUE(index->DependsOn(inv, y.node()));
+  EXPECT_FALSE(index->DependsOn(inv, x.node()));
+}
+
+}  // namespace
+}  // namespace xls
@@ -15,6 +15,7 @@
 #ifndef XLS_IR_SOURCE_LOCATION_H_
 #define XLS_IR_SOURCE_LOCATION_H_
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/optional.h"
@@ -47,8 +48,10 @@ class SourceLocation {
   Colno colno_;
 };
 
+// The source locations of an IR entity. Almost all entities have zero or one
+// location so a single location is stored inline without a heap allocation.
 struct SourceInfo {
-  std::vector<SourceLocation> locations;
+  absl::InlinedVector<SourceLocation, 1> locations;
 
   SourceInfo() : locations() {}
   explicit SourceInfo(const SourceLocation& loc) : locations({loc}) {}
@@ -0,0 +1,207 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/structural_hash_index.h"
+
+#include <algorithm>
+
+#include "absl/hash/hash.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+
+namespace {
+
+void SortById(std::vector<Node*>* nodes) {
+  std::sort(nodes->begin(), nodes->end(),
+            [](Node* a, Node* b) { return a->id() < b->id(); });
+}
+
+// Returns the operands of `node` in the order used for structural comparison.
+// Operands of commutative ops are sorted by id so that, for example, add(x, y)
+// and add(y, x) compare equal.
+std::vector<Node*> CanonicalOperands(const Node* node) {
+  std::vector<Node*> operands(node->operands().begin(),
+                              node->operands().end());
+  if (OpIsCommutative(node->op())) {
+    SortById(&operands);
+  }
+  return operands;
+}
+
+}  // namespace
+
+StructuralHashIndex::StructuralHashIndex(FunctionBase* f)
+    : function_base_(f) {
+  node_hashes_.reserve(f->node_count());
+  for (Node* node : f->nodes()) {
+    Insert(node);
+  }
+  f->RegisterChangeListener(this);
+}
+
+StructuralHashIndex::~StructuralHashIndex() {
+  if (function_base_ != nullptr) {
+    function_base_->UnregisterChangeListener(this);
+  }
+}
+
+/*static*/ bool StructuralHashIndex::IsIndexable(const Node* node) {
+  return !OpIsSideEffecting(node->op());
+}
+
+/*static*/ bool StructuralHashIndex::StructurallyEqual(const Node* a,
+                                                       const Node* b) {
+  if (a->op() != b->op() || a->GetType() != b->GetType()) {
+    return false;
+  }
+  return CanonicalOperands(a) == CanonicalOperands(b) &&
+         a->IsDefinitelyEqualTo(b);
+}
+
+/*static*/ uint64_t StructuralHashIndex::ComputeHash(const Node* node) {
+  std::vector<int64_t> values_to_hash = {
+      static_cast<int64_t>(node->op()),
+      reinterpret_cast<int64_t>(node->GetType())};
+  for (Node* operand : CanonicalOperands(node)) {
+    values_to_hash.push_back(operand->id());
+  }
+  // Mix in the attributes which commonly distinguish otherwise identical
+  // nodes. Attributes not handled here only cause bucket collisions which are
+  // resolved by StructurallyEqual.
+  switch (node->op()) {
+    case Op::kLiteral:
+      values_to_hash.push_back(
+          absl::Hash<Value>()(node->As<Literal>()->value()));
+      break;
+    case Op::kBitSlice:
+      values_to_hash.push_back(node->As<BitSlice>()->start());
+      break;
+    case Op::kTupleIndex:
+      values_to_hash.push_back(node->As<TupleIndex>()->index());
+      break;
+    case Op::kOneHot:
+      values_to_hash.push_back(
+          static_cast<int64_t>(node->As<OneHot>()->priority()));
+      break;
+    case Op::kInvoke:
+      values_to_hash.push_back(
+          reinterpret_cast<int64_t>(node->As<Invoke>()->to_apply()));
+      break;
+    case Op::kMap:
+      values_to_hash.push_back(
+          reinterpret_cast<int64_t>(node->As<Map>()->to_apply()));
+      break;
+    case Op::kCountedFor:
+      values_to_hash.push_back(
+          reinterpret_cast<int64_t>(node->As<CountedFor>()->body()));
+      break;
+    case Op::kDynamicCountedFor:
+      values_to_hash.push_back(
+          reinterpret_cast<int64_t>(node->As<DynamicCountedFor>()->body()));
+      break;
+    default:
+      break;
+  }
+  return absl::Hash<std::vector<int64_t>>()(values_to_hash);
+}
+
+Node* StructuralHashIndex::FindEquivalent(const Node* node) const {
+  auto hash_it = node_hashes_.find(node);
+  uint64_t hash =
+      hash_it == node_hashes_.end() ? ComputeHash(node) : hash_it->second;
+  auto bucket_it = buckets_.find(hash);
+  if (bucket_it == buckets_.end()) {
+    return nullptr;
+  }
+  Node* result = nullptr;
+  for (Node* candidate : bucket_it->second) {
+    if (candidate != node && StructurallyEqual(node, candidate) &&
+        (result == nullptr || candidate->id() < result->id())) {
+      result = candidate;
+    }
+  }
+  return result;
+}
+
+std::vector<Node*> StructuralHashIndex::PopDirtyBucket() {
+  XLS_CHECK(!dirty_worklist_.empty());
+  uint64_t hash = dirty_worklist_.front();
+  dirty_worklist_.pop_front();
+  dirty_set_.erase(hash);
+  auto it = buckets_.find(hash);
+  if (it == buckets_.end()) {
+    return {};
+  }
+  std::vector<Node*> nodes = it->second;
+  SortById(&nodes);
+  return nodes;
+}
+
+void StructuralHashIndex::Insert(Node* node) {
+  if (!IsIndexable(node)) {
+    return;
+  }
+  uint64_t hash = ComputeHash(node);
+  node_hashes_[node] = hash;
+  std::vector<Node*>& bucket = buckets_[hash];
+  bucket.push_back(node);
+  if (bucket.size() > 1 && dirty_set_.insert(hash).second) {
+    dirty_worklist_.push_back(hash);
+  }
+}
+
+void StructuralHashIndex::Remove(Node* node) {
+  auto hash_it = node_hashes_.find(node);
+  if (hash_it == node_hashes_.end()) {
+    return;
+  }
+  auto bucket_it = buckets_.find(hash_it->second);
+  XLS_CHECK(bucket_it != buckets_.end());
+  std::vector<Node*>& bucket = bucket_it->second;
+  bucket.erase(std::find(bucket.begin(), bucket.end(), node));
+  if (bucket.empty()) {
+    buckets_.erase(bucket_it);
+  }
+  node_hashes_.erase(hash_it);
+}
+
+void StructuralHashIndex::NodeAdded(Node* node) { Insert(node); }
+
+void StructuralHashIndex::NodeDeleted(Node* node) { Remove(node); }
+
+void StructuralHashIndex::OperandChanged(Node* node) {
+  // Operands are added during construction before the node is added to the
+  // function base. Such nodes are indexed when NodeAdded is called.
+  if (!node_hashes_.contains(node)) {
+    return;
+  }
+  Remove(node);
+  Insert(node);
+}
+
+void StructuralHashIndex::FunctionBaseDeleted(FunctionBase* function_base) {
+  XLS_CHECK_EQ(function_base, function_base_);
+  function_base_ = nullptr;
+  node_hashes_.clear();
+  buckets_.clear();
+  dirty_worklist_.clear();
+  dirty_set_.clear();
+}
+
+}  // namespace xls
@@ -0,0 +1,105 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_STRUCTURAL_HASH_INDEX_H_
+#define XLS_IR_STRUCTURAL_HASH_INDEX_H_
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "xls/ir/change_listener.h"
+
+namespace xls {
+
+class FunctionBase;
+class Node;
+
+// An index of the nodes of a FunctionBase keyed by a structural hash of each
+// node: its op, type, operands (in canonical order for commutative ops) and
+// op-specific attributes such as literal values and slice bounds. Nodes which
+// compare equal under StructurallyEqual have the same hash so any potentially
+// common subexpressions of a node share its bucket. Side-effecting nodes
+// (including params) are never indexed.
+//
+// The index is a ChangeListener of the function base and is kept up to date
+// incrementally as nodes are added, removed, or have operands replaced, so
+// the cost of maintaining it is proportional to the number of changes rather
+// than the size of the function. A bucket which gains a member while
+// non-empty is placed on a worklist of "dirty" buckets; consumers such as CSE
+// only need to examine dirty buckets rather than rehashing every node.
+//
+// FunctionBuilder consults the index owned by the function base
+// (FunctionBase::GetStructuralHashIndex) as it adds nodes, and CSE drains its
+// dirty buckets, so CSE only examines buckets changed since it last ran.
+class StructuralHashIndex : public ChangeListener {
+ public:
+  explicit StructuralHashIndex(FunctionBase* f);
+  ~StructuralHashIndex() override;
+
+  StructuralHashIndex(const StructuralHashIndex&) = delete;
+  StructuralHashIndex& operator=(const StructuralHashIndex&) = delete;
+
+  // Returns whether nodes of the given kind are tracked by the index.
+  static bool IsIndexable(const Node* node);
+
+  // Returns whether the two nodes are guaranteed to compute the same value:
+  // same op, type, attributes, and operands, where operands of commutative
+  // ops are compared without regard to order.
+  static bool StructurallyEqual(const Node* a, const Node* b);
+
+  // Returns the indexed node with the smallest id other than `node` which is
+  // structurally equal to `node`, or nullptr if there is no such node.
+  Node* FindEquivalent(const Node* node) const;
+
+  // Returns whether any bucket may contain structurally equal nodes which have
+  // not yet been returned by PopDirtyBucket.
+  bool HasDirtyBuckets() const { return !dirty_worklist_.empty(); }
+
+  // Removes a bucket from the dirty worklist and returns its members sorted
+  // by node id. Buckets are returned in the order they became dirty.
+  std::vector<Node*> PopDirtyBucket();
+
+  // Number of nodes in the index.
+  int64_t size() const { return node_hashes_.size(); }
+
+  // ChangeListener overrides.
+  void NodeAdded(Node* node) override;
+  void NodeDeleted(Node* node) override;
+  void OperandChanged(Node* node) override;
+  void FunctionBaseDeleted(FunctionBase* function_base) override;
+
+ private:
+  static uint64_t ComputeHash(const Node* node);
+
+  void Insert(Node* node);
+  void Remove(Node* node);
+
+  FunctionBase* function_base_;
+
+  // Map from indexed node to the hash it is currently bucketed under.
+  absl::flat_hash_map<Node*, uint64_t> node_hashes_;
+  absl::flat_hash_map<uint64_t, std::vector<Node*>> buckets_;
+
+  // Hashes of the dirty buckets in the order they became dirty, and the same
+  // hashes as a set for deduplication.
+  std::deque<uint64_t> dirty_worklist_;
+  absl::flat_hash_set<uint64_t> dirty_set_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_STRUCTURAL_HASH_INDEX_H_
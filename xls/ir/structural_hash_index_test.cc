@@ -0,0 +1,131 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/structural_hash_index.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+class StructuralHashIndexTest : public IrTestBase {};
+
+TEST_F(StructuralHashIndexTest, FindEquivalent) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue add_xy = fb.Add(x, y);
+  BValue add_yx = fb.Add(y, x);
+  BValue sub_xy = fb.Subtract(x, y);
+  BValue sub_yx = fb.Subtract(y, x);
+  BValue lit1 = fb.Literal(UBits(1, 8));
+  BValue lit2 = fb.Literal(UBits(2, 8));
+  BValue lit1_again = fb.Literal(UBits(1, 8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  StructuralHashIndex* index = f->GetStructuralHashIndex();
+  EXPECT_EQ(f->GetStructuralHashIndex(), index);
+  // Params are side-effecting and are not indexed.
+  EXPECT_EQ(index->size(), f->node_count() - 2);
+
+  // Add is commutative so operand order does not matter.
+  EXPECT_EQ(index->FindEquivalent(add_yx.node()), add_xy.node());
+  EXPECT_EQ(index->FindEquivalent(add_xy.node()), add_yx.node());
+  EXPECT_EQ(index->FindEquivalent(sub_xy.node()), nullptr);
+  EXPECT_EQ(index->FindEquivalent(sub_yx.node()), nullptr);
+  EXPECT_EQ(index->FindEquivalent(lit1_again.node()), lit1.node());
+  EXPECT_EQ(index->FindEquivalent(lit2.node()), nullptr);
+  EXPECT_EQ(index->FindEquivalent(x.node()), nullptr);
+}
+
+TEST_F(StructuralHashIndexTest, DirtyBuckets) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue neg1 = fb.Negate(x);
+  BValue neg2 = fb.Negate(x);
+  fb.Not(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  StructuralHashIndex* index = f->GetStructuralHashIndex();
+  ASSERT_TRUE(index->HasDirtyBuckets());
+  EXPECT_THAT(index->PopDirtyBucket(), ElementsAre(neg1.node(), neg2.node()));
+  EXPECT_FALSE(index->HasDirtyBuckets());
+
+  // Adding a node to a non-empty bucket makes it dirty again.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg3,
+                           f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNeg));
+  ASSERT_TRUE(index->HasDirtyBuckets());
+  EXPECT_THAT(index->PopDirtyBucket(),
+              ElementsAre(neg1.node(), neg2.node(), neg3));
+  EXPECT_FALSE(index->HasDirtyBuckets());
+
+  // Removing nodes does not dirty the bucket.
+  XLS_ASSERT_OK(f->RemoveNode(neg3));
+  EXPECT_FALSE(index->HasDirtyBuckets());
+  EXPECT_EQ(index->FindEquivalent(neg2.node()), neg1.node());
+}
+
+TEST_F(StructuralHashIndexTest, OperandReplacement) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue neg_x = fb.Negate(x);
+  BValue neg_y = fb.Negate(y);
+  BValue sub_xy = fb.Subtract(x, y);
+  BValue sub_yx = fb.Subtract(y, x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  StructuralHashIndex* index = f->GetStructuralHashIndex();
+  EXPECT_FALSE(index->HasDirtyBuckets());
+  EXPECT_EQ(index->FindEquivalent(neg_y.node()), nullptr);
+
+  EXPECT_TRUE(neg_y.node()->ReplaceOperand(y.node(), x.node()));
+  EXPECT_EQ(index->FindEquivalent(neg_y.node()), neg_x.node());
+  ASSERT_TRUE(index->HasDirtyBuckets());
+  EXPECT_THAT(index->PopDirtyBucket(),
+              ElementsAre(neg_x.node(), neg_y.node()));
+
+  // Swapping operands is also tracked.
+  sub_yx.node()->SwapOperands(0, 1);
+  EXPECT_EQ(index->FindEquivalent(sub_yx.node()), sub_xy.node());
+  EXPECT_TRUE(index->HasDirtyBuckets());
+}
+
+TEST_F(StructuralHashIndexTest, IndexOutlivesFunction) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Negate(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  auto index = std::make_unique<StructuralHashIndex>(f);
+  EXPECT_EQ(index->size(), 1);
+  XLS_ASSERT_OK(p->RemoveFunction(f));
+  EXPECT_EQ(index->size(), 0);
+  EXPECT_FALSE(index->HasDirtyBuckets());
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,6 +14,10 @@
 
 #include "xls/ir/ternary.h"
 
+#include <cstdint>
+#include <string>
+#include <utility>
+
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -86,7 +90,150 @@ absl::StatusOr<TernaryVector> StringToTernaryVector(std::string_view s) {
   return result;
 }
 
+PackedTernaryVector::PackedTernaryVector(InlineBitmap known,
+                                         InlineBitmap value)
+    : known_(std::move(known)), value_(std::move(value)) {
+  XLS_CHECK_EQ(known_.bit_count(), value_.bit_count());
+  value_.Intersect(known_);
+}
+
+PackedTernaryVector::PackedTernaryVector(const TernaryVector& vector)
+    : PackedTernaryVector(static_cast<int64_t>(vector.size())) {
+  for (int64_t i = 0; i < vector.size(); ++i) {
+    Set(i, vector[i]);
+  }
+}
+
+/* static */ PackedTernaryVector PackedTernaryVector::FromBits(
+    const Bits& bits) {
+  return PackedTernaryVector(InlineBitmap(bits.bit_count(), /*fill=*/true),
+                             bits.bitmap());
+}
+
+/* static */ PackedTernaryVector PackedTernaryVector::FromKnownBits(
+    const Bits& known_bits, const Bits& known_bits_values) {
+  XLS_CHECK_EQ(known_bits.bit_count(), known_bits_values.bit_count());
+  return PackedTernaryVector(known_bits.bitmap(), known_bits_values.bitmap());
+}
+
+TernaryVector PackedTernaryVector::ToTernaryVector() const {
+  TernaryVector result;
+  result.reserve(size());
+  for (int64_t i = 0; i < size(); ++i) {
+    result.push_back(Get(i));
+  }
+  return result;
+}
+
+std::string ToString(const PackedTernaryVector& value) {
+  return ToString(value.ToTernaryVector());
+}
+
 namespace ternary_ops {
+namespace {
+
+// Returns the word `wordno` of the mask of elements of `v` which are known to
+// be zero.
+uint64_t KnownZeroWord(const PackedTernaryVector& v, int64_t wordno) {
+  return v.known().GetWord(wordno) & ~v.value().GetWord(wordno);
+}
+
+// Returns x + y + carry and sets carry to the carry out.
+uint64_t AddWords(uint64_t x, uint64_t y, uint64_t& carry) {
+  uint64_t sum = x + y;
+  uint64_t carry_out = sum < x ? 1 : 0;
+  sum += carry;
+  carry_out |= sum < carry ? 1 : 0;
+  carry = carry_out;
+  return sum;
+}
+
+// Ternary a + b + carry_in for a known carry in. Adds the smallest and the
+// largest possible values of the operands: a carry into a bit is known
+// exactly when it is the same in both sums (see LLVM's
+// KnownBits::computeForAddSub).
+PackedTernaryVector AddWithCarry(const PackedTernaryVector& a,
+                                 const PackedTernaryVector& b,
+                                 bool carry_in) {
+  XLS_CHECK_EQ(a.size(), b.size());
+  InlineBitmap known(a.size());
+  InlineBitmap value(a.size());
+  uint64_t min_carry = carry_in ? 1 : 0;
+  uint64_t max_carry = min_carry;
+  for (int64_t i = 0; i < known.word_count(); ++i) {
+    uint64_t a_one = a.value().GetWord(i);
+    uint64_t b_one = b.value().GetWord(i);
+    uint64_t a_zero = KnownZeroWord(a, i);
+    uint64_t b_zero = KnownZeroWord(b, i);
+    uint64_t min_sum = AddWords(a_one, b_one, min_carry);
+    uint64_t max_sum = AddWords(~a_zero, ~b_zero, max_carry);
+    uint64_t carry_known_one = min_sum ^ a_one ^ b_one;
+    uint64_t carry_known_zero = ~(max_sum ^ a_zero ^ b_zero);
+    uint64_t known_word = a.known().GetWord(i) & b.known().GetWord(i) &
+                          (carry_known_one | carry_known_zero);
+    known.SetWord(i, known_word);
+    value.SetWord(i, min_sum & known_word);
+  }
+  return PackedTernaryVector(std::move(known), std::move(value));
+}
+
+}  // namespace
+
+PackedTernaryVector Not(const PackedTernaryVector& a) {
+  InlineBitmap value = a.value();
+  value.Invert();
+  return PackedTernaryVector(a.known(), std::move(value));
+}
+
+// An element of the result is known if both are known or either is zero.
+PackedTernaryVector And(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  XLS_CHECK_EQ(a.size(), b.size());
+  InlineBitmap known(a.size());
+  InlineBitmap value(a.size());
+  for (int64_t i = 0; i < known.word_count(); ++i) {
+    known.SetWord(i, (a.known().GetWord(i) & b.known().GetWord(i)) |
+                         KnownZeroWord(a, i) | KnownZeroWord(b, i));
+    value.SetWord(i, a.value().GetWord(i) & b.value().GetWord(i));
+  }
+  return PackedTernaryVector(std::move(known), std::move(value));
+}
+
+// An element of the result is known if both are known or either is one.
+PackedTernaryVector Or(const PackedTernaryVector& a,
+                       const PackedTernaryVector& b) {
+  XLS_CHECK_EQ(a.size(), b.size());
+  InlineBitmap known(a.size());
+  InlineBitmap value(a.size());
+  for (int64_t i = 0; i < known.word_count(); ++i) {
+    uint64_t value_word = a.value().GetWord(i) | b.value().GetWord(i);
+    known.SetWord(i,
+                  (a.known().GetWord(i) & b.known().GetWord(i)) | value_word);
+    value.SetWord(i, value_word);
+  }
+  return PackedTernaryVector(std::move(known), std::move(value));
+}
+
+PackedTernaryVector Xor(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  XLS_CHECK_EQ(a.size(), b.size());
+  InlineBitmap known = a.known();
+  known.Intersect(b.known());
+  InlineBitmap value = a.value();
+  value.Xor(b.value());
+  return PackedTernaryVector(std::move(known), std::move(value));
+}
+
+PackedTernaryVector Add(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  return AddWithCarry(a, b, /*carry_in=*/false);
+}
+
+// a - b = a + ~b + 1.
+PackedTernaryVector Sub(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  return AddWithCarry(a, Not(b), /*carry_in=*/true);
+}
 
 Bits ToKnownBits(const TernaryVector& ternary_vector) {
   absl::InlinedVector<bool, 1> bits(ternary_vector.size());
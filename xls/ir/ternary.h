@@ -15,9 +15,12 @@
 #ifndef XLS_IR_TERNARY_H_
 #define XLS_IR_TERNARY_H_
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bits.h"
 
 namespace xls {
@@ -51,6 +54,74 @@ inline std::ostream& operator<<(std::ostream& os, TernaryVector vector) {
   return os;
 }
 
+// A vector of ternary values packed into two bitmaps: bit i of `known()` is
+// set if element i is known, in which case bit i of `value()` holds its value.
+// Bits of `value()` are zero where the element is unknown. Takes two bits per
+// element rather than a byte, and the operations on it in ternary_ops evaluate
+// 64 elements per word operation.
+class PackedTernaryVector {
+ public:
+  // Creates a vector of `size` unknown elements.
+  explicit PackedTernaryVector(int64_t size) : known_(size), value_(size) {}
+
+  // Creates a vector from the given masks. Bits of `value` which are not set
+  // in `known` are ignored.
+  PackedTernaryVector(InlineBitmap known, InlineBitmap value);
+
+  // Adapter from the unpacked representation.
+  explicit PackedTernaryVector(const TernaryVector& vector);
+
+  // Returns a vector with all elements known and equal to `bits`.
+  static PackedTernaryVector FromBits(const Bits& bits);
+
+  // As ternary_ops::FromKnownBits().
+  static PackedTernaryVector FromKnownBits(const Bits& known_bits,
+                                           const Bits& known_bits_values);
+
+  // Adapter to the unpacked representation.
+  TernaryVector ToTernaryVector() const;
+
+  int64_t size() const { return known_.bit_count(); }
+
+  TernaryValue Get(int64_t i) const {
+    if (!known_.Get(i)) {
+      return TernaryValue::kUnknown;
+    }
+    return value_.Get(i) ? TernaryValue::kKnownOne : TernaryValue::kKnownZero;
+  }
+  void Set(int64_t i, TernaryValue value) {
+    known_.Set(i, value != TernaryValue::kUnknown);
+    value_.Set(i, value == TernaryValue::kKnownOne);
+  }
+
+  const InlineBitmap& known() const { return known_; }
+  const InlineBitmap& value() const { return value_; }
+
+  // Returns the known mask and the known values as `Bits`, as
+  // ternary_ops::ToKnownBits() and ternary_ops::ToKnownBitsValues().
+  Bits ToKnownBits() const { return Bits::FromBitmap(known_); }
+  Bits ToKnownBitsValues() const { return Bits::FromBitmap(value_); }
+
+  bool operator==(const PackedTernaryVector& other) const {
+    return known_ == other.known_ && value_ == other.value_;
+  }
+  bool operator!=(const PackedTernaryVector& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  InlineBitmap known_;
+  InlineBitmap value_;
+};
+
+std::string ToString(const PackedTernaryVector& value);
+
+inline std::ostream& operator<<(std::ostream& os,
+                                const PackedTernaryVector& vector) {
+  os << ToString(vector);
+  return os;
+}
+
 namespace ternary_ops {
 
 inline TernaryVector FromKnownBits(const Bits& known_bits,
@@ -167,6 +238,26 @@ inline TernaryVector BitsToTernary(const Bits& bits) {
   return result;
 }
 
+// Word-parallel operations on packed ternary vectors. Each element of the
+// result is known exactly when it is the same for every assignment of the
+// unknown elements of the operands. The operands must have the same size.
+PackedTernaryVector Not(const PackedTernaryVector& a);
+PackedTernaryVector And(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+PackedTernaryVector Or(const PackedTernaryVector& a,
+                       const PackedTernaryVector& b);
+PackedTernaryVector Xor(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+
+// Returns the ternary sum (difference) of the operands, modulo 2^size. The
+// carries are computed for the smallest and the largest possible operand
+// values at once, so this is as precise as possible rather than a ripple of
+// ternary full adders.
+PackedTernaryVector Add(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+PackedTernaryVector Sub(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+
 }  // namespace ternary_ops
 }  // namespace xls
 
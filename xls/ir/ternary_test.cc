@@ -14,8 +14,13 @@
 
 #include "xls/ir/ternary.h"
 
+#include <cstdint>
+#include <functional>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xls/ir/bits_ops.h"
 
 namespace xls {
 namespace {
@@ -55,5 +60,125 @@ TEST(Ternary, NumberOfKnownBits) {
   EXPECT_EQ(ternary_ops::NumberOfKnownBits(TernaryVector()), 0);
 }
 
+// Returns every ternary vector of the given width.
+std::vector<TernaryVector> AllTernaryVectors(int64_t width) {
+  std::vector<TernaryVector> result = {TernaryVector()};
+  for (int64_t i = 0; i < width; ++i) {
+    std::vector<TernaryVector> extended;
+    for (const TernaryVector& v : result) {
+      for (TernaryValue t : {TernaryValue::kKnownZero, TernaryValue::kKnownOne,
+                             TernaryValue::kUnknown}) {
+        extended.push_back(v);
+        extended.back().push_back(t);
+      }
+    }
+    result = std::move(extended);
+  }
+  return result;
+}
+
+// Returns every concrete value (as an integer) matched by `v`.
+std::vector<uint64_t> Concretize(const TernaryVector& v) {
+  std::vector<uint64_t> result = {0};
+  for (int64_t i = 0; i < v.size(); ++i) {
+    int64_t count = result.size();
+    for (int64_t j = 0; j < count; ++j) {
+      if (v[i] == TernaryValue::kKnownOne) {
+        result[j] |= uint64_t{1} << i;
+      } else if (v[i] == TernaryValue::kUnknown) {
+        result.push_back(result[j] | (uint64_t{1} << i));
+      }
+    }
+  }
+  return result;
+}
+
+// Returns the most precise ternary vector matching f(x, y) for all concrete
+// x and y matched by `a` and `b`.
+TernaryVector BruteForce(const TernaryVector& a, const TernaryVector& b,
+                         const std::function<uint64_t(uint64_t, uint64_t)>& f) {
+  uint64_t mask = (uint64_t{1} << a.size()) - 1;
+  uint64_t ones = mask;
+  uint64_t zeros = mask;
+  for (uint64_t x : Concretize(a)) {
+    for (uint64_t y : Concretize(b)) {
+      uint64_t result = f(x, y) & mask;
+      ones &= result;
+      zeros &= ~result;
+    }
+  }
+  TernaryVector result;
+  for (int64_t i = 0; i < a.size(); ++i) {
+    if ((ones >> i) & 1) {
+      result.push_back(TernaryValue::kKnownOne);
+    } else if ((zeros >> i) & 1) {
+      result.push_back(TernaryValue::kKnownZero);
+    } else {
+      result.push_back(TernaryValue::kUnknown);
+    }
+  }
+  return result;
+}
+
+TEST(Ternary, PackedRoundTrip) {
+  TernaryVector vector = *StringToTernaryVector("0b1101X1X001");
+  PackedTernaryVector packed(vector);
+  EXPECT_EQ(packed.size(), 10);
+  EXPECT_EQ(packed.ToTernaryVector(), vector);
+  EXPECT_EQ(packed.Get(3), TernaryValue::kUnknown);
+  EXPECT_EQ(packed.ToKnownBits(), ternary_ops::ToKnownBits(vector));
+  EXPECT_EQ(packed.ToKnownBitsValues(), ternary_ops::ToKnownBitsValues(vector));
+  EXPECT_EQ(packed, PackedTernaryVector::FromKnownBits(
+                        UBits(0b1111010111, 10), UBits(0b1101010001, 10)));
+  EXPECT_EQ(ToString(packed), "0b11_01X1_X001");
+
+  EXPECT_EQ(PackedTernaryVector::FromBits(UBits(5, 3)).ToTernaryVector(),
+            *StringToTernaryVector("0b101"));
+  EXPECT_EQ(PackedTernaryVector(3).ToTernaryVector(),
+            *StringToTernaryVector("0bXXX"));
+}
+
+TEST(Ternary, PackedOperationsAreExact) {
+  for (const TernaryVector& a : AllTernaryVectors(4)) {
+    PackedTernaryVector packed_a(a);
+    EXPECT_EQ(ternary_ops::Not(packed_a).ToTernaryVector(),
+              BruteForce(a, a, [](uint64_t x, uint64_t) { return ~x; }));
+    for (const TernaryVector& b : AllTernaryVectors(4)) {
+      PackedTernaryVector packed_b(b);
+      EXPECT_EQ(ternary_ops::And(packed_a, packed_b).ToTernaryVector(),
+                BruteForce(a, b, std::bit_and<uint64_t>()));
+      EXPECT_EQ(ternary_ops::Or(packed_a, packed_b).ToTernaryVector(),
+                BruteForce(a, b, std::bit_or<uint64_t>()));
+      EXPECT_EQ(ternary_ops::Xor(packed_a, packed_b).ToTernaryVector(),
+                BruteForce(a, b, std::bit_xor<uint64_t>()));
+      EXPECT_EQ(ternary_ops::Add(packed_a, packed_b).ToTernaryVector(),
+                BruteForce(a, b, std::plus<uint64_t>()));
+      EXPECT_EQ(ternary_ops::Sub(packed_a, packed_b).ToTernaryVector(),
+                BruteForce(a, b, std::minus<uint64_t>()));
+    }
+  }
+}
+
+TEST(Ternary, PackedAddCarriesAcrossWords) {
+  // (2^64 - 1) + 1 carries into the second word.
+  Bits all_ones_low = bits_ops::ZeroExtend(Bits::AllOnes(64), 130);
+  PackedTernaryVector sum =
+      ternary_ops::Add(PackedTernaryVector::FromBits(all_ones_low),
+                       PackedTernaryVector::FromBits(UBits(1, 130)));
+  EXPECT_EQ(sum, PackedTernaryVector::FromBits(
+                     bits_ops::ShiftLeftLogical(UBits(1, 130), 64)));
+
+  // With an unknown bit 64 in one operand, the carry out of the low word makes
+  // bits 64 and 65 unknown. The carry stops there, so the rest stays known.
+  PackedTernaryVector x = PackedTernaryVector::FromBits(all_ones_low);
+  x.Set(64, TernaryValue::kUnknown);
+  sum = ternary_ops::Add(x, PackedTernaryVector::FromBits(UBits(1, 130)));
+  for (int64_t i = 0; i < 130; ++i) {
+    EXPECT_EQ(sum.Get(i), i == 64 || i == 65 ? TernaryValue::kUnknown
+                                             : TernaryValue::kKnownZero)
+        << i;
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,6 +14,8 @@
 
 #include "xls/ir/value.h"
 
+#include <new>
+
 #include "absl/algorithm/container.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -24,6 +26,52 @@
 #include "re2/re2.h"
 
 namespace xls {
+namespace internal {
+
+ValueElements::ValueElements(absl::Span<const Value> elements)
+    : rep_(nullptr) {
+  if (elements.empty()) {
+    return;
+  }
+  rep_ = Allocate(elements.size());
+  Value* dst = data();
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    new (dst + i) Value(elements[i]);
+  }
+}
+
+ValueElements::ValueElements(std::vector<Value>&& elements) : rep_(nullptr) {
+  if (elements.empty()) {
+    return;
+  }
+  rep_ = Allocate(elements.size());
+  Value* dst = data();
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    new (dst + i) Value(std::move(elements[i]));
+  }
+}
+
+/* static */ ValueElements::Rep* ValueElements::Allocate(int64_t size) {
+  XLS_CHECK_GT(size, 0);
+  void* memory = ::operator new(sizeof(Rep) + size * sizeof(Value));
+  return new (memory) Rep(size);
+}
+
+void ValueElements::Unref() {
+  if (rep_ == nullptr ||
+      rep_->ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  Value* elements = data();
+  for (int64_t i = rep_->size - 1; i >= 0; --i) {
+    elements[i].~Value();
+  }
+  rep_->~Rep();
+  ::operator delete(rep_);
+  rep_ = nullptr;
+}
+
+}  // namespace internal
 
 /* static */ absl::StatusOr<Value> Value::Array(
     absl::Span<const Value> elements) {
@@ -38,6 +86,19 @@ namespace xls {
   return Value(ValueKind::kArray, elements);
 }
 
+/* static */ absl::StatusOr<Value> Value::ArrayOwned(
+    std::vector<Value>&& elements) {
+  if (elements.empty()) {
+    return absl::UnimplementedError("Empty array Values are not supported.");
+  }
+
+  // Blow up if they're not all of the same type.
+  for (int64_t i = 1; i < elements.size(); ++i) {
+    XLS_RET_CHECK(elements[0].SameTypeAs(elements[i]));
+  }
+  return Value(ValueKind::kArray, std::move(elements));
+}
+
 /* static */ absl::StatusOr<Value> Value::UBitsArray(
     absl::Span<const uint64_t> elements, int64_t bit_count) {
   if (elements.empty()) {
@@ -235,7 +296,7 @@ void Value::FlattenTo(BitPushBuffer* buffer) const {
 }
 
 absl::StatusOr<std::vector<Value>> Value::GetElements() const {
-  if (!std::holds_alternative<std::vector<Value>>(payload_)) {
+  if (!std::holds_alternative<internal::ValueElements>(payload_)) {
     return absl::InvalidArgumentError("Value does not hold elements.");
   }
   return std::vector<Value>(elements().begin(), elements().end());
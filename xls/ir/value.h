@@ -15,6 +15,12 @@
 #ifndef XLS_IR_VALUE_H_
 #define XLS_IR_VALUE_H_
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -24,6 +30,7 @@
 namespace xls {
 
 class Type;
+class Value;
 
 enum class ValueKind {
   kInvalid,
@@ -47,6 +54,67 @@ inline std::ostream& operator<<(std::ostream& os, ValueKind kind) {
   return os;
 }
 
+namespace internal {
+
+// Immutable, reference-counted storage for the elements of a tuple or array
+// Value. The reference count, the element count and the elements themselves
+// share a single heap allocation, and copying a Value only copies a pointer to
+// the storage. Empty aggregates (and tokens) allocate nothing. Values are
+// immutable so sharing the storage between copies is unobservable.
+class ValueElements {
+ public:
+  ValueElements() : rep_(nullptr) {}
+  explicit ValueElements(absl::Span<const Value> elements);
+  explicit ValueElements(std::vector<Value>&& elements);
+
+  ValueElements(const ValueElements& other) : rep_(other.rep_) { Ref(); }
+  ValueElements(ValueElements&& other) noexcept : rep_(other.rep_) {
+    other.rep_ = nullptr;
+  }
+  ValueElements& operator=(const ValueElements& other) {
+    ValueElements copy(other);
+    std::swap(rep_, copy.rep_);
+    return *this;
+  }
+  ValueElements& operator=(ValueElements&& other) noexcept {
+    std::swap(rep_, other.rep_);
+    return *this;
+  }
+  ~ValueElements() { Unref(); }
+
+  // Defined after Value as Value must be complete.
+  inline absl::Span<const Value> span() const;
+
+ private:
+  // Header of the allocation. The elements immediately follow it.
+  struct alignas(alignof(std::max_align_t)) Rep {
+    explicit Rep(int64_t size) : ref_count(1), size(size) {}
+
+    std::atomic<int64_t> ref_count;
+    int64_t size;
+  };
+
+  // Allocates uninitialized storage for `size` elements. `size` must be
+  // positive.
+  static Rep* Allocate(int64_t size);
+
+  Value* data() const {
+    return reinterpret_cast<Value*>(reinterpret_cast<char*>(rep_) +
+                                    sizeof(Rep));
+  }
+
+  void Ref() {
+    if (rep_ != nullptr) {
+      rep_->ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  void Unref();
+
+  Rep* rep_;
+};
+
+}  // namespace internal
+
 // Represents a value in the XLS system; e.g. values can be "bits", tuples of
 // values, or arrays or values. Arrays are represented similarly to tuples, but
 // are monomorphic and potentially multi-dimensional.
@@ -59,12 +127,14 @@ class Value {
     return Value(ValueKind::kTuple, elements);
   }
   static Value TupleOwned(std::vector<Value>&& elements) {
-    return Value(ValueKind::kTuple, elements);
+    return Value(ValueKind::kTuple, std::move(elements));
   }
 
   // All members of "elements" must be of the same type, or an error status will
   // be returned.
   static absl::StatusOr<Value> Array(absl::Span<const Value> elements);
+  // As above, but moves rather than copies the elements into the array.
+  static absl::StatusOr<Value> ArrayOwned(std::vector<Value>&& elements);
 
   // Shortcut to create an array of bits from an initializer list of literals
   // ex. UBitsArray({1, 2}, 32) will create a Value of type bits[32][2]
@@ -84,7 +154,7 @@ class Value {
   }
 
   static Value Token() {
-    return Value(ValueKind::kToken, std::vector<Value>({}));
+    return Value(ValueKind::kToken, internal::ValueElements());
   }
   static Value Bool(bool enabled) {
     return Value(UBits(/*value=*/enabled, /*bit_count=*/1));
@@ -109,7 +179,7 @@ class Value {
   absl::StatusOr<std::vector<Value>> GetElements() const;
 
   absl::Span<const Value> elements() const {
-    return std::get<std::vector<Value>>(payload_);
+    return std::get<internal::ValueElements>(payload_).span();
   }
   const Value& element(int64_t i) const { return elements().at(i); }
   int64_t size() const { return elements().size(); }
@@ -146,18 +216,43 @@ class Value {
   bool operator==(const Value& other) const;
   bool operator!=(const Value& other) const { return !(*this == other); }
 
+  template <typename H>
+  friend H AbslHashValue(H h, const Value& value) {
+    h = H::combine(std::move(h), value.kind_);
+    if (value.IsBits()) {
+      return H::combine(std::move(h), value.bits());
+    }
+    if (value.IsTuple() || value.IsArray()) {
+      return H::combine(std::move(h), value.elements());
+    }
+    return h;
+  }
+
  private:
   Value(ValueKind kind, absl::Span<const Value> elements)
-      : kind_(kind),
-        payload_(std::vector<Value>(elements.begin(), elements.end())) {}
+      : kind_(kind), payload_(internal::ValueElements(elements)) {}
 
   Value(ValueKind kind, std::vector<Value>&& elements)
+      : kind_(kind), payload_(internal::ValueElements(std::move(elements))) {}
+
+  Value(ValueKind kind, internal::ValueElements elements)
       : kind_(kind), payload_(std::move(elements)) {}
 
   ValueKind kind_;
-  std::variant<std::nullptr_t, std::vector<Value>, Bits> payload_;
+  std::variant<std::nullptr_t, internal::ValueElements, Bits> payload_;
 };
 
+namespace internal {
+
+absl::Span<const Value> ValueElements::span() const {
+  if (rep_ == nullptr) {
+    return absl::Span<const Value>();
+  }
+  return absl::Span<const Value>(data(), rep_->size);
+}
+
+}  // namespace internal
+
 inline std::ostream& operator<<(std::ostream& os, const Value& value) {
   os << value.ToString(FormatPreference::kDefault);
   return os;
@@ -105,12 +105,15 @@ absl::StatusOr<float> TupleToF32(const Value& v) {
 }
 
 absl::StatusOr<Value> LeafTypeTreeToValue(const LeafTypeTree<Value>& tree) {
+  return LeafTypeTreeToValue(tree.AsView());
+}
+
+absl::StatusOr<Value> LeafTypeTreeToValue(LeafTypeTreeView<const Value> tree) {
   Type* type = tree.type();
   if (type->IsTuple()) {
     std::vector<Value> values;
     for (int64_t i = 0; i < type->AsTupleOrDie()->size(); ++i) {
-      XLS_ASSIGN_OR_RETURN(Value value,
-                           LeafTypeTreeToValue(tree.CopySubtree({i})));
+      XLS_ASSIGN_OR_RETURN(Value value, LeafTypeTreeToValue(tree.AsView({i})));
       values.push_back(value);
     }
     return Value::TupleOwned(std::move(values));
@@ -118,8 +121,7 @@ absl::StatusOr<Value> LeafTypeTreeToValue(const LeafTypeTree<Value>& tree) {
   if (type->IsArray()) {
     std::vector<Value> values;
     for (int64_t i = 0; i < type->AsArrayOrDie()->size(); ++i) {
-      XLS_ASSIGN_OR_RETURN(Value value,
-                           LeafTypeTreeToValue(tree.CopySubtree({i})));
+      XLS_ASSIGN_OR_RETURN(Value value, LeafTypeTreeToValue(tree.AsView({i})));
       values.push_back(value);
     }
     return Value::ArrayOrDie(values);
@@ -93,8 +93,9 @@ Value F32ToTuple(float value);
 // Converts a 3-tuple F32 (as noted in F32ToTuple above) into a C++ float.
 absl::StatusOr<float> TupleToF32(const Value& v);
 
-// Converts a `LeafTypeTree<Value>` to a `Value`.
+// Converts a `LeafTypeTree<Value>` (or a view of one) to a `Value`.
 absl::StatusOr<Value> LeafTypeTreeToValue(const LeafTypeTree<Value>& tree);
+absl::StatusOr<Value> LeafTypeTreeToValue(LeafTypeTreeView<const Value> tree);
 
 // Converts a `Value` to a `LeafTypeTree<Value>`.
 // The given `Type*` must be the type of the given `Value`.
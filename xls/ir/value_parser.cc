@@ -0,0 +1,326 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/value_parser.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+
+namespace xls {
+namespace {
+
+// Returns the value of the given digit in the given base (2, 10 or 16) or -1
+// if it is not a digit of the base.
+int64_t DigitValue(char c, int64_t base) {
+  int64_t value;
+  if (c >= '0' && c <= '9') {
+    value = c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    value = c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    value = c - 'A' + 10;
+  } else {
+    return -1;
+  }
+  return value < base ? value : -1;
+}
+
+// Whether the character may continue an identifier or keyword, as in the IR
+// scanner.
+bool IsIdentifierChar(char c) {
+  return absl::ascii_isalnum(c) || c == '_' || c == '.';
+}
+
+class FastValueParser {
+ public:
+  explicit FastValueParser(std::string_view input) : input_(input) {}
+
+  // Parses a value of the given type, or a typed value if type is null.
+  std::optional<Value> ParseValue(Type* type);
+
+  // Returns whether only whitespace remains.
+  bool AtEnd() {
+    SkipWhitespace();
+    return pos_ == input_.size();
+  }
+
+ private:
+  void SkipWhitespace() {
+    while (pos_ < input_.size() && absl::ascii_isspace(input_[pos_])) {
+      ++pos_;
+    }
+  }
+
+  bool PeekIs(char c) {
+    SkipWhitespace();
+    return pos_ < input_.size() && input_[pos_] == c;
+  }
+
+  bool TryDrop(char c) {
+    if (!PeekIs(c)) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  bool TryDropKeyword(std::string_view keyword) {
+    SkipWhitespace();
+    std::string_view rest = input_.substr(pos_);
+    if (!absl::StartsWith(rest, keyword) ||
+        (rest.size() > keyword.size() &&
+         IsIdentifierChar(rest[keyword.size()]))) {
+      return false;
+    }
+    pos_ += keyword.size();
+    return true;
+  }
+
+  // Returns the characters of the literal at the current position: a digit
+  // followed by any alphanumeric characters and underscores.
+  std::optional<std::string_view> PopLiteral() {
+    SkipWhitespace();
+    if (pos_ == input_.size() || !absl::ascii_isdigit(input_[pos_])) {
+      return std::nullopt;
+    }
+    int64_t start = pos_;
+    while (pos_ < input_.size() &&
+           (absl::ascii_isalnum(input_[pos_]) || input_[pos_] == '_')) {
+      ++pos_;
+    }
+    return input_.substr(start, pos_ - start);
+  }
+
+  // Parses decimal digits (and underscores) of a number less than 10^18.
+  static std::optional<uint64_t> ParseDecimal(std::string_view digits);
+
+  // Parses hexadecimal or binary digits (and underscores) into a Bits value
+  // of the given width, one 64-bit word at a time from the least significant
+  // digit. Returns std::nullopt if the value does not fit.
+  static std::optional<Bits> ParsePowerOfTwoBase(std::string_view digits,
+                                                 int64_t base_bits,
+                                                 int64_t bit_count);
+
+  std::optional<Bits> ParseBitsLiteral(int64_t bit_count);
+
+  std::string_view input_;
+  int64_t pos_ = 0;
+};
+
+std::optional<uint64_t> FastValueParser::ParseDecimal(
+    std::string_view digits) {
+  uint64_t value = 0;
+  int64_t digit_count = 0;
+  for (char c : digits) {
+    if (c == '_') {
+      continue;
+    }
+    int64_t digit = DigitValue(c, 10);
+    if (digit < 0 || ++digit_count > 18) {
+      return std::nullopt;
+    }
+    value = value * 10 + digit;
+  }
+  if (digit_count == 0) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+std::optional<Bits> FastValueParser::ParsePowerOfTwoBase(
+    std::string_view digits, int64_t base_bits, int64_t bit_count) {
+  InlineBitmap bitmap(bit_count);
+  uint64_t word = 0;
+  int64_t shift = 0;
+  int64_t wordno = 0;
+  bool any_digit = false;
+  // Stores the completed word, failing if it holds bits beyond bit_count.
+  auto flush = [&]() {
+    if (word != 0) {
+      if (wordno >= bitmap.word_count()) {
+        return false;
+      }
+      bitmap.SetWord(wordno, word);
+      if (bitmap.GetWord(wordno) != word) {
+        return false;
+      }
+    }
+    word = 0;
+    shift = 0;
+    ++wordno;
+    return true;
+  };
+  for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+    if (*it == '_') {
+      continue;
+    }
+    int64_t digit = DigitValue(*it, int64_t{1} << base_bits);
+    if (digit < 0) {
+      return std::nullopt;
+    }
+    any_digit = true;
+    word |= static_cast<uint64_t>(digit) << shift;
+    shift += base_bits;
+    if (shift == 64 && !flush()) {
+      return std::nullopt;
+    }
+  }
+  if (!any_digit || !flush()) {
+    return std::nullopt;
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
+std::optional<Bits> FastValueParser::ParseBitsLiteral(int64_t bit_count) {
+  std::optional<std::string_view> literal = PopLiteral();
+  if (!literal.has_value()) {
+    return std::nullopt;
+  }
+  if (literal->size() >= 2 && (*literal)[0] == '0') {
+    if ((*literal)[1] == 'x') {
+      return ParsePowerOfTwoBase(literal->substr(2), /*base_bits=*/4,
+                                 bit_count);
+    }
+    if ((*literal)[1] == 'b') {
+      return ParsePowerOfTwoBase(literal->substr(2), /*base_bits=*/1,
+                                 bit_count);
+    }
+  }
+  std::optional<uint64_t> value = ParseDecimal(*literal);
+  if (!value.has_value()) {
+    return std::nullopt;
+  }
+  if (bit_count < 64 && (*value >> bit_count) != 0) {
+    return std::nullopt;
+  }
+  InlineBitmap bitmap(bit_count);
+  if (bit_count > 0) {
+    bitmap.SetWord(0, *value);
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
+std::optional<Value> FastValueParser::ParseValue(Type* type) {
+  TypeKind kind;
+  int64_t bit_count = 0;
+  if (type != nullptr) {
+    kind = type->kind();
+    if (type->IsBits()) {
+      bit_count = type->AsBitsOrDie()->bit_count();
+    }
+  } else if (TryDropKeyword("token")) {
+    return Value::Token();
+  } else if (TryDropKeyword("bits")) {
+    if (!TryDrop('[')) {
+      return std::nullopt;
+    }
+    std::optional<std::string_view> width = PopLiteral();
+    if (!width.has_value()) {
+      return std::nullopt;
+    }
+    std::optional<uint64_t> width_value = ParseDecimal(*width);
+    if (!width_value.has_value() || !TryDrop(']') || !TryDrop(':')) {
+      return std::nullopt;
+    }
+    kind = TypeKind::kBits;
+    bit_count = *width_value;
+  } else if (PeekIs('[')) {
+    kind = TypeKind::kArray;
+  } else {
+    kind = TypeKind::kTuple;
+  }
+
+  switch (kind) {
+    case TypeKind::kBits: {
+      std::optional<Bits> bits = ParseBitsLiteral(bit_count);
+      if (!bits.has_value()) {
+        return std::nullopt;
+      }
+      return Value(*std::move(bits));
+    }
+    case TypeKind::kArray: {
+      if (!TryDrop('[')) {
+        return std::nullopt;
+      }
+      Type* element_type =
+          type == nullptr ? nullptr : type->AsArrayOrDie()->element_type();
+      std::vector<Value> elements;
+      while (!TryDrop(']')) {
+        if (!elements.empty() && !TryDrop(',')) {
+          return std::nullopt;
+        }
+        std::optional<Value> element = ParseValue(element_type);
+        if (!element.has_value()) {
+          return std::nullopt;
+        }
+        elements.push_back(*std::move(element));
+      }
+      absl::StatusOr<Value> array = Value::ArrayOwned(std::move(elements));
+      if (!array.ok()) {
+        return std::nullopt;
+      }
+      return *std::move(array);
+    }
+    case TypeKind::kTuple: {
+      if (!TryDrop('(')) {
+        return std::nullopt;
+      }
+      std::vector<Value> elements;
+      while (!TryDrop(')')) {
+        if (!elements.empty() && !TryDrop(',')) {
+          return std::nullopt;
+        }
+        Type* element_type = nullptr;
+        if (type != nullptr) {
+          TupleType* tuple_type = type->AsTupleOrDie();
+          if (elements.size() >= tuple_type->size()) {
+            return std::nullopt;
+          }
+          element_type = tuple_type->element_type(elements.size());
+        }
+        std::optional<Value> element = ParseValue(element_type);
+        if (!element.has_value()) {
+          return std::nullopt;
+        }
+        elements.push_back(*std::move(element));
+      }
+      return Value::TupleOwned(std::move(elements));
+    }
+    case TypeKind::kToken:
+      if (!TryDropKeyword("token")) {
+        return std::nullopt;
+      }
+      return Value::Token();
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::optional<Value> TryParseValueFast(std::string_view input, Type* type) {
+  FastValueParser parser(input);
+  std::optional<Value> value = parser.ParseValue(type);
+  if (!value.has_value() || !parser.AtEnd()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+}  // namespace xls
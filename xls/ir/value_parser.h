@@ -0,0 +1,46 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A parser for the textual form of values which works directly on the input
+// string. Parser::ParseValue goes through the general IR scanner, which
+// creates a token holding a std::string for every literal and punctuation
+// mark; this parser allocates nothing beyond the Bits and Values it returns,
+// which makes it much faster on large values such as test vectors.
+
+#ifndef XLS_IR_VALUE_PARSER_H_
+#define XLS_IR_VALUE_PARSER_H_
+
+#include <optional>
+#include <string_view>
+
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Parses the given string as a value of the given type or, if type is null,
+// as a typed value (e.g. "(bits[8]:0x42, [bits[1]:0, bits[1]:1])").
+//
+// Handles the forms emitted by Value::ToString: hexadecimal, binary and
+// decimal literals which fit in 64 bits, optionally with underscores. Returns
+// std::nullopt if the input contains anything else (negative literals,
+// comments, trailing tokens) or is malformed, in which case the caller should
+// fall back to the general parser, which accepts every form and produces
+// descriptive errors.
+std::optional<Value> TryParseValueFast(std::string_view input,
+                                       Type* type = nullptr);
+
+}  // namespace xls
+
+#endif  // XLS_IR_VALUE_PARSER_H_
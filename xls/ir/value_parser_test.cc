@@ -0,0 +1,122 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/value_parser.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::Optional;
+
+TEST(ValueParserTest, TypedValues) {
+  EXPECT_THAT(TryParseValueFast("bits[32]:0x42"),
+              Optional(Value(UBits(0x42, 32))));
+  EXPECT_THAT(TryParseValueFast("  bits [8] : 0b1010_0101  "),
+              Optional(Value(UBits(0xa5, 8))));
+  EXPECT_THAT(TryParseValueFast("bits[16]:1234"),
+              Optional(Value(UBits(1234, 16))));
+  EXPECT_THAT(TryParseValueFast("bits[0]:0"), Optional(Value(Bits())));
+  EXPECT_THAT(TryParseValueFast("token"), Optional(Value::Token()));
+  EXPECT_THAT(TryParseValueFast("(bits[7]:0, (), [bits[2]:1, bits[2]:2])"),
+              Optional(Value::Tuple(
+                  {Value(UBits(0, 7)), Value::Tuple({}),
+                   Value::UBitsArray({1, 2}, 2).value()})));
+}
+
+TEST(ValueParserTest, WideValues) {
+  // Digits span several words and leading zeros do not count against the
+  // width.
+  std::string hex = "0x0000_1" + std::string(40, '0');
+  EXPECT_THAT(TryParseValueFast("bits[161]:" + hex),
+              Optional(Value(Bits::PowerOfTwo(160, 161))));
+  EXPECT_EQ(TryParseValueFast("bits[160]:" + hex), std::nullopt);
+
+  std::string binary = "0b" + std::string(100, '1');
+  EXPECT_THAT(TryParseValueFast("bits[100]:" + binary),
+              Optional(Value(Bits::AllOnes(100))));
+  EXPECT_EQ(TryParseValueFast("bits[99]:" + binary), std::nullopt);
+}
+
+TEST(ValueParserTest, ValuesOfGivenType) {
+  Package p("test");
+  Type* type = p.GetTupleType({p.GetBitsType(8),
+                               p.GetArrayType(2, p.GetBitsType(4)),
+                               p.GetTokenType()});
+  EXPECT_THAT(
+      TryParseValueFast("(0xff, [1, 0b10], token)", type),
+      Optional(Value::Tuple({Value(UBits(255, 8)),
+                             Value::UBitsArray({1, 2}, 4).value(),
+                             Value::Token()})));
+  EXPECT_EQ(TryParseValueFast("(0x100, [1, 2], token)", type), std::nullopt);
+  EXPECT_EQ(TryParseValueFast("(1, [1, 2], token, 3)", type), std::nullopt);
+}
+
+TEST(ValueParserTest, UnhandledFormsFallBack) {
+  // Each of these is left to the general parser, which either accepts it or
+  // reports a descriptive error.
+  for (const char* input :
+       {"bits[8]:-1", "bits[8]:0x1g", "bits[8]:1 // comment", "bits[8]:1 2",
+        "bits[0x8]:1", "bits[8]:", "[]", "(bits[8]:1,)", "bit[8]:1",
+        "bits[128]:100000000000000000000"}) {
+    EXPECT_EQ(TryParseValueFast(input), std::nullopt) << input;
+  }
+  EXPECT_THAT(Parser::ParseTypedValue("bits[8]:-1"),
+              IsOkAndHolds(Value(UBits(255, 8))));
+  EXPECT_THAT(Parser::ParseTypedValue("bits[128]:100000000000000000000"),
+              IsOkAndHolds(Value(bits_ops::ZeroExtend(
+                  bits_ops::UMul(UBits(10'000'000'000, 64),
+                                 UBits(10'000'000'000, 64)),
+                  128))));
+}
+
+TEST(ValueParserTest, MatchesGeneralParser) {
+  Package p("test");
+  for (const Value& value :
+       {Value(UBits(0, 1)), Value(UBits(0xdeadbeef, 32)),
+        Value(Bits::AllOnes(200)),
+        Value::Tuple({Value(UBits(3, 2)), Value::Token()}),
+        Value::UBitsArray({1, 2, 3, 4}, 65).value()}) {
+    for (FormatPreference format :
+         {FormatPreference::kHex, FormatPreference::kBinary,
+          FormatPreference::kUnsignedDecimal}) {
+      std::string text = value.ToString(format);
+      XLS_ASSERT_OK_AND_ASSIGN(Value expected, Parser::ParseTypedValue(text));
+      EXPECT_EQ(expected, value);
+      std::optional<Value> fast = TryParseValueFast(text);
+      // Decimal literals of more than 64 bits are left to the general parser.
+      if (format != FormatPreference::kUnsignedDecimal ||
+          value.GetFlatBitCount() <= 64) {
+        EXPECT_THAT(fast, Optional(value)) << text;
+      }
+      std::string untyped = value.ToHumanString(format);
+      Type* type = p.GetTypeForValue(value);
+      XLS_ASSERT_OK_AND_ASSIGN(expected, Parser::ParseValue(untyped, type));
+      EXPECT_EQ(expected, value);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls
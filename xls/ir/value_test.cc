@@ -23,6 +23,7 @@
 namespace xls {
 
 using ::testing::HasSubstr;
+using status_testing::StatusIs;
 
 TEST(ValueTest, ToHumanString) {
   Value bits_value(UBits(42, 33));
@@ -330,4 +331,47 @@ TEST(ValueTest, XBitsArrayWrongSizes) {
               HasSubstr("elements of arrays should have consistent size."));
 }
 
+TEST(ValueTest, CopiesShareElementStorage) {
+  Value inner = Value::Tuple({Value(UBits(1, 8)), Value(UBits(2, 8))});
+  Value outer = Value::Tuple({inner, Value(UBits(3, 100))});
+  Value copy = outer;
+  EXPECT_EQ(copy, outer);
+  EXPECT_EQ(copy.elements().data(), outer.elements().data());
+  EXPECT_EQ(outer.element(0).elements().data(), inner.elements().data());
+
+  Value moved = std::move(copy);
+  EXPECT_EQ(moved, outer);
+  EXPECT_EQ(moved.elements().data(), outer.elements().data());
+
+  // Reassigning a copy must not affect the original.
+  moved = Value(UBits(42, 32));
+  EXPECT_EQ(outer.size(), 2);
+  EXPECT_EQ(outer.element(0), inner);
+  EXPECT_EQ(outer.element(1), Value(UBits(3, 100)));
+}
+
+TEST(ValueTest, ArrayOwned) {
+  std::vector<Value> elements = {Value(UBits(1, 8)), Value(UBits(2, 8))};
+  XLS_ASSERT_OK_AND_ASSIGN(Value array,
+                           Value::ArrayOwned(std::vector<Value>(elements)));
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected, Value::Array(elements));
+  EXPECT_EQ(array, expected);
+
+  EXPECT_THAT(Value::ArrayOwned({Value(UBits(1, 8)), Value(UBits(2, 16))}),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(Value::ArrayOwned({}),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+TEST(ValueTest, EmptyAggregates) {
+  Value empty_tuple = Value::Tuple({});
+  EXPECT_EQ(empty_tuple.size(), 0);
+  EXPECT_TRUE(empty_tuple.elements().empty());
+  EXPECT_EQ(empty_tuple, Value::Tuple({}));
+  Value token = Value::Token();
+  EXPECT_TRUE(token.IsToken());
+  EXPECT_TRUE(token.elements().empty());
+  EXPECT_NE(token, empty_tuple);
+}
+
 }  // namespace xls
@@ -14,15 +14,23 @@
 
 #include "xls/ir/verifier.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/block.h"
 #include "xls/ir/caret.h"
 #include "xls/ir/channel.h"
@@ -1675,19 +1683,73 @@ absl::Status VerifyChannels(Package* package, bool codegen) {
 }  // namespace
 
 absl::Status VerifyPackage(Package* package, bool codegen) {
-  XLS_VLOG(4) << absl::StreamFormat("Verifying package %s:\n", package->name());
-  XLS_VLOG_LINES(4, package->DumpIr());
+  VerifierOptions options;
+  options.codegen = codegen;
+  return VerifyPackage(package, options);
+}
+
+namespace {
 
-  for (auto& function : package->functions()) {
-    XLS_RETURN_IF_ERROR(VerifyFunction(function.get(), codegen));
+absl::Status VerifyFunctionBaseOfPackage(FunctionBase* function_base,
+                                         bool codegen) {
+  if (function_base->IsFunction()) {
+    return VerifyFunction(function_base->AsFunctionOrDie(), codegen);
   }
+  if (function_base->IsProc()) {
+    return VerifyProc(function_base->AsProcOrDie(), codegen);
+  }
+  XLS_RET_CHECK(function_base->IsBlock());
+  return VerifyBlock(function_base->AsBlockOrDie(), codegen);
+}
 
-  for (auto& proc : package->procs()) {
-    XLS_RETURN_IF_ERROR(VerifyProc(proc.get(), codegen));
+// Verifies the given function bases on up to `thread_count` threads. Returns
+// the error of the first malformed function base in `function_bases`, if any.
+absl::Status VerifyFunctionBasesInParallel(
+    absl::Span<FunctionBase* const> function_bases, bool codegen,
+    int64_t thread_count) {
+  std::vector<absl::Status> statuses(function_bases.size());
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < function_bases.size();
+         i = next_index.fetch_add(1)) {
+      statuses[i] = VerifyFunctionBaseOfPackage(function_bases[i], codegen);
+    }
+  };
+  thread_count = std::min<int64_t>(thread_count, function_bases.size());
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
   }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status VerifyPackage(Package* package, const VerifierOptions& options) {
+  XLS_VLOG(4) << absl::StreamFormat("Verifying package %s:\n", package->name());
+  XLS_VLOG_LINES(4, package->DumpIr());
+  bool codegen = options.codegen;
 
-  for (auto& block : package->blocks()) {
-    XLS_RETURN_IF_ERROR(VerifyBlock(block.get(), codegen));
+  std::vector<FunctionBase*> to_verify;
+  for (FunctionBase* function_base : package->GetFunctionBases()) {
+    if (!options.should_verify || options.should_verify(function_base)) {
+      to_verify.push_back(function_base);
+    }
+  }
+  if (options.thread_count > 1) {
+    XLS_RETURN_IF_ERROR(VerifyFunctionBasesInParallel(to_verify, codegen,
+                                                      options.thread_count));
+  } else {
+    for (FunctionBase* function_base : to_verify) {
+      XLS_RETURN_IF_ERROR(VerifyFunctionBaseOfPackage(function_base, codegen));
+    }
   }
 
   // Verify node IDs are unique within the package and uplinks point to this
@@ -15,12 +15,16 @@
 #ifndef XLS_IR_VERIFIER_H_
 #define XLS_IR_VERIFIER_H_
 
+#include <cstdint>
+#include <functional>
+
 #include "absl/status/status.h"
 
 namespace xls {
 
 class Node;
 class Function;
+class FunctionBase;
 class Proc;
 class Block;
 class Package;
@@ -33,6 +37,25 @@ absl::Status VerifyProc(Proc* Proc, bool codegen = false);
 absl::Status VerifyBlock(Block* Block, bool codegen = false);
 absl::Status VerifyNode(Node* Node, bool codegen = false);
 
+struct VerifierOptions {
+  bool codegen = false;
+
+  // Number of threads on which the functions, procs and blocks of the package
+  // are verified. The result does not depend on the number of threads: if
+  // several function bases are malformed, the error of the first of them (in
+  // the order of Package::GetFunctionBases) is returned.
+  int64_t thread_count = 1;
+
+  // If set, only the function bases for which this returns true are verified.
+  // Used to skip function bases which are known not to have changed since they
+  // were last verified. The invariants of the package as a whole (e.g., unique
+  // node ids and names, and channels) are always verified. Called on the
+  // calling thread only.
+  std::function<bool(FunctionBase*)> should_verify;
+};
+
+absl::Status VerifyPackage(Package* package, const VerifierOptions& options);
+
 }  // namespace xls
 
 #endif  // XLS_IR_VERIFIER_H_
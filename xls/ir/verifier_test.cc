@@ -128,6 +128,48 @@ fn graph(p: bits[2], q: bits[42], r: bits[42]) -> bits[42] {
                                  "bits[42], has type bits[2].")));
 }
 
+TEST_F(VerifierTest, ParallelVerificationReturnsFirstError) {
+  std::string input = R"(
+package ParallelVerification
+
+fn f0(p: bits[2], q: bits[42], r: bits[42]) -> bits[42] {
+  ret and.1: bits[42] = and(q, r)
+}
+
+fn f1(a: bits[16]) -> bits[16] {
+  ret neg.2: bits[16] = neg(a)
+}
+
+fn f2(p: bits[2], q: bits[42], r: bits[42]) -> bits[42] {
+  ret and.3: bits[42] = and(q, r)
+}
+
+fn f3(a: bits[16]) -> bits[16] {
+  ret neg.4: bits[16] = neg(a)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  VerifierOptions options;
+  options.thread_count = 3;
+  XLS_ASSERT_OK(VerifyPackage(p.get(), options));
+
+  Function* f0 = FindFunction("f0", p.get());
+  Function* f2 = FindFunction("f2", p.get());
+  FindNode("and.1", f0)->ReplaceOperand(FindNode("q", f0), FindNode("p", f0));
+  FindNode("and.3", f2)->ReplaceOperand(FindNode("q", f2), FindNode("p", f2));
+  EXPECT_THAT(VerifyPackage(p.get(), options),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and.1")));
+
+  // Only the function bases selected by `should_verify` are verified.
+  options.should_verify = [&](FunctionBase* f) { return f != f0; };
+  EXPECT_THAT(VerifyPackage(p.get(), options),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and.3")));
+  options.should_verify = [&](FunctionBase* f) { return f != f0 && f != f2; };
+  XLS_EXPECT_OK(VerifyPackage(p.get(), options));
+}
+
 TEST_F(VerifierTest, SelectWithUselessDefault) {
   std::string input = R"(
 package p
@@ -28,15 +28,18 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/proc.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/proc_jit.h"
 
 ABSL_FLAG(std::string, input, "", "Path to the IR to compile.");
 ABSL_FLAG(std::string, top, "",
-          "IR function to compile. "
-          "If unspecified, the package top function will be used - "
+          "IR function or proc to compile. "
+          "If unspecified, the package top will be used - "
           "in that case, the package-scoping mangling will be removed.");
 ABSL_FLAG(std::string, namespaces, "",
           "Comma-separated list of namespaces into which to place the "
@@ -118,12 +121,13 @@ absl::StatusOr<std::string> GenerateWrapperSource(
 #include "xls/jit/jit_runtime.h"
 
 extern "C" {
-void {{extern_fn}}(const uint8_t* const* inputs,
-                   uint8_t* const* outputs,
-                   uint8_t* temp_buffer,
-                   ::xls::InterpreterEvents* events,
-                   ::xls::JitRuntime* runtime,
-                   int64_t continuation_point);
+int64_t {{extern_fn}}(const uint8_t* const* inputs,
+                      uint8_t* const* outputs,
+                      void* temp_buffer,
+                      ::xls::InterpreterEvents* events,
+                      void* user_data,
+                      ::xls::JitRuntime* runtime,
+                      int64_t continuation_point);
 }
 {{open_ns}}
 constexpr std::string_view kFnTypeProto = R"({{type_textproto}})";
@@ -155,7 +159,8 @@ absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
   std::vector<uint8_t> temp_buffers({{temp_buffer_size}});
   ::xls::InterpreterEvents events;
   {{extern_fn}}(arg_buffers, output_buffers, temp_buffers.data(),
-                &events, {{private_ns}}::global_data->jit_runtime.get(),
+                &events, /*user_data=*/nullptr,
+                {{private_ns}}::global_data->jit_runtime.get(),
                 /*continuation_point=*/0);
 
   ::xls::Value result = {{private_ns}}::global_data->jit_runtime->UnpackBuffer(
@@ -217,6 +222,129 @@ absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
   return absl::StrReplaceAll(kTemplate, substitution_map);
 }
 
+// Returns the substitutions for the namespace-opening and -closing
+// placeholders of the proc templates below.
+void AddNamespaceSubstitutions(
+    const std::vector<std::string>& namespaces,
+    absl::flat_hash_map<std::string, std::string>& substitution_map) {
+  if (namespaces.empty()) {
+    substitution_map["{{open_ns}}"] = "";
+    substitution_map["{{close_ns}}"] = "";
+  } else {
+    substitution_map["{{open_ns}}"] =
+        absl::StrFormat("\nnamespace %s {\n", absl::StrJoin(namespaces, "::"));
+    substitution_map["{{close_ns}}"] = absl::StrFormat(
+        "\n}  // namespace %s\n", absl::StrJoin(namespaces, "::"));
+  }
+}
+
+// Produces a header declaring a factory, named after the proc (with the
+// package name prefix removed), for runners of the AOT-compiled proc.
+absl::StatusOr<std::string> GenerateProcHeader(
+    Proc* proc, const std::vector<std::string>& namespaces) {
+  constexpr std::string_view kTemplate =
+      R"(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "xls/jit/aot_runtime.h"
+{{open_ns}}
+// Returns a runner for the proc `{{proc_name}}`. Each runner holds its own
+// proc state and channel queues. Call Tick() on the runner to run the proc.
+absl::StatusOr<std::unique_ptr<::xls::aot_compile::AotProcRunner>>
+{{wrapper_fn_name}}();
+{{close_ns}})";
+
+  absl::flat_hash_map<std::string, std::string> substitution_map;
+  std::string package_prefix =
+      absl::StrCat("__", proc->package()->name(), "__");
+  substitution_map["{{proc_name}}"] = proc->name();
+  substitution_map["{{wrapper_fn_name}}"] =
+      absl::StripPrefix(proc->name(), package_prefix);
+  AddNamespaceSubstitutions(namespaces, substitution_map);
+  return absl::StrReplaceAll(kTemplate, substitution_map);
+}
+
+// Generates a source file defining the factory declared by GenerateProcHeader.
+// The package IR is embedded in the source so the runner can lay out the proc
+// state and channel queues; the proc itself is never compiled at runtime.
+absl::StatusOr<std::string> GenerateProcWrapperSource(
+    Proc* proc, const ProcJitObjectCode& object_code,
+    const std::string& header_path,
+    const std::vector<std::string>& namespaces) {
+  constexpr std::string_view kTemplate =
+      R"~(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include "{{header_path}}"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "xls/ir/events.h"
+#include "xls/jit/aot_runtime.h"
+#include "xls/jit/jit_runtime.h"
+
+extern "C" {
+int64_t {{extern_fn}}(const uint8_t* const* inputs,
+                      uint8_t* const* outputs,
+                      void* temp_buffer,
+                      ::xls::InterpreterEvents* events,
+                      void* user_data,
+                      ::xls::JitRuntime* runtime,
+                      int64_t continuation_point);
+}
+{{open_ns}}
+namespace {
+
+constexpr std::string_view kPackageIr = R"xls_ir({{package_ir}})xls_ir";
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<::xls::aot_compile::AotProcRunner>>
+{{wrapper_fn_name}}() {
+  return ::xls::aot_compile::AotProcRunner::Create(
+      kPackageIr, "{{proc_name}}", &{{extern_fn}},
+      /*temp_buffer_size=*/{{temp_buffer_size}});
+}
+{{close_ns}}
+)~";
+
+  absl::flat_hash_map<std::string, std::string> substitution_map;
+  substitution_map["{{header_path}}"] = header_path;
+  substitution_map["{{extern_fn}}"] = object_code.function_name;
+  substitution_map["{{temp_buffer_size}}"] =
+      absl::StrCat(object_code.temp_buffer_size);
+  substitution_map["{{package_ir}}"] = proc->package()->DumpIr();
+  substitution_map["{{proc_name}}"] = proc->name();
+  std::string package_prefix =
+      absl::StrCat("__", proc->package()->name(), "__");
+  substitution_map["{{wrapper_fn_name}}"] =
+      absl::StripPrefix(proc->name(), package_prefix);
+  AddNamespaceSubstitutions(namespaces, substitution_map);
+  return absl::StrReplaceAll(kTemplate, substitution_map);
+}
+
+absl::Status CompileProc(Proc* proc, const std::string& output_object_path,
+                         const std::string& output_header_path,
+                         const std::string& output_source_path,
+                         const std::vector<std::string>& namespaces) {
+  XLS_ASSIGN_OR_RETURN(ProcJitObjectCode object_code,
+                       ProcJit::CreateObjectCode(proc));
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      output_object_path, std::string(object_code.object_code.begin(),
+                                      object_code.object_code.end())));
+
+  XLS_ASSIGN_OR_RETURN(std::string header_text,
+                       GenerateProcHeader(proc, namespaces));
+  XLS_RETURN_IF_ERROR(SetFileContents(output_header_path, header_text));
+
+  XLS_ASSIGN_OR_RETURN(std::string source_text,
+                       GenerateProcWrapperSource(proc, object_code,
+                                                 output_header_path,
+                                                 namespaces));
+  return SetFileContents(output_source_path, source_text);
+}
+
 absl::Status RealMain(const std::string& input_ir_path, std::string top,
                       const std::string& output_object_path,
                       const std::string& output_header_path,
@@ -226,13 +354,24 @@ absl::Status RealMain(const std::string& input_ir_path, std::string top,
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(input_ir, input_ir_path));
 
-  Function* f;
-  std::string package_prefix = absl::StrCat("__", package->name(), "__");
+  FunctionBase* top_fb;
   if (top.empty()) {
-    XLS_ASSIGN_OR_RETURN(f, package->GetTopAsFunction());
+    std::optional<FunctionBase*> package_top = package->GetTop();
+    if (!package_top.has_value()) {
+      return absl::InvalidArgumentError(
+          "Package has no top and --top was not specified.");
+    }
+    top_fb = package_top.value();
   } else {
-    XLS_ASSIGN_OR_RETURN(f, package->GetFunction(top));
+    XLS_ASSIGN_OR_RETURN(top_fb, package->GetFunctionBaseByName(top));
+  }
+  if (top_fb->IsProc()) {
+    return CompileProc(top_fb->AsProcOrDie(), output_object_path,
+                       output_header_path, output_source_path, namespaces);
   }
+  XLS_RET_CHECK(top_fb->IsFunction())
+      << "Only functions and procs can be AOT compiled: " << top_fb->name();
+  Function* f = top_fb->AsFunctionOrDie();
   XLS_ASSIGN_OR_RETURN(JitObjectCode object_code,
                        FunctionJit::CreateObjectCode(f));
   XLS_RETURN_IF_ERROR(SetFileContents(
@@ -14,6 +14,10 @@
 #include "xls/jit/aot_runtime.h"
 
 #include "google/protobuf/text_format.h"
+#include "absl/memory/memory.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls::aot_compile {
@@ -38,4 +42,62 @@ std::unique_ptr<GlobalData> InitGlobalData(
                  .return_type = fn_type->return_type()});
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<AotProcRunner>>
+AotProcRunner::Create(std::string_view package_ir, std::string_view proc_name,
+                      JitFunctionType function, int64_t temp_buffer_size) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(package_ir));
+  XLS_ASSIGN_OR_RETURN(Proc * proc, package->GetProc(proc_name));
+  auto runner =
+      absl::WrapUnique(new AotProcRunner(std::move(package), proc, function));
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       OrcJit::CreateDataLayout());
+  runner->jit_runtime_ = std::make_unique<JitRuntime>(data_layout);
+  XLS_ASSIGN_OR_RETURN(
+      runner->queue_mgr_,
+      JitChannelQueueManager::CreateThreadSafe(runner->package_.get(),
+                                               runner->jit_runtime_.get()));
+  for (Channel* channel : runner->package_->channels()) {
+    XLS_RET_CHECK_GE(channel->id(), 0);
+    if (channel->id() >= runner->queue_table_.size()) {
+      runner->queue_table_.resize(channel->id() + 1, nullptr);
+    }
+    runner->queue_table_[channel->id()] =
+        &runner->queue_mgr_->GetJitQueue(channel);
+    for (const Value& value : channel->initial_values()) {
+      XLS_RETURN_IF_ERROR(runner->queue_mgr_->GetQueue(channel).Write(value));
+    }
+  }
+  runner->continuation_ = std::make_unique<ProcJitContinuation>(
+      proc, temp_buffer_size, runner->jit_runtime_.get());
+  return runner;
+}
+
+absl::StatusOr<bool> AotProcRunner::Tick() {
+  int64_t next_continuation_point = function_(
+      continuation_->GetInputBuffers().data(),
+      continuation_->GetOutputBuffers().data(),
+      continuation_->GetTempBuffer().data(), &continuation_->GetEvents(),
+      /*user_data=*/queue_table_.data(), jit_runtime_.get(),
+      continuation_->GetContinuationPoint());
+  if (next_continuation_point == 0) {
+    continuation_->NextTick();
+    return true;
+  }
+  continuation_->SetContinuationPoint(next_continuation_point);
+  return false;
+}
+
+absl::Status AotProcRunner::WriteValueToChannel(std::string_view channel_name,
+                                                const Value& value) {
+  XLS_ASSIGN_OR_RETURN(Channel * channel, package_->GetChannel(channel_name));
+  return queue_mgr_->GetQueue(channel).Write(value);
+}
+
+absl::StatusOr<std::optional<Value>> AotProcRunner::ReadValueFromChannel(
+    std::string_view channel_name) {
+  XLS_ASSIGN_OR_RETURN(Channel * channel, package_->GetChannel(channel_name));
+  return queue_mgr_->GetQueue(channel).Read();
+}
+
 }  // namespace xls::aot_compile
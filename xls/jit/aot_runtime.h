@@ -19,12 +19,22 @@
 #define XLS_JIT_AOT_RUNTIME_H_
 
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "xls/ir/events.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/proc_jit.h"
 
 namespace xls::aot_compile {
 
@@ -48,6 +58,61 @@ struct GlobalData {
 // given the specified text-format FunctionType protobuf.
 std::unique_ptr<GlobalData> InitGlobalData(std::string_view fn_type_textproto);
 
+// Runs an ahead-of-time compiled proc (see ProcJit::CreateObjectCode). Owns the
+// channel queues and the state of the proc. The package IR is needed (only) to
+// determine the layout of the proc state and channels; no code is compiled at
+// runtime.
+//
+// Traces and assertions in AOT-compiled procs are not supported as the
+// generated code for them refers to host addresses of the compiling process.
+class AotProcRunner {
+ public:
+  // Creates a runner for the proc `proc_name` in the package `package_ir`.
+  // `function` and `temp_buffer_size` are the compiled function and its
+  // temporary buffer size from ProcJitObjectCode.
+  static absl::StatusOr<std::unique_ptr<AotProcRunner>> Create(
+      std::string_view package_ir, std::string_view proc_name,
+      JitFunctionType function, int64_t temp_buffer_size);
+
+  // Executes the proc until it completes its tick or blocks on a receive.
+  // Returns true if the tick completed. A blocked tick is resumed at the
+  // blocking receive by the next call.
+  absl::StatusOr<bool> Tick();
+
+  // Writes/reads a value to/from the channel of the given name. ReadValue
+  // returns std::nullopt if the channel queue is empty.
+  absl::Status WriteValueToChannel(std::string_view channel_name,
+                                   const Value& value);
+  absl::StatusOr<std::optional<Value>> ReadValueFromChannel(
+      std::string_view channel_name);
+
+  // Returns the current state of the proc.
+  std::vector<Value> GetState() const { return continuation_->GetState(); }
+  const InterpreterEvents& GetEvents() const {
+    return continuation_->GetEvents();
+  }
+
+  Package* package() const { return package_.get(); }
+  Proc* proc() const { return proc_; }
+  JitChannelQueueManager* queue_mgr() const { return queue_mgr_.get(); }
+
+ private:
+  AotProcRunner(std::unique_ptr<Package> package, Proc* proc,
+                JitFunctionType function)
+      : package_(std::move(package)), proc_(proc), function_(function) {}
+
+  std::unique_ptr<Package> package_;
+  Proc* proc_;
+  JitFunctionType function_;
+  std::unique_ptr<JitRuntime> jit_runtime_;
+  std::unique_ptr<JitChannelQueueManager> queue_mgr_;
+  std::unique_ptr<ProcJitContinuation> continuation_;
+
+  // Table of channel queues indexed by channel id which is passed to the
+  // compiled function as its `user_data` argument.
+  std::vector<JitChannelQueue*> queue_table_;
+};
+
 }  // namespace xls::aot_compile
 
 #endif  // XLS_JIT_AOT_RUNTIME_H_
@@ -0,0 +1,134 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/jit/aot_runtime.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls::aot_compile {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+constexpr std::string_view kAccumulatorIr = R"(
+package p
+
+chan in(bits[32], id=3, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="")
+chan out(bits[32], id=7, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+
+proc acc(tkn: token, sum: bits[32], init={10}) {
+  receive.1: (token, bits[32]) = receive(tkn, channel_id=3)
+  tuple_index.2: token = tuple_index(receive.1, index=0)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1)
+  add.4: bits[32] = add(sum, tuple_index.3)
+  send.5: token = send(tuple_index.2, add.4, channel_id=7)
+  next (send.5, add.4)
+}
+)";
+
+// Runs procs compiled with the AOT channel queue ABI. The code is linked into
+// this process by the JIT rather than by the system linker but is otherwise
+// the same as the code emitted by the AOT compiler.
+class AotProcRunnerTest : public ::testing::Test {
+ protected:
+  absl::StatusOr<std::unique_ptr<AotProcRunner>> CompileAndCreateRunner(
+      std::string_view ir_text, std::string_view proc_name) {
+    XLS_ASSIGN_OR_RETURN(package_, Parser::ParsePackage(ir_text));
+    XLS_ASSIGN_OR_RETURN(Proc * proc, package_->GetProc(proc_name));
+    XLS_ASSIGN_OR_RETURN(orc_jit_, OrcJit::Create());
+    XLS_ASSIGN_OR_RETURN(JittedFunctionBase jitted,
+                         BuildAotProcFunction(proc, *orc_jit_));
+    return AotProcRunner::Create(ir_text, proc_name, jitted.function,
+                                 jitted.temp_buffer_size);
+  }
+
+  std::unique_ptr<Package> package_;
+  std::unique_ptr<OrcJit> orc_jit_;
+};
+
+TEST_F(AotProcRunnerTest, Accumulator) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AotProcRunner> runner,
+                           CompileAndCreateRunner(kAccumulatorIr, "acc"));
+  EXPECT_THAT(runner->GetState(), ElementsAre(Value(UBits(10, 32))));
+
+  // Nothing to receive so the proc blocks.
+  EXPECT_THAT(runner->Tick(), IsOkAndHolds(false));
+  EXPECT_THAT(runner->ReadValueFromChannel("out"),
+              IsOkAndHolds(std::nullopt));
+
+  XLS_ASSERT_OK(runner->WriteValueToChannel("in", Value(UBits(1, 32))));
+  XLS_ASSERT_OK(runner->WriteValueToChannel("in", Value(UBits(2, 32))));
+  EXPECT_THAT(runner->Tick(), IsOkAndHolds(true));
+  EXPECT_THAT(runner->Tick(), IsOkAndHolds(true));
+  EXPECT_THAT(runner->Tick(), IsOkAndHolds(false));
+
+  EXPECT_THAT(runner->ReadValueFromChannel("out"),
+              IsOkAndHolds(Optional(Value(UBits(11, 32)))));
+  EXPECT_THAT(runner->ReadValueFromChannel("out"),
+              IsOkAndHolds(Optional(Value(UBits(13, 32)))));
+  EXPECT_THAT(runner->GetState(), ElementsAre(Value(UBits(13, 32))));
+}
+
+TEST_F(AotProcRunnerTest, ChannelInitialValues) {
+  constexpr std::string_view kIr = R"(
+package p
+
+chan loop(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=ready_valid, initial_values={5}, metadata="")
+
+proc inc(tkn: token, init={}) {
+  receive.1: (token, bits[32]) = receive(tkn, channel_id=0)
+  tuple_index.2: token = tuple_index(receive.1, index=0)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1)
+  literal.4: bits[32] = literal(value=1)
+  add.5: bits[32] = add(tuple_index.3, literal.4)
+  send.6: token = send(tuple_index.2, add.5, channel_id=0)
+  next (send.6)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AotProcRunner> runner,
+                           CompileAndCreateRunner(kIr, "inc"));
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_THAT(runner->Tick(), IsOkAndHolds(true));
+  }
+  EXPECT_THAT(runner->ReadValueFromChannel("loop"),
+              IsOkAndHolds(Optional(Value(UBits(8, 32)))));
+}
+
+TEST(AotProcObjectCodeTest, CreateObjectCode) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kAccumulatorIr));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, package->GetProc("acc"));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcJitObjectCode object_code,
+                           ProcJit::CreateObjectCode(proc));
+  EXPECT_FALSE(object_code.function_name.empty());
+  EXPECT_FALSE(object_code.object_code.empty());
+}
+
+}  // namespace
+}  // namespace xls::aot_compile
@@ -0,0 +1,251 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/jit/block_jit.h"
+
+#include <random>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+
+absl::StatusOr<std::unique_ptr<BlockJit>> BlockJit::Create(Block* block) {
+  auto jit = absl::WrapUnique(new BlockJit(block));
+  XLS_ASSIGN_OR_RETURN(jit->orc_jit_, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(jit->jit_runtime_, JitRuntime::Create());
+  XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
+                       BuildBlockFunction(block, *jit->orc_jit_));
+  jit->AllocateBuffers();
+  jit->ResetRegisters();
+  return jit;
+}
+
+void BlockJit::AllocateBuffers() {
+  const std::vector<int64_t>& input_sizes =
+      jitted_function_base_.input_buffer_sizes;
+  const std::vector<int64_t>& output_sizes =
+      jitted_function_base_.output_buffer_sizes;
+  int64_t input_port_count = block_->GetInputPorts().size();
+  int64_t output_port_count = block_->GetOutputPorts().size();
+  int64_t register_count = block_->GetRegisters().size();
+  XLS_CHECK_EQ(input_sizes.size(), input_port_count + register_count);
+  XLS_CHECK_EQ(output_sizes.size(), output_port_count + register_count);
+
+  for (int64_t i = 0; i < input_port_count; ++i) {
+    input_port_buffers_.push_back(std::vector<uint8_t>(input_sizes[i]));
+  }
+  for (int64_t i = 0; i < output_port_count; ++i) {
+    output_port_buffers_.push_back(std::vector<uint8_t>(output_sizes[i]));
+  }
+  for (std::vector<std::vector<uint8_t>>& buffers : register_buffers_) {
+    for (int64_t i = 0; i < register_count; ++i) {
+      buffers.push_back(
+          std::vector<uint8_t>(input_sizes[input_port_count + i]));
+    }
+  }
+
+  // The registers read by the jitted function in one cycle are written in the
+  // other.
+  for (int64_t c = 0; c < 2; ++c) {
+    for (std::vector<uint8_t>& buffer : input_port_buffers_) {
+      input_ptrs_[c].push_back(buffer.data());
+    }
+    for (std::vector<uint8_t>& buffer : register_buffers_[c]) {
+      input_ptrs_[c].push_back(buffer.data());
+    }
+    for (std::vector<uint8_t>& buffer : output_port_buffers_) {
+      output_ptrs_[c].push_back(buffer.data());
+    }
+    for (std::vector<uint8_t>& buffer : register_buffers_[1 - c]) {
+      output_ptrs_[c].push_back(buffer.data());
+    }
+  }
+  temp_buffer_.resize(jitted_function_base_.temp_buffer_size);
+}
+
+absl::Status BlockJit::SetInputPort(int64_t index, const Value& value) {
+  XLS_RET_CHECK_LT(index, input_port_buffers_.size());
+  InputPort* port = block_->GetInputPorts()[index];
+  if (!ValueConformsToType(value, port->GetType())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Got value %s for input port '%s' which is not of type %s",
+        value.ToString(), port->GetName(), port->GetType()->ToString()));
+  }
+  jit_runtime_->BlitValueToBuffer(value, port->GetType(),
+                                  GetInputPortBuffer(index));
+  return absl::OkStatus();
+}
+
+absl::Status BlockJit::SetInputPorts(
+    const absl::flat_hash_map<std::string, Value>& inputs) {
+  for (const auto& [name, value] : inputs) {
+    XLS_RETURN_IF_ERROR(block_->GetInputPort(name).status());
+  }
+  for (int64_t i = 0; i < block_->GetInputPorts().size(); ++i) {
+    InputPort* port = block_->GetInputPorts()[i];
+    auto port_iter = inputs.find(port->GetName());
+    if (port_iter == inputs.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing input for port '%s'", port->GetName()));
+    }
+    XLS_RETURN_IF_ERROR(SetInputPort(i, port_iter->second));
+  }
+  return absl::OkStatus();
+}
+
+Value BlockJit::GetOutputPort(int64_t index) const {
+  return jit_runtime_->UnpackBuffer(
+      output_port_buffers_[index].data(),
+      block_->GetOutputPorts()[index]->operand(0)->GetType(),
+      /*unpoison=*/true);
+}
+
+absl::flat_hash_map<std::string, Value> BlockJit::GetOutputPorts() const {
+  absl::flat_hash_map<std::string, Value> outputs;
+  for (int64_t i = 0; i < block_->GetOutputPorts().size(); ++i) {
+    outputs[block_->GetOutputPorts()[i]->GetName()] = GetOutputPort(i);
+  }
+  return outputs;
+}
+
+absl::Status BlockJit::SetRegister(int64_t index, const Value& value) {
+  XLS_RET_CHECK_LT(index, block_->GetRegisters().size());
+  Register* reg = block_->GetRegisters()[index];
+  if (!ValueConformsToType(value, reg->type())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Got value %s for register '%s' which is not of type %s",
+        value.ToString(), reg->name(), reg->type()->ToString()));
+  }
+  jit_runtime_->BlitValueToBuffer(value, reg->type(),
+                                  GetRegisterBuffer(index));
+  return absl::OkStatus();
+}
+
+Value BlockJit::GetRegister(int64_t index) const {
+  return jit_runtime_->UnpackBuffer(register_buffers_[current_][index].data(),
+                                    block_->GetRegisters()[index]->type(),
+                                    /*unpoison=*/true);
+}
+
+absl::Status BlockJit::SetRegisters(
+    const absl::flat_hash_map<std::string, Value>& reg_state) {
+  for (const auto& [name, value] : reg_state) {
+    XLS_RETURN_IF_ERROR(block_->GetRegister(name).status());
+  }
+  for (int64_t i = 0; i < block_->GetRegisters().size(); ++i) {
+    Register* reg = block_->GetRegisters()[i];
+    auto reg_iter = reg_state.find(reg->name());
+    if (reg_iter == reg_state.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing value for register '%s'", reg->name()));
+    }
+    XLS_RETURN_IF_ERROR(SetRegister(i, reg_iter->second));
+  }
+  return absl::OkStatus();
+}
+
+absl::flat_hash_map<std::string, Value> BlockJit::GetRegisters() const {
+  absl::flat_hash_map<std::string, Value> reg_state;
+  for (int64_t i = 0; i < block_->GetRegisters().size(); ++i) {
+    reg_state[block_->GetRegisters()[i]->name()] = GetRegister(i);
+  }
+  return reg_state;
+}
+
+void BlockJit::ResetRegisters() {
+  for (int64_t i = 0; i < block_->GetRegisters().size(); ++i) {
+    Register* reg = block_->GetRegisters()[i];
+    jit_runtime_->BlitValueToBuffer(ZeroOfType(reg->type()), reg->type(),
+                                    GetRegisterBuffer(i));
+  }
+}
+
+absl::Status BlockJit::RunOneCycle() {
+  events_ = InterpreterEvents();
+  jitted_function_base_.function(
+      input_ptrs_[current_].data(), output_ptrs_[current_].data(),
+      temp_buffer_.data(), &events_, /*user_data=*/nullptr, runtime(),
+      /*continuation_point=*/0);
+  current_ = 1 - current_;
+  return InterpreterEventsToStatus(events_);
+}
+
+absl::StatusOr<BlockRunResult> BlockJit::Run(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state) {
+  XLS_RETURN_IF_ERROR(SetInputPorts(inputs));
+  XLS_RETURN_IF_ERROR(SetRegisters(reg_state));
+  XLS_RETURN_IF_ERROR(RunOneCycle());
+  return BlockRunResult{.outputs = GetOutputPorts(),
+                        .reg_state = GetRegisters()};
+}
+
+absl::StatusOr<BlockIOResults> JitChannelizedSequentialBlock(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    std::optional<verilog::ResetProto> reset, int64_t seed) {
+  std::minstd_rand random_engine;
+  random_engine.seed(seed);
+
+  // Initial register state is zero for all registers.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockJit> jit, BlockJit::Create(block));
+
+  BlockIOResults block_io_results;
+  for (int64_t cycle = 0; cycle < inputs.size(); ++cycle) {
+    absl::flat_hash_map<std::string, Value> input_set = inputs.at(cycle);
+
+    // Sources set data/valid
+    for (ChannelSource& src : channel_sources) {
+      XLS_RETURN_IF_ERROR(
+          src.SetBlockInputs(cycle, input_set, random_engine, reset));
+    }
+
+    // Sinks set ready
+    for (ChannelSink& sink : channel_sinks) {
+      XLS_RETURN_IF_ERROR(sink.SetBlockInputs(cycle, input_set, random_engine));
+    }
+
+    XLS_RETURN_IF_ERROR(jit->SetInputPorts(input_set));
+    XLS_RETURN_IF_ERROR(jit->RunOneCycle());
+    absl::flat_hash_map<std::string, Value> outputs = jit->GetOutputPorts();
+
+    // Sources get ready
+    for (ChannelSource& src : channel_sources) {
+      XLS_RETURN_IF_ERROR(src.GetBlockOutputs(cycle, outputs));
+    }
+
+    // Sinks get data/valid
+    for (ChannelSink& sink : channel_sinks) {
+      XLS_RETURN_IF_ERROR(sink.GetBlockOutputs(cycle, outputs));
+    }
+
+    block_io_results.inputs.push_back(std::move(input_set));
+    block_io_results.outputs.push_back(std::move(outputs));
+  }
+
+  return block_io_results;
+}
+
+}  // namespace xls
@@ -0,0 +1,160 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_JIT_BLOCK_JIT_H_
+#define XLS_JIT_BLOCK_JIT_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/block.h"
+#include "xls/ir/events.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+
+// This class provides a facility to evaluate XLS blocks (on the host) by
+// converting them to LLVM IR, compiling it, and finally executing it. The
+// combinational logic and the register update of the block are compiled into
+// a single native function which evaluates one clock cycle.
+//
+// The BlockJit holds the state of the evaluation: the values driven on the
+// input ports, the values of the output ports computed in the last cycle, and
+// the register values. These are kept in preallocated buffers in the native
+// LLVM data layout which are reused across cycles. Ports and registers are
+// identified by their index in Block::GetInputPorts, Block::GetOutputPorts,
+// and Block::GetRegisters respectively. Not thread-safe.
+class BlockJit {
+ public:
+  // Returns an object containing a host-compiled version of the specified XLS
+  // block. All registers are initially zero.
+  static absl::StatusOr<std::unique_ptr<BlockJit>> Create(Block* block);
+
+  // Sets the value driven on the input port with the given index.
+  absl::Status SetInputPort(int64_t index, const Value& value);
+
+  // Sets the values driven on the input ports. `inputs` must contain a value
+  // for each input port of the block.
+  absl::Status SetInputPorts(
+      const absl::flat_hash_map<std::string, Value>& inputs);
+
+  // Returns the value of the output port with the given index computed in the
+  // last call to RunOneCycle.
+  Value GetOutputPort(int64_t index) const;
+
+  // Returns the values of the output ports keyed by port name.
+  absl::flat_hash_map<std::string, Value> GetOutputPorts() const;
+
+  // Sets/gets the value of the register with the given index.
+  absl::Status SetRegister(int64_t index, const Value& value);
+  Value GetRegister(int64_t index) const;
+
+  // Sets the values of the registers. `reg_state` must contain a value for
+  // each register of the block.
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& reg_state);
+
+  // Returns the values of the registers keyed by register name.
+  absl::flat_hash_map<std::string, Value> GetRegisters() const;
+
+  // Sets all registers to zero.
+  void ResetRegisters();
+
+  // Returns the buffers holding the value of an input port, output port, or
+  // register in the native LLVM data layout. These allow the values to be read
+  // or written without constructing xls::Values. The buffer of a register is
+  // only valid until the next call to RunOneCycle.
+  absl::Span<uint8_t> GetInputPortBuffer(int64_t index) {
+    return absl::MakeSpan(input_port_buffers_[index]);
+  }
+  absl::Span<const uint8_t> GetOutputPortBuffer(int64_t index) const {
+    return absl::MakeConstSpan(output_port_buffers_[index]);
+  }
+  absl::Span<uint8_t> GetRegisterBuffer(int64_t index) {
+    return absl::MakeSpan(register_buffers_[current_][index]);
+  }
+
+  // Evaluates one clock cycle of the block. The output port values are
+  // computed from the current input port and register values after which the
+  // registers are clocked. Returns an error if an assert fired during
+  // evaluation.
+  absl::Status RunOneCycle();
+
+  // Runs a single cycle of the block with the given input values and register
+  // values. Equivalent to BlockRun in block_interpreter.h. The register values
+  // of the BlockJit are overwritten by `reg_state`.
+  absl::StatusOr<BlockRunResult> Run(
+      const absl::flat_hash_map<std::string, Value>& inputs,
+      const absl::flat_hash_map<std::string, Value>& reg_state);
+
+  // Returns the events (e.g., traces) recorded in the last call to
+  // RunOneCycle.
+  const InterpreterEvents& GetEvents() const { return events_; }
+
+  Block* block() const { return block_; }
+  JitRuntime* runtime() const { return jit_runtime_.get(); }
+
+ private:
+  explicit BlockJit(Block* block) : block_(block) {}
+
+  // Allocates the port and register buffers and the arrays of pointers to them
+  // which are passed to the jitted function.
+  void AllocateBuffers();
+
+  Block* block_;
+  std::unique_ptr<OrcJit> orc_jit_;
+  std::unique_ptr<JitRuntime> jit_runtime_;
+  JittedFunctionBase jitted_function_base_;
+
+  std::vector<std::vector<uint8_t>> input_port_buffers_;
+  std::vector<std::vector<uint8_t>> output_port_buffers_;
+
+  // Two sets of register buffers. The set indexed by `current_` holds the
+  // current register values and the other receives the next register values
+  // computed by the jitted function. The sets are swapped after each cycle.
+  std::vector<std::vector<uint8_t>> register_buffers_[2];
+  int64_t current_ = 0;
+
+  // Input and output pointer arrays passed to the jitted function, one for each
+  // value of `current_`.
+  std::vector<uint8_t*> input_ptrs_[2];
+  std::vector<uint8_t*> output_ptrs_[2];
+  std::vector<uint8_t> temp_buffer_;
+
+  InterpreterEvents events_;
+};
+
+// Equivalent of InterpretChannelizedSequentialBlock (see block_interpreter.h)
+// which evaluates the block with a BlockJit rather than the interpreter.
+absl::StatusOr<BlockIOResults> JitChannelizedSequentialBlock(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_BLOCK_JIT_H_
@@ -0,0 +1,218 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/jit/block_jit.h"
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using testing::HasSubstr;
+using testing::Pair;
+using testing::UnorderedElementsAre;
+
+class BlockJitTest : public IrTestBase {};
+
+TEST_F(BlockJitTest, SumAndDifferenceBlock) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  b.OutputPort("sum", b.Add(x, y));
+  b.OutputPort("diff", b.Subtract(x, y));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockRunResult result,
+      jit->Run({{"x", Value(UBits(42, 32))}, {"y", Value(UBits(10, 32))}},
+               {}));
+  EXPECT_THAT(result.outputs,
+              UnorderedElementsAre(Pair("sum", Value(UBits(52, 32))),
+                                   Pair("diff", Value(UBits(32, 32)))));
+  EXPECT_TRUE(result.reg_state.empty());
+}
+
+TEST_F(BlockJitTest, InputErrors) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  b.OutputPort("out", x);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  EXPECT_THAT(jit->Run({}, {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing input for port 'x'")));
+  EXPECT_THAT(jit->Run({{"x", Value(UBits(1, 8))}}, {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("is not of type bits[32]")));
+}
+
+TEST_F(BlockJitTest, PipelinedAdder) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  BValue x_d = b.InsertRegister("x_d", x);
+  BValue y_d = b.InsertRegister("y_d", y);
+  BValue x_plus_y_d = b.InsertRegister("x_plus_y_d", b.Add(x_d, y_d));
+  b.OutputPort("out", x_plus_y_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::vector<std::pair<uint64_t, uint64_t>> inputs = {
+      {1, 2}, {42, 100}, {0, 0}, {0, 0}, {0, 0}};
+  std::vector<uint64_t> outputs;
+  for (const auto& [x_value, y_value] : inputs) {
+    XLS_ASSERT_OK(jit->SetInputPort(0, Value(UBits(x_value, 32))));
+    XLS_ASSERT_OK(jit->SetInputPort(1, Value(UBits(y_value, 32))));
+    XLS_ASSERT_OK(jit->RunOneCycle());
+    outputs.push_back(jit->GetOutputPort(0).bits().ToUint64().value());
+  }
+  EXPECT_EQ(outputs, (std::vector<uint64_t>{0, 0, 3, 142, 0}));
+}
+
+TEST_F(BlockJitTest, RegisterWithResetAndLoadEnable) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue rst_n = b.InputPort("rst_n", package->GetBitsType(1));
+  BValue le = b.InputPort("le", package->GetBitsType(1));
+  BValue x_d =
+      b.InsertRegister("x_d", x, rst_n,
+                       Reset{Value(UBits(42, 32)), /*asynchronous=*/false,
+                             /*active_low=*/true},
+                       le);
+  b.OutputPort("out", x_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs;
+  for (auto [rst_n_value, le_value, x_value] :
+       std::vector<std::tuple<int64_t, int64_t, int64_t>>{
+           {1, 0, 1}, {0, 0, 2}, {0, 1, 3}, {1, 1, 4}, {1, 0, 5}}) {
+    inputs.push_back({{"rst_n", Value(UBits(rst_n_value, 1))},
+                      {"le", Value(UBits(le_value, 1))},
+                      {"x", Value(UBits(x_value, 32))}});
+  }
+  std::vector<absl::flat_hash_map<std::string, Value>> expected;
+  XLS_ASSERT_OK_AND_ASSIGN(expected, InterpretSequentialBlock(block, inputs));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    XLS_ASSERT_OK(jit->SetInputPorts(inputs[i]));
+    XLS_ASSERT_OK(jit->RunOneCycle());
+    EXPECT_EQ(jit->GetOutputPorts(), expected[i]) << "cycle " << i;
+  }
+}
+
+TEST_F(BlockJitTest, AccumulatorRegisterMatchesBlockRun) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue accum = b.RegisterRead(reg);
+  BValue next_accum = b.Add(x, accum);
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("out", next_accum);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  absl::flat_hash_map<std::string, Value> reg_state = {
+      {"accum", Value(UBits(100, 32))}};
+  for (int64_t i = 0; i < 5; ++i) {
+    absl::flat_hash_map<std::string, Value> inputs = {
+        {"x", Value(UBits(i, 32))}};
+    XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult expected,
+                             BlockRun(inputs, reg_state, block));
+    XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult result,
+                             jit->Run(inputs, reg_state));
+    EXPECT_EQ(result.outputs, expected.outputs);
+    EXPECT_EQ(result.reg_state, expected.reg_state);
+    reg_state = std::move(result.reg_state);
+  }
+  EXPECT_THAT(jit->GetRegisters(),
+              UnorderedElementsAre(Pair("accum", Value(UBits(110, 32)))));
+}
+
+TEST_F(BlockJitTest, ChannelizedAccumulatorRegister) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue x_vld = b.InputPort("x_vld", package->GetBitsType(1));
+  BValue out_rdy = b.InputPort("out_rdy", package->GetBitsType(1));
+  BValue accum = b.RegisterRead(reg);
+  BValue next_accum =
+      b.Select(b.And(x_vld, out_rdy), {accum, b.Add(x, accum)});
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("x_rdy", out_rdy);
+  b.OutputPort("out", next_accum);
+  b.OutputPort("out_vld", x_vld);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<ChannelSource> sources{
+      ChannelSource("x", "x_vld", "x_rdy", 0.5, block)};
+  XLS_ASSERT_OK(
+      sources.at(0).SetDataSequence(std::vector<uint64_t>{1, 2, 3, 4, 5}));
+  std::vector<ChannelSink> sinks{
+      ChannelSink("out", "out_vld", "out_rdy", 0.1, block)};
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs(100);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockIOResults block_io,
+      JitChannelizedSequentialBlock(block, absl::MakeSpan(sources),
+                                    absl::MakeSpan(sinks), inputs));
+  EXPECT_EQ(block_io.outputs.size(), 100);
+  EXPECT_THAT(sinks.at(0).GetOutputSequenceAsUint64(),
+              IsOkAndHolds(std::vector<uint64_t>{1, 3, 6, 10, 15}));
+}
+
+}  // namespace
+}  // namespace xls
@@ -13,19 +13,28 @@
 // limitations under the License.
 #include "xls/jit/function_base_jit.h"
 
+#include <algorithm>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/Function.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Intrinsics.h"
 #include "llvm/include/llvm/IR/Type.h"
 #include "llvm/include/llvm/IR/Value.h"
 #include "xls/common/logging/logging.h"
+#include "xls/ir/block.h"
 #include "xls/ir/call_graph.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/register.h"
 #include "xls/jit/ir_builder_visitor.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/llvm_type_converter.h"
 
 namespace xls {
@@ -59,6 +68,24 @@ llvm::Value* LoadFromPointerArray(int64_t index, llvm::Type* data_type,
   return builder->CreateLoad(data_type, data_ptr);
 }
 
+// Adds `value` (an i64) to the int64_t counter at the fixed address `counter`.
+void AddToCounter(int64_t* counter, llvm::Value* value,
+                  llvm::IRBuilder<>* builder) {
+  llvm::Value* counter_ptr = builder->CreateIntToPtr(
+      builder->getInt64(absl::bit_cast<uint64_t>(counter)),
+      llvm::PointerType::get(builder->getContext(), 0));
+  llvm::Value* count = builder->CreateLoad(builder->getInt64Ty(), counter_ptr);
+  builder->CreateStore(builder->CreateAdd(count, value), counter_ptr);
+}
+
+// Returns the current value of the processor's cycle counter.
+llvm::Value* ReadCycleCounter(llvm::IRBuilder<>* builder) {
+  llvm::Function* read_cycle_counter =
+      llvm::Intrinsic::getDeclaration(builder->GetInsertBlock()->getModule(),
+                                      llvm::Intrinsic::readcyclecounter);
+  return builder->CreateCall(read_cycle_counter);
+}
+
 // Marks the given buffer of the given size (in bytes) as "unpoisoned" for MSAN
 // - in other words, prevent false positives from being thrown when running
 // under MSAN (since it can't yet follow values into LLVM space (it might be
@@ -116,6 +143,7 @@ class LlvmFunctionWrapper {
       absl::Span<Node* const> output_args, llvm::Type* return_type,
       const JitBuilderContext& jit_context,
       std::optional<FunctionArg> extra_arg = std::nullopt) {
+    std::string symbol = absl::StrCat(name, jit_context.symbol_suffix());
     llvm::Type* ptr_type = llvm::PointerType::get(jit_context.context(), 0);
     std::vector<llvm::Type*> param_types(6, ptr_type);
     if (extra_arg.has_value()) {
@@ -124,12 +152,12 @@ class LlvmFunctionWrapper {
     llvm::FunctionType* function_type =
         llvm::FunctionType::get(return_type, param_types,
                                 /*isVarArg=*/false);
-    XLS_CHECK_EQ(jit_context.module()->getFunction(name), nullptr)
+    XLS_CHECK_EQ(jit_context.module()->getFunction(symbol), nullptr)
         << absl::StreamFormat(
-               "Function named `%s` already exists in LLVM module", name);
+               "Function named `%s` already exists in LLVM module", symbol);
     llvm::Function* fn = llvm::cast<llvm::Function>(
         jit_context.module()
-            ->getOrInsertFunction(name, function_type)
+            ->getOrInsertFunction(symbol, function_type)
             .getCallee());
     fn->getArg(0)->setName("input_ptrs");
     fn->getArg(1)->setName("output_ptrs");
@@ -272,8 +300,10 @@ enum class AllocationKind {
 // functions.
 class BufferAllocator {
  public:
-  explicit BufferAllocator(const LlvmTypeConverter* type_converter)
-      : type_converter_(type_converter) {}
+  // Allocations start at `base_offset` in the temp block.
+  explicit BufferAllocator(const LlvmTypeConverter* type_converter,
+                           int64_t base_offset = 0)
+      : type_converter_(type_converter), current_offset_(base_offset) {}
 
   void SetAllocationKind(Node* node, AllocationKind kind) {
     XLS_CHECK(!allocation_kinds_.contains(node));
@@ -313,7 +343,7 @@ class BufferAllocator {
 
   const LlvmTypeConverter* type_converter_;
   absl::flat_hash_map<Node*, int64_t> temp_block_offsets_;
-  int64_t current_offset_ = 0;
+  int64_t current_offset_;
   absl::flat_hash_map<Node*, AllocationKind> allocation_kinds_;
 };
 
@@ -470,10 +500,11 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       XLS_RET_CHECK(allocator.GetAllocationKind(node) == AllocationKind::kNone);
       if (wrapper.IsOutputNode(node)) {
         // `node` is also an output node. This can occur, for example, if a
-        // state param is the next state value for a proc.
+        // state param is the next state value for a proc. The buffers are the
+        // same if the state element is updated in place.
         llvm::Value* input_buffer = wrapper.GetInputBuffer(node, b);
         for (llvm::Value* output_buffer : wrapper.GetOutputBuffers(node, b)) {
-          LlvmMemcpy(
+          LlvmMemcpyIfDistinct(
               output_buffer, input_buffer,
               jit_context.type_converter().GetTypeByteSize(node->GetType()), b);
         }
@@ -552,6 +583,10 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       args.push_back(wrapper.GetUserDataArg());
       args.push_back(wrapper.GetJitRuntimeArg());
     }
+    if (jit_context.profile() != nullptr) {
+      AddToCounter(jit_context.profile()->GetNodeCounter(node), b.getInt64(1),
+                   &b);
+    }
     llvm::CallInst* node_blocked = b.CreateCall(node_function.function, args);
 
     if (partition.continuation_point.has_value()) {
@@ -598,6 +633,17 @@ absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
 // Returns the nodes which comprise the inputs to a jitted function implementing
 // `function_base`. These nodes are passed in via the `inputs` argument.
 std::vector<Node*> GetJittedFunctionInputs(FunctionBase* function_base) {
+  if (function_base->IsBlock()) {
+    // The inputs of a block are the input port values followed by the current
+    // register values.
+    Block* block = function_base->AsBlockOrDie();
+    std::vector<Node*> inputs(block->GetInputPorts().begin(),
+                              block->GetInputPorts().end());
+    for (Register* reg : block->GetRegisters()) {
+      inputs.push_back(block->GetRegisterRead(reg).value());
+    }
+    return inputs;
+  }
   std::vector<Node*> inputs(function_base->params().begin(),
                             function_base->params().end());
   return inputs;
@@ -611,6 +657,19 @@ std::vector<Node*> GetJittedFunctionOutputs(FunctionBase* function_base) {
     Function* f = function_base->AsFunctionOrDie();
     return {f->return_value()};
   }
+  if (function_base->IsBlock()) {
+    // The outputs of a block are the values driven on the output ports
+    // followed by the next register values.
+    Block* block = function_base->AsBlockOrDie();
+    std::vector<Node*> outputs;
+    for (OutputPort* port : block->GetOutputPorts()) {
+      outputs.push_back(port->operand(0));
+    }
+    for (Register* reg : block->GetRegisters()) {
+      outputs.push_back(block->GetRegisterWrite(reg).value()->data());
+    }
+    return outputs;
+  }
   XLS_CHECK(function_base->IsProc());
   // The outputs of a proc are the next state values.
   Proc* proc = function_base->AsProcOrDie();
@@ -621,6 +680,24 @@ std::vector<Node*> GetJittedFunctionOutputs(FunctionBase* function_base) {
   return outputs;
 }
 
+// Returns the load enable and reset signals of the register writes of `block`
+// in register order. The function implementing the block writes these values
+// to output buffers following those of GetJittedFunctionOutputs so the
+// register update can be applied by the wrapper built by BuildBlockWrapper.
+std::vector<Node*> GetBlockRegisterControls(Block* block) {
+  std::vector<Node*> controls;
+  for (Register* reg : block->GetRegisters()) {
+    RegisterWrite* reg_write = block->GetRegisterWrite(reg).value();
+    if (reg_write->load_enable().has_value()) {
+      controls.push_back(reg_write->load_enable().value());
+    }
+    if (reg_write->reset().has_value()) {
+      controls.push_back(reg_write->reset().value());
+    }
+  }
+  return controls;
+}
+
 // Build an llvm::Function implementing the given FunctionBase. The jitted
 // function contains a sequence of calls to partition functions where each
 // partition only implements a subset of the FunctionBase's nodes. This
@@ -673,6 +750,11 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
 
   std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
   std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  if (xls_function->IsBlock()) {
+    std::vector<Node*> controls =
+        GetBlockRegisterControls(xls_function->AsBlockOrDie());
+    outputs.insert(outputs.end(), controls.begin(), controls.end());
+  }
   LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
       xls_function->name(), inputs, outputs,
       llvm::Type::getInt64Ty(jit_context.context()), jit_context,
@@ -682,6 +764,25 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
 
   XLS_RETURN_IF_ERROR(AllocateBuffers(partitions, wrapper, allocator));
 
+  // When profiling, count calls of the function and accumulate the cycles
+  // spent between entry and each return.
+  JitProfile::FunctionCounters* counters = nullptr;
+  llvm::Value* entry_cycle_count = nullptr;
+  if (jit_context.profile() != nullptr) {
+    counters = jit_context.profile()->GetFunctionCounters(xls_function);
+    AddToCounter(&counters->call_count, wrapper.entry_builder().getInt64(1),
+                 &wrapper.entry_builder());
+    entry_cycle_count = ReadCycleCounter(&wrapper.entry_builder());
+  }
+  auto record_cycles = [&](llvm::IRBuilder<>* builder) {
+    if (counters != nullptr) {
+      AddToCounter(
+          &counters->cycle_count,
+          builder->CreateSub(ReadCycleCounter(builder), entry_cycle_count),
+          builder);
+    }
+  };
+
   std::vector<llvm::Function*> partition_functions;
   for (int64_t i = 0; i < partitions.size(); ++i) {
     std::string name =
@@ -736,6 +837,7 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
           wrapper.function(),
           /*InsertBefore=*/nullptr);
       llvm::IRBuilder<> early_return_builder(early_return);
+      record_cycles(&early_return_builder);
       early_return_builder.CreateRet(early_return_builder.getInt64(
           partitions[i].continuation_point.value()));
 
@@ -761,6 +863,7 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
           builder.get());
     }
   }
+  record_cycles(builder.get());
   // Return zero indicating that the execution of the FunctionBase completed.
   builder->CreateRet(builder->getInt64(0));
 
@@ -1085,16 +1188,269 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
   return wrapper.function();
 }
 
-// Jits a function implementing `xls_function`. Also jits all transitively
-// dependent xls::Functions which may be called by `xls_function`.
-absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
-    FunctionBase* xls_function, JitBuilderContext& jit_context,
-    bool build_packed_wrapper) {
+// Builds a wrapper around the jitted function `callee` which evaluates the
+// function over a batch of inputs. The wrapper has the same signature as
+// `callee` except the final argument is the number of elements in the batch
+// rather than a continuation point. Each pointer in the `inputs` (`outputs`)
+// array points to `batch_size` consecutive values of the respective input
+// (output) in the native LLVM data layout. `callee` is invoked in a loop over
+// the batch which LLVM is free to inline and vectorize.
+absl::StatusOr<llvm::Function*> BuildBatchedWrapper(
+    FunctionBase* xls_function, llvm::Function* callee,
+    JitBuilderContext& jit_context) {
+  llvm::LLVMContext* context = &jit_context.context();
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  llvm::Type* i8 = llvm::Type::getInt8Ty(*context);
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_batched", xls_function->name()), inputs, outputs,
+      i64, jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "batch_size", .type = i64});
+  llvm::IRBuilder<>& entry_builder = wrapper.entry_builder();
+
+  // Arrays of pointers to the elements of the current iteration which are
+  // passed to `callee`.
+  llvm::Type* pointer_array_type =
+      llvm::ArrayType::get(llvm::Type::getInt8PtrTy(*context), 0);
+  llvm::Value* input_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(llvm::PointerType::get(*context, 0), inputs.size()));
+  llvm::Value* output_arg_array =
+      entry_builder.CreateAlloca(llvm::ArrayType::get(
+          llvm::PointerType::get(*context, 0), outputs.size()));
+  std::vector<llvm::Value*> input_bases;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    input_bases.push_back(
+        LoadPointerFromPointerArray(i, wrapper.GetInputsArg(), &entry_builder));
+  }
+  std::vector<llvm::Value*> output_bases;
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    output_bases.push_back(LoadPointerFromPointerArray(
+        i, wrapper.GetOutputsArg(), &entry_builder));
+  }
+
+  llvm::BasicBlock* entry_block = entry_builder.GetInsertBlock();
+  llvm::BasicBlock* header_block =
+      llvm::BasicBlock::Create(*context, "loop_header", wrapper.function());
+  llvm::BasicBlock* body_block =
+      llvm::BasicBlock::Create(*context, "loop_body", wrapper.function());
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(*context, "exit", wrapper.function());
+  entry_builder.CreateBr(header_block);
+
+  llvm::IRBuilder<> header_builder(header_block);
+  llvm::PHINode* index = header_builder.CreatePHI(i64, 2, "index");
+  index->addIncoming(llvm::ConstantInt::get(i64, 0), entry_block);
+  header_builder.CreateCondBr(
+      header_builder.CreateICmpSLT(index, wrapper.GetExtraArg().value()),
+      body_block, exit_block);
+
+  llvm::IRBuilder<> body_builder(body_block);
+  auto store_element_pointer = [&](llvm::Value* array, int64_t slot,
+                                   llvm::Value* base, Node* node) {
+    int64_t element_size =
+        jit_context.type_converter().GetTypeByteSize(node->GetType());
+    llvm::Value* offset = body_builder.CreateMul(
+        index, llvm::ConstantInt::get(i64, element_size));
+    llvm::Value* element = body_builder.CreateGEP(i8, base, offset);
+    llvm::Value* gep = body_builder.CreateGEP(
+        pointer_array_type, array,
+        {
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0),
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), slot),
+        });
+    body_builder.CreateStore(element, gep);
+  };
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    store_element_pointer(input_arg_array, i, input_bases[i], inputs[i]);
+  }
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    store_element_pointer(output_arg_array, i, output_bases[i], outputs[i]);
+  }
+
+  std::vector<llvm::Value*> args;
+  args.push_back(input_arg_array);
+  args.push_back(output_arg_array);
+  args.push_back(wrapper.GetTempBufferArg());
+  args.push_back(wrapper.GetInterpreterEventsArg());
+  args.push_back(wrapper.GetUserDataArg());
+  args.push_back(wrapper.GetJitRuntimeArg());
+  args.push_back(llvm::ConstantInt::get(i64, 0));
+  body_builder.CreateCall(callee, args);
+  llvm::Value* next_index =
+      body_builder.CreateAdd(index, llvm::ConstantInt::get(i64, 1));
+  index->addIncoming(next_index, body_block);
+  body_builder.CreateBr(header_block);
+
+  llvm::IRBuilder<> exit_builder(exit_block);
+  exit_builder.CreateRet(llvm::ConstantInt::get(i64, 0));
+
+  return wrapper.function();
+}
+
+// Builds a wrapper around the jitted function `callee` implementing the
+// combinational logic of `block` which additionally performs the register
+// update for one clock cycle. The wrapper has the same signature as `callee`
+// but the `outputs` argument only holds the output port values and the next
+// register values (see GetJittedFunctionOutputs). `callee` writes the load
+// enable and reset signals of the registers (see GetBlockRegisterControls) to
+// stack buffers in the wrapper after which the next register value is set to
+// the reset value if reset is asserted, or the current register value if the
+// load enable is not asserted. The next register buffers must not alias the
+// current register buffers.
+absl::StatusOr<llvm::Function*> BuildBlockWrapper(
+    Block* block, llvm::Function* callee, JitBuilderContext& jit_context) {
+  llvm::LLVMContext* context = &jit_context.context();
+  std::vector<Node*> inputs = GetJittedFunctionInputs(block);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(block);
+  std::vector<Node*> controls = GetBlockRegisterControls(block);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_cycle", block->name()), inputs, outputs,
+      llvm::Type::getInt64Ty(*context), jit_context,
+      LlvmFunctionWrapper::FunctionArg{
+          .name = "continuation_point",
+          .type = llvm::Type::getInt64Ty(*context)});
+  llvm::IRBuilder<>& b = wrapper.entry_builder();
+
+  llvm::Type* pointer_array_type =
+      llvm::ArrayType::get(llvm::Type::getInt8PtrTy(*context), 0);
+  llvm::Value* output_arg_array =
+      b.CreateAlloca(llvm::ArrayType::get(llvm::PointerType::get(*context, 0),
+                                          outputs.size() + controls.size()));
+  auto store_output_pointer = [&](int64_t slot, llvm::Value* buffer) {
+    llvm::Value* gep = b.CreateGEP(
+        pointer_array_type, output_arg_array,
+        {
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0),
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), slot),
+        });
+    b.CreateStore(buffer, gep);
+  };
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    store_output_pointer(
+        i, LoadPointerFromPointerArray(i, wrapper.GetOutputsArg(), &b));
+  }
+  absl::flat_hash_map<Node*, llvm::Value*> control_buffers;
+  for (int64_t i = 0; i < controls.size(); ++i) {
+    llvm::Value* buffer = b.CreateAlloca(
+        jit_context.type_converter().ConvertToLlvmType(controls[i]->GetType()));
+    store_output_pointer(outputs.size() + i, buffer);
+    control_buffers.try_emplace(controls[i], buffer);
+  }
+
+  std::vector<llvm::Value*> args;
+  args.push_back(wrapper.GetInputsArg());
+  args.push_back(output_arg_array);
+  args.push_back(wrapper.GetTempBufferArg());
+  args.push_back(wrapper.GetInterpreterEventsArg());
+  args.push_back(wrapper.GetUserDataArg());
+  args.push_back(wrapper.GetJitRuntimeArg());
+  args.push_back(wrapper.GetExtraArg().value());
+  llvm::Value* continuation_result = b.CreateCall(callee, args);
+
+  // The buffer of each next register value holds the data value of the
+  // register write. Overwrite it if the register is held or reset.
+  int64_t register_input_offset = block->GetInputPorts().size();
+  int64_t register_output_offset = block->GetOutputPorts().size();
+  for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+    Register* reg = block->GetRegisters()[i];
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                         block->GetRegisterWrite(reg));
+    if (!reg_write->load_enable().has_value() &&
+        !reg_write->reset().has_value()) {
+      continue;
+    }
+    llvm::Type* reg_type =
+        jit_context.type_converter().ConvertToLlvmType(reg->type());
+    llvm::Value* next_buffer = LoadPointerFromPointerArray(
+        register_output_offset + i, wrapper.GetOutputsArg(), &b);
+    llvm::Value* next_value = b.CreateLoad(reg_type, next_buffer);
+    if (reg_write->load_enable().has_value()) {
+      llvm::Value* load_enable =
+          b.CreateLoad(b.getInt1Ty(),
+                       control_buffers.at(reg_write->load_enable().value()));
+      llvm::Value* current_value = LoadFromPointerArray(
+          register_input_offset + i, reg_type, wrapper.GetInputsArg(), &b);
+      next_value = b.CreateSelect(load_enable, next_value, current_value);
+    }
+    if (reg_write->reset().has_value()) {
+      const Reset& reset = reg->reset().value();
+      llvm::Value* reset_active = b.CreateLoad(
+          b.getInt1Ty(), control_buffers.at(reg_write->reset().value()));
+      if (reset.active_low) {
+        reset_active = b.CreateNot(reset_active);
+      }
+      XLS_ASSIGN_OR_RETURN(llvm::Constant * reset_value,
+                           jit_context.type_converter().ToLlvmConstant(
+                               reg->type(), reset.reset_value));
+      next_value = b.CreateSelect(reset_active, reset_value, next_value);
+    }
+    b.CreateStore(next_value, next_buffer);
+  }
+
+  b.CreateRet(continuation_result);
+
+  return wrapper.function();
+}
+
+// A top-level function emitted into the current module of a JitBuilderContext
+// which has not yet been compiled.
+struct EmittedFunctionBase {
+  FunctionBase* function_base;
+  std::string function_name;
+  std::optional<std::string> packed_function_name;
+  std::optional<std::string> batched_function_name;
+  std::vector<Partition> partitions;
+};
+
+// Returns the key under which the compiled code of `f` is recorded in a
+// JitFunctionCache: the IR text of `f` followed by the symbols of the
+// functions it calls. The callees must already have been built.
+std::string GetJitFunctionCacheKey(FunctionBase* f,
+                                   JitBuilderContext& jit_context) {
+  std::string key = f->DumpIr();
+  for (Function* callee : CalledFunctions(f)) {
+    absl::StrAppend(&key, "\n",
+                    jit_context.GetLlvmFunction(callee)->getName().str());
+  }
+  return key;
+}
+
+// Emits a function implementing `xls_function`. Also emits all transitively
+// dependent xls::Functions which may be called by `xls_function` and which
+// have not already been built by `jit_context`. Unless the JIT compiles
+// eagerly, each dependent function is emitted into its own module so the
+// modules can be compiled in parallel or on first call. The names of these
+// functions are appended to `dependent_function_names`. If `cache` is
+// non-null, dependent functions are always emitted into their own modules and
+// functions found in the cache are not emitted at all.
+absl::StatusOr<EmittedFunctionBase> EmitFunctionAndDependencies(
+    FunctionBase* xls_function, BufferAllocator& allocator,
+    JitBuilderContext& jit_context, bool build_wrappers,
+    std::vector<std::string>* dependent_function_names,
+    JitFunctionCache* cache = nullptr) {
   std::vector<FunctionBase*> functions = GetDependentFunctions(xls_function);
-  BufferAllocator allocator(&jit_context.type_converter());
+  bool split_modules =
+      cache != nullptr ||
+      jit_context.orc_jit().compilation_mode() != JitCompilationMode::kEager;
   llvm::Function* top_function = nullptr;
-  std::vector<Partition> top_partitions;
+  EmittedFunctionBase emitted{.function_base = xls_function};
   for (FunctionBase* f : functions) {
+    if (f != xls_function && jit_context.HasLlvmFunction(f)) {
+      continue;
+    }
+    std::string cache_key;
+    if (cache != nullptr && f != xls_function) {
+      cache_key = GetJitFunctionCacheKey(f, jit_context);
+      const JitFunctionCache::CachedFunction* cached = cache->Find(cache_key);
+      if (cached != nullptr) {
+        XLS_VLOG(3) << absl::StreamFormat("Reusing compiled function %s as %s",
+                                          f->name(), cached->symbol);
+        jit_context.AddExternalFunction(f, cached->symbol, cached->type);
+        cache->RecordReusedFunction();
+        continue;
+      }
+    }
     XLS_ASSIGN_OR_RETURN(
         PartitionedFunction partitioned_function,
         BuildFunctionInternal(f, allocator, jit_context,
@@ -1102,54 +1458,132 @@ absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
     jit_context.SetLlvmFunction(f, partitioned_function.function);
     if (f == xls_function) {
       top_function = partitioned_function.function;
-      top_partitions = std::move(partitioned_function.partitions);
+      emitted.partitions = std::move(partitioned_function.partitions);
+    } else if (split_modules) {
+      dependent_function_names->push_back(
+          partitioned_function.function->getName().str());
+      if (cache != nullptr) {
+        llvm::Function* function = partitioned_function.function;
+        cache->Insert(std::move(cache_key),
+                      JitFunctionCache::CachedFunction{
+                          .symbol = function->getName().str(),
+                          .type = function->getFunctionType()});
+        cache->RecordCompiledFunction();
+      }
+      XLS_RETURN_IF_ERROR(
+          jit_context.orc_jit().CompileModule(jit_context.ConsumeModule()));
+      jit_context.StartNewModule(absl::StrCat("__module_", f->name()));
     }
   }
   XLS_RET_CHECK(top_function != nullptr);
+  if (xls_function->IsBlock()) {
+    // The register update is performed by a wrapper around the function
+    // implementing the combinational logic of the block.
+    XLS_ASSIGN_OR_RETURN(top_function,
+                         BuildBlockWrapper(xls_function->AsBlockOrDie(),
+                                           top_function, jit_context));
+  }
 
-  std::string function_name = top_function->getName().str();
-  std::string packed_wrapper_name;
-  if (build_packed_wrapper) {
+  emitted.function_name = top_function->getName().str();
+  if (build_wrappers) {
     XLS_ASSIGN_OR_RETURN(
         llvm::Function * packed_wrapper_function,
         BuildPackedWrapper(xls_function, top_function, jit_context));
-    packed_wrapper_name = packed_wrapper_function->getName().str();
+    emitted.packed_function_name = packed_wrapper_function->getName().str();
+    XLS_ASSIGN_OR_RETURN(
+        llvm::Function * batched_wrapper_function,
+        BuildBatchedWrapper(xls_function, top_function, jit_context));
+    emitted.batched_function_name = batched_wrapper_function->getName().str();
   }
+  return emitted;
+}
 
-  XLS_RETURN_IF_ERROR(
-      jit_context.orc_jit().CompileModule(jit_context.ConsumeModule()));
+// Returns the indices of the state elements of `proc` which may be updated in
+// place. See JittedFunctionBase::in_place_state_indices.
+std::vector<int64_t> GetInPlaceStateIndices(
+    Proc* proc, absl::Span<const Partition> partitions) {
+  absl::flat_hash_map<Node*, int64_t> partition_indices;
+  int64_t last_continuation_partition = -1;
+  for (int64_t i = 0; i < partitions.size(); ++i) {
+    for (Node* node : partitions[i].nodes) {
+      partition_indices[node] = i;
+    }
+    if (partitions[i].continuation_point.has_value()) {
+      last_continuation_partition = i;
+    }
+  }
+  std::vector<int64_t> indices;
+  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+    Param* param = proc->GetStateParam(i);
+    Node* next = proc->GetNextStateElement(i);
+    if (next == param) {
+      indices.push_back(i);
+      continue;
+    }
+    // An array update writing into the buffer of the current value must be
+    // the only use of the current value. It must also follow all continuation
+    // points so the state of a blocked tick is not modified.
+    if (next->Is<ArrayUpdate>() && next->operand(0) == param &&
+        param->users().size() == 1 && next->OperandInstanceCount(param) == 1 &&
+        std::count(proc->NextState().begin(), proc->NextState().end(),
+                   next) == 1 &&
+        partition_indices.at(next) > last_continuation_partition) {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
 
+// Returns the JittedFunctionBase for the compiled function `emitted`. The
+// temporary buffer passed to the function must hold `temp_buffer_size` bytes.
+absl::StatusOr<JittedFunctionBase> LoadJittedFunction(
+    const EmittedFunctionBase& emitted, int64_t temp_buffer_size,
+    JitBuilderContext& jit_context) {
   JittedFunctionBase jitted_function;
 
-  jitted_function.function_name = function_name;
+  jitted_function.function_base = emitted.function_base;
+  jitted_function.function_name = emitted.function_name;
   XLS_ASSIGN_OR_RETURN(auto fn_address,
-                       jit_context.orc_jit().LoadSymbol(function_name));
+                       jit_context.orc_jit().LoadSymbol(emitted.function_name));
   jitted_function.function = absl::bit_cast<JitFunctionType>(fn_address);
 
-  if (build_packed_wrapper) {
-    jitted_function.packed_function_name = packed_wrapper_name;
-    XLS_ASSIGN_OR_RETURN(auto packed_fn_address,
-                         jit_context.orc_jit().LoadSymbol(packed_wrapper_name));
+  if (emitted.packed_function_name.has_value()) {
+    jitted_function.packed_function_name = emitted.packed_function_name;
+    XLS_ASSIGN_OR_RETURN(
+        auto packed_fn_address,
+        jit_context.orc_jit().LoadSymbol(*emitted.packed_function_name));
     jitted_function.packed_function =
         absl::bit_cast<JitFunctionType>(packed_fn_address);
   }
+  if (emitted.batched_function_name.has_value()) {
+    jitted_function.batched_function_name = emitted.batched_function_name;
+    XLS_ASSIGN_OR_RETURN(
+        auto batched_fn_address,
+        jit_context.orc_jit().LoadSymbol(*emitted.batched_function_name));
+    jitted_function.batched_function =
+        absl::bit_cast<JitFunctionType>(batched_fn_address);
+  }
 
-  for (const Node* input : GetJittedFunctionInputs(xls_function)) {
+  for (const Node* input : GetJittedFunctionInputs(emitted.function_base)) {
     jitted_function.input_buffer_sizes.push_back(
         jit_context.type_converter().GetTypeByteSize(input->GetType()));
     jitted_function.packed_input_buffer_sizes.push_back(
         jit_context.type_converter().GetPackedTypeByteSize(input->GetType()));
   }
-  for (const Node* output : GetJittedFunctionOutputs(xls_function)) {
+  for (const Node* output : GetJittedFunctionOutputs(emitted.function_base)) {
     jitted_function.output_buffer_sizes.push_back(
         jit_context.type_converter().GetTypeByteSize(output->GetType()));
     jitted_function.packed_output_buffer_sizes.push_back(
         jit_context.type_converter().GetPackedTypeByteSize(output->GetType()));
   }
-  jitted_function.temp_buffer_size = allocator.size();
+  jitted_function.temp_buffer_size = temp_buffer_size;
+  if (emitted.function_base->IsProc()) {
+    jitted_function.in_place_state_indices = GetInPlaceStateIndices(
+        emitted.function_base->AsProcOrDie(), emitted.partitions);
+  }
 
   // Indicate which nodes correspond to which continuation points.
-  for (const Partition& partition : top_partitions) {
+  for (const Partition& partition : emitted.partitions) {
     if (partition.continuation_point.has_value()) {
       XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
       jitted_function
@@ -1161,20 +1595,152 @@ absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
   return std::move(jitted_function);
 }
 
+// Jits a function implementing `xls_function`. Also jits all transitively
+// dependent xls::Functions which may be called by `xls_function`, reusing
+// those compiled by earlier builds if `cache` is non-null.
+absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
+    FunctionBase* xls_function, JitBuilderContext& jit_context,
+    bool build_wrappers, JitFunctionCache* cache = nullptr) {
+  BufferAllocator allocator(
+      &jit_context.type_converter(),
+      /*base_offset=*/cache == nullptr ? 0 : cache->temp_buffer_base());
+  if (cache != nullptr) {
+    jit_context.set_symbol_suffix(cache->NextSymbolSuffix());
+  }
+  std::vector<std::string> dependent_function_names;
+  XLS_ASSIGN_OR_RETURN(
+      EmittedFunctionBase emitted,
+      EmitFunctionAndDependencies(xls_function, allocator, jit_context,
+                                  build_wrappers, &dependent_function_names,
+                                  cache));
+
+  XLS_RETURN_IF_ERROR(
+      jit_context.orc_jit().CompileModule(jit_context.ConsumeModule()));
+
+  if (jit_context.orc_jit().compilation_mode() ==
+          JitCompilationMode::kConcurrent &&
+      !dependent_function_names.empty()) {
+    // Materialize all of the modules with a single lookup so they are compiled
+    // in parallel rather than one call-graph level at a time as the linker
+    // discovers references.
+    dependent_function_names.push_back(emitted.function_name);
+    XLS_RETURN_IF_ERROR(
+        jit_context.orc_jit().LoadSymbols(dependent_function_names).status());
+  }
+
+  if (cache != nullptr) {
+    cache->set_temp_buffer_base(allocator.size());
+  }
+  return LoadJittedFunction(emitted, allocator.size(), jit_context);
+}
+
 }  // namespace
 
+/* static */ absl::StatusOr<std::unique_ptr<JitFunctionCache>>
+JitFunctionCache::Create(int64_t opt_level) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit,
+                       OrcJit::Create(opt_level));
+  return absl::WrapUnique(new JitFunctionCache(std::move(orc_jit)));
+}
+
+const JitFunctionCache::CachedFunction* JitFunctionCache::Find(
+    std::string_view key) const {
+  auto it = functions_.find(key);
+  return it == functions_.end() ? nullptr : &it->second;
+}
+
+void JitFunctionCache::Insert(std::string key, CachedFunction function) {
+  functions_[std::move(key)] = std::move(function);
+}
+
 absl::StatusOr<JittedFunctionBase> BuildFunction(Function* xls_function,
-                                                 OrcJit& orc_jit) {
-  JitBuilderContext jit_context(orc_jit);
+                                                 OrcJit& orc_jit,
+                                                 JitProfile* profile) {
+  JitBuilderContext jit_context(orc_jit, /*queue_mgr=*/std::nullopt, profile);
+  return BuildFunctionAndDependencies(xls_function, jit_context,
+                                      /*build_wrappers=*/true);
+}
+
+absl::StatusOr<JittedFunctionBase> BuildFunctionIncrementally(
+    Function* xls_function, JitFunctionCache& cache) {
+  JitBuilderContext jit_context(cache.orc_jit());
   return BuildFunctionAndDependencies(xls_function, jit_context,
-                                      /*build_packed_wrapper=*/true);
+                                      /*build_wrappers=*/true, &cache);
 }
 
 absl::StatusOr<JittedFunctionBase> BuildProcFunction(
-    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit) {
+    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit,
+    JitProfile* profile) {
+  JitBuilderContext jit_context(orc_jit, queue_mgr, profile);
+  return BuildFunctionAndDependencies(proc, jit_context,
+                                      /*build_wrappers=*/false);
+}
+
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildProcNetworkFunctions(
+    absl::Span<Proc* const> procs, JitChannelQueueManager* queue_mgr,
+    OrcJit& orc_jit) {
+  XLS_RET_CHECK(orc_jit.compilation_mode() == JitCompilationMode::kEager)
+      << "Proc networks are compiled into a single module";
   JitBuilderContext jit_context(orc_jit, queue_mgr);
+  // Functions invoked by more than one proc are emitted once and use the temp
+  // buffer offsets assigned when they were emitted, so all of the procs share
+  // one allocation of the temp buffer.
+  BufferAllocator allocator(&jit_context.type_converter());
+  std::vector<EmittedFunctionBase> emitted_procs;
+  for (Proc* proc : procs) {
+    // The JIT compiles eagerly so no functions are split into other modules.
+    std::vector<std::string> dependent_function_names;
+    XLS_ASSIGN_OR_RETURN(
+        EmittedFunctionBase emitted,
+        EmitFunctionAndDependencies(proc, allocator, jit_context,
+                                    /*build_wrappers=*/false,
+                                    &dependent_function_names));
+    emitted_procs.push_back(std::move(emitted));
+  }
+  XLS_RETURN_IF_ERROR(orc_jit.CompileModule(jit_context.ConsumeModule()));
+
+  std::vector<JittedFunctionBase> jitted_procs;
+  for (const EmittedFunctionBase& emitted : emitted_procs) {
+    XLS_ASSIGN_OR_RETURN(
+        JittedFunctionBase jitted_proc,
+        LoadJittedFunction(emitted, allocator.size(), jit_context));
+    jitted_procs.push_back(std::move(jitted_proc));
+  }
+  return jitted_procs;
+}
+
+absl::StatusOr<JittedFunctionBase> BuildBlockFunction(Block* block,
+                                                      OrcJit& orc_jit,
+                                                      JitProfile* profile) {
+  if (!block->GetInstantiations().empty()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Block `%s` has instantiations which are not supported by the JIT",
+        block->name()));
+  }
+  for (Register* reg : block->GetRegisters()) {
+    XLS_RETURN_IF_ERROR(block->GetRegisterRead(reg).status());
+    XLS_RETURN_IF_ERROR(block->GetRegisterWrite(reg).status());
+  }
+  JitBuilderContext jit_context(orc_jit, /*queue_mgr=*/std::nullopt, profile);
+  return BuildFunctionAndDependencies(block, jit_context,
+                                      /*build_wrappers=*/false);
+}
+
+absl::StatusOr<JittedFunctionBase> BuildAotProcFunction(Proc* proc,
+                                                        OrcJit& orc_jit) {
+  // The queue access functions are still resolved when the code is linked
+  // into the JIT. Point them at the definitions in this binary.
+  XLS_RETURN_IF_ERROR(orc_jit.DefineAbsoluteSymbol(
+      "xls_jit_channel_queue_read_raw",
+      reinterpret_cast<const void*>(&xls_jit_channel_queue_read_raw)));
+  XLS_RETURN_IF_ERROR(orc_jit.DefineAbsoluteSymbol(
+      "xls_jit_channel_queue_write_raw",
+      reinterpret_cast<const void*>(&xls_jit_channel_queue_write_raw)));
+  JitBuilderContext jit_context(orc_jit, /*queue_mgr=*/std::nullopt,
+                                /*profile=*/nullptr,
+                                /*relocatable_channel_queues=*/true);
   return BuildFunctionAndDependencies(proc, jit_context,
-                                      /*build_packed_wrapper=*/false);
+                                      /*build_wrappers=*/false);
 }
 
 }  // namespace xls
@@ -14,13 +14,24 @@
 #ifndef XLS_JIT_FUNCTION_BASE_JIT_H_
 #define XLS_JIT_FUNCTION_BASE_JIT_H_
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "xls/ir/block.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/proc.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 
@@ -69,6 +80,14 @@ struct JittedFunctionBase {
   std::optional<std::string> packed_function_name;
   std::optional<JitFunctionType> packed_function;
 
+  // Name and function pointer for the jitted function which evaluates the
+  // function over a batch of arguments/results in LLVM native format. Each
+  // input/output pointer points to consecutive values, one per batch
+  // element. The final argument of the function is the batch size rather than
+  // a continuation point. Only exists for JITted xls::Functions, not procs.
+  std::optional<std::string> batched_function_name;
+  std::optional<JitFunctionType> batched_function;
+
   // Sizes of the inputs/outputs in native LLVM format for `function_base`.
   std::vector<int64_t> input_buffer_sizes;
   std::vector<int64_t> output_buffer_sizes;
@@ -84,17 +103,119 @@ struct JittedFunctionBase {
   // execution was interrupted. Generally, these nodes will be blocking receive
   // nodes.
   absl::flat_hash_map<int64_t, Node*> continuation_points;
+
+  // Indices of the state elements of a proc which may be updated in place:
+  // the output buffer for the next value of the element may be the same as the
+  // input buffer holding its current value, which avoids copying the value
+  // each tick. These are elements whose next value is the current value, or
+  // an array update of the current value which is its only use and which
+  // follows all continuation points. Empty for other FunctionBases.
+  std::vector<int64_t> in_place_state_indices;
+};
+
+// Compiled code shared by successive builds of (possibly edited) functions
+// with a single OrcJit. Each xls::Function invoked by a built function is
+// compiled into its own module and recorded under a key formed from the IR
+// text of the function and the symbols of the functions it calls. A later
+// build reuses the compiled code of a function whose key is unchanged, so after
+// an edit only the edited functions and their (transitive) callers are
+// compiled again. The function being built and its wrappers are always
+// compiled. This makes rebuilding after small edits cheap, for example in
+// interactive tools.
+//
+// Compiled code bakes in the offsets of its temporary buffer allocations, so
+// each build allocates its temporaries above those of all earlier builds and
+// the temporary buffer grows with each build which compiles new code.
+class JitFunctionCache {
+ public:
+  // A function compiled by an earlier build.
+  struct CachedFunction {
+    std::string symbol;
+    llvm::FunctionType* type;
+  };
+
+  static absl::StatusOr<std::unique_ptr<JitFunctionCache>> Create(
+      int64_t opt_level = 3);
+
+  OrcJit& orc_jit() { return *orc_jit_; }
+
+  // Returns the function compiled under `key` or nullptr if there is none.
+  const CachedFunction* Find(std::string_view key) const;
+  void Insert(std::string key, CachedFunction function);
+
+  // Returns a suffix for the symbols of a new build which is distinct from the
+  // suffixes of all earlier builds.
+  std::string NextSymbolSuffix() { return absl::StrCat("__v", build_count_++); }
+
+  // Offset in the temporary buffer at which the next build allocates.
+  int64_t temp_buffer_base() const { return temp_buffer_base_; }
+  void set_temp_buffer_base(int64_t base) { temp_buffer_base_ = base; }
+
+  // Number of functions compiled or reused over all builds.
+  int64_t compiled_function_count() const { return compiled_function_count_; }
+  int64_t reused_function_count() const { return reused_function_count_; }
+  void RecordCompiledFunction() { ++compiled_function_count_; }
+  void RecordReusedFunction() { ++reused_function_count_; }
+
+ private:
+  explicit JitFunctionCache(std::unique_ptr<OrcJit> orc_jit)
+      : orc_jit_(std::move(orc_jit)) {}
+
+  std::unique_ptr<OrcJit> orc_jit_;
+  absl::flat_hash_map<std::string, CachedFunction> functions_;
+  int64_t build_count_ = 0;
+  int64_t temp_buffer_base_ = 0;
+  int64_t compiled_function_count_ = 0;
+  int64_t reused_function_count_ = 0;
 };
 
 // Builds and returns an LLVM IR function implementing the given XLS
-// function.
+// function. If `profile` is non-null the generated code updates the execution
+// counters in `profile`, which must outlive the generated code.
 absl::StatusOr<JittedFunctionBase> BuildFunction(Function* xls_function,
-                                                 OrcJit& orc_jit);
+                                                 OrcJit& orc_jit,
+                                                 JitProfile* profile = nullptr);
+
+// As BuildFunction but compiles into the OrcJit of `cache`, reusing the code
+// of invoked functions which are unchanged since an earlier build with the same
+// cache (see JitFunctionCache). `cache` must outlive the returned function.
+absl::StatusOr<JittedFunctionBase> BuildFunctionIncrementally(
+    Function* xls_function, JitFunctionCache& cache);
 
 // Builds and returns an LLVM IR function implementing the given XLS
-// proc.
+// proc. `profile` is as in BuildFunction.
 absl::StatusOr<JittedFunctionBase> BuildProcFunction(
-    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit);
+    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit,
+    JitProfile* profile = nullptr);
+
+// Builds LLVM IR functions implementing each of the given XLS procs in a
+// single module and returns them in the same order. Compiling the procs of a
+// network together lets LLVM optimize across them (e.g., functions invoked by
+// several procs are emitted once) and channels backed by a
+// RingBufferJitChannelQueue in `queue_mgr` are accessed inline. The procs share
+// the size of their temporary buffer. `orc_jit` must compile eagerly.
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildProcNetworkFunctions(
+    absl::Span<Proc* const> procs, JitChannelQueueManager* queue_mgr,
+    OrcJit& orc_jit);
+
+// Builds and returns an LLVM IR function which evaluates one clock cycle of
+// the given XLS block. The inputs of the function are the input port values
+// (in the order of Block::GetInputPorts) followed by the current register
+// values (in the order of Block::GetRegisters). The outputs are the values
+// driven on the output ports (in the order of Block::GetOutputPorts) followed
+// by the next register values. The register output buffers must not alias the
+// register input buffers. Blocks with instantiations are not supported.
+// `profile` is as in BuildFunction.
+absl::StatusOr<JittedFunctionBase> BuildBlockFunction(
+    Block* block, OrcJit& orc_jit, JitProfile* profile = nullptr);
+
+// Builds and returns an LLVM IR function implementing the given XLS proc for
+// ahead-of-time compilation. The generated code contains no addresses of
+// channel queues. Instead the `user_data` argument of the function must point
+// to an array of JitChannelQueue* indexed by channel id and queues are accessed
+// through the C-linkage functions declared in jit_channel_queue.h.
+absl::StatusOr<JittedFunctionBase> BuildAotProcFunction(Proc* proc,
+                                                        OrcJit& orc_jit);
 
 }  // namespace xls
 
@@ -31,8 +31,19 @@
 namespace xls {
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
+    Function* xls_function, int64_t opt_level,
+    std::optional<std::filesystem::path> object_cache_dir,
+    JitCompilationMode compilation_mode, JitCpuTarget cpu_target) {
+  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false,
+                        std::move(object_cache_dir), compilation_mode,
+                        /*enable_profiling=*/false, cpu_target);
+}
+
+absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateWithProfiling(
     Function* xls_function, int64_t opt_level) {
-  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false);
+  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false,
+                        /*object_cache_dir=*/std::nullopt,
+                        JitCompilationMode::kEager, /*enable_profiling=*/true);
 }
 
 absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
@@ -50,29 +61,52 @@ absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
 }
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
-    Function* xls_function, int64_t opt_level, bool emit_object_code) {
+    Function* xls_function, int64_t opt_level, bool emit_object_code,
+    std::optional<std::filesystem::path> object_cache_dir,
+    JitCompilationMode compilation_mode, bool enable_profiling,
+    JitCpuTarget cpu_target) {
+  auto jit = absl::WrapUnique(new FunctionJit(xls_function));
+  if (enable_profiling) {
+    jit->profile_ = std::make_unique<JitProfile>();
+  }
+  XLS_ASSIGN_OR_RETURN(
+      jit->orc_jit_,
+      OrcJit::Create(opt_level, emit_object_code, std::move(object_cache_dir),
+                     compilation_mode, cpu_target));
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       OrcJit::CreateDataLayout());
+  jit->jit_runtime_ = std::make_unique<JitRuntime>(data_layout);
+  XLS_ASSIGN_OR_RETURN(
+      jit->jitted_function_base_,
+      BuildFunction(xls_function, *jit->orc_jit_, jit->profile_.get()));
+  jit->AllocateBuffers();
+  return jit;
+}
+
+absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateIncremental(
+    Function* xls_function, JitFunctionCache* cache) {
   auto jit = absl::WrapUnique(new FunctionJit(xls_function));
-  XLS_ASSIGN_OR_RETURN(jit->orc_jit_,
-                       OrcJit::Create(opt_level, emit_object_code));
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
                        OrcJit::CreateDataLayout());
   jit->jit_runtime_ = std::make_unique<JitRuntime>(data_layout);
   XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
-                       BuildFunction(xls_function, *jit->orc_jit_));
+                       BuildFunctionIncrementally(xls_function, *cache));
+  jit->AllocateBuffers();
+  return jit;
+}
 
+void FunctionJit::AllocateBuffers() {
   // Pre-allocate argument, result, and temporary buffers.
-  for (int64_t i = 0; i < xls_function->params().size(); ++i) {
-    jit->arg_buffers_.push_back(std::vector<uint8_t>(jit->GetArgTypeSize(i)));
-    jit->arg_buffer_ptrs_.push_back(jit->arg_buffers_.back().data());
+  for (int64_t i = 0; i < xls_function_->params().size(); ++i) {
+    arg_buffers_.push_back(std::vector<uint8_t>(GetArgTypeSize(i)));
+    arg_buffer_ptrs_.push_back(arg_buffers_.back().data());
+    param_types_.push_back(xls_function_->param(i)->GetType());
   }
-  jit->result_buffer_.resize(jit->GetReturnTypeSize());
-  jit->temp_buffer_.resize(jit->GetTempBufferSize());
-
-  return jit;
+  result_buffer_.resize(GetReturnTypeSize());
+  temp_buffer_.resize(GetTempBufferSize());
 }
 
-absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
-    absl::Span<const Value> args) {
+absl::Status FunctionJit::CheckAndPackArgs(absl::Span<const Value> args) {
   absl::Span<Param* const> params = xls_function_->params();
   if (args.size() != params.size()) {
     return absl::InvalidArgumentError(absl::StrFormat(
@@ -88,16 +122,17 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     }
   }
 
-  std::vector<Type*> param_types;
-  for (const Param* param : xls_function_->params()) {
-    param_types.push_back(param->GetType());
-  }
+  // Copy the arg Values into the preallocated argument buffers.
+  return jit_runtime_->PackArgs(args, param_types_,
+                                absl::MakeSpan(arg_buffer_ptrs_));
+}
 
-  // Allocate argument buffers and copy in arg Values.
-  XLS_RETURN_IF_ERROR(jit_runtime_->PackArgs(args, param_types,
-                                             absl::MakeSpan(arg_buffer_ptrs_)));
+absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
+    absl::Span<const Value> args) {
+  XLS_RETURN_IF_ERROR(CheckAndPackArgs(args));
 
   InterpreterEvents events;
+  events.trace_collection = trace_collection_;
   InvokeJitFunction(arg_buffer_ptrs_, result_buffer_.data(), &events);
   Value result = jit_runtime_->UnpackBuffer(
       result_buffer_.data(), xls_function_->return_value()->GetType());
@@ -112,6 +147,19 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
   return Run(positional_args);
 }
 
+absl::Status FunctionJit::RunWithResultView(absl::Span<const Value> args,
+                                            absl::Span<uint8_t> result_buffer,
+                                            InterpreterEvents* events) {
+  if (result_buffer.size() < GetReturnTypeSize()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Result buffer too small - must be at least %d bytes!",
+                        GetReturnTypeSize()));
+  }
+  XLS_RETURN_IF_ERROR(CheckAndPackArgs(args));
+  InvokeJitFunction(arg_buffer_ptrs_, result_buffer.data(), events);
+  return absl::OkStatus();
+}
+
 absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
                                        absl::Span<uint8_t> result_buffer,
                                        InterpreterEvents* events) {
@@ -132,6 +180,33 @@ absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
   return absl::OkStatus();
 }
 
+absl::Status FunctionJit::RunBatched(absl::Span<const uint8_t* const> args,
+                                     absl::Span<uint8_t> result_buffer,
+                                     int64_t batch_size,
+                                     InterpreterEvents* events) {
+  XLS_RET_CHECK(jitted_function_base_.batched_function.has_value());
+  if (args.size() != xls_function_->params().size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        args.size(), xls_function_->params().size()));
+  }
+  if (batch_size < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Batch size must be non-negative, got %d", batch_size));
+  }
+  if (result_buffer.size() < batch_size * GetReturnTypeSize()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result buffer too small - must be at least %d bytes!",
+        batch_size * GetReturnTypeSize()));
+  }
+
+  uint8_t* output_buffers[1] = {result_buffer.data()};
+  jitted_function_base_.batched_function.value()(
+      args.data(), output_buffers, temp_buffer_.data(), events,
+      /*user_data=*/nullptr, runtime(), batch_size);
+  return absl::OkStatus();
+}
+
 void FunctionJit::InvokeJitFunction(absl::Span<uint8_t* const> arg_buffers,
                                     uint8_t* output_buffer,
                                     InterpreterEvents* events) {
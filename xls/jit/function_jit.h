@@ -15,6 +15,9 @@
 #ifndef XLS_JIT_FUNCTION_JIT_H_
 #define XLS_JIT_FUNCTION_JIT_H_
 
+#include <filesystem>
+#include <optional>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -24,6 +27,7 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_view.h"
 #include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 
@@ -51,10 +55,35 @@ struct JitObjectCode {
 class FunctionJit {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // function.
+  // function. If `object_cache_dir` is given, compiled object code is cached
+  // in that directory and reused by later compilations of the same function.
+  // `compilation_mode` selects whether the function and each function it
+  // (transitively) invokes are compiled up front, in parallel, or on first
+  // call (see JitCompilationMode). `cpu_target` selects whether code is tuned
+  // for the features of the host CPU (see JitCpuTarget).
   static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
+      Function* xls_function, int64_t opt_level = 3,
+      std::optional<std::filesystem::path> object_cache_dir = std::nullopt,
+      JitCompilationMode compilation_mode = JitCompilationMode::kEager,
+      JitCpuTarget cpu_target = JitCpuTarget::kHost);
+
+  // As Create but the compiled code is instrumented to count executions of
+  // each node and the calls and cycles spent in each (invoked) function. The
+  // counters are available via `profile()`. Instrumentation adds overhead so
+  // this should only be used for profiling.
+  static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateWithProfiling(
       Function* xls_function, int64_t opt_level = 3);
 
+  // Returns an object containing a host-compiled version of the specified XLS
+  // function which is compiled into the JIT owned by `cache`. Functions invoked
+  // by `xls_function` which are unchanged since an earlier build with `cache`
+  // are not compiled again (see JitFunctionCache), so recreating the
+  // FunctionJit after editing a function in the package only compiles the
+  // edited functions and their callers. `cache` must outlive the returned
+  // object.
+  static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateIncremental(
+      Function* xls_function, JitFunctionCache* cache);
+
   // Returns the bytes of an object file containing the compiled XLS function.
   static absl::StatusOr<JitObjectCode> CreateObjectCode(Function* xls_function,
                                                         int64_t opt_level = 3);
@@ -66,6 +95,17 @@ class FunctionJit {
   absl::StatusOr<InterpreterResult<Value>> Run(
       const absl::flat_hash_map<std::string, Value>& kwargs);
 
+  // Executes the compiled function with the specified arguments and writes the
+  // result in the native LLVM data layout to `result_buffer` rather than
+  // constructing a Value. The result may be read through a view (see
+  // value_view.h) or unpacked later with runtime()->UnpackBuffer. The buffer
+  // must hold at least GetReturnTypeSize() bytes and may be reused across
+  // calls, so callers evaluating many argument sets avoid allocating a result
+  // Value per call. Events are appended to `events`.
+  absl::Status RunWithResultView(absl::Span<const Value> args,
+                                 absl::Span<uint8_t> result_buffer,
+                                 InterpreterEvents* events);
+
   // Executes the compiled function with the arguments and results specified as
   // "views" - flat buffers onto which structures layouts can be applied (see
   // value_view.h).
@@ -82,6 +122,20 @@ class FunctionJit {
                             absl::Span<uint8_t> result_buffer,
                             InterpreterEvents* events);
 
+  // Evaluates the function over a batch of `batch_size` argument tuples in a
+  // single call. Arguments are in structure-of-arrays form: `args[i]` points to
+  // `batch_size` consecutive values of parameter i, each `GetArgTypeSize(i)`
+  // bytes in the native LLVM data layout. Results are written consecutively to
+  // `result_buffer` which must hold at least `batch_size *
+  // GetReturnTypeSize()` bytes. Events from all batch elements are accumulated
+  // in `events`.
+  //
+  // This avoids the per-call overhead of RunWithViews and lets LLVM optimize
+  // across the loop over batch elements.
+  absl::Status RunBatched(absl::Span<const uint8_t* const> args,
+                          absl::Span<uint8_t> result_buffer,
+                          int64_t batch_size, InterpreterEvents* events);
+
   // Similar to RunWithViews(), except the arguments here are _packed_views_ -
   // views whose data elements are tightly packed, with no padding bits or bytes
   // between them. The function return value is specified as the last arg - its
@@ -109,7 +163,9 @@ class FunctionJit {
     // Walk the type tree to get each arg's data buffer into our view/arg list.
     PackArgBuffers(arg_buffers, &result_buffer, args...);
 
+    // Only assertions are reported so traces need not be collected.
     InterpreterEvents events;
+    events.trace_collection = TraceCollection::kDisabled;
     uint8_t* output_buffers[1] = {result_buffer};
     jitted_function_base_.packed_function.value()(
         arg_buffers, output_buffers, temp_buffer_.data(), &events,
@@ -153,11 +209,34 @@ class FunctionJit {
 
   JitRuntime* runtime() const { return jit_runtime_.get(); }
 
+  // Returns the execution counters of the function or nullptr if the JIT was
+  // not created with profiling enabled.
+  JitProfile* profile() const { return profile_.get(); }
+
+  // Returns the on-disk object cache used when compiling the function or
+  // nullptr if none was specified.
+  JitObjectCache* object_cache() const {
+    return orc_jit_ == nullptr ? nullptr : orc_jit_->object_cache();
+  }
+
+  // Sets how traces are collected in the events returned by Run (see
+  // TraceCollection). Defaults to formatting each trace as it executes. Callers
+  // of the methods taking an InterpreterEvents* choose by setting
+  // InterpreterEvents::trace_collection instead.
+  void set_trace_collection(TraceCollection trace_collection) {
+    trace_collection_ = trace_collection;
+  }
+  TraceCollection trace_collection() const { return trace_collection_; }
+
  private:
   explicit FunctionJit(Function* xls_function) : xls_function_(xls_function) {}
 
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
-      Function* xls_function, int64_t opt_level, bool emit_object_code);
+      Function* xls_function, int64_t opt_level, bool emit_object_code,
+      std::optional<std::filesystem::path> object_cache_dir = std::nullopt,
+      JitCompilationMode compilation_mode = JitCompilationMode::kEager,
+      bool enable_profiling = false,
+      JitCpuTarget cpu_target = JitCpuTarget::kHost);
 
   // Builds a function which wraps the natively compiled XLS function `callee`
   // (as built by xls::BuildFunction) with another function which accepts the
@@ -196,10 +275,19 @@ class FunctionJit {
     *result_buffer = front.buffer();
   }
 
+  // Allocates the argument, result and temporary buffers reused across calls.
+  void AllocateBuffers();
+
+  // Checks the given arguments against the parameters of the function and
+  // packs them into `arg_buffers_`.
+  absl::Status CheckAndPackArgs(absl::Span<const Value> args);
+
   // Invokes the jitted function with the given argument and outputs.
   void InvokeJitFunction(absl::Span<uint8_t* const> arg_buffers,
                          uint8_t* output_buffer, InterpreterEvents* events);
 
+  // The JIT which compiled the function. Null if the function was compiled
+  // into the JIT of a JitFunctionCache.
   std::unique_ptr<OrcJit> orc_jit_;
 
   Function* xls_function_;
@@ -213,8 +301,16 @@ class FunctionJit {
   // Raw pointers to the buffers held in `arg_buffers_`.
   std::vector<uint8_t*> arg_buffer_ptrs_;
 
+  // The types of the parameters of `xls_function_`.
+  std::vector<Type*> param_types_;
+
   JittedFunctionBase jitted_function_base_;
   std::unique_ptr<JitRuntime> jit_runtime_;
+
+  // Counters updated by the compiled code if profiling is enabled.
+  std::unique_ptr<JitProfile> profile_;
+
+  TraceCollection trace_collection_ = TraceCollection::kFormatted;
 };
 
 }  // namespace xls
@@ -21,13 +21,20 @@
 #include "gtest/gtest.h"
 #include "absl/random/random.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/nodes.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_profile.h"
+#include "xls/jit/jit_runtime.h"
 #include "re2/re2.h"
 
 namespace xls {
@@ -36,6 +43,7 @@ namespace {
 using status_testing::IsOk;
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 
 // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Replace the empty
 // events returned by the JIT evaluator with a entry point that includes the
@@ -55,6 +63,38 @@ INSTANTIATE_TEST_SUITE_P(
           return jit->Run(kwargs);
         })));
 
+// Instantiations which compile each invoked function as a separate module,
+// either concurrently or lazily on first call.
+IrEvaluatorTestParam CompilationModeTestParam(JitCompilationMode mode) {
+  return IrEvaluatorTestParam(
+      [mode](Function* function, absl::Span<const Value> args)
+          -> absl::StatusOr<InterpreterResult<Value>> {
+        XLS_ASSIGN_OR_RETURN(
+            auto jit, FunctionJit::Create(function, /*opt_level=*/3,
+                                          /*object_cache_dir=*/std::nullopt,
+                                          mode));
+        return jit->Run(args);
+      },
+      [mode](Function* function,
+             const absl::flat_hash_map<std::string, Value>& kwargs)
+          -> absl::StatusOr<InterpreterResult<Value>> {
+        XLS_ASSIGN_OR_RETURN(
+            auto jit, FunctionJit::Create(function, /*opt_level=*/3,
+                                          /*object_cache_dir=*/std::nullopt,
+                                          mode));
+        return jit->Run(kwargs);
+      });
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    FunctionJitConcurrentCompilationTest, IrEvaluatorTestBase,
+    testing::Values(
+        CompilationModeTestParam(JitCompilationMode::kConcurrent)));
+
+INSTANTIATE_TEST_SUITE_P(
+    FunctionJitLazyCompilationTest, IrEvaluatorTestBase,
+    testing::Values(CompilationModeTestParam(JitCompilationMode::kLazy)));
+
 absl::StatusOr<Value> RunJitNoEvents(FunctionJit* jit,
                                      absl::Span<const Value> args) {
   XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result, jit->Run(args));
@@ -165,6 +205,165 @@ TEST(FunctionJitTest, TraceFmtBigArgTest) {
             "00000000000000000000000000000000000000000000000000000000000000");
 }
 
+TEST(FunctionJitTest, TraceCollection) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn traces(tkn: token, x: bits[8], y: (bits[3], bits[64])) -> token {
+    pred: bits[1] = literal(value=1, id=0)
+    trace.1: token = trace(tkn, pred, format="x: {} y: {:x}", data_operands=[x, y], id=1)
+    ret trace.2: token = trace(trace.1, pred, format="done", data_operands=[], id=2)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  std::vector<Value> args = {
+      Value::Token(), Value(UBits(42, 8)),
+      Value::Tuple({Value(UBits(5, 3)), Value(UBits(0xabcd, 64))})};
+
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> formatted, jit->Run(args));
+  EXPECT_THAT(formatted.events.trace_msgs,
+              ElementsAre("x: 42 y: (5, abcd)", "done"));
+  EXPECT_TRUE(formatted.events.raw_traces.empty());
+
+  // Raw traces are formatted on demand to the same messages.
+  jit->set_trace_collection(TraceCollection::kRaw);
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> raw, jit->Run(args));
+  EXPECT_TRUE(raw.events.trace_msgs.empty());
+  ASSERT_EQ(raw.events.raw_traces.size(), 2);
+  EXPECT_EQ(raw.events.raw_traces.trace(0)->id(), 1);
+  EXPECT_THAT(raw.events.GetTraceMessages(),
+              ElementsAre("x: 42 y: (5, abcd)", "done"));
+  EXPECT_EQ(raw.events, formatted.events);
+
+  jit->set_trace_collection(TraceCollection::kDisabled);
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> disabled, jit->Run(args));
+  EXPECT_TRUE(disabled.events.GetTraceMessages().empty());
+}
+
+TEST(FunctionJitTest, CountedForLoops) {
+  const std::string kIrText = R"(
+package p
+
+fn crc_body(i: bits[32], crc: bits[32]) -> bits[32] {
+  one: bits[32] = literal(value=1)
+  poly: bits[32] = literal(value=0xedb88320)
+  lsb: bits[32] = and(crc, one)
+  is_set: bits[1] = eq(lsb, one)
+  shifted: bits[32] = shrl(crc, one)
+  reduced: bits[32] = xor(shifted, poly)
+  selected: bits[32] = sel(is_set, cases=[shifted, reduced])
+  ret result: bits[32] = xor(selected, i)
+}
+
+fn traced_body(i: bits[8], acc: bits[8]) -> bits[8] {
+  tkn: token = after_all()
+  pred: bits[1] = literal(value=1)
+  trace_i: token = trace(tkn, pred, format="i: {}", data_operands=[i])
+  ret next_acc: bits[8] = add(acc, i)
+}
+
+top fn f(x: bits[32], y: bits[8]) -> (bits[32], bits[8]) {
+  crc: bits[32] = counted_for(x, trip_count=100000, stride=1, body=crc_body)
+  sum: bits[8] = counted_for(y, trip_count=3, stride=2, body=traced_body)
+  ret out: (bits[32], bits[8]) = tuple(crc, sum)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+
+  uint32_t crc = 0x12345678;
+  for (uint32_t i = 0; i < 100000; ++i) {
+    crc = ((crc & 1) ? ((crc >> 1) ^ 0xedb88320) : (crc >> 1)) ^ i;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<Value> result,
+      jit->Run({Value(UBits(0x12345678, 32)), Value(UBits(1, 8))}));
+  EXPECT_EQ(result.value,
+            Value::Tuple({Value(UBits(crc, 32)), Value(UBits(7, 8))}));
+  EXPECT_THAT(result.events.trace_msgs, ElementsAre("i: 0", "i: 2", "i: 4"));
+}
+
+TEST(FunctionJitTest, MapOverLanes) {
+  const std::string kIrText = R"(
+package p
+
+fn saturating_double(x: bits[16]) -> bits[16] {
+  one: bits[16] = literal(value=1)
+  limit: bits[16] = literal(value=0x7fff)
+  max: bits[16] = literal(value=0xffff)
+  doubled: bits[16] = shll(x, one)
+  overflow: bits[1] = ugt(x, limit)
+  ret result: bits[16] = sel(overflow, cases=[doubled, max])
+}
+
+top fn f(x: bits[16][37]) -> bits[16][37] {
+  ret out: bits[16][37] = map(x, to_apply=saturating_double)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+
+  std::vector<Value> input;
+  std::vector<Value> expected;
+  for (int64_t i = 0; i < 37; ++i) {
+    uint64_t x = (i * 1777) & 0xffff;
+    input.push_back(Value(UBits(x, 16)));
+    expected.push_back(Value(UBits(x > 0x7fff ? 0xffff : x * 2, 16)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Value input_array, Value::Array(input));
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected_array, Value::Array(expected));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {input_array}),
+              IsOkAndHolds(expected_array));
+}
+
+TEST(FunctionJitTest, WideBitManipulation) {
+  const std::string kIrText = R"(
+package p
+
+top fn f(x: bits[100]) -> (bits[7], bits[101], bits[101], bits[100]) {
+  enc: bits[7] = encode(x)
+  lsb: bits[101] = one_hot(x, lsb_prio=true)
+  msb: bits[101] = one_hot(x, lsb_prio=false)
+  rev: bits[100] = reverse(x)
+  ret result: (bits[7], bits[101], bits[101], bits[100]) = tuple(enc, lsb, msb, rev)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto host_jit,
+      FunctionJit::Create(f, /*opt_level=*/3, /*object_cache_dir=*/std::nullopt,
+                          JitCompilationMode::kEager, JitCpuTarget::kHost));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto generic_jit,
+      FunctionJit::Create(f, /*opt_level=*/3, /*object_cache_dir=*/std::nullopt,
+                          JitCompilationMode::kEager, JitCpuTarget::kGeneric));
+
+  std::vector<Value> inputs = {Value(UBits(0, 100)),
+                               Value(Bits::PowerOfTwo(99, 100)),
+                               Value(Bits::AllOnes(100))};
+  std::minstd_rand engine;
+  for (int64_t i = 0; i < 64; ++i) {
+    inputs.push_back(RandomValue(f->param(0)->GetType(), &engine));
+  }
+  for (const Value& input : inputs) {
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             InterpretFunction(f, {input}));
+    EXPECT_THAT(RunJitNoEvents(host_jit.get(), {input}),
+                IsOkAndHolds(expected.value))
+        << input;
+    EXPECT_THAT(RunJitNoEvents(generic_jit.get(), {input}),
+                IsOkAndHolds(expected.value))
+        << input;
+  }
+}
+
 // This test verifies that a compiled JIT function can be re-used.
 TEST(FunctionJitTest, ReuseTest) {
   Package package("my_package");
@@ -185,6 +384,61 @@ TEST(FunctionJitTest, ReuseTest) {
               IsOkAndHolds(Value(UBits(7, 8))));
 }
 
+TEST(FunctionJitTest, BlitRandomToBuffer) {
+  Package package("my_package");
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(42), package.GetTokenType(),
+       package.GetArrayType(5, package.GetBitsType(3)),
+       package.GetBitsType(200)});
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitRuntime> runtime,
+                           JitRuntime::Create());
+  Xoshiro256StarStar engine(42);
+  auto fill_random = [&](absl::Span<uint8_t> bytes) { engine.Fill(bytes); };
+  int64_t byte_size = runtime->GetTypeByteSize(type);
+  for (int64_t i = 0; i < 16; ++i) {
+    std::vector<uint8_t> buffer(byte_size, 0);
+    runtime->BlitRandomToBuffer(type, absl::MakeSpan(buffer), fill_random);
+    Value value = runtime->UnpackBuffer(buffer.data(), type);
+
+    // Blitting the unpacked value gives the same bytes so the padding bits
+    // have been cleared.
+    std::vector<uint8_t> expected(byte_size, 0);
+    runtime->BlitValueToBuffer(value, type, absl::MakeSpan(expected));
+    EXPECT_EQ(buffer, expected);
+  }
+}
+
+TEST(FunctionJitTest, RunWithResultView) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn f(x: bits[8], y: bits[100]) -> (bits[8], bits[100]) {
+    add.1: bits[8] = add(x, x)
+    ret tuple.2: (bits[8], bits[100]) = tuple(add.1, y)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
+  InterpreterEvents events;
+  for (int64_t i = 0; i < 4; ++i) {
+    std::vector<Value> args = {Value(UBits(i, 8)), Value(UBits(i * 3, 100))};
+    XLS_ASSERT_OK(jit->RunWithResultView(args, absl::MakeSpan(result_buffer),
+                                         &events));
+    EXPECT_EQ(
+        jit->runtime()->UnpackBuffer(result_buffer.data(),
+                                     function->GetType()->return_type()),
+        Value::Tuple({Value(UBits(2 * i, 8)), Value(UBits(i * 3, 100))}));
+  }
+
+  std::vector<uint8_t> small_buffer(1);
+  EXPECT_THAT(jit->RunWithResultView({Value(UBits(0, 8)), Value(UBits(0, 100))},
+                                     absl::MakeSpan(small_buffer), &events),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       testing::HasSubstr("Result buffer too small")));
+}
+
 TEST(FunctionJitTest, OneHotZeroBit) {
   Package package("my_package");
   std::string ir_text = R"(
@@ -200,6 +454,70 @@ TEST(FunctionJitTest, OneHotZeroBit) {
               IsOkAndHolds(Value(UBits(1, 1))));
 }
 
+TEST(FunctionJitTest, RunBatched) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn mul_add(x: bits[32], y: bits[32], z: (bits[16], bits[8])) -> bits[32] {
+    z0: bits[16] = tuple_index(z, index=0)
+    z1: bits[8] = tuple_index(z, index=1)
+    z0_ext: bits[32] = zero_ext(z0, new_bit_count=32)
+    z1_ext: bits[32] = zero_ext(z1, new_bit_count=32)
+    umul.1: bits[32] = umul(x, y)
+    add.2: bits[32] = add(umul.1, z0_ext)
+    ret add.3: bits[32] = add(add.2, z1_ext)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  constexpr int64_t kBatchSize = 1000;
+  std::vector<uint32_t> x(kBatchSize);
+  std::vector<uint32_t> y(kBatchSize);
+  // The tuple argument is in the native LLVM layout so fill it via the JIT
+  // runtime.
+  std::vector<uint8_t> z(kBatchSize * jit->GetArgTypeSize(2));
+  Type* z_type = function->param(2)->GetType();
+  std::vector<Value> z_values;
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    x[i] = i;
+    y[i] = 3 * i + 1;
+    z_values.push_back(Value::Tuple(
+        {Value(UBits(i % 1000, 16)), Value(UBits(i % 200, 8))}));
+    jit->runtime()->BlitValueToBuffer(
+        z_values.back(), z_type,
+        absl::MakeSpan(z).subspan(i * jit->GetArgTypeSize(2),
+                                  jit->GetArgTypeSize(2)));
+  }
+
+  std::vector<uint32_t> results(kBatchSize);
+  std::vector<const uint8_t*> args = {
+      reinterpret_cast<const uint8_t*>(x.data()),
+      reinterpret_cast<const uint8_t*>(y.data()), z.data()};
+  InterpreterEvents events;
+  XLS_ASSERT_OK(jit->RunBatched(
+      args,
+      absl::MakeSpan(reinterpret_cast<uint8_t*>(results.data()),
+                     results.size() * sizeof(uint32_t)),
+      kBatchSize, &events));
+
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Value expected,
+        RunJitNoEvents(jit.get(), {Value(UBits(x[i], 32)),
+                                   Value(UBits(y[i], 32)), z_values[i]}));
+    EXPECT_EQ(results[i], expected.bits().ToUint64().value()) << i;
+  }
+
+  // A result buffer which is too small is an error.
+  EXPECT_THAT(jit->RunBatched(args,
+                              absl::MakeSpan(reinterpret_cast<uint8_t*>(
+                                                 results.data()),
+                                             sizeof(uint32_t)),
+                              kBatchSize, &events),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 // Very basic smoke test for packed types.
 TEST(FunctionJitTest, PackedSmoke) {
   Package package("my_package");
@@ -500,6 +818,58 @@ TEST(FunctionJitTest, ArrayConcatArrayOfBits) {
   EXPECT_THAT(RunJitNoEvents(jit.get(), args), IsOkAndHolds(ret));
 }
 
+// Large array literals are emitted as global constants shared between their
+// uses in different functions.
+TEST(FunctionJitTest, LargeArrayLiterals) {
+  std::vector<int64_t> words;
+  for (int64_t i = 0; i < 32; ++i) {
+    words.push_back(3 * i);
+  }
+  std::string table = absl::StrJoin(words, ", ");
+  std::string ir_text = R"(
+  package my_package
+
+  fn lookup(i: bits[5]) -> bits[32] {
+    table: bits[32][32] = literal(value=[$0])
+    ret result: bits[32] = array_index(table, indices=[i])
+  }
+
+  top fn f(i: bits[5], j: bits[5]) -> bits[32] {
+    table: bits[32][32] = literal(value=[$0])
+    a: bits[32] = invoke(i, to_apply=lookup)
+    b: bits[32] = array_index(table, indices=[j])
+    ret result: bits[32] = add(a, b)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Package> package,
+      Parser::ParsePackage(absl::Substitute(ir_text, table)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  EXPECT_THAT(
+      RunJitNoEvents(jit.get(), {Value(UBits(2, 5)), Value(UBits(31, 5))}),
+      IsOkAndHolds(Value(UBits(6 + 93, 32))));
+}
+
+// A large array literal which is also the return value is copied out of its
+// global constant.
+TEST(FunctionJitTest, ReturnLargeArrayLiteral) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn f() -> bits[64][16] {
+    ret table: bits[64][16] = literal(value=[0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15])
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value expected,
+      Value::UBitsArray(
+          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}, 64));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {}), IsOkAndHolds(expected));
+}
+
 TEST(FunctionJitTest, ArrayConcatArrayOfBitsMixedOperands) {
   Package package("my_package");
 
@@ -686,5 +1056,120 @@ TEST(FunctionJitTest, CompoundTokenCompareError) {
               StatusIs(absl::StatusCode::kInvalidArgument,
                        testing::HasSubstr("Tokens are incomparable")));
 }
+
+TEST(FunctionJitTest, Profiling) {
+  const std::string kIrText = R"(
+package p
+
+fn body(i: bits[32], acc: bits[32]) -> bits[32] {
+  ret add.3: bits[32] = add(i, acc)
+}
+
+top fn f(x: bits[32]) -> bits[32] {
+  literal.4: bits[32] = literal(value=1)
+  add.5: bits[32] = add(x, literal.4)
+  ret counted_for.6: bits[32] = counted_for(add.5, trip_count=4, stride=1, body=body)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * body, package->GetFunction("body"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add5, f->GetNode("add.5"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * counted_for6, f->GetNode("counted_for.6"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add3, body->GetNode("add.3"));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::CreateWithProfiling(f));
+  ASSERT_NE(jit->profile(), nullptr);
+
+  // 1 + (0 + 1 + 2 + 3) = 7.
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(0, 32))}),
+              IsOkAndHolds(Value(UBits(7, 32))));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(1, 32))}),
+              IsOkAndHolds(Value(UBits(8, 32))));
+
+  const JitProfile& profile = *jit->profile();
+  EXPECT_EQ(profile.GetNodeCount(add5), 2);
+  EXPECT_EQ(profile.GetNodeCount(counted_for6), 2);
+  EXPECT_EQ(profile.GetNodeCount(add3), 8);
+  EXPECT_EQ(profile.GetFunctionCounts(f).call_count, 2);
+  EXPECT_EQ(profile.GetFunctionCounts(body).call_count, 8);
+  EXPECT_GT(profile.GetFunctionCounts(f).cycle_count, 0);
+  EXPECT_GE(profile.GetFunctionCounts(f).cycle_count,
+            profile.GetFunctionCounts(body).cycle_count);
+
+  jit->profile()->Reset();
+  EXPECT_EQ(profile.GetNodeCount(add5), 0);
+  EXPECT_EQ(profile.GetFunctionCounts(body).call_count, 0);
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(0, 32))}),
+              IsOkAndHolds(Value(UBits(7, 32))));
+  EXPECT_EQ(profile.GetNodeCount(add3), 4);
+}
+
+TEST(FunctionJitTest, NoProfileByDefault) {
+  Package p("no_profile");
+  FunctionBuilder b("fun", &p);
+  b.Add(b.Param("x", p.GetBitsType(8)), b.Param("y", p.GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+  EXPECT_EQ(jit->profile(), nullptr);
+}
+
+TEST(FunctionJitTest, IncrementalRebuild) {
+  const std::string kIrText = R"(
+package p
+
+fn leaf(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=1)
+  ret add.2: bits[32] = add(x, literal.1)
+}
+
+fn middle(x: bits[32]) -> bits[32] {
+  ret invoke.3: bits[32] = invoke(x, to_apply=leaf)
+}
+
+fn other(x: bits[32]) -> bits[32] {
+  ret neg.4: bits[32] = neg(x)
+}
+
+top fn f(x: bits[32]) -> bits[32] {
+  invoke.5: bits[32] = invoke(x, to_apply=middle)
+  invoke.6: bits[32] = invoke(x, to_apply=other)
+  ret add.7: bits[32] = add(invoke.5, invoke.6)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * leaf, package->GetFunction("leaf"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitFunctionCache> cache,
+                           JitFunctionCache::Create());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit,
+                           FunctionJit::CreateIncremental(f, cache.get()));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(10, 32))}),
+              IsOkAndHolds(Value(UBits(1, 32))));
+  EXPECT_EQ(cache->compiled_function_count(), 3);
+  EXPECT_EQ(cache->reused_function_count(), 0);
+
+  // Rebuilding the unchanged function reuses all of the invoked functions.
+  XLS_ASSERT_OK_AND_ASSIGN(jit, FunctionJit::CreateIncremental(f, cache.get()));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(10, 32))}),
+              IsOkAndHolds(Value(UBits(1, 32))));
+  EXPECT_EQ(cache->compiled_function_count(), 3);
+  EXPECT_EQ(cache->reused_function_count(), 3);
+
+  // After editing `leaf`, only `leaf` and its caller `middle` are compiled
+  // again.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * literal, leaf->GetNode("literal.1"));
+  XLS_ASSERT_OK(
+      literal->ReplaceUsesWithNew<Literal>(Value(UBits(5, 32))).status());
+  XLS_ASSERT_OK(leaf->RemoveNode(literal));
+  XLS_ASSERT_OK_AND_ASSIGN(jit, FunctionJit::CreateIncremental(f, cache.get()));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(10, 32))}),
+              IsOkAndHolds(Value(UBits(5, 32))));
+  EXPECT_EQ(cache->compiled_function_count(), 5);
+  EXPECT_EQ(cache->reused_function_count(), 4);
+}
+
 }  // namespace
 }  // namespace xls
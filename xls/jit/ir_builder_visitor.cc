@@ -13,17 +13,25 @@
 // limitations under the License.
 #include "xls/jit/ir_builder_visitor.h"
 
+#include <algorithm>
+#include <cstddef>
+
 #include "absl/base/config.h"  // IWYU pragma: keep
+#include "absl/numeric/int128.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/ADT/APInt.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
 #include "llvm/include/llvm/IR/Instructions.h"
 #include "llvm/include/llvm/IR/LLVMContext.h"
+#include "llvm/include/llvm/IR/Metadata.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/call_graph.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
@@ -37,12 +45,65 @@
 
 namespace xls {
 
+namespace {
+
+// Array and tuple typed literals of at least this many bits are emitted as
+// global constants shared by all their uses in the module.
+constexpr int64_t kMinGlobalLiteralBits = 512;
+
+// Returns true if the node is a literal which is emitted as a global constant.
+bool IsGlobalLiteral(Node* node) {
+  return node->Is<Literal>() && !node->GetType()->IsBits() &&
+         node->GetType()->GetFlatBitCount() >= kMinGlobalLiteralBits;
+}
+
+// Bodies of counted for loops and maps with at most this many nodes (and no
+// side effects) are inlined into the loop (see IsInlinableLoopBody).
+constexpr int64_t kMaxInlinedLoopBodyNodeCount = 64;
+
+// Returns true if the body of a counted for loop or map should be inlined into
+// the LLVM loop emitted for it. Inlining lets LLVM keep the loop state in
+// registers and optimize across iterations, but grows the code of the caller,
+// so it is only done for small bodies. Bodies with side effects (in the body or
+// any function it invokes) are never inlined as the ops record events through
+// runtime callbacks which gain nothing from inlining.
+bool IsInlinableLoopBody(Function* body) {
+  if (body->node_count() > kMaxInlinedLoopBodyNodeCount) {
+    return false;
+  }
+  for (FunctionBase* f : GetDependentFunctions(body)) {
+    for (Node* node : f->nodes()) {
+      if (OpIsSideEffecting(node->op())) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Returns an alloca of the given type in the entry block of the function
+// `builder` is inserting into. Allocas outside of the entry block are
+// allocated dynamically each time they are executed (e.g., on each iteration
+// of a loop) and are not promoted to registers by LLVM.
+llvm::AllocaInst* CreateEntryBlockAlloca(llvm::Type* type,
+                                         llvm::IRBuilder<>& builder) {
+  llvm::BasicBlock& entry_block =
+      builder.GetInsertBlock()->getParent()->getEntryBlock();
+  llvm::IRBuilder<> entry_builder(&entry_block, entry_block.begin());
+  return entry_builder.CreateAlloca(type);
+}
+
+}  // namespace
+
 bool ShouldMaterializeAtUse(Node* node) {
-  // Only materialize Bits typed literals at their use. Array and tuple typed
+  // Materialize Bits typed literals at their use. Other array and tuple typed
   // literals are typically manipulated via pointer in the JITted code so these
   // values would have to be put in an alloca'd buffer anyway so there is no
-  // advantage to doing this at their uses vs in HandleLiteral.
-  return node->Is<Literal>() && node->GetType()->IsBits();
+  // advantage to doing this at their uses vs in HandleLiteral. Large aggregate
+  // literals are the exception: their uses read directly from a read-only
+  // global (e.g., an array_index of a lookup table is a load from the global).
+  return node->Is<Literal>() &&
+         (node->GetType()->IsBits() || IsGlobalLiteral(node));
 }
 
 namespace {
@@ -82,11 +143,26 @@ class LlvmIrLoop {
                                : body_builder_.get();
     llvm::Value* next_index = b->CreateAdd(index_, b->getInt64(stride_));
     next_index->setName("next_index");
-    b->CreateBr(preheader_block_);
+    llvm::BranchInst* backedge = b->CreateBr(preheader_block_);
     index_->addIncoming(next_index, b->GetInsertBlock());
+    if (vectorize_) {
+      // Attach loop metadata requesting vectorization. The first operand of a
+      // loop ID is a self reference.
+      llvm::LLVMContext& context = b->getContext();
+      llvm::Metadata* enable[] = {
+          llvm::MDString::get(context, "llvm.loop.vectorize.enable"),
+          llvm::ConstantAsMetadata::get(b->getTrue())};
+      llvm::Metadata* ops[] = {nullptr, llvm::MDNode::get(context, enable)};
+      llvm::MDNode* loop_id = llvm::MDNode::getDistinct(context, ops);
+      loop_id->replaceOperandWith(0, loop_id);
+      backedge->setMetadata(llvm::LLVMContext::MD_loop, loop_id);
+    }
     finalized_ = true;
   }
 
+  // Requests that LLVM vectorize the loop. Iterations must be independent.
+  void EnableVectorization() { vectorize_ = true; }
+
  private:
   // The stride of the loop.
   int64_t stride_;
@@ -109,6 +185,7 @@ class LlvmIrLoop {
   // anywhere in the preheader or body.
   llvm::PHINode* index_;
 
+  bool vectorize_ = false;
   bool finalized_ = false;
 };
 
@@ -199,6 +276,181 @@ std::vector<std::string> ConcatVectors(absl::Span<const std::string> a,
   return result;
 }
 
+// Multiplies, dynamic shifts and bit slice updates wider than this many bits
+// are lowered to calls to the word-sliced runtime helpers below rather than to
+// LLVM integer instructions. LLVM's expansion of these operations on very wide
+// integers (e.g., i256 or i512) is large and slow, while up to 128 bits it
+// uses pairs of native registers.
+constexpr int64_t kMaxNativeIntegerWidth = 128;
+
+bool UseWideIntegerHelper(int64_t bit_count) {
+  return bit_count > kMaxNativeIntegerWidth;
+}
+
+// The wide integer runtime helpers operate on little-endian arrays of
+// 'word_count' 64-bit words. The result buffer must not alias the inputs.
+
+// result = lhs * rhs truncated to 'word_count' words.
+void WideMul(const uint64_t* lhs, const uint64_t* rhs, uint64_t* result,
+             int64_t word_count) {
+  std::fill(result, result + word_count, 0);
+  for (int64_t i = 0; i < word_count; ++i) {
+    if (lhs[i] == 0) {
+      continue;
+    }
+    uint64_t carry = 0;
+    for (int64_t j = 0; i + j < word_count; ++j) {
+      absl::uint128 product =
+          absl::uint128(lhs[i]) * rhs[j] + result[i + j] + carry;
+      result[i + j] = absl::Uint128Low64(product);
+      carry = absl::Uint128High64(product);
+    }
+  }
+}
+
+// result = value << amount. 'amount' must be less than 64 * word_count.
+void WideShll(const uint64_t* value, uint64_t amount, uint64_t* result,
+              int64_t word_count) {
+  int64_t word_shift = amount / 64;
+  int64_t bit_shift = amount % 64;
+  for (int64_t i = 0; i < word_count; ++i) {
+    int64_t src = i - word_shift;
+    uint64_t word = src >= 0 ? value[src] : 0;
+    uint64_t lower = src >= 1 ? value[src - 1] : 0;
+    result[i] = bit_shift == 0
+                    ? word
+                    : (word << bit_shift) | (lower >> (64 - bit_shift));
+  }
+}
+
+// result = value >> amount where the vacated high bits are filled from 'fill'
+// (all zeros or all ones). 'amount' must be less than 64 * word_count.
+void WideShiftRight(const uint64_t* value, uint64_t amount, uint64_t fill,
+                    uint64_t* result, int64_t word_count) {
+  int64_t word_shift = amount / 64;
+  int64_t bit_shift = amount % 64;
+  for (int64_t i = 0; i < word_count; ++i) {
+    int64_t src = i + word_shift;
+    uint64_t word = src < word_count ? value[src] : fill;
+    uint64_t upper = src + 1 < word_count ? value[src + 1] : fill;
+    result[i] = bit_shift == 0
+                    ? word
+                    : (word >> bit_shift) | (upper << (64 - bit_shift));
+  }
+}
+
+void WideShrl(const uint64_t* value, uint64_t amount, uint64_t* result,
+              int64_t word_count) {
+  WideShiftRight(value, amount, /*fill=*/0, result, word_count);
+}
+
+void WideShra(const uint64_t* value, uint64_t amount, uint64_t* result,
+              int64_t word_count) {
+  uint64_t fill =
+      static_cast<int64_t>(value[word_count - 1]) < 0 ? ~uint64_t{0} : 0;
+  WideShiftRight(value, amount, fill, result, word_count);
+}
+
+// result = value with bits [start, start + update_width) replaced by the low
+// 'update_width' bits of 'update'. Bits of the update which fall beyond the end
+// of the words are dropped. 'start' must be less than 64 * word_count and
+// 'update' must hold at least 'update_width' bits.
+void WideBitSliceUpdate(const uint64_t* value, uint64_t start,
+                        const uint64_t* update, int64_t update_width,
+                        uint64_t* result, int64_t word_count) {
+  std::copy(value, value + word_count, result);
+  for (int64_t i = 0; i * 64 < update_width; ++i) {
+    uint64_t position = start + i * 64;
+    int64_t word = position / 64;
+    if (word >= word_count) {
+      break;
+    }
+    int64_t offset = position % 64;
+    int64_t chunk_width = std::min(int64_t{64}, update_width - i * 64);
+    uint64_t mask = chunk_width == 64 ? ~uint64_t{0}
+                                      : (uint64_t{1} << chunk_width) - 1;
+    uint64_t chunk = update[i] & mask;
+    result[word] = (result[word] & ~(mask << offset)) | (chunk << offset);
+    if (offset != 0 && word + 1 < word_count) {
+      result[word + 1] = (result[word + 1] & ~(mask >> (64 - offset))) |
+                         (chunk >> (64 - offset));
+    }
+  }
+}
+
+// Returns the number of 64-bit words required to hold 'bit_count' bits.
+int64_t WordCount(int64_t bit_count) {
+  return CeilOfRatio(bit_count, int64_t{64});
+}
+
+// Returns the LLVM integer type spanning 'word_count' 64-bit words. Stored to
+// memory, a value of this type is laid out as the word arrays expected by the
+// wide integer runtime helpers (the JIT targets the little-endian host).
+llvm::IntegerType* WordsType(int64_t word_count, llvm::IRBuilder<>* builder) {
+  return builder->getIntNTy(word_count * 64);
+}
+
+// Stores 'value' extended to 'word_count' 64-bit words in a new stack buffer
+// and returns a pointer to the buffer.
+llvm::Value* StoreAsWords(llvm::Value* value, int64_t word_count,
+                          bool is_signed, llvm::IRBuilder<>* builder) {
+  llvm::Type* words_type = WordsType(word_count, builder);
+  llvm::Value* buffer = builder->CreateAlloca(words_type);
+  builder->CreateStore(builder->CreateIntCast(value, words_type, is_signed),
+                       buffer);
+  return buffer;
+}
+
+// Emits a call to the given wide integer runtime helper. The result of the
+// helper is written to a new buffer of 'word_count' words which is passed as
+// the second to last argument and followed by the word count. Returns the
+// result truncated to 'result_type'.
+template <typename HelperT>
+llvm::Value* CallWideIntegerHelper(HelperT* helper,
+                                   std::vector<llvm::Value*> args,
+                                   int64_t word_count,
+                                   llvm::IntegerType* result_type,
+                                   llvm::IRBuilder<>* builder) {
+  llvm::Type* words_type = WordsType(word_count, builder);
+  llvm::Value* result_buffer = builder->CreateAlloca(words_type);
+  args.push_back(result_buffer);
+  args.push_back(builder->getInt64(word_count));
+
+  std::vector<llvm::Type*> params;
+  for (llvm::Value* arg : args) {
+    params.push_back(arg->getType());
+  }
+  llvm::FunctionType* fn_type = llvm::FunctionType::get(
+      llvm::Type::getVoidTy(builder->getContext()), params,
+      /*isVarArg=*/false);
+  llvm::ConstantInt* fn_addr =
+      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
+                             absl::bit_cast<uint64_t>(helper));
+  llvm::Value* fn_ptr =
+      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
+  builder->CreateCall(fn_type, fn_ptr, args);
+  return builder->CreateTrunc(builder->CreateLoad(words_type, result_buffer),
+                              result_type);
+}
+
+// Emits 'lhs * rhs' where both operands have the type of the result. The low
+// bits of a product do not depend on the signedness of the operands so the
+// same lowering serves umul and smul once the operands have been extended to
+// the result width.
+llvm::Value* EmitMul(llvm::Value* lhs, llvm::Value* rhs,
+                     llvm::IRBuilder<>* builder) {
+  auto* type = llvm::cast<llvm::IntegerType>(lhs->getType());
+  if (!UseWideIntegerHelper(type->getBitWidth())) {
+    return builder->CreateMul(lhs, rhs);
+  }
+  int64_t word_count = WordCount(type->getBitWidth());
+  return CallWideIntegerHelper(
+      &WideMul,
+      {StoreAsWords(lhs, word_count, /*is_signed=*/false, builder),
+       StoreAsWords(rhs, word_count, /*is_signed=*/false, builder)},
+      word_count, type, builder);
+}
+
 // Emit an LLVM shift operation corresponding to the semantics of the given XLS
 // op.
 llvm::Value* EmitShiftOp(Node* shift, llvm::Value* lhs, llvm::Value* rhs,
@@ -232,9 +484,7 @@ llvm::Value* EmitShiftOp(Node* shift, llvm::Value* lhs, llvm::Value* rhs,
   // (selected in the Select instruction) so correctness is not affected.
   llvm::Value* safe_rhs = builder->CreateSelect(is_overshift, zero, wide_rhs);
 
-  if (op == Op::kShll) {
-    inst = builder->CreateShl(wide_lhs, safe_rhs);
-  } else if (op == Op::kShra) {
+  if (op == Op::kShra) {
     llvm::Value* high_bit = builder->CreateLShr(
         wide_lhs,
         llvm::ConstantInt::get(dest_type,
@@ -243,6 +493,23 @@ llvm::Value* EmitShiftOp(Node* shift, llvm::Value* lhs, llvm::Value* rhs,
         builder->CreateICmpEQ(high_bit, llvm::ConstantInt::get(dest_type, 1));
     overshift_value = builder->CreateSelect(
         high_bit_set, llvm::ConstantInt::getSigned(dest_type, -1), zero);
+  }
+
+  if (UseWideIntegerHelper(common_width)) {
+    // The shift amount is less than the width here so it fits in 64 bits.
+    int64_t word_count = WordCount(common_width);
+    auto* helper = op == Op::kShll   ? &WideShll
+                   : op == Op::kShra ? &WideShra
+                                     : &WideShrl;
+    inst = CallWideIntegerHelper(
+        helper,
+        {StoreAsWords(wide_lhs, word_count, /*is_signed=*/op == Op::kShra,
+                      builder),
+         builder->CreateTrunc(safe_rhs, builder->getInt64Ty())},
+        word_count, llvm::cast<llvm::IntegerType>(dest_type), builder);
+  } else if (op == Op::kShll) {
+    inst = builder->CreateShl(wide_lhs, safe_rhs);
+  } else if (op == Op::kShra) {
     inst = builder->CreateAShr(wide_lhs, safe_rhs);
   } else {
     XLS_CHECK_EQ(op, Op::kShrl);
@@ -416,136 +683,84 @@ llvm::Value* ClampIndexInBounds(llvm::Value* index, ArrayType* array_type,
   return inbounds_index;
 }
 
-// This is a shim to let JIT code add a new trace fragment to an existing trace
-// buffer.
-void PerformStringStep(char* step_string, std::string* buffer) {
-  buffer->append(step_string);
-}
-
-// Build the LLVM IR that handles string fragment format steps.
-absl::Status InvokeStringStepCallback(llvm::IRBuilder<>* builder,
-                                      const std::string& step_string,
-                                      llvm::Value* buffer_ptr) {
-  llvm::Constant* step_constant = builder->CreateGlobalStringPtr(step_string);
-
-  std::vector<llvm::Type*> params = {step_constant->getType(),
-                                     buffer_ptr->getType()};
-
-  llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
-
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
-
-  std::vector<llvm::Value*> args = {step_constant, buffer_ptr};
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&PerformStringStep));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
-  return absl::OkStatus();
-}
-
-void PerformFormatStep(JitRuntime* runtime, const xls::Type* type,
-                       const uint8_t* value, uint64_t format_u64,
-                       std::string* buffer) {
-  FormatPreference format = static_cast<FormatPreference>(format_u64);
-  Value ir_value = runtime->UnpackBuffer(value, type, /*unpoison=*/true);
-  absl::StrAppend(buffer, ir_value.ToHumanString(format));
-}
-
-// Build the LLVM IR that handles formatting a runtime value according to a
-// format preference.
-absl::Status InvokeFormatStepCallback(llvm::IRBuilder<>* builder,
-                                      FormatPreference format,
-                                      xls::Type* operand_type,
-                                      llvm::Value* operand,
-                                      llvm::Value* buffer_ptr,
-                                      llvm::Value* jit_runtime_ptr) {
-  llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
-  auto* i64_type = llvm::Type::getInt64Ty(builder->getContext());
-
-  llvm::ConstantInt* llvm_format =
-      llvm::ConstantInt::get(i64_type, static_cast<uint64_t>(format));
-
-  // Note: we assume the package lifetime is >= that of the JIT code by
-  // capturing this type pointer as a value burned into the JIT code, which
-  // should always be true.
-  llvm::ConstantInt* llvm_operand_type =
-      llvm::ConstantInt::get(i64_type, absl::bit_cast<uint64_t>(operand_type));
-
-  std::vector<llvm::Type*> params = {
-      jit_runtime_ptr->getType(), llvm_operand_type->getType(),
-      operand->getType(), llvm_format->getType(), buffer_ptr->getType()};
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
-
-  std::vector<llvm::Value*> args = {jit_runtime_ptr, llvm_operand_type, operand,
-                                    llvm_format, buffer_ptr};
-
-  llvm::ConstantInt* fn_addr = llvm::ConstantInt::get(
-      i64_type, absl::bit_cast<uint64_t>(&PerformFormatStep));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
-  return absl::OkStatus();
-}
-
-// This a shim to let JIT code record a completed trace as an interpreter event.
-void RecordTrace(std::string* buffer, xls::InterpreterEvents* events) {
-  events->trace_msgs.push_back(*buffer);
-  delete buffer;
+// Formats the message of `trace` given the data operands of the trace stored
+// consecutively in `data` in the native data layout of `jit_runtime`.
+std::string FormatTraceData(const void* jit_runtime, const Trace* trace,
+                            absl::Span<const uint8_t> data) {
+  JitRuntime* runtime =
+      static_cast<JitRuntime*>(const_cast<void*>(jit_runtime));
+  std::string message;
+  int64_t offset = 0;
+  auto arg = trace->args().begin();
+  for (const FormatStep& step : trace->format()) {
+    if (std::holds_alternative<std::string>(step)) {
+      absl::StrAppend(&message, std::get<std::string>(step));
+      continue;
+    }
+    Type* type = (*arg++)->GetType();
+    Value value = runtime->UnpackBuffer(data.data() + offset, type,
+                                        /*unpoison=*/true);
+    absl::StrAppend(&message,
+                    value.ToHumanString(std::get<FormatPreference>(step)));
+    offset += runtime->GetTypeByteSize(type);
+  }
+  return message;
+}
+
+// This is a shim to let JIT code record an executed trace as an interpreter
+// event. `data` holds the data operands of the trace stored consecutively. The
+// trace is formatted, recorded in binary form or dropped depending on the
+// trace collection of `events`.
+void RecordTrace(xls::InterpreterEvents* events, JitRuntime* jit_runtime,
+                 const Trace* trace, const uint8_t* data, int64_t size) {
+  switch (events->trace_collection) {
+    case TraceCollection::kFormatted:
+      events->trace_msgs.push_back(
+          FormatTraceData(jit_runtime, trace, absl::MakeConstSpan(data, size)));
+      break;
+    case TraceCollection::kRaw:
+      events->raw_traces.Record(trace, &FormatTraceData, jit_runtime,
+                                absl::MakeConstSpan(data, size));
+      break;
+    case TraceCollection::kDisabled:
+      break;
+  }
 }
 
 // Build the LLVM IR to invoke the callback that records traces.
 absl::Status InvokeRecordTraceCallback(llvm::IRBuilder<>* builder,
-                                       llvm::Value* buffer_ptr,
-                                       llvm::Value* interpreter_events_ptr) {
+                                       const Trace* trace, llvm::Value* data,
+                                       int64_t data_size,
+                                       llvm::Value* interpreter_events_ptr,
+                                       llvm::Value* jit_runtime_ptr) {
   llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
-
-  std::vector<llvm::Type*> params = {buffer_ptr->getType(), ptr_type};
-
+  llvm::Type* i64_type = llvm::Type::getInt64Ty(builder->getContext());
   llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
 
+  // Note: as with types in the format callbacks, we assume the package
+  // lifetime is >= that of the JIT code (and of any raw traces recorded by it)
+  // by burning the trace node pointer into the JIT code.
+  llvm::Value* trace_ptr = builder->CreateIntToPtr(
+      llvm::ConstantInt::get(i64_type, absl::bit_cast<uint64_t>(trace)),
+      ptr_type);
+
+  std::vector<llvm::Type*> params = {ptr_type, ptr_type, ptr_type, ptr_type,
+                                     i64_type};
   llvm::FunctionType* fn_type =
       llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
 
-  std::vector<llvm::Value*> args = {buffer_ptr, interpreter_events_ptr};
+  std::vector<llvm::Value*> args = {
+      interpreter_events_ptr, jit_runtime_ptr, trace_ptr, data,
+      llvm::ConstantInt::get(i64_type, data_size)};
 
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&RecordTrace));
+  llvm::ConstantInt* fn_addr = llvm::ConstantInt::get(
+      i64_type, absl::bit_cast<uint64_t>(&RecordTrace));
   llvm::Value* fn_ptr =
       builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
   builder->CreateCall(fn_type, fn_ptr, args);
   return absl::OkStatus();
 }
 
-// This is a shim to let JIT code create a buffer for accumulating trace
-// fragments.
-std::string* CreateTraceBuffer() { return new std::string(); }
-
-// Build the LLVM IR to invoke the callback that creates a trace buffer.
-absl::StatusOr<llvm::Value*> InvokeCreateBufferCallback(
-    llvm::IRBuilder<>* builder) {
-  std::vector<llvm::Type*> params;
-
-  llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
-
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(ptr_type, params, /*isVarArg=*/false);
-
-  std::vector<llvm::Value*> args;
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&CreateTraceBuffer));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  return builder->CreateCall(fn_type, fn_ptr, args);
-}
-
 // This a shim to let JIT code record an assertion failure as an interpreter
 // event.
 void RecordAssertion(char* msg, xls::InterpreterEvents* events) {
@@ -811,7 +1026,8 @@ absl::StatusOr<NodeIrContext> NodeIrContext::Create(
 llvm::Value* NodeIrContext::LoadOperand(int64_t i, llvm::IRBuilder<>* builder) {
   Node* operand = node()->operand(i);
 
-  if (ShouldMaterializeAtUse(operand)) {
+  llvm::IRBuilder<>& b = builder == nullptr ? entry_builder() : *builder;
+  if (ShouldMaterializeAtUse(operand) && !IsGlobalLiteral(operand)) {
     // If the operand is a bits constant, just return the constant as an
     // optimization.
     XLS_CHECK(operand->Is<Literal>());
@@ -819,7 +1035,6 @@ llvm::Value* NodeIrContext::LoadOperand(int64_t i, llvm::IRBuilder<>* builder) {
         .ToLlvmConstant(operand->GetType(), operand->As<Literal>()->value())
         .value();
   }
-  llvm::IRBuilder<>& b = builder == nullptr ? entry_builder() : *builder;
   llvm::Type* operand_type =
       type_converter().ConvertToLlvmType(operand->GetType());
   llvm::Value* operand_ptr = GetOperandPtr(i, &b);
@@ -833,6 +1048,12 @@ llvm::Value* NodeIrContext::GetOperandPtr(int64_t i,
   Node* operand = node()->operand(i);
   llvm::IRBuilder<>& b = builder == nullptr ? entry_builder() : *builder;
 
+  if (IsGlobalLiteral(operand)) {
+    return jit_context_.GetOrCreateConstantGlobal(
+        type_converter()
+            .ToLlvmConstant(operand->GetType(), operand->As<Literal>()->value())
+            .value());
+  }
   std::pair<Node*, llvm::BasicBlock*> cache_key = {operand, b.GetInsertBlock()};
   if (ShouldMaterializeAtUse(operand)) {
     if (materialized_cache_.contains(cache_key)) {
@@ -928,8 +1149,10 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
   absl::Status HandleOneHot(OneHot* one_hot) override;
   absl::Status HandleOneHotSel(OneHotSelect* sel) override;
   absl::Status HandleOrReduce(BitwiseReductionOp* op) override;
+  absl::Status HandleOutputPort(OutputPort* output_port) override;
   absl::Status HandlePrioritySel(PrioritySelect* sel) override;
   absl::Status HandleReceive(Receive* recv) override;
+  absl::Status HandleRegisterWrite(RegisterWrite* reg_write) override;
   absl::Status HandleReverse(UnOp* reverse) override;
   absl::Status HandleSDiv(BinOp* binop) override;
   absl::Status HandleSGe(CompareOp* ge) override;
@@ -1031,15 +1254,45 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
       llvm::Value* events, llvm::Value* user_data, llvm::Value* runtime,
       llvm::IRBuilder<>& builder);
 
+  // Returns a pointer to the JitChannelQueue of the given channel. With
+  // relocatable channel queues the pointer is loaded from the queue table
+  // passed in `user_data`, otherwise the address of the queue is a constant.
+  absl::StatusOr<llvm::Value*> GetQueuePtr(llvm::IRBuilder<>* builder,
+                                           Channel* channel,
+                                           llvm::Value* user_data);
+
+  // Returns a callee for the queue access function `relocatable_name` (when
+  // using relocatable channel queues) or at address `address` (otherwise).
+  llvm::FunctionCallee GetQueueFunction(llvm::IRBuilder<>* builder,
+                                        llvm::FunctionType* fn_type,
+                                        std::string_view relocatable_name,
+                                        uint64_t address);
+
+  // Returns the queue of the given channel if it is a ring buffer queue which
+  // the generated code may access inline, or nullptr otherwise.
+  RingBufferJitChannelQueue* GetRingBufferQueue(Channel* channel);
+
+  // Emits an inline read from (write to) the ring buffer of `queue`. These may
+  // add basic blocks and leave `builder` positioned in the block following the
+  // access. ReadFromRingBuffer returns an i1 value indicating whether a value
+  // was read.
+  llvm::Value* ReadFromRingBuffer(llvm::IRBuilder<>* builder,
+                                  RingBufferJitChannelQueue* queue,
+                                  llvm::Value* output_ptr);
+  void WriteToRingBuffer(llvm::IRBuilder<>* builder,
+                         RingBufferJitChannelQueue* queue,
+                         llvm::Value* data_ptr);
+
   // Invokes the receive callback function. The received data is written into
   // the buffer pointer to be `output_ptr`. Returns an i1 value indicating
-  // whether the receive fired.
+  // whether the receive fired. As with ReadFromRingBuffer, `builder` may be
+  // left positioned in a new basic block.
   absl::StatusOr<llvm::Value*> ReceiveFromQueue(llvm::IRBuilder<>* builder,
-                                                JitChannelQueue* queue,
+                                                Channel* channel,
                                                 Receive* receive,
                                                 llvm::Value* output_ptr,
                                                 llvm::Value* user_data);
-  absl::Status SendToQueue(llvm::IRBuilder<>* builder, JitChannelQueue* queue,
+  absl::Status SendToQueue(llvm::IRBuilder<>* builder, Channel* channel,
                            Send* send, llvm::Value* send_data_ptr,
                            llvm::Value* user_data);
 
@@ -1172,36 +1425,37 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
       ctx(), absl::StrCat(trace_name, "_print"), node_context.llvm_function());
   llvm::IRBuilder<> print_builder(print_block);
 
-  XLS_ASSIGN_OR_RETURN(llvm::Value * buffer_ptr,
-                       InvokeCreateBufferCallback(&print_builder));
-
   // Operands are: (tok, pred, ..data_operands..)
   XLS_RET_CHECK_EQ(trace_op->operand(0)->GetType(),
                    trace_op->package()->GetTokenType());
   XLS_RET_CHECK_EQ(trace_op->operand(1)->GetType(),
                    trace_op->package()->GetBitsType(1));
 
-  size_t operand_index = 2;
-  for (const FormatStep& step : trace_op->format()) {
-    if (std::holds_alternative<std::string>(step)) {
-      XLS_RETURN_IF_ERROR(InvokeStringStepCallback(
-          &print_builder, std::get<std::string>(step), buffer_ptr));
-    } else {
-      xls::Node* o = trace_op->operand(operand_index);
-      llvm::Value* operand = node_context.LoadOperand(operand_index);
-      llvm::AllocaInst* alloca = print_builder.CreateAlloca(operand->getType());
-      print_builder.CreateStore(operand, alloca);
-      // The way our format strings are currently formed we implicitly refer to
-      // the next operand after formatting this one.
-      operand_index += 1;
-      XLS_RETURN_IF_ERROR(InvokeFormatStepCallback(
-          &print_builder, std::get<FormatPreference>(step), o->GetType(),
-          alloca, buffer_ptr, jit_runtime_ptr));
+  // Store the data operands consecutively in a single buffer so the trace can
+  // be recorded with one callback. Formatting (if any) happens in the callback.
+  int64_t data_size = 0;
+  for (Node* arg : trace_op->args()) {
+    data_size += type_converter()->GetTypeByteSize(arg->GetType());
+  }
+  llvm::Value* data_ptr =
+      llvm::ConstantPointerNull::get(llvm::PointerType::get(ctx(), 0));
+  if (data_size > 0) {
+    data_ptr = print_builder.CreateAlloca(
+        llvm::ArrayType::get(print_builder.getInt8Ty(), data_size));
+    int64_t offset = 0;
+    for (int64_t i = 0; i < trace_op->args().size(); ++i) {
+      llvm::Value* operand = node_context.LoadOperand(i + 2);
+      llvm::Value* operand_ptr = print_builder.CreateConstGEP1_64(
+          print_builder.getInt8Ty(), data_ptr, offset);
+      print_builder.CreateAlignedStore(operand, operand_ptr, llvm::Align(1));
+      offset +=
+          type_converter()->GetTypeByteSize(trace_op->args()[i]->GetType());
     }
   }
 
-  XLS_RETURN_IF_ERROR(
-      InvokeRecordTraceCallback(&print_builder, buffer_ptr, events_ptr));
+  XLS_RETURN_IF_ERROR(InvokeRecordTraceCallback(&print_builder, trace_op,
+                                                data_ptr, data_size, events_ptr,
+                                                jit_runtime_ptr));
 
   print_builder.CreateBr(after_block);
 
@@ -1317,9 +1571,12 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
   // First, copy the entire array to update (operand 0) to the output buffer.
+  // The buffers are the same if a proc state element is updated in place (see
+  // JittedFunctionBase::in_place_state_indices).
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
-  LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
-             type_converter()->GetTypeByteSize(update->GetType()), b);
+  LlvmMemcpyIfDistinct(output_buffer, node_context.GetOperandPtr(0),
+                       type_converter()->GetTypeByteSize(update->GetType()),
+                       b);
 
   // Determine whether the indices are all inbounds. If any are out of bounds
   // then the array update operation is a NOP. Also, gather the GEP indices for
@@ -1453,6 +1710,23 @@ absl::Status IrBuilderVisitor::HandleBitSliceUpdate(BitSliceUpdate* update) {
                           max_width_type, update->operand(0)->BitCountOrDie()),
                       "start_is_inbounds");
 
+  if (UseWideIntegerHelper(max_width)) {
+    // The start is only used when it is in bounds so it fits in 64 bits.
+    int64_t word_count = WordCount(max_width);
+    llvm::Value* start_word = b.CreateSelect(
+        in_bounds, b.CreateTrunc(start_wide, b.getInt64Ty()), b.getInt64(0));
+    llvm::Value* updated_slice = CallWideIntegerHelper(
+        &WideBitSliceUpdate,
+        {StoreAsWords(to_update_wide, word_count, /*is_signed=*/false, &b),
+         start_word,
+         StoreAsWords(update_value_wide, word_count, /*is_signed=*/false, &b),
+         b.getInt64(update->update_value()->BitCountOrDie())},
+        word_count, llvm::cast<llvm::IntegerType>(result_type), &b);
+    llvm::Value* result =
+        b.CreateSelect(in_bounds, updated_slice, to_update, "result");
+    return FinalizeNodeIrContextWithValue(std::move(node_context), result);
+  }
+
   // Create a mask 00..0011..11 where the number of ones is equal to the
   // width of the update value. Then the updated value is:
   //
@@ -1593,7 +1867,8 @@ absl::Status IrBuilderVisitor::HandleCountedFor(CountedFor* counted_for) {
       counted_for->body()->param(0)->GetType());
   llvm::Value* cast_index = loop.body_builder().CreateIntCast(
       loop.index(), index_type, /*isSigned=*/false);
-  llvm::Value* index_buffer = loop.body_builder().CreateAlloca(index_type);
+  llvm::Value* index_buffer =
+      CreateEntryBlockAlloca(index_type, loop.body_builder());
   loop.body_builder().CreateStore(cast_index, index_buffer);
 
   // Signature of body function is:
@@ -1607,14 +1882,23 @@ absl::Status IrBuilderVisitor::HandleCountedFor(CountedFor* counted_for) {
   input_arg_ptrs.insert(input_arg_ptrs.end(), invariant_arg_buffers.begin(),
                         invariant_arg_buffers.end());
 
-  llvm::Value* next_state_buffer = loop.body_builder().CreateAlloca(state_type);
-  XLS_RETURN_IF_ERROR(CallFunction(body, input_arg_ptrs, {next_state_buffer},
-                                   node_context.GetTempBufferArg(),
-                                   node_context.GetInterpreterEventsArg(),
-                                   node_context.GetUserDataArg(),
-                                   node_context.GetJitRuntimeArg(),
-                                   loop.body_builder())
-                          .status());
+  llvm::Value* next_state_buffer =
+      CreateEntryBlockAlloca(state_type, loop.body_builder());
+  XLS_ASSIGN_OR_RETURN(
+      llvm::Value * call,
+      CallFunction(body, input_arg_ptrs, {next_state_buffer},
+                   node_context.GetTempBufferArg(),
+                   node_context.GetInterpreterEventsArg(),
+                   node_context.GetUserDataArg(),
+                   node_context.GetJitRuntimeArg(), loop.body_builder()));
+  // Small bodies are inlined into the loop. As the state, index and argument
+  // buffers are allocas in the entry block, LLVM then promotes the loop state
+  // to registers (phis in the loop header) and can unroll or vectorize the
+  // loop.
+  if (IsInlinableLoopBody(counted_for->body())) {
+    llvm::cast<llvm::CallInst>(call)->addFnAttr(
+        llvm::Attribute::AlwaysInline);
+  }
   // TODO(meheff): 2022/09/09 Rather than loading the state and storing it in
   // the state buffer for the next iteration, simply swap the state and
   // next-state buffer pointers passed to the loop body function.
@@ -1809,26 +2093,30 @@ absl::Status IrBuilderVisitor::HandleEncode(Encode* encode) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
   llvm::Value* input = node_context.LoadOperand(0);
   llvm::Type* input_type = input->getType();
-  llvm::Value* input_one = llvm::ConstantInt::get(input_type, 1);
+  int64_t input_width = encode->operand(0)->BitCountOrDie();
 
   llvm::Type* result_type =
       type_converter()->ConvertToLlvmType(encode->GetType());
   llvm::Value* result = llvm::ConstantInt::get(result_type, 0);
 
-  llvm::Value* result_zero = llvm::ConstantInt::get(result_type, 0);
-
-  // For each bit in the input, if it's set, bitwise-OR its [numeric] value
-  // with the result.
-  for (int i = 0; i < input_type->getIntegerBitWidth(); ++i) {
+  // Bit j of the result is the OR of the input bits whose index has bit j set,
+  // i.e., whether the input ANDed with a constant mask of those bits is
+  // non-zero. This requires one wide AND and compare per result bit rather than
+  // a select per input bit, and the wide operations map onto vector
+  // instructions where the target has them.
+  for (int64_t j = 0; j < encode->BitCountOrDie(); ++j) {
+    llvm::APInt mask(input_type->getIntegerBitWidth(), 0);
+    for (int64_t i = 0; i < input_width; ++i) {
+      if ((i >> j) & 1) {
+        mask.setBit(i);
+      }
+    }
     llvm::Value* bit_set =
-        b.CreateICmpEQ(b.CreateAnd(input, input_one), input_one);
-
-    // Chained select, i.e., a = (b ? c : (d ? e : (...))), etc.
-    llvm::Value* or_value = b.CreateSelect(
-        bit_set, llvm::ConstantInt::get(result_type, i), result_zero);
-    result = b.CreateOr(result, or_value);
-
-    input = b.CreateLShr(input, input_one);
+        b.CreateICmpNE(b.CreateAnd(input, llvm::ConstantInt::get(input_type,
+                                                                 mask)),
+                       llvm::ConstantInt::get(input_type, 0));
+    result = b.CreateOr(
+        result, b.CreateShl(b.CreateZExt(bit_set, result_type), j));
   }
 
   return FinalizeNodeIrContextWithValue(std::move(node_context), result);
@@ -1916,8 +2204,17 @@ absl::Status IrBuilderVisitor::HandleLiteral(Literal* literal) {
                        NewNodeIrContext(literal, {}));
   Type* xls_type = literal->GetType();
   XLS_ASSIGN_OR_RETURN(
-      llvm::Value * llvm_literal,
+      llvm::Constant * llvm_literal,
       type_converter()->ToLlvmConstant(xls_type, literal->value()));
+  // Large aggregates (e.g., lookup tables) are emitted once per module as
+  // global constants. Their uses read the global directly (see
+  // ShouldMaterializeAtUse) so a node function is only built when the literal
+  // is also an output, in which case it is copied out of the global.
+  if (IsGlobalLiteral(literal)) {
+    return FinalizeNodeIrContextWithPointerToValue(
+        std::move(node_context),
+        jit_context_.GetOrCreateConstantGlobal(llvm_literal));
+  }
   return FinalizeNodeIrContextWithValue(std::move(node_context), llvm_literal);
 }
 
@@ -1949,13 +2246,22 @@ absl::Status IrBuilderVisitor::HandleMap(Map* map) {
 
   // Call map function to compute the output element in situ.
   XLS_ASSIGN_OR_RETURN(llvm::Function * to_apply, GetFunction(map->to_apply()));
-  XLS_RETURN_IF_ERROR(CallFunction(to_apply, {input_element}, {output_element},
-                                   node_context.GetTempBufferArg(),
-                                   node_context.GetInterpreterEventsArg(),
-                                   node_context.GetUserDataArg(),
-                                   node_context.GetJitRuntimeArg(),
-                                   loop.body_builder())
-                          .status());
+  XLS_ASSIGN_OR_RETURN(
+      llvm::Value * call,
+      CallFunction(to_apply, {input_element}, {output_element},
+                   node_context.GetTempBufferArg(),
+                   node_context.GetInterpreterEventsArg(),
+                   node_context.GetUserDataArg(),
+                   node_context.GetJitRuntimeArg(), loop.body_builder()));
+  // A small pure function is inlined into the loop. Its values then live in
+  // registers (a function this small is a single partition so its
+  // intermediate values are allocas rather than temp buffer slots), the
+  // iterations are independent, and LLVM can turn the loop into SIMD code.
+  if (IsInlinableLoopBody(map->to_apply())) {
+    llvm::cast<llvm::CallInst>(call)->addFnAttr(
+        llvm::Attribute::AlwaysInline);
+    loop.EnableVectorization();
+  }
   loop.Finalize();
 
   return FinalizeNodeIrContextWithPointerToValue(
@@ -1966,7 +2272,7 @@ absl::Status IrBuilderVisitor::HandleSMul(ArithOp* mul) {
   return HandleBinaryOpWithOperandConversion(
       mul,
       [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
-        return b.CreateMul(lhs, rhs);
+        return EmitMul(lhs, rhs, &b);
       },
       /*is_signed=*/true);
 }
@@ -1975,7 +2281,7 @@ absl::Status IrBuilderVisitor::HandleUMul(ArithOp* mul) {
   return HandleBinaryOpWithOperandConversion(
       mul,
       [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
-        return b.CreateMul(lhs, rhs);
+        return EmitMul(lhs, rhs, &b);
       },
       /*is_signed=*/false);
 }
@@ -2137,32 +2443,36 @@ absl::Status IrBuilderVisitor::HandleOneHot(OneHot* one_hot) {
 
   llvm::Value* result;
   if (one_hot->operand(0)->GetType()->AsBitsOrDie()->bit_count() > 0) {
-    llvm::Value* zeroes;
+    llvm::Type* result_type =
+        type_converter()->ConvertToLlvmType(one_hot->GetType());
+    llvm::Value* zero_value = llvm::ConstantInt::get(input_type, 0);
+    llvm::Value* eq_zero = b.CreateICmpEQ(input, zero_value);
     if (one_hot->priority() == LsbOrMsb::kLsb) {
-      llvm::Function* cttz = llvm::Intrinsic::getDeclaration(
-          module(), llvm::Intrinsic::cttz, {input_type});
-      // We don't need to pass user data to these intrinsics; they're leaf
-      // nodes.
-      zeroes = b.CreateCall(cttz, {input, llvm_false});
+      // The lowest set bit is isolated by x & -x which avoids a count and a
+      // variable shift (and is a single BLSI instruction on targets with
+      // BMI1). If the input is zero, then set the special high bit.
+      llvm::Value* lowest_bit =
+          b.CreateZExt(b.CreateAnd(input, b.CreateNeg(input)), result_type);
+      llvm::Value* high_bit = b.CreateShl(
+          b.CreateZExt(eq_zero, result_type),
+          one_hot->operand(0)->GetType()->GetFlatBitCount());
+      result = b.CreateOr(lowest_bit, high_bit);
     } else {
       llvm::Function* ctlz = llvm::Intrinsic::getDeclaration(
           module(), llvm::Intrinsic::ctlz, {input_type});
-      zeroes = b.CreateCall(ctlz, {input, llvm_false});
+      // We don't need to pass user data to these intrinsics; they're leaf
+      // nodes.
+      llvm::Value* zeroes = b.CreateCall(ctlz, {input, llvm_false});
       zeroes = b.CreateSub(llvm::ConstantInt::get(input_type, input_width - 1),
                            zeroes);
-    }
-
-    // If the input is zero, then return the special high-bit value.
-    llvm::Value* zero_value = llvm::ConstantInt::get(input_type, 0);
-    llvm::Value* width_value = llvm::ConstantInt::get(
-        input_type, one_hot->operand(0)->GetType()->GetFlatBitCount());
-    llvm::Value* eq_zero = b.CreateICmpEQ(input, zero_value);
-    llvm::Value* shift_amount = b.CreateSelect(eq_zero, width_value, zeroes);
 
-    llvm::Type* result_type =
-        type_converter()->ConvertToLlvmType(one_hot->GetType());
-    result = b.CreateShl(llvm::ConstantInt::get(result_type, 1),
-                         b.CreateZExt(shift_amount, result_type));
+      // If the input is zero, then return the special high-bit value.
+      llvm::Value* width_value = llvm::ConstantInt::get(
+          input_type, one_hot->operand(0)->GetType()->GetFlatBitCount());
+      llvm::Value* shift_amount = b.CreateSelect(eq_zero, width_value, zeroes);
+      result = b.CreateShl(llvm::ConstantInt::get(result_type, 1),
+                           b.CreateZExt(shift_amount, result_type));
+    }
   } else {
     result = llvm_true;
   }
@@ -2331,6 +2641,17 @@ absl::Status IrBuilderVisitor::HandleOrReduce(BitwiseReductionOp* op) {
   });
 }
 
+absl::Status IrBuilderVisitor::HandleOutputPort(OutputPort* output_port) {
+  // The value driven on the port is an output of the jitted block function so
+  // the port itself performs no computation.
+  XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
+                       NewNodeIrContext(output_port, {"operand"}));
+  XLS_ASSIGN_OR_RETURN(llvm::Value * empty_tuple,
+                       type_converter()->ToLlvmConstant(
+                           output_port->GetType(), Value::Tuple({})));
+  return FinalizeNodeIrContextWithValue(std::move(node_context), empty_tuple);
+}
+
 absl::Status IrBuilderVisitor::HandleReverse(UnOp* reverse) {
   return HandleUnaryOp(
       reverse, [&](llvm::Value* operand, llvm::IRBuilder<>& b) {
@@ -2687,7 +3008,8 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::CallFunction(
     llvm::IRBuilder<>& builder) {
   llvm::Type* input_pointer_array_type =
       llvm::ArrayType::get(llvm::PointerType::get(ctx(), 0), inputs.size());
-  llvm::Value* input_arg_array = builder.CreateAlloca(input_pointer_array_type);
+  llvm::Value* input_arg_array =
+      CreateEntryBlockAlloca(input_pointer_array_type, builder);
   input_arg_array->setName("input_arg_array");
   for (int64_t i = 0; i < inputs.size(); ++i) {
     llvm::Value* input_buffer = inputs[i];
@@ -2703,7 +3025,7 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::CallFunction(
   llvm::Type* output_pointer_array_type =
       llvm::ArrayType::get(llvm::PointerType::get(ctx(), 0), outputs.size());
   llvm::Value* output_arg_array =
-      builder.CreateAlloca(output_pointer_array_type);
+      CreateEntryBlockAlloca(output_pointer_array_type, builder);
   output_arg_array->setName("output_arg_array");
   for (int64_t i = 0; i < outputs.size(); ++i) {
     llvm::Value* output_buffer = outputs[i];
@@ -2726,13 +3048,183 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::CallFunction(
   return builder.CreateCall(f, args);
 }
 
-bool QueueReceiveWrapper(JitChannelQueue* queue, uint8_t* buffer) {
-  return queue->ReadRaw(buffer);
+absl::StatusOr<llvm::Value*> IrBuilderVisitor::GetQueuePtr(
+    llvm::IRBuilder<>* builder, Channel* channel, llvm::Value* user_data) {
+  llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
+  if (jit_context_.relocatable_channel_queues()) {
+    llvm::Value* table_entry = builder->CreateGEP(
+        ptr_type, user_data,
+        {llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()), channel->id())});
+    return builder->CreateLoad(ptr_type, table_entry,
+                               absl::StrCat(channel->name(), "_queue"));
+  }
+  XLS_RET_CHECK(jit_context_.queue_manager().has_value());
+  JitChannelQueue* queue =
+      &jit_context_.queue_manager().value()->GetJitQueue(channel);
+  llvm::Value* queue_address = llvm::ConstantInt::get(
+      llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
+  return builder->CreateIntToPtr(queue_address, ptr_type);
+}
+
+llvm::FunctionCallee IrBuilderVisitor::GetQueueFunction(
+    llvm::IRBuilder<>* builder, llvm::FunctionType* fn_type,
+    std::string_view relocatable_name, uint64_t address) {
+  if (jit_context_.relocatable_channel_queues()) {
+    return jit_context_.module()->getOrInsertFunction(relocatable_name,
+                                                      fn_type);
+  }
+  llvm::ConstantInt* fn_addr =
+      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()), address);
+  llvm::Value* fn_ptr =
+      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
+  return llvm::FunctionCallee(fn_type, fn_ptr);
+}
+
+RingBufferJitChannelQueue* IrBuilderVisitor::GetRingBufferQueue(
+    Channel* channel) {
+  if (jit_context_.relocatable_channel_queues() ||
+      !jit_context_.queue_manager().has_value()) {
+    return nullptr;
+  }
+  return dynamic_cast<RingBufferJitChannelQueue*>(
+      &jit_context_.queue_manager().value()->GetJitQueue(channel));
+}
+
+// The LLVM type of RingBufferJitChannelQueue::RingBuffer.
+llvm::StructType* GetRingBufferType(llvm::LLVMContext& context) {
+  static_assert(offsetof(RingBufferJitChannelQueue::RingBuffer, data) == 0);
+  static_assert(offsetof(RingBufferJitChannelQueue::RingBuffer, capacity) ==
+                8);
+  static_assert(offsetof(RingBufferJitChannelQueue::RingBuffer, read_index) ==
+                16);
+  static_assert(offsetof(RingBufferJitChannelQueue::RingBuffer, size) == 24);
+  llvm::Type* i64_type = llvm::Type::getInt64Ty(context);
+  return llvm::StructType::get(
+      context,
+      {llvm::PointerType::get(context, 0), i64_type, i64_type, i64_type});
+}
+
+llvm::Value* IrBuilderVisitor::ReadFromRingBuffer(
+    llvm::IRBuilder<>* builder, RingBufferJitChannelQueue* queue,
+    llvm::Value* output_ptr) {
+  llvm::StructType* ring_type = GetRingBufferType(ctx());
+  llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
+  llvm::Type* i64_type = builder->getInt64Ty();
+  llvm::Value* ring = builder->CreateIntToPtr(
+      builder->getInt64(absl::bit_cast<uint64_t>(queue->ring_buffer())),
+      ptr_type);
+  llvm::Value* size_ptr = builder->CreateStructGEP(ring_type, ring, 3);
+  llvm::Value* size = builder->CreateLoad(i64_type, size_ptr, "size");
+
+  llvm::Function* function = builder->GetInsertBlock()->getParent();
+  llvm::BasicBlock* check_block = builder->GetInsertBlock();
+  llvm::BasicBlock* read_block =
+      llvm::BasicBlock::Create(ctx(), "ring_read", function);
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(ctx(), "ring_read_exit", function);
+  builder->CreateCondBr(builder->CreateICmpNE(size, builder->getInt64(0)),
+                        read_block, exit_block);
+
+  // Copy the element at the head of the queue and advance the read index.
+  llvm::IRBuilder<> read_builder(read_block);
+  llvm::Value* data = read_builder.CreateLoad(
+      ptr_type, read_builder.CreateStructGEP(ring_type, ring, 0), "data");
+  llvm::Value* capacity = read_builder.CreateLoad(
+      i64_type, read_builder.CreateStructGEP(ring_type, ring, 1), "capacity");
+  llvm::Value* read_index_ptr = read_builder.CreateStructGEP(ring_type, ring, 2);
+  llvm::Value* read_index =
+      read_builder.CreateLoad(i64_type, read_index_ptr, "read_index");
+  llvm::Value* slot_ptr = read_builder.CreateGEP(
+      read_builder.getInt8Ty(), data,
+      read_builder.CreateMul(read_index,
+                             read_builder.getInt64(queue->slot_size())));
+  LlvmMemcpy(output_ptr, slot_ptr, queue->element_size(), read_builder);
+  read_builder.CreateStore(
+      read_builder.CreateAnd(
+          read_builder.CreateAdd(read_index, read_builder.getInt64(1)),
+          read_builder.CreateSub(capacity, read_builder.getInt64(1))),
+      read_index_ptr);
+  read_builder.CreateStore(
+      read_builder.CreateSub(size, read_builder.getInt64(1)), size_ptr);
+  read_builder.CreateBr(exit_block);
+
+  builder->SetInsertPoint(exit_block);
+  llvm::PHINode* read_fired =
+      builder->CreatePHI(builder->getInt1Ty(), /*NumReservedValues=*/2);
+  read_fired->addIncoming(builder->getTrue(), read_block);
+  read_fired->addIncoming(builder->getFalse(), check_block);
+  return read_fired;
+}
+
+void IrBuilderVisitor::WriteToRingBuffer(llvm::IRBuilder<>* builder,
+                                         RingBufferJitChannelQueue* queue,
+                                         llvm::Value* data_ptr) {
+  llvm::StructType* ring_type = GetRingBufferType(ctx());
+  llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
+  llvm::Type* i64_type = builder->getInt64Ty();
+  llvm::Value* ring = builder->CreateIntToPtr(
+      builder->getInt64(absl::bit_cast<uint64_t>(queue->ring_buffer())),
+      ptr_type);
+  llvm::Value* capacity = builder->CreateLoad(
+      i64_type, builder->CreateStructGEP(ring_type, ring, 1), "capacity");
+  llvm::Value* size_ptr = builder->CreateStructGEP(ring_type, ring, 3);
+  llvm::Value* size = builder->CreateLoad(i64_type, size_ptr, "size");
+
+  llvm::Function* function = builder->GetInsertBlock()->getParent();
+  llvm::BasicBlock* write_block =
+      llvm::BasicBlock::Create(ctx(), "ring_write", function);
+  llvm::BasicBlock* grow_block =
+      llvm::BasicBlock::Create(ctx(), "ring_grow", function);
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(ctx(), "ring_write_exit", function);
+  builder->CreateCondBr(builder->CreateICmpULT(size, capacity), write_block,
+                        grow_block);
+
+  // Copy the data into the slot following the tail of the queue.
+  llvm::IRBuilder<> write_builder(write_block);
+  llvm::Value* data = write_builder.CreateLoad(
+      ptr_type, write_builder.CreateStructGEP(ring_type, ring, 0), "data");
+  llvm::Value* read_index = write_builder.CreateLoad(
+      i64_type, write_builder.CreateStructGEP(ring_type, ring, 2),
+      "read_index");
+  llvm::Value* write_index = write_builder.CreateAnd(
+      write_builder.CreateAdd(read_index, size),
+      write_builder.CreateSub(capacity, write_builder.getInt64(1)));
+  llvm::Value* slot_ptr = write_builder.CreateGEP(
+      write_builder.getInt8Ty(), data,
+      write_builder.CreateMul(write_index,
+                              write_builder.getInt64(queue->slot_size())));
+  LlvmMemcpy(slot_ptr, data_ptr, queue->element_size(), write_builder);
+  write_builder.CreateStore(
+      write_builder.CreateAdd(size, write_builder.getInt64(1)), size_ptr);
+  write_builder.CreateBr(exit_block);
+
+  // The ring buffer is full. The queue grows the buffer in WriteRaw.
+  llvm::IRBuilder<> grow_builder(grow_block);
+  llvm::FunctionType* fn_type =
+      llvm::FunctionType::get(grow_builder.getVoidTy(), {ptr_type, ptr_type},
+                              /*isVarArg=*/false);
+  llvm::Value* fn_ptr = grow_builder.CreateIntToPtr(
+      grow_builder.getInt64(
+          absl::bit_cast<uint64_t>(&xls_jit_channel_queue_write_raw)),
+      llvm::PointerType::get(fn_type, 0));
+  llvm::Value* queue_ptr = grow_builder.CreateIntToPtr(
+      grow_builder.getInt64(
+          absl::bit_cast<uint64_t>(static_cast<JitChannelQueue*>(queue))),
+      ptr_type);
+  grow_builder.CreateCall(fn_type, fn_ptr, {queue_ptr, data_ptr});
+  grow_builder.CreateBr(exit_block);
+
+  builder->SetInsertPoint(exit_block);
 }
 
 absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
-    llvm::IRBuilder<>* builder, JitChannelQueue* queue, Receive* receive,
+    llvm::IRBuilder<>* builder, Channel* channel, Receive* receive,
     llvm::Value* output_ptr, llvm::Value* user_data) {
+  if (RingBufferJitChannelQueue* queue = GetRingBufferQueue(channel)) {
+    return ReadFromRingBuffer(builder, queue, output_ptr);
+  }
+
   llvm::Type* bool_type = llvm::Type::getInt1Ty(ctx());
   llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
 
@@ -2743,17 +3235,14 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
       llvm::FunctionType::get(bool_type, params, /*isVarArg=*/false);
 
   // Call the wrapper to JitChannelQueue::Recv.
-  llvm::Value* queue_address = llvm::ConstantInt::get(
-      llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
-  std::vector<llvm::Value*> args = {
-      builder->CreateIntToPtr(queue_address, ptr_type), output_ptr};
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
-                             absl::bit_cast<uint64_t>(&QueueReceiveWrapper));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  llvm::Value* receive_fired = builder->CreateCall(fn_type, fn_ptr, args);
+  XLS_ASSIGN_OR_RETURN(llvm::Value * queue_ptr,
+                       GetQueuePtr(builder, channel, user_data));
+  std::vector<llvm::Value*> args = {queue_ptr, output_ptr};
+
+  llvm::FunctionCallee fn = GetQueueFunction(
+      builder, fn_type, "xls_jit_channel_queue_read_raw",
+      absl::bit_cast<uint64_t>(&xls_jit_channel_queue_read_raw));
+  llvm::Value* receive_fired = builder->CreateCall(fn, args);
   return receive_fired;
 }
 
@@ -2767,11 +3256,8 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
                                         /*include_wrapper_args=*/true));
   llvm::Value* user_data = node_context.GetUserDataArg();
 
-  XLS_RET_CHECK(jit_context_.queue_manager().has_value());
   XLS_ASSIGN_OR_RETURN(Channel * channel,
                        recv->package()->GetChannel(recv->channel_id()));
-  JitChannelQueue& queue =
-      jit_context_.queue_manager().value()->GetJitQueue(channel);
 
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
   // The data buffer is element 1 of the output tuple.
@@ -2798,7 +3284,9 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
     llvm::IRBuilder<> true_builder(true_block);
     XLS_ASSIGN_OR_RETURN(
         llvm::Value * true_receive_fired,
-        ReceiveFromQueue(&true_builder, &queue, recv, data_buffer, user_data));
+        ReceiveFromQueue(&true_builder, channel, recv, data_buffer, user_data));
+    // The receive may have added blocks after `true_block`.
+    llvm::BasicBlock* true_exit_block = true_builder.GetInsertBlock();
     true_builder.CreateBr(join_block);
 
     // And the same for a false predicate - this will store a zero
@@ -2822,7 +3310,7 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
 
     llvm::PHINode* receive_fired = join_builder.CreatePHI(
         llvm::Type::getInt1Ty(ctx()), /*NumReservedValues=*/2);
-    receive_fired->addIncoming(true_receive_fired, true_block);
+    receive_fired->addIncoming(true_receive_fired, true_exit_block);
     receive_fired->addIncoming(llvm::ConstantInt::getFalse(ctx()), false_block);
     receive_fired->setName("receive_fired");
     if (!recv->is_blocking()) {
@@ -2843,7 +3331,7 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
             : join_builder.getFalse());
   }
   XLS_ASSIGN_OR_RETURN(llvm::Value * receive_fired,
-                       ReceiveFromQueue(&node_context.entry_builder(), &queue,
+                       ReceiveFromQueue(&node_context.entry_builder(), channel,
                                         recv, data_buffer, user_data));
   receive_fired->setName("receive_fired");
   if (!recv->is_blocking()) {
@@ -2865,14 +3353,34 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
           : node_context.entry_builder().getFalse());
 }
 
-void QueueSendWrapper(JitChannelQueue* queue, const uint8_t* data) {
-  queue->WriteRaw(data);
+absl::Status IrBuilderVisitor::HandleRegisterWrite(RegisterWrite* reg_write) {
+  // The operands of the register write are outputs of the jitted block
+  // function. The register update itself is performed by the wrapper around
+  // the jitted block function.
+  std::vector<std::string> operand_names = {"data"};
+  if (reg_write->load_enable().has_value()) {
+    operand_names.push_back("load_enable");
+  }
+  if (reg_write->reset().has_value()) {
+    operand_names.push_back("reset");
+  }
+  XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
+                       NewNodeIrContext(reg_write, operand_names));
+  XLS_ASSIGN_OR_RETURN(llvm::Value * empty_tuple,
+                       type_converter()->ToLlvmConstant(reg_write->GetType(),
+                                                        Value::Tuple({})));
+  return FinalizeNodeIrContextWithValue(std::move(node_context), empty_tuple);
 }
 
 absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
-                                           JitChannelQueue* queue, Send* send,
+                                           Channel* channel, Send* send,
                                            llvm::Value* send_data_ptr,
                                            llvm::Value* user_data) {
+  if (RingBufferJitChannelQueue* queue = GetRingBufferQueue(channel)) {
+    WriteToRingBuffer(builder, queue, send_data_ptr);
+    return absl::OkStatus();
+  }
+
   llvm::Type* void_type = llvm::Type::getVoidTy(ctx());
   llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
 
@@ -2882,17 +3390,14 @@ absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
   llvm::FunctionType* fn_type =
       llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
 
-  llvm::Value* queue_address = llvm::ConstantInt::get(
-      llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
-  std::vector<llvm::Value*> args = {
-      builder->CreateIntToPtr(queue_address, ptr_type), send_data_ptr};
+  XLS_ASSIGN_OR_RETURN(llvm::Value * queue_ptr,
+                       GetQueuePtr(builder, channel, user_data));
+  std::vector<llvm::Value*> args = {queue_ptr, send_data_ptr};
 
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
-                             absl::bit_cast<uint64_t>(&QueueSendWrapper));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
+  llvm::FunctionCallee fn = GetQueueFunction(
+      builder, fn_type, "xls_jit_channel_queue_write_raw",
+      absl::bit_cast<uint64_t>(&xls_jit_channel_queue_write_raw));
+  builder->CreateCall(fn, args);
   return absl::OkStatus();
 }
 
@@ -2908,11 +3413,8 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
   llvm::Value* data_ptr = node_context.GetOperandPtr(1);
   llvm::Value* user_data = node_context.GetUserDataArg();
 
-  XLS_RET_CHECK(jit_context_.queue_manager().has_value());
   XLS_ASSIGN_OR_RETURN(Channel * channel,
                        send->package()->GetChannel(send->channel_id()));
-  JitChannelQueue& queue =
-      jit_context_.queue_manager().value()->GetJitQueue(channel);
   if (send->predicate().has_value()) {
     llvm::Value* predicate = node_context.LoadOperand(2);
 
@@ -2926,7 +3428,7 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
                                  node_context.llvm_function(), join_block);
     llvm::IRBuilder<> true_builder(true_block);
     XLS_RETURN_IF_ERROR(
-        SendToQueue(&true_builder, &queue, send, data_ptr, user_data));
+        SendToQueue(&true_builder, channel, send, data_ptr, user_data));
     true_builder.CreateBr(join_block);
 
     llvm::BasicBlock* false_block =
@@ -2943,7 +3445,7 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
                                           exit_builder.get());
   }
   // Unconditional send.
-  XLS_RETURN_IF_ERROR(SendToQueue(&b, &queue, send, data_ptr, user_data));
+  XLS_RETURN_IF_ERROR(SendToQueue(&b, channel, send, data_ptr, user_data));
 
   return FinalizeNodeIrContextWithValue(std::move(node_context),
                                         type_converter()->GetToken());
@@ -2957,6 +3459,15 @@ llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                               llvm::MaybeAlign(1), size);
 }
 
+llvm::Value* LlvmMemcpyIfDistinct(llvm::Value* tgt, llvm::Value* src,
+                                  int64_t size, llvm::IRBuilder<>& builder) {
+  llvm::Value* copy_size =
+      builder.CreateSelect(builder.CreateICmpEQ(tgt, src), builder.getInt64(0),
+                           builder.getInt64(size));
+  return builder.CreateMemCpy(tgt, llvm::MaybeAlign(1), src,
+                              llvm::MaybeAlign(1), copy_size);
+}
+
 absl::StatusOr<NodeFunction> CreateNodeFunction(
     Node* node, int64_t output_arg_count, JitBuilderContext& jit_context) {
   IrBuilderVisitor visitor(output_arg_count, jit_context);
@@ -14,33 +14,49 @@
 #ifndef XLS_JIT_IR_BUILDER_VISITOR_H_
 #define XLS_JIT_IR_BUILDER_VISITOR_H_
 
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "llvm/include/llvm/IR/Constant.h"
 #include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/GlobalVariable.h"
 #include "xls/ir/node.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
 
 // Returns whether the given node should be materialized at is uses rather than
 // being written to a buffer to pass to the JITted node function. Only possible
-// for nodes whose value is known at compile time (e.g., Literals).
+// for nodes whose value is known at compile time (e.g., Literals). Large
+// array and tuple literals are read from global constants at their uses.
 bool ShouldMaterializeAtUse(Node* node);
 
 // An object gathering necessary information for jitting XLS functions, procs,
-// etc.
+// etc. If `profile` is non-null, the generated code is instrumented to update
+// the counters in `profile`.
 class JitBuilderContext {
  public:
+  // If `relocatable_channel_queues` is true then no queue manager is needed
+  // and the generated code bakes in no queue addresses. Instead the `user_data`
+  // argument of the jitted function points to an array of JitChannelQueue*
+  // indexed by channel id, and queues are accessed by calling the C-linkage
+  // functions declared in jit_channel_queue.h by name.
   JitBuilderContext(
       OrcJit& orc_jit,
-      std::optional<JitChannelQueueManager*> queue_mgr = std::nullopt)
+      std::optional<JitChannelQueueManager*> queue_mgr = std::nullopt,
+      JitProfile* profile = nullptr, bool relocatable_channel_queues = false)
       : module_(orc_jit.NewModule("__module")),
         orc_jit_(orc_jit),
         type_converter_(orc_jit.GetContext(),
                         orc_jit.CreateDataLayout().value()),
-        queue_manager_(queue_mgr) {}
+        queue_manager_(queue_mgr),
+        profile_(profile),
+        relocatable_channel_queues_(relocatable_channel_queues) {}
 
   llvm::Module* module() const { return module_.get(); }
   llvm::LLVMContext& context() const { return module_->getContext(); }
@@ -50,9 +66,54 @@ class JitBuilderContext {
   // Destructively returns the underlying llvm::Module.
   std::unique_ptr<llvm::Module> ConsumeModule() { return std::move(module_); }
 
-  // Returns the llvm::Function implementing the given FunctionBase.
-  llvm::Function* GetLlvmFunction(FunctionBase* xls_fn) const {
-    return llvm_functions_.at(xls_fn);
+  // Replaces the (previously consumed) underlying module with a new empty
+  // module of the given name. Functions built in earlier modules remain
+  // available through GetLlvmFunction as external declarations.
+  void StartNewModule(std::string_view name) {
+    for (const auto& [xls_fn, llvm_fn] : llvm_functions_) {
+      external_functions_[xls_fn] = {llvm_fn->getName().str(),
+                                     llvm_fn->getFunctionType()};
+    }
+    llvm_functions_.clear();
+    constant_globals_.clear();
+    module_ = orc_jit_.NewModule(name);
+  }
+
+  // Returns a private constant global variable in the current module holding
+  // `constant`. LLVM uniques constants so all uses of equal constants within
+  // the module share one global.
+  llvm::GlobalVariable* GetOrCreateConstantGlobal(llvm::Constant* constant) {
+    auto [it, inserted] = constant_globals_.insert({constant, nullptr});
+    if (inserted) {
+      it->second = new llvm::GlobalVariable(
+          *module_, constant->getType(), /*isConstant=*/true,
+          llvm::GlobalValue::PrivateLinkage, constant, "const");
+      it->second->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    }
+    return it->second;
+  }
+
+  // Returns the llvm::Function implementing the given FunctionBase. If the
+  // function was built in an earlier module a declaration of it is added to
+  // the current module.
+  llvm::Function* GetLlvmFunction(FunctionBase* xls_fn) {
+    auto it = llvm_functions_.find(xls_fn);
+    if (it != llvm_functions_.end()) {
+      return it->second;
+    }
+    const ExternalFunction& external = external_functions_.at(xls_fn);
+    llvm::Function* declaration = llvm::cast<llvm::Function>(
+        module_->getOrInsertFunction(external.name, external.type)
+            .getCallee());
+    llvm_functions_[xls_fn] = declaration;
+    return declaration;
+  }
+
+  // Returns whether an llvm::Function implementing the given FunctionBase has
+  // been built in this or an earlier module.
+  bool HasLlvmFunction(FunctionBase* xls_fn) const {
+    return llvm_functions_.contains(xls_fn) ||
+           external_functions_.contains(xls_fn);
   }
 
   // Sets the llvm::Function implementing the given FunctionBase to
@@ -65,14 +126,53 @@ class JitBuilderContext {
     return queue_manager_;
   }
 
+  // Returns the profile to instrument the generated code for or nullptr if
+  // profiling is disabled.
+  JitProfile* profile() const { return profile_; }
+
+  bool relocatable_channel_queues() const {
+    return relocatable_channel_queues_;
+  }
+
+  // Suffix appended to the names of the externally visible llvm::Functions
+  // built with this context. Builds which share an OrcJit use distinct
+  // suffixes so their symbols do not collide in the JIT's dylib.
+  const std::string& symbol_suffix() const { return symbol_suffix_; }
+  void set_symbol_suffix(std::string_view suffix) {
+    symbol_suffix_ = std::string{suffix};
+  }
+
+  // Records that `xls_fn` is implemented by the already compiled function
+  // `name` of the given type in the JIT's dylib. Calls to `xls_fn` are
+  // emitted as calls to a declaration of that function.
+  void AddExternalFunction(FunctionBase* xls_fn, std::string_view name,
+                           llvm::FunctionType* type) {
+    external_functions_[xls_fn] = {std::string{name}, type};
+  }
+
  private:
   std::unique_ptr<llvm::Module> module_;
   OrcJit& orc_jit_;
   LlvmTypeConverter type_converter_;
   std::optional<JitChannelQueueManager*> queue_manager_;
+  JitProfile* profile_;
+  bool relocatable_channel_queues_;
+  std::string symbol_suffix_;
 
-  // Map from FunctionBase to the associated JITed llvm::Function.
+  // Map from FunctionBase to the associated JITed llvm::Function in the
+  // current module.
   absl::flat_hash_map<FunctionBase*, llvm::Function*> llvm_functions_;
+
+  // Functions defined in previously consumed modules.
+  struct ExternalFunction {
+    std::string name;
+    llvm::FunctionType* type;
+  };
+  absl::flat_hash_map<FunctionBase*, ExternalFunction> external_functions_;
+
+  // Constant globals in the current module (see GetOrCreateConstantGlobal).
+  absl::flat_hash_map<llvm::Constant*, llvm::GlobalVariable*>
+      constant_globals_;
 };
 
 // Abstraction representing an llvm::Function implementing an xls::Node. The
@@ -125,6 +225,10 @@ absl::StatusOr<NodeFunction> CreateNodeFunction(Node* node,
 llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                         llvm::IRBuilder<>& builder);
 
+// As LlvmMemcpy but nothing is copied if `tgt` and `src` are the same buffer.
+llvm::Value* LlvmMemcpyIfDistinct(llvm::Value* tgt, llvm::Value* src,
+                                  int64_t size, llvm::IRBuilder<>& builder);
+
 }  // namespace xls
 
 #endif  // XLS_JIT_IR_BUILDER_VISITOR_H_
@@ -14,8 +14,11 @@
 
 #include "xls/jit/jit_channel_queue.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
 
 namespace xls {
 namespace {
@@ -37,43 +40,49 @@ std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
   return runtime.UnpackBuffer(buffer.data(), type, /*unpoision=*/true);
 }
 
+// Returns the set of streaming send-receive channels in `package` which have
+// exactly one sending proc and exactly one receiving proc.
+absl::flat_hash_set<Channel*> GetSingleProducerSingleConsumerChannels(
+    Package* package) {
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<Proc*>> senders;
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<Proc*>> receivers;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    for (Node* node : proc->nodes()) {
+      if (node->Is<Send>()) {
+        senders[node->As<Send>()->channel_id()].insert(proc.get());
+      } else if (node->Is<Receive>()) {
+        receivers[node->As<Receive>()->channel_id()].insert(proc.get());
+      }
+    }
+  }
+  absl::flat_hash_set<Channel*> result;
+  for (Channel* channel : package->channels()) {
+    if (channel->kind() != ChannelKind::kStreaming ||
+        channel->supported_ops() != ChannelOps::kSendReceive) {
+      continue;
+    }
+    auto sender_it = senders.find(channel->id());
+    auto receiver_it = receivers.find(channel->id());
+    if (sender_it != senders.end() && sender_it->second.size() == 1 &&
+        receiver_it != receivers.end() && receiver_it->second.size() == 1) {
+      result.insert(channel);
+    }
+  }
+  return result;
+}
+
 }  // namespace
 
-ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
-    : channel_element_size_(channel_element_size),
-      allocated_element_size_(
-          RoundUpToNearest(channel_element_size,
-                           static_cast<int64_t>(alignof(std::max_align_t)))),
-      is_single_value_(is_single_value) {
-  // Align the vector allocation to a power of 2 for efficient utilization
-  // of the memory.
-  int64_t element_size_2 = 1 << CeilOfLog2(allocated_element_size_);
-  if (element_size_2 > kInitBufferSize) {
-    circular_buffer_.resize(element_size_2);
-  } else {
-    circular_buffer_.resize(kInitBufferSize);
-  }
-  max_byte_count_ = FloorOfRatio(static_cast<int64_t>(circular_buffer_.size()),
-                                 allocated_element_size_) *
-                    allocated_element_size_;
-}
-
-void ByteQueue::Resize() {
-  circular_buffer_.resize(circular_buffer_.size() * 2);
-  max_byte_count_ = FloorOfRatio(static_cast<int64_t>(circular_buffer_.size()),
-                                 allocated_element_size_) *
-                    allocated_element_size_;
-  // The content of the circular buffer must be rearranged when the read
-  // index is not at the beginning of the circular buffer to ensure correct
-  // ordering.
-  if (read_index_ != 0) {
-    std::move(circular_buffer_.begin(), circular_buffer_.begin() + read_index_,
-              circular_buffer_.begin() + bytes_used_);
-  }
-  // Realign the write index to the next available slot.
-  write_index_ = bytes_used_ + read_index_;
-  if (write_index_ == max_byte_count_) {
-    write_index_ = 0;
+void ThreadSafeJitChannelQueue::GenerateValues(int64_t count) {
+  if (!generator_.has_value()) {
+    return;
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    std::optional<Value> generated_value = (*generator_)();
+    if (!generated_value.has_value()) {
+      return;
+    }
+    WriteInternal(generated_value.value());
   }
 }
 
@@ -89,6 +98,20 @@ std::optional<Value> ThreadSafeJitChannelQueue::ReadInternal() {
   return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
 }
 
+int64_t ThreadUnsafeJitChannelQueue::ReadRawBatch(uint8_t* buffer,
+                                                  int64_t max_count) {
+  if (generator_.has_value()) {
+    for (int64_t i = 0; i < max_count; ++i) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (!generated_value.has_value()) {
+        break;
+      }
+      WriteInternal(generated_value.value());
+    }
+  }
+  return byte_queue_.ReadBatch(buffer, max_count);
+}
+
 int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
@@ -101,13 +124,277 @@ std::optional<Value> ThreadUnsafeJitChannelQueue::ReadInternal() {
   return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
 }
 
+LockFreeSpscJitChannelQueue::LockFreeSpscJitChannelQueue(
+    Channel* channel, JitRuntime* jit_runtime, int64_t segment_capacity)
+    : JitChannelQueue(channel, jit_runtime),
+      element_size_(jit_runtime->GetTypeByteSize(channel->type())),
+      allocated_element_size_(std::max(element_size_, int64_t{1})),
+      segment_capacity_(segment_capacity) {
+  XLS_CHECK_EQ(channel->kind(), ChannelKind::kStreaming);
+  XLS_CHECK_GT(segment_capacity_, 0);
+  tail_ = new Segment(segment_capacity_ * allocated_element_size_);
+  head_ = tail_;
+}
+
+LockFreeSpscJitChannelQueue::~LockFreeSpscJitChannelQueue() {
+  Segment* segment = head_;
+  while (segment != nullptr) {
+    Segment* next = segment->next.load(std::memory_order_relaxed);
+    delete segment;
+    segment = next;
+  }
+  delete spare_segment_.load(std::memory_order_relaxed);
+}
+
+LockFreeSpscJitChannelQueue::Segment*
+LockFreeSpscJitChannelQueue::AcquireSegment() {
+  Segment* segment =
+      spare_segment_.exchange(nullptr, std::memory_order_acq_rel);
+  if (segment == nullptr) {
+    segment = new Segment(segment_capacity_ * allocated_element_size_);
+  }
+  return segment;
+}
+
+void LockFreeSpscJitChannelQueue::RetireSegment(Segment* segment) {
+  segment->next.store(nullptr, std::memory_order_relaxed);
+  delete spare_segment_.exchange(segment, std::memory_order_acq_rel);
+}
+
+void LockFreeSpscJitChannelQueue::WriteRaw(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+  __msan_unpoison(data, element_size_);
+#endif
+  int64_t count = write_count_.load(std::memory_order_relaxed);
+  Push(data, count);
+  write_count_.store(count + 1, std::memory_order_release);
+}
+
+void LockFreeSpscJitChannelQueue::WriteRawBatch(const uint8_t* data,
+                                                int64_t count) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+  __msan_unpoison(data, count * element_size_);
+#endif
+  int64_t write_count = write_count_.load(std::memory_order_relaxed);
+  for (int64_t i = 0; i < count; ++i) {
+    Push(data + i * element_size_, write_count + i);
+  }
+  write_count_.store(write_count + count, std::memory_order_release);
+}
+
+int64_t LockFreeSpscJitChannelQueue::ReadRawBatch(uint8_t* buffer,
+                                                  int64_t max_count) {
+  if (generator_.has_value()) {
+    for (int64_t i = 0; i < max_count; ++i) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (!generated_value.has_value()) {
+        break;
+      }
+      WriteInternal(generated_value.value());
+    }
+  }
+  int64_t read_count = 0;
+  while (read_count < max_count &&
+         Pop(buffer + read_count * element_size_)) {
+    ++read_count;
+  }
+  return read_count;
+}
+
+void LockFreeSpscJitChannelQueue::Push(const uint8_t* data, int64_t index) {
+  int64_t slot = index % segment_capacity_;
+  if (slot == 0 && index != 0) {
+    // The current segment is full. Link in a new segment. The consumer will
+    // observe the link before observing the element written to it.
+    Segment* segment = AcquireSegment();
+    tail_->next.store(segment, std::memory_order_release);
+    tail_ = segment;
+  }
+  memcpy(tail_->data.get() + slot * allocated_element_size_, data,
+         element_size_);
+}
+
+bool LockFreeSpscJitChannelQueue::ReadRaw(uint8_t* buffer) {
+  // The generator runs on the consumer thread. Writes from any other thread are
+  // rejected by ChannelQueue::Write when a generator is attached so the
+  // consumer is the only producer in this case.
+  if (generator_.has_value()) {
+    std::optional<Value> generated_value = (*generator_)();
+    if (generated_value.has_value()) {
+      WriteInternal(generated_value.value());
+    }
+  }
+  return Pop(buffer);
+}
+
+bool LockFreeSpscJitChannelQueue::Pop(uint8_t* buffer) {
+  int64_t count = read_count_.load(std::memory_order_relaxed);
+  if (count == write_count_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  int64_t slot = count % segment_capacity_;
+  if (slot == 0 && count != 0) {
+    // The producer has moved on to the next segment so the current one can be
+    // retired.
+    Segment* next = head_->next.load(std::memory_order_acquire);
+    XLS_CHECK(next != nullptr);
+    RetireSegment(head_);
+    head_ = next;
+  }
+  memcpy(buffer, head_->data.get() + slot * allocated_element_size_,
+         element_size_);
+  read_count_.store(count + 1, std::memory_order_release);
+  return true;
+}
+
+int64_t LockFreeSpscJitChannelQueue::GetSizeInternal() const {
+  // Load the read count first. The write count is never less than the read
+  // count so the difference is never negative.
+  int64_t read_count = read_count_.load(std::memory_order_acquire);
+  int64_t write_count = write_count_.load(std::memory_order_acquire);
+  return write_count - read_count;
+}
+
+void LockFreeSpscJitChannelQueue::WriteInternal(const Value& value) {
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      element_size_);
+  jit_runtime_->BlitValueToBuffer(value, channel()->type(),
+                                  absl::MakeSpan(buffer));
+  WriteRaw(buffer.data());
+}
+
+std::optional<Value> LockFreeSpscJitChannelQueue::ReadInternal() {
+  std::vector<uint8_t> buffer(element_size_);
+  if (!Pop(buffer.data())) {
+    return std::nullopt;
+  }
+  return jit_runtime_->UnpackBuffer(buffer.data(), channel()->type(),
+                                    /*unpoison=*/true);
+}
+
+RingBufferJitChannelQueue::RingBufferJitChannelQueue(Channel* channel,
+                                                     JitRuntime* jit_runtime)
+    : JitChannelQueue(channel, jit_runtime),
+      element_size_(jit_runtime->GetTypeByteSize(channel->type())),
+      slot_size_(std::max(element_size_, int64_t{1})),
+      storage_(kInitCapacity * slot_size_) {
+  XLS_CHECK_EQ(channel->kind(), ChannelKind::kStreaming);
+  ring_buffer_ = RingBuffer{.data = storage_.data(),
+                            .capacity = kInitCapacity,
+                            .read_index = 0,
+                            .size = 0};
+}
+
+void RingBufferJitChannelQueue::Grow() {
+  std::vector<uint8_t> storage(2 * storage_.size());
+  // Unwrap the elements to the start of the new storage.
+  for (int64_t i = 0; i < ring_buffer_.size; ++i) {
+    int64_t slot = (ring_buffer_.read_index + i) & (ring_buffer_.capacity - 1);
+    memcpy(storage.data() + i * slot_size_, storage_.data() + slot * slot_size_,
+           element_size_);
+  }
+  storage_ = std::move(storage);
+  ring_buffer_.data = storage_.data();
+  ring_buffer_.capacity *= 2;
+  ring_buffer_.read_index = 0;
+}
+
+void RingBufferJitChannelQueue::WriteRaw(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+  __msan_unpoison(data, element_size_);
+#endif
+  if (ring_buffer_.size == ring_buffer_.capacity) {
+    Grow();
+  }
+  int64_t slot = (ring_buffer_.read_index + ring_buffer_.size) &
+                 (ring_buffer_.capacity - 1);
+  memcpy(ring_buffer_.data + slot * slot_size_, data, element_size_);
+  ++ring_buffer_.size;
+}
+
+void RingBufferJitChannelQueue::WriteRawBatch(const uint8_t* data,
+                                              int64_t count) {
+  for (int64_t i = 0; i < count; ++i) {
+    WriteRaw(data + i * element_size_);
+  }
+}
+
+bool RingBufferJitChannelQueue::ReadRaw(uint8_t* buffer) {
+  if (generator_.has_value()) {
+    std::optional<Value> generated_value = (*generator_)();
+    if (generated_value.has_value()) {
+      WriteInternal(generated_value.value());
+    }
+  }
+  return Pop(buffer);
+}
+
+int64_t RingBufferJitChannelQueue::ReadRawBatch(uint8_t* buffer,
+                                                int64_t max_count) {
+  if (generator_.has_value()) {
+    for (int64_t i = 0; i < max_count; ++i) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (!generated_value.has_value()) {
+        break;
+      }
+      WriteInternal(generated_value.value());
+    }
+  }
+  int64_t read_count = 0;
+  while (read_count < max_count &&
+         Pop(buffer + read_count * element_size_)) {
+    ++read_count;
+  }
+  return read_count;
+}
+
+bool RingBufferJitChannelQueue::Pop(uint8_t* buffer) {
+  if (ring_buffer_.size == 0) {
+    return false;
+  }
+  memcpy(buffer, ring_buffer_.data + ring_buffer_.read_index * slot_size_,
+         element_size_);
+  ring_buffer_.read_index =
+      (ring_buffer_.read_index + 1) & (ring_buffer_.capacity - 1);
+  --ring_buffer_.size;
+  return true;
+}
+
+int64_t RingBufferJitChannelQueue::GetSizeInternal() const {
+  return ring_buffer_.size;
+}
+
+void RingBufferJitChannelQueue::WriteInternal(const Value& value) {
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      element_size_);
+  jit_runtime_->BlitValueToBuffer(value, channel()->type(),
+                                  absl::MakeSpan(buffer));
+  WriteRaw(buffer.data());
+}
+
+std::optional<Value> RingBufferJitChannelQueue::ReadInternal() {
+  std::vector<uint8_t> buffer(element_size_);
+  if (!Pop(buffer.data())) {
+    return std::nullopt;
+  }
+  return jit_runtime_->UnpackBuffer(buffer.data(), channel()->type(),
+                                    /*unpoison=*/true);
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(Package* package,
                                          JitRuntime* jit_runtime) {
+  absl::flat_hash_set<Channel*> spsc_channels =
+      GetSingleProducerSingleConsumerChannels(package);
   std::vector<std::unique_ptr<ChannelQueue>> queues;
   for (Channel* channel : package->channels()) {
-    queues.push_back(
-        std::make_unique<ThreadSafeJitChannelQueue>(channel, jit_runtime));
+    if (spsc_channels.contains(channel)) {
+      queues.push_back(
+          std::make_unique<LockFreeSpscJitChannelQueue>(channel, jit_runtime));
+    } else {
+      queues.push_back(
+          std::make_unique<ThreadSafeJitChannelQueue>(channel, jit_runtime));
+    }
   }
   return absl::WrapUnique(
       new JitChannelQueueManager(package, std::move(queues)));
@@ -125,6 +412,25 @@ JitChannelQueueManager::CreateThreadUnsafe(Package* package,
       new JitChannelQueueManager(package, std::move(queues)));
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+JitChannelQueueManager::CreateWithRingBuffers(Package* package,
+                                              JitRuntime* jit_runtime) {
+  absl::flat_hash_set<Channel*> spsc_channels =
+      GetSingleProducerSingleConsumerChannels(package);
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (Channel* channel : package->channels()) {
+    if (spsc_channels.contains(channel)) {
+      queues.push_back(
+          std::make_unique<RingBufferJitChannelQueue>(channel, jit_runtime));
+    } else {
+      queues.push_back(
+          std::make_unique<ThreadUnsafeJitChannelQueue>(channel, jit_runtime));
+    }
+  }
+  return absl::WrapUnique(
+      new JitChannelQueueManager(package, std::move(queues)));
+}
+
 JitChannelQueue& JitChannelQueueManager::GetJitQueue(Channel* channel) {
   JitChannelQueue* queue = dynamic_cast<JitChannelQueue*>(&GetQueue(channel));
   XLS_CHECK_NE(queue, nullptr);
@@ -132,3 +438,15 @@ JitChannelQueue& JitChannelQueueManager::GetJitQueue(Channel* channel) {
 }
 
 }  // namespace xls
+
+extern "C" {
+bool xls_jit_channel_queue_read_raw(xls::JitChannelQueue* queue,
+                                    uint8_t* buffer) {
+  return queue->ReadRaw(buffer);
+}
+
+void xls_jit_channel_queue_write_raw(xls::JitChannelQueue* queue,
+                                     const uint8_t* data) {
+  queue->WriteRaw(data);
+}
+}
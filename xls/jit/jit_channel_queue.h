@@ -15,11 +15,13 @@
 #define XLS_JIT_JIT_CHANNEL_QUEUE_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
+#include "absl/base/optimization.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
@@ -28,6 +30,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/interpreter/byte_queue.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
@@ -36,84 +39,6 @@
 
 namespace xls {
 
-// A queue from which raw bytes may be written or read.
-class ByteQueue {
- public:
-  // `channel_element_size` is the granuality of the queue access. Each read or
-  // write to the queue handles this many bytes at a time. `is_single_value`
-  // indicates whether this queue follows single-value channel semantics where
-  // the queue only holds a single value; writes overwrite the value in the
-  // queue and reads are non-destructive. If `is_single_value` is false then the
-  // queue has FIFO semantics.
-  ByteQueue(int64_t channel_element_size, bool is_single_value);
-
-  int64_t element_size() const { return channel_element_size_; }
-
-  // Doubles the size of the queue.
-  void Resize();
-
-  void Write(const uint8_t* data) {
-#ifdef ABSL_HAVE_MEMORY_SANITIZER
-    __msan_unpoison(data, channel_element_size_);
-#endif
-    if (bytes_used_ == max_byte_count_ && !is_single_value_) {
-      Resize();
-    }
-    memcpy(circular_buffer_.data() + write_index_, data, channel_element_size_);
-    if (is_single_value_) {
-      bytes_used_ = allocated_element_size_;
-    } else {
-      bytes_used_ += allocated_element_size_;
-      write_index_ = write_index_ + allocated_element_size_;
-      if (write_index_ == max_byte_count_) {
-        write_index_ = 0;
-      }
-    }
-  }
-
-  bool Read(uint8_t* buffer) {
-    if (bytes_used_ == 0) {
-      return false;
-    }
-    memcpy(buffer, circular_buffer_.data() + read_index_,
-           channel_element_size_);
-    if (!is_single_value_) {
-      // Reads are destructive for non single-value channels.
-      bytes_used_ -= allocated_element_size_;
-      read_index_ = read_index_ + allocated_element_size_;
-      if (read_index_ == max_byte_count_) {
-        read_index_ = 0;
-      }
-    }
-    return true;
-  }
-
-  int64_t size() const { return bytes_used_ / allocated_element_size_; }
-
-  static constexpr int64_t kInitBufferSize = 128;
-
- private:
-  // Size of an element in the channel in units of bytes.
-  int64_t channel_element_size_ = 0;
-  // Allocated size of an element in the circular buffer in units of bytes. The
-  // elements are aligned to the largest scalar type.
-  int64_t allocated_element_size_ = 0;
-  // TODO(vmirian): 8-09-2022 Place the following guarded members on a single
-  // cache line for optimal performance.
-  // The maximum number of bytes that can hold elements in the circular buffer.
-  int64_t max_byte_count_ = 0;
-  // The number of bytes used in the circular buffer.
-  int64_t bytes_used_ = 0;
-  // Index in the circular buffer to write values to.
-  int64_t read_index_ = 0;
-  // Index in the circular buffer to read values from.
-  int64_t write_index_ = 0;
-  // A circular buffer to store the elements. It is preallocated with storage.
-  absl::InlinedVector<uint8_t, kInitBufferSize> circular_buffer_;
-  // Whether this queue follows single-value channel semantics.
-  bool is_single_value_;
-};
-
 // Abstract base class for channel queues which may be used by the JIT. These
 // queues support reading and writing raw bytes to the queue rather the just
 // xls::Values.
@@ -126,6 +51,15 @@ class JitChannelQueue : public ChannelQueue {
   virtual void WriteRaw(const uint8_t* data) = 0;
   virtual bool ReadRaw(uint8_t* buffer) = 0;
 
+  // Writes `count` values stored contiguously in `data` in LLVM's native
+  // format. Consecutive values are `GetTypeByteSize(channel()->type())` bytes
+  // apart.
+  virtual void WriteRawBatch(const uint8_t* data, int64_t count) = 0;
+
+  // Reads up to `max_count` values into `buffer` using the same layout as
+  // `WriteRawBatch`. Returns the number of values read.
+  virtual int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) = 0;
+
  protected:
   JitRuntime* jit_runtime_;
 };
@@ -159,7 +93,22 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
     return byte_queue_.Read(buffer);
   }
 
+  void WriteRawBatch(const uint8_t* data, int64_t count) override {
+    absl::MutexLock lock(&mutex_);
+    byte_queue_.WriteBatch(data, count);
+  }
+
+  int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) override {
+    absl::MutexLock lock(&mutex_);
+    GenerateValues(max_count);
+    return byte_queue_.ReadBatch(buffer, max_count);
+  }
+
  protected:
+  // Invokes the generator (if any) up to `count` times writing the generated
+  // values on to the queue.
+  void GenerateValues(int64_t count) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value)
       ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
@@ -189,6 +138,11 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
     return byte_queue_.Read(buffer);
   }
 
+  void WriteRawBatch(const uint8_t* data, int64_t count) override {
+    byte_queue_.WriteBatch(data, count);
+  }
+  int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) override;
+
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value) override;
@@ -197,16 +151,165 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
   ByteQueue byte_queue_;
 };
 
+// A lock-free version of the JIT channel queue which may be accessed by at most
+// one producer thread and one consumer thread at a time. Elements are stored in
+// a chain of fixed-capacity segments so, like the other streaming queues, the
+// queue is unbounded. The producer and consumer only communicate through the
+// write and read counters which are each placed on their own cache line. Only
+// streaming channels are supported.
+class LockFreeSpscJitChannelQueue : public JitChannelQueue {
+ public:
+  static constexpr int64_t kDefaultSegmentCapacity = 256;
+
+  // `segment_capacity` is the number of elements held in each segment of the
+  // queue.
+  LockFreeSpscJitChannelQueue(
+      Channel* channel, JitRuntime* jit_runtime,
+      int64_t segment_capacity = kDefaultSegmentCapacity);
+  ~LockFreeSpscJitChannelQueue() override;
+
+  // Must only be called from the producer thread.
+  void WriteRaw(const uint8_t* data) override;
+
+  // Must only be called from the consumer thread.
+  bool ReadRaw(uint8_t* buffer) override;
+
+  // Must only be called from the producer thread. The values are published to
+  // the consumer all at once.
+  void WriteRawBatch(const uint8_t* data, int64_t count) override;
+
+  // Must only be called from the consumer thread.
+  int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) override;
+
+ protected:
+  int64_t GetSizeInternal() const override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+ private:
+  struct Segment {
+    explicit Segment(int64_t byte_count) : data(new uint8_t[byte_count]) {}
+
+    std::unique_ptr<uint8_t[]> data;
+    // The segment following this one. Set by the producer before any element
+    // in the following segment is published.
+    std::atomic<Segment*> next = nullptr;
+  };
+
+  // Returns an empty segment for the producer, reusing a segment retired by
+  // the consumer if one is available.
+  Segment* AcquireSegment();
+
+  // Called by the consumer to retire a fully-read segment.
+  void RetireSegment(Segment* segment);
+
+  // Copies `data` into the slot for the element with the given index (the
+  // number of elements written before it) without publishing it to the
+  // consumer.
+  void Push(const uint8_t* data, int64_t index);
+
+  // Reads the element at the head of the queue into `buffer` without invoking
+  // the generator. Returns false if the queue is empty.
+  bool Pop(uint8_t* buffer);
+
+  int64_t element_size_;
+  // Size of an element within a segment. This is the element size except for
+  // zero-sized elements which occupy one byte.
+  int64_t allocated_element_size_;
+  int64_t segment_capacity_;
+
+  // Total number of elements written to the queue and the segment currently
+  // being written. Only modified by the producer.
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> write_count_ = 0;
+  Segment* tail_;
+
+  // Total number of elements read from the queue and the segment currently
+  // being read. Only modified by the consumer.
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> read_count_ = 0;
+  Segment* head_;
+
+  // A segment retired by the consumer which may be reused by the producer.
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<Segment*> spare_segment_ = nullptr;
+};
+
+// A thread-unsafe JIT channel queue backed by a ring buffer with a fixed
+// layout. Code compiled against a queue manager holding these queues reads and
+// writes the ring buffer inline rather than calling ReadRaw and WriteRaw. The
+// generated code only calls WriteRaw to grow a full buffer so, like the other
+// streaming queues, the queue is unbounded. Because the generated code bypasses
+// ReadRaw, attached generators are only invoked by direct calls to the queue.
+// Only streaming channels are supported.
+class RingBufferJitChannelQueue : public JitChannelQueue {
+ public:
+  // The state of the ring buffer accessed by the generated code.
+  struct RingBuffer {
+    // Storage for `capacity` elements, each `slot_size()` bytes.
+    uint8_t* data;
+    // Number of elements which fit in `data`. Always a power of two.
+    int64_t capacity;
+    // Index of the slot holding the element at the head of the queue.
+    int64_t read_index;
+    // Number of elements in the queue.
+    int64_t size;
+  };
+
+  static constexpr int64_t kInitCapacity = 16;
+
+  RingBufferJitChannelQueue(Channel* channel, JitRuntime* jit_runtime);
+  ~RingBufferJitChannelQueue() override = default;
+
+  void WriteRaw(const uint8_t* data) override;
+  bool ReadRaw(uint8_t* buffer) override;
+  void WriteRawBatch(const uint8_t* data, int64_t count) override;
+  int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) override;
+
+  RingBuffer* ring_buffer() { return &ring_buffer_; }
+
+  // Size of an element in bytes and the size of the slot holding an element
+  // in the ring buffer. Zero-sized elements occupy a single byte.
+  int64_t element_size() const { return element_size_; }
+  int64_t slot_size() const { return slot_size_; }
+
+ protected:
+  int64_t GetSizeInternal() const override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+ private:
+  // Doubles the capacity of the ring buffer.
+  void Grow();
+
+  // Reads the element at the head of the queue into `buffer` without invoking
+  // the generator. Returns false if the queue is empty.
+  bool Pop(uint8_t* buffer);
+
+  int64_t element_size_;
+  int64_t slot_size_;
+  std::vector<uint8_t> storage_;
+  RingBuffer ring_buffer_;
+};
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
   // Factories which create a queue manager with exclusively ThreadSafe/Unsafe
-  // queues.
+  // queues. The thread-safe factory uses a LockFreeSpscJitChannelQueue for
+  // streaming send-receive channels which are sent on by exactly one proc and
+  // received on by exactly one proc; all other channels use a
+  // ThreadSafeJitChannelQueue.
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadSafe(Package* package, JitRuntime* jit_runtime);
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadUnsafe(Package* package, JitRuntime* jit_runtime);
 
+  // Factory which creates a thread-unsafe queue manager in which the
+  // single-producer single-consumer streaming channels (as in
+  // CreateThreadSafe) use a RingBufferJitChannelQueue. Procs compiled against
+  // this manager access these channels inline. All other channels use a
+  // ThreadUnsafeJitChannelQueue.
+  static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+  CreateWithRingBuffers(Package* package, JitRuntime* jit_runtime);
+
   JitChannelQueue& GetJitQueue(Channel* channel);
 
  protected:
@@ -217,4 +320,15 @@ class JitChannelQueueManager : public ChannelQueueManager {
 
 }  // namespace xls
 
+// C-linkage entry points for raw queue accesses. Code compiled with
+// relocatable channel queues (see JitBuilderContext) calls these by name
+// rather than through addresses baked into the generated code so the emitted
+// object code can be linked into another binary ahead of time.
+extern "C" {
+bool xls_jit_channel_queue_read_raw(xls::JitChannelQueue* queue,
+                                    uint8_t* buffer);
+void xls_jit_channel_queue_write_raw(xls::JitChannelQueue* queue,
+                                     const uint8_t* data);
+}
+
 #endif  // XLS_JIT_JIT_CHANNEL_QUEUE_H_
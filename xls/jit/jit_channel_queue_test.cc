@@ -14,14 +14,17 @@
 
 #include "xls/jit/jit_channel_queue.h"
 
+#include <cstring>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/channel_queue_test_base.h"
 #include "xls/ir/channel.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 
 namespace xls {
@@ -54,7 +57,8 @@ template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     LockFreeSpscJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 TYPED_TEST(JitChannelQueueTest, BasicAccess) {
@@ -123,5 +127,155 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TYPED_TEST(JitChannelQueueTest, BatchedAccess) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  TypeParam queue(channel, GetJitRuntime());
+
+  // Write enough values in batches to force the underlying storage to grow and
+  // wrap around.
+  std::vector<uint32_t> send_buffer(100);
+  uint32_t next_write = 0;
+  uint32_t next_read = 0;
+  for (int64_t batch = 0; batch < 10; ++batch) {
+    for (uint32_t& value : send_buffer) {
+      value = next_write++;
+    }
+    queue.WriteRawBatch(reinterpret_cast<const uint8_t*>(send_buffer.data()),
+                        send_buffer.size());
+    std::vector<uint32_t> recv_buffer(37);
+    EXPECT_EQ(
+        queue.ReadRawBatch(reinterpret_cast<uint8_t*>(recv_buffer.data()),
+                           recv_buffer.size()),
+        recv_buffer.size());
+    for (uint32_t value : recv_buffer) {
+      EXPECT_EQ(value, next_read++);
+    }
+  }
+  EXPECT_EQ(queue.GetSize(), next_write - next_read);
+
+  // Drain the queue with a batch larger than the number of elements.
+  std::vector<uint32_t> recv_buffer(next_write);
+  EXPECT_EQ(queue.ReadRawBatch(reinterpret_cast<uint8_t*>(recv_buffer.data()),
+                               recv_buffer.size()),
+            next_write - next_read);
+  EXPECT_EQ(recv_buffer.front(), next_read);
+  EXPECT_EQ(recv_buffer[next_write - next_read - 1], next_write - 1);
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ(queue.ReadRawBatch(reinterpret_cast<uint8_t*>(recv_buffer.data()),
+                               recv_buffer.size()),
+            0);
+}
+
+TEST(LockFreeSpscJitChannelQueueTest, CrossSegmentBoundaries) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  LockFreeSpscJitChannelQueue queue(channel, GetJitRuntime(),
+                                    /*segment_capacity=*/3);
+
+  // Interleave writes and reads with varying occupancy so the read and write
+  // positions cross segment boundaries at different times.
+  uint32_t next_write = 0;
+  uint32_t next_read = 0;
+  for (int64_t burst = 1; burst < 10; ++burst) {
+    for (int64_t i = 0; i < burst; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&next_write));
+      ++next_write;
+    }
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+    for (int64_t i = 0; i < burst / 2 + 1; ++i) {
+      uint32_t result;
+      ASSERT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&result)));
+      EXPECT_EQ(result, next_read);
+      ++next_read;
+    }
+  }
+  while (next_read < next_write) {
+    EXPECT_THAT(queue.Read(),
+                testing::Optional(Value(UBits(next_read, 32))));
+    ++next_read;
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ(queue.Read(), std::nullopt);
+}
+
+TEST(LockFreeSpscJitChannelQueueTest, ConcurrentProducerAndConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  LockFreeSpscJitChannelQueue queue(channel, GetJitRuntime(),
+                                    /*segment_capacity=*/16);
+
+  constexpr uint64_t kElementCount = 100000;
+  Thread producer([&]() {
+    for (uint64_t i = 0; i < kElementCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&i));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kElementCount) {
+    uint64_t result;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&result))) {
+      ASSERT_EQ(result, expected);
+      ++expected;
+    }
+  }
+  producer.Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(JitChannelQueueManagerTest, ThreadSafeUsesLockFreeQueueForSpscChannels) {
+  const std::string kIrText = R"(
+package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan a_to_b(bits[32], id=1, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan b_out(bits[32], id=2, kind=streaming, ops=send_only, flow_control=none, metadata="")
+chan sv(bits[32], id=3, kind=single_value, ops=send_receive, metadata="")
+
+proc a(my_token: token, state: (), init={()}) {
+  receive.1: (token, bits[32]) = receive(my_token, channel_id=0)
+  tuple_index.2: token = tuple_index(receive.1, index=0)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1)
+  send.4: token = send(tuple_index.2, tuple_index.3, channel_id=1)
+  send.5: token = send(send.4, tuple_index.3, channel_id=3)
+  next (send.5, state)
+}
+
+proc b(my_token: token, state: (), init={()}) {
+  receive.10: (token, bits[32]) = receive(my_token, channel_id=1)
+  tuple_index.11: token = tuple_index(receive.10, index=0)
+  receive.12: (token, bits[32]) = receive(tuple_index.11, channel_id=3)
+  tuple_index.13: token = tuple_index(receive.12, index=0)
+  tuple_index.14: bits[32] = tuple_index(receive.12, index=1)
+  send.15: token = send(tuple_index.13, tuple_index.14, channel_id=2)
+  next (send.15, state)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_mgr,
+      JitChannelQueueManager::CreateThreadSafe(package.get(), GetJitRuntime()));
+
+  auto is_lock_free = [&](int64_t channel_id) {
+    Channel* channel = package->GetChannel(channel_id).value();
+    return dynamic_cast<LockFreeSpscJitChannelQueue*>(
+               &queue_mgr->GetJitQueue(channel)) != nullptr;
+  };
+  EXPECT_FALSE(is_lock_free(0));
+  EXPECT_TRUE(is_lock_free(1));
+  EXPECT_FALSE(is_lock_free(2));
+  EXPECT_FALSE(is_lock_free(3));
+}
+
 }  // namespace
 }  // namespace xls
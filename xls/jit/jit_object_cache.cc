@@ -0,0 +1,104 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <array>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "llvm/include/llvm/ADT/ArrayRef.h"
+#include "llvm/include/llvm/ADT/StringExtras.h"
+#include "llvm/include/llvm/Object/ObjectFile.h"
+#include "llvm/include/llvm/Support/SHA256.h"
+#include "llvm/include/llvm/Support/raw_ostream.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<JitObjectCache>>
+JitObjectCache::Create(const std::filesystem::path& directory,
+                       int64_t opt_level, std::string_view target_triple,
+                       std::string_view target_cpu,
+                       std::string_view target_features) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  return absl::WrapUnique(new JitObjectCache(
+      directory, opt_level, target_triple, target_cpu, target_features));
+}
+
+std::string JitObjectCache::GetKey(const llvm::Module& module) const {
+  std::string buffer = absl::StrFormat(
+      "opt_level: %d\ntriple: %s\ncpu: %s\nfeatures: %s\n", opt_level_,
+      target_triple_, target_cpu_, target_features_);
+  llvm::raw_string_ostream ostream(buffer);
+  module.print(ostream, nullptr);
+  ostream.flush();
+  std::array<uint8_t, 32> hash = llvm::SHA256::hash(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size()));
+  return llvm::toHex(hash, /*LowerCase=*/true);
+}
+
+std::filesystem::path JitObjectCache::GetPath(
+    const llvm::Module& module) const {
+  return directory_ / absl::StrCat(GetKey(module), ".o");
+}
+
+void JitObjectCache::notifyObjectCompiled(const llvm::Module* module,
+                                          llvm::MemoryBufferRef object) {
+  std::filesystem::path path = GetPath(*module);
+  absl::Status status = SetFileContentsAtomically(
+      path, std::string_view(object.getBufferStart(), object.getBufferSize()));
+  if (!status.ok()) {
+    XLS_LOG(WARNING) << absl::StreamFormat(
+        "Unable to write JIT object cache file %s: %s", path.string(),
+        status.ToString());
+  }
+}
+
+std::unique_ptr<llvm::MemoryBuffer> JitObjectCache::getObject(
+    const llvm::Module* module) {
+  std::filesystem::path path = GetPath(*module);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(path.string());
+  if (!buffer) {
+    absl::MutexLock lock(&mutex_);
+    ++miss_count_;
+    return nullptr;
+  }
+
+  // Guard against truncated or otherwise corrupt entries; these are treated as
+  // misses and the module is recompiled (overwriting the entry).
+  llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> object_file =
+      llvm::object::ObjectFile::createObjectFile(
+          buffer.get()->getMemBufferRef());
+  if (!object_file) {
+    XLS_LOG(WARNING) << absl::StreamFormat(
+        "Ignoring invalid JIT object cache file %s: %s", path.string(),
+        llvm::toString(object_file.takeError()));
+    absl::MutexLock lock(&mutex_);
+    ++miss_count_;
+    return nullptr;
+  }
+
+  XLS_VLOG(2) << "Loaded JIT object from cache: " << path;
+  absl::MutexLock lock(&mutex_);
+  ++hit_count_;
+  return std::move(buffer.get());
+}
+
+}  // namespace xls
@@ -0,0 +1,100 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+
+namespace xls {
+
+// An LLVM object cache which persists compiled object code in a directory on
+// disk so that identical modules need not be recompiled by later processes.
+// Objects are keyed by a hash of the (optimized) LLVM IR of the module along
+// with the optimization level, target triple, CPU and CPU features the object
+// was compiled for. Objects compiled for the features of one host are therefore
+// never loaded on a host which lacks them.
+//
+// A missing, truncated or otherwise invalid object file is a miss; the module
+// is recompiled and the entry overwritten. An object which cannot be written
+// is logged and still used by the current process.
+class JitObjectCache : public llvm::ObjectCache {
+ public:
+  // Creates a cache which stores objects in `directory`. The directory is
+  // created if it does not exist.
+  static absl::StatusOr<std::unique_ptr<JitObjectCache>> Create(
+      const std::filesystem::path& directory, int64_t opt_level,
+      std::string_view target_triple, std::string_view target_cpu,
+      std::string_view target_features);
+
+  // llvm::ObjectCache interface. Called by the LLVM compiler after compiling
+  // `module` and before compiling `module` respectively.
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) override;
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) override;
+
+  // Returns the cache key for the given module.
+  std::string GetKey(const llvm::Module& module) const;
+
+  // Returns the path of the cache entry for the given module.
+  std::filesystem::path GetPath(const llvm::Module& module) const;
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  // Number of lookups which were satisfied from and missed the cache
+  // respectively.
+  int64_t hit_count() const {
+    absl::MutexLock lock(&mutex_);
+    return hit_count_;
+  }
+  int64_t miss_count() const {
+    absl::MutexLock lock(&mutex_);
+    return miss_count_;
+  }
+
+ private:
+  JitObjectCache(const std::filesystem::path& directory, int64_t opt_level,
+                 std::string_view target_triple, std::string_view target_cpu,
+                 std::string_view target_features)
+      : directory_(directory),
+        opt_level_(opt_level),
+        target_triple_(target_triple),
+        target_cpu_(target_cpu),
+        target_features_(target_features) {}
+
+  std::filesystem::path directory_;
+  int64_t opt_level_;
+  std::string target_triple_;
+  std::string target_cpu_;
+  std::string target_features_;
+
+  mutable absl::Mutex mutex_;
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
@@ -0,0 +1,147 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+constexpr std::string_view kIr = R"(
+package test
+
+top fn add_mul(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  ret umul.2: bits[32] = umul(add.1, y)
+}
+)";
+
+// Returns the regular files in the given directory.
+std::vector<std::filesystem::path> ListFiles(
+    const std::filesystem::path& directory) {
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.is_regular_file()) {
+      files.push_back(entry.path());
+    }
+  }
+  return files;
+}
+
+absl::StatusOr<Value> RunAddMul(FunctionJit* jit, int64_t x, int64_t y) {
+  std::vector<Value> args = {Value(UBits(x, 32)), Value(UBits(y, 32))};
+  XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result, jit->Run(args));
+  return result.value;
+}
+
+TEST(JitObjectCacheTest, ReusesObjectAcrossJits) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path cache_dir = temp_dir.path() / "cache";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> first,
+                           FunctionJit::Create(f, /*opt_level=*/3, cache_dir));
+  EXPECT_THAT(RunAddMul(first.get(), 2, 3), IsOkAndHolds(Value(UBits(15, 32))));
+  EXPECT_EQ(first->object_cache()->hit_count(), 0);
+  EXPECT_EQ(first->object_cache()->miss_count(), 1);
+  EXPECT_EQ(ListFiles(cache_dir).size(), 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> second,
+                           FunctionJit::Create(f, /*opt_level=*/3, cache_dir));
+  EXPECT_THAT(RunAddMul(second.get(), 4, 5),
+              IsOkAndHolds(Value(UBits(45, 32))));
+  EXPECT_EQ(second->object_cache()->hit_count(), 1);
+  EXPECT_EQ(second->object_cache()->miss_count(), 0);
+  EXPECT_EQ(ListFiles(cache_dir).size(), 1);
+}
+
+TEST(JitObjectCacheTest, OptLevelIsPartOfKey) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FunctionJit> opt3,
+      FunctionJit::Create(f, /*opt_level=*/3, temp_dir.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FunctionJit> opt1,
+      FunctionJit::Create(f, /*opt_level=*/1, temp_dir.path()));
+  EXPECT_EQ(opt1->object_cache()->hit_count(), 0);
+  EXPECT_EQ(ListFiles(temp_dir.path()).size(), 2);
+  EXPECT_THAT(RunAddMul(opt1.get(), 1, 1), IsOkAndHolds(Value(UBits(2, 32))));
+}
+
+TEST(JitObjectCacheTest, CpuTargetIsPartOfKey) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FunctionJit> host,
+      FunctionJit::Create(f, /*opt_level=*/3, temp_dir.path(),
+                          JitCompilationMode::kEager, JitCpuTarget::kHost));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FunctionJit> generic,
+      FunctionJit::Create(f, /*opt_level=*/3, temp_dir.path(),
+                          JitCompilationMode::kEager, JitCpuTarget::kGeneric));
+  EXPECT_EQ(generic->object_cache()->hit_count(), 0);
+  EXPECT_EQ(ListFiles(temp_dir.path()).size(), 2);
+  EXPECT_THAT(RunAddMul(generic.get(), 2, 3),
+              IsOkAndHolds(Value(UBits(15, 32))));
+}
+
+TEST(JitObjectCacheTest, CorruptEntryIsRecompiled) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<FunctionJit> jit,
+        FunctionJit::Create(f, /*opt_level=*/3, temp_dir.path()));
+  }
+  std::vector<std::filesystem::path> files = ListFiles(temp_dir.path());
+  ASSERT_EQ(files.size(), 1);
+  XLS_ASSERT_OK(SetFileContents(files.front(), "not an object file"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FunctionJit> jit,
+      FunctionJit::Create(f, /*opt_level=*/3, temp_dir.path()));
+  EXPECT_EQ(jit->object_cache()->hit_count(), 0);
+  EXPECT_EQ(jit->object_cache()->miss_count(), 1);
+  EXPECT_THAT(RunAddMul(jit.get(), 2, 3), IsOkAndHolds(Value(UBits(15, 32))));
+}
+
+}  // namespace
+}  // namespace xls
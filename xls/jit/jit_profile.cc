@@ -0,0 +1,80 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_profile.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+namespace xls {
+
+int64_t JitProfile::GetNodeCount(Node* node) const {
+  auto it = node_counts_.find(node);
+  return it == node_counts_.end() ? 0 : it->second;
+}
+
+JitProfile::FunctionCounters JitProfile::GetFunctionCounts(
+    FunctionBase* function_base) const {
+  auto it = function_counters_.find(function_base);
+  return it == function_counters_.end() ? FunctionCounters() : it->second;
+}
+
+void JitProfile::Reset() {
+  for (auto& [node, count] : node_counts_) {
+    count = 0;
+  }
+  for (auto& [function_base, counters] : function_counters_) {
+    counters = FunctionCounters();
+  }
+}
+
+std::string JitProfile::ToString(int64_t max_nodes) const {
+  std::vector<std::pair<FunctionBase*, FunctionCounters>> functions(
+      function_counters_.begin(), function_counters_.end());
+  std::sort(functions.begin(), functions.end(),
+            [](const auto& a, const auto& b) {
+              if (a.second.cycle_count != b.second.cycle_count) {
+                return a.second.cycle_count > b.second.cycle_count;
+              }
+              return a.first->name() < b.first->name();
+            });
+  std::string result = "Functions (calls, cycles):\n";
+  for (const auto& [function_base, counters] : functions) {
+    absl::StrAppendFormat(&result, "  %s: %d, %d\n", function_base->name(),
+                          counters.call_count, counters.cycle_count);
+  }
+
+  std::vector<std::pair<Node*, int64_t>> nodes(node_counts_.begin(),
+                                               node_counts_.end());
+  std::sort(nodes.begin(), nodes.end(), [](const auto& a, const auto& b) {
+    if (a.second != b.second) {
+      return a.second > b.second;
+    }
+    return a.first->id() < b.first->id();
+  });
+  if (nodes.size() > max_nodes) {
+    nodes.resize(max_nodes);
+  }
+  absl::StrAppendFormat(&result, "Most executed nodes (top %d):\n", max_nodes);
+  for (const auto& [node, count] : nodes) {
+    absl::StrAppendFormat(&result, "  %s (%s): %d\n", node->GetName(),
+                          node->function_base()->name(), count);
+  }
+  return result;
+}
+
+}  // namespace xls
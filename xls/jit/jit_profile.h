@@ -0,0 +1,90 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_PROFILE_H_
+#define XLS_JIT_JIT_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/container/node_hash_map.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Execution counters collected by JIT-compiled code built with profiling
+// enabled. The addresses of the counters are embedded in the generated code
+// which increments them in place, so counters have stable addresses and must
+// outlive the compiled code. Not thread-safe: the compiled code updates the
+// counters with plain (non-atomic) increments.
+class JitProfile {
+ public:
+  // Counters for a jitted FunctionBase (function or proc).
+  struct FunctionCounters {
+    // Number of calls of the jitted function. For procs, each call either
+    // completes or resumes (after being blocked) a tick.
+    int64_t call_count = 0;
+    // Cycles (as measured by the processor's cycle counter) spent in the
+    // jitted function, including time spent in invoked functions.
+    int64_t cycle_count = 0;
+  };
+
+  JitProfile() = default;
+
+  // Not copyable or movable as compiled code holds pointers to the counters.
+  JitProfile(const JitProfile&) = delete;
+  JitProfile& operator=(const JitProfile&) = delete;
+
+  // Returns the address of the counter of executions of `node`, creating the
+  // counter if necessary. Used when building the code.
+  int64_t* GetNodeCounter(Node* node) { return &node_counts_[node]; }
+
+  // Returns the address of the counters for `function_base`, creating them if
+  // necessary. Used when building the code.
+  FunctionCounters* GetFunctionCounters(FunctionBase* function_base) {
+    return &function_counters_[function_base];
+  }
+
+  // Returns the number of times the given node was executed. Returns zero for
+  // nodes which are not instrumented (e.g., params and literals).
+  int64_t GetNodeCount(Node* node) const;
+
+  // Returns the counters for the given function base.
+  FunctionCounters GetFunctionCounts(FunctionBase* function_base) const;
+
+  const absl::node_hash_map<Node*, int64_t>& node_counts() const {
+    return node_counts_;
+  }
+  const absl::node_hash_map<FunctionBase*, FunctionCounters>&
+  function_counts() const {
+    return function_counters_;
+  }
+
+  // Sets all counters to zero.
+  void Reset();
+
+  // Returns a human-readable summary of the profile: the counters of each
+  // function followed by the `max_nodes` most frequently executed nodes.
+  std::string ToString(int64_t max_nodes = 20) const;
+
+ private:
+  // node_hash_map for pointer stability.
+  absl::node_hash_map<Node*, int64_t> node_counts_;
+  absl::node_hash_map<FunctionBase*, FunctionCounters> function_counters_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_PROFILE_H_
@@ -14,6 +14,8 @@
 
 #include "xls/jit/jit_runtime.h"
 
+#include <cstring>
+
 #include "absl/strings/str_format.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "xls/common/status/status_macros.h"
@@ -45,12 +47,12 @@ absl::Status JitRuntime::PackArgs(absl::Span<const Value> args,
         "Input buffer is not large enough to hold all arguments: %d vs. %d",
         arg_buffers.size(), args.size()));
   }
-  if (!args.empty()) {
-    for (int i = 0; i < args.size(); ++i) {
-      BlitValueToBuffer(
-          args[i], arg_types[i],
-          absl::MakeSpan(arg_buffers[i], GetTypeByteSize(arg_types[i])));
-    }
+  absl::MutexLock lock(&mutex_);
+  for (int i = 0; i < args.size(); ++i) {
+    BlitValueToBufferInternal(
+        args[i], arg_types[i],
+        absl::MakeSpan(arg_buffers[i],
+                       type_converter_->GetTypeByteSize(arg_types[i])));
   }
 
   return absl::OkStatus();
@@ -76,6 +78,13 @@ Value JitRuntime::UnpackBufferInternal(const uint8_t* buffer,
         __msan_unpoison(buffer, byte_count);
       }
 #endif  // ABSL_HAVE_MEMORY_SANITIZER
+      if (bit_count <= 64 && data_layout_.isLittleEndian()) {
+        // Fast path which avoids the byte swap and the construction from
+        // bytes.
+        uint64_t word = 0;
+        std::memcpy(&word, buffer, byte_count);
+        return Value(UBits(word & Mask(bit_count), bit_count));
+      }
       for (int i = 0; i < byte_count; ++i) {
         data.push_back(buffer[i]);
       }
@@ -92,17 +101,13 @@ Value JitRuntime::UnpackBufferInternal(const uint8_t* buffer,
       // Just as with arg packing, we need the DataLayout to tell us where each
       // arg is placed in the output buffer.
       const TupleType* tuple_type = result_type->AsTupleOrDie();
-      llvm::Type* llvm_type = type_converter_->ConvertToLlvmType(tuple_type);
-      const llvm::StructLayout* layout =
-          data_layout_.getStructLayout(llvm::cast<llvm::StructType>(llvm_type));
-
       std::vector<Value> values;
       values.reserve(tuple_type->size());
       for (int i = 0; i < tuple_type->size(); ++i) {
-        Value value =
-            UnpackBufferInternal(buffer + layout->getElementOffset(i),
-                                 tuple_type->element_type(i), unpoison);
-        values.push_back(value);
+        Value value = UnpackBufferInternal(
+            buffer + type_converter_->GetElementOffset(tuple_type, i),
+            tuple_type->element_type(i), unpoison);
+        values.push_back(std::move(value));
       }
       return Value::TupleOwned(std::move(values));
     }
@@ -113,25 +118,16 @@ Value JitRuntime::UnpackBufferInternal(const uint8_t* buffer,
       }
 
       const Type* element_type = array_type->element_type();
-      llvm::Type* llvm_element_type =
-          type_converter_->ConvertToLlvmType(array_type->element_type());
       std::vector<Value> values;
       values.reserve(array_type->size());
-      // This BitsType is only used inside the ToLlvmConstantCall() (and isn't
-      // stored), so it's safe for it to live on the stack.
-      BitsType bits_type(64);
       for (int i = 0; i < array_type->size(); ++i) {
-        llvm::Constant* index =
-            type_converter_->ToLlvmConstant(&bits_type, Value(UBits(i, 64)))
-                .value();
-        int64_t offset =
-            data_layout_.getIndexedOffsetInType(llvm_element_type, index);
-        Value value =
-            UnpackBufferInternal(buffer + offset, element_type, unpoison);
-        values.push_back(value);
+        Value value = UnpackBufferInternal(
+            buffer + type_converter_->GetElementOffset(array_type, i),
+            element_type, unpoison);
+        values.push_back(std::move(value));
       }
 
-      return Value::ArrayOrDie(values);
+      return Value::ArrayOwned(std::move(values)).value();
     }
     case TypeKind::kToken:
       return Value::Token();
@@ -180,14 +176,11 @@ void JitRuntime::BlitValueToBufferInternal(const Value& value, const Type* type,
     // load/store instructions), we need to make sure we blit args into LLVM
     // space as the underlying runtime expects, which means we need the
     // DataLayout to tell us where each constituent element should be placed.
-    llvm::Type* llvm_type = type_converter_->ConvertToLlvmType(type);
-    const llvm::StructLayout* layout =
-        data_layout_.getStructLayout(llvm::cast<llvm::StructType>(llvm_type));
-
     const TupleType* tuple_type = type->AsTupleOrDie();
     for (int i = 0; i < value.size(); ++i) {
-      BlitValueToBufferInternal(value.element(i), tuple_type->element_type(i),
-                                buffer.subspan(layout->getElementOffset(i)));
+      BlitValueToBufferInternal(
+          value.element(i), tuple_type->element_type(i),
+          buffer.subspan(type_converter_->GetElementOffset(tuple_type, i)));
     }
   } else if (value.IsToken()) {
     // Tokens contain no data.
@@ -196,6 +189,59 @@ void JitRuntime::BlitValueToBufferInternal(const Value& value, const Type* type,
   }
 }
 
+void JitRuntime::BlitRandomToBuffer(
+    const Type* type, absl::Span<uint8_t> buffer,
+    absl::FunctionRef<void(absl::Span<uint8_t>)> fill_random) {
+  absl::MutexLock lock(&mutex_);
+  BlitRandomToBufferInternal(type, buffer, fill_random);
+}
+
+void JitRuntime::BlitRandomToBufferInternal(
+    const Type* type, absl::Span<uint8_t> buffer,
+    absl::FunctionRef<void(absl::Span<uint8_t>)> fill_random) {
+  switch (type->kind()) {
+    case TypeKind::kBits: {
+      int64_t bit_count = type->AsBitsOrDie()->bit_count();
+      int64_t byte_count = CeilOfRatio(bit_count, kCharBit);
+      fill_random(buffer.subspan(0, byte_count));
+      // Zero out any padding bits and bytes as in BlitValueToBufferInternal.
+      int remainder_bits = bit_count % kCharBit;
+      if (remainder_bits != 0) {
+        buffer[byte_count - 1] &= static_cast<uint8_t>(Mask(remainder_bits));
+      }
+      int64_t allocated_size = type_converter_->GetTypeByteSize(type);
+      for (int64_t i = byte_count; i < allocated_size; ++i) {
+        buffer[i] = 0;
+      }
+      break;
+    }
+    case TypeKind::kArray: {
+      const ArrayType* array_type = type->AsArrayOrDie();
+      int64_t element_size =
+          type_converter_->GetTypeByteSize(array_type->element_type());
+      for (int64_t i = 0; i < array_type->size(); ++i) {
+        BlitRandomToBufferInternal(array_type->element_type(), buffer,
+                                   fill_random);
+        buffer = buffer.subspan(element_size);
+      }
+      break;
+    }
+    case TypeKind::kTuple: {
+      const TupleType* tuple_type = type->AsTupleOrDie();
+      for (int64_t i = 0; i < tuple_type->size(); ++i) {
+        BlitRandomToBufferInternal(
+            tuple_type->element_type(i),
+            buffer.subspan(type_converter_->GetElementOffset(tuple_type, i)),
+            fill_random);
+      }
+      break;
+    }
+    case TypeKind::kToken:
+      // Tokens contain no data.
+      break;
+  }
+}
+
 extern "C" {
 
 int64_t XlsJitGetArgBufferSize(int arg_count, const char** input_args) {
@@ -17,6 +17,7 @@
 
 #include <cstdint>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
@@ -54,6 +55,15 @@ class JitRuntime {
   void BlitValueToBuffer(const Value& value, const Type* type,
                          absl::Span<uint8_t> buffer);
 
+  // Fills the buffer with a random value of the given type according to the
+  // data layout expected by LLVM, without constructing an xls::Value.
+  // `fill_random` is called to fill each bits-typed leaf with random bytes
+  // (e.g., Xoshiro256StarStar::Fill). Padding bits and bytes of bits-typed
+  // leaves are zeroed.
+  void BlitRandomToBuffer(
+      const Type* type, absl::Span<uint8_t> buffer,
+      absl::FunctionRef<void(absl::Span<uint8_t>)> fill_random);
+
   const llvm::DataLayout& data_layout() { return data_layout_; }
 
   int64_t GetTypeByteSize(Type* xls_type) {
@@ -67,6 +77,10 @@ class JitRuntime {
   void BlitValueToBufferInternal(const Value& value, const Type* type,
                                  absl::Span<uint8_t> buffer)
       ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  void BlitRandomToBufferInternal(
+      const Type* type, absl::Span<uint8_t> buffer,
+      absl::FunctionRef<void(absl::Span<uint8_t>)> fill_random)
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
 
   mutable absl::Mutex mutex_;
 
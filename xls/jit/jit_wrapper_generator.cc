@@ -318,6 +318,263 @@ std::string CreateImplSpecialization(const Function& function,
                          absl::StrJoin(param_names, ", "));
 }
 
+// Returns true if values of the given type can be passed to and from the JIT
+// without conversion as a C++ type with the same layout as the JIT's native
+// (LLVM) representation of the type: bits types of up to 64 bits as unsigned
+// integers, arrays as std::arrays, and tuples as structs.
+bool IsNativelyRepresentable(const Type& type) {
+  if (type.IsBits()) {
+    return type.GetFlatBitCount() <= 64;
+  }
+  if (type.IsArray()) {
+    const ArrayType* array_type = type.AsArrayOrDie();
+    return array_type->size() > 0 &&
+           IsNativelyRepresentable(*array_type->element_type());
+  }
+  if (type.IsTuple()) {
+    const TupleType* tuple_type = type.AsTupleOrDie();
+    if (tuple_type->size() == 0) {
+      return false;
+    }
+    for (const Type* element_type : tuple_type->element_types()) {
+      if (!IsNativelyRepresentable(*element_type)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+// The native interface is only generated when every param and the return value
+// is natively representable and the function is not already covered by the
+// (packed) specialized interface, which would otherwise have the same
+// signature.
+bool HasNativeInterface(const Function& function) {
+  if (IsSpecializable(function)) {
+    return false;
+  }
+  auto [params, return_type] = GetSignature(function);
+  if (params.empty()) {
+    return false;
+  }
+  for (const Param* param : params) {
+    if (!IsNativelyRepresentable(*param->GetType())) {
+      return false;
+    }
+  }
+  return IsNativelyRepresentable(*return_type);
+}
+
+// Names and defines the C++ types mirroring the native layout of XLS types.
+// Each distinct tuple type gets a struct "TupleN" with members e0, e1, ...
+// which is defined in the wrapper class.
+class NativeTypeGenerator {
+ public:
+  // `scope` is prepended to the names of the generated structs, e.g.,
+  // "MyClass::" for use outside the class definition.
+  explicit NativeTypeGenerator(std::string_view scope) : scope_(scope) {}
+
+  // Returns the C++ type for the given type, creating struct definitions for
+  // any tuple types encountered.
+  std::string GetTypeName(const Type& type) {
+    std::string type_string;
+    if (MatchUint(type, &type_string)) {
+      return type_string;
+    }
+    if (type.IsArray()) {
+      const ArrayType* array_type = type.AsArrayOrDie();
+      return absl::StrFormat("std::array<%s, %d>",
+                             GetTypeName(*array_type->element_type()),
+                             array_type->size());
+    }
+    XLS_CHECK(type.IsTuple()) << type.ToString();
+    std::string key = type.ToString();
+    auto it = struct_names_.find(key);
+    if (it != struct_names_.end()) {
+      return absl::StrCat(scope_, it->second);
+    }
+    const TupleType* tuple_type = type.AsTupleOrDie();
+    std::vector<std::string> members;
+    for (int64_t i = 0; i < tuple_type->size(); ++i) {
+      members.push_back(absl::StrFormat(
+          "    %s e%d;", GetTypeName(*tuple_type->element_type(i)), i));
+    }
+    std::string name = absl::StrCat("Tuple", struct_names_.size());
+    struct_names_[key] = name;
+    definitions_.push_back(absl::StrFormat(
+        "  // Mirrors %s.\n  struct %s {\n%s\n  };", key, name,
+        absl::StrJoin(members, "\n")));
+    return absl::StrCat(scope_, name);
+  }
+
+  // Returns the struct definitions created so far. Structs are defined after
+  // the structs of their elements.
+  std::string GetDefinitions() const {
+    return absl::StrJoin(definitions_, "\n");
+  }
+
+ private:
+  std::string scope_;
+  absl::flat_hash_map<std::string, std::string> struct_names_;
+  std::vector<std::string> definitions_;
+};
+
+// Returns code which clears the bits of `expr` (of the native C++ type of
+// `type`) which lie above the bit widths of the XLS type. The JIT requires
+// these bits to be zero. Returns an empty string if no masking is necessary.
+std::string NativeMaskingCode(std::string_view expr, const Type& type,
+                              int64_t depth = 0) {
+  if (type.IsBits()) {
+    int64_t bit_count = type.GetFlatBitCount();
+    if (bit_count == 8 || bit_count == 16 || bit_count == 32 ||
+        bit_count == 64) {
+      return "";
+    }
+    if (bit_count == 0) {
+      return absl::StrFormat("%s = 0;", expr);
+    }
+    return absl::StrFormat("%s &= 0x%x;", expr,
+                           (uint64_t{1} << bit_count) - 1);
+  }
+  if (type.IsArray()) {
+    std::string element = absl::StrCat("_e", depth);
+    std::string element_masking = NativeMaskingCode(
+        element, *type.AsArrayOrDie()->element_type(), depth + 1);
+    if (element_masking.empty()) {
+      return "";
+    }
+    return absl::StrFormat("for (auto& %s : %s) { %s }", element, expr,
+                           element_masking);
+  }
+  XLS_CHECK(type.IsTuple()) << type.ToString();
+  const TupleType* tuple_type = type.AsTupleOrDie();
+  std::vector<std::string> element_maskings;
+  for (int64_t i = 0; i < tuple_type->size(); ++i) {
+    std::string element_masking =
+        NativeMaskingCode(absl::StrFormat("%s.e%d", expr, i),
+                          *tuple_type->element_type(i), depth);
+    if (!element_masking.empty()) {
+      element_maskings.push_back(element_masking);
+    }
+  }
+  return absl::StrJoin(element_maskings, " ");
+}
+
+// Returns the declaration of the native interface of the given function, e.g.,
+//
+//   absl::StatusOr<Tuple0> Run(const std::array<uint32_t, 4>& x);
+//
+// or an empty string if the function has no native interface.
+std::string CreateDeclNative(const Function& function,
+                             NativeTypeGenerator& types,
+                             std::string prepend_class_name = "") {
+  if (!HasNativeInterface(function)) {
+    return "";
+  }
+  auto [params, return_type] = GetSignature(function);
+  std::vector<std::string> param_strs;
+  for (const Param* param : params) {
+    param_strs.push_back(absl::StrFormat(
+        "const %s& %s", types.GetTypeName(*param->GetType()), param->name()));
+  }
+  if (!prepend_class_name.empty()) {
+    absl::StrAppend(&prepend_class_name, "::");
+  }
+  return absl::StrFormat("absl::StatusOr<%s> %sRun(%s);",
+                         types.GetTypeName(*return_type), prepend_class_name,
+                         absl::StrJoin(param_strs, ", "));
+}
+
+// Returns the implementation of the native interface of the given function or
+// an empty string if the function has none. Arguments are passed to the JIT by
+// pointer and the result is written directly into the returned object; no
+// xls::Values are created. Only arguments with XLS bit widths narrower than
+// their C++ types are copied (to clear the unused high bits).
+std::string CreateImplNative(const Function& function,
+                             std::string_view class_name) {
+  if (!HasNativeInterface(function)) {
+    return "";
+  }
+  NativeTypeGenerator types(absl::StrCat(class_name, "::"));
+  std::string signature =
+      CreateDeclNative(function, types, std::string(class_name));
+  signature.pop_back();
+
+  bool implicit_token_convention = false;
+  auto [params, return_type] =
+      GetSignature(function, &implicit_token_convention);
+
+  std::vector<std::string> locals;
+  std::vector<std::string> arg_ptrs;
+  if (implicit_token_convention) {
+    locals.push_back("  uint8_t _token = 0;");
+    locals.push_back("  uint8_t _activated = 1;");
+    arg_ptrs.push_back("&_token");
+    arg_ptrs.push_back("&_activated");
+  }
+  for (const Param* param : params) {
+    std::string masked_name = absl::StrCat("_", param->name());
+    std::string masking = NativeMaskingCode(masked_name, *param->GetType());
+    std::string arg_name(param->name());
+    if (!masking.empty()) {
+      locals.push_back(absl::StrFormat(
+          "  %s %s = %s;", types.GetTypeName(*param->GetType()), masked_name,
+          param->name()));
+      locals.push_back(absl::StrCat("  ", masking));
+      arg_name = masked_name;
+    }
+    arg_ptrs.push_back(absl::StrFormat(
+        "const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(&%s))",
+        arg_name));
+  }
+
+  // With the implicit token calling convention the JIT returns the tuple
+  // (token, value). The token is zero-sized so the value lies at the
+  // start of the result buffer.
+  std::string result_masking = NativeMaskingCode("_result", *return_type);
+  return absl::StrFormat(R"(%s {
+%s
+  uint8_t* _args[] = {%s};
+  %s _result;
+  xls::InterpreterEvents _events;
+  XLS_RETURN_IF_ERROR(jit_->RunWithViews(
+      _args,
+      absl::MakeSpan(reinterpret_cast<uint8_t*>(&_result), sizeof(_result)),
+      &_events));
+  XLS_RETURN_IF_ERROR(xls::InterpreterEventsToStatus(_events));
+  %s
+  return _result;
+})",
+                         signature, absl::StrJoin(locals, "\n"),
+                         absl::StrJoin(arg_ptrs, ", "),
+                         types.GetTypeName(*return_type), result_masking);
+}
+
+// Returns checks, run when the wrapper is created, that the native C++ types
+// have the same sizes as the JIT's buffers.
+std::string CreateNativeLayoutChecks(const Function& function,
+                                     std::string_view class_name) {
+  if (!HasNativeInterface(function)) {
+    return "";
+  }
+  NativeTypeGenerator types(absl::StrCat(class_name, "::"));
+  bool implicit_token_convention = false;
+  auto [params, return_type] =
+      GetSignature(function, &implicit_token_convention);
+  int64_t first_param = implicit_token_convention ? 2 : 0;
+  std::vector<std::string> checks;
+  for (int64_t i = 0; i < params.size(); ++i) {
+    checks.push_back(absl::StrFormat(
+        "  XLS_RET_CHECK_EQ(jit->GetArgTypeSize(%d), sizeof(%s));",
+        first_param + i, types.GetTypeName(*params[i]->GetType())));
+  }
+  checks.push_back(absl::StrFormat(
+      "  XLS_RET_CHECK_EQ(jit->GetReturnTypeSize(), sizeof(%s));",
+      types.GetTypeName(*return_type)));
+  return absl::StrJoin(checks, "\n");
+}
+
 }  // namespace
 
 std::string GenerateWrapperHeader(const Function& function,
@@ -333,11 +590,16 @@ std::string GenerateWrapperHeader(const Function& function,
   //  {{specialization}} : Any interfaces for specially-matched types, e.g., an
   //       interface that takes a float for a
   //       PackedTupleView<PackedBitsView<1>,...>.
+  //  {{native_types}} : Structs mirroring the tuple types of the native
+  //       interface (if any).
+  //  {{native}} : Interface taking native C++ types (if any).
   //  {{header_guard}} : Header guard.
   constexpr const char kHeaderTemplate[] =
       R"(// Automatically-generated file! DO NOT EDIT!
 #ifndef {{header_guard}}
 #define {{header_guard}}
+#include <array>
+#include <cstdint>
 #include <memory>
 
 #include "absl/status/status.h"
@@ -350,12 +612,14 @@ namespace {{namespace}} {
 // JIT execution wrapper for the {{function_name}} XLS IR module.
 class {{class_name}} {
  public:
+{{native_types}}
   static absl::StatusOr<std::unique_ptr<{{class_name}}>> Create();
   xls::FunctionJit* jit() { return jit_.get(); }
 
   absl::StatusOr<xls::Value> Run({{params}});
   absl::Status Run({{packed_params}});
   {{specialization}}
+  {{native}}
 
  private:
   {{class_name}}(std::unique_ptr<xls::Package> package,
@@ -400,6 +664,9 @@ class {{class_name}} {
   substitution_map["{{packed_params}}"] =
       absl::StrJoin(packed_param_strs, ", ");
   substitution_map["{{specialization}}"] = CreateDeclSpecialization(function);
+  NativeTypeGenerator native_types(/*scope=*/"");
+  substitution_map["{{native}}"] = CreateDeclNative(function, native_types);
+  substitution_map["{{native_types}}"] = native_types.GetDefinitions();
   substitution_map["{{header_guard}}"] = header_guard;
   return absl::StrReplaceAll(kHeaderTemplate, substitution_map);
 }
@@ -420,13 +687,17 @@ std::string GenerateWrapperSource(const Function& function,
   //  {{run_params}} : Packed Run() params
   //  {{run_packed_params}} : Packed RunWithPackedViews() arguments
   //  {{specialization}} : Specially-matched type implementations (if any)
+  //  {{native}} : Native type interface implementation (if any)
+  //  {{native_checks}} : Layout checks for the native type interface
   //  {{value_locals}}: "Value" routine locals.
   //  {{value_postprocessing}}: "Value" routine postprocessing.
   //  {{packed_locals}}: "Packed" routine locals.
   constexpr const char kSourceTemplate[] =
       R"-(// Automatically-generated file! DO NOT EDIT!
 #include "{{header_path}}"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/events.h"
 #include "xls/ir/ir_parser.h"
 
 namespace {{wrapper_namespace}} {
@@ -439,6 +710,7 @@ absl::StatusOr<std::unique_ptr<{{class_name}}>> {{class_name}}::Create() {
   XLS_ASSIGN_OR_RETURN(xls::Function* function,
                        package->GetFunction("{{function_name}}"));
   XLS_ASSIGN_OR_RETURN(auto jit, xls::FunctionJit::Create(function));
+{{native_checks}}
   return absl::WrapUnique(new {{class_name}}(std::move(package), std::move(jit)));
 }
 
@@ -463,6 +735,8 @@ absl::Status {{class_name}}::Run({{run_params}}) {
 
 {{specialization}}
 
+{{native}}
+
 }  // namespace {{wrapper_namespace}}
 )-";
   std::vector<std::string> param_list;
@@ -519,6 +793,9 @@ absl::Status {{class_name}}::Run({{run_params}}) {
   substitution_map["{{run_params}}"] = packed_params_str;
   substitution_map["{{run_packed_params}}"] = packed_args;
   substitution_map["{{specialization}}"] = specialization;
+  substitution_map["{{native}}"] = CreateImplNative(function, class_name);
+  substitution_map["{{native_checks}}"] =
+      CreateNativeLayoutChecks(function, class_name);
   substitution_map["{{value_locals}}"] = value_locals;
   substitution_map["{{value_postprocessing}}"] = retval_handling;
   substitution_map["{{packed_locals}}"] = packed_locals;
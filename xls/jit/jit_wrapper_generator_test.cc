@@ -27,6 +27,7 @@ namespace xls {
 namespace {
 
 using ::testing::HasSubstr;
+using ::testing::Not;
 
 TEST(JitWrapperGeneratorTest, GeneratesHeaderGuards) {
   constexpr const char kClassName[] = "MyClass";
@@ -197,5 +198,75 @@ fn main(t: token, activated: bits[1], x: bits[32]) -> (token, bits[32]) {
               HasSubstr("absl::StatusOr<xls::Value> Run(xls::Value x)"));
 }
 
+TEST(JitWrapperGeneratorTest, GeneratesNativeAggregates) {
+  constexpr const char kClassName[] = "MyClass";
+  const std::filesystem::path kHeaderPath =
+      "some/silly/genfiles/path/this_is_myclass.h";
+  constexpr const char kNamespace[] = "my_namespace";
+
+  const std::string program = R"(package p
+
+fn main(x: bits[32][4], y: (bits[5], bits[16][2])) -> (bits[32], (bits[5], bits[16][2])) {
+  literal.1: bits[32] = literal(value=0)
+  array_index.2: bits[32] = array_index(x, indices=[literal.1])
+  ret tuple.3: (bits[32], (bits[5], bits[16][2])) = tuple(array_index.2, y)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("main"));
+  GeneratedJitWrapper generated = GenerateJitWrapper(
+      *f, kClassName, kNamespace, kHeaderPath, "some/silly/genfiles/path");
+  EXPECT_THAT(generated.header, HasSubstr("struct Tuple0 {\n"
+                                          "    uint8_t e0;\n"
+                                          "    std::array<uint16_t, 2> e1;\n"
+                                          "  };"));
+  EXPECT_THAT(generated.header, HasSubstr("struct Tuple1 {\n"
+                                          "    uint32_t e0;\n"
+                                          "    Tuple0 e1;\n"
+                                          "  };"));
+  EXPECT_THAT(generated.header,
+              HasSubstr("absl::StatusOr<Tuple1> Run(const std::array<uint32_t, "
+                        "4>& x, const Tuple0& y);"));
+
+  // The arguments are passed by pointer. Only `y` is copied to clear the
+  // unused bits of its 5-bit element.
+  EXPECT_THAT(generated.source,
+              HasSubstr("absl::StatusOr<MyClass::Tuple1> MyClass::Run("
+                        "const std::array<uint32_t, 4>& x, "
+                        "const MyClass::Tuple0& y)"));
+  EXPECT_THAT(generated.source, HasSubstr("MyClass::Tuple0 _y = y;"));
+  EXPECT_THAT(generated.source, HasSubstr("_y.e0 &= 0x1f;"));
+  EXPECT_THAT(generated.source, Not(HasSubstr("_x = x;")));
+  EXPECT_THAT(generated.source, HasSubstr("jit_->RunWithViews("));
+  EXPECT_THAT(generated.source,
+              HasSubstr("XLS_RET_CHECK_EQ(jit->GetArgTypeSize(1), "
+                        "sizeof(MyClass::Tuple0));"));
+}
+
+TEST(JitWrapperGeneratorTest, NoNativeInterfaceForWideBits) {
+  constexpr const char kClassName[] = "MyClass";
+  const std::filesystem::path kHeaderPath =
+      "some/silly/genfiles/path/this_is_myclass.h";
+  constexpr const char kNamespace[] = "my_namespace";
+
+  const std::string program = R"(package p
+
+fn main(x: bits[65][2]) -> bits[65][2] {
+  ret identity.2: bits[65][2] = identity(x)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("main"));
+  GeneratedJitWrapper generated = GenerateJitWrapper(
+      *f, kClassName, kNamespace, kHeaderPath, "some/silly/genfiles/path");
+  EXPECT_THAT(generated.header, Not(HasSubstr("std::array")));
+  EXPECT_THAT(generated.source, Not(HasSubstr("RunWithViews")));
+}
+
 }  // namespace
 }  // namespace xls
+
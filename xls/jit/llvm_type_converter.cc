@@ -39,6 +39,10 @@ int64_t LlvmTypeConverter::GetLlvmBitCount(int64_t xls_bit_count) const {
 }
 
 llvm::Type* LlvmTypeConverter::ConvertToLlvmType(const Type* xls_type) const {
+  auto it = type_cache_.find(xls_type);
+  if (it != type_cache_.end()) {
+    return it->second;
+  }
   llvm::Type* llvm_type;
   if (xls_type->IsBits()) {
     llvm_type = llvm::IntegerType::get(
@@ -66,6 +70,7 @@ llvm::Type* LlvmTypeConverter::ConvertToLlvmType(const Type* xls_type) const {
     XLS_LOG(FATAL) << absl::StrCat("Type not supported for LLVM conversion: %s",
                                    xls_type->ToString());
   }
+  type_cache_[xls_type] = llvm_type;
   return llvm_type;
 }
 
@@ -163,7 +168,33 @@ absl::StatusOr<llvm::Constant*> LlvmTypeConverter::ToIntegralConstant(
 }
 
 int64_t LlvmTypeConverter::GetTypeByteSize(const Type* type) const {
-  return data_layout_.getTypeAllocSize(ConvertToLlvmType(type)).getFixedSize();
+  auto it = byte_size_cache_.find(type);
+  if (it != byte_size_cache_.end()) {
+    return it->second;
+  }
+  int64_t byte_size =
+      data_layout_.getTypeAllocSize(ConvertToLlvmType(type)).getFixedSize();
+  byte_size_cache_[type] = byte_size;
+  return byte_size;
+}
+
+int64_t LlvmTypeConverter::GetElementOffset(const Type* type,
+                                            int64_t index) const {
+  if (type->IsArray()) {
+    return index * GetTypeByteSize(type->AsArrayOrDie()->element_type());
+  }
+  XLS_CHECK(type->IsTuple()) << type->ToString();
+  auto it = tuple_offset_cache_.find(type);
+  if (it == tuple_offset_cache_.end()) {
+    const llvm::StructLayout* layout = data_layout_.getStructLayout(
+        llvm::cast<llvm::StructType>(ConvertToLlvmType(type)));
+    std::vector<int64_t> offsets(type->AsTupleOrDie()->size());
+    for (int64_t i = 0; i < offsets.size(); ++i) {
+      offsets[i] = layout->getElementOffset(i);
+    }
+    it = tuple_offset_cache_.emplace(type, std::move(offsets)).first;
+  }
+  return it->second.at(index);
 }
 
 llvm::Type* LlvmTypeConverter::GetTokenType() const {
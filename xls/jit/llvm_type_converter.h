@@ -16,6 +16,7 @@
 #define XLS_JIT_LLVM_TYPE_CONVERTER_H_
 
 #include <cstdint>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
@@ -29,6 +30,10 @@ namespace xls {
 // into the corresponding LLVM elements.
 //
 // This class must live as long as its constructor argument module.
+//
+// Type conversions, byte sizes and element offsets are memoized per XLS type.
+// The caches are keyed by pointer so the XLS types passed to the converter
+// must outlive it. The converter is not thread-safe.
 class LlvmTypeConverter {
  public:
   LlvmTypeConverter(llvm::LLVMContext* context,
@@ -66,6 +71,10 @@ class LlvmTypeConverter {
   // DataLayout object can handle ~all of the work for us.
   int64_t GetTypeByteSize(const Type* type) const;
 
+  // Returns the byte offset of the element at `index` within the LLVM
+  // representation of the given tuple or array type.
+  int64_t GetElementOffset(const Type* type, int64_t index) const;
+
   // Returns a new Value representing the LLVM form of a Token.
   llvm::Value* GetToken() const;
 
@@ -133,6 +142,11 @@ class LlvmTypeConverter {
 
   llvm::LLVMContext& context_;
   llvm::DataLayout data_layout_;
+
+  mutable TypeCache type_cache_;
+  mutable absl::flat_hash_map<const Type*, int64_t> byte_size_cache_;
+  mutable absl::flat_hash_map<const Type*, std::vector<int64_t>>
+      tuple_offset_cache_;
 };
 
 }  // namespace xls
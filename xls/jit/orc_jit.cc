@@ -14,32 +14,42 @@
 
 #include "xls/jit/orc_jit.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm-c/Target.h"
 #include "llvm/include/llvm/ADT/StringExtras.h"
+#include "llvm/include/llvm/ADT/StringMap.h"
+#include "llvm/include/llvm/Config/llvm-config.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
 #include "llvm/include/llvm/Analysis/LoopAnalysisManager.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutionUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/TaskDispatch.h"
 #include "llvm/include/llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
 #include "llvm/include/llvm/IR/PassManager.h"
 #include "llvm/include/llvm/Passes/OptimizationLevel.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
+#include "llvm/include/llvm/Support/Host.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
@@ -85,18 +95,98 @@ class BadOptLevelError : public llvm::ErrorInfo<BadOptLevelError> {
 
 char BadOptLevelError::ID;
 
+// Returns the executor process control for the JIT's execution session. If
+// `concurrent` is true, materialization tasks (and hence optimization and
+// compilation of modules) are dispatched to a thread pool.
+std::unique_ptr<llvm::orc::ExecutorProcessControl> CreateExecutorProcessControl(
+    bool concurrent) {
+  std::unique_ptr<llvm::orc::TaskDispatcher> dispatcher;
+#if LLVM_ENABLE_THREADS
+  if (concurrent) {
+    dispatcher = std::make_unique<llvm::orc::DynamicThreadPoolTaskDispatcher>();
+  }
+#endif  // LLVM_ENABLE_THREADS
+  return std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>(
+      /*SSP=*/nullptr, std::move(dispatcher));
+}
+
+// Called by a lazy compilation stub if compilation of the module fails.
+void LazyCompilationFailed() {
+  XLS_LOG(FATAL) << "Lazy compilation of JIT module failed";
+}
+
 }  // namespace
 
-OrcJit::OrcJit(int64_t opt_level, bool emit_object_code)
+bool AbslParseFlag(std::string_view text, JitCompilationMode* mode,
+                   std::string* error) {
+  if (text == "eager") {
+    *mode = JitCompilationMode::kEager;
+    return true;
+  }
+  if (text == "concurrent") {
+    *mode = JitCompilationMode::kConcurrent;
+    return true;
+  }
+  if (text == "lazy") {
+    *mode = JitCompilationMode::kLazy;
+    return true;
+  }
+  *error = "unknown value for enumeration";
+  return false;
+}
+
+std::string AbslUnparseFlag(JitCompilationMode mode) {
+  switch (mode) {
+    case JitCompilationMode::kEager:
+      return "eager";
+    case JitCompilationMode::kConcurrent:
+      return "concurrent";
+    case JitCompilationMode::kLazy:
+      return "lazy";
+  }
+  XLS_LOG(FATAL) << "Unknown JitCompilationMode: " << static_cast<int>(mode);
+}
+
+bool AbslParseFlag(std::string_view text, JitCpuTarget* target,
+                   std::string* error) {
+  if (text == "host") {
+    *target = JitCpuTarget::kHost;
+    return true;
+  }
+  if (text == "generic") {
+    *target = JitCpuTarget::kGeneric;
+    return true;
+  }
+  *error = "unknown value for enumeration";
+  return false;
+}
+
+std::string AbslUnparseFlag(JitCpuTarget target) {
+  switch (target) {
+    case JitCpuTarget::kHost:
+      return "host";
+    case JitCpuTarget::kGeneric:
+      return "generic";
+  }
+  XLS_LOG(FATAL) << "Unknown JitCpuTarget: " << static_cast<int>(target);
+}
+
+OrcJit::OrcJit(int64_t opt_level, bool emit_object_code,
+               std::optional<std::filesystem::path> object_cache_dir,
+               JitCompilationMode compilation_mode,
+               JitCpuTarget cpu_target)
     : context_(std::make_unique<llvm::LLVMContext>()),
-      execution_session_(
-          std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>()),
+      execution_session_(CreateExecutorProcessControl(
+          compilation_mode == JitCompilationMode::kConcurrent)),
       object_layer_(
           execution_session_,
           []() { return std::make_unique<llvm::SectionMemoryManager>(); }),
       dylib_(execution_session_.createBareJITDylib("main")),
       opt_level_(opt_level),
       emit_object_code_(emit_object_code),
+      object_cache_dir_(std::move(object_cache_dir)),
+      compilation_mode_(compilation_mode),
+      cpu_target_(cpu_target),
       data_layout_("") {}
 
 OrcJit::~OrcJit() {
@@ -117,7 +207,24 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   llvm::FunctionAnalysisManager fam;
   llvm::LoopAnalysisManager lam;
   llvm::ModuleAnalysisManager mam;
-  llvm::PassBuilder pass_builder;
+
+  // Give the passes the target machine so that cost models (e.g., of the
+  // vectorizers and instcombine) reflect the features of the target CPU. With
+  // concurrent compilation the optimizer runs on multiple threads at once and
+  // target machines are not thread-safe so create one for this module.
+  std::unique_ptr<llvm::TargetMachine> module_target_machine;
+  llvm::TargetMachine* target_machine = target_machine_.get();
+  if (compilation_mode_ == JitCompilationMode::kConcurrent) {
+    absl::StatusOr<std::unique_ptr<llvm::TargetMachine>> tm_or =
+        CreateTargetMachine(cpu_target_);
+    if (!tm_or.ok()) {
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     std::string{tm_or.status().message()});
+    }
+    module_target_machine = std::move(tm_or).value();
+    target_machine = module_target_machine.get();
+  }
+  llvm::PassBuilder pass_builder(target_machine);
 
   pass_builder.registerModuleAnalyses(mam);
   pass_builder.registerCGSCCAnalyses(cgam);
@@ -155,6 +262,15 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
 
   if (XLS_VLOG_IS_ON(3)) {
+    // The optimizer may run concurrently on multiple modules and target
+    // machines are not thread-safe so use a separate one for dumping assembly.
+    absl::StatusOr<std::unique_ptr<llvm::TargetMachine>> asm_target_machine =
+        CreateTargetMachine(cpu_target_);
+    if (!asm_target_machine.ok()) {
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          std::string{asm_target_machine.status().message()});
+    }
     // The ostream and its buffer must be declared before the
     // module_pass_manager because the destrutor of the pass manager calls flush
     // on the ostream so these must be destructed *after* the pass manager. C++
@@ -163,8 +279,9 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
     llvm::SmallVector<char, 0> stream_buffer;
     llvm::raw_svector_ostream ostream(stream_buffer);
     llvm::legacy::PassManager mpm;
-    if (target_machine_->addPassesToEmitFile(mpm, ostream, nullptr,
-                                             llvm::CGFT_AssemblyFile)) {
+    if ((*asm_target_machine)
+            ->addPassesToEmitFile(mpm, ostream, nullptr,
+                                  llvm::CGFT_AssemblyFile)) {
       XLS_VLOG(3) << "Could not create ASM generation pass!";
     }
     mpm.run(*bare_module);
@@ -175,34 +292,64 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   return module;
 }
 
-absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(int64_t opt_level,
-                                                       bool emit_object_code) {
+absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
+    int64_t opt_level, bool emit_object_code,
+    std::optional<std::filesystem::path> object_cache_dir,
+    JitCompilationMode compilation_mode, JitCpuTarget cpu_target) {
+  XLS_RET_CHECK(!emit_object_code ||
+                compilation_mode == JitCompilationMode::kEager)
+      << "Object code emission is only supported with eager compilation";
   absl::call_once(once, OnceInit);
-  std::unique_ptr<OrcJit> jit =
-      absl::WrapUnique(new OrcJit(opt_level, emit_object_code));
+  std::unique_ptr<OrcJit> jit = absl::WrapUnique(
+      new OrcJit(opt_level, emit_object_code, std::move(object_cache_dir),
+                 compilation_mode, cpu_target));
   XLS_RETURN_IF_ERROR(jit->Init());
   return std::move(jit);
 }
 
 /* static */ absl::StatusOr<llvm::DataLayout> OrcJit::CreateDataLayout() {
   absl::call_once(once, OnceInit);
+  // The data layout depends only on the target triple, not the CPU features.
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::TargetMachine> target_machine,
-                       CreateTargetMachine());
+                       CreateTargetMachine(JitCpuTarget::kHost));
   return target_machine->createDataLayout();
 }
 
-/* static */ absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
-OrcJit::CreateTargetMachine() {
-  auto error_or_target_builder =
-      llvm::orc::JITTargetMachineBuilder::detectHost();
-  if (!error_or_target_builder) {
-    return absl::InternalError(
-        absl::StrCat("Unable to detect host: ",
-                     llvm::toString(error_or_target_builder.takeError())));
+/* static */ absl::StatusOr<llvm::orc::JITTargetMachineBuilder>
+OrcJit::CreateTargetMachineBuilder(JitCpuTarget cpu_target) {
+  llvm::orc::JITTargetMachineBuilder target_builder(
+      llvm::Triple(llvm::sys::getProcessTriple()));
+  if (cpu_target == JitCpuTarget::kHost) {
+    llvm::StringMap<bool> host_features;
+    if (!llvm::sys::getHostCPUFeatures(host_features)) {
+      XLS_LOG(WARNING)
+          << "Unable to detect host CPU features; generating code for the "
+             "baseline features of "
+          << llvm::sys::getProcessTriple();
+    }
+    // Sort the features so the feature string (which is part of the object
+    // cache key) is deterministic.
+    std::vector<std::string> features;
+    for (const auto& feature : host_features) {
+      features.push_back(
+          absl::StrCat(feature.second ? "+" : "-", feature.first().str()));
+    }
+    std::sort(features.begin(), features.end());
+    target_builder.addFeatures(features);
+    target_builder.setCPU(std::string{llvm::sys::getHostCPUName()});
+  } else {
+    target_builder.setCPU("generic");
   }
 
-  error_or_target_builder->setRelocationModel(llvm::Reloc::Model::PIC_);
-  auto error_or_target_machine = error_or_target_builder->createTargetMachine();
+  target_builder.setRelocationModel(llvm::Reloc::Model::PIC_);
+  return target_builder;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
+OrcJit::CreateTargetMachine(JitCpuTarget cpu_target) {
+  XLS_ASSIGN_OR_RETURN(llvm::orc::JITTargetMachineBuilder target_builder,
+                       CreateTargetMachineBuilder(cpu_target));
+  auto error_or_target_machine = target_builder.createTargetMachine();
   if (!error_or_target_machine) {
     return absl::InternalError(
         absl::StrCat("Unable to create target machine: ",
@@ -212,8 +359,20 @@ OrcJit::CreateTargetMachine() {
   return std::move(error_or_target_machine.get());
 }
 
+std::string_view OrcJit::target_cpu() const {
+  llvm::StringRef cpu = target_machine_->getTargetCPU();
+  return std::string_view(cpu.data(), cpu.size());
+}
+
+std::string_view OrcJit::target_features() const {
+  llvm::StringRef features = target_machine_->getTargetFeatureString();
+  return std::string_view(features.data(), features.size());
+}
+
 absl::Status OrcJit::Init() {
-  XLS_ASSIGN_OR_RETURN(target_machine_, CreateTargetMachine());
+  XLS_ASSIGN_OR_RETURN(target_machine_, CreateTargetMachine(cpu_target_));
+  XLS_VLOG(1) << "JIT target CPU: " << target_cpu();
+  XLS_VLOG(2) << "JIT target features: " << target_features();
   data_layout_ = target_machine_->createDataLayout();
 
   execution_session_.runSessionLocked([this]() {
@@ -222,7 +381,27 @@ absl::Status OrcJit::Init() {
             data_layout_.getGlobalPrefix())));
   });
 
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  if (object_cache_dir_.has_value()) {
+    // The cache sits below the optimizer in the layer stack so it is keyed on
+    // (and only short-circuits code generation of) the optimized module.
+    XLS_ASSIGN_OR_RETURN(
+        object_cache_,
+        JitObjectCache::Create(*object_cache_dir_, opt_level_,
+                               target_machine_->getTargetTriple().str(),
+                               target_cpu(), target_features()));
+  }
+
+  std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler> compiler;
+  if (compilation_mode_ == JitCompilationMode::kConcurrent) {
+    // ConcurrentIRCompiler creates a target machine for each compilation.
+    XLS_ASSIGN_OR_RETURN(llvm::orc::JITTargetMachineBuilder target_builder,
+                         CreateTargetMachineBuilder(cpu_target_));
+    compiler = std::make_unique<llvm::orc::ConcurrentIRCompiler>(
+        std::move(target_builder), object_cache_.get());
+  } else {
+    compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_,
+                                                           object_cache_.get());
+  }
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
       execution_session_, object_layer_, std::move(compiler));
 
@@ -257,6 +436,28 @@ absl::Status OrcJit::Init() {
         return Optimizer(std::move(module), responsibility);
       });
 
+  if (compilation_mode_ == JitCompilationMode::kLazy) {
+    const llvm::Triple& triple = target_machine_->getTargetTriple();
+    auto lazy_call_through_manager =
+        llvm::orc::createLocalLazyCallThroughManager(
+            triple, execution_session_,
+            llvm::pointerToJITTargetAddress(&LazyCompilationFailed));
+    if (!lazy_call_through_manager) {
+      return absl::InternalError(absl::StrCat(
+          "Unable to create lazy call-through manager: ",
+          llvm::toString(lazy_call_through_manager.takeError())));
+    }
+    lazy_call_through_manager_ = std::move(lazy_call_through_manager.get());
+    compile_on_demand_layer_ =
+        std::make_unique<llvm::orc::CompileOnDemandLayer>(
+            execution_session_, *transform_layer_, *lazy_call_through_manager_,
+            llvm::orc::createLocalIndirectStubsManagerBuilder(triple));
+    // Modules are compiled as a unit. Splitting modules into per-function
+    // partitions would prevent node functions from being inlined.
+    compile_on_demand_layer_->setPartitionFunction(
+        llvm::orc::CompileOnDemandLayer::compileWholeModule);
+  }
+
   return absl::OkStatus();
 }
 
@@ -311,8 +512,17 @@ absl::Status VerifyModule(const llvm::Module& module) {
 
 absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
-  llvm::Error error = transform_layer_->add(
-      dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
+  llvm::orc::ThreadSafeModule thread_safe_module(std::move(module), context_);
+  if (compilation_mode_ == JitCompilationMode::kConcurrent) {
+    // Materializing a module locks its context so give each module its own
+    // context to enable modules to be optimized and compiled in parallel.
+    thread_safe_module = llvm::orc::cloneToNewContext(thread_safe_module);
+  }
+  llvm::orc::IRLayer* layer =
+      compilation_mode_ == JitCompilationMode::kLazy
+          ? static_cast<llvm::orc::IRLayer*>(compile_on_demand_layer_.get())
+          : static_cast<llvm::orc::IRLayer*>(transform_layer_.get());
+  llvm::Error error = layer->add(dylib_, std::move(thread_safe_module));
   if (error) {
     return absl::UnknownError(absl::StrFormat(
         "Error compiling converted IR: %s", llvm::toString(std::move(error))));
@@ -332,6 +542,44 @@ absl::StatusOr<llvm::JITTargetAddress> OrcJit::LoadSymbol(
   return symbol->getAddress();
 }
 
+absl::Status OrcJit::DefineAbsoluteSymbol(std::string_view name,
+                                          const void* address) {
+  llvm::orc::SymbolMap symbols;
+  symbols[execution_session_.intern(name)] = llvm::JITEvaluatedSymbol(
+      llvm::pointerToJITTargetAddress(address), llvm::JITSymbolFlags::Exported);
+  llvm::Error error =
+      dylib_.define(llvm::orc::absoluteSymbols(std::move(symbols)));
+  if (error) {
+    return absl::InternalError(
+        absl::StrFormat("Could not define symbol \"%s\": %s", name,
+                        llvm::toString(std::move(error))));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<llvm::JITTargetAddress>> OrcJit::LoadSymbols(
+    absl::Span<const std::string> function_names) {
+  llvm::orc::SymbolLookupSet lookup_set;
+  for (const std::string& name : function_names) {
+    lookup_set.add(execution_session_.intern(name));
+  }
+  llvm::Expected<llvm::orc::SymbolMap> symbols = execution_session_.lookup(
+      llvm::orc::makeJITDylibSearchOrder(&dylib_), std::move(lookup_set));
+  if (!symbols) {
+    return absl::InternalError(
+        absl::StrFormat("Could not find symbols [%s]: %s",
+                        absl::StrJoin(function_names, ", "),
+                        llvm::toString(symbols.takeError())));
+  }
+  std::vector<llvm::JITTargetAddress> addresses;
+  for (const std::string& name : function_names) {
+    auto it = symbols->find(execution_session_.intern(name));
+    XLS_RET_CHECK(it != symbols->end()) << name;
+    addresses.push_back(it->second.getAddress());
+  }
+  return addresses;
+}
+
 std::string DumpLlvmModuleToString(const llvm::Module& module) {
   std::string buffer;
   llvm::raw_string_ostream ostream(buffer);
@@ -15,19 +15,65 @@
 #ifndef XLS_JIT_ORC_JIT_H_
 #define XLS_JIT_ORC_JIT_H_
 
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/LazyReexports.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_type_converter.h"
 
 namespace xls {
 
+// How the JIT compiles the modules passed to OrcJit::CompileModule.
+enum class JitCompilationMode {
+  // Modules are optimized and compiled on the calling thread when their
+  // symbols are first looked up.
+  kEager,
+  // Modules are optimized and compiled in parallel on a thread pool. Each
+  // module is moved to its own LLVM context to allow this.
+  kConcurrent,
+  // Compilation of each module is deferred until one of its functions is first
+  // called. Looking up a symbol returns the address of a stub which compiles
+  // the module on first call and then jumps to the compiled code.
+  kLazy,
+};
+
+bool AbslParseFlag(std::string_view text, JitCompilationMode* mode,
+                   std::string* error);
+std::string AbslUnparseFlag(JitCompilationMode mode);
+
+// The CPU which the JIT generates code for.
+enum class JitCpuTarget {
+  // The host CPU. The host CPU model and its features (e.g., AVX2, AVX-512,
+  // BMI2, LZCNT) are detected at runtime and both the LLVM optimization passes
+  // and code generation are tuned for them. Code compiled this way may not run
+  // on other machines.
+  kHost,
+  // A generic CPU of the host architecture using only the baseline features
+  // of the target triple. Useful for object code which is shared across
+  // machines.
+  kGeneric,
+};
+
+bool AbslParseFlag(std::string_view text, JitCpuTarget* target,
+                   std::string* error);
+std::string AbslUnparseFlag(JitCpuTarget target);
+
 // A wrapper around ORC JIT which hides some of the internals of the LLVM
 // interface.
 class OrcJit {
@@ -35,9 +81,22 @@ class OrcJit {
   ~OrcJit();
   // Create an LLVM ORC JIT instance which compiles at the given optimization
   // level. If `emit_object_code` is true then `GetObjectCode` can be called
-  // after compilation to get the object code.
+  // after compilation to get the object code. If `object_cache_dir` is given
+  // then compiled object code is persisted in (and reused from) that directory
+  // across JIT instances and processes. See JitObjectCache.
+  //
+  // `compilation_mode` determines when and where modules are compiled (see
+  // JitCompilationMode). Symbols referenced across modules are resolved
+  // through the JIT's dylib. Only kEager is supported with `emit_object_code`
+  // which captures the object code of a single module.
+  //
+  // `cpu_target` selects the CPU model and features code is generated for (see
+  // JitCpuTarget). Both are part of the object cache key.
   static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
-      int64_t opt_level = 3, bool emit_object_code = false);
+      int64_t opt_level = 3, bool emit_object_code = false,
+      std::optional<std::filesystem::path> object_cache_dir = std::nullopt,
+      JitCompilationMode compilation_mode = JitCompilationMode::kEager,
+      JitCpuTarget cpu_target = JitCpuTarget::kHost);
 
   // Creates and returns a new LLVM module of the given name.
   std::unique_ptr<llvm::Module> NewModule(std::string_view name);
@@ -49,6 +108,26 @@ class OrcJit {
   absl::StatusOr<llvm::JITTargetAddress> LoadSymbol(
       std::string_view function_name);
 
+  // Returns the addresses of the given JIT'ed functions in the same order. The
+  // lookup is issued as a single query so, with concurrent compilation, the
+  // modules defining the functions are compiled in parallel.
+  absl::StatusOr<std::vector<llvm::JITTargetAddress>> LoadSymbols(
+      absl::Span<const std::string> function_names);
+
+  // Defines the symbol `name` in the JIT's dylib to be at the given host
+  // address. Used to resolve references to functions which generated code
+  // calls by name rather than by baked-in address.
+  absl::Status DefineAbsoluteSymbol(std::string_view name,
+                                    const void* address);
+
+  JitCompilationMode compilation_mode() const { return compilation_mode_; }
+  JitCpuTarget cpu_target() const { return cpu_target_; }
+
+  // Returns the name of the CPU and the comma-separated feature string (e.g.,
+  // "+avx2,+bmi2,...") which code is generated for.
+  std::string_view target_cpu() const;
+  std::string_view target_features() const;
+
   // Return the underlying LLVM context.
   llvm::LLVMContext* GetContext() { return context_.getContext(); }
 
@@ -56,15 +135,23 @@ class OrcJit {
   // call (if `emit_object_code` is true).
   const std::vector<uint8_t>& GetObjectCode() { return object_code_; }
 
+  // Returns the on-disk object cache or nullptr if no cache directory was
+  // specified.
+  JitObjectCache* object_cache() { return object_cache_.get(); }
+
   // Creates and returns a data layout object.
   static absl::StatusOr<llvm::DataLayout> CreateDataLayout();
 
  private:
-  OrcJit(int64_t opt_level, bool emit_object_code);
+  OrcJit(int64_t opt_level, bool emit_object_code,
+         std::optional<std::filesystem::path> object_cache_dir,
+         JitCompilationMode compilation_mode, JitCpuTarget cpu_target);
   absl::Status Init();
 
+  static absl::StatusOr<llvm::orc::JITTargetMachineBuilder>
+  CreateTargetMachineBuilder(JitCpuTarget cpu_target);
   static absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
-  CreateTargetMachine();
+  CreateTargetMachine(JitCpuTarget cpu_target);
 
   // Method which optimizes the given module. Used within the JIT to form an IR
   // transform layer.
@@ -79,15 +166,26 @@ class OrcJit {
 
   int64_t opt_level_;
   bool emit_object_code_;
+  std::optional<std::filesystem::path> object_cache_dir_;
+  JitCompilationMode compilation_mode_;
+  JitCpuTarget cpu_target_;
 
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   llvm::DataLayout data_layout_;
 
+  // Must outlive the compile layer which holds a pointer to it.
+  std::unique_ptr<JitObjectCache> object_cache_;
+
   std::unique_ptr<llvm::orc::IRCompileLayer> compile_layer_;
   std::unique_ptr<llvm::orc::IRTransformLayer> transform_layer_;
   // If set, this contains the logic to emit object code.
   std::unique_ptr<llvm::orc::IRTransformLayer> object_code_layer_;
 
+  // Used in lazy compilation mode to replace the functions of each module with
+  // stubs which compile the module on first call.
+  std::unique_ptr<llvm::orc::LazyCallThroughManager> lazy_call_through_manager_;
+  std::unique_ptr<llvm::orc::CompileOnDemandLayer> compile_on_demand_layer_;
+
   // When `CompileModule` is called and `emit_object_code` is true, this vector
   // will be allocated and filled with the object code of the compiled module.
   std::vector<uint8_t> object_code_;
@@ -14,6 +14,7 @@
 
 #include "xls/jit/proc_jit.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -27,16 +28,27 @@
 
 namespace xls {
 
-ProcJitContinuation::ProcJitContinuation(Proc* proc, int64_t temp_buffer_size,
-                                         JitRuntime* jit_runtime)
+ProcJitContinuation::ProcJitContinuation(
+    Proc* proc, int64_t temp_buffer_size, JitRuntime* jit_runtime,
+    absl::Span<const int64_t> in_place_state_indices)
     : proc_(proc), continuation_point_(0), jit_runtime_(jit_runtime) {
+  absl::flat_hash_set<Param*> in_place_params;
+  for (int64_t state_index : in_place_state_indices) {
+    in_place_params.insert(proc->GetStateParam(state_index));
+  }
+
   // Pre-allocate input, output, and temporary buffers.
   for (Param* param : proc->params()) {
     int64_t param_size = jit_runtime_->GetTypeByteSize(param->GetType());
     input_buffers_.push_back(std::vector<uint8_t>(param_size));
-    output_buffers_.push_back(std::vector<uint8_t>(param_size));
     input_ptrs_.push_back(input_buffers_.back().data());
-    output_ptrs_.push_back(output_buffers_.back().data());
+    if (in_place_params.contains(param)) {
+      output_buffers_.push_back(std::vector<uint8_t>());
+      output_ptrs_.push_back(input_ptrs_.back());
+    } else {
+      output_buffers_.push_back(std::vector<uint8_t>(param_size));
+      output_ptrs_.push_back(output_buffers_.back().data());
+    }
   }
 
   // Write initial state value to the input_buffer.
@@ -73,17 +85,83 @@ void ProcJitContinuation::NextTick() {
 
 absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::Create(
     Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr) {
+  return CreateInternal(proc, jit_runtime, queue_mgr,
+                        /*enable_profiling=*/false);
+}
+
+absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::CreateWithProfiling(
+    Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr) {
+  return CreateInternal(proc, jit_runtime, queue_mgr,
+                        /*enable_profiling=*/true);
+}
+
+absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::CreateInternal(
+    Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+    bool enable_profiling) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
   auto jit =
       absl::WrapUnique(new ProcJit(proc, jit_runtime, std::move(orc_jit)));
+  if (enable_profiling) {
+    jit->profile_ = std::make_unique<JitProfile>();
+  }
   XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
-                       BuildProcFunction(proc, queue_mgr, jit->GetOrcJit()));
+                       BuildProcFunction(proc, queue_mgr, jit->GetOrcJit(),
+                                         jit->profile_.get()));
   return jit;
 }
 
+absl::StatusOr<std::vector<std::unique_ptr<ProcJit>>> ProcJit::CreateNetwork(
+    absl::Span<Proc* const> procs, JitRuntime* jit_runtime,
+    JitChannelQueueManager* queue_mgr) {
+  XLS_ASSIGN_OR_RETURN(std::shared_ptr<OrcJit> orc_jit, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(std::vector<JittedFunctionBase> jitted_procs,
+                       BuildProcNetworkFunctions(procs, queue_mgr, *orc_jit));
+  std::vector<std::unique_ptr<ProcJit>> jits;
+  for (int64_t i = 0; i < procs.size(); ++i) {
+    auto jit = absl::WrapUnique(new ProcJit(procs[i], jit_runtime, orc_jit));
+    jit->jitted_function_base_ = std::move(jitted_procs[i]);
+    jits.push_back(std::move(jit));
+  }
+  return jits;
+}
+
+absl::StatusOr<ProcJitObjectCode> ProcJit::CreateObjectCode(Proc* proc) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit,
+                       OrcJit::Create(/*opt_level=*/3,
+                                      /*emit_object_code=*/true));
+  XLS_ASSIGN_OR_RETURN(JittedFunctionBase jitted_function_base,
+                       BuildAotProcFunction(proc, *orc_jit));
+  return ProcJitObjectCode{
+      .function_name = jitted_function_base.function_name,
+      .object_code = orc_jit->GetObjectCode(),
+      .temp_buffer_size = jitted_function_base.temp_buffer_size,
+  };
+}
+
 std::unique_ptr<ProcContinuation> ProcJit::NewContinuation() const {
-  return std::make_unique<ProcJitContinuation>(
-      proc(), jitted_function_base_.temp_buffer_size, jit_runtime_);
+  auto continuation = std::make_unique<ProcJitContinuation>(
+      proc(), jitted_function_base_.temp_buffer_size, jit_runtime_,
+      jitted_function_base_.in_place_state_indices);
+  continuation->GetEvents().trace_collection = trace_collection_;
+  return continuation;
+}
+
+absl::Status ProcJit::TickWithoutBlocking(
+    ProcJitContinuation& continuation) const {
+  XLS_RET_CHECK(continuation.AtStartOfTick());
+  int64_t continuation_point = jitted_function_base_.function(
+      continuation.GetInputBuffers().data(),
+      continuation.GetOutputBuffers().data(),
+      continuation.GetTempBuffer().data(), &continuation.GetEvents(),
+      /*user_data=*/nullptr, runtime(), /*continuation_point=*/0);
+  if (continuation_point != 0) {
+    continuation.SetContinuationPoint(continuation_point);
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Proc %s blocked in a tick which was expected not to block",
+        proc()->name()));
+  }
+  continuation.NextTick();
+  return absl::OkStatus();
 }
 
 absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
@@ -15,6 +15,9 @@
 #ifndef XLS_JIT_PROC_JIT_H_
 #define XLS_JIT_PROC_JIT_H_
 
+#include <memory>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -25,6 +28,7 @@
 #include "xls/ir/value.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 
@@ -38,9 +42,12 @@ class ProcJitContinuation : public ProcContinuation {
   // to its initial values with no proc nodes yet executed. `temp_buffer_size`
   // specifies the size of a flat buffer used to hold temporary xls::Node values
   // during execution of the JITed function. The size of the buffer is
-  // determined at JIT compile time and known by the ProcJit.
-  explicit ProcJitContinuation(Proc* proc, int64_t temp_buffer_size,
-                               JitRuntime* jit_runtime);
+  // determined at JIT compile time and known by the ProcJit. The state
+  // elements with indices in `in_place_state_indices` use a single buffer for
+  // the current and next value (see JittedFunctionBase::in_place_state_indices).
+  explicit ProcJitContinuation(
+      Proc* proc, int64_t temp_buffer_size, JitRuntime* jit_runtime,
+      absl::Span<const int64_t> in_place_state_indices = {});
 
   ~ProcJitContinuation() override = default;
 
@@ -76,7 +83,9 @@ class ProcJitContinuation : public ProcContinuation {
   InterpreterEvents events_;
 
   // Buffers to hold inputs, outputs, and temporary storage. This is allocated
-  // once and then re-used with each invocation of Run. Not thread-safe.
+  // once and then re-used with each invocation of Run. Not thread-safe. The
+  // output buffer of a state element updated in place is empty and its output
+  // pointer refers to the input buffer.
   std::vector<std::vector<uint8_t>> input_buffers_;
   std::vector<std::vector<uint8_t>> output_buffers_;
 
@@ -86,6 +95,17 @@ class ProcJitContinuation : public ProcContinuation {
   std::vector<uint8_t> temp_buffer_;
 };
 
+// Object code of an ahead-of-time compiled proc and metadata about how to call
+// it. See ProcJit::CreateObjectCode.
+struct ProcJitObjectCode {
+  // Name of the top-level jitted function in the object code.
+  std::string function_name;
+  std::vector<uint8_t> object_code;
+
+  // Minimum size of the temporary buffer passed to the jitted function.
+  int64_t temp_buffer_size;
+};
+
 // This class provides a facility to execute XLS procs (on the host) by
 // converting them to LLVM IR, compiling it, and finally executing it.
 class ProcJit : public ProcEvaluator {
@@ -95,6 +115,27 @@ class ProcJit : public ProcEvaluator {
   static absl::StatusOr<std::unique_ptr<ProcJit>> Create(
       Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr);
 
+  // As Create but the compiled code is instrumented to count executions of
+  // each node and the calls and cycles spent in the proc (and each function it
+  // invokes). The cycles of the proc are the cycles spent ticking the proc.
+  // The counters are available via `profile()`.
+  static absl::StatusOr<std::unique_ptr<ProcJit>> CreateWithProfiling(
+      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr);
+
+  // Returns objects executing each of the given procs, in the same order. The
+  // procs are compiled together into a single LLVM module (see
+  // BuildProcNetworkFunctions) which is shared by the returned objects.
+  static absl::StatusOr<std::vector<std::unique_ptr<ProcJit>>> CreateNetwork(
+      absl::Span<Proc* const> procs, JitRuntime* jit_runtime,
+      JitChannelQueueManager* queue_mgr);
+
+  // Compiles the given proc to object code for linking into another binary.
+  // The compiled function has type JitFunctionType and accesses channel
+  // queues through a table passed as its `user_data` argument (see
+  // BuildAotProcFunction), so it does not depend on any queue manager of this
+  // process. Ticking the compiled code is done by aot_compile::AotProcRunner.
+  static absl::StatusOr<ProcJitObjectCode> CreateObjectCode(Proc* proc);
+
   virtual ~ProcJit() = default;
 
   std::unique_ptr<ProcContinuation> NewContinuation() const override;
@@ -102,19 +143,57 @@ class ProcJit : public ProcEvaluator {
       ProcContinuation& continuation) const override;
   Proc* proc() const override { return proc_; }
 
+  // Returns whether a tick of the proc may block (i.e., the proc has blocking
+  // receives).
+  bool CanBlock() const {
+    return !jitted_function_base_.continuation_points.empty();
+  }
+
+  // Runs a complete tick of the proc without the bookkeeping Tick performs to
+  // support resuming a blocked tick. The continuation must be at the start of a
+  // tick. The caller must guarantee that the tick does not block: either the
+  // proc cannot block (see CanBlock) or each channel holds at least as many
+  // values as the proc has blocking receives on it. If the tick blocks anyway,
+  // an error is returned and the continuation is left at the blocked receive so
+  // the tick may be completed with Tick.
+  absl::Status TickWithoutBlocking(ProcJitContinuation& continuation) const;
+
   JitRuntime* runtime() const { return jit_runtime_; }
 
   OrcJit& GetOrcJit() { return *orc_jit_; }
 
+  // Returns the execution counters of the proc or nullptr if the JIT was not
+  // created with profiling enabled.
+  JitProfile* profile() const { return profile_.get(); }
+
+  // Sets how traces are collected in the events of continuations created
+  // afterwards by NewContinuation (see TraceCollection). Defaults to formatting
+  // each trace as it executes. Disabling collection avoids the cost of
+  // formatting in trace-heavy procs whose traces are not inspected.
+  void set_trace_collection(TraceCollection trace_collection) {
+    trace_collection_ = trace_collection;
+  }
+  TraceCollection trace_collection() const { return trace_collection_; }
+
  private:
   explicit ProcJit(Proc* proc, JitRuntime* jit_runtime,
-                   std::unique_ptr<OrcJit> orc_jit)
+                   std::shared_ptr<OrcJit> orc_jit)
       : proc_(proc), jit_runtime_(jit_runtime), orc_jit_(std::move(orc_jit)) {}
 
+  static absl::StatusOr<std::unique_ptr<ProcJit>> CreateInternal(
+      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+      bool enable_profiling);
+
   Proc* proc_;
   JitRuntime* jit_runtime_;
-  std::unique_ptr<OrcJit> orc_jit_;
+  // Shared by the procs of a network created with CreateNetwork.
+  std::shared_ptr<OrcJit> orc_jit_;
   JittedFunctionBase jitted_function_base_;
+
+  // Counters updated by the compiled code if profiling is enabled.
+  std::unique_ptr<JitProfile> profile_;
+
+  TraceCollection trace_collection_ = TraceCollection::kFormatted;
 };
 
 }  // namespace xls
@@ -23,12 +23,15 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/interpreter/proc_network_interpreter.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 
 namespace xls {
@@ -137,6 +140,98 @@ proc the_proc(my_token: token, state: (), init={()}) {
   }
 }
 
+TEST_F(ProcJitTest, TickWithoutBlocking) {
+  const std::string kIrText = R"(
+package p
+
+chan c_i(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan c_o(bits[32], id=1, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc the_proc(my_token: token, state: (), init={()}) {
+  literal.1: bits[32] = literal(value=3)
+  receive.2: (token, bits[32]) = receive(my_token, channel_id=0)
+  tuple_index.3: token = tuple_index(receive.2, index=0)
+  tuple_index.4: bits[32] = tuple_index(receive.2, index=1)
+  umul.5: bits[32] = umul(literal.1, tuple_index.4)
+  send.6: token = send(tuple_index.3, umul.5, channel_id=1)
+  next (send.6, state)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParsePackage(kIrText));
+
+  auto [queue_mgr, jit] =
+      CreateQueueManagerAndJit(FindProc("the_proc", package.get()));
+  EXPECT_TRUE(jit->CanBlock());
+
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+  ProcJitContinuation* jit_continuation =
+      dynamic_cast<ProcJitContinuation*>(continuation.get());
+  ASSERT_NE(jit_continuation, nullptr);
+
+  WriteU32(queue_mgr->GetQueueById(0).value(), 7);
+  XLS_ASSERT_OK(jit->TickWithoutBlocking(*jit_continuation));
+  EXPECT_TRUE(continuation->AtStartOfTick());
+  EXPECT_EQ(ReadU32(queue_mgr->GetQueueById(1).value()), 21);
+
+  // Without input the tick blocks. The blocked tick can be completed with Tick.
+  EXPECT_FALSE(jit->TickWithoutBlocking(*jit_continuation).ok());
+  EXPECT_FALSE(continuation->AtStartOfTick());
+  WriteU32(queue_mgr->GetQueueById(0).value(), 5);
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  EXPECT_TRUE(continuation->AtStartOfTick());
+  EXPECT_EQ(ReadU32(queue_mgr->GetQueueById(1).value()), 15);
+}
+
+TEST_F(ProcJitTest, Profiling) {
+  const std::string kIrText = R"(
+package p
+
+chan c_i(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan c_o(bits[32], id=1, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc the_proc(my_token: token, state: (), init={()}) {
+  literal.1: bits[32] = literal(value=3)
+  receive.2: (token, bits[32]) = receive(my_token, channel_id=0)
+  tuple_index.3: token = tuple_index(receive.2, index=0)
+  tuple_index.4: bits[32] = tuple_index(receive.2, index=1)
+  umul.5: bits[32] = umul(literal.1, tuple_index.4)
+  send.6: token = send(tuple_index.3, umul.5, channel_id=1)
+  next (send.6, state)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParsePackage(kIrText));
+  Proc* proc = FindProc("the_proc", package.get());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_mgr,
+      JitChannelQueueManager::CreateThreadSafe(package.get(),
+                                               jit_runtime_.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> jit,
+      ProcJit::CreateWithProfiling(proc, jit_runtime_.get(), queue_mgr.get()));
+  ASSERT_NE(jit->profile(), nullptr);
+
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+  // The proc blocks on the receive.
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  EXPECT_EQ(jit->profile()->GetNodeCount(FindNode("umul.5", proc)), 0);
+
+  WriteU32(queue_mgr->GetQueueById(0).value(), 7);
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  EXPECT_EQ(ReadU32(queue_mgr->GetQueueById(1).value()), 21);
+  WriteU32(queue_mgr->GetQueueById(0).value(), 2);
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  EXPECT_EQ(ReadU32(queue_mgr->GetQueueById(1).value()), 6);
+
+  EXPECT_EQ(jit->profile()->GetNodeCount(FindNode("umul.5", proc)), 2);
+  EXPECT_EQ(jit->profile()->GetNodeCount(FindNode("send.6", proc)), 2);
+  JitProfile::FunctionCounters counters =
+      jit->profile()->GetFunctionCounts(proc);
+  EXPECT_EQ(counters.call_count, 3);
+  EXPECT_GT(counters.cycle_count, 0);
+}
+
 TEST_F(ProcJitTest, RecvIf) {
   const std::string kIrText = R"(
 package p
@@ -367,6 +462,140 @@ TEST_F(ProcJitTest, MultistateProc) {
   EXPECT_TRUE(queue_mgr->GetQueueById(1).value()->IsEmpty());
 }
 
+TEST_F(ProcJitTest, InPlaceStateUpdates) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel_in,
+      package->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel_out,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+
+  // Proc pseudocode:
+  //
+  // table = [0, 0, 0, 0]
+  // history = [0, 0]
+  // i = 0
+  // k = 5
+  // while (true):
+  //   tmp = rcv(in)
+  //   send(out, history[0])
+  //   table[i] = tmp + k
+  //   history[1] = tmp
+  //   i += 1
+  //
+  // `table` and `k` are updated in place. `history` has another use so it is
+  // copied.
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tok", package.get());
+  Value zeros4 = Value::UBitsArray({0, 0, 0, 0}, 32).value();
+  Value zeros2 = Value::UBitsArray({0, 0}, 32).value();
+  BValue table = pb.StateElement("table", zeros4);
+  BValue history = pb.StateElement("history", zeros2);
+  BValue i = pb.StateElement("i", Value(UBits(0, 2)));
+  BValue k = pb.StateElement("k", Value(UBits(5, 32)));
+  BValue in = pb.Receive(channel_in);
+  pb.Send(channel_out, pb.ArrayIndex(history, {pb.Literal(UBits(0, 1))}));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      pb.Build({pb.ArrayUpdate(table, pb.Add(in, k), {i}),
+                pb.ArrayUpdate(history, in, {pb.Literal(UBits(1, 1))}),
+                pb.Add(i, pb.Literal(UBits(1, 2))), k}));
+
+  auto [queue_mgr, jit] = CreateQueueManagerAndJit(proc);
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+
+  WriteU32(queue_mgr->GetQueueById(0).value(), 10);
+  WriteU32(queue_mgr->GetQueueById(0).value(), 20);
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  EXPECT_THAT(
+      continuation->GetState(),
+      ElementsAre(Value::UBitsArray({15, 25, 0, 0}, 32).value(),
+                  Value::UBitsArray({0, 20}, 32).value(), Value(UBits(2, 2)),
+                  Value(UBits(5, 32))));
+
+  // A blocked tick leaves the state unmodified.
+  XLS_ASSERT_OK_AND_ASSIGN(TickResult result, jit->Tick(*continuation));
+  EXPECT_FALSE(result.tick_complete);
+  EXPECT_THAT(continuation->GetState(),
+              ElementsAre(Value::UBitsArray({15, 25, 0, 0}, 32).value(),
+                          Value::UBitsArray({0, 20}, 32).value(),
+                          Value(UBits(2, 2)), Value(UBits(5, 32))));
+
+  WriteU32(queue_mgr->GetQueueById(0).value(), 30);
+  WriteU32(queue_mgr->GetQueueById(0).value(), 40);
+  WriteU32(queue_mgr->GetQueueById(0).value(), 50);
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  EXPECT_THAT(continuation->GetState(),
+              ElementsAre(Value::UBitsArray({55, 25, 35, 45}, 32).value(),
+                          Value::UBitsArray({0, 50}, 32).value(),
+                          Value(UBits(1, 2)), Value(UBits(5, 32))));
+  for (int64_t j = 0; j < 5; ++j) {
+    EXPECT_EQ(ReadU32(queue_mgr->GetQueueById(1).value()), 0);
+  }
+}
+
+TEST_F(ProcJitTest, MixedInterpreterAndJitNetwork) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel_in,
+      package->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel_mid,
+      package->CreateStreamingChannel("mid", ChannelOps::kSendReceive,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel_out,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+
+  TokenlessProcBuilder producer_builder("producer", /*token_name=*/"tok",
+                                        package.get());
+  producer_builder.Send(
+      channel_mid, producer_builder.Add(producer_builder.Receive(channel_in),
+                                        producer_builder.Literal(UBits(1, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * producer, producer_builder.Build({}));
+
+  TokenlessProcBuilder consumer_builder("consumer", /*token_name=*/"tok",
+                                        package.get());
+  consumer_builder.Send(
+      channel_out,
+      consumer_builder.UMul(consumer_builder.Receive(channel_mid),
+                            consumer_builder.Literal(UBits(3, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * consumer, consumer_builder.Build({}));
+
+  // The JIT queues are shared by the interpreted producer and the jitted
+  // consumer.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_mgr,
+      JitChannelQueueManager::CreateThreadSafe(package.get(),
+                                               jit_runtime_.get()));
+  std::vector<std::unique_ptr<ProcEvaluator>> evaluators;
+  evaluators.push_back(
+      std::make_unique<ProcInterpreter>(producer, queue_mgr.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> consumer_jit,
+      ProcJit::Create(consumer, jit_runtime_.get(), queue_mgr.get()));
+  evaluators.push_back(std::move(consumer_jit));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcNetworkInterpreter> network,
+      ProcNetworkInterpreter::Create(package.get(), std::move(evaluators),
+                                     std::move(queue_mgr)));
+
+  ChannelQueue& in_queue = network->queue_manager().GetQueue(channel_in);
+  ChannelQueue& out_queue = network->queue_manager().GetQueue(channel_out);
+  WriteU32(&in_queue, 1);
+  WriteU32(&in_queue, 10);
+  XLS_ASSERT_OK(network->TickUntilOutput({{channel_out, 2}}).status());
+  EXPECT_EQ(ReadU32(&out_queue), 6);
+  EXPECT_EQ(ReadU32(&out_queue), 33);
+}
+
 TEST_F(ProcJitTest, NonBlockingReceivesProc) {
   auto package = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Channel * in0, package->CreateStreamingChannel(
@@ -0,0 +1,173 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/function_jit.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+#include "xls/common/python/absl_casters.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/status/statusor_pybind_caster.h"
+#include "xls/ir/events.h"
+#include "xls/ir/python/wrapper_types.h"
+#include "xls/ir/value.h"
+
+namespace py = pybind11;
+
+namespace xls {
+namespace {
+
+// Returns the size in bytes of the given buffer, which must be C-contiguous.
+absl::StatusOr<int64_t> ContiguousByteSize(const py::buffer_info& info,
+                                           std::string_view name) {
+  int64_t expected_stride = info.itemsize;
+  for (int64_t i = info.ndim - 1; i >= 0; --i) {
+    if (info.shape[i] > 1 && info.strides[i] != expected_stride) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Buffer `%s` is not C-contiguous", name));
+    }
+    expected_stride *= info.shape[i];
+  }
+  return info.size * info.itemsize;
+}
+
+// Python-facing wrapper of a FunctionJit. Holds a reference to the package of
+// the jitted function so it outlives the JIT.
+class FunctionJitHolder {
+ public:
+  static absl::StatusOr<FunctionJitHolder> Create(FunctionHolder function,
+                                                  int64_t opt_level) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create(&function.deref(), opt_level));
+    return FunctionJitHolder(function.package(), std::move(jit));
+  }
+
+  // Sizes of the parameters and result in the native layout of the JIT.
+  std::vector<int64_t> arg_sizes() const {
+    std::vector<int64_t> sizes;
+    for (int64_t i = 0; i < state_->jit->function()->params().size(); ++i) {
+      sizes.push_back(state_->jit->GetArgTypeSize(i));
+    }
+    return sizes;
+  }
+  int64_t return_size() const { return state_->jit->GetReturnTypeSize(); }
+
+  absl::StatusOr<Value> Run(const std::vector<Value>& args) {
+    absl::MutexLock lock(&state_->mutex);
+    return DropInterpreterEvents(state_->jit->Run(args));
+  }
+
+  // Evaluates the function over a batch of argument tuples held in buffers
+  // (e.g. NumPy arrays) in the native layout of the JIT, without copying them.
+  // `args[i]` holds consecutive values of parameter i and `result` receives
+  // the consecutive results; the batch size is the number of results which
+  // fit in `result`. The GIL is released during evaluation.
+  absl::Status RunBatched(const std::vector<py::buffer>& args,
+                          const py::buffer& result) {
+    std::vector<py::buffer_info> arg_infos;
+    arg_infos.reserve(args.size());
+    for (const py::buffer& arg : args) {
+      arg_infos.push_back(arg.request());
+    }
+    py::buffer_info result_info = result.request(/*writable=*/true);
+    XLS_ASSIGN_OR_RETURN(int64_t result_bytes,
+                         ContiguousByteSize(result_info, "result"));
+    if (result_bytes % return_size() != 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Result buffer size (%d bytes) is not a multiple of the return "
+          "type size (%d bytes)",
+          result_bytes, return_size()));
+    }
+    int64_t batch_size = result_bytes / return_size();
+    std::vector<int64_t> sizes = arg_sizes();
+    if (arg_infos.size() != sizes.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected %d argument buffers, got %d", sizes.size(),
+                          arg_infos.size()));
+    }
+    std::vector<const uint8_t*> arg_buffers;
+    for (int64_t i = 0; i < arg_infos.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          int64_t arg_bytes,
+          ContiguousByteSize(arg_infos[i], absl::StrCat("args[", i, "]")));
+      if (arg_bytes < batch_size * sizes[i]) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Argument buffer %d holds %d bytes; a batch of %d needs %d", i,
+            arg_bytes, batch_size, batch_size * sizes[i]));
+      }
+      arg_buffers.push_back(static_cast<const uint8_t*>(arg_infos[i].ptr));
+    }
+
+    InterpreterEvents events;
+    absl::Status status;
+    {
+      py::gil_scoped_release release;
+      absl::MutexLock lock(&state_->mutex);
+      status = state_->jit->RunBatched(
+          arg_buffers,
+          absl::MakeSpan(static_cast<uint8_t*>(result_info.ptr), result_bytes),
+          batch_size, &events);
+    }
+    XLS_RETURN_IF_ERROR(status);
+    return InterpreterEventsToStatus(events);
+  }
+
+ private:
+  // The JIT reuses its temporary buffers across calls, so calls are
+  // serialized.
+  struct State {
+    std::unique_ptr<FunctionJit> jit;
+    absl::Mutex mutex;
+  };
+
+  FunctionJitHolder(std::shared_ptr<Package> package,
+                    std::unique_ptr<FunctionJit> jit)
+      : package_(std::move(package)), state_(std::make_shared<State>()) {
+    state_->jit = std::move(jit);
+  }
+
+  std::shared_ptr<Package> package_;
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace
+
+PYBIND11_MODULE(function_jit, m) {
+  ImportStatusModule();
+  py::module::import("xls.ir.python.function");
+  py::module::import("xls.ir.python.value");
+
+  py::class_<FunctionJitHolder>(m, "FunctionJit")
+      .def_static("create", &FunctionJitHolder::Create, py::arg("function"),
+                  py::arg("opt_level") = 3)
+      .def_property_readonly("arg_sizes", &FunctionJitHolder::arg_sizes)
+      .def_property_readonly("return_size", &FunctionJitHolder::return_size)
+      .def("run", &FunctionJitHolder::Run, py::arg("args"))
+      .def("run_batched", &FunctionJitHolder::RunBatched, py::arg("args"),
+           py::arg("result"));
+}
+
+}  // namespace xls
@@ -0,0 +1,80 @@
+#
+# Copyright 2022 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for xls.jit.python.function_jit."""
+
+import numpy as np
+
+from xls.ir.python import bits as bits_mod
+from xls.ir.python import function_builder
+from xls.ir.python import package as ir_package
+from xls.ir.python import value as ir_value
+from xls.jit.python import function_jit
+from absl.testing import absltest
+
+
+def _build_add(p, bit_count):
+  fb = function_builder.FunctionBuilder('add', p)
+  t = p.get_bits_type(bit_count)
+  fb.add_add(fb.add_param('x', t), fb.add_param('y', t))
+  return fb.build()
+
+
+class FunctionJitTest(absltest.TestCase):
+
+  def test_run(self):
+    p = ir_package.Package('test_package')
+    jit = function_jit.FunctionJit.create(_build_add(p, 32))
+    result = jit.run([
+        ir_value.Value(bits_mod.UBits(2, 32)),
+        ir_value.Value(bits_mod.UBits(3, 32))
+    ])
+    self.assertEqual(result, ir_value.Value(bits_mod.UBits(5, 32)))
+
+  def test_run_batched(self):
+    p = ir_package.Package('test_package')
+    jit = function_jit.FunctionJit.create(_build_add(p, 32))
+    self.assertEqual(jit.arg_sizes, [4, 4])
+    self.assertEqual(jit.return_size, 4)
+
+    x = np.arange(1000, dtype=np.uint32)
+    y = np.full(1000, 0xfffffff0, dtype=np.uint32)
+    result = np.zeros(1000, dtype=np.uint32)
+    jit.run_batched([x, y], result)
+    np.testing.assert_array_equal(result, x + y)
+
+  def test_run_batched_multidimensional(self):
+    p = ir_package.Package('test_package')
+    jit = function_jit.FunctionJit.create(_build_add(p, 8))
+    x = np.arange(64, dtype=np.uint8).reshape(8, 8)
+    result = np.zeros((8, 8), dtype=np.uint8)
+    jit.run_batched([x, x], result)
+    np.testing.assert_array_equal(result, x + x)
+
+  def test_run_batched_errors(self):
+    p = ir_package.Package('test_package')
+    jit = function_jit.FunctionJit.create(_build_add(p, 32))
+    x = np.zeros(10, dtype=np.uint32)
+    with self.assertRaisesRegex(RuntimeError, 'a batch of 20 needs 80'):
+      jit.run_batched([x, x], np.zeros(20, dtype=np.uint32))
+    with self.assertRaisesRegex(RuntimeError, 'Expected 2 argument buffers'):
+      jit.run_batched([x], np.zeros(10, dtype=np.uint32))
+    with self.assertRaisesRegex(RuntimeError, 'not C-contiguous'):
+      jit.run_batched([np.zeros(20, dtype=np.uint32)[::2], x],
+                      np.zeros(10, dtype=np.uint32))
+
+
+if __name__ == '__main__':
+  absltest.main()
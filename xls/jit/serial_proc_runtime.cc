@@ -14,32 +14,74 @@
 #include "xls/jit/serial_proc_runtime.h"
 
 #include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/casts.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/proc.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/proc_jit.h"
 
 namespace xls {
-
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> SerialProcRuntime::Create(
     Package* package) {
   auto runtime = absl::WrapUnique(new SerialProcRuntime(std::move(package)));
-  XLS_RETURN_IF_ERROR(runtime->Init());
+  XLS_RETURN_IF_ERROR(runtime->Init(/*fused=*/false));
+  return runtime;
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+SerialProcRuntime::CreateFused(Package* package) {
+  auto runtime = absl::WrapUnique(new SerialProcRuntime(package));
+  XLS_RETURN_IF_ERROR(runtime->Init(/*fused=*/true));
   return runtime;
 }
 
 SerialProcRuntime::SerialProcRuntime(Package* package) : package_(package) {}
 
-absl::Status SerialProcRuntime::Init() {
+absl::Status SerialProcRuntime::Init(bool fused) {
   // Create a ProcJit and continuation for each proc.
   XLS_ASSIGN_OR_RETURN(jit_runtime_, JitRuntime::Create());
-  XLS_ASSIGN_OR_RETURN(queue_mgr_, JitChannelQueueManager::CreateThreadSafe(
-                                       package_, jit_runtime_.get()));
-  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+  if (fused) {
+    XLS_ASSIGN_OR_RETURN(queue_mgr_,
+                         JitChannelQueueManager::CreateWithRingBuffers(
+                             package_, jit_runtime_.get()));
+    std::vector<Proc*> procs;
+    for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+      procs.push_back(proc.get());
+    }
     XLS_ASSIGN_OR_RETURN(
-        proc_jits_[proc.get()],
-        ProcJit::Create(proc.get(), jit_runtime_.get(), queue_mgr_.get()));
+        std::vector<std::unique_ptr<ProcJit>> jits,
+        ProcJit::CreateNetwork(procs, jit_runtime_.get(), queue_mgr_.get()));
+    for (int64_t i = 0; i < procs.size(); ++i) {
+      proc_jits_[procs[i]] = std::move(jits[i]);
+    }
+  } else {
+    XLS_ASSIGN_OR_RETURN(queue_mgr_, JitChannelQueueManager::CreateThreadSafe(
+                                         package_, jit_runtime_.get()));
+    for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+      XLS_ASSIGN_OR_RETURN(
+          proc_jits_[proc.get()],
+          ProcJit::Create(proc.get(), jit_runtime_.get(), queue_mgr_.get()));
+    }
+  }
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
     continuations_[proc.get()] = proc_jits_.at(proc.get())->NewContinuation();
+
+    absl::flat_hash_map<int64_t, int64_t> counts;
+    for (Node* node : proc->nodes()) {
+      if (node->Is<Receive>() && node->As<Receive>()->is_blocking()) {
+        ++counts[node->As<Receive>()->channel_id()];
+      }
+    }
+    std::vector<std::pair<ChannelQueue*, int64_t>>& queue_counts =
+        blocking_receive_counts_[proc.get()];
+    for (const auto& [channel_id, count] : counts) {
+      XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                           queue_mgr_->GetQueueById(channel_id));
+      queue_counts.push_back({queue, count});
+    }
   }
 
   // Write initial values into channels.
@@ -51,6 +93,23 @@ absl::Status SerialProcRuntime::Init() {
   return absl::OkStatus();
 }
 
+bool SerialProcRuntime::CanTickWithoutBlocking(Proc* proc) const {
+  if (!continuations_.at(proc)->AtStartOfTick()) {
+    return false;
+  }
+  if (!proc_jits_.at(proc)->CanBlock()) {
+    return true;
+  }
+  // Procs run one at a time so no other proc reads from the queues during the
+  // tick.
+  for (const auto& [queue, count] : blocking_receive_counts_.at(proc)) {
+    if (queue->GetSize() < count) {
+      return false;
+    }
+  }
+  return true;
+}
+
 absl::Status SerialProcRuntime::Tick(bool print_traces) {
   bool progress_made = true;
   absl::flat_hash_set<Proc*> completed_procs;
@@ -62,6 +121,16 @@ absl::Status SerialProcRuntime::Tick(bool print_traces) {
       if (completed_procs.contains(proc.get())) {
         continue;
       }
+      if (CanTickWithoutBlocking(proc.get())) {
+        // Skip the bookkeeping for resuming blocked ticks.
+        auto* continuation = down_cast<ProcJitContinuation*>(
+            continuations_.at(proc.get()).get());
+        XLS_RETURN_IF_ERROR(
+            proc_jits_.at(proc.get())->TickWithoutBlocking(*continuation));
+        progress_made = true;
+        completed_procs.insert(proc.get());
+        continue;
+      }
       XLS_ASSIGN_OR_RETURN(
           TickResult result,
           proc_jits_.at(proc.get())->Tick(*continuations_.at(proc.get())));
@@ -71,6 +140,11 @@ absl::Status SerialProcRuntime::Tick(bool print_traces) {
       }
     }
   }
+  if (print_traces) {
+    for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+      PrintTraces(proc.get(), *continuations_.at(proc.get()));
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -86,6 +160,19 @@ absl::Status SerialProcRuntime::WriteBufferToChannel(
   return absl::OkStatus();
 }
 
+absl::Status SerialProcRuntime::WriteBuffersToChannel(
+    Channel* channel, absl::Span<uint8_t const> buffer) {
+  int64_t element_size = jit_runtime_->GetTypeByteSize(channel->type());
+  if (element_size == 0 || buffer.size() % element_size != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Buffer size %d is not a multiple of the element size %d of channel %s",
+        buffer.size(), element_size, channel->name()));
+  }
+  queue_mgr()->GetJitQueue(channel).WriteRawBatch(
+      buffer.data(), buffer.size() / element_size);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::optional<Value>> SerialProcRuntime::ReadValueFromChannel(
     Channel* channel) {
   return queue_mgr()->GetQueue(channel).Read();
@@ -96,6 +183,18 @@ absl::StatusOr<bool> SerialProcRuntime::ReadBufferFromChannel(
   return queue_mgr()->GetJitQueue(channel).ReadRaw(buffer.data());
 }
 
+absl::StatusOr<int64_t> SerialProcRuntime::ReadBuffersFromChannel(
+    Channel* channel, absl::Span<uint8_t> buffer) {
+  int64_t element_size = jit_runtime_->GetTypeByteSize(channel->type());
+  if (element_size == 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Cannot batch read zero-sized values from channel %s",
+        channel->name()));
+  }
+  return queue_mgr()->GetJitQueue(channel).ReadRawBatch(
+      buffer.data(), buffer.size() / element_size);
+}
+
 absl::StatusOr<std::vector<Value>>
 SerialProcRuntime::SerialProcRuntime::ProcState(Proc* proc) const {
   return continuations_.at(proc)->GetState();
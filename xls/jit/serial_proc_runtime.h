@@ -15,6 +15,7 @@
 #define XLS_JIT_SERIAL_PROC_RUNTIME_H_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
@@ -34,11 +35,21 @@ class SerialProcRuntime {
  public:
   static absl::StatusOr<std::unique_ptr<SerialProcRuntime>> Create(
       Package* package);
+
+  // Creates a runtime in which all of the procs are compiled together into a
+  // single LLVM module and the channels between procs of the package are
+  // ring buffers which the compiled code reads and writes inline (see
+  // JitChannelQueueManager::CreateWithRingBuffers). This speeds up ticking
+  // networks of tightly coupled procs. The runtime is not thread-safe.
+  static absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateFused(
+      Package* package);
   ~SerialProcRuntime() = default;
 
   // Attempt to progress every proc in the network. Terminates when every
   // block has either completed execution of its `next` function or is blocked
   // on a recv operation.
+  // If `print_traces` is true, the traces collected by the procs are then
+  // printed to stderr in proc order and cleared.
   absl::Status Tick(bool print_traces = false);
 
   Package* package() { return package_; }
@@ -50,6 +61,12 @@ class SerialProcRuntime {
   absl::Status WriteBufferToChannel(Channel* channel,
                                     absl::Span<uint8_t const> buffer);
 
+  // Writes a batch of values in LLVM's native format to the given
+  // channel. Values are packed contiguously in `buffer` so its size must be a
+  // multiple of the JIT byte size of the channel type.
+  absl::Status WriteBuffersToChannel(Channel* channel,
+                                     absl::Span<uint8_t const> buffer);
+
   // Reads a value from the given channel. The type of the returned value
   // matches the type of the data elements of the channel. If the queue is
   // empty, absl::nullopt is returned.
@@ -57,6 +74,12 @@ class SerialProcRuntime {
   absl::StatusOr<bool> ReadBufferFromChannel(Channel* channel,
                                              absl::Span<uint8_t> buffer);
 
+  // Reads as many values as are available and fit in `buffer` from the given
+  // channel. Values are packed contiguously as in `WriteBuffersToChannel`.
+  // Returns the number of values read.
+  absl::StatusOr<int64_t> ReadBuffersFromChannel(Channel* channel,
+                                                 absl::Span<uint8_t> buffer);
+
   // Returns the current state values in the given proc.
   absl::StatusOr<std::vector<Value>> ProcState(Proc* proc) const;
 
@@ -64,14 +87,24 @@ class SerialProcRuntime {
 
  private:
   SerialProcRuntime(Package* package);
-  absl::Status Init();
+  absl::Status Init(bool fused);
 
   Package* package_;
   std::unique_ptr<JitChannelQueueManager> queue_mgr_;
   std::unique_ptr<JitRuntime> jit_runtime_;
 
+  // Returns whether a tick of the proc starting now is guaranteed not to
+  // block so it may be run with ProcJit::TickWithoutBlocking.
+  bool CanTickWithoutBlocking(Proc* proc) const;
+
   absl::flat_hash_map<Proc*, std::unique_ptr<ProcJit>> proc_jits_;
   absl::flat_hash_map<Proc*, std::unique_ptr<ProcContinuation>> continuations_;
+
+  // The number of blocking receives in each proc on each channel. A tick
+  // which starts when every one of these queues holds at least this many
+  // values cannot block.
+  absl::flat_hash_map<Proc*, std::vector<std::pair<ChannelQueue*, int64_t>>>
+      blocking_receive_counts_;
 };
 
 }  // namespace xls
@@ -102,6 +102,70 @@ proc b(my_token: token, state: (), init={()}) {
   }
 }
 
+// As SimpleNetwork but with the procs compiled into a single module and the
+// channel between them accessed inline.
+TEST(SerialProcRuntimeTest, FusedNetwork) {
+  constexpr int kNumCycles = 40;
+  const std::string kIrText = R"(
+package p
+
+chan a_in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan a_to_b(bits[32], id=1, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan b_out(bits[32], id=2, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc a(my_token: token, state: (), init={()}) {
+  literal.1: bits[32] = literal(value=2)
+  receive.2: (token, bits[32]) = receive(my_token, channel_id=0)
+  tuple_index.3: token = tuple_index(receive.2, index=0)
+  tuple_index.4: bits[32] = tuple_index(receive.2, index=1)
+  umul.5: bits[32] = umul(literal.1, tuple_index.4)
+  send.6: token = send(tuple_index.3, umul.5, channel_id=1)
+  next (send.6, state)
+}
+
+proc b(my_token: token, state: (), init={()}) {
+  literal.100: bits[32] = literal(value=3)
+  receive.200: (token, bits[32]) = receive(my_token, channel_id=1)
+  tuple_index.300: token = tuple_index(receive.200, index=0)
+  tuple_index.400: bits[32] = tuple_index(receive.200, index=1)
+  umul.500: bits[32] = umul(literal.100, tuple_index.400)
+  send.600: token = send(tuple_index.300, umul.500, channel_id=2)
+  next (send.600, state)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime,
+                           SerialProcRuntime::CreateFused(p.get()));
+  auto queue_mgr = runtime->queue_mgr();
+  XLS_ASSERT_OK_AND_ASSIGN(auto input_queue, queue_mgr->GetQueueById(0));
+  XLS_ASSERT_OK_AND_ASSIGN(auto internal_queue, queue_mgr->GetQueueById(1));
+  XLS_ASSERT_OK_AND_ASSIGN(auto output_queue, queue_mgr->GetQueueById(2));
+  EXPECT_NE(dynamic_cast<RingBufferJitChannelQueue*>(internal_queue), nullptr);
+  EXPECT_EQ(dynamic_cast<RingBufferJitChannelQueue*>(input_queue), nullptr);
+
+  // Fill the internal queue beyond the initial capacity of its ring buffer so
+  // the compiled code reads from a grown (and wrapped) buffer.
+  for (int i = 0; i < kNumCycles; i++) {
+    WriteData(input_queue, i);
+    WriteData(internal_queue, 1000 + i);
+  }
+
+  for (int i = 0; i < kNumCycles; i++) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+
+  // The values written directly to the internal queue are received by "b"
+  // first, followed by the values sent by "a".
+  for (int i = 0; i < kNumCycles; i++) {
+    EXPECT_EQ(ReadData<int>(output_queue), (1000 + i) * 3);
+  }
+  EXPECT_EQ(internal_queue->GetSize(), kNumCycles);
+  for (int i = 0; i < kNumCycles; i++) {
+    EXPECT_EQ(ReadData<int>(internal_queue), i * 2);
+  }
+}
+
 // Test verifies that an "X"-shaped network can be modeled correctly, i.e.,
 // a network that looks like:
 //  A   B
@@ -578,5 +642,56 @@ TEST(SerialProcRuntimeTest, NonBlockingReceivesProc) {
   EXPECT_THAT(get_output(), IsOkAndHolds(Value(UBits(1, 32))));
 }
 
+TEST(SerialProcRuntimeTest, BatchedChannelAccess) {
+  constexpr int kNumValues = 1000;
+  const std::string kIrText = R"(
+package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc doubler(my_token: token, state: (), init={()}) {
+  literal.1: bits[32] = literal(value=2)
+  receive.2: (token, bits[32]) = receive(my_token, channel_id=0)
+  tuple_index.3: token = tuple_index(receive.2, index=0)
+  tuple_index.4: bits[32] = tuple_index(receive.2, index=1)
+  umul.5: bits[32] = umul(literal.1, tuple_index.4)
+  send.6: token = send(tuple_index.3, umul.5, channel_id=1)
+  next (send.6, state)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime, SerialProcRuntime::Create(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * in, p->GetChannel("in"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, p->GetChannel("out"));
+
+  std::vector<uint32_t> inputs(kNumValues);
+  for (int i = 0; i < kNumValues; ++i) {
+    inputs[i] = i;
+  }
+  XLS_ASSERT_OK(runtime->WriteBuffersToChannel(
+      in, absl::MakeConstSpan(reinterpret_cast<uint8_t*>(inputs.data()),
+                              inputs.size() * sizeof(uint32_t))));
+  EXPECT_FALSE(runtime
+                   ->WriteBuffersToChannel(
+                       in, absl::MakeConstSpan(
+                               reinterpret_cast<uint8_t*>(inputs.data()), 3))
+                   .ok());
+
+  for (int i = 0; i < kNumValues; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+
+  std::vector<uint32_t> outputs(kNumValues + 1);
+  EXPECT_THAT(runtime->ReadBuffersFromChannel(
+                  out, absl::MakeSpan(reinterpret_cast<uint8_t*>(outputs.data()),
+                                      outputs.size() * sizeof(uint32_t))),
+              IsOkAndHolds(kNumValues));
+  for (int i = 0; i < kNumValues; ++i) {
+    EXPECT_EQ(outputs[i], 2 * i);
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,231 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/threaded_proc_runtime.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+
+absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>>
+ThreadedProcRuntime::Create(Package* package, int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 0);
+  auto runtime = absl::WrapUnique(new ThreadedProcRuntime(package));
+  XLS_RETURN_IF_ERROR(runtime->Init(thread_count));
+  return runtime;
+}
+
+ThreadedProcRuntime::~ThreadedProcRuntime() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+absl::Status ThreadedProcRuntime::Init(int64_t thread_count) {
+  XLS_ASSIGN_OR_RETURN(jit_runtime_, JitRuntime::Create());
+  XLS_ASSIGN_OR_RETURN(queue_mgr_, JitChannelQueueManager::CreateThreadSafe(
+                                       package_, jit_runtime_.get()));
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    XLS_ASSIGN_OR_RETURN(
+        proc_jits_[proc.get()],
+        ProcJit::Create(proc.get(), jit_runtime_.get(), queue_mgr_.get()));
+    continuations_[proc.get()] = proc_jits_.at(proc.get())->NewContinuation();
+  }
+
+  // Write initial values into channels.
+  for (Channel* channel : package_->channels()) {
+    for (const Value& value : channel->initial_values()) {
+      XLS_RETURN_IF_ERROR(WriteValueToChannel(channel, value));
+    }
+  }
+
+  int64_t proc_count = package_->procs().size();
+  if (thread_count == 0 || thread_count > proc_count) {
+    thread_count = proc_count;
+  }
+  worker_procs_.resize(thread_count);
+  for (int64_t i = 0; i < proc_count; ++i) {
+    worker_procs_[i % thread_count].push_back(package_->procs()[i].get());
+  }
+  for (int64_t i = 0; i < thread_count; ++i) {
+    workers_.push_back(
+        std::make_unique<Thread>([this, i]() { WorkerMain(i); }));
+  }
+  return absl::OkStatus();
+}
+
+void ThreadedProcRuntime::WorkerMain(int64_t worker_index) {
+  int64_t last_generation = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      auto tick_started_or_shutdown = [&]() {
+        mutex_.AssertReaderHeld();
+        return shutdown_ || tick_generation_ != last_generation;
+      };
+      mutex_.Await(absl::Condition(&tick_started_or_shutdown));
+      if (shutdown_) {
+        return;
+      }
+      last_generation = tick_generation_;
+    }
+    absl::Status status = RunWorkerTick(worker_index);
+    absl::MutexLock lock(&mutex_);
+    if (!status.ok()) {
+      if (tick_status_.ok()) {
+        tick_status_ = status;
+      }
+      // Unblock the other workers.
+      tick_done_ = true;
+    }
+    ++finished_worker_count_;
+  }
+}
+
+absl::Status ThreadedProcRuntime::RunWorkerTick(int64_t worker_index) {
+  absl::flat_hash_set<Proc*> completed_procs;
+  const std::vector<Proc*>& procs = worker_procs_[worker_index];
+  while (true) {
+    int64_t epoch;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (tick_done_) {
+        return absl::OkStatus();
+      }
+      epoch = progress_epoch_;
+    }
+
+    bool progress_made = false;
+    for (Proc* proc : procs) {
+      if (completed_procs.contains(proc)) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(TickResult result,
+                           proc_jits_.at(proc)->Tick(*continuations_.at(proc)));
+      progress_made = progress_made || result.progress_made;
+      if (result.tick_complete) {
+        completed_procs.insert(proc);
+      }
+    }
+
+    absl::MutexLock lock(&mutex_);
+    if (progress_made) {
+      // Progress by this worker may have unblocked procs on other workers so
+      // every blocked worker must re-examine its procs.
+      ++progress_epoch_;
+      blocked_worker_count_ = 0;
+    }
+    if (completed_procs.size() == procs.size()) {
+      // Nothing left to run in this tick.
+      ++completed_worker_count_;
+      MaybeFinishTick();
+      return absl::OkStatus();
+    }
+    if (progress_made || progress_epoch_ != epoch) {
+      // Either this worker made progress or another worker did while this
+      // worker was running its procs. In both cases the blocked procs may now
+      // be able to proceed.
+      continue;
+    }
+
+    // All remaining procs of this worker are blocked. Sleep until another
+    // worker makes progress or the tick completes.
+    ++blocked_worker_count_;
+    MaybeFinishTick();
+    auto progress_or_done = [&]() {
+      mutex_.AssertReaderHeld();
+      return tick_done_ || progress_epoch_ != epoch;
+    };
+    mutex_.Await(absl::Condition(&progress_or_done));
+  }
+}
+
+void ThreadedProcRuntime::MaybeFinishTick() {
+  if (completed_worker_count_ + blocked_worker_count_ == workers_.size()) {
+    tick_done_ = true;
+  }
+}
+
+absl::Status ThreadedProcRuntime::Tick(bool print_traces) {
+  if (workers_.empty()) {
+    return absl::OkStatus();
+  }
+  absl::MutexLock lock(&mutex_);
+  progress_epoch_ = 0;
+  completed_worker_count_ = 0;
+  blocked_worker_count_ = 0;
+  finished_worker_count_ = 0;
+  tick_done_ = false;
+  tick_status_ = absl::OkStatus();
+  ++tick_generation_;
+  auto all_workers_finished = [&]() {
+    mutex_.AssertReaderHeld();
+    return finished_worker_count_ == workers_.size();
+  };
+  mutex_.Await(absl::Condition(&all_workers_finished));
+  if (print_traces) {
+    // The workers are idle until the next tick so the continuations can be
+    // read here. Printing from this thread keeps the output in proc order.
+    for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+      PrintTraces(proc.get(), *continuations_.at(proc.get()));
+    }
+  }
+  return tick_status_;
+}
+
+absl::Status ThreadedProcRuntime::WriteValueToChannel(Channel* channel,
+                                                      const Value& value) {
+  return queue_mgr()->GetQueue(channel).Write(value);
+}
+
+absl::Status ThreadedProcRuntime::WriteBufferToChannel(
+    Channel* channel, absl::Span<uint8_t const> buffer) {
+  queue_mgr()->GetJitQueue(channel).WriteRaw(buffer.data());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::optional<Value>> ThreadedProcRuntime::ReadValueFromChannel(
+    Channel* channel) {
+  return queue_mgr()->GetQueue(channel).Read();
+}
+
+absl::StatusOr<bool> ThreadedProcRuntime::ReadBufferFromChannel(
+    Channel* channel, absl::Span<uint8_t> buffer) {
+  return queue_mgr()->GetJitQueue(channel).ReadRaw(buffer.data());
+}
+
+absl::StatusOr<std::vector<Value>> ThreadedProcRuntime::ProcState(
+    Proc* proc) const {
+  return continuations_.at(proc)->GetState();
+}
+
+void ThreadedProcRuntime::ResetState() {
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    continuations_.at(proc.get()) =
+        proc_jits_.at(proc.get())->NewContinuation();
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,134 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_THREADED_PROC_RUNTIME_H_
+#define XLS_JIT_THREADED_PROC_RUNTIME_H_
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/thread.h"
+#include "xls/ir/package.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+
+// A multi-threaded counterpart of SerialProcRuntime. The procs in the package
+// are partitioned among a fixed set of worker threads which live for the
+// lifetime of the runtime. During a tick each worker repeatedly runs its procs
+// until every proc has either completed its tick or is blocked on a receive.
+// A worker whose procs are all blocked sleeps until another worker makes
+// progress (and so may have sent data on a channel) rather than polling.
+//
+// The runtime has the same interface and tick semantics as SerialProcRuntime:
+// a call to Tick returns once every proc has completed executing its `next`
+// function or is blocked and no further progress is possible.
+class ThreadedProcRuntime {
+ public:
+  // Creates a runtime for the given package. `thread_count` is the number of
+  // worker threads to use. If zero, one thread is created per proc. Procs are
+  // assigned to workers round-robin.
+  static absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>> Create(
+      Package* package, int64_t thread_count = 0);
+  ~ThreadedProcRuntime();
+
+  // Attempt to progress every proc in the network. Terminates when every
+  // proc has either completed execution of its `next` function or is blocked
+  // on a recv operation and no other proc can make progress.
+  // If `print_traces` is true, the traces collected by the procs are then
+  // printed to stderr in proc order and cleared.
+  absl::Status Tick(bool print_traces = false);
+
+  Package* package() { return package_; }
+  JitChannelQueueManager* queue_mgr() { return queue_mgr_.get(); }
+
+  // Writes the values to the given channel. `value` must match the type of the
+  // data element of the channel. Must not be called concurrently with Tick.
+  absl::Status WriteValueToChannel(Channel* channel, const Value& value);
+  absl::Status WriteBufferToChannel(Channel* channel,
+                                    absl::Span<uint8_t const> buffer);
+
+  // Reads a value from the given channel. The type of the returned value
+  // matches the type of the data elements of the channel. If the queue is
+  // empty, std::nullopt is returned. Must not be called concurrently with
+  // Tick.
+  absl::StatusOr<std::optional<Value>> ReadValueFromChannel(Channel* channel);
+  absl::StatusOr<bool> ReadBufferFromChannel(Channel* channel,
+                                             absl::Span<uint8_t> buffer);
+
+  // Returns the current state values in the given proc.
+  absl::StatusOr<std::vector<Value>> ProcState(Proc* proc) const;
+
+  void ResetState();
+
+  int64_t thread_count() const { return workers_.size(); }
+
+ private:
+  explicit ThreadedProcRuntime(Package* package) : package_(package) {}
+  absl::Status Init(int64_t thread_count);
+
+  // Body of each worker thread. Waits for a tick to begin, runs the worker's
+  // procs for the tick, and repeats until the runtime is destroyed.
+  void WorkerMain(int64_t worker_index);
+
+  // Runs the procs of the given worker until the tick completes. Returns an
+  // error if any proc evaluation fails.
+  absl::Status RunWorkerTick(int64_t worker_index);
+
+  // Marks the tick as done if every worker is either completed or blocked.
+  void MaybeFinishTick() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  Package* package_;
+  std::unique_ptr<JitChannelQueueManager> queue_mgr_;
+  std::unique_ptr<JitRuntime> jit_runtime_;
+
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcJit>> proc_jits_;
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcContinuation>> continuations_;
+
+  // The procs assigned to each worker.
+  std::vector<std::vector<Proc*>> worker_procs_;
+  std::vector<std::unique_ptr<Thread>> workers_;
+
+  absl::Mutex mutex_;
+  // Incremented at the start of each tick. Workers wait for this to change.
+  int64_t tick_generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Incremented whenever a proc makes progress during a tick. Blocked workers
+  // wait for this to change.
+  int64_t progress_epoch_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of workers which have completed all their procs in the current
+  // tick.
+  int64_t completed_worker_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of workers whose remaining procs are all blocked and which have not
+  // observed any progress since becoming blocked. Reset whenever progress is
+  // made.
+  int64_t blocked_worker_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of workers which have returned from the current tick.
+  int64_t finished_worker_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Whether no further progress is possible in the current tick.
+  bool tick_done_ ABSL_GUARDED_BY(mutex_) = false;
+  // The first error encountered by any worker during the current tick.
+  absl::Status tick_status_ ABSL_GUARDED_BY(mutex_);
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_THREADED_PROC_RUNTIME_H_
@@ -0,0 +1,212 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/threaded_proc_runtime.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+
+// Parameterized by the number of worker threads (zero means one per proc).
+class ThreadedProcRuntimeTest : public ::testing::TestWithParam<int64_t> {};
+
+// An X-shaped network:
+//  A   B
+//   \ /
+//    C
+//   / \
+//  D   E
+constexpr std::string_view kXNetworkIr = R"(
+package p
+
+chan i_a(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan i_b(bits[32], id=1, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan a_c(bits[32], id=2, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan b_c(bits[32], id=3, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan c_d(bits[32], id=4, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan c_e(bits[32], id=5, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan d_o(bits[32], id=6, kind=streaming, ops=send_only, flow_control=none, metadata="")
+chan e_o(bits[32], id=7, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc a(my_token: token, state: (), init={()}) {
+  literal.1: bits[32] = literal(value=1)
+  receive.2: (token, bits[32]) = receive(my_token, channel_id=0)
+  tuple_index.3: token = tuple_index(receive.2, index=0)
+  tuple_index.4: bits[32] = tuple_index(receive.2, index=1)
+  umul.5: bits[32] = umul(literal.1, tuple_index.4)
+  send.6: token = send(tuple_index.3, umul.5, channel_id=2)
+  next (send.6, state)
+}
+
+proc b(my_token: token, state: (), init={()}) {
+  literal.101: bits[32] = literal(value=2)
+  receive.102: (token, bits[32]) = receive(my_token, channel_id=1)
+  tuple_index.103: token = tuple_index(receive.102, index=0)
+  tuple_index.104: bits[32] = tuple_index(receive.102, index=1)
+  umul.105: bits[32] = umul(literal.101, tuple_index.104)
+  send.106: token = send(tuple_index.103, umul.105, channel_id=3)
+  next (send.106, state)
+}
+
+proc c(my_token: token, state: (), init={()}) {
+  literal.201: bits[32] = literal(value=3)
+  receive.202: (token, bits[32]) = receive(my_token, channel_id=2)
+  tuple_index.203: token = tuple_index(receive.202, index=0)
+  tuple_index.204: bits[32] = tuple_index(receive.202, index=1)
+  receive.205: (token, bits[32]) = receive(tuple_index.203, channel_id=3)
+  tuple_index.206: token = tuple_index(receive.205, index=0)
+  tuple_index.207: bits[32] = tuple_index(receive.205, index=1)
+  umul.208: bits[32] = umul(literal.201, tuple_index.204)
+  umul.209: bits[32] = umul(literal.201, tuple_index.207)
+  send.210: token = send(tuple_index.206, umul.208, channel_id=4)
+  send.211: token = send(send.210, umul.209, channel_id=5)
+  next (send.211, state)
+}
+
+proc d(my_token: token, state: (), init={()}) {
+  literal.301: bits[32] = literal(value=4)
+  receive.302: (token, bits[32]) = receive(my_token, channel_id=4)
+  tuple_index.303: token = tuple_index(receive.302, index=0)
+  tuple_index.304: bits[32] = tuple_index(receive.302, index=1)
+  umul.305: bits[32] = umul(literal.301, tuple_index.304)
+  send.306: token = send(tuple_index.303, umul.305, channel_id=6)
+  next (send.306, state)
+}
+
+proc e(my_token: token, state: (), init={()}) {
+  literal.401: bits[32] = literal(value=5)
+  receive.402: (token, bits[32]) = receive(my_token, channel_id=5)
+  tuple_index.403: token = tuple_index(receive.402, index=0)
+  tuple_index.404: bits[32] = tuple_index(receive.402, index=1)
+  umul.405: bits[32] = umul(literal.401, tuple_index.404)
+  send.406: token = send(tuple_index.403, umul.405, channel_id=7)
+  next (send.406, state)
+}
+)";
+
+TEST_P(ThreadedProcRuntimeTest, XNetwork) {
+  constexpr int kNumCycles = 32;
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, Parser::ParsePackage(kXNetworkIr));
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime,
+                           ThreadedProcRuntime::Create(p.get(), GetParam()));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * i_a, p->GetChannel("i_a"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * i_b, p->GetChannel("i_b"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * d_o, p->GetChannel("d_o"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * e_o, p->GetChannel("e_o"));
+
+  // Unlike the tests of the serial runtime the internal channels are not
+  // primed so each tick passes values all the way through the network.
+  for (int i = 0; i < kNumCycles; i++) {
+    XLS_ASSERT_OK(runtime->WriteValueToChannel(i_a, Value(UBits(i, 32))));
+    XLS_ASSERT_OK(runtime->WriteValueToChannel(i_b, Value(UBits(i + 10, 32))));
+    XLS_ASSERT_OK(runtime->Tick());
+    EXPECT_THAT(runtime->ReadValueFromChannel(d_o),
+                IsOkAndHolds(Value(UBits(i * 1 * 3 * 4, 32))));
+    EXPECT_THAT(runtime->ReadValueFromChannel(e_o),
+                IsOkAndHolds(Value(UBits((i + 10) * 2 * 3 * 5, 32))));
+  }
+}
+
+TEST_P(ThreadedProcRuntimeTest, BlockedNetworkTerminatesTick) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, Parser::ParsePackage(kXNetworkIr));
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime,
+                           ThreadedProcRuntime::Create(p.get(), GetParam()));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * i_a, p->GetChannel("i_a"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * i_b, p->GetChannel("i_b"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * d_o, p->GetChannel("d_o"));
+
+  // With no inputs every proc blocks and the tick must still return.
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(runtime->ReadValueFromChannel(d_o), IsOkAndHolds(std::nullopt));
+
+  // Supplying only one input leaves "c" blocked on its second receive.
+  XLS_ASSERT_OK(runtime->WriteValueToChannel(i_a, Value(UBits(1, 32))));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(runtime->ReadValueFromChannel(d_o), IsOkAndHolds(std::nullopt));
+
+  // The blocked ticks resume where they left off.
+  XLS_ASSERT_OK(runtime->WriteValueToChannel(i_b, Value(UBits(1, 32))));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(runtime->ReadValueFromChannel(d_o),
+              IsOkAndHolds(Value(UBits(12, 32))));
+}
+
+TEST_P(ThreadedProcRuntimeTest, CarriesStateAndResets) {
+  constexpr int kNumCycles = 1000;
+  const std::string kIrText = R"(
+package p
+
+chan a_in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan a_to_b(bits[32], id=1, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan b_out(bits[32], id=2, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc a(my_token: token, state: (bits[32]), init={(1)}) {
+  tuple_index.1: bits[32] = tuple_index(state, index=0)
+  receive.2: (token, bits[32]) = receive(my_token, channel_id=0)
+  tuple_index.3: token = tuple_index(receive.2, index=0)
+  tuple_index.4: bits[32] = tuple_index(receive.2, index=1)
+  umul.5: bits[32] = umul(tuple_index.1, tuple_index.4)
+  send.6: token = send(tuple_index.3, umul.5, channel_id=1)
+  literal.7: bits[32] = literal(value=1)
+  add.8: bits[32] = add(tuple_index.1, literal.7)
+  tuple.9: (bits[32]) = tuple(add.8)
+  next (send.6, tuple.9)
+}
+
+proc b(my_token: token, state: (), init={()}) {
+  literal.100: bits[32] = literal(value=3)
+  receive.200: (token, bits[32]) = receive(my_token, channel_id=1)
+  tuple_index.300: token = tuple_index(receive.200, index=0)
+  tuple_index.400: bits[32] = tuple_index(receive.200, index=1)
+  umul.500: bits[32] = umul(literal.100, tuple_index.400)
+  send.600: token = send(tuple_index.300, umul.500, channel_id=2)
+  next (send.600, state)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime,
+                           ThreadedProcRuntime::Create(p.get(), GetParam()));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * a_in, p->GetChannel("a_in"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * b_out, p->GetChannel("b_out"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * a, p->GetProc("a"));
+
+  for (int i = 0; i < kNumCycles; i++) {
+    XLS_ASSERT_OK(runtime->WriteValueToChannel(a_in, Value(UBits(i, 32))));
+    XLS_ASSERT_OK(runtime->Tick());
+    ASSERT_THAT(runtime->ReadValueFromChannel(b_out),
+                IsOkAndHolds(Value(UBits(i * (i + 1) * 3, 32))));
+  }
+  EXPECT_THAT(runtime->ProcState(a),
+              IsOkAndHolds(ElementsAre(Value::Tuple(
+                  {Value(UBits(kNumCycles + 1, 32))}))));
+
+  runtime->ResetState();
+  EXPECT_THAT(runtime->ProcState(a),
+              IsOkAndHolds(ElementsAre(Value::Tuple({Value(UBits(1, 32))}))));
+}
+
+INSTANTIATE_TEST_SUITE_P(ThreadedProcRuntimeTestInstantiation,
+                         ThreadedProcRuntimeTest,
+                         testing::Values(0, 1, 2, 3));
+
+}  // namespace
+}  // namespace xls
@@ -32,7 +32,7 @@ type Key = aes_common::Key;
 type KeyWidth = aes_common::KeyWidth;
 
 // Describes an encryption operation to be performed.
-struct Command {
+pub struct Command {
     // True to encrypt, false to decrypt.
     encrypt: bool,
     // The number of [complete] input message blocks to process.
@@ -0,0 +1,458 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements AES-GCM processing N blocks per proc iteration, for cores which
+// must encrypt faster than one block per cycle.
+//
+// The message is encrypted by N CTR lanes, each encrypting one block with
+// consecutive counter values. The authentication tag is computed by
+// aggregated GHASH: with X the tag so far and B_0..B_{k-1} the k blocks of an
+// iteration, the tag is updated as
+//
+//   X' = ((X ^ B_0) * H^k) ^ (B_1 * H^(k-1)) ^ ... ^ (B_{k-1} * H)
+//
+// which equals k steps of the serial update X' = (X ^ B) * H but has no chain
+// of multiplications: the k products are independent. The powers H^1..H^N of
+// the hash key are computed one per iteration after each command is received.
+import xls.modules.aes.aes
+import xls.modules.aes.aes_common
+import xls.modules.aes.aes_gcm
+import xls.modules.aes.ghash
+
+type Block = aes_common::Block;
+type Command = aes_gcm::Command;
+type InitVector = aes_common::InitVector;
+type Key = aes_common::Key;
+type KeyWidth = aes_common::KeyWidth;
+
+const ZERO_BLOCK = aes_common::ZERO_BLOCK;
+
+// The proc's FSM state.
+enum Step : u3 {
+    // Not processing any message; waiting for the next command.
+    IDLE = 0,
+    // Computing the powers of the hash key.
+    COMPUTE_H_POWERS = 1,
+    // Reading AAD from the input channel.
+    READ_AAD = 2,
+    // Reading message data from the input channel.
+    READ_MSG = 3,
+    // Finalizing the authentication tag.
+    HASH_LENGTHS = 4,
+    // Invalid. Should never be used.
+    INVALID = 5,
+}
+
+// The full state of the proc.
+pub struct State<N: u32> {
+    // The FSM state, as above.
+    step: Step,
+
+    // The command currently being processed.
+    command: Command,
+
+    // The number of AAD blocks left to receive.
+    aad_blocks_left: u32,
+
+    // The number of input message blocks left to receive.
+    msg_blocks_left: u32,
+
+    // The counter value with which to encrypt the next message block.
+    ctr: u32,
+
+    // The powers of the hash key: element i holds H^(i + 1).
+    h_powers: Block[N],
+
+    // The number of elements of h_powers computed so far.
+    h_powers_done: u32,
+
+    // The GHASH of the blocks processed so far.
+    tag: Block,
+}
+
+// Returns a "zero-valued" State structure, suitable for initializing the proc.
+pub fn initial_state<N: u32>() -> State<N> {
+    State<N> {
+        step: Step::IDLE,
+        command: aes_gcm::Command {
+            encrypt: false,
+            msg_blocks: u32:0,
+            aad_blocks: u32:0,
+            key: Key:[u8:0, ...],
+            key_width: KeyWidth::KEY_128,
+            iv: InitVector:0,
+        },
+        aad_blocks_left: u32:0,
+        msg_blocks_left: u32:0,
+        ctr: u32:0,
+        h_powers: Block[N]:[ZERO_BLOCK, ...],
+        h_powers_done: u32:0,
+        tag: ZERO_BLOCK,
+    }
+}
+
+// Creates the counter block for the given IV and counter value.
+fn create_ctr_block(iv: InitVector, ctr: u32) -> Block {
+    let ctr_block = (iv ++ ctr) as u8[16];
+    Block:[
+        [ctr_block[0], ctr_block[1], ctr_block[2], ctr_block[3]],
+        [ctr_block[4], ctr_block[5], ctr_block[6], ctr_block[7]],
+        [ctr_block[8], ctr_block[9], ctr_block[10], ctr_block[11]],
+        [ctr_block[12], ctr_block[13], ctr_block[14], ctr_block[15]],
+    ]
+}
+
+// Creates the final block hashed into the tag: the bit lengths of the AAD and
+// of the message.
+fn create_lengths_block(command: Command) -> Block {
+    let x = ((command.aad_blocks * u32:128) as u64) as u32[2];
+    let y = ((command.msg_blocks * u32:128) as u64) as u32[2];
+    Block:[x[0] as u8[4], x[1] as u8[4], y[0] as u8[4], y[1] as u8[4]]
+}
+
+// Encrypts (or decrypts) each of the given blocks in CTR mode, the i'th with
+// counter value `ctr + i`.
+fn ctr_encrypt<N: u32>(command: Command, ctr: u32, blocks: Block[N]) -> Block[N] {
+    for (i, result) in range(u32:0, N) {
+        let ctr_block = create_ctr_block(command.iv, ctr + i);
+        let key_stream = aes::encrypt(command.key, command.key_width, ctr_block);
+        update(result, i, aes_common::xor_block(blocks[i], key_stream))
+    }(Block[N]:[ZERO_BLOCK, ...])
+}
+
+// Returns the GHASH of `tag` followed by the first `count` of `blocks`, where
+// `h_powers` holds H^1..H^N. `count` must be nonzero.
+fn ghash_blocks<N: u32>(tag: Block, blocks: Block[N], count: u32,
+                        h_powers: Block[N]) -> Block {
+    for (i, acc) in range(u32:0, N) {
+        let block = if i == u32:0 { aes_common::xor_block(tag, blocks[i]) }
+                    else { blocks[i] };
+        let power_idx = if i < count { count - i - u32:1 } else { u32:0 };
+        let product = ghash::gf128_mul_parallel(block, h_powers[power_idx]);
+        if i < count { aes_common::xor_block(acc, product) } else { acc }
+    }(ZERO_BLOCK)
+}
+
+// Returns the first step in which data is read, given the number of blocks of
+// AAD and message to read.
+fn data_step(aad_blocks_left: u32, msg_blocks_left: u32) -> Step {
+    if aad_blocks_left != u32:0 {
+        Step::READ_AAD
+    } else {
+        if msg_blocks_left != u32:0 { Step::READ_MSG } else { Step::HASH_LENGTHS }
+    }
+}
+
+// The proc that implements AES-GCM over N blocks per iteration. It makes use of
+// three channels:
+//  - One for receiving command descriptors, as for aes_gcm.
+//  - One for receiving input data: AAD blocks followed by plaintext blocks, N
+//    blocks at a time. The AAD and the plaintext each start at a new transfer,
+//    and each of their last transfers holds the remaining blocks in its first
+//    elements.
+//  - One for sending output data: ciphertext blocks, N at a time and split as
+//    the plaintext is, followed by the authentication tag in the first element
+//    of a final transfer.
+//
+// Each command takes N iterations before data is read: one to receive it and
+// N - 1 to compute the powers of the hash key.
+pub proc aes_gcm_parallel<N: u32> {
+    command_in: chan<Command> in;
+    data_in: chan<Block[N]> in;
+    data_out: chan<Block[N]> out;
+
+    config(command_in: chan<Command> in,
+           data_in: chan<Block[N]> in,
+           data_out: chan<Block[N]> out) {
+        (command_in, data_in, data_out)
+    }
+
+    next(tok: token, state: State<N>) {
+        let idle = state.step == Step::IDLE;
+        let (tok, command) = recv_if(tok, command_in, idle);
+        let command = if idle { command } else { state.command };
+
+        // The hash key H is the encryption of the zero block.
+        let last_power_idx =
+            if state.h_powers_done == u32:0 { u32:0 } else { state.h_powers_done - u32:1 };
+        let next_power =
+            ghash::gf128_mul_parallel(state.h_powers[last_power_idx], state.h_powers[0]);
+        let h_powers = match state.step {
+            Step::IDLE => update(Block[N]:[ZERO_BLOCK, ...], u32:0,
+                                 aes::encrypt(command.key, command.key_width, ZERO_BLOCK)),
+            Step::COMPUTE_H_POWERS => update(state.h_powers, state.h_powers_done, next_power),
+            _ => state.h_powers,
+        };
+        let h_powers_done = match state.step {
+            Step::IDLE => u32:1,
+            Step::COMPUTE_H_POWERS => state.h_powers_done + u32:1,
+            _ => state.h_powers_done,
+        };
+
+        // Encrypt or decrypt the message blocks, and hash the AAD and the
+        // ciphertext.
+        let reading = state.step == Step::READ_AAD || state.step == Step::READ_MSG;
+        let (tok, input) = recv_if(tok, data_in, reading);
+        let blocks_left =
+            if state.step == Step::READ_AAD { state.aad_blocks_left }
+            else { state.msg_blocks_left };
+        let count = if blocks_left < N { blocks_left } else { N };
+        let output = ctr_encrypt(command, state.ctr, input);
+        let hashed = if state.step == Step::READ_MSG && command.encrypt { output }
+                     else { input };
+
+        // Once all data has been hashed, hash the lengths block, then XOR the
+        // tag with the encryption of counter 1.
+        let hash_lengths = state.step == Step::HASH_LENGTHS;
+        let hashed = if hash_lengths {
+            update(Block[N]:[ZERO_BLOCK, ...], u32:0, create_lengths_block(command))
+        } else {
+            hashed
+        };
+        let count = if hash_lengths { u32:1 } else { count };
+        let tag = ghash_blocks(state.tag, hashed, count, state.h_powers);
+        let tag_mask = aes::encrypt(
+            command.key, command.key_width, create_ctr_block(command.iv, u32:1));
+        let output = if hash_lengths {
+            update(Block[N]:[ZERO_BLOCK, ...], u32:0, aes_common::xor_block(tag, tag_mask))
+        } else {
+            output
+        };
+        let tok = send_if(tok, data_out, state.step == Step::READ_MSG || hash_lengths, output);
+
+        let tag = if reading || hash_lengths { tag } else {
+            if idle { ZERO_BLOCK } else { state.tag }
+        };
+        let aad_blocks_left = match state.step {
+            Step::IDLE => command.aad_blocks,
+            Step::READ_AAD => state.aad_blocks_left - count,
+            _ => state.aad_blocks_left,
+        };
+        let msg_blocks_left = match state.step {
+            Step::IDLE => command.msg_blocks,
+            Step::READ_MSG => state.msg_blocks_left - count,
+            _ => state.msg_blocks_left,
+        };
+        // As in aes_gcm, counter values 0 and 1 are used for the hash key and
+        // the tag mask, so the message is encrypted from counter value 2.
+        let ctr = match state.step {
+            Step::IDLE => u32:2,
+            Step::READ_MSG => state.ctr + count,
+            _ => state.ctr,
+        };
+
+        let next_step = match state.step {
+            Step::IDLE => if N > u32:1 { Step::COMPUTE_H_POWERS }
+                          else { data_step(aad_blocks_left, msg_blocks_left) },
+            Step::COMPUTE_H_POWERS => if h_powers_done < N { Step::COMPUTE_H_POWERS }
+                                      else { data_step(aad_blocks_left, msg_blocks_left) },
+            Step::READ_AAD => data_step(aad_blocks_left, msg_blocks_left),
+            Step::READ_MSG => data_step(u32:0, msg_blocks_left),
+            Step::HASH_LENGTHS => Step::IDLE,
+            // Unreachable from a valid state.
+            _ => Step::INVALID,
+        };
+
+        State<N> {
+            step: next_step,
+            command: command,
+            aad_blocks_left: aad_blocks_left,
+            msg_blocks_left: msg_blocks_left,
+            ctr: ctr,
+            h_powers: h_powers,
+            h_powers_done: h_powers_done,
+            tag: tag,
+        }
+    }
+}
+
+// An AES-GCM unit processing four blocks (512 bits) per iteration.
+proc aes_gcm_parallel_4 {
+    config(command_in: chan<Command> in,
+           data_in: chan<Block[4]> in,
+           data_out: chan<Block[4]> out) {
+        spawn aes_gcm_parallel<u32:4>(command_in, data_in, data_out)
+            (initial_state<u32:4>());
+        ()
+    }
+
+    // Nothing to do here - the spawned proc does all the lifting.
+    next(tok: token) { () }
+}
+
+// The AAD, message and expected results shared by the tests below: the same
+// as those of aes_gcm_multi_block_gcm in aes_gcm.x.
+const TEST_KEY = Key:[
+    u8:0xfe, u8:0xdc, u8:0xba, u8:0x98,
+    u8:0x76, u8:0x54, u8:0x32, u8:0x10,
+    u8:0x01, u8:0x23, u8:0x45, u8:0x67,
+    u8:0x89, u8:0xab, u8:0xcd, u8:0xef,
+    ...];
+const TEST_IV = InitVector:0xdead_beef_cafe_f00d_abba_baab;
+const TEST_AAD = Block[2]:[
+    Block:[
+        [u8:0xff, u8:0xee, u8:0xdd, u8:0xcc],
+        [u8:0xbb, u8:0xaa, u8:0x99, u8:0x88],
+        [u8:0x77, u8:0x66, u8:0x55, u8:0x44],
+        [u8:0x33, u8:0x22, u8:0x11, u8:0x00],
+    ],
+    Block:[
+        [u8:0xf0, u8:0xe1, u8:0xd2, u8:0xc3],
+        [u8:0xb4, u8:0xa5, u8:0x96, u8:0x87],
+        [u8:0x78, u8:0x69, u8:0x5a, u8:0x4b],
+        [u8:0x3c, u8:0x2d, u8:0x1e, u8:0x0f],
+    ],
+];
+const TEST_MSG = Block[3]:[
+    Block:[
+        [u8:0x01, u8:0x02, u8:0x03, u8:0x04],
+        [u8:0x50, u8:0x60, u8:0x70, u8:0x80],
+        [u8:0x09, u8:0xa0, u8:0x0b, u8:0xc0],
+        [u8:0xd0, u8:0x0e, u8:0xf0, u8:0x11],
+    ],
+    Block:[
+        [u8:0x11, u8:0x22, u8:0x33, u8:0x44],
+        [u8:0x55, u8:0x66, u8:0x77, u8:0x88],
+        [u8:0x99, u8:0xaa, u8:0xbb, u8:0xcc],
+        [u8:0xdd, u8:0xee, u8:0xff, u8:0xa5],
+    ],
+    Block:[
+        [u8:0xaa, u8:0x55, u8:0xaa, u8:0x55],
+        [u8:0x55, u8:0xaa, u8:0x55, u8:0xaa],
+        [u8:0xa5, u8:0x5a, u8:0xa5, u8:0x5a],
+        [u8:0x5a, u8:0xa5, u8:0x5a, u8:0xa5],
+    ],
+];
+const TEST_CTXT = Block[3]:[
+    Block:[
+        [u8:0x14, u8:0x68, u8:0x63, u8:0xde],
+        [u8:0xb3, u8:0x68, u8:0xfb, u8:0x35],
+        [u8:0xcb, u8:0xeb, u8:0xa2, u8:0x79],
+        [u8:0xc9, u8:0xe3, u8:0xef, u8:0xef],
+    ],
+    Block:[
+        [u8:0x86, u8:0xe1, u8:0x68, u8:0x07],
+        [u8:0xd5, u8:0x4f, u8:0x2d, u8:0x97],
+        [u8:0xd6, u8:0xea, u8:0x78, u8:0xce],
+        [u8:0x7d, u8:0xfc, u8:0x08, u8:0xb0],
+    ],
+    Block:[
+        [u8:0xcc, u8:0xe6, u8:0x42, u8:0x11],
+        [u8:0x76, u8:0x65, u8:0x12, u8:0x1b],
+        [u8:0xee, u8:0xe2, u8:0xab, u8:0xf9],
+        [u8:0x52, u8:0x08, u8:0xd7, u8:0x7c],
+    ],
+];
+const TEST_TAG = Block:[
+    [u8:0x6a, u8:0xa1, u8:0x83, u8:0x0f],
+    [u8:0x84, u8:0x53, u8:0xe7, u8:0xcb],
+    [u8:0x99, u8:0x93, u8:0x64, u8:0xaa],
+    [u8:0x42, u8:0x8c, u8:0xeb, u8:0x65],
+];
+
+const TEST_COMMAND = aes_gcm::Command {
+    encrypt: true,
+    aad_blocks: u32:2,
+    msg_blocks: u32:3,
+    key: TEST_KEY,
+    key_width: KeyWidth::KEY_128,
+    iv: TEST_IV,
+};
+
+// Tests four blocks per iteration: each of the AAD and the message fits in a
+// single partially-filled transfer.
+#[test_proc()]
+proc aes_gcm_parallel_4_test {
+    command_out: chan<Command> out;
+    input_out: chan<Block[4]> out;
+    result_in: chan<Block[4]> in;
+    terminator: chan<bool> out;
+
+    config(terminator: chan<bool> out) {
+        let (command_in, command_out) = chan<Command>;
+        let (input_in, input_out) = chan<Block[4]>;
+        let (result_in, result_out) = chan<Block[4]>;
+        spawn aes_gcm_parallel_4(command_in, input_in, result_out)();
+        (command_out, input_out, result_in, terminator)
+    }
+
+    next(tok: token) {
+        let tok = send(tok, command_out, TEST_COMMAND);
+        let tok = send(tok, input_out,
+                       Block[4]:[TEST_AAD[0], TEST_AAD[1], ZERO_BLOCK, ZERO_BLOCK]);
+        let tok = send(tok, input_out,
+                       Block[4]:[TEST_MSG[0], TEST_MSG[1], TEST_MSG[2], ZERO_BLOCK]);
+
+        let (tok, ctxt) = recv(tok, result_in);
+        let _ = assert_eq(ctxt[0], TEST_CTXT[0]);
+        let _ = assert_eq(ctxt[1], TEST_CTXT[1]);
+        let _ = assert_eq(ctxt[2], TEST_CTXT[2]);
+
+        let (tok, tag) = recv(tok, result_in);
+        let _ = assert_eq(tag[0], TEST_TAG);
+
+        let _ = send(tok, terminator, true);
+        ()
+    }
+}
+
+// Tests two blocks per iteration: the AAD fills a transfer and the message
+// spans a full and a partially-filled transfer. Decrypting the ciphertext
+// must give back the message and the same tag.
+#[test_proc()]
+proc aes_gcm_parallel_2_test {
+    command_out: chan<Command> out;
+    input_out: chan<Block[2]> out;
+    result_in: chan<Block[2]> in;
+    terminator: chan<bool> out;
+
+    config(terminator: chan<bool> out) {
+        let (command_in, command_out) = chan<Command>;
+        let (input_in, input_out) = chan<Block[2]>;
+        let (result_in, result_out) = chan<Block[2]>;
+        spawn aes_gcm_parallel<u32:2>(command_in, input_in, result_out)
+            (initial_state<u32:2>());
+        (command_out, input_out, result_in, terminator)
+    }
+
+    next(tok: token) {
+        let tok = send(tok, command_out, TEST_COMMAND);
+        let tok = send(tok, input_out, TEST_AAD);
+        let tok = send(tok, input_out, Block[2]:[TEST_MSG[0], TEST_MSG[1]]);
+        let tok = send(tok, input_out, Block[2]:[TEST_MSG[2], ZERO_BLOCK]);
+
+        let (tok, ctxt) = recv(tok, result_in);
+        let _ = assert_eq(ctxt, Block[2]:[TEST_CTXT[0], TEST_CTXT[1]]);
+        let (tok, ctxt) = recv(tok, result_in);
+        let _ = assert_eq(ctxt[0], TEST_CTXT[2]);
+        let (tok, tag) = recv(tok, result_in);
+        let _ = assert_eq(tag[0], TEST_TAG);
+
+        let command = aes_gcm::Command { encrypt: false, ..TEST_COMMAND };
+        let tok = send(tok, command_out, command);
+        let tok = send(tok, input_out, TEST_AAD);
+        let tok = send(tok, input_out, Block[2]:[TEST_CTXT[0], TEST_CTXT[1]]);
+        let tok = send(tok, input_out, Block[2]:[TEST_CTXT[2], ZERO_BLOCK]);
+
+        let (tok, ptxt) = recv(tok, result_in);
+        let _ = assert_eq(ptxt, Block[2]:[TEST_MSG[0], TEST_MSG[1]]);
+        let (tok, ptxt) = recv(tok, result_in);
+        let _ = assert_eq(ptxt[0], TEST_MSG[2]);
+        let (tok, tag) = recv(tok, result_in);
+        let _ = assert_eq(tag[0], TEST_TAG);
+
+        let _ = send(tok, terminator, true);
+        ()
+    }
+}
@@ -24,7 +24,9 @@
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "openssl/aead.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
@@ -42,6 +44,8 @@
 ABSL_FLAG(int, num_samples, 100, "The number of samples to execute.");
 ABSL_FLAG(bool, print_traces, false,
           "If true, print any trace! or trace_fmt! messages.");
+ABSL_FLAG(int, throughput_blocks, 128,
+          "The number of message blocks encrypted to measure throughput.");
 
 namespace xls::aes {
 
@@ -50,12 +54,33 @@ constexpr int kMaxPtxtBlocks = 128;
 constexpr int kTagBits = 128;
 constexpr int kTagBytes = kTagBits / 8;
 
-constexpr std::string_view kIrPath = "xls/modules/aes/aes_gcm.ir";
-constexpr std::string_view kCmdChannelName = "aes_gcm__command_in";
-constexpr std::string_view kDataInChannelName = "aes_gcm__data_in";
-constexpr std::string_view kDataOutChannelName = "aes_gcm__data_out";
+// Describes one of the AES-GCM procs under test.
+struct GcmVariant {
+  std::string_view name;
+  std::string_view ir_path;
+  std::string_view cmd_channel_name;
+  std::string_view data_in_channel_name;
+  std::string_view data_out_channel_name;
+  // The number of blocks processed per proc iteration. The data channels of
+  // procs which process more than one block carry arrays of that many blocks.
+  int blocks_per_transfer;
+};
+
+constexpr GcmVariant kSerialVariant = {
+    "aes_gcm",           "xls/modules/aes/aes_gcm.ir",
+    "aes_gcm__command_in", "aes_gcm__data_in",
+    "aes_gcm__data_out", 1};
+
+constexpr GcmVariant kParallelVariant = {
+    "aes_gcm_parallel_4",
+    "xls/modules/aes/aes_gcm_parallel_4.ir",
+    "aes_gcm_parallel_4__command_in",
+    "aes_gcm_parallel_4__data_in",
+    "aes_gcm_parallel_4__data_out",
+    4};
 
 struct JitData {
+  GcmVariant variant;
   std::unique_ptr<Package> package;
   std::unique_ptr<SerialProcRuntime> runtime;
 };
@@ -72,6 +97,8 @@ struct SampleData {
 struct Result {
   std::vector<Block> output_data;
   Block auth_tag;
+  // The number of ticks of the proc network to process the command.
+  int64_t ticks = 0;
 };
 
 absl::StatusOr<Value> CreateCommandValue(const SampleData& sample_data,
@@ -94,51 +121,95 @@ absl::StatusOr<Value> CreateCommandValue(const SampleData& sample_data,
   return Value::Tuple(command_elements);
 }
 
+// Packs the given blocks into values of the data channels of `variant`. Each
+// value holds `variant.blocks_per_transfer` blocks; the last is padded with
+// zero blocks.
+absl::StatusOr<std::vector<Value>> BlocksToChannelValues(
+    const GcmVariant& variant, const std::vector<Block>& blocks) {
+  std::vector<Value> values;
+  for (int i = 0; i < blocks.size(); i += variant.blocks_per_transfer) {
+    if (variant.blocks_per_transfer == 1) {
+      XLS_ASSIGN_OR_RETURN(Value block_value, BlockToValue(blocks[i]));
+      values.push_back(block_value);
+      continue;
+    }
+    std::vector<Value> elements;
+    for (int j = i; j < i + variant.blocks_per_transfer; j++) {
+      Block block = {};
+      if (j < blocks.size()) {
+        block = blocks[j];
+      }
+      XLS_ASSIGN_OR_RETURN(Value block_value, BlockToValue(block));
+      elements.push_back(block_value);
+    }
+    XLS_ASSIGN_OR_RETURN(Value value, Value::Array(elements));
+    values.push_back(value);
+  }
+  return values;
+}
+
+// Unpacks a value of the data channels of `variant` into its blocks.
+absl::StatusOr<std::vector<Block>> ChannelValueToBlocks(
+    const GcmVariant& variant, const Value& value) {
+  if (variant.blocks_per_transfer == 1) {
+    XLS_ASSIGN_OR_RETURN(Block block, ValueToBlock(value));
+    return std::vector<Block>{block};
+  }
+  std::vector<Block> blocks;
+  for (const Value& element : value.elements()) {
+    XLS_ASSIGN_OR_RETURN(Block block, ValueToBlock(element));
+    blocks.push_back(block);
+  }
+  return blocks;
+}
+
 absl::StatusOr<Result> XlsEncrypt(JitData* jit_data,
                                   const SampleData& sample_data, bool encrypt) {
   // Create (and send) the initial command.
+  const GcmVariant& variant = jit_data->variant;
   Package* package = jit_data->package.get();
   SerialProcRuntime* runtime = jit_data->runtime.get();
   XLS_ASSIGN_OR_RETURN(Channel * cmd_channel,
-                       package->GetChannel(kCmdChannelName));
+                       package->GetChannel(variant.cmd_channel_name));
   XLS_ASSIGN_OR_RETURN(Value command, CreateCommandValue(sample_data, encrypt));
   XLS_RETURN_IF_ERROR(runtime->WriteValueToChannel(cmd_channel, command));
 
   // Then send all input data: the AAD followed by the message body.
   XLS_ASSIGN_OR_RETURN(Channel * data_in_channel,
-                       package->GetChannel(kDataInChannelName));
-  for (int i = 0; i < sample_data.aad.size(); i++) {
-    XLS_ASSIGN_OR_RETURN(Value block_value, BlockToValue(sample_data.aad[i]));
-    XLS_RETURN_IF_ERROR(
-        runtime->WriteValueToChannel(data_in_channel, block_value));
-  }
-
-  for (int i = 0; i < sample_data.input_data.size(); i++) {
-    XLS_ASSIGN_OR_RETURN(Value block_value,
-                         BlockToValue(sample_data.input_data[i]));
-    XLS_RETURN_IF_ERROR(
-        runtime->WriteValueToChannel(data_in_channel, block_value));
+                       package->GetChannel(variant.data_in_channel_name));
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> aad_values,
+                       BlocksToChannelValues(variant, sample_data.aad));
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> input_values,
+                       BlocksToChannelValues(variant, sample_data.input_data));
+  for (const std::vector<Value>* values : {&aad_values, &input_values}) {
+    for (const Value& value : *values) {
+      XLS_RETURN_IF_ERROR(runtime->WriteValueToChannel(data_in_channel, value));
+    }
   }
 
   // Tick the network until we have all results.
   Result result;
   XLS_ASSIGN_OR_RETURN(Channel * data_out_channel,
-                       package->GetChannel(kDataOutChannelName));
+                       package->GetChannel(variant.data_out_channel_name));
   int msg_blocks_left = sample_data.input_data.size();
   while (true) {
     XLS_RETURN_IF_ERROR(runtime->Tick());
+    result.ticks++;
     XLS_ASSIGN_OR_RETURN(std::optional<Value> maybe_value,
                          runtime->ReadValueFromChannel(data_out_channel));
     if (!maybe_value.has_value()) {
       continue;
     }
 
-    XLS_ASSIGN_OR_RETURN(Block block, ValueToBlock(maybe_value.value()));
+    XLS_ASSIGN_OR_RETURN(std::vector<Block> blocks,
+                         ChannelValueToBlocks(variant, maybe_value.value()));
     if (msg_blocks_left > 0) {
-      result.output_data.push_back(block);
-      msg_blocks_left--;
+      for (int i = 0; i < blocks.size() && msg_blocks_left > 0; i++) {
+        result.output_data.push_back(blocks[i]);
+        msg_blocks_left--;
+      }
     } else {
-      result.auth_tag = block;
+      result.auth_tag = blocks[0];
       break;
     }
   }
@@ -294,9 +365,9 @@ absl::StatusOr<bool> RunSample(JitData* jit_data,
   return true;
 }
 
-absl::StatusOr<JitData> CreateJitData() {
+absl::StatusOr<JitData> CreateJitData(const GcmVariant& variant) {
   XLS_ASSIGN_OR_RETURN(std::filesystem::path full_ir_path,
-                       GetXlsRunfilePath(kIrPath));
+                       GetXlsRunfilePath(variant.ir_path));
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(full_ir_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(ir_text));
@@ -304,16 +375,17 @@ absl::StatusOr<JitData> CreateJitData() {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
                        SerialProcRuntime::Create(package.get()));
 
-  JitData jit_data{std::move(package), std::move(runtime)};
+  JitData jit_data{variant, std::move(package), std::move(runtime)};
   return jit_data;
 }
 
-absl::Status RunTest(int num_samples, int key_bits) {
+absl::Status RunTest(const GcmVariant& variant, int num_samples,
+                     int key_bits) {
   int key_bytes = key_bits / 8;
   SampleData sample_data;
   sample_data.key.fill(0);
   sample_data.key_bits = key_bits;
-  XLS_ASSIGN_OR_RETURN(JitData jit_data, CreateJitData());
+  XLS_ASSIGN_OR_RETURN(JitData jit_data, CreateJitData(variant));
 
   absl::BitGen bitgen;
   for (int sample_idx = 0; sample_idx < num_samples; sample_idx++) {
@@ -371,15 +443,71 @@ absl::Status RunTest(int num_samples, int key_bits) {
     }
   }
 
-  std::cout << "AES-GCM: Successfully ran " << num_samples << " " << key_bits
-            << "-bit samples." << std::endl;
+  std::cout << variant.name << ": Successfully ran " << num_samples << " "
+            << key_bits << "-bit samples." << std::endl;
 
   return absl::OkStatus();
 }
 
+// Returns the number of message blocks encrypted per tick of the proc network
+// of `variant` when encrypting a message of `num_blocks` blocks. Each tick runs
+// every proc once, so this is the throughput in blocks per cycle of a
+// full-throughput implementation of the procs.
+absl::StatusOr<double> MeasureThroughput(const GcmVariant& variant,
+                                         int num_blocks) {
+  XLS_ASSIGN_OR_RETURN(JitData jit_data, CreateJitData(variant));
+  SampleData sample_data;
+  sample_data.openssl_ctxt = nullptr;
+  sample_data.key.fill(0);
+  sample_data.key_bits = 128;
+  sample_data.init_vector.fill(0);
+  sample_data.input_data.resize(num_blocks);
+  absl::BitGen bitgen;
+  for (Block& block : sample_data.input_data) {
+    for (int byte_idx = 0; byte_idx < kBlockBytes; byte_idx++) {
+      block[byte_idx] = absl::Uniform(bitgen, 0, 256);
+    }
+  }
+  sample_data.aad.resize(1);
+  sample_data.aad[0].fill(0);
+
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(Result result,
+                       XlsEncrypt(&jit_data, sample_data, /*encrypt=*/true));
+  absl::Duration elapsed = absl::Now() - start;
+  double blocks_per_tick = static_cast<double>(num_blocks) / result.ticks;
+  std::cout << absl::StreamFormat(
+                   "%s: Encrypted %d blocks in %d ticks (%.2f blocks/tick, "
+                   "%.1f JIT blocks/s)",
+                   variant.name, num_blocks, result.ticks, blocks_per_tick,
+                   num_blocks / absl::ToDoubleSeconds(elapsed))
+            << std::endl;
+  return blocks_per_tick;
+}
+
 absl::Status RealMain(int num_samples) {
-  XLS_RETURN_IF_ERROR(RunTest(num_samples, /*key_bits=*/128));
-  return RunTest(num_samples, /*key_bits=*/256);
+  for (const GcmVariant& variant : {kSerialVariant, kParallelVariant}) {
+    XLS_RETURN_IF_ERROR(RunTest(variant, num_samples, /*key_bits=*/128));
+    XLS_RETURN_IF_ERROR(RunTest(variant, num_samples, /*key_bits=*/256));
+  }
+
+  // The parallel variant must encrypt more than one block per tick once the
+  // cost of starting a command is amortized.
+  int throughput_blocks = absl::GetFlag(FLAGS_throughput_blocks);
+  XLS_ASSIGN_OR_RETURN(double serial_throughput,
+                       MeasureThroughput(kSerialVariant, throughput_blocks));
+  XLS_ASSIGN_OR_RETURN(
+      double parallel_throughput,
+      MeasureThroughput(kParallelVariant, throughput_blocks));
+  if (parallel_throughput <= serial_throughput ||
+      parallel_throughput <= 1.0) {
+    return absl::InternalError(absl::StrFormat(
+        "Expected %s to encrypt more than one block per tick and more than "
+        "%s; got %.2f and %.2f blocks per tick",
+        kParallelVariant.name, kSerialVariant.name, parallel_throughput,
+        serial_throughput));
+  }
+  return absl::OkStatus();
 }
 
 }  // namespace xls::aes
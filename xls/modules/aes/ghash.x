@@ -64,6 +64,33 @@ pub fn gf128_mul(x: Block, y: Block) -> Block {
     u128_to_block(z_v.0)
 }
 
+// Computes the same product as gf128_mul, but structured for shallow logic:
+// the partial products of the carry-less multiplication are independent of
+// each other and are combined with a single wide XOR, followed by a two-step
+// reduction modulo x^128 + x^7 + x^2 + x + 1. gf128_mul instead computes a
+// chain of 128 dependent steps.
+// GCM numbers the coefficients from the most significant bit of a block, so
+// the operands and result are bit-reversed to perform the arithmetic on
+// conventionally-ordered polynomials.
+pub fn gf128_mul_parallel(x: Block, y: Block) -> Block {
+    let a = rev(block_to_u128(x));
+    let b = rev(block_to_u128(y)) as uN[256];
+
+    let product = for (i, product) in range(u32:0, u32:128) {
+        if (a >> i) as u1 == u1:0 { product } else { product ^ (b << i) }
+    }(uN[256]:0);
+
+    // Fold the high half into the low half using x^128 = x^7 + x^2 + x + 1.
+    // The first fold has degree at most 133, so a second fold of its top bits
+    // completes the reduction.
+    let high = product[128:256] as uN[136];
+    let fold = high ^ (high << 1) ^ (high << 2) ^ (high << 7);
+    let high = fold[128:136] as uN[128];
+    let result = product[0:128] ^ fold[0:128] ^
+                 high ^ (high << 1) ^ (high << 2) ^ (high << 7);
+    u128_to_block(rev(result))
+}
+
 #[test]
 fn gf128_mul_test() {
     // Test vectors were constructed by evaluation against a reference.
@@ -142,6 +169,40 @@ fn gf128_mul_test() {
     assert_eq(z, expected)
 }
 
+#[test]
+fn gf128_mul_parallel_test() {
+    let key = aes_common::Key:[u8:0, ...];
+    let h = aes::encrypt(key, aes_common::KeyWidth::KEY_128, ZERO_BLOCK);
+    let a = Block:[
+        [u8:0x66, u8:0xe9, u8:0x4b, u8:0xd4],
+        [u8:0xef, u8:0x8a, u8:0x2c, u8:0x3b],
+        [u8:0x88, u8:0x4c, u8:0xfa, u8:0x59],
+        [u8:0xca, u8:0x34, u8:0x2b, u8:0x2e],
+    ];
+    let b = Block:[
+        [u8:0x80, u8:0x55, u8:0xaa, u8:0x55],
+        [u8:0x55, u8:0xaa, u8:0x55, u8:0xaa],
+        [u8:0xa5, u8:0x5a, u8:0xa5, u8:0x5a],
+        [u8:0x5a, u8:0xa5, u8:0x5a, u8:0x01],
+    ];
+    let expected = Block:[
+        [u8:0x3b, u8:0xfe, u8:0x59, u8:0x12],
+        [u8:0xce, u8:0xdc, u8:0xff, u8:0x05],
+        [u8:0x88, u8:0x0f, u8:0xd7, u8:0x14],
+        [u8:0xcd, u8:0x72, u8:0xa1, u8:0x93],
+    ];
+    let _ = assert_eq(gf128_mul_parallel(a, b), expected);
+    let _ = assert_eq(gf128_mul_parallel(b, a), expected);
+    let _ = assert_eq(gf128_mul_parallel(a, ZERO_BLOCK), ZERO_BLOCK);
+
+    // Products whose high halves need both reduction steps.
+    let _ = assert_eq(gf128_mul_parallel(h, h), gf128_mul(h, h));
+    let _ = assert_eq(gf128_mul_parallel(h, b), gf128_mul(h, b));
+    let all_ones = Block:[u8[4]:[u8:0xff, ...], ...];
+    assert_eq(gf128_mul_parallel(all_ones, all_ones),
+              gf128_mul(all_ones, all_ones))
+}
+
 // Describes the inputs to the GHASH function/proc.
 // TODO(rspringer): Make more flexible: enable partial AAD and ciphertext blocks.
 pub struct Command {
@@ -0,0 +1,165 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file implements [most of] IEEE 754 floating point division, with the
+// following exceptions:
+//  - Both input and output denormals are treated as/flushed to 0.
+//  - Only round-to-nearest mode is supported.
+//  - No exception flags are raised/reported.
+// In all other cases, results should be identical to other
+// conforming implementations (modulo exact fraction values in the NaN case).
+//
+// The quotient is computed by radix-2 restoring digit recurrence: each
+// iteration of the loop below produces one quotient bit with a compare and a
+// subtract, and the iterations only depend on each other through the partial
+// remainder. Once unrolled, the recurrence is a regular chain of
+// FRACTION_SZ + 3 small stages, which the scheduler can split across as many
+// pipeline stages as needed to accept a new operation every cycle.
+
+import apfloat
+import std
+
+type APFloat = apfloat::APFloat;
+
+// Determines if the given value is 0, taking into account
+// flushing subnormals.
+fn is_zero<EXP_SZ: u32, FRACTION_SZ: u32>(x: APFloat<EXP_SZ, FRACTION_SZ>) -> u1 {
+  x.bexp == uN[EXP_SZ]:0
+}
+
+// Usage:
+//  - EXP_SZ: The number of bits in the exponent.
+//  - FRACTION_SZ: The number of bits in the fractional part of the FP number.
+//  - x, y: The dividend and the divisor.
+//
+// Derived parametrics:
+//  - SIGNED_EXP: Exponent widened to hold the difference of two biased
+//    exponents plus the bias, with a sign bit.
+//  - QUOTIENT: Quotient width: the leading bit, FRACTION_SZ fraction bits and
+//    a guard bit, plus one extra bit as the quotient may be less than one.
+//  - REMAINDER: Width of the partial remainder, which is always less than
+//    twice the divisor significand. Also wide enough to hold the significand
+//    plus a carry from rounding.
+pub fn apfloat_div_2<
+    EXP_SZ: u32,
+    FRACTION_SZ: u32,
+    SIGNED_EXP: u32 = EXP_SZ + u32:2,
+    QUOTIENT: u32 = FRACTION_SZ + u32:3,
+    REMAINDER: u32 = FRACTION_SZ + u32:2>(
+    x: APFloat<EXP_SZ, FRACTION_SZ>, y: APFloat<EXP_SZ, FRACTION_SZ>) ->
+    APFloat<EXP_SZ, FRACTION_SZ> {
+  // 1. Get and expand significands. Zero and subnormal operands are handled
+  // with the special cases below, so the hidden bit is always set here.
+  let x_significand = (u1:1 ++ x.fraction) as uN[REMAINDER];
+  let y_significand = (u1:1 ++ y.fraction) as uN[REMAINDER];
+
+  // 2. Divide the significands, one quotient bit per iteration. Both are in
+  // [1, 2), so the quotient is in (0.5, 2) and its first bit has weight 2^0.
+  let (quotient, remainder) =
+      for (i, (quotient, remainder)): (u32, (uN[QUOTIENT], uN[REMAINDER]))
+          in range(u32:0, QUOTIENT) {
+    let bit = remainder >= y_significand;
+    let remainder = if bit { remainder - y_significand } else { remainder };
+    ((quotient << uN[QUOTIENT]:1) | (bit as uN[QUOTIENT]),
+     remainder << uN[REMAINDER]:1)
+  }((uN[QUOTIENT]:0, x_significand));
+
+  // 3. Normalize. If the quotient is less than one, shift it left one place
+  // so the leading 1 is the top bit; the bit shifted in is exact (zero).
+  let quotient_lt_one = !quotient[-1:];
+  let quotient =
+      if quotient_lt_one { quotient << uN[QUOTIENT]:1 } else { quotient };
+
+  // 4. Round - we use nearest, half to even rounding. A non-zero remainder
+  // means the exact quotient has more bits than we computed.
+  let sticky = quotient[0:1] | (remainder != uN[REMAINDER]:0);
+  let guard = quotient[1:2];
+  let significand = (quotient >> uN[QUOTIENT]:2) as uN[REMAINDER];
+  let do_round_up = guard & (sticky | significand[0:1]);
+  let significand =
+      if do_round_up { significand + uN[REMAINDER]:1 } else { significand };
+  // If rounding carried out of the significand, it is exactly 2.0: the
+  // fraction bits are all zero and the exponent goes up by one.
+  let round_overflow = significand[-1:];
+  let result_fraction = significand as uN[FRACTION_SZ];
+
+  // 5. Subtract non-biased exponents, i.e., (A - bias) - (B - bias) + bias.
+  let bias = std::mask_bits<EXP_SZ>() as sN[SIGNED_EXP] >> uN[SIGNED_EXP]:1;
+  let exp = (x.bexp as sN[SIGNED_EXP]) - (y.bexp as sN[SIGNED_EXP]) + bias -
+            (quotient_lt_one as sN[SIGNED_EXP]) +
+            (round_overflow as sN[SIGNED_EXP]);
+
+  // We're done - except for special cases...
+  let result_sign = x.sign != y.sign;
+
+  // 6. Special cases!
+  // - Subnormals: flush to 0.
+  let is_subnormal = exp <= sN[SIGNED_EXP]:0;
+  let result_exp = if is_subnormal { uN[EXP_SZ]:0 } else { exp as uN[EXP_SZ] };
+  let result_fraction =
+      if is_subnormal { uN[FRACTION_SZ]:0 } else { result_fraction };
+
+  // - Overflow infinites - saturate exp, clear fraction.
+  let high_exp = std::mask_bits<EXP_SZ>();
+  let is_overflow = exp >= (high_exp as sN[SIGNED_EXP]);
+  let result_exp = if is_overflow { high_exp } else { result_exp };
+  let result_fraction =
+      if is_overflow { uN[FRACTION_SZ]:0 } else { result_fraction };
+
+  // - 0 / y = 0 and x / inf = 0.
+  let is_result_zero = is_zero(x) ||
+      apfloat::is_inf<EXP_SZ, FRACTION_SZ>(y);
+  let result_exp = if is_result_zero { uN[EXP_SZ]:0 } else { result_exp };
+  let result_fraction =
+      if is_result_zero { uN[FRACTION_SZ]:0 } else { result_fraction };
+
+  // - inf / y = inf and x / 0 = inf.
+  let is_result_inf = apfloat::is_inf<EXP_SZ, FRACTION_SZ>(x) || is_zero(y);
+  let result_exp = if is_result_inf { high_exp } else { result_exp };
+  let result_fraction =
+      if is_result_inf { uN[FRACTION_SZ]:0 } else { result_fraction };
+
+  let result = APFloat<EXP_SZ, FRACTION_SZ>{
+      sign: result_sign, bexp: result_exp, fraction: result_fraction };
+
+  // - NaNs. NaN trumps infinities, so we handle it last.
+  //   0 / 0 = NaN and inf / inf = NaN.
+  let has_nan_arg = apfloat::is_nan<EXP_SZ, FRACTION_SZ>(x) ||
+      apfloat::is_nan<EXP_SZ, FRACTION_SZ>(y);
+  let is_result_nan = has_nan_arg || (is_zero(x) && is_zero(y)) ||
+      (apfloat::is_inf<EXP_SZ, FRACTION_SZ>(x) &&
+       apfloat::is_inf<EXP_SZ, FRACTION_SZ>(y));
+  if is_result_nan { apfloat::qnan<EXP_SZ, FRACTION_SZ>() } else { result }
+}
+
+#[test]
+fn apfloat_div_2_small_test() {
+  // 1.5 / 1.25 = 1.2, rounded to 1.25.
+  let x = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:7, fraction: u3:4 };
+  let y = APFloat<u32:4, u32:3> { sign: u1:1, bexp: u4:7, fraction: u3:2 };
+  let expected = APFloat<u32:4, u32:3> { sign: u1:1, bexp: u4:7, fraction: u3:2 };
+  let _ = assert_eq(apfloat_div_2(x, y), expected);
+
+  // 1.25 / 1.5 = 0.8333, rounded to 0.8125.
+  let expected = APFloat<u32:4, u32:3> { sign: u1:1, bexp: u4:6, fraction: u3:5 };
+  let _ = assert_eq(apfloat_div_2(y, x), expected);
+
+  // Largest / smallest normal overflows to infinity.
+  let max = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:14, fraction: u3:7 };
+  let min = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:1, fraction: u3:0 };
+  let _ = assert_eq(apfloat_div_2(max, min), apfloat::inf<u32:4, u32:3>(u1:0));
+  // Smallest / largest normal flushes to zero.
+  let _ = assert_eq(apfloat_div_2(min, max), apfloat::zero<u32:4, u32:3>(u1:0));
+  ()
+}
@@ -0,0 +1,142 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file implements [most of] IEEE 754 floating point square root, with the
+// following exceptions:
+//  - Input denormals are treated as/flushed to 0 (sqrt of a normal number is
+//    never subnormal).
+//  - Only round-to-nearest mode is supported.
+//  - No exception flags are raised/reported.
+// In all other cases, results should be identical to other
+// conforming implementations (modulo exact fraction values in the NaN case).
+//
+// The root is computed by radix-2 restoring digit recurrence, one root bit
+// per loop iteration, so (as with apfloat_div_2) the unrolled loop is a
+// regular chain of small stages which pipelines to full throughput.
+
+import apfloat
+import std
+
+type APFloat = apfloat::APFloat;
+
+// Usage:
+//  - EXP_SZ: The number of bits in the exponent.
+//  - FRACTION_SZ: The number of bits in the fractional part of the FP number.
+//  - x: The floating-point number whose square root to compute.
+//
+// Derived parametrics:
+//  - SIGNED_EXP: EXP_SZ plus one sign bit, to hold the unbiased exponent.
+//  - ROOT: Root width: the leading bit, FRACTION_SZ fraction bits and a guard
+//    bit.
+//  - RADICAND: Width of the integer whose root is taken: twice the root width,
+//    so the root of the integer is the significand root scaled by 2^(ROOT-1).
+pub fn apfloat_sqrt<
+    EXP_SZ: u32,
+    FRACTION_SZ: u32,
+    SIGNED_EXP: u32 = EXP_SZ + u32:1,
+    ROOT: u32 = FRACTION_SZ + u32:2,
+    RADICAND: u32 = FRACTION_SZ * u32:2 + u32:4>(
+    x: APFloat<EXP_SZ, FRACTION_SZ>) -> APFloat<EXP_SZ, FRACTION_SZ> {
+  // 1. Remove the bias. If the exponent is odd, double the significand so the
+  // exponent becomes even and can be halved exactly. The bias is odd, so the
+  // unbiased exponent is odd exactly when the biased exponent is even.
+  let bias = std::mask_bits<EXP_SZ>() as sN[SIGNED_EXP] >> uN[SIGNED_EXP]:1;
+  let exp = (x.bexp as sN[SIGNED_EXP]) - bias;
+  let exp_is_odd = !(x.bexp[0:1]);
+  let significand = (u1:1 ++ x.fraction) as uN[RADICAND];
+  let significand =
+      if exp_is_odd { significand << uN[RADICAND]:1 } else { significand };
+
+  // 2. Take the integer square root of the significand, which is in [1, 4),
+  // scaled so its root has ROOT bits, one root bit per iteration.
+  let radicand = significand << (ROOT as uN[RADICAND]);
+  let (root, remainder) =
+      for (i, (root, remainder)): (u32, (uN[ROOT], uN[RADICAND]))
+          in range(u32:0, ROOT) {
+    // Bring down the next two bits of the radicand.
+    let shift = (ROOT - u32:1 - i) * u32:2;
+    let digits = (radicand >> (shift as uN[RADICAND])) & uN[RADICAND]:3;
+    let remainder = (remainder << uN[RADICAND]:2) | digits;
+    let trial = ((root as uN[RADICAND]) << uN[RADICAND]:2) | uN[RADICAND]:1;
+    let bit = remainder >= trial;
+    let remainder = if bit { remainder - trial } else { remainder };
+    ((root << uN[ROOT]:1) | (bit as uN[ROOT]), remainder)
+  }((uN[ROOT]:0, uN[RADICAND]:0));
+
+  // 3. Round - we use nearest, half to even rounding. The root is in [1, 2)
+  // so it is already normalized. A non-zero remainder means the exact root
+  // has more bits than we computed.
+  let sticky = remainder != uN[RADICAND]:0;
+  let guard = root[0:1];
+  let significand = root >> uN[ROOT]:1;
+  let do_round_up = guard & (sticky | significand[0:1]);
+  let significand =
+      if do_round_up { significand + uN[ROOT]:1 } else { significand };
+  // If rounding carried out of the significand, it is exactly 2.0.
+  let round_overflow = significand[-1:];
+  let result_fraction = significand as uN[FRACTION_SZ];
+
+  // 4. Halve the (even) exponent and restore the bias. The result exponent is
+  // always in the normal range.
+  let exp = (exp >> uN[SIGNED_EXP]:1) + bias +
+            (round_overflow as sN[SIGNED_EXP]);
+  let result = APFloat<EXP_SZ, FRACTION_SZ>{
+      sign: u1:0, bexp: exp as uN[EXP_SZ], fraction: result_fraction };
+
+  // 5. Special cases!
+  // - sqrt(x < 0) = NaN, including -inf.
+  let result = if x.sign { apfloat::qnan<EXP_SZ, FRACTION_SZ>() } else { result };
+  // - sqrt(inf) = inf.
+  let result = if apfloat::is_inf<EXP_SZ, FRACTION_SZ>(x) && !x.sign {
+    x
+  } else {
+    result
+  };
+  // - sqrt(0) = 0 and sqrt(-0) = -0; subnormals are flushed to 0.
+  let result = if apfloat::is_zero_or_subnormal<EXP_SZ, FRACTION_SZ>(x) {
+    apfloat::zero<EXP_SZ, FRACTION_SZ>(x.sign)
+  } else {
+    result
+  };
+  // - sqrt(NaN) = NaN.
+  if apfloat::is_nan<EXP_SZ, FRACTION_SZ>(x) {
+    apfloat::qnan<EXP_SZ, FRACTION_SZ>()
+  } else {
+    result
+  }
+}
+
+#[test]
+fn apfloat_sqrt_small_test() {
+  // sqrt(2.25) = 1.5.
+  let x = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:8, fraction: u3:1 };
+  let expected = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:7, fraction: u3:4 };
+  let _ = assert_eq(apfloat_sqrt(x), expected);
+
+  // sqrt(2) = 1.414, rounded to 1.375.
+  let x = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:8, fraction: u3:0 };
+  let expected = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:7, fraction: u3:3 };
+  let _ = assert_eq(apfloat_sqrt(x), expected);
+
+  // sqrt(0.5) = 0.707, rounded to 0.6875.
+  let x = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:6, fraction: u3:0 };
+  let expected = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:6, fraction: u3:3 };
+  let _ = assert_eq(apfloat_sqrt(x), expected);
+
+  // The largest value just below 4 rounds up to 2.
+  let x = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:8, fraction: u3:7 };
+  let expected = APFloat<u32:4, u32:3> { sign: u1:0, bexp: u4:8, fraction: u3:0 };
+  let _ = assert_eq(apfloat_sqrt(x), expected);
+  ()
+}
@@ -0,0 +1,61 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file implements [most of] IEEE 754 single-precision
+// floating point division, with the following exceptions:
+//  - Both input and output denormals are treated as/flushed to 0.
+//  - Only round-to-nearest mode is supported.
+//  - No exception flags are raised/reported.
+// In all other cases, results should be identical to other
+// conforming implementations (modulo exact fraction values in the NaN case).
+import float32
+import xls.modules.fp.apfloat_div_2
+
+type F32 = float32::F32;
+
+pub fn fp32_div_2(x: F32, y: F32) -> F32 {
+  apfloat_div_2::apfloat_div_2<u32:8, u32:23>(x, y)
+}
+
+#[test]
+fn fp32_div_2_test() {
+  let one = float32::one(u1:0);
+  let three = float32::unflatten(u32:0x40400000);
+  let six = float32::unflatten(u32:0x40c00000);
+  let two = float32::unflatten(u32:0x40000000);
+  let _ = assert_eq(fp32_div_2(six, three), two);
+  let _ = assert_eq(fp32_div_2(one, one), one);
+  let _ = assert_eq(fp32_div_2(one, three), float32::unflatten(u32:0x3eaaaaab));
+  let _ = assert_eq(fp32_div_2(float32::one(u1:1), three),
+                    float32::unflatten(u32:0xbeaaaaab));
+
+  // Special cases.
+  let _ = assert_eq(fp32_div_2(one, float32::zero(u1:1)), float32::inf(u1:1));
+  let _ = assert_eq(fp32_div_2(float32::zero(u1:0), one), float32::zero(u1:0));
+  let _ = assert_eq(fp32_div_2(one, float32::inf(u1:0)), float32::zero(u1:0));
+  let _ = assert_eq(fp32_div_2(float32::inf(u1:0), three), float32::inf(u1:0));
+  let _ = assert_eq(fp32_div_2(float32::zero(u1:0), float32::zero(u1:0)),
+                    float32::qnan());
+  let _ = assert_eq(fp32_div_2(float32::inf(u1:0), float32::inf(u1:1)),
+                    float32::qnan());
+  let _ = assert_eq(fp32_div_2(float32::qnan(), one), float32::qnan());
+  let _ = assert_eq(fp32_div_2(one, float32::qnan()), float32::qnan());
+
+  // Overflow and underflow.
+  let max = float32::unflatten(u32:0x7f7fffff);
+  let min = float32::unflatten(u32:0x00800000);
+  let _ = assert_eq(fp32_div_2(max, min), float32::inf(u1:0));
+  let _ = assert_eq(fp32_div_2(min, max), float32::zero(u1:0));
+  ()
+}
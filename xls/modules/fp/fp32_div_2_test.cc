@@ -0,0 +1,115 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Random-sampling test for the DSLX 2x32 floating-point divider.
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/modules/fp/fp32_div_2_jit_wrapper.h"
+#include "xls/tools/testbench.h"
+#include "xls/tools/testbench_builder.h"
+
+ABSL_FLAG(int, num_threads, 0,
+          "Number of threads to use. Set to 0 to use all.");
+ABSL_FLAG(int64_t, num_samples, 1024 * 1024,
+          "Number of random samples to test.");
+
+namespace xls {
+
+using Float2x32 = std::tuple<float, float>;
+
+// Generates a pair of floats with uniformly random bit patterns. Half of the
+// samples draw both exponents from a narrow range, so that most of their
+// quotients are normal rather than overflowing or flushing to zero.
+Float2x32 IndexToInput(uint64_t index) {
+  thread_local absl::BitGen bitgen;
+  uint32_t a = absl::Uniform<uint32_t>(bitgen);
+  uint32_t b = absl::Uniform<uint32_t>(bitgen);
+  if (index % 2 == 0) {
+    constexpr uint32_t kExpMask = 0x7f800000;
+    a = (a & ~kExpMask) | (absl::Uniform<uint32_t>(bitgen, 96, 160) << 23);
+    b = (b & ~kExpMask) | (absl::Uniform<uint32_t>(bitgen, 96, 160) << 23);
+  }
+  return Float2x32(absl::bit_cast<float>(a), absl::bit_cast<float>(b));
+}
+
+// The DSLX implementation uses the "round to nearest (half to even)"
+// rounding mode, which is the default on most systems, hence we don't need
+// to call fesetround().
+// The DSLX implementation also flushes input subnormals to 0, so we do that
+// here as well.
+float ComputeExpected(fp::Fp32Div2* jit_wrapper, Float2x32 input) {
+  float x = FlushSubnormal(std::get<0>(input));
+  float y = FlushSubnormal(std::get<1>(input));
+  return x / y;
+}
+
+// Computes FP division via DSLX & the JIT.
+float ComputeActual(fp::Fp32Div2* jit_wrapper, Float2x32 input) {
+  return jit_wrapper->Run(std::get<0>(input), std::get<1>(input)).value();
+}
+
+// Compares expected vs. actual results, taking into account two special cases.
+bool CompareResults(float a, float b) {
+  // DSLX flushes subnormal outputs, while regular FP division does not, so
+  // just check for that here. A quotient just below the smallest normal may
+  // also round up to it when rounded at subnormal precision, while DSLX
+  // flushes it.
+  return a == b || (std::isnan(a) && std::isnan(b)) ||
+         (std::fabs(a) <= std::numeric_limits<float>::min() &&
+          std::fabs(b) <= std::numeric_limits<float>::min());
+}
+
+void LogMismatch(uint64_t index, Float2x32 input, float expected,
+                 float actual) {
+  XLS_LOG(ERROR) << absl::StrFormat(
+      "Value mismatch at index %d, input 0x%08x / 0x%08x:\n"
+      "  Expected: 0x%08x\n"
+      "  Actual  : 0x%08x",
+      index, absl::bit_cast<uint32_t>(std::get<0>(input)),
+      absl::bit_cast<uint32_t>(std::get<1>(input)),
+      absl::bit_cast<uint32_t>(expected), absl::bit_cast<uint32_t>(actual));
+}
+
+absl::Status RealMain(uint64_t num_samples, int num_threads) {
+  TestbenchBuilder<Float2x32, float, fp::Fp32Div2> builder(
+      ComputeExpected, ComputeActual,
+      []() { return fp::Fp32Div2::Create().value(); });
+  builder.SetIndexToInputFn(IndexToInput)
+      .SetCompareResultsFn(CompareResults)
+      .SetLogErrorsFn(LogMismatch)
+      .SetNumSamples(num_samples);
+  if (num_threads != 0) {
+    builder.SetNumThreads(num_threads);
+  }
+  return builder.Build().Run();
+}
+
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  xls::InitXls(argv[0], argc, argv);
+  XLS_QCHECK_OK(xls::RealMain(absl::GetFlag(FLAGS_num_samples),
+                              absl::GetFlag(FLAGS_num_threads)));
+  return 0;
+}
@@ -0,0 +1,53 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file implements [most of] IEEE 754 single-precision
+// floating point square root, with the following exceptions:
+//  - Input denormals are treated as/flushed to 0.
+//  - Only round-to-nearest mode is supported.
+//  - No exception flags are raised/reported.
+// In all other cases, results should be identical to other
+// conforming implementations (modulo exact fraction values in the NaN case).
+import float32
+import xls.modules.fp.apfloat_sqrt
+
+type F32 = float32::F32;
+
+pub fn fp32_sqrt(x: F32) -> F32 {
+  apfloat_sqrt::apfloat_sqrt<u32:8, u32:23>(x)
+}
+
+#[test]
+fn fp32_sqrt_test() {
+  let one = float32::one(u1:0);
+  let two = float32::unflatten(u32:0x40000000);
+  let four = float32::unflatten(u32:0x40800000);
+  let _ = assert_eq(fp32_sqrt(one), one);
+  let _ = assert_eq(fp32_sqrt(four), two);
+  let _ = assert_eq(fp32_sqrt(two), float32::unflatten(u32:0x3fb504f3));
+  // sqrt(0.25) = 0.5.
+  let _ = assert_eq(fp32_sqrt(float32::unflatten(u32:0x3e800000)),
+                    float32::unflatten(u32:0x3f000000));
+
+  // Special cases.
+  let _ = assert_eq(fp32_sqrt(float32::zero(u1:0)), float32::zero(u1:0));
+  let _ = assert_eq(fp32_sqrt(float32::zero(u1:1)), float32::zero(u1:1));
+  let _ = assert_eq(fp32_sqrt(float32::inf(u1:0)), float32::inf(u1:0));
+  let _ = assert_eq(fp32_sqrt(float32::inf(u1:1)), float32::qnan());
+  let _ = assert_eq(fp32_sqrt(float32::one(u1:1)), float32::qnan());
+  let _ = assert_eq(fp32_sqrt(float32::qnan()), float32::qnan());
+  let neg_denormal = F32{sign: u1:1, bexp: u8:0, fraction: u23:99};
+  let _ = assert_eq(fp32_sqrt(neg_denormal), float32::zero(u1:1));
+  ()
+}
@@ -0,0 +1,107 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Test for the DSLX 32-bit floating-point square root. By default, a random
+// sample of inputs is tested; with --exhaustive, all 2^32 inputs are.
+#include <cmath>
+#include <cstdint>
+
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/modules/fp/fp32_sqrt_jit_wrapper.h"
+#include "xls/tools/testbench.h"
+#include "xls/tools/testbench_builder.h"
+
+ABSL_FLAG(int, num_threads, 0,
+          "Number of threads to use. Set to 0 to use all.");
+ABSL_FLAG(int64_t, num_samples, 1024 * 1024,
+          "Number of random samples to test. Ignored if --exhaustive is set.");
+ABSL_FLAG(bool, exhaustive, false,
+          "If true, test every 32-bit input rather than random samples.");
+
+namespace xls {
+
+// Generates a float with a uniformly random bit pattern.
+float IndexToRandomInput(uint64_t index) {
+  thread_local absl::BitGen bitgen;
+  return absl::bit_cast<float>(absl::Uniform<uint32_t>(bitgen));
+}
+
+// Generates the float whose bit pattern is the sample index.
+float IndexToExhaustiveInput(uint64_t index) {
+  return absl::bit_cast<float>(static_cast<uint32_t>(index));
+}
+
+// The DSLX implementation uses the "round to nearest (half to even)"
+// rounding mode, which is the default on most systems, hence we don't need
+// to call fesetround().
+// The DSLX implementation also flushes input subnormals to 0, so we do that
+// here as well.
+float ComputeExpected(fp::Fp32Sqrt* jit_wrapper, float input) {
+  return sqrtf(FlushSubnormal(input));
+}
+
+// Computes FP sqrt via DSLX & the JIT.
+float ComputeActual(fp::Fp32Sqrt* jit_wrapper, float input) {
+  return jit_wrapper->Run(input).value();
+}
+
+// The square root of a normal number is always normal, so no subnormal
+// special cases are needed: results must match exactly (or both be NaN).
+bool CompareResults(float a, float b) {
+  return absl::bit_cast<uint32_t>(a) == absl::bit_cast<uint32_t>(b) ||
+         (std::isnan(a) && std::isnan(b));
+}
+
+void LogMismatch(uint64_t index, float input, float expected, float actual) {
+  XLS_LOG(ERROR) << absl::StrFormat(
+      "Value mismatch at index %d, input 0x%08x:\n"
+      "  Expected: 0x%08x\n"
+      "  Actual  : 0x%08x",
+      index, absl::bit_cast<uint32_t>(input),
+      absl::bit_cast<uint32_t>(expected), absl::bit_cast<uint32_t>(actual));
+}
+
+absl::Status RealMain(uint64_t num_samples, bool exhaustive, int num_threads) {
+  TestbenchBuilder<float, float, fp::Fp32Sqrt> builder(
+      ComputeExpected, ComputeActual,
+      []() { return fp::Fp32Sqrt::Create().value(); });
+  builder.SetCompareResultsFn(CompareResults).SetLogErrorsFn(LogMismatch);
+  if (exhaustive) {
+    builder.SetIndexToInputFn(IndexToExhaustiveInput)
+        .SetNumSamples(int64_t{1} << 32);
+  } else {
+    builder.SetIndexToInputFn(IndexToRandomInput).SetNumSamples(num_samples);
+  }
+  if (num_threads != 0) {
+    builder.SetNumThreads(num_threads);
+  }
+  return builder.Build().Run();
+}
+
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  xls::InitXls(argv[0], argc, argv);
+  XLS_QCHECK_OK(xls::RealMain(absl::GetFlag(FLAGS_num_samples),
+                              absl::GetFlag(FLAGS_exhaustive),
+                              absl::GetFlag(FLAGS_num_threads)));
+  return 0;
+}
@@ -15,8 +15,12 @@
 #ifndef XLS_NETLIST_CELL_LIBRARY_H_
 #define XLS_NETLIST_CELL_LIBRARY_H_
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -242,6 +246,22 @@ class AbstractCellLibrary {
   absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*> GetEntry(
       std::string_view name) const;
 
+  // Creates the entry with the given name, or returns a NOT_FOUND status if
+  // there is no such cell.
+  using EntryLoader =
+      std::function<absl::StatusOr<AbstractCellLibraryEntry<EvalT>>(
+          std::string_view name)>;
+
+  // Sets a loader for entries which have not been added to the library. This
+  // allows only the cells actually referenced (e.g., by a netlist) to be
+  // extracted from a large library; see GetOrLoadEntry().
+  void SetEntryLoader(EntryLoader loader) { entry_loader_ = std::move(loader); }
+
+  // As GetEntry(), but if the library has no entry with the given name and an
+  // entry loader is set, the entry is loaded with it and added to the library.
+  absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*> GetOrLoadEntry(
+      std::string_view name);
+
   absl::Status AddEntry(AbstractCellLibraryEntry<EvalT> entry);
 
   absl::StatusOr<CellLibraryProto> ToProto() const;
@@ -250,6 +270,7 @@ class AbstractCellLibrary {
   absl::flat_hash_map<std::string,
                       std::unique_ptr<AbstractCellLibraryEntry<EvalT>>>
       entries_;
+  EntryLoader entry_loader_;
 };
 
 using CellLibrary = AbstractCellLibrary<>;
@@ -605,6 +626,20 @@ AbstractCellLibrary<EvalT>::GetEntry(std::string_view name) const {
   return it->second.get();
 }
 
+template <typename EvalT>
+absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*>
+AbstractCellLibrary<EvalT>::GetOrLoadEntry(std::string_view name) {
+  auto it = entries_.find(name);
+  if (it != entries_.end() || entry_loader_ == nullptr) {
+    return GetEntry(name);
+  }
+  XLS_ASSIGN_OR_RETURN(AbstractCellLibraryEntry<EvalT> entry,
+                       entry_loader_(name));
+  XLS_RET_CHECK_EQ(entry.name(), name);
+  XLS_RETURN_IF_ERROR(AddEntry(std::move(entry)));
+  return GetEntry(name);
+}
+
 }  // namespace netlist
 }  // namespace xls
 
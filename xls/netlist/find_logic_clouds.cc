@@ -14,10 +14,22 @@
 
 #include "xls/netlist/find_logic_clouds.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/common/logging/logging.h"
-#include "xls/data_structures/union_find.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 
 namespace xls {
 namespace netlist {
@@ -39,84 +51,160 @@ void Cluster::SortCells() {
   std::sort(other_cells_.begin(), other_cells_.end(), cell_name_lt);
 }
 
-std::vector<Cluster> FindLogicClouds(const Module& module,
-                                     bool include_vacuous) {
-  UnionFind<Cell*> cell_to_uf;
+namespace {
 
-  // Gets-or-adds the given cell to the UnionFind.
-  auto get_uf = [&cell_to_uf](Cell* c) -> Cell* {
-    cell_to_uf.Insert(c);
-    return cell_to_uf.Find(c);
+// Sorts the clusters for a deterministic order. For convenience (for now) we
+// convert the cell names to a string and rely on string comparison.
+void SortClusters(std::vector<Cluster>* clusters) {
+  auto cells_to_str = [](absl::Span<const Cell* const> cells) {
+    return absl::StrJoin(cells, ", ", [](std::string* out, const Cell* cell) {
+      absl::StrAppend(out, cell->name());
+    });
   };
-
-  // Helper for debugging that counts the number of equivalence classes in
-  // cell_to_uf.
-  auto count_equivalence_classes = [&cell_to_uf]() -> int64_t {
-    return cell_to_uf.GetRepresentatives().size();
+  auto cluster_sort_lt = [cells_to_str](const Cluster& a, const Cluster& b) {
+    return std::make_pair(cells_to_str(a.terminating_flops()),
+                          cells_to_str(a.other_cells())) <
+           std::make_pair(cells_to_str(b.terminating_flops()),
+                          cells_to_str(b.other_cells()));
   };
+  std::sort(clusters->begin(), clusters->end(), cluster_sort_lt);
+}
 
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    XLS_VLOG(4) << "Considering cell: " << cell->name();
-
-    // Flop output connectivity is excluded from the equivalence class, so we
-    // get partitions along flop (output) boundaries.
-    if (cell->kind() == CellKind::kFlop) {
-      // For flops we just make sure an equivalence class is present in the
-      // map, in case it doesn't have any cells on the input side.
-      get_uf(cell);
-      XLS_VLOG(4) << "--- Now " << count_equivalence_classes()
-                  << " equivalence classes for " << cell_to_uf.size()
-                  << " cells.";
-      continue;
+// Union-find over cell indices which may be updated from several threads at
+// once. Roots are always linked towards the smaller index, so concurrent
+// unions cannot form a cycle, and a link only succeeds (via compare-exchange)
+// if its source is still a root.
+class ConcurrentUnionFind {
+ public:
+  explicit ConcurrentUnionFind(int64_t size) : parents_(size) {
+    for (int64_t i = 0; i < size; ++i) {
+      parents_[i].store(i, std::memory_order_relaxed);
     }
+  }
 
-    for (auto& input : cell->inputs()) {
-      XLS_VLOG(4) << "- Considering input net: " << input.netref->name();
-      for (Cell* connected : input.netref->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
-        if (connected->kind() == CellKind::kFlop) {
+  int64_t Find(int64_t x) {
+    while (true) {
+      int64_t parent = parents_[x].load(std::memory_order_acquire);
+      if (parent == x) {
+        return x;
+      }
+      // Path halving: point x at its grandparent. Losing the race is harmless,
+      // the link is only ever moved closer to the root.
+      int64_t grandparent = parents_[parent].load(std::memory_order_acquire);
+      parents_[x].compare_exchange_weak(parent, grandparent,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed);
+      x = grandparent;
+    }
+  }
+
+  void Union(int64_t a, int64_t b) {
+    while (true) {
+      a = Find(a);
+      b = Find(b);
+      if (a == b) {
+        return;
+      }
+      if (a < b) {
+        std::swap(a, b);
+      }
+      int64_t expected = a;
+      if (parents_[a].compare_exchange_strong(expected, b,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+ private:
+  std::vector<std::atomic<int64_t>> parents_;
+};
+
+}  // namespace
+
+std::vector<Cluster> FindLogicClouds(const Module& module, bool include_vacuous,
+                                     int64_t thread_count) {
+  absl::Span<const std::unique_ptr<Cell>> cells = module.cells();
+  absl::flat_hash_map<const Cell*, int64_t> cell_to_index;
+  cell_to_index.reserve(cells.size());
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    cell_to_index[cells[i].get()] = i;
+  }
+  ConcurrentUnionFind cell_to_uf(cells.size());
+
+  // Merges the equivalence classes of the cells in [begin, end) with those of
+  // the cells they are connected to.
+  auto merge_cells = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      Cell* cell = cells[i].get();
+      XLS_VLOG(4) << "Considering cell: " << cell->name();
+
+      // Flop output connectivity is excluded from the equivalence class, so we
+      // get partitions along flop (output) boundaries. A flop which has no
+      // cells on its input side remains in its own equivalence class.
+      if (cell->kind() == CellKind::kFlop) {
+        continue;
+      }
+
+      for (auto& input : cell->inputs()) {
+        XLS_VLOG(4) << "- Considering input net: " << input.netref->name();
+        for (Cell* connected : input.netref->connected_cells()) {
+          if (cell == connected) {
+            continue;
+          }
+          if (connected->kind() == CellKind::kFlop) {
+            XLS_VLOG(4) << absl::StreamFormat(
+                "-- Cell is connected to flop cell %s on an input pin; not "
+                "merging equivalence classes.",
+                connected->name());
+            continue;
+          }
           XLS_VLOG(4) << absl::StreamFormat(
-              "-- Cell is connected to flop cell %s on an input pin; not "
-              "merging equivalence classes.",
+              "-- Cell %s is connected to cell %s", cell->name(),
               connected->name());
-          continue;
+          cell_to_uf.Union(i, cell_to_index.at(connected));
         }
-        XLS_VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                          cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        XLS_VLOG(4) << "--- Now " << count_equivalence_classes()
-                    << " equivalence classes for " << cell_to_uf.size()
-                    << " cells.";
       }
-    }
 
-    for (const auto& iter : cell->outputs()) {
-      NetRef output = iter.netref;
-      XLS_VLOG(4) << "- Considering output net: " << output->name();
-      for (Cell* connected : output->connected_cells()) {
-        if (cell == connected) {
-          continue;
+      for (const auto& iter : cell->outputs()) {
+        NetRef output = iter.netref;
+        XLS_VLOG(4) << "- Considering output net: " << output->name();
+        for (Cell* connected : output->connected_cells()) {
+          if (cell == connected) {
+            continue;
+          }
+          XLS_VLOG(4) << absl::StreamFormat(
+              "-- Cell %s is connected to cell %s", cell->name(),
+              connected->name());
+          cell_to_uf.Union(i, cell_to_index.at(connected));
         }
-        XLS_VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                          cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        XLS_VLOG(4) << "--- Now " << count_equivalence_classes()
-                    << " equivalence classes for " << cell_to_uf.size()
-                    << " cells.";
       }
     }
+  };
+
+  const int64_t cell_count = cells.size();
+  thread_count = std::max<int64_t>(1, std::min(thread_count, cell_count));
+  std::vector<std::unique_ptr<xls::Thread>> threads;
+  for (int64_t t = 1; t < thread_count; ++t) {
+    threads.push_back(std::make_unique<xls::Thread>([&, t]() {
+      merge_cells(cell_count * t / thread_count,
+                  cell_count * (t + 1) / thread_count);
+    }));
+  }
+  merge_cells(0, cell_count / thread_count);
+  for (std::unique_ptr<xls::Thread>& thread : threads) {
+    thread->Join();
   }
 
   // Run through the cells and put them into clusters according to their
   // equivalence classes.
-  absl::flat_hash_map<Cell*, Cluster> equivalence_set_to_cluster;
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    equivalence_set_to_cluster[get_uf(cell)].Add(cell);
+  absl::flat_hash_map<int64_t, Cluster> equivalence_set_to_cluster;
+  for (int64_t i = 0; i < cell_count; ++i) {
+    equivalence_set_to_cluster[cell_to_uf.Find(i)].Add(cells[i].get());
   }
+  XLS_VLOG(3) << equivalence_set_to_cluster.size()
+              << " equivalence classes for " << cell_count << " cells.";
 
   // Put them into a vector and sort each cluster's internal cells for
   // determinism.
@@ -131,21 +219,54 @@ std::vector<Cluster> FindLogicClouds(const Module& module,
     cluster.SortCells();
     clusters.push_back(std::move(cluster));
   }
+  SortClusters(&clusters);
+  return clusters;
+}
 
-  // For convenience (for now) we convert the cell names to a string and rely on
-  // string comparison for deterministic order.
-  auto cells_to_str = [](absl::Span<const Cell* const> cells) {
-    return absl::StrJoin(cells, ", ", [](std::string* out, const Cell* cell) {
-      absl::StrAppend(out, cell->name());
-    });
-  };
-  auto cluster_sort_lt = [cells_to_str](const Cluster& a, const Cluster& b) {
-    return std::make_pair(cells_to_str(a.terminating_flops()),
-                          cells_to_str(a.other_cells())) <
-           std::make_pair(cells_to_str(b.terminating_flops()),
-                          cells_to_str(b.other_cells()));
-  };
-  std::sort(clusters.begin(), clusters.end(), cluster_sort_lt);
+LogicCloudsProto ClustersToProto(const Module& module,
+                                 absl::Span<const Cluster> clusters) {
+  LogicCloudsProto proto;
+  proto.set_module_name(module.name());
+  for (const Cluster& cluster : clusters) {
+    LogicCloudProto* cloud = proto.add_clouds();
+    for (const Cell* cell : cluster.terminating_flops()) {
+      cloud->add_terminating_flops(cell->name());
+    }
+    for (const Cell* cell : cluster.other_cells()) {
+      cloud->add_other_cells(cell->name());
+    }
+  }
+  return proto;
+}
+
+absl::StatusOr<std::vector<Cluster>> ClustersFromProto(
+    const Module& module, const LogicCloudsProto& proto) {
+  if (proto.module_name() != module.name()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Logic clouds were computed for module %s, not %s.",
+        proto.module_name(), module.name()));
+  }
+  std::vector<Cluster> clusters;
+  clusters.reserve(proto.clouds_size());
+  for (const LogicCloudProto& cloud : proto.clouds()) {
+    Cluster& cluster = clusters.emplace_back();
+    for (const std::string& name : cloud.terminating_flops()) {
+      XLS_ASSIGN_OR_RETURN(Cell * cell, module.ResolveCell(name));
+      if (cell->kind() != CellKind::kFlop) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Terminating flop %s is not a flop.", cell->name()));
+      }
+      cluster.Add(cell);
+    }
+    for (const std::string& name : cloud.other_cells()) {
+      XLS_ASSIGN_OR_RETURN(Cell * cell, module.ResolveCell(name));
+      if (cell->kind() == CellKind::kFlop) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Logic cell %s is a flop.", cell->name()));
+      }
+      cluster.Add(cell);
+    }
+  }
   return clusters;
 }
 
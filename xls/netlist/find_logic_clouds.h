@@ -15,9 +15,14 @@
 #ifndef XLS_NETLIST_FIND_LOGIC_CLOUDS_H_
 #define XLS_NETLIST_FIND_LOGIC_CLOUDS_H_
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist.pb.h"
 
 namespace xls {
 namespace netlist {
@@ -51,8 +56,23 @@ class Cluster {
 // include_vacuous indicates whether a terminating flop with no connected logic
 // (e.g. a layer of flops that flop input to the module) should be considered to
 // be a cluster, or just discarded.
+//
+// The connected components are computed with a lock-free union-find over cell
+// indices; thread_count threads each merge the connections of a contiguous
+// range of cells.
 std::vector<Cluster> FindLogicClouds(const Module& module,
-                                     bool include_vacuous = false);
+                                     bool include_vacuous = false,
+                                     int64_t thread_count = 1);
+
+// Serializes the clusters found in 'module' (by cell name), so that they can
+// be reused across analyses without recomputing them.
+LogicCloudsProto ClustersToProto(const Module& module,
+                                 absl::Span<const Cluster> clusters);
+
+// The inverse of ClustersToProto: resolves the cells of the serialized
+// clusters in 'module', which must be the module they were computed for.
+absl::StatusOr<std::vector<Cluster>> ClustersFromProto(
+    const Module& module, const LogicCloudsProto& proto);
 
 // Converts the clusters to a string suitable for debugging/testing.
 std::string ClustersToString(absl::Span<const Cluster> clusters);
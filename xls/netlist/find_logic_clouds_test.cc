@@ -14,7 +14,10 @@
 
 #include "xls/netlist/find_logic_clouds.h"
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -28,6 +31,10 @@ namespace netlist {
 namespace rtl {
 namespace {
 
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
 TEST(ClusterTest, TwoSimpleClusters) {
   std::string netlist = R"(module main(clk, ai, ao);
   input clk;
@@ -131,6 +138,67 @@ cluster {
             ClustersToString(clusters));
 }
 
+constexpr char kMergeCloudNetlist[] = R"(module main(clk, a0, b0, ao, bo);
+  input clk;
+  input a0, b0;
+  output ao, bo;
+  wire a1, a1n, ab1, b1;
+
+  DFF dff_a0_a1(.D(a0), .Q(a1), .CLK(clk));
+  INV inv_a1_a1n(.A(a1), .ZN(a1n));
+  DFF dff_a1n_ao(.D(a1n), .Q(ao), .CLK(clk));
+
+  DFF dff_b0_b1(.D(b0), .Q(b1), .CLK(clk));
+  AND and_a1_b1(.A(a1), .B(b1), .Z(ab1));
+  DFF dff_ab1_bo(.D(ab1), .Q(bo), .CLK(clk));
+endmodule)";
+
+TEST(ClusterTest, ThreadCountDoesNotChangeClusters) {
+  Scanner scanner(kMergeCloudNetlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  std::string expected =
+      ClustersToString(FindLogicClouds(*m, /*include_vacuous=*/true));
+  for (int64_t thread_count : {2, 3, 6, 100}) {
+    EXPECT_EQ(ClustersToString(FindLogicClouds(*m, /*include_vacuous=*/true,
+                                               thread_count)),
+              expected)
+        << "thread_count: " << thread_count;
+  }
+}
+
+TEST(ClusterTest, ProtoRoundTrip) {
+  Scanner scanner(kMergeCloudNetlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  std::vector<Cluster> clusters = FindLogicClouds(*m);
+
+  LogicCloudsProto proto = ClustersToProto(*m, clusters);
+  EXPECT_EQ(proto.module_name(), "main");
+  ASSERT_EQ(proto.clouds_size(), 1);
+  EXPECT_THAT(proto.clouds(0).terminating_flops(),
+              ElementsAre("dff_a1n_ao", "dff_ab1_bo"));
+  EXPECT_THAT(proto.clouds(0).other_cells(),
+              ElementsAre("and_a1_b1", "inv_a1_a1n"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Cluster> restored,
+                           ClustersFromProto(*m, proto));
+  EXPECT_EQ(ClustersToString(restored), ClustersToString(clusters));
+
+  proto.set_module_name("other");
+  EXPECT_THAT(ClustersFromProto(*m, proto),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  proto.set_module_name("main");
+  proto.mutable_clouds(0)->add_other_cells("dff_a0_a1");
+  EXPECT_THAT(ClustersFromProto(*m, proto),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("is a flop")));
+}
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
@@ -14,12 +14,26 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <unistd.h>
+
+#include <optional>
+#include <string>
+#include <system_error>  // NOLINT
+#include <utility>
+
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "absl/types/variant.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -37,10 +51,15 @@ constexpr const char kNextStateKey[] = "next_state";
 constexpr const char kStateFunctionKey[] = "state_function";
 constexpr const char kInputValue[] = "input";
 constexpr const char kOutputValue[] = "output";
+constexpr const char kCellKind[] = "cell";
 constexpr const char kPinKind[] = "pin";
 constexpr const char kFfKind[] = "ff";
 constexpr const char kStateTableKind[] = "statetable";
 
+// Bumped whenever the extraction of functions (and so the meaning of cached
+// CellLibraryProtos) changes.
+constexpr int64_t kCacheFormatVersion = 1;
+
 // Translates an individual signal value char to the protobuf equivalent.
 absl::StatusOr<StateTableSignalProto> LibertyToTableSignal(
     const std::string& input) {
@@ -290,6 +309,203 @@ absl::StatusOr<CellLibraryProto> ExtractFunctions(
   return proto;
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<IndexedLibrary>>
+IndexedLibrary::FromPath(const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(MemoryMappedFile file, MemoryMappedFile::Open(path));
+  auto library = absl::WrapUnique(new IndexedLibrary());
+  library->file_ = std::move(file);
+  library->text_ = library->file_->contents();
+  XLS_RETURN_IF_ERROR(library->BuildIndex());
+  return library;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<IndexedLibrary>>
+IndexedLibrary::FromText(std::string text) {
+  auto library = absl::WrapUnique(new IndexedLibrary());
+  library->owned_text_ = std::move(text);
+  library->text_ = library->owned_text_;
+  XLS_RETURN_IF_ERROR(library->BuildIndex());
+  return library;
+}
+
+// Finds the extents of the cell blocks directly inside the library block
+// without tokenizing the rest of the file: only comments, quoted strings and
+// braces need to be recognized to track the block nesting depth.
+absl::Status IndexedLibrary::BuildIndex() {
+  auto is_identifier_char = [](char c) {
+    return absl::ascii_isalnum(c) || c == '_';
+  };
+  auto skip_whitespace = [&](size_t i) {
+    while (i < text_.size() && (absl::ascii_isspace(text_[i]) ||
+                                (text_[i] == '\\' && i + 1 < text_.size() &&
+                                 text_[i + 1] == '\n'))) {
+      ++i;
+    }
+    return i;
+  };
+
+  int64_t depth = 0;
+  std::optional<size_t> cell_start;
+  std::string cell_name;
+  size_t i = 0;
+  while (i < text_.size()) {
+    char c = text_[i];
+    if (text_.substr(i, 2) == "/*") {
+      size_t end = text_.find("*/", i + 2);
+      i = end == std::string_view::npos ? text_.size() : end + 2;
+    } else if (text_.substr(i, 2) == "//") {
+      size_t end = text_.find('\n', i + 2);
+      i = end == std::string_view::npos ? text_.size() : end + 1;
+    } else if (c == '"') {
+      size_t end = text_.find('"', i + 1);
+      if (end == std::string_view::npos) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unexpected end-of-file in string starting at offset ", i));
+      }
+      i = end + 1;
+    } else if (c == '{') {
+      ++depth;
+      ++i;
+    } else if (c == '}') {
+      if (depth == 0) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Unbalanced close brace at offset ", i));
+      }
+      --depth;
+      ++i;
+      if (depth == 1 && cell_start.has_value()) {
+        if (!cell_text_
+                 .emplace(cell_name,
+                          text_.substr(*cell_start, i - *cell_start))
+                 .second) {
+          return absl::InvalidArgumentError(
+              absl::StrCat("Duplicate cell in library: ", cell_name));
+        }
+        cell_names_.push_back(cell_name);
+        cell_start.reset();
+      }
+    } else if (absl::ascii_isalpha(c)) {
+      size_t start = i;
+      while (i < text_.size() && is_identifier_char(text_[i])) {
+        ++i;
+      }
+      if (depth != 1 || text_.substr(start, i - start) != kCellKind) {
+        continue;
+      }
+      // A cell block: `cell (name) {`.
+      size_t open = skip_whitespace(i);
+      if (open >= text_.size() || text_[open] != '(') {
+        continue;
+      }
+      size_t close = text_.find(')', open);
+      if (close == std::string_view::npos) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unterminated cell name starting at offset ", open));
+      }
+      size_t body = skip_whitespace(close + 1);
+      if (body >= text_.size() || text_[body] != '{') {
+        i = close + 1;
+        continue;
+      }
+      std::string_view name =
+          absl::StripAsciiWhitespace(text_.substr(open + 1, close - open - 1));
+      absl::ConsumePrefix(&name, "\"");
+      absl::ConsumeSuffix(&name, "\"");
+      cell_name = std::string(name);
+      cell_start = start;
+      i = close + 1;
+    } else {
+      ++i;
+    }
+  }
+  if (depth != 0) {
+    return absl::InvalidArgumentError("Unexpected end-of-file in library.");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<CellLibraryEntryProto> IndexedLibrary::ExtractCell(
+    std::string_view name) const {
+  auto it = cell_text_.find(name);
+  if (it == cell_text_.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("Cell not found in library: ", name));
+  }
+  XLS_ASSIGN_OR_RETURN(cell_lib::CharStream stream,
+                       cell_lib::CharStream::FromText(std::string(it->second)));
+  cell_lib::Scanner scanner(&stream);
+  cell_lib::Parser parser(&scanner);
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<cell_lib::Block> block,
+                       parser.ParseCell());
+  CellLibraryEntryProto entry_proto;
+  XLS_RETURN_IF_ERROR(ExtractFromCell(*block, &entry_proto));
+  return entry_proto;
+}
+
+absl::StatusOr<CellLibraryProto> IndexedLibrary::ExtractAllCells() const {
+  CellLibraryProto proto;
+  for (const std::string& name : cell_names_) {
+    XLS_ASSIGN_OR_RETURN(*proto.add_entries(), ExtractCell(name));
+  }
+  return proto;
+}
+
+absl::StatusOr<CellLibraryProto> ExtractFunctionsCached(
+    const std::filesystem::path& path, const std::filesystem::path& cache_dir) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IndexedLibrary> library,
+                       IndexedLibrary::FromPath(path));
+
+  SHA256_CTX sha;
+  SHA256_Init(&sha);
+  std::string version = absl::StrCat(kCacheFormatVersion, ":");
+  SHA256_Update(&sha, version.data(), version.size());
+  SHA256_Update(&sha, library->text().data(), library->text().size());
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256_Final(digest, &sha);
+  std::filesystem::path entry_path =
+      cache_dir /
+      absl::StrCat(absl::BytesToHexString(std::string_view(
+                       reinterpret_cast<const char*>(digest), sizeof(digest))),
+                   ".pb");
+
+  if (FileExists(entry_path).ok()) {
+    CellLibraryProto proto;
+    absl::Status status = ParseProtobinFile(entry_path, &proto);
+    if (status.ok()) {
+      XLS_VLOG(1) << "Restored cell library from cache: " << entry_path;
+      return proto;
+    }
+    XLS_LOG(WARNING) << absl::StreamFormat(
+        "Ignoring invalid cell library cache file %s: %s", entry_path.string(),
+        status.ToString());
+  }
+
+  XLS_ASSIGN_OR_RETURN(CellLibraryProto proto, library->ExtractAllCells());
+
+  // Write the entry to a uniquely named temporary file and then rename it into
+  // place so concurrent readers never observe a partially written entry.
+  std::filesystem::path temp_path = absl::StrCat(
+      entry_path.string(), absl::StrFormat(".%d.tmp", getpid()));
+  absl::Status status = RecursivelyCreateDir(cache_dir);
+  if (status.ok()) {
+    status = SetProtobinFile(temp_path, proto);
+  }
+  std::error_code ec;
+  if (status.ok()) {
+    std::filesystem::rename(temp_path, entry_path, ec);
+    if (ec) {
+      status = absl::InternalError(ec.message());
+    }
+  }
+  if (!status.ok()) {
+    XLS_LOG(WARNING) << absl::StreamFormat(
+        "Unable to write cell library cache file %s: %s", entry_path.string(),
+        status.ToString());
+    std::filesystem::remove(temp_path, ec);
+  }
+  return proto;
+}
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
@@ -15,9 +15,16 @@
 #ifndef XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 #define XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 
+#include <filesystem>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
 
@@ -31,6 +38,56 @@ namespace function {
 // logical operation of the cell or pin (in the case of multiple output pins).
 absl::StatusOr<CellLibraryProto> ExtractFunctions(cell_lib::CharStream* stream);
 
+// A Liberty file indexed by cell. Creating the index only scans the file for
+// the extents of its top-level cell blocks; the body of a cell is parsed (and
+// its functions extracted, as by ExtractFunctions) only when it is requested.
+// Netlists typically reference a small fraction of the cells of a library, so
+// this is much cheaper than extracting the whole library.
+class IndexedLibrary {
+ public:
+  // Indexes the Liberty file at the given path. The file is memory-mapped for
+  // the lifetime of the index.
+  static absl::StatusOr<std::unique_ptr<IndexedLibrary>> FromPath(
+      const std::filesystem::path& path);
+
+  // Indexes the given Liberty text.
+  static absl::StatusOr<std::unique_ptr<IndexedLibrary>> FromText(
+      std::string text);
+
+  // Returns the names of the cells in the library, in file order.
+  const std::vector<std::string>& cell_names() const { return cell_names_; }
+
+  // Returns the full text of the library.
+  std::string_view text() const { return text_; }
+
+  // Extracts the cell with the given name, or returns a NOT_FOUND status if
+  // the library has no such cell.
+  absl::StatusOr<CellLibraryEntryProto> ExtractCell(
+      std::string_view name) const;
+
+  // Extracts every cell of the library.
+  absl::StatusOr<CellLibraryProto> ExtractAllCells() const;
+
+ private:
+  IndexedLibrary() = default;
+
+  absl::Status BuildIndex();
+
+  std::optional<MemoryMappedFile> file_;
+  std::string owned_text_;
+  std::string_view text_;
+  std::vector<std::string> cell_names_;
+  // Maps each cell name to the text of its cell block.
+  absl::flat_hash_map<std::string, std::string_view> cell_text_;
+};
+
+// Returns the functions of the Liberty file at `path`, as ExtractFunctions.
+// The result is cached in `cache_dir` as a serialized CellLibraryProto keyed
+// by the contents of the file, so that later extractions of the same library
+// only require reading the (much smaller) proto.
+absl::StatusOr<CellLibraryProto> ExtractFunctionsCached(
+    const std::filesystem::path& path, const std::filesystem::path& cache_dir);
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
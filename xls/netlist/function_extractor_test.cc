@@ -14,9 +14,16 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
@@ -26,6 +33,88 @@ namespace netlist {
 namespace function {
 namespace {
 
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+
+// A library whose text contains comments, quoted braces and lookalike "cell"
+// entries, to exercise the indexing of IndexedLibrary.
+constexpr char kIndexedLib[] = R"(
+library (blah) {
+  /* cell (commented_out) { } */
+  cell : "not a cell block";
+  cell ("and2") {
+    // cell (comment) {
+    pin (a) {
+      direction: input;
+    }
+    pin (b) {
+      direction: input;
+    }
+    pin (z) {
+      direction: output;
+      function: "a&b";
+      text: "}{";
+    }
+  }
+  other (x) {
+    cell (nested) {
+    }
+  }
+  cell (inv) {
+    pin (a) {
+      direction: input;
+    }
+    pin (zn) {
+      direction: output;
+      function: "!a";
+    }
+  }
+}
+)";
+
+TEST(FunctionExtractorTest, IndexedLibraryMatchesExtractFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<IndexedLibrary> library,
+                           IndexedLibrary::FromText(kIndexedLib));
+  EXPECT_THAT(library->cell_names(), ElementsAre("and2", "inv"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto stream,
+                           cell_lib::CharStream::FromText(kIndexedLib));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto expected,
+                           ExtractFunctions(&stream));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto actual,
+                           library->ExtractAllCells());
+  EXPECT_EQ(actual.DebugString(), expected.DebugString());
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryEntryProto inv,
+                           library->ExtractCell("inv"));
+  EXPECT_EQ(inv.DebugString(), expected.entries(1).DebugString());
+  EXPECT_THAT(library->ExtractCell("nested"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(FunctionExtractorTest, CachedExtraction) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path lib_path = temp_dir.path() / "lib.lib";
+  std::filesystem::path cache_dir = temp_dir.path() / "cache";
+  XLS_ASSERT_OK(SetFileContents(lib_path, kIndexedLib));
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto first,
+                           ExtractFunctionsCached(lib_path, cache_dir));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           GetDirectoryEntries(cache_dir));
+  ASSERT_EQ(entries.size(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto second,
+                           ExtractFunctionsCached(lib_path, cache_dir));
+  EXPECT_EQ(second.DebugString(), first.DebugString());
+  EXPECT_EQ(first.entries_size(), 2);
+
+  // A changed library is extracted afresh.
+  XLS_ASSERT_OK(SetFileContents(lib_path, "library (empty) {\n}\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto third,
+                           ExtractFunctionsCached(lib_path, cache_dir));
+  EXPECT_EQ(third.entries_size(), 0);
+}
+
 TEST(FunctionExtractorTest, BasicFunctionality) {
   std::string lib = R"(
 library (blah) {
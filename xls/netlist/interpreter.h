@@ -14,18 +14,29 @@
 #ifndef XLS_NETLIST_INTERPRETER_H_
 #define XLS_NETLIST_INTERPRETER_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <iterator>
 #include <memory>
 #include <queue>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/thread_annotations.h"
+#include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/ir/type.h"
@@ -88,6 +99,21 @@ class AbstractInterpreter {
       const AbstractNetRef2Value<EvalT>& inputs,
       absl::Span<const std::string> dump_cells = {});
 
+  // Interprets the given module with the given input mapping, as
+  // InterpretModule() does, but with a static schedule: on first use the
+  // module is levelized into a flat, topologically ordered array of cells with
+  // precomputed net indices, which is reused by every later call. The cells of
+  // each level are evaluated in parallel chunks (by up to num_threads + 1
+  // threads) with no per-cell synchronization; cells which are submodules or
+  // depend on state tables or cell evaluation functions are evaluated through
+  // InterpretCell() on the calling thread.
+  //
+  // As the schedule is cached, cell evaluation functions must be added to the
+  // netlist before the first call for a module.
+  absl::StatusOr<AbstractNetRef2Value<EvalT>> InterpretModuleLevelized(
+      const rtl::AbstractModule<EvalT>* module,
+      const AbstractNetRef2Value<EvalT>& inputs);
+
  private:
   // Returns true if the specified AbstractNetRef is an output of the given
   // cell.
@@ -120,10 +146,99 @@ class AbstractInterpreter {
       const absl::flat_hash_set<std::string>& dump_cell_set,
       const rtl::AbstractCell<EvalT>* cell, AbstractNetRef2Value<EvalT>& wires);
 
+  // A cell function (see function::Ast) compiled to a sequence of operations
+  // on a stack of values, so that evaluating it amounts to a few word
+  // operations (for bit-parallel values, for 64 vectors at once) instead of a
+  // parse and walk of the function's text.
+  struct CompiledFunction {
+    enum class OpKind {
+      kInput,
+      kInternalPin,
+      kZero,
+      kOne,
+      kNot,
+      kAnd,
+      kOr,
+      kXor,
+    };
+    struct Op {
+      OpKind kind;
+      // For kInput, the index of the input among the cell's inputs.
+      int64_t input_index = 0;
+      // For kInternalPin, the name of the (state table) pin.
+      std::string pin_name;
+    };
+    // In evaluation order; operands precede their operations.
+    std::vector<Op> ops;
+  };
+
+  // Returns the compiled function of the output pin `output_index` of cells of
+  // the given library entry, compiling it on first use.
+  absl::StatusOr<const CompiledFunction*> GetCompiledFunction(
+      const AbstractCellLibraryEntry<EvalT>* entry, int64_t output_index,
+      const std::string& pin_name);
+
+  static absl::Status CompileFunction(
+      const AbstractCellLibraryEntry<EvalT>& entry, const function::Ast& ast,
+      CompiledFunction& compiled);
+
+  // Evaluates the compiled function, using get_input(i) for the value of the
+  // i-th cell input and get_internal_pin(name) for internal (state table) pin
+  // values.
+  template <typename GetInputFn, typename GetInternalPinFn>
+  absl::StatusOr<EvalT> EvaluateCompiledFunction(
+      const CompiledFunction& function, GetInputFn get_input,
+      GetInternalPinFn get_internal_pin);
+
   absl::StatusOr<EvalT> InterpretFunction(
-      const rtl::AbstractCell<EvalT>& cell, const function::Ast& ast,
+      const rtl::AbstractCell<EvalT>& cell, const CompiledFunction& function,
       const AbstractNetRef2Value<EvalT>& inputs);
 
+  // A module flattened into a static schedule for InterpretModuleLevelized().
+  // Nets are replaced by indices into a flat array of values, where index 0
+  // holds zero and index 1 holds one. Cells are in topological order and
+  // grouped into levels, with each cell only depending on the cells of earlier
+  // levels.
+  struct LevelizedModule {
+    struct ScheduledCell {
+      const rtl::AbstractCell<EvalT>* cell;
+      // Net indices of the cell's inputs.
+      std::vector<int64_t> inputs;
+      // Net indices of the cell's outputs, or -1 for unused outputs.
+      std::vector<int64_t> outputs;
+      // For cells evaluated in parallel, the compiled function of each used
+      // output.
+      std::vector<const CompiledFunction*> functions;
+    };
+    // The cells of a level are cells[begin, end). Those in
+    // cells[fallback_begin, end) must be evaluated by InterpretCell().
+    struct Level {
+      int64_t begin;
+      int64_t fallback_begin;
+      int64_t end;
+    };
+    int64_t net_count = 2;
+    // Net indices of module->inputs().
+    std::vector<int64_t> inputs;
+    std::vector<ScheduledCell> cells;
+    std::vector<Level> levels;
+    // Module outputs and the net indices of their values.
+    std::vector<std::pair<rtl::AbstractNetRef<EvalT>, int64_t>> outputs;
+  };
+
+  // Returns the levelized form of the given module, levelizing it on first
+  // use.
+  absl::StatusOr<const LevelizedModule*> GetLevelizedModule(
+      const rtl::AbstractModule<EvalT>* module);
+
+  absl::StatusOr<LevelizedModule> LevelizeModule(
+      const rtl::AbstractModule<EvalT>* module);
+
+  // Evaluates the given (non-fallback) cell, storing its outputs into values.
+  absl::Status EvaluateScheduledCell(
+      const typename LevelizedModule::ScheduledCell& scheduled,
+      absl::Span<EvalT> values);
+
   // Returns the value of the internal/output pin from the cell (defined by a
   // "statetable" attribute under the conditions defined in "inputs".
   absl::StatusOr<EvalT> InterpretStateTable(
@@ -170,6 +285,19 @@ class AbstractInterpreter {
   std::atomic_size_t num_available_threads_ ABSL_GUARDED_BY(input_queue_guard_);
   // Set to shut down thread pool.
   std::atomic_bool threads_should_exit_ ABSL_GUARDED_BY(input_queue_guard_);
+
+  // Compiled cell functions, keyed by cell library entry and output index.
+  // Node-based so that pointers to the functions stay valid.
+  absl::Mutex compiled_functions_mutex_;
+  absl::node_hash_map<
+      std::pair<const AbstractCellLibraryEntry<EvalT>*, int64_t>,
+      CompiledFunction>
+      compiled_functions_ ABSL_GUARDED_BY(compiled_functions_mutex_);
+
+  // Levelized modules, see InterpretModuleLevelized().
+  absl::Mutex levelized_modules_mutex_;
+  absl::node_hash_map<const rtl::AbstractModule<EvalT>*, LevelizedModule>
+      levelized_modules_ ABSL_GUARDED_BY(levelized_modules_mutex_);
 };
 
 using Interpreter = AbstractInterpreter<>;
@@ -386,6 +514,297 @@ AbstractInterpreter<EvalT>::InterpretModule(
   return outputs;
 }
 
+template <typename EvalT>
+absl::StatusOr<AbstractNetRef2Value<EvalT>>
+AbstractInterpreter<EvalT>::InterpretModuleLevelized(
+    const rtl::AbstractModule<EvalT>* module,
+    const AbstractNetRef2Value<EvalT>& inputs) {
+  XLS_ASSIGN_OR_RETURN(const LevelizedModule* levelized,
+                       GetLevelizedModule(module));
+
+  absl::FixedArray<EvalT> values(levelized->net_count, zero_);
+  values[1] = one_;
+  for (int64_t i = 0; i < module->inputs().size(); ++i) {
+    auto it = inputs.find(module->inputs()[i]);
+    XLS_RET_CHECK(it != inputs.end())
+        << "Missing value for input " << module->inputs()[i]->name();
+    values[levelized->inputs[i]] = it->second;
+  }
+
+  // Levels with fewer cells than this are evaluated on the calling thread.
+  constexpr int64_t kMinCellsPerChunk = 256;
+  for (const typename LevelizedModule::Level& level : levelized->levels) {
+    int64_t cell_count = level.fallback_begin - level.begin;
+    int64_t chunk_count =
+        (cell_count + kMinCellsPerChunk - 1) / kMinCellsPerChunk;
+    int64_t worker_count = std::min<int64_t>(threads_.size() + 1, chunk_count);
+    if (worker_count <= 1) {
+      for (int64_t i = level.begin; i < level.fallback_begin; ++i) {
+        XLS_RETURN_IF_ERROR(
+            EvaluateScheduledCell(levelized->cells[i], absl::MakeSpan(values)));
+      }
+    } else {
+      // Each cell only writes its own output nets, so the chunks need no
+      // synchronization beyond the joins below.
+      std::vector<absl::Status> statuses(worker_count);
+      std::atomic<int64_t> next_chunk = 0;
+      auto worker = [&](int64_t worker_index) {
+        while (true) {
+          int64_t chunk = next_chunk++;
+          if (chunk >= chunk_count) {
+            return;
+          }
+          int64_t begin = level.begin + chunk * kMinCellsPerChunk;
+          int64_t end =
+              std::min(begin + kMinCellsPerChunk, level.fallback_begin);
+          for (int64_t i = begin; i < end; ++i) {
+            absl::Status status = EvaluateScheduledCell(
+                levelized->cells[i], absl::MakeSpan(values));
+            if (!status.ok()) {
+              statuses[worker_index] = status;
+              return;
+            }
+          }
+        }
+      };
+      std::vector<std::unique_ptr<xls::Thread>> workers;
+      for (int64_t i = 1; i < worker_count; ++i) {
+        workers.push_back(
+            std::make_unique<xls::Thread>([&worker, i]() { worker(i); }));
+      }
+      worker(0);
+      for (std::unique_ptr<xls::Thread>& thread : workers) {
+        thread->Join();
+      }
+      for (const absl::Status& status : statuses) {
+        XLS_RETURN_IF_ERROR(status);
+      }
+    }
+
+    for (int64_t i = level.fallback_begin; i < level.end; ++i) {
+      const typename LevelizedModule::ScheduledCell& scheduled =
+          levelized->cells[i];
+      const rtl::AbstractCell<EvalT>* cell = scheduled.cell;
+      AbstractNetRef2Value<EvalT> cell_inputs;
+      for (int64_t j = 0; j < cell->inputs().size(); ++j) {
+        cell_inputs.insert(
+            {cell->inputs()[j].netref, values[scheduled.inputs[j]]});
+      }
+      XLS_ASSIGN_OR_RETURN(AbstractNetRef2Value<EvalT> results,
+                           InterpretCell(cell, cell_inputs));
+      for (int64_t j = 0; j < cell->outputs().size(); ++j) {
+        if (scheduled.outputs[j] < 0) {
+          continue;
+        }
+        auto it = results.find(cell->outputs()[j].netref);
+        XLS_RET_CHECK(it != results.end())
+            << "Cell " << cell->name() << " produced no value for output "
+            << cell->outputs()[j].name;
+        values[scheduled.outputs[j]] = it->second;
+      }
+    }
+  }
+
+  AbstractNetRef2Value<EvalT> outputs;
+  outputs.reserve(levelized->outputs.size());
+  for (const auto& [output, index] : levelized->outputs) {
+    outputs.insert({output, values[index]});
+  }
+  return outputs;
+}
+
+template <typename EvalT>
+absl::StatusOr<const typename AbstractInterpreter<EvalT>::LevelizedModule*>
+AbstractInterpreter<EvalT>::GetLevelizedModule(
+    const rtl::AbstractModule<EvalT>* module) {
+  absl::MutexLock lock(&levelized_modules_mutex_);
+  if (auto it = levelized_modules_.find(module);
+      it != levelized_modules_.end()) {
+    return &it->second;
+  }
+  XLS_ASSIGN_OR_RETURN(LevelizedModule levelized, LevelizeModule(module));
+  return &levelized_modules_.emplace(module, std::move(levelized))
+              .first->second;
+}
+
+template <typename EvalT>
+absl::StatusOr<typename AbstractInterpreter<EvalT>::LevelizedModule>
+AbstractInterpreter<EvalT>::LevelizeModule(
+    const rtl::AbstractModule<EvalT>* module) {
+  using ScheduledCell = typename LevelizedModule::ScheduledCell;
+  LevelizedModule levelized;
+
+  // Nets with a value before any cell is evaluated.
+  absl::flat_hash_map<rtl::AbstractNetRef<EvalT>, int64_t> net_indices;
+  net_indices[module->zero()] = 0;
+  net_indices[module->one()] = 1;
+  for (const rtl::AbstractNetRef<EvalT> input : module->inputs()) {
+    auto [it, inserted] =
+        net_indices.try_emplace(input, levelized.net_count);
+    if (inserted) {
+      ++levelized.net_count;
+    }
+    levelized.inputs.push_back(it->second);
+  }
+
+  // Nets driven by cell outputs.
+  absl::flat_hash_map<rtl::AbstractNetRef<EvalT>, int64_t> driven_nets;
+  for (const auto& cell : module->cells()) {
+    for (const auto& output : cell->outputs()) {
+      if (output.netref == module->GetDummyRef()) {
+        continue;
+      }
+      auto [it, inserted] =
+          net_indices.try_emplace(output.netref, levelized.net_count);
+      if (inserted) {
+        ++levelized.net_count;
+      }
+      driven_nets.try_emplace(output.netref, it->second);
+    }
+  }
+
+  // The number of each cell's inputs which are driven by cells not yet
+  // scheduled, and for each driven net, the cells it is an input of (once per
+  // input pin).
+  absl::flat_hash_map<const rtl::AbstractCell<EvalT>*, int64_t>
+      pending_inputs;
+  absl::flat_hash_map<rtl::AbstractNetRef<EvalT>,
+                      std::vector<const rtl::AbstractCell<EvalT>*>>
+      consumers;
+  std::vector<const rtl::AbstractCell<EvalT>*> ready;
+  for (const auto& cell : module->cells()) {
+    int64_t pending = 0;
+    for (const auto& input : cell->inputs()) {
+      if (driven_nets.contains(input.netref)) {
+        consumers[input.netref].push_back(cell.get());
+        ++pending;
+      } else if (!net_indices.contains(input.netref)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Netlist contains unconnected subgraphs and cannot be translated. "
+            "Example: cell %s",
+            cell->name()));
+      }
+    }
+    pending_inputs[cell.get()] = pending;
+    if (pending == 0) {
+      ready.push_back(cell.get());
+    }
+  }
+
+  while (!ready.empty()) {
+    typename LevelizedModule::Level level;
+    level.begin = levelized.cells.size();
+    std::vector<ScheduledCell> fallback_cells;
+    std::vector<const rtl::AbstractCell<EvalT>*> next_ready;
+    for (const rtl::AbstractCell<EvalT>* cell : ready) {
+      ScheduledCell scheduled;
+      scheduled.cell = cell;
+      for (const auto& input : cell->inputs()) {
+        scheduled.inputs.push_back(net_indices.at(input.netref));
+      }
+      for (const auto& output : cell->outputs()) {
+        auto it = driven_nets.find(output.netref);
+        scheduled.outputs.push_back(it == driven_nets.end() ? -1 : it->second);
+        if (it == driven_nets.end()) {
+          continue;
+        }
+        for (const rtl::AbstractCell<EvalT>* consumer :
+             consumers[output.netref]) {
+          if (--pending_inputs[consumer] == 0) {
+            next_ready.push_back(consumer);
+          }
+        }
+      }
+
+      // Only plain cell functions are evaluated in parallel.
+      const AbstractCellLibraryEntry<EvalT>* entry = cell->cell_library_entry();
+      bool fallback = netlist_->MaybeGetModule(entry->name()).has_value();
+      for (int64_t i = 0; !fallback && i < cell->outputs().size(); ++i) {
+        const auto& output = cell->outputs()[i];
+        if (output.eval != nullptr) {
+          fallback = true;
+          break;
+        }
+        if (scheduled.outputs[i] < 0) {
+          scheduled.functions.push_back(nullptr);
+          continue;
+        }
+        XLS_ASSIGN_OR_RETURN(const CompiledFunction* function,
+                             GetCompiledFunction(entry, i, output.name));
+        fallback = absl::c_any_of(function->ops, [](const auto& op) {
+          return op.kind == CompiledFunction::OpKind::kInternalPin;
+        });
+        scheduled.functions.push_back(function);
+      }
+      if (fallback) {
+        scheduled.functions.clear();
+        fallback_cells.push_back(std::move(scheduled));
+      } else {
+        levelized.cells.push_back(std::move(scheduled));
+      }
+    }
+    level.fallback_begin = levelized.cells.size();
+    for (ScheduledCell& scheduled : fallback_cells) {
+      levelized.cells.push_back(std::move(scheduled));
+    }
+    level.end = levelized.cells.size();
+    levelized.levels.push_back(level);
+    ready = std::move(next_ready);
+  }
+
+  // Cells left unscheduled are on cycles or depend on cells which are.
+  for (const auto& [cell, pending] : pending_inputs) {
+    if (pending > 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Netlist contains unconnected subgraphs and cannot be translated. "
+          "Example: cell %s",
+          cell->name()));
+    }
+  }
+
+  // As in InterpretModule(), outputs not driven by cells must be assigned
+  // (possibly through a chain of assignments) from a constant or an input.
+  const auto& assigns = module->assigns();
+  for (const rtl::AbstractNetRef<EvalT> output : module->outputs()) {
+    rtl::AbstractNetRef<EvalT> net_value = output;
+    if (!driven_nets.contains(output)) {
+      XLS_RET_CHECK(assigns.contains(output));
+      while (assigns.contains(net_value)) {
+        net_value = assigns.at(net_value);
+      }
+    }
+    auto it = net_indices.find(net_value);
+    XLS_RET_CHECK(it != net_indices.end())
+        << "Output " << output->name() << " has no value.";
+    levelized.outputs.push_back({output, it->second});
+  }
+  return levelized;
+}
+
+template <typename EvalT>
+absl::Status AbstractInterpreter<EvalT>::EvaluateScheduledCell(
+    const typename LevelizedModule::ScheduledCell& scheduled,
+    absl::Span<EvalT> values) {
+  for (int64_t i = 0; i < scheduled.outputs.size(); ++i) {
+    if (scheduled.outputs[i] < 0) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        EvalT value,
+        EvaluateCompiledFunction(
+            *scheduled.functions[i],
+            [&](int64_t input) -> const EvalT& {
+              return values[scheduled.inputs[input]];
+            },
+            [](const std::string& pin_name) -> absl::StatusOr<EvalT> {
+              return absl::InternalError(absl::StrFormat(
+                  "Internal pin %s in a levelized cell function.", pin_name));
+            }));
+    values[scheduled.outputs[i]] = std::move(value);
+  }
+  return absl::OkStatus();
+}
+
 template <typename EvalT>
 absl::StatusOr<AbstractNetRef2Value<EvalT>>
 AbstractInterpreter<EvalT>::InterpretCell(
@@ -460,7 +879,6 @@ AbstractInterpreter<EvalT>::InterpretCell(
     return results;
   }
 
-  const auto& pins = entry->output_pin_to_function();
   for (int i = 0; i < cell->outputs().size(); i++) {
     if (cell->outputs()[i].eval != nullptr) {
       // The order of values in cell->inputs() is the same as the order of
@@ -474,9 +892,10 @@ AbstractInterpreter<EvalT>::InterpretCell(
       results.insert({cell->outputs()[i].netref, value});
     } else {
       XLS_ASSIGN_OR_RETURN(
-          function::Ast ast,
-          function::Parser::ParseFunction(pins.at(cell->outputs()[i].name)));
-      XLS_ASSIGN_OR_RETURN(EvalT value, InterpretFunction(*cell, ast, inputs));
+          const CompiledFunction* function,
+          GetCompiledFunction(entry, i, cell->outputs()[i].name));
+      XLS_ASSIGN_OR_RETURN(EvalT value,
+                           InterpretFunction(*cell, *function, inputs));
       results.insert({cell->outputs()[i].netref, value});
     }
   }
@@ -513,69 +932,141 @@ absl::Status AbstractInterpreter<EvalT>::ThreadBody() {
 }
 
 template <typename EvalT>
-absl::StatusOr<EvalT> AbstractInterpreter<EvalT>::InterpretFunction(
-    const rtl::AbstractCell<EvalT>& cell, const function::Ast& ast,
-    const AbstractNetRef2Value<EvalT>& inputs) {
+absl::StatusOr<const typename AbstractInterpreter<EvalT>::CompiledFunction*>
+AbstractInterpreter<EvalT>::GetCompiledFunction(
+    const AbstractCellLibraryEntry<EvalT>* entry, int64_t output_index,
+    const std::string& pin_name) {
+  absl::MutexLock lock(&compiled_functions_mutex_);
+  auto key = std::make_pair(entry, output_index);
+  if (auto it = compiled_functions_.find(key);
+      it != compiled_functions_.end()) {
+    return &it->second;
+  }
+  XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                       function::Parser::ParseFunction(
+                           entry->output_pin_to_function().at(pin_name)));
+  CompiledFunction compiled;
+  XLS_RETURN_IF_ERROR(CompileFunction(*entry, ast, compiled));
+  return &compiled_functions_.emplace(key, std::move(compiled)).first->second;
+}
+
+template <typename EvalT>
+absl::Status AbstractInterpreter<EvalT>::CompileFunction(
+    const AbstractCellLibraryEntry<EvalT>& entry, const function::Ast& ast,
+    CompiledFunction& compiled) {
+  using OpKind = typename CompiledFunction::OpKind;
+  for (const function::Ast& child : ast.children()) {
+    XLS_RETURN_IF_ERROR(CompileFunction(entry, child, compiled));
+  }
+  typename CompiledFunction::Op op;
   switch (ast.kind()) {
-    case function::Ast::Kind::kAnd: {
-      XLS_ASSIGN_OR_RETURN(EvalT lhs,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      XLS_ASSIGN_OR_RETURN(EvalT rhs,
-                           InterpretFunction(cell, ast.children()[1], inputs));
-      return lhs & rhs;
-    }
+    case function::Ast::Kind::kAnd:
+      op.kind = OpKind::kAnd;
+      break;
     case function::Ast::Kind::kIdentifier: {
-      rtl::AbstractNetRef<EvalT> ref = nullptr;
-      for (const auto& input : cell.inputs()) {
-        if (input.name == ast.name()) {
-          ref = input.netref;
-        }
-      }
-
-      if (ref == nullptr) {
-        for (const auto& internal : cell.internal_pins()) {
-          if (internal.name == ast.name()) {
-            return InterpretStateTable(cell, internal.name, inputs);
-          }
-        }
+      // The inputs of a cell are in the order of its library entry's inputs.
+      absl::Span<const std::string> input_names = entry.input_names();
+      auto it = std::find(input_names.begin(), input_names.end(), ast.name());
+      if (it != input_names.end()) {
+        op.kind = OpKind::kInput;
+        op.input_index = std::distance(input_names.begin(), it);
+        break;
       }
-
-      if (ref == nullptr) {
-        return absl::NotFoundError(
-            absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
-                            "or internal signals.",
-                            ast.name(), cell.name()));
+      if (entry.state_table().has_value() &&
+          entry.state_table()->internal_signals().contains(ast.name())) {
+        op.kind = OpKind::kInternalPin;
+        op.pin_name = ast.name();
+        break;
       }
-
-      return inputs.at(ref);
+      return absl::NotFoundError(
+          absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
+                          "or internal signals.",
+                          ast.name(), entry.name()));
     }
     case function::Ast::Kind::kLiteralOne:
-      return one_;
+      op.kind = OpKind::kOne;
+      break;
     case function::Ast::Kind::kLiteralZero:
-      return zero_;
-    case function::Ast::Kind::kNot: {
-      XLS_ASSIGN_OR_RETURN(EvalT value,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      return !value;
-    }
-    case function::Ast::Kind::kOr: {
-      XLS_ASSIGN_OR_RETURN(EvalT lhs,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      XLS_ASSIGN_OR_RETURN(EvalT rhs,
-                           InterpretFunction(cell, ast.children()[1], inputs));
-      return lhs | rhs;
-    }
-    case function::Ast::Kind::kXor: {
-      XLS_ASSIGN_OR_RETURN(EvalT lhs,
-                           InterpretFunction(cell, ast.children()[0], inputs));
-      XLS_ASSIGN_OR_RETURN(EvalT rhs,
-                           InterpretFunction(cell, ast.children()[1], inputs));
-      return lhs ^ rhs;
-    }
+      op.kind = OpKind::kZero;
+      break;
+    case function::Ast::Kind::kNot:
+      op.kind = OpKind::kNot;
+      break;
+    case function::Ast::Kind::kOr:
+      op.kind = OpKind::kOr;
+      break;
+    case function::Ast::Kind::kXor:
+      op.kind = OpKind::kXor;
+      break;
     default:
       return absl::InvalidArgumentError(
           absl::StrCat("Unknown AST element type: ", ast.kind()));
   }
+  compiled.ops.push_back(std::move(op));
+  return absl::OkStatus();
+}
+
+template <typename EvalT>
+template <typename GetInputFn, typename GetInternalPinFn>
+absl::StatusOr<EvalT> AbstractInterpreter<EvalT>::EvaluateCompiledFunction(
+    const CompiledFunction& function, GetInputFn get_input,
+    GetInternalPinFn get_internal_pin) {
+  using OpKind = typename CompiledFunction::OpKind;
+  absl::InlinedVector<EvalT, 8> stack;
+  for (const typename CompiledFunction::Op& op : function.ops) {
+    switch (op.kind) {
+      case OpKind::kInput:
+        stack.push_back(get_input(op.input_index));
+        break;
+      case OpKind::kInternalPin: {
+        XLS_ASSIGN_OR_RETURN(EvalT value, get_internal_pin(op.pin_name));
+        stack.push_back(std::move(value));
+        break;
+      }
+      case OpKind::kZero:
+        stack.push_back(zero_);
+        break;
+      case OpKind::kOne:
+        stack.push_back(one_);
+        break;
+      case OpKind::kNot:
+        XLS_RET_CHECK(!stack.empty());
+        stack.back() = !stack.back();
+        break;
+      case OpKind::kAnd:
+      case OpKind::kOr:
+      case OpKind::kXor: {
+        XLS_RET_CHECK_GE(stack.size(), 2);
+        EvalT rhs = std::move(stack.back());
+        stack.pop_back();
+        EvalT& lhs = stack.back();
+        if (op.kind == OpKind::kAnd) {
+          lhs = lhs & rhs;
+        } else if (op.kind == OpKind::kOr) {
+          lhs = lhs | rhs;
+        } else {
+          lhs = lhs ^ rhs;
+        }
+        break;
+      }
+    }
+  }
+  XLS_RET_CHECK_EQ(stack.size(), 1);
+  return std::move(stack.back());
+}
+
+template <typename EvalT>
+absl::StatusOr<EvalT> AbstractInterpreter<EvalT>::InterpretFunction(
+    const rtl::AbstractCell<EvalT>& cell, const CompiledFunction& function,
+    const AbstractNetRef2Value<EvalT>& inputs) {
+  return EvaluateCompiledFunction(
+      function,
+      [&](int64_t input) -> const EvalT& {
+        return inputs.at(cell.inputs()[input].netref);
+      },
+      [&](const std::string& pin_name) {
+        return InterpretStateTable(cell, pin_name, inputs);
+      });
 }
 
 template <typename EvalT>
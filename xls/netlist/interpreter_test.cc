@@ -17,11 +17,13 @@
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/bit_parallel_evaluator.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/fake_cell_library.h"
 #include "xls/netlist/function_extractor.h"
@@ -219,6 +221,96 @@ endmodule
   EXPECT_EQ(outputs[module->outputs()[0]], 1);
 }
 
+// Verifies that levelized interpretation agrees with dynamic interpretation,
+// including for submodule and input-less cells.
+TEST(InterpreterTest, LevelizedMatchesDynamic) {
+  std::string module_text = R"(
+module submodule (a, b, o);
+  input a, b;
+  output o;
+
+  AND and0( .A(a), .B(b), .Z(o) );
+endmodule
+
+module main (i0, i1, i2, i3, o0, o1);
+  input i0, i1, i2, i3;
+  output o0, o1;
+  wire one, x, y, z;
+
+  LOGIC_ONE one0( .O(one) );
+  OR or0( .A(i0), .B(i1), .Z(x) );
+  submodule sub0( .a(x), .b(i2), .o(y) );
+  XOR xor0( .A(y), .B(i3), .Z(z) );
+  AOI21 aoi0( .A(z), .B(one), .C(i1), .ZN(o0) );
+  NAND nand0( .A(z), .B(x), .ZN(o1) );
+endmodule
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+
+  Interpreter interpreter(netlist.get());
+  for (int64_t i = 0; i < 16; ++i) {
+    NetRef2Value inputs;
+    for (int64_t j = 0; j < 4; ++j) {
+      inputs[module->inputs()[j]] = (i >> j) & 1;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value expected,
+                             interpreter.InterpretModule(module, inputs));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NetRef2Value actual,
+        interpreter.InterpretModuleLevelized(module, inputs));
+    EXPECT_EQ(actual, expected) << "inputs: " << i;
+  }
+}
+
+// Verifies that a level wide enough to be split across threads is evaluated
+// correctly, and that the schedule is reused across calls.
+TEST(InterpreterTest, LevelizedWideLevel) {
+  constexpr int64_t kCellCount = 1024;
+  std::string module_text = "module wide (i0, i1";
+  for (int64_t i = 0; i < kCellCount; ++i) {
+    absl::StrAppend(&module_text, ", o", i);
+  }
+  absl::StrAppend(&module_text, ");\n  input i0, i1;\n");
+  for (int64_t i = 0; i < kCellCount; ++i) {
+    absl::StrAppend(&module_text, "  output o", i, ";\n");
+  }
+  for (int64_t i = 0; i < kCellCount; ++i) {
+    absl::StrAppend(&module_text, "  ", i % 2 == 0 ? "XOR" : "AND", " c", i,
+                    "( .A(i0), .B(i1), .Z(o", i, ") );\n");
+  }
+  absl::StrAppend(&module_text, "endmodule\n");
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("wide"));
+
+  Interpreter interpreter(netlist.get(), false, true, /*num_threads=*/4);
+  for (int64_t i = 0; i < 4; ++i) {
+    bool a = i & 1;
+    bool b = (i >> 1) & 1;
+    NetRef2Value inputs;
+    inputs[module->inputs()[0]] = a;
+    inputs[module->inputs()[1]] = b;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NetRef2Value outputs,
+        interpreter.InterpretModuleLevelized(module, inputs));
+    ASSERT_EQ(outputs.size(), kCellCount);
+    for (int64_t j = 0; j < kCellCount; ++j) {
+      EXPECT_EQ(outputs.at(module->outputs()[j]), j % 2 == 0 ? a ^ b : a && b)
+          << "inputs: " << i << ", output: " << j;
+    }
+  }
+}
+
 // Verifies that a [combinational] StateTable can be correctly interpreted in a
 // design.
 TEST(InterpreterTest, StateTables) {
@@ -520,6 +612,47 @@ TEST(NetlistParserTest, XorUsingCellFunctionsAndOpaqueValues) {
       kFalse, kTrue);
 }
 
+TEST(NetlistParserTest, XorUsingCellFunctionsAndBitParallelValues) {
+  const BitParallelValue kFalse = BitParallelValue::Broadcast(false);
+  const BitParallelValue kTrue = BitParallelValue::Broadcast(true);
+  TestXorUsing<BitParallelValue>(
+      std::string(liberty_src),
+      [kTrue](auto x) -> bool { return x == kTrue; }, {}, kFalse, kTrue);
+}
+
+TEST(NetlistParserTest, BitParallelSimulation) {
+  // Each lane holds a different pair of input values so a single
+  // interpretation of the netlist evaluates 64 input vectors.
+  const BitParallelValue kFalse = BitParallelValue::Broadcast(false);
+  const BitParallelValue kTrue = BitParallelValue::Broadcast(true);
+  rtl::Scanner scanner(netlist_src);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto stream,
+      xls::netlist::cell_lib::CharStream::FromText(std::string(liberty_src)));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto,
+                           xls::netlist::function::ExtractFunctions(&stream));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      AbstractCellLibrary<BitParallelValue> cell_library,
+      AbstractCellLibrary<BitParallelValue>::FromProto(proto, kFalse, kTrue));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<rtl::AbstractNetlist<BitParallelValue>> n,
+      rtl::AbstractParser<BitParallelValue>::ParseNetlist(
+          &cell_library, &scanner, kFalse, kTrue));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::AbstractModule<BitParallelValue>* m,
+                           n->GetModule("xor2"));
+  AbstractInterpreter<BitParallelValue> interpreter(n.get(), kFalse, kTrue);
+
+  const BitParallelValue x = BitParallelValue::FromLanes(0x123456789abcdef0);
+  const BitParallelValue y = BitParallelValue::FromLanes(0x0ff00ff00ff00ff0);
+  AbstractNetRef2Value<BitParallelValue> inputs;
+  inputs.emplace(m->inputs()[0], x);
+  inputs.emplace(m->inputs()[1], y);
+  XLS_ASSERT_OK_AND_ASSIGN(AbstractNetRef2Value<BitParallelValue> outputs,
+                           interpreter.InterpretModule(m, inputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs.at(m->outputs()[0]).lanes(), (x ^ y).lanes());
+}
+
 template <typename ValueT>
 struct EvalOpCallCounter {
   std::atomic_size_t num_eval_calls = 0;
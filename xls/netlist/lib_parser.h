@@ -370,6 +370,13 @@ class Parser {
     return ParseBlock("library");
   }
 
+  // Parses a single cell block (e.g., as indexed out of a library by
+  // function::IndexedLibrary).
+  absl::StatusOr<std::unique_ptr<Block>> ParseCell() {
+    XLS_RETURN_IF_ERROR(DropIdentifierOrError("cell"));
+    return ParseBlock("cell");
+  }
+
  private:
   absl::StatusOr<bool> TryDropToken(TokenKind target, Pos* pos = nullptr);
   absl::Status DropTokenOrError(TokenKind kind);
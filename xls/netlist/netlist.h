@@ -23,7 +23,9 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -476,9 +478,12 @@ class AbstractModule {
   absl::flat_hash_map<AbstractNetRef<EvalT>, AbstractNetRef<EvalT>>
       assign_nets_;
   std::vector<std::unique_ptr<AbstractNetDef<EvalT>>> nets_;
-  absl::flat_hash_map<std::string, AbstractNetRef<EvalT>> name_to_netref_;
+  // The name maps are keyed by views of the names held by the (heap allocated
+  // and so address-stable) nets and cells, so that each name of a large
+  // netlist is only stored once.
+  absl::flat_hash_map<std::string_view, AbstractNetRef<EvalT>> name_to_netref_;
   std::vector<std::unique_ptr<AbstractCell<EvalT>>> cells_;
-  absl::flat_hash_map<std::string, AbstractCell<EvalT>*> name_to_cell_;
+  absl::flat_hash_map<std::string_view, AbstractCell<EvalT>*> name_to_cell_;
   AbstractNetRef<EvalT> zero_;
   AbstractNetRef<EvalT> one_;
   AbstractNetRef<EvalT> dummy_;
@@ -496,12 +501,12 @@ class AbstractNetlist {
   // Looks up a module by name.  Returns NotFoundError if no such module is
   // found.
   absl::StatusOr<const AbstractModule<EvalT>*> GetModule(
-      const std::string& module_name) const;
+      std::string_view module_name) const;
   // Faster version of GetModule--returns nullopt when module is not present.
   // Useful when looking for a module expects to get false results most of the
   // time.
   std::optional<const AbstractModule<EvalT>*> MaybeGetModule(
-      const std::string& module_name) const;
+      std::string_view module_name) const;
   const absl::Span<const std::unique_ptr<AbstractModule<EvalT>>> modules() {
     return modules_;
   }
@@ -526,6 +531,10 @@ class AbstractNetlist {
   // the 16 bit LUT_INIT parameter).
   absl::flat_hash_map<uint16_t, AbstractCellLibraryEntry<EvalT>> lut_cells_;
   std::vector<std::unique_ptr<AbstractModule<EvalT>>> modules_;
+  // Keyed by views of the module names. Every cell instance in a netlist looks
+  // up its cell name here while parsing.
+  absl::flat_hash_map<std::string_view, const AbstractModule<EvalT>*>
+      name_to_module_;
 };
 
 using Netlist = AbstractNetlist<>;
@@ -601,9 +610,9 @@ absl::StatusOr<AbstractCell<EvalT>*> AbstractModule<EvalT>::AddCell(
         absl::StrCat("Module already has a cell with name: ", cell.name()));
   }
 
-  cells_.push_back(std::make_unique<AbstractCell<EvalT>>(cell));
+  cells_.push_back(std::make_unique<AbstractCell<EvalT>>(std::move(cell)));
   auto cell_ptr = cells_.back().get();
-  name_to_cell_[cell.name()] = cell_ptr;
+  name_to_cell_[cell_ptr->name()] = cell_ptr;
   return cell_ptr;
 }
 
@@ -622,7 +631,7 @@ absl::Status AbstractModule<EvalT>::AddNetDecl(NetDeclKind kind,
 
   nets_.emplace_back(std::make_unique<AbstractNetDef<EvalT>>(name, kind));
   AbstractNetRef<EvalT> ref = nets_.back().get();
-  name_to_netref_[name] = ref;
+  name_to_netref_[ref->name()] = ref;
   switch (kind) {
     case NetDeclKind::kInput:
       input_nets_.push_back(ref);
@@ -829,23 +838,24 @@ template <typename EvalT>
 template <typename EvalT>
 void AbstractNetlist<EvalT>::AddModule(
     std::unique_ptr<AbstractModule<EvalT>> module) {
+  // The first module added with a given name is the one found by name.
+  name_to_module_.try_emplace(module->name(), module.get());
   modules_.emplace_back(std::move(module));
 }
 
 template <typename EvalT>
 std::optional<const AbstractModule<EvalT>*>
-AbstractNetlist<EvalT>::MaybeGetModule(const std::string& module_name) const {
-  for (const auto& module : modules_) {
-    if (module->name() == module_name) {
-      return module.get();
-    }
+AbstractNetlist<EvalT>::MaybeGetModule(std::string_view module_name) const {
+  auto it = name_to_module_.find(module_name);
+  if (it == name_to_module_.end()) {
+    return absl::nullopt;
   }
-  return absl::nullopt;
+  return it->second;
 }
 
 template <typename EvalT>
 absl::StatusOr<const AbstractModule<EvalT>*> AbstractNetlist<EvalT>::GetModule(
-    const std::string& module_name) const {
+    std::string_view module_name) const {
   auto found = MaybeGetModule(module_name);
   if (found == absl::nullopt) {
     return absl::NotFoundError(
@@ -0,0 +1,372 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/netlist_jit.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/casts.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "llvm/include/llvm/IR/Constants.h"
+#include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/IR/Value.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/function_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// Emits the logic of netlist modules into a single LLVM function, with every
+// net held as an i64 of 64 lanes.
+class ModuleEmitter {
+ public:
+  ModuleEmitter(const rtl::Netlist* netlist, llvm::IRBuilder<>* builder)
+      : netlist_(netlist),
+        builder_(builder),
+        zero_(builder->getInt64(0)),
+        one_(builder->getInt64(~uint64_t{0})) {}
+
+  // Emits the logic of `module` given the values of its inputs (in the order
+  // of module->inputs()) and returns the values of its outputs (in the order
+  // of module->outputs()).
+  absl::StatusOr<std::vector<llvm::Value*>> EmitModule(
+      const rtl::Module* module, absl::Span<llvm::Value* const> inputs);
+
+ private:
+  using NetValues = absl::flat_hash_map<rtl::NetRef, llvm::Value*>;
+
+  // Returns the cells of the module in topological order.
+  static absl::StatusOr<std::vector<const rtl::Cell*>> SortCells(
+      const rtl::Module* module);
+
+  // Returns the value of the given net, following assignments.
+  absl::StatusOr<llvm::Value*> GetNetValue(const rtl::Module* module,
+                                           const NetValues& values,
+                                           rtl::NetRef net);
+
+  // Emits the given cell, whose inputs must have values, and adds the values
+  // of its outputs.
+  absl::Status EmitCell(const rtl::Module* module, const rtl::Cell* cell,
+                        NetValues& values);
+
+  absl::StatusOr<llvm::Value*> EmitFunction(
+      const CellLibraryEntry& entry, const function::Ast& ast,
+      absl::Span<llvm::Value* const> cell_inputs);
+
+  const rtl::Netlist* netlist_;
+  llvm::IRBuilder<>* builder_;
+  llvm::Value* zero_;
+  llvm::Value* one_;
+  // Parsed cell functions, keyed by the function text.
+  absl::flat_hash_map<std::string, function::Ast> functions_;
+};
+
+absl::StatusOr<std::vector<const rtl::Cell*>> ModuleEmitter::SortCells(
+    const rtl::Module* module) {
+  absl::flat_hash_map<rtl::NetRef, const rtl::Cell*> drivers;
+  for (const auto& cell : module->cells()) {
+    for (const auto& output : cell->outputs()) {
+      if (output.netref != module->GetDummyRef()) {
+        drivers[output.netref] = cell.get();
+      }
+    }
+  }
+
+  // The number of each cell's inputs which are driven by cells not yet
+  // sorted, and the cells which each cell drives (once per input pin).
+  absl::flat_hash_map<const rtl::Cell*, int64_t> pending_inputs;
+  absl::flat_hash_map<const rtl::Cell*, std::vector<const rtl::Cell*>> users;
+  std::vector<const rtl::Cell*> ready;
+  const auto& assigns = module->assigns();
+  for (const auto& cell : module->cells()) {
+    int64_t pending = 0;
+    for (const auto& input : cell->inputs()) {
+      rtl::NetRef net = input.netref;
+      while (!drivers.contains(net) && assigns.contains(net)) {
+        net = assigns.at(net);
+      }
+      if (auto it = drivers.find(net); it != drivers.end()) {
+        users[it->second].push_back(cell.get());
+        ++pending;
+      }
+    }
+    pending_inputs[cell.get()] = pending;
+    if (pending == 0) {
+      ready.push_back(cell.get());
+    }
+  }
+
+  std::vector<const rtl::Cell*> sorted;
+  while (!ready.empty()) {
+    const rtl::Cell* cell = ready.back();
+    ready.pop_back();
+    sorted.push_back(cell);
+    for (const rtl::Cell* user : users[cell]) {
+      if (--pending_inputs[user] == 0) {
+        ready.push_back(user);
+      }
+    }
+  }
+  if (sorted.size() != module->cells().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Module %s contains a combinational cycle.", module->name()));
+  }
+  return sorted;
+}
+
+absl::StatusOr<llvm::Value*> ModuleEmitter::GetNetValue(
+    const rtl::Module* module, const NetValues& values, rtl::NetRef net) {
+  const auto& assigns = module->assigns();
+  while (true) {
+    if (net == module->zero()) {
+      return zero_;
+    }
+    if (net == module->one()) {
+      return one_;
+    }
+    if (auto it = values.find(net); it != values.end()) {
+      return it->second;
+    }
+    auto it = assigns.find(net);
+    if (it == assigns.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Net %s of module %s has no value.", net->name(),
+                          module->name()));
+    }
+    net = it->second;
+  }
+}
+
+absl::StatusOr<std::vector<llvm::Value*>> ModuleEmitter::EmitModule(
+    const rtl::Module* module, absl::Span<llvm::Value* const> inputs) {
+  XLS_RET_CHECK_EQ(inputs.size(), module->inputs().size());
+  NetValues values;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    values[module->inputs()[i]] = inputs[i];
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::vector<const rtl::Cell*> cells,
+                       SortCells(module));
+  for (const rtl::Cell* cell : cells) {
+    XLS_RETURN_IF_ERROR(EmitCell(module, cell, values));
+  }
+
+  std::vector<llvm::Value*> outputs;
+  for (const rtl::NetRef output : module->outputs()) {
+    XLS_ASSIGN_OR_RETURN(llvm::Value * value,
+                         GetNetValue(module, values, output));
+    outputs.push_back(value);
+  }
+  return outputs;
+}
+
+absl::Status ModuleEmitter::EmitCell(const rtl::Module* module,
+                                     const rtl::Cell* cell,
+                                     NetValues& values) {
+  // Inputs are in the order of the cell library entry's input names.
+  std::vector<llvm::Value*> cell_inputs;
+  for (const auto& input : cell->inputs()) {
+    XLS_ASSIGN_OR_RETURN(llvm::Value * value,
+                         GetNetValue(module, values, input.netref));
+    cell_inputs.push_back(value);
+  }
+
+  const CellLibraryEntry* entry = cell->cell_library_entry();
+  std::optional<const rtl::Module*> submodule =
+      netlist_->MaybeGetModule(entry->name());
+  if (submodule.has_value()) {
+    // In a module's cell library entry, the input names are in the order of
+    // the module's inputs, so the cell's inputs can be passed as is. Outputs
+    // are matched by name.
+    XLS_ASSIGN_OR_RETURN(std::vector<llvm::Value*> submodule_outputs,
+                         EmitModule(submodule.value(), cell_inputs));
+    for (const auto& output : cell->outputs()) {
+      if (output.netref == module->GetDummyRef()) {
+        continue;
+      }
+      bool output_found = false;
+      for (int64_t i = 0; i < submodule_outputs.size(); ++i) {
+        if (submodule.value()->outputs()[i]->name() == output.name) {
+          values[output.netref] = submodule_outputs[i];
+          output_found = true;
+          break;
+        }
+      }
+      XLS_RET_CHECK(output_found) << absl::StrFormat(
+          "Could not find output pin \"%s\" in module \"%s\", referenced in "
+          "cell \"%s\"!",
+          output.name, submodule.value()->name(), cell->name());
+    }
+    return absl::OkStatus();
+  }
+
+  for (const auto& output : cell->outputs()) {
+    if (output.eval != nullptr) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Cell %s has an evaluation function for output %s, which cannot be "
+          "compiled.",
+          cell->name(), output.name));
+    }
+    if (output.netref == module->GetDummyRef()) {
+      continue;
+    }
+    const std::string& text = entry->output_pin_to_function().at(output.name);
+    auto it = functions_.find(text);
+    if (it == functions_.end()) {
+      XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                           function::Parser::ParseFunction(text));
+      it = functions_.emplace(text, std::move(ast)).first;
+    }
+    XLS_ASSIGN_OR_RETURN(values[output.netref],
+                         EmitFunction(*entry, it->second, cell_inputs));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<llvm::Value*> ModuleEmitter::EmitFunction(
+    const CellLibraryEntry& entry, const function::Ast& ast,
+    absl::Span<llvm::Value* const> cell_inputs) {
+  std::vector<llvm::Value*> operands;
+  for (const function::Ast& child : ast.children()) {
+    XLS_ASSIGN_OR_RETURN(llvm::Value * operand,
+                         EmitFunction(entry, child, cell_inputs));
+    operands.push_back(operand);
+  }
+  switch (ast.kind()) {
+    case function::Ast::Kind::kAnd:
+      return builder_->CreateAnd(operands[0], operands[1]);
+    case function::Ast::Kind::kIdentifier: {
+      absl::Span<const std::string> input_names = entry.input_names();
+      for (int64_t i = 0; i < input_names.size(); ++i) {
+        if (input_names[i] == ast.name()) {
+          return cell_inputs[i];
+        }
+      }
+      if (entry.state_table().has_value() &&
+          entry.state_table()->internal_signals().contains(ast.name())) {
+        return absl::UnimplementedError(absl::StrFormat(
+            "Cell %s uses state table signal \"%s\", which cannot be "
+            "compiled.",
+            entry.name(), ast.name()));
+      }
+      return absl::NotFoundError(
+          absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs.",
+                          ast.name(), entry.name()));
+    }
+    case function::Ast::Kind::kLiteralOne:
+      return one_;
+    case function::Ast::Kind::kLiteralZero:
+      return zero_;
+    case function::Ast::Kind::kNot:
+      return builder_->CreateNot(operands[0]);
+    case function::Ast::Kind::kOr:
+      return builder_->CreateOr(operands[0], operands[1]);
+    case function::Ast::Kind::kXor:
+      return builder_->CreateXor(operands[0], operands[1]);
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown AST element type: ", static_cast<int>(ast.kind())));
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<NetlistJit>> NetlistJit::Create(
+    const rtl::Netlist* netlist, const rtl::Module* module,
+    int64_t opt_level) {
+  auto jit = absl::WrapUnique(new NetlistJit(module));
+  XLS_ASSIGN_OR_RETURN(jit->orc_jit_, OrcJit::Create(opt_level));
+
+  std::string function_name = absl::StrCat("__netlist_", module->name());
+  std::unique_ptr<llvm::Module> llvm_module =
+      jit->orc_jit_->NewModule(absl::StrCat("__module_", module->name()));
+  llvm::LLVMContext& context = *jit->orc_jit_->GetContext();
+  llvm::Type* ptr_type = llvm::PointerType::get(context, 0);
+  llvm::FunctionType* function_type = llvm::FunctionType::get(
+      llvm::Type::getVoidTy(context), {ptr_type, ptr_type},
+      /*isVarArg=*/false);
+  llvm::Function* function =
+      llvm::Function::Create(function_type, llvm::Function::ExternalLinkage,
+                             function_name, llvm_module.get());
+  llvm::IRBuilder<> builder(
+      llvm::BasicBlock::Create(context, "entry", function));
+
+  llvm::Type* word_type = builder.getInt64Ty();
+  llvm::Value* input_buffer = function->getArg(0);
+  llvm::Value* output_buffer = function->getArg(1);
+  std::vector<llvm::Value*> inputs;
+  for (int64_t i = 0; i < module->inputs().size(); ++i) {
+    inputs.push_back(builder.CreateLoad(
+        word_type, builder.CreateConstGEP1_64(word_type, input_buffer, i)));
+  }
+
+  ModuleEmitter emitter(netlist, &builder);
+  XLS_ASSIGN_OR_RETURN(std::vector<llvm::Value*> outputs,
+                       emitter.EmitModule(module, inputs));
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    builder.CreateStore(
+        outputs[i], builder.CreateConstGEP1_64(word_type, output_buffer, i));
+  }
+  builder.CreateRetVoid();
+
+  XLS_RETURN_IF_ERROR(jit->orc_jit_->CompileModule(std::move(llvm_module)));
+  XLS_ASSIGN_OR_RETURN(auto address, jit->orc_jit_->LoadSymbol(function_name));
+  jit->function_ = absl::bit_cast<JitFunctionType>(address);
+  return jit;
+}
+
+absl::Status NetlistJit::RunLanes(absl::Span<const uint64_t> inputs,
+                                  absl::Span<uint64_t> outputs) {
+  if (inputs.size() != module_->inputs().size() ||
+      outputs.size() != module_->outputs().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Module %s has %d inputs and %d outputs; got %d and %d.",
+        module_->name(), module_->inputs().size(), module_->outputs().size(),
+        inputs.size(), outputs.size()));
+  }
+  function_(inputs.data(), outputs.data());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<NetRef2Value> NetlistJit::Run(const NetRef2Value& inputs) {
+  std::vector<uint64_t> input_lanes;
+  for (const rtl::NetRef input : module_->inputs()) {
+    auto it = inputs.find(input);
+    XLS_RET_CHECK(it != inputs.end())
+        << "Missing value for input " << input->name();
+    input_lanes.push_back(it->second ? 1 : 0);
+  }
+  std::vector<uint64_t> output_lanes(module_->outputs().size());
+  XLS_RETURN_IF_ERROR(RunLanes(input_lanes, absl::MakeSpan(output_lanes)));
+
+  NetRef2Value outputs;
+  for (int64_t i = 0; i < output_lanes.size(); ++i) {
+    outputs[module_->outputs()[i]] = output_lanes[i] & 1;
+  }
+  return outputs;
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,124 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/netlist_jit.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// A module with an instance of another module and an input-less cell.
+constexpr char kModuleText[] = R"(
+module submodule (a, b, o);
+  input a, b;
+  output o;
+
+  AND and0( .A(a), .B(b), .Z(o) );
+endmodule
+
+module main (i0, i1, i2, i3, o0, o1);
+  input i0, i1, i2, i3;
+  output o0, o1;
+  wire one, x, y, z;
+
+  LOGIC_ONE one0( .O(one) );
+  OR or0( .A(i0), .B(i1), .Z(x) );
+  submodule sub0( .a(x), .b(i2), .o(y) );
+  XOR xor0( .A(y), .B(i3), .Z(z) );
+  AOI21 aoi0( .A(z), .B(one), .C(i1), .ZN(o0) );
+  NAND nand0( .A(z), .B(x), .ZN(o1) );
+endmodule
+)";
+
+class NetlistJitTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(cell_library_, MakeFakeCellLibrary());
+    rtl::Scanner scanner(kModuleText);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        netlist_, rtl::Parser::ParseNetlist(&cell_library_, &scanner));
+    XLS_ASSERT_OK_AND_ASSIGN(module_, netlist_->GetModule("main"));
+  }
+
+  CellLibrary cell_library_;
+  std::unique_ptr<rtl::Netlist> netlist_;
+  const rtl::Module* module_ = nullptr;
+};
+
+TEST_F(NetlistJitTest, MatchesInterpreter) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlistJit> jit,
+                           NetlistJit::Create(netlist_.get(), module_));
+  Interpreter interpreter(netlist_.get());
+  for (int64_t i = 0; i < 16; ++i) {
+    NetRef2Value inputs;
+    for (int64_t j = 0; j < 4; ++j) {
+      inputs[module_->inputs()[j]] = (i >> j) & 1;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value expected,
+                             interpreter.InterpretModule(module_, inputs));
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value actual, jit->Run(inputs));
+    EXPECT_EQ(actual, expected) << "inputs: " << i;
+  }
+}
+
+TEST_F(NetlistJitTest, EvaluatesLanesIndependently) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlistJit> jit,
+                           NetlistJit::Create(netlist_.get(), module_));
+  // Lane k holds input vector k % 16.
+  std::vector<uint64_t> inputs(4);
+  for (int64_t lane = 0; lane < 64; ++lane) {
+    for (int64_t j = 0; j < 4; ++j) {
+      inputs[j] |= uint64_t{((lane % 16) >> j) & 1} << lane;
+    }
+  }
+  std::vector<uint64_t> outputs(2);
+  XLS_ASSERT_OK(jit->RunLanes(inputs, absl::MakeSpan(outputs)));
+
+  for (int64_t lane = 0; lane < 64; ++lane) {
+    bool i0 = (inputs[0] >> lane) & 1;
+    bool i1 = (inputs[1] >> lane) & 1;
+    bool i2 = (inputs[2] >> lane) & 1;
+    bool i3 = (inputs[3] >> lane) & 1;
+    bool x = i0 || i1;
+    bool z = (x && i2) != i3;
+    EXPECT_EQ((outputs[0] >> lane) & 1, !(z || i1)) << "lane: " << lane;
+    EXPECT_EQ((outputs[1] >> lane) & 1, !(z && x)) << "lane: " << lane;
+  }
+}
+
+TEST_F(NetlistJitTest, WrongNumberOfInputs) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlistJit> jit,
+                           NetlistJit::Create(netlist_.get(), module_));
+  std::vector<uint64_t> inputs(3);
+  std::vector<uint64_t> outputs(2);
+  EXPECT_FALSE(jit->RunLanes(inputs, absl::MakeSpan(outputs)).ok());
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
@@ -14,7 +14,10 @@
 
 #include "xls/netlist/netlist_parser.h"
 
+#include <filesystem>
+#include <string_view>
 #include <tuple>
+#include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -35,6 +38,11 @@ namespace xls {
 namespace netlist {
 namespace rtl {
 
+absl::StatusOr<Scanner> Scanner::FromFile(const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(MemoryMappedFile file, MemoryMappedFile::Open(path));
+  return Scanner(std::move(file));
+}
+
 std::string Pos::ToHumanString() const {
   return absl::StrFormat("%d:%d", lineno + 1, colno + 1);
 }
@@ -188,8 +196,7 @@ absl::StatusOr<Token> Scanner::Pop() {
 }
 
 absl::StatusOr<Token> Scanner::ScanNumber(char startc, Pos pos) {
-  std::string chars;
-  chars.push_back(startc);
+  const size_t start = index_ - 1;
   bool seen_separator = false;
   auto is_hex_char = [](char c) {
     return absl::ascii_isxdigit(absl::ascii_toupper(c));
@@ -204,20 +211,19 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, Pos pos) {
   while (!AtEofInternal()) {
     char c = PeekCharOrDie();
     if (is_hex_char(c)) {
-      chars.push_back(PopCharOrDie());
+      DropCharOrDie();
     } else if (c == '\'' && !seen_separator) {
       // If we see a base separator, pop it, then the optional signedness
       // indicator (s|S), then the base indicator (d|b|o|h|D|B|O|H).
-      chars.push_back(PopCharOrDie());
+      DropCharOrDie();
       XLS_RET_CHECK(!AtEofInternal()) << "Saw EOF while scanning number base!";
-      chars.push_back(PopCharOrDie());
-      if (chars.back() == 's' || chars.back() == 'S') {
+      c = PopCharOrDie();
+      if (c == 's' || c == 'S') {
         XLS_RET_CHECK(!AtEofInternal())
             << "Saw EOF while scanning number base (post-signedness)!";
-        chars.push_back(PopCharOrDie());
+        c = PopCharOrDie();
       }
 
-      c = chars.back();
       XLS_RET_CHECK(c == 'd' || c == 'b' || c == 'o' || c == 'h' || c == 'D' ||
                     c == 'B' || c == 'O' || c == 'H')
           << "Expected [dbohDBOH], saw '" << c << "'";
@@ -228,23 +234,22 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, Pos pos) {
     }
   }
 
-  return Token{TokenKind::kNumber, pos, chars};
+  return Token{TokenKind::kNumber, pos, text_.substr(start, index_ - start)};
 }
 
 absl::StatusOr<Token> Scanner::ScanName(char startc, Pos pos, bool is_escaped) {
-  std::string chars;
-  chars.push_back(startc);
+  const size_t start = index_ - 1;
   while (!AtEofInternal()) {
     char c = PeekCharOrDie();
     bool is_whitespace = c == ' ' || c == '\t' || c == '\n';
     if ((is_escaped && !is_whitespace) || isalpha(c) || isdigit(c) ||
         c == '_') {
-      chars.push_back(PopCharOrDie());
+      DropCharOrDie();
     } else {
       break;
     }
   }
-  return Token{TokenKind::kName, pos, chars};
+  return Token{TokenKind::kName, pos, text_.substr(start, index_ - start)};
 }
 
 absl::StatusOr<Token> Scanner::PeekInternal() {
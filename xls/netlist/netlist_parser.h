@@ -17,7 +17,13 @@
 
 #include <sys/types.h>
 
+#include <filesystem>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -29,6 +35,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/variant.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -75,7 +82,9 @@ struct Pos {
 struct Token {
   TokenKind kind;
   Pos pos;
-  std::string value;
+  // For names and numbers, a view of the token's text in the scanned text, so
+  // that scanning does not copy the (potentially very large) netlist.
+  std::string_view value;
 
   std::string ToString() const;
 };
@@ -83,8 +92,15 @@ struct Token {
 // Token scanner for netlist files.
 class Scanner {
  public:
+  // Scans the given text, which must outlive the scanner and any tokens it
+  // returns.
   explicit Scanner(std::string_view text) : text_(text) {}
 
+  // Returns a scanner of the file at the given path. The file is memory-mapped
+  // (and owned by the scanner) rather than read into memory, so multi-GB
+  // netlists are paged in on demand.
+  static absl::StatusOr<Scanner> FromFile(const std::filesystem::path& path);
+
   absl::StatusOr<Token> Peek();
 
   absl::StatusOr<Token> Pop();
@@ -95,6 +111,8 @@ class Scanner {
   }
 
  private:
+  // The scan functions are called with the first character of the token
+  // already popped.
   absl::StatusOr<Token> ScanName(char startc, Pos pos, bool is_escaped);
   absl::StatusOr<Token> ScanNumber(char startc, Pos pos);
   absl::StatusOr<Token> PeekInternal();
@@ -118,6 +136,11 @@ class Scanner {
   // whether the character stream index has reached the end of the text.
   bool AtEofInternal() const { return index_ >= text_.size(); }
 
+  explicit Scanner(MemoryMappedFile file)
+      : file_(std::move(file)), text_(file_->contents()) {}
+
+  // The mapped file scanned, if any. Must precede text_, which views it.
+  std::optional<MemoryMappedFile> file_;
   std::string_view text_;
   int64_t index_ = 0;
   int64_t lineno_ = 0;
@@ -238,8 +261,9 @@ class AbstractParser {
       AbstractModule<EvalT>* module);
 
   // Pops a name token and returns its contents or gives an error status if a
-  // name token is not immediately present in the stream.
-  absl::StatusOr<std::string> PopNameOrError();
+  // name token is not immediately present in the stream. The returned view is
+  // into the scanned text.
+  absl::StatusOr<std::string_view> PopNameOrError();
 
   // Pops a name token and returns its value or gives an error status if a
   // number token is not immediately present in the stream.  The overload
@@ -251,9 +275,10 @@ class AbstractParser {
   // Pops either a name or number token or returns an error.  The overload
   // accepting a width parameter sets that parameter to the bit width of the
   // parsed number, if a number was parsed; otherwise, width is not modified.
-  absl::StatusOr<std::variant<std::string, int64_t>> PopNameOrNumberOrError();
-  absl::StatusOr<std::variant<std::string, int64_t>> PopNameOrNumberOrError(
-      size_t& width);
+  absl::StatusOr<std::variant<std::string_view, int64_t>>
+  PopNameOrNumberOrError();
+  absl::StatusOr<std::variant<std::string_view, int64_t>>
+  PopNameOrNumberOrError(size_t& width);
 
   // Drops a token of kind target from the head of the stream or gives an error
   // status.
@@ -292,7 +317,7 @@ class AbstractParser {
 using Parser = AbstractParser<>;
 
 template <typename EvalT>
-absl::StatusOr<std::string> AbstractParser<EvalT>::PopNameOrError() {
+absl::StatusOr<std::string_view> AbstractParser<EvalT>::PopNameOrError() {
   XLS_ASSIGN_OR_RETURN(Token token, scanner_->Pop());
   if (token.kind == TokenKind::kName) {
     return token.value;
@@ -342,9 +367,9 @@ absl::StatusOr<int64_t> AbstractParser<EvalT>::PopNumberOrError(size_t& width) {
 
     int64_t result;
     if (!absl::SimpleAtoi(token.value, &result)) {
-      return absl::InternalError(
-          "Number token's value cannot be parsed as an int64_t: " +
-          token.value);
+      return absl::InternalError(absl::StrCat(
+          "Number token's value cannot be parsed as an int64_t: ",
+          token.value));
     }
     // Size field defaults to 32 when not explicitly specified.
     width = 32;
@@ -361,7 +386,7 @@ absl::StatusOr<int64_t> AbstractParser<EvalT>::PopNumberOrError() {
 }
 
 template <typename EvalT>
-absl::StatusOr<std::variant<std::string, int64_t>>
+absl::StatusOr<std::variant<std::string_view, int64_t>>
 AbstractParser<EvalT>::PopNameOrNumberOrError(size_t& width) {
   TokenKind kind = scanner_->Peek()->kind;
   if (kind == TokenKind::kName) {
@@ -375,7 +400,7 @@ AbstractParser<EvalT>::PopNameOrNumberOrError(size_t& width) {
 }
 
 template <typename EvalT>
-absl::StatusOr<std::variant<std::string, int64_t>>
+absl::StatusOr<std::variant<std::string_view, int64_t>>
 AbstractParser<EvalT>::PopNameOrNumberOrError() {
   size_t width;
   return PopNameOrNumberOrError(width);
@@ -405,8 +430,8 @@ AbstractParser<EvalT>::PopParenNameList() {
       XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
       break;
     }
-    XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
-    results.push_back(name);
+    XLS_ASSIGN_OR_RETURN(std::string_view name, PopNameOrError());
+    results.push_back(std::string(name));
     must_end = !TryDropToken(TokenKind::kComma);
   }
   return results;
@@ -426,7 +451,7 @@ absl::Status AbstractParser<EvalT>::DropKeywordOrError(
 template <typename EvalT>
 absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*>
 AbstractParser<EvalT>::ParseCellModule(AbstractNetlist<EvalT>& netlist) {
-  XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
+  XLS_ASSIGN_OR_RETURN(std::string_view name, PopNameOrError());
   auto maybe_module = netlist.MaybeGetModule(name);
   if (maybe_module.has_value()) {
     return maybe_module.value()->AsCellLibraryEntry();
@@ -434,10 +459,10 @@ AbstractParser<EvalT>::ParseCellModule(AbstractNetlist<EvalT>& netlist) {
   if (name == "SB_LUT4") {
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kStartParams));
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kDot));
-    XLS_ASSIGN_OR_RETURN(std::string param_name, PopNameOrError());
+    XLS_ASSIGN_OR_RETURN(std::string_view param_name, PopNameOrError());
     if (param_name != "LUT_INIT") {
-      return absl::InvalidArgumentError(
-          "Expected a single .LUT_INIT named parameter, got: " + param_name);
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Expected a single .LUT_INIT named parameter, got: ", param_name));
     }
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenParen));
     XLS_ASSIGN_OR_RETURN(int64_t lut_mask, PopNumberOrError());
@@ -445,24 +470,24 @@ AbstractParser<EvalT>::ParseCellModule(AbstractNetlist<EvalT>& netlist) {
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
     return netlist.GetOrCreateLut4CellEntry(lut_mask, zero_, one_);
   }
-  return cell_library_->GetEntry(name);
+  return cell_library_->GetOrLoadEntry(name);
 }
 
 template <typename EvalT>
 absl::StatusOr<AbstractNetRef<EvalT>> AbstractParser<EvalT>::ParseNetRef(
     AbstractModule<EvalT>* module) {
-  using TokenT = std::variant<std::string, int64_t>;
+  using TokenT = std::variant<std::string_view, int64_t>;
   XLS_ASSIGN_OR_RETURN(TokenT token, PopNameOrNumberOrError());
   if (std::holds_alternative<int64_t>(token)) {
     int64_t value = std::get<int64_t>(token);
     return module->AddOrResolveNumber(value);
   }
 
-  std::string name = std::get<std::string>(token);
+  std::string_view name = std::get<std::string_view>(token);
   if (TryDropToken(TokenKind::kOpenBracket)) {
     XLS_ASSIGN_OR_RETURN(int64_t index, PopNumberOrError());
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseBracket));
-    absl::StrAppend(&name, "[", index, "]");
+    return module->ResolveNet(absl::StrCat(name, "[", index, "]"));
   }
   return module->ResolveNet(name);
 }
@@ -475,21 +500,24 @@ absl::Status AbstractParser<EvalT>::ParseInstance(
 
   XLS_ASSIGN_OR_RETURN(const AbstractCellLibraryEntry<EvalT>* cle,
                        ParseCellModule(netlist));
-  XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
+  XLS_ASSIGN_OR_RETURN(std::string_view name, PopNameOrError());
   XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenParen));
   // LRM 23.3.2 Calls these "named parameter assignments".
   absl::flat_hash_map<std::string, AbstractNetRef<EvalT>>
       named_parameter_assignments;
   while (true) {
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kDot));
-    XLS_ASSIGN_OR_RETURN(std::string pin_name, PopNameOrError());
+    XLS_ASSIGN_OR_RETURN(std::string_view pin_name, PopNameOrError());
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenParen));
     XLS_ASSIGN_OR_RETURN(AbstractNetRef<EvalT> net, ParseNetRef(module));
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
     XLS_VLOG(3) << "Adding named parameter assignment: " << pin_name;
-    bool is_new = named_parameter_assignments.insert({pin_name, net}).second;
+    bool is_new =
+        named_parameter_assignments.try_emplace(std::string(pin_name), net)
+            .second;
     if (!is_new) {
-      return absl::InvalidArgumentError("Duplicate port seen: " + pin_name);
+      return absl::InvalidArgumentError(
+          absl::StrCat("Duplicate port seen: ", pin_name));
     }
     if (!TryDropToken(TokenKind::kComma)) {
       break;
@@ -580,9 +608,9 @@ template <typename EvalT>
 absl::Status AbstractParser<EvalT>::ParseNetDecl(AbstractModule<EvalT>* module,
                                                  NetDeclKind kind) {
   XLS_ASSIGN_OR_RETURN(auto range, ParseOptionalRange());
-  std::vector<std::string> names;
+  std::vector<std::string_view> names;
   do {
-    XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
+    XLS_ASSIGN_OR_RETURN(std::string_view name, PopNameOrError());
     names.push_back(name);
   } while (TryDropToken(TokenKind::kComma));
 
@@ -595,7 +623,7 @@ absl::Status AbstractParser<EvalT>::ParseNetDecl(AbstractModule<EvalT>* module,
         "Multiple declarations for a ranged net is not yet supported.");
   }
 
-  for (const std::string& name : names) {
+  for (std::string_view name : names) {
     switch (kind) {
       case NetDeclKind::kInput:
       case NetDeclKind::kOutput:
@@ -623,12 +651,12 @@ absl::Status AbstractParser<EvalT>::ParseOneEntryOfAssignDecl(
     AbstractModule<EvalT>* module, std::vector<std::string>& side,
     bool is_lhs) {
   size_t number_bit_width;
-  using TokenT = std::variant<std::string, int64_t>;
+  using TokenT = std::variant<std::string_view, int64_t>;
   XLS_ASSIGN_OR_RETURN(TokenT token, PopNameOrNumberOrError(number_bit_width));
-  std::string name;
+  std::string_view name;
   std::optional<Range> range = absl::nullopt;
-  if (std::holds_alternative<std::string>(token)) {
-    name = std::get<std::string>(token);
+  if (std::holds_alternative<std::string_view>(token)) {
+    name = std::get<std::string_view>(token);
     XLS_ASSIGN_OR_RETURN(range, ParseOptionalRange(false));
   } else {
     // If we parsed a number, but we're expecting an lvalue, throw an error.
@@ -677,7 +705,7 @@ absl::Status AbstractParser<EvalT>::ParseOneEntryOfAssignDecl(
         high--;
       }
     } else {
-      side.push_back(name);
+      side.push_back(std::string(name));
     }
   }
   return absl::OkStatus();
@@ -755,7 +783,7 @@ template <typename EvalT>
 absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>>
 AbstractParser<EvalT>::ParseModule(AbstractNetlist<EvalT>& netlist) {
   XLS_RETURN_IF_ERROR(DropKeywordOrError("module"));
-  XLS_ASSIGN_OR_RETURN(std::string module_name, PopNameOrError());
+  XLS_ASSIGN_OR_RETURN(std::string_view module_name, PopNameOrError());
   XLS_ASSIGN_OR_RETURN(std::vector<std::string> module_ports,
                        PopParenNameList());
   XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kSemicolon));
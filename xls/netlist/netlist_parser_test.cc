@@ -23,6 +23,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/substitute.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/fake_cell_library.h"
 
@@ -441,6 +442,32 @@ endmodule)";
   TestAssignHelper(m);
 }
 
+TEST(NetlistParserTest, ParseFromMappedFile) {
+  std::string netlist = R"(module main(i, o);
+  input i;
+  output o;
+  wire i_n;
+  INV inv_0(.A(i), .ZN(i_n));
+  assign o = i_n;
+endmodule)";
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp_file,
+                           TempFile::CreateWithContent(netlist, ".v"));
+  XLS_ASSERT_OK_AND_ASSIGN(Scanner scanner,
+                           Scanner::FromFile(temp_file.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef net, m->ResolveNet("i_n"));
+  EXPECT_EQ(net->name(), "i_n");
+  XLS_ASSERT_OK_AND_ASSIGN(Cell * cell, m->ResolveCell("inv_0"));
+  EXPECT_EQ(cell->name(), "inv_0");
+}
+
+TEST(NetlistParserTest, ScannerFromMissingFile) {
+  EXPECT_FALSE(Scanner::FromFile("/does/not/exist.v").ok());
+}
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
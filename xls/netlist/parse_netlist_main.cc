@@ -23,6 +23,11 @@
 #include "xls/netlist/netlist_parser.h"
 
 ABSL_FLAG(bool, show_clusters, false, "Show the logic clusters found.");
+ABSL_FLAG(int64_t, cluster_threads, 1,
+          "Number of threads to use to find the logic clusters.");
+ABSL_FLAG(std::string, clusters_path, "",
+          "If set, writes the logic clusters found to this path as a "
+          "LogicCloudsProto text proto, for reuse by later analyses.");
 
 namespace xls {
 namespace {
@@ -38,8 +43,8 @@ absl::Status RealMain(std::string_view netlist_path,
                          netlist::CellLibrary::FromProto(cell_library_proto));
   }
 
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(netlist::rtl::Scanner scanner,
+                       netlist::rtl::Scanner::FromFile(netlist_path));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<netlist::rtl::Netlist> netlist,
       netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
@@ -60,12 +65,17 @@ absl::Status RealMain(std::string_view netlist_path,
               << std::endl;
   }
 
-  std::vector<netlist::rtl::Cluster> clusters =
-      netlist::rtl::FindLogicClouds(*module);
+  std::vector<netlist::rtl::Cluster> clusters = netlist::rtl::FindLogicClouds(
+      *module, /*include_vacuous=*/false, absl::GetFlag(FLAGS_cluster_threads));
   std::cout << "logic clusters: " << clusters.size() << std::endl;
   if (absl::GetFlag(FLAGS_show_clusters)) {
     std::cout << netlist::rtl::ClustersToString(clusters) << std::endl;
   }
+  if (!absl::GetFlag(FLAGS_clusters_path).empty()) {
+    XLS_RETURN_IF_ERROR(
+        SetTextProtoFile(absl::GetFlag(FLAGS_clusters_path),
+                         netlist::rtl::ClustersToProto(*module, clusters)));
+  }
 
   return absl::OkStatus();
 }
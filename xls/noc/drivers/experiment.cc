@@ -14,8 +14,14 @@
 
 #include "xls/noc/drivers/experiment.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/thread.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/global_routing_table.h"
 #include "xls/noc/simulation/network_graph.h"
@@ -177,9 +183,8 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   simulator.RegisterPostCycleService(link_monitor);
 
   // Run simulation.
-  for (int64_t i = 0; i < total_simulation_cycle_count_; ++i) {
-    XLS_RET_CHECK_OK(simulator.RunCycle());
-  }
+  simulator.SetFastForwardIdleCycles(fast_forward_idle_cycles_);
+  XLS_RET_CHECK_OK(simulator.RunCycles(total_simulation_cycle_count_));
 
   // Obtain metrics.  For now, the runner will measure traffic rate
   // for each flow, and sink. It will also collect the latency metrics from the
@@ -317,4 +322,43 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   return experiment_data;
 }
 
+absl::StatusOr<std::vector<ExperimentData>> Experiment::RunAllSteps(
+    int64_t thread_count) const {
+  XLS_RET_CHECK_GE(thread_count, 1);
+  int64_t step_count = GetStepCount();
+  int64_t worker_count = std::min(thread_count, step_count);
+
+  std::vector<ExperimentData> experiment_data(step_count);
+  std::vector<absl::Status> statuses(step_count);
+
+  // Worker i runs steps i, i + worker_count, ...
+  auto run_steps = [&](int64_t worker) {
+    for (int64_t step = worker; step < step_count; step += worker_count) {
+      absl::StatusOr<ExperimentData> data = RunStep(step);
+      if (!data.ok()) {
+        statuses[step] = data.status();
+        continue;
+      }
+      experiment_data[step] = std::move(data).value();
+    }
+  };
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t worker = 1; worker < worker_count; ++worker) {
+    threads.push_back(std::make_unique<Thread>(
+        [&run_steps, worker]() { run_steps(worker); }));
+  }
+  if (worker_count > 0) {
+    run_steps(0);
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return experiment_data;
+}
+
 }  // namespace xls::noc
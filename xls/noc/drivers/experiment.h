@@ -139,6 +139,15 @@ class ExperimentMetrics {
   // Prints out the metrics and values stored.
   absl::Status DebugDump() const;
 
+  bool operator==(const ExperimentMetrics& other) const {
+    return float_metrics_ == other.float_metrics_ &&
+           integer_integer_map_metrics_ == other.integer_integer_map_metrics_ &&
+           integer_metrics_ == other.integer_metrics_;
+  }
+  bool operator!=(const ExperimentMetrics& other) const {
+    return !(*this == other);
+  }
+
  private:
   absl::btree_map<std::string, double> float_metrics_;
   absl::btree_map<std::string, absl::flat_hash_map<int64_t, int64_t>>
@@ -242,6 +251,13 @@ class ExperimentRunner {
     return *this;
   }
 
+  // Skip simulating cycles in which the network is idle and no traffic is
+  // injected (see NocSimulator::RunCycles). Metrics are unaffected.
+  ExperimentRunner& SetFastForwardIdleCycles(bool enabled) {
+    fast_forward_idle_cycles_ = enabled;
+    return *this;
+  }
+
   int64_t GetSimulationCycleCount() const {
     return total_simulation_cycle_count_;
   }
@@ -249,11 +265,13 @@ class ExperimentRunner {
 
   int16_t GetSeed() const { return seed_; }
   std::string_view GetTrafficMode() const { return mode_name_; }
+  bool GetFastForwardIdleCycles() const { return fast_forward_idle_cycles_; }
 
  private:
   int64_t total_simulation_cycle_count_;
   int64_t cycle_time_in_ps_;
   int16_t seed_;
+  bool fast_forward_idle_cycles_ = false;
 
   std::string mode_name_;
 };
@@ -286,6 +304,15 @@ class Experiment {
                                 std::move(distributed_routing_table_builder));
   }
 
+  // Create the configs and run the simulations for all steps, using up to
+  // `thread_count` threads, and return the data of each step in step order.
+  //
+  // As steps are independent, each one is run with its own copy of the
+  // runner, network graph and simulator, so the results are identical to
+  // those of calling RunStep() for each step in turn.
+  absl::StatusOr<std::vector<ExperimentData>> RunAllSteps(
+      int64_t thread_count = 1) const;
+
   // Get the configuration for step N.
   absl::StatusOr<ExperimentConfig> GetConfigForStep(int64_t step) const {
     XLS_RET_CHECK(step >= 0 && step < GetStepCount());
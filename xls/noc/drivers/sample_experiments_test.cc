@@ -19,6 +19,7 @@
 #include "absl/strings/str_format.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
+#include "xls/noc/drivers/experiment.h"
 #include "xls/noc/drivers/experiment_factory.h"
 
 namespace xls::noc {
@@ -212,5 +213,29 @@ TEST(SampleExperimentsTest, AggregateTreeTest) {
   }
 }
 
+TEST(SampleExperimentsTest, RunAllStepsMatchesRunStep) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+
+  int64_t step_count = experiment.GetStepCount();
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ExperimentData> experiment_data,
+                           experiment.RunAllSteps(/*thread_count=*/3));
+  ASSERT_EQ(experiment_data.size(), step_count);
+
+  for (int64_t i = 0; i < step_count; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(ExperimentData expected, experiment.RunStep(i));
+    EXPECT_EQ(experiment_data.at(i).metrics, expected.metrics) << "step " << i;
+    EXPECT_EQ(experiment_data.at(i).info.GetLinkToPacketCountMap(),
+              expected.info.GetLinkToPacketCountMap())
+        << "step " << i;
+  }
+
+  EXPECT_FALSE(experiment.RunAllSteps(/*thread_count=*/0).ok());
+}
+
 }  // namespace
 }  // namespace xls::noc
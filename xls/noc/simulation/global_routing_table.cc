@@ -267,6 +267,70 @@ void DistributedRoutingTable::AllocateTableForNetwork(NetworkId network_id,
   routing_tables_[network_index].resize(component_count);
 }
 
+absl::Status DistributedRoutingTableBuilderBase::BuildDenseRoutingTable(
+    NetworkId network_id, DistributedRoutingTable* routing_table) {
+  NetworkManager* network_manager = routing_table->network_manager_;
+  const PortIndexMap& port_indices = routing_table->GetPortIndices();
+  int64_t destination_count =
+      routing_table->GetSinkIndices().NetworkComponentCount();
+  routing_table->dense_destination_count_ = destination_count;
+
+  int64_t network_index = network_id.id();
+  if (routing_table->dense_port_routes_.size() <= network_index) {
+    routing_table->dense_port_routes_.resize(network_index + 1);
+  }
+  std::vector<std::vector<DistributedRoutingTable::DensePortRoutes>>&
+      dense_port_routes = routing_table->dense_port_routes_[network_index];
+  dense_port_routes.clear();
+  dense_port_routes.resize(
+      routing_table->routing_tables_[network_index].size());
+
+  for (const NetworkComponentId& nc_id :
+       network_manager->GetNetwork(network_id).GetNetworkComponentIds()) {
+    NetworkComponent& nc = network_manager->GetNetworkComponent(nc_id);
+    const DistributedRoutingTable::RouterRoutingTable& table =
+        routing_table->GetRoutingTable(nc_id);
+    if (nc.kind() != NetworkComponentKind::kRouter || table.routes.empty()) {
+      continue;
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t input_port_count,
+                         port_indices.InputPortCount(nc_id));
+    std::vector<DistributedRoutingTable::DensePortRoutes>& ports =
+        dense_port_routes.at(nc_id.id());
+    ports.resize(input_port_count);
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          PortId port_id,
+          port_indices.GetPortByIndex(nc_id, PortDirection::kInput, i));
+      const std::vector<DistributedRoutingTable::PortRoutingList>& vc_routes =
+          table.routes.at(port_id.id());
+
+      int64_t offset = routing_table->dense_routes_.size();
+      ports[i] = DistributedRoutingTable::DensePortRoutes{
+          offset, static_cast<int64_t>(vc_routes.size())};
+      routing_table->dense_routes_.resize(
+          offset + vc_routes.size() * destination_count,
+          PortIndexAndVCIndex{-1, -1});
+
+      for (int64_t vc = 0; vc < vc_routes.size(); ++vc) {
+        for (const std::pair<int64_t, PortAndVCIndex>& hop : vc_routes[vc]) {
+          XLS_RET_CHECK_LT(hop.first, destination_count);
+          XLS_ASSIGN_OR_RETURN(
+              int64_t output_port_index,
+              port_indices.GetPortIndex(hop.second.port_id_,
+                                        PortDirection::kOutput));
+          routing_table->dense_routes_[offset + vc * destination_count +
+                                       hop.first] =
+              PortIndexAndVCIndex{output_port_index, hop.second.vc_index_};
+        }
+      }
+    }
+  }
+
+  return absl::OkStatus();
+}
+
 absl::Status DistributedRoutingTableBuilderBase::BuildNetworkInterfaceIndices(
     NetworkId network_id, DistributedRoutingTable* routing_table) {
   NetworkComponentIndexMapBuilder source_index_builder;
@@ -360,6 +424,7 @@ DistributedRoutingTableBuilderForTrees::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(BuildDenseRoutingTable(network_id, &routing_table));
 
   return routing_table;
 }
@@ -489,6 +554,7 @@ DistributedRoutingTableBuilderForMultiplePaths::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(BuildDenseRoutingTable(network_id, &routing_table));
 
   return routing_table;
 }
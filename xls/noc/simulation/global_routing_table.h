@@ -19,7 +19,14 @@
 #ifndef XLS_NOC_SIMULATION_GLOBAL_ROUTING_TABLE_H_
 #define XLS_NOC_SIMULATION_GLOBAL_ROUTING_TABLE_H_
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/indexer.h"
 #include "xls/noc/simulation/network_graph.h"
@@ -100,8 +107,39 @@ class DistributedRoutingTable {
   absl::StatusOr<PortAndVCIndex> GetRouterOutputPortByIndex(
       PortAndVCIndex from, int64_t destination_index);
 
-  // TODO(tedhong): 2020-01-25 Add indexer for input/output ports of a router
-  //                          and support routing directly via indices.
+  // Given a router, the index (see GetPortIndices) of an input port, a local
+  // virtual channel, and final destination index (sink), return the index of
+  // the output port and the vc the data should go out on.
+  //
+  // Unlike the above, this is a lookup in a dense table without hashing
+  // and so is meant for use in the simulator.
+  absl::StatusOr<PortIndexAndVCIndex> GetRouterOutputPortIndexAndVCIndex(
+      NetworkComponentId router, PortIndexAndVCIndex from,
+      int64_t destination_index) const {
+    if (router.network() < dense_port_routes_.size() &&
+        router.id() < dense_port_routes_[router.network()].size()) {
+      const std::vector<DensePortRoutes>& ports =
+          dense_port_routes_[router.network()][router.id()];
+      if (from.port_index_ >= 0 && from.port_index_ < ports.size() &&
+          from.vc_index_ >= 0 &&
+          from.vc_index_ < ports[from.port_index_].vc_count &&
+          destination_index >= 0 &&
+          destination_index < dense_destination_count_) {
+        const PortIndexAndVCIndex& to =
+            dense_routes_[ports[from.port_index_].offset +
+                          from.vc_index_ * dense_destination_count_ +
+                          destination_index];
+        if (to.port_index_ >= 0) {
+          return to;
+        }
+      }
+    }
+    return absl::NotFoundError(absl::StrFormat(
+        "Unable to find route from router %x input port index %d vc %d to "
+        "destination index %d",
+        router.AsUInt64(), from.port_index_, from.vc_index_,
+        destination_index));
+  }
 
   // Returns mapping of vc params to local indicies.
   const VirtualChannelIndexMap& GetVirtualChannelIndices() {
@@ -129,6 +167,15 @@ class DistributedRoutingTable {
   // number of components in a network.
   void AllocateTableForNetwork(NetworkId network_id, int64_t component_count);
 
+  // Location of the routes of a router input port within dense_routes_.
+  //
+  // The route for vc index v and destination index d is at
+  //   dense_routes_[offset + v * dense_destination_count_ + d]
+  struct DensePortRoutes {
+    int64_t offset;
+    int64_t vc_count;
+  };
+
   // Get (and create if necessary) routing table associated for a component.
   RouterRoutingTable& GetRoutingTable(NetworkComponentId nc_id) {
     return routing_tables_[nc_id.network()][nc_id.id()];
@@ -157,6 +204,17 @@ class DistributedRoutingTable {
   // ie. routing table for ComponentId id is
   //  routing_tables_[id.network()][id.id()]
   std::vector<std::vector<RouterRoutingTable>> routing_tables_;
+
+  // Dense copy of routing_tables_ built from the routing lists once they are
+  // complete (see DistributedRoutingTableBuilderBase::BuildDenseRoutingTable)
+  // in terms of port indices.
+  //
+  // The routes of the input port with index i of component id are at
+  //  dense_port_routes_[id.network()][id.id()][i]
+  // Output ports with index -1 denote a missing route.
+  std::vector<std::vector<std::vector<DensePortRoutes>>> dense_port_routes_;
+  std::vector<PortIndexAndVCIndex> dense_routes_;
+  int64_t dense_destination_count_ = 0;
 };
 
 // Abstract base class for distributed routing table builder.
@@ -176,6 +234,11 @@ class DistributedRoutingTableBuilderBase {
   // Setup port_indices_ and vc_indices_ for network.
   virtual absl::Status BuildPortAndVirtualChannelIndices(
       NetworkId network_id, DistributedRoutingTable* routing_table);
+
+  // Setup the dense routing table of the network from its routing lists.
+  // Must be called once the routing lists are complete.
+  virtual absl::Status BuildDenseRoutingTable(
+      NetworkId network_id, DistributedRoutingTable* routing_table);
 };
 
 // Build a routing table given a network with a tree topology.
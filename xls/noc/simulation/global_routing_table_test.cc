@@ -14,6 +14,9 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/logging/logging.h"
@@ -621,6 +624,88 @@ TEST(GlobalRoutingTableTest, MultiplePathsBetweenRoutersWithLoop1) {
                                               linkbo1_id, recvport3));
 }
 
+// Checks that the dense routing table agrees with the routing lists for
+// every router input port, vc and destination.
+void ExpectDenseRoutesMatchRoutingLists(DistributedRoutingTable& routing_table,
+                                        NetworkManager& graph) {
+  const PortIndexMap& port_indices = routing_table.GetPortIndices();
+  int64_t destination_count =
+      routing_table.GetSinkIndices().NetworkComponentCount();
+  int64_t route_count = 0;
+  for (NetworkComponentId nc_id :
+       graph.GetNetwork(graph.GetNetworkIds()[0]).GetNetworkComponentIds()) {
+    if (graph.GetNetworkComponent(nc_id).kind() !=
+        NetworkComponentKind::kRouter) {
+      continue;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(int64_t input_port_count,
+                             port_indices.InputPortCount(nc_id));
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          PortId port_id,
+          port_indices.GetPortByIndex(nc_id, PortDirection::kInput, i));
+      XLS_ASSERT_OK_AND_ASSIGN(
+          int64_t vc_count,
+          routing_table.GetVirtualChannelIndices().VirtualChannelCount(
+              port_id));
+      for (int64_t vc = 0; vc < std::max<int64_t>(vc_count, 1); ++vc) {
+        for (int64_t d = 0; d < destination_count; ++d) {
+          absl::StatusOr<PortAndVCIndex> expected =
+              routing_table.GetRouterOutputPortByIndex({port_id, vc}, d);
+          absl::StatusOr<PortIndexAndVCIndex> actual =
+              routing_table.GetRouterOutputPortIndexAndVCIndex(nc_id, {i, vc},
+                                                               d);
+          ASSERT_EQ(actual.ok(), expected.ok());
+          if (!expected.ok()) {
+            continue;
+          }
+          XLS_ASSERT_OK_AND_ASSIGN(
+              int64_t expected_port_index,
+              port_indices.GetPortIndex(expected->port_id_,
+                                        PortDirection::kOutput));
+          EXPECT_EQ(actual->port_index_, expected_port_index);
+          EXPECT_EQ(actual->vc_index_, expected->vc_index_);
+          ++route_count;
+        }
+      }
+    }
+  }
+  EXPECT_GT(route_count, 0);
+}
+
+TEST(GlobalRoutingTableTest, DenseRoutesForTrees) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLoop000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+  ExpectDenseRoutesMatchRoutingLists(routing_table, graph);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId routera_id,
+      FindNetworkComponentByName("RouterA", graph, params));
+  EXPECT_FALSE(
+      routing_table.GetRouterOutputPortIndexAndVCIndex(routera_id, {0, 0}, 99)
+          .ok());
+}
+
+TEST(GlobalRoutingTableTest, DenseRoutesForMultiplePaths) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLoop001(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForMultiplePaths route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+  ExpectDenseRoutesMatchRoutingLists(routing_table, graph);
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
@@ -14,6 +14,10 @@
 
 #include "xls/noc/simulation/noc_traffic_injector.h"
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/logging/logging.h"
@@ -72,6 +76,22 @@ absl::Status NocTrafficInjector::RunCycle() {
   return absl::OkStatus();
 }
 
+int64_t NocTrafficInjector::GetNextActiveCycle() const {
+  int64_t next_cycle = std::numeric_limits<int64_t>::max();
+  for (const std::unique_ptr<TrafficModel>& model : traffic_models_) {
+    next_cycle = std::min(next_cycle, model->GetNextPacketCycle(cycle_));
+  }
+  return next_cycle;
+}
+
+absl::Status NocTrafficInjector::SkipCycles(int64_t cycle_count) {
+  XLS_RET_CHECK_GE(cycle_count, 0);
+  XLS_RET_CHECK_LT(cycle_ + cycle_count, GetNextActiveCycle())
+      << "Unable to skip cycles in which packets are injected.";
+  cycle_ += cycle_count;
+  return absl::OkStatus();
+}
+
 namespace {
 
 // Function that calls run_action(i, j) for each flow and network_component
@@ -45,6 +45,13 @@ class NocTrafficInjector {
   // on the current_cycle.
   absl::Status RunCycle();
 
+  // Returns the first cycle after the last cycle run in which a flow has
+  // packets to inject.
+  int64_t GetNextActiveCycle() const;
+
+  // Skips cycle_count cycles, none of which may have packets to inject.
+  absl::Status SkipCycles(int64_t cycle_count);
+
   // Provides the interface between this object and the NOC simulator.
   void SetSimulatorShim(NocSimulatorTrafficServiceShim& simulator) {
     simulator_ = &simulator;
@@ -255,6 +262,14 @@ class NocTrafficInjectorService : public NocSimulatorServiceShim {
 
   virtual absl::Status RunCycle() override { return injector_->RunCycle(); }
 
+  int64_t GetNextActiveCycle(int64_t cycle) const override {
+    return injector_->GetNextActiveCycle();
+  }
+
+  absl::Status SkipCycles(int64_t cycle_count) override {
+    return injector_->SkipCycles(cycle_count);
+  }
+
  private:
   NocTrafficInjector* injector_;
 };
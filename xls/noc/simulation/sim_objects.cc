@@ -14,12 +14,21 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <algorithm>
+#include <deque>
+#include <memory>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
@@ -41,7 +50,7 @@ class SimplePipelineImpl {
  public:
   SimplePipelineImpl(int64_t stage_count, DataTimePhitT& from_channel,
                      DataTimePhitT& to_channel,
-                     std::queue<DataTimePhitT>& state,
+                     std::deque<DataTimePhitT>& state,
                      int64_t& internal_propagated_cycle)
       : stage_count_(stage_count),
         from_(from_channel),
@@ -56,7 +65,7 @@ class SimplePipelineImpl {
   DataTimePhitT& from_;
   DataTimePhitT& to_;
   // TODO(vmirian) 09-07-21 Optimize to select flit data and its metadata
-  std::queue<DataTimePhitT>& state_;
+  std::deque<DataTimePhitT>& state_;
   int64_t& internal_propagated_cycle_;
 };
 
@@ -94,7 +103,7 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
         to_.flit = state_.front().flit;
         to_.cycle = current_cycle;
         to_.metadata = state_.front().metadata;
-        state_.pop();
+        state_.pop_front();
       } else {
         to_.flit.type = FlitType::kInvalid;
         to_.flit.data = Bits(32);
@@ -107,7 +116,7 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
     }
 
     if (from_.cycle == current_cycle) {
-      state_.push(from_);
+      state_.push_back(from_);
       XLS_VLOG(2) << absl::StreamFormat("... link received data %s type %d",
                                         from_.flit.data.ToString(),
                                         from_.flit.type);
@@ -122,8 +131,155 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
   return internal_propagated_cycle_ == current_cycle;
 }
 
+// Returns true if the flit carries no data, i.e., is a bubble.
+bool IsIdleFlit(const DataFlit& flit) {
+  return flit.type == FlitType::kInvalid;
+}
+
+// Returns true if the flit carries no credits.
+bool IsIdleFlit(const MetadataFlit& flit) {
+  return flit.type == FlitType::kInvalid || flit.data.IsZero();
+}
+
 }  // namespace
 
+void DataFlitQueue::Initialize(NocSimulator& simulator,
+                               int64_t max_queue_size) {
+  store_start_ = simulator.GetNewDataFlitStore(max_queue_size);
+  max_queue_size_ = max_queue_size;
+  front_ = 0;
+  size_ = 0;
+}
+
+const DataFlitQueueElement& DataFlitQueue::front(
+    NocSimulator& simulator) const {
+  XLS_CHECK_GT(size_, 0);
+  return simulator.GetDataFlitStore(store_start_, max_queue_size_)[front_];
+}
+
+void DataFlitQueue::push(NocSimulator& simulator,
+                         const DataFlitQueueElement& element) {
+  XLS_CHECK_LT(size_, max_queue_size_);
+  int64_t back = (front_ + size_) % max_queue_size_;
+  simulator.GetDataFlitStore(store_start_, max_queue_size_)[back] = element;
+  ++size_;
+}
+
+void DataFlitQueue::pop() {
+  XLS_CHECK_GT(size_, 0);
+  front_ = (front_ + 1) % max_queue_size_;
+  --size_;
+}
+
+// Ticks the components of a phase of NocSimulator::Tick on a fixed set of
+// threads, which persist across ticks as there are many ticks per cycle.
+// The calling thread ticks the first group of components itself.
+class TickWorkerPool {
+ public:
+  TickWorkerPool(NocSimulator& simulator, int64_t thread_count)
+      : simulator_(simulator), thread_count_(thread_count) {
+    for (int64_t worker = 1; worker < thread_count_; ++worker) {
+      threads_.push_back(
+          std::make_unique<Thread>([this, worker]() { WorkerLoop(worker); }));
+    }
+  }
+
+  ~TickWorkerPool() {
+    {
+      absl::MutexLock lock(&mutex_);
+      stop_ = true;
+    }
+    for (std::unique_ptr<Thread>& thread : threads_) {
+      thread->Join();
+    }
+  }
+
+  // Ticks all of `components`, which must not share connections, and returns
+  // whether all of them converged.
+  bool TickAll(absl::Span<SimNetworkComponentBase* const> components) {
+    {
+      absl::MutexLock lock(&mutex_);
+      components_ = components;
+      converged_ = true;
+      pending_ = thread_count_ - 1;
+      ++generation_;
+    }
+    bool converged = TickGroup(0, components);
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        +[](int64_t* pending) { return *pending == 0; }, &pending_));
+    return converged && converged_;
+  }
+
+ private:
+  // Ticks the `worker`-th of thread_count_ contiguous groups of `components`.
+  bool TickGroup(int64_t worker,
+                 absl::Span<SimNetworkComponentBase* const> components) {
+    int64_t begin = components.size() * worker / thread_count_;
+    int64_t end = components.size() * (worker + 1) / thread_count_;
+    bool converged = true;
+    for (int64_t i = begin; i < end; ++i) {
+      converged &= components[i]->Tick(simulator_);
+    }
+    return converged;
+  }
+
+  void WorkerLoop(int64_t worker) {
+    int64_t seen_generation = 0;
+    while (true) {
+      absl::Span<SimNetworkComponentBase* const> components;
+      {
+        absl::MutexLock lock(&mutex_);
+        auto ready = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+          return stop_ || generation_ != seen_generation;
+        };
+        mutex_.Await(absl::Condition(&ready));
+        if (stop_) {
+          return;
+        }
+        seen_generation = generation_;
+        components = components_;
+      }
+      bool converged = TickGroup(worker, components);
+      absl::MutexLock lock(&mutex_);
+      converged_ &= converged;
+      --pending_;
+    }
+  }
+
+  NocSimulator& simulator_;
+  const int64_t thread_count_;
+  std::vector<std::unique_ptr<Thread>> threads_;
+
+  absl::Mutex mutex_;
+  bool stop_ ABSL_GUARDED_BY(mutex_) = false;
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t pending_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool converged_ ABSL_GUARDED_BY(mutex_) = true;
+  absl::Span<SimNetworkComponentBase* const> components_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+NocSimulator::NocSimulator()
+    : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+
+NocSimulator::~NocSimulator() = default;
+
+absl::Status NocSimulator::Initialize(NetworkManager& mgr,
+                                      NocParameters& params,
+                                      DistributedRoutingTable& routing,
+                                      NetworkId network) {
+  mgr_ = &mgr;
+  params_ = &params;
+  routing_ = &routing;
+  network_ = network;
+  cycle_ = -1;
+  tick_phases_.clear();
+  tick_workers_.reset();
+
+  return CreateSimulationObjects(network);
+}
+
 absl::Status NocSimulator::CreateSimulationObjects(NetworkId network) {
   Network& network_obj = mgr_->GetNetwork(network);
 
@@ -292,7 +448,150 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
   return absl::OkStatus();
 }
 
+absl::Status NocSimulator::RunCycles(int64_t cycle_count, int64_t max_ticks) {
+  XLS_RET_CHECK_GE(cycle_count, 0);
+  int64_t last_cycle = cycle_ + cycle_count;
+  while (cycle_ < last_cycle) {
+    // Cycle 0 sends the initial credits, so is never skipped.
+    if (fast_forward_idle_cycles_ && cycle_ >= 0 && IsIdle()) {
+      int64_t next_cycle = last_cycle;
+      for (NocSimulatorServiceShim* svc : pre_cycle_services_) {
+        next_cycle = std::min(next_cycle, svc->GetNextActiveCycle(cycle_));
+      }
+      for (NocSimulatorServiceShim* svc : post_cycle_services_) {
+        next_cycle = std::min(next_cycle, svc->GetNextActiveCycle(cycle_));
+      }
+
+      int64_t skipped = next_cycle - cycle_ - 1;
+      if (skipped > 0) {
+        XLS_VLOG(2) << absl::StreamFormat("*** Skipping idle cycles %d to %d",
+                                          cycle_ + 1, next_cycle - 1);
+        for (NocSimulatorServiceShim* svc : pre_cycle_services_) {
+          XLS_RETURN_IF_ERROR(svc->SkipCycles(skipped));
+        }
+        for (NocSimulatorServiceShim* svc : post_cycle_services_) {
+          XLS_RETURN_IF_ERROR(svc->SkipCycles(skipped));
+        }
+        // Components compare the cycle stamps of their state only for
+        // equality with the current cycle, so they carry on as if the
+        // skipped cycles had been simulated.
+        cycle_ += skipped;
+        skipped_cycle_count_ += skipped;
+      }
+    }
+
+    XLS_RETURN_IF_ERROR(RunCycle(max_ticks));
+  }
+  return absl::OkStatus();
+}
+
+bool NocSimulator::IsIdle() {
+  for (const SimConnectionState& connection : connections_) {
+    if (!IsIdleFlit(connection.forward_channels.flit)) {
+      return false;
+    }
+    for (const TimedMetadataFlit& credit : connection.reverse_channels) {
+      if (!IsIdleFlit(credit.flit)) {
+        return false;
+      }
+    }
+  }
+  for (const SimNetworkInterfaceSrc& nc : network_interface_sources_) {
+    if (!nc.IsIdle()) {
+      return false;
+    }
+  }
+  for (const SimLink& nc : links_) {
+    if (!nc.IsIdle()) {
+      return false;
+    }
+  }
+  for (const SimInputBufferedVCRouter& nc : routers_) {
+    if (!nc.IsIdle()) {
+      return false;
+    }
+  }
+  for (const SimNetworkInterfaceSink& nc : network_interface_sinks_) {
+    if (!nc.IsIdle()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::Status NocSimulator::SetTickThreadCount(int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 1);
+  XLS_RET_CHECK_NE(mgr_, nullptr) << "Simulator is not initialized";
+  tick_workers_.reset();
+  tick_phases_.clear();
+  if (thread_count > 1) {
+    CreateTickPhases();
+    tick_workers_ = std::make_unique<TickWorkerPool>(*this, thread_count);
+  }
+  return absl::OkStatus();
+}
+
+void NocSimulator::CreateTickPhases() {
+  // Greedily puts each component into the first phase none of whose
+  // components share a connection with it, in the order of the sequential
+  // tick.
+  std::vector<SimNetworkComponentBase*> components;
+  for (SimNetworkInterfaceSrc& nc : network_interface_sources_) {
+    components.push_back(&nc);
+  }
+  for (SimLink& nc : links_) {
+    components.push_back(&nc);
+  }
+  for (SimInputBufferedVCRouter& nc : routers_) {
+    components.push_back(&nc);
+  }
+  for (SimNetworkInterfaceSink& nc : network_interface_sinks_) {
+    components.push_back(&nc);
+  }
+
+  // Phases of the components which use each connection so far.
+  std::vector<std::vector<int64_t>> connection_phases(connections_.size());
+  for (SimNetworkComponentBase* component : components) {
+    std::vector<int64_t> connection_indices =
+        component->GetConnectionIndices(*this);
+    int64_t phase = 0;
+    auto conflicts = [&](int64_t phase) {
+      for (int64_t index : connection_indices) {
+        if (std::find(connection_phases[index].begin(),
+                      connection_phases[index].end(),
+                      phase) != connection_phases[index].end()) {
+          return true;
+        }
+      }
+      return false;
+    };
+    while (conflicts(phase)) {
+      ++phase;
+    }
+    for (int64_t index : connection_indices) {
+      connection_phases[index].push_back(phase);
+    }
+    if (phase == tick_phases_.size()) {
+      tick_phases_.emplace_back();
+    }
+    tick_phases_[phase].push_back(component);
+  }
+
+  for (int64_t i = 0; i < tick_phases_.size(); ++i) {
+    XLS_VLOG(1) << absl::StreamFormat("Tick phase %d: %d components", i,
+                                      tick_phases_[i].size());
+  }
+}
+
 bool NocSimulator::Tick() {
+  if (tick_workers_ != nullptr) {
+    bool converged = true;
+    for (const std::vector<SimNetworkComponentBase*>& phase : tick_phases_) {
+      converged &= tick_workers_->TickAll(phase);
+    }
+    return converged;
+  }
+
   // Goes through each simulator object and run atick.
   // Converges when everyone returns True -- that determines new cycle
 
@@ -358,6 +657,22 @@ bool SimNetworkComponentBase::Tick(NocSimulator& simulator) {
   return converged;
 }
 
+bool SimLink::IsIdle() const {
+  for (const TimedDataFlit& stage : forward_data_stages_) {
+    if (!IsIdleFlit(stage.flit)) {
+      return false;
+    }
+  }
+  for (const std::deque<TimedMetadataFlit>& stages : reverse_credit_stages_) {
+    for (const TimedMetadataFlit& stage : stages) {
+      if (!IsIdleFlit(stage.flit)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 int64_t SimLink::GetSourceConnectionIndex() const {
   return src_connection_index_;
 }
@@ -434,6 +749,15 @@ absl::Status SimNetworkInterfaceSrc::InitializeImpl(NocSimulator& simulator) {
   return absl::OkStatus();
 }
 
+bool SimNetworkInterfaceSrc::IsIdle() const {
+  for (int64_t vc = 0; vc < data_to_send_.size(); ++vc) {
+    if (!data_to_send_[vc].empty() || credit_update_[vc].credit != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 absl::Status SimNetworkInterfaceSrc::SendFlitAtTime(TimedDataFlit flit) {
   int64_t vc_index = flit.flit.vc;
 
@@ -461,7 +785,7 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
   input_buffers_.resize(virtual_channel_count);
 
   for (int64_t vc = 0; vc < virtual_channel_count; ++vc) {
-    input_buffers_[vc].max_queue_size = vc_params[vc].GetDepth();
+    input_buffers_[vc].Initialize(simulator, vc_params[vc].GetDepth());
   }
 
   NetworkManager* network_manager = simulator.GetNetworkManager();
@@ -477,6 +801,36 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
 int64_t SimInputBufferedVCRouter::GetUtilizationCycleCount() const {
   return utilization_cycle_count_;
 }
+
+bool SimInputBufferedVCRouter::IsIdle() const {
+  for (int64_t i = 0; i < input_buffers_.size(); ++i) {
+    for (int64_t vc = 0; vc < input_buffers_[i].size(); ++vc) {
+      if (!input_buffers_[i][vc].empty() || input_credit_to_send_[i][vc] != 0) {
+        return false;
+      }
+    }
+  }
+  for (const std::vector<CreditState>& credit_update : credit_update_) {
+    for (const CreditState& credit : credit_update) {
+      if (credit.credit != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::vector<int64_t> SimInputBufferedVCRouter::GetConnectionIndices(
+    NocSimulator& simulator) const {
+  absl::Span<int64_t> inputs = simulator.GetConnectionIndicesStore(
+      input_connection_index_start_, input_connection_count_);
+  absl::Span<int64_t> outputs = simulator.GetConnectionIndicesStore(
+      output_connection_index_start_, output_connection_count_);
+  std::vector<int64_t> indices(inputs.begin(), inputs.end());
+  indices.insert(indices.end(), outputs.begin(), outputs.end());
+  return indices;
+}
+
 absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
   NetworkManager* network_manager = simulator.GetNetworkManager();
   NetworkComponent& nc = network_manager->GetNetworkComponent(id_);
@@ -509,7 +863,7 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
 
     input_buffers_[i].resize(port_param.VirtualChannelCount());
     for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
-      input_buffers_[i][vc].max_queue_size = vc_params[vc].GetDepth();
+      input_buffers_[i][vc].Initialize(simulator, vc_params[vc].GetDepth());
     }
     input_credit_to_send_[i].resize(port_param.VirtualChannelCount());
     if (max_vc_ < port_param.VirtualChannelCount()) {
@@ -711,23 +1065,12 @@ absl::StatusOr<SimInputBufferedVCRouter::PortIndexAndVCIndex>
 SimInputBufferedVCRouter::GetDestinationPortIndexAndVcIndex(
     NocSimulator& simulator, PortIndexAndVCIndex input,
     int64_t destination_index) {
-  DistributedRoutingTable* routes = simulator.GetRoutingTable();
-
-  XLS_ASSIGN_OR_RETURN(PortId input_port,
-                       routes->GetPortIndices().GetPortByIndex(
-                           GetId(), PortDirection::kInput, input.port_index));
-
-  PortAndVCIndex port_from{input_port, input.vc_index};
-
   XLS_ASSIGN_OR_RETURN(
-      PortAndVCIndex port_to,
-      routes->GetRouterOutputPortByIndex(port_from, destination_index));
-
-  XLS_ASSIGN_OR_RETURN(int64_t output_port_index,
-                       routes->GetPortIndices().GetPortIndex(
-                           port_to.port_id_, PortDirection::kOutput));
+      ::xls::noc::PortIndexAndVCIndex output,
+      simulator.GetRoutingTable()->GetRouterOutputPortIndexAndVCIndex(
+          GetId(), {input.port_index, input.vc_index}, destination_index));
 
-  return PortIndexAndVCIndex{output_port_index, port_to.vc_index_};
+  return PortIndexAndVCIndex{output.port_index_, output.vc_index_};
 }
 
 bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
@@ -796,7 +1139,8 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
     if (input.forward_channels.flit.type != FlitType::kInvalid) {
       int64_t vc = input.forward_channels.flit.vc;
-      input_buffers_[i][vc].queue.push(
+      input_buffers_[i][vc].push(
+          simulator,
           {input.forward_channels.flit, input.forward_channels.metadata});
 
       XLS_VLOG(2) << absl::StrFormat(
@@ -815,12 +1159,14 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
       }
 
       // See if we have a flit to route and can route it.
-      if (input_buffers_[i][vc].queue.empty()) {
+      if (input_buffers_[i][vc].empty()) {
         continue;
       }
 
-      DataFlit flit = input_buffers_[i][vc].queue.front().flit;
-      TimedDataFlitInfo metadata = input_buffers_[i][vc].queue.front().metadata;
+      const DataFlitQueueElement& front =
+          input_buffers_[i][vc].front(simulator);
+      DataFlit flit = front.flit;
+      TimedDataFlitInfo metadata = front.metadata;
       int64_t destination_index = flit.destination_index;
 
       PortIndexAndVCIndex input{i, vc};
@@ -861,7 +1207,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
       // Update credit to send back to input.
       ++input_credit_to_send_[i][vc];
-      input_buffers_[i][vc].queue.pop();
+      input_buffers_[i][vc].pop();
 
       flit_sent = true;
 
@@ -919,7 +1265,7 @@ bool SimInputBufferedVCRouter::TryReversePropagation(NocSimulator& simulator) {
       // Upon reset (cycle-0) a full update of credits is sent.
       if (current_cycle == 0) {
         input.reverse_channels[vc].flit.data =
-            UBits(input_buffers_[i][vc].max_queue_size, 32);
+            UBits(input_buffers_[i][vc].max_queue_size(), 32);
       } else {
         input.reverse_channels[vc].flit.data =
             UBits(input_credit_to_send_[i][vc], 32);
@@ -1004,7 +1350,7 @@ bool SimNetworkInterfaceSink::TryForwardPropagation(NocSimulator& simulator) {
 
     // TODO(tedhong): 2021-01-31 Support blocking traffic at sink.
     // without blocking, the queue never gets empty so we don't
-    // emplace into input_buffers_[vc].queue.
+    // push into input_buffers_[vc].
     TimedDataFlit received_flit;
     received_flit.cycle = current_cycle;
     received_flit.flit = src.forward_channels.flit;
@@ -1031,11 +1377,11 @@ bool SimNetworkInterfaceSink::TryForwardPropagation(NocSimulator& simulator) {
       src.reverse_channels[vc].cycle = current_cycle;
       src.reverse_channels[vc].flit.type = FlitType::kTail;
       src.reverse_channels[vc].flit.data =
-          UBits(input_buffers_[vc].max_queue_size, 32);
+          UBits(input_buffers_[vc].max_queue_size(), 32);
 
       XLS_VLOG(2) << absl::StreamFormat(
           "... sink %x sending %d credit vc %d on %x", GetId().AsUInt64(),
-          input_buffers_[vc].max_queue_size, vc, src.id.AsUInt64());
+          input_buffers_[vc].max_queue_size(), vc, src.id.AsUInt64());
     }
   } else {
     for (int64_t vc = 0; vc < src.reverse_channels.size(); ++vc) {
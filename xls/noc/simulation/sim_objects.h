@@ -16,10 +16,14 @@
 #define XLS_NOC_SIMULATION_SIM_OBJECTS_H_
 
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <queue>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
@@ -53,10 +57,39 @@ struct DataFlitQueueElement {
   TimedDataFlitInfo metadata;
 };
 
+class NocSimulator;
+
 // Represents a fifo/buffer used to store phits.
-struct DataFlitQueue {
-  std::queue<DataFlitQueueElement> queue;
-  int64_t max_queue_size;
+//
+// The queue is a fixed-capacity ring buffer whose elements are stored in the
+// data flit store of the simulator (see NocSimulator::GetNewDataFlitStore), so
+// the buffers of all components are contiguous in memory. As the buffer is
+// referenced by index, the queue remains valid when its component is copied.
+class DataFlitQueue {
+ public:
+  // Reserves the storage for up to max_queue_size elements in the simulator.
+  void Initialize(NocSimulator& simulator, int64_t max_queue_size);
+
+  int64_t max_queue_size() const { return max_queue_size_; }
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Returns the oldest element of the queue, which must not be empty.
+  const DataFlitQueueElement& front(NocSimulator& simulator) const;
+
+  // Appends an element to the queue, which must not be full.
+  void push(NocSimulator& simulator, const DataFlitQueueElement& element);
+
+  // Removes the oldest element of the queue, which must not be empty.
+  void pop();
+
+ private:
+  int64_t store_start_ = 0;
+  int64_t max_queue_size_ = 0;
+
+  // Position of the oldest element within the buffer and number of elements.
+  int64_t front_ = 0;
+  int64_t size_ = 0;
 };
 
 // Represents a fifo/buffer used to store metadata phits.
@@ -65,7 +98,7 @@ struct MetadataFlitQueue {
   int64_t max_queue_size;
 };
 
-class NocSimulator;
+class TickWorkerPool;
 
 // Common functionality and base class for all simulator objects.
 class SimNetworkComponentBase {
@@ -84,6 +117,15 @@ class SimNetworkComponentBase {
   // Returns the associated NetworkComponentId.
   NetworkComponentId GetId() const { return id_; }
 
+  // Returns the indices of all SimConnectionState objects this component
+  // reads or writes when ticked.
+  virtual std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const = 0;
+
+  // Returns true if the component holds no flits or credits, so that
+  // simulating another cycle without new traffic leaves its state unchanged.
+  virtual bool IsIdle() const = 0;
+
   virtual ~SimNetworkComponentBase() = default;
 
  protected:
@@ -156,6 +198,13 @@ class SimLink : public SimNetworkComponentBase {
   // Get the sink connection index that in used in the simulator.
   int64_t GetSinkConnectionIndex() const;
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override {
+    return {src_connection_index_, sink_connection_index_};
+  }
+
+  bool IsIdle() const override;
+
  private:
   SimLink() = default;
 
@@ -173,10 +222,10 @@ class SimLink : public SimNetworkComponentBase {
   int64_t src_connection_index_;
   int64_t sink_connection_index_;
 
-  std::queue<TimedDataFlit> forward_data_stages_;
+  std::deque<TimedDataFlit> forward_data_stages_;
   int64_t internal_forward_propagated_cycle_;
 
-  std::vector<std::queue<TimedMetadataFlit>> reverse_credit_stages_;
+  std::vector<std::deque<TimedMetadataFlit>> reverse_credit_stages_;
   std::vector<int64_t> internal_reverse_propagated_cycle_;
 };
 
@@ -193,6 +242,13 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   // Register a flit to be sent at a specific time.
   absl::Status SendFlitAtTime(TimedDataFlit flit);
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override {
+    return {sink_connection_index_};
+  }
+
+  bool IsIdle() const override;
+
  private:
   SimNetworkInterfaceSrc() = default;
 
@@ -251,6 +307,14 @@ class SimNetworkInterfaceSink : public SimNetworkComponentBase {
     return bits_per_sec / 1024.0 / 1024.0 / 8.0;
   }
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override {
+    return {src_connection_index_};
+  }
+
+  // Received traffic is not buffered, so a sink is always idle.
+  bool IsIdle() const override { return true; }
+
  private:
   SimNetworkInterfaceSink() = default;
 
@@ -296,6 +360,11 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 
   int64_t GetUtilizationCycleCount() const;
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override;
+
+  bool IsIdle() const override;
+
  private:
   SimInputBufferedVCRouter() = default;
 
@@ -367,22 +436,14 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 // state and objects.
 class NocSimulator {
  public:
-  NocSimulator()
-      : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+  NocSimulator();
+  ~NocSimulator();
 
   // Creates all simulation objects for a given network.
   // NetworkManager, NocParameters, and DistributedRoutingTable should
   // have aleady been setup.
   absl::Status Initialize(NetworkManager& mgr, NocParameters& params,
-                          DistributedRoutingTable& routing, NetworkId network) {
-    mgr_ = &mgr;
-    params_ = &params;
-    routing_ = &routing;
-    network_ = network;
-    cycle_ = -1;
-
-    return CreateSimulationObjects(network);
-  }
+                          DistributedRoutingTable& routing, NetworkId network);
 
   NetworkManager* GetNetworkManager() { return mgr_; }
   NocParameters* GetNocParameters() { return params_; }
@@ -436,6 +497,22 @@ class NocSimulator {
     return absl::Span<PortId>(port_id_store_.data() + start, size);
   }
 
+  // Allocates and returns an index that can be used with
+  // GetDataFlitStore to retrieve an array of size.
+  int64_t GetNewDataFlitStore(int64_t size) {
+    int64_t next_start = data_flit_store_.size();
+    data_flit_store_.resize(next_start + size);
+    return next_start;
+  }
+
+  // Returns a reference to the store previously reserved with
+  // GetNewDataFlitStore.
+  absl::Span<DataFlitQueueElement> GetDataFlitStore(int64_t start,
+                                                    int64_t size = 1) {
+    return absl::Span<DataFlitQueueElement>(data_flit_store_.data() + start,
+                                            size);
+  }
+
   // Returns current/in-progress cycle;
   int64_t GetCurrentCycle() { return cycle_; }
 
@@ -445,9 +522,47 @@ class NocSimulator {
   // Run a single cycle of the simulator.
   absl::Status RunCycle(int64_t max_ticks = 9999);
 
+  // Runs cycle_count cycles of the simulator.
+  //
+  // If SetFastForwardIdleCycles() enabled it, then whenever the network is
+  // idle (see IsIdle) after a cycle, the cycles until the next one in which a
+  // registered service has work to do (see
+  // NocSimulatorServiceShim::GetNextActiveCycle) are skipped rather than
+  // simulated. As an idle network does not change state, the result is the
+  // same as that of simulating every cycle. The last of the cycles is always
+  // simulated, so statistics which depend on the last cycle seen are
+  // unaffected.
+  absl::Status RunCycles(int64_t cycle_count, int64_t max_ticks = 9999);
+
+  // Enables or disables the skipping of idle cycles by RunCycles().
+  void SetFastForwardIdleCycles(bool enabled) {
+    fast_forward_idle_cycles_ = enabled;
+  }
+
+  // Returns the number of cycles skipped by RunCycles() so far.
+  int64_t GetSkippedCycleCount() const { return skipped_cycle_count_; }
+
+  // Returns true if no flits or credits are in flight in the network or held
+  // by its components.
+  bool IsIdle();
+
   // Runs a single tick of the simulator.
+  //
+  // If SetTickThreadCount() enabled it, the components are ticked on several
+  // threads. To do so they are grouped into phases such that no two
+  // components of a phase share a SimConnectionState. The components of a
+  // phase are split into contiguous (and so mostly neighboring) groups which
+  // are ticked concurrently, and each phase starts once all threads are done
+  // with the previous one. As propagation only happens once the state of a
+  // connection is stamped with the current cycle, the result of a cycle does
+  // not depend on the order of ticks.
   bool Tick();
 
+  // Sets the number of threads to tick the components of the network on.
+  // Must be called after Initialize(). The default of one ticks all
+  // components on the calling thread.
+  absl::Status SetTickThreadCount(int64_t thread_count);
+
   // Register a service to run once at the beginning of each cycle.
   // TODO(tedhong): 2021-07-27 Add a scheme to provide a total order
   //                of services.
@@ -483,6 +598,9 @@ class NocSimulator {
   absl::Status CreateLink(NetworkComponentId nc_id);
   absl::Status CreateRouter(NetworkComponentId nc_id);
 
+  // Groups all components into tick_phases_ (see Tick).
+  void CreateTickPhases();
+
   NetworkManager* mgr_;
   NocParameters* params_;
   DistributedRoutingTable* routing_;
@@ -490,6 +608,9 @@ class NocSimulator {
   NetworkId network_;
   int64_t cycle_;
 
+  bool fast_forward_idle_cycles_ = false;
+  int64_t skipped_cycle_count_ = 0;
+
   // Map a specific ConnectionId to an index used to access
   // a specific SimConnectionState via the connections_ object.
   absl::flat_hash_map<ConnectionId, int64_t> connection_index_map_;
@@ -514,6 +635,9 @@ class NocSimulator {
   // Stores port ids for routers.
   std::vector<PortId> port_id_store_;
 
+  // Stores the elements of the DataFlitQueues of all components.
+  std::vector<DataFlitQueueElement> data_flit_store_;
+
   std::vector<SimLink> links_;
   std::vector<SimNetworkInterfaceSrc> network_interface_sources_;
   std::vector<SimNetworkInterfaceSink> network_interface_sinks_;
@@ -524,6 +648,11 @@ class NocSimulator {
 
   // Shims to services to run at the end of each cycle.
   std::vector<NocSimulatorServiceShim*> post_cycle_services_;
+
+  // Components in the phases of a multithreaded tick. Empty unless
+  // tick_workers_ is set.
+  std::vector<std::vector<SimNetworkComponentBase*>> tick_phases_;
+  std::unique_ptr<TickWorkerPool> tick_workers_;
 };
 
 }  // namespace noc
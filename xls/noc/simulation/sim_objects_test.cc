@@ -14,10 +14,16 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/network_graph_builder.h"
@@ -295,6 +301,149 @@ TEST(SimObjectsTest, TreeNetwork0) {
       38146);
 }
 
+// Sends the flits of TreeNetwork0 through the network, ticking it on the given
+// number of threads, and returns the traffic received by each of the sinks.
+absl::StatusOr<std::vector<std::vector<TimedDataFlit>>> RunTreeNetwork0(
+    int64_t tick_thread_count) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_RETURN_IF_ERROR(BuildNetworkGraphTree000(&proto, &graph, &params));
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSIGN_OR_RETURN(DistributedRoutingTable routing_table,
+                       route_builder.BuildNetworkRoutingTables(
+                           graph.GetNetworkIds()[0], graph, params));
+
+  NocSimulator simulator;
+  XLS_RETURN_IF_ERROR(simulator.Initialize(graph, params, routing_table,
+                                           graph.GetNetworkIds()[0]));
+  XLS_RETURN_IF_ERROR(simulator.SetTickThreadCount(tick_thread_count));
+
+  std::vector<SimNetworkInterfaceSink*> sinks;
+  for (std::string_view name :
+       {"RecvPort0", "RecvPort1", "RecvPort2", "RecvPort3"}) {
+    XLS_ASSIGN_OR_RETURN(NetworkComponentId id,
+                         FindNetworkComponentByName(name, graph, params));
+    XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sink,
+                         simulator.GetSimNetworkInterfaceSink(id));
+    sinks.push_back(sink);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      NetworkComponentId recv_port_1,
+      FindNetworkComponentByName("RecvPort1", graph, params));
+  XLS_ASSIGN_OR_RETURN(
+      NetworkComponentId recv_port_3,
+      FindNetworkComponentByName("RecvPort3", graph, params));
+  XLS_ASSIGN_OR_RETURN(
+      int64_t dest_index_1,
+      routing_table.GetSinkIndices().GetNetworkComponentIndex(recv_port_1));
+  XLS_ASSIGN_OR_RETURN(
+      int64_t dest_index_3,
+      routing_table.GetSinkIndices().GetNetworkComponentIndex(recv_port_3));
+
+  XLS_ASSIGN_OR_RETURN(
+      NetworkComponentId send_port_0,
+      FindNetworkComponentByName("SendPort0", graph, params));
+  XLS_ASSIGN_OR_RETURN(
+      NetworkComponentId send_port_1,
+      FindNetworkComponentByName("SendPort1", graph, params));
+  XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSrc * sim_send_port_0,
+                       simulator.GetSimNetworkInterfaceSrc(send_port_0));
+  XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSrc * sim_send_port_1,
+                       simulator.GetSimNetworkInterfaceSrc(send_port_1));
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSIGN_OR_RETURN(TimedDataFlit flit0,
+                         DataFlitBuilder()
+                             .Cycle(1 + i)
+                             .Type(FlitType::kTail)
+                             .VirtualChannel(0)
+                             .SourceIndex(0)
+                             .DestinationIndex(dest_index_1)
+                             .Data(UBits(707 + i, 64))
+                             .BuildTimedFlit());
+    XLS_RETURN_IF_ERROR(sim_send_port_0->SendFlitAtTime(flit0));
+    XLS_ASSIGN_OR_RETURN(TimedDataFlit flit1,
+                         DataFlitBuilder()
+                             .Cycle(1 + i)
+                             .Type(FlitType::kTail)
+                             .VirtualChannel(1)
+                             .SourceIndex(0)
+                             .DestinationIndex(dest_index_3)
+                             .Data(UBits(1001 + i, 64))
+                             .BuildTimedFlit());
+    XLS_RETURN_IF_ERROR(sim_send_port_1->SendFlitAtTime(flit1));
+  }
+
+  for (int64_t i = 0; i < 20; ++i) {
+    XLS_RETURN_IF_ERROR(simulator.RunCycle());
+  }
+
+  std::vector<std::vector<TimedDataFlit>> traffic;
+  for (SimNetworkInterfaceSink* sink : sinks) {
+    traffic.emplace_back(sink->GetReceivedTraffic().begin(),
+                         sink->GetReceivedTraffic().end());
+  }
+  return traffic;
+}
+
+TEST(SimObjectsTest, TreeNetwork0MultithreadedTickMatchesSequential) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::vector<TimedDataFlit>> expected,
+                           RunTreeNetwork0(/*tick_thread_count=*/1));
+  EXPECT_EQ(expected[1].size(), 4);
+  EXPECT_EQ(expected[3].size(), 4);
+
+  for (int64_t thread_count : {2, 3, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::vector<TimedDataFlit>> actual,
+                             RunTreeNetwork0(thread_count));
+    ASSERT_EQ(actual.size(), expected.size());
+    for (int64_t sink = 0; sink < expected.size(); ++sink) {
+      ASSERT_EQ(actual[sink].size(), expected[sink].size())
+          << "threads: " << thread_count << " sink: " << sink;
+      for (int64_t i = 0; i < expected[sink].size(); ++i) {
+        EXPECT_EQ(actual[sink][i].cycle, expected[sink][i].cycle);
+        EXPECT_EQ(actual[sink][i].flit.data, expected[sink][i].flit.data);
+        EXPECT_EQ(actual[sink][i].flit.vc, expected[sink][i].flit.vc);
+      }
+    }
+  }
+}
+
+TEST(SimObjectsTest, InvalidTickThreadCount) {
+  NocSimulator simulator;
+  EXPECT_FALSE(simulator.SetTickThreadCount(2).ok());
+}
+
+TEST(SimObjectsTest, DataFlitQueueWrapsAround) {
+  NocSimulator simulator;
+  DataFlitQueue queue_a;
+  DataFlitQueue queue_b;
+  queue_a.Initialize(simulator, 3);
+  queue_b.Initialize(simulator, 2);
+  EXPECT_EQ(queue_a.max_queue_size(), 3);
+  EXPECT_TRUE(queue_a.empty());
+
+  auto element = [](int64_t data) {
+    DataFlitQueueElement ret;
+    ret.flit.destination_index = data;
+    return ret;
+  };
+
+  queue_b.push(simulator, element(100));
+  for (int64_t i = 0; i < 10; ++i) {
+    queue_a.push(simulator, element(i));
+    if (queue_a.size() == 3) {
+      EXPECT_EQ(queue_a.front(simulator).flit.destination_index, i - 2);
+      queue_a.pop();
+    }
+  }
+  EXPECT_EQ(queue_a.size(), 2);
+  EXPECT_EQ(queue_a.front(simulator).flit.destination_index, 8);
+
+  // The queues do not share storage.
+  EXPECT_EQ(queue_b.size(), 1);
+  EXPECT_EQ(queue_b.front(simulator).flit.destination_index, 100);
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
@@ -14,9 +14,14 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/noc/simulation/noc_traffic_injector.h"
 #include "xls/noc/simulation/sample_network_graphs.h"
 #include "xls/noc/simulation/sim_objects.h"
@@ -379,5 +384,113 @@ TEST(SimTrafficTest, NetworkWithMultiplePathsAndReplay) {
   EXPECT_EQ(simulator.GetRouters()[1].GetUtilizationCycleCount(), 10);
 }
 
+struct SparseReplayResult {
+  absl::flat_hash_map<NetworkComponentId, DestinationToPacketCount>
+      link_to_packet_count_map;
+  std::vector<TimedDataFlit> received_traffic;
+  int64_t router_utilization_cycle_count;
+  double measured_traffic_rate;
+  int64_t skipped_cycle_count;
+};
+
+absl::StatusOr<SparseReplayResult> RunSparseReplay(bool fast_forward) {
+  NocTrafficManager traffic_mgr;
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow0_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetPacketSizeInBits(64)
+      .SetClockCycleTimes({0, 1, 2, 100, 101, 400, 900});
+  XLS_ASSIGN_OR_RETURN(TrafficModeId mode0_id,
+                       traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id).SetName("Mode 0").RegisterTrafficFlow(
+      flow0_id);
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_RETURN_IF_ERROR(BuildNetworkGraphLinear000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSIGN_OR_RETURN(DistributedRoutingTable routing_table,
+                       route_builder.BuildNetworkRoutingTables(
+                           graph.GetNetworkIds()[0], graph, params));
+
+  RandomNumberInterface rnd;
+  int64_t cycle_time_in_ps = 400;
+  rnd.SetSeed(1000);
+  XLS_ASSIGN_OR_RETURN(
+      NocTrafficInjector traffic_injector,
+      NocTrafficInjectorBuilder().Build(
+          cycle_time_in_ps, mode0_id,
+          routing_table.GetSourceIndices().GetNetworkComponents(),
+          routing_table.GetSinkIndices().GetNetworkComponents(),
+          params.GetNetworkParam(graph.GetNetworkIds()[0])
+              ->GetVirtualChannels(),
+          traffic_mgr, graph, params, rnd));
+
+  NocSimulator simulator;
+  XLS_RETURN_IF_ERROR(simulator.Initialize(graph, params, routing_table,
+                                           graph.GetNetworkIds()[0]));
+  simulator.SetFastForwardIdleCycles(fast_forward);
+
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+
+  NocSimulatorToLinkMonitorServiceShim link_monitor(simulator);
+  simulator.RegisterPostCycleService(link_monitor);
+
+  XLS_RETURN_IF_ERROR(simulator.RunCycles(1000));
+  XLS_RET_CHECK_EQ(simulator.GetCurrentCycle(), 999);
+
+  XLS_ASSIGN_OR_RETURN(NetworkComponentId recv_port_0,
+                       FindNetworkComponentByName("RecvPort0", graph, params));
+  XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sink,
+                       simulator.GetSimNetworkInterfaceSink(recv_port_0));
+
+  SparseReplayResult result;
+  result.link_to_packet_count_map = link_monitor.GetLinkToPacketCountMap();
+  absl::Span<const TimedDataFlit> received = sink->GetReceivedTraffic();
+  result.received_traffic.assign(received.begin(), received.end());
+  result.router_utilization_cycle_count =
+      simulator.GetRouters()[0].GetUtilizationCycleCount();
+  result.measured_traffic_rate =
+      traffic_injector.MeasuredTrafficRateInMiBps(cycle_time_in_ps, 0);
+  result.skipped_cycle_count = simulator.GetSkippedCycleCount();
+  return result;
+}
+
+TEST(SimTrafficTest, FastForwardIdleCyclesMatchesFullSimulation) {
+  XLS_ASSERT_OK_AND_ASSIGN(SparseReplayResult expected,
+                           RunSparseReplay(/*fast_forward=*/false));
+  XLS_ASSERT_OK_AND_ASSIGN(SparseReplayResult actual,
+                           RunSparseReplay(/*fast_forward=*/true));
+
+  EXPECT_EQ(expected.skipped_cycle_count, 0);
+  // Nearly all of the cycles are idle.
+  EXPECT_GT(actual.skipped_cycle_count, 900);
+
+  EXPECT_EQ(actual.link_to_packet_count_map,
+            expected.link_to_packet_count_map);
+  EXPECT_EQ(actual.router_utilization_cycle_count,
+            expected.router_utilization_cycle_count);
+  EXPECT_EQ(expected.router_utilization_cycle_count, 7);
+  EXPECT_EQ(actual.measured_traffic_rate, expected.measured_traffic_rate);
+
+  ASSERT_EQ(actual.received_traffic.size(), expected.received_traffic.size());
+  ASSERT_EQ(expected.received_traffic.size(), 7);
+  for (int64_t i = 0; i < expected.received_traffic.size(); ++i) {
+    EXPECT_EQ(actual.received_traffic[i].cycle,
+              expected.received_traffic[i].cycle);
+    EXPECT_EQ(actual.received_traffic[i].metadata.injection_cycle_time,
+              expected.received_traffic[i].metadata.injection_cycle_time);
+  }
+}
+
 }  // namespace
 }  // namespace xls::noc
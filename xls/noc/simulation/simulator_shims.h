@@ -15,6 +15,9 @@
 #ifndef XLS_NOC_SIMULATION_SIMULATOR_SHIMS_H_
 #define XLS_NOC_SIMULATION_SIMULATOR_SHIMS_H_
 
+#include <cstdint>
+
+#include "absl/status/status.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 
@@ -28,6 +31,19 @@ namespace xls::noc {
 class NocSimulatorServiceShim {
  public:
   virtual absl::Status RunCycle() = 0;
+
+  // Returns the first cycle after `cycle` in which the service has work to do,
+  // assuming the network stays idle until then. Used by the simulator to
+  // fast-forward through idle cycles (see NocSimulator::RunCycles), so the
+  // default of cycle + 1 requires the service to run on every cycle.
+  virtual int64_t GetNextActiveCycle(int64_t cycle) const { return cycle + 1; }
+
+  // Called instead of RunCycle() for each of cycle_count cycles skipped
+  // by the simulator.
+  virtual absl::Status SkipCycles(int64_t cycle_count) {
+    return absl::OkStatus();
+  }
+
   virtual ~NocSimulatorServiceShim() = default;
 };
 
@@ -15,6 +15,9 @@
 #ifndef XLS_NOC_SIMULATION_NOC_SIMULATOR_TO_LINK_MONITOR_SERVICE_SHIM_H_
 #define XLS_NOC_SIMULATION_NOC_SIMULATOR_TO_LINK_MONITOR_SERVICE_SHIM_H_
 
+#include <cstdint>
+#include <limits>
+
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/sim_objects.h"
 
@@ -50,6 +53,12 @@ class NocSimulatorToLinkMonitorServiceShim
   NocSimulatorToLinkMonitorServiceShim(NocSimulator& simulator);
   absl::Status RunCycle() override;
 
+  // Nothing passes through the links of an idle network, so the monitor never
+  // needs to run during idle cycles.
+  int64_t GetNextActiveCycle(int64_t cycle) const override {
+    return std::numeric_limits<int64_t>::max();
+  }
+
   const absl::flat_hash_map<NetworkComponentId, DestinationToPacketCount>&
   GetLinkToPacketCountMap() const;
 
@@ -32,6 +32,14 @@ class NocSimulatorToNocTrafficInjectorShim
   // Called by the simulator each cycle to request for traffic.
   absl::Status RunCycle() override { return traffic_injector_->RunCycle(); }
 
+  int64_t GetNextActiveCycle(int64_t cycle) const override {
+    return traffic_injector_->GetNextActiveCycle();
+  }
+
+  absl::Status SkipCycles(int64_t cycle_count) override {
+    return traffic_injector_->SkipCycles(cycle_count);
+  }
+
   // Called by the traffic injector to inject traffic.
   absl::Status SendFlitAtTime(TimedDataFlit flit,
                               NetworkComponentId source) override {
@@ -14,6 +14,9 @@
 
 #include "xls/noc/simulation/traffic_models.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace xls::noc {
 
 std::vector<DataPacket> GeneralizedGeometricTrafficModel::GetNewCyclePackets(
@@ -140,6 +143,13 @@ std::vector<DataPacket> ReplayTrafficModel::GetNewCyclePackets(int64_t cycle) {
   return packets;
 }
 
+int64_t ReplayTrafficModel::GetNextPacketCycle(int64_t cycle) const {
+  if (clock_cycle_iter_ == clock_cycles_.end()) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return std::max(*clock_cycle_iter_, cycle + 1);
+}
+
 double ReplayTrafficModel::ExpectedTrafficRateInMiBps(
     int64_t cycle_time_ps) const {
   double total_sec = static_cast<double>(cycle_count_ + 1) *
@@ -44,10 +44,14 @@ class TrafficModel {
   //       a call to GetNewCyclePackets(N) should not be called multiple times.
   // Note: The simulator will successively call GetNewCyclePackets(0),
   //       GetNewCyclePackets(1), GetNewCyclePackets(2), ...
-  //
-  // TODO(tedhong): 2021-06-27 Add an interface to support fast-forwarding.
   virtual std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) = 0;
 
+  // Returns the first cycle after `cycle` for which GetNewCyclePackets may
+  // return packets, so calls for the cycles in between may be skipped.
+  //
+  // Note: `cycle` is the cycle of the last call to GetNewCyclePackets.
+  virtual int64_t GetNextPacketCycle(int64_t cycle) const { return cycle + 1; }
+
   // Returns expected rate of traffic injected in MebiBytes Per Sec.
   virtual double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const = 0;
 
@@ -143,6 +147,10 @@ class GeneralizedGeometricTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle);
 
+  int64_t GetNextPacketCycle(int64_t cycle) const override {
+    return std::max(next_packet_cycle_, cycle + 1);
+  }
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const {
     double num_cycles = 1.0e12 / static_cast<double>(cycle_time_ps);
     double num_packets = lambda_ * num_cycles;
@@ -205,6 +213,8 @@ class ReplayTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle);
 
+  int64_t GetNextPacketCycle(int64_t cycle) const override;
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const;
 
   // Sets clock cycles to list and sorts the complete list of clock cycle.
@@ -23,6 +23,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value_helpers.h"
 #include "xls/passes/ternary_query_engine.h"
+#include "xls/passes/ternary_query_engine_cache.h"
 
 namespace xls {
 namespace {
@@ -921,8 +922,11 @@ absl::StatusOr<bool> ArraySimplificationPass::RunOnFunctionBaseInternal(
   XLS_ASSIGN_OR_RETURN(bool clamp_changed, ClampArrayIndexIndices(func));
   changed |= clamp_changed;
 
-  TernaryQueryEngine query_engine;
-  XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
+  TernaryQueryEngine local_query_engine;
+  XLS_ASSIGN_OR_RETURN(
+      const QueryEngine* shared_query_engine,
+      GetSharedTernaryQueryEngine(func, results, &local_query_engine));
+  const QueryEngine& query_engine = *shared_query_engine;
 
   for (Node* node : TopoSort(func)) {
     if (node->Is<ArrayIndex>()) {
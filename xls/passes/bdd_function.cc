@@ -14,6 +14,7 @@
 
 #include "xls/passes/bdd_function.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
@@ -25,6 +26,8 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/data_structures/union_find.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/abstract_node_evaluator.h"
@@ -262,14 +265,167 @@ bool ShouldEvaluate(Node* node) {
   XLS_LOG(FATAL) << "Invalid op: " << static_cast<int64_t>(node->op());
 }
 
+// Returns whether the BDD expression of the given node is computed from the
+// BDD expressions of its operands. Otherwise the node is modeled as new BDD
+// variables.
+bool IsExpressedInBdd(
+    Node* node,
+    const std::optional<std::function<bool(const Node*)>>& node_filter) {
+  return ShouldEvaluate(node) &&
+         (!node_filter.has_value() || node_filter.value()(node)) &&
+         std::all_of(node->operands().begin(), node->operands().end(),
+                     [](Node* o) { return o->GetType()->IsBits(); });
+}
+
 }  // namespace
 
 /* static */ absl::StatusOr<std::unique_ptr<BddFunction>> BddFunction::Run(
     FunctionBase* f, int64_t path_limit,
-    std::optional<std::function<bool(const Node*)>> node_filter) {
+    std::optional<std::function<bool(const Node*)>> node_filter,
+    int64_t node_limit, int64_t reorder_threshold) {
   XLS_VLOG(1) << absl::StreamFormat("BddFunction::Run(%s):", f->name());
   XLS_VLOG_LINES(5, f->DumpIr());
 
+  std::vector<Node*> nodes;
+  for (Node* node : TopoSort(f)) {
+    nodes.push_back(node);
+  }
+  return RunOnNodes(f, nodes, path_limit, node_filter, node_limit,
+                    reorder_threshold);
+}
+
+/* static */ std::vector<std::vector<Node*>> BddFunction::PartitionIntoCones(
+    FunctionBase* f, int64_t max_partitions,
+    std::optional<std::function<bool(const Node*)>> node_filter) {
+  XLS_CHECK_GT(max_partitions, 0);
+  std::vector<Node*> nodes;
+  UnionFind<Node*> cones;
+  for (Node* node : TopoSort(f)) {
+    if (!node->GetType()->IsBits()) {
+      continue;
+    }
+    nodes.push_back(node);
+    cones.Insert(node);
+    // The expression of an evaluated node is built from the expressions of
+    // its operands so they must be in the same BDD. All operands of an
+    // evaluated node are bits-typed and so have already been inserted.
+    if (IsExpressedInBdd(node, node_filter)) {
+      for (Node* operand : node->operands()) {
+        cones.Union(node, operand);
+      }
+    }
+  }
+
+  // Gather the sizes of the cones. The cones are identified by their index in
+  // order of first appearance to keep the partitioning deterministic.
+  absl::flat_hash_map<Node*, int64_t> cone_index;
+  std::vector<int64_t> cone_sizes;
+  for (Node* node : nodes) {
+    auto [it, inserted] =
+        cone_index.try_emplace(cones.Find(node), cone_sizes.size());
+    if (inserted) {
+      cone_sizes.push_back(0);
+    }
+    ++cone_sizes[it->second];
+  }
+
+  // Greedily assign the cones, largest first, to the least loaded partition.
+  std::vector<int64_t> cone_order(cone_sizes.size());
+  for (int64_t i = 0; i < cone_order.size(); ++i) {
+    cone_order[i] = i;
+  }
+  std::stable_sort(cone_order.begin(), cone_order.end(),
+                   [&](int64_t a, int64_t b) {
+                     return cone_sizes[a] > cone_sizes[b];
+                   });
+  int64_t partition_count =
+      std::min(max_partitions,
+               std::max(int64_t{1}, static_cast<int64_t>(cone_sizes.size())));
+  std::vector<int64_t> partition_sizes(partition_count, 0);
+  std::vector<int64_t> cone_partition(cone_sizes.size());
+  for (int64_t cone : cone_order) {
+    int64_t partition =
+        std::min_element(partition_sizes.begin(), partition_sizes.end()) -
+        partition_sizes.begin();
+    cone_partition[cone] = partition;
+    partition_sizes[partition] += cone_sizes[cone];
+  }
+
+  std::vector<std::vector<Node*>> partitions(partition_count);
+  for (Node* node : nodes) {
+    partitions[cone_partition[cone_index.at(cones.Find(node))]].push_back(
+        node);
+  }
+  return partitions;
+}
+
+/* static */ absl::StatusOr<std::vector<std::unique_ptr<BddFunction>>>
+BddFunction::RunSharded(
+    FunctionBase* f, int64_t shard_count, int64_t path_limit,
+    std::optional<std::function<bool(const Node*)>> node_filter,
+    int64_t node_limit, int64_t reorder_threshold) {
+  XLS_RET_CHECK_GT(shard_count, 0);
+  std::vector<std::unique_ptr<BddFunction>> shards;
+  if (shard_count == 1) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<BddFunction> bdd_function,
+        Run(f, path_limit, node_filter, node_limit, reorder_threshold));
+    shards.push_back(std::move(bdd_function));
+    return std::move(shards);
+  }
+
+  XLS_VLOG(1) << absl::StreamFormat("BddFunction::RunSharded(%s, %d):",
+                                    f->name(), shard_count);
+  std::vector<std::vector<Node*>> partitions =
+      PartitionIntoCones(f, shard_count, node_filter);
+
+  // Evaluate the filter up front so it is never called concurrently.
+  std::optional<std::function<bool(const Node*)>> shard_filter;
+  absl::flat_hash_set<const Node*> filtered_nodes;
+  if (node_filter.has_value()) {
+    for (Node* node : f->nodes()) {
+      if (!node_filter.value()(node)) {
+        filtered_nodes.insert(node);
+      }
+    }
+    shard_filter = [&filtered_nodes](const Node* node) {
+      return !filtered_nodes.contains(node);
+    };
+  }
+
+  // The first shard is built on the calling thread.
+  std::vector<absl::StatusOr<std::unique_ptr<BddFunction>>> results(
+      partitions.size());
+  auto run_shard = [&](int64_t i) {
+    XLS_VLOG(2) << absl::StreamFormat("  shard %d: %d nodes", i,
+                                      partitions[i].size());
+    results[i] = RunOnNodes(f, partitions[i], path_limit, shard_filter,
+                            node_limit, reorder_threshold);
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < partitions.size(); ++i) {
+    threads.push_back(std::make_unique<Thread>([&run_shard, i]() {
+      run_shard(i);
+    }));
+  }
+  run_shard(0);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  for (absl::StatusOr<std::unique_ptr<BddFunction>>& result : results) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<BddFunction> shard,
+                         std::move(result));
+    shards.push_back(std::move(shard));
+  }
+  return std::move(shards);
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<BddFunction>>
+BddFunction::RunOnNodes(
+    FunctionBase* f, absl::Span<Node* const> nodes, int64_t path_limit,
+    std::optional<std::function<bool(const Node*)>> node_filter,
+    int64_t node_limit, int64_t reorder_threshold) {
   auto bdd_function = absl::WrapUnique(new BddFunction(f));
   SaturatingBddEvaluator evaluator(path_limit, &bdd_function->bdd());
 
@@ -285,20 +441,51 @@ bool ShouldEvaluate(Node* node) {
 
   XLS_VLOG(3) << "BDD expressions:";
   absl::flat_hash_map<Node*, SaturatingBddNodeVector> values;
-  for (Node* node : TopoSort(f)) {
+
+  // Returns the BDD nodes of the expressions of all XLS nodes evaluated so far.
+  auto get_roots = [&]() {
+    std::vector<BddNodeIndex> roots;
+    for (const auto& [node, vector] : values) {
+      for (const SaturatingBddNodeIndex& value : vector) {
+        roots.push_back(std::get<BddNodeIndex>(value));
+      }
+    }
+    return roots;
+  };
+
+  // Frees the BDD nodes which are not part of the expression of any XLS node
+  // evaluated so far. Returns false if the BDD is still too large to continue
+  // evaluating nodes.
+  bool node_limit_reached = false;
+  auto collect_garbage = [&]() {
+    std::vector<BddNodeIndex> roots = get_roots();
+    std::vector<BddNodeIndex> remap =
+        bdd_function->bdd().GarbageCollect(roots);
+    for (auto& [node, vector] : values) {
+      for (SaturatingBddNodeIndex& value : vector) {
+        value = remap[std::get<BddNodeIndex>(value).value()];
+      }
+    }
+    return node_limit == 0 || bdd_function->bdd().size() <= node_limit / 2;
+  };
+
+  // The BDD size at which the variables are next reordered. The threshold
+  // doubles after each reordering so the cost of reordering stays
+  // proportional to the size of the BDD.
+  int64_t next_reorder_size = reorder_threshold;
+
+  for (Node* node : nodes) {
     XLS_VLOG(3) << "node: " << node->ToString();
     if (!node->GetType()->IsBits()) {
       XLS_VLOG(3) << "  skipping node, type is not bits: "
                   << node->GetType()->ToString();
       continue;
     }
+    bdd_function->nodes_.push_back(node);
     // If we shouldn't evaluate this node, the node is to be modeled as
     // variables, or the node includes some non-bits-typed operands, then just
     // create a vector of new BDD variables for this node.
-    if (!ShouldEvaluate(node) ||
-        (node_filter.has_value() && !node_filter.value()(node)) ||
-        std::any_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return !o->GetType()->IsBits(); })) {
+    if (node_limit_reached || !IsExpressedInBdd(node, node_filter)) {
       XLS_VLOG(2) << "  node filtered out.";
       values[node] = create_new_node_vector(node);
     } else {
@@ -329,6 +516,24 @@ bool ShouldEvaluate(Node* node) {
               std::get<BddNodeIndex>(values.at(node)[i]),
               /*minterm_limit=*/15));
     }
+
+    if (!node_limit_reached && reorder_threshold > 0 &&
+        bdd_function->bdd().size() > next_reorder_size) {
+      bdd_function->bdd().SiftVariables(get_roots());
+      node_limit_reached = !collect_garbage();
+      next_reorder_size =
+          2 * std::max(bdd_function->bdd().size(), reorder_threshold);
+    }
+    if (!node_limit_reached && node_limit > 0 &&
+        bdd_function->bdd().size() > node_limit) {
+      node_limit_reached = !collect_garbage();
+      if (node_limit_reached) {
+        XLS_VLOG(1) << absl::StreamFormat(
+            "BDD node limit of %d reached at node %s; remaining nodes are "
+            "modeled as variables.",
+            node_limit, node->GetName());
+      }
+    }
   }
 
   // Copy over the vector and BDD variables into the node map which is exposed
@@ -366,7 +571,8 @@ absl::StatusOr<Value> BddFunction::Evaluate(
       // doesn't have to deal with missing nodes.
       result = Value::Token();
     } else if (!node->GetType()->IsBits() ||
-               saturated_expressions_.contains(node)) {
+               saturated_expressions_.contains(node) ||
+               !node_map_.contains(node)) {
       std::vector<Value> operand_values;
       for (Node* operand : node->operands()) {
         operand_values.push_back(values.at(operand));
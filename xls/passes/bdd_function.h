@@ -15,8 +15,11 @@
 #ifndef XLS_PASSES_BDD_FUNCTION_H_
 #define XLS_PASSES_BDD_FUNCTION_H_
 
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -48,6 +51,19 @@ class BddFunction {
   // variable. This provides a mechanism for limiting the growth of the BDD.
   static constexpr int64_t kDefaultPathLimit = 16 * 1024;
 
+  // The default limit on the number of nodes in the BDD. When the BDD grows
+  // beyond this size while the function is being evaluated, nodes which are no
+  // longer referenced are garbage collected. If the live nodes still fill more
+  // than half of the limit afterwards, the remaining XLS nodes are not
+  // evaluated and their bits are modeled as new BDD variables.
+  static constexpr int64_t kDefaultNodeLimit = 4 * 1024 * 1024;
+
+  // The default BDD size at which the BDD variables are first reordered by
+  // sifting (see BinaryDecisionDiagram::SiftVariables) during construction.
+  // The variables are initially ordered by the order in which the XLS nodes
+  // are visited which can produce needlessly large BDDs.
+  static constexpr int64_t kDefaultReorderThreshold = 64 * 1024;
+
   // Construct a BDD representing the given function/proc.
   // `node_filter` is an optional function which filters the nodes to be
   // evaluated. If this function returns false for a node then the node will not
@@ -55,11 +71,44 @@ class BddFunction {
   // for which no information is known. If `node_filter` returns true, the node
   // still might *not* be evaluated because some kinds of nodes are never
   // evaluated for various reasons including computation expense.
+  // `node_limit` bounds the size of the BDD (see kDefaultNodeLimit) and
+  // `reorder_threshold` is the size at which the variables are first reordered
+  // (see kDefaultReorderThreshold). Zero disables either.
   static absl::StatusOr<std::unique_ptr<BddFunction>> Run(
       FunctionBase* f, int64_t path_limit = 0,
+      std::optional<std::function<bool(const Node*)>> node_filter =
+          absl::nullopt,
+      int64_t node_limit = kDefaultNodeLimit,
+      int64_t reorder_threshold = kDefaultReorderThreshold);
+
+  // Partitions the bits-typed nodes of the function into at most
+  // `max_partitions` groups such that the BDD expression of every node depends
+  // only on the BDD variables of nodes in the same group. Edges into nodes
+  // which are not evaluated with the BDD (see `node_filter` above) do not
+  // connect groups because such nodes are modeled as new variables. Each group
+  // is in topological order. Independent cones are combined into groups of
+  // roughly equal size. At least one (possibly empty) group is returned.
+  static std::vector<std::vector<Node*>> PartitionIntoCones(
+      FunctionBase* f, int64_t max_partitions,
       std::optional<std::function<bool(const Node*)>> node_filter =
           absl::nullopt);
 
+  // Like Run but builds a separate BddFunction for each group returned by
+  // PartitionIntoCones(f, `shard_count`, `node_filter`). The shards are built
+  // concurrently on separate threads. The BDDs of different shards share no
+  // variables so the bits of nodes in different shards are independent.
+  // `node_filter` is evaluated before any thread is started. The limits apply
+  // to each shard separately.
+  static absl::StatusOr<std::vector<std::unique_ptr<BddFunction>>> RunSharded(
+      FunctionBase* f, int64_t shard_count, int64_t path_limit = 0,
+      std::optional<std::function<bool(const Node*)>> node_filter =
+          absl::nullopt,
+      int64_t node_limit = kDefaultNodeLimit,
+      int64_t reorder_threshold = kDefaultReorderThreshold);
+
+  // Returns the bits-typed nodes represented in the BDD in topological order.
+  absl::Span<Node* const> nodes() const { return nodes_; }
+
   // Returns the underlying BDD.
   const BinaryDecisionDiagram& bdd() const { return bdd_; }
   BinaryDecisionDiagram& bdd() { return bdd_; }
@@ -72,7 +121,8 @@ class BddFunction {
 
   // Evaluates the function using the BDD with the given argument values.
   // Operations such as arithmetic operations which are not expressed in the BDD
-  // are evaluated using the IR interpreter. This method is for testing purposes
+  // (as well as nodes outside of this shard, see RunSharded) are evaluated
+  // using the IR interpreter. This method is for testing purposes
   // only for verifying that the BDD is properly constructed. Prerequisite: the
   // FunctionBase used to build the BddFunction must be a function not a proc.
   absl::StatusOr<Value> Evaluate(absl::Span<const Value> args) const;
@@ -80,9 +130,19 @@ class BddFunction {
  private:
   explicit BddFunction(FunctionBase* f) : func_base_(f) {}
 
+  // Builds the BDD for the given nodes which must be in topological order. The
+  // operands of each evaluated node must be included in `nodes`.
+  static absl::StatusOr<std::unique_ptr<BddFunction>> RunOnNodes(
+      FunctionBase* f, absl::Span<Node* const> nodes, int64_t path_limit,
+      std::optional<std::function<bool(const Node*)>> node_filter,
+      int64_t node_limit, int64_t reorder_threshold);
+
   FunctionBase* func_base_;
   BinaryDecisionDiagram bdd_;
 
+  // The bits-typed nodes in the BDD in topological order.
+  std::vector<Node*> nodes_;
+
   // A map from XLS Node to vector of BDD nodes representing the XLS Node's
   // expression.
   NodeMap node_map_;
@@ -19,6 +19,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/ir_converter.h"
 #include "xls/dslx/parse_and_typecheck.h"
@@ -27,6 +28,7 @@
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node_iterator.h"
 #include "xls/ir/package.h"
 #include "xls/passes/bdd_function_test.inc"
 
@@ -112,6 +114,100 @@ TEST_F(BddFunctionTest, Parity) {
   }
 }
 
+TEST_F(BddFunctionTest, NodeLimit) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue parity = fb.Literal(UBits(0, 1));
+  for (int64_t i = 0; i < 32; ++i) {
+    parity = fb.Xor(parity, fb.BitSlice(x, i, 1));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BddFunction> unlimited,
+      BddFunction::Run(f, /*path_limit=*/0, /*node_filter=*/absl::nullopt,
+                       /*node_limit=*/0));
+  const int64_t kNumSamples = 100;
+  std::minstd_rand engine;
+  // With the smaller limits the limit is reached part way through the
+  // function and the remaining nodes are modeled as variables.
+  for (int64_t node_limit : {40, 64, 128}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<BddFunction> bdd_function,
+        BddFunction::Run(f, /*path_limit=*/0, /*node_filter=*/absl::nullopt,
+                         node_limit));
+    EXPECT_LE(bdd_function->bdd().size(), unlimited->bdd().size());
+    for (int64_t i = 0; i < kNumSamples; ++i) {
+      std::vector<Value> inputs = RandomFunctionArguments(f, &engine);
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Value expected, DropInterpreterEvents(InterpretFunction(f, inputs)));
+      XLS_ASSERT_OK_AND_ASSIGN(Value actual, bdd_function->Evaluate(inputs));
+      EXPECT_EQ(expected, actual);
+    }
+  }
+}
+
+TEST_F(BddFunctionTest, ShardedIndependentCones) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue x_masked = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  BValue y_masked = fb.Or(y, fb.Literal(UBits(0xf0, 8)));
+  // The add is not evaluated with the BDD so it does not connect the cones of
+  // `x` and `y`.
+  BValue sum = fb.Add(x_masked, y_masked);
+  fb.Not(sum);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::vector<std::vector<Node*>> partitions =
+      BddFunction::PartitionIntoCones(f, /*max_partitions=*/3);
+  ASSERT_EQ(partitions.size(), 3);
+  absl::flat_hash_map<Node*, int64_t> partition_of;
+  for (int64_t i = 0; i < partitions.size(); ++i) {
+    for (Node* node : partitions[i]) {
+      EXPECT_TRUE(partition_of.emplace(node, i).second);
+    }
+  }
+  EXPECT_EQ(partition_of.size(), f->node_count());
+  EXPECT_NE(partition_of.at(x.node()), partition_of.at(y.node()));
+  EXPECT_NE(partition_of.at(x.node()), partition_of.at(sum.node()));
+  EXPECT_NE(partition_of.at(y.node()), partition_of.at(sum.node()));
+  EXPECT_EQ(partition_of.at(x.node()), partition_of.at(x_masked.node()));
+  EXPECT_EQ(partition_of.at(y.node()), partition_of.at(y_masked.node()));
+  EXPECT_EQ(partition_of.at(f->return_value()), partition_of.at(sum.node()));
+
+  // Asking for a single partition returns all nodes in topological order.
+  std::vector<std::vector<Node*>> single =
+      BddFunction::PartitionIntoCones(f, /*max_partitions=*/1);
+  ASSERT_EQ(single.size(), 1);
+  std::vector<Node*> topo_order;
+  for (Node* node : TopoSort(f)) {
+    topo_order.push_back(node);
+  }
+  EXPECT_EQ(single.front(), topo_order);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::unique_ptr<BddFunction>> shards,
+                           BddFunction::RunSharded(f, /*shard_count=*/3));
+  ASSERT_EQ(shards.size(), 3);
+  std::minstd_rand engine;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Value> inputs = RandomFunctionArguments(f, &engine);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Value expected, DropInterpreterEvents(InterpretFunction(f, inputs)));
+    for (const std::unique_ptr<BddFunction>& shard : shards) {
+      XLS_ASSERT_OK_AND_ASSIGN(Value actual, shard->Evaluate(inputs));
+      EXPECT_EQ(expected, actual);
+    }
+  }
+  for (int64_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(shards[partition_of.at(x_masked.node())]->GetBddNode(
+                  x_masked.node(), 4 + i),
+              shards[partition_of.at(x_masked.node())]->bdd().zero());
+  }
+}
+
 TEST_F(BddFunctionTest, BenchmarkTest) {
   // Run samples through various bechmarks and verify against the interpreter.
   //
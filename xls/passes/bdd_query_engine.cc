@@ -14,6 +14,9 @@
 
 #include "xls/passes/bdd_query_engine.h"
 
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
@@ -27,14 +30,23 @@
 namespace xls {
 
 absl::StatusOr<ReachedFixpoint> BddQueryEngine::Populate(FunctionBase* f) {
-  XLS_ASSIGN_OR_RETURN(bdd_function_,
-                       BddFunction::Run(f, path_limit_, node_filter_));
+  XLS_ASSIGN_OR_RETURN(
+      bdd_functions_,
+      BddFunction::RunSharded(f, shard_count_, path_limit_, node_filter_,
+                              node_limit_, reorder_threshold_));
+  node_shards_.clear();
+  for (const std::unique_ptr<BddFunction>& shard : bdd_functions_) {
+    for (Node* node : shard->nodes()) {
+      node_shards_[node] = shard.get();
+    }
+  }
+
   // Construct the Bits objects indication which bit values are statically known
   // for each node and what those values are (0 or 1) if known.
-  BinaryDecisionDiagram& bdd = this->bdd();
   ReachedFixpoint rf = ReachedFixpoint::Unchanged;
   for (Node* node : f->nodes()) {
     if (node->GetType()->IsBits()) {
+      BinaryDecisionDiagram& bdd = this->bdd(node);
       absl::InlinedVector<bool, 1> known_bits;
       absl::InlinedVector<bool, 1> bits_values;
       for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
@@ -77,50 +89,79 @@ bool BddQueryEngine::AtMostOneTrue(
     return false;
   }
 
-  BddNodeIndex result = bdd().zero();
   for (const TreeBitLocation& loc : bits) {
     if (!IsTracked(loc.node())) {
       return false;
     }
   }
 
+  // Bits in different shards depend on disjoint sets of variables so if bits
+  // in two different shards can each be true they can be true simultaneously.
+  // Bits which are always false can be ignored.
+  BinaryDecisionDiagram* shard_bdd = nullptr;
+  std::vector<BddNodeIndex> bdd_nodes;
+  for (const TreeBitLocation& loc : bits) {
+    BinaryDecisionDiagram& bdd = this->bdd(loc.node());
+    BddNodeIndex bdd_node = GetBddNode(loc);
+    if (bdd_node == bdd.zero()) {
+      continue;
+    }
+    if (shard_bdd != nullptr && shard_bdd != &bdd) {
+      return false;
+    }
+    shard_bdd = &bdd;
+    bdd_nodes.push_back(bdd_node);
+  }
+  if (shard_bdd == nullptr) {
+    return true;
+  }
+  BinaryDecisionDiagram& bdd = *shard_bdd;
+
   // Compute the OR-reduction of a pairwise AND of all bits. If this value is
   // zero then no two bits can be simultaneously true. Equivalently: at most one
   // bit is true.
-  for (int64_t i = 0; i < bits.size(); ++i) {
-    for (int64_t j = i + 1; j < bits.size(); ++j) {
-      result =
-          bdd().Or(result, bdd().And(GetBddNode(bits[i]), GetBddNode(bits[j])));
-      if (ExceedsPathLimit(result)) {
+  BddNodeIndex result = bdd.zero();
+  for (int64_t i = 0; i < bdd_nodes.size(); ++i) {
+    for (int64_t j = i + 1; j < bdd_nodes.size(); ++j) {
+      result = bdd.Or(result, bdd.And(bdd_nodes[i], bdd_nodes[j]));
+      if (ExceedsPathLimit(bdd, result)) {
         XLS_VLOG(3) << "AtMostOneTrue exceeded path limit of " << path_limit_;
         return false;
       }
     }
   }
-  return result == bdd().zero();
+  return result == bdd.zero();
 }
 
 bool BddQueryEngine::AtLeastOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
-  BddNodeIndex result = bdd().zero();
   // At least one bit is true is equivalent to an OR-reduction of all the bits.
+  // Shards share no variables so the OR-reduction is one only if the
+  // OR-reduction of the bits of a single shard is one.
+  absl::flat_hash_map<BinaryDecisionDiagram*, BddNodeIndex> shard_results;
   for (const TreeBitLocation& location : bits) {
     if (!IsTracked(location.node())) {
       return false;
     }
-    result = bdd().Or(result, GetBddNode(location));
-    if (ExceedsPathLimit(result)) {
+    BinaryDecisionDiagram& bdd = this->bdd(location.node());
+    BddNodeIndex& result =
+        shard_results.try_emplace(&bdd, bdd.zero()).first->second;
+    result = bdd.Or(result, GetBddNode(location));
+    if (ExceedsPathLimit(bdd, result)) {
       XLS_VLOG(3) << "AtLeastOneTrue exceeded path limit of " << path_limit_;
       return false;
     }
+    if (result == bdd.one()) {
+      return true;
+    }
   }
-  return result == bdd().one();
+  return false;
 }
 
-bool BddQueryEngine::Implies(const BddNodeIndex& a,
+bool BddQueryEngine::Implies(BinaryDecisionDiagram& bdd, const BddNodeIndex& a,
                              const BddNodeIndex& b) const {
   // A implies B  <=>  !(A && !B)
-  return bdd().And(a, bdd().Not(b)) == bdd().zero();
+  return bdd.And(a, bdd.Not(b)) == bdd.zero();
 }
 
 bool BddQueryEngine::Implies(const TreeBitLocation& a,
@@ -128,7 +169,13 @@ bool BddQueryEngine::Implies(const TreeBitLocation& a,
   if (!IsTracked(a.node()) || !IsTracked(b.node())) {
     return false;
   }
-  return Implies(GetBddNode(a), GetBddNode(b));
+  BinaryDecisionDiagram& bdd_a = bdd(a.node());
+  BinaryDecisionDiagram& bdd_b = bdd(b.node());
+  if (&bdd_a != &bdd_b) {
+    // Bits in different shards are independent.
+    return GetBddNode(a) == bdd_a.zero() || GetBddNode(b) == bdd_b.one();
+  }
+  return Implies(bdd_a, GetBddNode(a), GetBddNode(b));
 }
 
 std::optional<Bits> BddQueryEngine::ImpliedNodeValue(
@@ -138,27 +185,38 @@ std::optional<Bits> BddQueryEngine::ImpliedNodeValue(
     return absl::nullopt;
   }
 
-  // Create a Bdd node for the predicate_bit_values.
-  BddNodeIndex bdd_predicate_bit = bdd().one();
+  // Create a Bdd node for the predicate_bit_values in each shard. The
+  // predicate bits in other shards than `node` are independent of `node` so
+  // they only matter if they can't be satisfied.
+  absl::flat_hash_map<BinaryDecisionDiagram*, BddNodeIndex> shard_predicates;
   for (const auto& [conjuction_bit_location, conjunction_value] :
        predicate_bit_values) {
+    BinaryDecisionDiagram& bdd = this->bdd(conjuction_bit_location.node());
     BddNodeIndex conjuction_bit = GetBddNode(conjuction_bit_location);
     conjuction_bit =
-        conjunction_value ? conjuction_bit : bdd().Not(conjuction_bit);
-    bdd_predicate_bit = bdd().And(bdd_predicate_bit, conjuction_bit);
+        conjunction_value ? conjuction_bit : bdd.Not(conjuction_bit);
+    BddNodeIndex& shard_predicate =
+        shard_predicates.try_emplace(&bdd, bdd.one()).first->second;
+    shard_predicate = bdd.And(shard_predicate, conjuction_bit);
   }
   // If the predicate evaluates to false, we can't determine
   // what node value it implies. That is, !predicate || node_bit
   // evaluates to true for both node_bit == 1 and == 0.
-  if (bdd_predicate_bit == bdd().zero()) {
-    return absl::nullopt;
+  for (const auto& [bdd, shard_predicate] : shard_predicates) {
+    if (shard_predicate == bdd->zero()) {
+      return absl::nullopt;
+    }
   }
+  BinaryDecisionDiagram& bdd = this->bdd(node);
+  auto it = shard_predicates.find(&bdd);
+  BddNodeIndex bdd_predicate_bit =
+      it == shard_predicates.end() ? bdd.one() : it->second;
 
   auto implied_true_or_false = [&](int node_idx, bool node_bit_true) {
     BddNodeIndex bdd_node_bit = GetBddNode(TreeBitLocation(node, node_idx));
     BddNodeIndex qualified_bdd_node_bit =
-        node_bit_true ? bdd_node_bit : bdd().Not(bdd_node_bit);
-    return Implies(bdd_predicate_bit, qualified_bdd_node_bit);
+        node_bit_true ? bdd_node_bit : bdd.Not(bdd_node_bit);
+    return Implies(bdd, bdd_predicate_bit, qualified_bdd_node_bit);
   };
 
   // Check if bdd_predicate_bit implies that node has a particular value for
@@ -183,6 +241,13 @@ bool BddQueryEngine::KnownEquals(const TreeBitLocation& a,
   if (!IsTracked(a.node()) || !IsTracked(b.node())) {
     return false;
   }
+  BinaryDecisionDiagram& bdd_a = bdd(a.node());
+  BinaryDecisionDiagram& bdd_b = bdd(b.node());
+  if (&bdd_a != &bdd_b) {
+    // Independent bits are only equal if they are the same constant.
+    return (GetBddNode(a) == bdd_a.zero() && GetBddNode(b) == bdd_b.zero()) ||
+           (GetBddNode(a) == bdd_a.one() && GetBddNode(b) == bdd_b.one());
+  }
   return GetBddNode(a) == GetBddNode(b);
 }
 
@@ -191,7 +256,14 @@ bool BddQueryEngine::KnownNotEquals(const TreeBitLocation& a,
   if (!IsTracked(a.node()) || !IsTracked(b.node())) {
     return false;
   }
-  return GetBddNode(a) == bdd().Not(GetBddNode(b));
+  BinaryDecisionDiagram& bdd_a = bdd(a.node());
+  BinaryDecisionDiagram& bdd_b = bdd(b.node());
+  if (&bdd_a != &bdd_b) {
+    // Independent bits are only unequal if they are opposite constants.
+    return (GetBddNode(a) == bdd_a.zero() && GetBddNode(b) == bdd_b.one()) ||
+           (GetBddNode(a) == bdd_a.one() && GetBddNode(b) == bdd_b.zero());
+  }
+  return GetBddNode(a) == bdd_a.Not(GetBddNode(b));
 }
 
 }  // namespace xls
@@ -17,6 +17,7 @@
 
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "xls/ir/bits.h"
@@ -40,11 +41,25 @@ class BddQueryEngine : public QueryEngine {
   // terminals 0 and 1 to allow for a BDD expression before truncating it.
   // `node_filter` is an optional function which can be used to limit the nodes
   // which the BDD evaluates (returning false means the node will node be
-  // evaluated). See BddFunction for details.
-  explicit BddQueryEngine(int64_t path_limit = 0,
-                          std::optional<std::function<bool(const Node*)>>
-                              node_filter = absl::nullopt)
-      : path_limit_(path_limit), node_filter_(node_filter) {}
+  // evaluated). `node_limit` bounds the number of nodes in the BDD and
+  // `reorder_threshold` is the BDD size at which variables are reordered to
+  // shrink the BDD. See BddFunction for details. If `shard_count` is greater
+  // than one the function is partitioned into up to that many groups of
+  // independent cones whose BDDs are built concurrently (see
+  // BddFunction::RunSharded). Queries spanning several shards are answered
+  // exactly using the independence of the shards.
+  explicit BddQueryEngine(
+      int64_t path_limit = 0,
+      std::optional<std::function<bool(const Node*)>> node_filter =
+          absl::nullopt,
+      int64_t node_limit = BddFunction::kDefaultNodeLimit,
+      int64_t reorder_threshold = BddFunction::kDefaultReorderThreshold,
+      int64_t shard_count = 1)
+      : path_limit_(path_limit),
+        node_filter_(node_filter),
+        node_limit_(node_limit),
+        reorder_threshold_(reorder_threshold),
+        shard_count_(shard_count) {}
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
@@ -73,33 +88,51 @@ class BddQueryEngine : public QueryEngine {
   bool KnownNotEquals(const TreeBitLocation& a,
                       const TreeBitLocation& b) const override;
 
-  // Returns the underlying BddFunction representing the XLS function.
-  const BddFunction& bdd_function() const { return *bdd_function_; }
+  // Returns the underlying BddFunction representing the XLS function. The
+  // engine must have a single shard.
+  const BddFunction& bdd_function() const {
+    XLS_CHECK_EQ(bdd_functions_.size(), 1);
+    return *bdd_functions_.front();
+  }
+
+  // Returns the BddFunction of the shard containing the given bits-typed node.
+  const BddFunction& GetBddFunction(Node* node) const {
+    return *node_shards_.at(node);
+  }
+
+  // Returns the number of shards the function was partitioned into.
+  int64_t shard_count() const { return bdd_functions_.size(); }
 
  private:
-  // Returns the underlying BDD. This method is const, but queries on a BDD
-  // generally mutate the object. We sneakily avoid conflicts with C++ const
-  // because the BDD is only held indirectly via pointers.
+  // Returns the BDD of the shard containing the given node. This method is
+  // const, but queries on a BDD generally mutate the object. We sneakily avoid
+  // conflicts with C++ const because the BDD is only held indirectly via
+  // pointers.
   // TODO(meheff): Enable queries on a BDD with out mutating the BDD itself.
-  BinaryDecisionDiagram& bdd() const { return bdd_function_->bdd(); }
+  BinaryDecisionDiagram& bdd(Node* node) const {
+    return node_shards_.at(node)->bdd();
+  }
 
   // Returns the BDD node associated with the given bit.
   BddNodeIndex GetBddNode(const TreeBitLocation& location) const {
     XLS_CHECK(location.tree_index().empty());
     XLS_CHECK(location.node()->GetType()->IsBits());
-    return bdd_function_->GetBddNode(location.node(), location.bit_index());
+    return node_shards_.at(location.node())
+        ->GetBddNode(location.node(), location.bit_index());
   }
 
   // A implies B  <=>  !(A && !B)
-  bool Implies(const BddNodeIndex& a, const BddNodeIndex& b) const;
+  bool Implies(BinaryDecisionDiagram& bdd, const BddNodeIndex& a,
+               const BddNodeIndex& b) const;
 
   // Returns true if the expression of the given BDD node exceeds the path
   // limit.
   // TODO(meheff): This should be part of the BDD itself where a query can be
   // performed and the BDD method returns a union of path limit exceeded or
   // the result of the query.
-  bool ExceedsPathLimit(BddNodeIndex node) const {
-    return path_limit_ > 0 && bdd().GetNode(node).path_count > path_limit_;
+  bool ExceedsPathLimit(const BinaryDecisionDiagram& bdd,
+                        BddNodeIndex node) const {
+    return path_limit_ > 0 && bdd.GetNode(node).path_count > path_limit_;
   }
 
   // The maximum number of paths in expression in the BDD before truncating.
@@ -107,13 +140,25 @@ class BddQueryEngine : public QueryEngine {
 
   std::optional<std::function<bool(const Node*)>> node_filter_;
 
+  // The maximum number of nodes in the BDD.
+  int64_t node_limit_;
+
+  // The BDD size at which the variables are first reordered.
+  int64_t reorder_threshold_;
+
+  // The maximum number of independently built BDDs.
+  int64_t shard_count_;
+
   // Indicates the bits at the output of each node which have known values.
   absl::flat_hash_map<Node*, Bits> known_bits_;
 
   // Indicates the values of bits at the output of each node (if known)
   absl::flat_hash_map<Node*, Bits> bits_values_;
 
-  std::unique_ptr<BddFunction> bdd_function_;
+  // The BddFunction of each shard and the shard containing each bits-typed
+  // node. The shards have disjoint sets of BDD variables.
+  std::vector<std::unique_ptr<BddFunction>> bdd_functions_;
+  absl::flat_hash_map<Node*, BddFunction*> node_shards_;
 };
 
 }  // namespace xls
@@ -83,6 +83,58 @@ TEST_F(BddQueryEngineTest, EqualToPredicates) {
       query_engine.AtLeastOneNodeTrue({x_eq_42.node(), y_eq_42.node()}));
 }
 
+TEST_F(BddQueryEngineTest, ShardedQueries) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue x_eq_0 = fb.Eq(x, fb.Literal(UBits(0, 8)));
+  BValue x_ne_0 = fb.Not(x_eq_0);
+  BValue x_eq_7 = fb.Eq(x, fb.Literal(UBits(7, 8)));
+  BValue x_false = fb.And(x_eq_0, x_ne_0);
+  BValue y_eq_7 = fb.Eq(y, fb.Literal(UBits(7, 8)));
+  BValue y_false = fb.And(y_eq_7, fb.Not(y_eq_7));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  BddQueryEngine query_engine(
+      /*path_limit=*/0, /*node_filter=*/absl::nullopt,
+      /*node_limit=*/BddFunction::kDefaultNodeLimit,
+      /*reorder_threshold=*/BddFunction::kDefaultReorderThreshold,
+      /*shard_count=*/2);
+  XLS_ASSERT_OK(query_engine.Populate(f).status());
+  ASSERT_EQ(query_engine.shard_count(), 2);
+  EXPECT_NE(&query_engine.GetBddFunction(x.node()),
+            &query_engine.GetBddFunction(y.node()));
+
+  // Queries within a shard.
+  EXPECT_TRUE(KnownNotEquals(query_engine, x_eq_0.node(), x_ne_0.node()));
+  EXPECT_TRUE(query_engine.AtMostOneNodeTrue({x_eq_0.node(), x_eq_7.node()}));
+  EXPECT_TRUE(query_engine.IsAllZeros(x_false.node()));
+  EXPECT_TRUE(query_engine.IsAllZeros(y_false.node()));
+
+  // Queries across shards.
+  EXPECT_FALSE(Implies(query_engine, x_eq_7.node(), y_eq_7.node()));
+  EXPECT_TRUE(Implies(query_engine, x_false.node(), y_eq_7.node()));
+  EXPECT_FALSE(KnownEquals(query_engine, x_eq_7.node(), y_eq_7.node()));
+  EXPECT_TRUE(KnownEquals(query_engine, x_false.node(), y_false.node()));
+  EXPECT_FALSE(KnownNotEquals(query_engine, x_eq_7.node(), y_eq_7.node()));
+  EXPECT_FALSE(query_engine.AtMostOneNodeTrue({x_eq_0.node(), y_eq_7.node()}));
+  EXPECT_TRUE(query_engine.AtMostOneNodeTrue(
+      {x_eq_0.node(), x_eq_7.node(), y_false.node()}));
+  EXPECT_FALSE(query_engine.AtLeastOneNodeTrue({x_eq_0.node(), y_eq_7.node()}));
+  EXPECT_TRUE(query_engine.AtLeastOneNodeTrue(
+      {x_eq_0.node(), y_eq_7.node(), x_ne_0.node()}));
+
+  std::optional<Bits> implied = query_engine.ImpliedNodeValue(
+      {{{x_eq_0.node(), 0}, true}, {{y_eq_7.node(), 0}, true}}, x.node());
+  ASSERT_TRUE(implied.has_value());
+  EXPECT_EQ(implied.value(), UBits(0, 8));
+  EXPECT_FALSE(query_engine
+                   .ImpliedNodeValue({{{x_eq_0.node(), 0}, true},
+                                      {{y_false.node(), 0}, true}},
+                                     x.node())
+                   .has_value());
+}
+
 TEST_F(BddQueryEngineTest, VariousComparisonPredicates) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
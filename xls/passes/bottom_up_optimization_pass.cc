@@ -0,0 +1,209 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/bottom_up_optimization_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/casts.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/op.h"
+#include "xls/ir/type.h"
+
+namespace xls {
+namespace {
+
+// Returns whether the pass is enabled by the run_only_passes and skip_passes
+// options.
+bool IsPassEnabled(const Pass* pass, const PassOptions& options) {
+  if (options.run_only_passes.has_value() &&
+      std::find(options.run_only_passes->begin(),
+                options.run_only_passes->end(),
+                pass->short_name()) == options.run_only_passes->end()) {
+    return false;
+  }
+  return std::find(options.skip_passes.begin(), options.skip_passes.end(),
+                   pass->short_name()) == options.skip_passes.end();
+}
+
+// Appends the enabled leaf passes of 'pass', in the order in which they would
+// be run, to 'leaves'.
+absl::Status CollectFunctionBasePasses(
+    const Pass* pass, const PassOptions& options,
+    std::vector<const FunctionBasePass*>* leaves) {
+  if (pass->IsCompound()) {
+    for (const Pass* nested : down_cast<const CompoundPass*>(pass)->passes()) {
+      XLS_RETURN_IF_ERROR(CollectFunctionBasePasses(nested, options, leaves));
+    }
+    return absl::OkStatus();
+  }
+  const FunctionBasePass* function_base_pass =
+      dynamic_cast<const FunctionBasePass*>(pass);
+  XLS_RET_CHECK(function_base_pass != nullptr)
+      << "Pass " << pass->short_name() << " is not a function base pass";
+  if (IsPassEnabled(pass, options)) {
+    leaves->push_back(function_base_pass);
+  }
+  return absl::OkStatus();
+}
+
+// Returns the functions called by invokes in the package in a post order of
+// the call graph.
+std::vector<Function*> InvokedFunctionsInPostOrder(Package* p) {
+  absl::flat_hash_set<Function*> invoked;
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    for (Node* node : f->nodes()) {
+      if (node->Is<Invoke>()) {
+        invoked.insert(node->As<Invoke>()->to_apply());
+      }
+    }
+  }
+  std::vector<Function*> result;
+  for (FunctionBase* f : FunctionsInPostOrder(p)) {
+    if (f->IsFunction() && invoked.contains(f->AsFunctionOrDie())) {
+      result.push_back(f->AsFunctionOrDie());
+    }
+  }
+  return result;
+}
+
+// Returns whether the function may be replaced by a function for which
+// Function::IsDefinitelyEqualTo holds. That comparison only examines the nodes
+// which the return value depends on, so functions with side effects elsewhere
+// are excluded.
+bool IsMemoizable(Function* f) {
+  return std::none_of(f->nodes().begin(), f->nodes().end(), [](Node* node) {
+    return OpIsSideEffecting(node->op()) && !node->Is<Param>();
+  });
+}
+
+// Returns a hash of the structure of the function: the ops, types and operand
+// positions of its nodes in topological order. Functions for which
+// Function::IsDefinitelyEqualTo holds and whose nodes are in the same order
+// have the same hash.
+uint64_t FunctionStructuralHash(Function* f) {
+  absl::flat_hash_map<Node*, int64_t> node_positions;
+  uint64_t hash = absl::Hash<int64_t>()(f->params().size());
+  for (Node* node : TopoSort(f)) {
+    std::vector<int64_t> operand_positions;
+    operand_positions.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operand_positions.push_back(node_positions.at(operand));
+    }
+    hash = absl::Hash<std::tuple<uint64_t, Op, const Type*,
+                                 std::vector<int64_t>>>()(std::make_tuple(
+        hash, node->op(), node->GetType(), std::move(operand_positions)));
+    node_positions[node] = node_positions.size();
+  }
+  return absl::Hash<std::pair<uint64_t, int64_t>>()(
+      {hash, node_positions.at(f->return_value())});
+}
+
+// Redirects invokes of functions which are structurally identical to an
+// earlier function in a post order of the call graph to that earlier
+// function. Returns true if any invoke was changed.
+absl::StatusOr<bool> MergeIdenticalCallees(Package* p) {
+  absl::flat_hash_map<uint64_t, std::vector<Function*>> representatives;
+  absl::flat_hash_map<Function*, Function*> replacements;
+  bool changed = false;
+  for (FunctionBase* f : FunctionsInPostOrder(p)) {
+    // Callees precede callers in the post order so the invokes of 'f' are
+    // redirected before 'f' itself is compared to other functions.
+    std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+    for (Node* node : nodes) {
+      if (!node->Is<Invoke>()) {
+        continue;
+      }
+      auto it = replacements.find(node->As<Invoke>()->to_apply());
+      if (it == replacements.end()) {
+        continue;
+      }
+      XLS_VLOG(3) << absl::StreamFormat("Redirecting %s from %s to %s",
+                                        node->GetName(),
+                                        node->As<Invoke>()->to_apply()->name(),
+                                        it->second->name());
+      XLS_RETURN_IF_ERROR(
+          node->ReplaceUsesWithNew<Invoke>(node->operands(), it->second)
+              .status());
+      XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+      changed = true;
+    }
+    if (!f->IsFunction() || !IsMemoizable(f->AsFunctionOrDie())) {
+      continue;
+    }
+    Function* function = f->AsFunctionOrDie();
+    std::vector<Function*>& candidates =
+        representatives[FunctionStructuralHash(function)];
+    auto it = std::find_if(
+        candidates.begin(), candidates.end(),
+        [&](Function* other) { return other->IsDefinitelyEqualTo(function); });
+    if (it == candidates.end()) {
+      candidates.push_back(function);
+    } else {
+      replacements[function] = *it;
+    }
+  }
+  return changed;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> BottomUpOptimizationPass::RunInternal(
+    Package* p, const PassOptions& options, PassResults* results) const {
+  if (!options.bottom_up_optimization) {
+    return false;
+  }
+  std::vector<const FunctionBasePass*> leaves;
+  for (const std::unique_ptr<Pass>& pass : passes_) {
+    XLS_RETURN_IF_ERROR(
+        CollectFunctionBasePasses(pass.get(), options, &leaves));
+  }
+
+  bool changed = false;
+  if (options.memoize_bottom_up_optimization) {
+    XLS_ASSIGN_OR_RETURN(changed, MergeIdenticalCallees(p));
+  }
+
+  // Callees are visited before their callers so each function is optimized
+  // after the functions it invokes.
+  for (Function* f : InvokedFunctionsInPostOrder(p)) {
+    bool function_changed = true;
+    while (function_changed) {
+      function_changed = false;
+      for (const FunctionBasePass* pass : leaves) {
+        XLS_ASSIGN_OR_RETURN(bool pass_changed,
+                             pass->RunOnFunctionBase(f, options, results));
+        function_changed |= pass_changed;
+      }
+      changed |= function_changed;
+    }
+  }
+  return changed;
+}
+
+}  // namespace xls
@@ -0,0 +1,66 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_BOTTOM_UP_OPTIMIZATION_PASS_H_
+#define XLS_PASSES_BOTTOM_UP_OPTIMIZATION_PASS_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/passes/passes.h"
+
+namespace xls {
+
+// Pass which optimizes each invoked function on its own before it is inlined.
+// Functions are visited in a post order of the call graph (callees before
+// callers) and the contained passes are run on each invoked function to fixed
+// point. A function which is later inlined at several call sites is then
+// optimized once rather than once per copy.
+//
+// The pass only runs if PassOptions::bottom_up_optimization is set. If
+// PassOptions::memoize_bottom_up_optimization is also set, invokes of
+// structurally identical functions are first redirected to a single
+// representative so that only the representative is optimized.
+//
+// The contained passes (and the leaves of any contained compound passes) must
+// be FunctionBasePasses.
+class BottomUpOptimizationPass : public Pass {
+ public:
+  BottomUpOptimizationPass()
+      : Pass("bottom_up", "Bottom-up optimization of invoked functions") {}
+  ~BottomUpOptimizationPass() override {}
+
+  // Adds a pass to run on each invoked function. Arguments to method are the
+  // arguments to the pass constructor. Returns a pointer to the newly
+  // constructed pass.
+  template <typename T, typename... Args>
+  T* Add(Args&&... args) {
+    auto* pass = new T(std::forward<Args>(args)...);
+    passes_.emplace_back(pass);
+    return pass;
+  }
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
+                                   PassResults* results) const override;
+
+ private:
+  std::vector<std::unique_ptr<Pass>> passes_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_BOTTOM_UP_OPTIMIZATION_PASS_H_
@@ -0,0 +1,141 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/bottom_up_optimization_pass.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/arith_simplification_pass.h"
+#include "xls/passes/dce_pass.h"
+#include "xls/passes/passes.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class BottomUpOptimizationPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Package* p, bool enabled, bool memoize = false) {
+    BottomUpOptimizationPass pass;
+    pass.Add<ArithSimplificationPass>(kMaxOptLevel);
+    pass.Add<DeadCodeEliminationPass>();
+    PassOptions options;
+    options.bottom_up_optimization = enabled;
+    options.memoize_bottom_up_optimization = memoize;
+    PassResults results;
+    return pass.Run(p, options, &results);
+  }
+};
+
+TEST_F(BottomUpOptimizationPassTest, DisabledByDefault) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package some_package
+
+fn callee(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret add.2: bits[32] = add(x, literal.1)
+}
+
+top fn caller(a: bits[32]) -> bits[32] {
+  ret invoke.3: bits[32] = invoke(a, to_apply=callee)
+}
+)"));
+  EXPECT_THAT(Run(p.get(), /*enabled=*/false), IsOkAndHolds(false));
+}
+
+TEST_F(BottomUpOptimizationPassTest, OptimizesInvokedFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package some_package
+
+fn leaf(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret add.2: bits[32] = add(x, literal.1)
+}
+
+fn middle(x: bits[32]) -> bits[32] {
+  invoke.3: bits[32] = invoke(x, to_apply=leaf)
+  literal.4: bits[32] = literal(value=0)
+  ret add.5: bits[32] = add(invoke.3, literal.4)
+}
+
+top fn caller(a: bits[32]) -> bits[32] {
+  invoke.6: bits[32] = invoke(a, to_apply=middle)
+  literal.7: bits[32] = literal(value=0)
+  ret add.8: bits[32] = add(invoke.6, literal.7)
+}
+)"));
+  ASSERT_THAT(Run(p.get(), /*enabled=*/true), IsOkAndHolds(true));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * leaf, p->GetFunction("leaf"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * middle, p->GetFunction("middle"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * caller, p->GetFunction("caller"));
+  EXPECT_THAT(leaf->return_value(), m::Param("x"));
+  EXPECT_THAT(middle->return_value(), m::Invoke(m::Param("x")));
+  // Functions which are not invoked are left alone.
+  EXPECT_THAT(caller->return_value(), m::Add(m::Invoke(), m::Literal(0)));
+}
+
+TEST_F(BottomUpOptimizationPassTest, MemoizesIdenticalCallees) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package some_package
+
+fn foo(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret add.2: bits[32] = add(x, literal.1)
+}
+
+fn bar(y: bits[32]) -> bits[32] {
+  literal.3: bits[32] = literal(value=0)
+  ret add.4: bits[32] = add(y, literal.3)
+}
+
+fn baz(z: bits[32]) -> bits[32] {
+  literal.5: bits[32] = literal(value=1)
+  ret add.6: bits[32] = add(z, literal.5)
+}
+
+top fn caller(a: bits[32]) -> bits[32] {
+  invoke.7: bits[32] = invoke(a, to_apply=foo)
+  invoke.8: bits[32] = invoke(invoke.7, to_apply=bar)
+  ret invoke.9: bits[32] = invoke(invoke.8, to_apply=baz)
+}
+)"));
+  ASSERT_THAT(Run(p.get(), /*enabled=*/true, /*memoize=*/true),
+              IsOkAndHolds(true));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * baz, p->GetFunction("baz"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * caller, p->GetFunction("caller"));
+  Node* baz_invoke = caller->return_value();
+  Node* bar_invoke = baz_invoke->operand(0);
+  Node* foo_invoke = bar_invoke->operand(0);
+  EXPECT_EQ(baz_invoke->As<Invoke>()->to_apply(), baz);
+  Function* representative = foo_invoke->As<Invoke>()->to_apply();
+  EXPECT_EQ(bar_invoke->As<Invoke>()->to_apply(), representative);
+  EXPECT_THAT(representative->return_value(), m::Param());
+  EXPECT_THAT(baz->return_value(), m::Add(m::Param("z"), m::Literal(1)));
+}
+
+}  // namespace
+}  // namespace xls
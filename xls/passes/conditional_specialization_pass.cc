@@ -15,6 +15,7 @@
 #include "xls/passes/conditional_specialization_pass.h"
 
 #include "absl/algorithm/container.h"
+#include "absl/container/btree_set.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/ir/bits_ops.h"
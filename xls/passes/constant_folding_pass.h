@@ -28,6 +28,8 @@ class ConstantFoldingPass : public FunctionBasePass {
   ConstantFoldingPass() : FunctionBasePass("const_fold", "Constant folding") {}
   ~ConstantFoldingPass() override {}
 
+  bool IsFunctionLocal() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
@@ -57,6 +57,8 @@ class CsePass : public FunctionBasePass {
   CsePass() : FunctionBasePass("cse", "Common subexpression elimination") {}
   ~CsePass() override {}
 
+  bool IsFunctionLocal() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
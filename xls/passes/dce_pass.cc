@@ -17,6 +17,7 @@
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/dead_node_worklist.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/op.h"
@@ -31,8 +32,15 @@ absl::StatusOr<bool> DeadCodeEliminationPass::RunOnFunctionBaseInternal(
            !OpIsSideEffecting(n->op());
   };
 
+  // Only nodes which were added or lost a use since the last run can have
+  // become dead. On the first run on a function base every node is a
+  // candidate.
+  DeadNodeWorklist* dead_node_worklist = f->GetDeadNodeWorklist();
+  std::vector<Node*> candidates = dead_node_worklist->TakeCandidates();
+  XLS_VLOG(3) << "DCE considering " << candidates.size() << " of "
+              << f->node_count() << " nodes";
   std::deque<Node*> worklist;
-  for (Node* n : f->nodes()) {
+  for (Node* n : candidates) {
     if (n->users().empty() && is_deletable(n)) {
       worklist.push_back(n);
     }
@@ -57,6 +65,9 @@ absl::StatusOr<bool> DeadCodeEliminationPass::RunOnFunctionBaseInternal(
     XLS_RETURN_IF_ERROR(f->RemoveNode(node));
     removed_count++;
   }
+  // The removals above record the operands of the removed nodes as
+  // candidates, but every such operand was considered in the loop.
+  dead_node_worklist->Clear();
 
   XLS_VLOG(2) << "Removed " << removed_count << " dead nodes";
   return removed_count > 0;
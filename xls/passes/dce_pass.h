@@ -23,9 +23,12 @@
 
 namespace xls {
 
-// class DeadCodeEliminationPass iterates up from a functions result
-// nodes and marks all visited node. After that, all unvisited nodes
-// are considered dead.
+// class DeadCodeEliminationPass removes nodes which have no users and no
+// implicit uses and are not side-effecting, along with any operands which
+// become dead as a result. Only the nodes recorded by the function base's
+// DeadNodeWorklist since the previous run are considered, so the cost of a
+// run is proportional to the changes made by the preceding passes rather than
+// to the size of the function base.
 class DeadCodeEliminationPass : public FunctionBasePass {
  public:
   DeadCodeEliminationPass()
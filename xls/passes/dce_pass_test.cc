@@ -137,5 +137,33 @@ TEST_F(DeadCodeEliminationPassTest, Block) {
   EXPECT_EQ(block->node_count(), 5);
 }
 
+TEST_F(DeadCodeEliminationPassTest, OnlyConsidersChangedNodes) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn func(x: bits[42], y: bits[42]) -> bits[42] {
+       neg.1: bits[42] = neg(x)
+       not.2: bits[42] = not(neg.1)
+       ret sub.3: bits[42] = sub(not.2, y)
+     }
+  )",
+                                                       p.get()));
+  EXPECT_THAT(Run(f), IsOkAndHolds(false));
+  EXPECT_THAT(f->GetDeadNodeWorklist()->TakeCandidates(),
+              ::testing::IsEmpty());
+
+  // Bypassing not.2 makes it and (transitively) neg.1 dead.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * sub, f->GetNode("sub.3"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * x, f->GetNode("x"));
+  XLS_ASSERT_OK(sub->ReplaceOperandNumber(0, x));
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(f->node_count(), 3);
+  EXPECT_THAT(Run(f), IsOkAndHolds(false));
+
+  // Changing the return value makes the old one dead.
+  XLS_ASSERT_OK(f->set_return_value(x));
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(f->node_count(), 2);
+}
+
 }  // namespace
 }  // namespace xls
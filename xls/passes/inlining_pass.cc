@@ -14,6 +14,13 @@
 
 #include "xls/passes/inlining_pass.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
@@ -74,8 +81,10 @@ std::string GetPrefixedLabel(Invoke* invoke, std::string_view label,
 }
 
 // Inlines the node "invoke" by replacing it with the contents of the called
-// function.
-absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
+// function. 'to_inline' is the set of functions being inlined; invokes of
+// other functions may remain in the called function.
+absl::Status InlineInvoke(Invoke* invoke, int inline_count,
+                          const absl::flat_hash_set<Function*>& to_inline) {
   Function* invoked = invoke->to_apply();
   absl::flat_hash_map<Node*, Node*> invoked_node_to_replacement;
   for (int64_t i = 0; i < invoked->params().size(); ++i) {
@@ -88,8 +97,10 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
       // Already taken care of (e.g. parameters above).
       continue;
     }
-    XLS_RET_CHECK(!node->Is<Invoke>())
-        << "No invokes should remain in function to inline: "
+    XLS_RET_CHECK(!node->Is<Invoke>() ||
+                  !to_inline.contains(node->As<Invoke>()->to_apply()))
+        << "No invokes of inlined functions should remain in function to "
+           "inline: "
         << node->GetName();
     std::vector<Node*> new_operands;
     for (Node* operand : node->operands()) {
@@ -171,6 +182,62 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
   return invoke->function_base()->RemoveNode(invoke);
 }
 
+// Returns the functions whose invokes should be inlined. Without a budget this
+// is every invoked function. Otherwise an invoked function is inlined if the
+// number of nodes added to the package by inlining all of its call sites is at
+// most 'node_budget'.
+absl::flat_hash_set<Function*> FunctionsToInline(
+    Package* p, std::optional<int64_t> node_budget) {
+  std::vector<FunctionBase*> post_order = FunctionsInPostOrder(p);
+  absl::flat_hash_set<Function*> to_inline;
+  // The callers of each function through invokes, one entry per call site.
+  absl::flat_hash_map<Function*, std::vector<FunctionBase*>> call_sites;
+  // Functions which are also called by nodes other than invokes (e.g., maps
+  // and counted fors). These functions outlive the inlining of their invokes.
+  absl::flat_hash_set<Function*> otherwise_called;
+  for (FunctionBase* f : post_order) {
+    for (Node* node : f->nodes()) {
+      if (node->Is<Invoke>()) {
+        to_inline.insert(node->As<Invoke>()->to_apply());
+        call_sites[node->As<Invoke>()->to_apply()].push_back(f);
+      } else if (std::optional<Function*> callee = CalledFunction(node)) {
+        otherwise_called.insert(*callee);
+      }
+    }
+  }
+  if (!node_budget.has_value()) {
+    return to_inline;
+  }
+
+  // Decide callers before callees, tracking the number of copies of the body
+  // of each function base which remain after inlining.
+  to_inline.clear();
+  std::optional<FunctionBase*> top = p->GetTop();
+  absl::flat_hash_map<FunctionBase*, int64_t> body_copies;
+  for (auto it = post_order.rbegin(); it != post_order.rend(); ++it) {
+    FunctionBase* f = *it;
+    body_copies[f] = 1;
+    if (!f->IsFunction() || !call_sites.contains(f->AsFunctionOrDie())) {
+      continue;
+    }
+    Function* function = f->AsFunctionOrDie();
+    int64_t inlined_copies = 0;
+    for (FunctionBase* caller : call_sites.at(function)) {
+      inlined_copies += body_copies.at(caller);
+    }
+    bool removable = !otherwise_called.contains(function) &&
+                     (!top.has_value() || top.value() != f);
+    int64_t node_count = std::max<int64_t>(
+        function->node_count() - function->params().size(), 1);
+    int64_t cost = node_count * (inlined_copies - (removable ? 1 : 0));
+    if (cost <= *node_budget) {
+      to_inline.insert(function);
+      body_copies[f] = inlined_copies + (removable ? 0 : 1);
+    }
+  }
+  return to_inline;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> InliningPass::RunInternal(Package* p,
@@ -181,14 +248,21 @@ absl::StatusOr<bool> InliningPass::RunInternal(Package* p,
   // post order of the call graph (leaves first). This ensures that when a
   // function Foo is inlined into its callsites, no invokes remain in Foo. This
   // avoid duplicate work.
+  //
+  // A selective pass only inlines the invokes of the functions chosen by the
+  // cost model (see PassOptions::inlining_node_budget).
+  absl::flat_hash_set<Function*> to_inline = FunctionsToInline(
+      p, selective_ ? options.inlining_node_budget : std::nullopt);
   int inline_count = 0;
   for (FunctionBase* f : FunctionsInPostOrder(p)) {
     // Create copy of nodes() because we will be adding and removing nodes
     // during inlining.
     std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
     for (Node* node : nodes) {
-      if (node->Is<Invoke>()) {
-        XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++));
+      if (node->Is<Invoke>() &&
+          to_inline.contains(node->As<Invoke>()->to_apply())) {
+        XLS_RETURN_IF_ERROR(
+            InlineInvoke(node->As<Invoke>(), inline_count++, to_inline));
         changed = true;
       }
     }
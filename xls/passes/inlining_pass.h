@@ -21,13 +21,26 @@
 
 namespace xls {
 
+// Pass which inlines invocations. By default every invoke is inlined.
+//
+// A selective inlining pass instead consults a cost model if
+// PassOptions::inlining_node_budget is set. A callee is inlined at all of its
+// call sites if doing so adds at most the budgeted number of nodes to the
+// package, counting the copies of the callee made when its callers are
+// themselves inlined. Otherwise the callee is kept as a separate function, so
+// it is optimized once rather than at each of its call sites, and is left for
+// a later non-selective inlining pass.
 class InliningPass : public Pass {
  public:
-  InliningPass() : Pass("inlining", "Inlines invocations") {}
+  explicit InliningPass(bool selective = false)
+      : Pass("inlining", "Inlines invocations"), selective_(selective) {}
 
  protected:
   absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
                                    PassResults* results) const override;
+
+ private:
+  bool selective_;
 };
 
 }  // namespace xls
@@ -43,6 +43,14 @@ class InliningPassTest : public IrTestBase {
                             .status());
     return changed;
   }
+
+  absl::StatusOr<bool> InlineSelectively(Package* package,
+                                         int64_t node_budget) {
+    PassResults results;
+    PassOptions options;
+    options.inlining_node_budget = node_budget;
+    return InliningPass(/*selective=*/true).Run(package, options, &results);
+  }
 };
 
 TEST_F(InliningPassTest, AddWrapper) {
@@ -159,6 +167,95 @@ fn f(foobar: bits[32]) -> bits[32] {
               m::Name("foobar"));
 }
 
+TEST_F(InliningPassTest, SelectiveInliningKeepsLargeMultiUseCallee) {
+  const std::string program = R"(
+package some_package
+
+fn callee(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  umul.2: bits[32] = umul(add.1, y)
+  ret sub.3: bits[32] = sub(umul.2, x)
+}
+
+top fn caller(a: bits[32], b: bits[32]) -> bits[32] {
+  invoke.4: bits[32] = invoke(a, b, to_apply=callee)
+  ret invoke.5: bits[32] = invoke(invoke.4, b, to_apply=callee)
+}
+)";
+
+  // Inlining both call sites would add one copy of the three nodes of
+  // 'callee' to the package.
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  Function* f = FindFunction("caller", package.get());
+  ASSERT_THAT(InlineSelectively(package.get(), /*node_budget=*/2),
+              IsOkAndHolds(false));
+  EXPECT_THAT(f->return_value(), m::Invoke(m::Invoke(), m::Param("b")));
+
+  ASSERT_THAT(InlineSelectively(package.get(), /*node_budget=*/3),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Sub(m::UMul(), m::Sub()));
+}
+
+TEST_F(InliningPassTest, SelectiveInliningInlinesSingleUseCallee) {
+  const std::string program = R"(
+package some_package
+
+fn callee(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  umul.2: bits[32] = umul(add.1, y)
+  ret sub.3: bits[32] = sub(umul.2, x)
+}
+
+top fn caller(a: bits[32], b: bits[32]) -> bits[32] {
+  ret invoke.4: bits[32] = invoke(a, b, to_apply=callee)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  ASSERT_THAT(InlineSelectively(package.get(), /*node_budget=*/0),
+              IsOkAndHolds(true));
+  Function* f = FindFunction("caller", package.get());
+  EXPECT_THAT(f->return_value(),
+              m::Sub(m::UMul(m::Add(m::Param("a"), m::Param("b")),
+                             m::Param("b")),
+                     m::Param("a")));
+}
+
+TEST_F(InliningPassTest, SelectiveInliningCountsCopiesOfInlinedCallers) {
+  const std::string program = R"(
+package some_package
+
+fn leaf(x: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, x)
+  umul.2: bits[32] = umul(add.1, x)
+  ret sub.3: bits[32] = sub(umul.2, x)
+}
+
+fn middle(x: bits[32]) -> bits[32] {
+  invoke.4: bits[32] = invoke(x, to_apply=leaf)
+  ret neg.5: bits[32] = neg(invoke.4)
+}
+
+top fn caller(a: bits[32]) -> bits[32] {
+  invoke.6: bits[32] = invoke(a, to_apply=middle)
+  ret invoke.7: bits[32] = invoke(invoke.6, to_apply=middle)
+}
+)";
+
+  // Inlining 'middle' costs two nodes and makes two copies of the invoke of
+  // 'leaf', which would cost three more if inlined too.
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  ASSERT_THAT(InlineSelectively(package.get(), /*node_budget=*/2),
+              IsOkAndHolds(true));
+  Function* f = FindFunction("caller", package.get());
+  EXPECT_THAT(f->return_value(),
+              m::Neg(m::Invoke(m::Neg(m::Invoke(m::Param("a"))))));
+
+  // A non-selective pass inlines the remaining invokes.
+  ASSERT_THAT(Inline(package.get()), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Neg(m::Sub(m::UMul(), m::Neg())));
+}
+
 // Verifies that Cover and Assert ops have their labels differentiated when
 // "duplicated" via function inlining.
 TEST_F(InliningPassTest, CoversAndAssertsDeduplicated) {
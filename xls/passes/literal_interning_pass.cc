@@ -0,0 +1,58 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/literal_interning_pass.h"
+
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+absl::StatusOr<bool> LiteralInterningPass::RunInternal(
+    Package* p, const PassOptions& options, PassResults* results) const {
+  // The interned values. Copies of a Value share the storage of its elements.
+  absl::flat_hash_set<Value> pool;
+  bool changed = false;
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    std::vector<Literal*> literals;
+    for (Node* node : f->nodes()) {
+      if (node->Is<Literal>() && !node->GetType()->IsBits() &&
+          node->GetType()->GetFlatBitCount() >= min_bit_count_) {
+        literals.push_back(node->As<Literal>());
+      }
+    }
+    for (Literal* literal : literals) {
+      auto [it, inserted] = pool.insert(literal->value());
+      if (inserted ||
+          it->elements().data() == literal->value().elements().data()) {
+        continue;
+      }
+      XLS_VLOG(3) << absl::StreamFormat("Interning %s in %s",
+                                        literal->GetName(), f->name());
+      XLS_RETURN_IF_ERROR(literal->ReplaceUsesWithNew<Literal>(*it).status());
+      XLS_RETURN_IF_ERROR(f->RemoveNode(literal));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace xls
@@ -0,0 +1,52 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_LITERAL_INTERNING_PASS_H_
+#define XLS_PASSES_LITERAL_INTERNING_PASS_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+#include "xls/passes/passes.h"
+
+namespace xls {
+
+// Pass which makes equal array and tuple literals throughout the package share
+// the storage of their values. Aggregate values are reference counted, so
+// literals cloned from one another (e.g., by inlining) already share storage,
+// but equal literals created independently (e.g., by the parser or by
+// different passes) hold separate copies. Large tables such as S-boxes are
+// often repeated in several functions this way.
+//
+// Literals with fewer than 'min_bit_count' bits are left alone. Literals which
+// are interned are replaced by new literal nodes holding the shared value.
+class LiteralInterningPass : public Pass {
+ public:
+  explicit LiteralInterningPass(int64_t min_bit_count = 1024)
+      : Pass("literal_intern", "Literal interning"),
+        min_bit_count_(min_bit_count) {}
+  ~LiteralInterningPass() override {}
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
+                                   PassResults* results) const override;
+
+ private:
+  int64_t min_bit_count_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_LITERAL_INTERNING_PASS_H_
@@ -0,0 +1,106 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/literal_interning_pass.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/passes.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class LiteralInterningPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Package* p) {
+    PassResults results;
+    return LiteralInterningPass(/*min_bit_count=*/64)
+        .Run(p, PassOptions(), &results);
+  }
+
+  // Returns the array literal indexed by the return value of `f`.
+  absl::StatusOr<const Value*> TableOf(Package* p, std::string_view name) {
+    XLS_ASSIGN_OR_RETURN(Function * f, p->GetFunction(name));
+    return &f->return_value()->operand(0)->As<Literal>()->value();
+  }
+};
+
+TEST_F(LiteralInterningPassTest, SharesLargeLiteralsAcrossFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package some_package
+
+fn f(i: bits[2]) -> bits[32] {
+  table: bits[32][4] = literal(value=[1, 2, 3, 4])
+  ret result: bits[32] = array_index(table, indices=[i])
+}
+
+fn g(i: bits[2]) -> bits[32] {
+  table: bits[32][4] = literal(value=[1, 2, 3, 4])
+  ret result: bits[32] = array_index(table, indices=[i])
+}
+
+fn h(i: bits[2]) -> bits[32] {
+  table: bits[32][4] = literal(value=[5, 6, 7, 8])
+  ret result: bits[32] = array_index(table, indices=[i])
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Value* f_table, TableOf(p.get(), "f"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Value* g_table, TableOf(p.get(), "g"));
+  EXPECT_NE(f_table->elements().data(), g_table->elements().data());
+
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  XLS_ASSERT_OK_AND_ASSIGN(f_table, TableOf(p.get(), "f"));
+  XLS_ASSERT_OK_AND_ASSIGN(g_table, TableOf(p.get(), "g"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Value* h_table, TableOf(p.get(), "h"));
+  EXPECT_EQ(f_table->elements().data(), g_table->elements().data());
+  EXPECT_NE(f_table->elements().data(), h_table->elements().data());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g, p->GetFunction("g"));
+  EXPECT_THAT(g->return_value(),
+              m::ArrayIndex(m::Literal(*f_table), {m::Param("i")}));
+
+  // Everything is already shared.
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(LiteralInterningPassTest, IgnoresSmallLiterals) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package some_package
+
+fn f(i: bits[1]) -> bits[8] {
+  table: bits[8][2] = literal(value=[1, 2])
+  ret result: bits[8] = array_index(table, indices=[i])
+}
+
+fn g(i: bits[1]) -> bits[8] {
+  table: bits[8][2] = literal(value=[1, 2])
+  ret result: bits[8] = array_index(table, indices=[i])
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xls
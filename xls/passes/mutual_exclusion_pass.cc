@@ -14,23 +14,42 @@
 
 #include "xls/passes/mutual_exclusion_pass.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <random>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/graph_coloring.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/data_structures/transitive_closure.h"
 #include "xls/data_structures/union_find_map.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/ir/call_graph.h"
 #include "xls/ir/events.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/op.h"
+#include "xls/ir/reachability_index.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_helpers.h"
 #include "xls/passes/cse_pass.h"
@@ -241,14 +260,104 @@ bool HasIntersection(const absl::flat_hash_set<T>& lhs,
   return false;
 }
 
-Z3_lbool RunSolver(Z3_context c, Z3_ast asserted) {
+// Checks the satisfiability of `asserted`. Returns Z3_L_UNDEF without running
+// the solver if `deadline` has passed, otherwise the solver is given until
+// `deadline` to finish.
+Z3_lbool RunSolver(Z3_context c, Z3_ast asserted,
+                   std::optional<absl::Time> deadline) {
+  std::optional<absl::Duration> timeout;
+  if (deadline.has_value()) {
+    timeout = deadline.value() - absl::Now();
+    if (timeout.value() <= absl::ZeroDuration()) {
+      return Z3_L_UNDEF;
+    }
+  }
   Z3_solver solver = solvers::z3::CreateSolver(c, 1);
+  if (timeout.has_value()) {
+    Z3_params params = Z3_mk_params(c);
+    Z3_params_inc_ref(c, params);
+    Z3_params_set_uint(
+        c, params, Z3_mk_string_symbol(c, "timeout"),
+        std::max<int64_t>(1, absl::ToInt64Milliseconds(timeout.value())));
+    Z3_solver_set_params(c, solver, params);
+    Z3_params_dec_ref(c, params);
+  }
   Z3_solver_assert(c, solver, asserted);
   Z3_lbool satisfiable = Z3_solver_check(c, solver);
   Z3_solver_dec_ref(c, solver);
   return satisfiable;
 }
 
+// Checks the satisfiability of the conjunction of each of the given sets of
+// 1-bit nodes using up to `thread_count` threads. Z3 contexts cannot be shared
+// between threads so each thread other than the calling one translates `f`
+// into its own context; the calling thread uses `translator`. Queries which
+// are not started before `deadline` are reported as Z3_L_UNDEF.
+absl::StatusOr<std::vector<Z3_lbool>> SolveQueries(
+    FunctionBase* f, solvers::z3::IrTranslator* translator,
+    absl::Span<const std::vector<Node*>> queries, int64_t thread_count,
+    std::optional<absl::Time> deadline) {
+  std::vector<Z3_lbool> results(queries.size(), Z3_L_UNDEF);
+  std::atomic<int64_t> next_query = 0;
+  auto solve = [&](solvers::z3::IrTranslator* t) {
+    Z3_context ctx = t->ctx();
+    for (int64_t i = next_query++; i < queries.size(); i = next_query++) {
+      Z3_ast conjunction = t->GetTranslation(queries[i].front());
+      for (int64_t j = 1; j < queries[i].size(); ++j) {
+        conjunction = Z3_mk_bvand(ctx, conjunction,
+                                  t->GetTranslation(queries[i][j]));
+      }
+      results[i] = RunSolver(
+          ctx, solvers::z3::BitVectorToBoolean(ctx, conjunction), deadline);
+    }
+  };
+
+  std::vector<absl::Status> thread_statuses(
+      std::max<int64_t>(thread_count, 1));
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < thread_count && i < queries.size(); ++i) {
+    threads.push_back(std::make_unique<Thread>([&, i]() {
+      absl::StatusOr<std::unique_ptr<solvers::z3::IrTranslator>>
+          thread_translator = solvers::z3::IrTranslator::CreateAndTranslate(
+              f, /*allow_unsupported=*/true);
+      if (!thread_translator.ok()) {
+        thread_statuses[i] = thread_translator.status();
+        return;
+      }
+      solvers::z3::ScopedErrorHandler seh(thread_translator.value()->ctx());
+      solve(thread_translator.value().get());
+      thread_statuses[i] = seh.status();
+    }));
+  }
+  solve(translator);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (const absl::Status& status : thread_statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return results;
+}
+
+// Solver verdicts on the satisfiability of conjunctions of predicates, shared
+// by all invocations of the pass. The key is the sorted cone hashes (see
+// PredicateInfo) of the conjoined predicates; a single predicate is keyed by
+// its hash twice as `a AND a` is `a`. Verdicts of queries which ran out of time
+// are not cached.
+using SatCacheKey = std::pair<uint64_t, uint64_t>;
+
+absl::Mutex sat_cache_mutex(absl::kConstInit);
+
+absl::flat_hash_map<SatCacheKey, bool>& GetSatCache()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(sat_cache_mutex) {
+  static auto* cache = new absl::flat_hash_map<SatCacheKey, bool>();
+  return *cache;
+}
+
+SatCacheKey MakeSatCacheKey(uint64_t a, uint64_t b) {
+  return {std::min(a, b), std::max(a, b)};
+}
+
 // Returns a list of all predicates in a deterministic order, paired with their
 // index in the list.
 std::vector<std::pair<Node*, int64_t>> PredicateNodes(Predicates* p,
@@ -271,11 +380,95 @@ bool IsHeavyOp(Op op) {
          op == Op::kReceive;
 }
 
-absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
+// Information about a predicate used to pick the pairs of predicates which are
+// worth handing to the solver.
+struct PredicateInfo {
+  // The op and channel id (-1 for ops without a channel) of each heavy op
+  // predicated by the predicate. Only ops with the same op and channel can be
+  // merged, so pairs of predicates which share no such effect are not checked.
+  absl::flat_hash_set<std::pair<Op, int64_t>> effects;
+
+  // The non-literal nodes which the predicate transitively depends on,
+  // including itself. Predicates with disjoint support are independent.
+  absl::flat_hash_set<Node*> support;
+
+  // Hash of the text of the nodes the predicate transitively depends on (and of
+  // any functions they call). The text of a node names its operands so the
+  // hashes of two predicates determine the solver query on their conjunction,
+  // even across invocations of the pass on an IR which has since changed
+  // elsewhere.
+  uint64_t cone_hash = 0;
+
+  // Whether the solver found the predicate to be satisfiable.
+  bool satisfiable = false;
+};
+
+absl::flat_hash_map<Node*, PredicateInfo> ComputePredicateInfo(
+    Predicates* p, FunctionBase* f,
+    absl::Span<const std::pair<Node*, int64_t>> predicate_nodes) {
+  std::vector<Node*> topo_order;
+  for (Node* node : TopoSort(f)) {
+    topo_order.push_back(node);
+  }
+  absl::flat_hash_map<Node*, PredicateInfo> info;
+  for (const auto& [pred, index] : predicate_nodes) {
+    PredicateInfo& pred_info = info[pred];
+    for (Node* predicated : p->GetNodesPredicatedBy(pred)) {
+      if (!IsHeavyOp(predicated->op())) {
+        continue;
+      }
+      int64_t channel_id = -1;
+      if (predicated->Is<Send>()) {
+        channel_id = predicated->As<Send>()->channel_id();
+      } else if (predicated->Is<Receive>()) {
+        channel_id = predicated->As<Receive>()->channel_id();
+      }
+      pred_info.effects.insert({predicated->op(), channel_id});
+    }
+
+    absl::flat_hash_set<Node*> cone = {pred};
+    std::vector<Node*> worklist = {pred};
+    while (!worklist.empty()) {
+      Node* node = worklist.back();
+      worklist.pop_back();
+      for (Node* operand : node->operands()) {
+        if (cone.insert(operand).second) {
+          worklist.push_back(operand);
+        }
+      }
+    }
+    std::string cone_text;
+    for (Node* node : topo_order) {
+      if (!cone.contains(node)) {
+        continue;
+      }
+      absl::StrAppend(&cone_text, node->ToString(), "\n");
+      if (std::optional<Function*> callee = CalledFunction(node)) {
+        for (FunctionBase* dependency :
+             GetDependentFunctions(callee.value())) {
+          absl::StrAppend(&cone_text, dependency->DumpIr());
+        }
+      }
+      if (!node->Is<Literal>()) {
+        pred_info.support.insert(node);
+      }
+    }
+    pred_info.cone_hash = absl::Hash<std::string>()(cone_text);
+  }
+  return info;
+}
+
+absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
+                                    const PassOptions& options) {
   if (f->IsBlock()) {
     return absl::OkStatus();
   }
 
+  std::optional<absl::Time> deadline;
+  if (options.mutual_exclusion_time_budget.has_value()) {
+    deadline = absl::Now() + options.mutual_exclusion_time_budget.value();
+  }
+
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<solvers::z3::IrTranslator> translator,
                        solvers::z3::IrTranslator::CreateAndTranslate(f, true));
 
@@ -284,17 +477,67 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
   solvers::z3::ScopedErrorHandler seh(ctx);
 
   std::vector<std::pair<Node*, int64_t>> predicate_nodes = PredicateNodes(p, f);
+  absl::flat_hash_map<Node*, PredicateInfo> info =
+      ComputePredicateInfo(p, f, predicate_nodes);
+
+  for (const auto& [node, index] : predicate_nodes) {
+    XLS_VLOG(3) << "Predicate: " << node;
+  }
 
   Z3_global_param_set("rlimit", "500000");
 
+  // Runs the solver on the queries (sets of predicates to conjoin) which are
+  // not answered by the cache and returns the verdict on each query.
+  auto solve = [&](absl::Span<const std::vector<Node*>> queries)
+      -> absl::StatusOr<std::vector<Z3_lbool>> {
+    std::vector<Z3_lbool> verdicts(queries.size(), Z3_L_UNDEF);
+    std::vector<SatCacheKey> keys;
+    std::vector<std::vector<Node*>> uncached_queries;
+    std::vector<int64_t> uncached_indices;
+    {
+      absl::MutexLock lock(&sat_cache_mutex);
+      for (int64_t i = 0; i < queries.size(); ++i) {
+        keys.push_back(MakeSatCacheKey(info.at(queries[i].front()).cone_hash,
+                                       info.at(queries[i].back()).cone_hash));
+        auto it = GetSatCache().find(keys.back());
+        if (it != GetSatCache().end()) {
+          verdicts[i] = it->second ? Z3_L_TRUE : Z3_L_FALSE;
+        } else {
+          uncached_queries.push_back(queries[i]);
+          uncached_indices.push_back(i);
+        }
+      }
+    }
+    XLS_VLOG(3) << absl::StreamFormat("%d of %d queries answered by cache",
+                                      queries.size() - uncached_queries.size(),
+                                      queries.size());
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<Z3_lbool> solved,
+        SolveQueries(f, translator.get(), uncached_queries,
+                     options.mutual_exclusion_threads, deadline));
+    absl::MutexLock lock(&sat_cache_mutex);
+    for (int64_t i = 0; i < solved.size(); ++i) {
+      verdicts[uncached_indices[i]] = solved[i];
+      if (solved[i] != Z3_L_UNDEF) {
+        GetSatCache()[keys[uncached_indices[i]]] = solved[i] == Z3_L_TRUE;
+      }
+    }
+    return verdicts;
+  };
+
   // Determine for each predicate whether it is always false using Z3.
   // Dead nodes are mutually exclusive with all other nodes, so this can reduce
   // the runtime  by doing only a linear amount of Z3 calls to remove
   // quadratically many Z3 calls.
+  std::vector<std::vector<Node*>> single_queries;
   for (const auto& [node, index] : predicate_nodes) {
-    Z3_ast translated = translator->GetTranslation(node);
-    if (RunSolver(ctx, solvers::z3::BitVectorToBoolean(ctx, translated)) ==
-        Z3_L_FALSE) {
+    single_queries.push_back({node});
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<Z3_lbool> single_verdicts,
+                       solve(single_queries));
+  for (const auto& [node, index] : predicate_nodes) {
+    info.at(node).satisfiable = single_verdicts[index] == Z3_L_TRUE;
+    if (single_verdicts[index] == Z3_L_FALSE) {
       XLS_VLOG(3) << "Proved that " << node << " is always false";
       // A constant false node is mutually exclusive with all other nodes.
       for (const auto& [other, other_index] : predicate_nodes) {
@@ -305,35 +548,12 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
     }
   }
 
-  for (const auto& [node, index] : predicate_nodes) {
-    XLS_VLOG(3) << "Predicate: " << node;
-  }
-
-  Z3_global_param_set("rlimit", "500000");
-
   int64_t known_false = 0;
   int64_t known_true = 0;
   int64_t unknown = 0;
+  int64_t independent = 0;
 
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Op>> ops_for_pred;
-  for (const auto& [node, index] : predicate_nodes) {
-    for (Node* predicated_by : p->GetNodesPredicatedBy(node)) {
-      ops_for_pred[node].insert(predicated_by->op());
-    }
-  }
-
-  {
-    std::vector<Node*> irrelevant;
-    for (const auto& [pred, ops] : ops_for_pred) {
-      if (!std::any_of(ops.begin(), ops.end(), IsHeavyOp)) {
-        irrelevant.push_back(pred);
-      }
-    }
-    for (Node* pred : irrelevant) {
-      ops_for_pred.erase(pred);
-    }
-  }
-
+  std::vector<std::vector<Node*>> pair_queries;
   for (const auto& [node_a, index_a] : predicate_nodes) {
     for (const auto& [node_b, index_b] : predicate_nodes) {
       // This prevents checking `a NAND b` and then later checking `b NAND a`.
@@ -346,36 +566,48 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
         continue;
       }
 
-      if (!ops_for_pred.contains(node_a) || !ops_for_pred.contains(node_b) ||
-          !HasIntersection(ops_for_pred.at(node_a), ops_for_pred.at(node_b))) {
+      const PredicateInfo& info_a = info.at(node_a);
+      const PredicateInfo& info_b = info.at(node_b);
+      if (!HasIntersection(info_a.effects, info_b.effects)) {
         continue;
       }
 
-      Z3_ast z3_a = translator->GetTranslation(node_a);
-      Z3_ast z3_b = translator->GetTranslation(node_b);
-
-      // We try to find out if `a ∧ b` is satisfiable, which is true iff
-      // `a NAND b` is not valid.
-      Z3_ast a_and_b =
-          solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
-
-      Z3_lbool satisfiable = RunSolver(ctx, a_and_b);
-
-      if (satisfiable == Z3_L_FALSE) {
-        known_true += 1;
-        XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
-      } else if (satisfiable == Z3_L_TRUE) {
+      // Satisfiable predicates over disjoint sets of variables can be
+      // satisfied together.
+      if (info_a.satisfiable && info_b.satisfiable &&
+          !HasIntersection(info_a.support, info_b.support)) {
+        independent += 1;
         known_false += 1;
         XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
-      } else {
-        unknown += 1;
-        XLS_VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
-                    << node_a->GetName() << " and " << node_b->GetName();
+        continue;
       }
+
+      pair_queries.push_back({node_a, node_b});
     }
   }
 
-  XLS_VLOG(3) << "known_false = " << known_false;
+  // We try to find out if `a ∧ b` is satisfiable, which is true iff
+  // `a NAND b` is not valid.
+  XLS_ASSIGN_OR_RETURN(std::vector<Z3_lbool> pair_verdicts,
+                       solve(pair_queries));
+  for (int64_t i = 0; i < pair_queries.size(); ++i) {
+    Node* node_a = pair_queries[i][0];
+    Node* node_b = pair_queries[i][1];
+    if (pair_verdicts[i] == Z3_L_FALSE) {
+      known_true += 1;
+      XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
+    } else if (pair_verdicts[i] == Z3_L_TRUE) {
+      known_false += 1;
+      XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
+    } else {
+      unknown += 1;
+      XLS_VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
+                  << node_a->GetName() << " and " << node_b->GetName();
+    }
+  }
+
+  XLS_VLOG(3) << "known_false = " << known_false << " (" << independent
+              << " independent)";
   XLS_VLOG(3) << "known_true  = " << known_true;
   XLS_VLOG(3) << "unknown     = " << unknown;
 
@@ -429,42 +661,20 @@ absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
     }
   }
 
-  auto dfs = [&](Node* root, const NodeRelation& dag) {
-    std::vector<Node*> stack;
-    stack.push_back(root);
-    absl::flat_hash_set<Node*> discovered;
-    while (!stack.empty()) {
-      Node* popped = stack.back();
-      stack.pop_back();
-      if (!discovered.contains(popped)) {
-        discovered.insert(popped);
-        if (dag.contains(popped)) {
-          for (Node* child : dag.at(popped)) {
-            stack.push_back(child);
-          }
-        }
-      }
-    }
-    return discovered;
-  };
-
-  NodeRelation data_deps;
-  for (Node* node : f->nodes()) {
-    for (Node* child : node->operands()) {
-      data_deps[node].insert(child);
-    }
-  }
-
   NodeRelation transitive_closure = TransitiveClosure<Node*>(token_dag);
 
   // If a receive uses data from another receive in its predicate, they cannot
   // be merged.
+  ReachabilityIndex* reachability = f->GetReachabilityIndex();
   for (Node* effectful_node : token_nodes) {
-    if (effectful_node->Is<Receive>()) {
-      for (Node* other_node : dfs(effectful_node, data_deps)) {
-        if (other_node->Is<Receive>()) {
-          transitive_closure[effectful_node].insert(other_node);
-        }
+    if (!effectful_node->Is<Receive>()) {
+      continue;
+    }
+    for (Node* other_node : token_nodes) {
+      if (other_node->Is<Receive>() &&
+          (other_node == effectful_node ||
+           reachability->DependsOn(effectful_node, other_node))) {
+        transitive_closure[effectful_node].insert(other_node);
       }
     }
   }
@@ -539,35 +749,25 @@ absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
     }
   }
 
-  // The complement of the `neighborhoods` graph
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> inverted_neighborhoods;
-
-  for (Node* node : nodes) {
-    inverted_neighborhoods[node] = nodes;
-    for (Node* neighbor : neighborhoods.at(node)) {
-      inverted_neighborhoods[node].erase(neighbor);
-    }
-  }
-
   absl::flat_hash_map<Node*, int64_t> node_to_index;
   for (int64_t i = 0; i < ordered_nodes.size(); ++i) {
     node_to_index[ordered_nodes[i]] = i;
   }
 
-  std::vector<int64_t> iota(ordered_nodes.size());
-  std::iota(iota.begin(), iota.end(), 0);
+  // The complement of the `neighborhoods` graph, indexed by position in
+  // `ordered_nodes`.
+  const int64_t node_count = ordered_nodes.size();
+  BitmapGraph inverted_neighborhoods(node_count,
+                                     InlineBitmap(node_count, /*fill=*/true));
+  for (int64_t i = 0; i < node_count; ++i) {
+    inverted_neighborhoods[i].Set(i, false);
+    for (Node* neighbor : neighborhoods.at(ordered_nodes[i])) {
+      inverted_neighborhoods[i].Set(node_to_index.at(neighbor), false);
+    }
+  }
+
   std::vector<absl::flat_hash_set<int64_t>> coloring_indices =
-      RecursiveLargestFirstColoring<int64_t>(
-          absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
-          [&](int64_t node_index) -> absl::flat_hash_set<int64_t> {
-            absl::flat_hash_set<Node*> inv_neighbors =
-                inverted_neighborhoods.at(ordered_nodes.at(node_index));
-            absl::flat_hash_set<int64_t> result;
-            for (Node* inv_neighbor : inv_neighbors) {
-              result.insert(node_to_index.at(inv_neighbor));
-            }
-            return result;
-          });
+      RecursiveLargestFirstColoring(inverted_neighborhoods);
 
   std::vector<absl::flat_hash_set<Node*>> coloring;
   for (const absl::flat_hash_set<int64_t>& color_class : coloring_indices) {
@@ -784,7 +984,7 @@ absl::StatusOr<bool> MutualExclusionPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const PassOptions& options, PassResults* results) const {
   Predicates p;
   XLS_RETURN_IF_ERROR(AddSendReceivePredicates(&p, f));
-  XLS_RETURN_IF_ERROR(ComputeMutualExclusion(&p, f));
+  XLS_RETURN_IF_ERROR(ComputeMutualExclusion(&p, f, options));
   XLS_ASSIGN_OR_RETURN(std::vector<absl::flat_hash_set<Node*>> merge_classes,
                        ComputeMergeClasses(&p, f));
 
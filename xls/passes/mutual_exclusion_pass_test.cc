@@ -17,6 +17,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
@@ -44,13 +45,14 @@ class MutualExclusionPassTest : public IrTestBase {
  protected:
   MutualExclusionPassTest() = default;
 
-  absl::StatusOr<bool> Run(FunctionBase* f) {
+  absl::StatusOr<bool> Run(FunctionBase* f,
+                           const PassOptions& options = PassOptions()) {
     PassResults results;
     bool changed = false;
     bool subpass_changed;
     XLS_ASSIGN_OR_RETURN(
         subpass_changed,
-        MutualExclusionPass().RunOnFunctionBase(f, PassOptions(), &results));
+        MutualExclusionPass().RunOnFunctionBase(f, options, &results));
     changed |= subpass_changed;
     XLS_ASSIGN_OR_RETURN(
         subpass_changed,
@@ -149,6 +151,94 @@ TEST_F(MutualExclusionPassTest, ThreeParallelSends) {
                        *proc->GetNode("literal.4")}));
 }
 
+TEST_F(MutualExclusionPassTest, ParallelSolving) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+     package test_module
+
+     chan test_channel(
+       bits[32], id=0, kind=streaming, ops=send_only,
+       flow_control=ready_valid, metadata="""""")
+
+     top proc main(__token: token, __state: bits[2], init={0}) {
+       literal.1: bits[2] = literal(value=0)
+       literal.2: bits[2] = literal(value=1)
+       literal.3: bits[2] = literal(value=2)
+       literal.4: bits[2] = literal(value=3)
+       eq.5: bits[1] = eq(__state, literal.1)
+       eq.6: bits[1] = eq(__state, literal.2)
+       eq.7: bits[1] = eq(__state, literal.3)
+       eq.8: bits[1] = eq(__state, literal.4)
+       literal.9: bits[32] = literal(value=50)
+       send.10: token = send(__token, literal.9, predicate=eq.5, channel_id=0)
+       send.11: token = send(__token, literal.9, predicate=eq.6, channel_id=0)
+       send.12: token = send(__token, literal.9, predicate=eq.7, channel_id=0)
+       send.13: token = send(__token, literal.9, predicate=eq.8, channel_id=0)
+       after_all.14: token = after_all(send.10, send.11, send.12, send.13)
+       next (after_all.14, __state)
+     }
+  )"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, p->GetTopAsProc());
+  PassOptions options;
+  options.mutual_exclusion_threads = 4;
+  EXPECT_THAT(Run(proc, options), IsOkAndHolds(true));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1);
+  XLS_EXPECT_OK(VerifyProc(proc, true));
+}
+
+TEST_F(MutualExclusionPassTest, ExhaustedTimeBudget) {
+  // Solver verdicts are cached across runs of the pass, so the predicates here
+  // (which depend on `budget_state`) must not appear in any other test.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+     package test_module
+
+     chan test_channel(
+       bits[32], id=0, kind=streaming, ops=send_only,
+       flow_control=ready_valid, metadata="""""")
+
+     top proc main(__token: token, budget_state: bits[3], init={0}) {
+       bit_slice.5: bits[1] = bit_slice(budget_state, start=2, width=1)
+       not.6: bits[1] = not(bit_slice.5)
+       literal.1: bits[32] = literal(value=50)
+       send.2: token = send(__token, literal.1, predicate=bit_slice.5, channel_id=0)
+       send.3: token = send(__token, literal.1, predicate=not.6, channel_id=0)
+       after_all.4: token = after_all(send.2, send.3)
+       next (after_all.4, budget_state)
+     }
+  )"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, p->GetTopAsProc());
+  PassOptions options;
+  options.mutual_exclusion_time_budget = absl::ZeroDuration();
+  EXPECT_THAT(Run(proc, options), IsOkAndHolds(false));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 2);
+
+  // With time to run the solver the sends are merged.
+  options.mutual_exclusion_time_budget = absl::Minutes(1);
+  EXPECT_THAT(Run(proc, options), IsOkAndHolds(true));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1);
+  XLS_EXPECT_OK(VerifyProc(proc, true));
+}
+
+TEST_F(MutualExclusionPassTest, IndependentPredicates) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+     package test_module
+
+     chan test_channel(
+       bits[32], id=0, kind=streaming, ops=send_only,
+       flow_control=ready_valid, metadata="""""")
+
+     top proc main(__token: token, a: bits[1], b: bits[1], init={0, 0}) {
+       literal.1: bits[32] = literal(value=50)
+       send.2: token = send(__token, literal.1, predicate=a, channel_id=0)
+       send.3: token = send(__token, literal.1, predicate=b, channel_id=0)
+       after_all.4: token = after_all(send.2, send.3)
+       next (after_all.4, a, b)
+     }
+  )"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, p->GetTopAsProc());
+  EXPECT_THAT(Run(proc), IsOkAndHolds(false));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 2);
+}
+
 TEST_F(MutualExclusionPassTest, TwoSequentialSends) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
      package test_module
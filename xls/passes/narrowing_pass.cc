@@ -14,12 +14,21 @@
 
 #include "xls/passes/narrowing_pass.h"
 
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/op.h"
@@ -929,78 +938,174 @@ static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
   return std::move(query_engine);
 }
 
-absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
-    FunctionBase* f, const PassOptions& options, PassResults* results) const {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
-                       GetQueryEngine(f, use_range_analysis_));
+// Attempts to narrow the given node using the given query engine. Returns
+// true if the IR was changed.
+static absl::StatusOr<bool> MaybeNarrowNode(Node* node,
+                                            const QueryEngine& query_engine,
+                                            bool use_range_analysis,
+                                            const PassOptions& options) {
+  if (OpIsSideEffecting(node->op())) {
+    return false;
+  }
+  if (!node->Is<Literal>() && !node->Is<Param>()) {
+    XLS_ASSIGN_OR_RETURN(bool replaced,
+                         MaybeReplacePreciseWithLiteral(node, query_engine));
+    if (replaced) {
+      return true;
+    }
+  }
+  switch (node->op()) {
+    case Op::kShll:
+    case Op::kShrl:
+    case Op::kShra:
+      return MaybeNarrowShiftAmount(node, query_engine);
+    case Op::kArrayIndex:
+      return MaybeNarrowArrayIndex(use_range_analysis, options,
+                                   node->As<ArrayIndex>(), query_engine);
+    case Op::kSMul:
+    case Op::kUMul:
+      return MaybeNarrowMultiply(node->As<ArithOp>(), query_engine);
+    case Op::kSMulp:
+    case Op::kUMulp:
+      return MaybeNarrowPartialMultiply(node->As<PartialProductOp>(),
+                                        query_engine);
+    case Op::kULe:
+    case Op::kULt:
+    case Op::kUGe:
+    case Op::kUGt:
+    case Op::kSLe:
+    case Op::kSLt:
+    case Op::kSGe:
+    case Op::kSGt:
+    case Op::kEq:
+    case Op::kNe:
+      return MaybeNarrowCompare(node->As<CompareOp>(), query_engine);
+    case Op::kAdd:
+      return MaybeNarrowAdd(node, query_engine);
+    default:
+      return false;
+  }
+}
 
-  bool modified = false;
+namespace {
 
-  for (Node* node : TopoSort(f)) {
-    if (OpIsSideEffecting(node->op())) {
-      continue;
+// Records the nodes of a function base which are added or have their operands
+// replaced while the listener is registered. Nodes which are deleted are
+// dropped from the given query engines.
+class ModifiedNodeRecorder : public ChangeListener {
+ public:
+  ModifiedNodeRecorder(FunctionBase* f, TernaryQueryEngine* ternary_engine,
+                       RangeQueryEngine* range_engine)
+      : f_(f), ternary_engine_(ternary_engine), range_engine_(range_engine) {
+    f_->RegisterChangeListener(this);
+  }
+  ~ModifiedNodeRecorder() override { f_->UnregisterChangeListener(this); }
+
+  // Returns the nodes modified since the last call and resets the record.
+  absl::flat_hash_set<Node*> TakeModifiedNodes() {
+    absl::flat_hash_set<Node*> modified;
+    std::swap(modified, modified_);
+    return modified;
+  }
+
+  void NodeAdded(Node* node) override { modified_.insert(node); }
+  void NodeDeleted(Node* node) override {
+    modified_.erase(node);
+    ternary_engine_->Forget(node);
+    if (range_engine_ != nullptr) {
+      range_engine_->Forget(node);
     }
-    bool node_modified = false;
-    if (!node->Is<Literal>() && !node->Is<Param>()) {
-      XLS_ASSIGN_OR_RETURN(node_modified,
-                           MaybeReplacePreciseWithLiteral(node, *query_engine));
-      if (node_modified) {
-        modified = true;
+  }
+  void OperandChanged(Node* node) override { modified_.insert(node); }
+
+ private:
+  FunctionBase* f_;
+  TernaryQueryEngine* ternary_engine_;
+  RangeQueryEngine* range_engine_;
+  absl::flat_hash_set<Node*> modified_;
+};
+
+}  // namespace
+
+// Narrows the nodes of `f` to a fixed point. After an initial sweep over all
+// nodes, only the nodes which were modified by narrowing and their transitive
+// users are revisited, as the analysis of all other nodes is unchanged. The
+// query engines are updated incrementally between sweeps rather than being
+// repopulated.
+static absl::StatusOr<bool> NarrowWithWorklist(FunctionBase* f,
+                                               bool use_range_analysis,
+                                               const PassOptions& options) {
+  auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
+  TernaryQueryEngine* ternary_engine = ternary_query_engine.get();
+  RangeQueryEngine* range_engine = nullptr;
+  std::unique_ptr<QueryEngine> query_engine;
+  if (use_range_analysis) {
+    auto range_query_engine = std::make_unique<RangeQueryEngine>();
+    range_engine = range_query_engine.get();
+    std::vector<std::unique_ptr<QueryEngine>> engines;
+    engines.push_back(std::move(ternary_query_engine));
+    engines.push_back(std::move(range_query_engine));
+    query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
+  } else {
+    query_engine = std::move(ternary_query_engine);
+  }
+  XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
+
+  ModifiedNodeRecorder recorder(f, ternary_engine, range_engine);
+  std::vector<Node*> worklist = TopoSort(f).AsVector();
+  bool modified = false;
+  int64_t sweeps = 0;
+  while (!worklist.empty()) {
+    ++sweeps;
+    for (Node* node : worklist) {
+      // Nodes replaced earlier in the sweep are left for DCE.
+      if (node->IsDead()) {
         continue;
       }
+      XLS_ASSIGN_OR_RETURN(
+          bool node_modified,
+          MaybeNarrowNode(node, *query_engine, use_range_analysis, options));
+      modified |= node_modified;
     }
-    switch (node->op()) {
-      case Op::kShll:
-      case Op::kShrl:
-      case Op::kShra: {
-        XLS_ASSIGN_OR_RETURN(node_modified,
-                             MaybeNarrowShiftAmount(node, *query_engine));
-        break;
-      }
-      case Op::kArrayIndex: {
-        XLS_ASSIGN_OR_RETURN(
-            node_modified,
-            MaybeNarrowArrayIndex(use_range_analysis_, options,
-                                  node->As<ArrayIndex>(), *query_engine));
-        break;
-      }
-      case Op::kSMul:
-      case Op::kUMul: {
-        XLS_ASSIGN_OR_RETURN(
-            node_modified,
-            MaybeNarrowMultiply(node->As<ArithOp>(), *query_engine));
-        break;
-      }
-      case Op::kSMulp:
-      case Op::kUMulp: {
-        XLS_ASSIGN_OR_RETURN(node_modified,
-                             MaybeNarrowPartialMultiply(
-                                 node->As<PartialProductOp>(), *query_engine));
-        break;
-      }
-      case Op::kULe:
-      case Op::kULt:
-      case Op::kUGe:
-      case Op::kUGt:
-      case Op::kSLe:
-      case Op::kSLt:
-      case Op::kSGe:
-      case Op::kSGt:
-      case Op::kEq:
-      case Op::kNe: {
-        XLS_ASSIGN_OR_RETURN(
-            node_modified,
-            MaybeNarrowCompare(node->As<CompareOp>(), *query_engine));
-        break;
-      }
-      case Op::kAdd: {
-        XLS_ASSIGN_OR_RETURN(node_modified,
-                             MaybeNarrowAdd(node, *query_engine));
-        break;
+
+    absl::flat_hash_set<Node*> modified_nodes = recorder.TakeModifiedNodes();
+    std::vector<Node*> modified_in_order;
+    absl::flat_hash_set<Node*> stale;
+    worklist.clear();
+    for (Node* node : TopoSort(f)) {
+      if (modified_nodes.contains(node)) {
+        modified_in_order.push_back(node);
+      } else if (absl::c_none_of(node->operands(),
+                                 [&](Node* o) { return stale.contains(o); })) {
+        continue;
       }
-      default:
-        break;
+      stale.insert(node);
+      worklist.push_back(node);
     }
+    XLS_RETURN_IF_ERROR(ternary_engine->Update(worklist));
+    if (range_engine != nullptr) {
+      XLS_RETURN_IF_ERROR(range_engine->Update(f, modified_in_order).status());
+    }
+  }
+  XLS_VLOG(3) << absl::StreamFormat("Narrowing of %s converged in %d sweeps",
+                                    f->name(), sweeps);
+  return modified;
+}
+
+absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const PassOptions& options, PassResults* results) const {
+  if (options.narrowing_worklist) {
+    return NarrowWithWorklist(f, use_range_analysis_, options);
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
+                       GetQueryEngine(f, use_range_analysis_));
+
+  bool modified = false;
+  for (Node* node : TopoSort(f)) {
+    XLS_ASSIGN_OR_RETURN(
+        bool node_modified,
+        MaybeNarrowNode(node, *query_engine, use_range_analysis_, options));
     modified |= node_modified;
   }
   return modified;
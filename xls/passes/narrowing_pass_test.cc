@@ -37,10 +37,11 @@ class NarrowingPassTest : public IrTestBase,
  protected:
   NarrowingPassTest() = default;
 
-  absl::StatusOr<bool> Run(Package* p) {
+  absl::StatusOr<bool> Run(Package* p, bool worklist = false) {
     PassResults results;
     PassOptions options;
     options.convert_array_index_to_select = 2;
+    options.narrowing_worklist = worklist;
     return NarrowingPass(/*use_range_analysis=*/GetParam())
         .Run(p, options, &results);
   }
@@ -446,6 +447,23 @@ TEST_P(NarrowingPassTest, AddWithLeadingZeros) {
                                             /*start=*/0, /*width=*/31))));
 }
 
+TEST_P(NarrowingPassTest, WorklistRevisitsUsersOfNarrowedNodes) {
+  // Narrowing the multiply exposes the leading zeros of its result which in
+  // turn enables narrowing the add. The worklist mode reaches the fixed point
+  // in a single invocation.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u8 = p->GetBitsType(8);
+  fb.Add(fb.UMul(fb.Param("lhs", u8), fb.Param("rhs", u8),
+                 /*result_width=*/42),
+         fb.ZeroExtend(fb.Param("addend", u8), 42));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ASSERT_THAT(Run(p.get(), /*worklist=*/true), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              AllOf(m::Type("bits[42]"), m::ZeroExt(m::Add())));
+  ASSERT_THAT(Run(p.get(), /*worklist=*/true), IsOkAndHolds(false));
+}
+
 TEST_P(NarrowingPassTest, AddWithOnlyOneOperandLeadingZeros) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -38,6 +39,8 @@
 
 namespace xls {
 
+class TernaryQueryEngineCache;
+
 // This file defines a set of base classes for building XLS compiler passes and
 // pass pipelines. The base classes are templated allowing polymorphism of the
 // data types the pass operates on.
@@ -65,11 +68,59 @@ struct PassOptions {
   // optimization pass pipeline which holds this value.
   bool inline_procs = false;
 
+  // Whether the standard pipeline inlines procs (if inline_procs is set) late
+  // in the pipeline rather than at its usual position. Most passes then run on
+  // the separate, smaller procs and only a short cleanup runs on the single
+  // proc produced by inlining.
+  bool defer_proc_inlining = false;
+
   // If this is not `std::nullopt`, convert array indexes with fewer than or
   // equal to the given number of possible indices (by range analysis) into
   // chains of selects. Otherwise, this optimization is skipped, since it can
   // sometimes reduce output quality.
   std::optional<int64_t> convert_array_index_to_select = std::nullopt;
+
+  // Number of threads used to run function-local passes concurrently over the
+  // functions and procs of a package. Values of one or less run passes
+  // serially. Node ids assigned by concurrently run passes depend on thread
+  // scheduling.
+  int64_t function_pass_threads = 1;
+
+  // If set, the early inlining pass of the standard pipeline keeps a callee as
+  // a separate function if inlining all of its call sites would add more than
+  // this many nodes to the package (see InliningPass). Invokes of such callees
+  // are inlined later in the pipeline, after the callees have been optimized.
+  // Otherwise every invoke is inlined early.
+  std::optional<int64_t> inlining_node_budget = std::nullopt;
+
+  // Whether the standard pipeline optimizes each invoked function on its own,
+  // callees before callers, before inlining it (see BottomUpOptimizationPass).
+  bool bottom_up_optimization = false;
+
+  // Whether bottom-up optimization first redirects invokes of structurally
+  // identical functions to a single one of them so it is only optimized once.
+  bool memoize_bottom_up_optimization = false;
+
+  // If set, counted_for loops with a trip count greater than this are only
+  // partially unrolled, with this many trips per iteration of the remaining
+  // loop (see UnrollPass). Values of one or less leave such loops rolled.
+  // Otherwise loops are fully unrolled.
+  std::optional<int64_t> loop_unroll_factor = std::nullopt;
+
+  // Whether the narrowing pass iterates to a fixed point on its own, revisiting
+  // only the nodes affected by the previous sweep and updating its query
+  // engines incrementally, rather than sweeping the whole function base once
+  // per invocation.
+  bool narrowing_worklist = false;
+
+  // Number of threads used by the mutual exclusion pass to run the solver
+  // queries of a single proc. Values of one or less run the queries serially.
+  int64_t mutual_exclusion_threads = 1;
+
+  // If set, the total time the mutual exclusion pass may spend in the solver on
+  // a single proc. Predicates not yet proven mutually exclusive when the budget
+  // runs out are assumed not to be.
+  std::optional<absl::Duration> mutual_exclusion_time_budget = std::nullopt;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -83,6 +134,10 @@ struct PassInvocation {
 
   // The run duration of the pass.
   absl::Duration run_duration;
+
+  // The number of nodes in the IR before and after the pass ran.
+  int64_t node_count_before = 0;
+  int64_t node_count_after = 0;
 };
 
 // A object to which metadata may be written in each pass invocation. This data
@@ -90,13 +145,48 @@ struct PassInvocation {
 struct PassResults {
   // This vector contains and entry for each invocation of each pass.
   std::vector<PassInvocation> invocations;
+
+  // Bookkeeping which lets function-local passes skip function bases which
+  // have not changed since the pass last ran on them without effect. Times are
+  // indices into `invocations` of the (leaf) pass invocation in which the event
+  // occurred. Tracking is only enabled while a compound pass is running as
+  // changes made to the IR outside of a pass pipeline are not observed.
+  struct ChangeTracking {
+    bool enabled = false;
+    // Time at which each function base was last changed by a function-local
+    // pass.
+    absl::flat_hash_map<const FunctionBase*, int64_t> function_changes;
+    // Time at which a pass which is not function-local last changed the IR.
+    // Such a pass may have changed any function base.
+    int64_t global_change = -1;
+    // Time at which each function-local pass last ran on each function base
+    // without changing it.
+    absl::flat_hash_map<std::pair<const void*, const FunctionBase*>, int64_t>
+        unchanged_runs;
+    // Time at which each function base was last found to be well formed by
+    // the IR verifier (see VerifierChecker). Function bases which have not
+    // changed since are not verified again.
+    absl::flat_hash_map<const FunctionBase*, int64_t> verification_times;
+  };
+  ChangeTracking change_tracking;
+
+  // Query engines shared by the passes of a pipeline and kept up to date
+  // incrementally as the IR changes (see GetSharedTernaryQueryEngine). Created
+  // on first use and destroyed when the top-level compound pass finishes.
+  std::shared_ptr<TernaryQueryEngineCache> ternary_query_engine_cache;
+
+  // Named counters accumulated over the run of the pipeline by passes which
+  // report the size of what they generate, e.g., "proc_inlining.*". Only
+  // passes which are not function-local may update the counters.
+  absl::flat_hash_map<std::string, int64_t> counters;
 };
 
 // Base class for all compiler passes. Template parameters:
 //
 //   IrT : The data type that the pass operates on (e.g., xls::Package). The
 //     type should define 'DumpIr' and 'name' methods used for dumping and
-//     logging in compound passes. A pass which strictly operate on the XLS IR
+//     logging in compound passes and a 'GetNodeCount' method used for
+//     gathering pass metrics. A pass which strictly operate on the XLS IR
 //     may use the xls::Package type as the IrT template argument. Passes which
 //     operate on the IR and a schedule may be instantiated on a data structure
 //     containing both an xls::Package and a schedule. Roughly, IrT should
@@ -145,6 +235,12 @@ class PassBase {
   // Returns true if this is a compound pass.
   virtual bool IsCompound() const { return false; }
 
+  // Returns true if running the pass on a function/proc modifies nothing but
+  // that function/proc (and package-owned types) and reads nothing but it and
+  // the functions it calls. Only meaningful for passes over packages; see
+  // FunctionBasePass.
+  virtual bool IsFunctionLocal() const { return false; }
+
  protected:
   // Derived classes should override this function which is invoked from Run.
   virtual absl::StatusOr<bool> RunInternal(IrT* ir, const OptionsT& options,
@@ -221,8 +317,16 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
                                  "start",
                                  /*ordinal=*/0, /*changed=*/false));
     }
-    return RunNested(ir, options, results, this->short_name(),
-                     /*invariant_checkers=*/{});
+    // Change tracking is only valid for the duration of the top-level pass.
+    results->change_tracking = typename ResultsT::ChangeTracking();
+    results->change_tracking.enabled = true;
+    results->ternary_query_engine_cache.reset();
+    absl::StatusOr<bool> changed =
+        RunNested(ir, options, results, this->short_name(),
+                  /*invariant_checkers=*/{});
+    results->change_tracking = typename ResultsT::ChangeTracking();
+    results->ternary_query_engine_cache.reset();
+    return changed;
   }
 
   // Internal implementation of Run for compound passes. Invoked when a compound
@@ -344,6 +448,7 @@ absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
     // do not check it in optimized builds.
     std::string ir_before = ir->DumpIr();
 #endif
+    int64_t node_count_before = ir->GetNodeCount();
     absl::Time start = absl::Now();
     bool pass_changed;
     if (pass->IsCompound()) {
@@ -378,8 +483,12 @@ absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
         pass->short_name(),
         (pass_changed ? "changed IR" : "did not change IR"));
     if (!pass->IsCompound()) {
-      results->invocations.push_back(
-          {pass->short_name(), pass_changed, duration});
+      if (pass_changed && !pass->IsFunctionLocal()) {
+        results->change_tracking.global_change = results->invocations.size();
+      }
+      results->invocations.push_back({pass->short_name(), pass_changed,
+                                      duration, node_count_before,
+                                      ir->GetNodeCount()});
     }
     if (!options.ir_dump_path.empty()) {
       XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, top_level_name,
@@ -0,0 +1,96 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_metrics.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+
+namespace xls {
+
+PipelineMetricsProto SummarizePassResults(const PassResults& results) {
+  PipelineMetricsProto metrics;
+  absl::flat_hash_map<std::string, PassMetricsProto> pass_metrics;
+  // Pass names in order of first invocation for a deterministic tie break.
+  std::vector<std::string> pass_names;
+  absl::Duration total_duration;
+  for (const PassInvocation& invocation : results.invocations) {
+    auto [it, inserted] = pass_metrics.try_emplace(invocation.pass_name);
+    PassMetricsProto& pass = it->second;
+    if (inserted) {
+      pass.set_pass_name(invocation.pass_name);
+      pass_names.push_back(invocation.pass_name);
+    }
+    pass.set_invocation_count(pass.invocation_count() + 1);
+    pass.set_changed_count(pass.changed_count() +
+                           (invocation.ir_changed ? 1 : 0));
+    pass.set_total_duration_us(
+        pass.total_duration_us() +
+        absl::ToInt64Microseconds(invocation.run_duration));
+    pass.set_node_count_delta(pass.node_count_delta() +
+                              invocation.node_count_after -
+                              invocation.node_count_before);
+    total_duration += invocation.run_duration;
+  }
+  std::stable_sort(pass_names.begin(), pass_names.end(),
+                   [&](const std::string& a, const std::string& b) {
+                     return pass_metrics.at(a).total_duration_us() >
+                            pass_metrics.at(b).total_duration_us();
+                   });
+  for (const std::string& name : pass_names) {
+    *metrics.add_passes() = std::move(pass_metrics.at(name));
+  }
+  metrics.set_invocation_count(results.invocations.size());
+  metrics.set_total_duration_us(absl::ToInt64Microseconds(total_duration));
+  if (!results.invocations.empty()) {
+    metrics.set_initial_node_count(
+        results.invocations.front().node_count_before);
+    metrics.set_final_node_count(results.invocations.back().node_count_after);
+  }
+  metrics.mutable_counters()->insert(results.counters.begin(),
+                                     results.counters.end());
+  return metrics;
+}
+
+std::string PipelineMetricsToString(const PipelineMetricsProto& metrics) {
+  std::string out = absl::StrFormat(
+      "Pass run durations (# of times pass changed IR / # of times pass was "
+      "run, change in node count):\n");
+  for (const PassMetricsProto& pass : metrics.passes()) {
+    absl::StrAppendFormat(&out, "  %-20s : %-5dms (%3d / %3d, %+d)\n",
+                          pass.pass_name(), pass.total_duration_us() / 1000,
+                          pass.changed_count(), pass.invocation_count(),
+                          pass.node_count_delta());
+  }
+  if (!metrics.counters().empty()) {
+    std::vector<std::pair<std::string, int64_t>> counters(
+        metrics.counters().begin(), metrics.counters().end());
+    std::sort(counters.begin(), counters.end());
+    absl::StrAppend(&out, "Counters:\n");
+    for (const auto& [name, value] : counters) {
+      absl::StrAppendFormat(&out, "  %-40s : %d\n", name, value);
+    }
+  }
+  return out;
+}
+
+}  // namespace xls
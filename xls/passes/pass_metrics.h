@@ -0,0 +1,33 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PASS_METRICS_H_
+#define XLS_PASSES_PASS_METRICS_H_
+
+#include <string>
+
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+
+// Aggregates the invocations recorded in `results` by pass name.
+PipelineMetricsProto SummarizePassResults(const PassResults& results);
+
+// Returns a human-readable table of the given metrics, one line per pass.
+std::string PipelineMetricsToString(const PipelineMetricsProto& metrics);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PASS_METRICS_H_
@@ -0,0 +1,82 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_metrics.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(PassMetricsTest, SummarizeEmptyResults) {
+  PipelineMetricsProto metrics = SummarizePassResults(PassResults());
+  EXPECT_EQ(metrics.invocation_count(), 0);
+  EXPECT_EQ(metrics.total_duration_us(), 0);
+  EXPECT_EQ(metrics.passes_size(), 0);
+}
+
+TEST(PassMetricsTest, SummarizeAggregatesByPass) {
+  PassResults results;
+  results.invocations.push_back({"dce", true, absl::Milliseconds(2), 100, 90});
+  results.invocations.push_back(
+      {"narrow", true, absl::Milliseconds(10), 90, 95});
+  results.invocations.push_back({"dce", false, absl::Milliseconds(3), 95, 95});
+  results.invocations.push_back({"cse", true, absl::Milliseconds(1), 95, 80});
+
+  PipelineMetricsProto metrics = SummarizePassResults(results);
+  EXPECT_EQ(metrics.invocation_count(), 4);
+  EXPECT_EQ(metrics.total_duration_us(), 16000);
+  EXPECT_EQ(metrics.initial_node_count(), 100);
+  EXPECT_EQ(metrics.final_node_count(), 80);
+
+  // Sorted by decreasing total duration.
+  ASSERT_EQ(metrics.passes_size(), 3);
+  EXPECT_EQ(metrics.passes(0).pass_name(), "narrow");
+  EXPECT_EQ(metrics.passes(0).node_count_delta(), 5);
+  EXPECT_EQ(metrics.passes(1).pass_name(), "dce");
+  EXPECT_EQ(metrics.passes(1).invocation_count(), 2);
+  EXPECT_EQ(metrics.passes(1).changed_count(), 1);
+  EXPECT_EQ(metrics.passes(1).total_duration_us(), 5000);
+  EXPECT_EQ(metrics.passes(1).node_count_delta(), -10);
+  EXPECT_EQ(metrics.passes(2).pass_name(), "cse");
+  EXPECT_EQ(metrics.passes(2).node_count_delta(), -15);
+
+  std::string summary = PipelineMetricsToString(metrics);
+  EXPECT_THAT(summary, HasSubstr("narrow"));
+  EXPECT_THAT(summary, HasSubstr("(  1 /   2, -10)"));
+  EXPECT_THAT(summary, Not(HasSubstr("Counters")));
+}
+
+TEST(PassMetricsTest, SummarizeCounters) {
+  PassResults results;
+  results.counters["proc_inlining.activation_nodes"] = 12;
+  results.counters["proc_inlining.inlined_procs"] = 3;
+
+  PipelineMetricsProto metrics = SummarizePassResults(results);
+  EXPECT_THAT(metrics.counters(),
+              UnorderedElementsAre(Pair("proc_inlining.activation_nodes", 12),
+                                   Pair("proc_inlining.inlined_procs", 3)));
+  EXPECT_THAT(PipelineMetricsToString(metrics),
+              HasSubstr("proc_inlining.inlined_procs"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,11 +14,17 @@
 
 #include "xls/passes/passes.h"
 
+#include <algorithm>
+#include <atomic>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/call_graph.h"
 
 namespace xls {
 
@@ -41,15 +47,127 @@ absl::StatusOr<bool> FunctionBasePass::RunOnFunctionBase(
 absl::StatusOr<bool> FunctionBasePass::RunInternal(Package* p,
                                                    const PassOptions& options,
                                                    PassResults* results) const {
+  if (options.function_pass_threads > 1 && IsFunctionLocal()) {
+    return RunInternalInParallel(p, options, results);
+  }
   bool changed = false;
   for (FunctionBase* f : p->GetFunctionBases()) {
+    if (IsUnchangedSinceLastRun(f, *results)) {
+      continue;
+    }
     XLS_ASSIGN_OR_RETURN(bool function_changed,
                          RunOnFunctionBaseInternal(f, options, results));
+    RecordRun(f, function_changed, results);
     changed |= function_changed;
   }
   return changed;
 }
 
+bool FunctionBasePass::IsUnchangedSinceLastRun(
+    FunctionBase* f, const PassResults& results) const {
+  const PassResults::ChangeTracking& tracking = results.change_tracking;
+  if (!tracking.enabled || !IsFunctionLocal()) {
+    return false;
+  }
+  auto run_it = tracking.unchanged_runs.find({this, f});
+  if (run_it == tracking.unchanged_runs.end()) {
+    return false;
+  }
+  int64_t last_run = run_it->second;
+  if (tracking.global_change >= last_run) {
+    return false;
+  }
+  for (FunctionBase* dependency : GetDependentFunctions(f)) {
+    auto change_it = tracking.function_changes.find(dependency);
+    if (change_it != tracking.function_changes.end() &&
+        change_it->second >= last_run) {
+      return false;
+    }
+  }
+  XLS_VLOG(2) << absl::StreamFormat(
+      "Skipping %s on function_base %s: unchanged since last run",
+      long_name(), f->name());
+  return true;
+}
+
+void FunctionBasePass::RecordRun(FunctionBase* f, bool changed,
+                                 PassResults* results) const {
+  PassResults::ChangeTracking& tracking = results->change_tracking;
+  if (!tracking.enabled || !IsFunctionLocal()) {
+    return;
+  }
+  int64_t now = results->invocations.size();
+  if (changed) {
+    tracking.function_changes[f] = now;
+    tracking.unchanged_runs.erase({this, f});
+  } else {
+    tracking.unchanged_runs[{this, f}] = now;
+  }
+}
+
+namespace {
+
+// Partitions the function bases of the package into waves such that every
+// function called by a function base is in an earlier wave. Function bases in
+// the same wave do not call each other.
+std::vector<std::vector<FunctionBase*>> CallGraphWaves(Package* p) {
+  absl::flat_hash_map<FunctionBase*, int64_t> wave_index;
+  std::vector<std::vector<FunctionBase*>> waves;
+  for (FunctionBase* f : FunctionsInPostOrder(p)) {
+    int64_t index = 0;
+    for (Function* callee : CalledFunctions(f)) {
+      index = std::max(index, wave_index.at(callee) + 1);
+    }
+    wave_index[f] = index;
+    if (index >= waves.size()) {
+      waves.resize(index + 1);
+    }
+    waves[index].push_back(f);
+  }
+  return waves;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> FunctionBasePass::RunInternalInParallel(
+    Package* p, const PassOptions& options, PassResults* results) const {
+  bool changed = false;
+  for (const std::vector<FunctionBase*>& all_in_wave : CallGraphWaves(p)) {
+    // Changes made in earlier waves are recorded before this filtering so
+    // callers of changed functions are not skipped.
+    std::vector<FunctionBase*> wave;
+    for (FunctionBase* f : all_in_wave) {
+      if (!IsUnchangedSinceLastRun(f, *results)) {
+        wave.push_back(f);
+      }
+    }
+    std::vector<absl::StatusOr<bool>> wave_results(wave.size(), false);
+    std::atomic<int64_t> next_index = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_index.fetch_add(1); i < wave.size();
+           i = next_index.fetch_add(1)) {
+        wave_results[i] = RunOnFunctionBaseInternal(wave[i], options, results);
+      }
+    };
+    int64_t thread_count =
+        std::min<int64_t>(options.function_pass_threads, wave.size());
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    worker();
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+    for (int64_t i = 0; i < wave.size(); ++i) {
+      XLS_RETURN_IF_ERROR(wave_results[i].status());
+      RecordRun(wave[i], wave_results[i].value(), results);
+      changed |= wave_results[i].value();
+    }
+  }
+  return changed;
+}
+
 absl::StatusOr<bool> FunctionBasePass::TransformNodesToFixedPoint(
     FunctionBase* f,
     std::function<absl::StatusOr<bool>(Node*)> simplify_f) const {
@@ -59,12 +59,37 @@ class FunctionBasePass : public Pass {
                                          const PassOptions& options,
                                          PassResults* results) const;
 
+  // Function-local passes (see PassBase::IsFunctionLocal) may be run
+  // concurrently over the package when PassOptions::function_pass_threads is
+  // greater than one and so must not modify the PassResults passed to
+  // RunOnFunctionBaseInternal. When run inside a compound pass they also skip
+  // function bases which are unchanged since they last ran on them without
+  // effect.
+
  protected:
   // Iterates over each function and proc in the package calling
   // RunOnFunctionBase.
   absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
                                    PassResults* results) const override;
 
+  // Runs the pass over the function bases of the package using
+  // options.function_pass_threads threads. Function bases are processed in
+  // waves so that a function base is only transformed after all the
+  // functions it calls have been transformed and while no function calling
+  // it is being transformed.
+  absl::StatusOr<bool> RunInternalInParallel(Package* p,
+                                             const PassOptions& options,
+                                             PassResults* results) const;
+
+  // Returns true if this function-local pass previously ran on `f` without
+  // changing it and neither `f` nor any function it calls has changed since.
+  bool IsUnchangedSinceLastRun(FunctionBase* f,
+                               const PassResults& results) const;
+
+  // Records the outcome of running this pass on `f` in the change tracking
+  // of `results`.
+  void RecordRun(FunctionBase* f, bool changed, PassResults* results) const;
+
   virtual absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
       PassResults* results) const = 0;
@@ -16,8 +16,10 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
@@ -29,6 +31,7 @@
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
+#include "xls/ir/verifier.h"
 
 namespace xls {
 namespace {
@@ -477,5 +480,189 @@ TEST(PassesTest, TestTransformNodesToFixedPointWhileRemovingNodes) {
               IsOkAndHolds(false));
 }
 
+// Function-local pass which records the order in which function bases are
+// visited and adds a literal to each of them.
+class CallOrderRecordingPass : public FunctionBasePass {
+ public:
+  CallOrderRecordingPass() : FunctionBasePass("record", "Recording pass") {}
+
+  bool IsFunctionLocal() const override { return true; }
+
+  std::vector<std::string> visited() const {
+    absl::MutexLock lock(&mutex_);
+    return visited_;
+  }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const PassOptions& options,
+      PassResults* results) const override {
+    XLS_RETURN_IF_ERROR(
+        f->MakeNode<Literal>(SourceInfo(), Value(UBits(42, 123))).status());
+    absl::MutexLock lock(&mutex_);
+    visited_.push_back(f->name());
+    return true;
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  mutable std::vector<std::string> visited_ ABSL_GUARDED_BY(mutex_);
+};
+
+TEST(PassesTest, FunctionPassThreadsRunsCalleesFirst) {
+  auto p = std::make_unique<Package>("p");
+  Type* u32 = p->GetBitsType(32);
+  auto add_function = [&](std::string_view name,
+                          std::vector<Function*> callees) -> Function* {
+    FunctionBuilder fb(name, p.get());
+    BValue x = fb.Param("x", u32);
+    BValue result = x;
+    for (Function* callee : callees) {
+      result = fb.Add(result, fb.Invoke({x}, callee));
+    }
+    return fb.BuildWithReturnValue(result).value();
+  };
+  Function* a = add_function("a", {});
+  Function* b = add_function("b", {});
+  Function* c = add_function("c", {a});
+  add_function("d", {c, b});
+  for (int64_t i = 0; i < 8; ++i) {
+    add_function(absl::StrFormat("leaf%d", i), {});
+  }
+
+  CallOrderRecordingPass pass;
+  PassOptions options;
+  options.function_pass_threads = 4;
+  PassResults results;
+  ASSERT_THAT(pass.Run(p.get(), options, &results), IsOkAndHolds(true));
+
+  std::vector<std::string> visited = pass.visited();
+  EXPECT_EQ(visited.size(), p->functions().size());
+  auto position = [&](std::string_view name) {
+    return std::find(visited.begin(), visited.end(), name) - visited.begin();
+  };
+  EXPECT_LT(position("a"), position("c"));
+  EXPECT_LT(position("c"), position("d"));
+  EXPECT_LT(position("b"), position("d"));
+  for (const std::unique_ptr<Function>& f : p->functions()) {
+    EXPECT_LT(position(f->name()), visited.size());
+  }
+  XLS_EXPECT_OK(VerifyPackage(p.get()));
+}
+
+// Function-local pass which counts how many times it runs on each function
+// base. If `change_once` is given, the pass adds a dead literal to the
+// function base of that name the first time it runs on it.
+class CountingPass : public FunctionBasePass {
+ public:
+  explicit CountingPass(std::string_view change_once = "")
+      : FunctionBasePass("count", "Counting pass"), change_once_(change_once) {}
+
+  bool IsFunctionLocal() const override { return true; }
+
+  int64_t run_count(std::string_view name) const {
+    return run_counts_.contains(name) ? run_counts_.at(name) : 0;
+  }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const PassOptions& options,
+      PassResults* results) const override {
+    if (++run_counts_[f->name()] == 1 && f->name() == change_once_) {
+      XLS_RETURN_IF_ERROR(
+          f->MakeNode<Literal>(SourceInfo(), Value(UBits(1, 1))).status());
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  std::string change_once_;
+  mutable absl::flat_hash_map<std::string, int64_t> run_counts_;
+};
+
+// Package-wide pass which adds a dead literal to `f` the first time it runs.
+class ChangeOncePass : public Pass {
+ public:
+  explicit ChangeOncePass(Function* f)
+      : Pass("change_once", "Change once pass"), f_(f) {}
+
+  absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
+                                   PassResults* results) const override {
+    if (changed_) {
+      return false;
+    }
+    changed_ = true;
+    XLS_RETURN_IF_ERROR(
+        f_->MakeNode<Literal>(SourceInfo(), Value(UBits(1, 1))).status());
+    return true;
+  }
+
+ private:
+  Function* f_;
+  mutable bool changed_ = false;
+};
+
+// Builds a package with functions a, b, c and d where c invokes a and d invokes
+// b.
+std::unique_ptr<Package> BuildCallChainPackage() {
+  auto p = std::make_unique<Package>("p");
+  Type* u32 = p->GetBitsType(32);
+  auto add_function = [&](std::string_view name,
+                          std::optional<Function*> callee) -> Function* {
+    FunctionBuilder fb(name, p.get());
+    BValue x = fb.Param("x", u32);
+    BValue result = callee.has_value() ? fb.Invoke({x}, *callee) : x;
+    return fb.BuildWithReturnValue(result).value();
+  };
+  Function* a = add_function("a", std::nullopt);
+  Function* b = add_function("b", std::nullopt);
+  add_function("c", a);
+  add_function("d", b);
+  return p;
+}
+
+TEST(PassesTest, FixedPointSkipsUnchangedFunctions) {
+  std::unique_ptr<Package> p = BuildCallChainPackage();
+  FixedPointCompoundPass pipeline("fixed_point", "Fixed point");
+  CountingPass* counter = pipeline.Add<CountingPass>();
+  CountingPass* change_b = pipeline.Add<CountingPass>("b");
+  PassResults results;
+  ASSERT_THAT(pipeline.Run(p.get(), PassOptions(), &results),
+              IsOkAndHolds(true));
+
+  // Only b and its caller d changed in the first iteration so only they are
+  // revisited in the second iteration.
+  EXPECT_EQ(counter->run_count("a"), 1);
+  EXPECT_EQ(counter->run_count("b"), 2);
+  EXPECT_EQ(counter->run_count("c"), 1);
+  EXPECT_EQ(counter->run_count("d"), 2);
+  EXPECT_EQ(change_b->run_count("a"), 1);
+  EXPECT_EQ(change_b->run_count("b"), 2);
+  EXPECT_EQ(change_b->run_count("c"), 1);
+  EXPECT_EQ(change_b->run_count("d"), 2);
+}
+
+TEST(PassesTest, FixedPointRerunsAfterNonLocalChange) {
+  std::unique_ptr<Package> p = BuildCallChainPackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, p->GetFunction("a"));
+  FixedPointCompoundPass pipeline("fixed_point", "Fixed point");
+  CountingPass* counter = pipeline.Add<CountingPass>();
+  pipeline.Add<ChangeOncePass>(a);
+  PassResults results;
+  ASSERT_THAT(pipeline.Run(p.get(), PassOptions(), &results),
+              IsOkAndHolds(true));
+
+  // The change made by the non-local pass may have touched any function.
+  for (std::string_view name : {"a", "b", "c", "d"}) {
+    EXPECT_EQ(counter->run_count(name), 2) << name;
+  }
+
+  // Change tracking only applies within a single run of the pipeline.
+  ASSERT_THAT(pipeline.Run(p.get(), PassOptions(), &results),
+              IsOkAndHolds(false));
+  EXPECT_EQ(counter->run_count("a"), 3);
+}
+
 }  // namespace
 }  // namespace xls
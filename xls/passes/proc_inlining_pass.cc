@@ -14,6 +14,9 @@
 
 #include "xls/passes/proc_inlining_pass.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/common/logging/logging.h"
@@ -1181,6 +1184,23 @@ class ProcThread {
     return sink_activation_node_->activation_out;
   }
 
+  // Returns the number of nodes in the activation network of the proc thread.
+  int64_t GetActivationNodeCount() const { return activation_nodes_.size(); }
+
+  // Returns the number of bits of state added by the proc thread in addition
+  // to the state of the inlined proc (activation bit, saved receive data,
+  // etc).
+  int64_t GetBookkeepingStateBitCount() const {
+    int64_t bit_count = 0;
+    for (const StateElement& element : state_elements_) {
+      if (std::find(proc_state_.begin(), proc_state_.end(), &element) ==
+          proc_state_.end()) {
+        bit_count += element.GetInitialValue().GetFlatBitCount();
+      }
+    }
+    return bit_count;
+  }
+
  private:
   // The proc whose logic which this proc thread evaluates.
   Proc* inlined_proc_;
@@ -1591,8 +1611,10 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(Package* p,
   }
 
   std::vector<Proc*> procs_to_inline;
+  int64_t inlined_node_count = 0;
   for (const std::unique_ptr<Proc>& proc : p->procs()) {
     procs_to_inline.push_back(proc.get());
+    inlined_node_count += proc->node_count();
   }
 
   Proc* container_proc =
@@ -1697,6 +1719,41 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(Package* p,
 
   XLS_VLOG(3) << "After deleting inlined procs:\n" << p->DumpIr();
 
+  // Record the size of the logic generated to sequence the inlined procs. Any
+  // nodes in the container proc beyond those cloned from the inlined procs are
+  // activation logic, virtual channel logic or state bookkeeping.
+  int64_t activation_node_count = 0;
+  int64_t bookkeeping_state_bits = 0;
+  for (const ProcThread& proc_thread : proc_threads) {
+    activation_node_count += proc_thread.GetActivationNodeCount();
+    bookkeeping_state_bits += proc_thread.GetBookkeepingStateBitCount();
+  }
+  int64_t channel_state_bits = 0;
+  for (const auto& [_, virtual_channel] : virtual_channels) {
+    if (virtual_channel.ChannelDataState().has_value()) {
+      channel_state_bits +=
+          virtual_channel.ChannelDataState()->GetInitialValue()
+              .GetFlatBitCount() +
+          virtual_channel.ChannelValidState()->GetInitialValue()
+              .GetFlatBitCount();
+    }
+  }
+  int64_t generated_node_count =
+      std::max(int64_t{0}, container_proc->node_count() - inlined_node_count);
+  XLS_VLOG(2) << absl::StreamFormat(
+      "Inlined %d procs and %d virtual channels: %d activation nodes, %d "
+      "generated nodes, %d bookkeeping state bits, %d channel state bits",
+      procs_to_inline.size(), virtual_channels.size(), activation_node_count,
+      generated_node_count, bookkeeping_state_bits, channel_state_bits);
+  results->counters["proc_inlining.inlined_procs"] += procs_to_inline.size();
+  results->counters["proc_inlining.virtual_channels"] +=
+      virtual_channels.size();
+  results->counters["proc_inlining.activation_nodes"] += activation_node_count;
+  results->counters["proc_inlining.generated_nodes"] += generated_node_count;
+  results->counters["proc_inlining.bookkeeping_state_bits"] +=
+      bookkeeping_state_bits;
+  results->counters["proc_inlining.channel_state_bits"] += channel_state_bits;
+
   return true;
 }
 
@@ -458,6 +458,45 @@ TEST_F(ProcInliningPassTest, NestedProcsFifoDepth1) {
                 /*expected_ticks=*/3);
 }
 
+TEST_F(ProcInliningPassTest, ReportsCounters) {
+  auto p = CreatePackage();
+  Type* u32 = p->GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_in,
+      p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_out,
+      p->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * a_to_b,
+      p->CreateStreamingChannel("a_to_b", ChannelOps::kSendReceive, u32,
+                                /*initial_values=*/{}, /*fifo_depth=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * b_to_a,
+      p->CreateStreamingChannel("b_to_a", ChannelOps::kSendReceive, u32,
+                                /*initial_values=*/{}, /*fifo_depth=*/1));
+
+  XLS_ASSERT_OK(MakePassThroughProc("A", ch_in, a_to_b, b_to_a, ch_out, p.get())
+                    .status());
+  XLS_ASSERT_OK(MakeDoublerProc("B", a_to_b, b_to_a, p.get()).status());
+  XLS_ASSERT_OK(p->SetTopByName("A"));
+
+  PassOptions options;
+  options.inline_procs = true;
+  PassResults results;
+  ASSERT_THAT(ProcInliningPass().Run(p.get(), options, &results),
+              IsOkAndHolds(true));
+
+  EXPECT_EQ(results.counters.at("proc_inlining.inlined_procs"), 2);
+  EXPECT_EQ(results.counters.at("proc_inlining.virtual_channels"), 2);
+  // Each FIFO of depth one holds 32 bits of data and a valid bit.
+  EXPECT_EQ(results.counters.at("proc_inlining.channel_state_bits"), 66);
+  EXPECT_GT(results.counters.at("proc_inlining.activation_nodes"), 0);
+  EXPECT_GT(results.counters.at("proc_inlining.bookkeeping_state_bits"), 0);
+  EXPECT_GT(results.counters.at("proc_inlining.generated_nodes"), 0);
+}
+
 TEST_F(ProcInliningPassTest, NestedProcsWithUnspecifiedFifoDepth) {
   // Nested procs where the inner proc does a trivial arithmetic operation.
   auto p = CreatePackage();
@@ -151,10 +151,7 @@ absl::StatusOr<bool> RemoveUnobservableStateElements(Proc* proc) {
 
   // The equivalence classes of state element indices. State element X is in the
   // same class as Y if the next-state value of X depends on Y or vice versa.
-  UnionFind<int64_t> state_components;
-  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
-    state_components.Insert(i);
-  }
+  DenseUnionFind state_components(proc->GetStateElementCount());
 
   // At the end, the union-find data structure will have one equivalence class
   // corresponding to the set of all observable state indices. This value is
@@ -14,12 +14,17 @@
 
 #include "xls/passes/range_query_engine.h"
 
+#include <algorithm>
 #include <limits>
+#include <utility>
+#include <vector>
 
+#include "absl/container/btree_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/abstract_node_evaluator.h"
@@ -366,12 +371,103 @@ IntervalSet MinimizeIntervals(IntervalSet intervals, int64_t size) {
   return result;
 }
 
+int64_t MaxIntervalSetSizeForNodeCount(int64_t node_count) {
+  int64_t size = RangeQueryEngine::kMaxIntervalSetSize;
+  for (int64_t threshold = 1000; node_count > threshold; threshold *= 10) {
+    size /= 2;
+    if (size <= RangeQueryEngine::kMinIntervalSetSize) {
+      return RangeQueryEngine::kMinIntervalSetSize;
+    }
+  }
+  return size;
+}
+
 absl::StatusOr<ReachedFixpoint> RangeQueryEngine::Populate(FunctionBase* f) {
+  max_interval_set_size_ = MaxIntervalSetSizeForNodeCount(f->node_count());
+  levels_.clear();
+  for (Node* node : TopoSort(f)) {
+    GetLevel(node);
+  }
   RangeQueryVisitor visitor(this);
   XLS_RETURN_IF_ERROR(f->Accept(&visitor));
   return visitor.GetReachedFixpoint();
 }
 
+int64_t RangeQueryEngine::GetLevel(Node* node) {
+  auto it = levels_.find(node);
+  if (it != levels_.end()) {
+    return it->second;
+  }
+  int64_t level = 0;
+  for (Node* operand : node->operands()) {
+    level = std::max(level, GetLevel(operand) + 1);
+  }
+  levels_[node] = level;
+  return level;
+}
+
+void RangeQueryEngine::UpdateLevel(Node* node) {
+  std::vector<Node*> worklist = {node};
+  while (!worklist.empty()) {
+    Node* n = worklist.back();
+    worklist.pop_back();
+    int64_t level = 0;
+    for (Node* operand : n->operands()) {
+      level = std::max(level, GetLevel(operand) + 1);
+    }
+    auto [it, inserted] = levels_.try_emplace(n, level);
+    if (!inserted) {
+      if (it->second >= level) {
+        continue;
+      }
+      it->second = level;
+    }
+    for (Node* user : n->users()) {
+      if (levels_.contains(user)) {
+        worklist.push_back(user);
+      }
+    }
+  }
+}
+
+absl::StatusOr<ReachedFixpoint> RangeQueryEngine::Update(
+    FunctionBase* f, absl::Span<Node* const> modified) {
+  for (Node* node : modified) {
+    XLS_RET_CHECK_EQ(node->function_base(), f) << node->GetName();
+    UpdateLevel(node);
+  }
+
+  // Worklist of nodes to re-evaluate ordered by level (and id, for
+  // determinism) so each node is evaluated at most once, after all of its
+  // re-evaluated operands. The levels do not change while nodes are queued.
+  auto level_order = [this](Node* a, Node* b) {
+    return std::make_pair(levels_.at(a), a->id()) <
+           std::make_pair(levels_.at(b), b->id());
+  };
+  absl::btree_set<Node*, decltype(level_order)> worklist(level_order);
+  worklist.insert(modified.begin(), modified.end());
+
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  RangeQueryVisitor visitor(this);
+  while (!worklist.empty()) {
+    Node* node = *worklist.begin();
+    worklist.erase(worklist.begin());
+
+    IntervalSetTree previous = GetIntervalSetTree(node);
+    ForgetIntervals(node);
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
+    if (GetIntervalSetTree(node) == previous) {
+      continue;
+    }
+    rf = ReachedFixpoint::Changed;
+    for (Node* user : node->users()) {
+      GetLevel(user);
+      worklist.insert(user);
+    }
+  }
+  return rf;
+}
+
 IntervalSetTree RangeQueryEngine::GetIntervalSetTree(Node* node) const {
   if (interval_sets_.contains(node)) {
     return interval_sets_.at(node);
@@ -508,7 +604,8 @@ absl::Status RangeQueryVisitor::HandleVariadicOp(
     return early_status;
   }
 
-  result_intervals = MinimizeIntervals(result_intervals);
+  result_intervals =
+      MinimizeIntervals(result_intervals, engine_->max_interval_set_size());
 
   LeafTypeTree<IntervalSet> result(op->GetType());
   result.Set({}, result_intervals);
@@ -1046,7 +1143,7 @@ absl::Status RangeQueryVisitor::HandlePrioritySel(PrioritySelect* sel) {
     }
   }
   for (IntervalSet& intervals : result.elements()) {
-    intervals = MinimizeIntervals(intervals);
+    intervals = MinimizeIntervals(intervals, engine_->max_interval_set_size());
   }
   SetIntervalSetTree(sel, result);
   return absl::OkStatus();
@@ -1194,7 +1291,7 @@ absl::Status RangeQueryVisitor::HandleSel(Select* sel) {
     combine(sel->default_value().value());
   }
   for (IntervalSet& intervals : result.elements()) {
-    intervals = MinimizeIntervals(intervals);
+    intervals = MinimizeIntervals(intervals, engine_->max_interval_set_size());
   }
   SetIntervalSetTree(sel, result);
   return absl::OkStatus();
@@ -23,6 +23,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -42,6 +43,11 @@ class RangeQueryVisitor;
 // A query engine which tracks sets of intervals that a value can be in.
 class RangeQueryEngine : public QueryEngine {
  public:
+  // The maximum interval set size used for small functions.
+  static constexpr int64_t kMaxIntervalSetSize = 16;
+  // The smallest maximum interval set size used for very large functions.
+  static constexpr int64_t kMinIntervalSetSize = 4;
+
   // Create a `RangeQueryEngine` that contains no data.
   RangeQueryEngine() {}
 
@@ -49,6 +55,31 @@ class RangeQueryEngine : public QueryEngine {
   // given `FunctionBase*`;
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  // Incrementally updates the analysis of `f` after the nodes in `modified`
+  // were added to `f` or had their operands replaced. The analysis must have
+  // been populated for `f` previously. The modified nodes are re-evaluated
+  // first; the users of a node are re-evaluated only if the intervals of the
+  // node changed, with changes propagating through a worklist ordered by a
+  // level maintained for each node (greater than the levels of its operands),
+  // so the cost of an update depends on the nodes it reaches rather than the
+  // size of `f`. Unlike `Populate`, re-evaluated nodes are computed from
+  // scratch rather than intersected with their previous intervals, so the
+  // result is the same as populating a fresh engine even if the change was not
+  // semantics-preserving.
+  absl::StatusOr<ReachedFixpoint> Update(FunctionBase* f,
+                                         absl::Span<Node* const> modified);
+
+  // Discards the analysis of the given node, e.g. because it is about to be
+  // deleted.
+  void Forget(Node* node) {
+    ForgetIntervals(node);
+    levels_.erase(node);
+  }
+
+  // The maximum number of intervals kept in the interval set of any value.
+  // Set by `Populate` according to the size of the function.
+  int64_t max_interval_set_size() const { return max_interval_set_size_; }
+
   bool IsTracked(Node* node) const override {
     return known_bits_.contains(node);
   }
@@ -124,11 +155,37 @@ class RangeQueryEngine : public QueryEngine {
  private:
   friend class RangeQueryVisitor;
 
+  void ForgetIntervals(Node* node) {
+    known_bits_.erase(node);
+    known_bit_values_.erase(node);
+    interval_sets_.erase(node);
+  }
+
+  // Returns the level of the node, computing it (and those of its operands) if
+  // the node has none yet.
+  int64_t GetLevel(Node* node);
+
+  // Recomputes the level of the node from its operands and raises the levels
+  // of its transitive users where needed to keep them above their operands.
+  void UpdateLevel(Node* node);
+
   absl::flat_hash_map<Node*, Bits> known_bits_;
   absl::flat_hash_map<Node*, Bits> known_bit_values_;
   absl::flat_hash_map<Node*, IntervalSetTree> interval_sets_;
+  // The level of each node is greater than the levels of its operands. Levels
+  // order the worklist of `Update` and are maintained incrementally.
+  absl::flat_hash_map<Node*, int64_t> levels_;
+  int64_t max_interval_set_size_ = kMaxIntervalSetSize;
 };
 
+// Returns the maximum number of intervals to keep per value when analyzing a
+// function with `node_count` nodes. Operations on interval sets are
+// superlinear in the number of intervals (variadic ops consider every
+// combination of operand intervals) so the cap is halved for every tenfold
+// increase in function size beyond 1000 nodes, down to
+// `RangeQueryEngine::kMinIntervalSetSize`.
+int64_t MaxIntervalSetSizeForNodeCount(int64_t node_count);
+
 // Reduce the size of the given `IntervalSet` to the given size.
 // This is used to prevent the analysis from using too much memory and CPU.
 //
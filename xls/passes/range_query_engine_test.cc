@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -43,6 +44,8 @@
 namespace xls {
 namespace {
 
+using status_testing::IsOkAndHolds;
+
 class RangeQueryEngineTest : public IrTestBase {};
 
 // TODO(taktoa): replace this with a proper property-based testing library
@@ -104,6 +107,56 @@ TEST_F(RangeQueryEngineTest, MinimizeIntervals) {
   }
 }
 
+TEST_F(RangeQueryEngineTest, MaxIntervalSetSizeForNodeCount) {
+  EXPECT_EQ(MaxIntervalSetSizeForNodeCount(10), 16);
+  EXPECT_EQ(MaxIntervalSetSizeForNodeCount(1000), 16);
+  EXPECT_EQ(MaxIntervalSetSizeForNodeCount(1001), 8);
+  EXPECT_EQ(MaxIntervalSetSizeForNodeCount(10001), 4);
+  EXPECT_EQ(MaxIntervalSetSizeForNodeCount(1000000), 4);
+}
+
+TEST_F(RangeQueryEngineTest, IncrementalUpdate) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue sum = fb.Add(fb.Literal(UBits(5, 8)), fb.Literal(UBits(2, 8)));
+  BValue out = fb.Add(sum, fb.ZeroExtend(fb.BitSlice(x, 0, 1), 8));
+  BValue unrelated = fb.Not(x);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, fb.BuildWithReturnValue(fb.Tuple({out, unrelated})));
+
+  RangeQueryEngine engine;
+  XLS_ASSERT_OK(engine.Populate(f));
+  EXPECT_EQ(IntervalSetTreeToString(engine.GetIntervalSetTree(out.node())),
+            "[[7, 8]]");
+
+  // Replacing an operand with an equivalent node changes nothing downstream.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Literal * two, f->MakeNode<Literal>(SourceInfo(), Value(UBits(2, 8))));
+  XLS_ASSERT_OK(engine.Update(f, {two}));
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(1, two));
+  EXPECT_THAT(engine.Update(f, {sum.node()}),
+              IsOkAndHolds(ReachedFixpoint::Unchanged));
+
+  // Replace the operand with a different value. The analysis of the users is
+  // recomputed rather than intersected with the stale intervals.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Literal * ten, f->MakeNode<Literal>(SourceInfo(), Value(UBits(10, 8))));
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(1, ten));
+  EXPECT_THAT(engine.Update(f, {ten, sum.node()}),
+              IsOkAndHolds(ReachedFixpoint::Changed));
+  EXPECT_EQ(IntervalSetTreeToString(engine.GetIntervalSetTree(out.node())),
+            "[[15, 16]]");
+
+  RangeQueryEngine fresh;
+  XLS_ASSERT_OK(fresh.Populate(f));
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(engine.GetIntervalSetTree(node), fresh.GetIntervalSetTree(node))
+        << node->GetName();
+  }
+}
+
 TEST_F(RangeQueryEngineTest, Add) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
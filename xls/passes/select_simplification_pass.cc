@@ -33,6 +33,7 @@
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
 #include "xls/passes/ternary_query_engine.h"
+#include "xls/passes/ternary_query_engine_cache.h"
 
 namespace xls {
 namespace {
@@ -969,8 +970,11 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
 absl::StatusOr<bool> SelectSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* func, const PassOptions& options,
     PassResults* results) const {
-  TernaryQueryEngine query_engine;
-  XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
+  TernaryQueryEngine local_query_engine;
+  XLS_ASSIGN_OR_RETURN(
+      const QueryEngine* shared_query_engine,
+      GetSharedTernaryQueryEngine(func, results, &local_query_engine));
+  const QueryEngine& query_engine = *shared_query_engine;
   bool changed = false;
   for (Node* node : TopoSort(func)) {
     XLS_ASSIGN_OR_RETURN(bool node_changed,
@@ -17,13 +17,17 @@
 
 #include "xls/passes/standard_pipeline.h"
 
+#include <string_view>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/passes/arith_simplification_pass.h"
 #include "xls/passes/array_simplification_pass.h"
 #include "xls/passes/bdd_cse_pass.h"
 #include "xls/passes/bdd_simplification_pass.h"
 #include "xls/passes/bit_slice_simplification_pass.h"
 #include "xls/passes/boolean_simplification_pass.h"
+#include "xls/passes/bottom_up_optimization_pass.h"
 #include "xls/passes/canonicalization_pass.h"
 #include "xls/passes/comparison_simplification_pass.h"
 #include "xls/passes/concat_simplification_pass.h"
@@ -34,6 +38,7 @@
 #include "xls/passes/dfe_pass.h"
 #include "xls/passes/identity_removal_pass.h"
 #include "xls/passes/inlining_pass.h"
+#include "xls/passes/literal_interning_pass.h"
 #include "xls/passes/literal_uncommoning_pass.h"
 #include "xls/passes/map_inlining_pass.h"
 #include "xls/passes/mutual_exclusion_pass.h"
@@ -98,6 +103,36 @@ class SimplificationPass : public FixedPointCompoundPass {
   }
 };
 
+// Compound pass containing proc inlining and the proc state cleanup which
+// follows it. Two instances appear in the pipeline: an early one which runs
+// unless PassOptions::defer_proc_inlining is set (and procs are being
+// inlined), and a deferred one which runs only in that case. Deferring keeps
+// the procs separate, and the per-proc optimizations cheap, until late in the
+// pipeline.
+class ProcInliningStagePass : public CompoundPass {
+ public:
+  explicit ProcInliningStagePass(bool deferred)
+      : CompoundPass(deferred ? "deferred_proc_inlining" : "proc_inlining_stage",
+                     deferred ? "Deferred proc inlining" : "Proc inlining"),
+        deferred_(deferred) {}
+
+  absl::StatusOr<bool> RunNested(
+      Package* p, const PassOptions& options, PassResults* results,
+      std::string_view top_level_name,
+      absl::Span<const InvariantChecker* const> invariant_checkers)
+      const override {
+    bool defer = options.inline_procs && options.defer_proc_inlining;
+    if (defer != deferred_) {
+      return false;
+    }
+    return CompoundPass::RunNested(p, options, results, top_level_name,
+                                   invariant_checkers);
+  }
+
+ private:
+  bool deferred_;
+};
+
 std::unique_ptr<CompoundPass> CreateStandardPassPipeline(int64_t opt_level) {
   auto top = std::make_unique<CompoundPass>("ir", "Top level pass pipeline");
   top->AddInvariantChecker<VerifierChecker>();
@@ -111,7 +146,21 @@ std::unique_ptr<CompoundPass> CreateStandardPassPipeline(int64_t opt_level) {
   top->Add<SimplificationPass>(std::min(int64_t{2}, opt_level));
   top->Add<UnrollPass>();
   top->Add<MapInliningPass>();
-  top->Add<InliningPass>();
+
+  // If enabled (see PassOptions::bottom_up_optimization), fully optimize each
+  // invoked function once before it is copied into its call sites.
+  BottomUpOptimizationPass* bottom_up = top->Add<BottomUpOptimizationPass>();
+  bottom_up->Add<SimplificationPass>(std::min(int64_t{2}, opt_level));
+  bottom_up->Add<BddSimplificationPass>(std::min(int64_t{2}, opt_level));
+  bottom_up->Add<DeadCodeEliminationPass>();
+  bottom_up->Add<BddCsePass>();
+  bottom_up->Add<DeadCodeEliminationPass>();
+  bottom_up->Add<ConditionalSpecializationPass>(/*use_bdd=*/true);
+  bottom_up->Add<DeadCodeEliminationPass>();
+  bottom_up->Add<NarrowingPass>(/*use_range_analysis=*/true, opt_level);
+  bottom_up->Add<DeadCodeEliminationPass>();
+
+  top->Add<InliningPass>(/*selective=*/true);
   top->Add<DeadFunctionEliminationPass>();
 
   top->Add<BddSimplificationPass>(std::min(int64_t{2}, opt_level));
@@ -137,17 +186,25 @@ std::unique_ptr<CompoundPass> CreateStandardPassPipeline(int64_t opt_level) {
   top->Add<UselessIORemovalPass>();
   top->Add<DeadCodeEliminationPass>();
 
+  // Inline the invokes left by the selective inlining pass above (see
+  // PassOptions::inlining_node_budget) now that the callees have been
+  // optimized on their own.
+  top->Add<InliningPass>();
+  top->Add<DeadFunctionEliminationPass>();
+
   top->Add<TokenDependencyPass>();
-  top->Add<ProcInliningPass>();
 
   // After proc inlining flatten and optimize the proc state. Run tuple
   // simplification to simplify tuple structures left over from flattening.
   // TODO(meheff): Consider running proc state optimization more than once.
-  top->Add<ProcStateFlatteningPass>();
-  top->Add<IdentityRemovalPass>();
-  top->Add<TupleSimplificationPass>();
-  top->Add<ProcStateOptimizationPass>();
-  top->Add<DeadCodeEliminationPass>();
+  CompoundPass* proc_inlining =
+      top->Add<ProcInliningStagePass>(/*deferred=*/false);
+  proc_inlining->Add<ProcInliningPass>();
+  proc_inlining->Add<ProcStateFlatteningPass>();
+  proc_inlining->Add<IdentityRemovalPass>();
+  proc_inlining->Add<TupleSimplificationPass>();
+  proc_inlining->Add<ProcStateOptimizationPass>();
+  proc_inlining->Add<DeadCodeEliminationPass>();
 
   top->Add<BddSimplificationPass>(std::min(int64_t{3}, opt_level));
   top->Add<DeadCodeEliminationPass>();
@@ -168,8 +225,24 @@ std::unique_ptr<CompoundPass> CreateStandardPassPipeline(int64_t opt_level) {
   top->Add<DeadCodeEliminationPass>();
   top->Add<SimplificationPass>(std::min(int64_t{3}, opt_level));
 
+  // If inlining was deferred, the procs have been optimized individually up to
+  // this point. Inline them now and clean up the logic which sequences them.
+  CompoundPass* deferred_proc_inlining =
+      top->Add<ProcInliningStagePass>(/*deferred=*/true);
+  deferred_proc_inlining->Add<ProcInliningPass>();
+  deferred_proc_inlining->Add<ProcStateFlatteningPass>();
+  deferred_proc_inlining->Add<IdentityRemovalPass>();
+  deferred_proc_inlining->Add<TupleSimplificationPass>();
+  deferred_proc_inlining->Add<ProcStateOptimizationPass>();
+  deferred_proc_inlining->Add<DeadCodeEliminationPass>();
+  deferred_proc_inlining->Add<MutualExclusionPass>();
+  deferred_proc_inlining->Add<DeadCodeEliminationPass>();
+  deferred_proc_inlining->Add<SimplificationPass>(
+      std::min(int64_t{3}, opt_level));
+
   top->Add<LiteralUncommoningPass>();
   top->Add<DeadFunctionEliminationPass>();
+  top->Add<LiteralInterningPass>();
   return top;
 }
 
@@ -270,5 +270,45 @@ TEST_F(StandardPipelineTest, LogicCombining) {
 }
 
 
+TEST_F(StandardPipelineTest, DeferredProcInlining) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package test
+
+chan a_in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan a_to_b(bits[32], id=1, kind=streaming, ops=send_receive, fifo_depth=0, flow_control=none, metadata="")
+chan b_out(bits[32], id=2, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+top proc a(my_token: token, state: (), init={()}) {
+  literal.1: bits[32] = literal(value=2)
+  receive.2: (token, bits[32]) = receive(my_token, channel_id=0)
+  tuple_index.3: token = tuple_index(receive.2, index=0)
+  tuple_index.4: bits[32] = tuple_index(receive.2, index=1)
+  umul.5: bits[32] = umul(literal.1, tuple_index.4)
+  send.6: token = send(tuple_index.3, umul.5, channel_id=1)
+  next (send.6, state)
+}
+
+proc b(my_token: token, state: (), init={()}) {
+  literal.100: bits[32] = literal(value=3)
+  receive.200: (token, bits[32]) = receive(my_token, channel_id=1)
+  tuple_index.300: token = tuple_index(receive.200, index=0)
+  tuple_index.400: bits[32] = tuple_index(receive.200, index=1)
+  umul.500: bits[32] = umul(literal.100, tuple_index.400)
+  send.600: token = send(tuple_index.300, umul.500, channel_id=2)
+  next (send.600, state)
+}
+)"));
+  std::unique_ptr<CompoundPass> pipeline = CreateStandardPassPipeline();
+  PassOptions options;
+  options.inline_procs = true;
+  options.defer_proc_inlining = true;
+  PassResults results;
+  ASSERT_THAT(pipeline->Run(p.get(), options, &results), IsOkAndHolds(true));
+
+  EXPECT_EQ(p->procs().size(), 1);
+  EXPECT_EQ(results.counters.at("proc_inlining.inlined_procs"), 2);
+  EXPECT_EQ(results.counters.at("proc_inlining.virtual_channels"), 1);
+}
+
 }  // namespace
 }  // namespace xls
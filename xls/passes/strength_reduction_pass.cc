@@ -26,6 +26,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/passes/query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
+#include "xls/passes/ternary_query_engine_cache.h"
 
 namespace xls {
 namespace {
@@ -336,8 +337,11 @@ absl::StatusOr<bool> StrengthReduceNode(
 
 absl::StatusOr<bool> StrengthReductionPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const PassOptions& options, PassResults* results) const {
-  TernaryQueryEngine query_engine;
-  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+  TernaryQueryEngine local_query_engine;
+  XLS_ASSIGN_OR_RETURN(
+      const QueryEngine* shared_query_engine,
+      GetSharedTernaryQueryEngine(f, results, &local_query_engine));
+  const QueryEngine& query_engine = *shared_query_engine;
   XLS_ASSIGN_OR_RETURN(absl::flat_hash_set<Node*> reducible_adds,
                        FindReducibleAdds(f, query_engine));
   // Note: because we introduce new nodes into the graph that were not present
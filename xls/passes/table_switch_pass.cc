@@ -13,8 +13,14 @@
 // limitations under the License.
 #include "xls/passes/table_switch_pass.h"
 
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -164,8 +170,9 @@ absl::StatusOr<std::optional<Value>> LinksToTable(
   }
 
   // Gather all selectable Values in a map indexed by the uint64_t index
-  // associated with the Value.
-  absl::flat_hash_map<uint64_t, Value> map;
+  // associated with the Value. The Values are owned by the literals of the
+  // chain so they are only copied once, when the table is built.
+  absl::flat_hash_map<uint64_t, const Value*> map;
   uint64_t min_key = std::numeric_limits<uint64_t>::max();
   uint64_t max_key = 0;
   for (const Link& link : links) {
@@ -175,18 +182,19 @@ absl::StatusOr<std::optional<Value>> LinksToTable(
       // dead and can be ignored.
       continue;
     }
-    map[link.key] = link.value;
+    map[link.key] = &link.value;
     min_key = std::min(min_key, link.key);
     max_key = std::max(max_key, link.key);
   }
 
   // Converts the dense map of Values into an array of Values.
-  auto map_to_array_value = [](const absl::flat_hash_map<uint64_t, Value>& m)
+  auto map_to_array_value =
+      [](const absl::flat_hash_map<uint64_t, const Value*>& m)
       -> absl::StatusOr<Value> {
     std::vector<Value> values(m.size());
     for (auto& [key, value] : m) {
       XLS_RET_CHECK_LT(key, values.size());
-      values[key] = value;
+      values[key] = *value;
     }
     return Value::Array(values);
   };
@@ -209,7 +217,7 @@ absl::StatusOr<std::optional<Value>> LinksToTable(
                 << links.back().next->ToString();
     return absl::nullopt;
   }
-  const Value& else_value = links.back().next->As<Literal>()->value();
+  const Value* else_value = &links.back().next->As<Literal>()->value();
 
   XLS_VLOG(3) << "Index width: " << index_width;
   if (index_space_size.has_value()) {
@@ -256,10 +264,52 @@ absl::StatusOr<std::optional<Value>> LinksToTable(
   return absl::nullopt;
 }
 
+namespace {
+
+// A pool of the array literals of a function keyed by value. Tables which are
+// identical to a literal already in the function (including a table created
+// earlier by this pass) share that literal rather than creating a new one.
+class TablePool {
+ public:
+  explicit TablePool(FunctionBase* f) : f_(f) {}
+
+  // Returns a literal with the given array value, creating one if necessary.
+  absl::StatusOr<Literal*> GetOrCreate(const Value& table,
+                                       const SourceInfo& loc) {
+    if (!populated_) {
+      // Defer indexing the existing literals of the function until a table is
+      // found as most functions contain none.
+      for (Node* node : f_->nodes()) {
+        if (node->Is<Literal>() && node->GetType()->IsArray()) {
+          literals_.insert({node->As<Literal>()->value(), node->As<Literal>()});
+        }
+      }
+      populated_ = true;
+    }
+    auto it = literals_.find(table);
+    if (it != literals_.end()) {
+      XLS_VLOG(3) << absl::StreamFormat("Reusing table literal %s",
+                                        it->second->GetName());
+      return it->second;
+    }
+    XLS_ASSIGN_OR_RETURN(Literal * literal, f_->MakeNode<Literal>(loc, table));
+    literals_[table] = literal;
+    return literal;
+  }
+
+ private:
+  FunctionBase* f_;
+  bool populated_ = false;
+  absl::flat_hash_map<Value, Literal*> literals_;
+};
+
+}  // namespace
+
 absl::StatusOr<bool> TableSwitchPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const PassOptions& options, PassResults* results) const {
   bool changed = false;
   absl::flat_hash_set<Node*> transformed;
+  TablePool table_pool(f);
   for (Node* node : ReverseTopoSort(f)) {
     XLS_VLOG(3) << "Considering node: " << node->ToString();
     if (transformed.contains(node)) {
@@ -331,7 +381,7 @@ absl::StatusOr<bool> TableSwitchPass::RunOnFunctionBaseInternal(
         node->GetName(), table.value().ToString());
 
     XLS_ASSIGN_OR_RETURN(Literal * array_literal,
-                         f->MakeNode<Literal>(node->loc(), table.value()));
+                         table_pool.GetOrCreate(table.value(), node->loc()));
     XLS_RETURN_IF_ERROR(node->ReplaceUsesWithNew<ArrayIndex>(
                                 array_literal, std::vector<Node*>({index}))
                             .status());
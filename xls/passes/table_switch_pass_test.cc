@@ -784,5 +784,49 @@ fn main(index: bits[2]) -> bits[32] {
           /*indices=*/{m::Param()}));
 }
 
+TEST_F(TableSwitchPassTest, SharesIdenticalTables) {
+  // Two chains over different indexes select from the same values.
+  std::string program = R"(
+fn main(a: bits[2], b: bits[2]) -> (bits[32], bits[32]) {
+  _111: bits[32] = literal(value=111)
+  _222: bits[32] = literal(value=222)
+  _333: bits[32] = literal(value=333)
+  _444: bits[32] = literal(value=444)
+
+  literal_0: bits[2] = literal(value=0)
+  literal_1: bits[2] = literal(value=1)
+  literal_2: bits[2] = literal(value=2)
+  literal_3: bits[2] = literal(value=3)
+  a_eq_0: bits[1] = eq(a, literal_0)
+  a_eq_1: bits[1] = eq(a, literal_1)
+  a_eq_2: bits[1] = eq(a, literal_2)
+  a_eq_3: bits[1] = eq(a, literal_3)
+  b_eq_0: bits[1] = eq(b, literal_0)
+  b_eq_1: bits[1] = eq(b, literal_1)
+  b_eq_2: bits[1] = eq(b, literal_2)
+  b_eq_3: bits[1] = eq(b, literal_3)
+
+  a_sel_3: bits[32] = sel(a_eq_3, cases=[_111, _444])
+  a_sel_2: bits[32] = sel(a_eq_2, cases=[a_sel_3, _333])
+  a_sel_1: bits[32] = sel(a_eq_1, cases=[a_sel_2, _222])
+  a_sel_0: bits[32] = sel(a_eq_0, cases=[a_sel_1, _111])
+  b_sel_3: bits[32] = sel(b_eq_3, cases=[_111, _444])
+  b_sel_2: bits[32] = sel(b_eq_2, cases=[b_sel_3, _333])
+  b_sel_1: bits[32] = sel(b_eq_1, cases=[b_sel_2, _222])
+  b_sel_0: bits[32] = sel(b_eq_0, cases=[b_sel_1, _111])
+  ret result: (bits[32], bits[32]) = tuple(a_sel_0, b_sel_0)
+})";
+
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, p.get()));
+  ASSERT_THAT(Run(f), IsOkAndHolds(true));
+  Value table = Value::UBitsArray({111, 222, 333, 444}, 32).value();
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::ArrayIndex(m::Literal(table), {m::Param("a")}),
+                       m::ArrayIndex(m::Literal(table), {m::Param("b")})));
+  EXPECT_EQ(f->return_value()->operand(0)->operand(0),
+            f->return_value()->operand(1)->operand(0));
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,7 +15,10 @@
 #ifndef XLS_PASSES_TERNARY_EVALUATOR_H_
 #define XLS_PASSES_TERNARY_EVALUATOR_H_
 
+#include <cstdint>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/bits.h"
@@ -51,6 +54,91 @@ class TernaryEvaluator
   }
 };
 
+// A bit-sliced ternary value holding 64 independent lanes. Bit i of `known`
+// indicates whether the value in lane i is known and, if so, bit i of `value`
+// holds the value. Bits of `value` are zero in lanes which are unknown.
+struct BitParallelTernaryValue {
+  static constexpr int64_t kLaneCount = 64;
+
+  uint64_t known = 0;
+  uint64_t value = 0;
+
+  TernaryValue lane(int64_t i) const {
+    if (((known >> i) & 1) == 0) {
+      return TernaryValue::kUnknown;
+    }
+    return ((value >> i) & 1) ? TernaryValue::kKnownOne
+                              : TernaryValue::kKnownZero;
+  }
+  void set_lane(int64_t i, TernaryValue v) {
+    uint64_t mask = uint64_t{1} << i;
+    known = v == TernaryValue::kUnknown ? known & ~mask : known | mask;
+    value = v == TernaryValue::kKnownOne ? value | mask : value & ~mask;
+  }
+
+  bool operator==(const BitParallelTernaryValue& other) const {
+    return known == other.known && value == other.value;
+  }
+  bool operator!=(const BitParallelTernaryValue& other) const {
+    return !(*this == other);
+  }
+};
+
+// A ternary evaluator which evaluates 64 sets of TernaryVectors at once. The
+// result in each lane is identical to the result of TernaryEvaluator.
+class BitParallelTernaryEvaluator
+    : public AbstractEvaluator<BitParallelTernaryValue,
+                               BitParallelTernaryEvaluator> {
+ public:
+  BitParallelTernaryValue One() const { return {~uint64_t{0}, ~uint64_t{0}}; }
+
+  BitParallelTernaryValue Zero() const { return {~uint64_t{0}, 0}; }
+
+  BitParallelTernaryValue Not(const BitParallelTernaryValue& input) const {
+    return {input.known, ~input.value & input.known};
+  }
+
+  // A lane of the result is known if both inputs are known or either input is
+  // a known zero.
+  BitParallelTernaryValue And(const BitParallelTernaryValue& a,
+                              const BitParallelTernaryValue& b) const {
+    uint64_t known_zero = (a.known & ~a.value) | (b.known & ~b.value);
+    return {(a.known & b.known) | known_zero, a.value & b.value};
+  }
+
+  // A lane of the result is known if both inputs are known or either input is
+  // a known one.
+  BitParallelTernaryValue Or(const BitParallelTernaryValue& a,
+                             const BitParallelTernaryValue& b) const {
+    return {(a.known & b.known) | a.value | b.value, a.value | b.value};
+  }
+
+  // Returns a vector with value `values[i]` in lane i. At most kLaneCount
+  // vectors of identical width may be given. Unused lanes are known zero.
+  Vector Pack(absl::Span<const TernaryVector> values) const {
+    XLS_CHECK(!values.empty());
+    XLS_CHECK_LE(values.size(), BitParallelTernaryValue::kLaneCount);
+    Vector result(values.front().size(), Zero());
+    for (int64_t lane = 0; lane < values.size(); ++lane) {
+      XLS_CHECK_EQ(values[lane].size(), result.size());
+      for (int64_t i = 0; i < result.size(); ++i) {
+        result[i].set_lane(lane, values[lane][i]);
+      }
+    }
+    return result;
+  }
+
+  // Returns the TernaryVector held in the given lane of `vector`.
+  TernaryVector Unpack(const Vector& vector, int64_t lane) const {
+    TernaryVector result;
+    result.reserve(vector.size());
+    for (const BitParallelTernaryValue& bit : vector) {
+      result.push_back(bit.lane(lane));
+    }
+    return result;
+  }
+};
+
 }  // namespace xls
 
 #endif  // XLS_PASSES_TERNARY_EVALUATOR_H_
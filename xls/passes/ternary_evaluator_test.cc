@@ -14,9 +14,13 @@
 
 #include "xls/passes/ternary_evaluator.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
@@ -626,6 +630,53 @@ TEST_F(TernaryLogicTest, OneHotMsbToLsb) {
   }
 }
 
+TEST_F(TernaryLogicTest, BitParallelMatchesScalar) {
+  // Evaluate every pair of width-3 ternary vectors 64 pairs at a time.
+  std::vector<TernaryVector> vectors = EnumerateTernaryVectors(/*width=*/3);
+  std::vector<TernaryVector> lhs;
+  std::vector<TernaryVector> rhs;
+  for (const TernaryVector& a : vectors) {
+    for (const TernaryVector& b : vectors) {
+      lhs.push_back(a);
+      rhs.push_back(b);
+    }
+  }
+  BitParallelTernaryEvaluator parallel;
+  const int64_t kLaneCount = BitParallelTernaryValue::kLaneCount;
+  for (int64_t start = 0; start < lhs.size(); start += kLaneCount) {
+    int64_t count = std::min<int64_t>(kLaneCount, lhs.size() - start);
+    absl::Span<const TernaryVector> a_values =
+        absl::MakeConstSpan(lhs).subspan(start, count);
+    absl::Span<const TernaryVector> b_values =
+        absl::MakeConstSpan(rhs).subspan(start, count);
+    BitParallelTernaryEvaluator::Vector a = parallel.Pack(a_values);
+    BitParallelTernaryEvaluator::Vector b = parallel.Pack(b_values);
+    BitParallelTernaryEvaluator::Vector sum = parallel.Add(a, b);
+    BitParallelTernaryEvaluator::Vector bitwise_and = parallel.BitwiseAnd(a, b);
+    BitParallelTernaryEvaluator::Vector bitwise_or = parallel.BitwiseOr(a, b);
+    BitParallelTernaryEvaluator::Vector bitwise_not = parallel.BitwiseNot(a);
+    BitParallelTernaryEvaluator::Vector less_than = {parallel.ULessThan(a, b)};
+    BitParallelTernaryEvaluator::Vector select =
+        parallel.Select(parallel.BitSlice(a, 0, 1), {a, b});
+    for (int64_t lane = 0; lane < count; ++lane) {
+      const TernaryVector& a_value = a_values[lane];
+      const TernaryVector& b_value = b_values[lane];
+      EXPECT_EQ(parallel.Unpack(sum, lane), evaluator_.Add(a_value, b_value));
+      EXPECT_EQ(parallel.Unpack(bitwise_and, lane),
+                evaluator_.BitwiseAnd(a_value, b_value));
+      EXPECT_EQ(parallel.Unpack(bitwise_or, lane),
+                evaluator_.BitwiseOr(a_value, b_value));
+      EXPECT_EQ(parallel.Unpack(bitwise_not, lane),
+                evaluator_.BitwiseNot(a_value));
+      EXPECT_EQ(parallel.Unpack(less_than, lane),
+                TernaryVector({evaluator_.ULessThan(a_value, b_value)}));
+      EXPECT_EQ(parallel.Unpack(select, lane),
+                evaluator_.Select(evaluator_.BitSlice(a_value, 0, 1),
+                                  {a_value, b_value}));
+    }
+  }
+}
+
 TEST_F(TernaryLogicTest, TestTheTestStuff) {
   EXPECT_THAT(EnumerateTernaryVectors(/*width=*/0),
               ElementsAre(FromString("0b")));
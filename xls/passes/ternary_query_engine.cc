@@ -15,8 +15,10 @@
 #include "xls/passes/ternary_query_engine.h"
 
 #include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
 
-#include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "xls/common/status/status_macros.h"
@@ -25,6 +27,8 @@
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/ternary.h"
 #include "xls/passes/ternary_evaluator.h"
 
 namespace xls {
@@ -42,65 +46,109 @@ static bool IsExpensiveToEvaluate(Node* node) {
          node->GetType()->GetFlatBitCount() > 256;
 }
 
-Bits TernaryVectorToKnownBits(const TernaryEvaluator::Vector& ternary_vector) {
-  // Use InlinedVector to avoid std::vector<bool> specialization madness.
-  absl::InlinedVector<bool, 1> bits(ternary_vector.size());
-  for (int64_t i = 0; i < bits.size(); ++i) {
-    bits[i] = (ternary_vector[i] == TernaryValue::kKnownOne ||
-               ternary_vector[i] == TernaryValue::kKnownZero);
+// Evaluates the bitwise and additive operations word-parallel on packed
+// ternary vectors. Returns std::nullopt for other operations.
+static std::optional<PackedTernaryVector> EvaluatePacked(
+    Node* node, absl::Span<const PackedTernaryVector> operands) {
+  using BinaryOp = PackedTernaryVector (*)(const PackedTernaryVector&,
+                                           const PackedTernaryVector&);
+  auto fold = [&](BinaryOp op) {
+    PackedTernaryVector result = operands.front();
+    for (const PackedTernaryVector& operand : operands.subspan(1)) {
+      result = op(result, operand);
+    }
+    return result;
+  };
+  switch (node->op()) {
+    case Op::kLiteral:
+      return PackedTernaryVector::FromBits(
+          node->As<Literal>()->value().bits());
+    case Op::kNot:
+      return ternary_ops::Not(operands[0]);
+    case Op::kAnd:
+      return fold(ternary_ops::And);
+    case Op::kNand:
+      return ternary_ops::Not(fold(ternary_ops::And));
+    case Op::kOr:
+      return fold(ternary_ops::Or);
+    case Op::kNor:
+      return ternary_ops::Not(fold(ternary_ops::Or));
+    case Op::kXor:
+      return fold(ternary_ops::Xor);
+    case Op::kAdd:
+      return ternary_ops::Add(operands[0], operands[1]);
+    case Op::kSub:
+      return ternary_ops::Sub(operands[0], operands[1]);
+    default:
+      return std::nullopt;
   }
-  return Bits(bits);
 }
 
-Bits TernaryVectorToValueBits(const TernaryEvaluator::Vector& ternary_vector) {
-  // Use InlinedVector to avoid std::vector<bool> specialization madness.
-  absl::InlinedVector<bool, 1> bits(ternary_vector.size());
-  for (int64_t i = 0; i < bits.size(); ++i) {
-    bits[i] = ternary_vector[i] == TernaryValue::kKnownOne;
+// Evaluates the bits-typed node `node` using ternary logic. `get_operand`
+// returns the ternary value of a (bits-typed) operand.
+template <typename GetOperandFn>
+static absl::StatusOr<PackedTernaryVector> EvaluateNode(
+    Node* node, TernaryEvaluator* evaluator, GetOperandFn get_operand) {
+  if (IsExpensiveToEvaluate(node) ||
+      std::any_of(node->operands().begin(), node->operands().end(),
+                  [](Node* o) { return !o->GetType()->IsBits(); })) {
+    return PackedTernaryVector(node->BitCountOrDie());
+  }
+
+  std::vector<PackedTernaryVector> operand_values;
+  operand_values.reserve(node->operand_count());
+  for (Node* operand : node->operands()) {
+    operand_values.push_back(get_operand(operand));
   }
-  return Bits(bits);
+  if (std::optional<PackedTernaryVector> result =
+          EvaluatePacked(node, operand_values)) {
+    return std::move(result).value();
+  }
+
+  // Everything else goes through the bit-by-bit abstract evaluator.
+  std::vector<TernaryEvaluator::Vector> unpacked_operands;
+  unpacked_operands.reserve(operand_values.size());
+  for (const PackedTernaryVector& operand : operand_values) {
+    unpacked_operands.push_back(operand.ToTernaryVector());
+  }
+  XLS_ASSIGN_OR_RETURN(
+      TernaryEvaluator::Vector result,
+      AbstractEvaluate(node, unpacked_operands, evaluator,
+                       /*default_handler=*/[](Node* n) {
+                         return TernaryEvaluator::Vector(
+                             n->BitCountOrDie(), TernaryValue::kUnknown);
+                       }));
+  return PackedTernaryVector(result);
 }
 
 absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   TernaryEvaluator evaluator;
-  absl::flat_hash_map<Node*, TernaryEvaluator::Vector> values;
+  absl::flat_hash_map<Node*, PackedTernaryVector> values;
   for (Node* node : TopoSort(f)) {
     if (!node->GetType()->IsBits()) {
       continue;
     }
-    auto create_unknown_vector = [](Node* n) {
-      return TernaryEvaluator::Vector(n->BitCountOrDie(),
-                                      TernaryValue::kUnknown);
-    };
-    if (IsExpensiveToEvaluate(node) ||
-        std::any_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return !o->GetType()->IsBits(); })) {
-      values[node] = create_unknown_vector(node);
-      continue;
-    }
-
-    std::vector<TernaryEvaluator::Vector> operand_values;
-    for (Node* operand : node->operands()) {
-      operand_values.push_back(values.at(operand));
-    }
     XLS_ASSIGN_OR_RETURN(
-        values[node],
-        AbstractEvaluate(node, operand_values, &evaluator,
-                         /*default_handler=*/create_unknown_vector));
+        PackedTernaryVector value,
+        EvaluateNode(node, &evaluator, [&](Node* operand) {
+          return values.at(operand);
+        }));
+    values.emplace(node, std::move(value));
   }
 
   ReachedFixpoint rf = ReachedFixpoint::Unchanged;
   for (Node* node : f->nodes()) {
     // TODO(meheff): Handle types other than bits.
     if (node->GetType()->IsBits()) {
+      const PackedTernaryVector& value = values.at(node);
       if (!known_bits_.contains(node)) {
-        known_bits_[node] = Bits(values.at(node).size());
-        bits_values_[node] = Bits(values.at(node).size());
+        known_bits_[node] = Bits(value.size());
+        bits_values_[node] = Bits(value.size());
       }
-      Bits combined_known_bits = bits_ops::Or(
-          known_bits_[node], TernaryVectorToKnownBits(values.at(node)));
-      Bits combined_bits_values = bits_ops::Or(
-          bits_values_[node], TernaryVectorToValueBits(values.at(node)));
+      Bits combined_known_bits =
+          bits_ops::Or(known_bits_[node], value.ToKnownBits());
+      Bits combined_bits_values =
+          bits_ops::Or(bits_values_[node], value.ToKnownBitsValues());
       if ((combined_known_bits != known_bits_[node]) ||
           (combined_bits_values != bits_values_[node])) {
         rf = ReachedFixpoint::Changed;
@@ -112,6 +160,24 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   return rf;
 }
 
+absl::Status TernaryQueryEngine::Update(absl::Span<Node* const> nodes) {
+  TernaryEvaluator evaluator;
+  for (Node* node : nodes) {
+    if (!node->GetType()->IsBits()) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        PackedTernaryVector value,
+        EvaluateNode(node, &evaluator, [&](Node* operand) {
+          return PackedTernaryVector::FromKnownBits(known_bits_.at(operand),
+                                                    bits_values_.at(operand));
+        }));
+    known_bits_[node] = value.ToKnownBits();
+    bits_values_[node] = value.ToKnownBitsValues();
+  }
+  return absl::OkStatus();
+}
+
 bool TernaryQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   int64_t maybe_one_count = 0;
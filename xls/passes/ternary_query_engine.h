@@ -17,6 +17,7 @@
 
 #include "absl/status/statusor.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
 #include "xls/ir/nodes.h"
@@ -35,6 +36,20 @@ class TernaryQueryEngine : public QueryEngine {
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  // Re-evaluates the given nodes from the current values of their operands,
+  // replacing any previously computed values. `nodes` must be in topological
+  // order and every operand of a node in `nodes` must either be tracked or
+  // appear earlier in `nodes`. Used to incrementally update the analysis after
+  // the function is modified.
+  absl::Status Update(absl::Span<Node* const> nodes);
+
+  // Discards the analysis of the given node, e.g. because it is about to be
+  // deleted.
+  void Forget(Node* node) {
+    known_bits_.erase(node);
+    bits_values_.erase(node);
+  }
+
   bool IsTracked(Node* node) const override {
     return known_bits_.contains(node);
   }
@@ -0,0 +1,127 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/ternary_query_engine_cache.h"
+
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/node_iterator.h"
+
+namespace xls {
+
+// The cached engine of a single function base along with the set of nodes
+// which have changed since the engine was last brought up to date.
+class TernaryQueryEngineCache::Entry : public ChangeListener {
+ public:
+  Entry(TernaryQueryEngineCache* cache, FunctionBase* f)
+      : cache_(cache), f_(f) {
+    f_->RegisterChangeListener(this);
+  }
+  ~Entry() override {
+    if (f_ != nullptr) {
+      f_->UnregisterChangeListener(this);
+    }
+  }
+
+  const TernaryQueryEngine* engine() const { return &engine_; }
+
+  // Brings the engine up to date with the function base. Returns the number
+  // of nodes which were evaluated.
+  absl::StatusOr<int64_t> Refresh() {
+    if (!populated_) {
+      XLS_RETURN_IF_ERROR(engine_.Populate(f_).status());
+      populated_ = true;
+      changed_.clear();
+      return f_->node_count();
+    }
+    if (changed_.empty()) {
+      return 0;
+    }
+    // A node must be re-evaluated if it changed or if any of its operands
+    // was re-evaluated. Nodes in `changed_` are only compared against and never
+    // dereferenced as a node which was constructed but never added to the
+    // function may have since been destroyed.
+    absl::flat_hash_set<Node*> stale;
+    std::vector<Node*> to_evaluate;
+    for (Node* node : TopoSort(f_)) {
+      if (changed_.contains(node) ||
+          absl::c_any_of(node->operands(),
+                         [&](Node* o) { return stale.contains(o); })) {
+        stale.insert(node);
+        to_evaluate.push_back(node);
+      }
+    }
+    changed_.clear();
+    XLS_RETURN_IF_ERROR(engine_.Update(to_evaluate));
+    return to_evaluate.size();
+  }
+
+  void NodeAdded(Node* node) override { changed_.insert(node); }
+  void NodeDeleted(Node* node) override {
+    changed_.erase(node);
+    engine_.Forget(node);
+  }
+  void OperandChanged(Node* node) override { changed_.insert(node); }
+  void FunctionBaseDeleted(FunctionBase* function_base) override {
+    f_ = nullptr;
+    // Destroys this entry.
+    cache_->RemoveEntry(function_base);
+  }
+
+ private:
+  TernaryQueryEngineCache* cache_;
+  FunctionBase* f_;
+  bool populated_ = false;
+  absl::flat_hash_set<Node*> changed_;
+  TernaryQueryEngine engine_;
+};
+
+TernaryQueryEngineCache::TernaryQueryEngineCache() = default;
+TernaryQueryEngineCache::~TernaryQueryEngineCache() = default;
+
+absl::StatusOr<const TernaryQueryEngine*>
+TernaryQueryEngineCache::GetQueryEngine(FunctionBase* f) {
+  absl::MutexLock lock(&mutex_);
+  std::unique_ptr<Entry>& entry = entries_[f];
+  if (entry == nullptr) {
+    entry = std::make_unique<Entry>(this, f);
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t evaluated, entry->Refresh());
+  evaluated_node_count_ += evaluated;
+  return entry->engine();
+}
+
+void TernaryQueryEngineCache::RemoveEntry(FunctionBase* f) {
+  absl::MutexLock lock(&mutex_);
+  entries_.erase(f);
+}
+
+absl::StatusOr<const QueryEngine*> GetSharedTernaryQueryEngine(
+    FunctionBase* f, PassResults* results, TernaryQueryEngine* local_engine) {
+  if (!results->change_tracking.enabled) {
+    XLS_RETURN_IF_ERROR(local_engine->Populate(f).status());
+    return local_engine;
+  }
+  if (results->ternary_query_engine_cache == nullptr) {
+    results->ternary_query_engine_cache =
+        std::make_shared<TernaryQueryEngineCache>();
+  }
+  return results->ternary_query_engine_cache->GetQueryEngine(f);
+}
+
+}  // namespace xls
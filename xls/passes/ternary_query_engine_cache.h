@@ -0,0 +1,83 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_TERNARY_QUERY_ENGINE_CACHE_H_
+#define XLS_PASSES_TERNARY_QUERY_ENGINE_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+
+// Holds a TernaryQueryEngine for each function base it is asked about and
+// keeps the engines up to date as the IR changes. An engine is populated in
+// full on the first request for a function base. Afterwards the cache
+// observes the function base through a ChangeListener, and the next request
+// re-evaluates only the nodes which were added or had operands replaced, along
+// with their transitive users.
+//
+// Between requests an engine is a snapshot of the function base at the time
+// of the last request, exactly like a TernaryQueryEngine populated at that
+// time: nodes added since then are not tracked.
+class TernaryQueryEngineCache {
+ public:
+  TernaryQueryEngineCache();
+  ~TernaryQueryEngineCache();
+
+  TernaryQueryEngineCache(const TernaryQueryEngineCache&) = delete;
+  TernaryQueryEngineCache& operator=(const TernaryQueryEngineCache&) = delete;
+
+  // Returns a query engine which reflects the current state of `f`. The
+  // engine is owned by the cache and remains valid until `f` or the cache is
+  // destroyed.
+  absl::StatusOr<const TernaryQueryEngine*> GetQueryEngine(FunctionBase* f);
+
+  // Returns the total number of nodes evaluated by GetQueryEngine over the
+  // lifetime of the cache.
+  int64_t evaluated_node_count() const {
+    absl::MutexLock lock(&mutex_);
+    return evaluated_node_count_;
+  }
+
+ private:
+  class Entry;
+
+  // Removes the entry of a function base which is being destroyed.
+  void RemoveEntry(FunctionBase* f);
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t evaluated_node_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Returns a ternary query engine for `f`. When called from within a pass
+// pipeline the engine comes from a cache held in `results` which is shared by
+// all passes of the pipeline. Otherwise `local_engine` is populated and
+// returned.
+absl::StatusOr<const QueryEngine*> GetSharedTernaryQueryEngine(
+    FunctionBase* f, PassResults* results, TernaryQueryEngine* local_engine);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_TERNARY_QUERY_ENGINE_CACHE_H_
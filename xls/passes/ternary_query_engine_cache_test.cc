@@ -0,0 +1,115 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/ternary_query_engine_cache.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+class TernaryQueryEngineCacheTest : public IrTestBase {};
+
+TEST_F(TernaryQueryEngineCacheTest, UpdatesOnlyChangedNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(4));
+  BValue unrelated = fb.Not(fb.Param("y", p->GetBitsType(4)));
+  BValue masked = fb.And(x, fb.Literal(UBits(0b0011, 4)));
+  BValue result = fb.Or(masked, fb.Literal(UBits(0b1000, 4)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, fb.BuildWithReturnValue(fb.Tuple({result, unrelated})));
+
+  TernaryQueryEngineCache cache;
+  XLS_ASSERT_OK_AND_ASSIGN(const TernaryQueryEngine* engine,
+                           cache.GetQueryEngine(f));
+  EXPECT_EQ(engine->ToString(result.node()), "0b10XX");
+  EXPECT_EQ(cache.evaluated_node_count(), f->node_count());
+
+  // Requesting the engine again without changes evaluates nothing.
+  XLS_ASSERT_OK(cache.GetQueryEngine(f).status());
+  EXPECT_EQ(cache.evaluated_node_count(), f->node_count());
+
+  // Replace the mask. Only the new literal and its transitive users (the and,
+  // the or, and the tuple) should be re-evaluated.
+  XLS_ASSERT_OK_AND_ASSIGN(Literal * new_mask,
+                           f->MakeNode<Literal>(SourceInfo(),
+                                                Value(UBits(0b0001, 4))));
+  Node* old_mask = masked.node()->operand(1);
+  XLS_ASSERT_OK(masked.node()->ReplaceOperandNumber(1, new_mask));
+  XLS_ASSERT_OK(f->RemoveNode(old_mask));
+  int64_t count_before = cache.evaluated_node_count();
+  XLS_ASSERT_OK_AND_ASSIGN(engine, cache.GetQueryEngine(f));
+  EXPECT_EQ(cache.evaluated_node_count() - count_before, 4);
+  EXPECT_EQ(engine->ToString(result.node()), "0b100X");
+
+  // The incrementally updated engine agrees with a freshly populated one.
+  TernaryQueryEngine fresh;
+  XLS_ASSERT_OK(fresh.Populate(f).status());
+  for (Node* node : f->nodes()) {
+    if (node->GetType()->IsBits()) {
+      EXPECT_EQ(engine->ToString(node), fresh.ToString(node))
+          << node->GetName();
+    }
+  }
+}
+
+TEST_F(TernaryQueryEngineCacheTest, FunctionRemovedBeforeCache) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(4)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  TernaryQueryEngineCache cache;
+  XLS_ASSERT_OK(cache.GetQueryEngine(f).status());
+  // Destroying the function must drop its entry from the cache.
+  XLS_ASSERT_OK(p->RemoveFunction(f));
+}
+
+TEST_F(TernaryQueryEngineCacheTest, LocalEngineOutsidePipeline) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(4)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  PassResults results;
+  TernaryQueryEngine local_engine;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      const QueryEngine* engine,
+      GetSharedTernaryQueryEngine(f, &results, &local_engine));
+  EXPECT_EQ(engine, &local_engine);
+  EXPECT_EQ(results.ternary_query_engine_cache, nullptr);
+
+  results.change_tracking.enabled = true;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      engine, GetSharedTernaryQueryEngine(f, &results, &local_engine));
+  EXPECT_NE(engine, &local_engine);
+  ASSERT_NE(results.ternary_query_engine_cache, nullptr);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      const TernaryQueryEngine* cached,
+      results.ternary_query_engine_cache->GetQueryEngine(f));
+  EXPECT_EQ(engine, cached);
+}
+
+}  // namespace
+}  // namespace xls
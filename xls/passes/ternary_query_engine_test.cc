@@ -77,6 +77,32 @@ class TernaryQueryEngineTest : public IrTestBase {
   }
 };
 
+TEST_F(TernaryQueryEngineTest, Add) {
+  auto make_add = [](BValue lhs, BValue rhs, FunctionBuilder* fb) {
+    fb->Add(lhs, rhs);
+  };
+  EXPECT_THAT(RunOnBinaryOp("0bXX1", "0bXX1", make_add),
+              IsOkAndHolds("0bXX0"));
+  // 3 + 1 and 3 + 3 differ only in bit 1, even though the carry into bit 2 is
+  // unknown to a ripple of ternary full adders.
+  EXPECT_THAT(RunOnBinaryOp("0b011", "0b0X1", make_add),
+              IsOkAndHolds("0b1X0"));
+  EXPECT_THAT(RunOnBinaryOp("0b111", "0b001", make_add),
+              IsOkAndHolds("0b000"));
+}
+
+TEST_F(TernaryQueryEngineTest, Sub) {
+  auto make_sub = [](BValue lhs, BValue rhs, FunctionBuilder* fb) {
+    fb->Subtract(lhs, rhs);
+  };
+  EXPECT_THAT(RunOnBinaryOp("0bXX0", "0bXX0", make_sub),
+              IsOkAndHolds("0bXX0"));
+  EXPECT_THAT(RunOnBinaryOp("0b1X0", "0b0X0", make_sub),
+              IsOkAndHolds("0bXX0"));
+  EXPECT_THAT(RunOnBinaryOp("0b000", "0b001", make_sub),
+              IsOkAndHolds("0b111"));
+}
+
 TEST_F(TernaryQueryEngineTest, Uge) {
   auto make_uge = [](BValue lhs, BValue rhs, FunctionBuilder* fb) {
     fb->UGe(lhs, rhs);
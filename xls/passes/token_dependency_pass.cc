@@ -14,6 +14,8 @@
 
 #include "xls/passes/token_dependency_pass.h"
 
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
@@ -22,6 +24,7 @@
 #include "xls/data_structures/transitive_closure.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/op.h"
+#include "xls/ir/reachability_index.h"
 #include "xls/passes/token_provenance_analysis.h"
 
 namespace xls {
@@ -52,40 +55,17 @@ absl::StatusOr<bool> TokenDependencyPass::RunOnFunctionBaseInternal(
     }
   }
 
-  // This is a relation over the set of nodes in the program. If a value was
-  // consumed by node A was produced by node B, then there will be an edge from
-  // B to A in this relation.
-  NodeRelation data_deps;
-  {
-    for (Node* node : f->nodes()) {
-      for (Node* child : node->operands()) {
-        data_deps[child].insert(node);
-      }
-    }
-  }
-
   // The transitive closure of the token dependency relation.
   NodeRelation token_deps_closure = TransitiveClosure<Node*>(token_deps);
 
-  auto dfs = [&](Node* root,
-                 const NodeRelation& dag) -> absl::flat_hash_set<Node*> {
-    std::vector<Node*> stack;
-    stack.push_back(root);
-    absl::flat_hash_set<Node*> discovered;
-    while (!stack.empty()) {
-      Node* popped = stack.back();
-      stack.pop_back();
-      if (!discovered.contains(popped)) {
-        discovered.insert(popped);
-        if (dag.contains(popped)) {
-          for (Node* child : dag.at(popped)) {
-            stack.push_back(child);
-          }
-        }
-      }
+  // Answers whether one node is data-dependent on another.
+  ReachabilityIndex* reachability = f->GetReachabilityIndex();
+  std::vector<Node*> effectful_nodes;
+  for (Node* node : f->nodes()) {
+    if (OpIsSideEffecting(node->op())) {
+      effectful_nodes.push_back(node);
     }
-    return discovered;
-  };
+  }
 
   // A relation mapping each effectful node to the set of receives that it is
   // data-dependent on, but not token-dependent on.
@@ -102,12 +82,8 @@ absl::StatusOr<bool> TokenDependencyPass::RunOnFunctionBaseInternal(
       return absl::InternalError(
           "Can't handle token-and-data producing ops other than receive yet");
     }
-    for (Node* b : dfs(a, data_deps)) {
-      if (a == b) {
-        continue;
-      }
-
-      if (!OpIsSideEffecting(b->op())) {
+    for (Node* b : effectful_nodes) {
+      if (!reachability->DependsOn(b, a)) {
         continue;
       }
 
@@ -14,37 +14,45 @@
 
 #include "xls/passes/unroll_pass.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node_iterator.h"
 
 namespace xls {
 namespace {
 
-// Finds an "effectively used" (has users or is return value) counted for in the
-// function f, or returns nullptr if none is found.
-CountedFor* FindCountedFor(FunctionBase* f) {
+// Returns the "effectively used" (has users or is return value) counted fors
+// in the function f in topological order.
+std::vector<CountedFor*> FindCountedFors(FunctionBase* f) {
+  std::vector<CountedFor*> loops;
   for (Node* node : TopoSort(f)) {
     if (node->Is<CountedFor>() &&
         (f->HasImplicitUse(node) || !node->users().empty())) {
-      return node->As<CountedFor>();
+      loops.push_back(node->As<CountedFor>());
     }
   }
-  return nullptr;
+  return loops;
 }
 
-// Unrolls the node "loop" by replacing it with a sequence of dependent
-// invocations.
-absl::Status UnrollCountedFor(CountedFor* loop) {
+// Appends invocations of the body of "loop" for the trips in the range
+// [first_trip, last_trip) to the function containing the loop. Each invocation
+// takes the loop carry produced by the previous one, starting with
+// "loop_carry". Returns the loop carry produced by the last invocation.
+absl::StatusOr<Node*> UnrollTrips(CountedFor* loop, int64_t first_trip,
+                                  int64_t last_trip, Node* loop_carry) {
   FunctionBase* f = loop->function_base();
-  Node* loop_carry = loop->initial_value();
   int64_t ivar_bit_count = loop->body()->params()[0]->BitCountOrDie();
-  for (int64_t trip = 0, iv = 0; trip < loop->trip_count();
-       ++trip, iv += loop->stride()) {
+  for (int64_t trip = first_trip; trip < last_trip; ++trip) {
     XLS_ASSIGN_OR_RETURN(
         Literal * iv_node,
-        f->MakeNode<Literal>(loop->loc(), Value(UBits(iv, ivar_bit_count))));
+        f->MakeNode<Literal>(
+            loop->loc(), Value(UBits(trip * loop->stride(), ivar_bit_count))));
 
     // Construct the args for invocation.
     std::vector<Node*> invoke_args = {iv_node, loop_carry};
@@ -57,6 +65,87 @@ absl::Status UnrollCountedFor(CountedFor* loop) {
         f->MakeNode<Invoke>(loop->loc(), absl::MakeSpan(invoke_args),
                             loop->body()));
   }
+  return loop_carry;
+}
+
+// Unrolls the node "loop" by replacing it with a sequence of dependent
+// invocations.
+absl::Status UnrollCountedFor(CountedFor* loop) {
+  XLS_ASSIGN_OR_RETURN(Node * loop_carry,
+                       UnrollTrips(loop, /*first_trip=*/0,
+                                   /*last_trip=*/loop->trip_count(),
+                                   loop->initial_value()));
+  XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
+  return loop->function_base()->RemoveNode(loop);
+}
+
+// Returns a function which performs "factor" consecutive trips of "loop" by
+// invoking its body "factor" times. The function has the same signature as
+// the body and is shared by all loops with the same body, stride and factor.
+absl::StatusOr<Function*> GetUnrolledBody(CountedFor* loop, int64_t factor) {
+  Function* body = loop->body();
+  Package* package = body->package();
+  std::string name = absl::StrFormat("%s__unrolled_x%d_stride_%d",
+                                     body->name(), factor, loop->stride());
+  absl::StatusOr<Function*> existing = package->GetFunction(name);
+  if (existing.ok()) {
+    return existing.value();
+  }
+
+  Function* unrolled =
+      package->AddFunction(std::make_unique<Function>(name, package));
+  std::vector<Node*> params;
+  for (Param* param : body->params()) {
+    XLS_ASSIGN_OR_RETURN(
+        Param * unrolled_param,
+        unrolled->MakeNodeWithName<Param>(loop->loc(), param->name(),
+                                          param->GetType()));
+    params.push_back(unrolled_param);
+  }
+  int64_t ivar_bit_count = params[0]->BitCountOrDie();
+  Node* loop_carry = params[1];
+  for (int64_t i = 0; i < factor; ++i) {
+    Node* iv_node = params[0];
+    if (i > 0) {
+      XLS_ASSIGN_OR_RETURN(
+          Literal * offset,
+          unrolled->MakeNode<Literal>(
+              loop->loc(), Value(UBits(i * loop->stride(), ivar_bit_count))));
+      XLS_ASSIGN_OR_RETURN(iv_node,
+                           unrolled->MakeNode<BinOp>(loop->loc(), params[0],
+                                                     offset, Op::kAdd));
+    }
+    std::vector<Node*> invoke_args = params;
+    invoke_args[0] = iv_node;
+    invoke_args[1] = loop_carry;
+    XLS_ASSIGN_OR_RETURN(
+        loop_carry, unrolled->MakeNode<Invoke>(
+                        loop->loc(), absl::MakeSpan(invoke_args), body));
+  }
+  XLS_RETURN_IF_ERROR(unrolled->set_return_value(loop_carry));
+  return unrolled;
+}
+
+// Partially unrolls the node "loop" by "factor". The loop is replaced by a
+// loop with trip count trip_count / factor whose body performs "factor" trips
+// of the original loop, followed by invocations performing the remaining
+// trip_count % factor trips.
+absl::Status PartiallyUnrollCountedFor(CountedFor* loop, int64_t factor) {
+  FunctionBase* f = loop->function_base();
+  XLS_ASSIGN_OR_RETURN(Function * unrolled_body, GetUnrolledBody(loop, factor));
+  int64_t unrolled_trip_count = loop->trip_count() / factor;
+  std::vector<Node*> invariant_args(loop->invariant_args().begin(),
+                                    loop->invariant_args().end());
+  XLS_ASSIGN_OR_RETURN(
+      CountedFor * unrolled_loop,
+      f->MakeNode<CountedFor>(loop->loc(), loop->initial_value(),
+                              absl::MakeSpan(invariant_args),
+                              unrolled_trip_count, loop->stride() * factor,
+                              unrolled_body));
+  XLS_ASSIGN_OR_RETURN(
+      Node * loop_carry,
+      UnrollTrips(loop, /*first_trip=*/unrolled_trip_count * factor,
+                  /*last_trip=*/loop->trip_count(), unrolled_loop));
   XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
   return f->RemoveNode(loop);
 }
@@ -66,12 +155,17 @@ absl::Status UnrollCountedFor(CountedFor* loop) {
 absl::StatusOr<bool> UnrollPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const PassOptions& options, PassResults* results) const {
   bool changed = false;
-  while (true) {
-    CountedFor* loop = FindCountedFor(f);
-    if (loop == nullptr) {
-      break;
+  for (CountedFor* loop : FindCountedFors(f)) {
+    if (options.loop_unroll_factor.has_value() &&
+        loop->trip_count() > *options.loop_unroll_factor) {
+      if (*options.loop_unroll_factor <= 1) {
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(
+          PartiallyUnrollCountedFor(loop, *options.loop_unroll_factor));
+    } else {
+      XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
     }
-    XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
     changed = true;
   }
   return changed;
@@ -21,6 +21,15 @@
 
 namespace xls {
 
+// Pass which unrolls counted_for loops. By default loops are fully unrolled
+// into a chain of invokes of the loop body.
+//
+// If PassOptions::loop_unroll_factor is set to N, loops with a trip count of
+// at most N are still fully unrolled but longer loops are partially unrolled:
+// such a loop becomes a counted_for with a trip count of trip_count / N whose
+// body invokes the original body N times, followed by invokes for the
+// trip_count % N remaining trips. Running the pass again unrolls the new loop
+// further.
 class UnrollPass : public FunctionBasePass {
  public:
   UnrollPass() : FunctionBasePass("loop_unroll", "Unroll counted loops") {}
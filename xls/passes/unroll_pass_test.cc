@@ -57,5 +57,76 @@ fn unrollable() -> bits[32] {
                         m::Literal(0)));
 }
 
+TEST(UnrollPassTest, PartiallyUnrollsCountedFor) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32], zero: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  add.4: bits[32] = add(zero_ext.3, accum)
+  ret add.5: bits[32] = add(add.4, zero)
+}
+
+fn unrollable() -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=5, stride=2, body=body, invariant_args=[literal.1])
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  PassOptions options;
+  options.loop_unroll_factor = 2;
+  UnrollPass pass;
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+
+  // Two iterations of a loop performing two trips each, then the fifth trip.
+  EXPECT_THAT(f->return_value(),
+              m::Invoke(m::Literal(8),
+                        m::CountedFor(m::Literal(0), m::Literal(0)),
+                        m::Literal(0)));
+  CountedFor* loop = f->return_value()->operand(1)->As<CountedFor>();
+  EXPECT_EQ(loop->trip_count(), 2);
+  EXPECT_EQ(loop->stride(), 4);
+  Function* unrolled_body = loop->body();
+  EXPECT_THAT(unrolled_body->return_value(),
+              m::Invoke(m::Add(m::Param("i"), m::Literal(2)),
+                        m::Invoke(m::Param("i"), m::Param("accum"),
+                                  m::Param("zero")),
+                        m::Param("zero")));
+}
+
+TEST(UnrollPassTest, FullyUnrollsShortLoopsWithUnrollFactor) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  ret add.4: bits[32] = add(zero_ext.3, accum)
+}
+
+fn unrollable() -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=2, stride=1, body=body)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  PassOptions options;
+  options.loop_unroll_factor = 4;
+  UnrollPass pass;
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Invoke(m::Literal(1),
+                        m::Invoke(m::Literal(0), m::Literal(0))));
+}
+
 }  // namespace
 }  // namespace xls
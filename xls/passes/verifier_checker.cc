@@ -14,13 +14,41 @@
 
 #include "xls/passes/verifier_checker.h"
 
+#include <cstdint>
+
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/verifier.h"
 
 namespace xls {
 
 absl::Status VerifierChecker::Run(Package* p, const PassOptions& options,
                                   PassResults* results) const {
-  return VerifyPackage(p);
+  VerifierOptions verifier_options;
+  verifier_options.thread_count = options.function_pass_threads;
+  if (results == nullptr || !results->change_tracking.enabled) {
+    return VerifyPackage(p, verifier_options);
+  }
+
+  PassResults::ChangeTracking& tracking = results->change_tracking;
+  verifier_options.should_verify = [&](FunctionBase* f) {
+    auto verified_it = tracking.verification_times.find(f);
+    if (verified_it == tracking.verification_times.end() ||
+        tracking.global_change >= verified_it->second) {
+      return true;
+    }
+    auto change_it = tracking.function_changes.find(f);
+    return change_it != tracking.function_changes.end() &&
+           change_it->second >= verified_it->second;
+  };
+  XLS_RETURN_IF_ERROR(VerifyPackage(p, verifier_options));
+
+  // All changes made before the next pass invocation have been verified.
+  int64_t now = results->invocations.size();
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    tracking.verification_times[f] = now;
+  }
+  return absl::OkStatus();
 }
 
 }  // namespace xls
@@ -21,6 +21,10 @@
 namespace xls {
 
 // Invariant checker which just runs xls::Verifier.
+// Invariant checker which runs the IR verifier. The function bases of the
+// package are verified on PassOptions::function_pass_threads threads. While
+// change tracking is enabled (see PassResults::ChangeTracking), function bases
+// which have not changed since they were last verified are skipped.
 class VerifierChecker : public InvariantChecker {
  public:
   absl::Status Run(Package* p, const PassOptions& options,
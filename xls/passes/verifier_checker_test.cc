@@ -0,0 +1,113 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/verifier_checker.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/passes.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class VerifierCheckerTest : public IrTestBase {
+ protected:
+  absl::StatusOr<std::unique_ptr<Package>> ParseTwoFunctions() {
+    return ParsePackageNoVerify(R"(
+package p
+
+fn f(p: bits[2], q: bits[42], r: bits[42]) -> bits[42] {
+  ret and.1: bits[42] = and(q, r)
+}
+
+fn g(a: bits[16]) -> bits[16] {
+  ret neg.2: bits[16] = neg(a)
+}
+)");
+  }
+
+  // Replaces the lhs of the 'and' in `f` with a value of a different width.
+  // The change is not recorded in any change tracking.
+  void BreakFunction(Function* f) {
+    FindNode("and.1", f)->ReplaceOperand(FindNode("q", f), FindNode("p", f));
+  }
+
+  // Records a non-trivial pass invocation.
+  void RecordInvocation(PassResults* results) {
+    results->invocations.push_back({"pass", /*changed=*/true});
+  }
+};
+
+TEST_F(VerifierCheckerTest, VerifiesAllFunctionsWithoutChangeTracking) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParseTwoFunctions());
+  VerifierChecker checker;
+  PassResults results;
+  XLS_ASSERT_OK(checker.Run(p.get(), PassOptions(), &results));
+  BreakFunction(FindFunction("f", p.get()));
+  EXPECT_THAT(checker.Run(p.get(), PassOptions(), &results),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and.1")));
+}
+
+TEST_F(VerifierCheckerTest, SkipsFunctionsUnchangedSinceVerified) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParseTwoFunctions());
+  Function* f = FindFunction("f", p.get());
+  Function* g = FindFunction("g", p.get());
+  VerifierChecker checker;
+  PassResults results;
+  results.change_tracking.enabled = true;
+  XLS_ASSERT_OK(checker.Run(p.get(), PassOptions(), &results));
+
+  // Only `g` is known to have changed, so the breakage of `f` goes unnoticed.
+  BreakFunction(f);
+  results.change_tracking.function_changes[g] = results.invocations.size();
+  RecordInvocation(&results);
+  XLS_EXPECT_OK(checker.Run(p.get(), PassOptions(), &results));
+
+  results.change_tracking.function_changes[f] = results.invocations.size();
+  RecordInvocation(&results);
+  EXPECT_THAT(checker.Run(p.get(), PassOptions(), &results),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and.1")));
+}
+
+TEST_F(VerifierCheckerTest, GlobalChangeVerifiesAllFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParseTwoFunctions());
+  VerifierChecker checker;
+  PassResults results;
+  results.change_tracking.enabled = true;
+  XLS_ASSERT_OK(checker.Run(p.get(), PassOptions(), &results));
+
+  BreakFunction(FindFunction("f", p.get()));
+  results.change_tracking.global_change = results.invocations.size();
+  RecordInvocation(&results);
+  PassOptions options;
+  options.function_pass_threads = 4;
+  EXPECT_THAT(checker.Run(p.get(), options, &results),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and.1")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
@@ -31,67 +32,120 @@
 
 namespace xls {
 
+namespace {
+
+// Accumulates the nodes of a single pipeline stage into a new function. Nodes
+// must be added in topological order.
+class StageExtractor {
+ public:
+  StageExtractor(FunctionBase* src, const PipelineSchedule& schedule,
+                 int stage)
+      : src_(src),
+        schedule_(schedule),
+        stage_(stage),
+        new_f_(std::make_unique<Function>(
+            absl::StrFormat("%s_stage_%d", src->name(), stage),
+            src->package())) {}
+
+  absl::Status AddNode(Node* node) {
+    std::vector<Node*> new_operands;
+    for (Node* operand : node->operands()) {
+      if (node_map_.contains(operand)) {
+        new_operands.push_back(node_map_.at(operand));
+      } else {
+        Node* new_param = new_f_->AddNode(
+            std::make_unique<Param>(operand->loc(), operand->GetName(),
+                                    operand->GetType(), new_f_.get()));
+        node_map_[operand] = new_param;
+        new_operands.push_back(new_param);
+      }
+    }
+    // hack to support viewing procs as functions
+    Node* new_node;
+    if (node->Is<Send>() || node->Is<Receive>()) {
+      new_node = new_f_->AddNode(std::make_unique<xls::Param>(
+          node->loc(), node->GetName(), node->GetType(), new_f_.get()));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          new_node, node->CloneInNewFunction(new_operands, new_f_.get()));
+    }
+    node_map_[node] = new_node;
+    if (std::any_of(node->users().begin(), node->users().end(), [&](Node* u) {
+          return schedule_.cycle(u) > stage_ || u->Is<Send>() ||
+                 new_f_->HasImplicitUse(node);
+        })) {
+      live_out_.push_back(new_node);
+    }
+    return absl::OkStatus();
+  }
+
+  // Sets the return value and adds the function to the package.
+  absl::StatusOr<Function*> Finish() {
+    // If this stage doesn't include the function output, create a final tuple
+    // which gathers all nodes scheduled in the stage that are live out.
+    // The tuple will be the return value of the new function.
+    // Otherwise, just use the mapped function output.
+    auto src_function = static_cast<Function*>(src_);
+    if (node_map_.contains(src_function->return_value())) {
+      XLS_RETURN_IF_ERROR(
+          new_f_->set_return_value(node_map_[src_function->return_value()]));
+    } else {
+      if (live_out_.size() == 1) {
+        XLS_RETURN_IF_ERROR(new_f_->set_return_value(live_out_.front()));
+      } else {
+        XLS_ASSIGN_OR_RETURN(Node * return_tuple,
+                             new_f_->MakeNode<Tuple>(SourceInfo(), live_out_));
+        XLS_RETURN_IF_ERROR(new_f_->set_return_value(return_tuple));
+      }
+    }
+    return src_->package()->AddFunction(std::move(new_f_));
+  }
+
+ private:
+  FunctionBase* src_;
+  const PipelineSchedule& schedule_;
+  int stage_;
+  std::unique_ptr<Function> new_f_;
+  absl::flat_hash_map<Node*, Node*> node_map_;
+  std::vector<Node*> live_out_;
+};
+
+}  // namespace
+
 absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
                                        const PipelineSchedule& schedule,
                                        int stage) {
   // Create a new function in the package which only contains the nodes at the
   // given stage (cycle).
-  Package* package = src->package();
-  auto new_f = std::make_unique<Function>(
-      absl::StrFormat("%s_stage_%d", src->name(), stage), package);
-  absl::flat_hash_map<Node*, Node*> node_map;
-  std::vector<Node*> live_out;
+  StageExtractor extractor(src, schedule, stage);
   for (Node* node : TopoSort(src)) {
     if (schedule.cycle(node) == stage) {
-      std::vector<Node*> new_operands;
-      for (Node* operand : node->operands()) {
-        if (node_map.contains(operand)) {
-          new_operands.push_back(node_map.at(operand));
-        } else {
-          Node* new_param = new_f->AddNode(
-              std::make_unique<Param>(operand->loc(), operand->GetName(),
-                                      operand->GetType(), new_f.get()));
-          node_map[operand] = new_param;
-          new_operands.push_back(new_param);
-        }
-      }
-      // hack to support viewing procs as functions
-      Node* new_node;
-      if (node->Is<Send>() || node->Is<Receive>()) {
-        new_node = new_f->AddNode(std::make_unique<xls::Param>(
-            node->loc(), node->GetName(), node->GetType(), new_f.get()));
-      } else {
-        XLS_ASSIGN_OR_RETURN(
-            new_node, node->CloneInNewFunction(new_operands, new_f.get()));
-      }
-      node_map[node] = new_node;
-      if (std::any_of(node->users().begin(), node->users().end(), [&](Node* u) {
-            return schedule.cycle(u) > stage || u->Is<Send>() ||
-                   new_f->HasImplicitUse(node);
-          })) {
-        live_out.push_back(new_node);
-      }
+      XLS_RETURN_IF_ERROR(extractor.AddNode(node));
     }
   }
+  return extractor.Finish();
+}
 
-  // If this stage doesn't include the function output, create a final tuple
-  // which gathers all nodes scheduled in the stage that are live out.
-  // The tuple will be the return value of the new function.
-  // Otherwise, just use the mapped function output.
-
-  auto src_function = static_cast<Function*>(src);
-  if (node_map.contains(src_function->return_value())) {
-    XLS_RETURN_IF_ERROR(
-        new_f->set_return_value(node_map[src_function->return_value()]));
-  } else {
-    if (live_out.size() == 1) {
-      XLS_RETURN_IF_ERROR(new_f->set_return_value(live_out.front()));
-    } else {
-      XLS_ASSIGN_OR_RETURN(Node * return_tuple,
-                           new_f->MakeNode<Tuple>(SourceInfo(), live_out));
-      XLS_RETURN_IF_ERROR(new_f->set_return_value(return_tuple));
-    }
+absl::StatusOr<std::vector<Function*>> ExtractAllStages(
+    FunctionBase* src, const PipelineSchedule& schedule) {
+  // Distribute the nodes among the stages in one pass rather than walking the
+  // whole function once per stage.
+  std::vector<std::unique_ptr<StageExtractor>> extractors;
+  extractors.reserve(schedule.length());
+  for (int stage = 0; stage < schedule.length(); ++stage) {
+    extractors.push_back(
+        std::make_unique<StageExtractor>(src, schedule, stage));
   }
-  return package->AddFunction(std::move(new_f));
+  for (Node* node : TopoSort(src)) {
+    XLS_RETURN_IF_ERROR(extractors.at(schedule.cycle(node))->AddNode(node));
+  }
+  std::vector<Function*> stages;
+  stages.reserve(extractors.size());
+  for (std::unique_ptr<StageExtractor>& extractor : extractors) {
+    XLS_ASSIGN_OR_RETURN(Function * stage, extractor->Finish());
+    stages.push_back(stage);
+  }
+  return stages;
 }
+
 }  // namespace xls
@@ -15,6 +15,8 @@
 #ifndef XLS_SCHEDULING_EXTRACT_STAGE_H_
 #define XLS_SCHEDULING_EXTRACT_STAGE_H_
 
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "xls/ir/function.h"
 #include "xls/scheduling/pipeline_schedule.h"
@@ -27,6 +29,11 @@ absl::StatusOr<Function*> ExtractStage(FunctionBase* src,
                                        const PipelineSchedule& schedule,
                                        int stage);
 
+// Extracts every pipeline stage of 'src' as by ExtractStage, visiting each
+// node once. Element i of the result is the function for stage i.
+absl::StatusOr<std::vector<Function*>> ExtractAllStages(
+    FunctionBase* src, const PipelineSchedule& schedule);
+
 }  // namespace xls
 
 #endif  // XLS_SCHEDULING_EXTRACT_STAGE_H_
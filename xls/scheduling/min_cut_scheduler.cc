@@ -17,16 +17,22 @@
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <memory>
+#include <numeric>
 #include <random>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/scheduling/function_partition.h"
@@ -69,6 +75,64 @@ absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
   return absl::OkStatus();
 }
 
+// Performs the min-cuts at the given cycle boundaries in order, propagating
+// the bounds after each cut. Upon return no node in the function will have a
+// range which spans any of the boundaries.
+//
+// After the cut at the first boundary, every node is restricted to cycles
+// either at or before the boundary or after it, and the cuts (and bound
+// propagation) on each side involve only the nodes on that side. The cuts
+// before and after the first boundary are therefore independent and are
+// performed concurrently (on a copy of the bounds) when `thread_count` allows.
+// The result is the same as performing the cuts sequentially.
+absl::Status SplitAtBoundaries(FunctionBase* f,
+                               absl::Span<const int64_t> boundaries,
+                               const DelayEstimator& delay_estimator,
+                               int64_t thread_count,
+                               sched::ScheduleBounds* bounds) {
+  if (boundaries.empty()) {
+    return absl::OkStatus();
+  }
+  int64_t cycle = boundaries.front();
+  XLS_RETURN_IF_ERROR(SplitAfterCycle(f, cycle, delay_estimator, bounds));
+  XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+  XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+
+  std::vector<int64_t> before;
+  std::vector<int64_t> after;
+  for (int64_t boundary : boundaries.subspan(1)) {
+    (boundary < cycle ? before : after).push_back(boundary);
+  }
+  if (thread_count <= 1 || before.empty() || after.empty()) {
+    XLS_RETURN_IF_ERROR(SplitAtBoundaries(f, before, delay_estimator,
+                                          thread_count, bounds));
+    return SplitAtBoundaries(f, after, delay_estimator, thread_count, bounds);
+  }
+
+  int64_t after_thread_count = thread_count / 2;
+  sched::ScheduleBounds after_bounds = *bounds;
+  absl::Status after_status;
+  Thread thread([&]() {
+    after_status = SplitAtBoundaries(f, after, delay_estimator,
+                                     after_thread_count, &after_bounds);
+  });
+  absl::Status before_status =
+      SplitAtBoundaries(f, before, delay_estimator,
+                        thread_count - after_thread_count, bounds);
+  thread.Join();
+  XLS_RETURN_IF_ERROR(before_status);
+  XLS_RETURN_IF_ERROR(after_status);
+
+  // Merge in the bounds of the nodes after the boundary.
+  for (Node* node : f->nodes()) {
+    if (after_bounds.lb(node) > cycle) {
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, after_bounds.lb(node)));
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, after_bounds.ub(node)));
+    }
+  }
+  return absl::OkStatus();
+}
+
 // Returns the number of pipeline registers (flops) on the interior of the
 // pipeline not counting the input and output flops (if any).
 absl::StatusOr<int64_t> CountInteriorPipelineRegisters(
@@ -141,7 +205,8 @@ std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length) {
 absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints) {
+    absl::Span<const SchedulingConstraint> constraints, int64_t thread_count,
+    SchedulingMetricsProto* metrics) {
   XLS_VLOG(3) << "MinCutScheduler()";
   XLS_VLOG(3) << "  pipeline stages = " << pipeline_stages;
   XLS_VLOG_LINES(4, f->DumpIr());
@@ -181,33 +246,73 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
   }
 
   // Try a number of different orderings of cycle boundary at which the min-cut
-  // is performed and keep the best one.
-  int64_t best_register_count = std::numeric_limits<int64_t>::max();
-  std::optional<sched::ScheduleBounds> best_bounds;
-  for (const std::vector<int64_t>& cut_order :
-       GetMinCutCycleOrders(pipeline_stages - 1)) {
+  // is performed and keep the best one. The orderings are independent and are
+  // tried concurrently, with the threads divided among them.
+  std::vector<std::vector<int64_t>> cut_orders =
+      GetMinCutCycleOrders(pipeline_stages - 1);
+  std::vector<sched::ScheduleBounds> trial_bounds(cut_orders.size(), *bounds);
+  std::vector<absl::StatusOr<int64_t>> trial_register_counts(
+      cut_orders.size());
+  std::vector<absl::Duration> trial_durations(cut_orders.size());
+  auto run_trial = [&](int64_t i, int64_t trial_thread_count) {
+    absl::Time start = absl::Now();
     XLS_VLOG(3) << absl::StreamFormat("Trying cycle order: {%s}",
-                                      absl::StrJoin(cut_order, ", "));
-    sched::ScheduleBounds trial_bounds = *bounds;
-    // Partition the nodes at each cycle boundary. For each iteration, this
-    // splits the nodes into those which must be scheduled at or before the
-    // cycle and those which must be scheduled after. Upon loop completion each
-    // node will have a range of exactly one cycle.
-    for (int64_t cycle : cut_order) {
-      XLS_RETURN_IF_ERROR(
-          SplitAfterCycle(f, cycle, delay_estimator, &trial_bounds));
-      XLS_RETURN_IF_ERROR(trial_bounds.PropagateLowerBounds());
-      XLS_RETURN_IF_ERROR(trial_bounds.PropagateUpperBounds());
+                                      absl::StrJoin(cut_orders[i], ", "));
+    // Partition the nodes at each cycle boundary. This splits the nodes into
+    // those which must be scheduled at or before the cycle and those which
+    // must be scheduled after. Upon completion each node will have a range of
+    // exactly one cycle.
+    absl::Status status =
+        SplitAtBoundaries(f, cut_orders[i], delay_estimator,
+                          trial_thread_count, &trial_bounds[i]);
+    trial_durations[i] = absl::Now() - start;
+    trial_register_counts[i] =
+        status.ok() ? CountInteriorPipelineRegisters(f, trial_bounds[i])
+                    : absl::StatusOr<int64_t>(status);
+  };
+  int64_t trial_count = cut_orders.size();
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < trial_count && i < thread_count; ++i) {
+    // Trial `i` gets every `trial_count`-th thread starting at `i`.
+    int64_t trial_thread_count = (thread_count - i + trial_count - 1) /
+                                 trial_count;
+    threads.push_back(std::make_unique<Thread>(
+        [&run_trial, i, trial_thread_count]() {
+          run_trial(i, trial_thread_count);
+        }));
+  }
+  run_trial(0, (thread_count + trial_count - 1) / trial_count);
+  for (int64_t i = std::max<int64_t>(thread_count, 1); i < trial_count; ++i) {
+    run_trial(i, 1);
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  if (metrics != nullptr) {
+    int64_t cut_count = 0;
+    absl::Duration total_duration;
+    for (int64_t i = 0; i < trial_count; ++i) {
+      cut_count += cut_orders[i].size();
+      total_duration += trial_durations[i];
     }
+    metrics->set_min_cut_order_count(trial_count);
+    metrics->set_min_cut_count(cut_count);
+    metrics->set_min_cut_duration_us(absl::ToInt64Microseconds(total_duration));
+  }
+
+  // Keep the first ordering with the fewest registers.
+  int64_t best_register_count = std::numeric_limits<int64_t>::max();
+  std::optional<int64_t> best_trial;
+  for (int64_t i = 0; i < trial_count; ++i) {
     XLS_ASSIGN_OR_RETURN(int64_t trial_register_count,
-                         CountInteriorPipelineRegisters(f, trial_bounds));
-    if (!best_bounds.has_value() ||
+                         trial_register_counts[i]);
+    if (!best_trial.has_value() ||
         best_register_count > trial_register_count) {
-      best_bounds = std::move(trial_bounds);
+      best_trial = i;
       best_register_count = trial_register_count;
     }
   }
-  *bounds = std::move(*best_bounds);
+  *bounds = std::move(trial_bounds[*best_trial]);
 
   ScheduleCycleMap cycle_map;
   for (Node* node : f->nodes()) {
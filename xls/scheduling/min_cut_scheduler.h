@@ -23,6 +23,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/proc.h"
 #include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_metrics.pb.h"
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls {
@@ -30,11 +31,16 @@ namespace xls {
 // Schedules the given function into a pipeline with the given clock
 // period. Attempts to split nodes into stages such that the total number of
 // flops in the pipeline stages is minimized without violating the target clock
-// period.
+// period. Up to `thread_count` threads are used to try the cut orderings
+// concurrently and to perform independent cuts within an ordering
+// concurrently. The result does not depend on `thread_count`. If `metrics` is
+// given, the number of cuts and the time spent computing them are recorded in
+// it.
 absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints);
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t thread_count = 1, SchedulingMetricsProto* metrics = nullptr);
 
 // Returns the list of ordering of cycles (pipeline stages) in which to compute
 // min cut of the graph. Each min cut of the graph computes which XLS node
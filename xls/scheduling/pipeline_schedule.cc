@@ -17,13 +17,18 @@
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <memory>
 #include <random>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
@@ -75,18 +80,19 @@ std::vector<Node*> FinalStageNodes(FunctionBase* f) {
   return {};
 }
 
-// Construct ScheduleBounds for the given function assuming the given
-// clock period and delay estimator. `topo_sort` should be a topological sort of
-// the nodes of `f`. If `schedule_length` is given then the upper bounds are
+// Construct ScheduleBounds for the given function assuming the given clock
+// period, delay estimator and multicycle operation latencies. `topo_sort`
+// should be a topological sort of the nodes of `f`. If `schedule_length` is given then the upper bounds are
 // set on the bounds object with the maximum upper bound set to
 // `schedule_length` - 1. Otherwise, the maximum upper bound is set to the
 // maximum lower bound.
 absl::StatusOr<sched::ScheduleBounds> ConstructBounds(
     FunctionBase* f, int64_t clock_period_ps, std::vector<Node*> topo_sort,
     std::optional<int64_t> schedule_length,
-    const DelayEstimator& delay_estimator) {
+    const DelayEstimator& delay_estimator, const LatencyMap& node_latencies) {
   sched::ScheduleBounds bounds(f, std::move(topo_sort), clock_period_ps,
                                delay_estimator);
+  bounds.SetNodeLatencies(node_latencies);
 
   // Initially compute the lower bounds of all nodes.
   XLS_RETURN_IF_ERROR(bounds.PropagateLowerBounds());
@@ -167,11 +173,15 @@ absl::StatusOr<int64_t> ComputeCriticalPath(
 }
 
 // Returns the minimum clock period in picoseconds for which it is feasible to
-// schedule the function into a pipeline with the given number of stages.
+// schedule the function into a pipeline with the given number of stages and
+// initiation interval. `thread_count` candidate periods are evaluated
+// concurrently.
 absl::StatusOr<int64_t> FindMinimumClockPeriod(
-    FunctionBase* f, int64_t pipeline_stages,
+    FunctionBase* f, int64_t pipeline_stages, int64_t initiation_interval,
     const DelayEstimator& delay_estimator,
-    absl::Span<const SchedulingConstraint> constraints) {
+    absl::Span<const SchedulingConstraint> constraints,
+    const LatencyMap& node_latencies, int64_t thread_count,
+    SchedulingMetricsProto* metrics) {
   XLS_VLOG(4) << "FindMinimumClockPeriod()";
   XLS_VLOG(4) << "  pipeline stages = " << pipeline_stages;
   auto topo_sort_it = TopoSort(f);
@@ -187,23 +197,77 @@ absl::StatusOr<int64_t> FindMinimumClockPeriod(
   int64_t search_end = function_cp;
   XLS_VLOG(4) << absl::StreamFormat("Binary searching over interval [%d, %d]",
                                     search_start, search_end);
+  // LP models are re-solved for each candidate clock period so the solver can
+  // warm-start from the previous solution. An MPSolver cannot be used from
+  // multiple threads at once so each concurrent probe takes a model from the
+  // pool (creating one if none is free) and returns it when done.
+  absl::Mutex models_mutex;
+  std::vector<std::unique_ptr<SDCSchedulingModel>> free_models;
+  auto record_probe = [&](int64_t clk_period_ps, bool feasible,
+                          absl::Time start) {
+    if (metrics == nullptr) {
+      return;
+    }
+    absl::Duration duration = absl::Now() - start;
+    absl::MutexLock lock(&models_mutex);
+    ClockPeriodProbeProto* probe = metrics->add_clock_period_probes();
+    probe->set_clock_period_ps(clk_period_ps);
+    probe->set_feasible(feasible);
+    probe->set_duration_us(absl::ToInt64Microseconds(duration));
+  };
+  auto is_feasible = [&](int64_t clk_period_ps) -> absl::StatusOr<bool> {
+    absl::Time start = absl::Now();
+    absl::StatusOr<sched::ScheduleBounds> bounds_or =
+        ConstructBounds(f, clk_period_ps, topo_sort, pipeline_stages,
+                        delay_estimator, node_latencies);
+    if (!bounds_or.ok()) {
+      record_probe(clk_period_ps, false, start);
+      return false;
+    }
+    std::unique_ptr<SDCSchedulingModel> model;
+    {
+      absl::MutexLock lock(&models_mutex);
+      if (!free_models.empty()) {
+        model = std::move(free_models.back());
+        free_models.pop_back();
+      }
+    }
+    if (model == nullptr) {
+      absl::StatusOr<std::unique_ptr<SDCSchedulingModel>> model_or =
+          SDCSchedulingModel::Create(f, pipeline_stages, delay_estimator,
+                                     constraints, /*check_feasibility=*/true,
+                                     initiation_interval, node_latencies);
+      if (!model_or.ok()) {
+        record_probe(clk_period_ps, false, start);
+        return false;
+      }
+      model = std::move(model_or).value();
+    }
+    bool feasible = model->Solve(clk_period_ps, bounds_or.value()).ok();
+    {
+      absl::MutexLock lock(&models_mutex);
+      free_models.push_back(std::move(model));
+    }
+    record_probe(clk_period_ps, feasible, start);
+    return feasible;
+  };
+  absl::Time start = absl::Now();
   XLS_ASSIGN_OR_RETURN(
       int64_t min_period,
-      BinarySearchMinTrueWithStatus(
-          search_start, search_end,
-          [&](int64_t clk_period_ps) -> absl::StatusOr<bool> {
-            absl::StatusOr<sched::ScheduleBounds> bounds_or = ConstructBounds(
-                f, clk_period_ps, topo_sort, pipeline_stages, delay_estimator);
-            if (!bounds_or.ok()) {
-              return false;
-            }
-            sched::ScheduleBounds bounds = bounds_or.value();
-            absl::StatusOr<ScheduleCycleMap> scm =
-                SDCScheduler(f, pipeline_stages, clk_period_ps, delay_estimator,
-                             &bounds, constraints, /*check_feasibility=*/true);
-            return scm.ok();
-          }));
+      ParallelSearchMinTrueWithStatus(search_start, search_end, thread_count,
+                                      is_feasible));
   XLS_VLOG(4) << "minimum clock period = " << min_period;
+  if (metrics != nullptr) {
+    metrics->set_clock_period_search_duration_us(
+        absl::ToInt64Microseconds(absl::Now() - start));
+    for (const std::unique_ptr<SDCSchedulingModel>& model : free_models) {
+      metrics->set_lp_solve_count(metrics->lp_solve_count() +
+                                  model->solve_count());
+      metrics->set_lp_solve_duration_us(
+          metrics->lp_solve_duration_us() +
+          absl::ToInt64Microseconds(model->solve_duration()));
+    }
+  }
 
   return min_period;
 }
@@ -253,7 +317,12 @@ absl::StatusOr<PipelineSchedule> PipelineSchedule::FromProto(
       cycle_map[node] = stage.stage();
     }
   }
-  return PipelineSchedule(function, cycle_map);
+  // Preserve trailing empty stages.
+  std::optional<int64_t> length;
+  if (proto.stages_size() > 0) {
+    length = proto.stages_size();
+  }
+  return PipelineSchedule(function, cycle_map, length);
 }
 
 absl::Span<Node* const> PipelineSchedule::nodes_in_cycle(int64_t cycle) const {
@@ -299,16 +368,72 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
 
 /*static*/ absl::StatusOr<PipelineSchedule> PipelineSchedule::Run(
     FunctionBase* f, const DelayEstimator& delay_estimator,
-    const SchedulingOptions& options) {
+    const SchedulingOptions& options, SchedulingMetricsProto* metrics) {
+  absl::Time start = absl::Now();
   int64_t input_delay = options.additional_input_delay_ps().has_value()
                             ? options.additional_input_delay_ps().value()
                             : 0;
+  int64_t initiation_interval = options.initiation_interval().value_or(1);
+  if (initiation_interval < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Initiation interval must be positive, got %d", initiation_interval));
+  }
+
+  const OpLatencyMap& multicycle_ops = options.multicycle_ops();
+  for (const auto& [op, latency] : multicycle_ops) {
+    if (latency < 1) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Latency of multicycle operation %s must be "
+                          "positive, got %d",
+                          OpToString(op), latency));
+    }
+  }
+  std::optional<MemoryLookupConfig> memory_lookups = options.memory_lookups();
+  if (memory_lookups.has_value() && memory_lookups->read_latency < 1) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Memory read latency must be positive, got %d",
+                        memory_lookups->read_latency));
+  }
 
+  // The data of a memory read is available `read_latency` cycles after the
+  // address, so the read spans one more cycle than its latency.
+  LatencyMap node_latencies;
+  for (Node* node : f->nodes()) {
+    int64_t latency = 1;
+    if (memory_lookups.has_value() &&
+        IsLiteralTableLookup(node, memory_lookups->min_table_bits)) {
+      latency = memory_lookups->read_latency + 1;
+    } else if (auto it = multicycle_ops.find(node->op());
+               it != multicycle_ops.end()) {
+      latency = it->second;
+    }
+    if (latency == 1) {
+      continue;
+    }
+    if (options.strategy() == SchedulingStrategy::MIN_CUT) {
+      return absl::InvalidArgumentError(
+          "Multicycle operations are not supported by the min-cut scheduler");
+    }
+    if (f->HasImplicitUse(node)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Multicycle operation %s of %s has an implicit use (e.g., is the "
+          "return value or a next state value)",
+          node->GetName(), f->name()));
+    }
+    node_latencies[node] = latency;
+  }
+
+  // The delay of a multicycle operation is split evenly across its cycles.
   DecoratingDelayEstimator input_delay_added(
       "input_delay_added", delay_estimator,
-      [input_delay](Node* node, int64_t base_delay) {
-        return node->op() == Op::kReceive ? base_delay + input_delay
-                                          : base_delay;
+      [input_delay, &node_latencies](Node* node, int64_t base_delay) {
+        int64_t delay = node->op() == Op::kReceive ? base_delay + input_delay
+                                                   : base_delay;
+        auto it = node_latencies.find(node);
+        if (it == node_latencies.end()) {
+          return delay;
+        }
+        return (delay + it->second - 1) / it->second;
       });
 
   int64_t clock_period_ps;
@@ -334,8 +459,10 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
     // given pipeline length.
     XLS_ASSIGN_OR_RETURN(
         clock_period_ps,
-        FindMinimumClockPeriod(f, *options.pipeline_stages(), input_delay_added,
-                               options.constraints()));
+        FindMinimumClockPeriod(
+            f, *options.pipeline_stages(), initiation_interval,
+            input_delay_added, options.constraints(), node_latencies,
+            options.thread_count().value_or(1), metrics));
 
     if (options.period_relaxation_percent().has_value()) {
       int64_t relaxation_percent = options.period_relaxation_percent().value();
@@ -347,7 +474,8 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
   XLS_ASSIGN_OR_RETURN(
       sched::ScheduleBounds bounds,
       ConstructBounds(f, clock_period_ps, TopoSort(f).AsVector(),
-                      options.pipeline_stages(), input_delay_added));
+                      options.pipeline_stages(), input_delay_added,
+                      node_latencies));
   int64_t schedule_length = bounds.max_lower_bound() + 1;
   if (options.pipeline_stages().has_value()) {
     schedule_length = options.pipeline_stages().value();
@@ -358,12 +486,15 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
     XLS_ASSIGN_OR_RETURN(
         cycle_map,
         MinCutScheduler(f, schedule_length, clock_period_ps, input_delay_added,
-                        &bounds, options.constraints()));
+                        &bounds, options.constraints(),
+                        options.thread_count().value_or(1), metrics));
   } else if (options.strategy() == SchedulingStrategy::SDC) {
     XLS_ASSIGN_OR_RETURN(
         cycle_map,
         SDCScheduler(f, schedule_length, clock_period_ps, input_delay_added,
-                     &bounds, options.constraints()));
+                     &bounds, options.constraints(),
+                     /*check_feasibility=*/false, metrics,
+                     initiation_interval, node_latencies));
   } else if (options.strategy() == SchedulingStrategy::RANDOM) {
     for (Node* node : TopoSort(f)) {
       int64_t lower_bound = bounds.lb(node);
@@ -433,7 +564,31 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
     }
   }
 
+  // Verify that the results of multicycle operations are not used before they
+  // are available.
+  for (Node* node : f->nodes()) {
+    auto it = node_latencies.find(node);
+    if (it == node_latencies.end()) {
+      continue;
+    }
+    int64_t latency = it->second;
+    for (Node* user : node->users()) {
+      if (schedule.cycle(user) - schedule.cycle(node) < latency - 1) {
+        return absl::InternalError(absl::StrFormat(
+            "Multicycle operation %s with latency %d is scheduled in cycle %d "
+            "but its user %s is scheduled in cycle %d",
+            node->GetName(), latency, schedule.cycle(node), user->GetName(),
+            schedule.cycle(user)));
+      }
+    }
+  }
+
   XLS_VLOG_LINES(3, "Schedule\n" + schedule.ToString());
+  if (metrics != nullptr) {
+    metrics->set_clock_period_ps(clock_period_ps);
+    metrics->set_total_duration_us(
+        absl::ToInt64Microseconds(absl::Now() - start));
+  }
   return schedule;
 }
 
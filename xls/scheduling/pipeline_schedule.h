@@ -23,6 +23,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/proc.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/scheduling_metrics.pb.h"
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls {
@@ -31,10 +32,12 @@ namespace xls {
 class PipelineSchedule {
  public:
   // Produces a feed-forward pipeline schedule using the given delay model and
-  // scheduling options.
+  // scheduling options. If `metrics` is given, statistics about the time
+  // spent scheduling are recorded in it.
   static absl::StatusOr<PipelineSchedule> Run(
       FunctionBase* f, const DelayEstimator& delay_estimator,
-      const SchedulingOptions& options);
+      const SchedulingOptions& options,
+      SchedulingMetricsProto* metrics = nullptr);
 
   // Reconstructs a PipelineSchedule object from a proto representation.
   static absl::StatusOr<PipelineSchedule> FromProto(
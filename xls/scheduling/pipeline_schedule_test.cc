@@ -14,6 +14,8 @@
 
 #include "xls/scheduling/pipeline_schedule.h"
 
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
@@ -379,6 +381,113 @@ TEST_F(PipelineScheduleTest, JustPipelineLengthGiven) {
   EXPECT_THAT(scheduled_ops(5), UnorderedElementsAre(Op::kNeg));
 }
 
+TEST_F(PipelineScheduleTest, ParallelClockPeriodSearch) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  std::vector<BValue> chain;
+  BValue value = x;
+  for (int64_t i = 0; i < 12; ++i) {
+    value = fb.Negate(value);
+    chain.push_back(value);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  for (int64_t thread_count : {1, 2, 4}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        PipelineSchedule::Run(
+            func, TestDelayEstimator(),
+            SchedulingOptions().pipeline_stages(3).thread_count(thread_count)));
+    EXPECT_EQ(schedule.length(), 3);
+    // The minimum clock period is 4ps which forces exactly four negations into
+    // each stage.
+    for (int64_t i = 0; i < chain.size(); ++i) {
+      EXPECT_EQ(schedule.cycle(chain[i].node()), i / 4)
+          << "thread count: " << thread_count;
+    }
+  }
+}
+
+TEST_F(PipelineScheduleTest, ParallelMinCutIsThreadCountInvariant) {
+  // A lattice of adds and negates with many crossing paths so each cut has
+  // several candidate positions.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(16));
+  BValue b = fb.Param("b", p->GetBitsType(16));
+  for (int64_t i = 0; i < 10; ++i) {
+    BValue sum = fb.Add(a, b);
+    b = fb.Negate(a);
+    a = sum;
+  }
+  fb.Concat({a, b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule serial,
+      PipelineSchedule::Run(func, TestDelayEstimator(),
+                            SchedulingOptions(SchedulingStrategy::MIN_CUT)
+                                .pipeline_stages(5)
+                                .thread_count(1)));
+  for (int64_t thread_count : {2, 3, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        PipelineSchedule::Run(func, TestDelayEstimator(),
+                              SchedulingOptions(SchedulingStrategy::MIN_CUT)
+                                  .pipeline_stages(5)
+                                  .thread_count(thread_count)));
+    for (Node* node : func->nodes()) {
+      EXPECT_EQ(schedule.cycle(node), serial.cycle(node))
+          << node->GetName() << ", thread count: " << thread_count;
+    }
+  }
+}
+
+TEST_F(PipelineScheduleTest, SchedulingMetrics) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue value = fb.Param("x", p->GetBitsType(32));
+  for (int64_t i = 0; i < 6; ++i) {
+    value = fb.Negate(value);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  SchedulingMetricsProto sdc_metrics;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule sdc_schedule,
+      PipelineSchedule::Run(func, TestDelayEstimator(),
+                            SchedulingOptions().pipeline_stages(3),
+                            &sdc_metrics));
+  EXPECT_EQ(sdc_schedule.length(), 3);
+  EXPECT_EQ(sdc_metrics.clock_period_ps(), 2);
+  EXPECT_GT(sdc_metrics.clock_period_probes_size(), 0);
+  for (const ClockPeriodProbeProto& probe :
+       sdc_metrics.clock_period_probes()) {
+    EXPECT_EQ(probe.feasible(), probe.clock_period_ps() >= 2);
+  }
+  EXPECT_GT(sdc_metrics.lp_variable_count(), 0);
+  EXPECT_GT(sdc_metrics.lp_constraint_count(), 0);
+  // One solve per probe which reaches the solver plus the final schedule.
+  EXPECT_GT(sdc_metrics.lp_solve_count(), 1);
+  EXPECT_EQ(sdc_metrics.min_cut_count(), 0);
+
+  SchedulingMetricsProto min_cut_metrics;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule min_cut_schedule,
+      PipelineSchedule::Run(func, TestDelayEstimator(),
+                            SchedulingOptions(SchedulingStrategy::MIN_CUT)
+                                .clock_period_ps(2)
+                                .pipeline_stages(3),
+                            &min_cut_metrics));
+  EXPECT_EQ(min_cut_metrics.clock_period_ps(), 2);
+  EXPECT_EQ(min_cut_metrics.clock_period_probes_size(), 0);
+  EXPECT_EQ(min_cut_metrics.lp_solve_count(), 0);
+  EXPECT_GT(min_cut_metrics.min_cut_order_count(), 0);
+  EXPECT_EQ(min_cut_metrics.min_cut_count(),
+            2 * min_cut_metrics.min_cut_order_count());
+}
+
 TEST_F(PipelineScheduleTest, LongPipelineLength) {
   // Generate an absurdly long pipeline schedule. Most stages are empty, but it
   // should not crash.
@@ -609,6 +718,146 @@ TEST_F(PipelineScheduleTest, MultistateProcSchedule) {
   EXPECT_EQ(schedule.cycle(send.node()), 2);
 }
 
+TEST_F(PipelineScheduleTest, ProcStateRecurrenceWithInitiationInterval) {
+  Package p("p");
+  Type* u16 = p.GetBitsType(16);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_ch,
+      p.CreateStreamingChannel("out", ChannelOps::kSendOnly, u16));
+  TokenlessProcBuilder pb("the_proc", "tkn", &p);
+  BValue st = pb.StateElement("st", Value(UBits(0, 16)));
+  BValue next = pb.Negate(pb.Not(pb.Negate(st)));
+  pb.Send(out_ch, st);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({next}));
+
+  // The state recurrence requires three cycles at this clock period so it
+  // cannot be scheduled with an initiation interval of one or two.
+  EXPECT_FALSE(PipelineSchedule::Run(proc, TestDelayEstimator(),
+                                     SchedulingOptions().clock_period_ps(1))
+                   .ok());
+  EXPECT_FALSE(PipelineSchedule::Run(proc, TestDelayEstimator(),
+                                     SchedulingOptions()
+                                         .clock_period_ps(1)
+                                         .initiation_interval(2))
+                   .ok());
+  EXPECT_THAT(PipelineSchedule::Run(
+                  proc, TestDelayEstimator(),
+                  SchedulingOptions().clock_period_ps(1).initiation_interval(0)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Initiation interval must be positive")));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(
+          proc, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(1).initiation_interval(3)));
+  EXPECT_EQ(schedule.length(), 3);
+  EXPECT_EQ(schedule.cycle(st.node()), 0);
+  EXPECT_EQ(schedule.cycle(next.node()), 2);
+
+  // The minimum clock period for a fixed number of stages also benefits from
+  // the longer initiation interval.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule ii3_schedule,
+      PipelineSchedule::Run(
+          proc, TestDelayEstimator(),
+          SchedulingOptions().pipeline_stages(3).initiation_interval(3)));
+  EXPECT_EQ(ii3_schedule.cycle(next.node()) - ii3_schedule.cycle(st.node()),
+            2);
+}
+
+TEST_F(PipelineScheduleTest, MulticycleOperation) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue div = fb.UDiv(x, y);
+  BValue not_div = fb.Not(div);
+  BValue result = fb.Negate(not_div);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // The divide does not fit in a single cycle of the clock period.
+  EXPECT_THAT(PipelineSchedule::Run(func, TestDelayEstimator(),
+                                    SchedulingOptions().clock_period_ps(1)),
+              StatusIs(absl::StatusCode::kResourceExhausted,
+                       HasSubstr("greater delay")));
+
+  // Spread over two cycles, the second half of the divide shares a cycle with
+  // nothing else at this clock period.
+  for (SchedulingStrategy strategy :
+       {SchedulingStrategy::SDC, SchedulingStrategy::ASAP}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        PipelineSchedule::Run(func, TestDelayEstimator(),
+                              SchedulingOptions(strategy)
+                                  .clock_period_ps(1)
+                                  .multicycle_op(Op::kUDiv, 2)));
+    EXPECT_EQ(schedule.length(), 4);
+    EXPECT_EQ(schedule.cycle(div.node()), 0);
+    EXPECT_EQ(schedule.cycle(not_div.node()), 2);
+    EXPECT_EQ(schedule.cycle(result.node()), 3);
+  }
+
+  // With a longer clock period the user of the divide fits in the cycle in
+  // which its result is available.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(
+          func, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(2).multicycle_op(Op::kUDiv, 2)));
+  EXPECT_EQ(schedule.length(), 3);
+  EXPECT_EQ(schedule.cycle(div.node()), 0);
+  EXPECT_EQ(schedule.cycle(not_div.node()), 1);
+  EXPECT_EQ(schedule.cycle(result.node()), 2);
+
+  EXPECT_THAT(PipelineSchedule::Run(
+                  func, TestDelayEstimator(),
+                  SchedulingOptions(SchedulingStrategy::MIN_CUT)
+                      .clock_period_ps(1)
+                      .multicycle_op(Op::kUDiv, 2)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not supported by the min-cut scheduler")));
+  EXPECT_THAT(PipelineSchedule::Run(
+                  func, TestDelayEstimator(),
+                  SchedulingOptions().clock_period_ps(1).multicycle_op(
+                      Op::kUDiv, 0)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("must be positive")));
+}
+
+TEST_F(PipelineScheduleTest, MemoryLookup) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(2));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value table, Value::UBitsArray({1, 2, 3, 4}, /*bit_count=*/8));
+  BValue lookup = fb.ArrayIndex(fb.Literal(table), {x});
+  BValue not_lookup = fb.Not(lookup);
+  BValue result = fb.Negate(not_lookup);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // The data of the memory is available two cycles after the lookup.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(
+          func, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(3).memory_lookups(
+              MemoryLookupConfig{.min_table_bits = 32, .read_latency = 2})));
+  EXPECT_EQ(schedule.length(), 3);
+  EXPECT_EQ(schedule.cycle(lookup.node()), 0);
+  EXPECT_EQ(schedule.cycle(not_lookup.node()), 2);
+  EXPECT_EQ(schedule.cycle(result.node()), 2);
+
+  // Smaller tables than the configured minimum are left as logic.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      schedule,
+      PipelineSchedule::Run(
+          func, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(3).memory_lookups(
+              MemoryLookupConfig{.min_table_bits = 64, .read_latency = 2})));
+  EXPECT_EQ(schedule.length(), 1);
+}
+
 TEST_F(PipelineScheduleTest, ProcWithConditionalReceive) {
   // Test a proc with a conditional receive.
   Package p("p");
@@ -64,8 +64,22 @@ std::string ScheduleBounds::ToString() const {
   return out;
 }
 
+absl::Status ScheduleBounds::ComputeNodeDelays() {
+  if (!node_delays_.empty() || topo_sort_.empty()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delays,
+                       delay_estimator_->GetOperationDelaysInPs(topo_sort_));
+  node_delays_.reserve(topo_sort_.size());
+  for (int64_t i = 0; i < topo_sort_.size(); ++i) {
+    node_delays_[topo_sort_[i]] = delays[i];
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ScheduleBounds::PropagateLowerBounds() {
   XLS_VLOG(4) << "PropagateLowerBounds()";
+  XLS_RETURN_IF_ERROR(ComputeNodeDelays());
   // The delay in picoseconds from the beginning of a cycle to the start of the
   // node.
   absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
@@ -73,29 +87,32 @@ absl::Status ScheduleBounds::PropagateLowerBounds() {
   // Compute the lower bound of each node based on the lower bounds of the
   // operands of the node.
   for (Node* node : topo_sort_) {
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
     XLS_VLOG(4) << absl::StreamFormat("  %s : original lb=%d", node->GetName(),
                                       lb(node));
+    int64_t node_lb = lb(node);
+    int64_t node_in_cycle_delay = 0;
     for (Node* operand : node->operands()) {
-      int64_t operand_lb = lb(operand);
-      if (operand_lb < lb(node)) {
+      // The result of a multicycle operand is available in its last cycle,
+      // after the final portion of its delay.
+      int64_t operand_latency = Latency(operand);
+      int64_t result_cycle = lb(operand) + operand_latency - 1;
+      if (result_cycle < node_lb) {
         continue;
       }
-      XLS_ASSIGN_OR_RETURN(int64_t operand_delay,
-                           delay_estimator_->GetOperationDelayInPs(operand));
-      if (operand_lb > lb(node)) {
+      int64_t result_delay =
+          (operand_latency > 1 ? 0 : in_cycle_delay.at(operand)) +
+          node_delays_.at(operand);
+      if (result_cycle > node_lb) {
         XLS_VLOG(4) << absl::StreamFormat(
-            "    tightened lb to %d because of operand %s", operand_lb,
+            "    tightened lb to %d because of operand %s", result_cycle,
             operand->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb));
-        node_in_cycle_delay = in_cycle_delay.at(operand) + operand_delay;
+        node_lb = result_cycle;
+        node_in_cycle_delay = result_delay;
         continue;
       }
-      node_in_cycle_delay = std::max(
-          node_in_cycle_delay, in_cycle_delay.at(operand) + operand_delay);
+      node_in_cycle_delay = std::max(node_in_cycle_delay, result_delay);
     }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator_->GetOperationDelayInPs(node));
+    int64_t node_delay = node_delays_.at(node);
     if (node_delay > clock_period_ps_) {
       return absl::ResourceExhaustedError(absl::StrFormat(
           "Node %s has a greater delay (%dps) than the clock period (%dps)",
@@ -104,16 +121,21 @@ absl::Status ScheduleBounds::PropagateLowerBounds() {
     if (node_in_cycle_delay + node_delay > clock_period_ps_) {
       // Node does not fit in this cycle. Move to next cycle.
       XLS_VLOG(4) << "    overflows clock period, tightened lb to "
-                  << lb(node) + 1;
-      XLS_RETURN_IF_ERROR(TightenNodeLb(node, lb(node) + 1));
+                  << node_lb + 1;
+      ++node_lb;
       node_in_cycle_delay = 0;
     }
+    if (node_lb > lb(node)) {
+      XLS_RETURN_IF_ERROR(TightenNodeLb(node, node_lb));
+    }
+    in_cycle_delay[node] = node_in_cycle_delay;
   }
   return absl::OkStatus();
 }
 
 absl::Status ScheduleBounds::PropagateUpperBounds() {
   XLS_VLOG(4) << "PropagateUpperBounds()";
+  XLS_RETURN_IF_ERROR(ComputeNodeDelays());
   // The delay in picoseconds from the end of a cycle to the end of the node.
   absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
 
@@ -121,42 +143,56 @@ absl::Status ScheduleBounds::PropagateUpperBounds() {
   // users of the node.
   for (auto it = topo_sort_.rbegin(); it != topo_sort_.rend(); ++it) {
     Node* node = *it;
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
     XLS_VLOG(4) << absl::StreamFormat("  %s : original ub=%d", node->GetName(),
                                       ub(node));
+    // The result of a multicycle node is produced `latency - 1` cycles after
+    // the cycle in which the node is scheduled. Bound the cycle of the result
+    // by the users of the node and derive the bound of the node from it.
+    int64_t latency = Latency(node);
+    int64_t result_ub = ub(node) == std::numeric_limits<int64_t>::max()
+                            ? ub(node)
+                            : ub(node) + latency - 1;
+    int64_t result_in_cycle_delay = 0;
     for (Node* user : node->users()) {
       int64_t user_ub = ub(user);
       if (user_ub == std::numeric_limits<int64_t>::max() ||
-          user_ub > ub(node)) {
+          user_ub > result_ub) {
         continue;
       }
-      XLS_ASSIGN_OR_RETURN(int64_t user_delay,
-                           delay_estimator_->GetOperationDelayInPs(user));
-      if (user_ub < ub(node)) {
+      int64_t user_delay = node_delays_.at(user);
+      if (user_ub < result_ub) {
         XLS_VLOG(4) << absl::StreamFormat(
-            "    tightened ub to %d because of user %s", user_ub,
+            "    tightened result ub to %d because of user %s", user_ub,
             user->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeUb(node, user_ub));
-        node_in_cycle_delay = in_cycle_delay.at(user) + user_delay;
+        result_ub = user_ub;
+        result_in_cycle_delay = in_cycle_delay.at(user) + user_delay;
         continue;
       }
-      node_in_cycle_delay =
-          std::max(node_in_cycle_delay, in_cycle_delay.at(user) + user_delay);
+      result_in_cycle_delay =
+          std::max(result_in_cycle_delay, in_cycle_delay.at(user) + user_delay);
     }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator_->GetOperationDelayInPs(node));
+    int64_t node_delay = node_delays_.at(node);
     if (node_delay > clock_period_ps_) {
       return absl::ResourceExhaustedError(absl::StrFormat(
           "Node %s has a greater delay (%dps) than the clock period (%dps)",
           node->GetName(), node_delay, clock_period_ps_));
     }
-    if (node_in_cycle_delay + node_delay > clock_period_ps_) {
+    if (result_in_cycle_delay + node_delay > clock_period_ps_) {
       // Node does not fit in this cycle. Move to next cycle.
-      XLS_VLOG(4) << "    overflows clock period, tightened ub to "
-                  << ub(node) - 1;
-      XLS_RETURN_IF_ERROR(TightenNodeUb(node, ub(node) - 1));
-      node_in_cycle_delay = 0;
+      XLS_VLOG(4) << "    overflows clock period, tightened result ub to "
+                  << result_ub - 1;
+      --result_ub;
+      result_in_cycle_delay = 0;
+    }
+    if (latency > 1) {
+      // The first portion of a multicycle node ends its cycle.
+      result_in_cycle_delay = 0;
+    }
+    if (result_ub != std::numeric_limits<int64_t>::max() &&
+        result_ub - (latency - 1) < ub(node)) {
+      XLS_RETURN_IF_ERROR(TightenNodeUb(node, result_ub - (latency - 1)));
     }
+    in_cycle_delay[node] = result_in_cycle_delay;
   }
   return absl::OkStatus();
 }
@@ -62,6 +62,14 @@ class ScheduleBounds {
   ScheduleBounds& operator=(const ScheduleBounds& other) = default;
   ScheduleBounds& operator=(ScheduleBounds&& other) = default;
 
+  // Sets the latency in cycles of multicycle nodes. The result of a node with
+  // a latency of N is available N - 1 cycles after the cycle in which the node
+  // is scheduled, so its users are bounded to be at least that many cycles
+  // later. Nodes not in the map take a single cycle.
+  void SetNodeLatencies(absl::flat_hash_map<Node*, int64_t> node_latencies) {
+    node_latencies_ = std::move(node_latencies);
+  }
+
   // Resets node bounds to their initial unconstrained values.
   void Reset();
 
@@ -118,12 +126,28 @@ class ScheduleBounds {
   absl::Status PropagateUpperBounds();
 
  private:
+  // Queries the delays of all nodes in one batch, if not already done.
+  absl::Status ComputeNodeDelays();
+
+  // Returns the number of cycles spanned by `node`.
+  int64_t Latency(Node* node) const {
+    auto it = node_latencies_.find(node);
+    return it == node_latencies_.end() ? 1 : it->second;
+  }
+
   // A topological sort of the nodes in the function.
   std::vector<Node*> topo_sort_;
 
   int64_t clock_period_ps_;
   const DelayEstimator* delay_estimator_;
 
+  // The delay of each node, filled in by ComputeNodeDelays on the first
+  // propagation. The delays do not depend on the bounds, so they are kept by
+  // Reset and shared by copies made after the first propagation.
+  absl::flat_hash_map<Node*, int64_t> node_delays_;
+
+  absl::flat_hash_map<Node*, int64_t> node_latencies_;
+
   // The bounds of each node stored as a {lower, upper} pair.
   absl::flat_hash_map<Node*, std::pair<int64_t, int64_t>> bounds_;
 
@@ -0,0 +1,154 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/stable_hash.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
+
+namespace xls {
+namespace {
+
+std::string StrategyToString(SchedulingStrategy strategy) {
+  switch (strategy) {
+    case SchedulingStrategy::ASAP:
+      return "asap";
+    case SchedulingStrategy::MIN_CUT:
+      return "min_cut";
+    case SchedulingStrategy::SDC:
+      return "sdc";
+    case SchedulingStrategy::RANDOM:
+      return "random";
+  }
+  return absl::StrCat("unknown(", static_cast<int>(strategy), ")");
+}
+
+std::string DirectionToString(IODirection direction) {
+  return direction == IODirection::kSend ? "send" : "recv";
+}
+
+template <typename T>
+std::string OptionalToString(const std::optional<T>& value) {
+  return value.has_value() ? absl::StrCat(*value) : "none";
+}
+
+}  // namespace
+
+std::string ScheduleCacheKey(FunctionBase* f, const SchedulingOptions& options,
+                             std::string_view delay_model_name) {
+  // The thread count of the scheduler does not affect the schedule
+  // and so is not part of the key.
+  std::string key = absl::StrFormat(
+      "function: %s\ndelay_model: %s\nstrategy: %s\nclock_period_ps: %s\n"
+      "pipeline_stages: %s\nclock_margin_percent: %s\n"
+      "period_relaxation_percent: %s\nadditional_input_delay_ps: %s\n"
+      "initiation_interval: %s\nseed: %s\n",
+      f->name(), delay_model_name, StrategyToString(options.strategy()),
+      OptionalToString(options.clock_period_ps()),
+      OptionalToString(options.pipeline_stages()),
+      OptionalToString(options.clock_margin_percent()),
+      OptionalToString(options.period_relaxation_percent()),
+      OptionalToString(options.additional_input_delay_ps()),
+      OptionalToString(options.initiation_interval()),
+      OptionalToString(options.seed()));
+  for (const SchedulingConstraint& constraint : options.constraints()) {
+    if (std::holds_alternative<IOConstraint>(constraint)) {
+      const IOConstraint& io = std::get<IOConstraint>(constraint);
+      absl::StrAppendFormat(
+          &key, "io_constraint: %s:%s:%s:%s:%d:%d\n", io.SourceChannel(),
+          DirectionToString(io.SourceDirection()), io.TargetChannel(),
+          DirectionToString(io.TargetDirection()), io.MinimumLatency(),
+          io.MaximumLatency());
+    } else {
+      XLS_CHECK(std::holds_alternative<RecvsFirstSendsLastConstraint>(
+          constraint));
+      absl::StrAppend(&key, "receives_first_sends_last\n");
+    }
+  }
+  // Multicycle operations are sorted so the key does not depend on the
+  // iteration order of the map.
+  std::vector<std::pair<std::string, int64_t>> multicycle_ops;
+  for (const auto& [op, latency] : options.multicycle_ops()) {
+    multicycle_ops.push_back({OpToString(op), latency});
+  }
+  std::sort(multicycle_ops.begin(), multicycle_ops.end());
+  for (const auto& [op, latency] : multicycle_ops) {
+    absl::StrAppendFormat(&key, "multicycle_op: %s:%d\n", op, latency);
+  }
+  if (options.memory_lookups().has_value()) {
+    absl::StrAppendFormat(&key, "memory_lookups: %d:%d\n",
+                          options.memory_lookups()->min_table_bits,
+                          options.memory_lookups()->read_latency);
+  }
+  absl::StrAppend(&key, "package:\n", f->package()->DumpIr());
+  return key;
+}
+
+std::filesystem::path ScheduleCache::EntryPath(std::string_view key) const {
+  return directory_ /
+         absl::StrFormat("%016x.schedule_cache_entry", Fnv1aHash(key));
+}
+
+absl::StatusOr<std::optional<PipelineSchedule>> ScheduleCache::Lookup(
+    FunctionBase* f, const SchedulingOptions& options,
+    std::string_view delay_model_name) const {
+  std::string key = ScheduleCacheKey(f, options, delay_model_name);
+  std::filesystem::path path = EntryPath(key);
+  absl::Status exists = FileExists(path);
+  if (absl::IsNotFound(exists)) {
+    XLS_VLOG(1) << "Schedule cache miss: " << path;
+    return std::nullopt;
+  }
+  XLS_RETURN_IF_ERROR(exists);
+
+  ScheduleCacheEntryProto entry;
+  XLS_RETURN_IF_ERROR(ParseProtobinFile(path, &entry));
+  if (entry.key() != key) {
+    XLS_VLOG(1) << "Schedule cache miss (hash collision): " << path;
+    return std::nullopt;
+  }
+  XLS_VLOG(1) << "Schedule cache hit: " << path;
+  XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
+                       PipelineSchedule::FromProto(f, entry.schedule()));
+  return schedule;
+}
+
+absl::Status ScheduleCache::Insert(const PipelineSchedule& schedule,
+                                   const SchedulingOptions& options,
+                                   std::string_view delay_model_name) const {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory_));
+  ScheduleCacheEntryProto entry;
+  entry.set_key(
+      ScheduleCacheKey(schedule.function_base(), options, delay_model_name));
+  *entry.mutable_schedule() = schedule.ToProto();
+
+  // Several tops may be scheduled at once by codegen_main, so entries may be
+  // read and written concurrently.
+  return SetProtobinFileAtomically(EntryPath(entry.key()), entry);
+}
+
+}  // namespace xls
@@ -0,0 +1,73 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_SCHEDULING_SCHEDULE_CACHE_H_
+#define XLS_SCHEDULING_SCHEDULE_CACHE_H_
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/function_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// Returns a string which uniquely identifies the problem of scheduling `f`
+// with the given options and delay model. The key includes the IR of the
+// entire package containing `f` (which captures the structure and names of
+// the nodes of `f` as well as the channels it communicates over) and every
+// option which affects the computed schedule.
+std::string ScheduleCacheKey(FunctionBase* f, const SchedulingOptions& options,
+                             std::string_view delay_model_name);
+
+// A persistent cache of pipeline schedules stored in a directory, one file per
+// entry. Entries are looked up by a hash of the ScheduleCacheKey of the
+// problem. Each entry also holds the full key which is compared on lookup so
+// a hash collision results in a miss rather than a wrong schedule. Entries are
+// written atomically so a cache directory may be shared by concurrent
+// processes.
+class ScheduleCache {
+ public:
+  explicit ScheduleCache(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+
+  // Returns the cached schedule of `f` for the given options and delay model
+  // or std::nullopt if there is none.
+  absl::StatusOr<std::optional<PipelineSchedule>> Lookup(
+      FunctionBase* f, const SchedulingOptions& options,
+      std::string_view delay_model_name) const;
+
+  // Adds the given schedule to the cache, replacing any existing entry for the
+  // same problem. Creates the cache directory if it does not exist.
+  absl::Status Insert(const PipelineSchedule& schedule,
+                      const SchedulingOptions& options,
+                      std::string_view delay_model_name) const;
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+ private:
+  // Returns the path of the file holding the entry with the given key.
+  std::filesystem::path EntryPath(std::string_view key) const;
+
+  std::filesystem::path directory_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_SCHEDULE_CACHE_H_
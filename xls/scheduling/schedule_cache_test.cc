@@ -0,0 +1,96 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/schedule_cache.h"
+
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+namespace xls {
+namespace {
+
+class ScheduleCacheTest : public IrTestBase {};
+
+TEST_F(ScheduleCacheTest, LookupAfterInsert) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  fb.Negate(fb.Not(fb.Negate(x)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ScheduleCache cache(temp_dir.path() / "cache");
+  SchedulingOptions options = SchedulingOptions().pipeline_stages(5);
+  TestDelayEstimator delay_estimator;
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<PipelineSchedule> miss,
+                           cache.Lookup(f, options, delay_estimator.name()));
+  EXPECT_FALSE(miss.has_value());
+
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule schedule,
+                           PipelineSchedule::Run(f, delay_estimator, options));
+  XLS_ASSERT_OK(cache.Insert(schedule, options, delay_estimator.name()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<PipelineSchedule> hit,
+                           cache.Lookup(f, options, delay_estimator.name()));
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(hit->length(), schedule.length());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(hit->cycle(node), schedule.cycle(node));
+  }
+
+  // Changing an option or the delay model misses.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      miss, cache.Lookup(f, SchedulingOptions().pipeline_stages(4),
+                         delay_estimator.name()));
+  EXPECT_FALSE(miss.has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(miss, cache.Lookup(f, options, "other_model"));
+  EXPECT_FALSE(miss.has_value());
+}
+
+TEST_F(ScheduleCacheTest, ChangedFunctionMisses) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  fb.Negate(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ScheduleCache cache(temp_dir.path());
+  SchedulingOptions options = SchedulingOptions().pipeline_stages(2);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(f, TestDelayEstimator(), options));
+  XLS_ASSERT_OK(cache.Insert(schedule, options, "test"));
+
+  auto p2 = CreatePackage();
+  FunctionBuilder fb2(TestName(), p2.get());
+  BValue y = fb2.Param("x", p2->GetBitsType(32));
+  fb2.Not(y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, fb2.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<PipelineSchedule> miss,
+                           cache.Lookup(f2, options, "test"));
+  EXPECT_FALSE(miss.has_value());
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,53 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/scheduling_metrics.h"
+
+#include "absl/strings/str_format.h"
+
+namespace xls {
+
+std::string SchedulingMetricsToString(const SchedulingMetricsProto& metrics) {
+  std::string out = absl::StrFormat(
+      "Scheduling time: %dms (clock period %dps)\n",
+      metrics.total_duration_us() / 1000, metrics.clock_period_ps());
+  if (metrics.clock_period_probes_size() > 0) {
+    absl::StrAppendFormat(&out,
+                          "Clock period search: %dms, %d probes:\n",
+                          metrics.clock_period_search_duration_us() / 1000,
+                          metrics.clock_period_probes_size());
+    for (const ClockPeriodProbeProto& probe : metrics.clock_period_probes()) {
+      absl::StrAppendFormat(&out, "  %6dps : %-10s %dms\n",
+                            probe.clock_period_ps(),
+                            probe.feasible() ? "feasible" : "infeasible",
+                            probe.duration_us() / 1000);
+    }
+  }
+  if (metrics.has_lp_variable_count() || metrics.lp_solve_count() > 0) {
+    absl::StrAppendFormat(
+        &out, "LP: %d variables, %d constraints, %d solves in %dms\n",
+        metrics.lp_variable_count(), metrics.lp_constraint_count(),
+        metrics.lp_solve_count(), metrics.lp_solve_duration_us() / 1000);
+  }
+  if (metrics.min_cut_count() > 0) {
+    absl::StrAppendFormat(&out, "Min-cut: %d cuts over %d orderings in %dms\n",
+                          metrics.min_cut_count(),
+                          metrics.min_cut_order_count(),
+                          metrics.min_cut_duration_us() / 1000);
+  }
+  return out;
+}
+
+}  // namespace xls
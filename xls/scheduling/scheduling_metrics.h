@@ -0,0 +1,32 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_SCHEDULING_SCHEDULING_METRICS_H_
+#define XLS_SCHEDULING_SCHEDULING_METRICS_H_
+
+#include <string>
+
+#include "xls/scheduling/scheduling_metrics.pb.h"
+
+namespace xls {
+
+// Returns a human-readable summary of the given metrics. Sections for the
+// clock period search, the LP and the min-cuts are only included if the
+// corresponding metrics are present.
+std::string SchedulingMetricsToString(const SchedulingMetricsProto& metrics);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_SCHEDULING_METRICS_H_
@@ -0,0 +1,70 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/scheduling_metrics.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TEST(SchedulingMetricsTest, ToStringOmitsAbsentSections) {
+  SchedulingMetricsProto metrics;
+  metrics.set_total_duration_us(3000);
+  metrics.set_clock_period_ps(500);
+
+  std::string summary = SchedulingMetricsToString(metrics);
+  EXPECT_THAT(summary, HasSubstr("Scheduling time: 3ms (clock period 500ps)"));
+  EXPECT_THAT(summary, Not(HasSubstr("Clock period search")));
+  EXPECT_THAT(summary, Not(HasSubstr("LP:")));
+  EXPECT_THAT(summary, Not(HasSubstr("Min-cut:")));
+}
+
+TEST(SchedulingMetricsTest, ToStringIncludesAllSections) {
+  SchedulingMetricsProto metrics;
+  metrics.set_total_duration_us(12000);
+  metrics.set_clock_period_ps(250);
+  ClockPeriodProbeProto* probe = metrics.add_clock_period_probes();
+  probe->set_clock_period_ps(200);
+  probe->set_feasible(false);
+  probe->set_duration_us(4000);
+  probe = metrics.add_clock_period_probes();
+  probe->set_clock_period_ps(250);
+  probe->set_feasible(true);
+  probe->set_duration_us(5000);
+  metrics.set_clock_period_search_duration_us(9000);
+  metrics.set_lp_variable_count(40);
+  metrics.set_lp_constraint_count(75);
+  metrics.set_lp_solve_count(3);
+  metrics.set_lp_solve_duration_us(8000);
+  metrics.set_min_cut_order_count(2);
+  metrics.set_min_cut_count(6);
+  metrics.set_min_cut_duration_us(1000);
+
+  std::string summary = SchedulingMetricsToString(metrics);
+  EXPECT_THAT(summary, HasSubstr("Clock period search: 9ms, 2 probes"));
+  EXPECT_THAT(summary, HasSubstr("200ps : infeasible 4ms"));
+  EXPECT_THAT(summary, HasSubstr("250ps : feasible   5ms"));
+  EXPECT_THAT(summary,
+              HasSubstr("LP: 40 variables, 75 constraints, 3 solves in 8ms"));
+  EXPECT_THAT(summary, HasSubstr("Min-cut: 6 cuts over 2 orderings in 1ms"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -21,6 +21,7 @@
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/op.h"
 #include "xls/ir/proc.h"
 
 namespace xls {
@@ -93,6 +94,21 @@ class RecvsFirstSendsLastConstraint {
 using SchedulingConstraint =
     std::variant<IOConstraint, RecvsFirstSendsLastConstraint>;
 
+// A map from operation to the number of cycles over which the operation is
+// spread (its latency). Operations not in the map take a single cycle.
+using OpLatencyMap = absl::flat_hash_map<Op, int64_t>;
+
+// Describes the lookups into literal tables (see IsLiteralTableLookup) which
+// are implemented by read-only memories instead of logic.
+struct MemoryLookupConfig {
+  // Only tables of at least this many bits are mapped to memories.
+  int64_t min_table_bits;
+
+  // The number of cycles from presenting the address to a memory until the
+  // data is available at its registered output.
+  int64_t read_latency = 1;
+};
+
 // Options to use when generating a pipeline schedule. At least a clock period
 // or a pipeline length (or both) must be specified. See
 // https://google.github.io/xls/scheduling/ for details on these options.
@@ -141,6 +157,17 @@ class SchedulingOptions {
     return period_relaxation_percent_;
   }
 
+  // Sets/gets the number of threads the scheduler may use. When no clock
+  // period is specified, candidate periods of the minimum clock period search
+  // are evaluated concurrently, one per thread. The MIN_CUT strategy tries its
+  // cut orderings and performs independent cuts concurrently. If not set,
+  // scheduling is single-threaded.
+  SchedulingOptions& thread_count(int64_t value) {
+    thread_count_ = value;
+    return *this;
+  }
+  std::optional<int64_t> thread_count() const { return thread_count_; }
+
   // Sets/gets the additional delay added to each receive node.
   //
   // TODO(tedhong): 2022-02-11, Update so that this sets/gets the
@@ -162,6 +189,53 @@ class SchedulingOptions {
     return constraints_;
   }
 
+  // Sets/gets the initiation interval (II) of the pipeline, i.e., the number of
+  // cycles between the starts of successive proc iterations. With an II of N
+  // the feedback path from a state parameter to its next state value may span
+  // up to N stages, which permits a shorter clock period for procs whose state
+  // recurrence does not fit in a single cycle at the cost of accepting a new
+  // iteration at most once every N cycles. Only the SDC strategy makes use of
+  // an II greater than one; the schedules of other strategies have an
+  // effective II of one which also satisfies any larger II. If not set, the
+  // II is one (full throughput).
+  SchedulingOptions& initiation_interval(int64_t value) {
+    initiation_interval_ = value;
+    return *this;
+  }
+  std::optional<int64_t> initiation_interval() const {
+    return initiation_interval_;
+  }
+
+  // Marks all operations of kind `op` as multicycle operations spread over
+  // `latency` cycles. A multicycle operation is scheduled in the cycle in which
+  // it reads its operands and its result is available `latency - 1` cycles
+  // later, so its users are scheduled at least that many cycles after it. Its
+  // delay is divided evenly between the cycles it spans, i.e., the operation
+  // is assumed to be implemented by a pipelined operator (or retimed by the
+  // synthesis tool into the pipeline registers which carry its result).
+  // Multicycle operations are supported by the SDC, ASAP and RANDOM
+  // strategies.
+  SchedulingOptions& multicycle_op(Op op, int64_t latency) {
+    multicycle_ops_[op] = latency;
+    return *this;
+  }
+  const OpLatencyMap& multicycle_ops() const { return multicycle_ops_; }
+
+  // Schedules the lookups into literal tables described by `config` as reads
+  // of memories with a registered output: the users of each lookup are
+  // scheduled at least `config.read_latency` cycles after it, and the delay of
+  // the lookup is divided evenly between the cycles. Code generation must be
+  // given the same configuration (see CodegenOptions::memory_lookups) to map
+  // the lookups onto memories. Supported by the SDC, ASAP and RANDOM
+  // strategies.
+  SchedulingOptions& memory_lookups(const MemoryLookupConfig& config) {
+    memory_lookups_ = config;
+    return *this;
+  }
+  std::optional<MemoryLookupConfig> memory_lookups() const {
+    return memory_lookups_;
+  }
+
   // The random seed, which is only used if the scheduler is `RANDOM`.
   SchedulingOptions& seed(int32_t value) {
     seed_ = value;
@@ -175,8 +249,12 @@ class SchedulingOptions {
   std::optional<int64_t> pipeline_stages_;
   std::optional<int64_t> clock_margin_percent_;
   std::optional<int64_t> period_relaxation_percent_;
+  std::optional<int64_t> thread_count_;
   std::optional<int64_t> additional_input_delay_ps_;
+  std::optional<int64_t> initiation_interval_;
   std::vector<SchedulingConstraint> constraints_;
+  OpLatencyMap multicycle_ops_;
+  std::optional<MemoryLookupConfig> memory_lookups_;
   std::optional<int32_t> seed_;
 };
 
@@ -18,19 +18,19 @@
 #include <cmath>
 #include <functional>
 #include <random>
+#include <vector>
 
-#include "absl/container/btree_map.h"
-#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
-#include "xls/data_structures/strongly_connected_components.h"
-#include "xls/data_structures/union_find.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/scheduling/schedule_bounds.h"
@@ -42,129 +42,138 @@ namespace xls {
 
 namespace {
 
-using DelayMap = absl::flat_hash_map<Node*, int64_t>;
-
 // A helper function to compute each node's delay by calling the delay estimator
 absl::StatusOr<DelayMap> ComputeNodeDelays(
     FunctionBase* f, const DelayEstimator& delay_estimator) {
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delays,
+                       delay_estimator.GetOperationDelaysInPs(nodes));
   DelayMap result;
-  for (Node* node : f->nodes()) {
-    XLS_ASSIGN_OR_RETURN(result[node],
-                         delay_estimator.GetOperationDelayInPs(node));
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    result[nodes[i]] = delays[i];
   }
   return result;
 }
 
-// All transitive children (operands, operands of operands, etc.) of the given
-// node.
-absl::btree_set<Node*, Node::NodeIdLessThan> Descendants(Node* root) {
-  std::vector<Node*> stack;
-  stack.push_back(root);
-  absl::btree_set<Node*, Node::NodeIdLessThan> discovered;
-  while (!stack.empty()) {
-    Node* popped = stack.back();
-    stack.pop_back();
-    if (!discovered.contains(popped)) {
-      discovered.insert(popped);
-      for (Node* child : popped->operands()) {
-        stack.push_back(child);
-      }
-    }
-  }
-  return discovered;
+// Returns the number of cycles spanned by `node`.
+int64_t NodeLatency(Node* node, const LatencyMap& node_latencies) {
+  auto it = node_latencies.find(node);
+  return it == node_latencies.end() ? 1 : it->second;
 }
 
-// Returns the minimal set of schedule constraints which ensure that no
-// combinational path in the schedule exceeds `clock_period_ps`. The returned
-// map has a (potentially empty) vector entry for each node in `f`. The map
-// value (vector of nodes) for node `x` is the set of nodes which must be
-// scheduled at least one cycle later than `x`. That is, if `return_value[x]` is
-// `S` then:
+// Returns a set of schedule constraints which ensure that no combinational
+// path in the schedule exceeds `clock_period_ps`. The returned map has a
+// (potentially empty) vector entry for each node in `f`. The map value (vector
+// of nodes) for node `x` is the set of nodes which must be scheduled at least
+// one cycle later than `x`. That is, if `return_value[x]` is `S` then:
 //
-//   cycle(i) + 1 >= cycle(x) for i \in S
+//   cycle(i) >= cycle(x) + 1 for i \in S
 //
-// The set of constraints is a minimal set which guarantees that no
-// combinational path violates the clock period timing. Specifically, `(a, b)`
-// is in the set of returned constraints (ie., `return_value[a]` contains `b`)
-// iff critical-path distance from `a` to `b` including the delay of `a` and `b`
-// is greater than `critical_path_period`, but the critical-path distance of the
-// path *not* including the delay of `b` is *less than* `critical_path_period`.
+// If `x` is a multicycle operation with latency N the nodes in `S` are instead
+// on paths which start at the result of `x` (available in cycle(x) + N - 1) so
+// they must be scheduled at least N cycles later than `x`. Paths do not
+// continue through multicycle operations as their results are registered.
+//
+// A constraint `(a, b)` is generated when the critical-path distance from `a`
+// to `b` including the delay of `a` and `b` is greater than the clock period,
+// but the critical-path distance of the path *not* including the delay of `b`
+// is not. Constraints which are implied by another constraint are pruned:
+// `(a, c)` is omitted if there is a constraint `(a, b)` where `b` is an
+// ancestor of `c` (as cycle(c) >= cycle(b) by the def-use constraints).
+//
+// Rather than computing all-pairs distances, each node only tracks the
+// distances from the sources which are within one clock period upstream of it
+// (the "window" of the node), and a window is freed once all users of its node
+// have been visited. The memory used is therefore proportional to the number
+// of nodes within a clock period of each other rather than quadratic in the
+// size of `f`.
 absl::flat_hash_map<Node*, std::vector<Node*>>
 ComputeCombinationalDelayConstraints(FunctionBase* f, int64_t clock_period_ps,
-                                     const DelayMap& delay_map) {
+                                     const DelayMap& delay_map,
+                                     const LatencyMap& node_latencies) {
   absl::flat_hash_map<Node*, std::vector<Node*>> result;
   result.reserve(f->node_count());
-
-  // Compute all-pairs longest distance between all nodes in `f`. The distance
-  // from node `a` to node `b` is defined as the length of the longest delay
-  // path from `a` to `b` which includes the delay of the path endpoints `a` and
-  // `b`. The all-pairs distance is stored in the map of vectors `node_to_index`
-  // where `node_to_index[y]` holds the critical-path distances from each node
-  // `x` to `y`.
-  absl::flat_hash_map<Node*, std::vector<int64_t>> distances_to_node;
-  distances_to_node.reserve(f->node_count());
-
-  // Compute a map from Node* to the interval [0, node_count). These map values
-  // serve as indices into a flat vector of distances.
-  absl::flat_hash_map<Node*, int32_t> node_to_index;
-  std::vector<Node*> index_to_node(f->node_count());
-  node_to_index.reserve(f->node_count());
-  int32_t index = 0;
   for (Node* node : f->nodes()) {
-    node_to_index[node] = index;
-    index_to_node[index] = node;
-    index++;
-
     // Initialize the constraint map entry to an empty vector.
     result[node];
   }
 
+  // The distance to a node from a source in its window. `distance` is -1 if
+  // every path from the source which is shorter than the clock period has
+  // already been cut by a timing constraint. `covered` indicates that a
+  // timing constraint from the source to an ancestor of (or to) the node
+  // exists so further constraints from the source are implied.
+  struct WindowEntry {
+    int64_t distance;
+    bool covered;
+  };
+  using Window = absl::flat_hash_map<Node*, WindowEntry>;
+  absl::flat_hash_map<Node*, Window> windows;
+  absl::flat_hash_map<Node*, int64_t> unvisited_users;
+  for (Node* node : f->nodes()) {
+    unvisited_users[node] = node->users().size();
+  }
+
+  int64_t constraint_count = 0;
   for (Node* node : TopoSort(f)) {
-    int64_t node_index = node_to_index.at(node);
     int64_t node_delay = delay_map.at(node);
-    std::vector<int64_t> distances = std::vector<int64_t>(f->node_count(), -1);
-
-    // Compute the critical-path distance from `a` to `node` for all nodes `a`
-    // from the distances of `a` to each operand of `node`.
-    for (int64_t operand_i = 0; operand_i < node->operand_count();
-         ++operand_i) {
-      Node* operand = node->operand(operand_i);
-      const std::vector<int64_t>& distances_to_operand =
-          distances_to_node.at(operand);
-      for (int64_t i = 0; i < f->node_count(); ++i) {
-        int64_t operand_distance = distances_to_operand[i];
-        if (operand_distance != -1) {
-          if (distances[i] < operand_distance + node_delay) {
-            distances[i] = operand_distance + node_delay;
-            // Only add a constraint if the delay of `node` results in the
-            // length of the critical-path crossing the `clock_period_ps`
-            // boundary.
-            if (operand_distance <= clock_period_ps &&
-                operand_distance + node_delay > clock_period_ps) {
-              result[index_to_node[i]].push_back(node);
-            }
-          }
+
+    // Compute the critical-path distance to `node` from each source in the
+    // windows of its operands.
+    Window window;
+    for (Node* operand : node->operands()) {
+      for (const auto& [source, entry] : windows.at(operand)) {
+        WindowEntry& merged =
+            window.try_emplace(source, WindowEntry{-1, false}).first->second;
+        if (entry.distance != -1) {
+          merged.distance =
+              std::max(merged.distance, entry.distance + node_delay);
         }
+        merged.covered = merged.covered || entry.covered;
       }
     }
+    for (auto it = window.begin(); it != window.end();) {
+      const auto& [source, entry] = *it;
+      if (entry.distance == -1) {
+        // No path from the source within the clock period continues through
+        // this node.
+        window.erase(it++);
+        continue;
+      }
+      if (entry.distance > clock_period_ps) {
+        // The delay of `node` results in the length of the critical path
+        // crossing the `clock_period_ps` boundary.
+        if (!entry.covered) {
+          result[source].push_back(node);
+          ++constraint_count;
+        }
+        it->second = WindowEntry{-1, true};
+      }
+      ++it;
+    }
+    if (NodeLatency(node, node_latencies) > 1) {
+      window.clear();
+    }
+    if (node_delay <= clock_period_ps) {
+      window[node] = WindowEntry{node_delay, false};
+    }
+    windows[node] = std::move(window);
 
-    distances[node_index] = node_delay;
-    distances_to_node[node] = std::move(distances);
+    for (Node* operand : absl::flat_hash_set<Node*>(node->operands().begin(),
+                                                    node->operands().end())) {
+      if (--unvisited_users.at(operand) == 0) {
+        windows.erase(operand);
+      }
+    }
+    if (node->users().empty()) {
+      windows.erase(node);
+    }
   }
 
+  XLS_VLOG(3) << absl::StrFormat(
+      "%d timing constraints for clock period %dps", constraint_count,
+      clock_period_ps);
   if (XLS_VLOG_IS_ON(4)) {
-    XLS_VLOG(4) << "All-pairs critical-path distances:";
-    for (Node* target : TopoSort(f)) {
-      XLS_VLOG(4) << absl::StrFormat("  distances to %s:", target->GetName());
-      for (int64_t i = 0; i < f->node_count(); ++i) {
-        Node* source = index_to_node[i];
-        XLS_VLOG(4) << absl::StrFormat(
-            "    %s -> %s : %s", source->GetName(), target->GetName(),
-            distances_to_node[target][i] == -1
-                ? "(none)"
-                : absl::StrCat(distances_to_node[target][i]));
-      }
-    }
     XLS_VLOG(4) << absl::StrFormat("Constraints (clock period: %dps):",
                                    clock_period_ps);
     for (Node* node : TopoSort(f)) {
@@ -176,18 +185,30 @@ ComputeCombinationalDelayConstraints(FunctionBase* f, int64_t clock_period_ps,
   return result;
 }
 
-class ConstraintBuilder {
+}  // namespace
+
+// Builds the variables, constraints and objective of an SDC scheduling
+// problem in an MPSolver.
+class SDCConstraintBuilder {
  public:
-  ConstraintBuilder(FunctionBase* func, or_tools::MPSolver* solver,
-                    int64_t pipeline_length, int64_t clock_period_ps,
-                    const sched::ScheduleBounds& bounds,
-                    const DelayMap& delay_map);
+  SDCConstraintBuilder(FunctionBase* func, or_tools::MPSolver* solver,
+                       int64_t pipeline_length, const DelayMap& delay_map,
+                       const LatencyMap& node_latencies);
 
   absl::Status AddDefUseConstraints(Node* node, std::optional<Node*> user);
   absl::Status AddCausalConstraint(Node* node, std::optional<Node*> user);
   absl::Status AddLifetimeConstraint(Node* node, std::optional<Node*> user);
-  absl::Status AddBackedgeConstraints();
-  absl::Status AddTimingConstraints();
+  absl::Status AddBackedgeConstraints(int64_t initiation_interval);
+
+  // Sets the bounds of the cycle variables to the given bounds.
+  void SetBounds(const sched::ScheduleBounds& bounds);
+
+  // Sets the timing constraints to those required for the given clock period.
+  // Timing constraints added for a previous clock period which are not
+  // required for this clock period are relaxed rather than removed so the
+  // model stays structurally the same and the solver can reuse its previous
+  // basis.
+  absl::Status SetTimingConstraints(int64_t clock_period_ps);
   absl::Status AddSchedulingConstraint(const SchedulingConstraint& constraint);
   absl::Status AddIOConstraint(const IOConstraint& constraint);
   absl::Status AddRFSLConstraint(
@@ -195,8 +216,6 @@ class ConstraintBuilder {
 
   absl::Status AddObjective();
 
-  or_tools::MPSolver::ResultStatus Solve() { return solver_->Solve(); }
-
   absl::StatusOr<ScheduleCycleMap> ExtractResult() const;
 
   absl::flat_hash_map<Node*, or_tools::MPVariable*> GetCycleVars() const {
@@ -207,6 +226,12 @@ class ConstraintBuilder {
     return lifetime_var_;
   }
 
+  // Returns the number of timing constraints in the model which are relaxed
+  // for the most recent clock period.
+  int64_t relaxed_timing_constraint_count() const {
+    return timing_constraints_.size() - active_timing_constraint_count_;
+  }
+
  private:
   or_tools::MPConstraint* DiffLessThanConstraint(Node* x, Node* y,
                                                  int64_t limit,
@@ -248,8 +273,8 @@ class ConstraintBuilder {
   FunctionBase* func_;
   or_tools::MPSolver* solver_;
   int64_t pipeline_length_;
-  int64_t clock_period_ps_;
   const DelayMap& delay_map_;
+  LatencyMap node_latencies_;
   double infinity_;
 
   // Node's cycle after scheduling
@@ -263,25 +288,31 @@ class ConstraintBuilder {
   // graph.
   or_tools::MPVariable* cycle_at_sinknode_;
 
-  // A cache of the delay constraints.
-  absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints_;
+  // The timing constraints added so far indexed by (source, target). A
+  // constraint requires `target` to be scheduled at least one cycle after
+  // `source` (at least N cycles after a multicycle `source` of latency N).
+  absl::flat_hash_map<std::pair<Node*, Node*>, or_tools::MPConstraint*>
+      timing_constraints_;
+
+  // Number of entries in `timing_constraints_` required by the most recent
+  // clock period.
+  int64_t active_timing_constraint_count_ = 0;
 };
 
-ConstraintBuilder::ConstraintBuilder(FunctionBase* func,
-                                     or_tools::MPSolver* solver,
-                                     int64_t pipeline_length,
-                                     int64_t clock_period_ps,
-                                     const sched::ScheduleBounds& bounds,
-                                     const DelayMap& delay_map)
+SDCConstraintBuilder::SDCConstraintBuilder(FunctionBase* func,
+                                           or_tools::MPSolver* solver,
+                                           int64_t pipeline_length,
+                                           const DelayMap& delay_map,
+                                           const LatencyMap& node_latencies)
     : func_(func),
       solver_(solver),
       pipeline_length_(pipeline_length),
-      clock_period_ps_(clock_period_ps),
       delay_map_(delay_map),
+      node_latencies_(node_latencies),
       infinity_(solver->infinity()) {
   for (Node* node : func_->nodes()) {
     cycle_var_[node] =
-        solver_->MakeNumVar(bounds.lb(node), bounds.ub(node), node->GetName());
+        solver_->MakeNumVar(0.0, pipeline_length_ - 1, node->GetName());
     lifetime_var_[node] = solver_->MakeNumVar(
         0.0, infinity_, absl::StrFormat("lifetime_%s", node->GetName()));
   }
@@ -289,14 +320,14 @@ ConstraintBuilder::ConstraintBuilder(FunctionBase* func,
       solver->MakeNumVar(-infinity_, infinity_, "cycle_at_sinknode");
 }
 
-absl::Status ConstraintBuilder::AddDefUseConstraints(
+absl::Status SDCConstraintBuilder::AddDefUseConstraints(
     Node* node, std::optional<Node*> user) {
   XLS_RETURN_IF_ERROR(AddCausalConstraint(node, user));
   XLS_RETURN_IF_ERROR(AddLifetimeConstraint(node, user));
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddCausalConstraint(Node* node,
+absl::Status SDCConstraintBuilder::AddCausalConstraint(Node* node,
                                                     std::optional<Node*> user) {
   or_tools::MPVariable* cycle_at_node = cycle_var_.at(node);
   or_tools::MPVariable* cycle_at_user =
@@ -304,21 +335,25 @@ absl::Status ConstraintBuilder::AddCausalConstraint(Node* node,
 
   std::string user_str = user.has_value() ? user.value()->GetName() : "«sink»";
 
-  // Constraint: cycle[node] - cycle[node_user] <= 0
+  // The result of a multicycle operation is available `latency - 1` cycles
+  // after the operation is scheduled.
+  int64_t min_distance = NodeLatency(node, node_latencies_) - 1;
+
+  // Constraint: cycle[node] - cycle[node_user] <= -min_distance
   or_tools::MPConstraint* causal = solver_->MakeRowConstraint(
-      -infinity_, 0.0,
+      -infinity_, -min_distance,
       absl::StrFormat("causal_%s_%s", node->GetName(), user_str));
   causal->SetCoefficient(cycle_at_node, 1);
   causal->SetCoefficient(cycle_at_user, -1);
 
   XLS_VLOG(2) << "Setting causal constraint: "
-              << absl::StrFormat("cycle[%s] - cycle[%s] ≥ 0", user_str,
-                                 node->GetName());
+              << absl::StrFormat("cycle[%s] - cycle[%s] ≥ %d", user_str,
+                                 node->GetName(), min_distance);
 
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddLifetimeConstraint(
+absl::Status SDCConstraintBuilder::AddLifetimeConstraint(
     Node* node, std::optional<Node*> user) {
   or_tools::MPVariable* cycle_at_node = cycle_var_.at(node);
   or_tools::MPVariable* lifetime_at_node = lifetime_var_.at(node);
@@ -342,86 +377,79 @@ absl::Status ConstraintBuilder::AddLifetimeConstraint(
   return absl::OkStatus();
 }
 
-// This ensures that state backedges don't span more than one cycle, which is
-// necessary while II = 1.
-absl::Status ConstraintBuilder::AddBackedgeConstraints() {
+// This ensures that each state backedge spans fewer than `initiation_interval`
+// cycles. A state element's next value must be computed no earlier than its
+// state parameter is read (so an iteration never overwrites state it has yet
+// to read) and at most `initiation_interval - 1` cycles later (so the value is
+// written back before the next iteration reads it).
+//
+// With an initiation interval of one this forces each state parameter into the
+// same cycle as its next state value. Transitively, the state elements of each
+// strongly connected component of the state dependence graph are then all
+// scheduled in the same cycle.
+absl::Status SDCConstraintBuilder::AddBackedgeConstraints(
+    int64_t initiation_interval) {
   Proc* proc = dynamic_cast<Proc*>(func_);
   if (proc == nullptr) {
     return absl::OkStatus();
   }
+  XLS_RET_CHECK_GE(initiation_interval, 1);
 
-  using StateIndex = int64_t;
-
-  absl::flat_hash_set<Node*> params(proc->StateParams().begin(),
-                                    proc->StateParams().end());
-
-  // This constructs the state dependence graph, which is defined in the
-  // following way:
-  //
-  // First, construct a bipartite graph where nodes are either state params or
-  // next state nodes, and there is an edge from a state param to a next state
-  // node iff there is a path between them in the DFG. For example, this might
-  // look like `{(p1, n1), (p2, n1), (p2, n2), (p3, n3)}`.
-  //
-  // Then, identify each param node with its corresponding next node.
-  // Using the previous example, this would look like
-  // `{(v1, v1), (v2, v1), (v2, v2), (v3, v3)}`.
-  absl::btree_map<StateIndex, absl::btree_set<StateIndex>> graph;
-  for (StateIndex target = 0; target < proc->GetStateElementCount(); ++target) {
-    for (Node* param : Descendants(proc->GetNextStateElement(target))) {
-      if (!params.contains(param)) {
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(StateIndex source, proc->GetStateParamIndex(
-                                                  dynamic_cast<Param*>(param)));
-      graph[source].insert(target);
-    }
-  }
-
-  // A strongly connected component in the state dependence graph is a set of
-  // state params / next state nodes that must be scheduled in the same cycle.
-  std::vector<absl::btree_set<StateIndex>> sccs =
-      StronglyConnectedComponents<StateIndex>(graph);
-  for (const absl::btree_set<StateIndex>& scc : sccs) {
-    absl::btree_set<Node*, Node::NodeIdLessThan> nodes;
-    for (const StateIndex& index : scc) {
-      nodes.insert(proc->GetStateParam(index));
-      nodes.insert(proc->GetNextStateElement(index));
-    }
-    Node* rep = *(nodes.begin());
-    for (Node* other : nodes) {
-      if (rep == other) {
-        continue;
-      }
-      DiffEqualsConstraint(rep, other, 0, "backedge");
-      XLS_VLOG(2) << "Setting backedge constraint: "
-                  << absl::StrFormat("cycle[%s] = cycle[%s]", rep->GetName(),
-                                     other->GetName());
+  for (int64_t index = 0; index < proc->GetStateElementCount(); ++index) {
+    Node* param = proc->GetStateParam(index);
+    Node* next = proc->GetNextStateElement(index);
+    if (param == next) {
+      continue;
     }
+    DiffGreaterThanConstraint(next, param, 0, "backedge");
+    DiffLessThanConstraint(next, param, initiation_interval - 1, "backedge");
+    XLS_VLOG(2) << "Setting backedge constraint: "
+                << absl::StrFormat("0 ≤ cycle[%s] - cycle[%s] ≤ %d",
+                                   next->GetName(), param->GetName(),
+                                   initiation_interval - 1);
   }
 
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddTimingConstraints() {
-  if (delay_constraints_.empty()) {
-    delay_constraints_ = ComputeCombinationalDelayConstraints(
-        func_, clock_period_ps_, delay_map_);
+void SDCConstraintBuilder::SetBounds(const sched::ScheduleBounds& bounds) {
+  for (Node* node : func_->nodes()) {
+    cycle_var_.at(node)->SetBounds(bounds.lb(node), bounds.ub(node));
   }
+}
 
+absl::Status SDCConstraintBuilder::SetTimingConstraints(
+    int64_t clock_period_ps) {
+  absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints =
+      ComputeCombinationalDelayConstraints(func_, clock_period_ps, delay_map_,
+                                           node_latencies_);
+
+  for (auto& [nodes, constraint] : timing_constraints_) {
+    constraint->SetUB(infinity_);
+  }
+  active_timing_constraint_count_ = 0;
   for (Node* source : func_->nodes()) {
-    for (Node* target : delay_constraints_.at(source)) {
-      DiffGreaterThanConstraint(target, source, 1, "timing");
+    int64_t min_distance = NodeLatency(source, node_latencies_);
+    for (Node* target : delay_constraints.at(source)) {
+      ++active_timing_constraint_count_;
+      auto [it, inserted] =
+          timing_constraints_.try_emplace({source, target}, nullptr);
+      if (inserted) {
+        it->second =
+            DiffGreaterThanConstraint(target, source, min_distance, "timing");
+      } else {
+        it->second->SetUB(-min_distance);
+      }
       XLS_VLOG(2) << "Setting timing constraint: "
-                  << absl::StrFormat("1 ≤ %s - %s", target->GetName(),
-                                     source->GetName());
+                  << absl::StrFormat("%d ≤ %s - %s", min_distance,
+                                     target->GetName(), source->GetName());
     }
   }
 
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddSchedulingConstraint(
+absl::Status SDCConstraintBuilder::AddSchedulingConstraint(
     const SchedulingConstraint& constraint) {
   if (std::holds_alternative<IOConstraint>(constraint)) {
     return AddIOConstraint(std::get<IOConstraint>(constraint));
@@ -433,7 +461,7 @@ absl::Status ConstraintBuilder::AddSchedulingConstraint(
   return absl::InternalError("Unhandled scheduling constraint type");
 }
 
-absl::Status ConstraintBuilder::AddIOConstraint(
+absl::Status SDCConstraintBuilder::AddIOConstraint(
     const IOConstraint& constraint) {
   // Map from channel name to set of nodes that send/receive on that channel.
   absl::flat_hash_map<std::string, std::vector<Node*>> channel_to_nodes;
@@ -478,7 +506,7 @@ absl::Status ConstraintBuilder::AddIOConstraint(
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddRFSLConstraint(
+absl::Status SDCConstraintBuilder::AddRFSLConstraint(
     const RecvsFirstSendsLastConstraint& constraint) {
   for (Node* node : func_->nodes()) {
     if (node->Is<Receive>()) {
@@ -504,7 +532,7 @@ absl::Status ConstraintBuilder::AddRFSLConstraint(
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddObjective() {
+absl::Status SDCConstraintBuilder::AddObjective() {
   or_tools::MPObjective* objective = solver_->MutableObjective();
   for (Node* node : func_->nodes()) {
     // This acts as a tie-breaker for underconstrained problems.
@@ -519,7 +547,7 @@ absl::Status ConstraintBuilder::AddObjective() {
   return absl::OkStatus();
 }
 
-absl::StatusOr<ScheduleCycleMap> ConstraintBuilder::ExtractResult() const {
+absl::StatusOr<ScheduleCycleMap> SDCConstraintBuilder::ExtractResult() const {
   ScheduleCycleMap cycle_map;
   for (Node* node : func_->nodes()) {
     double cycle = cycle_var_.at(node)->solution_value();
@@ -532,31 +560,31 @@ absl::StatusOr<ScheduleCycleMap> ConstraintBuilder::ExtractResult() const {
   return cycle_map;
 }
 
-}  // namespace
-
-absl::StatusOr<ScheduleCycleMap> SDCScheduler(
-    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
-    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints,
-    bool check_feasibility) {
-  XLS_VLOG(3) << "SDCScheduler()";
+/* static */ absl::StatusOr<std::unique_ptr<SDCSchedulingModel>>
+SDCSchedulingModel::Create(FunctionBase* f, int64_t pipeline_stages,
+                           const DelayEstimator& delay_estimator,
+                           absl::Span<const SchedulingConstraint> constraints,
+                           bool check_feasibility,
+                           int64_t initiation_interval,
+                           const LatencyMap& node_latencies) {
+  XLS_VLOG(3) << "SDCSchedulingModel::Create()";
   XLS_VLOG(3) << "  pipeline stages = " << pipeline_stages;
+  XLS_VLOG(3) << "  initiation interval = " << initiation_interval;
   XLS_VLOG_LINES(4, f->DumpIr());
 
-  XLS_VLOG(4) << "Initial bounds:";
-  XLS_VLOG_LINES(4, bounds->ToString());
-
-  std::unique_ptr<or_tools::MPSolver> solver(
-      or_tools::MPSolver::CreateSolver("GLOP"));
-  if (!solver) {
+  auto model = absl::WrapUnique(new SDCSchedulingModel());
+  model->solver_.reset(or_tools::MPSolver::CreateSolver("GLOP"));
+  if (!model->solver_) {
     return absl::UnavailableError("GLOP solver unavailable.");
   }
 
-  XLS_ASSIGN_OR_RETURN(DelayMap delay_map,
+  XLS_ASSIGN_OR_RETURN(model->delay_map_,
                        ComputeNodeDelays(f, delay_estimator));
 
-  ConstraintBuilder builder(f, solver.get(), pipeline_stages, clock_period_ps,
-                            *bounds, delay_map);
+  model->builder_ = std::make_unique<SDCConstraintBuilder>(
+      f, model->solver_.get(), pipeline_stages, model->delay_map_,
+      node_latencies);
+  SDCConstraintBuilder& builder = *model->builder_;
 
   for (const SchedulingConstraint& constraint : constraints) {
     XLS_RETURN_IF_ERROR(builder.AddSchedulingConstraint(constraint));
@@ -571,21 +599,83 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler(
     }
   }
 
-  XLS_RETURN_IF_ERROR(builder.AddTimingConstraints());
-  XLS_RETURN_IF_ERROR(builder.AddBackedgeConstraints());
+  XLS_RETURN_IF_ERROR(builder.AddBackedgeConstraints(initiation_interval));
 
   if (!check_feasibility) {
     XLS_RETURN_IF_ERROR(builder.AddObjective());
   }
+  return std::move(model);
+}
+
+SDCSchedulingModel::~SDCSchedulingModel() = default;
 
-  or_tools::MPSolver::ResultStatus status = builder.Solve();
+absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::Solve(
+    int64_t clock_period_ps, const sched::ScheduleBounds& bounds) {
+  XLS_VLOG(3) << "SDCSchedulingModel::Solve()";
+  XLS_VLOG(3) << "  clock period = " << clock_period_ps << "ps";
+  XLS_VLOG(4) << "Bounds:";
+  XLS_VLOG_LINES(4, bounds.ToString());
+
+  builder_->SetBounds(bounds);
+  XLS_RETURN_IF_ERROR(builder_->SetTimingConstraints(clock_period_ps));
+
+  if (solve_count_ == 1) {
+    // Presolve transforms the problem differently for each clock period which
+    // prevents GLOP from restarting from the basis of the previous solve.
+    // Disable it for all solves after the first.
+    XLS_RET_CHECK(solver_->SetSolverSpecificParametersAsString(
+        "use_preprocessing: false"));
+  }
+  or_tools::MPSolverParameters parameters;
+  parameters.SetIntegerParam(
+      or_tools::MPSolverParameters::INCREMENTALITY,
+      or_tools::MPSolverParameters::INCREMENTALITY_ON);
+  absl::Time start = absl::Now();
+  or_tools::MPSolver::ResultStatus status = solver_->Solve(parameters);
+  solve_duration_ += absl::Now() - start;
+  ++solve_count_;
 
   if (status != or_tools::MPSolver::OPTIMAL) {
     XLS_VLOG(1) << "SDCScheduler failed with " << status;
     return absl::InternalError("The problem does not have an optimal solution");
   }
 
-  return builder.ExtractResult();
+  return builder_->ExtractResult();
+}
+
+int64_t SDCSchedulingModel::variable_count() const {
+  return solver_->NumVariables();
+}
+
+int64_t SDCSchedulingModel::constraint_count() const {
+  return solver_->NumConstraints() -
+         builder_->relaxed_timing_constraint_count();
+}
+
+absl::StatusOr<ScheduleCycleMap> SDCScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints, bool check_feasibility,
+    SchedulingMetricsProto* metrics, int64_t initiation_interval,
+    const LatencyMap& node_latencies) {
+  XLS_VLOG(3) << "SDCScheduler()";
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<SDCSchedulingModel> model,
+      SDCSchedulingModel::Create(f, pipeline_stages, delay_estimator,
+                                 constraints, check_feasibility,
+                                 initiation_interval, node_latencies));
+  absl::StatusOr<ScheduleCycleMap> cycle_map =
+      model->Solve(clock_period_ps, *bounds);
+  if (metrics != nullptr) {
+    metrics->set_lp_variable_count(model->variable_count());
+    metrics->set_lp_constraint_count(model->constraint_count());
+    metrics->set_lp_solve_count(metrics->lp_solve_count() +
+                                model->solve_count());
+    metrics->set_lp_solve_duration_us(
+        metrics->lp_solve_duration_us() +
+        absl::ToInt64Microseconds(model->solve_duration()));
+  }
+  return cycle_map;
 }
 
 }  // namespace xls
@@ -15,18 +15,79 @@
 #ifndef XLS_SCHEDULING_SDC_SCHEDULER_H_
 #define XLS_SCHEDULING_SDC_SCHEDULER_H_
 
+#include <cstdint>
+#include <memory>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/proc.h"
 #include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_metrics.pb.h"
 #include "xls/scheduling/scheduling_options.h"
 
+namespace operations_research {
+class MPSolver;
+}  // namespace operations_research
+
 namespace xls {
 
+class SDCConstraintBuilder;
+
+using DelayMap = absl::flat_hash_map<Node*, int64_t>;
+
+// Map from multicycle node to the number of cycles it spans.
+using LatencyMap = absl::flat_hash_map<Node*, int64_t>;
+
+// An SDC scheduling problem for a fixed function, pipeline length and set of
+// scheduling constraints which can be solved repeatedly for different clock
+// periods and bounds. The LP model is built once and each solve only updates
+// the variable bounds and the timing constraints, so the solver can warm-start
+// from the basis of the previous solve. This makes searches over the clock
+// period (e.g., the binary search in FindMinimumClockPeriod) much cheaper than
+// calling SDCScheduler for each candidate period.
+class SDCSchedulingModel {
+ public:
+  // See SDCScheduler for a description of the arguments.
+  static absl::StatusOr<std::unique_ptr<SDCSchedulingModel>> Create(
+      FunctionBase* f, int64_t pipeline_stages,
+      const DelayEstimator& delay_estimator,
+      absl::Span<const SchedulingConstraint> constraints,
+      bool check_feasibility = false, int64_t initiation_interval = 1,
+      const LatencyMap& node_latencies = {});
+  ~SDCSchedulingModel();
+
+  // Solves the problem for the given clock period with the cycle of each node
+  // restricted to the given bounds. Returns an error if the problem is
+  // infeasible.
+  absl::StatusOr<ScheduleCycleMap> Solve(int64_t clock_period_ps,
+                                         const sched::ScheduleBounds& bounds);
+
+  // Returns the number of variables and constraints in the LP as of the most
+  // recent solve. Timing constraints relaxed for the most recent clock period
+  // are not counted.
+  int64_t variable_count() const;
+  int64_t constraint_count() const;
+
+  // Returns the number of solves performed and their total wall-clock time.
+  int64_t solve_count() const { return solve_count_; }
+  absl::Duration solve_duration() const { return solve_duration_; }
+
+ private:
+  SDCSchedulingModel() = default;
+
+  DelayMap delay_map_;
+  std::unique_ptr<operations_research::MPSolver> solver_;
+  std::unique_ptr<SDCConstraintBuilder> builder_;
+  int64_t solve_count_ = 0;
+  absl::Duration solve_duration_;
+};
+
 // Schedule to minimize the total pipeline registers using SDC scheduling
 // the constraint matrix is totally unimodular, this ILP problem can be solved
 // by LP.
@@ -35,6 +96,20 @@ namespace xls {
 // the LP solver will merely attempt to show that the generated set of
 // constraints is feasible, rather than find an register-optimal schedule.
 //
+// If `metrics` is given, the size of the LP and the solver time are recorded
+// in it.
+//
+// For procs, the next state value of each state element is scheduled no
+// earlier than its state parameter and less than `initiation_interval` cycles
+// after it, so that the value is written back before the state parameter is
+// read by the next iteration which starts `initiation_interval` cycles later.
+//
+// Users of a node with latency N in `node_latencies` (see
+// SchedulingOptions::multicycle_op) are scheduled at least N - 1 cycles after
+// it, and combinational paths starting at its result at least N cycles after
+// it. The given delay estimator should return the delay of a single cycle of
+// each multicycle node.
+//
 // References:
 //   - Cong, Jason, and Zhiru Zhang. "An efficient and versatile scheduling
 //   algorithm based on SDC formulation." 2006 43rd ACM/IEEE Design Automation
@@ -46,7 +121,9 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler(
     FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
     absl::Span<const SchedulingConstraint> constraints,
-    bool check_feasibility = false);
+    bool check_feasibility = false,
+    SchedulingMetricsProto* metrics = nullptr, int64_t initiation_interval = 1,
+    const LatencyMap& node_latencies = {});
 
 }  // namespace xls
 
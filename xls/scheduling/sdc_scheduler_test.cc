@@ -0,0 +1,184 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/sdc_scheduler.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/scheduling/schedule_bounds.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOk;
+using ::testing::Not;
+
+class SDCSchedulerTest : public IrTestBase {
+ protected:
+  // Returns bounds which restrict every node of `f` to the first
+  // `pipeline_stages` cycles.
+  absl::StatusOr<sched::ScheduleBounds> MakeBounds(FunctionBase* f,
+                                                   int64_t clock_period_ps,
+                                                   int64_t pipeline_stages) {
+    sched::ScheduleBounds bounds(f, clock_period_ps, delay_estimator_);
+    for (Node* node : f->nodes()) {
+      XLS_RETURN_IF_ERROR(bounds.TightenNodeUb(node, pipeline_stages - 1));
+    }
+    return bounds;
+  }
+
+  // Returns the number of pipeline register bits required by the schedule.
+  // The LP may have several optimal solutions so schedules are compared by
+  // their objective rather than cycle by cycle.
+  static int64_t RegisterBitCount(FunctionBase* f,
+                                  const ScheduleCycleMap& cycle_map) {
+    int64_t bits = 0;
+    for (Node* node : f->nodes()) {
+      int64_t last_use = cycle_map.at(node);
+      for (Node* user : node->users()) {
+        last_use = std::max(last_use, cycle_map.at(user));
+      }
+      bits += node->GetType()->GetFlatBitCount() *
+              (last_use - cycle_map.at(node));
+    }
+    return bits;
+  }
+
+  // Returns the longest combinational path delay within any single cycle of
+  // the schedule.
+  int64_t MaxStageDelay(FunctionBase* f, const ScheduleCycleMap& cycle_map) {
+    absl::flat_hash_map<Node*, int64_t> path_delay;
+    int64_t max_delay = 0;
+    for (Node* node : TopoSort(f)) {
+      int64_t operand_delay = 0;
+      for (Node* operand : node->operands()) {
+        if (cycle_map.at(operand) == cycle_map.at(node)) {
+          operand_delay = std::max(operand_delay, path_delay.at(operand));
+        }
+      }
+      path_delay[node] =
+          operand_delay + delay_estimator_.GetOperationDelayInPs(node).value();
+      max_delay = std::max(max_delay, path_delay[node]);
+    }
+    return max_delay;
+  }
+
+  TestDelayEstimator delay_estimator_;
+};
+
+TEST_F(SDCSchedulerTest, ModelResolvesMatchFreshSchedules) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue sum = fb.Add(x, y);
+  fb.Negate(fb.Not(fb.Negate(fb.Not(sum))));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  constexpr int64_t kStages = 5;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SDCSchedulingModel> model,
+      SDCSchedulingModel::Create(f, kStages, delay_estimator_,
+                                 /*constraints=*/{}));
+  // Solve for the clock periods in an order which both tightens and relaxes
+  // the timing constraints between solves.
+  for (int64_t clock_period_ps : {5, 1, 3, 2, 5, 1}) {
+    XLS_ASSERT_OK_AND_ASSIGN(sched::ScheduleBounds bounds,
+                             MakeBounds(f, clock_period_ps, kStages));
+    XLS_ASSERT_OK_AND_ASSIGN(ScheduleCycleMap resolved,
+                             model->Solve(clock_period_ps, bounds));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        ScheduleCycleMap fresh,
+        SDCScheduler(f, kStages, clock_period_ps, delay_estimator_, &bounds,
+                     /*constraints=*/{}));
+    for (Node* node : f->nodes()) {
+      for (Node* operand : node->operands()) {
+        EXPECT_LE(resolved.at(operand), resolved.at(node));
+      }
+    }
+    EXPECT_EQ(RegisterBitCount(f, resolved), RegisterBitCount(f, fresh))
+        << "clock period: " << clock_period_ps;
+  }
+}
+
+TEST_F(SDCSchedulerTest, ReconvergentPathsMeetTiming) {
+  // A lattice of adds in which every node is reachable along many paths of
+  // different lengths. Timing constraints implied by other constraints are
+  // pruned which must not result in a schedule violating timing.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> row;
+  for (int64_t i = 0; i < 4; ++i) {
+    row.push_back(fb.Param(absl::StrCat("x", i), p->GetBitsType(32)));
+  }
+  for (int64_t depth = 0; depth < 8; ++depth) {
+    std::vector<BValue> next;
+    for (int64_t i = 0; i < row.size(); ++i) {
+      BValue sum = fb.Add(row[i], row[(i + 1) % row.size()]);
+      next.push_back(depth % 3 == 0 ? fb.Negate(sum) : sum);
+    }
+    row = std::move(next);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Concat(row)));
+
+  constexpr int64_t kStages = 6;
+  for (int64_t clock_period_ps : {2, 3, 4}) {
+    XLS_ASSERT_OK_AND_ASSIGN(sched::ScheduleBounds bounds,
+                             MakeBounds(f, clock_period_ps, kStages));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        ScheduleCycleMap cycle_map,
+        SDCScheduler(f, kStages, clock_period_ps, delay_estimator_, &bounds,
+                     /*constraints=*/{}));
+    EXPECT_LE(MaxStageDelay(f, cycle_map), clock_period_ps);
+  }
+}
+
+TEST_F(SDCSchedulerTest, ModelRecoversFromInfeasiblePeriod) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  fb.Not(fb.Negate(fb.Not(x)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  constexpr int64_t kStages = 2;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SDCSchedulingModel> model,
+      SDCSchedulingModel::Create(f, kStages, delay_estimator_,
+                                 /*constraints=*/{},
+                                 /*check_feasibility=*/true));
+  XLS_ASSERT_OK_AND_ASSIGN(sched::ScheduleBounds bounds,
+                           MakeBounds(f, /*clock_period_ps=*/1, kStages));
+  // Three unit-delay operations do not fit in two stages of 1ps but do fit in
+  // two stages of 2ps.
+  EXPECT_THAT(model->Solve(/*clock_period_ps=*/1, bounds), Not(IsOk()));
+  EXPECT_THAT(model->Solve(/*clock_period_ps=*/2, bounds), IsOk());
+  EXPECT_THAT(model->Solve(/*clock_period_ps=*/1, bounds), Not(IsOk()));
+  EXPECT_THAT(model->Solve(/*clock_period_ps=*/3, bounds), IsOk());
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,12 +14,18 @@
 
 #include "xls/simulation/module_simulator.h"
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "xls/codegen/flattening.h"
+#include "xls/common/thread.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
@@ -119,6 +125,67 @@ ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
     return absl::InvalidArgumentError("Expected clock in signature");
   }
 
+  const int64_t shard_count = std::min(
+      max_concurrent_simulations_,
+      std::max(int64_t{1}, static_cast<int64_t>(inputs.size()) /
+                               kMinInputsPerShard));
+  std::vector<std::vector<BitsMap>> outputs;
+  if (shard_count <= 1) {
+    XLS_ASSIGN_OR_RETURN(std::vector<BitsMap> shard_outputs, RunShard(inputs));
+    outputs.push_back(std::move(shard_outputs));
+  } else {
+    // Shards are contiguous ranges of the inputs. Each is simulated on its own
+    // thread, the first on the calling thread.
+    outputs.resize(shard_count);
+    std::vector<absl::Status> statuses(shard_count);
+    auto run_shard = [&](int64_t shard) {
+      const int64_t begin = inputs.size() * shard / shard_count;
+      const int64_t end = inputs.size() * (shard + 1) / shard_count;
+      absl::StatusOr<std::vector<BitsMap>> shard_outputs =
+          RunShard(inputs.subspan(begin, end - begin));
+      if (shard_outputs.ok()) {
+        outputs[shard] = std::move(shard_outputs).value();
+      } else {
+        statuses[shard] = shard_outputs.status();
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t shard = 1; shard < shard_count; ++shard) {
+      threads.push_back(
+          std::make_unique<Thread>([&run_shard, shard] { run_shard(shard); }));
+    }
+    run_shard(0);
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+    for (const absl::Status& status : statuses) {
+      XLS_RETURN_IF_ERROR(status);
+    }
+  }
+
+  std::vector<BitsMap> results;
+  results.reserve(inputs.size());
+  for (std::vector<BitsMap>& shard_outputs : outputs) {
+    for (BitsMap& output : shard_outputs) {
+      results.push_back(std::move(output));
+    }
+  }
+
+  if (XLS_VLOG_IS_ON(1)) {
+    XLS_VLOG(1) << "Results:\n";
+    for (int64_t i = 0; i < results.size(); ++i) {
+      XLS_VLOG(1) << "  Set " << i << ":";
+      for (const auto& pair : results[i]) {
+        XLS_VLOG(1) << "    " << pair.first << " : " << pair.second;
+      }
+    }
+  }
+
+  return results;
+}
+
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+ModuleSimulator::RunShard(absl::Span<const BitsMap> inputs) const {
   ModuleTestbench tb(verilog_text_, file_type_, signature_, simulator_,
                      includes_);
 
@@ -267,16 +334,6 @@ ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
     }
   }
 
-  if (XLS_VLOG_IS_ON(1)) {
-    XLS_VLOG(1) << "Results:\n";
-    for (int64_t i = 0; i < outputs.size(); ++i) {
-      XLS_VLOG(1) << "  Set " << i << ":";
-      for (const auto& pair : outputs[i]) {
-        XLS_VLOG(1) << "    " << pair.first << " : " << pair.second;
-      }
-    }
-  }
-
   return outputs;
 }
 
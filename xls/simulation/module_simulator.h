@@ -15,6 +15,10 @@
 #ifndef XLS_SIMULATION_MODULE_SIMULATOR_H_
 #define XLS_SIMULATION_MODULE_SIMULATOR_H_
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/module_signature.h"
@@ -57,7 +61,8 @@ class ModuleSimulator {
 
   // Runs the given batch of argument values through the module with a single
   // invocation of the Verilog simulator. Generally, this is much faster than
-  // running via separate calls to Run.
+  // running via separate calls to Run. Large batches may be split across
+  // several concurrent invocations, see SetMaxConcurrentSimulations.
   absl::StatusOr<std::vector<BitsMap>> RunBatched(
       absl::Span<const BitsMap> inputs) const;
 
@@ -70,7 +75,22 @@ class ModuleSimulator {
   // Overload which accepts arguments as a Span.
   absl::StatusOr<Value> Run(absl::Span<const Value> inputs) const;
 
+  // Sets the maximum number of Verilog simulator processes which RunBatched
+  // runs concurrently. A batch is split into contiguous shards of at least
+  // kMinInputsPerShard inputs, each simulated by its own testbench which
+  // resets the module first. Defaults to 1, i.e., no sharding.
+  void SetMaxConcurrentSimulations(int64_t count) {
+    max_concurrent_simulations_ = count;
+  }
+
+  static constexpr int64_t kMinInputsPerShard = 16;
+
  private:
+  // Runs the given inputs, which have been validated, through the module with
+  // a single invocation of the Verilog simulator.
+  absl::StatusOr<std::vector<BitsMap>> RunShard(
+      absl::Span<const BitsMap> inputs) const;
+
   // Deassert all control inputs on the module.
   absl::Status DeassertControlSignals(ModuleTestbench* tb) const;
 
@@ -82,6 +102,7 @@ class ModuleSimulator {
   FileType file_type_;
   const VerilogSimulator* simulator_;
   absl::Span<const VerilogInclude> includes_;
+  int64_t max_concurrent_simulations_ = 1;
 };
 
 }  // namespace verilog
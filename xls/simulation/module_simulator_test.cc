@@ -156,6 +156,26 @@ TEST_P(ModuleSimulatorTest, FixedLatencyBatched) {
   EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(14, 8))));
 }
 
+TEST_P(ModuleSimulatorTest, FixedLatencyBatchedSharded) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeFixedLatencyModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+  simulator.SetMaxConcurrentSimulations(4);
+
+  std::vector<ModuleSimulator::BitsMap> inputs;
+  for (int64_t i = 0; i < 4 * ModuleSimulator::kMinInputsPerShard + 3; ++i) {
+    inputs.push_back({{"x", UBits(i, 8)}});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ModuleSimulator::BitsMap> outputs,
+                           simulator.RunBatched(inputs));
+
+  ASSERT_EQ(outputs.size(), inputs.size());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    EXPECT_THAT(outputs[i], ElementsAre(Pair("out", UBits((2 * i) % 256, 8))))
+        << "input: " << i;
+  }
+}
+
 TEST_P(ModuleSimulatorTest, CombinationalBatched) {
   XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeCombinationalModule());
   ModuleSimulator simulator =
@@ -12,16 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <filesystem>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/file/temp_directory.h"
-#include "xls/common/file/temp_file.h"
 #include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
@@ -68,36 +71,47 @@ absl::StatusOr<std::pair<std::string, std::string>> InvokeVvp(
   return InvokeSubprocess(args_vec);
 }
 
-class IcarusVerilogSimulator : public VerilogSimulator {
+// A design compiled by iverilog into a vvp file in a temporary directory.
+class IcarusVerilogDesign : public CompiledVerilogDesign {
  public:
+  IcarusVerilogDesign(TempDirectory temp_dir, std::filesystem::path vvp_path)
+      : temp_dir_(std::move(temp_dir)), vvp_path_(std::move(vvp_path)) {}
+
   absl::StatusOr<std::pair<std::string, std::string>> Run(
-      std::string_view text, FileType file_type,
-      absl::Span<const VerilogInclude> includes) const override {
-    if (file_type == FileType::kSystemVerilog) {
-      return absl::UnimplementedError(
-          "iverilog does not support SystemVerilog");
+      absl::Span<const std::pair<std::string, std::string>> plusargs)
+      const override {
+    // Plusargs follow the vvp file on the command line.
+    std::vector<std::string> args = {vvp_path_.string()};
+    for (const auto& [name, value] : plusargs) {
+      args.push_back(absl::StrCat("+", name, "=", value));
     }
-    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
-    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(temp_top.path()));
-    std::filesystem::path temp_dir = temp_top.path();
-
-    std::string top_v_path = temp_dir / GetTopFileName(file_type);
-    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
-
-    XLS_ASSIGN_OR_RETURN(TempFile temp_out, TempFile::Create(".out"));
+    return InvokeVvp(args);
+  }
 
-    XLS_CHECK_OK(SetUpIncludes(temp_dir, includes));
-    XLS_RETURN_IF_ERROR(
-        InvokeIverilog({top_v_path, "-o", temp_out.path().string(), "-I",
-                        temp_dir.string()})
-            .status());
+ private:
+  TempDirectory temp_dir_;
+  std::filesystem::path vvp_path_;
+};
 
-    return InvokeVvp({temp_out.path().string()});
+class IcarusVerilogSimulator : public VerilogSimulator {
+ public:
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledVerilogDesign> design,
+                         Compile(text, file_type, includes));
+    return design->Run(/*plusargs=*/{});
   }
 
   absl::Status RunSyntaxChecking(
       std::string_view text, FileType file_type,
       absl::Span<const VerilogInclude> includes) const override {
+    return Compile(text, file_type, includes).status();
+  }
+
+  absl::StatusOr<std::unique_ptr<CompiledVerilogDesign>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
     if (file_type == FileType::kSystemVerilog) {
       return absl::UnimplementedError(
           "iverilog does not support SystemVerilog");
@@ -109,15 +123,15 @@ class IcarusVerilogSimulator : public VerilogSimulator {
     std::string top_v_path = temp_dir / GetTopFileName(file_type);
     XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
 
-    XLS_ASSIGN_OR_RETURN(TempFile temp_out, TempFile::Create(".out"));
+    std::filesystem::path vvp_path = temp_dir / "top.vvp";
 
     XLS_CHECK_OK(SetUpIncludes(temp_dir, includes));
-    XLS_RETURN_IF_ERROR(
-        InvokeIverilog({top_v_path, "-o", temp_out.path().string(), "-I",
-                        temp_dir.string()})
-            .status());
+    XLS_RETURN_IF_ERROR(InvokeIverilog({top_v_path, "-o", vvp_path.string(),
+                                        "-I", temp_dir.string()})
+                            .status());
 
-    return absl::OkStatus();
+    return std::make_unique<IcarusVerilogDesign>(std::move(temp_top),
+                                                 std::move(vvp_path));
   }
 };
 
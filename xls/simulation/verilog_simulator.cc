@@ -85,6 +85,28 @@ absl::StatusOr<std::vector<Observation>> StdoutToObservations(
 
 }  // namespace
 
+absl::StatusOr<std::pair<std::string, std::string>>
+CompiledVerilogDesign::RunWithStimulus(std::string_view plusarg_name,
+                                       std::string_view stimulus) const {
+  XLS_ASSIGN_OR_RETURN(TempFile stimulus_file,
+                       TempFile::CreateWithContent(stimulus, ".txt"));
+  std::vector<std::pair<std::string, std::string>> plusargs = {
+      {std::string(plusarg_name), stimulus_file.path().string()}};
+  return Run(plusargs);
+}
+
+absl::StatusOr<std::unique_ptr<CompiledVerilogDesign>>
+VerilogSimulator::Compile(std::string_view text, FileType file_type,
+                          absl::Span<const VerilogInclude> includes) const {
+  return absl::UnimplementedError(
+      "Simulator does not support compiling a design once for multiple runs");
+}
+
+absl::StatusOr<std::unique_ptr<CompiledVerilogDesign>>
+VerilogSimulator::Compile(std::string_view text, FileType file_type) const {
+  return Compile(text, file_type, /*includes=*/{});
+}
+
 absl::StatusOr<std::pair<std::string, std::string>> VerilogSimulator::Run(
     std::string_view text, FileType file_type) const {
   return Run(text, file_type, /*includes=*/{});
@@ -15,6 +15,9 @@
 #ifndef XLS_SIMULATION_VERILOG_SIMULATOR_H_
 #define XLS_SIMULATION_VERILOG_SIMULATOR_H_
 
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -37,6 +40,34 @@ struct Observation {
   Bits value;
 };
 
+// A design compiled by a VerilogSimulator, which can be simulated any number of
+// times without being compiled again. Stimulus which varies between
+// simulations can be read by the design at runtime from a file named by a
+// plusarg, e.g.:
+//
+//   reg [8*256-1:0] stimulus_file;
+//   ...
+//   if ($value$plusargs("stimulus=%s", stimulus_file)) begin
+//     fd = $fopen(stimulus_file, "r");
+//     ...
+//
+// Run may be called concurrently from multiple threads.
+class CompiledVerilogDesign {
+ public:
+  virtual ~CompiledVerilogDesign() = default;
+
+  // Simulates the design, passing each name/value pair as the plusarg
+  // "+name=value". Returns the stdout/stderr as a string pair.
+  virtual absl::StatusOr<std::pair<std::string, std::string>> Run(
+      absl::Span<const std::pair<std::string, std::string>> plusargs)
+      const = 0;
+
+  // Simulates the design with the given stimulus text, which is written to a
+  // temporary file whose path is passed as the plusarg `plusarg_name`.
+  absl::StatusOr<std::pair<std::string, std::string>> RunWithStimulus(
+      std::string_view plusarg_name, std::string_view stimulus) const;
+};
+
 // Interface wrapping a Verilog simulator such Icarus verilog.
 class VerilogSimulator {
  public:
@@ -57,6 +88,16 @@ class VerilogSimulator {
   absl::Status RunSyntaxChecking(std::string_view text,
                                  FileType file_type) const;
 
+  // Compiles the given Verilog text into a design which can be simulated
+  // repeatedly, e.g., with different stimulus, without repeating the
+  // compilation and elaboration done by each call to Run. Returns an
+  // UnimplementedError if the simulator does not support this.
+  virtual absl::StatusOr<std::unique_ptr<CompiledVerilogDesign>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const;
+  absl::StatusOr<std::unique_ptr<CompiledVerilogDesign>> Compile(
+      std::string_view text, FileType file_type) const;
+
   // Simulation runner harness: runs the given Verilog text using the verilog
   // simulator infrastructure and returns observations of data values that arose
   // during simulation.
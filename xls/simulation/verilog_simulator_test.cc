@@ -14,8 +14,14 @@
 
 #include "xls/simulation/verilog_simulator.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/simulation/verilog_simulators.h"
 #include "xls/simulation/verilog_test_base.h"
@@ -26,6 +32,7 @@ namespace {
 
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Not;
 
 class VerilogSimulatorTest : public VerilogTestBase {};
 
@@ -72,6 +79,54 @@ endmodule
   EXPECT_EQ(UBits(1, /*bit_count=*/1), observations[1].value);
 }
 
+TEST_P(VerilogSimulatorTest, CompiledDesignReadsStimulusAtRuntime) {
+  std::string text = R"(module device_under_test(
+  input [7:0] x,
+  input [7:0] y,
+  output [7:0] z
+);
+  assign z = x + y;
+endmodule
+
+module tb;
+  reg [8*256-1:0] stimulus_file;
+  integer fd;
+  reg [7:0] x;
+  reg [7:0] y;
+  wire [7:0] z;
+  device_under_test dut(.x(x), .y(y), .z(z));
+  initial begin
+    if (!$value$plusargs("stimulus=%s", stimulus_file)) begin
+      $display("Missing +stimulus");
+      $finish;
+    end
+    fd = $fopen(stimulus_file, "r");
+    while ($fscanf(fd, "%h %h\n", x, y) == 2) begin
+      #1 $display("z = %h", z);
+    end
+    $fclose(fd);
+  end
+endmodule
+)";
+
+  absl::StatusOr<std::unique_ptr<CompiledVerilogDesign>> design =
+      GetSimulator()->Compile(text, GetFileType());
+  if (absl::IsUnimplemented(design.status())) {
+    return;
+  }
+  XLS_ASSERT_OK(design.status());
+
+  std::pair<std::string, std::string> stdout_stderr;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      stdout_stderr, (*design)->RunWithStimulus("stimulus", "01 02\n03 04\n"));
+  EXPECT_THAT(stdout_stderr.first, HasSubstr("z = 03\nz = 07\n"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      stdout_stderr, (*design)->RunWithStimulus("stimulus", "ff 02\n"));
+  EXPECT_THAT(stdout_stderr.first, HasSubstr("z = 01\n"));
+  EXPECT_THAT(stdout_stderr.first, Not(HasSubstr("z = 07")));
+}
+
 TEST_P(VerilogSimulatorTest, SystemVerilogAssertAsserted) {
   std::string text = R"(module device_under_test(
   input  [7:0] in,
@@ -14,10 +14,20 @@
 
 #include "xls/solvers/z3_ir_translator.h"
 
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/debugging/leak_check.h"
+#include "absl/hash/hash.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
@@ -1349,40 +1359,91 @@ absl::StatusOr<Z3_ast> PredicateToObjective(Predicate p, Z3_ast a,
 
 absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
                               absl::Duration timeout) {
-  XLS_ASSIGN_OR_RETURN(auto translator, IrTranslator::CreateAndTranslate(f));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrProver> prover,
+                       IrProver::Create(f, timeout));
+  return prover->TryProve(subject, p);
+}
+
+namespace {
+
+// Identifies a query of an IrProver: the hash of the function's IR text, the
+// subject node and the predicate (with the compared-to node, if any). Nodes are
+// identified by name as ids are not part of the IR text of every node.
+using IrProverCacheKey = std::tuple<uint64_t, std::string, PredicateKind,
+                                    std::optional<std::string>>;
+
+absl::Mutex ir_prover_cache_mutex(absl::kConstInit);
+
+absl::flat_hash_map<IrProverCacheKey, bool>& GetIrProverCache()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(ir_prover_cache_mutex) {
+  static auto* cache = new absl::flat_hash_map<IrProverCacheKey, bool>();
+  return *cache;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<IrProver>> IrProver::Create(
+    Function* f, absl::Duration timeout) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(f));
   translator->SetTimeout(timeout);
-  Z3_ast value = translator->GetTranslation(subject);
+  return absl::WrapUnique(new IrProver(f, std::move(translator)));
+}
+
+IrProver::IrProver(Function* f, std::unique_ptr<IrTranslator> translator)
+    : function_hash_(absl::Hash<std::string>()(f->DumpIr())),
+      translator_(std::move(translator)),
+      solver_(CreateSolver(translator_->ctx(), 1)) {}
+
+IrProver::~IrProver() { Z3_solver_dec_ref(translator_->ctx(), solver_); }
 
+absl::StatusOr<bool> IrProver::TryProve(Node* subject, const Predicate& p) {
   // All token types are equal.
   if (subject->GetType()->IsToken() &&
       p.kind() == PredicateKind::kEqualToNode &&
       p.node()->GetType()->IsToken()) {
     return true;
   }
-  if (translator->GetValueKind(value) != Z3_BV_SORT) {
+
+  IrProverCacheKey key(function_hash_, subject->GetName(), p.kind(),
+                       p.kind() == PredicateKind::kEqualToNode
+                           ? std::make_optional(p.node()->GetName())
+                           : std::nullopt);
+  {
+    absl::MutexLock lock(&ir_prover_cache_mutex);
+    auto it = GetIrProverCache().find(key);
+    if (it != GetIrProverCache().end()) {
+      ++cache_hit_count_;
+      return it->second;
+    }
+  }
+
+  Z3_ast value = translator_->GetTranslation(subject);
+  if (translator_->GetValueKind(value) != Z3_BV_SORT) {
     return absl::InvalidArgumentError(
         "Cannot prove properties of non-bits-typed node: " +
         subject->ToString());
   }
   XLS_ASSIGN_OR_RETURN(Z3_ast objective,
-                       PredicateToObjective(p, value, translator.get()));
-  Z3_context ctx = translator->ctx();
+                       PredicateToObjective(p, value, translator_.get()));
+  Z3_context ctx = translator_->ctx();
   XLS_VLOG(2) << "objective:\n" << Z3_ast_to_string(ctx, objective);
-  Z3_solver solver = solvers::z3::CreateSolver(ctx, 1);
-  Z3_solver_assert(ctx, solver, objective);
-  Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
-  XLS_VLOG(2) << solvers::z3::SolverResultToString(ctx, solver, satisfiable)
+  Z3_solver_push(ctx, solver_);
+  Z3_solver_assert(ctx, solver_, objective);
+  Z3_lbool satisfiable = Z3_solver_check(ctx, solver_);
+  XLS_VLOG(2) << solvers::z3::SolverResultToString(ctx, solver_, satisfiable)
               << std::endl;
-  Z3_solver_dec_ref(ctx, solver);
-
-  if (Z3_solver_check(ctx, solver) == Z3_L_FALSE) {
-    // We posit the inverse of the predicate we want to check -- when that is
-    // unsatisfiable, the predicate has been proven (there was no way found that
-    // we could not satisfy its inverse).
-    return true;
+  Z3_solver_pop(ctx, solver_, 1);
+
+  // We posit the inverse of the predicate we want to check -- when that is
+  // unsatisfiable, the predicate has been proven (there was no way found that
+  // we could not satisfy its inverse).
+  bool proven = satisfiable == Z3_L_FALSE;
+  if (satisfiable != Z3_L_UNDEF) {
+    absl::MutexLock lock(&ir_prover_cache_mutex);
+    GetIrProverCache()[key] = proven;
   }
-
-  return false;
+  return proven;
 }
 
 }  // namespace z3
@@ -18,6 +18,9 @@
 #ifndef XLS_TOOLS_Z3_IR_TRANSLATOR_H_
 #define XLS_TOOLS_Z3_IR_TRANSLATOR_H_
 
+#include <cstdint>
+#include <memory>
+
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "xls/common/logging/logging.h"
@@ -313,6 +316,38 @@ class Predicate {
 absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
                               absl::Duration timeout);
 
+// Proves predicates about the nodes of a single function. Unlike repeated calls
+// of TryProve(), the function is only translated once: each predicate is
+// checked within a push/pop scope of one long-lived solver, which also lets Z3
+// reuse what it learned about the function between queries.
+//
+// Definite verdicts (i.e., not those of timed-out queries) are also cached
+// process-wide by function, subject and predicate, where functions are
+// identified by a hash of their IR text, so re-proving a predicate about an
+// unchanged function (e.g., from another pass invocation) is free.
+//
+// The function must not be modified while the prover is in use.
+class IrProver {
+ public:
+  static absl::StatusOr<std::unique_ptr<IrProver>> Create(
+      Function* f, absl::Duration timeout);
+  ~IrProver();
+
+  // As the free function TryProve(), for a node of this prover's function.
+  absl::StatusOr<bool> TryProve(Node* subject, const Predicate& p);
+
+  // The number of TryProve() calls answered from the verdict cache.
+  int64_t cache_hit_count() const { return cache_hit_count_; }
+
+ private:
+  IrProver(Function* f, std::unique_ptr<IrTranslator> translator);
+
+  uint64_t function_hash_;
+  std::unique_ptr<IrTranslator> translator_;
+  Z3_solver solver_;
+  int64_t cache_hit_count_ = 0;
+};
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
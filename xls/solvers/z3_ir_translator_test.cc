@@ -14,6 +14,9 @@
 
 #include "xls/solvers/z3_ir_translator.h"
 
+#include <memory>
+#include <string>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
@@ -127,6 +130,43 @@ fn f(x: bits[32], y: bits[32]) -> bits[32] {
   EXPECT_TRUE(proven);
 }
 
+TEST_F(Z3IrTranslatorTest, ProverAnswersSeveralPredicates) {
+  const std::string program = R"(
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  add.1: bits[8] = add(x, y)
+  sub.2: bits[8] = sub(add.1, y)
+  ret xor.3: bits[8] = xor(sub.2, x)
+}
+)";
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * x, f->GetNode("x"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * sub, f->GetNode("sub.2"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<solvers::z3::IrProver> prover,
+      solvers::z3::IrProver::Create(f, absl::InfiniteDuration()));
+  // Each query is popped off again, so an unprovable predicate does not
+  // affect the ones after it.
+  EXPECT_THAT(prover->TryProve(x, Predicate::EqualToZero()),
+              IsOkAndHolds(false));
+  EXPECT_THAT(prover->TryProve(sub, Predicate::EqualTo(x)),
+              IsOkAndHolds(true));
+  EXPECT_THAT(prover->TryProve(f->return_value(), Predicate::EqualToZero()),
+              IsOkAndHolds(true));
+  EXPECT_THAT(prover->TryProve(x, Predicate::NotEqualToZero()),
+              IsOkAndHolds(false));
+  EXPECT_EQ(prover->cache_hit_count(), 0);
+
+  // A prover of the same function reuses the verdicts.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<solvers::z3::IrProver> other,
+      solvers::z3::IrProver::Create(f, absl::InfiniteDuration()));
+  EXPECT_THAT(other->TryProve(sub, Predicate::EqualTo(x)), IsOkAndHolds(true));
+  EXPECT_THAT(other->TryProve(x, Predicate::EqualToZero()),
+              IsOkAndHolds(false));
+  EXPECT_EQ(other->cache_hit_count(), 2);
+}
+
 TEST_F(Z3IrTranslatorTest, TupleIndexMinusSelf) {
   const std::string program = R"(
 fn f(p: (bits[1], bits[32])) -> bits[32] {
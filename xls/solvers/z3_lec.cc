@@ -14,6 +14,8 @@
 
 #include "xls/solvers/z3_lec.h"
 
+#include <algorithm>
+#include <atomic>
 #include <thread>  // NOLINT(build/c++11)
 
 #include "absl/base/internal/sysinfo.h"
@@ -23,6 +25,7 @@
 #include "absl/strings/strip.h"
 #include "xls/codegen/vast.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/node_util.h"
@@ -74,7 +77,87 @@ Lec::Lec(Package* ir_package, Function* ir_function, Netlist* netlist,
       netlist_(netlist),
       netlist_module_name_(netlist_module_name),
       schedule_(schedule),
-      stage_(stage) {}
+      stage_(stage),
+      solver_threads_(std::thread::hardware_concurrency()) {}
+
+absl::StatusOr<std::unique_ptr<Lec>> Lec::CreatePartition(
+    const LecParams& params, const LecPartitionOptions& options, int64_t begin,
+    int64_t end, int64_t solver_threads) {
+  auto lec = absl::WrapUnique<Lec>(new Lec(
+      params.ir_package, params.ir_function, params.netlist,
+      params.netlist_module_name, options.schedule,
+      options.schedule.has_value() ? options.stage : 0));
+  lec->output_bit_range_ = std::make_pair(begin, end);
+  lec->solver_threads_ = solver_threads;
+  XLS_RETURN_IF_ERROR(lec->Init());
+  if (options.constraints != nullptr) {
+    XLS_RETURN_IF_ERROR(lec->AddConstraints(options.constraints));
+  }
+  return lec;
+}
+
+absl::StatusOr<PartitionedLecResult> Lec::RunPartitioned(
+    const LecParams& params, const LecPartitionOptions& options) {
+  XLS_RET_CHECK_GT(options.partition_count, 0);
+  XLS_RET_CHECK_GT(options.thread_count, 0);
+
+  // Created up front (on this thread) only to count the output bits; the
+  // partitions each translate the IR and netlist in their own Z3 context, as
+  // contexts can't be shared between threads.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Lec> whole,
+                       CreatePartition(params, options, 0, 0, 1));
+  const int64_t bit_count = whole->output_bit_count();
+  whole.reset();
+
+  const int64_t partition_count =
+      std::max<int64_t>(1, std::min(options.partition_count, bit_count));
+  const int64_t thread_count =
+      std::min(options.thread_count, partition_count);
+  const int64_t solver_threads = std::max<int64_t>(
+      1, std::thread::hardware_concurrency() / thread_count);
+
+  // Empty for partitions proved equivalent, otherwise the counterexample.
+  std::vector<std::optional<std::string>> counterexamples(partition_count);
+  std::vector<absl::Status> statuses(thread_count);
+  std::atomic<int64_t> next_partition = 0;
+  auto worker = [&](int64_t worker_index) {
+    for (int64_t p = next_partition++; p < partition_count;
+         p = next_partition++) {
+      absl::StatusOr<std::unique_ptr<Lec>> lec = CreatePartition(
+          params, options, bit_count * p / partition_count,
+          bit_count * (p + 1) / partition_count, solver_threads);
+      if (!lec.ok()) {
+        statuses[worker_index] = lec.status();
+        return;
+      }
+      if (!lec.value()->Run()) {
+        counterexamples[p] = lec.value()->ResultToString();
+      }
+    }
+  };
+  std::vector<std::unique_ptr<xls::Thread>> threads;
+  for (int64_t i = 1; i < thread_count; ++i) {
+    threads.push_back(
+        std::make_unique<xls::Thread>([&worker, i]() { worker(i); }));
+  }
+  worker(0);
+  for (std::unique_ptr<xls::Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+
+  PartitionedLecResult result;
+  result.proven = true;
+  for (std::optional<std::string>& counterexample : counterexamples) {
+    if (counterexample.has_value()) {
+      result.proven = false;
+      result.counterexamples.push_back(std::move(counterexample.value()));
+    }
+  }
+  return result;
+}
 
 Lec::~Lec() {
   if (model_) {
@@ -125,8 +208,14 @@ absl::Status Lec::Init() {
         ir_outputs_.push_back(x);
         netlist_outputs_.push_back(x);
       } else {
+        int64_t bit_index = ir_outputs_.size();
         ir_outputs_.push_back(ir_bits[i]);
         netlist_outputs_.push_back(netlist_bits[i]);
+        if (output_bit_range_.has_value() &&
+            (bit_index < output_bit_range_->first ||
+             bit_index >= output_bit_range_->second)) {
+          continue;
+        }
         eq_nodes.push_back(Z3_mk_eq(ctx(), ir_bits[i], netlist_bits[i]));
       }
     }
@@ -134,7 +223,7 @@ absl::Status Lec::Init() {
 
   Z3_ast eval_node = Z3_mk_and(ctx(), eq_nodes.size(), eq_nodes.data());
   eval_node = Z3_mk_not(ctx(), eval_node);
-  solver_ = CreateSolver(ctx(), std::thread::hardware_concurrency());
+  solver_ = CreateSolver(ctx(), solver_threads_);
   Z3_solver_assert(ctx(), solver_.value(), eval_node);
 
   return absl::OkStatus();
@@ -268,12 +357,37 @@ bool Lec::Run() {
   return !satisfiable_;
 }
 
+absl::StatusOr<bool> Lec::RunPortfolio(
+    absl::Span<const PortfolioSolver> solvers,
+    const PortfolioOptions& options) {
+  XLS_LOG(INFO) << "Beginning portfolio execution";
+  Z3_ast_vector assertions =
+      Z3_solver_get_assertions(ctx(), solver_.value());
+  Z3_ast_vector_inc_ref(ctx(), assertions);
+  std::vector<Z3_ast> conjuncts;
+  for (int i = 0; i < Z3_ast_vector_size(ctx(), assertions); i++) {
+    conjuncts.push_back(Z3_ast_vector_get(ctx(), assertions, i));
+  }
+  Z3_ast problem = Z3_mk_and(ctx(), conjuncts.size(), conjuncts.data());
+  Z3_ast_vector_dec_ref(ctx(), assertions);
+
+  XLS_ASSIGN_OR_RETURN(PortfolioResult result,
+                       SolvePortfolio(ctx(), problem, solvers, options));
+  if (result.satisfiable == Z3_L_UNDEF) {
+    return absl::DeadlineExceededError("No solver decided the LEC problem.");
+  }
+  XLS_LOG(INFO) << "Decided by " << result.solver;
+  satisfiable_ = result.satisfiable == Z3_L_TRUE;
+  model_ = result.model;
+  return !satisfiable_;
+}
+
 std::string Lec::ResultToString() {
   std::vector<std::string> output;
-  output.push_back(SolverResultToString(ctx(), solver_.value(),
-                                        satisfiable_ ? Z3_L_TRUE : Z3_L_FALSE,
-                                        /*hexify=*/true));
-  if (satisfiable_) {
+  output.push_back(SolverResultToString(
+      ctx(), model_.has_value() ? model_.value() : nullptr,
+      satisfiable_ ? Z3_L_TRUE : Z3_L_FALSE, /*hexify=*/true));
+  if (satisfiable_ && model_.has_value()) {
     for (const Node* node : ir_output_nodes_) {
       std::pair<std::string, std::string> outputs = GetComparisonStrings(node);
       std::string ir_string = outputs.first;
@@ -397,6 +511,9 @@ absl::Status Lec::CreateNetlistTranslator() {
 }
 
 void Lec::DumpIrTree() {
+  if (!model_.has_value()) {
+    return;
+  }
   std::deque<const Node*> to_process;
   absl::flat_hash_set<const Node*> seen;
   for (const Node* node : ir_output_nodes_) {
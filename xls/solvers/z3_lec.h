@@ -15,8 +15,12 @@
 #ifndef XLS_SOLVERS_Z3_LEC_H_
 #define XLS_SOLVERS_Z3_LEC_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -26,6 +30,7 @@
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_netlist_translator.h"
+#include "xls/solvers/z3_portfolio.h"
 
 namespace xls {
 namespace solvers {
@@ -48,6 +53,37 @@ struct LecParams {
   std::string netlist_module_name;
 };
 
+// Options for Lec::RunPartitioned().
+struct LecPartitionOptions {
+  // The number of partitions into which the output bits are split. Each
+  // partition (a contiguous range of output bits) is checked by a separate Lec
+  // with its own Z3 context, whose problem is just the fan-in cones of its
+  // output bits.
+  int64_t partition_count = 1;
+
+  // The maximum number of partitions checked at once, each on its own thread.
+  int64_t thread_count = 1;
+
+  // If set, only the given stage of the schedule is checked, as for
+  // Lec::CreateForStage().
+  std::optional<PipelineSchedule> schedule;
+  int stage = -1;
+
+  // If non-null, constraints applied to every partition; see
+  // Lec::AddConstraints().
+  Function* constraints = nullptr;
+};
+
+// The result of Lec::RunPartitioned().
+struct PartitionedLecResult {
+  // True if the netlist and IR are proved to be equivalent in every partition.
+  bool proven;
+
+  // The ResultToString() of each partition that was not proved equivalent,
+  // i.e., its counterexample, in partition order.
+  std::vector<std::string> counterexamples;
+};
+
 // Class for performing logical equivalence checks between a function specified
 // in XLS IR (perhaps converted from DSLX) and a netlist.
 class Lec {
@@ -61,6 +97,14 @@ class Lec {
   // cell/wire to stage is derived from there.
   static absl::StatusOr<std::unique_ptr<Lec>> CreateForStage(
       const LecParams& params, const PipelineSchedule& schedule, int stage);
+
+  // Checks equivalence with the output bits partitioned as specified by
+  // `options`, solving the partitions concurrently. A single monolithic
+  // problem for a wide output can be far harder for Z3 than the sum of its
+  // per-cone problems.
+  static absl::StatusOr<PartitionedLecResult> RunPartitioned(
+      const LecParams& params, const LecPartitionOptions& options);
+
   ~Lec();
 
   // Applies additional constraints (aside from the LEC itself), such as
@@ -76,6 +120,13 @@ class Lec {
   // Returns true of the netlist and IR are proved to be equivalent.
   bool Run();
 
+  // As Run(), but races the given solvers on the problem; see
+  // SolvePortfolio(). Returns DeadlineExceededError if no solver decides the
+  // problem in time. A counterexample found by an external solver has no
+  // model, so ResultToString() then only reports the verdict.
+  absl::StatusOr<bool> RunPortfolio(absl::Span<const PortfolioSolver> solvers,
+                                    const PortfolioOptions& options);
+
   // Dumps all Z3 values corresponding to IR nodes in the input function.
   void DumpIrTree();
 
@@ -84,10 +135,20 @@ class Lec {
 
   Z3_context ctx() { return ir_translator_->ctx(); }
 
+  // Returns the number of (flattened) output bits compared.
+  int64_t output_bit_count() const { return ir_outputs_.size(); }
+
  private:
   Lec(Package* ir_package, Function* ir_function,
       netlist::rtl::Netlist* netlist, const std::string& netlist_module_name,
       std::optional<PipelineSchedule> schedule, int stage);
+
+  // Creates a LEC object which only checks output bits [begin, end) and
+  // solves with the given number of threads.
+  static absl::StatusOr<std::unique_ptr<Lec>> CreatePartition(
+      const LecParams& params, const LecPartitionOptions& options,
+      int64_t begin, int64_t end, int64_t solver_threads);
+
   absl::Status Init();
   absl::Status CreateIrTranslator();
   absl::Status CreateNetlistTranslator();
@@ -155,12 +216,20 @@ class Lec {
   std::optional<PipelineSchedule> schedule_;
   int stage_;
 
+  // If set, only the output bits in this range (indices into ir_outputs_) are
+  // checked.
+  std::optional<std::pair<int64_t, int64_t>> output_bit_range_;
+
+  // The number of threads used by the solver.
+  int64_t solver_threads_;
+
   // Z3 elements are, under the hood, void pointers, but let's respect the
   // interface and use std::optional to determine live-ness.
   std::optional<Z3_solver> solver_;
 
-  // Satisfiable is equivalent to "model_.has_value()", but having an explicit
-  // value is more understandable.
+  // Satisfiable is equivalent to "model_.has_value()" (except after an external
+  // portfolio solver found a counterexample), but having an explicit value is
+  // more understandable.
   bool satisfiable_;
   std::optional<Z3_model> model_;
 };
@@ -17,6 +17,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/substitute.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/netlist/cell_library.h"
@@ -55,6 +56,28 @@ absl::StatusOr<bool> Match(const std::string& ir_text,
   return lec->Run();
 }
 
+absl::StatusOr<PartitionedLecResult> MatchPartitioned(
+    const std::string& ir_text, const std::string& netlist_text,
+    const LecPartitionOptions& options) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(Function * entry_function, package->GetTopAsFunction());
+
+  XLS_ASSIGN_OR_RETURN(netlist::CellLibrary cell_library,
+                       netlist::MakeFakeCellLibrary());
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Netlist> netlist,
+      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+
+  LecParams params;
+  params.ir_package = package.get();
+  params.ir_function = entry_function;
+  params.netlist = netlist.get();
+  params.netlist_module_name = "main";
+  return Lec::RunPartitioned(params, options);
+}
+
 // This test verifies that we can do a simple LEC.
 TEST(Z3LecTest, SimpleLec) {
   std::string ir_text = R"(
@@ -135,6 +158,73 @@ endmodule
   ASSERT_FALSE(match);
 }
 
+// Verifies that a partitioned LEC proves equivalence and reports a
+// counterexample for each partition containing mismatched output bits.
+TEST(Z3LecTest, PartitionedLec) {
+  std::string ir_text = R"(
+package p
+
+top fn main(input: bits[4]) -> bits[4] {
+  ret not.2: bits[4] = not(input)
+}
+)";
+
+  // Bits 1 and 3 are computed incorrectly when `bad` is substituted.
+  std::string netlist_template = R"(
+module main ( clk, input_3_, input_2_, input_1_, input_0_, out_3_, out_2_, out_1_, out_0_);
+  input clk, input_3_, input_2_, input_1_, input_0_;
+  output out_3_, out_2_, out_1_, out_0_;
+  wire p0_input_3_, p0_input_2_, p0_input_1_, p0_input_0_,
+       p0_not_2_comb_3_, p0_not_2_comb_2_, p0_not_2_comb_1_, p0_not_2_comb_0_;
+
+  DFF p0_input_reg_3_ ( .D(input_3_), .CLK(clk), .Q(p0_input_3_) );
+  DFF p0_input_reg_2_ ( .D(input_2_), .CLK(clk), .Q(p0_input_2_) );
+  DFF p0_input_reg_1_ ( .D(input_1_), .CLK(clk), .Q(p0_input_1_) );
+  DFF p0_input_reg_0_ ( .D(input_0_), .CLK(clk), .Q(p0_input_0_) );
+
+  $0
+  INV p0_not_2_2_ ( .A(p0_input_2_), .ZN(p0_not_2_comb_2_) );
+  $1
+  INV p0_not_2_0_ ( .A(p0_input_0_), .ZN(p0_not_2_comb_0_) );
+
+  DFF p0_not_2_reg_3_ (.D(p0_not_2_comb_3_), .CLK(clk), .Q(out_3_));
+  DFF p0_not_2_reg_2_ (.D(p0_not_2_comb_2_), .CLK(clk), .Q(out_2_));
+  DFF p0_not_2_reg_1_ (.D(p0_not_2_comb_1_), .CLK(clk), .Q(out_1_));
+  DFF p0_not_2_reg_0_ (.D(p0_not_2_comb_0_), .CLK(clk), .Q(out_0_));
+endmodule
+)";
+  std::string good_netlist = absl::Substitute(
+      netlist_template,
+      "INV p0_not_2_3_ ( .A(p0_input_3_), .ZN(p0_not_2_comb_3_) );",
+      "INV p0_not_2_1_ ( .A(p0_input_1_), .ZN(p0_not_2_comb_1_) );");
+  std::string bad_netlist = absl::Substitute(
+      netlist_template,
+      "OR p0_not_2_3_ ( .A(p0_input_3_), .B(p0_input_3_), "
+      ".Z(p0_not_2_comb_3_) );",
+      "OR p0_not_2_1_ ( .A(p0_input_1_), .B(p0_input_1_), "
+      ".Z(p0_not_2_comb_1_) );");
+
+  LecPartitionOptions options;
+  options.partition_count = 4;
+  options.thread_count = 2;
+  XLS_ASSERT_OK_AND_ASSIGN(PartitionedLecResult good,
+                           MatchPartitioned(ir_text, good_netlist, options));
+  EXPECT_TRUE(good.proven);
+  EXPECT_TRUE(good.counterexamples.empty());
+
+  XLS_ASSERT_OK_AND_ASSIGN(PartitionedLecResult bad,
+                           MatchPartitioned(ir_text, bad_netlist, options));
+  EXPECT_FALSE(bad.proven);
+  EXPECT_EQ(bad.counterexamples.size(), 2);
+
+  // A single partition finds the mismatch too.
+  options.partition_count = 1;
+  XLS_ASSERT_OK_AND_ASSIGN(bad,
+                           MatchPartitioned(ir_text, bad_netlist, options));
+  EXPECT_FALSE(bad.proven);
+  EXPECT_EQ(bad.counterexamples.size(), 1);
+}
+
 // This test verifies that we can do a simple multi-stage LEC.
 // There are three defined stages:
 // [inputs] -> p0_AND -> p1_OR -> p2 NOT -> [outputs]
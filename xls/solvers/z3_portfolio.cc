@@ -0,0 +1,303 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/z3_portfolio.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
+#include "xls/solvers/z3_utils.h"
+#include "../z3/src/api/z3_api.h"
+
+namespace xls {
+namespace solvers {
+namespace z3 {
+namespace {
+
+// How often the losing Z3 solvers are interrupted until they stop. An
+// interrupt which arrives before a solver starts checking may be lost, so
+// interrupt until every solver has returned.
+constexpr absl::Duration kInterruptInterval = absl::Milliseconds(10);
+
+// The state of one member of the portfolio while it runs.
+struct Member {
+  ~Member() {
+    if (ctx == nullptr) {
+      return;
+    }
+    if (model != nullptr) {
+      Z3_model_dec_ref(ctx, model);
+    }
+    if (solver != nullptr) {
+      Z3_solver_dec_ref(ctx, solver);
+    }
+    Z3_del_context(ctx);
+    Z3_del_config(config);
+  }
+
+  Z3_lbool verdict = Z3_L_UNDEF;
+  absl::Status status;
+
+  // The member's own context, and the problem translated into it. Only set
+  // for Z3 solvers.
+  Z3_config config = nullptr;
+  Z3_context ctx = nullptr;
+  Z3_ast assertion = nullptr;
+  Z3_solver solver = nullptr;
+  Z3_model model = nullptr;
+};
+
+// Builds the solver for the given tactics (or Z3's default solver).
+absl::StatusOr<Z3_solver> CreateTacticSolver(
+    Z3_context ctx, absl::Span<const std::string> tactics) {
+  if (tactics.empty()) {
+    Z3_solver solver = Z3_mk_solver(ctx);
+    Z3_solver_inc_ref(ctx, solver);
+    return solver;
+  }
+  Z3_tactic tactic = nullptr;
+  for (const std::string& name : tactics) {
+    Z3_tactic next = Z3_mk_tactic(ctx, name.c_str());
+    if (next == nullptr) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown Z3 tactic: ", name));
+    }
+    Z3_tactic_inc_ref(ctx, next);
+    if (tactic != nullptr) {
+      Z3_tactic combined = Z3_tactic_and_then(ctx, tactic, next);
+      Z3_tactic_inc_ref(ctx, combined);
+      Z3_tactic_dec_ref(ctx, tactic);
+      Z3_tactic_dec_ref(ctx, next);
+      next = combined;
+    }
+    tactic = next;
+  }
+  Z3_solver solver = Z3_mk_solver_from_tactic(ctx, tactic);
+  Z3_solver_inc_ref(ctx, solver);
+  Z3_tactic_dec_ref(ctx, tactic);
+  return solver;
+}
+
+absl::Status RunZ3(const PortfolioSolver& spec, Member& member) {
+  ScopedErrorHandler handler(member.ctx);
+  XLS_ASSIGN_OR_RETURN(member.solver,
+                       CreateTacticSolver(member.ctx, spec.args));
+  XLS_RETURN_IF_ERROR(handler.status());
+  Z3_solver_assert(member.ctx, member.solver, member.assertion);
+  member.verdict = Z3_solver_check(member.ctx, member.solver);
+  if (member.verdict == Z3_L_TRUE) {
+    member.model = Z3_solver_get_model(member.ctx, member.solver);
+    Z3_model_inc_ref(member.ctx, member.model);
+  }
+  return handler.status();
+}
+
+absl::Status RunSmtLib(const PortfolioSolver& spec,
+                       const std::filesystem::path& problem,
+                       const absl::Notification& cancel, Member& member) {
+  std::vector<std::string> argv = spec.args;
+  argv.push_back(problem.string());
+  XLS_ASSIGN_OR_RETURN(auto output, InvokeSubprocess(argv, "", &cancel));
+  std::vector<std::string_view> words =
+      absl::StrSplit(output.first, absl::ByAnyChar(" \t\r\n"),
+                     absl::SkipEmpty());
+  if (!words.empty() && words.front() == "sat") {
+    member.verdict = Z3_L_TRUE;
+  } else if (!words.empty() && words.front() == "unsat") {
+    member.verdict = Z3_L_FALSE;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<PortfolioSolver> ParsePortfolioSolver(std::string_view spec) {
+  PortfolioSolver solver;
+  solver.name = std::string(spec);
+  if (spec == "z3") {
+    solver.kind = PortfolioSolver::Kind::kZ3;
+    return solver;
+  }
+  if (absl::ConsumePrefix(&spec, "z3:")) {
+    solver.kind = PortfolioSolver::Kind::kZ3;
+    solver.args = absl::StrSplit(spec, '+');
+  } else if (absl::ConsumePrefix(&spec, "smtlib:")) {
+    solver.kind = PortfolioSolver::Kind::kSmtLib;
+    solver.args = absl::StrSplit(spec, ' ', absl::SkipEmpty());
+  } else {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid portfolio solver \"", solver.name,
+        "\"; expected \"z3\", \"z3:<tactic>[+<tactic>...]\" or "
+        "\"smtlib:<command line>\"."));
+  }
+  for (const std::string& arg : solver.args) {
+    if (arg.empty()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Invalid portfolio solver \"", solver.name, "\": empty argument."));
+    }
+  }
+  if (solver.args.empty()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid portfolio solver \"", solver.name, "\": no command given."));
+  }
+  return solver;
+}
+
+absl::StatusOr<std::vector<PortfolioSolver>> ParsePortfolio(
+    absl::Span<const std::string> specs) {
+  std::vector<PortfolioSolver> solvers;
+  solvers.reserve(specs.size());
+  for (const std::string& spec : specs) {
+    XLS_ASSIGN_OR_RETURN(PortfolioSolver solver, ParsePortfolioSolver(spec));
+    solvers.push_back(std::move(solver));
+  }
+  return solvers;
+}
+
+absl::StatusOr<PortfolioResult> SolvePortfolio(
+    Z3_context ctx, Z3_ast assertion, absl::Span<const PortfolioSolver> solvers,
+    const PortfolioOptions& options) {
+  XLS_RET_CHECK(!solvers.empty());
+
+  // Give each Z3 solver its own copy of the problem: contexts are not thread
+  // safe. External solvers all read the same SMT-LIB2 file.
+  std::vector<Member> members(solvers.size());
+  std::optional<TempFile> problem;
+  for (int64_t i = 0; i < solvers.size(); ++i) {
+    Member& member = members[i];
+    if (solvers[i].kind == PortfolioSolver::Kind::kZ3) {
+      member.config = Z3_mk_config();
+      member.ctx = Z3_mk_context(member.config);
+      member.assertion = Z3_translate(ctx, assertion, member.ctx);
+      if (options.timeout != absl::InfiniteDuration()) {
+        std::string timeout =
+            absl::StrCat(absl::ToInt64Milliseconds(options.timeout));
+        Z3_update_param_value(member.ctx, "timeout", timeout.c_str());
+      }
+    } else if (!problem.has_value()) {
+      std::string text = Z3_benchmark_to_smtlib_string(
+          ctx, /*name=*/"", options.smtlib_logic.c_str(),
+          /*status=*/"unknown", /*attributes=*/"", /*num_assumptions=*/0,
+          /*assumptions=*/nullptr, assertion);
+      XLS_ASSIGN_OR_RETURN(problem, TempFile::CreateWithContent(text, ".smt2"));
+    }
+  }
+
+  absl::Mutex mutex;
+  int64_t finished = 0;
+  std::optional<int64_t> winner;
+  absl::Notification cancel;
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < solvers.size(); ++i) {
+    threads.push_back(std::make_unique<Thread>([&, i]() {
+      Member& member = members[i];
+      member.status = solvers[i].kind == PortfolioSolver::Kind::kZ3
+                          ? RunZ3(solvers[i], member)
+                          : RunSmtLib(solvers[i], problem->path(), cancel,
+                                      member);
+      absl::MutexLock lock(&mutex);
+      ++finished;
+      if (!winner.has_value() && member.status.ok() &&
+          member.verdict != Z3_L_UNDEF) {
+        winner = i;
+      }
+    }));
+  }
+
+  // Wait for a verdict, for every solver to give up, or for the timeout.
+  {
+    absl::MutexLock lock(&mutex);
+    auto decided_or_all_finished = [&]() {
+      mutex.AssertReaderHeld();
+      return winner.has_value() || finished == solvers.size();
+    };
+    mutex.AwaitWithDeadline(absl::Condition(&decided_or_all_finished),
+                            absl::Now() + options.timeout);
+  }
+
+  // Stop the others.
+  cancel.Notify();
+  {
+    absl::MutexLock lock(&mutex);
+    auto all_finished = [&]() {
+      mutex.AssertReaderHeld();
+      return finished == solvers.size();
+    };
+    while (!all_finished()) {
+      for (const Member& member : members) {
+        if (member.ctx != nullptr) {
+          Z3_interrupt(member.ctx);
+        }
+      }
+      mutex.AwaitWithTimeout(absl::Condition(&all_finished),
+                             kInterruptInterval);
+    }
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  PortfolioResult result;
+  if (!winner.has_value()) {
+    // Only report failures of solvers which were not stopped by us.
+    for (const Member& member : members) {
+      if (!member.status.ok() && !absl::IsCancelled(member.status)) {
+        return member.status;
+      }
+    }
+    return result;
+  }
+  for (int64_t i = 0; i < solvers.size(); ++i) {
+    if (!members[i].status.ok() && !absl::IsCancelled(members[i].status)) {
+      XLS_LOG(WARNING) << "Portfolio solver " << solvers[i].name
+                       << " failed: " << members[i].status;
+    }
+  }
+  const Member& member = members[winner.value()];
+  XLS_VLOG(1) << "Portfolio solver " << solvers[winner.value()].name
+              << " decided the problem.";
+  result.satisfiable = member.verdict;
+  result.solver = solvers[winner.value()].name;
+  if (member.model != nullptr) {
+    Z3_model model = Z3_model_translate(member.ctx, member.model, ctx);
+    Z3_model_inc_ref(ctx, model);
+    result.model = model;
+  }
+  return result;
+}
+
+}  // namespace z3
+}  // namespace solvers
+}  // namespace xls
@@ -0,0 +1,102 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Races several solvers on one problem and takes the first definitive answer.
+// Solver runtime on hard bit-vector problems varies by orders of magnitude
+// between tactics and between solvers, so running a few configurations side
+// by side bounds the worst case far better than any single configuration.
+
+#ifndef XLS_SOLVERS_Z3_PORTFOLIO_H_
+#define XLS_SOLVERS_Z3_PORTFOLIO_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "../z3/src/api/z3.h"
+
+namespace xls {
+namespace solvers {
+namespace z3 {
+
+// A member of a solver portfolio.
+struct PortfolioSolver {
+  enum class Kind {
+    // Z3, in its own context, with the tactics in `args` applied in sequence
+    // (or Z3's default solver if `args` is empty).
+    kZ3,
+    // An external solver reading SMT-LIB2: `args` is its command line, to
+    // which the path of a file holding the problem is appended. The solver
+    // must exit successfully and print "sat", "unsat" or "unknown" first.
+    kSmtLib,
+  };
+  Kind kind;
+  std::vector<std::string> args;
+
+  // The specification this solver was parsed from; identifies the solver in
+  // results.
+  std::string name;
+};
+
+// Parses a portfolio member specification, one of:
+//   "z3": Z3's default solver.
+//   "z3:<tactic>[+<tactic>...]": a Z3 solver built from the given tactics,
+//     e.g., "z3:qfbv" or "z3:simplify+bit-blast+sat".
+//   "smtlib:<command line>": an external SMT-LIB2 solver, e.g.,
+//     "smtlib:/usr/bin/bitwuzla" or "smtlib:/usr/bin/cvc5 --lang=smt2".
+absl::StatusOr<PortfolioSolver> ParsePortfolioSolver(std::string_view spec);
+
+// Parses each of the given specifications with ParsePortfolioSolver().
+absl::StatusOr<std::vector<PortfolioSolver>> ParsePortfolio(
+    absl::Span<const std::string> specs);
+
+struct PortfolioOptions {
+  // How long to wait for a definitive answer from any solver.
+  absl::Duration timeout = absl::InfiniteDuration();
+
+  // The logic declared in the SMT-LIB2 problem given to external solvers.
+  std::string smtlib_logic = "ALL";
+};
+
+struct PortfolioResult {
+  // Z3_L_TRUE or Z3_L_FALSE if some solver decided the problem, otherwise
+  // Z3_L_UNDEF (e.g., all solvers gave up or the timeout expired).
+  Z3_lbool satisfiable = Z3_L_UNDEF;
+
+  // The name of the solver which decided the problem, if any.
+  std::string solver;
+
+  // If the problem is satisfiable and was decided by a Z3 solver, a model
+  // translated into the caller's context. The model is reference counted;
+  // the caller must Z3_model_dec_ref() it. External solvers yield no model.
+  std::optional<Z3_model> model;
+};
+
+// Solves `assertion` in `ctx` with all the given solvers concurrently. The
+// first solver to report sat or unsat wins and the others are interrupted (Z3)
+// or killed (external solvers). Each Z3 solver runs in a fresh context, so
+// `ctx` is only used by the calling thread.
+absl::StatusOr<PortfolioResult> SolvePortfolio(
+    Z3_context ctx, Z3_ast assertion, absl::Span<const PortfolioSolver> solvers,
+    const PortfolioOptions& options = PortfolioOptions());
+
+}  // namespace z3
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_Z3_PORTFOLIO_H_
@@ -0,0 +1,168 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/z3_portfolio.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "../z3/src/api/z3_api.h"
+
+namespace xls {
+namespace solvers {
+namespace z3 {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+
+class PortfolioTest : public ::testing::Test {
+ protected:
+  PortfolioTest() {
+    config_ = Z3_mk_config();
+    ctx_ = Z3_mk_context(config_);
+  }
+  ~PortfolioTest() override {
+    Z3_del_context(ctx_);
+    Z3_del_config(config_);
+  }
+
+  // Returns the assertion that `x * multiplier == 7` for an 8-bit x, which is
+  // satisfiable exactly when the multiplier is odd.
+  Z3_ast MakeProblem(int multiplier) {
+    Z3_sort sort = Z3_mk_bv_sort(ctx_, 8);
+    x_ = Z3_mk_const(ctx_, Z3_mk_string_symbol(ctx_, "x"), sort);
+    return Z3_mk_eq(
+        ctx_, Z3_mk_bvmul(ctx_, x_, Z3_mk_int(ctx_, multiplier, sort)),
+        Z3_mk_int(ctx_, 7, sort));
+  }
+
+  std::vector<PortfolioSolver> Parse(std::vector<std::string> specs) {
+    return ParsePortfolio(specs).value();
+  }
+
+  Z3_config config_;
+  Z3_context ctx_;
+  Z3_ast x_ = nullptr;
+};
+
+TEST_F(PortfolioTest, ParsesSpecs) {
+  XLS_ASSERT_OK_AND_ASSIGN(PortfolioSolver z3, ParsePortfolioSolver("z3"));
+  EXPECT_EQ(z3.kind, PortfolioSolver::Kind::kZ3);
+  EXPECT_TRUE(z3.args.empty());
+
+  XLS_ASSERT_OK_AND_ASSIGN(PortfolioSolver tactics,
+                           ParsePortfolioSolver("z3:simplify+bit-blast+sat"));
+  EXPECT_EQ(tactics.kind, PortfolioSolver::Kind::kZ3);
+  EXPECT_THAT(tactics.args, ElementsAre("simplify", "bit-blast", "sat"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(PortfolioSolver external,
+                           ParsePortfolioSolver("smtlib:/bin/cvc5  -q"));
+  EXPECT_EQ(external.kind, PortfolioSolver::Kind::kSmtLib);
+  EXPECT_THAT(external.args, ElementsAre("/bin/cvc5", "-q"));
+  EXPECT_EQ(external.name, "smtlib:/bin/cvc5  -q");
+
+  EXPECT_THAT(ParsePortfolioSolver("yices"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ParsePortfolioSolver("z3:simplify++sat"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ParsePortfolioSolver("smtlib: "),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(PortfolioTest, Z3SolversProveUnsat) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PortfolioResult result,
+      SolvePortfolio(ctx_, MakeProblem(2),
+                     Parse({"z3", "z3:simplify+bit-blast+sat", "z3:qfbv"})));
+  EXPECT_EQ(result.satisfiable, Z3_L_FALSE);
+  EXPECT_FALSE(result.model.has_value());
+}
+
+TEST_F(PortfolioTest, Z3SolverModelIsTranslated) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PortfolioResult result,
+      SolvePortfolio(ctx_, MakeProblem(3), Parse({"z3", "z3:qfbv"})));
+  EXPECT_EQ(result.satisfiable, Z3_L_TRUE);
+  ASSERT_TRUE(result.model.has_value());
+
+  // 3 * 0xad = 0x207, i.e., 7 in 8 bits.
+  Z3_ast value;
+  ASSERT_TRUE(Z3_model_eval(ctx_, result.model.value(), x_,
+                            /*model_completion=*/true, &value));
+  uint64_t x;
+  ASSERT_TRUE(Z3_get_numeral_uint64(ctx_, value, &x));
+  EXPECT_EQ(x, 0xad);
+  Z3_model_dec_ref(ctx_, result.model.value());
+}
+
+TEST_F(PortfolioTest, ExternalSolverVerdict) {
+  // The problem file is appended to the command line, so echo prints the
+  // verdict first.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PortfolioResult result,
+      SolvePortfolio(ctx_, MakeProblem(3), Parse({"smtlib:/bin/echo unsat"})));
+  EXPECT_EQ(result.satisfiable, Z3_L_FALSE);
+  EXPECT_EQ(result.solver, "smtlib:/bin/echo unsat");
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      result, SolvePortfolio(ctx_, MakeProblem(3),
+                             Parse({"smtlib:/bin/echo unknown"})));
+  EXPECT_EQ(result.satisfiable, Z3_L_UNDEF);
+  EXPECT_TRUE(result.solver.empty());
+}
+
+TEST_F(PortfolioTest, FirstVerdictCancelsOthers) {
+  absl::Time start = absl::Now();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PortfolioResult result,
+      SolvePortfolio(ctx_, MakeProblem(2),
+                     Parse({"smtlib:/bin/sleep 60", "z3"})));
+  EXPECT_EQ(result.satisfiable, Z3_L_FALSE);
+  EXPECT_EQ(result.solver, "z3");
+  EXPECT_LT(absl::Now() - start, absl::Seconds(30));
+}
+
+TEST_F(PortfolioTest, Timeout) {
+  PortfolioOptions options;
+  options.timeout = absl::Milliseconds(100);
+  absl::Time start = absl::Now();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PortfolioResult result,
+      SolvePortfolio(ctx_, MakeProblem(2), Parse({"smtlib:/bin/sleep 60"}),
+                     options));
+  EXPECT_EQ(result.satisfiable, Z3_L_UNDEF);
+  EXPECT_LT(absl::Now() - start, absl::Seconds(30));
+}
+
+TEST_F(PortfolioTest, FailuresAreReportedWithoutVerdict) {
+  EXPECT_THAT(SolvePortfolio(ctx_, MakeProblem(2),
+                             Parse({"z3:no-such-tactic"})),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(SolvePortfolio(ctx_, MakeProblem(2),
+                             Parse({"z3:no-such-tactic", "z3"})),
+              IsOkAndHolds(::testing::Field(&PortfolioResult::satisfiable,
+                                            Z3_L_FALSE)));
+}
+
+}  // namespace
+}  // namespace z3
+}  // namespace solvers
+}  // namespace xls
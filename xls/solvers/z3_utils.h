@@ -56,6 +56,11 @@ Z3_solver CreateSolver(Z3_context ctx, int num_threads);
 std::string SolverResultToString(Z3_context ctx, Z3_solver solver,
                                  Z3_lbool satisfiable, bool hexify = true);
 
+// As above, but prints the given model (if non-null) rather than the model of
+// a solver, e.g., for a model translated from another context.
+std::string SolverResultToString(Z3_context ctx, Z3_model model,
+                                 Z3_lbool satisfiable, bool hexify = true);
+
 // Returns a string representation of the given node interpreted under the given
 // model.
 // If "hexify" is true, then all output values will be converted from boolean or
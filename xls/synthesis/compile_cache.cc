@@ -0,0 +1,79 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/compile_cache.h"
+
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/stable_hash.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+namespace synthesis {
+
+std::string CompileCacheKey(const CompileRequest& request) {
+  // The serialized signature holds no maps, so its serialization is
+  // deterministic.
+  return absl::StrFormat(
+      "top_module_name: %s\ntarget_frequency_hz: %d\nsignature: %s\n"
+      "module_text:\n%s",
+      request.top_module_name(), request.target_frequency_hz(),
+      absl::CHexEscape(request.signature().SerializeAsString()),
+      request.module_text());
+}
+
+std::filesystem::path CompileCache::EntryPath(std::string_view key) const {
+  return directory_ /
+         absl::StrFormat("%016x.compile_cache_entry", Fnv1aHash(key));
+}
+
+absl::StatusOr<std::optional<CompileResponse>> CompileCache::Lookup(
+    const CompileRequest& request) const {
+  std::string key = CompileCacheKey(request);
+  std::filesystem::path path = EntryPath(key);
+  absl::Status exists = FileExists(path);
+  if (absl::IsNotFound(exists)) {
+    XLS_VLOG(1) << "Compile cache miss: " << path;
+    return std::nullopt;
+  }
+  XLS_RETURN_IF_ERROR(exists);
+
+  CompileCacheEntry entry;
+  XLS_RETURN_IF_ERROR(ParseProtobinFile(path, &entry));
+  if (entry.key() != key) {
+    XLS_VLOG(1) << "Compile cache miss (hash collision): " << path;
+    return std::nullopt;
+  }
+  XLS_VLOG(1) << "Compile cache hit: " << path;
+  return entry.response();
+}
+
+absl::Status CompileCache::Insert(const CompileRequest& request,
+                                  const CompileResponse& response) const {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory_));
+  CompileCacheEntry entry;
+  entry.set_key(CompileCacheKey(request));
+  *entry.mutable_response() = response;
+
+  return SetProtobinFileAtomically(EntryPath(entry.key()), entry);
+}
+
+}  // namespace synthesis
+}  // namespace xls
@@ -0,0 +1,69 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SYNTHESIS_COMPILE_CACHE_H_
+#define XLS_SYNTHESIS_COMPILE_CACHE_H_
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+
+// Returns a string which uniquely identifies the synthesis problem posed by
+// `request`: the Verilog text, its signature, the top module and the target
+// frequency.
+std::string CompileCacheKey(const CompileRequest& request);
+
+// A persistent cache of synthesis results stored in a directory, one file per
+// entry. Entries are looked up by a hash of the CompileCacheKey of the request
+// and hold the full key, which is compared on lookup so a hash collision
+// results in a miss rather than a wrong result. Entries are written atomically
+// so a cache directory may be shared by concurrent threads and processes.
+//
+// Synthesis results typically depend on the synthesis flow and cell library as
+// well, which are not part of the request. Use a separate cache directory for
+// each flow.
+class CompileCache {
+ public:
+  explicit CompileCache(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+
+  // Returns the cached response to `request` or std::nullopt if there is none.
+  absl::StatusOr<std::optional<CompileResponse>> Lookup(
+      const CompileRequest& request) const;
+
+  // Adds the response to `request` to the cache, replacing any existing entry
+  // for the same request. Creates the cache directory if it does not exist.
+  absl::Status Insert(const CompileRequest& request,
+                      const CompileResponse& response) const;
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+ private:
+  // Returns the path of the file holding the entry with the given key.
+  std::filesystem::path EntryPath(std::string_view key) const;
+
+  std::filesystem::path directory_;
+};
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_SYNTHESIS_COMPILE_CACHE_H_
@@ -0,0 +1,77 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/compile_cache.h"
+
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+CompileRequest MakeRequest(int64_t target_frequency_hz) {
+  CompileRequest request;
+  request.set_module_text("module top(input a, output b); assign b = a; "
+                          "endmodule");
+  request.set_top_module_name("top");
+  request.set_target_frequency_hz(target_frequency_hz);
+  return request;
+}
+
+TEST(CompileCacheTest, LookupAfterInsert) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  CompileCache cache(temp_dir.path() / "cache");
+  CompileRequest request = MakeRequest(1'000'000'000);
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<CompileResponse> response,
+                           cache.Lookup(request));
+  EXPECT_FALSE(response.has_value());
+
+  CompileResponse inserted;
+  inserted.set_slack_ps(42);
+  inserted.set_netlist("// NETLIST");
+  XLS_ASSERT_OK(cache.Insert(request, inserted));
+
+  XLS_ASSERT_OK_AND_ASSIGN(response, cache.Lookup(request));
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->slack_ps(), 42);
+  EXPECT_EQ(response->netlist(), "// NETLIST");
+
+  // The target frequency and the module text are part of the key.
+  XLS_ASSERT_OK_AND_ASSIGN(response, cache.Lookup(MakeRequest(2'000'000'000)));
+  EXPECT_FALSE(response.has_value());
+  CompileRequest other_module = request;
+  other_module.set_module_text("module top(); endmodule");
+  XLS_ASSERT_OK_AND_ASSIGN(response, cache.Lookup(other_module));
+  EXPECT_FALSE(response.has_value());
+}
+
+TEST(CompileCacheTest, KeyDistinguishesRequests) {
+  CompileRequest request = MakeRequest(1'000'000'000);
+  CompileRequest other_top = request;
+  other_top.set_top_module_name("other");
+  EXPECT_EQ(CompileCacheKey(request), CompileCacheKey(request));
+  EXPECT_NE(CompileCacheKey(request), CompileCacheKey(other_top));
+  EXPECT_NE(CompileCacheKey(request),
+            CompileCacheKey(MakeRequest(1'000'000'001)));
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
@@ -26,6 +27,7 @@
 #include "xls/synthesis/server_credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
+#include "xls/synthesis/synthesis_sweep.h"
 
 const char kUsage[] = R"(
 Launches a XLS synthesis server which serves dummy results. The flag
@@ -57,25 +59,57 @@ class DummySynthesisServiceImpl : public SynthesisService::Service {
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override {
+    FillResponse(*request, result);
+    if (serve_errors_) {
+      return ::grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Dummy synthesis server error");
+    }
+    return ::grpc::Status::OK;
+  }
+
+  ::grpc::Status Sweep(
+      ::grpc::ServerContext* server_context, const SweepRequest* request,
+      ::grpc::ServerWriter<SynthesisSweepResult>* writer) override {
+    auto compile = [&](const CompileRequest& compile_request)
+        -> absl::StatusOr<CompileResponse> {
+      if (serve_errors_) {
+        return absl::InternalError("Dummy synthesis server error");
+      }
+      CompileResponse response;
+      FillResponse(compile_request, &response);
+      return response;
+    };
+    FrequencySweepOptions options = GetFrequencySweepOptions(*request);
+    for (const CompileRequest& module : request->modules()) {
+      absl::StatusOr<SynthesisSweepResult> result =
+          SweepFrequency(module, options, compile);
+      if (!result.ok()) {
+        return ::grpc::Status(grpc::StatusCode::INTERNAL,
+                              std::string(result.status().message()));
+      }
+      if (!writer->Write(*result)) {
+        return ::grpc::Status(grpc::StatusCode::CANCELLED,
+                              "Sweep cancelled by the client");
+      }
+    }
+    return ::grpc::Status::OK;
+  }
+
+ private:
+  void FillResponse(const CompileRequest& request, CompileResponse* result) {
     auto start = absl::Now();
 
-    result->set_slack_ps(request->target_frequency_hz() <= max_frequency_hz_
+    result->set_slack_ps(request.target_frequency_hz() <= max_frequency_hz_
                              ? 0
-                             : 1e12L / request->target_frequency_hz() -
+                             : 1e12L / request.target_frequency_hz() -
                                    1e12L / max_frequency_hz_);
     result->set_power(42);
     result->set_area(123);
     result->set_netlist("// NETLIST");
     result->set_elapsed_runtime_ms(
         absl::ToInt64Milliseconds(absl::Now() - start));
-    if (serve_errors_) {
-      return ::grpc::Status(grpc::StatusCode::INTERNAL,
-                            "Dummy synthesis server error");
-    }
-    return ::grpc::Status::OK;
   }
 
- private:
   int64_t max_frequency_hz_;
   bool serve_errors_;
 };
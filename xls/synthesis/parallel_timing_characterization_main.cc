@@ -0,0 +1,150 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "grpcpp/channel.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/synthesis/client_credentials.h"
+#include "xls/synthesis/compile_cache.h"
+#include "xls/synthesis/synthesis.pb.h"
+#include "xls/synthesis/synthesis_service.grpc.pb.h"
+#include "xls/synthesis/synthesis_sweep.h"
+
+const char kUsage[] = R"(
+Finds the maximum frequency at which each of the given Verilog modules meets
+timing by bisecting frequencies with Compile requests to synthesis servers.
+Modules are swept concurrently, one at a time per server. With --cache_dir,
+synthesis results are kept on disk, so rerunning a characterization after
+adding modules (e.g., new ops or bit widths) only synthesizes the new modules.
+Usage:
+
+  parallel_timing_characterization_main --servers=host1:10000,host2:10000 \
+      --cache_dir=CACHE_DIR --output_dir=OUTPUT_DIR [VERILOG_FILE...]
+
+For each module, a line "<file>: <max frequency>MHz" is printed to stdout and,
+with --output_dir, its xls.synthesis.SynthesisSweepResult is written to
+<output_dir>/<file stem>.textproto. The modules may be generated by
+op_module_generator, as timing_characterization_client_main does.
+)";
+
+ABSL_FLAG(std::vector<std::string>, servers,
+          std::vector<std::string>({"localhost:10000"}),
+          "Comma-separated addresses of the synthesis servers to use.");
+ABSL_FLAG(std::string, top, "top", "Name of the top module of each file.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "Directory in which to cache synthesis results. Results are not "
+          "cached if unspecified.");
+ABSL_FLAG(std::string, output_dir, "",
+          "Directory to which to write the sweep result of each module.");
+ABSL_FLAG(int64_t, min_freq_mhz, 500, "Minimum frequency to test.");
+ABSL_FLAG(int64_t, max_freq_mhz, 5000, "Maximum frequency to test.");
+ABSL_FLAG(int64_t, tolerance_mhz, 10,
+          "Precision to which the maximum frequency is determined.");
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+CompileFunction MakeGrpcCompileFunction(const std::string& server) {
+  std::shared_ptr<SynthesisService::Stub> stub = SynthesisService::NewStub(
+      ::grpc::CreateChannel(server, GetChannelCredentials()));
+  return [stub, server](
+             const CompileRequest& request) -> absl::StatusOr<CompileResponse> {
+    ::grpc::ClientContext context;
+    CompileResponse response;
+    ::grpc::Status status = stub->Compile(&context, request, &response);
+    if (!status.ok()) {
+      return absl::UnavailableError(
+          absl::StrFormat("Compile request to %s failed: %s", server,
+                          status.error_message()));
+    }
+    return response;
+  };
+}
+
+absl::Status RealMain(absl::Span<const std::string_view> verilog_paths) {
+  std::vector<CompileRequest> requests;
+  for (std::string_view path : verilog_paths) {
+    CompileRequest& request = requests.emplace_back();
+    XLS_ASSIGN_OR_RETURN(*request.mutable_module_text(),
+                         GetFileContents(path));
+    request.set_top_module_name(absl::GetFlag(FLAGS_top));
+  }
+
+  std::vector<CompileFunction> compilers;
+  for (const std::string& server : absl::GetFlag(FLAGS_servers)) {
+    compilers.push_back(MakeGrpcCompileFunction(server));
+  }
+
+  std::optional<CompileCache> cache;
+  if (!absl::GetFlag(FLAGS_cache_dir).empty()) {
+    cache.emplace(absl::GetFlag(FLAGS_cache_dir));
+  }
+
+  FrequencySweepOptions options;
+  options.min_frequency_hz = absl::GetFlag(FLAGS_min_freq_mhz) * 1'000'000;
+  options.max_frequency_hz = absl::GetFlag(FLAGS_max_freq_mhz) * 1'000'000;
+  options.tolerance_hz = absl::GetFlag(FLAGS_tolerance_mhz) * 1'000'000;
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<SynthesisSweepResult> results,
+      ParallelSweepFrequency(requests, options, compilers,
+                             cache.has_value() ? &*cache : nullptr));
+
+  std::filesystem::path output_dir(absl::GetFlag(FLAGS_output_dir));
+  if (!output_dir.empty()) {
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(output_dir));
+  }
+  for (int64_t i = 0; i < results.size(); ++i) {
+    std::cout << absl::StreamFormat("%s: %dMHz\n", verilog_paths[i],
+                                    results[i].max_frequency_hz() / 1'000'000);
+    if (!output_dir.empty()) {
+      std::filesystem::path stem =
+          std::filesystem::path(verilog_paths[i]).stem();
+      XLS_RETURN_IF_ERROR(SetTextProtoFile(
+          output_dir / absl::StrCat(stem.string(), ".textproto"), results[i]));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+  XLS_QCHECK(!positional_arguments.empty())
+      << "At least one Verilog file must be specified.";
+  XLS_QCHECK_OK(xls::synthesis::RealMain(positional_arguments));
+  return EXIT_SUCCESS;
+}
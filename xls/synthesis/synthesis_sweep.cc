@@ -0,0 +1,153 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/synthesis_sweep.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+absl::StatusOr<CompileResponse> CachedCompile(const CompileRequest& request,
+                                              const CompileFunction& compile,
+                                              const CompileCache* cache) {
+  if (cache != nullptr) {
+    XLS_ASSIGN_OR_RETURN(std::optional<CompileResponse> cached,
+                         cache->Lookup(request));
+    if (cached.has_value()) {
+      return *std::move(cached);
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(CompileResponse response, compile(request));
+  if (cache != nullptr) {
+    XLS_RETURN_IF_ERROR(cache->Insert(request, response));
+  }
+  return response;
+}
+
+}  // namespace
+
+FrequencySweepOptions GetFrequencySweepOptions(const SweepRequest& request) {
+  FrequencySweepOptions options;
+  if (request.has_min_frequency_hz()) {
+    options.min_frequency_hz = request.min_frequency_hz();
+  }
+  if (request.has_max_frequency_hz()) {
+    options.max_frequency_hz = request.max_frequency_hz();
+  }
+  if (request.has_tolerance_hz()) {
+    options.tolerance_hz = request.tolerance_hz();
+  }
+  return options;
+}
+
+absl::StatusOr<SynthesisSweepResult> SweepFrequency(
+    const CompileRequest& request, const FrequencySweepOptions& options,
+    const CompileFunction& compile, const CompileCache* cache) {
+  if (options.min_frequency_hz <= 0 ||
+      options.max_frequency_hz < options.min_frequency_hz ||
+      options.tolerance_hz <= 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid frequency sweep: [%d, %d] Hz with tolerance %d Hz",
+        options.min_frequency_hz, options.max_frequency_hz,
+        options.tolerance_hz));
+  }
+  SynthesisSweepResult result;
+  result.set_module_text(request.module_text());
+  if (request.has_signature()) {
+    *result.mutable_signature() = request.signature();
+  }
+  result.set_top_module_name(request.top_module_name());
+  result.set_max_frequency_hz(0);
+
+  int64_t low = options.min_frequency_hz;
+  int64_t high = options.max_frequency_hz;
+  while (high - low > options.tolerance_hz) {
+    int64_t current = low + (high - low) / 2;
+    CompileRequest attempt = request;
+    attempt.set_target_frequency_hz(current);
+    XLS_ASSIGN_OR_RETURN(CompileResponse response,
+                         CachedCompile(attempt, compile, cache));
+    bool met_timing = response.slack_ps() >= 0;
+    XLS_VLOG(1) << absl::StreamFormat("%s at %dMHz (slack %dps)",
+                                      met_timing ? "PASS" : "FAIL",
+                                      current / 1'000'000, response.slack_ps());
+    if (met_timing) {
+      low = current;
+      result.set_max_frequency_hz(current);
+    } else {
+      high = current;
+    }
+    SynthesisSweepResult::SynthesisResult* attempt_result =
+        result.add_results();
+    attempt_result->set_target_frequency_hz(current);
+    *attempt_result->mutable_response() = std::move(response);
+  }
+  return result;
+}
+
+absl::StatusOr<std::vector<SynthesisSweepResult>> ParallelSweepFrequency(
+    absl::Span<const CompileRequest> requests,
+    const FrequencySweepOptions& options,
+    absl::Span<const CompileFunction> compilers, const CompileCache* cache) {
+  if (compilers.empty()) {
+    return absl::InvalidArgumentError("No compile functions given.");
+  }
+  std::vector<SynthesisSweepResult> results(requests.size());
+  std::atomic<int64_t> next_request = 0;
+  absl::Mutex mutex;
+  absl::Status status;
+  auto worker = [&](const CompileFunction& compile) {
+    while (true) {
+      int64_t i = next_request.fetch_add(1);
+      if (i >= requests.size()) {
+        return;
+      }
+      absl::StatusOr<SynthesisSweepResult> result =
+          SweepFrequency(requests[i], options, compile, cache);
+      if (!result.ok()) {
+        absl::MutexLock lock(&mutex);
+        status.Update(result.status());
+        // Abandon the remaining requests.
+        next_request = requests.size();
+        return;
+      }
+      results[i] = *std::move(result);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < compilers.size(); ++i) {
+    threads.push_back(std::make_unique<Thread>(
+        [&worker, &compile = compilers[i]]() { worker(compile); }));
+  }
+  worker(compilers[0]);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  XLS_RETURN_IF_ERROR(status);
+  return results;
+}
+
+}  // namespace synthesis
+}  // namespace xls
@@ -0,0 +1,70 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SYNTHESIS_SYNTHESIS_SWEEP_H_
+#define XLS_SYNTHESIS_SYNTHESIS_SWEEP_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/synthesis/compile_cache.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+
+// Synthesizes the module of a request, typically by issuing a Compile RPC to
+// a synthesis server. Must be callable from any thread.
+using CompileFunction =
+    std::function<absl::StatusOr<CompileResponse>(const CompileRequest&)>;
+
+// The range of target frequencies bisected by SweepFrequency.
+struct FrequencySweepOptions {
+  int64_t min_frequency_hz = 500'000'000;
+  int64_t max_frequency_hz = 5'000'000'000;
+  // Bisection stops once the range of frequencies still in question is at
+  // most this wide.
+  int64_t tolerance_hz = 10'000'000;
+};
+
+// Returns the options of a Sweep RPC.
+FrequencySweepOptions GetFrequencySweepOptions(const SweepRequest& request);
+
+// Finds the maximum frequency at which the module of `request` meets timing by
+// bisecting the range of frequencies in `options`, calling `compile` for each
+// attempted target frequency (the target frequency of `request` is ignored).
+// If `cache` is non-null, responses to requests found in it are reused and new
+// responses are added to it, so a repeated sweep of the same module issues no
+// requests at all.
+absl::StatusOr<SynthesisSweepResult> SweepFrequency(
+    const CompileRequest& request, const FrequencySweepOptions& options,
+    const CompileFunction& compile, const CompileCache* cache = nullptr);
+
+// Calls SweepFrequency for each of `requests`, using one thread per element of
+// `compilers` (e.g., one per synthesis server). Each thread sweeps one request
+// at a time, taking the next unswept request when done. Returns the results in
+// the order of `requests`, or the first error encountered.
+absl::StatusOr<std::vector<SynthesisSweepResult>> ParallelSweepFrequency(
+    absl::Span<const CompileRequest> requests,
+    const FrequencySweepOptions& options,
+    absl::Span<const CompileFunction> compilers,
+    const CompileCache* cache = nullptr);
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_SYNTHESIS_SYNTHESIS_SWEEP_H_
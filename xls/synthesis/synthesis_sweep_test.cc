@@ -0,0 +1,162 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/synthesis_sweep.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/synthesis/compile_cache.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Returns a compile function which meets timing up to the frequency (in MHz)
+// given by the module text, like dummy_synthesis_server_main, and counts the
+// requests it receives.
+CompileFunction MakeFakeCompiler(std::atomic<int64_t>* request_count) {
+  return [request_count](const CompileRequest& request)
+             -> absl::StatusOr<CompileResponse> {
+    ++*request_count;
+    int64_t max_frequency_mhz;
+    if (!absl::SimpleAtoi(request.module_text(), &max_frequency_mhz)) {
+      return absl::InternalError("Synthesis failed");
+    }
+    int64_t max_frequency_hz = max_frequency_mhz * 1'000'000;
+    CompileResponse response;
+    response.set_slack_ps(request.target_frequency_hz() <= max_frequency_hz
+                              ? 0
+                              : 1e12 / request.target_frequency_hz() -
+                                    1e12 / max_frequency_hz);
+    return response;
+  };
+}
+
+CompileRequest MakeRequest(int64_t max_frequency_mhz) {
+  CompileRequest request;
+  request.set_module_text(absl::StrCat(max_frequency_mhz));
+  request.set_top_module_name("top");
+  return request;
+}
+
+TEST(SynthesisSweepTest, FindsMaxFrequency) {
+  std::atomic<int64_t> request_count = 0;
+  FrequencySweepOptions options;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      SynthesisSweepResult result,
+      SweepFrequency(MakeRequest(1234), options,
+                     MakeFakeCompiler(&request_count)));
+  EXPECT_EQ(result.top_module_name(), "top");
+  EXPECT_LE(result.max_frequency_hz(), 1'234'000'000);
+  EXPECT_GT(result.max_frequency_hz(), 1'234'000'000 - options.tolerance_hz);
+  EXPECT_EQ(result.results_size(), request_count);
+
+  XLS_ASSERT_OK_AND_ASSIGN(result,
+                           SweepFrequency(MakeRequest(100), options,
+                                          MakeFakeCompiler(&request_count)));
+  EXPECT_EQ(result.max_frequency_hz(), 0);
+}
+
+TEST(SynthesisSweepTest, CachedSweepIssuesNoRequests) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  CompileCache cache(temp_dir.path());
+  std::atomic<int64_t> request_count = 0;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      SynthesisSweepResult first,
+      SweepFrequency(MakeRequest(2000), FrequencySweepOptions(),
+                     MakeFakeCompiler(&request_count), &cache));
+  EXPECT_GT(request_count, 0);
+
+  request_count = 0;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      SynthesisSweepResult second,
+      SweepFrequency(MakeRequest(2000), FrequencySweepOptions(),
+                     MakeFakeCompiler(&request_count), &cache));
+  EXPECT_EQ(request_count, 0);
+  EXPECT_EQ(second.max_frequency_hz(), first.max_frequency_hz());
+  EXPECT_EQ(second.results_size(), first.results_size());
+}
+
+TEST(SynthesisSweepTest, ParallelSweep) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  CompileCache cache(temp_dir.path());
+  std::vector<std::atomic<int64_t>> request_counts(3);
+  std::vector<CompileFunction> compilers;
+  for (std::atomic<int64_t>& count : request_counts) {
+    count = 0;
+    compilers.push_back(MakeFakeCompiler(&count));
+  }
+  std::vector<CompileRequest> requests;
+  for (int64_t mhz = 600; mhz < 4800; mhz += 300) {
+    requests.push_back(MakeRequest(mhz));
+  }
+  FrequencySweepOptions options;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<SynthesisSweepResult> results,
+      ParallelSweepFrequency(requests, options, compilers, &cache));
+  ASSERT_EQ(results.size(), requests.size());
+  for (int64_t i = 0; i < requests.size(); ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        SynthesisSweepResult expected,
+        SweepFrequency(requests[i], options, compilers[0], &cache));
+    EXPECT_EQ(results[i].module_text(), requests[i].module_text());
+    EXPECT_EQ(results[i].max_frequency_hz(), expected.max_frequency_hz());
+  }
+
+  // Every sweep after the first was answered by the cache.
+  int64_t total_count = 0;
+  for (std::atomic<int64_t>& count : request_counts) {
+    total_count += count;
+  }
+  std::atomic<int64_t> rerun_count = 0;
+  std::vector<CompileFunction> rerun_compilers = {
+      MakeFakeCompiler(&rerun_count), MakeFakeCompiler(&rerun_count)};
+  XLS_ASSERT_OK(
+      ParallelSweepFrequency(requests, options, rerun_compilers, &cache)
+          .status());
+  EXPECT_GT(total_count, 0);
+  EXPECT_EQ(rerun_count, 0);
+}
+
+TEST(SynthesisSweepTest, ParallelSweepError) {
+  std::atomic<int64_t> request_count = 0;
+  std::vector<CompileFunction> compilers = {MakeFakeCompiler(&request_count),
+                                            MakeFakeCompiler(&request_count)};
+  std::vector<CompileRequest> requests = {MakeRequest(1000), MakeRequest(2000)};
+  requests.push_back(requests.front());
+  requests.back().set_module_text("not a frequency");
+  EXPECT_THAT(ParallelSweepFrequency(requests, FrequencySweepOptions(),
+                                     compilers),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Synthesis failed")));
+  EXPECT_THAT(ParallelSweepFrequency(requests, FrequencySweepOptions(), {}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
@@ -14,7 +14,7 @@
 # limitations under the License.
 """Utility functions used in synthesis."""
 
-from typing import Sequence, Callable, TypeVar, Optional
+from typing import Iterator, Sequence, Callable, TypeVar, Optional
 
 from absl import logging
 
@@ -112,3 +112,39 @@ def bisect_frequency(
   run_bisect(0,
              len(frequencies) - 1, frequencies, run_sample, sample_meets_timing)
   return sweep_result
+
+
+def sweep_frequencies(
+    verilog_texts: Sequence[str], top_module_name: str, start_hz: int,
+    limit_hz: int, tolerance_hz: int, grpc_channel: grpc.Channel
+) -> Iterator[synthesis_pb2.SynthesisSweepResult]:
+  """Determines the maximum frequency of each Verilog module with one RPC.
+
+  Unlike bisect_frequency, the bisection runs on the server, which may reuse
+  work between the target frequencies of a module.
+
+  Args:
+    verilog_texts: Texts of the Verilog modules.
+    top_module_name: The name of the top module to synthesize.
+    start_hz: Lowest frequency (inclusive) to search.
+    limit_hz: Highest frequency (inclusive) to search.
+    tolerance_hz: The bisection stops once the range of frequencies in question
+      is at most this wide.
+    grpc_channel: A channel to the SynthesisService GRPC service to use for
+      synthesizing the verilog.
+
+  Yields:
+    A SynthesisSweepResult for each module in order, as soon as its sweep
+    completes.
+  """
+  grpc.channel_ready_future(grpc_channel).result()
+  stub = synthesis_service_pb2_grpc.SynthesisServiceStub(grpc_channel)
+  request = synthesis_pb2.SweepRequest()
+  for verilog_text in verilog_texts:
+    module = request.modules.add()
+    module.module_text = verilog_text
+    module.top_module_name = top_module_name
+  request.min_frequency_hz = start_hz
+  request.max_frequency_hz = limit_hz
+  request.tolerance_hz = tolerance_hz
+  yield from stub.Sweep(request)
@@ -113,6 +113,38 @@ class SynthesisUtilsTest(absltest.TestCase):
     proc.terminate()
     proc.wait()
 
+  def test_sweep_frequencies(self):
+    port, proc = self._start_server(['--max_frequency_ghz=2.0'])
+
+    channel_creds = client_credentials.get_credentials()
+    with grpc.secure_channel(f'localhost:{port}', channel_creds) as channel:
+      results = list(
+          synthesis_utils.sweep_frequencies(['verilog_a', 'verilog_b'], 'main',
+                                            int(1.5e9), int(3e9), int(0.1e9),
+                                            channel))
+    self.assertLen(results, 2)
+    self.assertEqual(results[0].module_text, 'verilog_a')
+    self.assertEqual(results[1].module_text, 'verilog_b')
+    for result in results:
+      self.assertLessEqual(result.max_frequency_hz, int(2e9))
+      self.assertGreater(result.max_frequency_hz, int(1.9e9))
+      self.assertLen(result.results, 4)
+    proc.terminate()
+    proc.wait()
+
+  def test_sweep_frequencies_with_error(self):
+    port, proc = self._start_server(
+        ['--max_frequency_ghz=2.0', '--serve_errors'])
+
+    channel_creds = client_credentials.get_credentials()
+    with grpc.secure_channel(f'localhost:{port}', channel_creds) as channel:
+      with self.assertRaises(grpc.RpcError):
+        _ = list(
+            synthesis_utils.sweep_frequencies(['verilog'], 'main', int(1.5e9),
+                                              int(3e9), int(0.1e9), channel))
+    proc.terminate()
+    proc.wait()
+
 
 if __name__ == '__main__':
   absltest.main()
@@ -34,6 +34,7 @@
 #include "xls/synthesis/server_credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
+#include "xls/synthesis/synthesis_sweep.h"
 #include "xls/synthesis/yosys/yosys_util.h"
 
 const char kUsage[] =
@@ -86,6 +87,32 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
     return ::grpc::Status::OK;
   }
 
+  // Sweeps the frequencies of each module. Yosys synthesis does not depend on
+  // the target frequency, so each module is synthesized once and only place
+  // and route runs for every target frequency.
+  ::grpc::Status Sweep(
+      ::grpc::ServerContext* server_context, const SweepRequest* request,
+      ::grpc::ServerWriter<SynthesisSweepResult>* writer) override {
+    if (absl::GetFlag(FLAGS_synthesis_only)) {
+      return ::grpc::Status(grpc::StatusCode::FAILED_PRECONDITION,
+                            "Sweeping requires place and route.");
+    }
+    FrequencySweepOptions options = GetFrequencySweepOptions(*request);
+    for (const CompileRequest& module : request->modules()) {
+      absl::StatusOr<SynthesisSweepResult> result =
+          SweepModule(module, options);
+      if (!result.ok()) {
+        return ::grpc::Status(grpc::StatusCode::INTERNAL,
+                              std::string(result.status().message()));
+      }
+      if (!writer->Write(*result)) {
+        return ::grpc::Status(grpc::StatusCode::CANCELLED,
+                              "Sweep cancelled by the client");
+      }
+    }
+    return ::grpc::Status::OK;
+  }
+
   // Run the given arguments as a subprocess with InvokeSubprocess.
   // InvokeSubprocess is wrapped because the error message can be very large (it
   // includes both stdout and stderr) which breaks propagation of the error via
@@ -118,24 +145,65 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
   // CompileRequest.
   absl::Status RunSynthesis(const CompileRequest* request,
                             CompileResponse* result) {
-    if (request->top_module_name().empty()) {
-      return absl::InvalidArgumentError("Must specify top module name.");
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
+    std::filesystem::path temp_dir_path = temp_dir.path();
+    if (absl::GetFlag(FLAGS_save_temps)) {
+      std::move(temp_dir).Release();
     }
+    XLS_RETURN_IF_ERROR(RunYosys(*request, temp_dir_path, result));
 
+    // If only synthesis requested, done.
+    if (absl::GetFlag(FLAGS_synthesis_only)) {
+      return absl::OkStatus();
+    }
+    return RunNextpnr(*request, temp_dir_path, result);
+  }
+
+  // Synthesizes the module with yosys once, then bisects its target frequency
+  // running only nextpnr.
+  absl::StatusOr<SynthesisSweepResult> SweepModule(
+      const CompileRequest& request, const FrequencySweepOptions& options) {
     XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
     std::filesystem::path temp_dir_path = temp_dir.path();
     if (absl::GetFlag(FLAGS_save_temps)) {
       std::move(temp_dir).Release();
     }
+    absl::Time synthesis_start = absl::Now();
+    CompileResponse synthesis_result;
+    XLS_RETURN_IF_ERROR(RunYosys(request, temp_dir_path, &synthesis_result));
+    absl::Duration synthesis_time = absl::Now() - synthesis_start;
+    // The elapsed runtime of each attempt includes the shared synthesis.
+    auto place_and_route = [&](const CompileRequest& attempt)
+        -> absl::StatusOr<CompileResponse> {
+      absl::Time start = absl::Now();
+      CompileResponse result = synthesis_result;
+      XLS_RETURN_IF_ERROR(RunNextpnr(attempt, temp_dir_path, &result));
+      result.set_elapsed_runtime_ms(
+          absl::ToInt64Milliseconds(absl::Now() - start + synthesis_time));
+      return result;
+    };
+    return SweepFrequency(request, options, place_and_route);
+  }
+
+  // Invokes yosys to synthesize the verilog given in the CompileRequest into
+  // the netlist `temp_dir_path`/netlist.json, adding the netlist and the
+  // synthesis statistics to `result`.
+  absl::Status RunYosys(const CompileRequest& request,
+                        const std::filesystem::path& temp_dir_path,
+                        CompileResponse* result) {
+    if (request.top_module_name().empty()) {
+      return absl::InvalidArgumentError("Must specify top module name.");
+    }
+
     std::filesystem::path verilog_path = temp_dir_path / "input.v";
-    XLS_RETURN_IF_ERROR(SetFileContents(verilog_path, request->module_text()));
+    XLS_RETURN_IF_ERROR(SetFileContents(verilog_path, request.module_text()));
 
     // Invoke yosys to generate netlist.
     std::filesystem::path netlist_path = temp_dir_path / "netlist.json";
     std::pair<std::string, std::string> string_pair;
     std::string yosys_cmd =
         absl::StrFormat("synth_%s -top %s -json %s", synthesis_target_,
-                        request->top_module_name(), netlist_path.string());
+                        request.top_module_name(), netlist_path.string());
     XLS_LOG(INFO) << "yosys cmd: " << yosys_cmd;
     XLS_ASSIGN_OR_RETURN(
         string_pair,
@@ -161,12 +229,16 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
             ->mutable_cell_histogram())[name_count.first] = name_count.second;
     }
 
-    // If only synthesis requested, done.
-    if (absl::GetFlag(FLAGS_synthesis_only)) {
-      return absl::OkStatus();
-    }
+    return absl::OkStatus();
+  }
 
-    // Invoke nextpnr for place and route.
+  // Invokes nextpnr to place and route the netlist written by RunYosys in
+  // `temp_dir_path`, adding the maximum frequency and, given a target
+  // frequency, the slack to `result`.
+  absl::Status RunNextpnr(const CompileRequest& request,
+                          const std::filesystem::path& temp_dir_path,
+                          CompileResponse* result) {
+    std::filesystem::path netlist_path = temp_dir_path / "netlist.json";
     std::optional<std::filesystem::path> pnr_path;
     std::vector<std::string> nextpnr_args = {nextpnr_path_, "--json",
                                              netlist_path.string()};
@@ -180,11 +252,12 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
       nextpnr_args.push_back("--hx8k");
     }
 
-    if (request->has_target_frequency_hz()) {
+    if (request.has_target_frequency_hz()) {
       nextpnr_args.push_back("--freq");
       nextpnr_args.push_back(
-          absl::StrCat(request->has_target_frequency_hz() / 1000000));
+          absl::StrCat(request.target_frequency_hz() / 1000000));
     }
+    std::pair<std::string, std::string> string_pair;
     XLS_ASSIGN_OR_RETURN(string_pair, RunSubprocess(nextpnr_args));
     auto [nextpnr_stdout, nextpnr_stderr] = string_pair;
     if (absl::GetFlag(FLAGS_save_temps)) {
@@ -204,6 +277,10 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
                          ParseNextpnrOutput(nextpnr_stderr));
     result->set_max_frequency_hz(max_frequency_hz);
     XLS_LOG(INFO) << "max_frequency_mhz: " << (max_frequency_hz / 1e6);
+    if (request.target_frequency_hz() > 0 && max_frequency_hz > 0) {
+      result->set_slack_ps(1e12L / request.target_frequency_hz() -
+                           1e12L / max_frequency_hz);
+    }
 
     return absl::OkStatus();
   }
@@ -13,25 +13,33 @@
 // limitations under the License.
 
 #include <cstdint>
+#include <iostream>
 #include <limits>
+#include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/time/clock.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/parallel_for.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/passes/bdd_function.h"
+#include "xls/tools/ir_stats.pb.h"
+#include "xls/tools/proto_results.h"
 
 const char* kUsage = R"(
 Builds a BDD from XLS IR and prints various metrics about the BDD. Usage:
 
-To gather BDD stats of an IR file:
-   bdd_stats <ir_file>
+To gather BDD stats of one or more IR files:
+   bdd_stats <ir_file> [<ir_file>...]
 
 To gather BDD stats of a set of benchmarks:
    bdd_stats --benchmarks=sha256,crc32
@@ -41,98 +49,160 @@ To gather BDD stats of a set of benchmarks:
 ABSL_FLAG(int64_t, bdd_path_limit, 0,
           "Maximum number of paths before truncating the BDD subgraph "
           "and declaring a new variable. If zero, then no limit.");
+ABSL_FLAG(int64_t, bdd_node_limit, xls::BddFunction::kDefaultNodeLimit,
+          "Maximum number of nodes in the BDD. Unreferenced nodes are garbage "
+          "collected when the BDD exceeds this size. If zero, then no limit.");
 ABSL_FLAG(std::vector<std::string>, benchmarks, {},
           "Comma-separated list of benchmarks gather BDD stats about.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads to build BDDs of different packages on; zero "
+          "for one per hardware thread.");
+ABSL_FLAG(std::string, results_path, "",
+          "If specified, the statistics are also written to this file as a "
+          "BddStatsResultsProto in the format given by --results_format.");
+ABSL_FLAG(std::string, results_format, "textproto",
+          "Format of the file written to --results_path. One of: textproto, "
+          "json.");
 
 namespace xls {
 namespace {
 
-// Return list of pairs of {name, Package} for the specified bechmarks.
-absl::StatusOr<std::vector<std::pair<std::string, std::unique_ptr<Package>>>>
-GetBenchmarks(absl::Span<const std::string> benchmark_names) {
-  std::vector<std::pair<std::string, std::unique_ptr<Package>>> packages;
-  std::vector<std::string> names;
+// Returns the names of the specified benchmarks.
+absl::StatusOr<std::vector<std::string>> GetBenchmarkNames(
+    absl::Span<const std::string> benchmark_names) {
   if (benchmark_names.size() == 1 && benchmark_names.front() == "all") {
-    XLS_ASSIGN_OR_RETURN(names, sample_packages::GetBenchmarkNames());
-  } else {
-    names = std::vector<std::string>(benchmark_names.begin(),
-                                     benchmark_names.end());
+    return sample_packages::GetBenchmarkNames();
   }
-  for (const std::string& name : names) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<Package> package,
-        sample_packages::GetBenchmark(name, /*optimized=*/true));
-    packages.push_back({name, std::move(package)});
+  return std::vector<std::string>(benchmark_names.begin(),
+                                  benchmark_names.end());
+}
+
+// Loads the named benchmark or parses the IR file at the given path.
+absl::StatusOr<std::unique_ptr<Package>> GetPackage(std::string_view name,
+                                                    bool is_benchmark) {
+  if (is_benchmark) {
+    return sample_packages::GetBenchmark(name, /*optimized=*/true);
   }
-  return packages;
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(name));
+  return Parser::ParsePackage(contents, name);
 }
 
-absl::Status RealMain(std::string_view input_path) {
-  std::vector<std::pair<std::string, std::unique_ptr<Package>>> packages;
-  if (absl::GetFlag(FLAGS_benchmarks).empty()) {
-    XLS_QCHECK(!input_path.empty());
-    std::string path;
-    if (input_path == "-") {
-      path = "/dev/stdin";
-    } else {
-      path = std::string(input_path);
-    }
-    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                         Parser::ParsePackage(contents, path));
-    packages.push_back({path, std::move(package)});
-  } else {
-    XLS_ASSIGN_OR_RETURN(packages,
-                         GetBenchmarks(absl::GetFlag(FLAGS_benchmarks)));
+// Builds the BDD of the top entity of the named package and returns
+// statistics about it.
+absl::StatusOr<BddStatsProto> GetBddStats(std::string_view name,
+                                          bool is_benchmark) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       GetPackage(name, is_benchmark));
+  std::optional<FunctionBase*> top = package->GetTop();
+  if (!top.has_value()) {
+    return absl::InternalError(absl::StrFormat(
+        "Top entity not set for package: %s.", package->name()));
   }
+  BddStatsProto stats;
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<BddFunction> bdd_function,
+      BddFunction::Run(top.value(), absl::GetFlag(FLAGS_bdd_path_limit),
+                       /*node_filter=*/absl::nullopt,
+                       absl::GetFlag(FLAGS_bdd_node_limit)));
+  stats.set_construction_time_us(
+      absl::ToInt64Microseconds(absl::Now() - start));
+  const BinaryDecisionDiagram& bdd = bdd_function->bdd();
+  stats.set_bdd_node_count(bdd.size());
+  stats.set_variable_count(bdd.variable_count());
+  stats.set_computed_table_size(bdd.computed_table_size());
+  stats.set_computed_table_lookups(bdd.computed_table_lookups());
+  stats.set_computed_table_hits(bdd.computed_table_hits());
+
+  int64_t number_bits = 0;
+  for (Node* node : top.value()->nodes()) {
+    number_bits += node->GetType()->GetFlatBitCount();
+  }
+  stats.set_bits_in_graph(number_bits);
 
-  absl::Duration total_time;
-  for (const auto& pair : packages) {
-    const std::string& name = pair.first;
-    const auto& package = pair.second;
-    if (packages.size() > 1) {
-      // Use endl to flush cout so the banner appears before starting work on
-      // the BDD.
-      std::cout << "================== " << name << std::endl;
-    }
-    std::optional<FunctionBase*> top = package->GetTop();
-    if (!top.has_value()) {
-      return absl::InternalError(absl::StrFormat(
-          "Top entity not set for package: %s.", package->name()));
-    }
-    absl::Time start = absl::Now();
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<BddFunction> bdd_function,
-        BddFunction::Run(top.value(), absl::GetFlag(FLAGS_bdd_path_limit)));
-    absl::Duration bdd_time = absl::Now() - start;
-    total_time += bdd_time;
-    std::cout << "BDD construction time: " << bdd_time << "\n";
-    std::cout << "BDD node count: " << bdd_function->bdd().size() << "\n";
-    std::cout << "BDD variable count: " << bdd_function->bdd().variable_count()
+  int64_t max_paths = 0;
+  for (int64_t i = 0; i < bdd.size(); ++i) {
+    max_paths = std::max(max_paths, bdd.path_count(BddNodeIndex(i)));
+  }
+  stats.set_max_paths(max_paths);
+  return stats;
+}
+
+void PrintStats(const BddStatsProto& stats) {
+  std::cout << "BDD construction time: "
+            << absl::Microseconds(stats.construction_time_us()) << "\n";
+  std::cout << "BDD node count: " << stats.bdd_node_count() << "\n";
+  std::cout << absl::StreamFormat(
+      "BDD computed table: %d entries, %d lookups, %.1f%% hit rate\n",
+      stats.computed_table_size(), stats.computed_table_lookups(),
+      stats.computed_table_lookups() == 0
+          ? 0.0
+          : 100.0 * stats.computed_table_hits() /
+                stats.computed_table_lookups());
+  std::cout << "BDD variable count: " << stats.variable_count() << "\n";
+  std::cout << "Bits in graph: " << stats.bits_in_graph() << "\n";
+  if (stats.max_paths() == std::numeric_limits<int32_t>::max()) {
+    std::cout << "Maximum paths of any expression: INT32_MAX\n";
+  } else {
+    std::cout << "Maximum paths of any expression: " << stats.max_paths()
               << "\n";
+  }
+}
 
-    int64_t number_bits = 0;
-    for (Node* node : top.value()->nodes()) {
-      number_bits += node->GetType()->GetFlatBitCount();
+absl::Status RealMain(absl::Span<const std::string_view> input_paths) {
+  // Each package is loaded (or parsed) and analyzed by a single thread; the
+  // packages are analyzed concurrently.
+  std::vector<std::string> names;
+  bool is_benchmark = !absl::GetFlag(FLAGS_benchmarks).empty();
+  if (is_benchmark) {
+    XLS_ASSIGN_OR_RETURN(names,
+                         GetBenchmarkNames(absl::GetFlag(FLAGS_benchmarks)));
+  } else {
+    XLS_QCHECK(!input_paths.empty());
+    for (std::string_view path : input_paths) {
+      names.push_back(path == "-" ? "/dev/stdin" : std::string(path));
     }
-    std::cout << "Bits in graph: " << number_bits << "\n";
+  }
 
-    int64_t max_paths = 0;
-    for (int64_t i = 0; i < bdd_function->bdd().size(); ++i) {
-      max_paths =
-          std::max(max_paths, bdd_function->bdd().path_count(BddNodeIndex(i)));
-    }
-    if (max_paths == std::numeric_limits<int32_t>::max()) {
-      std::cout << "Maximum paths of any expression: INT32_MAX\n";
-    } else {
-      std::cout << "Maximum paths of any expression: " << max_paths << "\n";
+  BddStatsResultsProto results;
+  for (const std::string& name : names) {
+    results.add_packages()->set_name(name);
+  }
+  std::vector<absl::Status> statuses(names.size());
+  absl::Time start = absl::Now();
+  ParallelFor(names.size(), absl::GetFlag(FLAGS_threads), [&](int64_t i) {
+    absl::StatusOr<BddStatsProto> stats = GetBddStats(names[i], is_benchmark);
+    if (!stats.ok()) {
+      statuses[i] = stats.status();
+      return;
     }
+    stats->set_name(names[i]);
+    *results.mutable_packages(i) = *std::move(stats);
+  });
+  results.set_wall_time_us(absl::ToInt64Microseconds(absl::Now() - start));
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
   }
 
-  if (packages.size() > 1) {
+  absl::Duration total_time;
+  for (const BddStatsProto& stats : results.packages()) {
+    if (results.packages_size() > 1) {
+      std::cout << "================== " << stats.name() << "\n";
+    }
+    PrintStats(stats);
+    total_time += absl::Microseconds(stats.construction_time_us());
+  }
+  if (results.packages_size() > 1) {
     std::cout << "\nTotal construction time: " << total_time << "\n";
+    std::cout << "Wall-clock time: "
+              << absl::Microseconds(results.wall_time_us()) << "\n";
   }
 
+  if (!absl::GetFlag(FLAGS_results_path).empty()) {
+    XLS_RETURN_IF_ERROR(WriteProtoResults(
+        results, absl::GetFlag(FLAGS_results_path),
+        absl::GetFlag(FLAGS_results_format)));
+  }
   return absl::OkStatus();
 }
 
@@ -145,11 +215,11 @@ int main(int argc, char** argv) {
 
   if (positional_arguments.empty() && absl::GetFlag(FLAGS_benchmarks).empty()) {
     XLS_LOG(QFATAL) << absl::StreamFormat(
-        "Expected invocation:\n  %s <path>\n  %s "
+        "Expected invocation:\n  %s <path>...\n  %s "
         "--benchmarks=<benchmark-names>",
         argv[0], argv[0]);
   }
 
-  XLS_QCHECK_OK(xls::RealMain(positional_arguments[0]));
+  XLS_QCHECK_OK(xls::RealMain(positional_arguments));
   return EXIT_SUCCESS;
 }
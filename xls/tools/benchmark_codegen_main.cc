@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <numeric>
 
 #include "absl/status/status.h"
@@ -22,6 +23,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/contrib/integrator/area_model/area_estimator.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
 #include "xls/ir/ir_parser.h"
@@ -40,6 +42,9 @@ Usage:
 ABSL_FLAG(std::string, top, "",
           "Name of top block to use in lieu of the default.");
 ABSL_FLAG(bool, schedule, true, "Enable running the scheduler.");
+ABSL_FLAG(std::string, area_model, "",
+          "Name of the area model used to estimate the area of the block. If "
+          "empty, the area is not estimated.");
 
 namespace xls {
 namespace {
@@ -109,10 +114,24 @@ absl::Status RealMain(std::string_view opt_ir_path,
         opt_package.get(), *delay_estimator.value(), scheduling_options));
   }
 
+  std::unique_ptr<AreaEstimator> area_estimator;
+  if (!absl::GetFlag(FLAGS_area_model).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        area_estimator,
+        GetAreaEstimatorByName(absl::GetFlag(FLAGS_area_model)));
+  }
+
   XLS_ASSIGN_OR_RETURN(Block * top, GetTopBlock(block_package.get()));
-  XLS_ASSIGN_OR_RETURN(verilog::BlockMetricsProto metrics,
-                       verilog::GenerateBlockMetrics(top, delay_estimator));
+  XLS_ASSIGN_OR_RETURN(
+      verilog::BlockMetricsProto metrics,
+      verilog::GenerateBlockMetrics(
+          top, delay_estimator,
+          area_estimator == nullptr
+              ? std::nullopt
+              : std::optional<const AreaEstimator*>(area_estimator.get())));
   std::cout << absl::StreamFormat("Flop count: %d\n", metrics.flop_count());
+  std::cout << absl::StreamFormat("Load-enabled flop count: %d\n",
+                                  metrics.enabled_flop_count());
   std::cout << absl::StreamFormat(
       "Has feedthrough path: %s\n",
       metrics.feedthrough_path_exists() ? "true" : "false");
@@ -132,6 +151,23 @@ absl::Status RealMain(std::string_view opt_ir_path,
     std::cout << absl::StreamFormat("Max feedthrough path delay: %dps\n",
                                     metrics.max_feedthrough_path_delay_ps());
   }
+  for (const verilog::PipelineStageMetricsProto& stage :
+       metrics.pipeline_stages()) {
+    if (stage.has_max_delay_ps()) {
+      std::cout << absl::StreamFormat("Stage %d delay: %dps\n", stage.stage(),
+                                      stage.max_delay_ps());
+    }
+  }
+  for (const verilog::DelayHistogramBucketProto& bucket :
+       metrics.reg_to_reg_delay_histogram()) {
+    std::cout << absl::StreamFormat("Reg-to-reg paths [%dps, %dps): %d\n",
+                                    bucket.lower_bound_ps(),
+                                    bucket.upper_bound_ps(), bucket.count());
+  }
+  if (metrics.has_estimated_area()) {
+    std::cout << absl::StreamFormat("Estimated area: %d\n",
+                                    metrics.estimated_area());
+  }
   std::cout << absl::StreamFormat(
       "Lines of Verilog: %d\n",
       std::vector<std::string>(absl::StrSplit(verilog_contents, '\n')).size());
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
+#include <functional>
 #include <numeric>
 
 #include "absl/status/status.h"
@@ -36,9 +38,13 @@
 #include "xls/jit/function_jit.h"
 #include "xls/jit/proc_jit.h"
 #include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/pass_metrics.h"
 #include "xls/passes/passes.h"
 #include "xls/passes/standard_pipeline.h"
 #include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_metrics.h"
+#include "xls/tools/benchmark.pb.h"
+#include "xls/tools/proto_results.h"
 
 const char kUsage[] = R"(
 Prints numerous metrics and other information about an XLS IR file including:
@@ -51,6 +57,9 @@ where:
 
 Example invocation:
   benchmark_main path/to/file.ir
+
+Timed stages may be repeated with --repetitions (after --warmup_repetitions
+untimed runs) and the results written in structured form with --results_path.
 )";
 
 // LINT.IfChange
@@ -84,6 +93,23 @@ ABSL_FLAG(int64_t, convert_array_index_to_select, -1,
           "equal to the given number of possible indices (by range analysis) "
           "into chains of selects. Otherwise, this optimization is skipped, "
           "since it can sometimes reduce output quality.");
+ABSL_FLAG(std::string, scheduling_metrics_path, "",
+          "If specified, the metrics gathered while scheduling are written to "
+          "this file as a SchedulingMetricsProto in text format.");
+ABSL_FLAG(int64_t, repetitions, 1,
+          "Number of timed repetitions of each timed stage (optimization, JIT "
+          "compilation and execution, interpretation, scheduling and "
+          "codegen). The median is printed and summary statistics over all "
+          "repetitions are recorded in the results.");
+ABSL_FLAG(int64_t, warmup_repetitions, 0,
+          "Number of untimed runs of each timed stage performed before the "
+          "timed repetitions.");
+ABSL_FLAG(std::string, results_path, "",
+          "If specified, the results of the benchmark are written to this file "
+          "as a BenchmarkResultProto in the format given by --results_format.");
+ABSL_FLAG(std::string, results_format, "textproto",
+          "Format of the file written to --results_path. One of: textproto, "
+          "json.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls {
@@ -96,7 +122,8 @@ std::string KnownBitString(Node* node, const QueryEngine& query_engine) {
   return query_engine.ToString(node);
 }
 
-void PrintNodeBreakdown(FunctionBase* f) {
+void PrintNodeBreakdown(FunctionBase* f, BenchmarkResultProto* results) {
+  results->set_node_count(f->node_count());
   std::cout << absl::StreamFormat("Entry function (%s) node count: %d nodes\n",
                                   f->name(), f->node_count());
   std::vector<Op> ops;
@@ -117,16 +144,80 @@ void PrintNodeBreakdown(FunctionBase* f) {
   }
 }
 
-int64_t DurationToMs(absl::Duration duration) {
-  return duration / absl::Milliseconds(1);
+// Calls `run` --warmup_repetitions times and then --repetitions times,
+// returning the durations reported by the latter calls. `run` measures and
+// returns the duration of its own timed region so that setup (e.g., making a
+// fresh copy of the IR) can be excluded.
+absl::StatusOr<std::vector<absl::Duration>> RunRepeatedly(
+    const std::function<absl::StatusOr<absl::Duration>()>& run) {
+  int64_t warmup_repetitions = absl::GetFlag(FLAGS_warmup_repetitions);
+  int64_t repetitions = absl::GetFlag(FLAGS_repetitions);
+  XLS_RET_CHECK_GE(warmup_repetitions, 0);
+  XLS_RET_CHECK_GT(repetitions, 0);
+  for (int64_t i = 0; i < warmup_repetitions; ++i) {
+    XLS_RETURN_IF_ERROR(run().status());
+  }
+  std::vector<absl::Duration> durations;
+  for (int64_t i = 0; i < repetitions; ++i) {
+    XLS_ASSIGN_OR_RETURN(absl::Duration duration, run());
+    durations.push_back(duration);
+  }
+  return durations;
+}
+
+TimingStatsProto SummarizeDurations(
+    absl::Span<const absl::Duration> durations) {
+  std::vector<double> us;
+  for (absl::Duration duration : durations) {
+    us.push_back(absl::ToDoubleMicroseconds(duration));
+  }
+  std::sort(us.begin(), us.end());
+  TimingStatsProto stats;
+  stats.set_repetitions(us.size());
+  if (us.empty()) {
+    return stats;
+  }
+  double mean = std::accumulate(us.begin(), us.end(), 0.0) / us.size();
+  double variance = 0.0;
+  for (double x : us) {
+    variance += (x - mean) * (x - mean);
+  }
+  variance /= us.size();
+  int64_t mid = us.size() / 2;
+  stats.set_mean_us(mean);
+  stats.set_median_us(us.size() % 2 == 0 ? (us[mid - 1] + us[mid]) / 2.0
+                                         : us[mid]);
+  stats.set_min_us(us.front());
+  stats.set_max_us(us.back());
+  stats.set_stddev_us(std::sqrt(variance));
+  return stats;
+}
+
+// Prints the median of the given durations as "<label>: <median>ms" and
+// records summary statistics in `results` under `key`.
+void ReportTiming(std::string_view label, std::string_view key,
+                  absl::Span<const absl::Duration> durations,
+                  BenchmarkResultProto* results) {
+  TimingStatsProto stats = SummarizeDurations(durations);
+  int64_t median_ms = static_cast<int64_t>(stats.median_us() / 1000.0);
+  if (stats.repetitions() <= 1) {
+    std::cout << absl::StreamFormat("%s: %dms\n", label, median_ms);
+  } else {
+    std::cout << absl::StreamFormat(
+        "%s: %dms (median of %d; min %.1fms, max %.1fms, stddev %.1fms)\n",
+        label, median_ms, stats.repetitions(), stats.min_us() / 1000.0,
+        stats.max_us() / 1000.0, stats.stddev_us() / 1000.0);
+  }
+  (*results->mutable_timings())[std::string(key)] = std::move(stats);
 }
 
 // Run the standard pipeline on the given package and prints stats about the
-// passes and execution time.
-absl::Status RunOptimizationAndPrintStats(Package* package) {
+// passes and execution time. When repeated, all but the last run optimize a
+// fresh copy of the package so that each run sees the same input.
+absl::Status RunOptimizationAndPrintStats(Package* package,
+                                          BenchmarkResultProto* results) {
   std::unique_ptr<CompoundPass> pipeline = CreateStandardPassPipeline();
 
-  absl::Time start = absl::Now();
   PassOptions pass_options;
   int64_t convert_array_index_to_select =
       absl::GetFlag(FLAGS_convert_array_index_to_select);
@@ -136,52 +227,53 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
           : std::make_optional(convert_array_index_to_select);
   // TODO(meheff): 2022/3/23 Add this as a flag and benchmark_ir option.
   pass_options.inline_procs = true;
+
+  const std::string ir_text = package->DumpIr();
+  const std::string top_name = package->GetTop().value()->name();
+  const int64_t total_runs = absl::GetFlag(FLAGS_warmup_repetitions) +
+                             absl::GetFlag(FLAGS_repetitions);
+  int64_t run_count = 0;
   PassResults pass_results;
-  XLS_RETURN_IF_ERROR(
-      pipeline->Run(package, pass_options, &pass_results).status());
-  absl::Duration total_time = absl::Now() - start;
-  std::cout << absl::StreamFormat("Optimization time: %dms\n",
-                                  DurationToMs(total_time));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<absl::Duration> durations,
+      RunRepeatedly([&]() -> absl::StatusOr<absl::Duration> {
+        std::unique_ptr<Package> copy;
+        Package* to_optimize = package;
+        if (++run_count < total_runs) {
+          XLS_ASSIGN_OR_RETURN(copy, Parser::ParsePackage(ir_text));
+          XLS_RETURN_IF_ERROR(copy->SetTopByName(top_name));
+          to_optimize = copy.get();
+        }
+        pass_results = PassResults();
+        absl::Time start = absl::Now();
+        XLS_RETURN_IF_ERROR(
+            pipeline->Run(to_optimize, pass_options, &pass_results).status());
+        return absl::Now() - start;
+      }));
+  ReportTiming("Optimization time", "optimization", durations, results);
   std::cout << absl::StreamFormat("Dynamic pass count: %d\n",
                                   pass_results.invocations.size());
 
-  // Aggregate run times by the pass name and print a table of the aggregate
-  // execution time of each pass in decending order.
-  absl::flat_hash_map<std::string, absl::Duration> pass_times;
-  absl::flat_hash_map<std::string, int64_t> pass_counts;
-  absl::flat_hash_map<std::string, int64_t> changed_counts;
-  for (const PassInvocation& invocation : pass_results.invocations) {
-    pass_times[invocation.pass_name] += invocation.run_duration;
-    ++pass_counts[invocation.pass_name];
-    changed_counts[invocation.pass_name] += invocation.ir_changed ? 1 : 0;
-  }
-  std::vector<std::string> pass_names;
-  for (const auto& pair : pass_times) {
-    pass_names.push_back(pair.first);
-  }
-  std::sort(pass_names.begin(), pass_names.end(),
-            [&](const std::string& a, const std::string& b) {
-              return pass_times.at(a) > pass_times.at(b);
-            });
-  std::cout << "Pass run durations (# of times pass changed IR / # of times "
-               "pass was run):"
-            << std::endl;
-  for (const std::string& name : pass_names) {
-    std::cout << absl::StreamFormat("  %-20s : %-5dms (%3d / %3d)\n", name,
-                                    DurationToMs(pass_times.at(name)),
-                                    changed_counts.at(name),
-                                    pass_counts.at(name));
-  }
+  // Print a table of the aggregate execution time of each pass in descending
+  // order.
+  PipelineMetricsProto metrics = SummarizePassResults(pass_results);
+  std::cout << absl::StreamFormat(
+      "Node count before/after optimization: %d/%d\n",
+      metrics.initial_node_count(), metrics.final_node_count());
+  std::cout << PipelineMetricsToString(metrics);
+  *results->mutable_pass_metrics() = std::move(metrics);
   return absl::OkStatus();
 }
 
 absl::Status PrintCriticalPath(
     FunctionBase* f, const QueryEngine& query_engine,
     const DelayEstimator& delay_estimator,
-    std::optional<int64_t> effective_clock_period_ps) {
+    std::optional<int64_t> effective_clock_period_ps,
+    BenchmarkResultProto* results) {
   XLS_ASSIGN_OR_RETURN(
       std::vector<CriticalPathEntry> critical_path,
       AnalyzeCriticalPath(f, effective_clock_period_ps, delay_estimator));
+  results->set_critical_path_delay_ps(critical_path.front().path_delay_ps);
   std::cout << absl::StrFormat("Return value delay: %dps\n",
                                critical_path.front().path_delay_ps);
   std::cout << absl::StrFormat("Critical path entry count: %d\n",
@@ -231,7 +323,8 @@ absl::Status PrintCriticalPath(
 }
 
 absl::Status PrintTotalDelay(FunctionBase* f,
-                             const DelayEstimator& delay_estimator) {
+                             const DelayEstimator& delay_estimator,
+                             BenchmarkResultProto* results) {
   int64_t total_delay = 0;
   for (Node* node : f->nodes()) {
     XLS_ASSIGN_OR_RETURN(int64_t op_delay,
@@ -239,6 +332,7 @@ absl::Status PrintTotalDelay(FunctionBase* f,
     total_delay += op_delay;
   }
   std::cout << absl::StrFormat("Total delay: %dps\n", total_delay);
+  results->set_total_delay_ps(total_delay);
   return absl::OkStatus();
 }
 
@@ -269,7 +363,8 @@ absl::StatusOr<PipelineSchedule> ScheduleAndPrintStats(
     Package* package, const DelayEstimator& delay_estimator,
     std::optional<int64_t> clock_period_ps,
     std::optional<int64_t> pipeline_stages,
-    std::optional<int64_t> clock_margin_percent) {
+    std::optional<int64_t> clock_margin_percent,
+    BenchmarkResultProto* results) {
   SchedulingOptions options;
   if (clock_period_ps.has_value()) {
     options.clock_period_ps(*clock_period_ps);
@@ -286,33 +381,51 @@ absl::StatusOr<PipelineSchedule> ScheduleAndPrintStats(
     return absl::InternalError(absl::StrFormat(
         "Top entity not set for package: %s.", package->name()));
   }
-  absl::Time start = absl::Now();
+  SchedulingMetricsProto metrics;
+  std::optional<PipelineSchedule> schedule;
   XLS_ASSIGN_OR_RETURN(
-      PipelineSchedule schedule,
-      PipelineSchedule::Run(top.value(), delay_estimator, options));
-  absl::Duration total_time = absl::Now() - start;
-  std::cout << absl::StreamFormat("Scheduling time: %dms\n",
-                                  total_time / absl::Milliseconds(1));
+      std::vector<absl::Duration> durations,
+      RunRepeatedly([&]() -> absl::StatusOr<absl::Duration> {
+        metrics.Clear();
+        absl::Time start = absl::Now();
+        XLS_ASSIGN_OR_RETURN(schedule,
+                             PipelineSchedule::Run(top.value(), delay_estimator,
+                                                   options, &metrics));
+        return absl::Now() - start;
+      }));
+  ReportTiming("Scheduling time", "scheduling", durations, results);
+  std::cout << SchedulingMetricsToString(metrics);
+  *results->mutable_scheduling_metrics() = metrics;
+  if (!absl::GetFlag(FLAGS_scheduling_metrics_path).empty()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(
+        absl::GetFlag(FLAGS_scheduling_metrics_path), metrics));
+  }
 
-  return std::move(schedule);
+  return std::move(schedule).value();
 }
 
 absl::Status PrintCodegenInfo(FunctionBase* f,
-                              const PipelineSchedule& schedule) {
-  absl::Time start = absl::Now();
-  XLS_ASSIGN_OR_RETURN(verilog::ModuleGeneratorResult codegen_result,
-                       verilog::ToPipelineModuleText(
-                           schedule, f, verilog::BuildPipelineOptions()));
-  absl::Duration total_time = absl::Now() - start;
-  std::cout << absl::StreamFormat("Codegen time: %dms\n",
-                                  total_time / absl::Milliseconds(1));
+                              const PipelineSchedule& schedule,
+                              BenchmarkResultProto* results) {
+  std::string verilog_text;
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<absl::Duration> durations,
+      RunRepeatedly([&]() -> absl::StatusOr<absl::Duration> {
+        absl::Time start = absl::Now();
+        XLS_ASSIGN_OR_RETURN(verilog::ModuleGeneratorResult codegen_result,
+                             verilog::ToPipelineModuleText(
+                                 schedule, f, verilog::BuildPipelineOptions()));
+        absl::Duration duration = absl::Now() - start;
+        verilog_text = std::move(codegen_result.verilog_text);
+        return duration;
+      }));
+  ReportTiming("Codegen time", "codegen", durations, results);
 
   // TODO(meheff): Add an estimate of total number of gates.
-  std::cout << absl::StreamFormat(
-      "Lines of Verilog: %d\n",
-      std::vector<std::string>(
-          absl::StrSplit(codegen_result.verilog_text, '\n'))
-          .size());
+  int64_t line_count =
+      std::vector<std::string>(absl::StrSplit(verilog_text, '\n')).size();
+  std::cout << absl::StreamFormat("Lines of Verilog: %d\n", line_count);
+  results->set_verilog_line_count(line_count);
 
   return absl::OkStatus();
 }
@@ -321,7 +434,8 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
                                const PipelineSchedule& schedule,
                                const BddQueryEngine& bdd_query_engine,
                                const DelayEstimator& delay_estimator,
-                               std::optional<int64_t> clock_period_ps) {
+                               std::optional<int64_t> clock_period_ps,
+                               BenchmarkResultProto* results) {
   int64_t total_flops = 0;
   int64_t total_duplicates = 0;
   int64_t total_constants = 0;
@@ -382,6 +496,8 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
   std::cout << absl::StreamFormat(
       "Total pipeline flops: %d (%d dups, %4d constant)\n", total_flops,
       total_duplicates, total_constants);
+  results->set_pipeline_stages(schedule.length());
+  results->set_pipeline_flops(total_flops);
 
   if (clock_period_ps.has_value()) {
     int64_t min_slack = std::numeric_limits<int64_t>::max();
@@ -389,12 +505,13 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
       min_slack = std::min(min_slack, *clock_period_ps - stage_delay);
     }
     std::cout << absl::StreamFormat("Min stage slack: %d\n", min_slack);
+    results->set_min_stage_slack_ps(min_slack);
   }
 
   return absl::OkStatus();
 }
 
-absl::Status PrintProcInfo(Proc* p) {
+absl::Status PrintProcInfo(Proc* p, BenchmarkResultProto* results) {
   XLS_RET_CHECK(p != nullptr);
 
   int64_t total_flops = 0;
@@ -403,90 +520,115 @@ absl::Status PrintProcInfo(Proc* p) {
   }
 
   std::cout << absl::StreamFormat("Total state flops: %d\n", total_flops);
+  results->set_state_flops(total_flops);
 
   return absl::OkStatus();
 }
 
 absl::Status RunInterpeterAndJit(FunctionBase* function_base,
-                                 std::string_view description) {
+                                 std::string_view description,
+                                 BenchmarkResultProto* results) {
   // TODO(meheff): 2022/10/10 Run interpreter / jit for a fixed amount of time
   // (1s?) and report the rate (iterations per second). Currently, many of the
   // benchmarks do not run long enough to produce statistically significant
   // results.
-  std::minstd_rand rng_engine;
   if (function_base->IsFunction()) {
     Function* function = function_base->AsFunctionOrDie();
-    absl::Time start_jit_compile = absl::Now();
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
-                         FunctionJit::Create(function));
-    std::cout << absl::StreamFormat(
-        "JIT compile time (%s): %dms\n", description,
-        DurationToMs(absl::Now() - start_jit_compile));
+    std::unique_ptr<FunctionJit> jit;
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<absl::Duration> compile_durations,
+        RunRepeatedly([&]() -> absl::StatusOr<absl::Duration> {
+          absl::Time start = absl::Now();
+          XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(function));
+          return absl::Now() - start;
+        }));
+    ReportTiming(absl::StrFormat("JIT compile time (%s)", description),
+                 absl::StrCat("jit_compile.", description), compile_durations,
+                 results);
 
+    // To avoid being dominated by xls::Value conversion to native
+    // format, generate the arguments directly in the native format. The
+    // interpreter arguments are unpacked from the same buffers.
     const int64_t kInputCount = 100;
+    Xoshiro256StarStar rng_engine;
+    auto fill_random = [&](absl::Span<uint8_t> bytes) {
+      rng_engine.Fill(bytes);
+    };
     std::vector<std::vector<Value>> arg_set(kInputCount);
-    for (std::vector<Value>& args : arg_set) {
-      for (Param* param : function->params()) {
-        args.push_back(RandomValue(param->GetType(), &rng_engine));
-      }
-    }
-
-    // To avoid being dominated by xls::Value conversion to native
-    // format, preconvert the arguments.
     std::vector<std::vector<std::vector<uint8_t>>> jit_arg_buffers;
     std::vector<std::vector<uint8_t*>> jit_arg_pointers;
-    for (const std::vector<Value>& args : arg_set) {
+    for (std::vector<Value>& args : arg_set) {
       std::vector<std::vector<uint8_t>> buffers;
       std::vector<uint8_t*> pointers;
-      for (int64_t i = 0; i < args.size(); ++i) {
+      for (int64_t i = 0; i < function->params().size(); ++i) {
+        Type* param_type = function->param(i)->GetType();
         buffers.push_back(std::vector<uint8_t>(jit->GetArgTypeSize(i), 0));
         pointers.push_back(buffers.back().data());
+        jit->runtime()->BlitRandomToBuffer(
+            param_type, absl::MakeSpan(buffers.back()), fill_random);
+        args.push_back(
+            jit->runtime()->UnpackBuffer(buffers.back().data(), param_type));
       }
       jit_arg_buffers.push_back(std::move(buffers));
       jit_arg_pointers.push_back(pointers);
-      XLS_RETURN_IF_ERROR(jit->runtime()->PackArgs(
-          args, function->GetType()->parameters(), jit_arg_pointers.back()));
     }
 
     // The JIT is much faster so run many times.
     const int64_t kJitRunMultiplier = 1000;
     InterpreterEvents events;
     std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
-    absl::Time start_jit_run = absl::Now();
-    for (int64_t i = 0; i < kJitRunMultiplier; ++i) {
-      for (const std::vector<uint8_t*>& pointers : jit_arg_pointers) {
-        XLS_RETURN_IF_ERROR(jit->RunWithViews(
-            pointers, absl::MakeSpan(result_buffer), &events));
-      }
-    }
-    std::cout << absl::StreamFormat("JIT run time (%s): %dms\n", description,
-                                    DurationToMs(absl::Now() - start_jit_run));
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<absl::Duration> jit_run_durations,
+        RunRepeatedly([&]() -> absl::StatusOr<absl::Duration> {
+          absl::Time start = absl::Now();
+          for (int64_t i = 0; i < kJitRunMultiplier; ++i) {
+            for (const std::vector<uint8_t*>& pointers : jit_arg_pointers) {
+              XLS_RETURN_IF_ERROR(jit->RunWithViews(
+                  pointers, absl::MakeSpan(result_buffer), &events));
+            }
+          }
+          return absl::Now() - start;
+        }));
+    ReportTiming(absl::StrFormat("JIT run time (%s)", description),
+                 absl::StrCat("jit_run.", description), jit_run_durations,
+                 results);
 
-    absl::Time start_interpreter = absl::Now();
-    for (const std::vector<Value>& args : arg_set) {
-      XLS_RETURN_IF_ERROR(InterpretFunction(function, args).status());
-    }
-    std::cout << absl::StreamFormat(
-        "Interpreter run time (%s): %dms\n", description,
-        DurationToMs(absl::Now() - start_interpreter));
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<absl::Duration> interpreter_durations,
+        RunRepeatedly([&]() -> absl::StatusOr<absl::Duration> {
+          absl::Time start = absl::Now();
+          for (const std::vector<Value>& args : arg_set) {
+            XLS_RETURN_IF_ERROR(InterpretFunction(function, args).status());
+          }
+          return absl::Now() - start;
+        }));
+    ReportTiming(absl::StrFormat("Interpreter run time (%s)", description),
+                 absl::StrCat("interpreter_run.", description),
+                 interpreter_durations, results);
     return absl::OkStatus();
   }
 
   XLS_RET_CHECK(function_base->IsProc());
   Proc* proc = function_base->AsProcOrDie();
 
-  absl::Time start_jit_compile = absl::Now();
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> jit_runtime,
-                       JitRuntime::Create());
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
-                       JitChannelQueueManager::CreateThreadSafe(
-                           proc->package(), jit_runtime.get()));
   XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<ProcJit> jit,
-      ProcJit::Create(proc, jit_runtime.get(), queue_manager.get()));
-  std::cout << absl::StreamFormat(
-      "JIT compile time (%s): %dms\n", description,
-      DurationToMs(absl::Now() - start_jit_compile));
+      std::vector<absl::Duration> compile_durations,
+      RunRepeatedly([&]() -> absl::StatusOr<absl::Duration> {
+        absl::Time start = absl::Now();
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> jit_runtime,
+                             JitRuntime::Create());
+        XLS_ASSIGN_OR_RETURN(
+            std::unique_ptr<JitChannelQueueManager> queue_manager,
+            JitChannelQueueManager::CreateThreadSafe(proc->package(),
+                                                     jit_runtime.get()));
+        XLS_ASSIGN_OR_RETURN(
+            std::unique_ptr<ProcJit> jit,
+            ProcJit::Create(proc, jit_runtime.get(), queue_manager.get()));
+        return absl::Now() - start;
+      }));
+  ReportTiming(absl::StrFormat("JIT compile time (%s)", description),
+               absl::StrCat("jit_compile.", description), compile_durations,
+               results);
   // TODO(meheff): 2022/5/16 Run the proc as well.
 
   return absl::OkStatus();
@@ -508,15 +650,19 @@ absl::Status RealMain(std::string_view path,
     return absl::InternalError(absl::StrFormat(
         "Top entity not set for package: %s.", package->name()));
   }
+  BenchmarkResultProto results;
+  results.set_ir_path(std::string(path));
+  results.set_top(package->GetTop().value()->name());
+
   XLS_RETURN_IF_ERROR(
-      RunInterpeterAndJit(package->GetTop().value(), "unoptimized"));
+      RunInterpeterAndJit(package->GetTop().value(), "unoptimized", &results));
 
-  XLS_RETURN_IF_ERROR(RunOptimizationAndPrintStats(package.get()));
+  XLS_RETURN_IF_ERROR(RunOptimizationAndPrintStats(package.get(), &results));
 
   FunctionBase* f = package->GetTop().value();
   BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
   XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
-  PrintNodeBreakdown(f);
+  PrintNodeBreakdown(f, &results);
 
   std::optional<int64_t> effective_clock_period_ps;
   if (clock_period_ps.has_value()) {
@@ -536,33 +682,41 @@ absl::Status RealMain(std::string_view path,
   }
   const auto& delay_estimator = *pdelay_estimator;
   XLS_RETURN_IF_ERROR(PrintCriticalPath(f, query_engine, delay_estimator,
-                                        effective_clock_period_ps));
-  XLS_RETURN_IF_ERROR(PrintTotalDelay(f, delay_estimator));
+                                        effective_clock_period_ps, &results));
+  XLS_RETURN_IF_ERROR(PrintTotalDelay(f, delay_estimator, &results));
 
   if (clock_period_ps.has_value() || pipeline_stages.has_value()) {
     XLS_ASSIGN_OR_RETURN(
         PipelineSchedule schedule,
         ScheduleAndPrintStats(package.get(), delay_estimator, clock_period_ps,
-                              pipeline_stages, clock_margin_percent));
+                              pipeline_stages, clock_margin_percent,
+                              &results));
 
     // Only print codegen info for functions.
     //
     // TODO(tedhong): 2022-09-28 - Support passing additional codegen options
     // to benchmark_main to be able to codegen procs.
     if (f->IsFunction()) {
-      XLS_RETURN_IF_ERROR(PrintCodegenInfo(f, schedule));
+      XLS_RETURN_IF_ERROR(PrintCodegenInfo(f, schedule, &results));
     }
 
     XLS_RETURN_IF_ERROR(PrintScheduleInfo(f, schedule, query_engine,
-                                          delay_estimator, clock_period_ps));
+                                          delay_estimator, clock_period_ps,
+                                          &results));
 
     // Print out state information for procs.
     if (f->IsProc()) {
-      XLS_RETURN_IF_ERROR(PrintProcInfo(f->AsProcOrDie()));
+      XLS_RETURN_IF_ERROR(PrintProcInfo(f->AsProcOrDie(), &results));
     }
   }
 
-  XLS_RETURN_IF_ERROR(RunInterpeterAndJit(f, "optimized"));
+  XLS_RETURN_IF_ERROR(RunInterpeterAndJit(f, "optimized", &results));
+
+  if (!absl::GetFlag(FLAGS_results_path).empty()) {
+    XLS_RETURN_IF_ERROR(WriteProtoResults(
+        results, absl::GetFlag(FLAGS_results_path),
+        absl::GetFlag(FLAGS_results_format)));
+  }
   return absl::OkStatus();
 }
 
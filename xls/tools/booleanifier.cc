@@ -19,7 +19,10 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <tuple>
+#include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
@@ -31,11 +34,20 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 
 namespace xls {
 
 // Evaluator for converting Nodes representing high-level Ops into
 // single-bit AND/OR/NOT-based ones.
+//
+// Gates are structurally hashed: a gate with the same op and operands as an
+// existing one reuses it, with AND/OR operands put in a canonical order. Each
+// gate is also simplified locally as it is created. Constants are folded,
+// double negations are removed, and gates whose operands are equal or
+// complementary are reduced. The AbstractEvaluator expansions re-derive many
+// identical terms (e.g., the carry chain of an adder feeding a comparison),
+// so this keeps the output much smaller than a node-by-node expansion.
 class BitEvaluator : public AbstractEvaluator<Node*, BitEvaluator> {
  public:
   BitEvaluator(FunctionBuilder* builder)
@@ -46,19 +58,70 @@ class BitEvaluator : public AbstractEvaluator<Node*, BitEvaluator> {
   Node* One() const { return one_.node(); }
   Node* Zero() const { return zero_.node(); }
   Node* Not(Node* const& input) const {
-    return builder_->Not(BValue(input, builder_)).node();
+    if (input == One()) {
+      return Zero();
+    }
+    if (input == Zero()) {
+      return One();
+    }
+    if (input->op() == Op::kNot) {
+      return input->operand(0);
+    }
+    auto [it, inserted] = not_gates_.try_emplace(input, nullptr);
+    if (inserted) {
+      it->second = builder_->Not(BValue(input, builder_)).node();
+    }
+    return it->second;
   }
   Node* And(Node* const& a, Node* const& b) const {
-    return builder_->And(BValue(a, builder_), BValue(b, builder_)).node();
+    return Gate(Op::kAnd, a, b);
   }
   Node* Or(Node* const& a, Node* const& b) const {
-    return builder_->Or(BValue(a, builder_), BValue(b, builder_)).node();
+    return Gate(Op::kOr, a, b);
   }
 
  private:
+  static bool IsComplement(Node* a, Node* b) {
+    return (a->op() == Op::kNot && a->operand(0) == b) ||
+           (b->op() == Op::kNot && b->operand(0) == a);
+  }
+
+  // Returns the AND or OR of a and b, creating a gate only if no existing node
+  // computes it.
+  Node* Gate(Op op, Node* a, Node* b) const {
+    // The controlling value decides the result on its own (0 for AND, 1 for
+    // OR); the other constant leaves the other operand unchanged.
+    Node* controlling = op == Op::kAnd ? Zero() : One();
+    Node* non_controlling = op == Op::kAnd ? One() : Zero();
+    if (a == controlling || b == controlling || IsComplement(a, b)) {
+      return controlling;
+    }
+    if (a == non_controlling) {
+      return b;
+    }
+    if (b == non_controlling || a == b) {
+      return a;
+    }
+    if (a->id() > b->id()) {
+      std::swap(a, b);
+    }
+    auto [it, inserted] =
+        gates_.try_emplace(std::make_tuple(op, a, b), nullptr);
+    if (inserted) {
+      BValue lhs(a, builder_);
+      BValue rhs(b, builder_);
+      it->second = (op == Op::kAnd ? builder_->And(lhs, rhs)
+                                   : builder_->Or(lhs, rhs))
+                       .node();
+    }
+    return it->second;
+  }
+
   FunctionBuilder* builder_;
   BValue one_;
   BValue zero_;
+  mutable absl::flat_hash_map<Node*, Node*> not_gates_;
+  mutable absl::flat_hash_map<std::tuple<Op, Node*, Node*>, Node*> gates_;
 };
 
 absl::StatusOr<Function*> Booleanifier::Booleanify(
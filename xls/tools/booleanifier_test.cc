@@ -13,11 +13,15 @@
 // limitations under the License.
 #include "xls/tools/booleanifier.h"
 
+#include <algorithm>
 #include <array>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/matchers.h"
@@ -562,6 +566,52 @@ TEST_F(BooleanifierTest, BooleanFunctionName) {
   EXPECT_EQ(given_name_f->name(), "baz");
 }
 
+// Verifies that gates are hash-consed and simplified as they are created: no
+// two gates compute the same function of the same operands, and no gate has a
+// constant operand.
+TEST_F(BooleanifierTest, GatesAreStructurallyHashed) {
+  const std::string kIrText = R"(
+package p
+
+fn main(x: bits[8], y: bits[8]) -> (bits[1], bits[8], bits[1]) {
+  literal.1: bits[8] = literal(value=0)
+  add.2: bits[8] = add(x, literal.1)
+  eq.3: bits[1] = eq(add.2, x)
+  add.4: bits[8] = add(x, y)
+  add.5: bits[8] = add(y, x)
+  eq.6: bits[1] = eq(add.4, add.5)
+  ret tuple.7: (bits[1], bits[8], bits[1]) = tuple(eq.3, add.4, eq.6)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(FunctionData fd, GetFunctionData(kIrText, "main"));
+
+  absl::flat_hash_set<std::tuple<Op, std::vector<Node*>>> gates;
+  for (Node* node : fd.boolified->nodes()) {
+    if (node->op() != Op::kAnd && node->op() != Op::kOr &&
+        node->op() != Op::kNot) {
+      continue;
+    }
+    std::vector<Node*> operands(node->operands().begin(),
+                                node->operands().end());
+    for (Node* operand : operands) {
+      EXPECT_FALSE(operand->Is<Literal>()) << node->ToString();
+    }
+    std::sort(operands.begin(), operands.end(), [](Node* a, Node* b) {
+      return a->id() < b->id();
+    });
+    EXPECT_TRUE(gates.insert({node->op(), operands}).second)
+        << node->ToString();
+  }
+
+  // The simplified function still computes the same values.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value result,
+      DropInterpreterEvents(InterpretFunction(
+          fd.boolified, {Value(UBits(200, 8)), Value(UBits(100, 8))})));
+  EXPECT_EQ(result, Value::Tuple({Value(UBits(1, 1)), Value(UBits(44, 8)),
+                                  Value(UBits(1, 1))}));
+}
+
 TEST_F(BooleanifierTest, HandlesArrayEmptyIndex) {
   const std::string kIrText = R"(
 package p
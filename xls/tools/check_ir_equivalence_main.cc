@@ -12,7 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
 #include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "absl/base/internal/sysinfo.h"
 #include "absl/flags/flag.h"
@@ -34,7 +39,9 @@
 #include "xls/passes/passes.h"
 #include "xls/passes/unroll_pass.h"
 #include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_portfolio.h"
 #include "xls/solvers/z3_utils.h"
+#include "xls/tools/equivalence_simulation.h"
 #include "../z3/src/api/z3.h"
 #include "../z3/src/api/z3_api.h"
 
@@ -58,6 +65,16 @@ ABSL_FLAG(std::string, top, "",
           "Functions are supported.");
 ABSL_FLAG(absl::Duration, timeout, absl::InfiniteDuration(),
           "How long to wait for any proof to complete.");
+ABSL_FLAG(int64_t, simulation_samples, 1 << 16,
+          "Number of input vectors on which to run both functions (through "
+          "the JIT) before attempting a proof. A difference found by "
+          "simulation is reported without invoking the solver. Zero disables "
+          "simulation.");
+ABSL_FLAG(std::vector<std::string>, portfolio, {},
+          "Comma-separated list of solvers to race on the proof, taking the "
+          "first definitive answer, e.g. \"z3,z3:qfbv,smtlib:/usr/bin/cvc5\". "
+          "See xls/solvers/z3_portfolio.h for the syntax. If empty, Z3's "
+          "default solver is used.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls {
@@ -80,7 +97,9 @@ absl::StatusOr<Z3_ast> CreateComparisonFunction(
 }
 
 absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
-                      const std::string& entry, absl::Duration timeout) {
+                      const std::string& entry, absl::Duration timeout,
+                      int64_t simulation_samples,
+                      absl::Span<const std::string> portfolio) {
   std::vector<std::unique_ptr<Package>> packages;
   for (const auto ir_path : ir_paths) {
     XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
@@ -119,6 +138,25 @@ absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
     functions.push_back(func);
   }
 
+  // Differences are usually found within milliseconds by simulation, whereas
+  // the solver may take minutes to produce a counterexample.
+  if (simulation_samples > 0) {
+    EquivalenceSimulationOptions simulation_options;
+    simulation_options.sample_count = simulation_samples;
+    absl::StatusOr<std::optional<EquivalenceCounterexample>> counterexample =
+        FindCounterexampleBySimulation(functions[0], functions[1],
+                                       simulation_options);
+    if (!counterexample.ok()) {
+      XLS_LOG(WARNING) << "Simulation failed, falling back to the solver: "
+                       << counterexample.status();
+    } else if (counterexample->has_value()) {
+      std::cout << "Simulation result; satisfiable: true\n\n"
+                << "  Counterexample:\n  "
+                << counterexample->value().ToString() << std::endl;
+      return absl::OkStatus();
+    }
+  }
+
   std::vector<std::unique_ptr<IrTranslator>> translators;
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
                        IrTranslator::CreateAndTranslate(functions[0]));
@@ -140,23 +178,48 @@ absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
   XLS_ASSIGN_OR_RETURN(
       Z3_ast results_equal,
       CreateComparisonFunction(absl::MakeSpan(translators), functions));
-  translators[0]->SetTimeout(timeout);
-
-  Z3_solver solver =
-      solvers::z3::CreateSolver(ctx, std::thread::hardware_concurrency());
-
   // Remember: we try to prove the condition by searching for a model that
   // produces the opposite result. Thus, we want to find a model where the
   // results are _not_ equal.
   Z3_ast objective = Z3_mk_eq(ctx, Z3_mk_false(ctx), results_equal);
-  Z3_solver_assert(ctx, solver, objective);
+
+  // Both modes produce a result and, if satisfiable, a model which the caller
+  // owns a reference to.
+  Z3_lbool satisfiable;
+  Z3_model model = nullptr;
+  if (!portfolio.empty()) {
+    XLS_ASSIGN_OR_RETURN(std::vector<solvers::z3::PortfolioSolver> solvers,
+                         solvers::z3::ParsePortfolio(portfolio));
+    solvers::z3::PortfolioOptions options;
+    options.timeout = timeout;
+    XLS_ASSIGN_OR_RETURN(
+        solvers::z3::PortfolioResult result,
+        solvers::z3::SolvePortfolio(ctx, objective, solvers, options));
+    if (!result.solver.empty()) {
+      XLS_LOG(INFO) << "Decided by " << result.solver;
+    }
+    satisfiable = result.satisfiable;
+    model = result.model.value_or(nullptr);
+  } else {
+    translators[0]->SetTimeout(timeout);
+    Z3_solver solver =
+        solvers::z3::CreateSolver(ctx, std::thread::hardware_concurrency());
+    Z3_solver_assert(ctx, solver, objective);
+    satisfiable = Z3_solver_check(ctx, solver);
+    if (satisfiable == Z3_L_TRUE) {
+      model = Z3_solver_get_model(ctx, solver);
+      Z3_model_inc_ref(ctx, model);
+    }
+    Z3_solver_dec_ref(ctx, solver);
+  }
 
   // Finally, print the output to the terminal in gorgeous two-color ASCII.
-  Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
-  std::cout << solvers::z3::SolverResultToString(ctx, solver, satisfiable)
+  std::cout << solvers::z3::SolverResultToString(ctx, model, satisfiable)
             << std::endl;
 
-  Z3_solver_dec_ref(ctx, solver);
+  if (model != nullptr) {
+    Z3_model_dec_ref(ctx, model);
+  }
 
   return absl::OkStatus();
 }
@@ -168,5 +231,7 @@ int main(int argc, char** argv) {
       xls::InitXls(kUsage, argc, argv);
   XLS_QCHECK_EQ(positional_args.size(), 2) << "Two IR files must be specified!";
   XLS_QCHECK_OK(xls::RealMain(positional_args, absl::GetFlag(FLAGS_top),
-                              absl::GetFlag(FLAGS_timeout)));
+                              absl::GetFlag(FLAGS_timeout),
+                              absl::GetFlag(FLAGS_simulation_samples),
+                              absl::GetFlag(FLAGS_portfolio)));
 }
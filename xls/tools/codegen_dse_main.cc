@@ -0,0 +1,356 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/codegen/block_metrics.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/pipeline_generator.h"
+#include "xls/codegen/xls_metrics.pb.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/contrib/integrator/area_model/area_estimator.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+const char kUsage[] = R"(
+Explores the space of pipelined modules generated from an IR file over a grid
+of scheduling and codegen options, and prints the metrics of each variant along
+with which variants are Pareto-optimal in critical-path delay, area and latency.
+Example invocation:
+
+   codegen_dse_main --clock_period_ps=500,1000,2000 \
+       --pipeline_stages=0,2,4 \
+       --flop_inputs=true,false \
+       --delay_models=unit,sky130 \
+       --thread_count=16 \
+       IR_FILE
+
+A clock period or pipeline stage count of zero leaves the respective option
+unset; each variant must set at least one of them.
+)";
+
+ABSL_FLAG(std::string, top, "",
+          "Top entity to generate pipelines for. If unset the top of the "
+          "package is used.");
+ABSL_FLAG(std::vector<std::string>, clock_period_ps, {"0"},
+          "Comma-separated list of target clock periods in picoseconds to "
+          "explore. Zero leaves the clock period unset.");
+ABSL_FLAG(std::vector<std::string>, pipeline_stages, {"0"},
+          "Comma-separated list of pipeline stage counts to explore. Zero "
+          "leaves the stage count unset.");
+ABSL_FLAG(std::vector<std::string>, flop_inputs, {"true"},
+          "Comma-separated list of values of the codegen option flop_inputs to "
+          "explore.");
+ABSL_FLAG(std::vector<std::string>, delay_models, {"unit"},
+          "Comma-separated list of delay models to explore.");
+ABSL_FLAG(std::string, area_model, "",
+          "Area model used to estimate the area of each variant. If unset the "
+          "flop count of a variant is used as its area.");
+ABSL_FLAG(int64_t, thread_count, 0,
+          "Number of threads used to generate the variants. If zero, the "
+          "number of hardware threads is used.");
+ABSL_FLAG(std::string, output_dir, "",
+          "If set, the Verilog and the block metrics of each variant are "
+          "written to this directory.");
+
+namespace xls {
+namespace {
+
+// A point in the explored space of options.
+struct Variant {
+  std::string delay_model;
+  std::optional<int64_t> clock_period_ps;
+  std::optional<int64_t> pipeline_stages;
+  bool flop_inputs;
+};
+
+// The outcome of generating a variant.
+struct VariantResult {
+  absl::Status status = absl::UnknownError("Variant not generated");
+  int64_t latency = 0;
+  int64_t critical_path_ps = 0;
+  int64_t area = 0;
+  verilog::BlockMetricsProto metrics;
+  bool pareto_optimal = false;
+};
+
+std::string VariantName(int64_t index) {
+  return absl::StrFormat("variant_%d", index);
+}
+
+absl::StatusOr<std::vector<std::optional<int64_t>>> ParseOptionalInts(
+    const std::vector<std::string>& values, std::string_view flag) {
+  std::vector<std::optional<int64_t>> result;
+  for (const std::string& value : values) {
+    int64_t parsed;
+    if (!absl::SimpleAtoi(value, &parsed) || parsed < 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid value of --%s: \"%s\"", flag, value));
+    }
+    result.push_back(parsed == 0 ? std::nullopt
+                                 : std::optional<int64_t>(parsed));
+  }
+  return result;
+}
+
+absl::StatusOr<std::vector<Variant>> GetVariants() {
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::optional<int64_t>> clock_periods,
+      ParseOptionalInts(absl::GetFlag(FLAGS_clock_period_ps),
+                        "clock_period_ps"));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::optional<int64_t>> stage_counts,
+      ParseOptionalInts(absl::GetFlag(FLAGS_pipeline_stages),
+                        "pipeline_stages"));
+  std::vector<bool> flop_inputs;
+  for (const std::string& value : absl::GetFlag(FLAGS_flop_inputs)) {
+    bool parsed;
+    if (!absl::SimpleAtob(value, &parsed)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid value of --flop_inputs: \"%s\"", value));
+    }
+    flop_inputs.push_back(parsed);
+  }
+
+  std::vector<Variant> variants;
+  for (const std::string& delay_model : absl::GetFlag(FLAGS_delay_models)) {
+    for (std::optional<int64_t> clock_period_ps : clock_periods) {
+      for (std::optional<int64_t> pipeline_stages : stage_counts) {
+        if (!clock_period_ps.has_value() && !pipeline_stages.has_value()) {
+          continue;
+        }
+        for (bool flop_input : flop_inputs) {
+          variants.push_back(Variant{.delay_model = delay_model,
+                                     .clock_period_ps = clock_period_ps,
+                                     .pipeline_stages = pipeline_stages,
+                                     .flop_inputs = flop_input});
+        }
+      }
+    }
+  }
+  if (variants.empty()) {
+    return absl::InvalidArgumentError(
+        "No variants to explore; each variant must set a nonzero "
+        "--clock_period_ps or --pipeline_stages.");
+  }
+  return variants;
+}
+
+// Schedules and generates the given variant of `top`. The block generated for
+// the variant is added to the package of `top` under the name of the variant.
+absl::StatusOr<VariantResult> GenerateVariant(
+    FunctionBase* top, const Variant& variant, int64_t index,
+    const AreaEstimator* area_estimator) {
+  XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                       GetCachingDelayEstimator(variant.delay_model));
+  SchedulingOptions scheduling_options;
+  if (variant.clock_period_ps.has_value()) {
+    scheduling_options.clock_period_ps(variant.clock_period_ps.value());
+  }
+  if (variant.pipeline_stages.has_value()) {
+    scheduling_options.pipeline_stages(variant.pipeline_stages.value());
+  }
+  XLS_ASSIGN_OR_RETURN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(top, *delay_estimator, scheduling_options));
+
+  verilog::CodegenOptions codegen_options = verilog::BuildPipelineOptions();
+  codegen_options.flop_inputs(variant.flop_inputs);
+  codegen_options.module_name(VariantName(index));
+  XLS_ASSIGN_OR_RETURN(
+      verilog::ModuleGeneratorResult module,
+      verilog::ToPipelineModuleText(schedule, top, codegen_options,
+                                    delay_estimator));
+
+  VariantResult result;
+  XLS_ASSIGN_OR_RETURN(Block * block,
+                       top->package()->GetBlock(VariantName(index)));
+  XLS_ASSIGN_OR_RETURN(
+      result.metrics,
+      verilog::GenerateBlockMetrics(
+          block, delay_estimator,
+          area_estimator == nullptr
+              ? std::nullopt
+              : std::optional<const AreaEstimator*>(area_estimator)));
+  result.latency = module.signature.proto().pipeline().latency();
+  result.critical_path_ps = std::max(
+      {result.metrics.max_reg_to_reg_delay_ps(),
+       result.metrics.max_input_to_reg_delay_ps(),
+       result.metrics.max_reg_to_output_delay_ps(),
+       result.metrics.max_feedthrough_path_delay_ps()});
+  result.area = result.metrics.has_estimated_area()
+                    ? result.metrics.estimated_area()
+                    : result.metrics.flop_count();
+
+  std::string output_dir = absl::GetFlag(FLAGS_output_dir);
+  if (!output_dir.empty()) {
+    std::filesystem::path path(output_dir);
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        path / absl::StrCat(VariantName(index), ".v"), module.verilog_text));
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(
+        path / absl::StrCat(VariantName(index), ".metrics.textproto"),
+        result.metrics));
+  }
+  return result;
+}
+
+// Returns true if `a` is no worse than `b` in every objective and better in at
+// least one.
+bool Dominates(const VariantResult& a, const VariantResult& b) {
+  bool no_worse = a.critical_path_ps <= b.critical_path_ps &&
+                  a.area <= b.area && a.latency <= b.latency;
+  bool better = a.critical_path_ps < b.critical_path_ps || a.area < b.area ||
+                a.latency < b.latency;
+  return no_worse && better;
+}
+
+void MarkParetoOptimal(std::vector<VariantResult>& results) {
+  for (VariantResult& result : results) {
+    if (!result.status.ok()) {
+      continue;
+    }
+    result.pareto_optimal = std::none_of(
+        results.begin(), results.end(), [&](const VariantResult& other) {
+          return other.status.ok() && Dominates(other, result);
+        });
+  }
+}
+
+std::string OptionalToString(std::optional<int64_t> value) {
+  return value.has_value() ? absl::StrCat(value.value()) : "-";
+}
+
+absl::Status RealMain(std::string_view ir_path) {
+  XLS_ASSIGN_OR_RETURN(std::vector<Variant> variants, GetVariants());
+  std::unique_ptr<AreaEstimator> area_estimator;
+  if (!absl::GetFlag(FLAGS_area_model).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        area_estimator,
+        GetAreaEstimatorByName(absl::GetFlag(FLAGS_area_model)));
+  }
+  std::optional<std::string_view> top_name;
+  if (!absl::GetFlag(FLAGS_top).empty()) {
+    top_name = absl::GetFlag(FLAGS_top);
+  }
+
+  // The IR is read once. Code generation adds blocks to a package, so each
+  // thread parses a private copy of the package and generates its variants
+  // into it. The caching delay estimators are shared by all threads.
+  XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
+  int64_t thread_count = absl::GetFlag(FLAGS_thread_count);
+  if (thread_count <= 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  thread_count = std::min<int64_t>(thread_count, variants.size());
+
+  std::vector<VariantResult> results(variants.size());
+  std::vector<absl::Status> thread_statuses(thread_count);
+  std::atomic<int64_t> next_variant = 0;
+  auto generate_variants = [&](int64_t thread_index) {
+    absl::StatusOr<std::unique_ptr<Package>> package =
+        Parser::ParsePackage(ir_contents, ir_path);
+    if (!package.ok()) {
+      thread_statuses[thread_index] = package.status();
+      return;
+    }
+    absl::StatusOr<FunctionBase*> top = FindTop(package->get(), top_name);
+    if (!top.ok()) {
+      thread_statuses[thread_index] = top.status();
+      return;
+    }
+    for (int64_t i = next_variant++; i < variants.size(); i = next_variant++) {
+      absl::StatusOr<VariantResult> result =
+          GenerateVariant(top.value(), variants[i], i, area_estimator.get());
+      if (result.ok()) {
+        results[i] = std::move(result).value();
+        results[i].status = absl::OkStatus();
+      } else {
+        results[i].status = result.status();
+      }
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < thread_count; ++i) {
+    threads.push_back(
+        std::make_unique<Thread>([&, i]() { generate_variants(i); }));
+  }
+  generate_variants(0);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (const absl::Status& status : thread_statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+
+  MarkParetoOptimal(results);
+  std::cout << absl::StreamFormat(
+      "%-12s %-16s %8s %8s %6s %8s %12s %10s %7s\n", "variant", "delay_model",
+      "clock_ps", "stages", "flop_in", "latency", "critical_ps", "area",
+      "pareto");
+  for (int64_t i = 0; i < variants.size(); ++i) {
+    const Variant& variant = variants[i];
+    const VariantResult& result = results[i];
+    std::string options = absl::StrFormat(
+        "%-12s %-16s %8s %8s %6s", VariantName(i), variant.delay_model,
+        OptionalToString(variant.clock_period_ps),
+        OptionalToString(variant.pipeline_stages),
+        variant.flop_inputs ? "true" : "false");
+    if (!result.status.ok()) {
+      std::cout << absl::StreamFormat("%s failed: %s\n", options,
+                                      result.status.message());
+      continue;
+    }
+    std::cout << absl::StreamFormat("%s %8d %12d %10d %7s\n", options,
+                                    result.latency, result.critical_path_ps,
+                                    result.area,
+                                    result.pareto_optimal ? "*" : "");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s IR_FILE",
+                                          argv[0]);
+  }
+  XLS_QCHECK_OK(xls::RealMain(positional_arguments[0]));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#
+# Copyright 2022 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tests for xls.tools.codegen_dse_main."""
+
+import subprocess
+
+from xls.common import runfiles
+from xls.common import test_base
+
+CODEGEN_DSE_MAIN_PATH = runfiles.get_path('xls/tools/codegen_dse_main')
+
+NOT_ADD_IR = """package not_add
+
+top fn not_add(x: bits[32], y: bits[32]) -> bits[32] {
+  sum: bits[32] = add(x, y)
+  ret not_sum: bits[32] = not(sum)
+}
+"""
+
+
+class CodegenDseMainTest(test_base.TestCase):
+
+  def test_clock_periods(self):
+    ir_file = self.create_tempfile(content=NOT_ADD_IR)
+    output_dir = self.create_tempdir()
+
+    output = subprocess.check_output([
+        CODEGEN_DSE_MAIN_PATH, '--delay_models=unit',
+        '--clock_period_ps=1,2', '--flop_inputs=true,false',
+        '--thread_count=2', '--output_dir=' + output_dir.full_path,
+        ir_file.full_path
+    ]).decode('utf-8')
+    lines = output.splitlines()
+    self.assertLen(lines, 5)
+    self.assertIn('critical_ps', lines[0])
+    for i, line in enumerate(lines[1:]):
+      self.assertTrue(line.startswith('variant_{} '.format(i)))
+      self.assertNotIn('failed', line)
+    # At least one variant is not dominated by any other.
+    self.assertTrue(any(line.endswith('*') for line in lines[1:]))
+    with open(output_dir.full_path + '/variant_0.v') as f:
+      self.assertIn('module variant_0', f.read())
+
+  def test_no_variants(self):
+    ir_file = self.create_tempfile(content=NOT_ADD_IR)
+
+    comp = subprocess.run(
+        [CODEGEN_DSE_MAIN_PATH, '--clock_period_ps=0', ir_file.full_path],
+        stderr=subprocess.PIPE,
+        check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('No variants to explore', comp.stderr.decode('utf-8'))
+
+
+if __name__ == '__main__':
+  test_base.main()
@@ -14,6 +14,9 @@
 
 #include "xls/tools/codegen_flags.h"
 
+#include <string>
+#include <vector>
+
 #include "absl/flags/flag.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/status_macros.h"
@@ -27,17 +30,39 @@ ABSL_FLAG(
 ABSL_FLAG(std::string, output_schedule_path, "",
           "Specific output path for the generated pipeline schedule. "
           "If not specified, then no schedule is output.");
+ABSL_FLAG(std::string, schedule_cache_dir, "",
+          "Directory holding a cache of pipeline schedules. If specified, the "
+          "schedule is read from the cache when the IR, scheduling options "
+          "and delay model match a previous run, and is added to the cache "
+          "otherwise.");
 ABSL_FLAG(std::string, output_block_ir_path, "",
           "Path to write the block-level IR.");
 ABSL_FLAG(
     std::string, output_signature_path, "",
     "Specific output path for the module signature. If not specified then "
     "no module signature is generated.");
+ABSL_FLAG(std::string, output_sdc_path, "",
+          "Specific output path for timing constraints of the pipelined "
+          "module in Synopsys Design Constraints (SDC) format: the clock and "
+          "the input and output delays of the ports, derived from the clock "
+          "period and the path delays estimated by the delay model. If not "
+          "specified then no constraints are generated.");
 ABSL_FLAG(std::string, output_verilog_line_map_path, "",
           "Specific output path for Verilog line map. If not specified then "
           "Verilog line map is not generated.");
 ABSL_FLAG(std::string, top, "",
           "Top entity of the package to generate the (System)Verilog code.");
+ABSL_FLAG(std::vector<std::string>, tops, {},
+          "Comma-separated list of entities of the package for each of which "
+          "a module is generated. The package is parsed once and the entities "
+          "are scheduled concurrently using --codegen_thread_count threads. "
+          "The Verilog, signature and (for pipelined modules) schedule of "
+          "each entity are written to --output_dir as <name>.v (or .sv), "
+          "<name>.sig.textproto and <name>.schedule.textproto. Cannot be "
+          "combined with --top, --module_name or the per-file output path "
+          "flags.");
+ABSL_FLAG(std::string, output_dir, "",
+          "Directory to which the outputs for --tops are written.");
 ABSL_FLAG(std::string, generator, "pipeline",
           "The generator to use when emitting the device function. Valid "
           "values: pipeline, combinational.");
@@ -103,6 +128,28 @@ ABSL_FLAG(std::string, streaming_channel_valid_suffix, "_vld",
 ABSL_FLAG(std::string, streaming_channel_ready_suffix, "_rdy",
           "Suffix to append to ready signals for streaming channels.");
 ABSL_FLAG(std::string, umulp_format, "", "Format string to use for smulp.");
+ABSL_FLAG(int64_t, codegen_thread_count, 1,
+          "The number of threads used to emit the generated Verilog and, with "
+          "--tops, to schedule the entities. The output does not depend on "
+          "the number of threads.");
+ABSL_FLAG(bool, sat_io_analysis, false,
+          "If true, prove that streaming outputs are mutually exclusive by "
+          "random simulation and SAT rather than with BDDs. Faster on procs "
+          "with wide send predicates.");
+ABSL_FLAG(bool, retime_registers, false,
+          "If true, move pipeline registers across combinational logic to "
+          "shorten the critical path of the pipelined block. The latency of "
+          "the pipeline is unchanged.");
+ABSL_FLAG(bool, share_resources, false,
+          "If true, share one multiplier, divider or wide adder among "
+          "operations on mutually exclusive select arms. Operations are not "
+          "shared if the added multiplexers would lengthen the critical path.");
+ABSL_FLAG(std::string, clock_gate_format, "",
+          "Format string to use when emitting a clock gating cell. If "
+          "specified, registers without a reset which have a load enable are "
+          "clocked by a gated clock rather than holding their value through "
+          "a multiplexer. Supported placeholders: {name}, {clock}, {enable} "
+          "and {gated_clock}.");
 // LINT.ThenChange(//xls/build_rules/xls_codegen_rules.bzl)
 
 namespace xls {
@@ -129,10 +176,16 @@ absl::StatusOr<CodegenFlagsProto> CodegenFlagsFromAbslFlags() {
 #define POPULATE_FLAG(__x) p.set_##__x(absl::GetFlag(FLAGS_##__x));
   POPULATE_FLAG(output_verilog_path);
   POPULATE_FLAG(output_schedule_path);
+  POPULATE_FLAG(schedule_cache_dir);
   POPULATE_FLAG(output_block_ir_path);
   POPULATE_FLAG(output_signature_path);
   POPULATE_FLAG(output_verilog_line_map_path);
+  POPULATE_FLAG(output_sdc_path);
   POPULATE_FLAG(top);
+  for (const std::string& top : absl::GetFlag(FLAGS_tops)) {
+    p.add_tops(top);
+  }
+  POPULATE_FLAG(output_dir);
 
   // Generator is somewhat special, in that we need to parse it to its enum
   // form.
@@ -177,6 +230,11 @@ absl::StatusOr<CodegenFlagsProto> CodegenFlagsFromAbslFlags() {
   POPULATE_FLAG(streaming_channel_data_suffix);
   POPULATE_FLAG(streaming_channel_valid_suffix);
   POPULATE_FLAG(streaming_channel_ready_suffix);
+  POPULATE_FLAG(codegen_thread_count);
+  POPULATE_FLAG(sat_io_analysis);
+  POPULATE_FLAG(retime_registers);
+  POPULATE_FLAG(share_resources);
+  POPULATE_FLAG(clock_gate_format);
 #undef POPULATE_FLAG
   return p;
 }
@@ -12,8 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "xls/codegen/codegen_options.h"
@@ -21,19 +28,23 @@
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/codegen/op_override_impls.h"
 #include "xls/codegen/pipeline_generator.h"
+#include "xls/codegen/timing_constraints.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/standard_pipeline.h"
 #include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/schedule_cache.h"
 #include "xls/tools/codegen_flags.h"
 #include "xls/tools/scheduling_options_flags.h"
+#include "xls/tools/tool_server.h"
 
 const char kUsage[] = R"(
 Generates Verilog RTL from a given IR file. Writes a Verilog file and a module
@@ -48,6 +59,17 @@ Emit a feed-forward pipelined module:
        --clock_period_ps=500 \
        --pipeline_stages=7 \
        IR_FILE
+
+Emit a pipelined module for each of several functions of a package:
+   codegen_main --generator=pipeline \
+       --clock_period_ps=500 \
+       --tops=foo,bar,baz \
+       --output_dir=DIR \
+       --codegen_thread_count=8 \
+       IR_FILE
+
+Serve invocations sent with tool_client_main, keeping the process warm:
+   codegen_main --serve_on_socket=/tmp/codegen.sock
 )";
 
 namespace xls {
@@ -110,7 +132,26 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
   options.streaming_channel_data_suffix(p.streaming_channel_data_suffix());
   options.streaming_channel_valid_suffix(p.streaming_channel_valid_suffix());
   options.streaming_channel_ready_suffix(p.streaming_channel_ready_suffix());
+  options.emit_thread_count(p.codegen_thread_count());
+  options.sat_io_analysis(p.sat_io_analysis());
+  options.retime_registers(p.retime_registers());
+  options.share_resources(p.share_resources());
+  if (!p.clock_gate_format().empty()) {
+    options.clock_gate_format(p.clock_gate_format());
+  }
+
+  return options;
+}
 
+// Returns the options for generating a pipeline scheduled with the given
+// options. Lookups scheduled as memory reads are lowered to memories.
+verilog::CodegenOptions PipelineCodegenOptions(
+    const verilog::CodegenOptions& codegen_options,
+    const SchedulingOptions& scheduling_options) {
+  verilog::CodegenOptions options = codegen_options;
+  if (scheduling_options.memory_lookups().has_value()) {
+    options.memory_lookups(scheduling_options.memory_lookups().value());
+  }
   return options;
 }
 
@@ -139,6 +180,129 @@ absl::StatusOr<PipelineSchedule> RunSchedulingPipeline(
   return schedule_status;
 }
 
+// Returns the schedule of `main`. If `cache_dir` is non-empty the schedule is
+// read from the schedule cache in that directory when present, and added to
+// the cache otherwise.
+absl::StatusOr<PipelineSchedule> RunSchedulingPipelineWithCache(
+    FunctionBase* main, const SchedulingOptions& scheduling_options,
+    const DelayEstimator* delay_estimator, const std::string& cache_dir) {
+  if (cache_dir.empty()) {
+    return RunSchedulingPipeline(main, scheduling_options, delay_estimator);
+  }
+  ScheduleCache cache(cache_dir);
+  XLS_ASSIGN_OR_RETURN(
+      std::optional<PipelineSchedule> cached,
+      cache.Lookup(main, scheduling_options, delay_estimator->name()));
+  if (cached.has_value()) {
+    return *std::move(cached);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      PipelineSchedule schedule,
+      RunSchedulingPipeline(main, scheduling_options, delay_estimator));
+  XLS_RETURN_IF_ERROR(
+      cache.Insert(schedule, scheduling_options, delay_estimator->name()));
+  return schedule;
+}
+
+// Generates a module for each of the entities named by the --tops flag and
+// writes the outputs of each into --output_dir. The package is shared by all
+// entities. Scheduling only reads the package so the entities are scheduled
+// concurrently. Module generation adds blocks to the package and is done
+// serially in the order the entities are given.
+absl::Status GenerateMultipleTops(
+    Package* p, const CodegenFlagsProto& codegen_flags_proto,
+    const verilog::CodegenOptions& codegen_options) {
+  if (!codegen_flags_proto.top().empty()) {
+    return absl::InvalidArgumentError("--top cannot be used with --tops.");
+  }
+  if (!codegen_flags_proto.module_name().empty()) {
+    return absl::InvalidArgumentError(
+        "--module_name cannot be used with --tops; each module is named after "
+        "its entity.");
+  }
+  if (!codegen_flags_proto.output_verilog_path().empty() ||
+      !codegen_flags_proto.output_schedule_path().empty() ||
+      !codegen_flags_proto.output_block_ir_path().empty() ||
+      !codegen_flags_proto.output_signature_path().empty() ||
+      !codegen_flags_proto.output_verilog_line_map_path().empty() ||
+      !codegen_flags_proto.output_sdc_path().empty()) {
+    return absl::InvalidArgumentError(
+        "Per-file output path flags cannot be used with --tops; outputs are "
+        "written to --output_dir.");
+  }
+  if (codegen_flags_proto.output_dir().empty()) {
+    return absl::InvalidArgumentError("--tops requires --output_dir.");
+  }
+  std::filesystem::path output_dir(codegen_flags_proto.output_dir());
+
+  std::vector<FunctionBase*> tops;
+  for (const std::string& name : codegen_flags_proto.tops()) {
+    XLS_ASSIGN_OR_RETURN(FunctionBase * top, p->GetFunctionBaseByName(name));
+    tops.push_back(top);
+  }
+
+  std::vector<absl::StatusOr<PipelineSchedule>> schedules(
+      tops.size(), absl::UnknownError("Entity not scheduled"));
+  const DelayEstimator* delay_estimator = nullptr;
+  verilog::CodegenOptions pipeline_options = codegen_options;
+  if (codegen_flags_proto.generator() == GENERATOR_KIND_PIPELINE) {
+    if (absl::GetFlag(FLAGS_pipeline_stages) == 0 &&
+        absl::GetFlag(FLAGS_clock_period_ps) == 0) {
+      return absl::InvalidArgumentError(
+          "Must specify --pipeline_stages or --clock_period_ps (or both).");
+    }
+    XLS_ASSIGN_OR_RETURN(SchedulingOptions scheduling_options,
+                         SetUpSchedulingOptions(p));
+    pipeline_options =
+        PipelineCodegenOptions(codegen_options, scheduling_options);
+    XLS_ASSIGN_OR_RETURN(delay_estimator, SetUpDelayEstimator());
+    std::atomic<int64_t> next_top = 0;
+    auto schedule_tops = [&]() {
+      for (int64_t i = next_top++; i < tops.size(); i = next_top++) {
+        schedules[i] = RunSchedulingPipelineWithCache(
+            tops[i], scheduling_options, delay_estimator,
+            codegen_flags_proto.schedule_cache_dir());
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < codegen_flags_proto.codegen_thread_count() &&
+                        i < tops.size();
+         ++i) {
+      threads.push_back(std::make_unique<Thread>(schedule_tops));
+    }
+    schedule_tops();
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  std::string verilog_extension =
+      codegen_flags_proto.use_system_verilog() ? ".sv" : ".v";
+  for (int64_t i = 0; i < tops.size(); ++i) {
+    FunctionBase* top = tops[i];
+    verilog::ModuleGeneratorResult result;
+    if (codegen_flags_proto.generator() == GENERATOR_KIND_PIPELINE) {
+      XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule, std::move(schedules[i]));
+      XLS_ASSIGN_OR_RETURN(
+          result, verilog::ToPipelineModuleText(schedule, top, pipeline_options,
+                                                delay_estimator));
+      XLS_RETURN_IF_ERROR(SetTextProtoFile(
+          output_dir / absl::StrCat(top->name(), ".schedule.textproto"),
+          schedule.ToProto()));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          result, verilog::GenerateCombinationalModule(top, codegen_options));
+    }
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(
+        output_dir / absl::StrCat(top->name(), ".sig.textproto"),
+        result.signature.proto()));
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        output_dir / absl::StrCat(top->name(), verilog_extension),
+        result.verilog_text));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status RealMain(std::string_view ir_path) {
   XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
                        CodegenFlagsFromAbslFlags());
@@ -157,6 +321,10 @@ absl::Status RealMain(std::string_view ir_path) {
   XLS_ASSIGN_OR_RETURN(verilog::CodegenOptions codegen_options,
                        CodegenOptionsFromProto(codegen_flags_proto));
 
+  if (codegen_flags_proto.tops_size() > 0) {
+    return GenerateMultipleTops(p.get(), codegen_flags_proto, codegen_options);
+  }
+
   std::optional<std::string_view> maybe_top_str;
   if (!codegen_flags_proto.top().empty()) {
     maybe_top_str = codegen_flags_proto.top();
@@ -164,25 +332,40 @@ absl::Status RealMain(std::string_view ir_path) {
   XLS_ASSIGN_OR_RETURN(FunctionBase * main, FindTop(p.get(), maybe_top_str));
 
   if (codegen_flags_proto.generator() == GENERATOR_KIND_PIPELINE) {
-    XLS_QCHECK(absl::GetFlag(FLAGS_pipeline_stages) != 0 ||
-               absl::GetFlag(FLAGS_clock_period_ps) != 0)
-        << "Must specify --pipeline_stages or --clock_period_ps (or both).";
+    if (absl::GetFlag(FLAGS_pipeline_stages) == 0 &&
+        absl::GetFlag(FLAGS_clock_period_ps) == 0) {
+      return absl::InvalidArgumentError(
+          "Must specify --pipeline_stages or --clock_period_ps (or both).");
+    }
 
     XLS_ASSIGN_OR_RETURN(SchedulingOptions scheduling_options,
                          SetUpSchedulingOptions(p.get()));
     XLS_ASSIGN_OR_RETURN(const DelayEstimator* delay_estimator,
                          SetUpDelayEstimator());
-    XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
-        RunSchedulingPipeline(main, scheduling_options, delay_estimator));
+    XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
+                         RunSchedulingPipelineWithCache(
+                             main, scheduling_options, delay_estimator,
+                             codegen_flags_proto.schedule_cache_dir()));
 
     XLS_ASSIGN_OR_RETURN(
-        result, verilog::ToPipelineModuleText(schedule, main, codegen_options));
+        result, verilog::ToPipelineModuleText(
+                    schedule, main,
+                    PipelineCodegenOptions(codegen_options, scheduling_options),
+                    delay_estimator));
 
     if (!codegen_flags_proto.output_schedule_path().empty()) {
       XLS_RETURN_IF_ERROR(SetTextProtoFile(
           codegen_flags_proto.output_schedule_path(), schedule.ToProto()));
     }
+
+    if (!codegen_flags_proto.output_sdc_path().empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          std::string sdc,
+          verilog::GenerateSdcConstraints(
+              result.signature, scheduling_options.clock_period_ps()));
+      XLS_RETURN_IF_ERROR(
+          SetFileContents(codegen_flags_proto.output_sdc_path(), sdc));
+    }
   } else if (codegen_flags_proto.generator() == GENERATOR_KIND_COMBINATIONAL) {
     XLS_ASSIGN_OR_RETURN(
         result, verilog::GenerateCombinationalModule(main, codegen_options));
@@ -235,6 +418,20 @@ int main(int argc, char** argv) {
   std::vector<std::string_view> positional_arguments =
       xls::InitXls(kUsage, argc, argv);
 
+  std::string serve_on_socket = absl::GetFlag(FLAGS_serve_on_socket);
+  if (!serve_on_socket.empty()) {
+    XLS_QCHECK_OK(xls::tools::ServeToolInvocations(
+        serve_on_socket,
+        [](absl::Span<const std::string_view> args) -> absl::Status {
+          if (args.size() != 1) {
+            return absl::InvalidArgumentError(
+                "Expected invocation: codegen_main IR_FILE");
+          }
+          return xls::RealMain(args[0]);
+        }));
+    return EXIT_SUCCESS;
+  }
+
   if (positional_arguments.size() != 1) {
     XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s IR_FILE",
                                           argv[0]);
@@ -15,6 +15,7 @@
 
 """Tests for xls.tools.codegen_main."""
 
+import os
 import subprocess
 
 from google.protobuf import text_format
@@ -68,6 +69,23 @@ fn gate_example(x: bits[32], y: bits[1]) -> bits[32] {
 }
 """
 
+MULTI_FUNCTION_IR = """package multi
+
+fn add_one(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=1)
+  ret add.2: bits[32] = add(x, literal.1)
+}
+
+fn not_and(x: bits[8], y: bits[8]) -> bits[8] {
+  and.3: bits[8] = and(x, y)
+  ret not.4: bits[8] = not(and.3)
+}
+
+fn negate(x: bits[16]) -> bits[16] {
+  ret neg.5: bits[16] = neg(x)
+}
+"""
+
 
 class CodeGenMainTest(parameterized.TestCase):
 
@@ -157,6 +175,30 @@ class CodeGenMainTest(parameterized.TestCase):
     ]).decode('utf-8')
     self.assertIn('module foo_qux_baz(', verilog)
 
+  @parameterized.parameters(['combinational', 'pipeline'])
+  def test_multiple_tops(self, generator):
+    ir_file = self.create_tempfile(content=MULTI_FUNCTION_IR)
+    output_dir = self.create_tempdir()
+    subprocess.check_call([
+        CODEGEN_MAIN_PATH, '--generator=' + generator, '--delay_model=unit',
+        '--pipeline_stages=2', '--alsologtostderr',
+        '--tops=add_one,not_and,negate', '--codegen_thread_count=2',
+        '--output_dir=' + output_dir.full_path, ir_file.full_path
+    ])
+
+    for top in ['add_one', 'not_and', 'negate']:
+      with open(f'{output_dir.full_path}/{top}.sv', 'r') as f:
+        self.assertIn(f'module {top}(', f.read())
+      with open(f'{output_dir.full_path}/{top}.sig.textproto', 'r') as f:
+        sig_proto = text_format.Parse(
+            f.read(), module_signature_pb2.ModuleSignatureProto())
+        self.assertEqual(sig_proto.module_name, top)
+        self.assertEqual(
+            sig_proto.HasField('pipeline'), generator == 'pipeline')
+      if generator == 'pipeline':
+        self.assertTrue(
+            os.path.exists(f'{output_dir.full_path}/{top}.schedule.textproto'))
+
   def test_pipeline_system_verilog(self):
     verilog_path = test_base.create_named_output_text_file('sha256.sv')
     subprocess.check_call([
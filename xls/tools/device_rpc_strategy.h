@@ -15,9 +15,14 @@
 #ifndef XLS_TOOLS_DEVICE_RPC_STRATEGY_H_
 #define XLS_TOOLS_DEVICE_RPC_STRATEGY_H_
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 
@@ -38,6 +43,25 @@ class DeviceRpcStrategy {
   // Calls an unnamed function on the device.
   virtual absl::StatusOr<Value> CallUnnamed(
       const FunctionType& function_type, absl::Span<const Value> arguments) = 0;
+
+  // Calls an unnamed function on the device once per element of
+  // "argument_sets", returning the results in the same order. Strategies may
+  // pipeline the calls, issuing up to "max_in_flight" requests before
+  // collecting the first response; the default implementation makes the calls
+  // one at a time.
+  virtual absl::StatusOr<std::vector<Value>> CallUnnamedBatch(
+      const FunctionType& function_type,
+      absl::Span<const std::vector<Value>> argument_sets,
+      int64_t max_in_flight) {
+    std::vector<Value> results;
+    results.reserve(argument_sets.size());
+    for (const std::vector<Value>& arguments : argument_sets) {
+      XLS_ASSIGN_OR_RETURN(Value result,
+                           CallUnnamed(function_type, arguments));
+      results.push_back(std::move(result));
+    }
+    return results;
+  }
 };
 
 }  // namespace xls
@@ -20,6 +20,9 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/ir_parser.h"
@@ -32,6 +35,13 @@ ABSL_FLAG(int64_t, device_ordinal, 0,
           "Device ordinal within the -target_device category, useful when "
           "multiple are present.");
 ABSL_FLAG(std::string, function_type, "", "Function type being invoked.");
+ABSL_FLAG(std::string, args_file, "",
+          "Batch of invocations to make instead of a single one given by "
+          "positional arguments: one invocation per line, with the arguments "
+          "separated by ';'. One result is printed per line, in order.");
+ABSL_FLAG(int64_t, max_in_flight, 2,
+          "Maximum number of requests of an -args_file batch sent to the "
+          "device before its first outstanding response is received.");
 
 namespace xls {
 namespace tools {
@@ -50,13 +60,38 @@ void RealMain(absl::Span<const std::string_view> args) {
   XLS_QCHECK_OK(function_type_status.status());
   FunctionType* function_type = function_type_status.value();
 
-  std::vector<Value> arguments;
-  for (int64_t i = 0; i < args.size(); ++i) {
-    std::string_view s = args[i];
-    absl::StatusOr<Value> argument =
-        Parser::ParseValue(s, function_type->parameter_type(i));
-    XLS_QCHECK_OK(argument.status());
-    arguments.push_back(std::move(argument).value());
+  auto parse_arguments = [&](absl::Span<const std::string_view> strs) {
+    XLS_QCHECK_EQ(strs.size(), function_type->parameter_count())
+        << "Wrong number of arguments for function type "
+        << function_type->ToString();
+    std::vector<Value> arguments;
+    for (int64_t i = 0; i < strs.size(); ++i) {
+      absl::StatusOr<Value> argument =
+          Parser::ParseValue(strs[i], function_type->parameter_type(i));
+      XLS_QCHECK_OK(argument.status());
+      arguments.push_back(std::move(argument).value());
+    }
+    return arguments;
+  };
+
+  std::string args_file = absl::GetFlag(FLAGS_args_file);
+  std::vector<std::vector<Value>> argument_sets;
+  if (args_file.empty()) {
+    argument_sets.push_back(parse_arguments(args));
+  } else {
+    XLS_QCHECK(args.empty())
+        << "Cannot provide both -args_file and positional arguments";
+    absl::StatusOr<std::string> contents = GetFileContents(args_file);
+    XLS_QCHECK_OK(contents.status());
+    for (std::string_view line :
+         absl::StrSplit(contents.value(), '\n', absl::SkipWhitespace())) {
+      std::vector<std::string_view> strs =
+          absl::StrSplit(line, ';', absl::SkipWhitespace());
+      for (std::string_view& str : strs) {
+        str = absl::StripAsciiWhitespace(str);
+      }
+      argument_sets.push_back(parse_arguments(strs));
+    }
   }
 
   absl::StatusOr<std::unique_ptr<DeviceRpcStrategy>> drpc_status =
@@ -66,11 +101,13 @@ void RealMain(absl::Span<const std::string_view> args) {
   std::unique_ptr<DeviceRpcStrategy> drpc = std::move(drpc_status).value();
   XLS_QCHECK_OK(drpc->Connect(absl::GetFlag(FLAGS_device_ordinal)));
 
-  absl::StatusOr<Value> rpc_status =
-      drpc->CallUnnamed(*function_type, arguments);
+  absl::StatusOr<std::vector<Value>> rpc_status = drpc->CallUnnamedBatch(
+      *function_type, argument_sets, absl::GetFlag(FLAGS_max_in_flight));
   XLS_QCHECK_OK(rpc_status.status());
 
-  std::cout << rpc_status.value().ToString(FormatPreference::kHex) << std::endl;
+  for (const Value& result : rpc_status.value()) {
+    std::cout << result.ToString(FormatPreference::kHex) << std::endl;
+  }
 }
 
 }  // namespace
@@ -0,0 +1,200 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/equivalence_simulation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/type.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kCornerValueCount = 5;
+
+// Returns corner value `which` (in [0, kCornerValueCount)) of the given type.
+// Aggregates hold the same corner value in every element.
+Value CornerValue(Type* type, int64_t which) {
+  if (type->IsTuple()) {
+    std::vector<Value> elements;
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      elements.push_back(CornerValue(element_type, which));
+    }
+    return Value::Tuple(elements);
+  }
+  if (type->IsArray()) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    std::vector<Value> elements(
+        array_type->size(), CornerValue(array_type->element_type(), which));
+    return Value::Array(elements).value();
+  }
+  if (type->IsToken()) {
+    return Value::Token();
+  }
+  int64_t bit_count = type->AsBitsOrDie()->bit_count();
+  if (bit_count == 0) {
+    return Value(Bits());
+  }
+  switch (which) {
+    case 0:
+      return Value(Bits(bit_count));
+    case 1:
+      return Value(UBits(1, bit_count));
+    case 2:
+      return Value(Bits::AllOnes(bit_count));
+    case 3:
+      return Value(Bits::MinSigned(bit_count));
+    default:
+      return Value(Bits::MaxSigned(bit_count));
+  }
+}
+
+// Returns the number of input vectors made of corner values, i.e.,
+// kCornerValueCount ** param_count, saturating at `limit`.
+int64_t CornerVectorCount(int64_t param_count, int64_t limit) {
+  int64_t count = 1;
+  for (int64_t i = 0; i < param_count && count < limit; ++i) {
+    count *= kCornerValueCount;
+  }
+  return std::min(count, limit);
+}
+
+}  // namespace
+
+std::string EquivalenceCounterexample::ToString() const {
+  return absl::StrFormat(
+      "args: (%s)\n  lhs result: %s\n  rhs result: %s",
+      absl::StrJoin(args, ", ",
+                    [](std::string* out, const Value& v) {
+                      absl::StrAppend(out, v.ToString());
+                    }),
+      lhs_result.ToString(), rhs_result.ToString());
+}
+
+absl::StatusOr<std::optional<EquivalenceCounterexample>>
+FindCounterexampleBySimulation(Function* lhs, Function* rhs,
+                               const EquivalenceSimulationOptions& options) {
+  XLS_RET_CHECK_GT(options.batch_size, 0);
+  if (lhs->params().size() != rhs->params().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Functions have different numbers of parameters: %d vs %d",
+        lhs->params().size(), rhs->params().size()));
+  }
+  std::vector<Type*> param_types;
+  for (int64_t i = 0; i < lhs->params().size(); ++i) {
+    Type* type = lhs->param(i)->GetType();
+    if (!type->IsEqualTo(rhs->param(i)->GetType())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Parameter %d has different types: %s vs %s", i, type->ToString(),
+          rhs->param(i)->GetType()->ToString()));
+    }
+    param_types.push_back(type);
+  }
+  Type* return_type = lhs->return_value()->GetType();
+  if (!return_type->IsEqualTo(rhs->return_value()->GetType())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Functions have different return types: %s vs %s",
+        return_type->ToString(), rhs->return_value()->GetType()->ToString()));
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> lhs_jit,
+                       FunctionJit::Create(lhs));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> rhs_jit,
+                       FunctionJit::Create(rhs));
+  int64_t return_size = lhs_jit->GetReturnTypeSize();
+  XLS_RET_CHECK_EQ(return_size, rhs_jit->GetReturnTypeSize());
+
+  int64_t param_count = param_types.size();
+  int64_t corner_count =
+      CornerVectorCount(param_count, options.sample_count);
+  std::minstd_rand engine(options.seed);
+
+  // The arguments of each batch in structure-of-arrays form (see
+  // FunctionJit::RunBatched), along with their values for reporting.
+  std::vector<std::vector<uint8_t>> arg_buffers(param_count);
+  std::vector<const uint8_t*> arg_pointers(param_count);
+  std::vector<std::vector<Value>> batch_args;
+  std::vector<uint8_t> lhs_results;
+  std::vector<uint8_t> rhs_results;
+  for (int64_t start = 0; start < options.sample_count;
+       start += options.batch_size) {
+    int64_t batch_size =
+        std::min(options.batch_size, options.sample_count - start);
+    batch_args.resize(batch_size);
+    for (int64_t i = 0; i < param_count; ++i) {
+      arg_buffers[i].assign(batch_size * lhs_jit->GetArgTypeSize(i), 0);
+      arg_pointers[i] = arg_buffers[i].data();
+    }
+    for (int64_t b = 0; b < batch_size; ++b) {
+      int64_t sample = start + b;
+      std::vector<Value>& args = batch_args[b];
+      args.clear();
+      int64_t corners = sample;
+      for (int64_t i = 0; i < param_count; ++i) {
+        if (sample < corner_count) {
+          args.push_back(
+              CornerValue(param_types[i], corners % kCornerValueCount));
+          corners /= kCornerValueCount;
+        } else {
+          args.push_back(RandomValue(param_types[i], &engine));
+        }
+        int64_t arg_size = lhs_jit->GetArgTypeSize(i);
+        lhs_jit->runtime()->BlitValueToBuffer(
+            args.back(), param_types[i],
+            absl::MakeSpan(arg_buffers[i]).subspan(b * arg_size, arg_size));
+      }
+    }
+
+    lhs_results.assign(batch_size * return_size, 0);
+    rhs_results.assign(batch_size * return_size, 0);
+    InterpreterEvents events;
+    XLS_RETURN_IF_ERROR(lhs_jit->RunBatched(
+        arg_pointers, absl::MakeSpan(lhs_results), batch_size, &events));
+    XLS_RETURN_IF_ERROR(rhs_jit->RunBatched(
+        arg_pointers, absl::MakeSpan(rhs_results), batch_size, &events));
+
+    for (int64_t b = 0; b < batch_size; ++b) {
+      const uint8_t* lhs_result = lhs_results.data() + b * return_size;
+      const uint8_t* rhs_result = rhs_results.data() + b * return_size;
+      // Equal buffers hold equal values; unequal ones may only differ in
+      // padding so compare the values themselves.
+      if (std::memcmp(lhs_result, rhs_result, return_size) == 0) {
+        continue;
+      }
+      Value lhs_value =
+          lhs_jit->runtime()->UnpackBuffer(lhs_result, return_type);
+      Value rhs_value =
+          rhs_jit->runtime()->UnpackBuffer(rhs_result, return_type);
+      if (lhs_value != rhs_value) {
+        return EquivalenceCounterexample{batch_args[b], lhs_value, rhs_value};
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace xls
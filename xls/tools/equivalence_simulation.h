@@ -0,0 +1,65 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_EQUIVALENCE_SIMULATION_H_
+#define XLS_TOOLS_EQUIVALENCE_SIMULATION_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+struct EquivalenceSimulationOptions {
+  // The total number of input vectors to try.
+  int64_t sample_count = 1 << 16;
+
+  // The number of input vectors evaluated by each (batched) JIT call.
+  int64_t batch_size = 1024;
+
+  // Seed of the random input vectors.
+  int64_t seed = 0;
+};
+
+// A set of arguments on which two functions produce different results.
+struct EquivalenceCounterexample {
+  std::vector<Value> args;
+  Value lhs_result;
+  Value rhs_result;
+
+  std::string ToString() const;
+};
+
+// Runs `lhs` and `rhs`, which must have the same signature, on the same input
+// vectors through the batched JIT and returns the first vector on which their
+// results differ, if any. This is a cheap pre-filter for a formal equivalence
+// check: a nullopt result proves nothing.
+//
+// The first input vectors are the combinations of corner values of each
+// parameter (zero, one, all ones, and the minimum and maximum signed values,
+// element-wise for aggregates), as these find many bugs in arithmetic and
+// comparisons which uniformly random inputs are unlikely to hit. The remaining
+// vectors are uniformly random.
+absl::StatusOr<std::optional<EquivalenceCounterexample>>
+FindCounterexampleBySimulation(Function* lhs, Function* rhs,
+                               const EquivalenceSimulationOptions& options);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_EQUIVALENCE_SIMULATION_H_
@@ -0,0 +1,127 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/equivalence_simulation.h"
+
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+class EquivalenceSimulationTest : public IrTestBase {};
+
+TEST_F(EquivalenceSimulationTest, EquivalentFunctions) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * lhs, ParseFunction(R"(
+fn lhs(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(x, y)
+}
+)",
+                                                         p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * rhs, ParseFunction(R"(
+fn rhs(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.2: bits[8] = add(y, x)
+}
+)",
+                                                         p.get()));
+  EquivalenceSimulationOptions options;
+  options.sample_count = 4096;
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<EquivalenceCounterexample> result,
+                           FindCounterexampleBySimulation(lhs, rhs, options));
+  EXPECT_FALSE(result.has_value());
+}
+
+TEST_F(EquivalenceSimulationTest, CornerCaseDifference) {
+  auto p = CreatePackage();
+  // The functions only differ when x is the minimum signed value, which
+  // uniformly random inputs would find with probability 2^-32 per sample.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * lhs, ParseFunction(R"(
+fn lhs(x: bits[32]) -> bits[1] {
+  zero: bits[32] = literal(value=0)
+  neg: bits[32] = neg(x)
+  ret slt.1: bits[1] = slt(neg, zero)
+}
+)",
+                                                         p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * rhs, ParseFunction(R"(
+fn rhs(x: bits[32]) -> bits[1] {
+  zero: bits[32] = literal(value=0)
+  ret sgt.2: bits[1] = sgt(x, zero)
+}
+)",
+                                                         p.get()));
+  EquivalenceSimulationOptions options;
+  options.sample_count = 16;
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<EquivalenceCounterexample> result,
+                           FindCounterexampleBySimulation(lhs, rhs, options));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->args, std::vector<Value>{Value(Bits::MinSigned(32))});
+  EXPECT_EQ(result->lhs_result, Value(UBits(1, 1)));
+  EXPECT_EQ(result->rhs_result, Value(UBits(0, 1)));
+}
+
+TEST_F(EquivalenceSimulationTest, RandomDifferenceInLaterBatch) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * lhs, ParseFunction(R"(
+fn lhs(x: bits[8], y: (bits[4], bits[4])) -> bits[4] {
+  ret tuple_index.1: bits[4] = tuple_index(y, index=0)
+}
+)",
+                                                         p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * rhs, ParseFunction(R"(
+fn rhs(x: bits[8], y: (bits[4], bits[4])) -> bits[4] {
+  ret tuple_index.2: bits[4] = tuple_index(y, index=1)
+}
+)",
+                                                         p.get()));
+  EquivalenceSimulationOptions options;
+  // All corner vectors have equal tuple elements.
+  options.batch_size = 8;
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<EquivalenceCounterexample> result,
+                           FindCounterexampleBySimulation(lhs, rhs, options));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_NE(result->lhs_result, result->rhs_result);
+  EXPECT_EQ(result->args[1].element(0), result->lhs_result);
+  EXPECT_EQ(result->args[1].element(1), result->rhs_result);
+}
+
+TEST_F(EquivalenceSimulationTest, MismatchedSignatures) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * lhs, ParseFunction(R"(
+fn lhs(x: bits[8]) -> bits[8] {
+  ret x: bits[8] = param(name=x)
+}
+)",
+                                                         p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * rhs, ParseFunction(R"(
+fn rhs(x: bits[16]) -> bits[16] {
+  ret x: bits[16] = param(name=x)
+}
+)",
+                                                         p.get()));
+  EXPECT_FALSE(FindCounterexampleBySimulation(lhs, rhs,
+                                              EquivalenceSimulationOptions())
+                   .ok());
+}
+
+}  // namespace
+}  // namespace xls
@@ -12,7 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <random>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
@@ -26,19 +32,23 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/ir_converter.h"
 #include "xls/dslx/mangle.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/interpreter/evaluation_cache.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value_helpers.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/orc_jit.h"
 #include "xls/passes/passes.h"
 #include "xls/passes/standard_pipeline.h"
+#include "xls/tools/value_stream.h"
 
 const char kUsage[] = R"(
 Evaluates an IR file with user-specified or random inputs using the IR
@@ -59,6 +69,13 @@ and compare each result against a corresponding values in EXPECTED_FILE:
 
    eval_ir_main --input_file=INPUT_FILE --expected_file=EXPECTED_FILE IR_FILE
 
+Evaluate an IR function on a large binary file of arguments in the native
+layout of the JIT (see xls/tools/value_stream.h), streaming the results to
+a file in the same format:
+
+   eval_ir_main --input_file=INPUT_FILE --input_format=jit \
+       --output_file=OUTPUT_FILE --output_format=jit IR_FILE
+
 Evaluate IR with randomly generated inputs:
 
    eval_ir_main --random_inputs=100 IR_FILE
@@ -84,6 +101,10 @@ Evaluate IR after every optimization pass:
 Evaluate IR using the JIT and with the interpreter and compare the results:
 
    eval_ir_main --test_llvm_jit --random_inputs=100  IR_FILE
+
+Evaluate IR with randomly generated inputs using 8 threads:
+
+   eval_ir_main --random_inputs=100000 --threads=8 IR_FILE
 )";
 
 // LINT.IfChange
@@ -98,6 +119,13 @@ ABSL_FLAG(std::string, input_file, "",
 ABSL_FLAG(int64_t, random_inputs, 0,
           "If non-zero, this is the number of randomly generated inputs to use "
           "in evaluation. Cannot be specified with --input.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads to use for generating random inputs and "
+          "evaluating the inputs. The inputs are split into contiguous shards, "
+          "one per thread, each with its own JIT and (for random inputs) its "
+          "own deterministically seeded random number generator. Results are "
+          "always printed in input order. The generated random inputs depend "
+          "on the number of threads.");
 ABSL_FLAG(std::string, expected, "",
           "The expected result of the evaluation. A non-zero error code is "
           "returned if the evaluated result does not match.");
@@ -115,12 +143,31 @@ ABSL_FLAG(
     "When specified with --optimize_ir, run evaluation after each pass. "
     "A non-zero error status is returned if any of the results do not match.");
 ABSL_FLAG(bool, use_llvm_jit, true, "Use the LLVM IR JIT for execution.");
+ABSL_FLAG(int64_t, interpreter_cache_size, 0,
+          "If non-zero (and the JIT is not used), the maximum number of "
+          "results of functions called via invoke and map operations which "
+          "are memoized by the interpreter. Speeds up evaluation of inputs "
+          "which repeatedly call functions with the same arguments.");
 ABSL_FLAG(bool, test_llvm_jit, false,
           "If true, then run the JIT and compare the results against the "
           "interpereter.");
 ABSL_FLAG(int64_t, llvm_opt_level, 3,
           "The optimization level of the LLVM JIT. Valid values are from 0 (no "
           "optimizations) to 3 (maximum optimizations).");
+ABSL_FLAG(std::string, jit_object_cache_dir, "",
+          "If non-empty, the directory in which to cache object code compiled "
+          "by the LLVM JIT. Later invocations on the same IR reuse the cached "
+          "object code rather than recompiling.");
+ABSL_FLAG(xls::JitCompilationMode, jit_compilation_mode,
+          xls::JitCompilationMode::kEager,
+          "How the LLVM JIT compiles the function and the functions it "
+          "invokes. One of: eager (compile everything up front as one "
+          "module), concurrent (compile each function as a separate module in "
+          "parallel), lazy (compile each function on its first call).");
+ABSL_FLAG(xls::JitCpuTarget, jit_cpu_target, xls::JitCpuTarget::kHost,
+          "The CPU the LLVM JIT generates code for. One of: host (tune for the "
+          "detected model and features of the host CPU), generic (baseline "
+          "features of the host architecture).");
 ABSL_FLAG(std::string, input_validator_expr, "",
           "DSLX expression to validate randomly-generated inputs. "
           "The expression can reference entry function input arguments "
@@ -140,6 +187,22 @@ ABSL_FLAG(
     "Test-only flag for injecting the result produced by the JIT. Used to "
     "force mismatches between JIT and interpreter for testing purposed.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(std::string, input_format, "text",
+          "Format of --input_file and --expected_file. One of: text, jit. The "
+          "jit format holds values in the native data layout of the JIT (see "
+          "xls/tools/value_stream.h) and requires --use_llvm_jit.");
+ABSL_FLAG(std::string, output_file, "",
+          "If specified, the results of evaluating --input_file are written "
+          "to this file in the format given by --output_format instead of "
+          "being printed.");
+ABSL_FLAG(std::string, output_format, "text",
+          "Format of --output_file. One of: text, jit. The jit format "
+          "requires --input_format=jit.");
+ABSL_FLAG(int64_t, batch_size, 65536,
+          "Number of inputs read from --input_file and evaluated at a time. "
+          "Inputs are streamed through evaluation in batches, so memory use "
+          "does not depend on the size of the file, unless --optimize_ir or "
+          "--test_llvm_jit is given which require all inputs in memory.");
 
 namespace xls {
 namespace {
@@ -154,29 +217,105 @@ struct ArgSet {
   std::optional<Value> expected;
 };
 
+// A contiguous range [start, end) of the inputs which is processed by a single
+// thread.
+struct Shard {
+  int64_t start;
+  int64_t end;
+};
+
+// Splits `count` items into at most `thread_count` shards of nearly equal
+// size. At least one (possibly empty) shard is always returned.
+std::vector<Shard> MakeShards(int64_t count, int64_t thread_count) {
+  int64_t shard_count = std::max(int64_t{1}, std::min(thread_count, count));
+  std::vector<Shard> shards;
+  for (int64_t i = 0; i < shard_count; ++i) {
+    shards.push_back(
+        Shard{count * i / shard_count, count * (i + 1) / shard_count});
+  }
+  return shards;
+}
+
+// Runs `fn` on each of the shards, in parallel if there is more than one
+// shard. Returns the status of each invocation indexed by shard.
+std::vector<absl::Status> RunShards(
+    absl::Span<const Shard> shards,
+    const std::function<absl::Status(int64_t, const Shard&)>& fn) {
+  std::vector<absl::Status> statuses(shards.size());
+  if (shards.size() == 1) {
+    statuses[0] = fn(0, shards[0]);
+    return statuses;
+  }
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < shards.size(); ++i) {
+    threads.push_back(std::make_unique<Thread>(
+        [&, i]() { statuses[i] = fn(i, shards[i]); }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  return statuses;
+}
+
+// Returns the first error in the given statuses, or OK if there is none.
+absl::Status FirstError(absl::Span<const absl::Status> statuses) {
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 // Returns the given arguments as a semicolon-separated string.
 std::string ArgsToString(absl::Span<const Value> args) {
   return absl::StrJoin(args, "; ", ValueFormatterHex);
 }
 
-// Evaluates the function with the given ArgSets. Returns an error if the result
-// does not match expectations (if any). 'actual_src' and 'expected_src' are
-// string descriptions of the sources of the actual results and expected
-// results, respectively. These strings are included in error messages.
-absl::StatusOr<std::vector<Value>> Eval(
-    Function* f, absl::Span<const ArgSet> arg_sets, bool use_jit,
-    std::string_view actual_src = "actual",
-    std::string_view expected_src = "expected") {
-  std::unique_ptr<FunctionJit> jit;
-  if (use_jit) {
-    // No support for procs yet.
-    XLS_ASSIGN_OR_RETURN(
-        jit, FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level)));
+absl::StatusOr<std::unique_ptr<FunctionJit>> CreateJit(Function* f) {
+  // No support for procs yet.
+  std::optional<std::filesystem::path> object_cache_dir;
+  if (!absl::GetFlag(FLAGS_jit_object_cache_dir).empty()) {
+    object_cache_dir = absl::GetFlag(FLAGS_jit_object_cache_dir);
+  }
+  return FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level),
+                             object_cache_dir,
+                             absl::GetFlag(FLAGS_jit_compilation_mode),
+                             absl::GetFlag(FLAGS_jit_cpu_target));
+}
+
+// State carried across calls to Eval when the inputs are evaluated in
+// batches.
+struct EvalStream {
+  // JITs indexed by shard. Each is created on first use and reused by later
+  // batches so the function is compiled once per thread rather than once per
+  // batch.
+  std::vector<std::unique_ptr<FunctionJit>> jits;
+  // Index of the first input of the batch among all inputs.
+  int64_t first_index = 0;
+  // Where the results are printed.
+  std::ostream* out = &std::cout;
+};
+
+// Evaluates the function on the given ArgSets (a single shard of the inputs)
+// and writes the results into `results`. Each shard uses its own JIT (if
+// `use_jit`), created in `jit` if not yet set, so shards may be evaluated
+// concurrently.
+absl::Status EvalShard(Function* f, absl::Span<const ArgSet> arg_sets,
+                       bool use_jit, absl::Span<Value> results,
+                       std::unique_ptr<FunctionJit>& jit) {
+  if (use_jit && jit == nullptr) {
+    XLS_ASSIGN_OR_RETURN(jit, CreateJit(f));
+  }
+
+  // The cache is local to this evaluation as the function (and its callees)
+  // may be modified between evaluations when evaluating after each pass.
+  std::optional<EvaluationCache> cache;
+  if (!use_jit && absl::GetFlag(FLAGS_interpreter_cache_size) > 0) {
+    cache.emplace(absl::GetFlag(FLAGS_interpreter_cache_size));
   }
 
-  std::vector<Value> results;
-  for (const ArgSet& arg_set : arg_sets) {
-    Value result;
+  for (int64_t i = 0; i < arg_sets.size(); ++i) {
+    const ArgSet& arg_set = arg_sets[i];
+    Value& result = results[i];
     if (use_jit) {
       if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
         XLS_ASSIGN_OR_RETURN(result,
@@ -191,21 +330,66 @@ absl::StatusOr<std::vector<Value>> Eval(
       // require rethinking some of the control flow because event comparison
       // only makes sense for certain modes (optimize_ir and test_llvm_jit).
       XLS_ASSIGN_OR_RETURN(
-          result, DropInterpreterEvents(InterpretFunction(f, arg_set.args)));
+          result, DropInterpreterEvents(InterpretFunction(
+                      f, arg_set.args, cache.has_value() ? &*cache : nullptr)));
     }
-    std::cout << result.ToString(FormatPreference::kHex) << std::endl;
+  }
+  return absl::OkStatus();
+}
 
-    if (arg_set.expected.has_value()) {
-      if (result != *arg_set.expected) {
-        return absl::InvalidArgumentError(absl::StrFormat(
-            "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s",
-            results.size(), ArgsToString(arg_set.args), actual_src,
-            result.ToString(FormatPreference::kHex), expected_src,
-            arg_set.expected->ToString(FormatPreference::kHex)));
+// Evaluates the function with the given ArgSets. Returns an error if the result
+// does not match expectations (if any). 'actual_src' and 'expected_src' are
+// string descriptions of the sources of the actual results and expected
+// results, respectively. These strings are included in error messages.
+// If `stream` is given the ArgSets are one batch of a larger set of inputs.
+absl::StatusOr<std::vector<Value>> Eval(
+    Function* f, absl::Span<const ArgSet> arg_sets, bool use_jit,
+    std::string_view actual_src = "actual",
+    std::string_view expected_src = "expected",
+    EvalStream* stream = nullptr) {
+  EvalStream single_batch;
+  if (stream == nullptr) {
+    stream = &single_batch;
+  }
+  std::vector<Value> results(arg_sets.size());
+  std::vector<Shard> shards =
+      MakeShards(arg_sets.size(), absl::GetFlag(FLAGS_threads));
+  if (stream->jits.size() < shards.size()) {
+    stream->jits.resize(shards.size());
+  }
+  std::vector<absl::Status> statuses =
+      RunShards(shards, [&](int64_t shard_index, const Shard& shard) {
+        int64_t size = shard.end - shard.start;
+        return EvalShard(f, arg_sets.subspan(shard.start, size), use_jit,
+                         absl::MakeSpan(results).subspan(shard.start, size),
+                         stream->jits[shard_index]);
+      });
+
+  // Print and check the results in input order. If a shard failed, none of
+  // the results of that shard or any later shard are printed. The output is
+  // flushed before returning so results printed before an error are seen.
+  for (int64_t shard_index = 0; shard_index < shards.size(); ++shard_index) {
+    stream->out->flush();
+    XLS_RETURN_IF_ERROR(statuses[shard_index]);
+    for (int64_t i = shards[shard_index].start; i < shards[shard_index].end;
+         ++i) {
+      const ArgSet& arg_set = arg_sets[i];
+      const Value& result = results[i];
+      *stream->out << result.ToString(FormatPreference::kHex) << "\n";
+
+      if (arg_set.expected.has_value()) {
+        if (result != *arg_set.expected) {
+          stream->out->flush();
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s",
+              stream->first_index + i, ArgsToString(arg_set.args), actual_src,
+              result.ToString(FormatPreference::kHex), expected_src,
+              arg_set.expected->ToString(FormatPreference::kHex)));
+        }
       }
     }
-    results.push_back(result);
   }
+  stream->out->flush();
   return results;
 }
 
@@ -359,15 +543,8 @@ absl::StatusOr<bool> ValidateInput(Function* validator, const ArgSet& arg_set) {
 }
 
 absl::StatusOr<ArgSet> GenerateArgSet(Function* f, Function* validator,
-                                      std::minstd_rand* rng_engine) {
+                                      Xoshiro256StarStar* rng_engine) {
   ArgSet arg_set;
-  if (validator == nullptr) {
-    for (Param* param : f->params()) {
-      arg_set.args.push_back(RandomValue(param->GetType(), rng_engine));
-    }
-    return arg_set;
-  }
-
   int input_validator_limit = absl::GetFlag(FLAGS_input_validator_limit);
   for (int i = 0; i < input_validator_limit; i++) {
     arg_set.args.clear();
@@ -387,6 +564,265 @@ absl::StatusOr<ArgSet> GenerateArgSet(Function* f, Function* validator,
       "or -input_validator_limit should be increased."));
 }
 
+// Returns the error for an --expected_file whose number of values does not
+// match the number of inputs.
+absl::Status ExpectedCountMismatch() {
+  return absl::InvalidArgumentError(
+      "Number of values in expected file does not match the number of "
+      "inputs.");
+}
+
+// Evaluates the function with the JIT on the inputs of --input_file in the
+// jit format. The records are passed to the JIT as read, without constructing
+// Values, and results are compared with expectations as raw records, only
+// unpacked to Values when they differ.
+absl::Status EvalJitInputFile(Function* f,
+                              const std::optional<Value>& expected) {
+  if (!absl::GetFlag(FLAGS_use_llvm_jit)) {
+    return absl::InvalidArgumentError(
+        "--input_format=jit requires --use_llvm_jit");
+  }
+  std::vector<std::unique_ptr<FunctionJit>> jits(absl::GetFlag(FLAGS_threads));
+  XLS_ASSIGN_OR_RETURN(jits[0], CreateJit(f));
+  std::vector<Type*> param_types;
+  for (Param* param : f->params()) {
+    param_types.push_back(param->GetType());
+  }
+  std::vector<Type*> result_types = {f->return_value()->GetType()};
+  JitRecordLayout input_layout(param_types, jits[0]->runtime());
+  JitRecordLayout result_layout(result_types, jits[0]->runtime());
+  int64_t input_size = input_layout.record_size();
+  int64_t result_size = result_layout.record_size();
+
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<JitValueReader> reader,
+      JitValueReader::Create(absl::GetFlag(FLAGS_input_file), &input_layout));
+  std::unique_ptr<JitValueReader> expected_reader;
+  if (!absl::GetFlag(FLAGS_expected_file).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        expected_reader,
+        JitValueReader::Create(absl::GetFlag(FLAGS_expected_file),
+                               &result_layout));
+  }
+  std::vector<uint8_t> expected_record;
+  if (expected.has_value()) {
+    expected_record.resize(result_size);
+    XLS_RETURN_IF_ERROR(
+        result_layout.Pack({*expected}, absl::MakeSpan(expected_record)));
+  }
+
+  std::unique_ptr<JitValueWriter> writer;
+  std::ofstream text_output;
+  std::ostream* out = &std::cout;
+  std::string output_file = absl::GetFlag(FLAGS_output_file);
+  if (absl::GetFlag(FLAGS_output_format) == "jit") {
+    XLS_QCHECK(!output_file.empty()) << "--output_format=jit requires "
+                                        "--output_file";
+    XLS_ASSIGN_OR_RETURN(writer,
+                         JitValueWriter::Create(output_file, &result_layout));
+  } else if (!output_file.empty()) {
+    text_output.open(output_file);
+    if (!text_output.is_open()) {
+      return absl::PermissionDeniedError(
+          absl::StrFormat("Unable to create output file %s", output_file));
+    }
+    out = &text_output;
+  }
+
+  std::vector<uint8_t> inputs;
+  std::vector<uint8_t> results;
+  std::vector<uint8_t> expecteds;
+  for (int64_t first_index = 0;;) {
+    XLS_ASSIGN_OR_RETURN(
+        int64_t count, reader->Read(absl::GetFlag(FLAGS_batch_size), &inputs));
+    if (count == 0) {
+      break;
+    }
+    results.assign(count * result_size, 0);
+    std::vector<Shard> shards = MakeShards(count, jits.size());
+    auto eval_shard = [&](int64_t shard_index,
+                          const Shard& shard) -> absl::Status {
+      std::unique_ptr<FunctionJit>& jit = jits[shard_index];
+      if (jit == nullptr) {
+        XLS_ASSIGN_OR_RETURN(jit, CreateJit(f));
+      }
+      std::vector<uint8_t*> args(input_layout.value_count());
+      for (int64_t r = shard.start; r < shard.end; ++r) {
+        uint8_t* record = inputs.data() + r * input_size;
+        for (int64_t i = 0; i < args.size(); ++i) {
+          args[i] = record + input_layout.offset(i);
+        }
+        InterpreterEvents events;
+        XLS_RETURN_IF_ERROR(jit->RunWithViews(
+            args,
+            absl::MakeSpan(results).subspan(r * result_size,
+                                            result_layout.size(0)),
+            &events));
+        XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(events));
+      }
+      return absl::OkStatus();
+    };
+    XLS_RETURN_IF_ERROR(FirstError(RunShards(shards, eval_shard)));
+
+    if (writer != nullptr) {
+      XLS_RETURN_IF_ERROR(writer->Write(results));
+    } else {
+      for (int64_t r = 0; r < count; ++r) {
+        Value result = result_layout.Unpack(
+            absl::MakeSpan(results).subspan(r * result_size, result_size))[0];
+        *out << result.ToString(FormatPreference::kHex) << "\n";
+      }
+      out->flush();
+    }
+
+    if (expected_reader != nullptr) {
+      XLS_ASSIGN_OR_RETURN(int64_t expected_count,
+                           expected_reader->Read(count, &expecteds));
+      if (expected_count != count) {
+        return ExpectedCountMismatch();
+      }
+    }
+    bool check_results = expected_reader != nullptr || expected.has_value();
+    for (int64_t r = 0; check_results && r < count; ++r) {
+      const uint8_t* result = results.data() + r * result_size;
+      const uint8_t* expected_result = expected_reader != nullptr
+                                           ? expecteds.data() + r * result_size
+                                           : expected_record.data();
+      if (std::memcmp(result, expected_result, result_size) == 0) {
+        continue;
+      }
+      // The records may differ only in padding.
+      Value actual =
+          result_layout.Unpack(absl::MakeSpan(result, result_size))[0];
+      Value expected_value =
+          result_layout.Unpack(absl::MakeSpan(expected_result, result_size))[0];
+      if (actual != expected_value) {
+        std::vector<Value> args = input_layout.Unpack(
+            absl::MakeSpan(inputs).subspan(r * input_size, input_size));
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Miscompare for input[%i] \"%s\"\n  actual: %s\n  expected: %s",
+            first_index + r, ArgsToString(args),
+            actual.ToString(FormatPreference::kHex),
+            expected_value.ToString(FormatPreference::kHex)));
+      }
+    }
+    first_index += count;
+  }
+
+  if (expected_reader != nullptr) {
+    XLS_ASSIGN_OR_RETURN(int64_t extra, expected_reader->Read(1, &expecteds));
+    if (extra != 0) {
+      return ExpectedCountMismatch();
+    }
+  }
+  if (writer != nullptr) {
+    XLS_RETURN_IF_ERROR(writer->Close());
+  }
+  if (text_output.is_open()) {
+    text_output.close();
+    if (text_output.fail()) {
+      return absl::InternalError(
+          absl::StrFormat("Error writing output file %s", output_file));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Evaluates the function on the inputs of --input_file, checking the results
+// against --expected or --expected_file if given. Inputs are read, evaluated
+// and their results written in batches of --batch_size so only one batch is
+// held in memory at a time.
+absl::Status EvalInputFile(Function* f) {
+  XLS_RET_CHECK(!absl::GetFlag(FLAGS_eval_after_each_pass))
+      << "Must specify --optimize_ir with --eval_after_each_pass";
+  std::optional<Value> expected;
+  if (!absl::GetFlag(FLAGS_expected).empty()) {
+    XLS_QCHECK(absl::GetFlag(FLAGS_expected_file).empty())
+        << "Cannot specify both --expected_file and --expected";
+    XLS_ASSIGN_OR_RETURN(
+        expected, Parser::ParseTypedValue(absl::GetFlag(FLAGS_expected)));
+  }
+  if (absl::GetFlag(FLAGS_input_format) == "jit") {
+    return EvalJitInputFile(f, expected);
+  }
+  if (absl::GetFlag(FLAGS_input_format) != "text") {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Unknown input format: %s", absl::GetFlag(FLAGS_input_format)));
+  }
+  if (absl::GetFlag(FLAGS_output_format) != "text") {
+    return absl::InvalidArgumentError(
+        "--output_format=jit requires --input_format=jit");
+  }
+
+  EvalStream stream;
+  std::ofstream output;
+  std::string output_file = absl::GetFlag(FLAGS_output_file);
+  if (!output_file.empty()) {
+    output.open(output_file);
+    if (!output.is_open()) {
+      return absl::PermissionDeniedError(
+          absl::StrFormat("Unable to create output file %s", output_file));
+    }
+    stream.out = &output;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<TextValueReader> reader,
+      TextValueReader::Create(absl::GetFlag(FLAGS_input_file)));
+  std::unique_ptr<TextValueReader> expected_reader;
+  if (!absl::GetFlag(FLAGS_expected_file).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        expected_reader,
+        TextValueReader::Create(absl::GetFlag(FLAGS_expected_file)));
+  }
+
+  int64_t batch_size = absl::GetFlag(FLAGS_batch_size);
+  while (true) {
+    std::vector<ArgSet> batch;
+    while (batch.size() < batch_size) {
+      XLS_ASSIGN_OR_RETURN(std::optional<std::vector<Value>> args,
+                           reader->Read());
+      if (!args.has_value()) {
+        break;
+      }
+      ArgSet& arg_set = batch.emplace_back();
+      arg_set.args = *std::move(args);
+      arg_set.expected = expected;
+      if (expected_reader != nullptr) {
+        XLS_ASSIGN_OR_RETURN(std::optional<std::vector<Value>> values,
+                             expected_reader->Read());
+        if (!values.has_value() || values->size() != 1) {
+          return ExpectedCountMismatch();
+        }
+        arg_set.expected = values->front();
+      }
+    }
+    if (batch.empty()) {
+      break;
+    }
+    XLS_RETURN_IF_ERROR(
+        Eval(f, batch, absl::GetFlag(FLAGS_use_llvm_jit), "actual",
+             "expected", &stream)
+            .status());
+    stream.first_index += batch.size();
+  }
+
+  if (expected_reader != nullptr) {
+    XLS_ASSIGN_OR_RETURN(std::optional<std::vector<Value>> extra,
+                         expected_reader->Read());
+    if (extra.has_value()) {
+      return ExpectedCountMismatch();
+    }
+  }
+  if (output.is_open()) {
+    output.close();
+    if (output.fail()) {
+      return absl::InternalError(
+          absl::StrFormat("Error writing output file %s", output_file));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status RealMain(std::string_view input_path,
                       std::string_view dslx_stdlib_path) {
   if (input_path == "-") {
@@ -415,22 +851,29 @@ absl::Status RealMain(std::string_view input_path,
   } else if (!absl::GetFlag(FLAGS_input_file).empty()) {
     XLS_QCHECK_EQ(absl::GetFlag(FLAGS_random_inputs), 0)
         << "Cannot specify both --input_file and --random_inputs";
-    absl::StatusOr<std::string> args_input_file =
-        GetFileContents(absl::GetFlag(FLAGS_input_file));
-    XLS_QCHECK_OK(args_input_file.status());
-    for (const auto& arg_line : absl::StrSplit(args_input_file.value(), '\n',
-                                               absl::SkipWhitespace())) {
-      absl::StatusOr<ArgSet> arg_set_status = ArgSetFromString(arg_line);
-      XLS_QCHECK_OK(arg_set_status.status())
-          << absl::StreamFormat("Invalid line in input file %s: %s",
-                                absl::GetFlag(FLAGS_input_file), arg_line);
-      arg_sets.push_back(arg_set_status.value());
+    if (!absl::GetFlag(FLAGS_optimize_ir) &&
+        !absl::GetFlag(FLAGS_test_llvm_jit)) {
+      return EvalInputFile(f);
+    }
+    // All inputs are needed to evaluate the function more than once.
+    XLS_QCHECK_EQ(absl::GetFlag(FLAGS_input_format), "text")
+        << "--input_format=jit cannot be used with --optimize_ir or "
+           "--test_llvm_jit";
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<TextValueReader> reader,
+        TextValueReader::Create(absl::GetFlag(FLAGS_input_file)));
+    while (true) {
+      absl::StatusOr<std::optional<std::vector<Value>>> args = reader->Read();
+      XLS_QCHECK_OK(args.status());
+      if (!args->has_value()) {
+        break;
+      }
+      arg_sets.emplace_back().args = **std::move(args);
     }
   } else {
     XLS_QCHECK_NE(absl::GetFlag(FLAGS_random_inputs), 0)
         << "Must specify --input, --input_file, or --random_inputs.";
     arg_sets.resize(absl::GetFlag(FLAGS_random_inputs));
-    std::minstd_rand rng_engine;
     std::string validator_text = absl::GetFlag(FLAGS_input_validator_expr);
     std::filesystem::path validator_path =
         absl::GetFlag(FLAGS_input_validator_path);
@@ -449,9 +892,30 @@ absl::Status RealMain(std::string_view input_path,
       XLS_ASSIGN_OR_RETURN(validator, validator_pkg->GetFunction(mangled_name));
     }
 
-    for (ArgSet& arg_set : arg_sets) {
-      XLS_ASSIGN_OR_RETURN(arg_set, GenerateArgSet(f, validator, &rng_engine));
-    }
+    // Each shard uses its own random number generator seeded with the shard
+    // index so the generated inputs are deterministic for a given number of
+    // threads. Without a validator the inputs of a shard are generated in a
+    // single batch.
+    std::vector<Shard> shards =
+        MakeShards(arg_sets.size(), absl::GetFlag(FLAGS_threads));
+    auto generate_shard = [&](int64_t shard_index,
+                              const Shard& shard) -> absl::Status {
+      Xoshiro256StarStar rng_engine(shard_index);
+      if (validator == nullptr) {
+        std::vector<std::vector<Value>> args = RandomFunctionArgumentSets(
+            f, shard.end - shard.start, &rng_engine);
+        for (int64_t i = shard.start; i < shard.end; ++i) {
+          arg_sets[i].args = std::move(args[i - shard.start]);
+        }
+        return absl::OkStatus();
+      }
+      for (int64_t i = shard.start; i < shard.end; ++i) {
+        XLS_ASSIGN_OR_RETURN(arg_sets[i],
+                             GenerateArgSet(f, validator, &rng_engine));
+      }
+      return absl::OkStatus();
+    };
+    XLS_RETURN_IF_ERROR(FirstError(RunShards(shards, generate_shard)));
   }
 
   if (!absl::GetFlag(FLAGS_expected).empty()) {
@@ -496,6 +960,8 @@ absl::Status RealMain(std::string_view input_path,
 int main(int argc, char** argv) {
   std::vector<std::string_view> positional_arguments =
       xls::InitXls(kUsage, argc, argv);
+  XLS_QCHECK_GE(absl::GetFlag(FLAGS_threads), 1)
+      << "--threads must be at least 1.";
   if (positional_arguments.empty()) {
     XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <ir-path>",
                                           argv[0]);
@@ -504,6 +970,14 @@ int main(int argc, char** argv) {
              absl::GetFlag(FLAGS_input_validator_path).empty())
       << "At most one one of 'input_validator' or 'input_validator_path' may "
          "be specified.";
+  XLS_QCHECK(absl::GetFlag(FLAGS_output_file).empty() ||
+             (!absl::GetFlag(FLAGS_input_file).empty() &&
+              !absl::GetFlag(FLAGS_optimize_ir) &&
+              !absl::GetFlag(FLAGS_test_llvm_jit)))
+      << "--output_file requires --input_file and cannot be used with "
+         "--optimize_ir or --test_llvm_jit.";
+  XLS_QCHECK_GE(absl::GetFlag(FLAGS_batch_size), 1)
+      << "--batch_size must be at least 1.";
   std::string dslx_stdlib_path = absl::GetFlag(FLAGS_dslx_stdlib_path);
   XLS_QCHECK_OK(xls::RealMain(positional_arguments[0], dslx_stdlib_path));
 }
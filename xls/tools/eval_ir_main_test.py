@@ -13,6 +13,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import struct
 import subprocess
 
 from xls.common import runfiles
@@ -174,6 +175,63 @@ class EvalMainTest(absltest.TestCase):
     ])
     self.assertEqual(results.decode('utf-8'), '')
 
+  def test_input_file_with_output_file(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile(
+        content='\n'.join(('bits[32]:0x42; bits[32]:0x123',
+                           'bits[32]:0x10; bits[32]:0xf0f')))
+    output_file = self.create_tempfile()
+    results = subprocess.check_output([
+        EVAL_IR_MAIN_PATH, '--input_file=' + input_file.full_path,
+        '--output_file=' + output_file.full_path, '--batch_size=1',
+        ir_file.full_path
+    ])
+    self.assertEqual(results.decode('utf-8'), '')
+    self.assertSequenceEqual(('bits[32]:0x165', 'bits[32]:0xf1f'),
+                             output_file.read_text().strip().split('\n'))
+
+  def test_jit_input_and_output_files(self):
+    # A bits[32] value is held in four little-endian bytes by the JIT and each
+    # value of a record is aligned to 16 bytes (see value_stream.h).
+    def jit_file(signature, records):
+      record_size = 16 * len(records[0])
+      data = b'XLSJITV1' + struct.pack('<QQ', record_size, len(signature))
+      data += signature.encode('utf-8')
+      for record in records:
+        for value in record:
+          data += struct.pack('<I', value) + bytes(12)
+      return data
+
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile(
+        content=jit_file('(bits[32], bits[32])', [(0x42, 0x123),
+                                                  (0x10, 0xf0f)]),
+        mode='wb')
+    output_file = self.create_tempfile()
+    subprocess.check_call([
+        EVAL_IR_MAIN_PATH, '--input_file=' + input_file.full_path,
+        '--input_format=jit', '--output_file=' + output_file.full_path,
+        '--output_format=jit', '--use_llvm_jit=true', ir_file.full_path
+    ])
+    self.assertEqual(
+        output_file.read_bytes(),
+        jit_file('(bits[32])', [(0x165,), (0xf1f,)]))
+
+    # The jit format output can be checked against a jit format expected file
+    # and printed as text.
+    expected_file = self.create_tempfile(
+        content=jit_file('(bits[32])', [(0x165,), (0xf1e,)]), mode='wb')
+    comp = subprocess.run([
+        EVAL_IR_MAIN_PATH, '--input_file=' + input_file.full_path,
+        '--input_format=jit', '--expected_file=' + expected_file.full_path,
+        '--use_llvm_jit=true', ir_file.full_path
+    ],
+                          stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE,
+                          check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('Miscompare for input[1]', comp.stderr.decode('utf-8'))
+
   def test_tuple_in_out(self):
     ir_file = self.create_tempfile(content=TUPLE_IR)
     result = subprocess.check_output([
@@ -15,7 +15,10 @@
 // Tool to evaluate the behavior of a Proc network.
 
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <queue>
 #include <random>
 #include <string>
@@ -46,6 +49,8 @@
 #include "xls/ir/value_helpers.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/serial_proc_runtime.h"
+#include "xls/jit/threaded_proc_runtime.h"
+#include "xls/tools/value_stream.h"
 #include "re2/re2.h"
 
 constexpr const char* kUsage = R"(
@@ -64,8 +69,13 @@ ABSL_FLAG(std::vector<std::string>, ticks, {},
 ABSL_FLAG(std::string, backend, "serial_jit",
           "Backend to use for evaluation. Valid options are:\n"
           " * serial_jit: JIT-backed single-stepping runtime.\n"
+          " * multi_jit: JIT-backed runtime which runs procs on multiple "
+          "threads.\n"
           " * ir_interpreter: Interpreter at the IR level.\n"
           " * block_interpreter: Interpret a block generated from a proc.");
+ABSL_FLAG(int64_t, multi_jit_threads, 0,
+          "Number of worker threads used by the multi_jit backend. If zero, "
+          "one thread is used per proc.");
 ABSL_FLAG(std::string, block_signature_proto, "",
           "Path to textproto file containing signature from codegen");
 ABSL_FLAG(int64_t, max_cycles_no_output, 100,
@@ -245,14 +255,19 @@ absl::Status RunIrInterpreter(
   return absl::OkStatus();
 }
 
-absl::Status RunSerialJit(
+// Runs the procs in the package with a JIT-backed runtime. `RuntimeT` is
+// either SerialProcRuntime or ThreadedProcRuntime.
+template <typename RuntimeT>
+absl::Status RunJit(
     Package* package, const std::vector<int64_t>& ticks,
     absl::flat_hash_map<std::string, std::vector<Value>> inputs_for_channels,
     absl::flat_hash_map<std::string, std::vector<Value>>
-        expected_outputs_for_channels) {
+        expected_outputs_for_channels,
+    const std::function<absl::StatusOr<std::unique_ptr<RuntimeT>>(Package*)>&
+        create_runtime) {
   XLS_VLOG(1) << "Compiling...";
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
-                       SerialProcRuntime::Create(package));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<RuntimeT> runtime,
+                       create_runtime(package));
 
   XLS_VLOG(1) << "Writing inputs...";
   for (const auto& [channel_name, values] : inputs_for_channels) {
@@ -272,7 +287,7 @@ absl::Status RunSerialJit(
     // then number-of-ticks-based timing won't work and we'll need to run based
     // on collecting some number of outputs.
     for (int64_t i = 0; i < this_ticks; i++) {
-      XLS_RETURN_IF_ERROR(runtime->Tick());
+      XLS_RETURN_IF_ERROR(runtime->Tick(absl::GetFlag(FLAGS_show_trace)));
 
       for (const std::unique_ptr<Proc>& proc : package->procs()) {
         XLS_ASSIGN_OR_RETURN(std::vector<Value> values,
@@ -634,22 +649,28 @@ absl::Status RunBlockInterpreter(
   return absl::OkStatus();
 }
 
+// Reads at most max_lines values from the file, one per line. The file is
+// read incrementally so only the values which are used are parsed.
 absl::StatusOr<std::vector<Value>> ParseValuesFile(std::string_view filename,
                                                    uint64_t max_lines) {
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(filename));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<TextValueReader> reader,
+                       TextValueReader::Create(filename));
   std::vector<Value> ret;
-  uint64_t li = 0;
-  for (const auto& line :
-       absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
-    if (0 == (li % 500)) {
-      XLS_VLOG(1) << "Parsing values file at line " << li;
-    }
-    li++;
-    XLS_ASSIGN_OR_RETURN(Value expected_status, Parser::ParseTypedValue(line));
-    ret.push_back(expected_status);
-    if (li == max_lines) {
+  while (ret.size() < max_lines) {
+    if (0 == (ret.size() % 500)) {
+      XLS_VLOG(1) << "Parsing values file at line " << ret.size();
+    }
+    XLS_ASSIGN_OR_RETURN(std::optional<std::vector<Value>> record,
+                         reader->Read());
+    if (!record.has_value()) {
       break;
     }
+    if (record->size() != 1) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "%s: expected one value per line, got %d", filename,
+          record->size()));
+    }
+    ret.push_back(std::move(record->front()));
   }
   return ret;
 }
@@ -796,8 +817,18 @@ absl::Status RealMain(
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
 
   if (backend == "serial_jit") {
-    return RunSerialJit(package.get(), ticks, inputs_for_channels,
-                        expected_outputs_for_channels);
+    return RunJit<SerialProcRuntime>(
+        package.get(), ticks, inputs_for_channels,
+        expected_outputs_for_channels,
+        [](Package* p) { return SerialProcRuntime::Create(p); });
+  }
+  if (backend == "multi_jit") {
+    return RunJit<ThreadedProcRuntime>(
+        package.get(), ticks, inputs_for_channels,
+        expected_outputs_for_channels, [](Package* p) {
+          return ThreadedProcRuntime::Create(
+              p, absl::GetFlag(FLAGS_multi_jit_threads));
+        });
   }
   if (backend == "ir_interpreter") {
     return RunIrInterpreter(package.get(), ticks, inputs_for_channels,
@@ -825,8 +856,8 @@ int main(int argc, char* argv[]) {
   }
 
   std::string backend = absl::GetFlag(FLAGS_backend);
-  if (backend != "serial_jit" && backend != "ir_interpreter" &&
-      backend != "block_interpreter") {
+  if (backend != "serial_jit" && backend != "multi_jit" &&
+      backend != "ir_interpreter" && backend != "block_interpreter") {
     XLS_LOG(QFATAL) << "Unrecognized backend choice.";
   }
 
@@ -13,13 +13,20 @@
 // limitations under the License.
 
 // Simple driver for executing the ExtractStage() routine.
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/scheduling/extract_stage.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
@@ -29,6 +36,10 @@ ABSL_FLAG(std::string, function, "",
           "Function to extract from. "
           "If unspecified, a \"best guess\" will be selected.");
 ABSL_FLAG(std::string, output_path, "", "Path to which to write output.");
+ABSL_FLAG(std::string, output_dir, "",
+          "If set, and all stages are extracted, each stage is written as its "
+          "own package to <output_dir>/<function>_stage_<N>.ir instead of "
+          "all stages being written to --output_path.");
 ABSL_FLAG(std::string, schedule_path, "",
           "Path to the function's pipeline schedule.");
 ABSL_FLAG(
@@ -40,9 +51,15 @@ namespace xls {
 absl::Status RealMain(const std::string& ir_path,
                       std::optional<std::string> function_name,
                       const std::string& schedule_path, int stage,
-                      const std::string& output_path) {
-  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
+                      const std::string& output_path,
+                      const std::string& output_dir) {
+  // Only the function to extract from (and what it depends on) is parsed.
+  std::vector<std::string> entity_names;
+  if (function_name) {
+    entity_names.push_back(function_name.value());
+  }
+  XLS_ASSIGN_OR_RETURN(auto package,
+                       Parser::ParsePackageFromFile(ir_path, entity_names));
   FunctionBase* function;
   if (function_name) {
     auto get_proc = package->GetFunction(function_name.value());
@@ -63,13 +80,24 @@ absl::Status RealMain(const std::string& ir_path,
   std::vector<FunctionBase*> funcs = package->GetFunctionBases();
 
   if (stage == -1) {
-    bool assigned_top = false;
-    for (int i = 0; i < schedule.length(); ++i) {
-      XLS_ASSIGN_OR_RETURN(Function * stage,
-                           ExtractStage(function, schedule, i));
-      XLS_RETURN_IF_ERROR(package->SetTop(stage));
-      assigned_top = true;
+    XLS_ASSIGN_OR_RETURN(std::vector<Function*> stages,
+                         ExtractAllStages(function, schedule));
+    if (!output_dir.empty()) {
+      // Write each stage to a package of its own, e.g. for stage-by-stage
+      // equivalence checking.
+      for (Function* stage_fn : stages) {
+        Package stage_package(package->name());
+        XLS_ASSIGN_OR_RETURN(Function * clone,
+                             stage_fn->Clone(stage_fn->name(), &stage_package));
+        XLS_RETURN_IF_ERROR(stage_package.SetTop(clone));
+        XLS_RETURN_IF_ERROR(SetFileContents(
+            std::filesystem::path(output_dir) /
+                absl::StrCat(stage_fn->name(), ".ir"),
+            stage_package.DumpIr()));
+      }
+      return absl::OkStatus();
     }
+    XLS_RETURN_IF_ERROR(package->SetTop(stages.back()));
   } else {
     XLS_ASSIGN_OR_RETURN(Function * stage,
                          ExtractStage(function, schedule, stage));
@@ -106,8 +134,13 @@ int main(int argc, char* argv[]) {
   int stage = absl::GetFlag(FLAGS_stage);
 
   std::string output_path = absl::GetFlag(FLAGS_output_path);
-  XLS_QCHECK(!output_path.empty()) << "--output path can't be empty!";
-  XLS_QCHECK_OK(
-      xls::RealMain(ir_path, function_name, schedule_path, stage, output_path));
+  std::string output_dir = absl::GetFlag(FLAGS_output_dir);
+  if (output_dir.empty()) {
+    XLS_QCHECK(!output_path.empty()) << "--output path can't be empty!";
+  } else {
+    XLS_QCHECK_EQ(stage, -1) << "--output_dir requires extracting all stages.";
+  }
+  XLS_QCHECK_OK(xls::RealMain(ir_path, function_name, schedule_path, stage,
+                              output_path, output_dir));
   return 0;
 }
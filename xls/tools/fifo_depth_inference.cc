@@ -0,0 +1,266 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/fifo_depth_inference.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/casts.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/interpreter/proc_network_interpreter.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+namespace {
+
+// Statistics gathered by a single simulation of the proc network.
+struct SimulationResult {
+  int64_t ticks = 0;
+  // Total number of values sent on send-only channels.
+  int64_t outputs = 0;
+  absl::flat_hash_map<Channel*, int64_t> max_occupancy;
+  absl::flat_hash_map<Channel*, int64_t> stalls;
+};
+
+// A proc evaluator which models back-pressure of bounded FIFOs. At the start of
+// each tick the wrapped evaluator is only run if every channel in `depths`
+// which the proc sends on holds fewer elements than its depth. Otherwise the
+// proc makes no progress in this tick of the network.
+class BoundedFifoProcEvaluator : public ProcEvaluator {
+ public:
+  BoundedFifoProcEvaluator(std::unique_ptr<ProcEvaluator> evaluator,
+                           std::vector<Channel*> send_channels,
+                           ChannelQueueManager* queue_manager,
+                           const absl::flat_hash_map<Channel*, int64_t>* depths,
+                           SimulationResult* result)
+      : evaluator_(std::move(evaluator)),
+        send_channels_(std::move(send_channels)),
+        queue_manager_(queue_manager),
+        depths_(depths),
+        result_(result) {}
+
+  std::unique_ptr<ProcContinuation> NewContinuation() const override {
+    return evaluator_->NewContinuation();
+  }
+
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override {
+    if (continuation.AtStartOfTick()) {
+      for (Channel* channel : send_channels_) {
+        auto it = depths_->find(channel);
+        if (it != depths_->end() &&
+            queue_manager_->GetQueue(channel).GetSize() >= it->second) {
+          ++result_->stalls[channel];
+          return TickResult{.tick_complete = false,
+                            .progress_made = false,
+                            .blocked_channel = std::nullopt,
+                            .sent_channels = {}};
+        }
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(TickResult tick_result,
+                         evaluator_->Tick(continuation));
+    for (Channel* channel : tick_result.sent_channels) {
+      int64_t& max_occupancy = result_->max_occupancy[channel];
+      max_occupancy =
+          std::max(max_occupancy, queue_manager_->GetQueue(channel).GetSize());
+    }
+    return tick_result;
+  }
+
+  Proc* proc() const override { return evaluator_->proc(); }
+
+ private:
+  std::unique_ptr<ProcEvaluator> evaluator_;
+  std::vector<Channel*> send_channels_;
+  ChannelQueueManager* queue_manager_;
+  const absl::flat_hash_map<Channel*, int64_t>* depths_;
+  SimulationResult* result_;
+};
+
+// Returns the channels sent on by `proc` without duplicates.
+absl::StatusOr<std::vector<Channel*>> GetSendChannels(Proc* proc) {
+  std::vector<Channel*> channels;
+  for (Node* node : proc->nodes()) {
+    if (!node->Is<Send>()) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(Channel * channel, proc->package()->GetChannel(
+                                                node->As<Send>()->channel_id()));
+    if (std::find(channels.begin(), channels.end(), channel) ==
+        channels.end()) {
+      channels.push_back(channel);
+    }
+  }
+  return channels;
+}
+
+// Runs the proc network on the inputs in `options` with the given channel
+// depths until it blocks or `options.max_ticks` ticks have been executed.
+// Channels not in `depths` are unbounded.
+absl::StatusOr<SimulationResult> Simulate(
+    Package* package, const FifoDepthInferenceOptions& options,
+    const absl::flat_hash_map<Channel*, int64_t>& depths) {
+  SimulationResult result;
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
+                       ChannelQueueManager::Create(package));
+  ChannelQueueManager* queues = queue_manager.get();
+
+  std::vector<std::unique_ptr<ProcEvaluator>> evaluators;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    XLS_ASSIGN_OR_RETURN(std::vector<Channel*> send_channels,
+                         GetSendChannels(proc.get()));
+    evaluators.push_back(std::make_unique<BoundedFifoProcEvaluator>(
+        std::make_unique<ProcInterpreter>(proc.get(), queues),
+        std::move(send_channels), queues, &depths, &result));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ProcNetworkInterpreter> network,
+      ProcNetworkInterpreter::Create(package, std::move(evaluators),
+                                     std::move(queue_manager)));
+
+  for (Channel* channel : package->channels()) {
+    for (const Value& value : channel->initial_values()) {
+      XLS_RETURN_IF_ERROR(queues->GetQueue(channel).Write(value));
+    }
+  }
+  for (const auto& [name, values] : options.inputs) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue, queues->GetQueueByName(name));
+    if (queue->channel()->supported_ops() != ChannelOps::kReceiveOnly) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Inputs given for channel `%s` which is not receive-only", name));
+    }
+    for (const Value& value : values) {
+      XLS_RETURN_IF_ERROR(queue->Write(value));
+    }
+  }
+
+  absl::StatusOr<int64_t> ticks = network->TickUntilBlocked(options.max_ticks);
+  if (ticks.ok()) {
+    result.ticks = ticks.value();
+  } else if (absl::IsDeadlineExceeded(ticks.status())) {
+    result.ticks = options.max_ticks;
+  } else {
+    return ticks.status();
+  }
+
+  for (Channel* channel : package->channels()) {
+    if (channel->supported_ops() == ChannelOps::kSendOnly) {
+      result.outputs += queues->GetQueue(channel).GetSize();
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+std::string ChannelFifoDepth::ToString() const {
+  return absl::StrFormat(
+      "%s: declared_depth=%s, max_occupancy=%d, declared_depth_stalls=%d, "
+      "inferred_depth=%d",
+      channel->name(),
+      declared_depth.has_value() ? absl::StrCat(declared_depth.value())
+                                 : "none",
+      max_occupancy, declared_depth_stalls, inferred_depth);
+}
+
+absl::StatusOr<FifoDepthInferenceResult> InferFifoDepths(
+    Package* package, const FifoDepthInferenceOptions& options) {
+  XLS_RET_CHECK_GT(options.max_ticks, 0);
+
+  std::vector<StreamingChannel*> channels;
+  for (Channel* channel : package->channels()) {
+    if (channel->kind() == ChannelKind::kStreaming &&
+        channel->supported_ops() == ChannelOps::kSendReceive) {
+      channels.push_back(down_cast<StreamingChannel*>(channel));
+    }
+  }
+  std::sort(channels.begin(), channels.end(),
+            [](Channel* a, Channel* b) { return a->id() < b->id(); });
+
+  FifoDepthInferenceResult result;
+  XLS_ASSIGN_OR_RETURN(SimulationResult unbounded,
+                       Simulate(package, options, /*depths=*/{}));
+  result.unbounded_ticks = unbounded.ticks;
+  result.unbounded_outputs = unbounded.outputs;
+
+  absl::flat_hash_map<Channel*, int64_t> declared_depths;
+  for (StreamingChannel* channel : channels) {
+    if (channel->GetFifoDepth().has_value()) {
+      declared_depths[channel] =
+          std::max<int64_t>(channel->GetFifoDepth().value(), 1);
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(SimulationResult declared,
+                       Simulate(package, options, declared_depths));
+  result.declared_ticks = declared.ticks;
+  result.declared_outputs = declared.outputs;
+
+  auto reaches_peak_throughput = [&](const SimulationResult& r) {
+    return r.outputs >= unbounded.outputs && r.ticks <= unbounded.ticks;
+  };
+
+  // With every depth at least the maximum unbounded occupancy no proc ever
+  // stalls, so the network behaves exactly as with unbounded FIFOs. Shrink the
+  // depths from there one channel at a time.
+  absl::flat_hash_map<Channel*, int64_t> depths;
+  for (StreamingChannel* channel : channels) {
+    depths[channel] = std::max<int64_t>(unbounded.max_occupancy[channel], 1);
+  }
+  for (StreamingChannel* channel : channels) {
+    int64_t lo = 1;
+    int64_t hi = depths.at(channel);
+    while (lo < hi) {
+      int64_t mid = lo + (hi - lo) / 2;
+      depths[channel] = mid;
+      XLS_ASSIGN_OR_RETURN(SimulationResult bounded,
+                           Simulate(package, options, depths));
+      if (reaches_peak_throughput(bounded)) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    depths[channel] = lo;
+    XLS_VLOG(1) << absl::StreamFormat("Inferred depth of channel `%s`: %d",
+                                      channel->name(), lo);
+  }
+
+  for (StreamingChannel* channel : channels) {
+    result.channels.push_back(ChannelFifoDepth{
+        .channel = channel,
+        .declared_depth = channel->GetFifoDepth(),
+        .max_occupancy = unbounded.max_occupancy[channel],
+        .declared_depth_stalls = declared.stalls[channel],
+        .inferred_depth = depths.at(channel)});
+  }
+  return result;
+}
+
+void ApplyFifoDepths(const FifoDepthInferenceResult& result) {
+  for (const ChannelFifoDepth& channel_depth : result.channels) {
+    channel_depth.channel->SetFifoDepth(channel_depth.inferred_depth);
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,98 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_FIFO_DEPTH_INFERENCE_H_
+#define XLS_TOOLS_FIFO_DEPTH_INFERENCE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+struct FifoDepthInferenceOptions {
+  // Values fed into each receive-only channel, keyed by channel name.
+  absl::flat_hash_map<std::string, std::vector<Value>> inputs;
+
+  // Maximum number of ticks of the proc network in each simulation. Networks
+  // which do not block once their inputs are exhausted (e.g., procs without
+  // receives) are run for exactly this many ticks.
+  int64_t max_ticks = 100000;
+};
+
+// Results of FIFO depth inference for a single internal streaming channel.
+struct ChannelFifoDepth {
+  StreamingChannel* channel;
+
+  // The depth declared in the IR, if any.
+  std::optional<int64_t> declared_depth;
+
+  // Maximum number of elements held by the channel when its depth is
+  // unbounded.
+  int64_t max_occupancy;
+
+  // Number of ticks in which a proc stalled because the channel was full when
+  // simulated with the declared depths.
+  int64_t declared_depth_stalls;
+
+  // Minimum depth at which the network reaches the throughput it has with
+  // unbounded FIFOs.
+  int64_t inferred_depth;
+
+  std::string ToString() const;
+};
+
+struct FifoDepthInferenceResult {
+  // Number of ticks and total number of values sent on send-only channels
+  // with unbounded FIFOs, and with the declared FIFO depths.
+  int64_t unbounded_ticks;
+  int64_t unbounded_outputs;
+  int64_t declared_ticks;
+  int64_t declared_outputs;
+
+  // Per-channel results sorted by channel id.
+  std::vector<ChannelFifoDepth> channels;
+};
+
+// Infers the FIFO depth of each internal (send-and-receive) streaming channel
+// of the proc network in `package` by simulating it with the proc network
+// interpreter on the given inputs.
+//
+// Back-pressure is modeled by stalling a proc at the start of its tick if any
+// channel it sends on holds `depth` or more elements. The network is first run
+// with unbounded FIFOs which gives the peak throughput (values sent on output
+// channels within the fewest ticks) and the maximum occupancy of each channel.
+// Then, one channel at a time in id order, the depth of the channel is
+// minimized by bisection between one and its maximum occupancy while keeping
+// the depths already chosen for earlier channels, such that the network still
+// reaches peak throughput. The inferred depths thus together reach peak
+// throughput on the given inputs; they are not guaranteed to for other
+// traffic. A depth of zero (a direct connection) is modeled as a depth of one.
+absl::StatusOr<FifoDepthInferenceResult> InferFifoDepths(
+    Package* package, const FifoDepthInferenceOptions& options);
+
+// Sets the FIFO depth of each channel in `result` to its inferred depth.
+void ApplyFifoDepths(const FifoDepthInferenceResult& result);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_FIFO_DEPTH_INFERENCE_H_
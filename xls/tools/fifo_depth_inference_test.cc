@@ -0,0 +1,160 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/fifo_depth_inference.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+class FifoDepthInferenceTest : public IrTestBase {
+ protected:
+  // Returns `count` sequential U32 values.
+  static std::vector<Value> Iota(int64_t count) {
+    std::vector<Value> values;
+    for (int64_t i = 0; i < count; ++i) {
+      values.push_back(Value(UBits(i, 32)));
+    }
+    return values;
+  }
+};
+
+// Creates a proc which passes through a received value to a send each tick.
+absl::StatusOr<Proc*> CreatePassThroughProc(std::string_view proc_name,
+                                            Channel* in_channel,
+                                            Channel* out_channel,
+                                            Package* package) {
+  ProcBuilder pb(proc_name, /*token_name=*/"tok", package);
+  BValue token_input = pb.Receive(in_channel, pb.GetTokenParam());
+  BValue send_token = pb.Send(out_channel, pb.TupleIndex(token_input, 0),
+                              pb.TupleIndex(token_input, 1));
+  return pb.Build(send_token, {});
+}
+
+// Creates a proc which idles every other tick and otherwise receives two
+// values and sends their sum.
+absl::StatusOr<Proc*> CreatePairSumProc(std::string_view proc_name,
+                                        Channel* in_channel,
+                                        Channel* out_channel,
+                                        Package* package) {
+  ProcBuilder pb(proc_name, /*token_name=*/"tok", package);
+  BValue active = pb.StateElement("active", Value(UBits(0, 1)));
+  BValue first = pb.ReceiveIf(in_channel, pb.GetTokenParam(), active);
+  BValue second = pb.ReceiveIf(in_channel, pb.TupleIndex(first, 0), active);
+  BValue send_token =
+      pb.SendIf(out_channel, pb.TupleIndex(second, 0), active,
+                pb.Add(pb.TupleIndex(first, 1), pb.TupleIndex(second, 1)));
+  return pb.Build(send_token, {pb.Not(active)});
+}
+
+TEST_F(FifoDepthInferenceTest, PassThroughPipeline) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in, p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                              p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * mid,
+      p->CreateStreamingChannel("mid", ChannelOps::kSendReceive,
+                                p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  XLS_ASSERT_OK(CreatePassThroughProc("first", in, mid, p.get()).status());
+  XLS_ASSERT_OK(CreatePassThroughProc("second", mid, out, p.get()).status());
+
+  FifoDepthInferenceOptions options;
+  options.inputs["in"] = Iota(10);
+  XLS_ASSERT_OK_AND_ASSIGN(FifoDepthInferenceResult result,
+                           InferFifoDepths(p.get(), options));
+  EXPECT_EQ(result.unbounded_outputs, 10);
+  EXPECT_EQ(result.declared_ticks, result.unbounded_ticks);
+  ASSERT_EQ(result.channels.size(), 1);
+  EXPECT_EQ(result.channels[0].channel, mid);
+  EXPECT_EQ(result.channels[0].max_occupancy, 1);
+  EXPECT_EQ(result.channels[0].declared_depth_stalls, 0);
+  EXPECT_EQ(result.channels[0].inferred_depth, 1);
+
+  ApplyFifoDepths(result);
+  EXPECT_THAT(mid->GetFifoDepth(), Optional(1));
+}
+
+TEST_F(FifoDepthInferenceTest, BurstyConsumer) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in, p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                              p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * mid,
+      p->CreateStreamingChannel("mid", ChannelOps::kSendReceive,
+                                p->GetBitsType(32), /*initial_values=*/{},
+                                /*fifo_depth=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  XLS_ASSERT_OK(CreatePassThroughProc("producer", in, mid, p.get()).status());
+  XLS_ASSERT_OK(CreatePairSumProc("consumer", mid, out, p.get()).status());
+
+  // The producer sends one value each tick and the consumer takes two values
+  // every other tick, so a FIFO of depth one throttles the producer.
+  FifoDepthInferenceOptions options;
+  options.inputs["in"] = Iota(20);
+  XLS_ASSERT_OK_AND_ASSIGN(FifoDepthInferenceResult result,
+                           InferFifoDepths(p.get(), options));
+  EXPECT_EQ(result.unbounded_outputs, 10);
+  EXPECT_GT(result.declared_ticks, result.unbounded_ticks);
+  ASSERT_EQ(result.channels.size(), 1);
+  EXPECT_THAT(result.channels[0].declared_depth, Optional(1));
+  EXPECT_EQ(result.channels[0].max_occupancy, 2);
+  EXPECT_GT(result.channels[0].declared_depth_stalls, 0);
+  EXPECT_EQ(result.channels[0].inferred_depth, 2);
+
+  ApplyFifoDepths(result);
+  EXPECT_THAT(mid->GetFifoDepth(), Optional(2));
+}
+
+TEST_F(FifoDepthInferenceTest, InputsOnInternalChannel) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in, p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                              p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * mid, p->CreateStreamingChannel("mid", ChannelOps::kSendReceive,
+                                               p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  XLS_ASSERT_OK(CreatePassThroughProc("first", in, mid, p.get()).status());
+  XLS_ASSERT_OK(CreatePassThroughProc("second", mid, out, p.get()).status());
+
+  FifoDepthInferenceOptions options;
+  options.inputs["mid"] = Iota(1);
+  EXPECT_THAT(InferFifoDepths(p.get(), options),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not receive-only")));
+}
+
+}  // namespace
+}  // namespace xls
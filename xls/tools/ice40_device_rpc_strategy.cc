@@ -22,6 +22,8 @@
 #include <unistd.h>
 
 #include <filesystem>
+#include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -254,8 +256,11 @@ absl::Status Ice40DeviceRpcStrategy::Connect(int64_t device_ordinal) {
   return absl::OkStatus();
 }
 
-absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
-    const FunctionType& function_type, absl::Span<const Value> arguments) {
+absl::Status Ice40DeviceRpcStrategy::WriteRequest(
+    absl::Span<const Value> arguments) {
+  if (!tty_fd_.has_value()) {
+    return absl::FailedPreconditionError("Not connected to an ICE40 device.");
+  }
   BitPushBuffer buffer;
   for (const Value& arg : arguments) {
     arg.FlattenTo(&buffer);
@@ -285,10 +290,16 @@ absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
     bytes_written += ret;
   }
 
-  if (tcflush(tty_fd_.value(), TCOFLUSH) != 0) {
+  // Wait for the request to be transmitted. (Flushing with TCOFLUSH would
+  // instead discard any of it still queued.)
+  if (tcdrain(tty_fd_.value()) != 0) {
     return absl::InternalError("Could not flush write(s) to device.");
   }
+  return absl::OkStatus();
+}
 
+absl::StatusOr<Value> Ice40DeviceRpcStrategy::ReadResponse(
+    const FunctionType& function_type) {
   int64_t output_bits = function_type.return_type()->GetFlatBitCount();
   std::vector<uint8_t> result(CeilOfRatio(output_bits, int64_t{8}));
 
@@ -303,8 +314,8 @@ absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
       return absl::InternalError(
           absl::StrFormat("Could not read partial data of %d remaining bytes "
                           "(originally %d) from ICE40: %s",
-                          buffer.size_in_bytes() - bytes_written,
-                          buffer.size_in_bytes(), Strerror(errno)));
+                          result.size() - bytes_read, result.size(),
+                          Strerror(errno)));
     }
     bytes_read += ret;
   }
@@ -322,4 +333,33 @@ absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
   return absl::UnimplementedError("NYI: convert result to Value");
 }
 
+absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
+    const FunctionType& function_type, absl::Span<const Value> arguments) {
+  XLS_RETURN_IF_ERROR(WriteRequest(arguments));
+  return ReadResponse(function_type);
+}
+
+absl::StatusOr<std::vector<Value>> Ice40DeviceRpcStrategy::CallUnnamedBatch(
+    const FunctionType& function_type,
+    absl::Span<const std::vector<Value>> argument_sets,
+    int64_t max_in_flight) {
+  XLS_RET_CHECK_GE(max_in_flight, 1);
+  // The link is full duplex, so while the device transmits one response the
+  // next requests are already on their way (or queued in the device's input
+  // controller).
+  std::vector<Value> results;
+  results.reserve(argument_sets.size());
+  int64_t requests_sent = 0;
+  while (results.size() < argument_sets.size()) {
+    while (requests_sent < argument_sets.size() &&
+           requests_sent - results.size() < max_in_flight) {
+      XLS_RETURN_IF_ERROR(WriteRequest(argument_sets[requests_sent]));
+      ++requests_sent;
+    }
+    XLS_ASSIGN_OR_RETURN(Value result, ReadResponse(function_type));
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
 }  // namespace xls
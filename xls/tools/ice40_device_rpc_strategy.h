@@ -15,7 +15,12 @@
 #ifndef XLS_TOOLS_ICE40_DEVICE_RPC_STRATEGY_H_
 #define XLS_TOOLS_ICE40_DEVICE_RPC_STRATEGY_H_
 
+#include <cstdint>
+#include <optional>
+#include <vector>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/tools/device_rpc_strategy.h"
 
 namespace xls {
@@ -29,7 +34,23 @@ class Ice40DeviceRpcStrategy : public DeviceRpcStrategy {
   absl::StatusOr<Value> CallUnnamed(const FunctionType& function_type,
                                     absl::Span<const Value> arguments) override;
 
+  // Pipelines the calls over the serial link: the I/O wrapper on the device
+  // processes requests in order, so responses are matched to requests by
+  // position. Note that the wrapper generated by WrapIO buffers only one
+  // request beyond the one being computed, so max_in_flight should not exceed
+  // 2 for it; bytes of further requests would be dropped.
+  absl::StatusOr<std::vector<Value>> CallUnnamedBatch(
+      const FunctionType& function_type,
+      absl::Span<const std::vector<Value>> argument_sets,
+      int64_t max_in_flight) override;
+
  private:
+  // Sends the flattened arguments of one call to the device.
+  absl::Status WriteRequest(absl::Span<const Value> arguments);
+
+  // Receives the result of one call from the device.
+  absl::StatusOr<Value> ReadResponse(const FunctionType& function_type);
+
   std::optional<int> tty_fd_;
 };
 
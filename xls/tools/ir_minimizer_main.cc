@@ -12,17 +12,22 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <optional>
 #include <random>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/random/distributions.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_split.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/thread.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
@@ -77,6 +82,12 @@ from the interpreter results. Example invocation:
   ir_minimizer_main --test_llvm_jit --use_optimization_pipeline \
     --input='bits[32]:42; bits[1]:0' IR_FILE
 
+With --bulk_removal, the random simplifications are preceded by a
+delta-debugging style phase which replaces large subsets of nodes with zero
+literals at once. With --parallelism=N, up to N candidate simplifications are
+tested concurrently and the first one (in generation order) which still fails
+is adopted. This pays off when the test executable is slow.
+
 )";
 
 ABSL_FLAG(bool, can_remove_params, false,
@@ -129,6 +140,16 @@ ABSL_FLAG(std::vector<std::string>, preserve_channels, {},
           "Preserve IO ops on the given channel names during minimization. "
           "This is useful when minimizing with a script that runs the "
           "scheduler with IO constraints.");
+ABSL_FLAG(bool, bulk_removal, false,
+          "If true, then before the random simplifications try replacing "
+          "whole subsets of nodes with zero literals at once, halving the "
+          "subset size whenever no subset of the current size can be "
+          "replaced (delta debugging). This typically reduces large samples "
+          "with far fewer test invocations.");
+ABSL_FLAG(int64_t, parallelism, 1,
+          "Number of candidate simplifications to test concurrently. The "
+          "first candidate (in generation order) which still fails is "
+          "adopted.");
 ABSL_FLAG(std::string, top, "",
           "The name of the top entity. Currently, only procs and functions are "
           "supported. Entry function to use during minimization.");
@@ -241,6 +262,69 @@ absl::StatusOr<bool> StillFails(
   return result;
 }
 
+// Tests each of the given IR texts, running up to --parallelism tests
+// concurrently, and returns the index of the first one which still fails (or
+// std::nullopt if none do). Cached results are looked up and recorded on the
+// calling thread so the test cache needs no synchronization.
+absl::StatusOr<std::optional<int64_t>> FindFirstStillFailing(
+    absl::Span<const std::string> ir_texts,
+    const std::optional<std::vector<Value>>& inputs,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  std::vector<std::optional<bool>> still_fails(ir_texts.size());
+  std::vector<int64_t> pending;
+  for (int64_t i = 0; i < ir_texts.size(); ++i) {
+    XLS_VLOG(1) << "=== Verifying contents still fails";
+    XLS_VLOG_LINES(2, ir_texts[i]);
+    auto it = test_cache->find(ir_texts[i]);
+    if (it != test_cache->end()) {
+      XLS_LOG(INFO) << absl::StreamFormat("Found result in cache (failed = %d)",
+                                          it->second);
+      still_fails[i] = it->second;
+    } else {
+      pending.push_back(i);
+    }
+  }
+
+  int64_t worker_count = std::min<int64_t>(
+      std::max<int64_t>(absl::GetFlag(FLAGS_parallelism), 1), pending.size());
+  std::vector<absl::Status> statuses(worker_count);
+  auto run_worker = [&](int64_t worker) {
+    for (int64_t j = worker; j < pending.size(); j += worker_count) {
+      int64_t i = pending[j];
+      absl::StatusOr<bool> result = StillFailsHelper(ir_texts[i], inputs);
+      if (!result.ok()) {
+        statuses[worker] = result.status();
+        return;
+      }
+      still_fails[i] = *result;
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t worker = 1; worker < worker_count; ++worker) {
+    threads.push_back(std::make_unique<Thread>(
+        [&run_worker, worker]() { run_worker(worker); }));
+  }
+  if (worker_count > 0) {
+    run_worker(0);
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+
+  for (int64_t i : pending) {
+    (*test_cache)[ir_texts[i]] = still_fails[i].value();
+  }
+  for (int64_t i = 0; i < ir_texts.size(); ++i) {
+    if (still_fails[i].value()) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
 // Writes the IR out to a temporary file, runs the test executable on it, and
 // returns 'true' if the test (still) fails on that IR text.  Optional test
 // cache is used to memoize the results of testing the given IR.
@@ -687,6 +771,104 @@ absl::Status CleanUp(FunctionBase* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
+// Returns the names of the nodes of `f` which bulk removal may replace with a
+// zero literal.
+std::vector<std::string> ZeroReplaceableNodeNames(FunctionBase* f) {
+  std::vector<std::string> names;
+  for (Node* node : f->nodes()) {
+    if (TypeHasToken(node->GetType())) {
+      continue;
+    }
+    if (node->Is<Param>() && node->IsDead()) {
+      continue;
+    }
+    if (node->Is<Literal>() && node->As<Literal>()->value().IsAllZeros()) {
+      continue;
+    }
+    names.push_back(node->GetName());
+  }
+  return names;
+}
+
+// Delta-debugging style reduction which replaces chunks of nodes with zero
+// literals all at once. The first chunk whose replacement still fails is
+// adopted, and the chunk size is halved once no chunk of the current size can
+// be replaced. Returns the reduced, still failing IR text.
+absl::StatusOr<std::string> BulkReplaceWithZeros(
+    std::string knownf_ir_text, const std::optional<std::vector<Value>>& inputs,
+    bool can_remove_params, int64_t total_attempt_limit,
+    absl::flat_hash_map<std::string, bool>* test_cache,
+    int64_t* total_attempts) {
+  const int64_t parallelism =
+      std::max<int64_t>(absl::GetFlag(FLAGS_parallelism), 1);
+  std::vector<std::string> names;
+  {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         ParsePackage(knownf_ir_text));
+    names = ZeroReplaceableNodeNames(package->GetTop().value());
+  }
+
+  int64_t chunk_size = (names.size() + 1) / 2;
+  while (chunk_size > 0 && *total_attempts < total_attempt_limit) {
+    bool progress = false;
+    for (int64_t start = 0; start < names.size() && !progress &&
+                            *total_attempts < total_attempt_limit;
+         start += chunk_size * parallelism) {
+      // Build one candidate per chunk of this batch.
+      std::vector<std::string> candidate_ir_texts;
+      std::vector<std::pair<int64_t, int64_t>> candidate_stats;
+      int64_t batch_end =
+          std::min<int64_t>(names.size(), start + chunk_size * parallelism);
+      for (int64_t begin = start; begin < batch_end; begin += chunk_size) {
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                             ParsePackage(knownf_ir_text));
+        FunctionBase* f = package->GetTop().value();
+        absl::flat_hash_map<std::string, Node*> nodes_by_name;
+        for (Node* node : f->nodes()) {
+          nodes_by_name[node->GetName()] = node;
+        }
+        int64_t end = std::min<int64_t>(begin + chunk_size, names.size());
+        for (int64_t i = begin; i < end; ++i) {
+          Node* node = nodes_by_name.at(names[i]);
+          XLS_RETURN_IF_ERROR(
+              node->ReplaceUsesWithNew<Literal>(ZeroOfType(node->GetType()))
+                  .status());
+        }
+        XLS_RETURN_IF_ERROR(CleanUp(f, can_remove_params));
+        std::string candidate_ir_text = package->DumpIr();
+        if (candidate_ir_text == knownf_ir_text) {
+          continue;
+        }
+        candidate_ir_texts.push_back(std::move(candidate_ir_text));
+        candidate_stats.push_back({end - begin, f->node_count()});
+        ++*total_attempts;
+      }
+
+      XLS_ASSIGN_OR_RETURN(
+          std::optional<int64_t> first,
+          FindFirstStillFailing(candidate_ir_texts, inputs, test_cache));
+      if (!first.has_value()) {
+        continue;
+      }
+      knownf_ir_text = candidate_ir_texts[*first];
+      progress = true;
+      std::cerr << absl::StreamFormat(
+          "---\ntransform: bulk replace %d nodes with zero\n(%d nodes)\n",
+          candidate_stats[*first].first, candidate_stats[*first].second);
+    }
+
+    if (progress) {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                           ParsePackage(knownf_ir_text));
+      names = ZeroReplaceableNodeNames(package->GetTop().value());
+      chunk_size = std::min<int64_t>(chunk_size, names.size());
+    } else {
+      chunk_size /= 2;
+    }
+  }
+  return knownf_ir_text;
+}
+
 absl::Status RealMain(std::string_view path,
                       const int64_t failed_attempt_limit,
                       const int64_t total_attempt_limit) {
@@ -730,91 +912,121 @@ absl::Status RealMain(std::string_view path,
     XLS_LOG(INFO) << "=== Done cleaning up initial garbage";
   }
 
-  // If so, we start simplifying via this seeded RNG.
-  std::mt19937 rng;  // Default constructor uses deterministic seed.
-
   // Smallest version of the function that's known to be failing.
   int64_t failed_simplification_attempts = 0;
   int64_t total_attempts = 0;
 
-  while (true) {
-    if (failed_simplification_attempts >= failed_attempt_limit) {
-      XLS_LOG(INFO) << "Hit failed-simplification-attempt-limit: "
-                    << failed_simplification_attempts;
-      // Used up all our attempts for this state.
-      break;
-    }
+  if (absl::GetFlag(FLAGS_bulk_removal)) {
+    XLS_LOG(INFO) << "=== Bulk removal";
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        BulkReplaceWithZeros(knownf_ir_text, inputs, can_remove_params,
+                             total_attempt_limit, &test_cache,
+                             &total_attempts));
+    XLS_LOG(INFO) << "=== Done with bulk removal after " << total_attempts
+                  << " attempts";
+  }
 
-    total_attempts++;
-    if (total_attempts >= total_attempt_limit) {
-      XLS_LOG(INFO) << "Hit total-attempt-limit: " << total_attempts;
-      break;
-    }
+  // Then we continue simplifying via this seeded RNG.
+  std::mt19937 rng;  // Default constructor uses deterministic seed.
 
-    XLS_VLOG(1) << "=== Simplification attempt " << total_attempts;
+  const int64_t parallelism =
+      std::max<int64_t>(absl::GetFlag(FLAGS_parallelism), 1);
+  bool done = false;
+  while (!done) {
+    // Generate a batch of up to `parallelism` changed candidates, all derived
+    // from the last known failing version.
+    std::vector<std::string> candidate_ir_texts;
+    std::vector<std::string> candidate_transforms;
+    std::vector<std::string> candidate_dumps;
+    while (candidate_ir_texts.size() < parallelism) {
+      if (failed_simplification_attempts >= failed_attempt_limit) {
+        XLS_LOG(INFO) << "Hit failed-simplification-attempt-limit: "
+                      << failed_simplification_attempts;
+        // Used up all our attempts for this state.
+        done = true;
+        break;
+      }
 
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                         ParsePackage(knownf_ir_text));
-    FunctionBase* candidate = package->GetTop().value();
-    XLS_VLOG_LINES(2,
-                   "=== Candidate for simplification:\n" + candidate->DumpIr());
-
-    // Simplify the function.
-    std::string which_transform;
-    XLS_ASSIGN_OR_RETURN(SimplificationResult simplification,
-                         Simplify(candidate, inputs, &rng, &which_transform));
-
-    // If we cannot change it, we're done.
-    if (simplification == SimplificationResult::kCannotChange) {
-      XLS_LOG(INFO) << "Cannot simplify any further, done!";
-      break;
-    }
-
-    // If we happened to not change it (e.g. because the RNG said not to), keep
-    // going until we do. We still bump the counter to make sure we don't end up
-    // wedged in a state where we can't simplify anything.
-    if (simplification == SimplificationResult::kDidNotChange) {
-      XLS_VLOG(1) << "Did not change the sample.";
-      failed_simplification_attempts++;
-      continue;
-    }
-    XLS_LOG(INFO) << "Trying " << which_transform;
+      total_attempts++;
+      if (total_attempts >= total_attempt_limit) {
+        XLS_LOG(INFO) << "Hit total-attempt-limit: " << total_attempts;
+        done = true;
+        break;
+      }
+
+      XLS_VLOG(1) << "=== Simplification attempt " << total_attempts;
 
-    // When we changed (simplified) it, clean it up then see if it still fails.
-    XLS_CHECK(simplification == SimplificationResult::kDidChange);
-    XLS_RETURN_IF_ERROR(CleanUp(candidate, can_remove_params));
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                           ParsePackage(knownf_ir_text));
+      FunctionBase* candidate = package->GetTop().value();
+      XLS_VLOG_LINES(
+          2, "=== Candidate for simplification:\n" + candidate->DumpIr());
 
-    XLS_VLOG_LINES(2, "=== After simplification [" + which_transform + "]\n" +
-                          candidate->DumpIr());
+      // Simplify the function.
+      std::string which_transform;
+      XLS_ASSIGN_OR_RETURN(SimplificationResult simplification,
+                           Simplify(candidate, inputs, &rng, &which_transform));
 
-    std::string candidate_ir_text = package->DumpIr();
-    XLS_ASSIGN_OR_RETURN(bool still_fails,
-                         StillFails(candidate_ir_text, inputs, &test_cache));
-    if (!still_fails) {
-      failed_simplification_attempts++;
+      // If we cannot change it, we're done.
+      if (simplification == SimplificationResult::kCannotChange) {
+        XLS_LOG(INFO) << "Cannot simplify any further, done!";
+        done = true;
+        break;
+      }
+
+      // If we happened to not change it (e.g. because the RNG said not to),
+      // keep going until we do. We still bump the counter to make sure we
+      // don't end up wedged in a state where we can't simplify anything.
+      if (simplification == SimplificationResult::kDidNotChange) {
+        XLS_VLOG(1) << "Did not change the sample.";
+        failed_simplification_attempts++;
+        continue;
+      }
+      XLS_LOG(INFO) << "Trying " << which_transform;
+
+      // When we changed (simplified) it, clean it up before testing it.
+      XLS_CHECK(simplification == SimplificationResult::kDidChange);
+      XLS_RETURN_IF_ERROR(CleanUp(candidate, can_remove_params));
+
+      XLS_VLOG_LINES(2, "=== After simplification [" + which_transform +
+                            "]\n" + candidate->DumpIr());
+
+      candidate_ir_texts.push_back(package->DumpIr());
+      candidate_transforms.push_back(which_transform);
+      candidate_dumps.push_back(
+          absl::StrCat(candidate->node_count() > 50 ? "" : candidate->DumpIr(),
+                       "(", candidate->node_count(), " nodes)"));
+    }
+    if (candidate_ir_texts.empty()) {
+      continue;
+    }
+
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<int64_t> first,
+        FindFirstStillFailing(candidate_ir_texts, inputs, &test_cache));
+    if (!first.has_value()) {
+      failed_simplification_attempts += candidate_ir_texts.size();
       XLS_LOG(INFO) << "Sample no longer fails.";
       XLS_LOG(INFO) << "Failed simplification attempts now: "
                     << failed_simplification_attempts;
-      // That simplification caused it to stop failing, but keep going with the
-      // last known failing version and seeing if we can find something else
-      // from there.
+      // The simplifications caused it to stop failing, but keep going with
+      // the last known failing version and seeing if we can find something
+      // else from there.
       continue;
     }
 
     // We found something that definitely fails, update our "knownf" value and
     // reset our failed simplification attempt count since we see we've made
     // some forward progress.
-    XLS_RETURN_IF_ERROR(CleanUp(candidate, can_remove_params));
-
     XLS_RETURN_IF_ERROR(VerifyStillFails(
         knownf_ir_text, inputs, "Known failure does not fail after cleanup!",
         &test_cache));
 
-    knownf_ir_text = candidate_ir_text;
+    knownf_ir_text = candidate_ir_texts[*first];
 
-    std::cerr << "---\ntransform: " << which_transform << "\n"
-              << (candidate->node_count() > 50 ? "" : candidate->DumpIr())
-              << "(" << candidate->node_count() << " nodes)" << std::endl;
+    std::cerr << "---\ntransform: " << candidate_transforms[*first] << "\n"
+              << candidate_dumps[*first] << std::endl;
 
     failed_simplification_attempts = 0;
   }
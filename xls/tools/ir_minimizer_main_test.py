@@ -349,6 +349,19 @@ top proc foo(tkn: token, init={}) {
 }
 ''')
 
+  def test_minimize_add_bulk_removal_parallel(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    test_sh_file = self.create_tempfile()
+    self._write_sh_script(test_sh_file.full_path, ['/bin/grep add $1'])
+    minimized_ir = subprocess.check_output([
+        IR_MINIMIZER_MAIN_PATH, '--test_executable=' + test_sh_file.full_path,
+        '--can_remove_params', '--bulk_removal', '--parallelism=4',
+        ir_file.full_path
+    ]).decode('utf-8')
+    self.assertIn('top fn foo() -> bits[32] {', minimized_ir)
+    self.assertIn('add(', minimized_ir)
+    self.assertNotIn('not(', minimized_ir)
+
   def test_verify_return_code(self):
     # If the test script never successfully runs, then ir_minimizer_main should
     # return nonzero.
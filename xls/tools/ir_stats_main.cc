@@ -12,58 +12,176 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-// Prints summary information about an IR file to the terminal.
+// Prints summary information about IR files to the terminal.
 // Output will be added as needs warrant, so feel free to make additions!
+//
+// Several files may be given. They are parsed and analyzed concurrently and
+// the results are printed in the order the files were given.
 
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
-#include "xls/common/file/filesystem.h"
+#include "absl/types/span.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/parallel_for.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/memory_usage.h"
+#include "xls/tools/ir_stats.pb.h"
+#include "xls/tools/proto_results.h"
 
 ABSL_FLAG(
     std::string, top, "",
     "The name of the top entity. Currently, only functions are supported. "
-    "If set, restrict dumping to the given function. "
-    "The name should not be mangled with the Package name.");
+    "If set, restrict dumping to the given function. Only the function and "
+    "the functions it calls are parsed, so package-wide statistics cover "
+    "just those. The name should not be mangled with the Package name.");
+ABSL_FLAG(bool, memory, false,
+          "If true, also print an estimate of the memory used by the IR, "
+          "broken down by structure.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads to analyze files and functions on; zero for one "
+          "per hardware thread.");
+ABSL_FLAG(std::string, results_path, "",
+          "If specified, the statistics are also written to this file as an "
+          "IrStatsResultsProto in the format given by --results_format.");
+ABSL_FLAG(std::string, results_format, "textproto",
+          "Format of the file written to --results_path. One of: textproto, "
+          "json.");
 
 namespace xls {
+namespace {
+
+MemoryUsageProto ToProto(const MemoryUsage& usage) {
+  MemoryUsageProto proto;
+  proto.set_node_bytes(usage.node_bytes);
+  proto.set_node_arena_bytes(usage.node_arena_bytes);
+  proto.set_operand_bytes(usage.operand_bytes);
+  proto.set_user_bytes(usage.user_bytes);
+  proto.set_source_info_bytes(usage.source_info_bytes);
+  proto.set_name_bytes(usage.name_bytes);
+  proto.set_total_bytes(usage.total_bytes());
+  return proto;
+}
 
-absl::Status RealMain(std::string_view ir_path,
-                      std::optional<std::string> restrict_fn) {
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(contents));
+absl::StatusOr<std::unique_ptr<Package>> ParseIrFile(
+    std::string_view path, const std::optional<std::string>& restrict_fn) {
+  std::vector<std::string> entity_names;
+  if (restrict_fn.has_value()) {
+    entity_names.push_back(restrict_fn.value());
+  }
+  return Parser::ParsePackageFromFile(path, entity_names);
+}
 
-  std::cout << "Package \"" << package->name() << "\"" << std::endl;
-  for (const auto& f : package->functions()) {
-    if (restrict_fn && restrict_fn.value() != f->name()) {
-      continue;
+void PrintStats(const PackageStatsProto& stats) {
+  std::cout << "Package \"" << stats.package_name() << "\"" << std::endl;
+  for (const FunctionStatsProto& f : stats.functions()) {
+    std::cout << "  Function: \"" << f.name() << "\"" << std::endl;
+    std::cout << "    Signature: " << f.signature() << std::endl;
+    std::cout << "    Nodes: " << f.node_count() << std::endl;
+    if (f.has_memory()) {
+      std::cout << "    Memory: " << f.memory().total_bytes() << " bytes"
+                << std::endl;
     }
-    std::cout << "  Function: \"" << f->name() << "\"" << std::endl;
-    std::cout << "    Signature: " << f->GetType()->ToString() << std::endl;
-    std::cout << "    Nodes: " << f->node_count() << std::endl;
     std::cout << std::endl;
   }
+}
+
+absl::Status RealMain(absl::Span<const std::string_view> ir_paths,
+                      std::optional<std::string> restrict_fn, bool memory,
+                      int64_t thread_count) {
+  // Parse the files and compute package-wide statistics.
+  std::vector<std::unique_ptr<Package>> packages(ir_paths.size());
+  std::vector<absl::Status> statuses(ir_paths.size());
+  std::vector<MemoryUsage> package_memory(ir_paths.size());
+  IrStatsResultsProto results;
+  for (std::string_view path : ir_paths) {
+    results.add_packages()->set_ir_path(std::string(path));
+  }
+  ParallelFor(ir_paths.size(), thread_count, [&](int64_t i) {
+    absl::StatusOr<std::unique_ptr<Package>> package =
+        ParseIrFile(ir_paths[i], restrict_fn);
+    if (!package.ok()) {
+      statuses[i] = package.status();
+      return;
+    }
+    packages[i] = std::move(package).value();
+    PackageStatsProto* stats = results.mutable_packages(i);
+    stats->set_package_name(packages[i]->name());
+    if (memory) {
+      package_memory[i] = GetMemoryUsage(packages[i].get());
+      *stats->mutable_memory() = ToProto(package_memory[i]);
+      stats->set_type_count(package_memory[i].type_count);
+    } else {
+      stats->set_type_count(packages[i]->GetOwnedTypeCount());
+    }
+  });
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+
+  // Compute per-function statistics. The slots in the results are allocated
+  // up front so the functions can be analyzed in any order.
+  std::vector<Function*> functions;
+  std::vector<FunctionStatsProto*> function_stats;
+  for (int64_t i = 0; i < packages.size(); ++i) {
+    for (const auto& f : packages[i]->functions()) {
+      if (restrict_fn && restrict_fn.value() != f->name()) {
+        continue;
+      }
+      functions.push_back(f.get());
+      function_stats.push_back(results.mutable_packages(i)->add_functions());
+    }
+  }
+  ParallelFor(functions.size(), thread_count, [&](int64_t i) {
+    Function* f = functions[i];
+    FunctionStatsProto* stats = function_stats[i];
+    stats->set_name(f->name());
+    stats->set_signature(f->GetType()->ToString());
+    stats->set_node_count(f->node_count());
+    if (memory) {
+      *stats->mutable_memory() = ToProto(GetMemoryUsage(f));
+    }
+  });
+
+  for (int64_t i = 0; i < results.packages_size(); ++i) {
+    PrintStats(results.packages(i));
+    if (memory) {
+      std::cout << "Package memory usage:" << std::endl
+                << package_memory[i].ToString() << std::endl;
+    }
+  }
+  if (!absl::GetFlag(FLAGS_results_path).empty()) {
+    XLS_RETURN_IF_ERROR(WriteProtoResults(
+        results, absl::GetFlag(FLAGS_results_path),
+        absl::GetFlag(FLAGS_results_format)));
+  }
   return absl::OkStatus();
 }
 
+}  // namespace
 }  // namespace xls
 
 int main(int argc, char** argv) {
   std::vector<std::string_view> positional_args =
       xls::InitXls(argv[0], argc, argv);
-  XLS_QCHECK(positional_args.size() == 1);
+  XLS_QCHECK(!positional_args.empty())
+      << "Expected one or more IR files as arguments.";
 
   std::optional<std::string> restrict_fn;
   if (!absl::GetFlag(FLAGS_top).empty()) {
     restrict_fn = absl::GetFlag(FLAGS_top);
   }
-  XLS_QCHECK_OK(xls::RealMain(positional_args[0], restrict_fn));
+  XLS_QCHECK_OK(xls::RealMain(positional_args, restrict_fn,
+                              absl::GetFlag(FLAGS_memory),
+                              absl::GetFlag(FLAGS_threads)));
   return 0;
 }
@@ -16,12 +16,20 @@
 
 #include <signal.h>
 
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "absl/base/internal/sysinfo.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/init_xls.h"
@@ -37,6 +45,7 @@
 #include "xls/netlist/netlist_parser.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/solvers/z3_lec.h"
+#include "xls/solvers/z3_portfolio.h"
 #include "xls/solvers/z3_utils.h"
 #include "../z3/src/api/z3_api.h"
 
@@ -48,6 +57,11 @@ ABSL_FLAG(std::string, cell_proto_path, "",
           "This is a whole bunch faster than specifiying an unprocessed "
           "cell library and should be favored.\n"
           "Either this or --cell_lib_path should be set.");
+ABSL_FLAG(std::string, cell_lib_cache_dir, "",
+          "If set, the functions extracted from --cell_lib_path are cached in "
+          "this directory, and reused while the library is unchanged. "
+          "Otherwise only the cells referenced by the netlist are extracted "
+          "from the library.");
 ABSL_FLAG(std::string, constraints_file, "",
           "Optional path to a DSLX file containing a input parameter "
           "constraint function. This function must have the same signature as "
@@ -81,6 +95,20 @@ ABSL_FLAG(int32_t, timeout_sec, -1,
 ABSL_FLAG(bool, auto_stage, false,
           "If true, then the tool will determine on its own whether to perform "
           "staged or full LEC. This requires that a schedule be specified.");
+ABSL_FLAG(int32_t, partition_count, 1,
+          "If greater than 1, the output bits are split into this many "
+          "partitions, each proved by a separate solver concurrently with the "
+          "others. This is often much faster for wide outputs. Not supported "
+          "with --auto_stage or --timeout_sec.");
+ABSL_FLAG(int32_t, partition_threads, 0,
+          "The number of partitions to prove at once with --partition_count. "
+          "If 0, the number of CPUs is used.");
+ABSL_FLAG(std::vector<std::string>, portfolio, {},
+          "Comma-separated list of solvers to race on the proof, taking the "
+          "first definitive answer, e.g. \"z3,z3:qfbv,smtlib:/usr/bin/cvc5\". "
+          "See xls/solvers/z3_portfolio.h for the syntax. If empty, Z3's "
+          "default solver is used. Not supported with --auto_stage or "
+          "--partition_count.");
 ABSL_FLAG(int32_t, stage, -1,
           "Pipeline stage to evaluate. Requires --schedule.\n"
           "If \"schedule\" is set, but this is not, then the entire module "
@@ -103,21 +131,32 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     netlist::CellLibraryProto cell_proto;
     XLS_RET_CHECK(cell_proto.ParseFromString(cell_proto_text));
     return netlist::CellLibrary::FromProto(cell_proto);
-  } else {
-    XLS_ASSIGN_OR_RETURN(std::string lib_text, GetFileContents(cell_lib_path));
-    XLS_ASSIGN_OR_RETURN(auto stream,
-                         netlist::cell_lib::CharStream::FromText(lib_text));
-    XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto proto,
-                         netlist::function::ExtractFunctions(&stream));
+  }
+  std::string cache_dir = absl::GetFlag(FLAGS_cell_lib_cache_dir);
+  if (!cache_dir.empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        netlist::CellLibraryProto proto,
+        netlist::function::ExtractFunctionsCached(cell_lib_path, cache_dir));
     return netlist::CellLibrary::FromProto(proto);
   }
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<const netlist::function::IndexedLibrary> library,
+      netlist::function::IndexedLibrary::FromPath(cell_lib_path));
+  netlist::CellLibrary cell_library;
+  cell_library.SetEntryLoader([library](std::string_view name)
+                                  -> absl::StatusOr<netlist::CellLibraryEntry> {
+    XLS_ASSIGN_OR_RETURN(netlist::CellLibraryEntryProto entry_proto,
+                         library->ExtractCell(name));
+    return netlist::CellLibraryEntry::FromProto(entry_proto);
+  });
+  return cell_library;
 }
 
 // Loads and parses a netlist from a file.
 absl::StatusOr<std::unique_ptr<netlist::rtl::Netlist>> GetNetlist(
     std::string_view netlist_path, netlist::CellLibrary* cell_library) {
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(netlist::rtl::Scanner scanner,
+                       netlist::rtl::Scanner::FromFile(netlist_path));
   return netlist::rtl::Parser::ParseNetlist(cell_library, &scanner);
 }
 
@@ -226,7 +265,8 @@ absl::Status RealMain(
     std::string_view netlist_module_name, std::string_view cell_lib_path,
     std::string_view cell_proto_path, std::string_view netlist_path,
     std::string_view constraints_file, std::string_view schedule_path,
-    int stage, bool auto_stage, int timeout_sec) {
+    int stage, bool auto_stage, int timeout_sec, int partition_count,
+    int partition_threads, absl::Span<const std::string> portfolio) {
   solvers::z3::LecParams lec_params;
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
@@ -245,24 +285,20 @@ absl::Status RealMain(
   lec_params.netlist = netlist.get();
   lec_params.netlist_module_name = netlist_module_name;
 
-  std::unique_ptr<solvers::z3::Lec> lec;
+  std::optional<PipelineSchedule> schedule;
   if (!schedule_path.empty()) {
     XLS_ASSIGN_OR_RETURN(
         PipelineScheduleProto proto,
         ParseTextProtoFile<PipelineScheduleProto>(schedule_path));
     XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
-        PipelineSchedule::FromProto(lec_params.ir_function, proto));
+        schedule, PipelineSchedule::FromProto(lec_params.ir_function, proto));
     if (auto_stage) {
-      return AutoStage(lec_params, schedule, timeout_sec);
+      return AutoStage(lec_params, schedule.value(), timeout_sec);
     }
-    XLS_ASSIGN_OR_RETURN(lec, solvers::z3::Lec::CreateForStage(
-                                  std::move(lec_params), schedule, stage));
-  } else {
-    XLS_ASSIGN_OR_RETURN(lec, solvers::z3::Lec::Create(std::move(lec_params)));
   }
 
   std::unique_ptr<Package> constraints_pkg;
+  Function* constraints = nullptr;
   if (!constraints_file.empty()) {
     XLS_ASSIGN_OR_RETURN(std::filesystem::path ir_converter_path,
                          GetXlsRunfilePath(kIrConverterPath));
@@ -273,22 +309,64 @@ absl::Status RealMain(
 
     XLS_ASSIGN_OR_RETURN(constraints_pkg,
                          Parser::ParsePackage(stdout_and_stderr.first));
-    XLS_ASSIGN_OR_RETURN(Function * function,
-                         constraints_pkg->GetTopAsFunction());
-    XLS_RETURN_IF_ERROR(lec->AddConstraints(function));
+    XLS_ASSIGN_OR_RETURN(constraints, constraints_pkg->GetTopAsFunction());
   }
 
-  struct sigaction old_action;
-  if (timeout_sec != -1) {
-    old_action = SetAlarm(timeout_sec);
+  if (partition_count > 1) {
+    solvers::z3::LecPartitionOptions options;
+    options.partition_count = partition_count;
+    options.thread_count = partition_threads == 0
+                               ? absl::base_internal::NumCPUs()
+                               : partition_threads;
+    options.schedule = schedule;
+    options.stage = stage;
+    options.constraints = constraints;
+    XLS_ASSIGN_OR_RETURN(
+        solvers::z3::PartitionedLecResult result,
+        solvers::z3::Lec::RunPartitioned(lec_params, options));
+    if (result.proven) {
+      std::cout << "Proved equivalent in all " << partition_count
+                << " partitions." << std::endl;
+    }
+    for (const std::string& counterexample : result.counterexamples) {
+      std::cout << counterexample << std::endl;
+    }
+    return absl::OkStatus();
   }
-  bool equal = lec->Run();
-  if (timeout_sec != -1) {
-    CancelAlarm(old_action);
+
+  std::unique_ptr<solvers::z3::Lec> lec;
+  if (schedule.has_value()) {
+    XLS_ASSIGN_OR_RETURN(lec, solvers::z3::Lec::CreateForStage(
+                                  std::move(lec_params), *schedule, stage));
+  } else {
+    XLS_ASSIGN_OR_RETURN(lec, solvers::z3::Lec::Create(std::move(lec_params)));
   }
-  absl::MutexLock lock(&mutex);
-  if (z3_interrupted) {
-    return absl::DeadlineExceededError("LEC timed out.");
+  if (constraints != nullptr) {
+    XLS_RETURN_IF_ERROR(lec->AddConstraints(constraints));
+  }
+
+  bool equal;
+  if (!portfolio.empty()) {
+    XLS_ASSIGN_OR_RETURN(std::vector<solvers::z3::PortfolioSolver> solvers,
+                         solvers::z3::ParsePortfolio(portfolio));
+    solvers::z3::PortfolioOptions options;
+    if (timeout_sec != -1) {
+      options.timeout = absl::Seconds(timeout_sec);
+    }
+    XLS_ASSIGN_OR_RETURN(equal, lec->RunPortfolio(solvers, options));
+  } else {
+    struct sigaction old_action;
+    if (timeout_sec != -1) {
+      old_action = SetAlarm(timeout_sec);
+    }
+    equal = lec->Run();
+    if (timeout_sec != -1) {
+      CancelAlarm(old_action);
+    }
+    absl::MutexLock lock(&mutex);
+    if (z3_interrupted) {
+      return absl::DeadlineExceededError("LEC timed out.");
+    }
   }
 
   std::cout << lec->ResultToString() << std::endl;
@@ -329,10 +407,20 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(!(auto_stage && schedule_path.empty()))
       << "--schedule_path must be specified with --auto_stage.";
 
+  int partition_count = absl::GetFlag(FLAGS_partition_count);
+  int timeout_sec = absl::GetFlag(FLAGS_timeout_sec);
+  XLS_QCHECK(partition_count <= 1 || (!auto_stage && timeout_sec == -1))
+      << "--partition_count cannot be used with --auto_stage or "
+         "--timeout_sec.";
+  std::vector<std::string> portfolio = absl::GetFlag(FLAGS_portfolio);
+  XLS_QCHECK(portfolio.empty() || (!auto_stage && partition_count <= 1))
+      << "--portfolio cannot be used with --auto_stage or --partition_count.";
+
   XLS_QCHECK_OK(xls::RealMain(
       ir_path, absl::GetFlag(FLAGS_entry_function_name),
       absl::GetFlag(FLAGS_netlist_module_name), cell_lib_path, cell_proto_path,
       netlist_path, absl::GetFlag(FLAGS_constraints_file), schedule_path, stage,
-      auto_stage, absl::GetFlag(FLAGS_timeout_sec)));
+      auto_stage, timeout_sec, partition_count,
+      absl::GetFlag(FLAGS_partition_threads), portfolio));
   return 0;
 }
@@ -13,7 +13,15 @@
 // limitations under the License.
 
 // Driver for NetlistInterpreter: loads a netlist from disk, feeds Value input
-// (taken from the command line) into it, and prints the result.
+// (taken from the command line or, one per line, from a file) into it, and
+// prints the result.
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
@@ -24,6 +32,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/bit_parallel_evaluator.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
@@ -38,6 +47,11 @@ ABSL_FLAG(std::string, cell_library, "",
           "Cell library to use for interpretation.");
 ABSL_FLAG(std::string, cell_library_proto, "",
           "Preprocessed cell library proto to use for interpretation.");
+ABSL_FLAG(std::string, cell_library_cache_dir, "",
+          "If set, the functions extracted from --cell_library are cached in "
+          "this directory, and reused while the library is unchanged. "
+          "Otherwise only the cells referenced by the netlist are extracted "
+          "from the library.");
 // TODO(rspringer): Eliminate the need for this flag.
 // This one is a hidden temporary flag until we can properly handle cells
 // with state_function attributes (e.g., some latches).
@@ -48,6 +62,12 @@ ABSL_FLAG(std::string, input, "",
           "The input to the function as a semicolon-separated list of typed "
           "values. For example: \"bits[32]:42; (bits[7]:0, bits[20]:4)\". "
           "Values must be listed in the same order as the module inputs.");
+ABSL_FLAG(std::string, input_file, "",
+          "Path to a file of inputs, one per line, each in the format of "
+          "--input. The module is evaluated for 64 lines at a time, one per "
+          "bit of a 64-bit word, and one output is printed per line. Cells "
+          "with state tables are not supported in this mode, and "
+          "--dump_cells is ignored.");
 ABSL_FLAG(std::string, output_type, "",
           "Type of the value as an XLS-formatted string. If un-set, then the "
           "output will be printed as flat uninterpreted bits.");
@@ -56,25 +76,142 @@ ABSL_FLAG(std::string, netlist, "", "Path to the netlist to interpret.");
 
 namespace xls {
 
-absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
+template <typename EvalT>
+absl::StatusOr<netlist::AbstractCellLibrary<EvalT>> GetCellLibrary(
     const std::string& cell_library_path,
-    const std::string& cell_library_proto_path) {
+    const std::string& cell_library_proto_path, EvalT zero, EvalT one) {
   if (!cell_library_proto_path.empty()) {
     XLS_ASSIGN_OR_RETURN(std::string proto_text,
                          GetFileContents(cell_library_proto_path));
     netlist::CellLibraryProto lib_proto;
     XLS_RET_CHECK(lib_proto.ParseFromString(proto_text));
-    return netlist::CellLibrary::FromProto(lib_proto);
-  } else {
-    XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
-                         GetFileContents(cell_library_path));
+    return netlist::AbstractCellLibrary<EvalT>::FromProto(lib_proto, zero,
+                                                          one);
+  }
+  std::string cache_dir = absl::GetFlag(FLAGS_cell_library_cache_dir);
+  if (!cache_dir.empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        netlist::CellLibraryProto lib_proto,
+        netlist::function::ExtractFunctionsCached(cell_library_path,
+                                                  cache_dir));
+    return netlist::AbstractCellLibrary<EvalT>::FromProto(lib_proto, zero,
+                                                          one);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<const netlist::function::IndexedLibrary> library,
+      netlist::function::IndexedLibrary::FromPath(cell_library_path));
+  netlist::AbstractCellLibrary<EvalT> cell_library;
+  cell_library.SetEntryLoader(
+      [library, zero, one](std::string_view name)
+          -> absl::StatusOr<netlist::AbstractCellLibraryEntry<EvalT>> {
+        XLS_ASSIGN_OR_RETURN(netlist::CellLibraryEntryProto entry_proto,
+                             library->ExtractCell(name));
+        return netlist::AbstractCellLibraryEntry<EvalT>::FromProto(entry_proto,
+                                                                   zero, one);
+      });
+  return cell_library;
+}
+
+// Returns the bits of the given input values, indexed by module input port
+// offset.
+//
+// Input values are listed in the same order as inputs are declared by
+// the netlist module declaration, which may be different from the order of
+// Module::inputs().  For example:
+//
+//  module ifte(i, t, e, out);
+//    input [7:0] e;
+//    input i;
+//    output [7:0] out;
+//    input [7:0] t;
+//
+// The values of --inputs should follow the module declaration, which would
+// also follow the declaration of the source language (e.g. C++ or XLS).
+absl::StatusOr<Bits> GetInputBits(absl::Span<const std::string> inputs,
+                                  int64_t input_count) {
+  Bits input_bits;
+  for (const auto& input_string : inputs) {
+    XLS_ASSIGN_OR_RETURN(Value input, Parser::ParseTypedValue(input_string));
+    Bits flat_value = FlattenValueToBits(input);
+    input_bits = bits_ops::Concat({input_bits, flat_value});
+  }
+  XLS_RET_CHECK(input_count == input_bits.bit_count());
+  return bits_ops::Reverse(input_bits);
+}
+
+// Returns the output bits as a value of `output_type`, or as flat bits if
+// `output_type` is null.
+absl::StatusOr<Value> GetOutputValue(const Bits& output_bits,
+                                     Type* output_type) {
+  if (output_type == nullptr) {
+    return Value(output_bits);
+  }
+  return UnflattenBitsToValue(output_bits, output_type);
+}
+
+// Interprets the module once per line of `input_file`, packing up to
+// BitParallelValue::kLaneCount lines into the lanes of a single
+// (levelized) interpretation, and prints one output per line.
+absl::Status InterpretBatch(const std::string& netlist_text,
+                            const std::string& cell_library_path,
+                            const std::string& cell_library_proto_path,
+                            const std::string& module_name,
+                            const std::string& input_file,
+                            Type* output_type) {
+  const BitParallelValue kZero = BitParallelValue::Broadcast(false);
+  const BitParallelValue kOne = BitParallelValue::Broadcast(true);
+  XLS_ASSIGN_OR_RETURN(
+      netlist::AbstractCellLibrary<BitParallelValue> cell_library,
+      GetCellLibrary(cell_library_path, cell_library_proto_path, kZero, kOne));
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(
+      auto netlist,
+      netlist::rtl::AbstractParser<BitParallelValue>::ParseNetlist(
+          &cell_library, &scanner, kZero, kOne));
+  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
+
+  XLS_ASSIGN_OR_RETURN(std::string input_text, GetFileContents(input_file));
+  std::vector<std::string_view> lines =
+      absl::StrSplit(input_text, '\n', absl::SkipWhitespace());
+
+  const std::vector<netlist::rtl::AbstractNetRef<BitParallelValue>>&
+      module_inputs = module->inputs();
+  netlist::AbstractInterpreter<BitParallelValue> interpreter(netlist.get(),
+                                                             kZero, kOne);
+  for (int64_t chunk_start = 0; chunk_start < lines.size();
+       chunk_start += BitParallelValue::kLaneCount) {
+    int64_t lane_count = std::min<int64_t>(BitParallelValue::kLaneCount,
+                                           lines.size() - chunk_start);
+    netlist::AbstractNetRef2Value<BitParallelValue> input_nets;
+    for (const auto& in : module_inputs) {
+      input_nets[in] = kZero;
+    }
+    for (int64_t lane = 0; lane < lane_count; ++lane) {
+      std::vector<std::string> inputs =
+          absl::StrSplit(lines[chunk_start + lane], ';');
+      XLS_ASSIGN_OR_RETURN(Bits input_bits,
+                           GetInputBits(inputs, module_inputs.size()));
+      for (const auto& in : module_inputs) {
+        input_nets[in].set_lane(
+            lane, input_bits.Get(module->GetInputPortOffset(in->name())));
+      }
+    }
+
     XLS_ASSIGN_OR_RETURN(
-        auto char_stream,
-        netlist::cell_lib::CharStream::FromText(cell_library_text));
-    XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
-                         netlist::function::ExtractFunctions(&char_stream));
-    return netlist::CellLibrary::FromProto(lib_proto);
+        auto output_nets,
+        interpreter.InterpretModuleLevelized(module, input_nets));
+
+    for (int64_t lane = 0; lane < lane_count; ++lane) {
+      BitsRope rope(output_nets.size());
+      for (const auto& ref : module->outputs()) {
+        rope.push_back(output_nets[ref].lane(lane));
+      }
+      XLS_ASSIGN_OR_RETURN(Value output,
+                           GetOutputValue(rope.Build(), output_type));
+      std::cout << output.ToString(FormatPreference::kHex) << std::endl;
+    }
   }
+  return absl::OkStatus();
 }
 
 absl::Status RealMain(const std::string& netlist_path,
@@ -82,43 +219,38 @@ absl::Status RealMain(const std::string& netlist_path,
                       const std::string& cell_library_proto_path,
                       const std::string& module_name,
                       absl::Span<const std::string> inputs,
+                      const std::string& input_file,
                       const std::string& output_type_string,
                       absl::Span<const std::string> dump_cells) {
-  XLS_ASSIGN_OR_RETURN(
-      netlist::CellLibrary cell_library,
-      GetCellLibrary(cell_library_path, cell_library_proto_path));
-
   XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
+
+  // This is a disposable package - it only exists to hold the type below.
+  Package package("foo");
+  Type* output_type = nullptr;
+  if (!output_type_string.empty()) {
+    XLS_ASSIGN_OR_RETURN(output_type,
+                         Parser::ParseType(output_type_string, &package));
+  }
+
+  if (!input_file.empty()) {
+    return InterpretBatch(netlist_text, cell_library_path,
+                          cell_library_proto_path, module_name, input_file,
+                          output_type);
+  }
+
+  XLS_ASSIGN_OR_RETURN(netlist::CellLibrary cell_library,
+                       GetCellLibrary(cell_library_path,
+                                      cell_library_proto_path, false, true));
   netlist::rtl::Scanner scanner(netlist_text);
   XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
                                          &cell_library, &scanner));
   XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
 
-  // Input values are listed in the same order as inputs are declared by
-  // the netlist module declaration, which may be different from the order of
-  // Module::inputs().  For example:
-  //
-  //  module ifte(i, t, e, out);
-  //    input [7:0] e;
-  //    input i;
-  //    output [7:0] out;
-  //    input [7:0] t;
-  //
-  // The values of --inputs should follow the module declaration, which would
-  // also follow the declaration of the source language (e.g. C++ or XLS).
-
-  Bits input_bits;
-  for (const auto& input_string : inputs) {
-    XLS_ASSIGN_OR_RETURN(Value input, Parser::ParseTypedValue(input_string));
-    Bits flat_value = FlattenValueToBits(input);
-    input_bits = bits_ops::Concat({input_bits, flat_value});
-  }
-  input_bits = bits_ops::Reverse(input_bits);
-
-  netlist::NetRef2Value input_nets;
   const std::vector<netlist::rtl::NetRef>& module_inputs = module->inputs();
-  XLS_RET_CHECK(module_inputs.size() == input_bits.bit_count());
+  XLS_ASSIGN_OR_RETURN(Bits input_bits,
+                       GetInputBits(inputs, module_inputs.size()));
 
+  netlist::NetRef2Value input_nets;
   for (int i = 0; i < module->inputs().size(); i++) {
     const netlist::rtl::NetRef in = module_inputs[i];
     input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
@@ -132,19 +264,7 @@ absl::Status RealMain(const std::string& netlist_path,
   for (const netlist::rtl::NetRef ref : module->outputs()) {
     rope.push_back(output_nets[ref]);
   }
-  Bits output_bits = rope.Build();
-
-  Value output;
-  if (!output_type_string.empty()) {
-    // This is a disposable package - it only exists to hold the type below.
-    Package package("foo");
-    XLS_ASSIGN_OR_RETURN(Type * output_type,
-                         Parser::ParseType(output_type_string, &package));
-    XLS_ASSIGN_OR_RETURN(output,
-                         UnflattenBitsToValue(output_bits, output_type));
-  } else {
-    output = Value(output_bits);
-  }
+  XLS_ASSIGN_OR_RETURN(Value output, GetOutputValue(rope.Build(), output_type));
 
   std::cout << output.ToString(FormatPreference::kHex) << std::endl;
   return absl::OkStatus();
@@ -168,8 +288,13 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(!module_name.empty()) << "--module_name must be specified.";
 
   std::string input = absl::GetFlag(FLAGS_input);
-  XLS_QCHECK(!input.empty()) << "--input must be specified.";
-  std::vector<std::string> inputs = absl::StrSplit(input, ';');
+  std::string input_file = absl::GetFlag(FLAGS_input_file);
+  XLS_QCHECK(!input.empty() ^ !input_file.empty())
+      << "One (and only one) of --input or --input_file must be specified.";
+  std::vector<std::string> inputs;
+  if (!input.empty()) {
+    inputs = absl::StrSplit(input, ';');
+  }
 
   std::string dump_cells_str = absl::GetFlag(FLAGS_dump_cells);
   std::vector<std::string> dump_cells = absl::StrSplit(dump_cells_str, ',');
@@ -178,7 +303,7 @@ int main(int argc, char* argv[]) {
 
   XLS_QCHECK_OK(xls::RealMain(netlist_path, cell_library_path,
                               cell_library_proto_path, module_name, inputs,
-                              output_type, dump_cells));
+                              input_file, output_type, dump_cells));
 
   return 0;
 }
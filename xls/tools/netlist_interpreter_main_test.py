@@ -14,6 +14,7 @@
 # limitations under the License.
 """Tests for xls.tools.netlist_interpreter_main."""
 
+import math
 import subprocess
 
 from xls.common import runfiles
@@ -25,11 +26,15 @@ NETLIST_INTERPRETER_MAIN = runfiles.get_path(XLS_TOOLS +
 CELL_LIBRARY = runfiles.get_path(XLS_TOOLS + 'testdata/simple_cell.lib')
 
 
-def run_netlist_interpreter(netlist, module, input_data, output_type):
+def run_netlist_interpreter(netlist,
+                            module,
+                            input_data,
+                            output_type,
+                            input_flag='--input='):
   result = subprocess.check_output([
       NETLIST_INTERPRETER_MAIN,
       '--netlist=' + runfiles.get_path(XLS_TOOLS + netlist),
-      '--module_name=' + module, '--input=' + input_data,
+      '--module_name=' + module, input_flag + input_data,
       '--output_type=' + output_type, '--cell_library=' + CELL_LIBRARY
   ])
   return result.decode('utf-8').strip()
@@ -48,6 +53,21 @@ class NetlistTranspilerMainTest(test_base.TestCase):
                                   'bits[8]')
     self.assertEqual(res, 'bits[8]:0xaa')
 
+  def test_sqrt_input_file(self):
+    # More inputs than lanes in a single bit-parallel evaluation.
+    values = list(range(0, 1000, 7))
+    input_file = self.create_tempfile(
+        content=''.join('bits[16]:{}\n'.format(v) for v in values))
+    res = run_netlist_interpreter(
+        'testdata/sqrt.v',
+        'isqrt',
+        input_file.full_path,
+        'bits[8]',
+        input_flag='--input_file=')
+    self.assertEqual(
+        res.splitlines(),
+        ['bits[8]:{:#x}'.format(math.isqrt(v)) for v in values])
+
 
 if __name__ == '__main__':
   test_base.main()
@@ -24,7 +24,8 @@
 namespace xls::tools {
 
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
-                                             const OptOptions& options) {
+                                             const OptOptions& options,
+                                             PassResults* results) {
   if (!options.top.empty()) {
     XLS_VLOG(3) << "OptimizeIrForEntry; top: '" << options.top
                 << "'; opt_level: " << options.opt_level;
@@ -33,7 +34,8 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
   }
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(ir, options.ir_path));
+                       Parser::ParsePackage(ir, options.ir_path,
+                                            options.parse_threads));
   if (!options.top.empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(options.top));
   }
@@ -50,15 +52,27 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
       .run_only_passes = options.run_only_passes,
       .skip_passes = options.skip_passes,
       .inline_procs = options.inline_procs,
+      .defer_proc_inlining = options.defer_proc_inlining,
       .convert_array_index_to_select = options.convert_array_index_to_select,
+      .function_pass_threads = options.function_pass_threads,
+      .inlining_node_budget = options.inlining_node_budget,
+      .bottom_up_optimization = options.bottom_up_optimization,
+      .memoize_bottom_up_optimization = options.memoize_bottom_up_optimization,
+      .loop_unroll_factor = options.loop_unroll_factor,
+      .narrowing_worklist = options.narrowing_worklist,
+      .mutual_exclusion_threads = options.mutual_exclusion_threads,
+      .mutual_exclusion_time_budget = options.mutual_exclusion_time_budget,
   };
-  PassResults results;
+  PassResults local_results;
+  if (results == nullptr) {
+    results = &local_results;
+  }
   XLS_RETURN_IF_ERROR(
-      pipeline->Run(package.get(), pass_options, &results).status());
+      pipeline->Run(package.get(), pass_options, results).status());
   // If opt returns something that obviously can't be codegenned, that's a bug
   // in opt, not codegen.
   XLS_RETURN_IF_ERROR(xls::VerifyPackage(package.get(), /*codegen=*/true));
-  return package->DumpIr();
+  return DumpPackage(package.get(), options.output_ir_format);
 }
 
 }  // namespace xls::tools
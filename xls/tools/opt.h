@@ -23,6 +23,8 @@
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "xls/ir/binary_ir.h"
 
 // TODO(meheff): 2021-10-04 Remove this header.
 #include "xls/passes/passes.h"
@@ -40,13 +42,27 @@ struct OptOptions {
   std::vector<std::string> skip_passes;
   std::optional<int64_t> convert_array_index_to_select = std::nullopt;
   bool inline_procs;
+  bool defer_proc_inlining = false;
+  int64_t function_pass_threads = 1;
+  std::optional<int64_t> inlining_node_budget = std::nullopt;
+  bool bottom_up_optimization = false;
+  bool memoize_bottom_up_optimization = false;
+  std::optional<int64_t> loop_unroll_factor = std::nullopt;
+  bool narrowing_worklist = false;
+  int64_t mutual_exclusion_threads = 1;
+  std::optional<absl::Duration> mutual_exclusion_time_budget = std::nullopt;
+  int64_t parse_threads = 1;
+  IrFormat output_ir_format = IrFormat::kText;
 };
 
 // Helper used in the opt_main tool, optimizes the given IR for a particular
 // top-level entity (e.g., function, proc, etc) at the given opt level and
-// returns the resulting optimized IR.
+// returns the resulting optimized IR in the format given by
+// `options.output_ir_format`. If `results` is non-null, the results of
+// the pass pipeline (e.g., per-pass timing) are written to it.
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
-                                             const OptOptions& options);
+                                             const OptOptions& options,
+                                             PassResults* results = nullptr);
 
 }  // namespace xls::tools
 
@@ -17,15 +17,19 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/passes/pass_metrics.h"
 #include "xls/passes/passes.h"
 #include "xls/passes/standard_pipeline.h"
 #include "xls/tools/opt.h"
+#include "xls/tools/tool_server.h"
 
 const char kUsage[] = R"(
 Takes in an IR file and produces an IR file that has been run through the
@@ -40,6 +44,9 @@ where:
 
 Example invocation:
   opt_main path/to/file.ir
+
+With --serve_on_socket, runs as a server for invocations sent with
+tool_client_main instead.
 )";
 
 // LINT.IfChange
@@ -64,6 +71,51 @@ ABSL_FLAG(int64_t, opt_level, xls::kMaxOptLevel,
                           xls::kMaxOptLevel));
 ABSL_FLAG(bool, inline_procs, false,
           "Whether to inline all procs by calling the proc inlining pass. ");
+ABSL_FLAG(bool, defer_proc_inlining, false,
+          "If --inline_procs is set, inline the procs late in the pipeline "
+          "after optimizing each proc separately.");
+ABSL_FLAG(int64_t, function_pass_threads, 1,
+          "Number of threads used to run function-local passes concurrently "
+          "over the functions and procs of the package. Node ids of nodes "
+          "created by these passes may differ between runs if greater than "
+          "one.");
+ABSL_FLAG(int64_t, inlining_node_budget, -1,
+          "If non-negative, functions are only inlined early in the pipeline "
+          "if inlining all of their call sites adds at most this many nodes. "
+          "Other functions are kept separate and optimized on their own "
+          "before being inlined later in the pipeline. Otherwise all "
+          "functions are inlined early.");
+ABSL_FLAG(bool, bottom_up_optimization, false,
+          "Whether to optimize each invoked function on its own, callees "
+          "before callers, before it is inlined into its call sites.");
+ABSL_FLAG(bool, memoize_bottom_up_optimization, false,
+          "Whether bottom-up optimization redirects invokes of structurally "
+          "identical functions to one of them so it is only optimized once.");
+ABSL_FLAG(int64_t, loop_unroll_factor, -1,
+          "If non-negative, counted_for loops with a trip count greater than "
+          "this are partially unrolled into a loop performing this many trips "
+          "per iteration. Otherwise loops are fully unrolled.");
+ABSL_FLAG(bool, narrowing_worklist, false,
+          "Whether the narrowing pass revisits only the nodes affected by its "
+          "previous sweep, iterating to a fixed point on its own.");
+ABSL_FLAG(int64_t, mutual_exclusion_threads, 1,
+          "Number of threads used by the mutual exclusion pass to run the "
+          "solver queries of a single proc.");
+ABSL_FLAG(int64_t, mutual_exclusion_time_budget_ms, -1,
+          "If non-negative, the total time in milliseconds the mutual "
+          "exclusion pass may spend in the solver on a single proc. Channel "
+          "operations not proven mutually exclusive within the budget are not "
+          "merged.");
+ABSL_FLAG(int64_t, parse_threads, 1,
+          "Number of threads used to parse the functions, procs and blocks of "
+          "the input IR concurrently.");
+ABSL_FLAG(std::string, pass_metrics_proto, "",
+          "If specified, write per-pass metrics (run time, invocation and "
+          "change counts, and node count deltas) as a PipelineMetricsProto in "
+          "text format to this file.");
+ABSL_FLAG(std::string, output_ir_format, "text",
+          "Format of the optimized IR: `text` or `binary`. The binary format "
+          "is faster to load but is not stable across XLS versions.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls::tools {
@@ -80,6 +132,13 @@ absl::Status RealMain(std::string_view input_path) {
       absl::GetFlag(FLAGS_run_only_passes);
   int64_t convert_array_index_to_select =
       absl::GetFlag(FLAGS_convert_array_index_to_select);
+  int64_t inlining_node_budget = absl::GetFlag(FLAGS_inlining_node_budget);
+  int64_t loop_unroll_factor = absl::GetFlag(FLAGS_loop_unroll_factor);
+  int64_t mutual_exclusion_time_budget_ms =
+      absl::GetFlag(FLAGS_mutual_exclusion_time_budget_ms);
+  XLS_ASSIGN_OR_RETURN(
+      IrFormat output_ir_format,
+      IrFormatFromString(absl::GetFlag(FLAGS_output_ir_format)));
   const OptOptions options = {
       .opt_level = absl::GetFlag(FLAGS_opt_level),
       .top = top,
@@ -93,10 +152,36 @@ absl::Status RealMain(std::string_view input_path) {
               ? std::nullopt
               : std::make_optional(convert_array_index_to_select),
       .inline_procs = absl::GetFlag(FLAGS_inline_procs),
+      .defer_proc_inlining = absl::GetFlag(FLAGS_defer_proc_inlining),
+      .function_pass_threads = absl::GetFlag(FLAGS_function_pass_threads),
+      .inlining_node_budget = (inlining_node_budget < 0)
+                                  ? std::nullopt
+                                  : std::make_optional(inlining_node_budget),
+      .bottom_up_optimization = absl::GetFlag(FLAGS_bottom_up_optimization),
+      .memoize_bottom_up_optimization =
+          absl::GetFlag(FLAGS_memoize_bottom_up_optimization),
+      .loop_unroll_factor = (loop_unroll_factor < 0)
+                                ? std::nullopt
+                                : std::make_optional(loop_unroll_factor),
+      .narrowing_worklist = absl::GetFlag(FLAGS_narrowing_worklist),
+      .mutual_exclusion_threads = absl::GetFlag(FLAGS_mutual_exclusion_threads),
+      .mutual_exclusion_time_budget =
+          (mutual_exclusion_time_budget_ms < 0)
+              ? std::nullopt
+              : std::make_optional(
+                    absl::Milliseconds(mutual_exclusion_time_budget_ms)),
+      .parse_threads = absl::GetFlag(FLAGS_parse_threads),
+      .output_ir_format = output_ir_format,
   };
+  PassResults results;
   XLS_ASSIGN_OR_RETURN(std::string opt_ir,
-                       tools::OptimizeIrForTop(ir, options));
+                       tools::OptimizeIrForTop(ir, options, &results));
   std::cout << opt_ir;
+  std::string pass_metrics_path = absl::GetFlag(FLAGS_pass_metrics_proto);
+  if (!pass_metrics_path.empty()) {
+    XLS_RETURN_IF_ERROR(
+        SetTextProtoFile(pass_metrics_path, SummarizePassResults(results)));
+  }
   return absl::OkStatus();
 }
 
@@ -107,6 +192,20 @@ int main(int argc, char **argv) {
   std::vector<std::string_view> positional_arguments =
       xls::InitXls(kUsage, argc, argv);
 
+  std::string serve_on_socket = absl::GetFlag(FLAGS_serve_on_socket);
+  if (!serve_on_socket.empty()) {
+    XLS_QCHECK_OK(xls::tools::ServeToolInvocations(
+        serve_on_socket,
+        [](absl::Span<const std::string_view> args) -> absl::Status {
+          if (args.empty()) {
+            return absl::InvalidArgumentError(
+                "Expected invocation: opt_main <path>");
+          }
+          return xls::tools::RealMain(args[0]);
+        }));
+    return EXIT_SUCCESS;
+  }
+
   if (positional_arguments.empty()) {
     XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <path>",
                                           argv[0]);
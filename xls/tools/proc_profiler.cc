@@ -0,0 +1,339 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/proc_profiler.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/interpreter/proc_network_interpreter.h"
+
+namespace xls {
+namespace {
+
+// What a proc did so far in the current tick of the network. A proc may be
+// run more than once in a tick if it is unblocked by a send of another proc.
+struct ProcTickState {
+  bool progress_made = false;
+  bool tick_complete = false;
+  Channel* blocked_channel = nullptr;
+};
+
+// Mutable state shared by the profiling evaluators of all procs.
+struct ProfileRecorder {
+  ProcNetworkProfile* profile;
+  ChannelQueueManager* queue_manager;
+  absl::flat_hash_map<Channel*, ChannelProfile*> channel_profiles;
+  std::vector<ProcTickState> current;
+  // Whether an evaluator returned an error in the current tick.
+  bool evaluator_error = false;
+};
+
+// A proc evaluator which records the result of each tick of the wrapped
+// evaluator.
+class ProfilingProcEvaluator : public ProcEvaluator {
+ public:
+  ProfilingProcEvaluator(std::unique_ptr<ProcEvaluator> evaluator,
+                         int64_t proc_index, ProfileRecorder* recorder)
+      : evaluator_(std::move(evaluator)),
+        proc_index_(proc_index),
+        recorder_(recorder) {}
+
+  std::unique_ptr<ProcContinuation> NewContinuation() const override {
+    return evaluator_->NewContinuation();
+  }
+
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override {
+    absl::StatusOr<TickResult> tick_result = evaluator_->Tick(continuation);
+    if (!tick_result.ok()) {
+      recorder_->evaluator_error = true;
+      return tick_result.status();
+    }
+    ProcTickState& state = recorder_->current[proc_index_];
+    state.progress_made |= tick_result->progress_made;
+    state.tick_complete = tick_result->tick_complete;
+    state.blocked_channel = tick_result->blocked_channel.value_or(nullptr);
+
+    int64_t tick = recorder_->profile->ticks;
+    for (Channel* channel : tick_result->sent_channels) {
+      ChannelProfile* channel_profile =
+          recorder_->channel_profiles.at(channel);
+      ++channel_profile->sends;
+      if (!channel_profile->first_send_tick.has_value()) {
+        channel_profile->first_send_tick = tick;
+      }
+      channel_profile->last_send_tick = tick;
+      channel_profile->max_occupancy =
+          std::max(channel_profile->max_occupancy,
+                   recorder_->queue_manager->GetQueue(channel).GetSize());
+    }
+    return tick_result;
+  }
+
+  Proc* proc() const override { return evaluator_->proc(); }
+
+ private:
+  std::unique_ptr<ProcEvaluator> evaluator_;
+  int64_t proc_index_;
+  ProfileRecorder* recorder_;
+};
+
+std::string JsonString(std::string_view s) {
+  return absl::StrCat("\"", absl::CEscape(s), "\"");
+}
+
+}  // namespace
+
+double ProcProfile::Utilization() const {
+  if (activity.empty()) {
+    return 0.0;
+  }
+  return static_cast<double>(iterations) / activity.size();
+}
+
+double ChannelProfile::MeanOccupancy() const {
+  if (occupancy.empty()) {
+    return 0.0;
+  }
+  int64_t total = 0;
+  for (int64_t o : occupancy) {
+    total += o;
+  }
+  return static_cast<double>(total) / occupancy.size();
+}
+
+std::optional<double> ChannelProfile::SustainedThroughput() const {
+  if (sends < 2) {
+    return std::nullopt;
+  }
+  return static_cast<double>(sends - 1) /
+         std::max<int64_t>(last_send_tick.value() - first_send_tick.value(),
+                           1);
+}
+
+std::string ProcNetworkProfile::ToString() const {
+  std::string result =
+      absl::StrFormat("Proc network profile of package %s: %d ticks\n",
+                      package->name(), ticks);
+  absl::StrAppend(&result, "Procs:\n");
+  for (const ProcProfile& proc_profile : procs) {
+    // Find the channel the proc was most often blocked on.
+    absl::flat_hash_map<Channel*, int64_t> blocked_counts;
+    for (Channel* channel : proc_profile.blocked_channel) {
+      if (channel != nullptr) {
+        ++blocked_counts[channel];
+      }
+    }
+    Channel* top_channel = nullptr;
+    int64_t top_count = 0;
+    for (auto [channel, count] : blocked_counts) {
+      if (count > top_count ||
+          (count == top_count && channel->id() < top_channel->id())) {
+        top_channel = channel;
+        top_count = count;
+      }
+    }
+    int64_t blocked_ticks =
+        static_cast<int64_t>(proc_profile.activity.size()) -
+        proc_profile.iterations;
+    absl::StrAppendFormat(
+        &result, "  %s: iterations=%d, utilization=%.1f%%, blocked_ticks=%d",
+        proc_profile.proc->name(), proc_profile.iterations,
+        100.0 * proc_profile.Utilization(), blocked_ticks);
+    if (top_channel != nullptr) {
+      absl::StrAppendFormat(&result, " (mostly on %s)", top_channel->name());
+    }
+    absl::StrAppend(&result, "\n");
+  }
+  absl::StrAppend(&result, "Channels:\n");
+  for (const ChannelProfile& channel_profile : channels) {
+    std::optional<double> throughput = channel_profile.SustainedThroughput();
+    absl::StrAppendFormat(
+        &result,
+        "  %s: sends=%d, first_send_tick=%s, sustained_throughput=%s/tick, "
+        "max_occupancy=%d, mean_occupancy=%.2f, stall_ticks=%d\n",
+        channel_profile.channel->name(), channel_profile.sends,
+        channel_profile.first_send_tick.has_value()
+            ? absl::StrCat(channel_profile.first_send_tick.value())
+            : "-",
+        throughput.has_value() ? absl::StrFormat("%.3f", throughput.value())
+                               : "-",
+        channel_profile.max_occupancy, channel_profile.MeanOccupancy(),
+        channel_profile.stall_ticks);
+  }
+  return result;
+}
+
+std::string ProcNetworkProfile::ToChromeTrace() const {
+  std::vector<std::string> events;
+  events.push_back(absl::StrFormat(
+      R"({"name": "process_name", "ph": "M", "pid": 0, "args": {"name": %s}})",
+      JsonString(package->name())));
+  for (int64_t tid = 0; tid < procs.size(); ++tid) {
+    const ProcProfile& proc_profile = procs[tid];
+    events.push_back(absl::StrFormat(
+        R"({"name": "thread_name", "ph": "M", "pid": 0, "tid": %d, )"
+        R"("args": {"name": %s}})",
+        tid, JsonString(proc_profile.proc->name())));
+    // Emit one span for each run of ticks with the same activity.
+    int64_t start = 0;
+    for (int64_t t = 1; t <= proc_profile.activity.size(); ++t) {
+      if (t < proc_profile.activity.size() &&
+          proc_profile.activity[t] == proc_profile.activity[start] &&
+          proc_profile.blocked_channel[t] ==
+              proc_profile.blocked_channel[start]) {
+        continue;
+      }
+      std::string name;
+      switch (proc_profile.activity[start]) {
+        case ProcActivity::kComplete:
+          name = "iteration";
+          break;
+        case ProcActivity::kPartial:
+          name = absl::StrCat("partial, blocked on ",
+                              proc_profile.blocked_channel[start]->name());
+          break;
+        case ProcActivity::kBlocked:
+          name = absl::StrCat("blocked on ",
+                              proc_profile.blocked_channel[start]->name());
+          break;
+      }
+      events.push_back(absl::StrFormat(
+          R"({"name": %s, "cat": "proc", "ph": "X", "ts": %d, "dur": %d, )"
+          R"("pid": 0, "tid": %d, "args": {"ticks": %d}})",
+          JsonString(name), start, t - start, tid, t - start));
+      start = t;
+    }
+  }
+  for (const ChannelProfile& channel_profile : channels) {
+    // Emit a counter event only when the occupancy changes.
+    for (int64_t t = 0; t < channel_profile.occupancy.size(); ++t) {
+      if (t > 0 &&
+          channel_profile.occupancy[t] == channel_profile.occupancy[t - 1]) {
+        continue;
+      }
+      events.push_back(absl::StrFormat(
+          R"({"name": %s, "cat": "channel", "ph": "C", "ts": %d, "pid": 0, )"
+          R"("args": {"occupancy": %d}})",
+          JsonString(channel_profile.channel->name()), t,
+          channel_profile.occupancy[t]));
+    }
+  }
+  return absl::StrCat("{\"traceEvents\": [\n  ",
+                      absl::StrJoin(events, ",\n  "), "\n]}\n");
+}
+
+absl::StatusOr<ProcNetworkProfile> ProfileProcNetwork(
+    Package* package, const ProcProfilerOptions& options) {
+  XLS_RET_CHECK_GT(options.max_ticks, 0);
+  ProcNetworkProfile profile{.package = package};
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    profile.procs.push_back(ProcProfile{.proc = proc.get()});
+  }
+  for (Channel* channel : package->channels()) {
+    profile.channels.push_back(ChannelProfile{.channel = channel});
+  }
+  std::sort(profile.channels.begin(), profile.channels.end(),
+            [](const ChannelProfile& a, const ChannelProfile& b) {
+              return a.channel->id() < b.channel->id();
+            });
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
+                       ChannelQueueManager::Create(package));
+  ProfileRecorder recorder{.profile = &profile,
+                           .queue_manager = queue_manager.get()};
+  for (ChannelProfile& channel_profile : profile.channels) {
+    recorder.channel_profiles[channel_profile.channel] = &channel_profile;
+  }
+
+  std::vector<std::unique_ptr<ProcEvaluator>> evaluators;
+  for (int64_t i = 0; i < package->procs().size(); ++i) {
+    evaluators.push_back(std::make_unique<ProfilingProcEvaluator>(
+        std::make_unique<ProcInterpreter>(package->procs()[i].get(),
+                                          queue_manager.get()),
+        i, &recorder));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ProcNetworkInterpreter> network,
+      ProcNetworkInterpreter::Create(package, std::move(evaluators),
+                                     std::move(queue_manager)));
+
+  ChannelQueueManager& queues = network->queue_manager();
+  for (Channel* channel : package->channels()) {
+    for (const Value& value : channel->initial_values()) {
+      XLS_RETURN_IF_ERROR(queues.GetQueue(channel).Write(value));
+    }
+  }
+  for (const auto& [name, values] : options.inputs) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue, queues.GetQueueByName(name));
+    if (queue->channel()->supported_ops() != ChannelOps::kReceiveOnly) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Inputs given for channel `%s` which is not receive-only", name));
+    }
+    for (const Value& value : values) {
+      XLS_RETURN_IF_ERROR(queue->Write(value));
+    }
+  }
+
+  while (profile.ticks < options.max_ticks) {
+    recorder.current.assign(profile.procs.size(), ProcTickState());
+    absl::Status status = network->Tick();
+    if (!status.ok()) {
+      bool progress_made = std::any_of(
+          recorder.current.begin(), recorder.current.end(),
+          [](const ProcTickState& s) { return s.progress_made; });
+      if (recorder.evaluator_error || progress_made) {
+        return status;
+      }
+      // No proc made progress so the network is blocked.
+      break;
+    }
+
+    for (int64_t i = 0; i < profile.procs.size(); ++i) {
+      const ProcTickState& state = recorder.current[i];
+      ProcProfile& proc_profile = profile.procs[i];
+      if (state.tick_complete) {
+        ++proc_profile.iterations;
+        proc_profile.activity.push_back(ProcActivity::kComplete);
+        proc_profile.blocked_channel.push_back(nullptr);
+        continue;
+      }
+      proc_profile.activity.push_back(state.progress_made
+                                          ? ProcActivity::kPartial
+                                          : ProcActivity::kBlocked);
+      proc_profile.blocked_channel.push_back(state.blocked_channel);
+      if (state.blocked_channel != nullptr) {
+        ++recorder.channel_profiles.at(state.blocked_channel)->stall_ticks;
+      }
+    }
+    for (ChannelProfile& channel_profile : profile.channels) {
+      channel_profile.occupancy.push_back(
+          queues.GetQueue(channel_profile.channel).GetSize());
+    }
+    ++profile.ticks;
+  }
+  return profile;
+}
+
+}  // namespace xls
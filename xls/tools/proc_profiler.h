@@ -0,0 +1,118 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_PROC_PROFILER_H_
+#define XLS_TOOLS_PROC_PROFILER_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+struct ProcProfilerOptions {
+  // Values fed into each receive-only channel, keyed by channel name.
+  absl::flat_hash_map<std::string, std::vector<Value>> inputs;
+
+  // Maximum number of ticks of the proc network. The network is run until it
+  // blocks or this many ticks have been executed.
+  int64_t max_ticks = 100000;
+};
+
+// What a proc did in a single tick of the proc network.
+enum class ProcActivity : int8_t {
+  // The proc completed an iteration.
+  kComplete,
+  // The proc executed part of an iteration and is blocked on a receive.
+  kPartial,
+  // The proc made no progress because it is blocked on a receive.
+  kBlocked,
+};
+
+struct ProcProfile {
+  Proc* proc;
+
+  // Number of completed iterations.
+  int64_t iterations = 0;
+
+  // Activity of the proc in each tick and, for ticks which are not complete,
+  // the channel the proc is blocked on.
+  std::vector<ProcActivity> activity;
+  std::vector<Channel*> blocked_channel;
+
+  // Fraction of ticks in which the proc completed an iteration.
+  double Utilization() const;
+};
+
+struct ChannelProfile {
+  Channel* channel;
+
+  // Number of values sent on the channel.
+  int64_t sends = 0;
+
+  // Ticks of the first and last send on the channel, if any.
+  std::optional<int64_t> first_send_tick;
+  std::optional<int64_t> last_send_tick;
+
+  // Maximum number of values held by the channel at any point, and the number
+  // of values held at the end of each tick.
+  int64_t max_occupancy = 0;
+  std::vector<int64_t> occupancy;
+
+  // Number of ticks in which a proc was blocked receiving on the channel.
+  int64_t stall_ticks = 0;
+
+  double MeanOccupancy() const;
+
+  // Values sent per tick between the first and the last send. This is the
+  // sustained throughput of the channel once its producer has filled up.
+  std::optional<double> SustainedThroughput() const;
+};
+
+// Activity of a proc network recorded tick by tick.
+struct ProcNetworkProfile {
+  Package* package;
+  int64_t ticks = 0;
+
+  // Profiles of the procs in package order and of the channels in id order.
+  std::vector<ProcProfile> procs;
+  std::vector<ChannelProfile> channels;
+
+  // Returns a human-readable summary of the profile.
+  std::string ToString() const;
+
+  // Returns the profile as a Chrome trace-event JSON document which may be
+  // viewed with chrome://tracing or Perfetto. Each proc is a thread whose
+  // timeline shows spans of completed iterations and of ticks spent blocked,
+  // and the occupancy of each channel is a counter. One tick of the network
+  // is shown as one microsecond.
+  std::string ToChromeTrace() const;
+};
+
+// Runs the proc network in `package` with the proc network interpreter on the
+// given inputs and records the activity of each proc and channel in each tick.
+absl::StatusOr<ProcNetworkProfile> ProfileProcNetwork(
+    Package* package, const ProcProfilerOptions& options);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_PROC_PROFILER_H_
@@ -0,0 +1,135 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tool to profile the throughput of a proc network and the utilization of its
+// procs and channels.
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/tools/proc_profiler.h"
+
+const char kUsage[] = R"(
+Runs a proc network with the IR interpreter on the given (or random) inputs
+until it blocks and prints a summary of the utilization of each proc and the
+throughput, occupancy and stalls of each channel. Optionally writes a Chrome
+trace-event timeline of the activity of each proc and the occupancy of each
+channel which may be viewed with chrome://tracing or Perfetto.
+
+Example invocation:
+
+  proc_profiler_main --inputs_for_channels=in=/tmp/in.txt \
+    --trace_path=/tmp/trace.json IR_FILE
+)";
+
+ABSL_FLAG(
+    std::vector<std::string>, inputs_for_channels, {},
+    "Comma separated list of channel=filename pairs, for example: ch_a=foo.ir. "
+    "Files contain one XLS Value in human-readable form per line.");
+ABSL_FLAG(int64_t, random_inputs, 256,
+          "Number of random values fed into each receive-only channel which "
+          "has no inputs given by --inputs_for_channels.");
+ABSL_FLAG(int64_t, random_seed, 42, "Seed of the random inputs.");
+ABSL_FLAG(int64_t, max_ticks, 100000,
+          "Maximum number of ticks of the proc network.");
+ABSL_FLAG(std::string, trace_path, "",
+          "If given, a Chrome trace-event JSON timeline of the proc network is "
+          "written to this path.");
+
+namespace xls {
+namespace {
+
+absl::StatusOr<std::vector<Value>> ParseValuesFile(std::string_view filename) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(filename));
+  std::vector<Value> values;
+  for (std::string_view line :
+       absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
+    XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(line));
+    values.push_back(value);
+  }
+  return values;
+}
+
+absl::Status RealMain(std::string_view ir_path) {
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, ir_path));
+
+  ProcProfilerOptions options;
+  options.max_ticks = absl::GetFlag(FLAGS_max_ticks);
+  for (const std::string& pair : absl::GetFlag(FLAGS_inputs_for_channels)) {
+    std::vector<std::string> split = absl::StrSplit(pair, '=');
+    if (split.size() != 2) {
+      return absl::InvalidArgumentError(
+          "Format of argument should be channel=file");
+    }
+    XLS_ASSIGN_OR_RETURN(options.inputs[split[0]], ParseValuesFile(split[1]));
+  }
+  std::minstd_rand engine(absl::GetFlag(FLAGS_random_seed));
+  for (Channel* channel : package->channels()) {
+    if (channel->supported_ops() != ChannelOps::kReceiveOnly ||
+        options.inputs.contains(channel->name())) {
+      continue;
+    }
+    // Single-value channels hold one value for the whole simulation.
+    int64_t count = channel->kind() == ChannelKind::kSingleValue
+                        ? 1
+                        : absl::GetFlag(FLAGS_random_inputs);
+    std::vector<Value>& values = options.inputs[channel->name()];
+    for (int64_t i = 0; i < count; ++i) {
+      values.push_back(RandomValue(channel->type(), &engine));
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(ProcNetworkProfile profile,
+                       ProfileProcNetwork(package.get(), options));
+  std::cout << profile.ToString();
+
+  if (!absl::GetFlag(FLAGS_trace_path).empty()) {
+    XLS_RETURN_IF_ERROR(SetFileContents(absl::GetFlag(FLAGS_trace_path),
+                                        profile.ToChromeTrace()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s IR_FILE",
+                                          argv[0]);
+  }
+
+  XLS_QCHECK_OK(xls::RealMain(positional_arguments[0]));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/proc_profiler.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+class ProcProfilerTest : public IrTestBase {
+ protected:
+  // Returns `count` sequential U32 values.
+  static std::vector<Value> Iota(int64_t count) {
+    std::vector<Value> values;
+    for (int64_t i = 0; i < count; ++i) {
+      values.push_back(Value(UBits(i, 32)));
+    }
+    return values;
+  }
+};
+
+// Creates a proc which passes through a received value to a send each tick.
+absl::StatusOr<Proc*> CreatePassThroughProc(std::string_view proc_name,
+                                            Channel* in_channel,
+                                            Channel* out_channel,
+                                            Package* package) {
+  ProcBuilder pb(proc_name, /*token_name=*/"tok", package);
+  BValue token_input = pb.Receive(in_channel, pb.GetTokenParam());
+  BValue send_token = pb.Send(out_channel, pb.TupleIndex(token_input, 0),
+                              pb.TupleIndex(token_input, 1));
+  return pb.Build(send_token, {});
+}
+
+TEST_F(ProcProfilerTest, PassThroughPipeline) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in, p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                              p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * mid, p->CreateStreamingChannel("mid", ChannelOps::kSendReceive,
+                                               p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  XLS_ASSERT_OK(CreatePassThroughProc("first", in, mid, p.get()).status());
+  XLS_ASSERT_OK(CreatePassThroughProc("second", mid, out, p.get()).status());
+
+  ProcProfilerOptions options;
+  options.inputs["in"] = Iota(10);
+  XLS_ASSERT_OK_AND_ASSIGN(ProcNetworkProfile profile,
+                           ProfileProcNetwork(p.get(), options));
+  EXPECT_EQ(profile.ticks, 10);
+  ASSERT_EQ(profile.procs.size(), 2);
+  for (const ProcProfile& proc_profile : profile.procs) {
+    EXPECT_EQ(proc_profile.iterations, 10);
+    EXPECT_DOUBLE_EQ(proc_profile.Utilization(), 1.0);
+  }
+
+  ASSERT_EQ(profile.channels.size(), 3);
+  const ChannelProfile& mid_profile = profile.channels[1];
+  EXPECT_EQ(mid_profile.channel, mid);
+  EXPECT_EQ(mid_profile.sends, 10);
+  EXPECT_EQ(mid_profile.max_occupancy, 1);
+  EXPECT_EQ(mid_profile.stall_ticks, 0);
+  EXPECT_DOUBLE_EQ(mid_profile.MeanOccupancy(), 0.0);
+
+  const ChannelProfile& out_profile = profile.channels[2];
+  EXPECT_EQ(out_profile.channel, out);
+  EXPECT_EQ(out_profile.sends, 10);
+  EXPECT_THAT(out_profile.first_send_tick, Optional(0));
+  EXPECT_THAT(out_profile.SustainedThroughput(), Optional(1.0));
+
+  std::string trace = profile.ToChromeTrace();
+  EXPECT_THAT(trace, HasSubstr("\"traceEvents\""));
+  EXPECT_THAT(trace, HasSubstr("\"name\": \"second\""));
+  EXPECT_THAT(trace, HasSubstr("\"name\": \"iteration\""));
+}
+
+TEST_F(ProcProfilerTest, StarvedJoin) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * a, p->CreateStreamingChannel("a", ChannelOps::kReceiveOnly,
+                                             p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * b, p->CreateStreamingChannel("b", ChannelOps::kReceiveOnly,
+                                             p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  ProcBuilder pb("join", /*token_name=*/"tok", p.get());
+  BValue recv_a = pb.Receive(a, pb.GetTokenParam());
+  BValue recv_b = pb.Receive(b, pb.TupleIndex(recv_a, 0));
+  BValue send =
+      pb.Send(out, pb.TupleIndex(recv_b, 0),
+              pb.Add(pb.TupleIndex(recv_a, 1), pb.TupleIndex(recv_b, 1)));
+  XLS_ASSERT_OK(pb.Build(send, {}).status());
+
+  // The fourth iteration receives from `a` and then blocks on `b` forever.
+  ProcProfilerOptions options;
+  options.inputs["a"] = Iota(5);
+  options.inputs["b"] = Iota(3);
+  XLS_ASSERT_OK_AND_ASSIGN(ProcNetworkProfile profile,
+                           ProfileProcNetwork(p.get(), options));
+  EXPECT_EQ(profile.ticks, 4);
+  ASSERT_EQ(profile.procs.size(), 1);
+  const ProcProfile& join_profile = profile.procs[0];
+  EXPECT_EQ(join_profile.iterations, 3);
+  EXPECT_DOUBLE_EQ(join_profile.Utilization(), 0.75);
+  EXPECT_THAT(join_profile.activity,
+              ElementsAre(ProcActivity::kComplete, ProcActivity::kComplete,
+                          ProcActivity::kComplete, ProcActivity::kPartial));
+  EXPECT_THAT(join_profile.blocked_channel,
+              ElementsAre(nullptr, nullptr, nullptr, b));
+
+  ASSERT_EQ(profile.channels.size(), 3);
+  EXPECT_EQ(profile.channels[1].channel, b);
+  EXPECT_EQ(profile.channels[1].stall_ticks, 1);
+  EXPECT_EQ(profile.channels[2].sends, 3);
+
+  EXPECT_THAT(profile.ToString(), HasSubstr("(mostly on b)"));
+  EXPECT_THAT(profile.ToChromeTrace(), HasSubstr("partial, blocked on b"));
+}
+
+}  // namespace
+}  // namespace xls
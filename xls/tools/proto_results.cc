@@ -0,0 +1,46 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/proto_results.h"
+
+#include <string>
+
+#include "google/protobuf/util/json_util.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+
+namespace xls {
+
+absl::Status WriteProtoResults(const google::protobuf::Message& results,
+                               std::string_view path, std::string_view format) {
+  if (format == "textproto") {
+    return SetTextProtoFile(path, results);
+  }
+  if (format == "json") {
+    std::string json;
+    google::protobuf::util::JsonPrintOptions print_options;
+    print_options.add_whitespace = true;
+    print_options.preserve_proto_field_names = true;
+    auto status = google::protobuf::util::MessageToJsonString(results, &json,
+                                                              print_options);
+    if (!status.ok()) {
+      return absl::InternalError(std::string{status.message()});
+    }
+    return SetFileContents(path, json);
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Unknown results format: %s", format));
+}
+
+}  // namespace xls
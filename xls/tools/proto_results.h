@@ -0,0 +1,33 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_PROTO_RESULTS_H_
+#define XLS_TOOLS_PROTO_RESULTS_H_
+
+#include <string_view>
+
+#include "google/protobuf/message.h"
+#include "absl/status/status.h"
+
+namespace xls {
+
+// Writes the structured results of a tool to the file at `path` in the given
+// format, which is one of "textproto" or "json". JSON output uses the proto
+// field names so it can be consumed without the proto definitions.
+absl::Status WriteProtoResults(const google::protobuf::Message& results,
+                               std::string_view path, std::string_view format);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_PROTO_RESULTS_H_
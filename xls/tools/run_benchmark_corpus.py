@@ -0,0 +1,155 @@
+# Copyright 2022 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Runs benchmark_main over a corpus of designs and collects the results.
+
+Each design is benchmarked with benchmark_main writing its results as a JSON
+BenchmarkResultProto (see xls/tools/benchmark.proto). The results of all
+designs are gathered into a single JSON BenchmarkSuiteResultProto which can be
+stored and compared across releases to track the performance of the pass
+pipeline, JIT and scheduler over time.
+
+Example invocation:
+
+  run_benchmark_corpus --repetitions=5 --warmup_repetitions=1 \
+    --label=v0.1 --output_path=/tmp/results.json
+"""
+
+import json
+import os
+import subprocess
+import tempfile
+from typing import Any, Dict, List, Sequence
+
+from absl import app
+from absl import flags
+from absl import logging
+
+from xls.common import runfiles
+
+_DESIGNS = flags.DEFINE_multi_string(
+    'design', None,
+    'Names of the designs in the corpus to benchmark. If not given, all '
+    'designs are benchmarked.')
+_EXTRA_IR = flags.DEFINE_multi_string(
+    'extra_ir', [],
+    'Paths of additional IR files to benchmark with the default flags.')
+_REPETITIONS = flags.DEFINE_integer(
+    'repetitions', 3, 'Number of timed repetitions of each timed stage.')
+_WARMUP_REPETITIONS = flags.DEFINE_integer(
+    'warmup_repetitions', 1,
+    'Number of untimed runs of each timed stage before the timed repetitions.')
+_LABEL = flags.DEFINE_string(
+    'label', '', 'Label identifying the run, e.g. a release tag or commit.')
+_OUTPUT_PATH = flags.DEFINE_string(
+    'output_path', None,
+    'Path to write the results to as a JSON BenchmarkSuiteResultProto.')
+_KEEP_GOING = flags.DEFINE_bool(
+    'keep_going', False,
+    'Continue with the remaining designs if benchmarking a design fails.')
+
+_BENCHMARK_MAIN_PATH = 'xls/tools/benchmark_main'
+
+# The designs of the corpus. Each entry maps a design name to the runfiles path
+# of its (unoptimized) IR and any additional benchmark_main flags. Functions
+# are scheduled into a fixed number of stages so that scheduling and codegen
+# are included in the benchmark.
+_CORPUS = {
+    'adler32': ('xls/examples/adler32.ir', {
+        'pipeline_stages': 4
+    }),
+    'sha256': ('xls/examples/sha256.ir', {
+        'pipeline_stages': 8
+    }),
+    'fp32_add_2': ('xls/modules/fp/fp32_add_2.ir', {
+        'pipeline_stages': 4
+    }),
+    'fp32_mul_2': ('xls/modules/fp/fp32_mul_2.ir', {
+        'pipeline_stages': 4
+    }),
+    'fp32_fma': ('xls/modules/fp/fp32_fma.ir', {
+        'pipeline_stages': 4
+    }),
+    'aes_ctr': ('xls/modules/aes/aes_ctr.ir', {}),
+    'aes_ghash': ('xls/modules/aes/aes_ghash.ir', {}),
+}
+
+
+def _run_benchmark(ir_path: str, args: Dict[str, Any]) -> Dict[str, Any]:
+  """Runs benchmark_main on the given IR file and returns its JSON results."""
+  with tempfile.TemporaryDirectory() as temp_dir:
+    results_path = os.path.join(temp_dir, 'results.json')
+    cmd = [
+        runfiles.get_path(_BENCHMARK_MAIN_PATH),
+        ir_path,
+        f'--repetitions={_REPETITIONS.value}',
+        f'--warmup_repetitions={_WARMUP_REPETITIONS.value}',
+        f'--results_path={results_path}',
+        '--results_format=json',
+    ] + [f'--{k}={v}' for k, v in args.items()]
+    logging.info('Running: %s', subprocess.list2cmdline(cmd))
+    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+    with open(results_path, 'r') as f:
+      return json.load(f)
+
+
+def _summary_table(results: List[Dict[str, Any]]) -> str:
+  """Returns a table of the median time of each stage for each design."""
+  stages = sorted({s for r in results for s in r.get('timings', {})})
+  rows = [['design'] + stages]
+  for r in results:
+    timings = r.get('timings', {})
+    name = os.path.basename(r['ir_path'])
+    rows.append([name] + [
+        '%.2f' % (timings[s]['median_us'] / 1000.0) if s in timings else '-'
+        for s in stages
+    ])
+  widths = [max(len(row[i]) for row in rows) for i in range(len(rows[0]))]
+  return '\n'.join('  '.join(c.rjust(w)
+                             for c, w in zip(row, widths))
+                   for row in rows)
+
+
+def main(argv: Sequence[str]) -> None:
+  if len(argv) > 1:
+    raise app.UsageError('Too many command-line arguments.')
+
+  designs = _DESIGNS.value or sorted(_CORPUS)
+  for design in designs:
+    if design not in _CORPUS:
+      raise app.UsageError(f'Unknown design: {design}')
+  to_run = [(runfiles.get_path(_CORPUS[d][0]), _CORPUS[d][1]) for d in designs]
+  to_run += [(path, {}) for path in _EXTRA_IR.value]
+
+  results = []
+  for ir_path, args in to_run:
+    try:
+      results.append(_run_benchmark(ir_path, args))
+    except subprocess.CalledProcessError as e:
+      if not _KEEP_GOING.value:
+        raise
+      logging.error('Benchmarking %s failed: %s', ir_path, e)
+
+  print('Median time per stage (ms):')
+  print(_summary_table(results))
+
+  if _OUTPUT_PATH.value:
+    with open(_OUTPUT_PATH.value, 'w') as f:
+      json.dump({
+          'label': _LABEL.value,
+          'results': results
+      }, f, indent=2)
+
+
+if __name__ == '__main__':
+  app.run(main)
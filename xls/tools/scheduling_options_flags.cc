@@ -21,6 +21,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/op.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
 // LINT.IfChange
@@ -44,8 +45,37 @@ ABSL_FLAG(int64_t, period_relaxation_percent, 0,
           "constraints will be used. Increasing this will trade-off an "
           "increase in critical path delay in favor of decreased register "
           "count. See https://google.github.io/xls/scheduling for details.");
+ABSL_FLAG(int64_t, scheduling_thread_count, 0,
+          "The number of threads the scheduler may use. Used by the search "
+          "for the minimum clock period when scheduling without an explicit "
+          "--clock_period_ps, and by the min-cut scheduler. When set to 0 "
+          "scheduling is single-threaded.");
 ABSL_FLAG(int64_t, additional_input_delay_ps, 0,
           "The additional delay added to each receive node.");
+ABSL_FLAG(int64_t, initiation_interval, 1,
+          "The initiation interval (II) of the pipeline: the number of cycles "
+          "between the starts of successive proc iterations. With an II of N "
+          "the path from each proc state element to its next value may span "
+          "up to N pipeline stages. See "
+          "https://google.github.io/xls/scheduling for details.");
+ABSL_FLAG(std::vector<std::string>, multicycle_ops, {},
+          "A comma-separated list of multicycle operations, each of which is "
+          "specified by a literal like `umul:3` which means that every umul "
+          "spans 3 cycles: its result is used no earlier than 2 cycles after "
+          "the cycle in which it is scheduled and its delay is divided "
+          "evenly between the cycles. The pipeline registers which carry the "
+          "result are intended to be retimed into the operation by the "
+          "synthesis tool. Not supported by the min-cut strategy.");
+ABSL_FLAG(int64_t, memory_lookup_min_bits, 0,
+          "If positive, lookups (array_index) into literal tables of at least "
+          "this many bits are implemented by read-only memories with a "
+          "registered output rather than by logic. Their users are scheduled "
+          "--memory_read_latency cycles later and codegen replaces each lookup "
+          "and the pipeline registers carrying its result with an instance of "
+          "a memory module.");
+ABSL_FLAG(int64_t, memory_read_latency, 1,
+          "The number of cycles from the address to the data of the memories "
+          "enabled by --memory_lookup_min_bits.");
 ABSL_FLAG(std::vector<std::string>, io_constraints, {},
           "A comma-separated list of IO constraints, each of which is "
           "specified by a literal like `foo:send:bar:recv:3:5` which means "
@@ -82,10 +112,34 @@ absl::StatusOr<SchedulingOptions> SetUpSchedulingOptions(Package* p) {
     scheduling_options.period_relaxation_percent(
         absl::GetFlag(FLAGS_period_relaxation_percent));
   }
+  if (absl::GetFlag(FLAGS_scheduling_thread_count) != 0) {
+    scheduling_options.thread_count(
+        absl::GetFlag(FLAGS_scheduling_thread_count));
+  }
   if (absl::GetFlag(FLAGS_additional_input_delay_ps) != 0) {
     scheduling_options.additional_input_delay_ps(
         absl::GetFlag(FLAGS_additional_input_delay_ps));
   }
+  if (absl::GetFlag(FLAGS_initiation_interval) != 1) {
+    scheduling_options.initiation_interval(
+        absl::GetFlag(FLAGS_initiation_interval));
+  }
+  for (const std::string& m : absl::GetFlag(FLAGS_multicycle_ops)) {
+    std::vector<std::string> components = absl::StrSplit(m, ':');
+    int64_t latency;
+    if (components.size() != 2 ||
+        !absl::SimpleAtoi(components[1], &latency)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Could not parse multicycle operation: `%s`", m));
+    }
+    XLS_ASSIGN_OR_RETURN(Op op, StringToOp(components[0]));
+    scheduling_options.multicycle_op(op, latency);
+  }
+  if (absl::GetFlag(FLAGS_memory_lookup_min_bits) > 0) {
+    scheduling_options.memory_lookups(MemoryLookupConfig{
+        .min_table_bits = absl::GetFlag(FLAGS_memory_lookup_min_bits),
+        .read_latency = absl::GetFlag(FLAGS_memory_read_latency)});
+  }
   for (const std::string& c : absl::GetFlag(FLAGS_io_constraints)) {
     std::vector<std::string> components = absl::StrSplit(c, ':');
     if (components.size() != 6) {
@@ -158,7 +212,7 @@ absl::StatusOr<SchedulingOptions> SetUpSchedulingOptions(Package* p) {
 }
 
 absl::StatusOr<DelayEstimator*> SetUpDelayEstimator() {
-  return GetDelayEstimator(absl::GetFlag(FLAGS_delay_model));
+  return GetCachingDelayEstimator(absl::GetFlag(FLAGS_delay_model));
 }
 
 }  // namespace xls
@@ -26,7 +26,12 @@ ABSL_DECLARE_FLAG(int64_t, pipeline_stages);
 ABSL_DECLARE_FLAG(std::string, delay_model);
 ABSL_DECLARE_FLAG(int64_t, clock_margin_percent);
 ABSL_DECLARE_FLAG(int64_t, period_relaxation_percent);
+ABSL_DECLARE_FLAG(int64_t, scheduling_thread_count);
 ABSL_DECLARE_FLAG(int64_t, additional_input_delay_ps);
+ABSL_DECLARE_FLAG(int64_t, initiation_interval);
+ABSL_DECLARE_FLAG(std::vector<std::string>, multicycle_ops);
+ABSL_DECLARE_FLAG(int64_t, memory_lookup_min_bits);
+ABSL_DECLARE_FLAG(int64_t, memory_read_latency);
 ABSL_DECLARE_FLAG(std::vector<std::string>, scheduling_constraints);
 
 namespace xls {
@@ -60,6 +60,10 @@ ABSL_FLAG(std::string, args, "",
 ABSL_FLAG(std::string, verilog_simulator, "",
           "The Verilog simulator to use. If not specified, the default "
           "simulator is used.");
+ABSL_FLAG(int64_t, max_concurrent_simulations, 1,
+          "The maximum number of Verilog simulator processes to run "
+          "concurrently. Large batches of arguments are split into shards "
+          "which are simulated separately.");
 ABSL_FLAG(std::string, file_type, "",
           "The type of input file, may be either 'verilog' or "
           "'system_verilog'. If not specified the file type is determined by "
@@ -75,6 +79,8 @@ absl::Status RealMain(std::string_view verilog_text,
                       const verilog::VerilogSimulator* verilog_simulator) {
   verilog::ModuleSimulator simulator(signature, verilog_text, file_type,
                                      verilog_simulator);
+  simulator.SetMaxConcurrentSimulations(
+      absl::GetFlag(FLAGS_max_concurrent_simulations));
 
   std::vector<absl::flat_hash_map<std::string, Value>> args_sets;
   for (std::string_view args_string : args_strings) {
@@ -35,10 +35,10 @@ namespace xls {
 // periodically printed to the terminal, as this class' primary use is for
 // exploring large test spaces.
 //
-// Presently, work is parititioned uniformly across threads at startup. This can
-// lead to work imbalance if certain areas of the input space execute faster
-// than others. More advanced strategies can be explored in the future if this
-// becomes a problem.
+// Work is initially partitioned uniformly across threads, but each thread
+// claims its work in chunks and a thread which finishes its portion steals
+// chunks from the others (see TestbenchWorkQueue). This avoids idle threads
+// when certain areas of the input space execute faster than others.
 
 namespace internal {
 // Forward decl of common Testbench base class.
@@ -71,6 +71,7 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
   //                     are considered equivalent.
   //   log_errors      : The function to log errors when compare_results returns
   //                     false.
+  //   chunk_size      : The number of indices a worker claims at a time.
   //
   // All lambdas must be thread-safe.
   //
@@ -85,16 +86,18 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
             std::function<ResultT(ShardDataT*, InputT)> compute_expected,
             std::function<ResultT(ShardDataT*, InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            uint64_t chunk_size = kDefaultTestbenchChunkSize)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
-            compare_results, log_errors),
+            compare_results, log_errors, chunk_size),
         create_shard_(create_shard),
         compute_expected_(compute_expected),
         compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+    this->thread_create_fn_ = [this](int64_t worker_index) {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
+          &this->mutex_, &this->wake_me_, this->work_queue_.get(),
+          worker_index, this->max_failures_,
           this->index_to_input_, create_shard_, compute_expected_,
           compute_actual_, this->compare_results_, this->log_errors_);
     };
@@ -118,15 +121,17 @@ class Testbench<InputT, ResultT, ShardDataT,
             std::function<ResultT(InputT)> compute_expected,
             std::function<ResultT(InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            uint64_t chunk_size = kDefaultTestbenchChunkSize)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
-            compare_results, log_errors),
+            compare_results, log_errors, chunk_size),
         compute_expected_(compute_expected),
         compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+    this->thread_create_fn_ = [this](int64_t worker_index) {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
+          &this->mutex_, &this->wake_me_, this->work_queue_.get(),
+          worker_index, this->max_failures_,
           this->index_to_input_, compute_expected_, compute_actual_,
           this->compare_results_, this->log_errors_);
     };
@@ -149,12 +154,14 @@ class TestbenchBase {
       uint64_t start, uint64_t end, uint64_t num_threads, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
-      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+      uint64_t chunk_size)
       : started_(false),
         num_threads_(num_threads),
         start_(start),
         end_(end),
         max_failures_(max_failures),
+        chunk_size_(chunk_size),
         num_samples_processed_(0),
         index_to_input_(index_to_input),
         compare_results_(compare_results),
@@ -171,6 +178,19 @@ class TestbenchBase {
     return absl::OkStatus();
   }
 
+  // Sets the number of indices a worker claims from the work queue at a time.
+  // Smaller chunks balance work better at the cost of more synchronization.
+  // Must be called before Run().
+  absl::Status SetChunkSize(uint64_t chunk_size) {
+    absl::MutexLock lock(&mutex_);
+    if (this->started_) {
+      return absl::FailedPreconditionError(
+          "Can't change the chunk size after starting execution.");
+    }
+    chunk_size_ = chunk_size;
+    return absl::OkStatus();
+  }
+
   // Executes the test.
   absl::Status Run() {
     // Lock before spawning threads to prevent missing any early wakeup signals
@@ -179,23 +199,11 @@ class TestbenchBase {
     started_ = true;
 
     // Set up all the workers.
-    uint64_t chunk_size = (end_ - start_) / num_threads_;
-    uint64_t chunk_remainder =
-        chunk_size == 0 ? (end_ - start_) : (end_ - start_) % chunk_size;
-    uint64_t first = 0;
-    uint64_t last;
+    work_queue_ = std::make_unique<TestbenchWorkQueue>(
+        start_, end_, num_threads_, chunk_size_);
     for (int i = 0; i < num_threads_; i++) {
-      last = first + chunk_size;
-      // Distribute any remainder evenly amongst the threads.
-      if (chunk_remainder > 0) {
-        last++;
-        chunk_remainder--;
-      }
-
-      threads_.push_back(thread_create_fn_(first, last));
+      threads_.push_back(thread_create_fn_(i));
       threads_.back()->Run();
-
-      first = last + 1;
     }
 
     // Wait for all to be ready.
@@ -266,33 +274,24 @@ class TestbenchBase {
   // How many seconds to wait before printing status (at most).
   static constexpr absl::Duration kPrintInterval = absl::Seconds(5);
 
-  // Prints the current execution status across all threads.
+  // Prints the current execution status across all threads. As work is
+  // balanced dynamically, each thread's progress is given as its share of the
+  // entire index space.
   void PrintStatus() {
-    // Get the remainder-adjusted chunk size for this thread.
-    auto thread_chunk_size = [this](int thread_index) {
-      uint64_t total_size = end_ - start_;
-      uint64_t chunk_size = total_size / threads_.size();
-      uint64_t remainder =
-          chunk_size == 0 ? total_size : total_size % chunk_size;
-      if (thread_index < remainder) {
-        chunk_size++;
-      }
-      return chunk_size;
-    };
-
-    // Ignore remainder issues here. It shouldn't matter much at all.
     absl::Time now = absl::Now();
     auto delta = now - start_time_;
+    uint64_t total_size = end_ - start_;
     uint64_t total_done = 0;
     for (int64_t i = 0; i < threads_.size(); ++i) {
       uint64_t num_passes = threads_[i]->num_passes();
       uint64_t num_failures = threads_[i]->num_failures();
       uint64_t thread_done = num_passes + num_failures;
-      uint64_t chunk_size = thread_chunk_size(i);
       total_done += thread_done;
       std::cout << absl::StreamFormat(
-                       "thread %02d: %f%% @ %.1f us/sample :: failures %d", i,
-                       static_cast<double>(thread_done) / chunk_size * 100.0,
+                       "thread %02d: %d samples (%f%% of total) @ %.1f "
+                       "us/sample :: failures %d",
+                       i, thread_done,
+                       static_cast<double>(thread_done) / total_size * 100.0,
                        absl::ToDoubleMicroseconds(delta) / thread_done,
                        num_failures)
                 << "\n";
@@ -307,9 +306,10 @@ class TestbenchBase {
         static_cast<double>(total_done - num_samples_processed_) /
         ToInt64Seconds(kPrintInterval);
     std::cout << absl::StreamFormat(
-                     "--- ^ after %s elapsed; %f Misamples/s; estimate %s "
-                     "remaining ...",
+                     "--- ^ after %s elapsed; %f%% done; %f Misamples/s; "
+                     "estimate %s remaining ...",
                      absl::FormatDuration(delta),
+                     static_cast<double>(total_done) / total_size * 100.0,
                      throughput_this_print / std::pow(2, 20),
                      absl::FormatDuration(estimate))
               << std::endl;
@@ -329,14 +329,16 @@ class TestbenchBase {
   uint64_t start_;
   uint64_t end_;
   uint64_t max_failures_;
+  uint64_t chunk_size_;
   uint64_t num_samples_processed_;
   std::function<InputT(uint64_t)> index_to_input_;
   std::function<bool(ResultT, ResultT)> compare_results_;
   std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors_;
 
   using ThreadT = TestbenchThread<InputT, ResultT, ShardDataT>;
-  std::function<std::unique_ptr<ThreadT>(uint64_t, uint64_t)> thread_create_fn_;
+  std::function<std::unique_ptr<ThreadT>(int64_t)> thread_create_fn_;
   std::vector<std::unique_ptr<ThreadT>> threads_;
+  std::unique_ptr<TestbenchWorkQueue> work_queue_;
 
   // The main thread sleeps while tests are running. As worker threads finish,
   // they'll wake us up via this condvar.
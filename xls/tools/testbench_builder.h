@@ -91,6 +91,11 @@ class TestbenchBuilder {
     return *this;
   }
 
+  TestbenchBuilder& SetChunkSize(int64_t chunk_size) {
+    chunk_size_ = chunk_size;
+    return *this;
+  }
+
   TestbenchBuilder& SetPrintInputFn(const PrintInputFnT& fn) {
     print_input_ = fn;
     return *this;
@@ -111,6 +116,7 @@ class TestbenchBuilder {
  private:
   uint64_t num_samples_ = 16 * 1024;
   uint64_t num_threads_ = std::thread::hardware_concurrency();
+  uint64_t chunk_size_ = kDefaultTestbenchChunkSize;
   int64_t max_failures_ = 1;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
@@ -163,6 +169,11 @@ class TestbenchBuilder<
     return *this;
   }
 
+  TestbenchBuilder& SetChunkSize(int64_t chunk_size) {
+    chunk_size_ = chunk_size;
+    return *this;
+  }
+
   TestbenchBuilder& SetPrintInputFn(const PrintInputFnT& fn) {
     print_input_ = fn;
     return *this;
@@ -183,6 +194,7 @@ class TestbenchBuilder<
  private:
   uint64_t num_samples_ = 16 * 1024;
   uint64_t num_threads_ = std::thread::hardware_concurrency();
+  uint64_t chunk_size_ = kDefaultTestbenchChunkSize;
   int64_t max_failures_ = 1;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
@@ -230,7 +242,7 @@ TestbenchBuilder<InputT, ResultT, ShardDataT, EnableT>::Build() {
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, create_shard_data_, this->compute_expected_,
-      this->compute_actual_, compare_results, log_errors);
+      this->compute_actual_, compare_results, log_errors, this->chunk_size_);
 }
 
 // Non-shard-data-containing Build() implementation.
@@ -270,7 +282,7 @@ Testbench<InputT, ResultT> TestbenchBuilder<
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, this->compute_expected_, this->compute_actual_,
-      compare_results, log_errors);
+      compare_results, log_errors, this->chunk_size_);
 }
 
 }  // namespace xls
@@ -15,7 +15,12 @@
 #ifndef XLS_TOOLS_TESTBENCH_THREAD_H_
 #define XLS_TOOLS_TESTBENCH_THREAD_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -26,12 +31,93 @@
 
 namespace xls {
 
+// The default number of indices claimed by a worker at a time.
+inline constexpr uint64_t kDefaultTestbenchChunkSize = 1024;
+
+// TestbenchWorkQueue distributes the index space [start, end) of a testbench
+// amongst its worker threads. The space is initially split into one contiguous
+// range per worker. Workers claim chunks of (at most) `chunk_size` indices from
+// the front of their own range and, once it is exhausted, steal chunks from
+// the back of the range of the worker with the most remaining work. This keeps
+// all workers busy even if some areas of the input space are much slower to
+// evaluate than others.
+class TestbenchWorkQueue {
+ public:
+  TestbenchWorkQueue(uint64_t start, uint64_t end, int64_t num_workers,
+                     uint64_t chunk_size)
+      : chunk_size_(std::max(chunk_size, uint64_t{1})) {
+    num_workers = std::max(num_workers, int64_t{1});
+    uint64_t total = end - start;
+    for (int64_t i = 0; i < num_workers; ++i) {
+      auto range = std::make_unique<Range>();
+      range->next = start + total / num_workers * i +
+                    std::min<uint64_t>(i, total % num_workers);
+      range->end = range->next + total / num_workers +
+                   (i < total % num_workers ? 1 : 0);
+      ranges_.push_back(std::move(range));
+    }
+  }
+
+  // Claims the next chunk of work for the given worker. Returns false if no
+  // work remains anywhere in the index space.
+  bool NextChunk(int64_t worker_index, uint64_t* chunk_start,
+                 uint64_t* chunk_end) {
+    Range& own = *ranges_[worker_index];
+    {
+      absl::MutexLock lock(&own.mutex);
+      if (own.next < own.end) {
+        *chunk_start = own.next;
+        *chunk_end = own.next + std::min(chunk_size_, own.end - own.next);
+        own.next = *chunk_end;
+        return true;
+      }
+    }
+
+    // Steal from the back of the largest remaining range. The sizes may
+    // change between finding the victim and locking it, so retry until no
+    // work is left.
+    while (true) {
+      Range* victim = nullptr;
+      uint64_t victim_size = 0;
+      for (std::unique_ptr<Range>& range : ranges_) {
+        absl::MutexLock lock(&range->mutex);
+        if (range->end - range->next > victim_size) {
+          victim = range.get();
+          victim_size = range->end - range->next;
+        }
+      }
+      if (victim == nullptr) {
+        return false;
+      }
+      absl::MutexLock lock(&victim->mutex);
+      if (victim->next < victim->end) {
+        *chunk_end = victim->end;
+        *chunk_start = victim->end - std::min(chunk_size_,
+                                              victim->end - victim->next);
+        victim->end = *chunk_start;
+        return true;
+      }
+    }
+  }
+
+ private:
+  // The unclaimed indices [next, end) of a single worker.
+  struct Range {
+    absl::Mutex mutex;
+    uint64_t next ABSL_GUARDED_BY(mutex);
+    uint64_t end ABSL_GUARDED_BY(mutex);
+  };
+
+  uint64_t chunk_size_;
+  std::vector<std::unique_ptr<Range>> ranges_;
+};
+
 template <typename InputT, typename ResultT, typename ShardDataT>
 class TestbenchThreadBase;
 
 // TestbenchThread handles the work of _actually_ running tests.
-// It simply iterates over its given range of the index space and calls the
-// expected/actual calculators.
+// It repeatedly claims chunks of the index space from the shared work queue and
+// calls the expected/actual calculators on each index.
 //
 // Just as with Testbench, TestbenchThread supports execution both with and
 // without per-shard data, and uses the same type of construct to expose an API
@@ -45,6 +131,8 @@ class TestbenchThread
   // All specified functions must be thread-safe.
   //  - wake_parent_mutex: A mutex that protects:
   //  - wake_parent: A condvar to kick the parent when this thread has finished.
+  //  - work_queue: The queue from which to claim chunks of the index space.
+  //  - worker_index: The index of this thread in the work queue.
   //  - max_failures: The number of failures that will cause us to bail out.
   //                  If 0, then there will be no limit.
   //  - index_to_input: A function that can convert an index to an input to the
@@ -54,7 +142,8 @@ class TestbenchThread
   //                     under test.
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      TestbenchWorkQueue* work_queue, int64_t worker_index,
+      uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<std::unique_ptr<ShardDataT>()> create_shard,
       std::function<ResultT(ShardDataT*, InputT)> generate_expected,
@@ -62,7 +151,7 @@ class TestbenchThread
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
+            wake_parent_mutex, wake_parent, work_queue, worker_index,
             max_failures, index_to_input, compare_results, log_errors),
         create_shard_fn_(create_shard),
         generate_expected_(generate_expected),
@@ -94,14 +183,15 @@ class TestbenchThread<
  public:
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      TestbenchWorkQueue* work_queue, int64_t worker_index,
+      uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<ResultT(InputT)> generate_expected,
       std::function<ResultT(InputT)> generate_actual,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
+            wake_parent_mutex, wake_parent, work_queue, worker_index,
             max_failures, index_to_input, compare_results, log_errors),
         generate_expected_(generate_expected),
         generate_actual_(generate_actual) {
@@ -127,7 +217,8 @@ class TestbenchThreadBase {
  public:
   TestbenchThreadBase(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      TestbenchWorkQueue* work_queue, int64_t worker_index,
+      uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
@@ -137,8 +228,8 @@ class TestbenchThreadBase {
         running_(false),
         ready_(false),
         start_(false),
-        start_index_(start_index),
-        end_index_(end_index),
+        work_queue_(work_queue),
+        worker_index_(worker_index),
         max_failures_(max_failures),
         num_passes_(0),
         num_failures_(0),
@@ -171,25 +262,30 @@ class TestbenchThreadBase {
     }
 
     running_.store(true);
-    for (uint64_t i = start_index_; i < end_index_; i++) {
-      // Don't check for cancelled on every iteration; it's a touch slow.
-      if (i % 128 == 0 && cancelled_.load()) {
-        return_status = absl::CancelledError("This thread was cancelled.");
-        break;
-      }
-
-      InputT input = index_to_input_(i);
-      ResultT expected = generate_expected_fn_(input);
-      ResultT actual = generate_actual_fn_(input);
-      if (!compare_results_(expected, actual)) {
-        num_failures_.store(num_failures_.load() + 1);
-        log_errors_(i, input, expected, actual);
-        if (max_failures_ <= num_failures_.load()) {
-          return_status = absl::UnknownError("Maximum error count reached.");
+    uint64_t chunk_start;
+    uint64_t chunk_end;
+    while (return_status.ok() &&
+           work_queue_->NextChunk(worker_index_, &chunk_start, &chunk_end)) {
+      for (uint64_t i = chunk_start; i < chunk_end; i++) {
+        // Don't check for cancelled on every iteration; it's a touch slow.
+        if ((i == chunk_start || i % 128 == 0) && cancelled_.load()) {
+          return_status = absl::CancelledError("This thread was cancelled.");
           break;
         }
-      } else {
-        num_passes_.store(num_passes_.load() + 1);
+
+        InputT input = index_to_input_(i);
+        ResultT expected = generate_expected_fn_(input);
+        ResultT actual = generate_actual_fn_(input);
+        if (!compare_results_(expected, actual)) {
+          num_failures_.store(num_failures_.load() + 1);
+          log_errors_(i, input, expected, actual);
+          if (max_failures_ <= num_failures_.load()) {
+            return_status = absl::UnknownError("Maximum error count reached.");
+            break;
+          }
+        } else {
+          num_passes_.store(num_passes_.load() + 1);
+        }
       }
     }
 
@@ -251,8 +347,9 @@ class TestbenchThreadBase {
   std::atomic<bool> ready_;
   std::atomic<bool> start_;
 
-  uint64_t start_index_;
-  uint64_t end_index_;
+  // Parent-owned.
+  TestbenchWorkQueue* work_queue_;
+  int64_t worker_index_;
 
   // Bookkeeping data.
   uint64_t max_failures_;
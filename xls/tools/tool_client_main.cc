@@ -0,0 +1,87 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Sends one invocation of a tool to a server started with the tool's
+// --serve_on_socket flag and prints the tool's output.
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/strings/str_cat.h"
+#include "grpcpp/grpcpp.h"
+#include "grpcpp/security/credentials.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/tools/tool_server.grpc.pb.h"
+#include "xls/tools/tool_server.pb.h"
+
+const char kUsage[] = R"(
+Runs a tool invocation on a server started with --serve_on_socket, e.g.
+`opt_main --serve_on_socket=/tmp/opt.sock`. The arguments after `--` are the
+usual command-line arguments of the tool; relative paths are resolved against
+the current directory. The output of the tool is printed to stdout.
+
+Example invocation:
+  tool_client_main --socket=/tmp/opt.sock -- --top=main path/to/file.ir
+)";
+
+ABSL_FLAG(std::string, socket, "",
+          "Unix domain socket on which the tool server listens.");
+
+namespace xls::tools {
+namespace {
+
+int RealMain(absl::Span<const std::string_view> tool_args) {
+  ToolInvocationRequest request;
+  for (std::string_view arg : tool_args) {
+    request.add_args(std::string(arg));
+  }
+  std::error_code ec;
+  std::filesystem::path working_directory = std::filesystem::current_path(ec);
+  if (!ec) {
+    request.set_working_directory(working_directory);
+  }
+
+  std::shared_ptr<::grpc::Channel> channel = ::grpc::CreateChannel(
+      absl::StrCat("unix:", absl::GetFlag(FLAGS_socket)),
+      ::grpc::experimental::LocalCredentials(UDS));
+  std::unique_ptr<ToolService::Stub> stub = ToolService::NewStub(channel);
+  ::grpc::ClientContext context;
+  ToolInvocationResponse response;
+  ::grpc::Status status = stub->Invoke(&context, request, &response);
+  if (!status.ok()) {
+    std::cerr << status.error_message() << "\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << response.output();
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+}  // namespace xls::tools
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+  if (absl::GetFlag(FLAGS_socket).empty()) {
+    XLS_LOG(QFATAL) << "--socket is required.";
+  }
+  return xls::tools::RealMain(positional_arguments);
+}
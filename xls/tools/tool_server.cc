@@ -0,0 +1,221 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/tool_server.h"
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "absl/flags/commandlineflag.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "grpcpp/grpcpp.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/tools/tool_server.grpc.pb.h"
+#include "xls/tools/tool_server.pb.h"
+
+ABSL_FLAG(std::string, serve_on_socket, "",
+          "If specified, run as a server listening on this Unix domain socket "
+          "instead of running once. Invocations of the tool are then sent to "
+          "the server with tool_client_main.");
+
+namespace xls::tools {
+namespace {
+
+// Changes the working directory for the lifetime of the object.
+class ScopedWorkingDirectory {
+ public:
+  static absl::StatusOr<std::unique_ptr<ScopedWorkingDirectory>> Create(
+      const std::filesystem::path& path) {
+    std::error_code ec;
+    std::filesystem::path previous = std::filesystem::current_path(ec);
+    if (!ec) {
+      std::filesystem::current_path(path, ec);
+    }
+    if (ec) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Cannot change to directory %s: %s", path.string(), ec.message()));
+    }
+    return absl::WrapUnique(new ScopedWorkingDirectory(std::move(previous)));
+  }
+
+  ~ScopedWorkingDirectory() {
+    std::error_code ec;
+    std::filesystem::current_path(previous_, ec);
+    if (ec) {
+      XLS_LOG(ERROR) << "Cannot change back to directory " << previous_ << ": "
+                     << ec.message();
+    }
+  }
+
+ private:
+  explicit ScopedWorkingDirectory(std::filesystem::path previous)
+      : previous_(std::move(previous)) {}
+
+  std::filesystem::path previous_;
+};
+
+// Service implementation that runs the invocations of a single tool.
+class ToolServiceImpl : public ToolService::Service {
+ public:
+  explicit ToolServiceImpl(ToolMain main) : main_(std::move(main)) {}
+
+  ::grpc::Status Invoke(::grpc::ServerContext* server_context,
+                        const ToolInvocationRequest* request,
+                        ToolInvocationResponse* response) override {
+    absl::StatusOr<std::string> output;
+    {
+      absl::MutexLock lock(&mutex_);
+      output = RunToolInvocation(*request, main_);
+    }
+    if (!output.ok()) {
+      // The canonical status codes of absl and gRPC are the same.
+      return ::grpc::Status(
+          static_cast<::grpc::StatusCode>(output.status().code()),
+          std::string(output.status().message()));
+    }
+    response->set_output(*std::move(output));
+    return ::grpc::Status::OK;
+  }
+
+ private:
+  ToolMain main_;
+  absl::Mutex mutex_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::vector<std::string>> SetFlagsFromArgs(
+    absl::Span<const std::string> args) {
+  std::vector<std::string> positional_arguments;
+  for (int64_t i = 0; i < args.size(); ++i) {
+    std::string_view arg = args[i];
+    if (arg == "--") {
+      positional_arguments.insert(positional_arguments.end(),
+                                  args.begin() + i + 1, args.end());
+      break;
+    }
+    if (arg == "-" || !absl::StartsWith(arg, "-")) {
+      positional_arguments.push_back(std::string(arg));
+      continue;
+    }
+    // Flags may be spelled with one or two leading dashes.
+    arg.remove_prefix(absl::StartsWith(arg, "--") ? 2 : 1);
+    std::string_view name = arg;
+    std::optional<std::string_view> value;
+    if (size_t equals = arg.find('='); equals != std::string_view::npos) {
+      name = arg.substr(0, equals);
+      value = arg.substr(equals + 1);
+    }
+    absl::CommandLineFlag* flag = absl::FindCommandLineFlag(name);
+    if (flag == nullptr && !value.has_value() &&
+        absl::StartsWith(name, "no")) {
+      flag = absl::FindCommandLineFlag(name.substr(2));
+      if (flag != nullptr && flag->IsOfType<bool>()) {
+        value = "false";
+      } else {
+        flag = nullptr;
+      }
+    }
+    if (flag == nullptr) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Unknown command-line flag `%s`", name));
+    }
+    if (!value.has_value()) {
+      if (flag->IsOfType<bool>()) {
+        value = "true";
+      } else if (i + 1 < args.size()) {
+        value = args[++i];
+      } else {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Missing value for flag `%s`", name));
+      }
+    }
+    std::string error;
+    if (!flag->ParseFrom(*value, &error)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid value for flag `%s`: %s", name, error));
+    }
+  }
+  return positional_arguments;
+}
+
+absl::StatusOr<std::string> RunToolInvocation(
+    const ToolInvocationRequest& request, const ToolMain& main) {
+  absl::FlagSaver flag_saver;
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::string> positional_arguments,
+      SetFlagsFromArgs(std::vector<std::string>(request.args().begin(),
+                                                request.args().end())));
+  std::vector<std::string_view> positional_views;
+  for (const std::string& argument : positional_arguments) {
+    if (argument == "-") {
+      return absl::InvalidArgumentError(
+          "Reading from stdin is not supported by the tool server");
+    }
+    positional_views.push_back(argument);
+  }
+
+  std::unique_ptr<ScopedWorkingDirectory> working_directory;
+  if (request.has_working_directory()) {
+    XLS_ASSIGN_OR_RETURN(
+        working_directory,
+        ScopedWorkingDirectory::Create(request.working_directory()));
+  }
+  std::ostringstream output;
+  std::streambuf* stdout_buffer = std::cout.rdbuf(output.rdbuf());
+  absl::Status status = main(positional_views);
+  std::cout.rdbuf(stdout_buffer);
+  XLS_RETURN_IF_ERROR(status);
+  return output.str();
+}
+
+absl::Status ServeToolInvocations(std::string_view socket_path,
+                                  const ToolMain& main) {
+  ToolServiceImpl service(main);
+  ::grpc::ServerBuilder builder;
+  builder.AddListeningPort(absl::StrCat("unix:", socket_path),
+                           ::grpc::experimental::LocalServerCredentials(UDS));
+  builder.RegisterService(&service);
+  std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
+  if (server == nullptr) {
+    return absl::UnavailableError(
+        absl::StrFormat("Unable to serve on socket %s", socket_path));
+  }
+  XLS_LOG(INFO) << "Serving on socket: " << socket_path;
+  server->Wait();
+  return absl::OkStatus();
+}
+
+}  // namespace xls::tools
@@ -0,0 +1,67 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Support for running a tool binary (`opt_main`, `codegen_main`,
+// `ir_converter_main`) as a long-lived server, so that a build invoking the
+// tool many times pays for process startup and for the process-lifetime state
+// of the tool (e.g. delay model registration) only once. Invocations are sent
+// to the server by `tool_client_main`, with the tool's usual flags.
+
+#ifndef XLS_TOOLS_TOOL_SERVER_H_
+#define XLS_TOOLS_TOOL_SERVER_H_
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/declare.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/tools/tool_server.pb.h"
+
+ABSL_DECLARE_FLAG(std::string, serve_on_socket);
+
+namespace xls::tools {
+
+// Runs one invocation of a tool given its positional arguments. The flags of
+// the invocation are set before it is called, and its output is written to
+// `std::cout`.
+using ToolMain = std::function<absl::Status(
+    absl::Span<const std::string_view> positional_arguments)>;
+
+// Sets the flags named by the given command-line arguments (`--name=value`,
+// `--name value`, and `--name`/`--noname` for boolean flags) and returns the
+// remaining positional arguments. Arguments after `--` are all positional.
+absl::StatusOr<std::vector<std::string>> SetFlagsFromArgs(
+    absl::Span<const std::string> args);
+
+// Runs the invocation described by `request` in this process and returns what
+// it wrote to stdout. Flags are restored and the working directory is changed
+// back once the invocation completes. Reading from stdin (a `-` argument) is
+// not supported.
+absl::StatusOr<std::string> RunToolInvocation(
+    const ToolInvocationRequest& request, const ToolMain& main);
+
+// Serves invocations of `main` on the Unix domain socket at `socket_path`
+// until the process is killed. Flags, the working directory and `std::cout`
+// are process-wide, so invocations run one at a time; start several servers to
+// run invocations in parallel.
+absl::Status ServeToolInvocations(std::string_view socket_path,
+                                  const ToolMain& main);
+
+}  // namespace xls::tools
+
+#endif  // XLS_TOOLS_TOOL_SERVER_H_
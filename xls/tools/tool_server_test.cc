@@ -0,0 +1,128 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/tool_server.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+ABSL_FLAG(int64_t, tool_server_test_int, 1, "Flag for testing.");
+ABSL_FLAG(bool, tool_server_test_bool, false, "Flag for testing.");
+ABSL_FLAG(std::string, tool_server_test_string, "", "Flag for testing.");
+
+namespace xls::tools {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+// Prints the test flags and the positional arguments.
+absl::Status PrintFlags(absl::Span<const std::string_view> args) {
+  std::cout << absl::GetFlag(FLAGS_tool_server_test_int) << " "
+            << absl::GetFlag(FLAGS_tool_server_test_bool) << " "
+            << absl::GetFlag(FLAGS_tool_server_test_string) << " "
+            << absl::StrJoin(args, ",");
+  return absl::OkStatus();
+}
+
+ToolInvocationRequest MakeRequest(std::vector<std::string> args) {
+  ToolInvocationRequest request;
+  for (std::string& arg : args) {
+    request.add_args(std::move(arg));
+  }
+  return request;
+}
+
+TEST(ToolServerTest, SetFlagsFromArgs) {
+  absl::FlagSaver flag_saver;
+  EXPECT_THAT(SetFlagsFromArgs({"--tool_server_test_int=42", "a",
+                                "-tool_server_test_string", "hello", "b",
+                                "--tool_server_test_bool", "--", "--c"}),
+              IsOkAndHolds(ElementsAre("a", "b", "--c")));
+  EXPECT_EQ(absl::GetFlag(FLAGS_tool_server_test_int), 42);
+  EXPECT_EQ(absl::GetFlag(FLAGS_tool_server_test_string), "hello");
+  EXPECT_TRUE(absl::GetFlag(FLAGS_tool_server_test_bool));
+
+  EXPECT_THAT(SetFlagsFromArgs({"--notool_server_test_bool"}),
+              IsOkAndHolds(IsEmpty()));
+  EXPECT_FALSE(absl::GetFlag(FLAGS_tool_server_test_bool));
+}
+
+TEST(ToolServerTest, SetFlagsFromArgsErrors) {
+  absl::FlagSaver flag_saver;
+  EXPECT_THAT(SetFlagsFromArgs({"--no_such_flag=1"}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unknown command-line flag")));
+  EXPECT_THAT(SetFlagsFromArgs({"--tool_server_test_int=x"}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid value")));
+  EXPECT_THAT(SetFlagsFromArgs({"--tool_server_test_int"}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing value")));
+}
+
+TEST(ToolServerTest, RunToolInvocationRestoresFlags) {
+  EXPECT_THAT(
+      RunToolInvocation(MakeRequest({"--tool_server_test_int=7",
+                                     "--tool_server_test_string=x", "in.ir"}),
+                        PrintFlags),
+      IsOkAndHolds("7 0 x in.ir"));
+  EXPECT_THAT(RunToolInvocation(MakeRequest({"in.ir"}), PrintFlags),
+              IsOkAndHolds("1 0  in.ir"));
+  EXPECT_EQ(absl::GetFlag(FLAGS_tool_server_test_int), 1);
+}
+
+TEST(ToolServerTest, RunToolInvocationReturnsErrors) {
+  auto fail = [](absl::Span<const std::string_view> args) {
+    std::cout << "partial output";
+    return absl::InternalError("tool failed");
+  };
+  EXPECT_THAT(RunToolInvocation(MakeRequest({"in.ir"}), fail),
+              StatusIs(absl::StatusCode::kInternal, "tool failed"));
+  EXPECT_THAT(RunToolInvocation(MakeRequest({"-"}), PrintFlags),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("stdin")));
+}
+
+TEST(ToolServerTest, RunToolInvocationInWorkingDirectory) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path original = std::filesystem::current_path();
+  ToolInvocationRequest request = MakeRequest({});
+  request.set_working_directory(temp_dir.path());
+  auto print_directory = [](absl::Span<const std::string_view> args) {
+    std::cout << std::filesystem::current_path().string();
+    return absl::OkStatus();
+  };
+  std::string expected = std::filesystem::canonical(temp_dir.path()).string();
+  EXPECT_THAT(RunToolInvocation(request, print_directory),
+              IsOkAndHolds(expected));
+  EXPECT_EQ(std::filesystem::current_path(), original);
+}
+
+}  // namespace
+}  // namespace xls::tools
@@ -0,0 +1,215 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/value_stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+namespace {
+
+constexpr char kMagic[] = "XLSJITV1";
+constexpr int64_t kMagicSize = sizeof(kMagic) - 1;
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<TextValueReader>> TextValueReader::Create(
+    const std::filesystem::path& path) {
+  auto reader = absl::WrapUnique(new TextValueReader(path));
+  if (!reader->stream_.is_open()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to open value file %s", path.string()));
+  }
+  return reader;
+}
+
+absl::StatusOr<std::optional<std::vector<Value>>> TextValueReader::Read() {
+  std::string line;
+  while (std::getline(stream_, line)) {
+    ++line_number_;
+    if (absl::StripAsciiWhitespace(line).empty()) {
+      continue;
+    }
+    std::vector<Value> values;
+    for (std::string_view value_string : absl::StrSplit(line, ';')) {
+      absl::StatusOr<Value> value = Parser::ParseTypedValue(value_string);
+      if (!value.ok()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("%s:%d: %s", path_.string(), line_number_,
+                            value.status().message()));
+      }
+      values.push_back(*std::move(value));
+    }
+    return values;
+  }
+  if (stream_.bad()) {
+    return absl::InternalError(
+        absl::StrFormat("Error reading value file %s", path_.string()));
+  }
+  return std::nullopt;
+}
+
+JitRecordLayout::JitRecordLayout(absl::Span<Type* const> types,
+                                 JitRuntime* runtime)
+    : types_(types.begin(), types.end()), runtime_(runtime) {
+  for (Type* type : types_) {
+    int64_t size = runtime_->GetTypeByteSize(type);
+    offsets_.push_back(record_size_);
+    sizes_.push_back(size);
+    record_size_ += RoundUpToNearest(size, kAlignment);
+  }
+}
+
+std::string JitRecordLayout::Signature() const {
+  return absl::StrFormat(
+      "(%s)", absl::StrJoin(types_, ", ", [](std::string* out, Type* type) {
+        absl::StrAppend(out, type->ToString());
+      }));
+}
+
+absl::Status JitRecordLayout::Pack(absl::Span<const Value> values,
+                                   absl::Span<uint8_t> record) const {
+  XLS_RET_CHECK_EQ(record.size(), record_size_);
+  if (values.size() != types_.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d values, got %d", types_.size(),
+                        values.size()));
+  }
+  std::fill(record.begin(), record.end(), 0);
+  for (int64_t i = 0; i < types_.size(); ++i) {
+    if (!ValueConformsToType(values[i], types_[i])) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Value %s is not of type %s", values[i].ToString(),
+          types_[i]->ToString()));
+    }
+    runtime_->BlitValueToBuffer(values[i], types_[i],
+                                record.subspan(offsets_[i], sizes_[i]));
+  }
+  return absl::OkStatus();
+}
+
+std::vector<Value> JitRecordLayout::Unpack(
+    absl::Span<const uint8_t> record) const {
+  std::vector<Value> values;
+  for (int64_t i = 0; i < types_.size(); ++i) {
+    values.push_back(
+        runtime_->UnpackBuffer(record.data() + offsets_[i], types_[i]));
+  }
+  return values;
+}
+
+absl::StatusOr<std::unique_ptr<JitValueReader>> JitValueReader::Create(
+    const std::filesystem::path& path, const JitRecordLayout* layout) {
+  auto reader = absl::WrapUnique(new JitValueReader(path, layout));
+  std::ifstream& stream = reader->stream_;
+  if (!stream.is_open()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to open value file %s", path.string()));
+  }
+  char magic[kMagicSize];
+  uint64_t record_size = 0;
+  uint64_t signature_size = 0;
+  stream.read(magic, kMagicSize);
+  stream.read(reinterpret_cast<char*>(&record_size), sizeof(record_size));
+  stream.read(reinterpret_cast<char*>(&signature_size),
+              sizeof(signature_size));
+  if (!stream || std::memcmp(magic, kMagic, kMagicSize) != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("%s is not a JIT value file", path.string()));
+  }
+  std::string signature(signature_size, '\0');
+  stream.read(signature.data(), signature_size);
+  if (!stream) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Truncated header in JIT value file %s",
+                        path.string()));
+  }
+  if (signature != layout->Signature() ||
+      record_size != layout->record_size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "JIT value file %s holds records of type %s (%d bytes), expected %s "
+        "(%d bytes)",
+        path.string(), signature, record_size, layout->Signature(),
+        layout->record_size()));
+  }
+  return reader;
+}
+
+absl::StatusOr<int64_t> JitValueReader::Read(int64_t max_records,
+                                             std::vector<uint8_t>* buffer) {
+  int64_t record_size = layout_->record_size();
+  buffer->resize(max_records * record_size);
+  stream_.read(reinterpret_cast<char*>(buffer->data()), buffer->size());
+  if (stream_.bad()) {
+    return absl::InternalError(
+        absl::StrFormat("Error reading JIT value file %s", path_.string()));
+  }
+  int64_t bytes_read = stream_.gcount();
+  if (bytes_read % record_size != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "JIT value file %s ends with a partial record", path_.string()));
+  }
+  buffer->resize(bytes_read);
+  return bytes_read / record_size;
+}
+
+absl::StatusOr<std::unique_ptr<JitValueWriter>> JitValueWriter::Create(
+    const std::filesystem::path& path, const JitRecordLayout* layout) {
+  auto writer = absl::WrapUnique(new JitValueWriter(path, layout));
+  std::ofstream& stream = writer->stream_;
+  if (!stream.is_open()) {
+    return absl::PermissionDeniedError(
+        absl::StrFormat("Unable to create value file %s", path.string()));
+  }
+  uint64_t record_size = layout->record_size();
+  std::string signature = layout->Signature();
+  uint64_t signature_size = signature.size();
+  stream.write(kMagic, kMagicSize);
+  stream.write(reinterpret_cast<const char*>(&record_size),
+               sizeof(record_size));
+  stream.write(reinterpret_cast<const char*>(&signature_size),
+               sizeof(signature_size));
+  stream.write(signature.data(), signature.size());
+  return writer;
+}
+
+absl::Status JitValueWriter::Write(absl::Span<const uint8_t> records) {
+  XLS_RET_CHECK_EQ(records.size() % layout_->record_size(), 0);
+  stream_.write(reinterpret_cast<const char*>(records.data()),
+                records.size());
+  return absl::OkStatus();
+}
+
+absl::Status JitValueWriter::Close() {
+  stream_.close();
+  if (stream_.fail()) {
+    return absl::InternalError(
+        absl::StrFormat("Error writing JIT value file %s", path_.string()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,160 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_VALUE_STREAM_H_
+#define XLS_TOOLS_VALUE_STREAM_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+
+namespace xls {
+
+// Readers and writers for streaming large sets of IR values to and from files
+// without holding the files in memory. Two formats are supported:
+//
+//  - Text: one record per line, each a semicolon-separated list of typed
+//    values as accepted by Parser::ParseTypedValue, e.g.
+//    "bits[32]:42; (bits[7]:0, bits[20]:4)". Blank lines are skipped.
+//
+//  - JIT: a binary file of fixed-size records holding values in the native
+//    data layout of the JIT, so records can be passed to the JIT (e.g.
+//    FunctionJit::RunWithViews) without parsing or packing. The file starts
+//    with a header:
+//
+//      magic       8 bytes, "XLSJITV1"
+//      record size uint64
+//      signature   uint64 length followed by the bytes of the record
+//                  signature, e.g. "(bits[32], (bits[7], bits[20]))"
+//
+//    followed by the records. Integers are in host byte order and the data
+//    layout is that of the host, so files are not portable between
+//    architectures; the header is checked on reading.
+
+// Reads records of the text format one line at a time.
+class TextValueReader {
+ public:
+  static absl::StatusOr<std::unique_ptr<TextValueReader>> Create(
+      const std::filesystem::path& path);
+
+  // Returns the values of the next record or std::nullopt at the end of the
+  // file.
+  absl::StatusOr<std::optional<std::vector<Value>>> Read();
+
+ private:
+  explicit TextValueReader(const std::filesystem::path& path)
+      : path_(path), stream_(path) {}
+
+  std::filesystem::path path_;
+  std::ifstream stream_;
+  int64_t line_number_ = 0;
+};
+
+// The layout of a record of the JIT format: one value of each of the given
+// types, each in the native layout of the JIT at an offset aligned to
+// kAlignment bytes. The record size is also a multiple of kAlignment so
+// every record of a buffer of consecutive records is aligned.
+class JitRecordLayout {
+ public:
+  static constexpr int64_t kAlignment = 16;
+
+  JitRecordLayout(absl::Span<Type* const> types, JitRuntime* runtime);
+
+  int64_t record_size() const { return record_size_; }
+  int64_t value_count() const { return types_.size(); }
+  Type* type(int64_t i) const { return types_.at(i); }
+  int64_t offset(int64_t i) const { return offsets_.at(i); }
+  int64_t size(int64_t i) const { return sizes_.at(i); }
+
+  // Returns the signature of the record written to the file header.
+  std::string Signature() const;
+
+  // Writes the values into the record, which must be record_size() bytes.
+  absl::Status Pack(absl::Span<const Value> values,
+                    absl::Span<uint8_t> record) const;
+
+  // Returns the values held in the record.
+  std::vector<Value> Unpack(absl::Span<const uint8_t> record) const;
+
+ private:
+  std::vector<Type*> types_;
+  std::vector<int64_t> offsets_;
+  std::vector<int64_t> sizes_;
+  int64_t record_size_ = 0;
+  JitRuntime* runtime_;
+};
+
+// Reads records of the JIT format in batches.
+class JitValueReader {
+ public:
+  // Opens the file and checks its header against the given layout, which
+  // must outlive the reader.
+  static absl::StatusOr<std::unique_ptr<JitValueReader>> Create(
+      const std::filesystem::path& path, const JitRecordLayout* layout);
+
+  // Reads up to `max_records` consecutive records into `buffer`, which is
+  // resized to hold them. Returns the number of records read, which is zero
+  // only at the end of the file.
+  absl::StatusOr<int64_t> Read(int64_t max_records,
+                               std::vector<uint8_t>* buffer);
+
+ private:
+  JitValueReader(const std::filesystem::path& path,
+                 const JitRecordLayout* layout)
+      : path_(path), stream_(path, std::ios::binary), layout_(layout) {}
+
+  std::filesystem::path path_;
+  std::ifstream stream_;
+  const JitRecordLayout* layout_;
+};
+
+// Writes records of the JIT format.
+class JitValueWriter {
+ public:
+  // Creates the file and writes its header. The layout must outlive the
+  // writer.
+  static absl::StatusOr<std::unique_ptr<JitValueWriter>> Create(
+      const std::filesystem::path& path, const JitRecordLayout* layout);
+
+  // Appends consecutive records; the size of `records` must be a multiple of
+  // the record size.
+  absl::Status Write(absl::Span<const uint8_t> records);
+
+  // Flushes the file and returns any error encountered while writing.
+  absl::Status Close();
+
+ private:
+  JitValueWriter(const std::filesystem::path& path,
+                 const JitRecordLayout* layout)
+      : path_(path), stream_(path, std::ios::binary), layout_(layout) {}
+
+  std::filesystem::path path_;
+  std::ofstream stream_;
+  const JitRecordLayout* layout_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_VALUE_STREAM_H_
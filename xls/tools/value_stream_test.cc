@@ -0,0 +1,132 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/value_stream.h"
+
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+TEST(ValueStreamTest, TextReader) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile file, TempFile::CreateWithContent(
+                         "bits[8]:1; (bits[4]:2, bits[1]:0)\n"
+                         "\n"
+                         "  bits[8]:3;(bits[4]:4, bits[1]:1)\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TextValueReader> reader,
+                           TextValueReader::Create(file.path()));
+  EXPECT_THAT(reader->Read(),
+              IsOkAndHolds(Optional(ElementsAre(
+                  Value(UBits(1, 8)),
+                  Value::Tuple({Value(UBits(2, 4)), Value(UBits(0, 1))})))));
+  EXPECT_THAT(reader->Read(),
+              IsOkAndHolds(Optional(ElementsAre(
+                  Value(UBits(3, 8)),
+                  Value::Tuple({Value(UBits(4, 4)), Value(UBits(1, 1))})))));
+  EXPECT_THAT(reader->Read(), IsOkAndHolds(std::nullopt));
+}
+
+TEST(ValueStreamTest, TextReaderReportsLineOfError) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile file, TempFile::CreateWithContent("bits[8]:1\nbogus\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TextValueReader> reader,
+                           TextValueReader::Create(file.path()));
+  XLS_ASSERT_OK(reader->Read().status());
+  EXPECT_THAT(reader->Read(), StatusIs(absl::StatusCode::kInvalidArgument,
+                                       HasSubstr(":2:")));
+}
+
+TEST(ValueStreamTest, JitRoundTrip) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitRuntime> runtime,
+                           JitRuntime::Create());
+  std::vector<Type*> types = {
+      package.GetBitsType(3),
+      package.GetTupleType({package.GetBitsType(64), package.GetBitsType(1)})};
+  JitRecordLayout layout(types, runtime.get());
+  EXPECT_EQ(layout.offset(0), 0);
+  EXPECT_EQ(layout.offset(1) % JitRecordLayout::kAlignment, 0);
+  EXPECT_EQ(layout.record_size() % JitRecordLayout::kAlignment, 0);
+
+  std::vector<std::vector<Value>> records;
+  for (int64_t i = 0; i < 5; ++i) {
+    records.push_back(
+        {Value(UBits(i, 3)),
+         Value::Tuple({Value(UBits(i * 1000, 64)), Value(UBits(i % 2, 1))})});
+  }
+  std::vector<uint8_t> buffer(records.size() * layout.record_size());
+  for (int64_t i = 0; i < records.size(); ++i) {
+    XLS_ASSERT_OK(layout.Pack(
+        records[i], absl::MakeSpan(buffer).subspan(i * layout.record_size(),
+                                                   layout.record_size())));
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitValueWriter> writer,
+                           JitValueWriter::Create(file.path(), &layout));
+  XLS_ASSERT_OK(writer->Write(buffer));
+  XLS_ASSERT_OK(writer->Close());
+
+  // Read back in batches of two records.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitValueReader> reader,
+                           JitValueReader::Create(file.path(), &layout));
+  std::vector<std::vector<Value>> read_records;
+  std::vector<uint8_t> read_buffer;
+  while (true) {
+    XLS_ASSERT_OK_AND_ASSIGN(int64_t count, reader->Read(2, &read_buffer));
+    if (count == 0) {
+      break;
+    }
+    for (int64_t i = 0; i < count; ++i) {
+      read_records.push_back(layout.Unpack(absl::MakeSpan(read_buffer).subspan(
+          i * layout.record_size(), layout.record_size())));
+    }
+  }
+  EXPECT_EQ(read_records, records);
+}
+
+TEST(ValueStreamTest, JitReaderChecksSignature) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitRuntime> runtime,
+                           JitRuntime::Create());
+  std::vector<Type*> write_types = {package.GetBitsType(8)};
+  std::vector<Type*> read_types = {package.GetBitsType(16)};
+  JitRecordLayout write_layout(write_types, runtime.get());
+  JitRecordLayout read_layout(read_types, runtime.get());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitValueWriter> writer,
+                           JitValueWriter::Create(file.path(), &write_layout));
+  XLS_ASSERT_OK(writer->Close());
+  EXPECT_THAT(JitValueReader::Create(file.path(), &read_layout),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("holds records of type (bits[8])")));
+}
+
+}  // namespace
+}  // namespace xls